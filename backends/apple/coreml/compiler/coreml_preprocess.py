@@ -29,6 +29,8 @@ class COMPILE_SPEC_KEYS(Enum):
     MODEL_TYPE = "model_type"
     MIN_DEPLOYMENT_TARGET = "min_deployment_target"
     MODEL_COMPUTE_PRECISION = "model_compute_precision"
+    PREWARM = "prewarm"
+    ASYNC_EXECUTE = "async_execute"
 
 
 class MODEL_PATHS(Enum):
@@ -156,12 +158,38 @@ class CoreMLBackend(BackendDetails):
             compute_unit.name.lower().encode("utf-8"),
         )
 
+    @staticmethod
+    def generate_prewarm_compile_spec(prewarm: bool) -> CompileSpec:
+        """
+        Returns the compile spec representing whether the runtime pre-warms the model when the
+        ``Method`` is loaded. Pre-warming moves the cost of loading the model on the compute device
+        out of the first execution. If the spec is absent, the delegate config decides.
+        """
+        return CompileSpec(
+            COMPILE_SPEC_KEYS.PREWARM.value,
+            str(prewarm).lower().encode("utf-8"),
+        )
+
+    @staticmethod
+    def generate_async_execute_compile_spec(async_execute: bool) -> CompileSpec:
+        """
+        Returns the compile spec representing whether the runtime executes the model asynchronously.
+        The outputs of such a model are only valid after a call to
+        ``CoreMLBackendDelegate::wait_for_async_executions``.
+        """
+        return CompileSpec(
+            COMPILE_SPEC_KEYS.ASYNC_EXECUTE.value,
+            str(async_execute).lower().encode("utf-8"),
+        )
+
     @staticmethod
     def generate_compile_specs(
         compute_unit: ct.ComputeUnit = ct.ComputeUnit.ALL,
         minimum_deployment_target: ct.target = ct.target.iOS15,
         compute_precision: ct.precision = ct.precision.FLOAT16,
         model_type: MODEL_TYPE = MODEL_TYPE.MODEL,
+        prewarm: Optional[bool] = None,
+        async_execute: bool = False,
     ) -> List[CompileSpec]:
         """
         Returns the list of compile specs that's used by CoreMLBackend to lower the module.
@@ -179,6 +207,12 @@ class CoreMLBackend(BackendDetails):
             CoreMLBackend.generate_compute_precision_compile_spec(compute_precision)
         )
         compile_specs.append(CoreMLBackend.generate_model_type_compile_spec(model_type))
+        if prewarm is not None:
+            compile_specs.append(CoreMLBackend.generate_prewarm_compile_spec(prewarm))
+        if async_execute:
+            compile_specs.append(
+                CoreMLBackend.generate_async_execute_compile_spec(async_execute)
+            )
 
         return compile_specs
 
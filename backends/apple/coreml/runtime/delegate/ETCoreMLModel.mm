@@ -207,6 +207,7 @@ NSDictionary<NSString *, MLMultiArrayConstraint *> *get_multi_array_output_const
                                          argNames:(NSOrderedSet<NSString *> *)argNames
                              argConstraintsByName:(NSDictionary<NSString *, MLMultiArrayConstraint *> *)argConstraintsByName
                                          copyData:(const BOOL)copyData
+                                       packedOnly:(const BOOL)packedOnly
                                             error:(NSError * __autoreleasing *)error {
     NSEnumerator *nameEnumerator = [argNames objectEnumerator];
     NSMutableArray<MLMultiArray *> *result = [NSMutableArray arrayWithCapacity:args.size()];
@@ -217,7 +218,7 @@ NSDictionary<NSString *, MLMultiArrayConstraint *> *get_multi_array_output_const
         const auto& layout = arg.layout();
         auto dataType = to_ml_multiarray_data_type(layout.dataType());
         MLMultiArray *multiArrayArg = nil;
-        if (dataType == constraint.dataType) {
+        if (dataType == constraint.dataType && (!packedOnly || layout.is_packed())) {
             // We can use the same data storage.
             multiArrayArg = [[MLMultiArray alloc] initWithDataPointer:arg.data()
                                                                 shape:to_array(layout.shape())
@@ -227,7 +228,7 @@ NSDictionary<NSString *, MLMultiArrayConstraint *> *get_multi_array_output_const
                                                                 error:error];
             lCopyData = NO;
         } else {
-            // We can't use the same data storage, data types are not the same.
+            // We can't use the same data storage, data types or layouts are not the same.
             multiArrayArg = ::make_ml_multi_array(layout.shape(), constraint.dataType, self.cache, error);
         }
         
@@ -258,6 +259,7 @@ NSDictionary<NSString *, MLMultiArrayConstraint *> *get_multi_array_output_const
                     argNames:self.orderedInputNames
         argConstraintsByName:self.inputConstraintsByName
                     copyData:YES
+                  packedOnly:NO
                        error:error];
     
 }
@@ -268,6 +270,7 @@ NSDictionary<NSString *, MLMultiArrayConstraint *> *get_multi_array_output_const
                     argNames:self.orderedOutputNames
         argConstraintsByName:self.outputConstraintsByName
                     copyData:NO
+                  packedOnly:YES
                        error:error];
     
 }
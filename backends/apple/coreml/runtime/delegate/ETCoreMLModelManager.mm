@@ -695,18 +695,17 @@ NSDictionary<ETCoreMLModelStructurePath *, NSString *> * _Nullable get_operation
                                                              loggingOptions:loggingOptions
                                                                  eventLogger:eventLogger
                                                                        error:&localError];
-    // Try without output backings.
+    // Try without output backings, only if the prediction failed with them.
     if (!modelOutputs && predictionOptions.outputBackings.count > 0) {
         localError = nil;
         executor.ignoreOutputBackings = YES;
+        modelOutputs = [executor executeModelWithInputs:inputFeatures
+                                      predictionOptions:predictionOptions
+                                         loggingOptions:loggingOptions
+                                            eventLogger:eventLogger
+                                                  error:&localError];
     }
     
-    modelOutputs = [executor executeModelWithInputs:inputFeatures
-                                  predictionOptions:predictionOptions
-                                     loggingOptions:loggingOptions
-                                        eventLogger:eventLogger
-                                              error:&localError];
-    
     if (error) {
         *error = localError;
     }
@@ -30,6 +30,12 @@ NS_ASSUME_NONNULL_BEGIN
 /// The key name for compute units.
 @property (class, copy, readonly, nonatomic) NSString* computeUnitsKeyName;
 
+/// The key name for pre-warming the model in `init`.
+@property (class, copy, readonly, nonatomic) NSString* prewarmKeyName;
+
+/// The key name for executing the model asynchronously.
+@property (class, copy, readonly, nonatomic) NSString* asyncExecuteKeyName;
+
 /// The compiled model package extension name.
 @property (class, copy, readonly, nonatomic) NSString* compiledModelExtensionName;
 
@@ -35,6 +35,16 @@
     return ETCoreMLComputeUnitsName;
 }
 
++ (NSString *)prewarmKeyName {
+    static NSString * const ETCoreMLPrewarmKeyName = @"prewarm";
+    return ETCoreMLPrewarmKeyName;
+}
+
++ (NSString *)asyncExecuteKeyName {
+    static NSString * const ETCoreMLAsyncExecuteKeyName = @"async_execute";
+    return ETCoreMLAsyncExecuteKeyName;
+}
+
 + (NSString *)compiledModelExtensionName {
     static NSString * const ETCoreMLCompiledModelExtensionName = @"mlmodelc";
     return ETCoreMLCompiledModelExtensionName;
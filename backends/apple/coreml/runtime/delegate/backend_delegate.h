@@ -29,7 +29,8 @@ public:
         size_t max_models_cache_size = 10 * size_t(1024) * size_t(1024) * size_t(1024);
         // If set to `true`, delegate pre-warms the most recently used asset.
         bool should_prewarm_asset = true;
-        // If set to `true`, delegate pre-warms the model in `init`.
+        // If set to `true`, delegate pre-warms the model in `init`. The `prewarm`
+        // compile spec of a model takes precedence over this value.
         bool should_prewarm_model = true;
     };
 
@@ -82,18 +83,30 @@ public:
     /// implementation must execute the model with the inputs and must populate
     /// the outputs from the model prediction outputs.
     ///
+    /// If the model was initialized with the `async_execute` compile spec, the
+    /// implementation may return before the outputs are populated. The memory
+    /// of the `args` must then stay valid and must not be accessed until
+    /// `wait_for_async_executions` returns, and `event_logger` is not used.
+    ///
     /// @param handle The model handle.
     /// @param args The inputs and outputs to the model.
     /// @param logging_options The model logging options.
     /// @param event_logger The model event logger.
     /// @param error   On failure, error is filled with the failure information.
-    /// @retval `true` if the execution succeeded otherwise `false`.
+    /// @retval `true` if the execution succeeded or was started otherwise `false`.
     virtual bool execute(Handle* handle,
                          const std::vector<MultiArray>& args,
                          const ModelLoggingOptions& logging_options,
                          ModelEventLogger* event_logger,
                          std::error_code& error) const noexcept = 0;
 
+    /// Must wait for all the executions that were started asynchronously.
+    ///
+    /// @param error   On failure, error is filled with the failure information
+    /// of the first asynchronous execution that failed since the last call.
+    /// @retval `true` if all the executions succeeded otherwise `false`.
+    virtual bool wait_for_async_executions(std::error_code& error) const noexcept = 0;
+
     /// Must return `true` if the delegate is available for execution otherwise
     /// `false`.
     virtual bool is_available() const noexcept = 0;
@@ -14,6 +14,9 @@
 #import <backend_delegate.h>
 #import <model_event_logger.h>
 #import <multiarray.h>
+#import <mutex>
+#import <optional>
+#import <unordered_set>
 
 namespace  {
 using namespace executorchcoreml;
@@ -44,6 +47,16 @@ MLModelConfiguration *get_model_configuration(const std::unordered_map<std::stri
     return configuration;
 }
 
+std::optional<bool> get_bool_spec(const std::unordered_map<std::string, Buffer>& specs, NSString *key_name) {
+    auto it = specs.find(std::string(key_name.UTF8String));
+    if (it == specs.end()) {
+        return std::nullopt;
+    }
+    
+    std::string value(reinterpret_cast<const char *>(it->second.data()), it->second.size());
+    return value == "true" || value == "1";
+}
+
 NSURL * _Nullable create_directory_if_needed(NSURL *url,
                                              NSFileManager *fileManager,
                                              NSError * __autoreleasing *error) {
@@ -128,6 +141,12 @@ public:
             [model_manager_ prewarmRecentlyUsedAssetsWithMaxCount:1];
         }
         available_.store(model_manager_ != nil, std::memory_order_seq_cst);
+        execution_queue_ = dispatch_queue_create("com.executorchcoreml.delegate.execution", DISPATCH_QUEUE_SERIAL_WITH_AUTORELEASE_POOL);
+        execution_group_ = dispatch_group_create();
+    }
+    
+    ~BackendDelegateImpl() noexcept override {
+        dispatch_group_wait(execution_group_, DISPATCH_TIME_FOREVER);
     }
     
     BackendDelegateImpl(BackendDelegateImpl const&) = delete;
@@ -142,11 +161,23 @@ public:
         ModelHandle *modelHandle = [model_manager_ loadModelFromAOTData:data
                                                           configuration:configuration
                                                                   error:&localError];
-        if (modelHandle && config_.should_prewarm_model) {
+        if (!modelHandle) {
+            return nullptr;
+        }
+        
+        // Pre-warming loads the model on the compute device, so that the first
+        // execution doesn't pay for it.
+        bool should_prewarm_model = get_bool_spec(specs, ETCoreMLStrings.prewarmKeyName).value_or(config_.should_prewarm_model);
+        if (should_prewarm_model) {
             NSError *localError = nil;
             [model_manager_ prewarmModelWithHandle:modelHandle error:&localError];
         }
         
+        if (get_bool_spec(specs, ETCoreMLStrings.asyncExecuteKeyName).value_or(false)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            async_handles_.insert(modelHandle);
+        }
+        
         return modelHandle;
     }
     
@@ -155,6 +186,29 @@ public:
                  const ModelLoggingOptions& logging_options,
                  ModelEventLogger *event_logger,
                  std::error_code& ec) const noexcept override {
+        if (is_async_handle(handle)) {
+            // The executions are serialized on the queue, an execution that
+            // consumes the outputs of a pending one therefore sees them.
+            // The block copies these, references would dangle.
+            std::vector<MultiArray> async_args = args;
+            ModelLoggingOptions async_logging_options = logging_options;
+            ETCoreMLModelManager *model_manager = model_manager_;
+            auto delegate = this;
+            dispatch_group_async(execution_group_, execution_queue_, ^{
+                NSError *error = nil;
+                if (![model_manager executeModelWithHandle:handle
+                                                   argsVec:async_args
+                                            loggingOptions:async_logging_options
+                                               eventLogger:nullptr
+                                                     error:&error]) {
+                    delegate->set_async_error(static_cast<ErrorCode>(error.code));
+                }
+            });
+            return true;
+        }
+        
+        // The inputs could be the outputs of a pending asynchronous execution.
+        dispatch_group_wait(execution_group_, DISPATCH_TIME_FOREVER);
         NSError *error = nil;
         if (![model_manager_ executeModelWithHandle:handle
                                             argsVec:args
@@ -168,6 +222,18 @@ public:
         return true;
     }
     
+    bool wait_for_async_executions(std::error_code& ec) const noexcept override {
+        dispatch_group_wait(execution_group_, DISPATCH_TIME_FOREVER);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (async_error_) {
+            ec = async_error_;
+            async_error_ = std::error_code();
+            return false;
+        }
+        
+        return true;
+    }
+    
     bool is_valid_handle(Handle* handle) const noexcept override {
         return [model_manager_ modelWithHandle:handle] != nil;
     }
@@ -182,6 +248,12 @@ public:
     }
     
     void destroy(Handle* handle) const noexcept override {
+        // A pending execution could still be using the model.
+        dispatch_group_wait(execution_group_, DISPATCH_TIME_FOREVER);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            async_handles_.erase(handle);
+        }
         [model_manager_ unloadModelWithHandle:handle];
     }
     
@@ -191,9 +263,31 @@ public:
         return result;
     }
     
+    bool is_async_handle(Handle* handle) const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return async_handles_.count(handle) > 0;
+    }
+    
+    void set_async_error(std::error_code ec) const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!async_error_) {
+            async_error_ = ec;
+        }
+    }
+    
     ETCoreMLModelManager *model_manager_;
     std::atomic<bool> available_;
     Config config_;
+    // Serial queue on which the asynchronous executions run.
+    dispatch_queue_t execution_queue_;
+    // Group that tracks the pending asynchronous executions.
+    dispatch_group_t execution_group_;
+    // Protects `async_handles_` and `async_error_`.
+    mutable std::mutex mutex_;
+    // Handles of the models initialized with the `async_execute` compile spec.
+    mutable std::unordered_set<Handle*> async_handles_;
+    // Error of the first asynchronous execution that failed.
+    mutable std::error_code async_error_;
 };
 
 std::shared_ptr<BackendDelegate> BackendDelegate::make(const Config& config) {
@@ -10,6 +10,7 @@
 #import <ETCoreMLStrings.h>
 #import <backend_delegate.h>
 #import <coreml_backend/delegate.h>
+#import <executorch/runtime/backend/delegate_profiling.h>
 #import <executorch/runtime/core/evalue.h>
 #import <memory>
 #import <model_event_logger.h>
@@ -155,6 +156,8 @@ CoreMLBackendDelegate::init(BackendInitContext& context,
     
     auto buffer = Buffer(processed->data(), processed->size());
     std::error_code error;
+    // Compiling and loading the model takes most of the time of init.
+    DelegateProfilingScope compile_scope(context.event_tracer(), DelegateProfilingEventType::kCompile);
     auto handle = impl_->init(std::move(buffer), specs_map);
     ET_CHECK_OR_RETURN_ERROR(handle != nullptr,
                              InvalidProgram,
@@ -172,26 +175,30 @@ Error CoreMLBackendDelegate::execute(BackendExecutionContext& context,
     size_t nOutputs = nArgs.second;
     delegate_args.reserve(nInputs + nOutputs);
     
-    // inputs
-    for (size_t i = 0; i < nInputs; i++) {
-        auto multi_array = get_multi_array(args[i], ArgType::Input);
-        ET_CHECK_OR_RETURN_ERROR(multi_array.has_value(),
-                                 Internal,
-                                 "%s: Failed to create multiarray from input at args[%zu]", ETCoreMLStrings.delegateIdentifier.UTF8String, i);
-        delegate_args.emplace_back(std::move(multi_array.value()));
-    }
+    {
+        DelegateProfilingScope transfer_scope(context.event_tracer(), DelegateProfilingEventType::kDataTransfer);
+        // inputs
+        for (size_t i = 0; i < nInputs; i++) {
+            auto multi_array = get_multi_array(args[i], ArgType::Input);
+            ET_CHECK_OR_RETURN_ERROR(multi_array.has_value(),
+                                     Internal,
+                                     "%s: Failed to create multiarray from input at args[%zu]", ETCoreMLStrings.delegateIdentifier.UTF8String, i);
+            delegate_args.emplace_back(std::move(multi_array.value()));
+        }
     
-    // outputs
-    for (size_t i = nInputs; i < nInputs + nOutputs; i++) {
-        auto multi_array = get_multi_array(args[i], ArgType::Output);
-        ET_CHECK_OR_RETURN_ERROR(multi_array.has_value(),
-                                 Internal,
-                                 "%s: Failed to create multiarray from output at args[%zu]", ETCoreMLStrings.delegateIdentifier.UTF8String, i);
-        delegate_args.emplace_back(std::move(multi_array.value()));
+        // outputs
+        for (size_t i = nInputs; i < nInputs + nOutputs; i++) {
+            auto multi_array = get_multi_array(args[i], ArgType::Output);
+            ET_CHECK_OR_RETURN_ERROR(multi_array.has_value(),
+                                     Internal,
+                                     "%s: Failed to create multiarray from output at args[%zu]", ETCoreMLStrings.delegateIdentifier.UTF8String, i);
+            delegate_args.emplace_back(std::move(multi_array.value()));
+        }
     }
     
     auto logging_options = get_logging_options(context);
     std::error_code ec;
+    DelegateProfilingScope execute_scope(context.event_tracer(), DelegateProfilingEventType::kExecute);
 #ifdef ET_EVENT_TRACER_ENABLED
     auto event_logger = ModelEventLoggerImpl(context.event_tracer());
     ET_CHECK_OR_RETURN_ERROR(impl_->execute(handle, delegate_args, logging_options, &event_logger, ec),
@@ -223,6 +230,15 @@ bool CoreMLBackendDelegate::purge_models_cache() const noexcept {
     return impl_->purge_models_cache();
 }
 
+Error CoreMLBackendDelegate::wait_for_async_executions() const noexcept {
+    std::error_code ec;
+    ET_CHECK_OR_RETURN_ERROR(impl_->wait_for_async_executions(ec),
+                             DelegateInvalidHandle,
+                             "%s: Failed to run the model asynchronously.",
+                             ETCoreMLStrings.delegateIdentifier.UTF8String);
+    return Error::Ok;
+}
+
 CoreMLBackendDelegate *CoreMLBackendDelegate::get_registered_delegate() noexcept {
     return static_cast<CoreMLBackendDelegate *>(get_backend_class(ETCoreMLStrings.delegateIdentifier.UTF8String));
 }
@@ -62,6 +62,18 @@ public:
     /// asynchronously deleted.
     bool purge_models_cache() const noexcept;
 
+    /// Waits for the executions of the models that were lowered with the
+    /// `async_execute` compile spec.
+    ///
+    /// The `execute` of such a model returns once the execution is scheduled,
+    /// so that the caller can do other work while the model runs. The model
+    /// outputs are only valid, and the inputs can only be reused, after this
+    /// method returns.
+    ///
+    /// @retval `Error::Ok` if all the executions succeeded otherwise
+    /// `Error::DelegateInvalidHandle`.
+    Error wait_for_async_executions() const noexcept;
+
 private:
     std::shared_ptr<executorchcoreml::BackendDelegate> impl_;
 };
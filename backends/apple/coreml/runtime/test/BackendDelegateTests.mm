@@ -171,6 +171,43 @@ std::vector<MultiArray> to_multiarrays(NSArray<MLMultiArray *> *ml_multiarrays)
     }
 }
 
+- (void)testAsyncAddModelExecution {
+    NSURL *modelURL = [[self class] bundledResourceWithName:@"add_coreml_all" extension:@"bin"];
+    XCTAssertNotNil(modelURL);
+    NSError *localError = nil;
+    NSData *data = [NSData dataWithContentsOfURL:modelURL];
+    std::unordered_map<std::string, Buffer> compileSpecs;
+    NSData *specData = [@"true" dataUsingEncoding:NSUTF8StringEncoding];
+    compileSpecs.emplace(std::string(ETCoreMLStrings.asyncExecuteKeyName.UTF8String), Buffer(specData.bytes, specData.length));
+    compileSpecs.emplace(std::string(ETCoreMLStrings.prewarmKeyName.UTF8String), Buffer(specData.bytes, specData.length));
+    BackendDelegate::Handle *handle = _delegate->init(Buffer(data.bytes, data.length), compileSpecs);
+    ETCoreMLModel *model = (__bridge ETCoreMLModel *)handle;
+    int x = 20;
+    int y = 50;
+    // add_coreml_all does the following operations.
+    int z = x + y;
+    z = z + x;
+    z = z + x;
+    z = z + z;
+    
+    NSArray<MLMultiArray *> *inputs = [ETCoreMLTestUtils inputsForModel:model repeatedValues:@[@(x), @(y)] error:&localError];
+    XCTAssertNotNil(inputs);
+    MLMultiArray *output = [ETCoreMLTestUtils filledMultiArrayWithShape:inputs[0].shape dataType:inputs[0].dataType repeatedValue:@(0) error:&localError];
+    NSArray<MLMultiArray *> *args = [inputs arrayByAddingObject:output];
+    std::error_code errorCode;
+    XCTAssertTrue(_delegate->execute(handle,
+                                     to_multiarrays(args),
+                                     ModelLoggingOptions(),
+                                     nullptr,
+                                     errorCode));
+    XCTAssertTrue(_delegate->wait_for_async_executions(errorCode));
+    for (NSUInteger i = 0; i < output.count; i++) {
+        NSNumber *value = [output objectAtIndexedSubscript:i];
+        XCTAssertEqual(value.integerValue, z);
+    }
+    _delegate->destroy(handle);
+}
+
 - (void)testMulModelExecution {
     NSURL *modelURL = [[self class] bundledResourceWithName:@"mul_coreml_all" extension:@"bin"];
     XCTAssertNotNil(modelURL);
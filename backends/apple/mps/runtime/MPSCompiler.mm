@@ -17,6 +17,7 @@
 // Runtime headers
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 
+#include <cstring>
 #include <unordered_map>
 #include <string>
 #include <iostream>
@@ -38,10 +39,19 @@ __ET_NODISCARD Error MPSCompiler::compileModel(
   MPSExecutor* executor,
   MemoryAllocator* runtime_allocator,
   ArrayRef<CompileSpec> compile_specs) {
-  MPS_UNUSED(compile_specs);
-
   Error err = Error::Ok;
 
+  for (const CompileSpec& spec : compile_specs) {
+    if (std::strcmp(spec.key, "pipelined") == 0) {
+      ET_CHECK_OR_RETURN_ERROR(
+        spec.value.nbytes == 1,
+        InvalidProgram,
+        "Compile spec 'pipelined' must be a single byte");
+      executor->_pipelined =
+        *static_cast<const uint8_t*>(spec.value.buffer) != 0;
+    }
+  }
+
   std::unique_ptr<MPSGraphBuilder> mpsGraphBuilder(
     new MPSGraphBuilder(buffer_pointer, executor->_mpsGraphTensorToId));
   err = mpsGraphBuilder->compileModel();
@@ -60,6 +70,7 @@ __ET_NODISCARD Error MPSCompiler::compileModel(
 
   ET_LOG(Debug, "MPSGraphExecutable total inputs: %lu", [executor->_inputShapes count]);
   ET_LOG(Debug, "MPSGraphExecutable total outputs: %lu", [executor->_outputShapes count]);
+  ET_LOG(Debug, "MPSGraphExecutable pipelined: %d", executor->_pipelined);
 
   return err;
 }
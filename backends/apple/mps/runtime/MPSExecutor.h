@@ -11,6 +11,7 @@
 
 #include <executorch/backends/apple/mps/runtime/operations/OperationUtils.h>
 #include <executorch/backends/apple/mps/runtime/MPSStream.h>
+#include <executorch/backends/apple/mps/runtime/MPSSynchronize.h>
 
 #include <map>
 #include <memory>
@@ -36,6 +37,9 @@ class MPSExecutor {
   //   - False: Simulator or x86 or pre-macOS15/iOS17/iPadOS17
   bool _use_shared_mem;
   bool _buffers_initialized;
+  // Set by the "pipelined" compile spec: forward() returns once the work is
+  // committed to the GPU instead of waiting for it; see MPSSynchronize.h.
+  bool _pipelined;
 
   // Input/Output GPU buffer pointer
   std::vector<id<MTLBuffer>> _inputGPUBuffers;
@@ -45,10 +49,18 @@ class MPSExecutor {
   std::vector<CPUBufferWrapper> _inputCPUBuffers;
   std::vector<CPUBufferWrapper> _outputCPUBuffers;
 
+  // Host memory bound to the inputs/outputs when using shared memory
+  std::vector<const void*> _inputHostPtrs;
+  std::vector<const void*> _outputHostPtrs;
+
   std::unordered_map<MPSGraphTensor*, int32_t> _mpsGraphTensorToId;
  public:
   MPSExecutor();
   ~MPSExecutor() {
+    if (_pipelined) {
+      // The GPU may still be using the buffers of the last execution.
+      ET_CHECK(synchronize() == Error::Ok);
+    }
     if (_inputsArray) {
       [_inputsArray release];
       _inputsArray = nil;
@@ -79,6 +91,7 @@ class MPSExecutor {
   set_inputs_outputs(std::vector<const Tensor*>& inputs, std::vector<const Tensor*>& outputs);
 
   Error initDataBuffers();
+  Error bindSharedBuffers(std::vector<const Tensor*>& inputs, std::vector<const Tensor*>& outputs);
   Error updateDataBuffers(std::vector<const Tensor*>& inputs, std::vector<const Tensor*>& outputs);
   Error syncOutputBuffers(std::vector<const Tensor*>& outputs);
 
@@ -7,6 +7,7 @@
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/backends/apple/mps/schema_generated.h>
 #include <executorch/backends/apple/mps/runtime/MPSExecutor.h>
+#include <executorch/backends/apple/mps/runtime/MPSSharedMemoryAllocator.h>
 #import <Foundation/Foundation.h>
 #import <MetalPerformanceShaders/MetalPerformanceShaders.h>
 #import <MetalPerformanceShadersGraph/MetalPerformanceShadersGraph.h>
@@ -22,9 +23,51 @@ namespace executor {
 namespace mps {
 namespace delegate {
 
+namespace {
+
+// Wraps the memory of `tensor` in place. Memory from an
+// MPSSharedMemoryAllocator is already wrapped by an MTLBuffer; any other
+// memory is wrapped here, by the pages that hold it.
+MPSGraphTensorData* newSharedTensorData(const Tensor& tensor, MPSGraphShapedType* type) {
+  const void* ptr = tensor.const_data_ptr();
+  NSUInteger offset = 0;
+  id<MTLBuffer> buffer = getSharedMTLBuffer(ptr, tensor.nbytes(), &offset);
+  if (buffer == nil) {
+    NSUInteger alignedLength = 0;
+    void* alignedPtr = pageAlignedBlockPtr(ptr, (NSUInteger)tensor.nbytes(), &alignedLength);
+    offset = uintptr_t(ptr) - uintptr_t(alignedPtr);
+    MTLResourceOptions options = MTLResourceCPUCacheModeDefaultCache | MTLResourceStorageModeShared;
+    buffer = [[MPSDevice::getInstance()->device() newBufferWithBytesNoCopy:alignedPtr
+                                                                    length:alignedLength
+                                                                   options:options
+                                                               deallocator:nil] autorelease];
+    if (buffer == nil) {
+      return nil;
+    }
+  }
+  MPSNDArrayDescriptor* descriptor = [MPSNDArrayDescriptor descriptorWithDataType:[type dataType]
+                                                                            shape:[type shape]];
+  MPSNDArray* array = [[[MPSNDArray alloc] initWithBuffer:buffer
+                                                   offset:offset
+                                               descriptor:descriptor] autorelease];
+  return [[MPSGraphTensorData alloc] initWithMPSNDArray:array];
+}
+
+// Sets `array[index]` to `tensorData`, appending it if `index` is the end.
+void setTensorData(NSMutableArray<MPSGraphTensorData *>* array, NSUInteger index, MPSGraphTensorData* tensorData) {
+  if (index < [array count]) {
+    [array replaceObjectAtIndex:index withObject:tensorData];
+  } else {
+    [array addObject:tensorData];
+  }
+}
+
+} // namespace
+
 MPSExecutor::MPSExecutor() {
   _use_shared_mem = true;
   _buffers_initialized = false;
+  _pipelined = false;
 
 #if TARGET_OS_SIMULATOR or defined(__x86_64__)
   _use_shared_mem = false;
@@ -42,14 +85,14 @@ MPSExecutor::set_inputs_outputs(std::vector<const Tensor*>& inputs, std::vector<
   ET_CHECK_OR_RETURN_ERROR(inputs.size() == getNumInputs(), Internal, "Inputs mismatch");
   ET_CHECK_OR_RETURN_ERROR(outputs.size() == getNumOutputs(), Internal, "Outputs mismatch");
 
-  if (_buffers_initialized) {
+  if (_use_shared_mem) {
     // When using shared memory, there is no need to blit
     // the contents of the CPU buffer to the GPU
-    // Once a CPU buffer has been wrapped around a GPU buffer,
-    // it can be reused across different multiple inference runs.
-    if (!_use_shared_mem) {
-      updateDataBuffers(inputs, outputs);
-    }
+    return bindSharedBuffers(inputs, outputs);
+  }
+
+  if (_buffers_initialized) {
+    updateDataBuffers(inputs, outputs);
   } else {
     updateDataBuffers(inputs, outputs);
     for (MPSGraphTensor *tensor in [_executable feedTensors]) {
@@ -71,29 +114,67 @@ MPSExecutor::set_inputs_outputs(std::vector<const Tensor*>& inputs, std::vector<
   return Error::Ok;
 }
 
+Error
+MPSExecutor::bindSharedBuffers(
+  std::vector<const Tensor*>& inputs, std::vector<const Tensor*>& outputs
+) {
+  // The GPU reads and writes the tensors in place, so they only need to be
+  // bound again when their memory changes, e.g. after set_input() with a
+  // different tensor.
+  _inputHostPtrs.resize(inputs.size(), nullptr);
+  _outputHostPtrs.resize(outputs.size(), nullptr);
+
+  NSArray<MPSGraphTensor *>* feedTensors = [_executable feedTensors];
+  for (NSUInteger j = 0; j < [feedTensors count]; j++) {
+    int i = _mpsGraphTensorToId[feedTensors[j]];
+    const void* ptr = inputs[i]->const_data_ptr();
+    if (j < [_inputsArray count] && _inputHostPtrs[i] == ptr) {
+      continue;
+    }
+    MPSGraphTensorData* tensorData = newSharedTensorData(*inputs[i], _inputShapes[i]);
+    ET_CHECK_OR_RETURN_ERROR(tensorData != nil, Internal, "Could not bind input %d", i);
+    setTensorData(_inputsArray, j, tensorData);
+    [tensorData release];
+    _inputHostPtrs[i] = ptr;
+  }
+
+  for (int i = 0; i < outputs.size(); i++) {
+    const void* ptr = outputs[i]->const_data_ptr();
+    if (i < [_outputsArray count] && _outputHostPtrs[i] == ptr) {
+      continue;
+    }
+    MPSGraphTensorData* tensorData = newSharedTensorData(*outputs[i], _outputShapes[i]);
+    ET_CHECK_OR_RETURN_ERROR(tensorData != nil, Internal, "Could not bind output %d", i);
+    setTensorData(_outputsArray, i, tensorData);
+    [tensorData release];
+    _outputHostPtrs[i] = ptr;
+  }
+
+  return Error::Ok;
+}
+
 __ET_NODISCARD Error MPSExecutor::forward(std::vector<const Tensor*>& outputs) {
   Error err = Error::Ok;
   MPSStream* mpsStream = getDefaultMPSStream();
-  if (mpsStream->commitAndContinueEnabled() || mpsStream->hasLiveCommandBuffer()) {
-    id<MTLCommandBuffer> commandBuffer = mpsStream->commandBuffer();
-    [_executable encodeToCommandBuffer:commandBuffer
-                          inputsArray:_inputsArray
-                          resultsArray:_outputsArray
-                  executionDescriptor:nil];
-  } else {
-    [_executable runWithMTLCommandQueue:mpsStream->commandQueue()
-                            inputsArray:_inputsArray
-                           resultsArray:_outputsArray
-                    executionDescriptor:nil];
-  }
+  // Encode into the stream's command buffer, which also holds the input and
+  // output blits, rather than letting MPSGraph create and wait on a command
+  // buffer of its own for every execution.
+  [_executable encodeToCommandBuffer:mpsStream->commandBuffer()
+                        inputsArray:_inputsArray
+                       resultsArray:_outputsArray
+                executionDescriptor:nil];
   syncOutputBuffers(outputs);
 
   // On simulator, the buffers are synchronized during `syncOutputBuffer`
 #if !TARGET_OS_SIMULATOR
-  if (mpsStream->commitAndContinueEnabled()) {
+  if (!_pipelined) {
+    err = mpsStream->synchronize(SyncType::COMMIT_AND_WAIT);
+  } else if (mpsStream->commitAndContinueEnabled()) {
+    // Submit the work and keep encoding the next execution into the same
+    // MPSCommandBuffer; synchronize() waits for it.
     err = mpsStream->synchronize(SyncType::COMMIT_AND_CONTINUE);
   } else {
-    err = mpsStream->synchronize(SyncType::COMMIT_AND_WAIT);
+    err = mpsStream->synchronize(SyncType::COMMIT);
   }
 
   ET_CHECK_OR_RETURN_ERROR(
@@ -161,47 +242,34 @@ MPSExecutor::updateDataBuffers(
     for (int i = 0; i < inputs.size(); i++) {
       const Tensor& tensor = *inputs[i];
       void* host_src = tensor.mutable_data_ptr<void*>();
-      if (_use_shared_mem) {
-        // Use directly the CPU buffer when using shared memory.
-        _inputGPUBuffers[i] = getMTLBufferStorage(tensor);
-      } else {
-        _inputCPUBuffers[i].flags = 0;
+      _inputCPUBuffers[i].flags = 0;
 #if TARGET_OS_SIMULATOR
-        // Simulator crashes when using newBufferWithBytesNoCopy.
-        // Use memcpy directly instead of using blit to copy the CPU
-        // data into the GPU buffer.
-        _inputCPUBuffers[i].srcOffset = 0;
-        _inputCPUBuffers[i].srcBuffer = host_src;
-        _inputCPUBuffers[i].srcCpu = 1;
+      // Simulator crashes when using newBufferWithBytesNoCopy.
+      // Use memcpy directly instead of using blit to copy the CPU
+      // data into the GPU buffer.
+      _inputCPUBuffers[i].srcOffset = 0;
+      _inputCPUBuffers[i].srcBuffer = host_src;
+      _inputCPUBuffers[i].srcCpu = 1;
 #else
-        MTLResourceOptions options = MTLResourceCPUCacheModeDefaultCache | MTLResourceStorageModeShared;
-        NSUInteger alignedLength = 0;
-        void* alignedPtr = pageAlignedBlockPtr(host_src, (NSUInteger)tensor.nbytes(), &alignedLength);
-        _inputCPUBuffers[i].srcOffset = uintptr_t(host_src) - uintptr_t(alignedPtr);
-        _inputCPUBuffers[i].srcBuffer = [MPSDevice::getInstance()->device() newBufferWithBytesNoCopy:alignedPtr
-                                                          length:alignedLength
-                                                        options:options
-                                                    deallocator:nil];
+      MTLResourceOptions options = MTLResourceCPUCacheModeDefaultCache | MTLResourceStorageModeShared;
+      NSUInteger alignedLength = 0;
+      void* alignedPtr = pageAlignedBlockPtr(host_src, (NSUInteger)tensor.nbytes(), &alignedLength);
+      _inputCPUBuffers[i].srcOffset = uintptr_t(host_src) - uintptr_t(alignedPtr);
+      _inputCPUBuffers[i].srcBuffer = [MPSDevice::getInstance()->device() newBufferWithBytesNoCopy:alignedPtr
+                                                        length:alignedLength
+                                                      options:options
+                                                  deallocator:nil];
 
 #endif
-        _inputCPUBuffers[i].dstBuffer = _inputGPUBuffers[i];
-        _inputCPUBuffers[i].dstOffset = 0;
-        _inputCPUBuffers[i].length = tensor.nbytes();
-      }
-    }
-
-    if (_use_shared_mem) {
-      for (int i = 0; i < outputs.size(); i++) {
-        _outputGPUBuffers[i] = getMTLBufferStorage(*outputs[i]);
-      }
+      _inputCPUBuffers[i].dstBuffer = _inputGPUBuffers[i];
+      _inputCPUBuffers[i].dstOffset = 0;
+      _inputCPUBuffers[i].length = tensor.nbytes();
     }
   }
 
-  if (!_use_shared_mem) {
-    MPSStream* mpsStream = getDefaultMPSStream();
-      mpsStream->copy_and_sync(
-        _inputCPUBuffers, /*non_blocking=*/true);
-  }
+  MPSStream* mpsStream = getDefaultMPSStream();
+  mpsStream->copy_and_sync(
+    _inputCPUBuffers, /*non_blocking=*/true);
 
   return Error::Ok;
 }
@@ -0,0 +1,76 @@
+//
+//  Copyright (c) 2023 Apple Inc. All rights reserved.
+//  Provided subject to the LICENSE file in the top level directory.
+//
+
+#pragma once
+
+// Runtime headers
+#include <executorch/runtime/core/memory_allocator.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __OBJC__
+#include <Metal/Metal.h>
+#endif
+
+namespace torch {
+namespace executor {
+namespace mps {
+namespace delegate {
+
+/**
+ * A MemoryAllocator over page-aligned host memory that is also wrapped, once,
+ * by a shared-storage MTLBuffer.
+ *
+ * On Apple silicon the CPU and the GPU share memory, so when the planned
+ * buffers of a method come from this allocator, the MPS delegate binds the
+ * input and output tensors that live in them directly, without wrapping or
+ * copying them on every execution.
+ *
+ * The allocator must outlive every method that uses its memory.
+ *
+ * Example:
+ * @code
+ *   MPSSharedMemoryAllocator planned_memory(buffer_size);
+ *   // MemoryAllocator only holds pointers into the shared memory.
+ *   MemoryAllocator allocator(
+ *       planned_memory.size(), planned_memory.base_address());
+ *   HierarchicalAllocator planned_allocator(1, &allocator);
+ * @endcode
+ */
+class MPSSharedMemoryAllocator : public MemoryAllocator {
+ public:
+  /**
+   * Allocates at least `size` bytes; the size is rounded up to a whole number
+   * of pages. On failure, the allocator is empty and every allocation fails.
+   */
+  explicit MPSSharedMemoryAllocator(uint32_t size);
+
+  ~MPSSharedMemoryAllocator();
+
+  MPSSharedMemoryAllocator(const MPSSharedMemoryAllocator&) = delete;
+  MPSSharedMemoryAllocator& operator=(const MPSSharedMemoryAllocator&) = delete;
+
+ private:
+  MPSSharedMemoryAllocator(uint32_t size, uint8_t* base_address);
+
+  // The id<MTLBuffer>, opaque so that this header can be used from C++.
+  void* buffer_ = nullptr;
+};
+
+#ifdef __OBJC__
+/**
+ * Returns the MTLBuffer of the MPSSharedMemoryAllocator holding the `nbytes`
+ * at `ptr`, and the offset of `ptr` into it, or nil if no allocator holds
+ * them. The buffer is not retained.
+ */
+id<MTLBuffer>
+getSharedMTLBuffer(const void* ptr, size_t nbytes, NSUInteger* offset);
+#endif
+
+} // namespace delegate
+} // namespace mps
+} // namespace executor
+} // namespace torch
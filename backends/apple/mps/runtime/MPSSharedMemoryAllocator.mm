@@ -0,0 +1,117 @@
+//
+//  Copyright (c) 2023 Apple Inc. All rights reserved.
+//  Provided subject to the LICENSE file in the top level directory.
+//
+
+#include <executorch/backends/apple/mps/runtime/MPSDevice.h>
+#include <executorch/backends/apple/mps/runtime/MPSSharedMemoryAllocator.h>
+#include <executorch/runtime/platform/log.h>
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+namespace torch {
+namespace executor {
+namespace mps {
+namespace delegate {
+
+namespace {
+
+struct SharedRegion {
+  size_t size;
+  id<MTLBuffer> buffer;
+};
+
+// The live regions, keyed by their base address.
+std::mutex& regionsMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::map<uintptr_t, SharedRegion>& regions() {
+  static auto* regions = new std::map<uintptr_t, SharedRegion>();
+  return *regions;
+}
+
+uint32_t roundUpToPage(uint32_t size) {
+  const uint32_t page = static_cast<uint32_t>(getpagesize());
+  return (size + page - 1) / page * page;
+}
+
+uint8_t* allocatePages(uint32_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  void* memory = nullptr;
+  if (posix_memalign(&memory, getpagesize(), size) != 0) {
+    ET_LOG(Error, "Failed to allocate %u bytes of shared memory", size);
+    return nullptr;
+  }
+  return static_cast<uint8_t*>(memory);
+}
+
+} // namespace
+
+MPSSharedMemoryAllocator::MPSSharedMemoryAllocator(uint32_t size)
+    : MPSSharedMemoryAllocator(
+          roundUpToPage(size), allocatePages(roundUpToPage(size))) {}
+
+MPSSharedMemoryAllocator::MPSSharedMemoryAllocator(
+    uint32_t size,
+    uint8_t* base_address)
+    : MemoryAllocator(base_address != nullptr ? size : 0, base_address) {
+  if (base_address == nullptr) {
+    return;
+  }
+  // The memory stays owned by this allocator: no deallocator.
+  id<MTLBuffer> buffer = [MPSDevice::getInstance()->device()
+      newBufferWithBytesNoCopy:base_address
+                        length:size
+                       options:MTLResourceCPUCacheModeDefaultCache |
+                               MTLResourceStorageModeShared
+                   deallocator:nil];
+  if (buffer == nil) {
+    ET_LOG(Error, "Failed to wrap %u bytes of shared memory in an MTLBuffer", size);
+    return;
+  }
+  buffer_ = (void*)buffer;
+  std::lock_guard<std::mutex> lock(regionsMutex());
+  regions()[uintptr_t(base_address)] = SharedRegion{size, buffer};
+}
+
+MPSSharedMemoryAllocator::~MPSSharedMemoryAllocator() {
+  if (buffer_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(regionsMutex());
+      regions().erase(uintptr_t(base_address()));
+    }
+    [(id<MTLBuffer>)buffer_ release];
+    buffer_ = nullptr;
+  }
+  free(base_address());
+}
+
+id<MTLBuffer>
+getSharedMTLBuffer(const void* ptr, size_t nbytes, NSUInteger* offset) {
+  const uintptr_t address = uintptr_t(ptr);
+  std::lock_guard<std::mutex> lock(regionsMutex());
+  // The last region that starts at or before `ptr`.
+  auto it = regions().upper_bound(address);
+  if (it == regions().begin()) {
+    return nil;
+  }
+  --it;
+  const uintptr_t begin = it->first;
+  if (address + nbytes > begin + it->second.size) {
+    return nil;
+  }
+  *offset = (NSUInteger)(address - begin);
+  return it->second.buffer;
+}
+
+} // namespace delegate
+} // namespace mps
+} // namespace executor
+} // namespace torch
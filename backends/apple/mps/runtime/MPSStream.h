@@ -92,8 +92,14 @@ class MPSStream {
   MPSCommandBuffer* _prevCommandBuffer = nil;
   id<MTLComputeCommandEncoder> _commandEncoder = nil;
   dispatch_queue_t _serialQueue = nullptr;
-  // CommitAndContinue is disabled by default
+  // CommitAndContinue is enabled by default, so that consecutive executions
+  // keep encoding into the same MPSCommandBuffer; it is disabled on the
+  // simulator, where the CPU copies wait for the GPU anyway.
+#if TARGET_OS_SIMULATOR
   bool _enableCommitAndContinue = false;
+#else
+  bool _enableCommitAndContinue = true;
+#endif
   // accumulated sizes of resources encoded on command buffer
   size_t _commandBufferResourceSize = 0;
   // unfortunately, there's no way to get the underlying buffer from
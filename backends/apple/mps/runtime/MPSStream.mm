@@ -4,6 +4,7 @@
 //
 
 #include <executorch/backends/apple/mps/runtime/MPSStream.h>
+#include <executorch/backends/apple/mps/runtime/MPSSynchronize.h>
 #include <executorch/runtime/platform/assert.h>
 #include <vector>
 
@@ -138,6 +139,9 @@ void MPSStream::flush() {
     // if commitAndContinue is disabled (e.g., for Profiler), we keep the command
     // buffer so we could wait on it later, if required.
     if (!_enableCommitAndContinue) {
+      // The queue executes in order, so waiting on the last committed buffer
+      // is enough; the older one can be released.
+      [_prevCommandBuffer release];
       _prevCommandBuffer = _commandBuffer;
     } else {
       [_commandBuffer release];
@@ -248,6 +252,15 @@ MPSStream* MPSStreamImpl::getInstance() {
 
 MPSStreamImpl::MPSStreamImpl() {}
 
+__ET_NODISCARD Error synchronize() {
+  __block Error err = Error::Ok;
+  MPSStream* mpsStream = getDefaultMPSStream();
+  dispatch_sync(mpsStream->queue(), ^() {
+    err = mpsStream->synchronize(SyncType::COMMIT_AND_WAIT);
+  });
+  return err;
+}
+
 MPSStream* getCurrentMPSStream() {
   return getDefaultMPSStream();
 }
@@ -0,0 +1,33 @@
+//
+//  Copyright (c) 2023 Apple Inc. All rights reserved.
+//  Provided subject to the LICENSE file in the top level directory.
+//
+
+#pragma once
+
+// Runtime headers
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+namespace mps {
+namespace delegate {
+
+/**
+ * Waits until the GPU has finished all the work submitted by the MPS delegate.
+ *
+ * Programs lowered with the "pipelined" compile spec return from execute()
+ * as soon as their work is committed to the GPU, so that consecutive
+ * executions overlap. Their outputs are only valid, and their inputs may only
+ * be overwritten, after this function returns.
+ *
+ * This header does not include any Objective-C header, so it can be used
+ * from plain C++ code.
+ */
+__ET_NODISCARD Error synchronize();
+
+} // namespace delegate
+} // namespace mps
+} // namespace executor
+} // namespace torch
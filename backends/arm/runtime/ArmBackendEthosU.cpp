@@ -21,6 +21,11 @@
 #include <ethosu_driver.h>
 #include <pmu_ethosu.h>
 
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define ET_ARM_BACKEND_USE_MVE 1
+#endif
+
 using namespace std;
 
 namespace torch {
@@ -106,6 +111,8 @@ class ArmBackend final : public PyTorchBackendInterface {
     // Write argument values (from EValue tensor) into Ethos-U scratch
     // TODO(MLETORCH-123): Optimise into direct write from Vela into the SRAM
     //                     or DRAM output for compatible data layouts.
+    // Inputs whose data already lives at their place in the scratch region,
+    // e.g. set there by the application, are not copied.
     for (int i = 0; i < handles.inputs->count; i++) {
       auto tensor_in = args[i]->toTensor();
       VelaIO* scratch_in = &handles.inputs->io[i];
@@ -144,19 +151,21 @@ class ArmBackend final : public PyTorchBackendInterface {
           handles.inputs->io[i].elem_size == 4;
 
       // Select a compatible copy routine
+      const char* input_addr = tensor_in.const_data_ptr<char>();
       if (both_char and permuted_input_shape) {
         // permuted byte copy CHW to HWC
         permute_CHW_to_HWC(
+            input_addr,
             scratch_addr,
-            tensor_in.mutable_data_ptr<char>(),
+            tensor_in.size(0),
+            tensor_in.size(1),
             tensor_in.size(2),
             tensor_in.size(3));
       } else if (both_char or both_int) {
         // Sizes match and elt size matches so memcpy
-        memcpy(
-            scratch_addr,
-            tensor_in.mutable_data_ptr<char>(),
-            tensor_in.nbytes());
+        if (input_addr != scratch_addr) {
+          memcpy(scratch_addr, input_addr, tensor_in.nbytes());
+        }
       } else {
         ET_LOG(Error, "No matching input copy routine");
         return Error::InvalidProgram;
@@ -198,12 +207,20 @@ class ArmBackend final : public PyTorchBackendInterface {
     for (int i = 0; i < handles.outputs->count; i++) {
       const char* output_addr =
           handles.scratch_data + handles.outputs->io[i].offset;
-      // Process input EValue into scratch
-      int* output_address = (int*)output_addr;
       // Outputs are in the index immediately after inputs
       auto tensor_out = args[handles.inputs->count + i]->toTensor();
-      for (int j = 0; j < tensor_out.numel(); j++) {
-        tensor_out.mutable_data_ptr<int>()[j] = output_address[j];
+      if (tensor_out.element_size() != handles.outputs->io[i].elem_size) {
+        ET_LOG(
+            Error,
+            "Output %d has %zu byte elements, expected %d",
+            i,
+            (size_t)tensor_out.element_size(),
+            handles.outputs->io[i].elem_size);
+        return Error::InvalidProgram;
+      }
+      char* output_data = tensor_out.mutable_data_ptr<char>();
+      if (output_data != output_addr) {
+        memcpy(output_data, output_addr, tensor_out.nbytes());
       }
     }
 
@@ -257,11 +274,43 @@ class ArmBackend final : public PyTorchBackendInterface {
     return Error::Ok;
   }
 
-  void permute_CHW_to_HWC(char* input, char* output, int H, int W) const {
-    for (int i = 0; i != H * W; ++i) {
-      output[i * 3 + 0] = input[i + 0 * W * H];
-      output[i * 3 + 1] = input[i + 1 * W * H];
-      output[i * 3 + 2] = input[i + 2 * W * H];
+  // Copies N images of C channels of H x W bytes from input, in CHW layout,
+  // to output in HWC layout.
+  void permute_CHW_to_HWC(
+      const char* input,
+      char* output,
+      int N,
+      int C,
+      int H,
+      int W) const {
+    const int plane = H * W;
+    for (int n = 0; n < N; ++n) {
+      const char* image_in = input + n * C * plane;
+      char* image_out = output + n * C * plane;
+#ifdef ET_ARM_BACKEND_USE_MVE
+      // Scatter 16 bytes of a channel at a time to every C-th byte of the
+      // output. The byte offsets of the scatter must fit in 8 bits.
+      if (C <= 17) {
+        const uint8x16_t offsets =
+            vmulq_n_u8(vidupq_n_u8(0, 1), static_cast<uint8_t>(C));
+        for (int c = 0; c < C; ++c) {
+          const uint8_t* src =
+              reinterpret_cast<const uint8_t*>(image_in + c * plane);
+          uint8_t* dst = reinterpret_cast<uint8_t*>(image_out + c);
+          for (int i = 0; i < plane; i += 16) {
+            mve_pred16_t p = vctp8q(plane - i);
+            uint8x16_t v = vldrbq_z_u8(src + i, p);
+            vstrbq_scatter_offset_p_u8(dst + i * C, offsets, v, p);
+          }
+        }
+        continue;
+      }
+#endif
+      for (int c = 0; c < C; ++c) {
+        for (int i = 0; i < plane; ++i) {
+          image_out[i * C + c] = image_in[c * plane + i];
+        }
+      }
     }
   }
 };
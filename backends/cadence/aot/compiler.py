@@ -10,6 +10,7 @@ from typing import Any, Tuple
 import torch
 
 from executorch.backends.cadence.aot.passes import (
+    FuseQuantizedConvRelu,
     ReplacePT2DequantWithCadenceDequant,
     ReplacePT2QuantWithCadenceQuant,
 )
@@ -87,4 +88,9 @@ def export_to_cadence(
         [ReplacePT2QuantWithCadenceQuant(), ReplacePT2DequantWithCadenceDequant()]
     )
 
+    # Fuse quantized ops whose fused kernels save a pass over the activations
+    cadence_program_manager = cadence_program_manager.transform(
+        [FuseQuantizedConvRelu()]
+    )
+
     return cadence_program_manager
@@ -4,8 +4,10 @@
 # This source code is licensed under the BSD-style license found in the
 # LICENSE file in the root directory of this source tree.
 
+import torch
 from executorch.exir.dialects._ops import ops as exir_ops
 from executorch.exir.pass_base import ExportPass
+from torch.fx.passes.infra.pass_base import PassResult
 
 
 class ReplacePT2QuantWithCadenceQuant(ExportPass):
@@ -40,3 +42,43 @@ class ReplacePT2DequantWithCadenceDequant(ExportPass):
             kwargs,
             meta,
         )
+
+
+class FuseQuantizedConvRelu(ExportPass):
+    """
+    Fuse a quantized_relu that is the only user of a quantized_conv into a
+    quantized_conv_relu, which clamps the conv output while it is stored.
+    quantized_relu clamps at the zero point of its input, which is the output
+    zero point of the conv, so both compute the same result.
+    """
+
+    def call(self, graph_module: torch.fx.GraphModule) -> PassResult:
+        graph = graph_module.graph
+        modified = False
+        for relu in list(graph.nodes):
+            if relu.target != exir_ops.edge.cadence.quantized_relu.default:
+                continue
+            conv = relu.args[0]
+            if (
+                not isinstance(conv, torch.fx.Node)
+                or conv.target != exir_ops.edge.cadence.quantized_conv.default
+                or len(conv.users) != 1
+            ):
+                continue
+            with graph.inserting_before(relu):
+                fused = graph.call_function(
+                    exir_ops.edge.cadence.quantized_conv_relu.default,
+                    conv.args,
+                    conv.kwargs,
+                )
+            fused.meta = relu.meta
+            relu.replace_all_uses_with(fused)
+            graph.erase_node(relu)
+            graph.erase_node(conv)
+            modified = True
+
+        if modified:
+            graph.eliminate_dead_code()
+            graph_module.recompile()
+            graph_module = super().call(graph_module).graph_module
+        return PassResult(graph_module, modified)
@@ -56,8 +56,10 @@ void quantize(
     xtfloatx2 acc = zero_vec;
     XT_MADD_SX2(acc, scale_vec, in_vec);
     xtfloatx2 t0 = XT_FIROUND_SX2(acc);
+    // The signed truncation keeps negative values for signed T; they are
+    // already clamped to the range of T.
     ae_int32x2 t1 =
-        XT_UTRUNC_SX2(XT_MAX_SX2(XT_MIN_SX2(t0, max_val), min_val), 0);
+        XT_TRUNC_SX2(XT_MAX_SX2(XT_MIN_SX2(t0, max_val), min_val), 0);
     y[i] = AE_MOVAD32_H(t1);
     y[i + 1] = AE_MOVAD32_L(t1);
   }
@@ -128,10 +130,13 @@ void requantize(
     float inv_out_scale,
     int32_t out_zero_point,
     size_t size) {
-  xtfloatx2 in_scale_vec = (xtfloatx2)in_scale;
-  xtfloatx2 in_zero_vec = XT_FLOAT_SX2(in_zero_point, 0);
-  xtfloatx2 inv_out_scale_vec = (xtfloatx2)inv_out_scale;
-  xtfloatx2 out_zero_vec = XT_FLOAT_SX2(out_zero_point, 0);
+  // Fold the dequantize and quantize steps into a single multiply-add:
+  // out = round(in * (in_scale * inv_out_scale) +
+  //             (out_zero_point - in_zero_point * in_scale * inv_out_scale))
+  const float scale = in_scale * inv_out_scale;
+  const float offset = out_zero_point - in_zero_point * scale;
+  xtfloatx2 scale_vec = (xtfloatx2)scale;
+  xtfloatx2 offset_vec = (xtfloatx2)offset;
 
   float min_val = std::numeric_limits<OT>::min();
   float max_val = std::numeric_limits<OT>::max();
@@ -140,21 +145,18 @@ void requantize(
   // Vectorize by 2
   for (; i < (size & ~1); i += 2) {
     xtfloatx2 in_vec = {(float)in[i], (float)in[i + 1]};
-    xtfloatx2 t0 = XT_SUB_SX2(in_vec, in_zero_vec);
-    xtfloatx2 t1 = XT_MUL_SX2(t0, in_scale_vec);
-
-    xtfloatx2 acc = out_zero_vec;
-    XT_MADD_SX2(acc, inv_out_scale_vec, t1);
-    xtfloatx2 t2 = XT_FIROUND_SX2(acc);
-    ae_int32x2 t3 =
-        XT_UTRUNC_SX2(XT_MAX_SX2(XT_MIN_SX2(t2, max_val), min_val), 0);
-    out[i] = AE_MOVAD32_H(t3);
-    out[i + 1] = AE_MOVAD32_L(t3);
+    xtfloatx2 acc = offset_vec;
+    XT_MADD_SX2(acc, scale_vec, in_vec);
+    xtfloatx2 t0 = XT_FIROUND_SX2(acc);
+    ae_int32x2 t1 =
+        XT_TRUNC_SX2(XT_MAX_SX2(XT_MIN_SX2(t0, max_val), min_val), 0);
+    out[i] = AE_MOVAD32_H(t1);
+    out[i + 1] = AE_MOVAD32_L(t1);
   }
   // Handle residual iteration
   if (i < size) {
-    out[i] = requantize<IT, OT>(
-        in[i], in_scale, in_zero_point, inv_out_scale, out_zero_point);
+    float tmp = roundf(in[i] * scale + offset);
+    out[i] = std::max(std::min(tmp, max_val), min_val);
   }
 }
 
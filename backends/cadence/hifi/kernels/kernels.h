@@ -60,6 +60,18 @@ void dequantize(
     int32_t zero_point,
     size_t size);
 
+// Requantize an int8_t/uint8_t array to a uint8_t/int8_t array, without
+// going through an fp32 buffer.
+template <typename IT, typename OT>
+void requantize(
+    OT* __restrict__ out,
+    const IT* __restrict__ in,
+    float in_scale,
+    int32_t in_zero_point,
+    float inv_out_scale,
+    int32_t out_zero_point,
+    size_t size);
+
 }; // namespace kernels
 }; // namespace HiFi
 }; // namespace impl
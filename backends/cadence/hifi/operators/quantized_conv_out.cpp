@@ -62,7 +62,9 @@ __attribute__((noinline)) void conv2d_nchw_core_generic(
     const float* __restrict__ bias_scale = nullptr,
     float out_scale = 1,
     OT out_zero_point = 0,
-    bool per_tensor_quantized = true) {
+    bool per_tensor_quantized = true,
+    // Whether to apply a relu to the output, fused into the store
+    bool fused_relu = false) {
   float inv_out_scale = 1. / out_scale;
   bool zero_pad_unit_dilation = d0 == 1 && d1 == 1 && p0 == 0 && p1 == 0;
 
@@ -139,10 +141,15 @@ __attribute__((noinline)) void conv2d_nchw_core_generic(
               float val =
                   (per_tensor_quantized ? bias_scale[0] : bias_scale[_oc]) *
                   acc;
+              // 0 quantizes to out_zero_point, so this matches a quantized
+              // relu with the output's quantization parameters.
+              if (fused_relu) {
+                val = std::max(val, 0.f);
+              }
               out_plane[_oh * ow + _ow] =
                   kernels::quantize<OT>(val, inv_out_scale, out_zero_point);
             } else {
-              out_plane[_oh * ow + _ow] = acc;
+              out_plane[_oh * ow + _ow] = fused_relu ? std::max(acc, 0.f) : acc;
             }
           }
         }
@@ -151,12 +158,7 @@ __attribute__((noinline)) void conv2d_nchw_core_generic(
   }
 }
 
-// The quantized convolution kernel. in_scale and weight_scale are implicit in
-// bias_scale, since it is a product of the two. The kernel will branch to
-// quantized::conv1d or quantized::conv2d based on the dimensionality of
-// activation tensor.
-void quantized_conv_out(
-    RuntimeContext& ctx,
+void quantized_conv_impl(
     const Tensor& input,
     const Tensor& weight,
     const Tensor& bias,
@@ -169,9 +171,7 @@ void quantized_conv_out(
     const Tensor& bias_scale,
     double output_scale,
     int64_t output_zero_point,
-    const Tensor& out_multiplier,
-    const Tensor& out_shift,
-    bool channel_last,
+    bool fused_relu,
     Tensor& out) {
   bool conv1d = input.dim() == 3;
   // input = [n, c, h, w]
@@ -219,7 +219,84 @@ void quantized_conv_out(
       bias_scale.const_data_ptr<float>(),
       output_scale,
       (uint8_t)output_zero_point,
-      per_tensor_quantized);
+      per_tensor_quantized,
+      fused_relu);
+}
+
+// The quantized convolution kernel. in_scale and weight_scale are implicit in
+// bias_scale, since it is a product of the two. The kernel will branch to
+// quantized::conv1d or quantized::conv2d based on the dimensionality of
+// activation tensor.
+void quantized_conv_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    exec_aten::IntArrayRef stride,
+    exec_aten::IntArrayRef padding,
+    exec_aten::IntArrayRef dilation,
+    int64_t groups,
+    int64_t in_zero_point,
+    const Tensor& weight_zero_point,
+    const Tensor& bias_scale,
+    double output_scale,
+    int64_t output_zero_point,
+    const Tensor& out_multiplier,
+    const Tensor& out_shift,
+    bool channel_last,
+    Tensor& out) {
+  quantized_conv_impl(
+      input,
+      weight,
+      bias,
+      stride,
+      padding,
+      dilation,
+      groups,
+      in_zero_point,
+      weight_zero_point,
+      bias_scale,
+      output_scale,
+      output_zero_point,
+      /*fused_relu=*/false,
+      out);
+}
+
+// quantized_conv followed by quantized_relu, which clamps the output at
+// output_zero_point while it is stored instead of in a separate pass over it.
+void quantized_conv_relu_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    exec_aten::IntArrayRef stride,
+    exec_aten::IntArrayRef padding,
+    exec_aten::IntArrayRef dilation,
+    int64_t groups,
+    int64_t in_zero_point,
+    const Tensor& weight_zero_point,
+    const Tensor& bias_scale,
+    double output_scale,
+    int64_t output_zero_point,
+    const Tensor& out_multiplier,
+    const Tensor& out_shift,
+    bool channel_last,
+    Tensor& out) {
+  quantized_conv_impl(
+      input,
+      weight,
+      bias,
+      stride,
+      padding,
+      dilation,
+      groups,
+      in_zero_point,
+      weight_zero_point,
+      bias_scale,
+      output_scale,
+      output_zero_point,
+      /*fused_relu=*/true,
+      out);
 }
 
 }; // namespace native
@@ -13,19 +13,71 @@
 #include "NeuronLog.h"
 #include "api/NeuronAdapter.h"
 
+#include "executorch/runtime/backend/delegate_profiling.h"
 #include "executorch/runtime/core/error.h"
+#include "executorch/runtime/core/exec_aten/util/tensor_util.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <thread>
 #include <unordered_set>
 
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace torch {
 namespace executor {
 
 const char kHighAddrKey[] = "HighAddr";
 const char kImportForeverKey[] = "ImportForever";
+const char kAsyncModeKey[] = "AsyncMode";
+const char kExecutionPoolSizeKey[] = "ExecutionPoolSize";
+const char kCompilationCacheDirKey[] = "CompilationCacheDir";
+const char kCompilationCacheMaxSizeKey[] = "CompilationCacheMaxSizeMB";
+const char kPreferenceKey[] = "Preference";
+const char kPriorityKey[] = "Priority";
+const char kPrebuiltPreferencesKey[] = "PrebuiltPreferences";
+const char kCoreAffinityKey[] = "CoreAffinity";
+const char kExecutionStreamKey[] = "ExecutionStream";
+
+namespace neuron {
+// Replace the settings parsed from the compile specs with the overrides.
+void ApplyDelegateSettingOverrides(NeuronDelegateSetting& setting);
+} // namespace neuron
+
+namespace {
+
+// Hand the whole pages of the payload back to the kernel. The payload segment may not be freed
+// by the FreeableBuffer, e.g. when the program comes from a buffer the application mapped. The
+// pages are paged out rather than discarded with MADV_DONTNEED, which would zero anonymous
+// memory that the application may still read.
+void PageOutPayload(const void* data, size_t size) {
+#ifdef MADV_PAGEOUT
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (data == nullptr || pageSize <= 0) {
+        return;
+    }
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    const uintptr_t first = (begin + pageSize - 1) & ~uintptr_t(pageSize - 1);
+    const uintptr_t last = (begin + size) & ~uintptr_t(pageSize - 1);
+    if (first >= last) {
+        return;
+    }
+    if (madvise(reinterpret_cast<void*>(first), last - first, MADV_PAGEOUT) != 0) {
+        LogWarn("NeuronBackend", "madvise(MADV_PAGEOUT) of the payload failed, errno %d", errno);
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+} // namespace
 
 Result<DelegateHandle*> NeuronBackend::init(BackendInitContext& context,
                                             FreeableBuffer* processed,
@@ -38,10 +90,45 @@ Result<DelegateHandle*> NeuronBackend::init(BackendInitContext& context,
         } else if (std::strcmp(compile_spec.key, kImportForeverKey) == 0) {
             setting.mImportForever = *static_cast<char*>(compile_spec.value.buffer);
             LogInfo("NeuronBackend", "IsImportForever Enable : %d", setting.mImportForever);
+        } else if (std::strcmp(compile_spec.key, kAsyncModeKey) == 0) {
+            setting.mAsyncMode = *static_cast<char*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "IsAsyncMode Enable : %d", setting.mAsyncMode);
+        } else if (std::strcmp(compile_spec.key, kExecutionPoolSizeKey) == 0) {
+            setting.mExecutionPoolSize = *static_cast<uint32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "ExecutionPoolSize : %u", setting.mExecutionPoolSize);
+        } else if (std::strcmp(compile_spec.key, kCompilationCacheDirKey) == 0) {
+            auto dir = static_cast<const char*>(compile_spec.value.buffer);
+            setting.mCompilationCacheDir = std::string(dir, strnlen(dir, compile_spec.value.nbytes));
+            LogInfo("NeuronBackend", "CompilationCacheDir : %s", setting.mCompilationCacheDir.c_str());
+        } else if (std::strcmp(compile_spec.key, kCompilationCacheMaxSizeKey) == 0) {
+            setting.mCompilationCacheMaxSizeMb = *static_cast<uint32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "CompilationCacheMaxSizeMB : %u", setting.mCompilationCacheMaxSizeMb);
+        } else if (std::strcmp(compile_spec.key, kPreferenceKey) == 0) {
+            setting.mDefaultPreference.mPreference = *static_cast<int32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "Preference : %d", setting.mDefaultPreference.mPreference);
+        } else if (std::strcmp(compile_spec.key, kPriorityKey) == 0) {
+            setting.mDefaultPreference.mPriority = *static_cast<int32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "Priority : %d", setting.mDefaultPreference.mPriority);
+        } else if (std::strcmp(compile_spec.key, kPrebuiltPreferencesKey) == 0) {
+            // (preference, priority) pairs of int32.
+            auto values = static_cast<const int32_t*>(compile_spec.value.buffer);
+            const size_t count = compile_spec.value.nbytes / (2 * sizeof(int32_t));
+            for (size_t i = 0; i < count; i++) {
+                setting.mPrebuiltPreferences.push_back({values[2 * i], values[2 * i + 1]});
+                LogInfo("NeuronBackend", "PrebuiltPreference : %d, priority %d",
+                        values[2 * i], values[2 * i + 1]);
+            }
+        } else if (std::strcmp(compile_spec.key, kCoreAffinityKey) == 0) {
+            setting.mCoreAffinity = *static_cast<uint32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "CoreAffinity : 0x%x", setting.mCoreAffinity);
+        } else if (std::strcmp(compile_spec.key, kExecutionStreamKey) == 0) {
+            setting.mExecutionStream = *static_cast<uint32_t*>(compile_spec.value.buffer);
+            LogInfo("NeuronBackend", "ExecutionStream : %u", setting.mExecutionStream);
         } else {
             LogWarn("NeuronBackend", "unknown compile spec: %s", compile_spec.key);
         }
     }
+    neuron::ApplyDelegateSettingOverrides(setting);
     auto Payload = NeuronPayload(processed->data(), processed->size());
     LogInfo("NeuronBackend", "version %u, input %u, output %u, length %u, payload size: %zu",
                  Payload.Header.Version, Payload.Header.InputCount, Payload.Header.OutputCount, Payload.Header.DataLen, processed->size());
@@ -51,7 +138,13 @@ Result<DelegateHandle*> NeuronBackend::init(BackendInitContext& context,
     if (delegate == nullptr) {
         return nullptr;
     }
+    DelegateProfilingScope compileProfiling(context.event_tracer(), DelegateProfilingEventType::kCompile);
     auto res = delegate->LoadCompiledNetwork(Payload, setting);
+    // NeuronModel_setOperandValue only references the networks, and NeuronCompilation_finish
+    // copies them into the compilation. Every compilation is finished and the shared weights are
+    // imported, so the payload is not needed anymore; the models must not be compiled again.
+    PageOutPayload(processed->data(), processed->size());
+    processed->Free();
     return res == NEURON_NO_ERROR ? delegate.release() : nullptr;
 }
 
@@ -71,29 +164,501 @@ bool NeuronBackend::is_available() const {
     return true;
 }
 
+int NeuronAsyncTracker::Submit(const neuron::NeuronExecutor& executor, uint32_t stream) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const NeuronEvent* dependency = nullptr;
+    for (auto pending = mPending.rbegin(); pending != mPending.rend(); pending++) {
+        if (pending->mStream == stream) {
+            dependency = pending->mExecutor->GetEvent();
+            break;
+        }
+    }
+    // The execution is in flight until it is waited for.
+    PerformanceGovernor::GetInstance().Begin();
+    auto res = executor.ComputeAsync(&dependency, dependency == nullptr ? 0 : 1);
+    if (res != NEURON_NO_ERROR) {
+        PerformanceGovernor::GetInstance().End();
+        return res;
+    }
+    mPending.push_back({&executor, stream});
+    return NEURON_NO_ERROR;
+}
+
+int NeuronAsyncTracker::Wait(const neuron::NeuronExecutor& executor) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = std::find_if(mPending.begin(), mPending.end(),
+                           [&executor](const Pending& pending) {
+                               return pending.mExecutor == &executor;
+                           });
+    if (it == mPending.end()) {
+        return NEURON_NO_ERROR;
+    }
+    // The executions of a stream complete in submission order, so retire the earlier ones of the
+    // stream as well. Those of the other streams may still be running.
+    const uint32_t stream = it->mStream;
+    int res = NEURON_NO_ERROR;
+    auto kept = mPending.begin();
+    for (auto pending = mPending.begin(); pending != std::next(it); pending++) {
+        if (pending->mStream != stream) {
+            *kept++ = *pending;
+            continue;
+        }
+        auto err = pending->mExecutor->Wait();
+        PerformanceGovernor::GetInstance().End();
+        res = (res == NEURON_NO_ERROR) ? err : res;
+    }
+    mPending.erase(kept, std::next(it));
+    return res;
+}
+
+int NeuronAsyncTracker::WaitAll() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    int res = NEURON_NO_ERROR;
+    for (const auto& pending : mPending) {
+        auto err = pending.mExecutor->Wait();
+        PerformanceGovernor::GetInstance().End();
+        res = (res == NEURON_NO_ERROR) ? err : res;
+    }
+    mPending.clear();
+    return res;
+}
+
+namespace neuron {
+
+Error WaitForAsyncExecutions() {
+    return NeuronAsyncTracker::GetInstance().WaitAll() == NEURON_NO_ERROR
+        ? Error::Ok : Error::InvalidState;
+}
+
+namespace {
+thread_local ExecutionOptions tExecutionOptions;
+} // namespace
+
+void SetExecutionOptions(const ExecutionOptions& options) {
+    tExecutionOptions = options;
+}
+
+const ExecutionOptions& GetExecutionOptions() {
+    return tExecutionOptions;
+}
+
+void SetPerformanceLockOptions(const PerformanceLockOptions& options) {
+    PerformanceGovernor::GetInstance().SetOptions(options);
+}
+
+PerformanceLockOptions GetPerformanceLockOptions() {
+    return PerformanceGovernor::GetInstance().GetOptions();
+}
+
+namespace {
+std::mutex gOverridesMutex;
+DelegateSettingOverrides gOverrides;
+} // namespace
+
+void SetDelegateSettingOverrides(const DelegateSettingOverrides& overrides) {
+    std::lock_guard<std::mutex> lock(gOverridesMutex);
+    gOverrides = overrides;
+}
+
+void ApplyDelegateSettingOverrides(NeuronDelegateSetting& setting) {
+    std::lock_guard<std::mutex> lock(gOverridesMutex);
+    if (gOverrides.mHighAddr) {
+        setting.mHighAddr = *gOverrides.mHighAddr;
+        LogInfo("NeuronBackend", "IsHighAddr overridden : %d", setting.mHighAddr);
+    }
+    if (gOverrides.mImportForever) {
+        setting.mImportForever = *gOverrides.mImportForever;
+        LogInfo("NeuronBackend", "IsImportForever overridden : %d", setting.mImportForever);
+    }
+}
+
+} // namespace neuron
+
+namespace {
+// Shortest lock taken when an execution begins, so that it covers the execution even when the
+// hold time is shorter.
+constexpr uint32_t kMinExecutionLockMs = 2000;
+} // namespace
+
+PerformanceGovernor::~PerformanceGovernor() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ReleaseLocked();
+}
+
+void PerformanceGovernor::Begin() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mInFlight++;
+    if (mOptions.mEnabled) {
+        AcquireLocked(std::max(mOptions.mHoldTimeMs, kMinExecutionLockMs));
+    }
+}
+
+void PerformanceGovernor::End() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mInFlight == 0 || --mInFlight > 0 || !mOptions.mEnabled) {
+        return;
+    }
+    if (mOptions.mHoldTimeMs == 0) {
+        ReleaseLocked();
+    } else {
+        AcquireLocked(mOptions.mHoldTimeMs);
+    }
+}
+
+void PerformanceGovernor::SetOptions(const neuron::PerformanceLockOptions& options) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // A lock of the previous mode must not outlive the change, the next execution takes a new one.
+    if (!options.mEnabled || options.mMode != mOptions.mMode) {
+        ReleaseLocked();
+    }
+    mOptions = options;
+}
+
+neuron::PerformanceLockOptions PerformanceGovernor::GetOptions() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOptions;
+}
+
+void PerformanceGovernor::AcquireLocked(uint32_t ms) {
+    if (!mLib.mEnable) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::milliseconds(ms);
+    // Renewing takes a call to the power HAL, so back-to-back executions only renew the lock
+    // once half of it has elapsed.
+    if (mHalHandle != 0 && mExpiry - now >= duration / 2) {
+        return;
+    }
+    mHalHandle = mLib.acquirePerformanceLock(mHalHandle, mOptions.mMode, ms);
+    mExpiry = now + duration;
+}
+
+void PerformanceGovernor::ReleaseLocked() {
+    if (mHalHandle != 0) {
+        mLib.releasePerformanceLock(mHalHandle);
+        mHalHandle = 0;
+    }
+}
+
+int NeuronExecuTorchDelegate::LoadCompiledNetwork(NeuronPayload payload, NeuronDelegateSetting options) {
+    mSettings = options;
+    CHECK_TRUE(!payload.Networks.empty());
+    mInputCount = payload.Header.InputCount;
+    mOutputCount = payload.Header.OutputCount;
+    mNetworkCount = payload.Networks.size();
+    CHECK_NO_ERROR(LoadSharedInputs(payload));
+    auto runtimeOption = mSettings.ToRuntimeOption();
+    for (uint32_t network = 0; network < mNetworkCount; network++) {
+        CHECK_NO_ERROR(LoadVariant(payload, network, runtimeOption, mSettings.mDefaultPreference,
+                                   /*base=*/nullptr));
+        const auto base = mVariants.back().get();
+        for (const auto& preference : mSettings.mPrebuiltPreferences) {
+            if (preference == mSettings.mDefaultPreference) {
+                continue;
+            }
+            CHECK_NO_ERROR(LoadVariant(payload, network, runtimeOption, preference, base));
+        }
+    }
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecuTorchDelegate::LoadSharedInputs(const NeuronPayload& payload) {
+    mNetworkInputCount = mInputCount + payload.SharedInputs.size();
+    std::vector<bool> isShared(mNetworkInputCount, false);
+    for (const auto& input : payload.SharedInputs) {
+        CHECK_TRUE(input.InputIndex < mNetworkInputCount && !isShared[input.InputIndex]);
+        auto unit = neuron::SharedWeights::GetInstance().Acquire(input.Name, input.Data,
+                                                                 input.Length);
+        CHECK_VALID_PTR(unit);
+        // The size is only known to the payload carrying the data.
+        const size_t size = input.Length != 0 ? input.Length : unit->GetSize();
+        mSharedInputs.push_back({input.InputIndex, input.Name, unit, size});
+        isShared[input.InputIndex] = true;
+    }
+    for (uint32_t i = 0; i < mNetworkInputCount; i++) {
+        if (!isShared[i]) {
+            mInputIndexes.push_back(i);
+        }
+    }
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecuTorchDelegate::LoadVariant(const NeuronPayload& payload, uint32_t network,
+                                          std::string& runtimeOption,
+                                          const neuron::CompilationPreference& preference,
+                                          const CompilationVariant* base) {
+    auto variant = std::unique_ptr<CompilationVariant>(new (std::nothrow) CompilationVariant);
+    CHECK_VALID_PTR(variant);
+    variant->mNetwork = network;
+    variant->mPreference = preference;
+    const uint32_t poolSize = std::max<uint32_t>(mSettings.mExecutionPoolSize, 1);
+    for (uint32_t i = 0; i < poolSize; i++) {
+        auto execution = std::unique_ptr<ExecutionContext>(new (std::nothrow) ExecutionContext);
+        CHECK_VALID_PTR(execution);
+        auto& executor = execution->mExecutor;
+        int res = NEURON_NO_ERROR;
+        if (i > 0) {
+            res = executor.LoadFromExecutor(variant->mExecutions.front()->mExecutor);
+        } else if (base == nullptr) {
+            res = LoadExecutor(executor, payload, payload.Networks[network], runtimeOption);
+        } else {
+            res = executor.LoadFromExecutor(base->mExecutions.front()->mExecutor,
+                                            runtimeOption, preference);
+        }
+        CHECK_NO_ERROR(res);
+        CHECK_TRUE(executor.IsValid());
+        CHECK_NO_ERROR(BindSharedInputs(executor));
+        variant->mExecutions.push_back(std::move(execution));
+    }
+    variant->mFreeList.Reset(poolSize);
+    SummaryIoCounts(*variant);
+    CHECK_TRUE(variant->mInputSizes.size() == mNetworkInputCount);
+    CHECK_TRUE(variant->mOutputSizes.size() == mOutputCount);
+    mVariants.push_back(std::move(variant));
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecuTorchDelegate::BindSharedInputs(neuron::NeuronExecutor& executor) const {
+    for (const auto& input : mSharedInputs) {
+        CHECK_NO_ERROR(executor.SetInputOutputFromMemory</*isInput*/true>(
+            input.mIndex, input.mUnit->GetNeuronMemory(), input.mUnit->GetOffset(),
+            input.mSize));
+    }
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecuTorchDelegate::LoadExecutor(neuron::NeuronExecutor& executor,
+                                           const NeuronPayload& payload,
+                                           const NeuronPayload::Network& network,
+                                           std::string& runtimeOption) {
+    const auto& preference = mSettings.mDefaultPreference;
+    const neuron::CompilationCache cache(
+        mSettings.mCompilationCacheDir, size_t(mSettings.mCompilationCacheMaxSizeMb) << 20);
+    if (!cache.IsEnabled()) {
+        return executor.LoadFromCompiledNetwork(network.Data, network.Length,
+                                                mNetworkInputCount,
+                                                payload.Header.OutputCount, runtimeOption,
+                                                preference);
+    }
+
+    const auto key = cache.GetKey(network.Data, network.Length,
+                                  runtimeOption + " --preference " +
+                                  std::to_string(preference.mPreference) + " --priority " +
+                                  std::to_string(preference.mPriority));
+    std::vector<uint8_t> finishedNetwork;
+    if (cache.Load(key, finishedNetwork)) {
+        if (executor.LoadFromFinishedNetwork(finishedNetwork.data(), finishedNetwork.size())
+                == NEURON_NO_ERROR) {
+            return NEURON_NO_ERROR;
+        }
+        // Stale or corrupted entry, e.g. after a driver update. Recompile and replace it.
+        LogWarn("NeuronBackend", "Failed to restore compilation cache entry %s", key.c_str());
+        cache.Remove(key);
+        finishedNetwork.clear();
+    }
+
+    auto res = executor.LoadFromCompiledNetwork(network.Data, network.Length,
+                                                mNetworkInputCount,
+                                                payload.Header.OutputCount, runtimeOption,
+                                                preference, &finishedNetwork);
+    CHECK_NO_ERROR(res);
+    // A failure to populate the cache only costs the next cold start.
+    cache.Store(key, finishedNetwork);
+    return NEURON_NO_ERROR;
+}
+
+uint32_t NeuronExecuTorchDelegate::SelectNetwork(EValue** args) const {
+    if (mNetworkCount == 1) {
+        return 0;
+    }
+    const CompilationVariant* selected = nullptr;
+    size_t selectedSize = SIZE_MAX;
+    for (const auto& variant : mVariants) {
+        // Every network has exactly one variant with the default preference.
+        if (!(variant->mPreference == mSettings.mDefaultPreference)) {
+            continue;
+        }
+        bool fits = true;
+        size_t totalSize = 0;
+        for (size_t i = 0; i < mInputCount && fits; i++) {
+            const auto size = variant->mInputSizes[mInputIndexes[i]];
+            fits = args[i]->toTensor().nbytes() <= size;
+            totalSize += size;
+        }
+        if (fits && totalSize < selectedSize) {
+            selected = variant.get();
+            selectedSize = totalSize;
+        }
+    }
+    if (selected == nullptr) {
+        LogWarn("NeuronBackend", "No compiled network fits the input shapes, using network 0");
+        return 0;
+    }
+    return selected->mNetwork;
+}
+
+NeuronExecuTorchDelegate::CompilationVariant& NeuronExecuTorchDelegate::SelectVariant(
+        uint32_t network, const neuron::ExecutionOptions& options) const {
+    neuron::CompilationPreference preference = mSettings.mDefaultPreference;
+    if (options.mPreference != neuron::ExecutionOptions::kDefault) {
+        preference.mPreference = options.mPreference;
+    }
+    if (options.mPriority != neuron::ExecutionOptions::kDefault) {
+        preference.mPriority = options.mPriority;
+    }
+    CompilationVariant* defaultVariant = nullptr;
+    for (auto& variant : mVariants) {
+        if (variant->mNetwork != network) {
+            continue;
+        }
+        if (variant->mPreference == preference) {
+            return *variant;
+        }
+        if (defaultVariant == nullptr) {
+            defaultVariant = variant.get();
+        }
+    }
+    LogWarn("NeuronBackend", "Preference %d priority %d is not pre-built, using the default",
+            preference.mPreference, preference.mPriority);
+    return *defaultVariant;
+}
+
+Error NeuronExecuTorchDelegate::ResizeOutputs(const CompilationVariant& variant,
+                                              EValue** args) const {
+    const auto& executor = variant.mExecutions.front()->mExecutor;
+    for (size_t o = 0; o < mOutputCount; o++) {
+        auto tensor = args[mInputCount + o]->toTensor();
+        if (tensor.nbytes() == variant.mOutputSizes[o]) {
+            continue;
+        }
+        std::vector<uint32_t> dims(tensor.dim());
+        if (executor.GetOutputPaddedDimensions(o, dims.data()) != NEURON_NO_ERROR) {
+            return Error::InvalidState;
+        }
+        std::vector<exec_aten::SizesType> sizes(dims.begin(), dims.end());
+        auto err = resize_tensor(tensor, {sizes.data(), sizes.size()});
+        if (err != Error::Ok) {
+            LogError("NeuronBackend", "Failed to resize output %zu for network %u", o,
+                     variant.mNetwork);
+            return err;
+        }
+    }
+    return Error::Ok;
+}
+
+uint32_t NeuronExecuTorchDelegate::AcquireExecution(CompilationVariant& variant) const {
+    uint32_t index = 0;
+    while (!variant.mFreeList.Pop(index)) {
+        std::this_thread::yield();
+    }
+    return index;
+}
+
+void NeuronExecuTorchDelegate::ReleaseExecution(CompilationVariant& variant,
+                                                uint32_t index) const {
+    variant.mFreeList.Push(index);
+}
+
+NeuronExecuTorchDelegate::ExecutionContext* NeuronExecuTorchDelegate::GetBindingSetExecution(
+        CompilationVariant& variant, uint32_t bindingSet) const {
+    std::lock_guard<std::mutex> lock(variant.mBindingSetMutex);
+    if (bindingSet >= variant.mBindingSets.size()) {
+        variant.mBindingSets.resize(bindingSet + 1);
+    }
+    auto& execution = variant.mBindingSets[bindingSet];
+    if (execution) {
+        return execution.get();
+    }
+    auto newExecution = std::unique_ptr<ExecutionContext>(new (std::nothrow) ExecutionContext);
+    if (newExecution == nullptr) {
+        return nullptr;
+    }
+    auto& executor = newExecution->mExecutor;
+    if (executor.LoadFromExecutor(variant.mExecutions.front()->mExecutor) != NEURON_NO_ERROR
+            || !executor.IsValid() || BindSharedInputs(executor) != NEURON_NO_ERROR) {
+        LogError("NeuronBackend", "Failed to create the execution of binding set %u", bindingSet);
+        return nullptr;
+    }
+    LogInfo("NeuronBackend", "Network %u: created the execution of binding set %u",
+            variant.mNetwork, bindingSet);
+    execution = std::move(newExecution);
+    return execution.get();
+}
+
 Error NeuronExecuTorchDelegate::execute(
-      __ET_UNUSED BackendExecutionContext& context,
+      BackendExecutionContext& context,
       EValue** args) const {
-    if (HintNeuronBackend(args) != NEURON_NO_ERROR) {
+    const auto& options = neuron::GetExecutionOptions();
+    if (std::chrono::steady_clock::now() > options.mDeadline) {
+        LogWarn("NeuronBackend", "Execution deadline exceeded, skipping the execution");
+        return Error::InvalidState;
+    }
+    auto& variant = SelectVariant(SelectNetwork(args), options);
+    if (mNetworkCount > 1) {
+        ET_CHECK_OK_OR_RETURN_ERROR(ResizeOutputs(variant, args));
+    }
+    if (options.mBindingSet >= 0) {
+        auto execution = GetBindingSetExecution(variant, options.mBindingSet);
+        if (execution == nullptr) {
+            return Error::InvalidState;
+        }
+        std::lock_guard<std::mutex> lock(execution->mMutex);
+        return execute(*execution, options, context.event_tracer(), args);
+    }
+    const auto index = AcquireExecution(variant);
+    auto status = execute(*variant.mExecutions[index], options, context.event_tracer(), args);
+    ReleaseExecution(variant, index);
+    return status;
+}
+
+Error NeuronExecuTorchDelegate::execute(ExecutionContext& execution,
+                                        const neuron::ExecutionOptions& options,
+                                        EventTracer* eventTracer, EValue** args) const {
+    auto& executor = execution.mExecutor;
+    auto& cache = execution.mCache;
+    if (execution.mSubmitted) {
+        // The previous execution of the instance runs in the background until it is waited for
+        // here, so this covers its APU execution rather than the submission below.
+        DelegateProfilingScope profiling(eventTracer, DelegateProfilingEventType::kExecute);
+        // The execution instance and its bound buffers cannot change while it is running.
+        execution.mSubmitted = false;
+        if (NeuronAsyncTracker::GetInstance().Wait(executor) != NEURON_NO_ERROR) {
+            return Error::InvalidState;
+        }
+    }
+
+    // Host-side setup: memory import hints, boost hint and I/O binding.
+    auto bindProfiling = std::make_unique<DelegateProfilingScope>(
+        eventTracer, DelegateProfilingEventType::kDataTransfer);
+
+    if (HintNeuronBackend(execution, args) != NEURON_NO_ERROR) {
         return Error::InvalidState;
     };
 
+    if (options.mBoostHint != execution.mBoostHint && options.mBoostHint >= 0) {
+        if (executor.SetBoostHint(std::min<int32_t>(options.mBoostHint, 100)) != NEURON_NO_ERROR) {
+            return Error::InvalidState;
+        }
+        execution.mBoostHint = options.mBoostHint;
+    }
+
     auto& allocator = GET_NEURON_ALLOCATOR;
-    size_t inputCount = mInputSizes.size(), outputCount = mOutputSizes.size();
+    size_t inputCount = mInputCount, outputCount = mOutputCount;
 
     for (int i = 0; i < inputCount; i++) {
         auto data_ptr = args[i]->toTensor().data_ptr();
         auto data_size = args[i]->toTensor().nbytes();
-        if (IsCached</*isInput=*/true>(i, data_ptr)) {
+        if (cache.IsCached</*isInput=*/true>(i, data_ptr)) {
             continue;
         };
         auto unit = allocator.Find(data_ptr);
         if (unit) {
-            UpdateCache<true>(i, data_ptr);
-            size_t offset = (char*)data_ptr - (char*)unit->GetAddress();
-            mExecutor.SetInputOutputFromMemory</*isInput*/true>(i, unit->GetNeuronMemory(), offset, data_size);
+            cache.UpdateCache<true>(i, data_ptr);
+            size_t offset = unit->GetOffset() + ((char*)data_ptr - (char*)unit->GetAddress());
+            executor.SetInputOutputFromMemory</*isInput*/true>(mInputIndexes[i], unit->GetNeuronMemory(), offset, data_size);
         } else {
-            mExecutor.SetInputOutput</*isInput=*/true>(i, data_ptr, data_size);
+            executor.SetInputOutput</*isInput=*/true>(mInputIndexes[i], data_ptr, data_size);
         }
     }
 
@@ -101,47 +666,67 @@ Error NeuronExecuTorchDelegate::execute(
         auto data_ptr = args[o]->toTensor().data_ptr();
         auto data_size = args[o]->toTensor().nbytes();
         auto output_index = o - inputCount;
-        if (IsCached</*isInput=*/false>(output_index, data_ptr)) {
+        if (cache.IsCached</*isInput=*/false>(output_index, data_ptr)) {
             continue;
         };
         auto unit = allocator.Find(data_ptr);
         if (unit) {
-            UpdateCache</*isInput=*/false>(output_index, data_ptr);
-            size_t offset = (char*)data_ptr - (char*)unit->GetAddress();
-            mExecutor.SetInputOutputFromMemory</*isInput*/false>(output_index, unit->GetNeuronMemory(), offset, data_size);
+            cache.UpdateCache</*isInput=*/false>(output_index, data_ptr);
+            size_t offset = unit->GetOffset() + ((char*)data_ptr - (char*)unit->GetAddress());
+            executor.SetInputOutputFromMemory</*isInput*/false>(output_index, unit->GetNeuronMemory(), offset, data_size);
         } else {
-            mExecutor.SetInputOutput</*isInput=*/false>(output_index, data_ptr, data_size);
+            executor.SetInputOutput</*isInput=*/false>(output_index, data_ptr, data_size);
+        }
+    }
+
+    bindProfiling.reset();
+
+    if (mSettings.mAsyncMode || options.mAsync) {
+        if (NeuronAsyncTracker::GetInstance().Submit(executor, mSettings.mExecutionStream)
+                != NEURON_NO_ERROR) {
+            return Error::InvalidState;
         }
+        execution.mSubmitted = true;
+        return Error::Ok;
     }
 
-    return mExecutor.Compute() == NEURON_NO_ERROR ? Error::Ok : Error::InvalidState;
+    // NeuronAdapter does not report the APU time, so this covers the APU execution and the
+    // synchronization of the outputs back to the host.
+    DelegateProfilingScope profiling(eventTracer, DelegateProfilingEventType::kExecute);
+    auto& governor = PerformanceGovernor::GetInstance();
+    governor.Begin();
+    auto res = executor.Compute();
+    governor.End();
+    return res == NEURON_NO_ERROR ? Error::Ok : Error::InvalidState;
 };
 
-int NeuronExecuTorchDelegate::HintNeuronBackend(EValue** args) const {
-    auto HintImportForever = [this](EValue** args) -> int {
+int NeuronExecuTorchDelegate::HintNeuronBackend(ExecutionContext& execution, EValue** args) const {
+    auto HintImportForever = [this, &execution](EValue** args) -> int {
         auto& allocator = GET_NEURON_ALLOCATOR;
-        size_t inputCount = mInputSizes.size(), outputCount = mOutputSizes.size();
+        auto& executor = execution.mExecutor;
+        auto& hasImported = execution.mHasImported;
+        size_t inputCount = mInputCount, outputCount = mOutputCount;
         for (int i = 0; i < inputCount; i++) {
             auto data_ptr = args[i]->toTensor().data_ptr();
-            if (mHasImported.count(data_ptr)) {
+            if (hasImported.count(data_ptr)) {
                 continue;
             }
             auto unit = allocator.Find(data_ptr);
             if (unit) {
-                mExecutor.SetInputOutputFromMemory</*isInput*/true>(i, unit->GetNeuronMemory(), 0, unit->GetSize());
-                mHasImported.insert(data_ptr);
+                executor.SetInputOutputFromMemory</*isInput*/true>(mInputIndexes[i], unit->GetNeuronMemory(), unit->GetOffset(), unit->GetSize());
+                hasImported.insert(data_ptr);
             }
         }
         for (int o = inputCount; o < inputCount + outputCount; o++) {
             auto data_ptr = args[o]->toTensor().data_ptr();
-            if (mHasImported.count(data_ptr)) {
+            if (hasImported.count(data_ptr)) {
                 continue;
             }
             auto output_index = o - inputCount;
             auto unit = allocator.Find(data_ptr);
             if (unit) {
-                mExecutor.SetInputOutputFromMemory</*isInput*/false>(output_index, unit->GetNeuronMemory(), 0, unit->GetSize());
-                mHasImported.insert(data_ptr);
+                executor.SetInputOutputFromMemory</*isInput*/false>(output_index, unit->GetNeuronMemory(), unit->GetOffset(), unit->GetSize());
+                hasImported.insert(data_ptr);
             }
         }
         return NEURON_NO_ERROR;
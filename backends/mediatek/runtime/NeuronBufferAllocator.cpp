@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#include "NeuronBufferAllocator.h"
+#include "NeuronLog.h"
+
+#include <memory>
+#include <mutex>
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+const MemoryUnit* const MemoryUnitIndex::kAmbiguous =
+    reinterpret_cast<const MemoryUnit*>(uintptr_t(1));
+
+MemoryUnitIndex::~MemoryUnitIndex() {
+    for (auto& rootEntry : mRoot) {
+        auto node = rootEntry.load(std::memory_order_relaxed);
+        if (node == nullptr) {
+            continue;
+        }
+        for (auto& leaf : node->mLeaves) {
+            delete leaf.load(std::memory_order_relaxed);
+        }
+        delete node;
+    }
+}
+
+bool MemoryUnitIndex::ToGranule(const void* address, uintptr_t& granule) {
+    // Drop the top byte, which may hold a pointer tag on arm64.
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(address) & ((uintptr_t(1) << 56) - 1);
+    if (addr >> kAddressBits) {
+        return false;
+    }
+    granule = addr >> kGranuleBits;
+    return true;
+}
+
+std::atomic<const MemoryUnit*>* MemoryUnitIndex::GetOrCreateEntry(uintptr_t granule) {
+    auto& rootEntry = mRoot[granule >> (2 * kLevelBits)];
+    auto node = rootEntry.load(std::memory_order_acquire);
+    if (node == nullptr) {
+        node = new Node();
+        rootEntry.store(node, std::memory_order_release);
+    }
+    auto& nodeEntry = node->mLeaves[(granule >> kLevelBits) & (kLevelSize - 1)];
+    auto leaf = nodeEntry.load(std::memory_order_acquire);
+    if (leaf == nullptr) {
+        leaf = new Leaf();
+        nodeEntry.store(leaf, std::memory_order_release);
+    }
+    return &leaf->mUnits[granule & (kLevelSize - 1)];
+}
+
+void MemoryUnitIndex::Insert(const MemoryUnit* unit) {
+    uintptr_t first, last;
+    const auto start = static_cast<const char*>(unit->GetAddress());
+    if (unit->GetSize() == 0 || !ToGranule(start, first)
+            || !ToGranule(start + unit->GetSize() - 1, last)) {
+        return;
+    }
+    for (auto granule = first; granule <= last; granule++) {
+        auto entry = GetOrCreateEntry(granule);
+        auto current = entry->load(std::memory_order_relaxed);
+        entry->store(current == nullptr ? unit : kAmbiguous, std::memory_order_release);
+    }
+}
+
+void MemoryUnitIndex::Erase(const MemoryUnit* unit) {
+    uintptr_t first, last;
+    const auto start = static_cast<const char*>(unit->GetAddress());
+    if (unit->GetSize() == 0 || !ToGranule(start, first)
+            || !ToGranule(start + unit->GetSize() - 1, last)) {
+        return;
+    }
+    for (auto granule = first; granule <= last; granule++) {
+        auto entry = GetOrCreateEntry(granule);
+        // Ambiguous granules stay ambiguous, the slow path still resolves them correctly.
+        if (entry->load(std::memory_order_relaxed) == unit) {
+            entry->store(nullptr, std::memory_order_release);
+        }
+    }
+}
+
+const MemoryUnit* MemoryUnitIndex::Find(const void* address) const {
+    uintptr_t granule;
+    if (!ToGranule(address, granule)) {
+        return nullptr;
+    }
+    auto node = mRoot[granule >> (2 * kLevelBits)].load(std::memory_order_acquire);
+    if (node == nullptr) {
+        return nullptr;
+    }
+    auto leaf = node->mLeaves[(granule >> kLevelBits) & (kLevelSize - 1)].load(
+        std::memory_order_acquire);
+    if (leaf == nullptr) {
+        return nullptr;
+    }
+    return leaf->mUnits[granule & (kLevelSize - 1)].load(std::memory_order_acquire);
+}
+
+BufferAllocator& BufferAllocator::GetInstance() {
+    static BufferAllocator instance;
+    return instance;
+}
+
+void* BufferAllocator::Allocate(size_t size) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto unit = AllocateFromArena(size);
+    if (unit == nullptr) {
+        unit = MemoryUnit::Create(size);
+    }
+    if (unit == nullptr) {
+        LogError("NeuronBufferAllocator", "Failed to allocate buffer of size %zu", size);
+        return nullptr;
+    }
+    void* address = unit->GetAddress();
+    mIndex.Insert(unit.get());
+    mPool[address] = std::move(unit);
+    return address;
+}
+
+bool BufferAllocator::RemoveBuffer(void* address) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mPool.find(address);
+    if (it == mPool.end()) {
+        return false;
+    }
+    mIndex.Erase(it->second.get());
+    if (it->second->GetSlab() != nullptr) {
+        ReleaseToArena(it->second.get());
+    }
+    mPool.erase(it);
+    return true;
+}
+
+void BufferAllocator::EnableArena(size_t slabSize) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // Round up to the block granularity so that blocks never share an index granule.
+    mSlabSize = (slabSize + kMinBlockSize - 1) / kMinBlockSize * kMinBlockSize;
+    // Existing slabs keep serving their live blocks, but are no longer bumped into.
+    mSlabUsed = mSlabSize;
+}
+
+size_t BufferAllocator::GetSizeClass(size_t size) {
+    size_t sizeClass = 0;
+    while ((kMinBlockSize << sizeClass) < size) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+std::unique_ptr<MemoryUnit> BufferAllocator::AllocateFromArena(size_t size) {
+    if (mSlabSize == 0 || size == 0 || size > mSlabSize / 4) {
+        return nullptr;
+    }
+    const auto sizeClass = GetSizeClass(size);
+    const size_t blockSize = kMinBlockSize << sizeClass;
+    if (sizeClass >= mFreeBlocks.size()) {
+        mFreeBlocks.resize(sizeClass + 1);
+    }
+
+    // Recycle a freed block of the same class first.
+    auto& freeBlocks = mFreeBlocks[sizeClass];
+    if (!freeBlocks.empty()) {
+        const auto block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return MemoryUnit::CreateView(block.slab, block.offset, size);
+    }
+
+    if (mSlabs.empty() || mSlabUsed + blockSize > mSlabSize) {
+        auto slab = MemoryUnit::Create(mSlabSize);
+        if (slab == nullptr) {
+            return nullptr;
+        }
+        LogInfo("NeuronBufferAllocator", "Allocated arena slab %zu of size %zu", mSlabs.size(),
+                mSlabSize);
+        mSlabs.push_back(std::move(slab));
+        mSlabUsed = 0;
+    }
+    auto unit = MemoryUnit::CreateView(mSlabs.back().get(), mSlabUsed, size);
+    if (unit != nullptr) {
+        mSlabUsed += blockSize;
+    }
+    return unit;
+}
+
+void BufferAllocator::ReleaseToArena(const MemoryUnit* unit) {
+    const auto sizeClass = GetSizeClass(unit->GetSize());
+    if (sizeClass >= mFreeBlocks.size()) {
+        mFreeBlocks.resize(sizeClass + 1);
+    }
+    mFreeBlocks[sizeClass].push_back({unit->GetSlab(), unit->GetOffset()});
+}
+
+const MemoryUnit* BufferAllocator::Find(void* address) {
+    auto unit = mIndex.Find(address);
+    if (unit == MemoryUnitIndex::kAmbiguous) {
+        return FindLocked(address);
+    }
+    if (unit == nullptr) {
+        return nullptr;
+    }
+    // The granule may extend past the end of the unit.
+    auto offset = static_cast<char*>(address) - static_cast<char*>(unit->GetAddress());
+    return (offset >= 0 && size_t(offset) < unit->GetSize()) ? unit : nullptr;
+}
+
+const MemoryUnit* BufferAllocator::FindLocked(void* address) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& [base, unit] : mPool) {
+        auto offset = static_cast<char*>(address) - static_cast<char*>(base);
+        if (offset >= 0 && size_t(offset) < unit->GetSize()) {
+            return unit.get();
+        }
+    }
+    return nullptr;
+}
+
+void BufferAllocator::Clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& [_, unit] : mPool) {
+        mIndex.Erase(unit.get());
+    }
+    mPool.clear();
+    mFreeBlocks.clear();
+    mSlabs.clear();
+    mSlabUsed = 0;
+}
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,186 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#include "NeuronCompilationCache.h"
+#include "NeuronLog.h"
+#include "api/NeuronAdapter.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+namespace {
+
+constexpr char kEntryExtension[] = ".nbc";
+
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+// FNV-1a over 8-byte words, then over the remaining tail bytes. Word-wise hashing keeps the
+// key computation cheap for payloads of several hundred megabytes.
+uint64_t Hash(uint64_t hash, const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * kFnvPrime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+std::mutex CompilationCache::sMutex;
+
+CompilationCache::CompilationCache(const std::string& cacheDir, size_t maxSizeBytes)
+    : mCacheDir(cacheDir), mMaxSizeBytes(maxSizeBytes) {
+    if (mCacheDir.empty()) {
+        return;
+    }
+    std::error_code ec;
+    fs::create_directories(mCacheDir, ec);
+    if (ec) {
+        LogWarn("NeuronBackend", "Unable to create compilation cache dir %s: %s",
+                mCacheDir.c_str(), ec.message().c_str());
+    }
+}
+
+std::string CompilationCache::GetKey(const void* payload, size_t size,
+                                     const std::string& runtimeOption) const {
+    NeuronRuntimeVersion version{};
+    Neuron_getVersion(&version);
+
+    uint64_t hash = kFnvOffsetBasis;
+    hash = Hash(hash, &version, sizeof(version));
+    hash = Hash(hash, runtimeOption.data(), runtimeOption.size());
+    hash = Hash(hash, payload, size);
+
+    char key[64];
+    std::snprintf(key, sizeof(key), "%016" PRIx64 "_%zx", hash, size);
+    return key;
+}
+
+std::string CompilationCache::GetEntryPath(const std::string& key) const {
+    return (fs::path(mCacheDir) / (key + kEntryExtension)).string();
+}
+
+bool CompilationCache::Load(const std::string& key, std::vector<uint8_t>& compiledNetwork) const {
+    std::lock_guard<std::mutex> lock(sMutex);
+    const auto path = GetEntryPath(key);
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec || size == 0) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    compiledNetwork.resize(size);
+    file.read(reinterpret_cast<char*>(compiledNetwork.data()), size);
+    if (file.gcount() != static_cast<std::streamsize>(size)) {
+        LogWarn("NeuronBackend", "Truncated compilation cache entry %s", path.c_str());
+        compiledNetwork.clear();
+        return false;
+    }
+    // Refresh the timestamp that the LRU eviction is based on.
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    LogInfo("NeuronBackend", "Compilation cache hit: %s", path.c_str());
+    return true;
+}
+
+int CompilationCache::Store(const std::string& key,
+                            const std::vector<uint8_t>& compiledNetwork) const {
+    std::lock_guard<std::mutex> lock(sMutex);
+    const auto path = GetEntryPath(key);
+    // Write to a temporary file first so that a crash never leaves a partial entry behind.
+    const auto tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LogWarn("NeuronBackend", "Unable to write compilation cache entry %s", path.c_str());
+            return NEURON_BAD_STATE;
+        }
+        file.write(reinterpret_cast<const char*>(compiledNetwork.data()), compiledNetwork.size());
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+            return NEURON_BAD_STATE;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return NEURON_BAD_STATE;
+    }
+    LogInfo("NeuronBackend", "Compilation cache stored: %s (%zu bytes)", path.c_str(),
+            compiledNetwork.size());
+    Evict();
+    return NEURON_NO_ERROR;
+}
+
+void CompilationCache::Remove(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(sMutex);
+    std::error_code ec;
+    fs::remove(GetEntryPath(key), ec);
+}
+
+void CompilationCache::Evict() const {
+    if (mMaxSizeBytes == 0) {
+        return;
+    }
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t totalSize = 0;
+    std::error_code ec;
+    for (const auto& dirEntry : fs::directory_iterator(mCacheDir, ec)) {
+        if (!dirEntry.is_regular_file(ec) || dirEntry.path().extension() != kEntryExtension) {
+            continue;
+        }
+        Entry entry{dirEntry.path(), dirEntry.last_write_time(ec), dirEntry.file_size(ec)};
+        totalSize += entry.size;
+        entries.push_back(std::move(entry));
+    }
+    if (totalSize <= mMaxSizeBytes) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    // Never evict the most recent entry, which is the one just stored.
+    for (size_t i = 0; i + 1 < entries.size() && totalSize > mMaxSizeBytes; i++) {
+        if (fs::remove(entries[i].path, ec)) {
+            LogInfo("NeuronBackend", "Compilation cache evicted: %s",
+                    entries[i].path.string().c_str());
+            totalSize -= entries[i].size;
+        }
+    }
+}
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
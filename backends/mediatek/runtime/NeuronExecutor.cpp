@@ -24,7 +24,9 @@ namespace neuron {
 NeuronExecutor::NeuronExecutor() {};
 
 int NeuronExecutor::LoadFromCompiledNetwork(const void *buffer, size_t size,
-                                            int inputCount, int outputCount, std::string& runtimeOption) {
+                                            int inputCount, int outputCount, std::string& runtimeOption,
+                                            const CompilationPreference& preference,
+                                            std::vector<uint8_t>* finishedNetwork) {
     NeuronModel *model = nullptr;
     NeuronCompilation *compilation = nullptr;
     NeuronExecution *execution = nullptr;
@@ -36,7 +38,7 @@ int NeuronExecutor::LoadFromCompiledNetwork(const void *buffer, size_t size,
     err |= NeuronModel_create(&model);
     CHECK_NO_ERROR(err);
 
-    mModel = std::unique_ptr<NeuronModel, NeuronDeleter>(model);
+    mModel = std::shared_ptr<NeuronModel>(model, NeuronDeleter());
 
     std::vector<uint32_t> input_op_number;
     // fake input, the real outputs are loaded by compiled network.
@@ -132,16 +134,24 @@ int NeuronExecutor::LoadFromCompiledNetwork(const void *buffer, size_t size,
     CHECK_NO_ERROR(err);
 
     mCompilation =
-        std::unique_ptr<NeuronCompilation, NeuronDeleter>(compilation);
+        std::shared_ptr<NeuronCompilation>(compilation, NeuronDeleter());
 
-    err |=
-        NeuronCompilation_setPreference(compilation, NEURON_PREFER_TURBO_BOOST);
-    err |= NeuronCompilation_setPriority(compilation, NEURON_PRIORITY_HIGH);
+    err |= NeuronCompilation_setPreference(compilation, preference.mPreference);
+    err |= NeuronCompilation_setPriority(compilation, preference.mPriority);
     CHECK_NO_ERROR(err);
 
     err = NeuronCompilation_finish(compilation);
     CHECK_NO_ERROR(err);
 
+    // The finished network can only be stored before any execution is created.
+    if (finishedNetwork != nullptr) {
+        size_t networkSize = 0;
+        err = NeuronCompilation_getCompiledNetworkSize(compilation, &networkSize);
+        CHECK_NO_ERROR(err);
+        finishedNetwork->resize(networkSize);
+        err = NeuronCompilation_storeCompiledNetwork(compilation, finishedNetwork->data(), networkSize);
+        CHECK_NO_ERROR(err);
+    }
 
     // ---------------------------Execution------------------------------------
     // Create Neuron executor instance.
@@ -152,6 +162,61 @@ int NeuronExecutor::LoadFromCompiledNetwork(const void *buffer, size_t size,
     return NEURON_NO_ERROR;
 }
 
+int NeuronExecutor::LoadFromFinishedNetwork(const void *buffer, size_t size) {
+    NeuronModel *model = nullptr;
+    NeuronCompilation *compilation = nullptr;
+    NeuronExecution *execution = nullptr;
+
+    int err = NeuronModel_restoreFromCompiledNetwork(&model, &compilation, buffer, size);
+    CHECK_NO_ERROR(err);
+    mModel = std::shared_ptr<NeuronModel>(model, NeuronDeleter());
+    mCompilation = std::shared_ptr<NeuronCompilation>(compilation, NeuronDeleter());
+
+    err = NeuronExecution_create(compilation, &execution);
+    CHECK_NO_ERROR(err);
+    mExecution = std::unique_ptr<NeuronExecution, NeuronDeleter>(execution);
+
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecutor::LoadFromExecutor(const NeuronExecutor& other) {
+    CHECK_VALID_PTR(other.mCompilation);
+    mModel = other.mModel;
+    mCompilation = other.mCompilation;
+
+    NeuronExecution *execution = nullptr;
+    int err = NeuronExecution_create(mCompilation.get(), &execution);
+    CHECK_NO_ERROR(err);
+    mExecution = std::unique_ptr<NeuronExecution, NeuronDeleter>(execution);
+
+    return NEURON_NO_ERROR;
+}
+
+int NeuronExecutor::LoadFromExecutor(const NeuronExecutor& other, std::string& runtimeOption,
+                                     const CompilationPreference& preference) {
+    CHECK_VALID_PTR(other.mModel);
+    mModel = other.mModel;
+
+    NeuronCompilation *compilation = nullptr;
+    NeuronExecution *execution = nullptr;
+
+    int err = NeuronCompilation_createWithOptions(mModel.get(), &compilation, runtimeOption.c_str());
+    CHECK_NO_ERROR(err);
+    mCompilation = std::shared_ptr<NeuronCompilation>(compilation, NeuronDeleter());
+
+    err |= NeuronCompilation_setPreference(compilation, preference.mPreference);
+    err |= NeuronCompilation_setPriority(compilation, preference.mPriority);
+    CHECK_NO_ERROR(err);
+
+    err = NeuronCompilation_finish(compilation);
+    CHECK_NO_ERROR(err);
+
+    err = NeuronExecution_create(compilation, &execution);
+    CHECK_NO_ERROR(err);
+    mExecution = std::unique_ptr<NeuronExecution, NeuronDeleter>(execution);
+
+    return NEURON_NO_ERROR;
+}
 
 } // neuron
 } // executor
@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#include "NeuronMemoryAllocator.h"
+#include "NeuronLog.h"
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+void* NeuronMemoryAllocator::allocate(size_t size, size_t alignment) {
+    if (!isPowerOf2(alignment)) {
+        LogError("NeuronMemoryAllocator", "Alignment %zu is not a power of 2", alignment);
+        return nullptr;
+    }
+    // Shared buffers and arena blocks are page aligned. Allocate extra for larger alignments,
+    // the aligned pointer still resolves to the same MemoryUnit.
+    if (alignment > BufferAllocator::kMinBlockSize) {
+        size += alignment;
+    }
+    void* buffer = GET_NEURON_ALLOCATOR.Allocate(size);
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    mBuffers.push_back(buffer);
+    return alignPointer(buffer, alignment);
+}
+
+void NeuronMemoryAllocator::reset() {
+    for (auto buffer : mBuffers) {
+        GET_NEURON_ALLOCATOR.RemoveBuffer(buffer);
+    }
+    mBuffers.clear();
+}
+
+Result<std::unique_ptr<NeuronPlannedMemory>> NeuronPlannedMemory::Create(
+        const MethodMeta& methodMeta) {
+    std::unique_ptr<NeuronPlannedMemory> plannedMemory(new NeuronPlannedMemory());
+    const size_t count = methodMeta.num_memory_planned_buffers();
+    plannedMemory->mSpans.reserve(count);
+    for (size_t id = 0; id < count; id++) {
+        // .get() will always succeed because id < count.
+        const auto size = static_cast<size_t>(methodMeta.memory_planned_buffer_size(id).get());
+        auto buffer = static_cast<uint8_t*>(plannedMemory->mAllocator.allocate(size));
+        if (buffer == nullptr) {
+            LogError("NeuronMemoryAllocator", "Failed to allocate planned buffer %zu of size %zu",
+                     id, size);
+            return Error::MemoryAllocationFailed;
+        }
+        plannedMemory->mSpans.push_back({buffer, size});
+    }
+    plannedMemory->mPlannedMemory = std::make_unique<HierarchicalAllocator>(
+        Span<Span<uint8_t>>{plannedMemory->mSpans.data(), plannedMemory->mSpans.size()});
+    return plannedMemory;
+}
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#include "NeuronSharedWeights.h"
+#include "NeuronLog.h"
+
+#include <cstring>
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+SharedWeights& SharedWeights::GetInstance() {
+    static SharedWeights instance;
+    return instance;
+}
+
+const MemoryUnit* SharedWeights::Acquire(const std::string& name, const void* data,
+                                         size_t size) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& allocator = GET_NEURON_ALLOCATOR;
+    auto it = mSegments.find(name);
+    if (it == mSegments.end()) {
+        if (data == nullptr || size == 0) {
+            LogError("NeuronSharedWeights", "Shared weights %s are not loaded", name.c_str());
+            return nullptr;
+        }
+        void* buffer = allocator.Allocate(size);
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(buffer, data, size);
+        LogInfo("NeuronSharedWeights", "Imported shared weights %s (%zu bytes)", name.c_str(),
+                size);
+        it = mSegments.emplace(name, Segment{buffer, size, 0}).first;
+    } else if (size != 0 && size != it->second.mSize) {
+        LogError("NeuronSharedWeights", "Shared weights %s size mismatch: %zu vs %zu",
+                 name.c_str(), size, it->second.mSize);
+        return nullptr;
+    }
+    it->second.mRefCount++;
+    return allocator.Find(it->second.mBuffer);
+}
+
+void SharedWeights::Release(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mSegments.find(name);
+    if (it == mSegments.end()) {
+        return;
+    }
+    if (--it->second.mRefCount == 0) {
+        GET_NEURON_ALLOCATOR.RemoveBuffer(it->second.mBuffer);
+        mSegments.erase(it);
+    }
+}
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
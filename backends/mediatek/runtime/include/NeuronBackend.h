@@ -9,8 +9,10 @@
 #pragma once
 
 #include "NeuronBufferAllocator.h"
+#include "NeuronCompilationCache.h"
 #include "NeuronPayloadHeader.h"
 #include "NeuronExecutor.h"
+#include "NeuronSharedWeights.h"
 #include "NeuronLog.h"
 #include "api/NeuronAdapter.h"
 #include "api/APUWareUtilsLib.h"
@@ -19,9 +21,17 @@
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/evalue.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace torch {
 namespace executor {
@@ -45,26 +55,287 @@ class NeuronBackend final : public PyTorchBackendInterface {
 
 extern const char kHighAddrKey[];
 extern const char kImportForeverKey[];
+extern const char kAsyncModeKey[];
+extern const char kExecutionPoolSizeKey[];
+extern const char kCompilationCacheDirKey[];
+extern const char kCompilationCacheMaxSizeKey[];
+extern const char kPreferenceKey[];
+extern const char kPriorityKey[];
+extern const char kPrebuiltPreferencesKey[];
+extern const char kCoreAffinityKey[];
+extern const char kExecutionStreamKey[];
 
 struct NeuronDelegateSetting {
   bool mHighAddr = false;
 
   bool mImportForever = false;
 
+  // Return from execute() once the APU execution is scheduled instead of waiting for it.
+  bool mAsyncMode = false;
+
+  // Number of execution instances sharing the compilation, i.e. concurrent execute() calls.
+  uint32_t mExecutionPoolSize = 1;
+
+  // Directory of the on-disk compilation cache. Empty to disable the cache.
+  std::string mCompilationCacheDir;
+
+  // Size limit of the compilation cache in MB. The oldest entries are evicted over the limit.
+  // 0 means unlimited.
+  uint32_t mCompilationCacheMaxSizeMb = 0;
+
+  // Preference and priority of the executions that do not request any.
+  neuron::CompilationPreference mDefaultPreference;
+
+  // Additional compilations built at init, selectable per execution with
+  // neuron::ExecutionOptions.
+  std::vector<neuron::CompilationPreference> mPrebuiltPreferences;
+
+  // Bitmask of the APU cores the executions may run on, e.g. to give independent partitions of a
+  // program cores of their own. 0 keeps the core assignment of the compiled network.
+  uint32_t mCoreAffinity = 0;
+
+  // Asynchronous executions are only chained after the previous one of the same stream, so that
+  // independent partitions compiled with different streams run concurrently.
+  uint32_t mExecutionStream = 0;
+
   std::string ToRuntimeOption() {
-    if (mHighAddr && mImportForever) {
-      return "--apusys-config \"{ \\\"high_addr\\\": true, \\\"import_forever\\\": true }\"";
-    } else if (mHighAddr) {
-      return "--apusys-config \"{ \\\"high_addr\\\": true }\"";
-    } else if (mImportForever) {
-      return "--apusys-config \"{ \\\"import_forever\\\": true }\"";
-    } else {
-      return "";
+    std::string config;
+    auto addConfig = [&config](const std::string& entry) {
+      config += (config.empty() ? "" : ", ") + entry;
+    };
+    if (mHighAddr) {
+      addConfig("\\\"high_addr\\\": true");
+    }
+    if (mImportForever) {
+      addConfig("\\\"import_forever\\\": true");
+    }
+    if (mCoreAffinity != 0) {
+      addConfig("\\\"core_affinity\\\": " + std::to_string(mCoreAffinity));
     }
+    return config.empty() ? "" : "--apusys-config \"{ " + config + " }\"";
   }
 };
 
 
+// Keeps track of the asynchronous executions in flight. A new execution is chained after
+// the latest in-flight one, so consecutive Neuron delegates of a method run back-to-back on
+// the APU without the CPU waiting in between.
+class NeuronAsyncTracker {
+public:
+  static NeuronAsyncTracker& GetInstance() {
+    static NeuronAsyncTracker instance;
+    return instance;
+  }
+
+  // Schedule the executor after the latest in-flight execution of the stream.
+  int Submit(const neuron::NeuronExecutor& executor, uint32_t stream = 0);
+
+  // Wait for the given executor, and the executions submitted before it on its stream, and stop
+  // tracking them.
+  int Wait(const neuron::NeuronExecutor& executor);
+
+  // Wait for every in-flight execution.
+  int WaitAll();
+
+private:
+  NeuronAsyncTracker() {}
+
+  NeuronAsyncTracker(const NeuronAsyncTracker&) = delete;
+
+  NeuronAsyncTracker& operator=(const NeuronAsyncTracker&) = delete;
+
+private:
+  struct Pending {
+    const neuron::NeuronExecutor* mExecutor;
+
+    uint32_t mStream;
+  };
+
+  // In submission order.
+  std::vector<Pending> mPending;
+
+  std::mutex mMutex;
+};
+
+namespace neuron {
+
+// Block until all the asynchronous Neuron executions have completed. Must be called before
+// reading the outputs of a method whose Neuron delegates were compiled with kAsyncModeKey.
+Error WaitForAsyncExecutions();
+
+// Options of the Neuron executions issued by the calling thread, e.g. sustained speed for a
+// background worker while the interactive thread keeps turbo boost.
+struct ExecutionOptions {
+  static constexpr int32_t kDefault = -1;
+
+  // One of NEURON_PREFER_*, or kDefault for the preference the delegate was compiled with. Any
+  // other preference must be listed in kPrebuiltPreferencesKey, otherwise the default is used.
+  int32_t mPreference = kDefault;
+
+  // One of NEURON_PRIORITY_*, or kDefault. Selects a pre-built compilation like mPreference.
+  int32_t mPriority = kDefault;
+
+  // Device frequency hint between 0 and 100, or kDefault to leave it to the scheduler.
+  int32_t mBoostHint = kDefault;
+
+  // Executions issued after the deadline fail instead of running.
+  std::chrono::steady_clock::time_point mDeadline = std::chrono::steady_clock::time_point::max();
+
+  // Submit the executions asynchronously like kAsyncModeKey does, even for the delegates compiled
+  // without it. The caller must then WaitForAsyncExecutions() before reading the outputs.
+  bool mAsync = false;
+
+  // Any non-negative id to run on an execution instance dedicated to the binding set, e.g. one
+  // per KV cache set. The instance keeps the I/O bindings of the set while other sets execute, so
+  // alternating between buffer sets does not rebind them. kDefault shares the pool of instances.
+  // A binding set executes on one thread at a time.
+  int32_t mBindingSet = kDefault;
+};
+
+void SetExecutionOptions(const ExecutionOptions& options);
+
+const ExecutionOptions& GetExecutionOptions();
+
+// Apply the execution options to the calling thread until the end of the scope.
+class ScopedExecutionOptions {
+public:
+  explicit ScopedExecutionOptions(const ExecutionOptions& options)
+      : mPrevious(GetExecutionOptions()) {
+    SetExecutionOptions(options);
+  }
+
+  ~ScopedExecutionOptions() {
+    SetExecutionOptions(mPrevious);
+  }
+
+private:
+  const ExecutionOptions mPrevious;
+};
+
+// Performance lock of the APU, shared by the Neuron delegates of the process.
+struct PerformanceLockOptions {
+  // Acquire the lock while executions are in flight. Disable to leave the clocks to the system.
+  bool mEnabled = true;
+
+  PERFORMANCE_MODE_E mMode = FAST_SINGLE_ANSWER_MODE;
+
+  // How long the lock is kept after the last execution completes, so that the executions of a
+  // burst, e.g. the tokens of a generation, do not wait for the clocks to ramp up again. 0
+  // releases it as soon as the executions complete.
+  uint32_t mHoldTimeMs = 2000;
+};
+
+void SetPerformanceLockOptions(const PerformanceLockOptions& options);
+
+PerformanceLockOptions GetPerformanceLockOptions();
+
+// Settings that replace the compile specs of the delegates initialized afterwards, e.g. to compare
+// them on an exported model without exporting it again.
+struct DelegateSettingOverrides {
+  std::optional<bool> mHighAddr;
+
+  std::optional<bool> mImportForever;
+};
+
+void SetDelegateSettingOverrides(const DelegateSettingOverrides& overrides);
+
+} // namespace neuron
+
+// Holds the APU performance lock while Neuron executions are in flight, and for the hold time
+// after the last one. The lock is timed, so it expires by itself once the process goes idle and
+// no thread is needed to release it.
+class PerformanceGovernor {
+public:
+  static PerformanceGovernor& GetInstance() {
+    static PerformanceGovernor instance;
+    return instance;
+  }
+
+  // An execution is about to be issued.
+  void Begin();
+
+  // An execution issued after Begin() has completed or failed.
+  void End();
+
+  void SetOptions(const neuron::PerformanceLockOptions& options);
+
+  neuron::PerformanceLockOptions GetOptions();
+
+private:
+  PerformanceGovernor() : mLib(ApuWareUtilsLib::GetInstance()) {}
+
+  ~PerformanceGovernor();
+
+  PerformanceGovernor(const PerformanceGovernor&) = delete;
+
+  PerformanceGovernor& operator=(const PerformanceGovernor&) = delete;
+
+  // Extend the lock to last at least `ms` from now, unless it already lasts half of that.
+  void AcquireLocked(uint32_t ms);
+
+  void ReleaseLocked();
+
+private:
+  ApuWareUtilsLib& mLib;
+
+  neuron::PerformanceLockOptions mOptions;
+
+  uint32_t mInFlight = 0;
+
+  int32_t mHalHandle = 0;
+
+  std::chrono::steady_clock::time_point mExpiry;
+
+  std::mutex mMutex;
+};
+
+// Lock-free LIFO free-list of indexes in [0, size). The head packs a modification tag in its
+// upper 32 bits to protect against ABA.
+class IndexFreeList {
+public:
+  static constexpr uint32_t kEnd = UINT32_MAX;
+
+  void Reset(uint32_t size) {
+    mNext = std::unique_ptr<std::atomic<uint32_t>[]>(new std::atomic<uint32_t>[size]);
+    for (uint32_t i = 0; i < size; i++) {
+      mNext[i].store(i + 1 < size ? i + 1 : kEnd, std::memory_order_relaxed);
+    }
+    mHead.store(size > 0 ? 0 : kEnd, std::memory_order_release);
+  }
+
+  bool Pop(uint32_t& index) {
+    uint64_t head = mHead.load(std::memory_order_acquire);
+    while (true) {
+      const uint32_t top = static_cast<uint32_t>(head);
+      if (top == kEnd) {
+        return false;
+      }
+      const uint64_t next = mNext[top].load(std::memory_order_relaxed);
+      const uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+      if (mHead.compare_exchange_weak(head, newHead, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        index = top;
+        return true;
+      }
+    }
+  }
+
+  void Push(uint32_t index) {
+    uint64_t head = mHead.load(std::memory_order_relaxed);
+    uint64_t newHead = 0;
+    do {
+      mNext[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+      newHead = (((head >> 32) + 1) << 32) | index;
+    } while (!mHead.compare_exchange_weak(head, newHead, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+private:
+  std::atomic<uint64_t> mHead{kEnd};
+
+  std::unique_ptr<std::atomic<uint32_t>[]> mNext;
+};
+
 class NeuronExecuTorchDelegate {
 public:
   class MemoryCache {
@@ -72,92 +343,190 @@ public:
     template <bool isInput>
     bool IsCached(int i, void* ptr) {
       const auto& cache = isInput ? mInputCache : mOutputCache;
-      auto it = cache.find(i);
-      return (it != cache.end()) && (ptr == it->second);
+      return i < cache.size() && ptr == cache[i];
     }
 
     template <bool isInput>
     void UpdateCache(int i, void* ptr) {
-      (isInput ? mInputCache[i] : mOutputCache[i]) = ptr;
-      return;
+      auto& cache = isInput ? mInputCache : mOutputCache;
+      if (i >= cache.size()) {
+        cache.resize(i + 1, nullptr);
+      }
+      cache[i] = ptr;
     }
 
   private:
-    std::unordered_map<int, void*> mInputCache;
+    // Bound buffer per argument index, null if not bound from a Neuron buffer.
+    std::vector<void*> mInputCache;
+
+    std::vector<void*> mOutputCache;
+  };
+
+  // An execution instance with the I/O bindings it currently holds.
+  struct ExecutionContext {
+    neuron::NeuronExecutor mExecutor;
+
+    MemoryCache mCache;
+
+    std::unordered_set<const void*> mHasImported;
+
+    // Boost hint currently set on the execution.
+    int32_t mBoostHint = neuron::ExecutionOptions::kDefault;
+
+    // Submitted to NeuronAsyncTracker since the last time it was waited for.
+    bool mSubmitted = false;
+
+    // Held by the execute() call using the instance of a binding set.
+    std::mutex mMutex;
+  };
+
+  // The pool of execution instances of one compilation.
+  struct CompilationVariant {
+    // Index of the compiled network in the payload.
+    uint32_t mNetwork = 0;
+
+    neuron::CompilationPreference mPreference;
+
+    std::vector<size_t> mInputSizes;
+
+    std::vector<size_t> mOutputSizes;
+
+    std::vector<std::unique_ptr<ExecutionContext>> mExecutions;
+
+    IndexFreeList mFreeList;
 
-    std::unordered_map<int, void*> mOutputCache;
+    // The instances dedicated to binding sets, indexed by binding set and created on first use.
+    std::vector<std::unique_ptr<ExecutionContext>> mBindingSets;
+
+    std::mutex mBindingSetMutex;
   };
 
   NeuronExecuTorchDelegate() {}
 
   ~NeuronExecuTorchDelegate() {
-    mPLock->Stop();
+    for (auto& variant : mVariants) {
+      for (auto& execution : variant->mExecutions) {
+        if (execution->mSubmitted) {
+          NeuronAsyncTracker::GetInstance().Wait(execution->mExecutor);
+        }
+      }
+      for (auto& execution : variant->mBindingSets) {
+        if (execution && execution->mSubmitted) {
+          NeuronAsyncTracker::GetInstance().Wait(execution->mExecutor);
+        }
+      }
+    }
+    mVariants.clear();
+    for (const auto& input : mSharedInputs) {
+      neuron::SharedWeights::GetInstance().Release(input.mName);
+    }
   }
 
-  int LoadCompiledNetwork(NeuronPayload payload, NeuronDelegateSetting options) {
-    mSettings = options;
-    auto runtimeOption = mSettings.ToRuntimeOption();
-    auto res = mExecutor.LoadFromCompiledNetwork(payload.CompiledNetwork, payload.Header.DataLen,
-                                                 payload.Header.InputCount,
-                                                 payload.Header.OutputCount, runtimeOption);
-    CHECK_NO_ERROR(res);
-    CHECK_TRUE(mExecutor.IsValid());
-    SummaryIoCounts();
-    mPLock = std::unique_ptr<ScopePerformancer>(new ScopePerformancer);
-    return NEURON_NO_ERROR;
-  }
+  int LoadCompiledNetwork(NeuronPayload payload, NeuronDelegateSetting options);
 
   Error execute(
-      __ET_UNUSED BackendExecutionContext& context,
+      BackendExecutionContext& context,
       EValue** args) const;
 
 private:
-    template<bool isInput>
-    bool IsCached(int index, void* ptr) const {
-      return mCache.IsCached</*isInput=*/isInput>(index, ptr);
-    }
-
-    template<bool isInput>
-    void UpdateCache(int index, void* ptr) const {
-      mCache.UpdateCache<isInput>(index, ptr);
-    }
-
-    int SummaryIoCounts() {
+    int SummaryIoCounts(CompilationVariant& variant) {
+      const auto& executor = variant.mExecutions.front()->mExecutor;
       for (int i = 0;; i++) {
-        size_t size = mExecutor.GetInputOutputPaddedSize</*isInput*/ true>(i);
+        size_t size = executor.GetInputOutputPaddedSize</*isInput*/ true>(i);
         if (size == 0) {
           break;
         }
-        LogInfo("NeuronBackend", "Model input:%d size: %lu", i, size);
-        mInputSizes.push_back(size);
+        LogInfo("NeuronBackend", "Network %u input:%d size: %lu", variant.mNetwork, i, size);
+        variant.mInputSizes.push_back(size);
       }
       for (int o = 0;; o++) {
-        size_t size = mExecutor.GetInputOutputPaddedSize</*isInput*/ false>(o);
+        size_t size = executor.GetInputOutputPaddedSize</*isInput*/ false>(o);
         if (size == 0) {
           break;
         }
-        LogInfo("NeuronBackend", "Model output:%d size: %lu", o, size);
-        mOutputSizes.push_back(size);
+        LogInfo("NeuronBackend", "Network %u output:%d size: %lu", variant.mNetwork, o, size);
+        variant.mOutputSizes.push_back(size);
       }
       return NEURON_NO_ERROR;
     }
 
-    int HintNeuronBackend(EValue** args) const;
+    // Compile a network of the payload into the given executor, going through the compilation
+    // cache if enabled.
+    int LoadExecutor(neuron::NeuronExecutor& executor, const NeuronPayload& payload,
+                     const NeuronPayload::Network& network, std::string& runtimeOption);
+
+    // Take a reference on the shared weights of the payload and map the delegate arguments to
+    // the remaining network inputs.
+    int LoadSharedInputs(const NeuronPayload& payload);
+
+    // Build the execution pool of a compilation. Without a base variant the network is compiled
+    // from the payload, otherwise the model of the base variant is reused.
+    int LoadVariant(const NeuronPayload& payload, uint32_t network, std::string& runtimeOption,
+                    const neuron::CompilationPreference& preference,
+                    const CompilationVariant* base);
+
+    // The compiled network fitting the shapes of the inputs, i.e. the smallest one whose
+    // inputs are all large enough.
+    uint32_t SelectNetwork(EValue** args) const;
+
+    // The variant of the network matching the execution options of the calling thread.
+    CompilationVariant& SelectVariant(uint32_t network,
+                                      const neuron::ExecutionOptions& options) const;
+
+    // Resize the dynamic output tensors to the output shapes of the selected network.
+    Error ResizeOutputs(const CompilationVariant& variant, EValue** args) const;
+
+    // Take an idle execution context from the pool, waiting for one if all of them are busy.
+    uint32_t AcquireExecution(CompilationVariant& variant) const;
+
+    void ReleaseExecution(CompilationVariant& variant, uint32_t index) const;
+
+    // The execution instance of a binding set, created on the compilation of the variant the
+    // first time the set executes. Null if it could not be created.
+    ExecutionContext* GetBindingSetExecution(CompilationVariant& variant,
+                                             uint32_t bindingSet) const;
+
+    // Bind the shared weights to a new execution instance.
+    int BindSharedInputs(neuron::NeuronExecutor& executor) const;
+
+    Error execute(ExecutionContext& execution, const neuron::ExecutionOptions& options,
+                  EventTracer* eventTracer, EValue** args) const;
+
+    int HintNeuronBackend(ExecutionContext& execution, EValue** args) const;
 
 private:
-    std::vector<size_t> mInputSizes;
+    // Number of inputs in the delegate arguments.
+    size_t mInputCount = 0;
 
-    std::vector<size_t> mOutputSizes;
+    size_t mOutputCount = 0;
 
-    mutable MemoryCache mCache;
+    // Number of inputs of the compiled networks, including the shared weights.
+    size_t mNetworkInputCount = 0;
 
-    std::unique_ptr<ScopePerformancer> mPLock;
+    // Network input index of each input in the delegate arguments.
+    std::vector<uint32_t> mInputIndexes;
 
-    neuron::NeuronExecutor mExecutor;
+    struct SharedInput {
+      uint32_t mIndex;
 
-    NeuronDelegateSetting mSettings;
+      std::string mName;
+
+      const neuron::MemoryUnit* mUnit;
+
+      size_t mSize;
+    };
 
-    mutable std::unordered_set<const void*> mHasImported;
+    // Network inputs bound once to the shared weights.
+    std::vector<SharedInput> mSharedInputs;
+
+    // Number of compiled networks in the payload.
+    uint32_t mNetworkCount = 1;
+
+    // Per network, the default compilation first, then the pre-built ones. Each has its own
+    // pool of execution instances, handed out per execute() call.
+    std::vector<std::unique_ptr<CompilationVariant>> mVariants;
+
+    NeuronDelegateSetting mSettings;
 
 private:
     NeuronExecuTorchDelegate(const NeuronExecuTorchDelegate&);
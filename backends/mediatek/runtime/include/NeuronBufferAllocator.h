@@ -15,10 +15,13 @@
 
 #include <android/hardware_buffer.h>
 
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <new>
+#include <unordered_map>
+#include <vector>
 
 #define GET_NEURON_ALLOCATOR ::torch::executor::neuron::BufferAllocator::GetInstance()
 
@@ -42,6 +45,19 @@ public:
         return (obj && (obj->Allocate() == NEURON_NO_ERROR)) ? std::move(obj) : nullptr;
     }
 
+    // Create a unit referring to the range [offset, offset + size) of a slab unit. The view
+    // shares the slab's NeuronMemory and must not outlive it.
+    static std::unique_ptr<MemoryUnit> CreateView(const MemoryUnit* slab, size_t offset,
+                                                  size_t size) {
+        auto obj = std::unique_ptr<MemoryUnit>(new (std::nothrow) MemoryUnit(size));
+        if (obj) {
+            obj->mSlab = slab;
+            obj->mOffset = offset;
+            obj->mAddress = static_cast<char*>(slab->GetAddress()) + offset;
+        }
+        return obj;
+    }
+
     ~MemoryUnit() {
       mNeuronMemory.reset();
       mAhwb.reset();
@@ -51,7 +67,14 @@ public:
 
     void* GetAddress() const { return mAddress; }
 
-    NeuronMemory* GetNeuronMemory() const { return mNeuronMemory.get(); }
+    NeuronMemory* GetNeuronMemory() const {
+        return mSlab ? mSlab->GetNeuronMemory() : mNeuronMemory.get();
+    }
+
+    // Offset of GetAddress() in GetNeuronMemory(). Non-zero for views into a slab only.
+    size_t GetOffset() const { return mOffset; }
+
+    const MemoryUnit* GetSlab() const { return mSlab; }
 
 private:
     explicit MemoryUnit(size_t size) : mSize(size) {}
@@ -91,6 +114,54 @@ private:
     void* mAddress = nullptr;
 
     size_t mSize = 0;
+
+    // Set for views created by CreateView().
+    const MemoryUnit* mSlab = nullptr;
+
+    size_t mOffset = 0;
+};
+
+// Maps every 4KB granule of the registered buffers to its MemoryUnit with a three-level radix
+// table, so that interior pointers resolve in constant time. Lookups are lock-free; updates must
+// be serialized by the caller. Table nodes are only freed on destruction, so a concurrent lookup
+// never reads freed memory.
+class MemoryUnitIndex {
+public:
+    MemoryUnitIndex() = default;
+
+    ~MemoryUnitIndex();
+
+    void Insert(const MemoryUnit* unit);
+
+    void Erase(const MemoryUnit* unit);
+
+    // Returns the unit containing the address, or nullptr. Returns kAmbiguous if the granule
+    // is shared by more than one unit, in which case the caller has to resolve it by itself.
+    const MemoryUnit* Find(const void* address) const;
+
+    static const MemoryUnit* const kAmbiguous;
+
+private:
+    static constexpr int kGranuleBits = 12;
+    static constexpr int kLevelBits = 12;
+    static constexpr size_t kLevelSize = size_t(1) << kLevelBits;
+    static constexpr int kAddressBits = kGranuleBits + 3 * kLevelBits; // 48-bit user space
+
+    struct Leaf {
+        std::atomic<const MemoryUnit*> mUnits[kLevelSize];
+    };
+
+    struct Node {
+        std::atomic<Leaf*> mLeaves[kLevelSize];
+    };
+
+    // Get the leaf entry of the granule, creating the table nodes on demand.
+    std::atomic<const MemoryUnit*>* GetOrCreateEntry(uintptr_t granule);
+
+    static bool ToGranule(const void* address, uintptr_t& granule);
+
+private:
+    std::atomic<Node*> mRoot[kLevelSize] = {};
 };
 
 class BufferAllocator {
@@ -99,8 +170,14 @@ public:
 
     void* Allocate(size_t size);
 
+    // Serve allocations up to slabSize / 4 from shared slabs of slabSize bytes, rounded up to
+    // power-of-two size classes, instead of one AHardwareBuffer per allocation. Freed blocks
+    // are recycled within their size class. A slabSize of 0 disables the arena.
+    void EnableArena(size_t slabSize = kDefaultSlabSize);
+
     bool RemoveBuffer(void* address);
 
+    // Find the unit containing the address. Safe to call concurrently without locking.
     const MemoryUnit* Find(void* address);
 
     void Clear();
@@ -112,8 +189,42 @@ private:
 
     BufferAllocator& operator=(const BufferAllocator&) = delete;
 
+    // Slow path for granules shared by several units.
+    const MemoryUnit* FindLocked(void* address);
+
+    // Sub-allocate from the slabs, or return nullptr if the size is served by a dedicated buffer.
+    std::unique_ptr<MemoryUnit> AllocateFromArena(size_t size);
+
+    void ReleaseToArena(const MemoryUnit* unit);
+
+    static size_t GetSizeClass(size_t size);
+
+public:
+    static constexpr size_t kDefaultSlabSize = 64 * 1024 * 1024;
+
+    static constexpr size_t kMinBlockSize = 4096;
+
 private:
-    std::map<void*, std::unique_ptr<MemoryUnit>> mPool;
+    // Owns the units, keyed by their base address. Guarded by mMutex.
+    std::unordered_map<void*, std::unique_ptr<MemoryUnit>> mPool;
+
+    MemoryUnitIndex mIndex;
+
+    // Arena state, guarded by mMutex.
+    size_t mSlabSize = 0;
+
+    std::vector<std::unique_ptr<MemoryUnit>> mSlabs;
+
+    // Bump offset in the last slab.
+    size_t mSlabUsed = 0;
+
+    struct Block {
+        const MemoryUnit* slab;
+        size_t offset;
+    };
+
+    // Freed blocks of each size class, indexed by log2(class size / kMinBlockSize).
+    std::vector<std::vector<Block>> mFreeBlocks;
 
     std::mutex mMutex;
 };
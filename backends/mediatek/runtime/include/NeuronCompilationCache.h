@@ -0,0 +1,63 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#pragma once
+
+#include "api/NeuronAdapter.h"
+#include "NeuronLog.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+// On-disk cache of finished compilations. Each entry is the compiled network stored by
+// NeuronCompilation_storeCompiledNetwork, keyed by the DLA payload, the runtime options and
+// the Neuron runtime version. Entries are evicted least-recently-used first once the cache
+// directory grows over its size limit.
+class CompilationCache {
+public:
+    // A maxSizeBytes of 0 disables eviction.
+    CompilationCache(const std::string& cacheDir, size_t maxSizeBytes = 0);
+
+    bool IsEnabled() const { return !mCacheDir.empty(); }
+
+    // Build the cache key of a DLA payload compiled with the given runtime options.
+    std::string GetKey(const void* payload, size_t size, const std::string& runtimeOption) const;
+
+    // Read the cached compiled network of the key. Returns false on a cache miss.
+    bool Load(const std::string& key, std::vector<uint8_t>& compiledNetwork) const;
+
+    // Write the compiled network of the key, then evict old entries if needed.
+    int Store(const std::string& key, const std::vector<uint8_t>& compiledNetwork) const;
+
+    // Remove the entry of the key, e.g. when it could not be restored.
+    void Remove(const std::string& key) const;
+
+private:
+    std::string GetEntryPath(const std::string& key) const;
+
+    void Evict() const;
+
+private:
+    const std::string mCacheDir;
+
+    const size_t mMaxSizeBytes;
+
+    // Serializes the directory updates of the delegates initialized concurrently.
+    static std::mutex sMutex;
+};
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
@@ -44,14 +44,54 @@ struct NeuronDeleter {
       NeuronMemory_free(memory);
     }
   }
+  void operator()(NeuronEvent *event) {
+    if (event != nullptr) {
+      NeuronEvent_free(event);
+    }
+  }
+};
+
+// Scheduling options that are fixed once a compilation is finished.
+struct CompilationPreference {
+  // One of NEURON_PREFER_*.
+  int32_t mPreference = NEURON_PREFER_TURBO_BOOST;
+
+  // One of NEURON_PRIORITY_*.
+  int32_t mPriority = NEURON_PRIORITY_HIGH;
+
+  bool operator==(const CompilationPreference& other) const {
+    return mPreference == other.mPreference && mPriority == other.mPriority;
+  }
 };
 
 class NeuronExecutor {
 public:
     explicit NeuronExecutor();
 
+    // Compile the DLA payload. If finishedNetwork is given, the finished compilation is also
+    // stored into it so that it can be reloaded with LoadFromFinishedNetwork().
     int LoadFromCompiledNetwork(const void* buffer, size_t size,
-                                int inputCount, int outputCount, std::string& runtimeOption);
+                                int inputCount, int outputCount, std::string& runtimeOption,
+                                const CompilationPreference& preference = {},
+                                std::vector<uint8_t>* finishedNetwork = nullptr);
+
+    // Restore a compilation previously stored by LoadFromCompiledNetwork(), skipping compilation.
+    int LoadFromFinishedNetwork(const void* buffer, size_t size);
+
+    // Create another execution instance on the compilation already loaded by `other`.
+    int LoadFromExecutor(const NeuronExecutor& other);
+
+    // Compile the model already loaded by `other` again with another preference. The model is
+    // shared, only the compilation is duplicated. The model references the buffer given to
+    // `other.LoadFromCompiledNetwork()`, which must still be alive.
+    int LoadFromExecutor(const NeuronExecutor& other, std::string& runtimeOption,
+                         const CompilationPreference& preference);
+
+    // Hint the device frequency of the next executions, between 0 (lowest) and 100 (highest).
+    int SetBoostHint(uint8_t boostValue) const {
+        CHECK_VALID_PTR(mExecution);
+        return NeuronExecution_setBoostHint(mExecution.get(), boostValue);
+    }
 
     template <bool isInput>
     int SetInputOutput(uint32_t index, void *buffer, size_t length) const {
@@ -78,22 +118,65 @@ public:
         return res == NEURON_NO_ERROR ? size : 0;
     }
 
+    // The dimensions array must hold as many entries as the rank of the output.
+    int GetOutputPaddedDimensions(int32_t index, uint32_t* dimensions) const {
+        CHECK_VALID_PTR(mCompilation);
+        return NeuronCompilation_getOutputPaddedDimensions(mCompilation.get(), index, dimensions);
+    }
+
     int Compute() const {
         CHECK_VALID_PTR(mExecution);
         return NeuronExecution_compute(mExecution.get());
     }
 
+    // Schedule the execution without blocking. The execution starts once all the
+    // dependencies are signaled. Wait() must be called before the execution is reused.
+    int ComputeAsync(const NeuronEvent* const* dependencies = nullptr,
+                     uint32_t numDependencies = 0) const {
+        CHECK_VALID_PTR(mExecution);
+        CHECK_TRUE(mEvent == nullptr);
+        NeuronEvent* event = nullptr;
+        auto res = NeuronExecution_startComputeWithDependencies(
+            mExecution.get(), dependencies, numDependencies, /*duration=*/0, &event);
+        CHECK_NO_ERROR(res);
+        CHECK_VALID_PTR(event);
+        mEvent = std::unique_ptr<NeuronEvent, NeuronDeleter>(event);
+        return NEURON_NO_ERROR;
+    }
+
+    // Block until the execution scheduled by ComputeAsync() completes. No-op if idle.
+    int Wait() const {
+        if (mEvent == nullptr) {
+            return NEURON_NO_ERROR;
+        }
+        auto res = NeuronEvent_wait(mEvent.get());
+        mEvent.reset();
+        return res;
+    }
+
+    bool IsPending() const {
+        return mEvent != nullptr;
+    }
+
+    const NeuronEvent* GetEvent() const {
+        return mEvent.get();
+    }
+
     bool IsValid() const {
         return mExecution != nullptr;
     }
 
 private:
-    std::unique_ptr<NeuronModel, NeuronDeleter> mModel;
+    // Shared by every executor created with LoadFromExecutor().
+    std::shared_ptr<NeuronModel> mModel;
 
-    std::unique_ptr<NeuronCompilation, NeuronDeleter> mCompilation;
+    std::shared_ptr<NeuronCompilation> mCompilation;
 
     std::unique_ptr<NeuronExecution, NeuronDeleter> mExecution;
 
+    // Completion event of the in-flight asynchronous execution, if any.
+    mutable std::unique_ptr<NeuronEvent, NeuronDeleter> mEvent;
+
     std::vector<size_t> mInputSizes;
 
     std::vector<size_t> mOutputSizes;
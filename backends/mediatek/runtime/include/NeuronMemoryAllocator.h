@@ -0,0 +1,68 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#pragma once
+
+#include "NeuronBufferAllocator.h"
+
+#include <executorch/runtime/core/hierarchical_allocator.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/method_meta.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+// MemoryAllocator handing out Neuron shared buffers from the BufferAllocator. Delegate inputs
+// and outputs living in these buffers are bound with SetInputOutputFromMemory instead of being
+// copied. All the buffers are released on reset() and at destruction.
+class NeuronMemoryAllocator : public MemoryAllocator {
+public:
+    NeuronMemoryAllocator() : MemoryAllocator(0, nullptr) {}
+
+    ~NeuronMemoryAllocator() override { reset(); }
+
+    void* allocate(size_t size, size_t alignment = kDefaultAlignment) override;
+
+    void reset() override;
+
+private:
+    std::vector<void*> mBuffers;
+};
+
+// Memory-planned buffers of a method backed by Neuron shared buffers, so that intermediate
+// tensors passed between Neuron delegates reach the APU without a copy.
+class NeuronPlannedMemory {
+public:
+    static Result<std::unique_ptr<NeuronPlannedMemory>> Create(const MethodMeta& methodMeta);
+
+    HierarchicalAllocator* get() { return mPlannedMemory.get(); }
+
+private:
+    NeuronPlannedMemory() {}
+
+    NeuronPlannedMemory(const NeuronPlannedMemory&) = delete;
+
+    NeuronPlannedMemory& operator=(const NeuronPlannedMemory&) = delete;
+
+private:
+    NeuronMemoryAllocator mAllocator;
+
+    std::vector<Span<uint8_t>> mSpans;
+
+    std::unique_ptr<HierarchicalAllocator> mPlannedMemory;
+};
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
@@ -8,7 +8,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Version 1 payloads carry a single compiled network of DataLen bytes.
+constexpr unsigned char kNeuronPayloadVersionSingle = 1;
+
+// Version 2 payloads carry several compiled networks of the same model, e.g. one per token
+// batch size, and the delegate runs the one matching the input shapes. The DataLen bytes are:
+//   uint32_t NetworkCount
+//   NetworkCount x { uint32_t NetworkLen; NetworkLen bytes of compiled network }
+constexpr unsigned char kNeuronPayloadVersionMultiNetwork = 2;
+
+// Version 3 payloads append a table of shared inputs to the version 2 layout. A shared input is
+// a network input holding weights, e.g. shared by the prompt and generation networks of a
+// layer. It is imported once per process into Neuron memory under its name, and it does not
+// appear in the delegate arguments:
+//   uint32_t SharedInputCount
+//   SharedInputCount x { uint32_t InputIndex; uint32_t NameLen; NameLen bytes of name;
+//                        uint32_t DataLen; DataLen bytes of data }
+// DataLen may be 0 when another delegate of the program carries the data.
+constexpr unsigned char kNeuronPayloadVersionSharedInputs = 3;
 
 struct __attribute__((packed)) NeuronPayloadHeader {
     unsigned char Version;
@@ -21,11 +45,108 @@ struct __attribute__((packed)) NeuronPayloadHeader {
 };
 
 struct NeuronPayload {
+    struct Network {
+        const void* Data;
+
+        uint32_t Length;
+    };
+
+    struct SharedInput {
+        // Index of the input in the compiled networks.
+        uint32_t InputIndex;
+
+        std::string Name;
+
+        const void* Data;
+
+        uint32_t Length;
+    };
+
     NeuronPayload(const void* payload, size_t size) :
         Header(*(struct NeuronPayloadHeader*)payload),
-        CompiledNetwork((char*)payload + sizeof(struct NeuronPayloadHeader)) {}
+        CompiledNetwork((char*)payload + sizeof(struct NeuronPayloadHeader)) {
+        const size_t available = size > sizeof(struct NeuronPayloadHeader)
+            ? size - sizeof(struct NeuronPayloadHeader) : 0;
+        if (Header.Version != kNeuronPayloadVersionMultiNetwork &&
+                Header.Version != kNeuronPayloadVersionSharedInputs) {
+            Networks.push_back({CompiledNetwork, Header.DataLen});
+            return;
+        }
+        mData = static_cast<const char*>(CompiledNetwork);
+        mLength = std::min<size_t>(Header.DataLen, available);
+        if (!ParseNetworks() ||
+                (Header.Version == kNeuronPayloadVersionSharedInputs && !ParseSharedInputs())) {
+            Networks.clear();
+            SharedInputs.clear();
+        }
+    }
 
     NeuronPayloadHeader Header;
 
     void* CompiledNetwork = nullptr;
+
+    // The compiled networks, empty if the payload is malformed.
+    std::vector<Network> Networks;
+
+    std::vector<SharedInput> SharedInputs;
+
+private:
+    bool ParseNetworks() {
+        uint32_t count = 0;
+        if (!Read(count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            Network network;
+            if (!Read(network.Length) || !Skip(network.Length, network.Data)) {
+                return false;
+            }
+            Networks.push_back(network);
+        }
+        return true;
+    }
+
+    bool ParseSharedInputs() {
+        uint32_t count = 0;
+        if (!Read(count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            SharedInput input;
+            uint32_t nameLength = 0;
+            const void* name = nullptr;
+            if (!Read(input.InputIndex) || !Read(nameLength) || !Skip(nameLength, name) ||
+                    !Read(input.Length) || !Skip(input.Length, input.Data)) {
+                return false;
+            }
+            input.Name.assign(static_cast<const char*>(name), nameLength);
+            SharedInputs.push_back(std::move(input));
+        }
+        return true;
+    }
+
+    bool Read(uint32_t& value) {
+        if (mLength - mOffset < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, mData + mOffset, sizeof(value));
+        mOffset += sizeof(value);
+        return true;
+    }
+
+    bool Skip(uint32_t length, const void*& data) {
+        if (mLength - mOffset < length) {
+            return false;
+        }
+        data = mData + mOffset;
+        mOffset += length;
+        return true;
+    }
+
+private:
+    const char* mData = nullptr;
+
+    size_t mLength = 0;
+
+    size_t mOffset = 0;
 };
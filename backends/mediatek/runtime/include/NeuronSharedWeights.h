@@ -0,0 +1,59 @@
+/*
+* Copyright (c) 2024 MediaTek Inc.
+*
+* Licensed under the BSD License (the "License"); you may not use this file
+* except in compliance with the License. See the license file in the root
+* directory of this source tree for more details.
+*/
+
+#pragma once
+
+#include "NeuronBufferAllocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace torch {
+namespace executor {
+namespace neuron {
+
+// Process-wide registry of the named weight segments shared by several compiled networks. Each
+// segment is imported once into a Neuron buffer and reference counted by the delegates using it.
+class SharedWeights {
+public:
+    static SharedWeights& GetInstance();
+
+    // Get the buffer of the named segment, importing the data if the segment is not registered
+    // yet. Returns nullptr if the segment is unknown and no data is given, or if the size
+    // mismatches the registered segment.
+    const MemoryUnit* Acquire(const std::string& name, const void* data, size_t size);
+
+    void Release(const std::string& name);
+
+private:
+    SharedWeights() {}
+
+    SharedWeights(const SharedWeights&) = delete;
+
+    SharedWeights& operator=(const SharedWeights&) = delete;
+
+private:
+    struct Segment {
+        void* mBuffer = nullptr;
+
+        size_t mSize = 0;
+
+        uint32_t mRefCount = 0;
+    };
+
+    std::unordered_map<std::string, Segment> mSegments;
+
+    std::mutex mMutex;
+};
+
+} // namespace neuron
+} // namespace executor
+} // namespace torch
@@ -106,59 +106,3 @@ struct ApuWareUtilsLib {
   ReleasePerformanceLockPtr releasePerformanceLock =
     reinterpret_cast<decltype(releasePerformanceLock)>(voidFunction);
 };
-
-class ScopePerformancer {
-public:
-    ScopePerformancer(uint32_t ms = 2000) : mLib(ApuWareUtilsLib::GetInstance()), mMs(ms) {
-        mLock = mLib.mEnable;
-        if (mLock) {
-            APUWARE_LOG_D("Powerhal Up");
-            mRunning.store(true);
-            mThread = std::thread(&ScopePerformancer::acquireLockRepeatedly, this);
-        }
-    };
-
-    void Stop() {
-        if (mRunning.load()) {
-            mRunning.store(false);
-            mCond.notify_one();
-        }
-    }
-
-    ~ScopePerformancer() {
-        Stop();
-        if (mThread.joinable()) {
-            mThread.join();
-        }
-        if (mHalHandle != 0 && mLock) {
-            APUWARE_LOG_D("Powerhal Free");
-            mLib.releasePerformanceLock(mHalHandle);
-            mHalHandle = 0;
-        }
-    }
-
-private:
-    void acquireLockRepeatedly() {
-        std::unique_lock<std::mutex> lock(mMutex);
-        while (mRunning.load()) {
-            mHalHandle = mLib.acquirePerformanceLock(mHalHandle, FAST_SINGLE_ANSWER_MODE, mMs);
-            mCond.wait_for(lock, std::chrono::milliseconds(1000), [this] { return !mRunning.load(); });
-        }
-    }
-
-    struct ApuWareUtilsLib mLib;
-
-    bool mLock = false;
-
-    int mHalHandle = 0;
-
-    uint32_t mMs;
-
-    std::atomic<bool> mRunning{false};
-
-    std::thread mThread;
-
-    std::mutex mMutex;
-
-    std::condition_variable mCond;
-};
\ No newline at end of file
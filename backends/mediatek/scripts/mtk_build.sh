@@ -18,12 +18,6 @@ if [ -z "$ANDROID_NDK" ]; then
     exit 1
 fi
 
-# Check if the NEURON_BUFFER_ALLOCATOR_LIB environment variable is set
-if [ -z "$NEURON_BUFFER_ALLOCATOR_LIB" ]; then
-    echo "Error: NEURON_BUFFER_ALLOCATOR_LIB environment variable is not set." >&2
-    exit 1
-fi
-
 # Create and enter the build directory
 cd "$SOURCE_DIR"
 rm -rf cmake-android-out && mkdir cmake-android-out && cd cmake-android-out
@@ -35,7 +29,6 @@ cmake -DBUCK2="$BUCK_PATH" \
       -DANDROID_ABI=arm64-v8a \
       -DANDROID_PLATFORM=android-30 \
       -DEXECUTORCH_BUILD_NEURON=ON \
-      -DNEURON_BUFFER_ALLOCATOR_LIB="$NEURON_BUFFER_ALLOCATOR_LIB" \
       ..
 
 # Build the project
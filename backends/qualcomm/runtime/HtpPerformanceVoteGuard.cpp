@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Qualcomm Innovation Center, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <executorch/backends/qualcomm/runtime/HtpPerformanceVoteGuard.h>
+#include <executorch/backends/qualcomm/runtime/Logging.h>
+#include <executorch/backends/qualcomm/runtime/backends/htpbackend/HtpDevice.h>
+
+namespace torch {
+namespace executor {
+namespace qnn {
+
+thread_local HtpPerformanceVoteGuard* HtpPerformanceVoteGuard_guard = nullptr;
+
+HtpPerformanceVoteGuard* HtpPerformanceVoteGuard::get_current() {
+  return HtpPerformanceVoteGuard_guard;
+}
+
+void HtpPerformanceVoteGuard::set_current(HtpPerformanceVoteGuard* guard) {
+  HtpPerformanceVoteGuard_guard = guard;
+}
+
+HtpPerformanceVoteGuard::~HtpPerformanceVoteGuard() {
+  HtpPerformanceVoteGuard::set_current(prev_guard_);
+  for (const auto& voted_device : voted_devices_) {
+    std::shared_ptr<HtpDevice> device = voted_device.lock();
+    if (device == nullptr) {
+      continue;
+    }
+    if (prev_guard_ != nullptr) {
+      prev_guard_->Vote(device);
+    } else if (device->RestorePerformanceMode() != Error::Ok) {
+      QNN_EXECUTORCH_LOG_WARN("Fail to restore the HTP performance vote");
+    }
+  }
+}
+
+void HtpPerformanceVoteGuard::Vote(const std::shared_ptr<HtpDevice>& device) {
+  if (device->SetPerformanceMode(performance_mode_) != Error::Ok) {
+    QNN_EXECUTORCH_LOG_WARN("Fail to vote for the HTP performance mode");
+    return;
+  }
+  for (const auto& voted_device : voted_devices_) {
+    if (voted_device.lock() == device) {
+      return;
+    }
+  }
+  voted_devices_.push_back(device);
+}
+
+} // namespace qnn
+} // namespace executor
+} // namespace torch
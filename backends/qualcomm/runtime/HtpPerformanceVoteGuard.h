@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Qualcomm Innovation Center, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <executorch/backends/qualcomm/schema_generated.h>
+
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace qnn {
+
+class HtpDevice;
+
+// A RAII, thread local (!) guard that raises the performance vote of the HTP
+// for the QNN delegates executed on the calling thread while it is alive,
+// e.g. around the token generation loop of an LLM, so that it runs at burst
+// clocks without keeping them up while the application is idle. Delegates
+// vote when they execute under the guard. Upon destruction their votes go
+// back to the mode of the enclosing guard, or to the performance_mode they
+// were lowered with.
+//
+// NOTE: Prototype API; subject to change.
+class HtpPerformanceVoteGuard {
+ public:
+  static HtpPerformanceVoteGuard* get_current();
+
+  explicit HtpPerformanceVoteGuard(
+      qnn_delegate::QnnExecuTorchHtpPerformanceMode performance_mode =
+          qnn_delegate::QnnExecuTorchHtpPerformanceMode::kHtpBurst)
+      : performance_mode_(performance_mode),
+        prev_guard_(HtpPerformanceVoteGuard::get_current()) {
+    HtpPerformanceVoteGuard::set_current(this);
+  }
+  ~HtpPerformanceVoteGuard();
+
+  HtpPerformanceVoteGuard(const HtpPerformanceVoteGuard&) = delete;
+  HtpPerformanceVoteGuard& operator=(const HtpPerformanceVoteGuard&) = delete;
+
+  // Called by a delegate before it executes on device
+  void Vote(const std::shared_ptr<HtpDevice>& device);
+
+ private:
+  static void set_current(HtpPerformanceVoteGuard* guard);
+
+  const qnn_delegate::QnnExecuTorchHtpPerformanceMode performance_mode_;
+  HtpPerformanceVoteGuard* const prev_guard_;
+  // The devices voted for under this guard. They may be destroyed before the
+  // guard, together with the delegates owning them.
+  std::vector<std::weak_ptr<HtpDevice>> voted_devices_;
+};
+
+} // namespace qnn
+} // namespace executor
+} // namespace torch
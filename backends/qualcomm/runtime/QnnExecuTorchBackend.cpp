@@ -11,6 +11,7 @@
 #include <executorch/backends/qualcomm/runtime/QnnExecuTorchBackend.h>
 #include <executorch/backends/qualcomm/runtime/QnnManager.h>
 #include <executorch/backends/qualcomm/schema_generated.h>
+#include <executorch/runtime/backend/delegate_profiling.h>
 
 #include <string>
 namespace torch {
@@ -28,6 +29,8 @@ Result<DelegateHandle*> QnnExecuTorchBackend::init(
   QnnExecuTorchContextBinary qnn_context_blob;
   const qnn_delegate::QnnExecuTorchOptions* qnn_executorch_options;
 
+  // Points into the processed data, which is only valid until the end of
+  // init().
   qnn_context_blob.buffer = const_cast<void*>(processed->data());
   qnn_context_blob.nbytes = processed->size();
 
@@ -48,10 +51,15 @@ Result<DelegateHandle*> QnnExecuTorchBackend::init(
   // destructible, we must call the destructor manually in destroy().
   new (qnn_manager) QnnManager(qnn_executorch_options, qnn_context_blob);
 
-  ET_CHECK_OR_RETURN_ERROR(
-      qnn_manager->Init() == Error::Ok,
-      Internal,
-      "Fail to initialize Qnn Manager");
+  EventTracer* event_tracer = context.event_tracer();
+  {
+    DelegateProfilingScope init_scope(
+        event_tracer, DelegateProfilingEventType::kInit);
+    ET_CHECK_OR_RETURN_ERROR(
+        qnn_manager->Init() == Error::Ok,
+        Internal,
+        "Fail to initialize Qnn Manager");
+  }
 
   if (qnn_manager->IsOnlinePrepare()) {
     auto graph = qcir::GetGraph(qnn_context_blob.buffer);
@@ -157,21 +165,35 @@ Result<DelegateHandle*> QnnExecuTorchBackend::init(
     }
 
     QnnExecuTorchContextBinary context_binary;
-    ET_CHECK_OR_RETURN_ERROR(
-        qnn_manager->Compile(op_wrappers, context_binary) == Error::Ok,
-        Internal,
-        "Fail to compile graph in online prepare stage");
+    {
+      DelegateProfilingScope compile_scope(
+          event_tracer, DelegateProfilingEventType::kCompile);
+      ET_CHECK_OR_RETURN_ERROR(
+          qnn_manager->Compile(op_wrappers, context_binary) == Error::Ok,
+          Internal,
+          "Fail to compile graph in online prepare stage");
+    }
 
+    DelegateProfilingScope init_scope(
+        event_tracer, DelegateProfilingEventType::kInit);
     ET_CHECK_OR_RETURN_ERROR(
         qnn_manager->AllocateTensor(graph_inputs, graph_outputs) == Error::Ok,
         Internal,
         "Fail to allocate tensor in online prepare stage");
   } else {
+    DelegateProfilingScope init_scope(
+        event_tracer, DelegateProfilingEventType::kInit);
     ET_CHECK_OR_RETURN_ERROR(
         qnn_manager->AllocateTensor() == Error::Ok,
         Internal,
         "Fail to allocate tensor");
   }
+  // The context and the tensors of its graph were created from the processed
+  // data, which is not read any more. Releasing it now keeps a large context
+  // binary, e.g. of an LLM, from staying resident next to the copy that the
+  // backend made of it. Loaded with a MmapDataLoader from a segment of the
+  // program, it was consumed in place and is unmapped here.
+  processed->Free();
   return qnn_manager;
 }
 
@@ -188,39 +210,51 @@ Error QnnExecuTorchBackend::execute(
   std::vector<Qnn_Tensor_t> input_tensor_structs;
   std::vector<Qnn_Tensor_t> output_tensor_structs;
 
-  input_tensor_structs.reserve(input_tensors.size());
-  for (int i = 0; i < input_tensors.size(); ++i) {
-    if (qnn_manager->RegisterMem(
-            args[i]->toTensor().mutable_data_ptr(), input_tensors[i]) !=
-        Error::Ok) {
-      input_tensors[i]->FillDataBuffer(
-          args[i]->toTensor().const_data_ptr(), true /* copy_data */);
+  EventTracer* event_tracer = context.event_tracer();
+  {
+    // Registers the memory of the arguments with the backend, or copies the
+    // inputs where that fails.
+    DelegateProfilingScope transfer_scope(
+        event_tracer, DelegateProfilingEventType::kDataTransfer);
+    input_tensor_structs.reserve(input_tensors.size());
+    for (int i = 0; i < input_tensors.size(); ++i) {
+      if (qnn_manager->RegisterMem(
+              args[i]->toTensor().mutable_data_ptr(), input_tensors[i]) !=
+          Error::Ok) {
+        input_tensors[i]->FillDataBuffer(
+            args[i]->toTensor().const_data_ptr(), true /* copy_data */);
+      }
+      input_tensor_structs.push_back(input_tensors[i]->CloneTensorStruct());
     }
-    input_tensor_structs.push_back(input_tensors[i]->CloneTensorStruct());
-  }
 
-  int output_index = input_tensors.size();
-  for (const auto& output_tensor : output_tensors) {
-    // pos=0 limits the search to the prefix
-    if (output_tensor->GetName().rfind("output_", 0) == 0) {
-      void* mutable_data_ptr =
-          args[output_index]->toTensor().mutable_data_ptr();
-      if (qnn_manager->RegisterMem(mutable_data_ptr, output_tensor) !=
-          Error::Ok) {
-        output_tensor->FillDataBuffer(mutable_data_ptr, false /* copy_data */);
+    int output_index = input_tensors.size();
+    for (const auto& output_tensor : output_tensors) {
+      // pos=0 limits the search to the prefix
+      if (output_tensor->GetName().rfind("output_", 0) == 0) {
+        void* mutable_data_ptr =
+            args[output_index]->toTensor().mutable_data_ptr();
+        if (qnn_manager->RegisterMem(mutable_data_ptr, output_tensor) !=
+            Error::Ok) {
+          output_tensor->FillDataBuffer(
+              mutable_data_ptr, false /* copy_data */);
+        }
+        output_index++;
       }
-      output_index++;
+      output_tensor_structs.push_back(output_tensor->CloneTensorStruct());
     }
-    output_tensor_structs.push_back(output_tensor->CloneTensorStruct());
   }
 
+  {
+    DelegateProfilingScope execute_scope(
+        event_tracer, DelegateProfilingEventType::kExecute);
+    ET_CHECK_OR_RETURN_ERROR(
+        qnn_manager->Execute(input_tensor_structs, output_tensor_structs) ==
+            Error::Ok,
+        Internal,
+        "Fail to execute graph");
+  }
   ET_CHECK_OR_RETURN_ERROR(
-      qnn_manager->Execute(input_tensor_structs, output_tensor_structs) ==
-          Error::Ok,
-      Internal,
-      "Fail to execute graph");
-  ET_CHECK_OR_RETURN_ERROR(
-      qnn_manager->ProfileExecuteData(context.event_tracer()) == Error::Ok,
+      qnn_manager->ProfileExecuteData(event_tracer) == Error::Ok,
       Internal,
       "Fail to profile graph");
 
@@ -5,6 +5,7 @@
  * This source code is licensed under the BSD-style license found in the
  * LICENSE file in the root directory of this source tree.
  */
+#include <executorch/backends/qualcomm/runtime/HtpPerformanceVoteGuard.h>
 #include <executorch/backends/qualcomm/runtime/QnnManager.h>
 #include <executorch/backends/qualcomm/runtime/SharedBuffer.h>
 #include <executorch/backends/qualcomm/runtime/Utils.h>
@@ -17,7 +18,6 @@ namespace executor {
 namespace qnn {
 QnnManager::~QnnManager() {
   backend_params_ptr_.reset(new BackendConfigParameters());
-  logger_.reset();
   qnn_loaded_backend_.TerminateAllBackends();
 }
 
@@ -100,33 +100,54 @@ Error QnnManager::RegisterMem(
     return Error::Internal;
   }
 
-  if (!shared_buffer_manager.IsAllocated(data_ptr)) {
+  // Buffers are only registered the first time they are seen, later
+  // executions reuse the handle.
+  Qnn_MemHandle_t handle =
+      backend_params_ptr_->qnn_mem_manager_ptr_->GetRegisteredHandle(
+          tensor_wrapper, data_ptr);
+  if (handle != nullptr) {
+    tensor_wrapper->SetMemHandle(handle);
+    return Error::Ok;
+  }
+
+  size_t allocated_bytes = 0;
+  void* allocation_base =
+      shared_buffer_manager.GetAllocationBase(data_ptr, allocated_bytes);
+  if (allocation_base == nullptr) {
     // It means two scenarios here:
     // 1. the input and output partitioned graph
     // 2. Actually, user doesn't allocate shared buffer with
-    // QnnExecuTorchAllocCustomMem API
+    // QnnExecuTorchAllocCustomMem API or a SharedBufferAllocator
     return Error::Internal;
-  } else if (backend_params_ptr_->qnn_mem_manager_ptr_->IsRegistered(
-                 tensor_wrapper->GetMemHandle())) {
-    if (options_->log_level() >= QnnExecuTorchLogLevel::kLogLevelInfo)
-      QNN_EXECUTORCH_LOG_INFO(
-          "Tensor name %s has been registered shared memory.",
-          tensor_wrapper->GetName().c_str());
-    return Error::Ok;
   }
 
-  int32_t mem_fd = SharedBuffer::GetSharedBufferManager().MemToFd(data_ptr);
+  int32_t mem_fd = shared_buffer_manager.MemToFd(allocation_base);
   if (mem_fd == -1) {
     QNN_EXECUTORCH_LOG_WARN(
         "Tensor name %s is failed to get file descriptor.",
         tensor_wrapper->GetName().c_str());
     return Error::Internal;
   }
-  ET_CHECK_OR_RETURN_ERROR(
-      backend_params_ptr_->qnn_mem_manager_ptr_->RegisterMem(
-          tensor_wrapper, mem_fd) == Error::Ok,
-      Internal,
-      "Fail to register to shared memory.");
+
+  if (data_ptr == allocation_base) {
+    // The tensor data starts at the beginning of the buffer
+    ET_CHECK_OR_RETURN_ERROR(
+        backend_params_ptr_->qnn_mem_manager_ptr_->RegisterIonMem(
+            tensor_wrapper, mem_fd, data_ptr) == Error::Ok,
+        Internal,
+        "Fail to register to shared memory.");
+  } else {
+    // The tensor lives inside a larger buffer, e.g. a memory-planned one, or
+    // the buffer was padded for alignment
+    size_t offset = static_cast<char*>(data_ptr) -
+        static_cast<char*>(allocation_base);
+    ET_CHECK_OR_RETURN_ERROR(
+        backend_params_ptr_->qnn_mem_manager_ptr_->RegisterCustomMem(
+            tensor_wrapper, mem_fd, data_ptr, allocated_bytes, offset) ==
+            Error::Ok,
+        Internal,
+        "Fail to register to shared memory.");
+  }
 
   return Error::Ok;
 }
@@ -134,8 +155,6 @@ Error QnnManager::RegisterMem(
 Error QnnManager::Init() {
   ET_CHECK_OR_RETURN_ERROR(
       LoadQnnLibrary() == Error::Ok, Internal, "Fail to load Qnn library");
-  logger_ = std::make_unique<QnnLogger>(
-      qnn_loaded_backend_, LoggingCallback, options_->log_level());
   if (backend_params_ptr_->backend_init_state_ ==
       BackendInitializeState::UNINITIALIZED) {
     QNN_EXECUTORCH_LOG_INFO(
@@ -143,19 +162,27 @@ Error QnnManager::Init() {
         "parameters for Qnn executorch backend type %d",
         options_->backend_options()->backend_type());
     backend_params_ptr_ = QnnBackendFactory().Create(
-        qnn_loaded_backend_, logger_.get(), qnn_context_blob_, options_);
-    ET_CHECK_OR_RETURN_ERROR(
-        backend_params_ptr_->qnn_backend_ptr_->Configure() == Error::Ok,
-        Internal,
-        "Fail to configure Qnn backend");
+        qnn_loaded_backend_, qnn_context_blob_, options_);
     ET_CHECK_OR_RETURN_ERROR(
-        backend_params_ptr_->qnn_device_ptr_->Configure() == Error::Ok,
+        backend_params_ptr_ != nullptr,
         Internal,
-        "Fail to configure Qnn device");
-    ET_CHECK_OR_RETURN_ERROR(
-        backend_params_ptr_->qnn_context_ptr_->Configure() == Error::Ok,
-        Internal,
-        "Fail to configure Qnn context");
+        "Fail to create Qnn backend parameters");
+    // A context created from the same context binary by another delegate is
+    // configured already, this delegate only retrieves its graph from it.
+    if (!backend_params_ptr_->is_context_shared_) {
+      ET_CHECK_OR_RETURN_ERROR(
+          backend_params_ptr_->qnn_backend_ptr_->Configure() == Error::Ok,
+          Internal,
+          "Fail to configure Qnn backend");
+      ET_CHECK_OR_RETURN_ERROR(
+          backend_params_ptr_->qnn_device_ptr_->Configure() == Error::Ok,
+          Internal,
+          "Fail to configure Qnn device");
+      ET_CHECK_OR_RETURN_ERROR(
+          backend_params_ptr_->qnn_context_ptr_->Configure() == Error::Ok,
+          Internal,
+          "Fail to configure Qnn context");
+    }
     ET_CHECK_OR_RETURN_ERROR(
         backend_params_ptr_->qnn_graph_ptr_->Configure() == Error::Ok,
         Internal,
@@ -168,10 +195,12 @@ Error QnnManager::Init() {
 }
 
 Error QnnManager::AllocateTensor() {
+  const std::string& graph_name =
+      backend_params_ptr_->qnn_graph_ptr_->GetGraphName();
   std::vector<Qnn_Tensor_t> input_tensors =
-      backend_params_ptr_->qnn_context_ptr_->GetGraphInputs();
+      backend_params_ptr_->qnn_context_ptr_->GetGraphInputs(graph_name);
   std::vector<Qnn_Tensor_t> output_tensors =
-      backend_params_ptr_->qnn_context_ptr_->GetGraphOutputs();
+      backend_params_ptr_->qnn_context_ptr_->GetGraphOutputs(graph_name);
 
   for (auto& tensor : input_tensors) {
     std::shared_ptr<TensorWrapper> tensor_wrapper = CreateTensorWrapper(tensor);
@@ -208,8 +237,25 @@ Error QnnManager::Execute(
     std::vector<Qnn_Tensor_t>& output_tensor_structs) {
   Qnn_ErrorHandle_t error = QNN_SUCCESS;
 
-  error = backend_params_ptr_->qnn_graph_ptr_->GraphExecute(
-      input_tensor_structs, output_tensor_structs);
+  HtpPerformanceVoteGuard* perf_vote_guard =
+      HtpPerformanceVoteGuard::get_current();
+  if (perf_vote_guard != nullptr &&
+      options_->backend_options()->backend_type() ==
+          QnnExecuTorchBackendType::kHtpBackend) {
+    perf_vote_guard->Vote(std::static_pointer_cast<HtpDevice>(
+        backend_params_ptr_->qnn_device_ptr_));
+  }
+
+  // Profiling collects the events of an execution into the profile of the
+  // graph, so profiled executions stay synchronous.
+  QnnGraph* graph = backend_params_ptr_->qnn_graph_ptr_.get();
+  if (graph->SupportsAsyncExecute() &&
+      options_->profile_level() == QnnExecuTorchProfileLevel::kProfileOff) {
+    error =
+        graph->GraphExecuteAsync(input_tensor_structs, output_tensor_structs);
+  } else {
+    error = graph->GraphExecute(input_tensor_structs, output_tensor_structs);
+  }
 
   if (error != QNN_SUCCESS) {
     QNN_EXECUTORCH_LOG_ERROR(
@@ -263,7 +309,6 @@ Error QnnManager::ProfileExecuteData(EventTracer* event_tracer) {
 void QnnManager::Destroy() {
   QNN_EXECUTORCH_LOG_INFO("Destroy Qnn backend parameters");
   backend_params_ptr_.reset(new BackendConfigParameters());
-  logger_.reset();
 
   qnn_loaded_backend_.TerminateAllBackends();
 }
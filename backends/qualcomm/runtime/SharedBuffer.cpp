@@ -69,7 +69,9 @@ void* SharedBuffer::AllocMem(size_t bytes, size_t alignment) {
   if (!status) {
     QNN_EXECUTORCH_LOG_ERROR("Failed to allocate the tensor by RPC memory.");
     rpc_mem_free_(buf);
+    return nullptr;
   }
+  allocated_bytes_map_[buf] = static_cast<size_t>(allocate_bytes);
   return aligned_buf;
 }
 
@@ -90,6 +92,7 @@ void SharedBuffer::FreeMem(void* buf) {
     QNN_EXECUTORCH_LOG_WARN("Don't free an unallocated tensor.");
   } else {
     rpc_mem_free_(restore_map_[buf]);
+    allocated_bytes_map_.erase(restore_map_[buf]);
     restore_map_.erase(buf);
   }
 }
@@ -98,6 +101,18 @@ bool SharedBuffer::IsAllocated(void* buf) {
   return restore_map_.count(buf) != 0U;
 }
 
+void* SharedBuffer::GetAllocationBase(void* buf, size_t& allocated_bytes) {
+  auto addr = reinterpret_cast<uintptr_t>(buf);
+  for (const auto& allocation : allocated_bytes_map_) {
+    auto base = reinterpret_cast<uintptr_t>(allocation.first);
+    if (addr >= base && addr < base + allocation.second) {
+      allocated_bytes = allocation.second;
+      return allocation.first;
+    }
+  }
+  return nullptr;
+}
+
 Error SharedBuffer::Load() {
   // On Android, 32-bit and 64-bit libcdsprpc.so can be found at /vendor/lib/
   // and /vendor/lib64/ respectively.
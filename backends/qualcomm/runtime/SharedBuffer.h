@@ -38,6 +38,12 @@ class SharedBuffer final {
 
   bool IsAllocated(void* buf);
 
+  // Return the address returned by rpcmem_alloc for the shared buffer that
+  // contains buf, which may point into the middle of it, e.g. to a tensor
+  // in a memory-planned buffer. The size of that allocation is written to
+  // allocated_bytes. Return nullptr if buf is not in a shared buffer.
+  void* GetAllocationBase(void* buf, size_t& allocated_bytes);
+
   bool GetInitialize() {
     return initialize_;
   }
@@ -63,6 +69,8 @@ class SharedBuffer final {
   // Function pointer to rpcmem_to_fd
   RpcMemToFdFn_t rpc_mem_to_fd_;
   std::unordered_map<void*, void*> restore_map_;
+  // Bytes allocated via rpcmem_alloc, keyed by the address it returned
+  std::unordered_map<void*, size_t> allocated_bytes_map_;
   std::atomic_bool initialize_{false};
   static std::mutex init_mutex_;
 };
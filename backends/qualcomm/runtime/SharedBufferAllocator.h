@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Qualcomm Innovation Center, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <executorch/backends/qualcomm/runtime/QnnExecuTorch.h>
+#include <executorch/runtime/core/memory_allocator.h>
+
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace qnn {
+
+/**
+ * MemoryAllocator handing out shared buffers via QnnExecuTorchAllocCustomMem.
+ * It is meant to back the memory-planned buffers of a method, e.g. through
+ * the planned_memory_allocator of Module: delegate inputs and outputs that
+ * live in these buffers, including the intermediate tensors passed between
+ * QNN delegates, are registered with QNN once and then used without copies
+ * when the delegates are lowered with shared_buffer enabled.
+ *
+ * All the buffers are freed on reset() and at destruction, so the allocator
+ * must outlive the methods using its memory.
+ */
+class SharedBufferAllocator : public MemoryAllocator {
+ public:
+  SharedBufferAllocator() : MemoryAllocator(0, nullptr) {}
+
+  ~SharedBufferAllocator() override {
+    reset();
+  }
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    if (!isPowerOf2(alignment)) {
+      ET_LOG(Error, "Alignment %zu is not a power of 2", alignment);
+      return nullptr;
+    }
+    void* buffer = QnnExecuTorchAllocCustomMem(size, alignment);
+    if (buffer == nullptr) {
+      ET_LOG(Error, "Failed to allocate %zu bytes of shared buffer", size);
+      return nullptr;
+    }
+    buffers_.push_back(buffer);
+    used_size_ += size;
+    return buffer;
+  }
+
+  size_t used_size() const override {
+    return used_size_;
+  }
+
+  void reset() override {
+    for (auto buffer : buffers_) {
+      QnnExecuTorchFreeCustomMem(buffer);
+    }
+    buffers_.clear();
+    used_size_ = 0;
+  }
+
+ private:
+  std::vector<void*> buffers_;
+  size_t used_size_ = 0;
+};
+
+} // namespace qnn
+} // namespace executor
+} // namespace torch
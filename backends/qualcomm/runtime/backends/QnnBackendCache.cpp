@@ -46,35 +46,34 @@ Error QnnBackendCache::GetQnnGraphInfoFromBinary() {
     return Error::Internal;
   }
 
-  if (num_graphs > 1) {
-    QNN_EXECUTORCH_LOG_WARN(
-        "The context binary contains %lu graphs. But now "
-        "assume that one context binary contains one graph.",
-        num_graphs);
-    return Error::Internal;
-  }
-
-  // only have version_1 now
-  if (graph[0].version != QNN_SYSTEM_CONTEXT_GRAPH_INFO_VERSION_1) {
-    QNN_EXECUTORCH_LOG_WARN(
-        "Unknown QNN GraphInfo version %d.", graph[0].version);
-    return Error::Internal;
-  }
-  // get graph name from metadata
-  graph_name_ = graph->graphInfoV1.graphName;
-
-  // get graph inputs from metadata
-  uint32_t numGraphInputs = graph->graphInfoV1.numGraphInputs;
-  input_tensor_structs_.reserve(numGraphInputs);
-  for (std::uint32_t i = 0; i < numGraphInputs; ++i) {
-    input_tensor_structs_.emplace_back(graph->graphInfoV1.graphInputs[i]);
-  }
+  for (std::uint32_t graph_index = 0; graph_index < num_graphs;
+       ++graph_index) {
+    const QnnSystemContext_GraphInfo_t& graph_info = graph[graph_index];
+    // only have version_1 now
+    if (graph_info.version != QNN_SYSTEM_CONTEXT_GRAPH_INFO_VERSION_1) {
+      QNN_EXECUTORCH_LOG_WARN(
+          "Unknown QNN GraphInfo version %d.", graph_info.version);
+      return Error::Internal;
+    }
+    // get graph name from metadata
+    std::string graph_name = graph_info.graphInfoV1.graphName;
+    graph_names_.emplace_back(graph_name);
+
+    // get graph inputs from metadata
+    uint32_t numGraphInputs = graph_info.graphInfoV1.numGraphInputs;
+    std::vector<Qnn_Tensor_t>& inputs = input_tensor_structs_[graph_name];
+    inputs.reserve(numGraphInputs);
+    for (std::uint32_t i = 0; i < numGraphInputs; ++i) {
+      inputs.emplace_back(graph_info.graphInfoV1.graphInputs[i]);
+    }
 
-  // get graph outputs from metadata
-  uint32_t numGraphOutputs = graph->graphInfoV1.numGraphOutputs;
-  output_tensor_structs_.reserve(numGraphOutputs);
-  for (std::uint32_t i = 0; i < numGraphOutputs; ++i) {
-    output_tensor_structs_.emplace_back(graph->graphInfoV1.graphOutputs[i]);
+    // get graph outputs from metadata
+    uint32_t numGraphOutputs = graph_info.graphInfoV1.numGraphOutputs;
+    std::vector<Qnn_Tensor_t>& outputs = output_tensor_structs_[graph_name];
+    outputs.reserve(numGraphOutputs);
+    for (std::uint32_t i = 0; i < numGraphOutputs; ++i) {
+      outputs.emplace_back(graph_info.graphInfoV1.graphOutputs[i]);
+    }
   }
 
   return Error::Ok;
@@ -150,18 +149,20 @@ QnnBackendCache::~QnnBackendCache() {
   qnn_sys_impl_.Unload();
 }
 
-std::vector<Qnn_Tensor_t> QnnBackendCache::GetGraphInputs() {
-  if (state_ != DESERIALIZE)
+std::vector<Qnn_Tensor_t> QnnBackendCache::GetGraphInputs(
+    const std::string& graph_name) {
+  if (state_ != DESERIALIZE || input_tensor_structs_.count(graph_name) == 0)
     return {};
 
-  return input_tensor_structs_;
+  return input_tensor_structs_[graph_name];
 }
 
-std::vector<Qnn_Tensor_t> QnnBackendCache::GetGraphOutputs() {
-  if (state_ != DESERIALIZE)
+std::vector<Qnn_Tensor_t> QnnBackendCache::GetGraphOutputs(
+    const std::string& graph_name) {
+  if (state_ != DESERIALIZE || output_tensor_structs_.count(graph_name) == 0)
     return {};
 
-  return output_tensor_structs_;
+  return output_tensor_structs_[graph_name];
 }
 } // namespace qnn
 } // namespace executor
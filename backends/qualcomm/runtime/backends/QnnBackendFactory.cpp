@@ -7,12 +7,29 @@
  */
 #include <executorch/backends/qualcomm/runtime/Logging.h>
 #include <executorch/backends/qualcomm/runtime/backends/QnnBackendFactory.h>
+
+#include <string_view>
 namespace torch {
 namespace executor {
 namespace qnn {
+// NOLINTNEXTLINE(fuchsia-statically-constructed-objects)
+std::map<
+    QnnBackendFactory::SharedContextKey,
+    std::weak_ptr<SharedContextParameters>>
+    QnnBackendFactory::shared_contexts_;
+// NOLINTNEXTLINE(fuchsia-statically-constructed-objects)
+std::mutex QnnBackendFactory::shared_contexts_mutex_;
+
+QnnBackendFactory::SharedContextKey QnnBackendFactory::GetSharedContextKey(
+    const QnnExecuTorchContextBinary& qnn_context_blob) {
+  std::string_view content(
+      static_cast<const char*>(qnn_context_blob.buffer),
+      qnn_context_blob.nbytes);
+  return {qnn_context_blob.nbytes, std::hash<std::string_view>{}(content)};
+}
+
 std::unique_ptr<BackendConfigParameters> QnnBackendFactory::Create(
     const QnnImplementation& implementation,
-    QnnLogger* logger,
     const QnnExecuTorchContextBinary& qnn_context_blob,
     const QnnExecuTorchOptions* options) {
   auto backend_params = std::make_unique<BackendConfigParameters>();
@@ -49,17 +66,68 @@ std::unique_ptr<BackendConfigParameters> QnnBackendFactory::Create(
         QNN_EXECUTORCH_LOG_INFO(
             "use_fold_relu in htp_options: %d", htp_options->use_fold_relu());
       }
-      backend_params->qnn_backend_ptr_ =
-          std::make_unique<HtpBackend>(implementation, logger);
-      backend_params->qnn_device_ptr_ = std::make_unique<HtpDevice>(
-          implementation, logger, options->soc_info(), htp_options);
+      // Only context binaries are shared, the graphs of other blobs are
+      // composed by their delegates.
+      const bool can_share_context =
+          qnn_context_blob.buffer != nullptr && !options->online_prepare();
+      SharedContextKey key;
+      std::shared_ptr<SharedContextParameters> shared_context;
+      std::lock_guard<std::mutex> lock(shared_contexts_mutex_);
+      if (can_share_context) {
+        key = GetSharedContextKey(qnn_context_blob);
+        auto it = shared_contexts_.find(key);
+        if (it != shared_contexts_.end()) {
+          shared_context = it->second.lock();
+        }
+        // It was not configured yet, or failed to
+        if (shared_context != nullptr &&
+            shared_context->qnn_context_ptr_->GetHandle() == nullptr) {
+          shared_context = nullptr;
+        }
+      }
 
-      backend_params->qnn_context_ptr_ = std::make_unique<HtpContext>(
-          implementation,
-          backend_params->qnn_backend_ptr_.get(),
-          backend_params->qnn_device_ptr_.get(),
-          qnn_context_blob,
-          htp_options);
+      if (shared_context != nullptr) {
+        QNN_EXECUTORCH_LOG_INFO(
+            "Reuse the QNN context of a context binary of %d bytes",
+            qnn_context_blob.nbytes);
+        backend_params->is_context_shared_ = true;
+      } else {
+        shared_context = std::make_shared<SharedContextParameters>();
+        shared_context->implementation_ptr_ =
+            std::make_unique<QnnImplementation>(implementation);
+        const QnnImplementation& shared_implementation =
+            *shared_context->implementation_ptr_;
+        shared_context->logger_ptr_ = std::make_unique<QnnLogger>(
+            shared_implementation, LoggingCallback, options->log_level());
+        QnnLogger* shared_logger = shared_context->logger_ptr_.get();
+
+        shared_context->qnn_backend_ptr_ =
+            std::make_unique<HtpBackend>(shared_implementation, shared_logger);
+        shared_context->qnn_device_ptr_ = std::make_unique<HtpDevice>(
+            shared_implementation,
+            shared_logger,
+            options->soc_info(),
+            htp_options);
+
+        shared_context->qnn_context_ptr_ = std::make_unique<HtpContext>(
+            shared_implementation,
+            shared_context->qnn_backend_ptr_.get(),
+            shared_context->qnn_device_ptr_.get(),
+            qnn_context_blob,
+            htp_options);
+
+        if (can_share_context &&
+            shared_context->qnn_context_ptr_->GetCacheState() ==
+                QnnBackendCache::DESERIALIZE) {
+          shared_contexts_[key] = shared_context;
+        }
+      }
+      backend_params->qnn_backend_ptr_ = std::shared_ptr<QnnBackend>(
+          shared_context, shared_context->qnn_backend_ptr_.get());
+      backend_params->qnn_device_ptr_ = std::shared_ptr<QnnDevice>(
+          shared_context, shared_context->qnn_device_ptr_.get());
+      backend_params->qnn_context_ptr_ = std::shared_ptr<QnnContext>(
+          shared_context, shared_context->qnn_context_ptr_.get());
 
       backend_params->qnn_graph_ptr_ = std::make_unique<HtpGraph>(
           implementation,
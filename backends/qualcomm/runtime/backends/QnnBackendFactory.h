@@ -22,19 +22,46 @@
 #include <executorch/backends/qualcomm/schema_generated.h>
 
 #include <memory>
+#include <mutex>
+#include <map>
+#include <utility>
 namespace torch {
 namespace executor {
 namespace qnn {
 typedef enum { UNINITIALIZED, INITIALIZED } BackendInitializeState;
 
+// @brief Struct containing the handles that can be shared between delegates
+// loading the same context binary, e.g. one holding the prefill and decode
+// graphs of an LLM. The context, and with it the weights the graphs share,
+// is then only created once. It keeps its own copy of the implementation and
+// its own logger, so that it can outlive the delegate that created it.
+typedef struct SharedContextParameters {
+  std::unique_ptr<QnnImplementation> implementation_ptr_;
+  std::unique_ptr<QnnLogger> logger_ptr_;
+  std::unique_ptr<QnnBackend> qnn_backend_ptr_;
+  std::unique_ptr<QnnDevice> qnn_device_ptr_;
+  std::unique_ptr<QnnContext> qnn_context_ptr_;
+
+  ~SharedContextParameters() {
+    qnn_context_ptr_.reset();
+    qnn_device_ptr_.reset();
+    qnn_backend_ptr_.reset();
+    logger_ptr_.reset();
+  }
+} SharedContextParameters;
+
 // @brief Struct containing all handles for a given QNN backend
 typedef struct BackendConfigParameters {
-  std::unique_ptr<QnnBackend> qnn_backend_ptr_;
+  // Alias into a SharedContextParameters and keep it alive
+  std::shared_ptr<QnnBackend> qnn_backend_ptr_;
   BackendInitializeState backend_init_state_;
-  std::unique_ptr<QnnContext> qnn_context_ptr_;
-  std::unique_ptr<QnnDevice> qnn_device_ptr_;
+  std::shared_ptr<QnnContext> qnn_context_ptr_;
+  std::shared_ptr<QnnDevice> qnn_device_ptr_;
   std::unique_ptr<QnnGraph> qnn_graph_ptr_;
   std::unique_ptr<QnnMemManager> qnn_mem_manager_ptr_;
+  // Whether the backend, device and context were configured by another
+  // delegate already
+  bool is_context_shared_;
 
   // Default ctor
   BackendConfigParameters()
@@ -43,7 +70,8 @@ typedef struct BackendConfigParameters {
         qnn_context_ptr_(nullptr),
         qnn_device_ptr_(nullptr),
         qnn_graph_ptr_(nullptr),
-        qnn_mem_manager_ptr_(nullptr) {}
+        qnn_mem_manager_ptr_(nullptr),
+        is_context_shared_(false) {}
   // Default dtor
   ~BackendConfigParameters() {
     qnn_graph_ptr_.reset();
@@ -60,9 +88,20 @@ class QnnBackendFactory {
  public:
   std::unique_ptr<BackendConfigParameters> Create(
       const QnnImplementation& implementation,
-      QnnLogger* logger,
       const QnnExecuTorchContextBinary& qnn_context_blob,
       const QnnExecuTorchOptions* options);
+
+ private:
+  // Entries are keyed by the size and the hash of the content of the context
+  // binary. Delegates of different methods get different copies of the same
+  // binary, so the content is what identifies it.
+  using SharedContextKey = std::pair<uint64_t, size_t>;
+  static SharedContextKey GetSharedContextKey(
+      const QnnExecuTorchContextBinary& qnn_context_blob);
+
+  static std::map<SharedContextKey, std::weak_ptr<SharedContextParameters>>
+      shared_contexts_;
+  static std::mutex shared_contexts_mutex_;
 };
 } // namespace qnn
 } // namespace executor
@@ -63,6 +63,7 @@ class QnnInterface {
   DEFINE_SHIM_FUNCTION_INTERFACE(graph_add_node, graphAddNode);
   DEFINE_SHIM_FUNCTION_INTERFACE(graph_finalize, graphFinalize);
   DEFINE_SHIM_FUNCTION_INTERFACE(graph_execute, graphExecute);
+  DEFINE_SHIM_FUNCTION_INTERFACE(graph_execute_async, graphExecuteAsync);
   DEFINE_SHIM_FUNCTION_INTERFACE(graph_retrieve, graphRetrieve);
   // --------- QnnLog ---------
   DEFINE_SHIM_FUNCTION_INTERFACE(log_create, logCreate);
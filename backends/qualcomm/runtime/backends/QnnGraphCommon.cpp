@@ -6,9 +6,33 @@
  * LICENSE file in the root directory of this source tree.
  */
 #include <executorch/backends/qualcomm/runtime/backends/QnnGraphCommon.h>
+
+#include <condition_variable>
+#include <mutex>
 namespace torch {
 namespace executor {
 namespace qnn {
+namespace {
+// The completion of an asynchronous execution, which the backend signals from
+// a thread of its own.
+struct ExecutionCompletion {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  Qnn_ErrorHandle_t error = QNN_SUCCESS;
+};
+
+void NotifyExecutionCompletion(void* param, Qnn_NotifyStatus_t status) {
+  auto* completion = static_cast<ExecutionCompletion*>(param);
+  std::lock_guard<std::mutex> lock(completion->mutex);
+  completion->done = true;
+  completion->error = status.error;
+  // Notify under the lock, the waiter destroys the completion once it sees
+  // done.
+  completion->cv.notify_one();
+}
+} // namespace
+
 Error QnnGraph::Configure() {
   // create qnn backend
   const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
@@ -21,14 +45,21 @@ Error QnnGraph::Configure() {
       "Fail to make graph config.");
 
   if (context_->GetCacheState() == QnnBackendCache::DESERIALIZE) {
+    // A context binary with a single graph is used whatever the graph is
+    // named. Otherwise the graph_name option selects one of its graphs.
+    const std::vector<std::string>& graph_names = context_->GetGraphNames();
+    if (graph_names.size() == 1) {
+      graph_name_ = graph_names[0];
+    }
     // retrieve QNN Graph
     error = qnn_interface.qnn_graph_retrieve(
-        context_->GetHandle(), context_->GetGraphName().c_str(), &handle_);
+        context_->GetHandle(), graph_name_.c_str(), &handle_);
     if (error != QNN_SUCCESS) {
       QNN_EXECUTORCH_LOG_ERROR(
           "Can't retrieve graph "
-          "%s from context. Error %d.",
-          context_->GetGraphName().c_str(),
+          "%s from context with %zu graphs. Error %d.",
+          graph_name_.c_str(),
+          graph_names.size(),
           QNN_GET_ERROR_CODE(error));
       return Error::Internal;
     }
@@ -51,6 +82,10 @@ Error QnnGraph::Configure() {
     return Error::Internal;
   }
 
+  supports_async_execute_ =
+      qnn_interface.qnn_property_has_capability(
+          QNN_PROPERTY_GRAPH_SUPPORT_ASYNC_EXECUTION) == QNN_PROPERTY_SUPPORTED;
+
   // The profiler needs to be created after the backend is created.
   profile_ =
       std::make_unique<QnnProfile>(implementation_, backend_, profile_level_);
@@ -70,6 +105,29 @@ Qnn_ErrorHandle_t QnnGraph::GraphExecute(
       /*signalHandle=*/nullptr);
 };
 
+Qnn_ErrorHandle_t QnnGraph::GraphExecuteAsync(
+    const std::vector<Qnn_Tensor_t>& input_tensor_structs,
+    std::vector<Qnn_Tensor_t>& output_tensor_structs) {
+  ExecutionCompletion completion;
+  Qnn_ErrorHandle_t error =
+      implementation_.GetQnnInterface().qnn_graph_execute_async(
+          handle_,
+          input_tensor_structs.data(),
+          input_tensor_structs.size(),
+          output_tensor_structs.data(),
+          output_tensor_structs.size(),
+          /*profileHandle=*/nullptr,
+          /*signalHandle=*/nullptr,
+          NotifyExecutionCompletion,
+          &completion);
+  if (error != QNN_SUCCESS) {
+    return error;
+  }
+  std::unique_lock<std::mutex> lock(completion.mutex);
+  completion.cv.wait(lock, [&completion] { return completion.done; });
+  return completion.error;
+}
+
 Error QnnGraph::EnsureTensorInQnnGraph(
     const std::shared_ptr<TensorWrapper>& tensor_wrapper) {
   const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
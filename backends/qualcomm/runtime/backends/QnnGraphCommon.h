@@ -33,7 +33,8 @@ class QnnGraph {
         backend_(backend),
         context_(context),
         profile_level_(profile_level),
-        graph_name_(graph_name) {}
+        graph_name_(graph_name),
+        supports_async_execute_(false) {}
 
   virtual ~QnnGraph(){};
 
@@ -43,6 +44,18 @@ class QnnGraph {
       const std::vector<Qnn_Tensor_t>& input_tensor_structs,
       std::vector<Qnn_Tensor_t>& output_tensor_structs);
 
+  // Queues an execution of the graph with the backend and waits for its
+  // completion. The backend can then queue the executions of several threads,
+  // e.g. of a pool of Methods sharing the context, instead of running them one
+  // call at a time. Executions are not profiled.
+  Qnn_ErrorHandle_t GraphExecuteAsync(
+      const std::vector<Qnn_Tensor_t>& input_tensor_structs,
+      std::vector<Qnn_Tensor_t>& output_tensor_structs);
+
+  bool SupportsAsyncExecute() const {
+    return supports_async_execute_;
+  }
+
   Qnn_ErrorHandle_t GraphAddNode(const Qnn_OpConfig_t& op_config) {
     return implementation_.GetQnnInterface().qnn_graph_add_node(
         handle_, op_config);
@@ -61,6 +74,10 @@ class QnnGraph {
     return handle_;
   }
 
+  const std::string& GetGraphName() const {
+    return graph_name_;
+  }
+
  protected:
   virtual Error MakeConfig(std::vector<const QnnGraph_Config_t*>& config) {
     return Error::Ok;
@@ -74,6 +91,7 @@ class QnnGraph {
   QnnExecuTorchProfileLevel profile_level_;
   std::string graph_name_;
   std::unique_ptr<QnnProfile> profile_;
+  bool supports_async_execute_;
 };
 } // namespace qnn
 } // namespace executor
@@ -6,24 +6,55 @@
  * LICENSE file in the root directory of this source tree.
  */
 #include <executorch/backends/qualcomm/runtime/backends/QnnMemManager.h>
+#include "HTP/QnnHtpMem.h"
 
 namespace torch {
 namespace executor {
 namespace qnn {
 
-bool QnnMemManager::IsRegistered(Qnn_MemHandle_t handle) {
-  return registered_set_.count(handle) != 0U;
+Qnn_MemHandle_t QnnMemManager::GetRegisteredHandle(
+    const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+    void* mem_ptr) {
+  auto it = registered_map_.find({tensor_wrapper.get(), mem_ptr});
+  return it == registered_map_.end() ? nullptr : it->second;
 }
 
-Error QnnMemManager::RegisterMem(
+Error QnnMemManager::RegisterIonMem(
     const std::shared_ptr<TensorWrapper>& tensor_wrapper,
-    int32_t mem_fd) {
-  const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
+    int32_t mem_fd,
+    void* mem_ptr) {
   Qnn_MemDescriptor_t descriptor = {
       {tensor_wrapper->GetRank(), tensor_wrapper->GetDims(), nullptr},
       tensor_wrapper->GetDataType(),
       QNN_MEM_TYPE_ION,
       {{mem_fd}}};
+  return RegisterMem(tensor_wrapper, mem_ptr, descriptor);
+}
+
+Error QnnMemManager::RegisterCustomMem(
+    const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+    int32_t mem_fd,
+    void* mem_ptr,
+    size_t total_mem_size,
+    size_t offset) {
+  QnnMemHtp_Descriptor_t htp_descriptor;
+  htp_descriptor.type = QNN_HTP_MEM_SHARED_BUFFER;
+  htp_descriptor.size = total_mem_size;
+  htp_descriptor.sharedBufferConfig = {mem_fd, offset};
+  Qnn_MemDescriptor_t descriptor = {
+      {tensor_wrapper->GetRank(), tensor_wrapper->GetDims(), nullptr},
+      tensor_wrapper->GetDataType(),
+      QNN_MEM_TYPE_CUSTOM,
+      {{mem_fd}}};
+  descriptor.customInfo = &htp_descriptor;
+  return RegisterMem(tensor_wrapper, mem_ptr, descriptor);
+}
+
+Error QnnMemManager::RegisterMem(
+    const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+    void* mem_ptr,
+    const Qnn_MemDescriptor_t& descriptor) {
+  const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
   Qnn_MemHandle_t handle = nullptr;
   Qnn_ErrorHandle_t error = QNN_SUCCESS;
   error = qnn_interface.qnn_mem_register(
@@ -39,7 +70,7 @@ Error QnnMemManager::RegisterMem(
     return Error::Internal;
   }
   tensor_wrapper->SetMemHandle(handle);
-  registered_set_.insert(handle);
+  registered_map_[{tensor_wrapper.get(), mem_ptr}] = handle;
   QNN_EXECUTORCH_LOG_INFO(
       "Tensor %s is successfully registered to shared memory.",
       tensor_wrapper->GetName().c_str());
@@ -50,15 +81,16 @@ void QnnMemManager::DeRegisterMem() {
   const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
   Qnn_ErrorHandle_t error = QNN_SUCCESS;
 
-  for (auto& mem_handle : registered_set_) {
-    error = qnn_interface.qnn_mem_de_register(&mem_handle, /*numHandles=*/1);
+  for (auto& registration : registered_map_) {
+    error = qnn_interface.qnn_mem_de_register(
+        &registration.second, /*numHandles=*/1);
     if (error != QNN_SUCCESS) {
       QNN_EXECUTORCH_LOG_WARN(
           "Failed to de-register shared memory. Error %d",
           QNN_GET_ERROR_CODE(error));
     }
   }
-  registered_set_.clear();
+  registered_map_.clear();
 }
 
 } // namespace qnn
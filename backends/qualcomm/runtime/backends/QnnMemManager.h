@@ -9,7 +9,8 @@
 #include <executorch/backends/qualcomm/aot/wrappers/TensorWrapper.h>
 #include <executorch/backends/qualcomm/runtime/backends/QnnContextCommon.h>
 #include <executorch/backends/qualcomm/runtime/backends/QnnImplementation.h>
-#include <unordered_set>
+#include <map>
+#include <utility>
 
 namespace torch {
 namespace executor {
@@ -25,18 +26,44 @@ class QnnMemManager {
     DeRegisterMem();
   }
 
-  Error RegisterMem(
+  // Register a shared buffer that starts at mem_ptr and only holds the data
+  // of tensor_wrapper, e.g. one allocated via QnnExecuTorchAllocCustomMem.
+  Error RegisterIonMem(
+      const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+      int32_t mem_fd,
+      void* mem_ptr);
+
+  // Register the data of tensor_wrapper at mem_ptr, which lies offset bytes
+  // into a shared buffer of total_mem_size bytes, e.g. a tensor in a
+  // memory-planned buffer. This uses the HTP shared buffer memory type.
+  Error RegisterCustomMem(
       const std::shared_ptr<TensorWrapper>& tensor_wrapper,
-      int32_t mem_fd);
+      int32_t mem_fd,
+      void* mem_ptr,
+      size_t total_mem_size,
+      size_t offset);
 
-  bool IsRegistered(Qnn_MemHandle_t handle);
+  // Return the handle of an earlier registration of the data of
+  // tensor_wrapper at mem_ptr, or nullptr if there is none. Handles stay
+  // registered until the QnnMemManager is destroyed, so that each buffer is
+  // only registered once rather than on every execution.
+  Qnn_MemHandle_t GetRegisteredHandle(
+      const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+      void* mem_ptr);
 
  private:
+  Error RegisterMem(
+      const std::shared_ptr<TensorWrapper>& tensor_wrapper,
+      void* mem_ptr,
+      const Qnn_MemDescriptor_t& descriptor);
+
   void DeRegisterMem();
 
   const QnnImplementation& implementation_;
   QnnContext* context_;
-  std::unordered_set<Qnn_MemHandle_t> registered_set_;
+  // A handle describes the shape and data type of the tensor as well as its
+  // memory, so registrations are keyed by both.
+  std::map<std::pair<TensorWrapper*, void*>, Qnn_MemHandle_t> registered_map_;
 };
 } // namespace qnn
 } // namespace executor
@@ -89,11 +89,10 @@ Qnn_ErrorHandle_t QnnProfile::ProfileData(EventTracer* event_tracer) {
         if (sub_event_data.type == QNN_PROFILE_EVENTTYPE_NODE &&
             (sub_event_data.unit == QNN_PROFILE_EVENTUNIT_MICROSEC ||
              sub_event_data.unit == QNN_PROFILE_EVENTUNIT_CYCLES)) {
-          torch::executor::event_tracer_log_profiling_delegate(
+          torch::executor::log_delegate_node_event(
               event_tracer,
               sub_event_data.identifier,
-              /*delegate_debug_id=*/
-              static_cast<torch::executor::DebugHandle>(-1),
+              torch::executor::kDelegateNamedEventId,
               0,
               sub_event_data.value);
         }
@@ -10,7 +10,7 @@
 #include <executorch/backends/qualcomm/runtime/QnnExecuTorch.h>
 #include <executorch/backends/qualcomm/runtime/backends/QnnBackendCommon.h>
 #include <executorch/backends/qualcomm/runtime/backends/QnnImplementation.h>
-#include <executorch/runtime/core/event_tracer_hooks_delegate.h>
+#include <executorch/runtime/backend/delegate_profiling.h>
 #include "QnnProfile.h"
 namespace torch {
 namespace executor {
@@ -281,7 +281,7 @@ std::vector<QnnHtpPerfInfrastructure_PowerConfig_t> SetRpcPollingPowerConfig(
 
 HtpDevice::~HtpDevice() {
   if (htp_perf_infra_ != nullptr && powerconfig_client_id_ != 0 &&
-      !down_vote_power_configs_ptr_.empty()) {
+      voted_performance_mode_ != QnnExecuTorchHtpPerformanceMode::kHtpDefault) {
     htp_perf_infra_->setPowerConfig(
         powerconfig_client_id_, down_vote_power_configs_ptr_.data());
     htp_perf_infra_->destroyPowerConfigId(powerconfig_client_id_);
@@ -358,67 +358,78 @@ Error HtpDevice::MakeConfig(std::vector<const QnnDevice_Config_t*>& config) {
   return Error::Ok;
 }
 
-void HtpDevice::PerformanceVote() {
-  if (IsPerfModeEnabled()) {
-    htp_perf_infra_->setPowerConfig(
-        powerconfig_client_id_, perf_power_configs_ptr_.data());
+Error HtpDevice::CreatePowerConfigId() {
+  if (htp_perf_infra_ != nullptr) {
+    return Error::Ok;
   }
-};
+  const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
+  Qnn_ErrorHandle_t error = QNN_SUCCESS;
 
-void HtpDevice::ReleasePerformanceVote() {
-  if (IsPerfModeEnabled()) {
-    htp_perf_infra_->setPowerConfig(
-        powerconfig_client_id_, down_vote_power_configs_ptr_.data());
+  // Get htp_perf_infra
+  if (GetPerfInfra(qnn_interface, &owned_htp_perf_infra_) != Error::Ok) {
+    return Error::Internal;
   }
-};
-
-Error HtpDevice::AfterCreateDevice() {
-  if (IsPerfModeEnabled()) {
-    const QnnInterface& qnn_interface = implementation_.GetQnnInterface();
-    Qnn_ErrorHandle_t error = QNN_SUCCESS;
 
-    // Get htp_perf_infra
-    htp_perf_infra_ = &owned_htp_perf_infra_;
-    if (GetPerfInfra(qnn_interface, htp_perf_infra_) != Error::Ok) {
-      return Error::Internal;
-    }
+  // Get power client id
+  error = owned_htp_perf_infra_.createPowerConfigId(
+      /*device_id=*/0, /*core_id=*/0, &powerconfig_client_id_);
 
-    // Get power client id
-    error = htp_perf_infra_->createPowerConfigId(
-        /*device_id=*/0, /*core_id=*/0, &powerconfig_client_id_);
+  if (error != QNN_SUCCESS) {
+    QNN_EXECUTORCH_LOG_ERROR(
+        "HTP backend unable to create "
+        "power config. Error %d",
+        QNN_GET_ERROR_CODE(error));
+    return Error::Internal;
+  }
+  htp_perf_infra_ = &owned_htp_perf_infra_;
+
+  down_vote_power_configs_ = SetVotePowerConfig(
+      powerconfig_client_id_,
+      QnnExecuTorchHtpPerformanceMode::kHtpDefault,
+      PerformanceModeVoteType::kDownVote);
+  down_vote_power_configs_ptr_ =
+      ObtainNullTermPtrVector(down_vote_power_configs_);
+  return Error::Ok;
+}
 
-    if (error != QNN_SUCCESS) {
-      QNN_EXECUTORCH_LOG_ERROR(
-          "HTP backend unable to create "
-          "power config. Error %d",
-          QNN_GET_ERROR_CODE(error));
-      return Error::Internal;
-    }
+Error HtpDevice::SetPerformanceMode(
+    QnnExecuTorchHtpPerformanceMode performance_mode) {
+  std::lock_guard<std::mutex> lock(vote_mutex_);
+  if (performance_mode == voted_performance_mode_) {
+    return Error::Ok;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      CreatePowerConfigId() == Error::Ok,
+      Internal,
+      "Fail to create HTP power config");
 
-    // Set vector of PowerConfigs and map it to a vector of pointers.
+  if (performance_mode == QnnExecuTorchHtpPerformanceMode::kHtpDefault) {
+    htp_perf_infra_->setPowerConfig(
+        powerconfig_client_id_, down_vote_power_configs_ptr_.data());
+  } else {
     perf_power_configs_ = SetVotePowerConfig(
         powerconfig_client_id_,
-        htp_options_->performance_mode(),
+        performance_mode,
         PerformanceModeVoteType::kUpVote);
     perf_power_configs_ptr_ = ObtainNullTermPtrVector(perf_power_configs_);
+    htp_perf_infra_->setPowerConfig(
+        powerconfig_client_id_, perf_power_configs_ptr_.data());
+  }
 
-    down_vote_power_configs_ = SetVotePowerConfig(
-        powerconfig_client_id_,
-        QnnExecuTorchHtpPerformanceMode::kHtpDefault,
-        PerformanceModeVoteType::kDownVote);
-    down_vote_power_configs_ptr_ =
-        ObtainNullTermPtrVector(down_vote_power_configs_);
-
-    // vote immediately
-    PerformanceVote();
+  // Set Rpc polling mode, polling only pays off in the high power modes
+  rpc_power_configs_ = SetRpcPollingPowerConfig(performance_mode);
+  rpc_power_configs_ptr_ = ObtainNullTermPtrVector(rpc_power_configs_);
+  htp_perf_infra_->setPowerConfig(
+      powerconfig_client_id_, rpc_power_configs_ptr_.data());
 
-    // Set Rpc polling mode
-    rpc_power_configs_ =
-        SetRpcPollingPowerConfig(htp_options_->performance_mode());
-    rpc_power_configs_ptr_ = ObtainNullTermPtrVector(rpc_power_configs_);
+  voted_performance_mode_ = performance_mode;
+  return Error::Ok;
+}
 
-    htp_perf_infra_->setPowerConfig(
-        powerconfig_client_id_, rpc_power_configs_ptr_.data());
+Error HtpDevice::AfterCreateDevice() {
+  if (IsPerfModeEnabled()) {
+    // vote immediately
+    return SetPerformanceMode(htp_options_->performance_mode());
   }
 
   return Error::Ok;
@@ -11,6 +11,7 @@
 #include <executorch/backends/qualcomm/runtime/backends/htpbackend/HtpDeviceCustomConfig.h>
 #include <executorch/backends/qualcomm/runtime/backends/htpbackend/HtpDevicePlatformInfoConfig.h>
 #include <memory>
+#include <mutex>
 
 #include "HTP/QnnHtpDevice.h"
 
@@ -44,14 +45,24 @@ class HtpDevice : public QnnDevice {
     kDownVote = 2,
   };
 
+  // Vote for performance_mode, or release the vote for kHtpDefault. This
+  // overrides the performance_mode of the options until
+  // RestorePerformanceMode() is called. See HtpPerformanceVoteGuard.
+  Error SetPerformanceMode(QnnExecuTorchHtpPerformanceMode performance_mode);
+
+  // Go back to the performance_mode of the options
+  Error RestorePerformanceMode() {
+    return SetPerformanceMode(htp_options_->performance_mode());
+  }
+
  protected:
   Error MakeConfig(std::vector<const QnnDevice_Config_t*>& config) override;
 
   Error AfterCreateDevice() override;
 
  private:
-  void PerformanceVote();
-  void ReleasePerformanceVote();
+  // Obtain the perf infrastructure and a power config client id on first use
+  Error CreatePowerConfigId();
 
   inline bool IsPerfModeEnabled() {
     return htp_options_->performance_mode() !=
@@ -90,6 +101,12 @@ class HtpDevice : public QnnDevice {
 
   const SocInfo* qcom_target_soc_info_;
   const QnnExecuTorchHtpBackendOptions* htp_options_;
+
+  // The mode currently voted for, kHtpDefault if there is no vote. Delegates
+  // sharing the device may vote from different threads.
+  QnnExecuTorchHtpPerformanceMode voted_performance_mode_{
+      QnnExecuTorchHtpPerformanceMode::kHtpDefault};
+  std::mutex vote_mutex_;
 };
 } // namespace qnn
 } // namespace executor
@@ -200,6 +200,7 @@ def generate_qnn_executorch_compiler_spec(
     tensor_dump_output_path: str = "",
     profile: bool = False,
     shared_buffer: bool = False,
+    graph_name: str = "executorch",
 ) -> List[CompileSpec]:
     """
     Helper function generating compiler specs for Qualcomm AI Engine Direct
@@ -227,6 +228,11 @@ def generate_qnn_executorch_compiler_spec(
             profile the performance of each operator with cycle unit.
         shared_buffer: Enables usage of shared buffer between application
             and backend for graph I/O.
+        graph_name: Name of the QNN graph of the delegate. When several
+            delegates load the same context binary holding several graphs,
+            e.g. the prefill and decode graphs of an LLM, this selects the
+            graph of each delegate. They share a single QNN context at
+            runtime.
 
     Returns:
         List[CompileSpec]: Compiler specs for Qualcomm AI Engine Direct.
@@ -242,7 +248,7 @@ def generate_qnn_executorch_compiler_spec(
     qnn_executorch_options = QnnExecuTorchOptions(
         _soc_info_table[soc_model], backend_options
     )
-    qnn_executorch_options.graph_name = "executorch"
+    qnn_executorch_options.graph_name = graph_name
     qnn_executorch_options.log_level = (
         QnnExecuTorchLogLevel.kLogLevelDebug
         if debug
@@ -0,0 +1,402 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import operator
+from typing import List, Optional, Tuple
+
+import torch
+from executorch.exir.dialects._ops import ops as exir_ops
+from executorch.exir.pass_base import ExportPass, PassResult
+from torch.library import impl, impl_abstract
+
+# Fused operators with optimized kernels in kernels/optimized/fused_ops.yaml.
+# Each one computes a chain of ATen operators in a single pass through memory.
+fused_lib = torch.library.Library("fused", "DEF")
+
+fused_lib.define("mul_add(Tensor self, Tensor scale, Tensor shift) -> Tensor")
+fused_lib.define(
+    "mul_add.out(Tensor self, Tensor scale, Tensor shift, *, "
+    "Tensor(a!) out) -> Tensor(a!)"
+)
+
+fused_lib.define(
+    "addmm_gelu(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, "
+    'Scalar alpha=1, str approximate="none") -> Tensor'
+)
+fused_lib.define(
+    "addmm_gelu.out(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, "
+    'Scalar alpha=1, str approximate="none", Tensor(a!) out) -> Tensor(a!)'
+)
+
+fused_lib.define("rms_norm(Tensor input, Tensor? weight, float eps) -> Tensor")
+fused_lib.define(
+    "rms_norm.out(Tensor input, Tensor? weight, float eps, *, "
+    "Tensor(a!) out) -> Tensor(a!)"
+)
+
+# `activation` is one of "none", "relu" or "silu".
+fused_lib.define(
+    "group_norm_act(Tensor input, Tensor? weight, Tensor? bias, int N, int C, "
+    "int HxW, int group, float eps, str activation) -> Tensor"
+)
+fused_lib.define(
+    "group_norm_act.out(Tensor input, Tensor? weight, Tensor? bias, int N, "
+    "int C, int HxW, int group, float eps, str activation, *, "
+    "Tensor(a!) out) -> Tensor(a!)"
+)
+
+fused_lib.define(
+    "batch_norm_act(Tensor input, Tensor? weight, Tensor? bias, "
+    "Tensor running_mean, Tensor running_var, float eps, str activation) "
+    "-> Tensor"
+)
+fused_lib.define(
+    "batch_norm_act.out(Tensor input, Tensor? weight, Tensor? bias, "
+    "Tensor running_mean, Tensor running_var, float eps, str activation, *, "
+    "Tensor(a!) out) -> Tensor(a!)"
+)
+
+
+@impl(fused_lib, "mul_add", "CompositeExplicitAutograd")
+def mul_add(
+    self: torch.Tensor, scale: torch.Tensor, shift: torch.Tensor
+) -> torch.Tensor:
+    return torch.ops.aten.add.Tensor(torch.ops.aten.mul.Tensor(self, scale), shift)
+
+
+@impl_abstract("fused::mul_add.out")
+def mul_add_out_meta(
+    self: torch.Tensor,
+    scale: torch.Tensor,
+    shift: torch.Tensor,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return mul_add(self, scale, shift)
+
+
+@impl(fused_lib, "addmm_gelu", "CompositeExplicitAutograd")
+def addmm_gelu(
+    self: torch.Tensor,
+    mat1: torch.Tensor,
+    mat2: torch.Tensor,
+    beta: float = 1,
+    alpha: float = 1,
+    approximate: str = "none",
+) -> torch.Tensor:
+    return torch.ops.aten.gelu.default(
+        torch.ops.aten.addmm.default(self, mat1, mat2, beta=beta, alpha=alpha),
+        approximate=approximate,
+    )
+
+
+@impl_abstract("fused::addmm_gelu.out")
+def addmm_gelu_out_meta(
+    self: torch.Tensor,
+    mat1: torch.Tensor,
+    mat2: torch.Tensor,
+    beta: float = 1,
+    alpha: float = 1,
+    approximate: str = "none",
+    out: Optional[torch.Tensor] = None,
+) -> torch.Tensor:
+    return addmm_gelu(self, mat1, mat2, beta, alpha, approximate)
+
+
+@impl(fused_lib, "rms_norm", "CompositeExplicitAutograd")
+def rms_norm(
+    input: torch.Tensor, weight: Optional[torch.Tensor], eps: float
+) -> torch.Tensor:
+    out = input * torch.rsqrt((input * input).mean(-1, keepdim=True) + eps)
+    return out if weight is None else out * weight
+
+
+@impl_abstract("fused::rms_norm.out")
+def rms_norm_out_meta(
+    input: torch.Tensor,
+    weight: Optional[torch.Tensor],
+    eps: float,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return rms_norm(input, weight, eps)
+
+
+def _apply_norm_activation(x: torch.Tensor, activation: str) -> torch.Tensor:
+    if activation == "relu":
+        return torch.ops.aten.relu.default(x)
+    if activation == "silu":
+        return torch.ops.aten.silu.default(x)
+    assert activation == "none", f"Unsupported activation: {activation}"
+    return x
+
+
+@impl(fused_lib, "group_norm_act", "CompositeExplicitAutograd")
+def group_norm_act(
+    input: torch.Tensor,
+    weight: Optional[torch.Tensor],
+    bias: Optional[torch.Tensor],
+    N: int,
+    C: int,
+    HxW: int,
+    group: int,
+    eps: float,
+    activation: str,
+) -> torch.Tensor:
+    out = torch.ops.aten.native_group_norm.default(
+        input, weight, bias, N, C, HxW, group, eps
+    )[0]
+    return _apply_norm_activation(out, activation)
+
+
+@impl_abstract("fused::group_norm_act.out")
+def group_norm_act_out_meta(
+    input: torch.Tensor,
+    weight: Optional[torch.Tensor],
+    bias: Optional[torch.Tensor],
+    N: int,
+    C: int,
+    HxW: int,
+    group: int,
+    eps: float,
+    activation: str,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return group_norm_act(input, weight, bias, N, C, HxW, group, eps, activation)
+
+
+@impl(fused_lib, "batch_norm_act", "CompositeExplicitAutograd")
+def batch_norm_act(
+    input: torch.Tensor,
+    weight: Optional[torch.Tensor],
+    bias: Optional[torch.Tensor],
+    running_mean: torch.Tensor,
+    running_var: torch.Tensor,
+    eps: float,
+    activation: str,
+) -> torch.Tensor:
+    out = torch.ops.aten._native_batch_norm_legit_no_training.default(
+        input, weight, bias, running_mean, running_var, 0.0, eps
+    )[0]
+    return _apply_norm_activation(out, activation)
+
+
+@impl_abstract("fused::batch_norm_act.out")
+def batch_norm_act_out_meta(
+    input: torch.Tensor,
+    weight: Optional[torch.Tensor],
+    bias: Optional[torch.Tensor],
+    running_mean: torch.Tensor,
+    running_var: torch.Tensor,
+    eps: float,
+    activation: str,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return batch_norm_act(
+        input, weight, bias, running_mean, running_var, eps, activation
+    )
+
+
+_MUL_ADD_DTYPES = (torch.float32, torch.float64, torch.int32, torch.int64)
+_ADDMM_GELU_DTYPES = (torch.float32, torch.float64)
+_NORM_ACT_DTYPES = (torch.float32, torch.float64)
+
+
+def _get_tensor_val(arg: object) -> Optional[torch.Tensor]:
+    if not isinstance(arg, torch.fx.Node):
+        return None
+    val = arg.meta.get("val", None)
+    return val if isinstance(val, torch.Tensor) else None
+
+
+def _is_single_use(node: object, target: object) -> bool:
+    return (
+        isinstance(node, torch.fx.Node)
+        and node.op == "call_function"
+        and node.target == target
+        and len(node.users) == 1
+    )
+
+
+class FuseOpChainsPass(ExportPass):
+    """
+    Rewrites chains of edge operators into the fused operators defined above,
+    so that the optimized kernel library runs each chain as one kernel:
+
+    - mul.Tensor -> add.Tensor (scale and shift) becomes fused.mul_add
+    - addmm -> gelu becomes fused.addmm_gelu
+    - native_group_norm -> relu or silu becomes fused.group_norm_act
+    - _native_batch_norm_legit_no_training -> relu or silu becomes
+      fused.batch_norm_act
+
+    fused.rms_norm has no edge chain to match, since RMSNorm decomposes into
+    several elementwise ops; models call it directly instead.
+
+    A chain is only fused when its intermediate result has no other users and
+    all of its tensors share a dtype the fused kernel supports. Run this pass
+    on the edge program before to_executorch(), and only when the program
+    will be run with the optimized kernels.
+    """
+
+    def _fuse_mul_add(self, graph: torch.fx.Graph, add: torch.fx.Node) -> bool:
+        if add.kwargs.get("alpha", 1) != 1 or len(add.args) != 2:
+            return False
+        mul_target = exir_ops.edge.aten.mul.Tensor
+        # Addition commutes, so the mul can feed either operand.
+        if _is_single_use(add.args[0], mul_target):
+            mul, shift = add.args
+        elif _is_single_use(add.args[1], mul_target):
+            shift, mul = add.args
+        else:
+            return False
+        self_node, scale = mul.args
+
+        vals = [_get_tensor_val(n) for n in (self_node, scale, shift, add)]
+        if any(val is None for val in vals):
+            return False
+        if any(val.dtype != vals[-1].dtype for val in vals):
+            return False
+        if vals[-1].dtype not in _MUL_ADD_DTYPES:
+            return False
+
+        with graph.inserting_before(add):
+            fused = graph.call_function(
+                exir_ops.edge.fused.mul_add.default,
+                (self_node, scale, shift),
+            )
+        fused.meta = add.meta
+        add.replace_all_uses_with(fused)
+        graph.erase_node(add)
+        graph.erase_node(mul)
+        return True
+
+    def _fuse_addmm_gelu(self, graph: torch.fx.Graph, gelu: torch.fx.Node) -> bool:
+        addmm = gelu.args[0]
+        if not _is_single_use(addmm, exir_ops.edge.aten.addmm.default):
+            return False
+
+        vals = [_get_tensor_val(n) for n in addmm.args[:3] + (gelu,)]
+        if any(val is None for val in vals):
+            return False
+        if any(val.dtype != vals[-1].dtype for val in vals):
+            return False
+        if vals[-1].dtype not in _ADDMM_GELU_DTYPES:
+            return False
+
+        if len(gelu.args) > 1:
+            approximate = gelu.args[1]
+        else:
+            approximate = gelu.kwargs.get("approximate", "none")
+        kwargs = {
+            "beta": addmm.kwargs.get("beta", 1),
+            "alpha": addmm.kwargs.get("alpha", 1),
+            "approximate": approximate,
+        }
+        with graph.inserting_before(gelu):
+            fused = graph.call_function(
+                exir_ops.edge.fused.addmm_gelu.default,
+                tuple(addmm.args[:3]),
+                kwargs,
+            )
+        fused.meta = gelu.meta
+        gelu.replace_all_uses_with(fused)
+        graph.erase_node(gelu)
+        graph.erase_node(addmm)
+        return True
+
+    def _match_activation(
+        self, act: torch.fx.Node
+    ) -> Optional[Tuple[str, object, List[torch.fx.Node]]]:
+        """
+        Returns the name of the activation `act` computes, its input, and the
+        nodes that compute it, if `act` ends a relu or silu. Edge programs
+        carry silu decomposed as mul(x, sigmoid(x)).
+        """
+        if act.target == exir_ops.edge.aten.relu.default:
+            return "relu", act.args[0], [act]
+        if act.target == exir_ops.edge.aten.silu.default:
+            return "silu", act.args[0], [act]
+        if act.target == exir_ops.edge.aten.mul.Tensor and len(act.args) == 2:
+            sigmoid_target = exir_ops.edge.aten.sigmoid.default
+            for x, sigmoid in (act.args, reversed(act.args)):
+                if _is_single_use(sigmoid, sigmoid_target) and sigmoid.args[0] is x:
+                    return "silu", x, [act, sigmoid]
+        return None
+
+    def _fuse_norm_act(self, graph: torch.fx.Graph, act: torch.fx.Node) -> bool:
+        match = self._match_activation(act)
+        if match is None:
+            return False
+        activation, getitem, act_nodes = match
+
+        # The normalization yields (out, mean, rstd); only `out` may be used,
+        # and only by the activation.
+        if not (
+            isinstance(getitem, torch.fx.Node)
+            and getitem.op == "call_function"
+            and getitem.target == operator.getitem
+            and getitem.args[1] == 0
+            and set(getitem.users) <= set(act_nodes)
+        ):
+            return False
+        norm = getitem.args[0]
+        if not isinstance(norm, torch.fx.Node) or len(norm.users) != 1:
+            return False
+        if norm.target == exir_ops.edge.aten.native_group_norm.default:
+            fused_target = exir_ops.edge.fused.group_norm_act.default
+            input, weight, bias, N, C, HxW, group, eps = norm.args
+            args = (input, weight, bias, N, C, HxW, group, eps, activation)
+            tensors = (input, weight, bias)
+        elif (
+            norm.target
+            == exir_ops.edge.aten._native_batch_norm_legit_no_training.default
+        ):
+            fused_target = exir_ops.edge.fused.batch_norm_act.default
+            input, weight, bias, running_mean, running_var, _, eps = norm.args
+            args = (input, weight, bias, running_mean, running_var, eps, activation)
+            tensors = (input, weight, bias, running_mean, running_var)
+        else:
+            return False
+
+        vals = [_get_tensor_val(n) for n in tensors if n is not None]
+        vals.append(_get_tensor_val(act))
+        if any(val is None for val in vals):
+            return False
+        if any(val.dtype != vals[-1].dtype for val in vals):
+            return False
+        if vals[-1].dtype not in _NORM_ACT_DTYPES:
+            return False
+
+        with graph.inserting_before(act):
+            fused = graph.call_function(fused_target, args)
+        fused.meta = act.meta
+        act.replace_all_uses_with(fused)
+        for node in act_nodes + [getitem, norm]:
+            graph.erase_node(node)
+        return True
+
+    def call(self, graph_module: torch.fx.GraphModule) -> PassResult:
+        graph = graph_module.graph
+        modified = False
+        for node in list(graph.nodes):
+            if node.op != "call_function":
+                continue
+            if node.target == exir_ops.edge.aten.add.Tensor:
+                modified |= self._fuse_mul_add(graph, node)
+            elif node.target == exir_ops.edge.aten.gelu.default:
+                modified |= self._fuse_addmm_gelu(graph, node)
+            elif node.target in (
+                exir_ops.edge.aten.relu.default,
+                exir_ops.edge.aten.silu.default,
+                exir_ops.edge.aten.mul.Tensor,
+            ):
+                modified |= self._fuse_norm_act(graph, node)
+
+        if modified:
+            graph.eliminate_dead_code()
+            graph_module.recompile()
+            graph_module = super().call(graph_module).graph_module
+        return PassResult(graph_module, modified)
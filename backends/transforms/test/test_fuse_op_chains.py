@@ -0,0 +1,185 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import unittest
+
+import torch
+from executorch.backends.transforms.fuse_op_chains import FuseOpChainsPass
+from executorch.exir import to_edge
+from executorch.exir.dialects._ops import ops as exir_ops
+from torch.export import export
+
+
+def _count(graph_module: torch.fx.GraphModule, target) -> int:
+    return sum(
+        1
+        for node in graph_module.graph.nodes
+        if node.op == "call_function" and node.target == target
+    )
+
+
+class TestFuseOpChainsPass(unittest.TestCase):
+    def _run_pass(self, module, inputs):
+        edge = to_edge(export(module, inputs))
+        return edge.transform([FuseOpChainsPass()])
+
+    def test_mul_add(self):
+        class ScaleShift(torch.nn.Module):
+            def forward(self, x, scale, shift):
+                return x * scale + shift
+
+        inputs = (torch.randn(4, 8), torch.randn(8), torch.randn(8))
+        edge = self._run_pass(ScaleShift(), inputs)
+        graph_module = edge.exported_program().graph_module
+
+        self.assertEqual(_count(graph_module, exir_ops.edge.fused.mul_add.default), 1)
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.mul.Tensor), 0)
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.add.Tensor), 0)
+        torch.testing.assert_close(
+            edge.exported_program().module()(*inputs), ScaleShift()(*inputs)
+        )
+
+        # The out variant registered for the runtime kernel must be found.
+        edge.to_executorch()
+
+    def test_mul_with_other_users_is_not_fused(self):
+        class ReusedProduct(torch.nn.Module):
+            def forward(self, x, scale, shift):
+                y = x * scale
+                return y + shift, y
+
+        inputs = (torch.randn(4, 8), torch.randn(8), torch.randn(8))
+        edge = self._run_pass(ReusedProduct(), inputs)
+        graph_module = edge.exported_program().graph_module
+
+        self.assertEqual(_count(graph_module, exir_ops.edge.fused.mul_add.default), 0)
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.mul.Tensor), 1)
+
+    def test_addmm_gelu(self):
+        class LinearGelu(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.linear = torch.nn.Linear(16, 32)
+
+            def forward(self, x):
+                return torch.nn.functional.gelu(self.linear(x), approximate="tanh")
+
+        module = LinearGelu().eval()
+        inputs = (torch.randn(4, 16),)
+        edge = self._run_pass(module, inputs)
+        graph_module = edge.exported_program().graph_module
+
+        fused = [
+            node
+            for node in graph_module.graph.nodes
+            if node.target == exir_ops.edge.fused.addmm_gelu.default
+        ]
+        self.assertEqual(len(fused), 1)
+        self.assertEqual(fused[0].kwargs["approximate"], "tanh")
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.gelu.default), 0)
+        torch.testing.assert_close(
+            edge.exported_program().module()(*inputs), module(*inputs)
+        )
+
+    def test_rms_norm_exports(self):
+        class Norm(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.weight = torch.nn.Parameter(torch.randn(8))
+
+            def forward(self, x):
+                return torch.ops.fused.rms_norm(x, self.weight, 1e-6)
+
+        module = Norm().eval()
+        inputs = (torch.randn(4, 8),)
+        edge = self._run_pass(module, inputs)
+        graph_module = edge.exported_program().graph_module
+
+        self.assertEqual(
+            _count(graph_module, exir_ops.edge.fused.rms_norm.default), 1
+        )
+        x = inputs[0]
+        expected = x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + 1e-6)
+        torch.testing.assert_close(module(x), expected * module.weight)
+        edge.to_executorch()
+
+    def test_group_norm_silu(self):
+        class GroupNormSilu(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.norm = torch.nn.GroupNorm(4, 16)
+
+            def forward(self, x):
+                return torch.nn.functional.silu(self.norm(x))
+
+        module = GroupNormSilu().eval()
+        inputs = (torch.randn(2, 16, 8, 8),)
+        edge = self._run_pass(module, inputs)
+        graph_module = edge.exported_program().graph_module
+
+        fused = [
+            node
+            for node in graph_module.graph.nodes
+            if node.target == exir_ops.edge.fused.group_norm_act.default
+        ]
+        self.assertEqual(len(fused), 1)
+        self.assertEqual(fused[0].args[-1], "silu")
+        self.assertEqual(
+            _count(graph_module, exir_ops.edge.aten.native_group_norm.default), 0
+        )
+        torch.testing.assert_close(
+            edge.exported_program().module()(*inputs), module(*inputs)
+        )
+        edge.to_executorch()
+
+    def test_batch_norm_relu(self):
+        class BatchNormRelu(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.norm = torch.nn.BatchNorm2d(16)
+
+            def forward(self, x):
+                return torch.relu(self.norm(x))
+
+        module = BatchNormRelu()
+        # Non-trivial running statistics, so that they are actually applied.
+        module.train()(torch.randn(4, 16, 8, 8) * 3 + 1)
+        module.eval()
+        inputs = (torch.randn(2, 16, 8, 8),)
+        edge = self._run_pass(module, inputs)
+        graph_module = edge.exported_program().graph_module
+
+        fused = [
+            node
+            for node in graph_module.graph.nodes
+            if node.target == exir_ops.edge.fused.batch_norm_act.default
+        ]
+        self.assertEqual(len(fused), 1)
+        self.assertEqual(fused[0].args[-1], "relu")
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.relu.default), 0)
+        torch.testing.assert_close(
+            edge.exported_program().module()(*inputs), module(*inputs)
+        )
+        edge.to_executorch()
+
+    def test_norm_with_other_users_is_not_fused(self):
+        class ReusedNorm(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.norm = torch.nn.GroupNorm(4, 16)
+
+            def forward(self, x):
+                y = self.norm(x)
+                return torch.relu(y), y
+
+        inputs = (torch.randn(2, 16, 8, 8),)
+        edge = self._run_pass(ReusedNorm().eval(), inputs)
+        graph_module = edge.exported_program().graph_module
+
+        self.assertEqual(
+            _count(graph_module, exir_ops.edge.fused.group_norm_act.default), 0
+        )
+        self.assertEqual(_count(graph_module, exir_ops.edge.aten.relu.default), 1)
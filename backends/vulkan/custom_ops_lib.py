@@ -0,0 +1,48 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import torch
+from torch.library import impl, Library
+
+namespace = "et_vk"
+lib = Library(namespace, "DEF")
+
+############################
+## linear_weight_int4 ##
+############################
+
+lib.define(
+    "linear_weight_int4(Tensor self, Tensor weight, int group_size, Tensor scales_and_zeros) -> Tensor"
+)
+
+
+@impl(lib, "linear_weight_int4", "CompositeExplicitAutograd")
+def linear_weight_int4_impl(
+    x: torch.Tensor,
+    weight: torch.Tensor,
+    group_size: int,
+    scales_and_zeros: torch.Tensor,
+) -> torch.Tensor:
+    """
+    Weight only groupwise int4 quantized linear, i.e. x @ w.T where w is the
+    dequantized weight of sizes (N, K).
+
+    `weight` is a uint8 tensor of sizes (N, K / 2) that holds two unsigned 4 bit
+    values per byte, with the value of the even column in the lower nibble.
+    `scales_and_zeros` has sizes (K / group_size, N, 2), and each group of
+    `group_size` values of a row is dequantized as (q - 8) * scale + zero.
+    """
+    n, k_half = weight.shape
+    k = 2 * k_half
+    q = torch.stack([weight & 0x0F, weight >> 4], dim=-1).reshape(n, k)
+    q = q.to(x.dtype) - 8
+    scales = scales_and_zeros[:, :, 0].t().repeat_interleave(group_size, dim=1)
+    zeros = scales_and_zeros[:, :, 1].t().repeat_interleave(group_size, dim=1)
+    w = q * scales.to(x.dtype) + zeros.to(x.dtype)
+    return torch.nn.functional.linear(x, w)
+
+
+linear_weight_int4_op = getattr(getattr(torch.ops, namespace), "linear_weight_int4")
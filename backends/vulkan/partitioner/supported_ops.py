@@ -6,6 +6,8 @@
 
 import operator
 
+import executorch.backends.vulkan.custom_ops_lib  # noqa
+
 from executorch.exir.dialects._ops import ops as exir_ops
 
 
@@ -72,6 +74,11 @@ MATMUL_OPS = [
     exir_ops.edge.aten.linear.default,
 ]
 
+QUANTIZED_MATMUL_OPS = [
+    exir_ops.edge.aten._weight_int8pack_mm.default,
+    exir_ops.edge.et_vk.linear_weight_int4.default,
+]
+
 POOLING_OPS = [
     exir_ops.edge.aten.max_pool2d_with_indices.default,
 ]
@@ -142,6 +149,7 @@ def register_dynamic_shape_ops(ops: OpList):
         *BINARY_OPS,
         *UNARY_OPS,
         *MATMUL_OPS,
+        *QUANTIZED_MATMUL_OPS,
         *POOLING_OPS,
         *CONVOLUTION_OPS,
     ]:
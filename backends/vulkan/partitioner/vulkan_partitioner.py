@@ -118,6 +118,9 @@ def parse_compile_options(compile_options: Dict[str, Any]) -> List[CompileSpec]:
         ):
             value_bytes = int(value).to_bytes(4, byteorder="little")
             compile_specs.append(CompileSpec(key, value_bytes))
+        elif isinstance(value, bool):
+            value_bytes = int(value).to_bytes(4, byteorder="little")
+            compile_specs.append(CompileSpec(key, value_bytes))
 
         # Unhandled options are ignored
 
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+namespace torch {
+namespace executor {
+namespace vulkan {
+
+/**
+ * Vulkan delegates lowered with the `async_execute` compile option submit
+ * their work to the GPU and return from execute without waiting for it, so
+ * that the host can do other work while the GPU runs. Their output tensors
+ * are only valid once this function returns.
+ *
+ * Every Vulkan delegate waits for all pending executions before it runs, so
+ * outputs that are only consumed by other Vulkan delegates do not need an
+ * explicit wait. Any other consumer, including non-delegated ops of the same
+ * Method, must not run before this function was called; the option is meant
+ * for models that are fully delegated to Vulkan.
+ *
+ * NOTE: Prototype API; subject to change.
+ */
+void experimental_wait_for_async_executions();
+
+} // namespace vulkan
+} // namespace executor
+} // namespace torch
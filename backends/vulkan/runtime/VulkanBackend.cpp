@@ -6,13 +6,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/backends/vulkan/runtime/VulkanAsyncExecution.h>
 #include <executorch/backends/vulkan/runtime/VulkanDelegateHeader.h>
+#include <executorch/backends/vulkan/runtime/VulkanHostVisibleAllocator.h>
 #include <executorch/backends/vulkan/schema_generated.h>
 
 #include <executorch/backends/vulkan/runtime/graph/ComputeGraph.h>
 
 #include <executorch/backends/vulkan/runtime/graph/ops/OperatorRegistry.h>
 
+#include <executorch/runtime/backend/delegate_profiling.h>
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/evalue.h>
@@ -20,11 +23,14 @@
 #include <executorch/runtime/platform/compiler.h>
 #include <executorch/runtime/platform/profiler.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib> /* strtol */
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <unordered_set>
 #include <vector>
 
 namespace torch {
@@ -105,6 +111,9 @@ api::GPUMemoryLayout get_memory_layout(
 
 GraphConfig get_graph_config(ArrayRef<CompileSpec>& compile_specs) {
   GraphConfig config = GraphConfig();
+  // Intermediates are only accessed by the graph itself, so their memory can
+  // be planned at runtime when it was not planned ahead of time.
+  config.enable_memory_planning = true;
 
   for (const CompileSpec& spec : compile_specs) {
     const uint8_t* value_data = (const uint8_t*)spec.value.buffer;
@@ -125,6 +134,18 @@ GraphConfig get_graph_config(ArrayRef<CompileSpec>& compile_specs) {
 
       config.set_memory_layout_override(memory_layout);
     }
+    if (strcmp(spec.key, "async_execute") == 0) {
+      ET_CHECK_MSG(value_size == sizeof(uint32_t), "Unexpected value size!");
+      config.enable_async_execute = getUInt32LE(value_data) != 0;
+    }
+    if (strcmp(spec.key, "workgroup_autotuning") == 0) {
+      ET_CHECK_MSG(value_size == sizeof(uint32_t), "Unexpected value size!");
+      config.enable_workgroup_autotuning = getUInt32LE(value_data) != 0;
+    }
+    if (strcmp(spec.key, "fp16_storage") == 0) {
+      ET_CHECK_MSG(value_size == sizeof(uint32_t), "Unexpected value size!");
+      config.enable_fp16_storage = getUInt32LE(value_data) != 0;
+    }
   }
   return config;
 }
@@ -135,6 +156,8 @@ class GraphBuilder {
   const uint8_t* constant_data_;
 
   std::unordered_map<uint32_t, ValueRef> ref_mapping_;
+  // Graph inputs and outputs, whose dtype is seen by the caller
+  std::unordered_set<uint32_t> io_fb_ids_;
 
  public:
   explicit GraphBuilder(
@@ -144,7 +167,13 @@ class GraphBuilder {
       : compute_graph_(compute_graph),
         flatbuffer_(flatbuffer),
         constant_data_(constant_data),
-        ref_mapping_() {}
+        ref_mapping_(),
+        io_fb_ids_(
+            flatbuffer->input_ids()->cbegin(),
+            flatbuffer->input_ids()->cend()) {
+    io_fb_ids_.insert(
+        flatbuffer->output_ids()->cbegin(), flatbuffer->output_ids()->cend());
+  }
 
   bool fb_id_exists(const uint32_t fb_id) {
     const std::unordered_map<uint32_t, ValueRef>::iterator found_ref =
@@ -165,7 +194,7 @@ class GraphBuilder {
   }
 
   void add_tensor_to_graph(const uint32_t fb_id, VkTensorPtr tensor_fb) {
-    const api::ScalarType& dtype = get_scalar_type(tensor_fb->datatype());
+    api::ScalarType dtype = get_scalar_type(tensor_fb->datatype());
     api::StorageType storage_type =
         tensor_fb->storage_type() == vkgraph::VkStorageType::DEFAULT_STORAGE
         ? compute_graph_->suggested_storage_type()
@@ -186,6 +215,10 @@ class GraphBuilder {
 
       ref = compute_graph_->add_tensorref(dims_vector, dtype, tensor_data);
     } else {
+      if (io_fb_ids_.count(fb_id) == 0) {
+        dtype =
+            compute_graph_->suggested_intermediate_dtype(dtype, storage_type);
+      }
       ref = compute_graph_->add_tensor(
           dims_vector,
           dtype,
@@ -383,6 +416,89 @@ void maybe_resize_output(
   ET_CHECK_MSG(err == Error::Ok, "Failed to resize output tensor.");
 }
 
+/*
+ * Returns the allocator that holds the data of `et_tensor` if the tensor can
+ * be bound in place of the staging buffer at `staging`, and nullptr if it has
+ * to be copied through the staging buffer instead.
+ */
+VulkanHostVisibleAllocator* find_bindable_allocator(
+    ComputeGraph* graph,
+    const ValueRef staging,
+    const exec_aten::Tensor& et_tensor) {
+  const void* data = et_tensor.const_data_ptr();
+  const size_t nbytes = et_tensor.nbytes();
+  if (nbytes == 0 || data == nullptr ||
+      et_tensor.element_size() !=
+          api::element_size(graph->get_staging(staging)->dtype())) {
+    return nullptr;
+  }
+  VulkanHostVisibleAllocator* allocator =
+      VulkanHostVisibleAllocator::find(data, nbytes);
+  if (allocator == nullptr ||
+      !allocator->is_bindable(allocator->offset_of(data))) {
+    return nullptr;
+  }
+  return allocator;
+}
+
+/*
+ * Binds the staging buffer at `staging` to the data of `et_tensor` if
+ * possible, or to the graph's own staging buffer otherwise. Returns true if
+ * the binding changed.
+ */
+bool update_staging_binding(
+    ComputeGraph* graph,
+    const ValueRef staging,
+    const exec_aten::Tensor& et_tensor) {
+  VulkanHostVisibleAllocator* allocator =
+      find_bindable_allocator(graph, staging, et_tensor);
+  if (allocator == nullptr) {
+    return graph->reset_staging_binding(staging);
+  }
+  const void* data = et_tensor.const_data_ptr();
+  return graph->bind_staging_to_buffer(
+      staging,
+      allocator->buffer(),
+      allocator->offset_of(data),
+      et_tensor.nbytes());
+}
+
+//
+// Async execution
+//
+
+struct PendingInvalidation final {
+  VulkanHostVisibleAllocator* allocator;
+  const void* data;
+  size_t nbytes;
+};
+
+// Graphs with an execution that was submitted but not waited for, and the
+// host visible outputs of those executions.
+struct AsyncExecutions final {
+  std::mutex mutex;
+  std::vector<ComputeGraph*> graphs;
+  std::vector<PendingInvalidation> invalidations;
+};
+
+AsyncExecutions& async_executions() {
+  static AsyncExecutions executions;
+  return executions;
+}
+
+void wait_for_async_executions() {
+  AsyncExecutions& executions = async_executions();
+  std::lock_guard<std::mutex> guard(executions.mutex);
+  for (ComputeGraph* graph : executions.graphs) {
+    graph->wait_for_execution();
+  }
+  for (const PendingInvalidation& pending : executions.invalidations) {
+    pending.allocator->invalidate(pending.data, pending.nbytes);
+  }
+  executions.graphs.clear();
+  executions.invalidations.clear();
+}
+
 //
 // VulkanBackend class
 //
@@ -430,11 +546,29 @@ class VulkanBackend final : public PyTorchBackendInterface {
 
     compute_graph->prepare();
 
+    const MemoryPlanningStats& stats = compute_graph->memory_planning_stats();
+    if (stats.num_tensors > 0) {
+      ET_LOG(
+          Info,
+          "Vulkan memory planning: %zu tensors in %zu allocations, %zu bytes "
+          "instead of %zu bytes",
+          stats.num_tensors,
+          stats.num_allocations,
+          stats.planned_bytes,
+          stats.unplanned_bytes);
+    }
+
     compute_graph->encode_prepack();
     compute_graph->prepack();
 
     compute_graph->encode_execute();
 
+    // Persist the pipelines compiled and the workgroup sizes tuned for this
+    // model right away, in case the process does not exit cleanly.
+    api::Context* const context = compute_graph->context();
+    context->pipeline_cache().save_cache();
+    context->adapter_ptr()->workgroup_size_cache().save_cache();
+
     return Error::Ok;
   }
 
@@ -447,7 +581,12 @@ class VulkanBackend final : public PyTorchBackendInterface {
 
     new (compute_graph) ComputeGraph(get_graph_config(compile_specs));
 
-    Error err = compileModel(processed->data(), compute_graph);
+    Error err;
+    {
+      DelegateProfilingScope compile_scope(
+          context.event_tracer(), DelegateProfilingEventType::kCompile);
+      err = compileModel(processed->data(), compute_graph);
+    }
 
     // This backend does not need its processed data after compiling the model.
     processed->Free();
@@ -456,42 +595,116 @@ class VulkanBackend final : public PyTorchBackendInterface {
       return err;
     }
 
+    // GPU memory of the intermediate tensors whose memory was planned.
+    log_delegate_memory_usage(
+        context.event_tracer(),
+        compute_graph->memory_planning_stats().planned_bytes);
+
     return compute_graph;
   }
 
   Error execute(
-      __ET_UNUSED BackendExecutionContext& context,
+      BackendExecutionContext& context,
       DelegateHandle* handle,
       EValue** args) const override {
     EXECUTORCH_SCOPE_PROF("VulkanBackend::execute");
+    EventTracer* event_tracer = context.event_tracer();
 
     ComputeGraph* compute_graph = static_cast<ComputeGraph*>(handle);
 
+    // Inputs may be the outputs of a pending execution, and the staging
+    // buffers of this graph may still be in use.
+    wait_for_async_executions();
+
     const size_t num_inputs = compute_graph->inputs().size();
+    const size_t num_outputs = compute_graph->outputs().size();
     bool should_propagate_resize = false;
     for (size_t i = 0; i < num_inputs; i++) {
       bool was_resized =
           maybe_resize_input(compute_graph, i, args[i]->toTensor());
       should_propagate_resize = should_propagate_resize || was_resized;
-      compute_graph->copy_into_staging(
-          compute_graph->inputs()[i].staging,
-          args[i]->toTensor().const_data_ptr(),
-          args[i]->toTensor().numel());
     }
 
     if (should_propagate_resize) {
       compute_graph->propagate_resize();
     }
-    compute_graph->execute();
 
-    for (size_t i = 0; i < compute_graph->outputs().size(); i++) {
+    // args holds inputs directly followed by outputs, so the i'th output for
+    // compute_graph corresponds to the (i + num_inputs)'th arg. The outputs
+    // are resized up front so that their final size is known when binding
+    // their memory.
+    for (size_t i = 0; i < num_outputs; i++) {
       maybe_resize_output(compute_graph, i, args[num_inputs + i]->toTensor());
-      // args holds inputs directly followed by outputs, so the i'th output
-      // for compute_graph corresponds to the (i + num_inputs)'th arg
-      compute_graph->copy_from_staging(
-          compute_graph->outputs()[i].staging,
-          args[num_inputs + i]->toTensor().mutable_data_ptr(),
-          args[num_inputs + i]->toTensor().numel());
+    }
+
+    // Tensors allocated by a VulkanHostVisibleAllocator are bound directly.
+    // The command buffer only has to be encoded again when a binding changes.
+    bool should_encode = false;
+    for (size_t i = 0; i < num_inputs + num_outputs; i++) {
+      const ValueRef staging = i < num_inputs
+          ? compute_graph->inputs()[i].staging
+          : compute_graph->outputs()[i - num_inputs].staging;
+      bool was_rebound =
+          update_staging_binding(compute_graph, staging, args[i]->toTensor());
+      should_encode = should_encode || was_rebound;
+    }
+
+    {
+      DelegateProfilingScope transfer_scope(
+          event_tracer, DelegateProfilingEventType::kDataTransfer);
+      for (size_t i = 0; i < num_inputs; i++) {
+        const ValueRef staging = compute_graph->inputs()[i].staging;
+        const exec_aten::Tensor& tensor = args[i]->toTensor();
+        VulkanHostVisibleAllocator* allocator =
+            find_bindable_allocator(compute_graph, staging, tensor);
+        if (allocator != nullptr) {
+          allocator->flush(tensor.const_data_ptr(), tensor.nbytes());
+        } else {
+          compute_graph->copy_into_staging(
+              staging, tensor.const_data_ptr(), tensor.numel());
+        }
+      }
+    }
+
+    const bool async = compute_graph->graphconfig().enable_async_execute;
+    {
+      // In async mode this only covers the submission of the command buffer.
+      DelegateProfilingScope execute_scope(
+          event_tracer, DelegateProfilingEventType::kExecute);
+      if (should_encode) {
+        compute_graph->encode_execute();
+      }
+
+      if (!async) {
+        compute_graph->execute();
+      } else {
+        compute_graph->submit_execute();
+      }
+    }
+
+    AsyncExecutions& executions = async_executions();
+    std::unique_lock<std::mutex> guard(executions.mutex, std::defer_lock);
+    if (async) {
+      guard.lock();
+      executions.graphs.push_back(compute_graph);
+    }
+
+    // In async mode the outputs are completed by the next call to
+    // wait_for_async_executions().
+    for (size_t i = 0; i < num_outputs; i++) {
+      const ValueRef staging = compute_graph->outputs()[i].staging;
+      exec_aten::Tensor& tensor = args[num_inputs + i]->toTensor();
+      VulkanHostVisibleAllocator* allocator =
+          find_bindable_allocator(compute_graph, staging, tensor);
+      if (allocator != nullptr && async) {
+        executions.invalidations.push_back(
+            {allocator, tensor.const_data_ptr(), tensor.nbytes()});
+      } else if (allocator != nullptr) {
+        allocator->invalidate(tensor.const_data_ptr(), tensor.nbytes());
+      } else {
+        compute_graph->copy_from_staging_deferred(
+            staging, tensor.mutable_data_ptr(), tensor.numel());
+      }
     }
 
     return Error::Ok;
@@ -500,6 +713,14 @@ class VulkanBackend final : public PyTorchBackendInterface {
   void destroy(DelegateHandle* handle) const override {
     if (handle != nullptr) {
       ComputeGraph* compute_graph = static_cast<ComputeGraph*>(handle);
+      {
+        AsyncExecutions& executions = async_executions();
+        std::lock_guard<std::mutex> guard(executions.mutex);
+        auto& graphs = executions.graphs;
+        graphs.erase(
+            std::remove(graphs.begin(), graphs.end(), compute_graph),
+            graphs.end());
+      }
       // ComputeGraph is not trivially destructible. Since
       // this was constructed manually in init(), we must destroy it manually
       // here.
@@ -513,6 +734,11 @@ Backend backend{"VulkanBackend", &cls};
 static auto success_with_compiler = register_backend(backend);
 
 } // namespace
+
+void experimental_wait_for_async_executions() {
+  wait_for_async_executions();
+}
+
 } // namespace vulkan
 } // namespace executor
 } // namespace torch
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/vulkan/runtime/VulkanHostVisibleAllocator.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace vulkan {
+namespace {
+
+using namespace vkcompute;
+
+std::mutex& registry_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// All live allocators, so that the delegate can find the buffer that holds
+// the data of a tensor.
+std::vector<VulkanHostVisibleAllocator*>& registry() {
+  static std::vector<VulkanHostVisibleAllocator*> allocators;
+  return allocators;
+}
+
+api::Adapter* adapter() {
+  return api::runtime()->get_adapter_p();
+}
+
+uint8_t* map_buffer(const api::VulkanBuffer& buffer) {
+  void* data = nullptr;
+  VK_CHECK(vmaMapMemory(buffer.vma_allocator(), buffer.allocation(), &data));
+  return static_cast<uint8_t*>(data);
+}
+
+} // namespace
+
+VulkanHostVisibleAllocator::VulkanHostVisibleAllocator(uint32_t size)
+    : VulkanHostVisibleAllocator(
+          adapter()->vma().create_storage_buffer(size, /*gpu_only = */ false)) {
+}
+
+VulkanHostVisibleAllocator::VulkanHostVisibleAllocator(
+    api::VulkanBuffer&& buffer)
+    : MemoryAllocator(
+          api::utils::safe_downcast<uint32_t>(buffer.mem_size()),
+          map_buffer(buffer)),
+      buffer_(std::move(buffer)),
+      offset_alignment_(
+          std::max<VkDeviceSize>(
+              adapter()->min_storage_buffer_offset_alignment(),
+              1u)) {
+  std::lock_guard<std::mutex> guard(registry_mutex());
+  registry().push_back(this);
+}
+
+VulkanHostVisibleAllocator::~VulkanHostVisibleAllocator() {
+  {
+    std::lock_guard<std::mutex> guard(registry_mutex());
+    auto& allocators = registry();
+    allocators.erase(
+        std::remove(allocators.begin(), allocators.end(), this),
+        allocators.end());
+  }
+  vmaUnmapMemory(buffer_.vma_allocator(), buffer_.allocation());
+}
+
+void* VulkanHostVisibleAllocator::allocate(size_t size, size_t alignment) {
+  return MemoryAllocator::allocate(
+      size, std::max(alignment, static_cast<size_t>(offset_alignment_)));
+}
+
+VulkanHostVisibleAllocator* VulkanHostVisibleAllocator::find(
+    const void* data,
+    size_t nbytes) {
+  const uint8_t* begin = static_cast<const uint8_t*>(data);
+  std::lock_guard<std::mutex> guard(registry_mutex());
+  for (VulkanHostVisibleAllocator* allocator : registry()) {
+    const uint8_t* base = allocator->base_address();
+    if (begin >= base && begin + nbytes <= base + allocator->size()) {
+      return allocator;
+    }
+  }
+  return nullptr;
+}
+
+void VulkanHostVisibleAllocator::flush(const void* data, size_t nbytes) const {
+  VK_CHECK(vmaFlushAllocation(
+      buffer_.vma_allocator(), buffer_.allocation(), offset_of(data), nbytes));
+}
+
+void VulkanHostVisibleAllocator::invalidate(const void* data, size_t nbytes)
+    const {
+  VK_CHECK(vmaInvalidateAllocation(
+      buffer_.vma_allocator(), buffer_.allocation(), offset_of(data), nbytes));
+}
+
+} // namespace vulkan
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/backends/vulkan/runtime/api/api.h>
+
+#include <executorch/runtime/core/memory_allocator.h>
+
+namespace torch {
+namespace executor {
+namespace vulkan {
+
+/**
+ * A MemoryAllocator that hands out memory from a single host visible Vulkan
+ * buffer, which stays mapped for the lifetime of the allocator.
+ *
+ * Tensors placed in this memory, e.g. by using it for the planned buffers of
+ * a Method or for the data of user provided inputs, are bound directly by the
+ * Vulkan delegate instead of being copied into and out of the staging
+ * buffers of the delegate on every execution. Tensors that do not start at a
+ * multiple of the storage buffer offset alignment of the device fall back to
+ * the staging copies.
+ *
+ * The allocator must outlive every Method that executed with tensors in its
+ * memory, and must only be used with the default Vulkan adapter.
+ *
+ * NOTE: Prototype API; subject to change.
+ */
+class VulkanHostVisibleAllocator final : public MemoryAllocator {
+ public:
+  /**
+   * Creates an allocator backed by a new buffer of `size` bytes.
+   */
+  explicit VulkanHostVisibleAllocator(uint32_t size);
+
+  VulkanHostVisibleAllocator(const VulkanHostVisibleAllocator&) = delete;
+  VulkanHostVisibleAllocator& operator=(const VulkanHostVisibleAllocator&) =
+      delete;
+  VulkanHostVisibleAllocator(VulkanHostVisibleAllocator&&) = delete;
+  VulkanHostVisibleAllocator& operator=(VulkanHostVisibleAllocator&&) = delete;
+
+  ~VulkanHostVisibleAllocator() override;
+
+  /**
+   * Allocates `size` bytes, aligned to at least the storage buffer offset
+   * alignment of the device so that the memory can be bound directly.
+   */
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override;
+
+  /**
+   * Returns the allocator whose buffer holds the `nbytes` bytes at `data`, or
+   * nullptr if there is none.
+   */
+  static VulkanHostVisibleAllocator* find(const void* data, size_t nbytes);
+
+  inline const vkcompute::api::VulkanBuffer& buffer() const {
+    return buffer_;
+  }
+
+  /**
+   * Returns the offset of `data` in the buffer. `data` must be in the buffer.
+   */
+  inline VkDeviceSize offset_of(const void* data) const {
+    return static_cast<VkDeviceSize>(
+        static_cast<const uint8_t*>(data) - base_address());
+  }
+
+  /**
+   * Returns true if the memory at `offset` can be bound to a shader.
+   */
+  inline bool is_bindable(VkDeviceSize offset) const {
+    return offset % offset_alignment_ == 0;
+  }
+
+  /**
+   * Makes host writes to the `nbytes` bytes at `data` visible to the device.
+   * Does nothing if the memory is host coherent.
+   */
+  void flush(const void* data, size_t nbytes) const;
+
+  /**
+   * Makes device writes to the `nbytes` bytes at `data` visible to the host.
+   * Does nothing if the memory is host coherent.
+   */
+  void invalidate(const void* data, size_t nbytes) const;
+
+ private:
+  VulkanHostVisibleAllocator(vkcompute::api::VulkanBuffer&& buffer);
+
+  vkcompute::api::VulkanBuffer buffer_;
+  VkDeviceSize offset_alignment_;
+};
+
+} // namespace vulkan
+} // namespace executor
+} // namespace torch
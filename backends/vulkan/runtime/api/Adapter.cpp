@@ -265,6 +265,29 @@ std::string get_queue_family_properties_str(const VkQueueFlags flags) {
   return ss.str();
 }
 
+// The cache data of one device and driver cannot be used by another, so every
+// device and driver gets its own files in the cache directory.
+std::string get_device_cache_path(
+    const VkPhysicalDeviceProperties& properties,
+    const std::string& cache_data_dir,
+    const std::string& cache_name,
+    const std::string& extension) {
+  if (cache_data_dir.empty()) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << cache_data_dir << "/vulkan_" << cache_name << "_" << std::hex
+     << std::setfill('0') << std::setw(8) << properties.vendorID << "_"
+     << std::setw(8) << properties.deviceID << "_" << std::setw(8)
+     << properties.driverVersion << "_";
+  for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+    ss << std::setw(2)
+       << static_cast<uint32_t>(properties.pipelineCacheUUID[i]);
+  }
+  ss << extension;
+  return ss.str();
+}
+
 } // namespace
 
 //
@@ -293,7 +316,7 @@ Adapter::Adapter(
     VkInstance instance,
     PhysicalDevice physical_device,
     const uint32_t num_queues,
-    const std::string& cache_data_path)
+    const std::string& cache_data_dir)
     : queue_usage_mutex_{},
       physical_device_(std::move(physical_device)),
       queues_{},
@@ -308,7 +331,19 @@ Adapter::Adapter(
       shader_layout_cache_(device_.handle_),
       shader_cache_(device_.handle_),
       pipeline_layout_cache_(device_.handle_),
-      compute_pipeline_cache_(device_.handle_, cache_data_path),
+      compute_pipeline_cache_(
+          device_.handle_,
+          physical_device_.properties,
+          get_device_cache_path(
+              physical_device_.properties,
+              cache_data_dir,
+              "pipeline_cache",
+              ".bin")),
+      workgroup_size_cache_(get_device_cache_path(
+          physical_device_.properties,
+          cache_data_dir,
+          "workgroup_sizes",
+          ".txt")),
       sampler_cache_(device_.handle_),
       vma_(instance_, physical_device_.handle, device_.handle_) {}
 
@@ -15,6 +15,7 @@
 #include <executorch/backends/vulkan/runtime/api/Pipeline.h>
 #include <executorch/backends/vulkan/runtime/api/Shader.h>
 #include <executorch/backends/vulkan/runtime/api/Utils.h>
+#include <executorch/backends/vulkan/runtime/api/WorkgroupSizeCache.h>
 
 #include <executorch/backends/vulkan/runtime/api/memory/Allocator.h>
 
@@ -102,7 +103,7 @@ class Adapter final {
       VkInstance instance,
       PhysicalDevice physical_device,
       const uint32_t num_queues,
-      const std::string& cache_data_path);
+      const std::string& cache_data_dir);
 
   Adapter(const Adapter&) = delete;
   Adapter& operator=(const Adapter&) = delete;
@@ -137,6 +138,7 @@ class Adapter final {
   ShaderCache shader_cache_;
   PipelineLayoutCache pipeline_layout_cache_;
   ComputePipelineCache compute_pipeline_cache_;
+  WorkgroupSizeCache workgroup_size_cache_;
   // Memory Management
   SamplerCache sampler_cache_;
   Allocator vma_;
@@ -168,6 +170,14 @@ class Adapter final {
     return physical_device_.timestamp_period;
   }
 
+  inline VkDeviceSize min_storage_buffer_offset_alignment() const {
+    return physical_device_.properties.limits.minStorageBufferOffsetAlignment;
+  }
+
+  inline const VkPhysicalDeviceLimits& limits() const {
+    return physical_device_.properties.limits;
+  }
+
   // Queue Management
 
   Queue request_queue();
@@ -191,6 +201,10 @@ class Adapter final {
     return compute_pipeline_cache_;
   }
 
+  inline WorkgroupSizeCache& workgroup_size_cache() {
+    return workgroup_size_cache_;
+  }
+
   // Memory Allocation
 
   inline SamplerCache& sampler_cache() {
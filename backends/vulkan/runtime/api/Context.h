@@ -150,6 +150,32 @@ class Context final {
   }
 #endif /* USE_VULKAN_GPU_DIAGNOSTICS */
 
+  // Time the commands recorded between shader_profile_begin() and
+  // shader_profile_end() with a QueryPool that is not owned by the context,
+  // e.g. to compare dispatch configurations.
+
+  inline void reset_querypool(QueryPool& querypool) {
+    set_cmd();
+    querypool.reset(cmd_);
+  }
+
+  inline uint32_t shader_profile_begin(
+      QueryPool& querypool,
+      const ShaderInfo& shader_descriptor,
+      const utils::uvec3& global_workgroup_size,
+      const utils::uvec3& local_workgroup_size) {
+    set_cmd();
+    return querypool.shader_profile_begin(
+        cmd_,
+        shader_descriptor.kernel_name,
+        create_extent3d(global_workgroup_size),
+        create_extent3d(local_workgroup_size));
+  }
+
+  inline void shader_profile_end(QueryPool& querypool, const uint32_t log_idx) {
+    querypool.shader_profile_end(cmd_, log_idx);
+  }
+
   // Memory Management
   void register_buffer_cleanup(VulkanBuffer& buffer) {
     std::lock_guard<std::mutex> bufferlist_lock(buffer_clearlist_mutex_);
@@ -296,6 +322,19 @@ class StorageBuffer final {
             nbytes_,
             gpuonly)) {}
 
+  // Wraps an existing buffer, usually a view into memory that is shared with
+  // the host, instead of allocating a new one.
+  StorageBuffer(
+      Context* context_p,
+      const ScalarType dtype,
+      VulkanBuffer&& buffer)
+      : context_p_(context_p),
+        dtype_(dtype),
+        numel_(utils::safe_downcast<size_t>(
+            buffer.mem_range() / element_size(dtype_))),
+        nbytes_(element_size(dtype_) * numel_),
+        vulkan_buffer_(std::move(buffer)) {}
+
   StorageBuffer(const StorageBuffer&) = delete;
   StorageBuffer& operator=(const StorageBuffer&) = delete;
 
@@ -8,6 +8,8 @@
 
 #include <executorch/backends/vulkan/runtime/api/Pipeline.h>
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
 namespace vkcompute {
@@ -366,12 +368,20 @@ void PipelineLayoutCache::purge() {
 
 ComputePipelineCache::ComputePipelineCache(
     VkDevice device,
+    const VkPhysicalDeviceProperties& properties,
     const std::string& cache_data_path)
     : cache_mutex_{},
       device_(device),
       pipeline_cache_{VK_NULL_HANDLE},
       cache_{},
-      cache_data_path_(cache_data_path) {
+      cache_data_path_(cache_data_path),
+      vendor_id_(properties.vendorID),
+      device_id_(properties.deviceID),
+      cache_uuid_{},
+      has_new_pipelines_(false) {
+  std::memcpy(
+      cache_uuid_.data(), properties.pipelineCacheUUID, cache_uuid_.size());
+
   VkPipelineCacheCreateInfo pipeline_cache_create_info{};
 
   auto buffer = load_cache();
@@ -393,7 +403,12 @@ ComputePipelineCache::ComputePipelineCache(
     : cache_mutex_{},
       device_(other.device_),
       pipeline_cache_(other.pipeline_cache_),
-      cache_(std::move(other.cache_)) {
+      cache_(std::move(other.cache_)),
+      cache_data_path_(std::move(other.cache_data_path_)),
+      vendor_id_(other.vendor_id_),
+      device_id_(other.device_id_),
+      cache_uuid_(other.cache_uuid_),
+      has_new_pipelines_(other.has_new_pipelines_) {
   std::lock_guard<std::mutex> lock(other.cache_mutex_);
 
   other.pipeline_cache_ = VK_NULL_HANDLE;
@@ -423,6 +438,7 @@ VkPipeline ComputePipelineCache::retrieve(
                  {key,
                   ComputePipelineCache::Value(device_, key, pipeline_cache_)})
              .first;
+    has_new_pipelines_ = true;
   }
 
   return it->second.handle();
@@ -449,19 +465,65 @@ std::vector<char> ComputePipelineCache::load_cache() {
 
   std::vector<char> buffer(size);
   file.read(buffer.data(), size);
+  if (file.fail()) {
+    return {};
+  }
+
+  // Drivers are supposed to reject data created by another device or driver,
+  // but not all of them do. Check the header (see VkPipelineCacheHeaderVersion
+  // in the Vulkan spec) before handing the data to the driver.
+  constexpr size_t kHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+  if (buffer.size() < kHeaderSize) {
+    return {};
+  }
+  uint32_t header[4];
+  std::memcpy(header, buffer.data(), sizeof(header));
+  const bool header_matches = header[0] >= kHeaderSize &&
+      header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+      header[2] == vendor_id_ && header[3] == device_id_ &&
+      std::memcmp(
+          buffer.data() + sizeof(header),
+          cache_uuid_.data(),
+          cache_uuid_.size()) == 0;
+  if (!header_matches) {
+    return {};
+  }
 
   return buffer;
 }
 
 void ComputePipelineCache::save_cache() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  if (cache_data_path_.empty() || !has_new_pipelines_) {
+    return;
+  }
+
   size_t size{};
-  vkGetPipelineCacheData(device_, pipeline_cache_, &size, nullptr);
+  if (vkGetPipelineCacheData(device_, pipeline_cache_, &size, nullptr) !=
+      VK_SUCCESS) {
+    return;
+  }
 
   std::vector<char> buffer(size);
-  vkGetPipelineCacheData(device_, pipeline_cache_, &size, buffer.data());
+  if (vkGetPipelineCacheData(device_, pipeline_cache_, &size, buffer.data()) !=
+      VK_SUCCESS) {
+    return;
+  }
 
-  std::ofstream file(cache_data_path_, std::ios::binary);
-  file.write(buffer.data(), buffer.size());
+  // Write to a temporary file first, so that a process that is killed while
+  // writing does not leave a truncated cache behind.
+  const std::string tmp_path = cache_data_path_ + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::binary);
+    file.write(buffer.data(), size);
+    if (file.fail()) {
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), cache_data_path_.c_str()) == 0) {
+    has_new_pipelines_ = false;
+  }
 }
 
 } // namespace api
@@ -17,6 +17,7 @@
 #include <executorch/backends/vulkan/runtime/api/memory/Buffer.h>
 #include <executorch/backends/vulkan/runtime/api/memory/Image.h>
 
+#include <array>
 #include <mutex>
 #include <unordered_map>
 
@@ -220,6 +221,7 @@ class ComputePipelineCache final {
  public:
   explicit ComputePipelineCache(
       VkDevice device,
+      const VkPhysicalDeviceProperties& properties,
       const std::string& cache_data_path);
 
   ComputePipelineCache(const ComputePipelineCache&) = delete;
@@ -271,7 +273,6 @@ class ComputePipelineCache final {
 
  private:
   std::vector<char> load_cache();
-  void save_cache();
 
   // Multiple threads could potentially be adding entries into the cache, so use
   // a mutex to manage access
@@ -280,11 +281,26 @@ class ComputePipelineCache final {
   VkDevice device_;
   VkPipelineCache pipeline_cache_;
   std::unordered_map<Key, Value, Hasher> cache_;
-  const std::string cache_data_path_;
+  std::string cache_data_path_;
+
+  // Identify the device and driver the cache data must have been created by
+  uint32_t vendor_id_;
+  uint32_t device_id_;
+  std::array<uint8_t, VK_UUID_SIZE> cache_uuid_;
+
+  // Whether pipelines were created since the cache data was last saved
+  bool has_new_pipelines_;
 
  public:
   VkPipeline retrieve(const Key&);
   void purge();
+
+  /*
+   * Write the cache data to the cache data path, if one is set and new
+   * pipelines were created since it was last written. This is also done on
+   * destruction, but processes on mobile are often killed before that.
+   */
+  void save_cache();
 };
 
 //
@@ -75,7 +75,9 @@ QueryPool::~QueryPool() {
 
 void QueryPool::reset(const CommandBuffer& cmd) {
   std::lock_guard<std::mutex> lock(mutex_);
-  cmd.reset_querypool(querypool_, 0u, in_use_);
+  // Reset every query rather than only the ones used so far, since queries
+  // must also be reset before they are used for the first time.
+  cmd.reset_querypool(querypool_, 0u, config_.max_query_count);
   previous_shader_count_ += shader_log().size();
   in_use_ = 0u;
   shader_logs_.emplace_back();
@@ -8,6 +8,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include <executorch/backends/vulkan/runtime/api/Adapter.h>
@@ -233,6 +234,21 @@ uint32_t select_first(const std::vector<Runtime::DeviceMapping>& devices) {
 // Global runtime initialization
 //
 
+std::mutex& pipeline_cache_dir_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::string& pipeline_cache_dir_storage() {
+  static std::string dir;
+  return dir;
+}
+
+std::string pipeline_cache_dir() {
+  std::lock_guard<std::mutex> lock(pipeline_cache_dir_mutex());
+  return pipeline_cache_dir_storage();
+}
+
 std::unique_ptr<Runtime> init_global_vulkan_runtime() {
   // Load Vulkan drivers
 #if defined(USE_VULKAN_VOLK)
@@ -253,14 +269,14 @@ std::unique_ptr<Runtime> init_global_vulkan_runtime() {
 #endif /* VULKAN_DEBUG */
   const bool init_default_device = true;
   const uint32_t num_requested_queues = 1; // TODO: raise this value
-  const std::string cache_data_path = ""; // TODO: expose to client
+  const std::string cache_data_dir = pipeline_cache_dir();
 
   const RuntimeConfiguration default_config{
       enable_validation_messages,
       init_default_device,
       AdapterSelector::First,
       num_requested_queues,
-      cache_data_path,
+      cache_data_dir,
   };
 
   try {
@@ -356,7 +372,7 @@ uint32_t Runtime::create_adapter(const Selector& selector) {
       instance_,
       device_mapping.first,
       config_.num_requested_queues,
-      config_.cache_data_path));
+      config_.cache_data_dir));
   device_mapping.second = adapter_i;
 
   return adapter_i;
@@ -378,5 +394,10 @@ Runtime* runtime() {
   return p_runtime.get();
 }
 
+void set_pipeline_cache_dir(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(pipeline_cache_dir_mutex());
+  pipeline_cache_dir_storage() = dir;
+}
+
 } // namespace api
 } // namespace vkcompute
@@ -39,7 +39,9 @@ struct RuntimeConfiguration final {
   bool init_default_device;
   AdapterSelector default_selector;
   uint32_t num_requested_queues;
-  std::string cache_data_path;
+  // Directory that the pipeline cache of each adapter is persisted to; empty
+  // to disable persistence
+  std::string cache_data_dir;
 };
 
 class Runtime final {
@@ -104,5 +106,10 @@ class Runtime final {
 // a static local variable.
 Runtime* runtime();
 
+// Set the directory that the global runtime persists its pipeline caches to,
+// so that pipelines compiled by the driver can be reused by later processes.
+// Only takes effect if called before the global runtime is first used.
+void set_pipeline_cache_dir(const std::string& dir);
+
 } // namespace api
 } // namespace vkcompute
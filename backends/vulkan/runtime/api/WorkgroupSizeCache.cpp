@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/vulkan/runtime/api/WorkgroupSizeCache.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace vkcompute {
+namespace api {
+
+namespace {
+
+// The cache data is a text file. The first line identifies the format, and
+// every following line holds one entry as "<key> <x> <y> <z>".
+constexpr const char* kCacheDataHeader = "vulkan_workgroup_sizes 1";
+
+} // namespace
+
+WorkgroupSizeCache::WorkgroupSizeCache(const std::string& cache_data_path)
+    : cache_mutex_{},
+      cache_{},
+      cache_data_path_(cache_data_path),
+      has_new_entries_(false) {
+  load_cache();
+}
+
+WorkgroupSizeCache::~WorkgroupSizeCache() {
+  save_cache();
+}
+
+bool WorkgroupSizeCache::find(const Key& key, Value& value) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  auto it = cache_.find(key);
+  if (cache_.cend() == it) {
+    return false;
+  }
+  value = it->second;
+  return true;
+}
+
+void WorkgroupSizeCache::insert(const Key& key, const Value& value) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  cache_[key] = value;
+  has_new_entries_ = true;
+}
+
+void WorkgroupSizeCache::load_cache() {
+  // Return if path is not specified; this means the cache is not persisted
+  if (cache_data_path_.empty()) {
+    return;
+  }
+
+  // Return if file doesn't exist; this is expected on the first model-load
+  std::ifstream file(cache_data_path_);
+  if (file.fail()) {
+    return;
+  }
+
+  std::string line;
+  if (!std::getline(file, line) || line != kCacheDataHeader) {
+    return;
+  }
+
+  while (std::getline(file, line)) {
+    std::istringstream ss(line);
+    Key key;
+    Value value;
+    ss >> key >> value.data[0u] >> value.data[1u] >> value.data[2u];
+    // Skip malformed entries, e.g. from a write that was cut short
+    if (ss.fail() || value.data[0u] == 0u || value.data[1u] == 0u ||
+        value.data[2u] == 0u) {
+      continue;
+    }
+    cache_[key] = value;
+  }
+}
+
+void WorkgroupSizeCache::save_cache() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+
+  if (cache_data_path_.empty() || !has_new_entries_) {
+    return;
+  }
+
+  // Write to a temporary file first, so that a process that is killed while
+  // writing does not leave a truncated cache behind.
+  const std::string tmp_path = cache_data_path_ + ".tmp";
+  {
+    std::ofstream file(tmp_path);
+    file << kCacheDataHeader << "\n";
+    for (const auto& entry : cache_) {
+      file << entry.first << " " << entry.second.data[0u] << " "
+           << entry.second.data[1u] << " " << entry.second.data[2u] << "\n";
+    }
+    if (file.fail()) {
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), cache_data_path_.c_str()) == 0) {
+    has_new_entries_ = false;
+  }
+}
+
+} // namespace api
+} // namespace vkcompute
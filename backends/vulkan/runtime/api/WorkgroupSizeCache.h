@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// @lint-ignore-every CLANGTIDY facebook-hte-BadMemberName
+
+#include <executorch/backends/vulkan/runtime/api/Utils.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vkcompute {
+namespace api {
+
+//
+// Holds the local workgroup sizes that were measured to be the fastest for
+// dispatches on the device of an Adapter. Entries are keyed by a string that
+// identifies the dispatch, e.g. its shader, global workgroup size and
+// specialization constants. Like the pipeline cache, the entries can be
+// persisted to a file so that the measurements are only made once per device
+// and driver.
+//
+
+class WorkgroupSizeCache final {
+ public:
+  explicit WorkgroupSizeCache(const std::string& cache_data_path);
+
+  WorkgroupSizeCache(const WorkgroupSizeCache&) = delete;
+  WorkgroupSizeCache& operator=(const WorkgroupSizeCache&) = delete;
+
+  WorkgroupSizeCache(WorkgroupSizeCache&&) = delete;
+  WorkgroupSizeCache& operator=(WorkgroupSizeCache&&) = delete;
+
+  ~WorkgroupSizeCache();
+
+  using Key = std::string;
+  using Value = utils::uvec3;
+
+ private:
+  void load_cache();
+
+  // Multiple threads could potentially be adding entries into the cache, so use
+  // a mutex to manage access
+  std::mutex cache_mutex_;
+
+  std::unordered_map<Key, Value> cache_;
+  std::string cache_data_path_;
+
+  // Whether entries were added since the cache data was last saved
+  bool has_new_entries_;
+
+ public:
+  /*
+   * Write the local workgroup size for `key` to `value` and return true if
+   * the cache has an entry for it, otherwise return false.
+   */
+  bool find(const Key& key, Value& value);
+
+  void insert(const Key& key, const Value& value);
+
+  inline size_t size() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return cache_.size();
+  }
+
+  /*
+   * Write the cache data to the cache data path, if one is set and entries
+   * were added since it was last written. This is also done on destruction.
+   */
+  void save_cache();
+};
+
+} // namespace api
+} // namespace vkcompute
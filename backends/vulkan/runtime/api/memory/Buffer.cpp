@@ -20,6 +20,7 @@ VulkanBuffer::VulkanBuffer()
       allocator_(VK_NULL_HANDLE),
       memory_{},
       owns_memory_(false),
+      is_view_(false),
       handle_(VK_NULL_HANDLE) {}
 
 VulkanBuffer::VulkanBuffer(
@@ -37,6 +38,7 @@ VulkanBuffer::VulkanBuffer(
       allocator_(vma_allocator),
       memory_{},
       owns_memory_(allocate_memory),
+      is_view_(false),
       handle_(VK_NULL_HANDLE) {
   // If the buffer size is 0, allocate a buffer with a size of 1 byte. This is
   // to ensure that there will be some resource that can be bound to a shader.
@@ -74,11 +76,36 @@ VulkanBuffer::VulkanBuffer(
   }
 }
 
+VulkanBuffer::VulkanBuffer(
+    const VulkanBuffer& buffer,
+    const VkDeviceSize offset,
+    const VkDeviceSize range)
+    : buffer_properties_({
+          range,
+          buffer.buffer_properties_.mem_offset + offset,
+          range,
+          buffer.buffer_properties_.buffer_usage,
+      }),
+      allocator_(buffer.allocator_),
+      memory_{},
+      owns_memory_(false),
+      is_view_(true),
+      handle_(buffer.handle_) {
+  VK_CHECK_COND(
+      offset + range <= buffer.buffer_properties_.mem_range,
+      "Buffer view exceeds the range of the viewed buffer!");
+  // Share the allocation so that the view can be mapped; the destructor makes
+  // sure that it is not freed through the view.
+  memory_.create_info = buffer.memory_.create_info;
+  memory_.allocation = buffer.memory_.allocation;
+}
+
 VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
     : buffer_properties_(other.buffer_properties_),
       allocator_(other.allocator_),
       memory_(std::move(other.memory_)),
       owns_memory_(other.owns_memory_),
+      is_view_(other.is_view_),
       handle_(other.handle_) {
   other.handle_ = VK_NULL_HANDLE;
 }
@@ -86,20 +113,28 @@ VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
 VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept {
   VkBuffer tmp_buffer = handle_;
   bool tmp_owns_memory = owns_memory_;
+  bool tmp_is_view = is_view_;
 
   buffer_properties_ = other.buffer_properties_;
   allocator_ = other.allocator_;
   memory_ = std::move(other.memory_);
   owns_memory_ = other.owns_memory_;
+  is_view_ = other.is_view_;
   handle_ = other.handle_;
 
   other.handle_ = tmp_buffer;
   other.owns_memory_ = tmp_owns_memory;
+  other.is_view_ = tmp_is_view;
 
   return *this;
 }
 
 VulkanBuffer::~VulkanBuffer() {
+  // Views own neither the handle nor the memory of the viewed buffer
+  if (is_view_) {
+    memory_.allocation = VK_NULL_HANDLE;
+    return;
+  }
   if (VK_NULL_HANDLE != handle_) {
     if (owns_memory_) {
       vmaDestroyBuffer(allocator_, handle_, memory_.allocation);
@@ -131,6 +166,8 @@ MemoryMap::MemoryMap(const VulkanBuffer& buffer, const uint8_t access)
       data_len_{buffer.mem_size()} {
   if (allocation_) {
     VK_CHECK(vmaMapMemory(allocator_, allocation_, &data_));
+    // Views start part of the way into the memory of the viewed buffer
+    data_ = reinterpret_cast<uint8_t*>(data_) + buffer.mem_offset();
   }
 }
 
@@ -47,6 +47,15 @@ class VulkanBuffer final {
       const VkBufferUsageFlags,
       const bool allocate_memory = true);
 
+  /*
+   * Creates a view of `range` bytes of `buffer`, starting at `offset`. The
+   * view shares the handle and memory of `buffer`, and must not outlive it.
+   */
+  explicit VulkanBuffer(
+      const VulkanBuffer& buffer,
+      const VkDeviceSize offset,
+      const VkDeviceSize range);
+
   VulkanBuffer(const VulkanBuffer&) = delete;
   VulkanBuffer& operator=(const VulkanBuffer&) = delete;
 
@@ -69,6 +78,8 @@ class VulkanBuffer final {
   Allocation memory_;
   // Indicates whether the underlying memory is owned by this resource
   bool owns_memory_;
+  // Indicates whether the handle belongs to another VulkanBuffer
+  bool is_view_;
   VkBuffer handle_;
 
  public:
@@ -114,6 +125,10 @@ class VulkanBuffer final {
     return owns_memory_;
   }
 
+  inline bool is_view() const {
+    return is_view_;
+  }
+
   operator bool() const {
     return (handle_ != VK_NULL_HANDLE);
   }
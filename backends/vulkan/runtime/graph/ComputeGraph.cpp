@@ -15,6 +15,9 @@
 
 #include <executorch/backends/vulkan/runtime/graph/ops/utils/StagingUtils.h>
 
+#include <algorithm>
+#include <sstream>
+
 namespace vkcompute {
 
 //
@@ -81,7 +84,13 @@ ComputeGraph::ComputeGraph(GraphConfig config)
 }
 
 ComputeGraph::~ComputeGraph() {
+  if (has_pending_execution()) {
+    execute_fence_.wait();
+  }
+  deferred_copies_.clear();
+
   values_.clear();
+  detached_staging_.clear();
 
   prepack_nodes_.clear();
   execute_nodes_.clear();
@@ -112,6 +121,19 @@ api::GPUMemoryLayout ComputeGraph::suggested_memory_layout(
   return api::kChannelsPacked;
 }
 
+api::ScalarType ComputeGraph::suggested_intermediate_dtype(
+    const api::ScalarType dtype,
+    const api::StorageType storage_type) {
+  // fp16 buffers would also need 16 bit arithmetic in the shaders, whereas
+  // texels are loaded as fp32 regardless of the texture format.
+  if (config_.enable_fp16_storage && dtype == api::kFloat &&
+      storage_type != api::kBuffer &&
+      context_->adapter_ptr()->has_full_float16_buffers_support()) {
+    return api::kHalf;
+  }
+  return dtype;
+}
+
 void ComputeGraph::check_no_active_value_ptrs() {
   VK_CHECK_COND(
       values_in_use_ == 0,
@@ -147,15 +169,19 @@ ValueRef ComputeGraph::add_tensor(
     const api::StorageType storage_type,
     const api::GPUMemoryLayout memory_layout,
     const int64_t shared_object_idx) {
-  bool allocate_memory = shared_object_idx < 0;
+  const bool plan_memory =
+      shared_object_idx < 0 && config_.enable_memory_planning;
+  bool allocate_memory = shared_object_idx < 0 && !plan_memory;
 
   ValueRef idx(static_cast<int>(values_.size()));
   check_no_active_value_ptrs();
   values_.emplace_back(vTensor(
       context(), sizes, dtype, storage_type, memory_layout, allocate_memory));
 
-  if (!allocate_memory) {
+  if (shared_object_idx >= 0) {
     get_shared_object(shared_object_idx).add_user(this, idx);
+  } else if (plan_memory) {
+    unplanned_tensors_.push_back(idx);
   }
   return idx;
 }
@@ -363,6 +389,50 @@ void ComputeGraph::copy_from_staging(
   copy_staging_to_ptr(*staging, data, nbytes);
 }
 
+void ComputeGraph::copy_from_staging_deferred(
+    const ValueRef idx,
+    void* data,
+    const size_t numel) {
+  if (!has_pending_execution()) {
+    copy_from_staging(idx, data, numel);
+    return;
+  }
+  deferred_copies_.push_back({idx, data, numel});
+}
+
+bool ComputeGraph::bind_staging_to_buffer(
+    const ValueRef idx,
+    const api::VulkanBuffer& buffer,
+    const VkDeviceSize offset,
+    const VkDeviceSize range) {
+  StagingPtr staging = get_staging(idx);
+  const api::VulkanBuffer& current = staging->buffer();
+  if (current.handle() == buffer.handle() &&
+      current.mem_offset() == buffer.mem_offset() + offset &&
+      current.mem_range() == range) {
+    return false;
+  }
+
+  api::StorageBuffer view(
+      context(), staging->dtype(), api::VulkanBuffer(buffer, offset, range));
+  if (!current.is_view()) {
+    detached_staging_.emplace(idx, std::move(*staging));
+  }
+  *staging = std::move(view);
+  return true;
+}
+
+bool ComputeGraph::reset_staging_binding(const ValueRef idx) {
+  auto it = detached_staging_.find(idx);
+  if (it == detached_staging_.end()) {
+    return false;
+  }
+  StagingPtr staging = get_staging(idx);
+  *staging = std::move(it->second);
+  detached_staging_.erase(it);
+  return true;
+}
+
 void ComputeGraph::prepare() {
 #define MERGE_FIELD(field)                    \
   static_cast<uint32_t>(std::ceil(            \
@@ -385,6 +455,170 @@ void ComputeGraph::prepare() {
     context_->descriptor_pool().init(config);
   }
 #undef MERGE_FIELD
+
+  plan_memory();
+}
+
+void ComputeGraph::plan_memory() {
+  if (unplanned_tensors_.empty()) {
+    return;
+  }
+
+  struct PlannedTensor final {
+    ValueRef idx;
+    size_t first_use;
+    size_t last_use;
+    VkMemoryRequirements mem_reqs;
+    api::StorageType storage_type;
+  };
+
+  struct PlannedObject final {
+    std::vector<const PlannedTensor*> users;
+    VkDeviceSize size;
+    uint32_t memory_type_bits;
+    api::StorageType storage_type;
+  };
+
+  const size_t num_nodes = execute_nodes_.size();
+  std::unordered_map<ValueRef, size_t> tensor_indices;
+  std::vector<PlannedTensor> tensors;
+  tensors.reserve(unplanned_tensors_.size());
+  for (const ValueRef idx : unplanned_tensors_) {
+    vTensorPtr t = get_tensor(idx);
+    const bool has_resource = t->storage_type() == api::kBuffer
+        ? static_cast<bool>(t->buffer())
+        : static_cast<bool>(t->image());
+    // Tensors without a resource, e.g. empty ones, do not need memory
+    if (!has_resource) {
+      continue;
+    }
+    tensor_indices[idx] = tensors.size();
+    tensors.push_back(
+        {idx, num_nodes, 0, t->get_memory_requirements(), t->storage_type()});
+  }
+  unplanned_tensors_.clear();
+
+  // Measure lifetimes in execute nodes; anything that may be accessed outside
+  // of the execute nodes lives for the whole graph.
+  const auto extend_lifetime = [&](const ValueRef idx,
+                                   const size_t first,
+                                   const size_t last) {
+    auto it = tensor_indices.find(idx);
+    if (it == tensor_indices.end()) {
+      return;
+    }
+    PlannedTensor& tensor = tensors[it->second];
+    tensor.first_use = std::min(tensor.first_use, first);
+    tensor.last_use = std::max(tensor.last_use, last);
+  };
+  for (size_t i = 0; i < num_nodes; ++i) {
+    for (const ArgGroup& arg_group : execute_nodes_[i]->args_) {
+      for (const ValueRef idx : arg_group.refs) {
+        extend_lifetime(idx, i, i);
+      }
+    }
+  }
+  for (const std::unique_ptr<PrepackNode>& node : prepack_nodes_) {
+    extend_lifetime(node->packed_, 0, num_nodes);
+  }
+  for (const IOValueRef& io : inputs_) {
+    extend_lifetime(io.value, 0, num_nodes);
+  }
+  for (const IOValueRef& io : outputs_) {
+    extend_lifetime(io.value, 0, num_nodes);
+  }
+  for (PlannedTensor& tensor : tensors) {
+    if (tensor.first_use > tensor.last_use) {
+      tensor.first_use = 0;
+      tensor.last_use = num_nodes;
+    }
+  }
+
+  // Greedy by size: place the largest tensors first, each into the first
+  // allocation of the same kind that none of its users overlap with.
+  std::vector<PlannedTensor*> by_size;
+  by_size.reserve(tensors.size());
+  for (PlannedTensor& tensor : tensors) {
+    by_size.push_back(&tensor);
+  }
+  std::stable_sort(
+      by_size.begin(),
+      by_size.end(),
+      [](const PlannedTensor* lhs, const PlannedTensor* rhs) {
+        return lhs->mem_reqs.size > rhs->mem_reqs.size;
+      });
+
+  std::vector<PlannedObject> objects;
+  for (const PlannedTensor* tensor : by_size) {
+    PlannedObject* target = nullptr;
+    for (PlannedObject& object : objects) {
+      if (object.storage_type != tensor->storage_type ||
+          (object.memory_type_bits & tensor->mem_reqs.memoryTypeBits) == 0) {
+        continue;
+      }
+      bool overlaps = false;
+      for (const PlannedTensor* user : object.users) {
+        if (user->first_use <= tensor->last_use &&
+            tensor->first_use <= user->last_use) {
+          overlaps = true;
+          break;
+        }
+      }
+      if (!overlaps) {
+        target = &object;
+        break;
+      }
+    }
+    if (target == nullptr) {
+      objects.push_back(
+          {{},
+           0u,
+           tensor->mem_reqs.memoryTypeBits,
+           tensor->storage_type});
+      target = &objects.back();
+    }
+    target->users.push_back(tensor);
+    target->size = std::max(target->size, tensor->mem_reqs.size);
+    target->memory_type_bits &= tensor->mem_reqs.memoryTypeBits;
+  }
+
+  memory_planning_stats_.num_tensors += tensors.size();
+  memory_planning_stats_.num_allocations += objects.size();
+  for (const PlannedTensor& tensor : tensors) {
+    memory_planning_stats_.unplanned_bytes += tensor.mem_reqs.size;
+  }
+
+  for (PlannedObject& object : objects) {
+    std::sort(
+        object.users.begin(),
+        object.users.end(),
+        [](const PlannedTensor* lhs, const PlannedTensor* rhs) {
+          return lhs->first_use < rhs->first_use;
+        });
+
+    planned_objects_.emplace_back();
+    SharedObject& shared_object = planned_objects_.back();
+    for (const PlannedTensor* user : object.users) {
+      shared_object.add_user(this, user->idx);
+    }
+    // add_user() merges the memory types of its users; only the memory types
+    // that every user supports can be used.
+    shared_object.aggregate_memory_requirements.memoryTypeBits =
+        object.memory_type_bits;
+    shared_object.allocate(this);
+    shared_object.bind_users(this);
+    memory_planning_stats_.planned_bytes +=
+        shared_object.aggregate_memory_requirements.size;
+
+    // The first node that uses a reused allocation has to wait for the nodes
+    // that used it before.
+    for (size_t i = 1; i < object.users.size(); ++i) {
+      if (object.users[i]->first_use < num_nodes) {
+        execute_nodes_[object.users[i]->first_use]
+            ->wait_for_prior_dispatches_ = true;
+      }
+    }
+  }
 }
 
 void ComputeGraph::encode_prepack() {
@@ -402,24 +636,242 @@ void ComputeGraph::prepack() const {
   context_->flush();
 }
 
+namespace {
+
+// Number of times each candidate is timed; the shortest time is used, which
+// hides the cost of e.g. caches that are cold on the first dispatch.
+constexpr uint32_t kTuningRuns = 3u;
+
+// Local workgroup sizes to try, in addition to the one chosen by the op
+constexpr uint32_t kLocalSizeCandidates[][3] = {
+    {64u, 1u, 1u},
+    {32u, 2u, 1u},
+    {16u, 4u, 1u},
+    {8u, 8u, 1u},
+    {4u, 16u, 1u},
+    {8u, 4u, 2u},
+    {4u, 4u, 4u},
+    {16u, 8u, 1u},
+    {8u, 8u, 2u},
+    {16u, 16u, 1u},
+    {8u, 8u, 4u},
+};
+
+bool writes_own_input(const std::vector<ArgGroup>& args) {
+  std::vector<ValueRef> read_refs;
+  for (const ArgGroup& arg : args) {
+    if (arg.access & api::MemoryAccessType::READ) {
+      read_refs.insert(read_refs.end(), arg.refs.begin(), arg.refs.end());
+    }
+  }
+  for (const ArgGroup& arg : args) {
+    if (!(arg.access & api::MemoryAccessType::WRITE)) {
+      continue;
+    }
+    for (const ValueRef ref : arg.refs) {
+      if (std::find(read_refs.begin(), read_refs.end(), ref) !=
+          read_refs.end()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Identifies the dispatches that can share a tuning result, since they run
+// the same shader code over the same number of invocations.
+std::string get_tuning_key(
+    const api::ShaderInfo& shader,
+    const api::utils::uvec3& global_workgroup_size,
+    const api::SpecVarList& spec_vars) {
+  std::stringstream ss;
+  ss << shader.kernel_name << "/" << global_workgroup_size.data[0u] << ","
+     << global_workgroup_size.data[1u] << "," << global_workgroup_size.data[2u]
+     << "/";
+  for (uint32_t i = 0; i < spec_vars.size(); ++i) {
+    const api::SpecVar& spec_var = spec_vars.at(i);
+    switch (spec_var.type) {
+      case api::SpecVar::Type::FLOAT:
+        ss << spec_var.value.as_float;
+        break;
+      case api::SpecVar::Type::INT:
+        ss << spec_var.value.as_int32;
+        break;
+      case api::SpecVar::Type::UINT:
+        ss << spec_var.value.as_uint32;
+        break;
+      case api::SpecVar::Type::BOOL:
+        ss << spec_var.value.as_bool;
+        break;
+    }
+    ss << ",";
+  }
+  return ss.str();
+}
+
+std::vector<api::utils::uvec3> get_local_size_candidates(
+    const api::ShaderInfo& shader,
+    const api::utils::uvec3& global_workgroup_size,
+    const api::utils::uvec3& default_local_size,
+    const VkPhysicalDeviceLimits& limits) {
+  std::vector<api::utils::uvec3> candidates = {default_local_size};
+  for (const auto& size : kLocalSizeCandidates) {
+    const api::utils::uvec3 candidate = {size[0u], size[1u], size[2u]};
+    if (candidate.data[0u] * candidate.data[1u] * candidate.data[2u] >
+        limits.maxComputeWorkGroupInvocations) {
+      continue;
+    }
+    bool is_useful = true;
+    for (uint32_t i = 0; i < 3u; ++i) {
+      const uint32_t num_invocations = api::utils::div_up(
+          global_workgroup_size.data[i], shader.out_tile_size.data[i]);
+      // Skip sizes that are larger than the workgroup size limit, or that
+      // would leave more than half of the invocations of a dimension idle.
+      if (candidate.data[i] > limits.maxComputeWorkGroupSize[i] ||
+          (candidate.data[i] > 1u &&
+           candidate.data[i] >= 2u * num_invocations)) {
+        is_useful = false;
+      }
+    }
+    const bool is_default = candidate.data[0u] == default_local_size.data[0u] &&
+        candidate.data[1u] == default_local_size.data[1u] &&
+        candidate.data[2u] == default_local_size.data[2u];
+    if (is_useful && !is_default) {
+      candidates.push_back(candidate);
+    }
+  }
+  return candidates;
+}
+
+} // namespace
+
+void ComputeGraph::tune_workgroup_sizes() {
+  api::Adapter* const adapter = context_->adapter_ptr();
+  if (!adapter->timestamp_compute_and_graphics()) {
+    return;
+  }
+  api::WorkgroupSizeCache& cache = adapter->workgroup_size_cache();
+
+  const api::QueryPoolConfig querypool_config{2u, 1u};
+  api::QueryPool querypool(querypool_config, adapter);
+
+  for (std::unique_ptr<ExecuteNode>& node : execute_nodes_) {
+    // Executing the node on its own would change the tensor it reads
+    if (writes_own_input(node->args_)) {
+      continue;
+    }
+
+    const std::string key = get_tuning_key(
+        node->shader_, node->global_workgroup_size_, node->spec_vars_);
+    api::utils::uvec3 local_size{};
+    if (cache.find(key, local_size)) {
+      node->local_workgroup_size_ = local_size;
+      continue;
+    }
+
+    const std::vector<api::utils::uvec3> candidates = get_local_size_candidates(
+        node->shader_,
+        node->global_workgroup_size_,
+        node->local_workgroup_size_,
+        adapter->limits());
+
+    uint64_t best_time_ns = UINT64_MAX;
+    local_size = node->local_workgroup_size_;
+    for (const api::utils::uvec3& candidate : candidates) {
+      const uint64_t time_ns = time_execute_node(*node, candidate, querypool);
+      if (time_ns < best_time_ns) {
+        best_time_ns = time_ns;
+        local_size = candidate;
+      }
+    }
+    node->local_workgroup_size_ = local_size;
+    cache.insert(key, local_size);
+  }
+}
+
+uint64_t ComputeGraph::time_execute_node(
+    ExecuteNode& node,
+    const api::utils::uvec3& local_workgroup_size,
+    api::QueryPool& querypool) {
+  node.local_workgroup_size_ = local_workgroup_size;
+
+  uint64_t min_time_ns = UINT64_MAX;
+  for (uint32_t run = 0; run < kTuningRuns; ++run) {
+    // Also releases the descriptor set of the previous run, since the
+    // descriptor pool is only sized for one execution of the graph
+    context_->flush();
+
+    context_->reset_querypool(querypool);
+    const uint32_t log_idx = context_->shader_profile_begin(
+        querypool,
+        node.shader_,
+        node.global_workgroup_size_,
+        local_workgroup_size);
+    node.encode(this);
+    context_->shader_profile_end(querypool, log_idx);
+
+    api::VulkanFence fence = context_->fences().get_fence();
+    context_->submit_cmd_to_gpu(fence.get_submit_handle());
+    fence.wait();
+    context_->fences().return_fence(fence);
+
+    querypool.extract_results();
+    querypool.shader_log_for_each([&](const api::ShaderDuration& duration) {
+      min_time_ns = std::min(min_time_ns, duration.execution_duration_ns);
+    });
+  }
+  return min_time_ns;
+}
+
 void ComputeGraph::encode_execute() {
-  context_->flush();
-  context_->set_cmd(/*reusable = */ true);
+  wait_for_execution();
+
+  // The command buffer may be encoded again when I/O bindings change, but the
+  // shared objects must only be allocated once.
+  if (!shared_objects_allocated_) {
+    for (SharedObject& shared_object : shared_objects_) {
+      shared_object.allocate(this);
+      shared_object.bind_users(this);
+    }
+    shared_objects_allocated_ = true;
+  }
 
-  for (SharedObject& shared_object : shared_objects_) {
-    shared_object.allocate(this);
-    shared_object.bind_users(this);
+  if (config_.enable_workgroup_autotuning && !workgroup_sizes_tuned_) {
+    tune_workgroup_sizes();
+    workgroup_sizes_tuned_ = true;
   }
 
+  context_->flush();
+  context_->set_cmd(/*reusable = */ true);
+
   for (std::unique_ptr<ExecuteNode>& node : execute_nodes_) {
     node->encode(this);
   }
 }
 
-void ComputeGraph::execute() const {
-  api::VulkanFence fence = context_->fences().get_fence();
-  context_->submit_cmd_to_gpu(fence.get_submit_handle());
-  fence.wait();
+void ComputeGraph::execute() {
+  submit_execute();
+  wait_for_execution();
+}
+
+void ComputeGraph::submit_execute() {
+  wait_for_execution();
+  execute_fence_ = context_->fences().get_fence();
+  context_->submit_cmd_to_gpu(execute_fence_.get_submit_handle());
+}
+
+void ComputeGraph::wait_for_execution() {
+  if (!has_pending_execution()) {
+    return;
+  }
+  execute_fence_.wait();
+  // Fences are reset after waiting, so this one can be used again.
+  context_->fences().return_fence(execute_fence_);
+
+  for (const DeferredCopy& copy : deferred_copies_) {
+    copy_from_staging(copy.staging, copy.data, copy.numel);
+  }
+  deferred_copies_.clear();
 }
 
 void ComputeGraph::resize_input(
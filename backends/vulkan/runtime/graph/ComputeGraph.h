@@ -11,6 +11,7 @@
 // @lint-ignore-every CLANGTIDY facebook-hte-BadMemberName
 
 #include <optional>
+#include <unordered_map>
 
 #include <executorch/backends/vulkan/runtime/api/api.h>
 
@@ -70,6 +71,18 @@ DECL_VALUE_PTR_CLASS(ValueListPtr, std::vector<ValueRef>)
 // ComputeGraph
 //
 
+/*
+ * GPU memory used by the tensors whose memory was planned by `prepare()`.
+ */
+struct MemoryPlanningStats final {
+  size_t num_tensors = 0;
+  size_t num_allocations = 0;
+  // Bytes the tensors would use if each had its own allocation
+  size_t unplanned_bytes = 0;
+  // Bytes of the allocations that the tensors share instead
+  size_t planned_bytes = 0;
+};
+
 /*
  * This is the core data structure used to execute Vulkan models in graph mode.
  * As opposed to ATen/eager mode where a command buffer is encoded every
@@ -103,6 +116,28 @@ class ComputeGraph final {
   std::vector<IOValueRef> inputs_;
   std::vector<IOValueRef> outputs_;
 
+  // Staging buffers of the graph that were replaced by external buffers
+  std::unordered_map<ValueRef, api::StorageBuffer> detached_staging_;
+  bool shared_objects_allocated_ = false;
+  bool workgroup_sizes_tuned_ = false;
+
+  struct DeferredCopy final {
+    ValueRef staging;
+    void* data;
+    size_t numel;
+  };
+
+  // Fence of the submitted execution that has not been waited for yet, and
+  // the output copies to do once it completes
+  api::VulkanFence execute_fence_;
+  std::vector<DeferredCopy> deferred_copies_;
+
+  // Tensors whose memory is assigned by the memory planner, and the
+  // allocations it created for them
+  std::vector<ValueRef> unplanned_tensors_;
+  std::vector<SharedObject> planned_objects_;
+  MemoryPlanningStats memory_planning_stats_;
+
  protected:
   size_t values_in_use_ = 0;
 
@@ -115,6 +150,14 @@ class ComputeGraph final {
     return context_.get();
   }
 
+  inline const GraphConfig& graphconfig() const {
+    return config_;
+  }
+
+  inline const MemoryPlanningStats& memory_planning_stats() const {
+    return memory_planning_stats_;
+  }
+
   inline std::vector<IOValueRef>& inputs() {
     return inputs_;
   }
@@ -277,6 +320,16 @@ class ComputeGraph final {
   api::GPUMemoryLayout suggested_memory_layout(
       const std::vector<int64_t>& sizes);
 
+  /*
+   * Returns the dtype to use for a tensor of `dtype` that is only accessed by
+   * the graph itself. fp32 textures are stored as fp16 if the graph config
+   * enables fp16 storage and the device supports fp16 arithmetic; otherwise
+   * `dtype` is returned as is.
+   */
+  api::ScalarType suggested_intermediate_dtype(
+      const api::ScalarType dtype,
+      const api::StorageType storage_type);
+
   //
   // Graph Building
   //
@@ -382,6 +435,28 @@ class ComputeGraph final {
     return api::BufferBindInfo(param_ubos_.back().buffer());
   }
 
+  /*
+   * Like create_params_buffer(), for parameters that depend on the sizes of
+   * tensors. Returns the index of the buffer, which the resize function of
+   * the node passes to update_params_buffer(). Since resizing only updates
+   * uniform buffers in place, the encoded command buffer stays valid across
+   * resizes and does not have to be encoded again.
+   */
+  template <typename Block>
+  int32_t add_params_buffer(const Block& data) {
+    param_ubos_.emplace_back(api::UniformParamsBuffer(context_.get(), data));
+    return api::utils::safe_downcast<int32_t>(param_ubos_.size() - 1);
+  }
+
+  inline const api::BufferBindInfo params_buffer(const int32_t idx) const {
+    return api::BufferBindInfo(param_ubos_.at(idx).buffer());
+  }
+
+  template <typename Block>
+  void update_params_buffer(const int32_t idx, const Block& data) {
+    param_ubos_.at(idx).update(data);
+  }
+
   /*
    * Convenience function to add an input tensor along with its staging buffer
    */
@@ -434,6 +509,32 @@ class ComputeGraph final {
 
   void prepare();
 
+ private:
+  /*
+   * Assign memory to the tensors that were added without a shared object
+   * while memory planning is enabled. Tensors whose lifetimes, measured in
+   * execute nodes, do not overlap share an allocation. Graph inputs and
+   * outputs, and tensors used by prepack nodes, live for the whole graph.
+   */
+  void plan_memory();
+
+  /*
+   * Replace the local workgroup size of each execute node with the fastest of
+   * a set of candidates, measured by executing the node on its own. Results
+   * are looked up in, and added to, the workgroup size cache of the adapter.
+   */
+  void tune_workgroup_sizes();
+
+  /*
+   * Return the shortest of several execution times of `node`, in nanoseconds,
+   * when it is dispatched with `local_workgroup_size`.
+   */
+  uint64_t time_execute_node(
+      ExecuteNode& node,
+      const api::utils::uvec3& local_workgroup_size,
+      api::QueryPool& querypool);
+
+ public:
   //
   // Dispatch Utilities
   //
@@ -472,6 +573,37 @@ class ComputeGraph final {
   copy_into_staging(const ValueRef idx, const void* data, const size_t numel);
   void copy_from_staging(const ValueRef idx, void* data, const size_t numel);
 
+  /*
+   * Like `copy_from_staging()`, but if an execution is still pending the copy
+   * is only done by `wait_for_execution()` once that execution completes.
+   * `data` must stay valid until then.
+   */
+  void copy_from_staging_deferred(
+      const ValueRef idx,
+      void* data,
+      const size_t numel);
+
+  /*
+   * Replace the staging buffer at `idx` with a view of `range` bytes of
+   * `buffer` starting at `offset`, so that the input is read from (or the
+   * output is written to) that memory directly. `buffer` must be host visible
+   * and must outlive every execution of the graph that uses it.
+   *
+   * Returns true if the binding changed, in which case `encode_execute()` has
+   * to be called again before the next `execute()`.
+   */
+  bool bind_staging_to_buffer(
+      const ValueRef idx,
+      const api::VulkanBuffer& buffer,
+      const VkDeviceSize offset,
+      const VkDeviceSize range);
+
+  /*
+   * Restore the graph's own staging buffer at `idx` after a call to
+   * `bind_staging_to_buffer()`. Returns true if the binding changed.
+   */
+  bool reset_staging_binding(const ValueRef idx);
+
   //
   // Graph Prepacking
   //
@@ -484,11 +616,36 @@ class ComputeGraph final {
   //
 
   void encode_execute();
-  void execute() const;
+  void execute();
+
+  /*
+   * Submit the execute command buffer without waiting for it to complete, so
+   * that the host can do other work in the meantime. Only one execution can
+   * be pending at a time; a pending execution is waited for before the next
+   * one is submitted.
+   */
+  void submit_execute();
+
+  /*
+   * Wait for the pending execution, if any, and then do the output copies
+   * that were deferred until it completes.
+   */
+  void wait_for_execution();
+
+  inline bool has_pending_execution() const {
+    return execute_fence_.waiting();
+  }
 
   //
   // Dynamic Shape support
   //
+  // Resizing updates tensor metadata and the shape dependent parameters of
+  // the nodes, which all live in uniform buffers, in place. Execute nodes
+  // dispatch enough work groups for the largest sizes their textures fit, and
+  // the shaders skip the texels beyond the current limits. So the encoded
+  // command buffer can be executed again after propagate_resize() without
+  // being encoded again, for any sizes within the planned bounds.
+  //
 
   void resize_input(const int64_t idx, const std::vector<int64_t>& new_sizes);
   void propagate_resize();
@@ -56,6 +56,14 @@ GraphConfig::GraphConfig() {
   // settings will be serialized as part of the graph.
   enable_memory_layout_override = true;
   memory_layout_override = api::kWidthPacked;
+
+  enable_memory_planning = false;
+
+  enable_async_execute = false;
+
+  enable_workgroup_autotuning = false;
+
+  enable_fp16_storage = false;
 }
 
 void GraphConfig::set_storage_type_override(api::StorageType storage_type) {
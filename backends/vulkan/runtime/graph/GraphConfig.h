@@ -28,6 +28,25 @@ struct GraphConfig final {
   bool enable_memory_layout_override;
   api::GPUMemoryLayout memory_layout_override;
 
+  // Let prepare() alias the memory of tensors without a shared object whose
+  // lifetimes do not overlap
+  bool enable_memory_planning;
+
+  // Let the delegate return from execute before the GPU is done; see
+  // VulkanAsyncExecution.h.
+  bool enable_async_execute;
+
+  // Let encode_execute() measure the execution time of a set of candidate
+  // local workgroup sizes for each execute node on the device, and use the
+  // fastest one. Results are kept in the workgroup size cache of the adapter.
+  bool enable_workgroup_autotuning;
+
+  // Store fp32 tensors that are only accessed by the graph as fp16 textures
+  // (RGBA16F) if the device supports fp16 arithmetic. Shaders still compute in
+  // fp32 on the texels they load; inputs, outputs and constants stay fp32. See
+  // ComputeGraph::suggested_intermediate_dtype().
+  bool enable_fp16_storage;
+
   // Generate a default graph config with pre-configured settings
   explicit GraphConfig();
 
@@ -50,6 +50,11 @@ void ExecuteNode::encode(ComputeGraph* graph) {
 
   bind_params_to_descriptor_set(params_, descriptor_set, idx);
 
+  if (wait_for_prior_dispatches_) {
+    pipeline_barrier.stage.src |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    pipeline_barrier.stage.dst |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  }
+
   context->register_shader_dispatch(
       descriptor_set, pipeline_barrier, shader_, global_workgroup_size_);
 }
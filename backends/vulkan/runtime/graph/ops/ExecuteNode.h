@@ -72,12 +72,17 @@ class ExecuteNode final {
  protected:
   const api::ShaderInfo shader_;
   const api::utils::uvec3 global_workgroup_size_;
-  const api::utils::uvec3 local_workgroup_size_;
+  // Not const, since it may be replaced by workgroup size autotuning
+  api::utils::uvec3 local_workgroup_size_;
   const std::vector<ArgGroup> args_;
   const api::ParamsBindList params_;
   const api::SpecVarList spec_vars_;
   const ResizeFunction resize_fn_;
   const std::vector<ValueRef> resize_args_;
+
+  // Set by the memory planner when an argument reuses the memory of a tensor
+  // of an earlier node, so that the dispatch waits for earlier dispatches.
+  bool wait_for_prior_dispatches_ = false;
 };
 
 } // namespace vkcompute
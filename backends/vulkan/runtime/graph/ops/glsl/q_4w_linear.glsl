@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#version 450 core
+
+#define PRECISION ${PRECISION}
+
+#define VEC4_T ${texel_type(DTYPE)}
+
+#include "indexing_utils.h"
+
+layout(std430) buffer;
+
+${layout_declare_tensor(0, "w", "t_out", DTYPE, STORAGE)}
+${layout_declare_tensor(1, "r", "t_mat1", DTYPE, STORAGE)}
+${layout_declare_tensor(2, "r", "t_weight", "int", STORAGE)}
+${layout_declare_tensor(3, "r", "t_scales_and_zeros", DTYPE, STORAGE)}
+${layout_declare_ubo(4, "ivec3", "out_limits")}
+${layout_declare_ubo(5, "ivec4", "out_sizes")}
+${layout_declare_ubo(6, "ivec4", "mat1_sizes")}
+${layout_declare_ubo(7, "int", "group_size")}
+
+layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+
+/*
+ * Unpack 4 consecutive unsigned 4 bit values of `word`, starting at bit
+ * `offset`, and shift them to the signed range [-8, 7].
+ */
+vec4 unpack_uint4x4(const int word, const int offset) {
+  const uint bits = uint(word);
+  return vec4(
+             bitfieldExtract(bits, offset, 4),
+             bitfieldExtract(bits, offset + 4, 4),
+             bitfieldExtract(bits, offset + 8, 4),
+             bitfieldExtract(bits, offset + 12, 4)) -
+      8.0;
+}
+
+/*
+ * Computes out = mat1 @ dequantize(weight).T, where weight holds the 4 bit
+ * values of a tensor of sizes {N, K}, two values per byte with the lower
+ * nibble first. Each group of `group_size` values along K of an output
+ * channel n is dequantized as (q - 8) * scale + zero, with the scale and zero
+ * of the group stored at scales_and_zeros[group][n].
+ *
+ * Each texel of the packed weight holds 32 consecutive values of one row, so
+ * that it lines up with 8 texels of the width packed mat1. Each invocation
+ * computes one texel, i.e. 4 output channels, of the output.
+ */
+void main() {
+  const ivec3 pos = ivec3(gl_GlobalInvocationID);
+
+  if (any(greaterThanEqual(pos, out_limits))) {
+    return;
+  }
+
+  const int N = out_sizes.x;
+  const int K = mat1_sizes.x;
+  const int num_groups = K / group_size;
+  const int texels_per_group = group_size / 32;
+
+  vec4 sums = vec4(0);
+  for (int group = 0; group < num_groups; ++group) {
+    vec4 weighted_sums = vec4(0);
+    float in_sum = 0;
+
+    for (int k32 = group * texels_per_group;
+         k32 < (group + 1) * texels_per_group;
+         ++k32) {
+      vec4 in_texels[8];
+      for (int c = 0; c < 8; ++c) {
+        in_texels[c] =
+            vec4(texelFetch(t_mat1, ivec3(8 * k32 + c, pos.y, pos.z), 0));
+        in_sum += dot(in_texels[c], vec4(1));
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        const int n = 4 * pos.x + i;
+        if (n >= N) {
+          break;
+        }
+        const ivec4 weight_texel = texelFetch(t_weight, ivec3(k32, n, 0), 0);
+        for (int c = 0; c < 4; ++c) {
+          weighted_sums[i] +=
+              dot(in_texels[2 * c], unpack_uint4x4(weight_texel[c], 0)) +
+              dot(in_texels[2 * c + 1], unpack_uint4x4(weight_texel[c], 16));
+        }
+      }
+    }
+
+    for (int i = 0; i < 4; ++i) {
+      const int n = 4 * pos.x + i;
+      if (n >= N) {
+        break;
+      }
+      const vec2 scale_and_zero =
+          vec4(texelFetch(t_scales_and_zeros, ivec3(0, n, group), 0)).xy;
+      sums[i] += scale_and_zero.x * weighted_sums[i] +
+          scale_and_zero.y * in_sum;
+    }
+  }
+
+  imageStore(t_out, pos, VEC4_T(sums));
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#version 450 core
+
+#define PRECISION ${PRECISION}
+
+#define VEC4_T ${texel_type(DTYPE)}
+
+#include "indexing_utils.h"
+
+layout(std430) buffer;
+
+${layout_declare_tensor(0, "w", "t_out", DTYPE, STORAGE)}
+${layout_declare_tensor(1, "r", "t_mat1", DTYPE, STORAGE)}
+${layout_declare_tensor(2, "r", "t_weight", "int", STORAGE)}
+${layout_declare_tensor(3, "r", "t_scales", DTYPE, STORAGE)}
+${layout_declare_ubo(4, "ivec3", "out_limits")}
+${layout_declare_ubo(5, "ivec4", "out_sizes")}
+${layout_declare_ubo(6, "ivec4", "mat1_sizes")}
+
+layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+
+/*
+ * Unpack the 4 signed 8 bit values packed into `word`, lowest byte first.
+ */
+vec4 unpack_int8x4(const int word) {
+  return vec4(
+      bitfieldExtract(word, 0, 8),
+      bitfieldExtract(word, 8, 8),
+      bitfieldExtract(word, 16, 8),
+      bitfieldExtract(word, 24, 8));
+}
+
+/*
+ * Computes out = mat1 @ dequantize(weight).T, where weight is an int8 tensor
+ * of sizes {N, K} with one scale per output channel. Each texel of the packed
+ * weight holds 16 consecutive int8 values of one row, so that it lines up
+ * with 4 texels of the width packed mat1.
+ *
+ * Each invocation computes one texel, i.e. 4 output channels, of the output.
+ */
+void main() {
+  const ivec3 pos = ivec3(gl_GlobalInvocationID);
+
+  if (any(greaterThanEqual(pos, out_limits))) {
+    return;
+  }
+
+  const int N = out_sizes.x;
+  const int K = mat1_sizes.x;
+  const int num_k_texels = divup4(K);
+
+  vec4 sums = vec4(0);
+  for (int k16 = 0; 4 * k16 < num_k_texels; ++k16) {
+    vec4 in_texels[4];
+    for (int c = 0; c < 4; ++c) {
+      const int k4 = 4 * k16 + c;
+      in_texels[c] = k4 < num_k_texels
+          ? vec4(texelFetch(t_mat1, ivec3(k4, pos.y, pos.z), 0))
+          : vec4(0);
+    }
+
+    for (int i = 0; i < 4; ++i) {
+      const int n = 4 * pos.x + i;
+      if (n >= N) {
+        break;
+      }
+      const ivec4 weight_texel = texelFetch(t_weight, ivec3(k16, n, 0), 0);
+      sums[i] += dot(in_texels[0], unpack_int8x4(weight_texel.x)) +
+          dot(in_texels[1], unpack_int8x4(weight_texel.y)) +
+          dot(in_texels[2], unpack_int8x4(weight_texel.z)) +
+          dot(in_texels[3], unpack_int8x4(weight_texel.w));
+    }
+  }
+
+  const vec4 scales = vec4(texelFetch(t_scales, ivec3(pos.x, 0, 0), 0));
+  imageStore(t_out, pos, VEC4_T(sums * scales));
+}
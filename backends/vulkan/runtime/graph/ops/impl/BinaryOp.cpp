@@ -31,7 +31,6 @@ void resize_binary_op_node(
     ComputeGraph* graph,
     const std::vector<ArgGroup>& args,
     const std::vector<ValueRef>& extra_args) {
-  (void)extra_args;
   vTensorPtr out = graph->get_tensor(args[0].refs[0]);
 
   // TODO(T183442143): Verify tensors are broadcastable.
@@ -42,6 +41,10 @@ void resize_binary_op_node(
       calculate_broadcasted_output_size(*self, *other);
 
   out->virtual_resize(new_out_sizes);
+  // Whether an input is broadcast along the packed dim can change with its
+  // sizes.
+  graph->update_params_buffer(
+      extra_args[0], create_broadcast_params(*self, *other));
 }
 
 void add_binary_op_node(
@@ -71,8 +74,8 @@ void add_binary_op_node(
     alpha_val = graph.extract_scalar<float>(alpha);
   }
 
-  const api::utils::ivec2 broadcast_params =
-      create_broadcast_params(*t_in1, *t_in2);
+  const int32_t broadcast_params =
+      graph.add_params_buffer(create_broadcast_params(*t_in1, *t_in2));
 
   std::string kernel_name("binary_");
   kernel_name.reserve(kShaderNameReserve);
@@ -91,13 +94,13 @@ void add_binary_op_node(
       {t_out->sizes_ubo(),
        t_in1->sizes_ubo(),
        t_in2->sizes_ubo(),
-       graph.create_params_buffer(broadcast_params),
+       graph.params_buffer(broadcast_params),
        graph.create_params_buffer(alpha_val)},
       // Specialization Constants
       {SV(t_out->packed_dim_whcn_idx())},
       // Resizing Logic
       resize_binary_op_node,
-      {}));
+      {broadcast_params}));
 }
 
 #define DEFINE_BINARY_OP_WITH_ALPHA_FN(op_name)                          \
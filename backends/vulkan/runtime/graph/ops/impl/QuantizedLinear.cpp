@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/vulkan/runtime/graph/ops/OperatorRegistry.h>
+
+#include <executorch/backends/vulkan/runtime/graph/ops/impl/Staging.h>
+
+#include <executorch/backends/vulkan/runtime/graph/ops/impl/utils/ScalarUtils.h>
+#include <executorch/backends/vulkan/runtime/graph/ops/impl/utils/TensorUtils.h>
+
+#include <executorch/backends/vulkan/runtime/graph/ops/utils/ShaderNameUtils.h>
+#include <executorch/backends/vulkan/runtime/graph/ops/utils/StagingUtils.h>
+
+namespace vkcompute {
+
+/*
+ * Copy the bytes of a quantized weight tensor of sizes {N, row_bytes} into a
+ * width packed int32 texture of sizes {N, row_bytes / 4}, without converting
+ * them. Each texel then holds 16 consecutive bytes of one row, which the
+ * shaders unpack.
+ */
+ValueRef prepack_quantized_weight(ComputeGraph& graph, const ValueRef vref) {
+  const std::vector<int64_t> sizes = graph.sizes_of(vref);
+  VK_CHECK_COND(sizes.size() == 2);
+  VK_CHECK_COND(api::element_size(graph.dtype_of(vref)) == 1);
+  VK_CHECK_COND(sizes.at(1) % 4 == 0);
+
+  ValueRef v = graph.add_tensor(
+      {sizes.at(0), sizes.at(1) / 4},
+      api::kInt,
+      api::kTexture3D,
+      api::kWidthPacked);
+  vTensorPtr t = graph.get_tensor(v);
+
+  // The staging buffer holds the bytes of the TensorRef, which the int variant
+  // of the shader reads as 32 bit words.
+  api::ShaderInfo shader = get_nchw_to_tensor_shader(*t);
+
+  api::utils::uvec3 global_size = t->image_extents();
+  api::utils::uvec3 local_size = adaptive_work_group_size(global_size);
+
+  graph.prepack_nodes().emplace_back(new PrepackNode(
+      graph,
+      shader,
+      global_size,
+      local_size,
+      vref,
+      v,
+      {t->sizes_ubo()},
+      // Specialization constants
+      {SV(t->packed_dim_whcn_idx())}));
+
+  return v;
+}
+
+void check_quantized_linear_args(
+    ComputeGraph& graph,
+    const ValueRef mat1,
+    const ValueRef weight_data,
+    const ValueRef out) {
+  std::vector<int64_t> mat1_sizes = graph.sizes_of(mat1);
+  std::vector<int64_t> weight_sizes = graph.sizes_of(weight_data);
+
+  VK_CHECK_COND(mat1_sizes.size() == 2 || mat1_sizes.size() == 3);
+  VK_CHECK_COND(weight_sizes.size() == 2);
+
+  VK_CHECK_COND(graph.memory_layout_of(mat1) == api::kWidthPacked);
+  VK_CHECK_COND(graph.memory_layout_of(out) == api::kWidthPacked);
+}
+
+void resize_quantized_linear_node(
+    ComputeGraph* graph,
+    const std::vector<ArgGroup>& args,
+    const std::vector<ValueRef>& extra_args) {
+  vTensorPtr out = graph->get_tensor(args[0].refs[0]);
+  vTensorPtr mat1 = graph->get_tensor(args[1].refs[0]);
+  vTensorPtr weight = graph->get_tensor(args[1].refs[1]);
+
+  (void)extra_args;
+
+  std::vector<int64_t> new_out_sizes = mat1->sizes();
+  new_out_sizes.back() = weight->sizes().at(0);
+
+  out->virtual_resize(new_out_sizes);
+}
+
+void add_q_8w_linear_node(
+    ComputeGraph& graph,
+    const ValueRef mat1,
+    const ValueRef weight_data,
+    const ValueRef scales_data,
+    const ValueRef out) {
+  check_quantized_linear_args(graph, mat1, weight_data, out);
+  VK_CHECK_COND(graph.dtype_of(weight_data) == api::kChar);
+  VK_CHECK_COND(
+      api::utils::val_at(-1, graph.sizes_of(mat1)) ==
+      api::utils::val_at(-1, graph.sizes_of(weight_data)));
+
+  ValueRef weight = prepack_quantized_weight(graph, weight_data);
+  ValueRef scales =
+      prepack_if_tensor_ref(graph, scales_data, api::kWidthPacked);
+
+  api::utils::uvec3 global_size = graph.image_extents_of(out);
+  api::utils::uvec3 local_size = adaptive_work_group_size(global_size);
+
+  std::string kernel_name("q_8w_linear");
+  kernel_name.reserve(kShaderNameReserve);
+  add_dtype_suffix(kernel_name, graph.dtype_of(out));
+
+  graph.execute_nodes().emplace_back(new ExecuteNode(
+      graph,
+      VK_KERNEL_FROM_STR(kernel_name),
+      global_size,
+      local_size,
+      // Inputs and Outputs
+      {{out, api::MemoryAccessType::WRITE},
+       {{mat1, weight, scales}, api::MemoryAccessType::READ}},
+      // Shader params buffers
+      {
+          graph.texture_limits_ubo(out),
+          graph.sizes_ubo(out),
+          graph.sizes_ubo(mat1),
+      },
+      // Specialization Constants
+      {},
+      // Resizing Logic
+      resize_quantized_linear_node,
+      {}));
+}
+
+void add_q_4w_linear_node(
+    ComputeGraph& graph,
+    const ValueRef mat1,
+    const ValueRef weight_data,
+    const ValueRef group_size,
+    const ValueRef scales_and_zeros_data,
+    const ValueRef out) {
+  check_quantized_linear_args(graph, mat1, weight_data, out);
+  VK_CHECK_COND(graph.dtype_of(weight_data) == api::kByte);
+
+  // Two 4 bit values are packed into each byte of the weight
+  const int64_t K = api::utils::val_at(-1, graph.sizes_of(mat1));
+  VK_CHECK_COND(K == 2 * api::utils::val_at(-1, graph.sizes_of(weight_data)));
+
+  // The shader processes the weights in blocks of 32 values, i.e. one texel of
+  // the packed weight, which must not span two groups.
+  const int group_size_val = graph.extract_scalar<int>(group_size);
+  VK_CHECK_COND(group_size_val > 0 && group_size_val % 32 == 0);
+  VK_CHECK_COND(K % group_size_val == 0);
+
+  const std::vector<int64_t> scales_and_zeros_sizes =
+      graph.sizes_of(scales_and_zeros_data);
+  VK_CHECK_COND(scales_and_zeros_sizes.size() == 3);
+  VK_CHECK_COND(scales_and_zeros_sizes.at(0) == K / group_size_val);
+  VK_CHECK_COND(scales_and_zeros_sizes.at(2) == 2);
+
+  ValueRef weight = prepack_quantized_weight(graph, weight_data);
+  ValueRef scales_and_zeros =
+      prepack_if_tensor_ref(graph, scales_and_zeros_data, api::kWidthPacked);
+
+  api::utils::uvec3 global_size = graph.image_extents_of(out);
+  api::utils::uvec3 local_size = adaptive_work_group_size(global_size);
+
+  std::string kernel_name("q_4w_linear");
+  kernel_name.reserve(kShaderNameReserve);
+  add_dtype_suffix(kernel_name, graph.dtype_of(out));
+
+  graph.execute_nodes().emplace_back(new ExecuteNode(
+      graph,
+      VK_KERNEL_FROM_STR(kernel_name),
+      global_size,
+      local_size,
+      // Inputs and Outputs
+      {{out, api::MemoryAccessType::WRITE},
+       {{mat1, weight, scales_and_zeros}, api::MemoryAccessType::READ}},
+      // Shader params buffers
+      {
+          graph.texture_limits_ubo(out),
+          graph.sizes_ubo(out),
+          graph.sizes_ubo(mat1),
+          graph.create_params_buffer(group_size_val),
+      },
+      // Specialization Constants
+      {},
+      // Resizing Logic
+      resize_quantized_linear_node,
+      {}));
+}
+
+void weight_int8pack_mm(
+    ComputeGraph& graph,
+    const std::vector<ValueRef>& args) {
+  return add_q_8w_linear_node(graph, args[0], args[1], args[2], args[3]);
+}
+
+void linear_weight_int4(
+    ComputeGraph& graph,
+    const std::vector<ValueRef>& args) {
+  return add_q_4w_linear_node(
+      graph, args[0], args[1], args[2], args[3], args[4]);
+}
+
+REGISTER_OPERATORS {
+  VK_REGISTER_OP(aten._weight_int8pack_mm.default, weight_int8pack_mm);
+  VK_REGISTER_OP(et_vk.linear_weight_int4.default, linear_weight_int4);
+}
+
+} // namespace vkcompute
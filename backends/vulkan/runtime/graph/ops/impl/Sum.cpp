@@ -29,6 +29,13 @@ std::vector<int64_t> calc_out_sizes(vTensor& self, int64_t dim, bool keepdim) {
   return output_size;
 }
 
+int calc_channel_texels(const vTensor& in) {
+  const int64_t in_dim = in.sizes().size();
+  const int32_t channel =
+      in_dim > 2 ? static_cast<int32_t>(in.sizes()[in_dim - 3]) : 1;
+  return int(ceil(channel / 4.0));
+}
+
 void resize_sum_node(
     ComputeGraph* graph,
     const std::vector<ArgGroup>& args,
@@ -43,6 +50,11 @@ void resize_sum_node(
   std::vector<int64_t> output_size = calc_out_sizes(*in, dim, keepdim);
 
   out->virtual_resize(output_size);
+  // The size of the summed dim and the number of channel texels of the input
+  // feed the shader.
+  graph->update_params_buffer(
+      extra_args[4], static_cast<uint32_t>(in->sizes()[dim]));
+  graph->update_params_buffer(extra_args[5], calc_channel_texels(*in));
 }
 
 void check_sum_args(const vTensor& in, const vTensor& out) {
@@ -64,9 +76,10 @@ void add_sum_dim_node(
   check_sum_args(*t_input, *t_out);
 
   int64_t in_dim = t_input->sizes().size();
-  int32_t channel =
-      in_dim > 2 ? static_cast<int32_t>(t_input->sizes()[in_dim - 3]) : 1;
-  uint32_t dim_size = t_input->sizes()[dim];
+  const int32_t dim_size =
+      graph.add_params_buffer(static_cast<uint32_t>(t_input->sizes()[dim]));
+  const int32_t channel_texels =
+      graph.add_params_buffer(calc_channel_texels(*t_input));
 
   api::utils::uvec3 global_size = t_out->image_extents();
   api::utils::uvec3 local_size = adaptive_work_group_size(global_size);
@@ -89,13 +102,13 @@ void add_sum_dim_node(
       // Shader params buffers
       {t_out->texture_limits_ubo(),
        graph.create_params_buffer(dim + 4 - in_dim),
-       graph.create_params_buffer(dim_size),
-       graph.create_params_buffer(int(ceil(channel / 4.0)))},
+       graph.params_buffer(dim_size),
+       graph.params_buffer(channel_texels)},
       // Specialization Constants
       {},
       // Resizing Logic
       resize_sum_node,
-      {out, in, static_cast<int>(dim), keepdim}));
+      {out, in, static_cast<int>(dim), keepdim, dim_size, channel_texels}));
 }
 
 ValueRef add_node(
@@ -141,7 +154,8 @@ void add_sum_dim_IntList(
   // the for loop.
   ValueRef input = in;
   for (auto dim = dims_set.rbegin(); dim != std::prev(dims_set.rend()); ++dim) {
-    ValueRef tmp_node = add_node(graph, input, *dim, keepdim_val);
+    ValueRef tmp_node =
+        add_node(graph, input, *dim, keepdim_val, graph.dtype_of(out));
     add_sum_dim_node(graph, input, *dim, keepdim_val, tmp_node);
     input = tmp_node;
   }
@@ -196,9 +196,13 @@ def define_common_targets(is_fbcode = False):
             "runtime/*.cpp",
         ]),
         compiler_flags = get_vulkan_compiler_flags(),
-        headers = native.glob([
-            "runtime/*.h",
-        ]),
+        headers = native.glob(
+            ["runtime/*.h"],
+            exclude = ["runtime/VulkanHostVisibleAllocator.h"],
+        ),
+        exported_headers = [
+            "runtime/VulkanHostVisibleAllocator.h",
+        ],
         visibility = [
             "//executorch/backends/...",
             "//executorch/extension/pybindings/...",
@@ -207,10 +211,13 @@ def define_common_targets(is_fbcode = False):
         ],
         deps = [
             ":vk_delegate_schema",
-            ":vulkan_graph_runtime",
             "//executorch/runtime/backend:interface",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
         ],
+        exported_deps = [
+            ":vulkan_graph_runtime",
+            "//executorch/runtime/core:memory_allocator",
+        ],
         define_static_target = False,
         # VulkanBackend.cpp needs to compile with executor as whole
         # @lint-ignore BUCKLINT: Avoid `link_whole=True` (https://fburl.com/avoid-link-whole)
@@ -14,6 +14,8 @@ import torch
 
 from executorch.backends.transforms.mean_to_sum_div import MeanToSumDiv
 
+from executorch.backends.vulkan.custom_ops_lib import linear_weight_int4_op
+
 from executorch.backends.vulkan.partitioner.vulkan_partitioner import VulkanPartitioner
 from executorch.backends.vulkan.vulkan_preprocess import VulkanBackend
 
@@ -99,6 +101,7 @@ class TestBackends(unittest.TestCase):
         memory_layouts=None,
         first_output_only=False,
         custom_pass: Optional[List[ExportPass]] = None,
+        edge_compile_config: Optional[EdgeCompileConfig] = None,
     ):
         """
         Helper testing function that takes a torch.nn.Module and lowers it to Vulkan with
@@ -118,7 +121,9 @@ class TestBackends(unittest.TestCase):
             program: ExportedProgram = export(
                 model, sample_inputs, dynamic_shapes=dynamic_shapes
             )
-            edge_program: EdgeProgramManager = to_edge(program)
+            edge_program: EdgeProgramManager = to_edge(
+                program, compile_config=edge_compile_config
+            )
 
             if custom_pass is not None:
                 edge_program = edge_program.transform(custom_pass)
@@ -586,6 +591,53 @@ class TestBackends(unittest.TestCase):
             test_inputs=test_inputs,
         )
 
+    def test_vulkan_backend_weight_int8pack_mm(self):
+        class QuantizedLinearModule(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.weight = torch.randint(-128, 127, (64, 128), dtype=torch.int8)
+                self.scales = torch.rand(64, dtype=torch.float32) / 64
+
+            def forward(self, x):
+                return torch.ops.aten._weight_int8pack_mm.default(
+                    x, self.weight, self.scales
+                )
+
+        module = QuantizedLinearModule()
+        sample_inputs = (torch.rand(size=(32, 128), dtype=torch.float32),)
+
+        self.lower_module_and_test_output(
+            module,
+            sample_inputs,
+            memory_layouts=[vk_graph_schema.VkMemoryLayout.TENSOR_WIDTH_PACKED],
+            # _weight_int8pack_mm is not a core ATen op
+            edge_compile_config=EdgeCompileConfig(_check_ir_validity=False),
+        )
+
+    def test_vulkan_backend_linear_weight_int4(self):
+        class QuantizedLinearModule(torch.nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.group_size = 32
+                self.weight = torch.randint(0, 255, (64, 64), dtype=torch.uint8)
+                self.scales_and_zeros = (
+                    torch.rand((128 // self.group_size, 64, 2), dtype=torch.float32) / 16
+                )
+
+            def forward(self, x):
+                return linear_weight_int4_op(
+                    x, self.weight, self.group_size, self.scales_and_zeros
+                )
+
+        module = QuantizedLinearModule()
+        sample_inputs = (torch.rand(size=(32, 128), dtype=torch.float32),)
+
+        self.lower_module_and_test_output(
+            module,
+            sample_inputs,
+            memory_layouts=[vk_graph_schema.VkMemoryLayout.TENSOR_WIDTH_PACKED],
+        )
+
     def test_vulkan_backend_partial(self):
         class SimpleModel(torch.nn.Module):
             def __init__(self):
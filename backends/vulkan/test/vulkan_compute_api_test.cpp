@@ -880,6 +880,227 @@ TEST(VulkanComputeGraphTest, test_simple_graph) {
   }
 }
 
+TEST(VulkanComputeGraphTest, test_simple_graph_async_execute) {
+  GraphConfig config;
+  ComputeGraph graph(config);
+
+  std::vector<int64_t> size_big = {8, 64, 124};
+  std::vector<int64_t> size_small = {8, 1, 124};
+
+  // Build graph
+
+  IOValueRef a = graph.add_input_tensor(size_big, api::kFloat);
+  IOValueRef b = graph.add_input_tensor(size_small, api::kFloat);
+
+  IOValueRef out = {};
+
+  out.value = graph.add_tensor(size_big, api::kFloat);
+
+  auto addFn = VK_GET_OP_FN("aten.add.Tensor");
+  addFn(graph, {a.value, b.value, kDummyValueRef, out.value});
+
+  out.staging = graph.set_output_tensor(out.value);
+
+  graph.prepare();
+  graph.encode_execute();
+
+  // Run graph
+
+  std::vector<float> data_out(graph.get_tensor(out.value)->gpu_numel());
+  for (float i = 5.0f; i < 30.0f; i += 10.0f) {
+    float val_a = i + 2.0f;
+    float val_b = i + 1.5f;
+    float val_c = val_a + val_b;
+
+    fill_vtensor(graph, a, val_a);
+    fill_vtensor(graph, b, val_b);
+
+    graph.submit_execute();
+    EXPECT_TRUE(graph.has_pending_execution());
+
+    // The copy is only done once the execution completes
+    std::fill(data_out.begin(), data_out.end(), 0.0f);
+    graph.copy_from_staging_deferred(
+        out.staging, data_out.data(), data_out.size());
+
+    graph.wait_for_execution();
+    EXPECT_FALSE(graph.has_pending_execution());
+
+    // Sanity check that the values are correct
+    for (size_t i = 0; i < graph.get_tensor(out.value)->numel(); ++i) {
+      CHECK_VALUE(data_out, i, val_c);
+    }
+  }
+}
+
+TEST(VulkanComputeGraphTest, test_simple_graph_with_memory_planning) {
+  GraphConfig config;
+  config.enable_memory_planning = true;
+  ComputeGraph graph(config);
+
+  std::vector<int64_t> size_big = {8, 64, 124};
+  std::vector<int64_t> size_small = {8, 1, 124};
+
+  // Build graph; c and e have disjoint lifetimes and can share memory
+
+  IOValueRef a = graph.add_input_tensor(size_big, api::kFloat);
+  IOValueRef b = graph.add_input_tensor(size_small, api::kFloat);
+
+  ValueRef c = graph.add_tensor(size_big, api::kFloat);
+  ValueRef d = graph.add_tensor(size_big, api::kFloat);
+  ValueRef e = graph.add_tensor(size_big, api::kFloat);
+
+  IOValueRef out = {};
+  out.value = graph.add_tensor(size_big, api::kFloat);
+
+  auto addFn = VK_GET_OP_FN("aten.add.Tensor");
+  addFn(graph, {a.value, b.value, kDummyValueRef, c});
+  addFn(graph, {c, b.value, kDummyValueRef, d});
+  addFn(graph, {d, b.value, kDummyValueRef, e});
+  addFn(graph, {e, b.value, kDummyValueRef, out.value});
+
+  out.staging = graph.set_output_tensor(out.value);
+
+  graph.prepare();
+  graph.encode_execute();
+
+  EXPECT_EQ(graph.memory_planning_stats().num_tensors, 6);
+  EXPECT_EQ(graph.memory_planning_stats().num_allocations, 5);
+  EXPECT_LT(
+      graph.memory_planning_stats().planned_bytes,
+      graph.memory_planning_stats().unplanned_bytes);
+
+  // Run graph
+
+  for (float i = 5.0f; i < 30.0f; i += 10.0f) {
+    float val_a = i + 2.0f;
+    float val_b = i + 1.5f;
+    float val_out = val_a + 4 * val_b;
+
+    fill_vtensor(graph, a, val_a);
+    fill_vtensor(graph, b, val_b);
+
+    graph.execute();
+
+    EXTRACT_TENSOR(out);
+
+    // Sanity check that the values are correct
+    for (size_t i = 0; i < graph.get_tensor(out.value)->numel(); ++i) {
+      CHECK_VALUE(data_out, i, val_out);
+    }
+  }
+}
+
+TEST(VulkanComputeGraphTest, test_simple_graph_with_fp16_storage) {
+  if (!api::context()->adapter_ptr()->has_full_float16_buffers_support()) {
+    GTEST_SKIP();
+  }
+  GraphConfig config;
+  config.enable_fp16_storage = true;
+  ComputeGraph graph(config);
+
+  std::vector<int64_t> size_big = {8, 64, 124};
+  std::vector<int64_t> size_small = {8, 1, 124};
+
+  // Build graph
+
+  IOValueRef a = graph.add_input_tensor(size_big, api::kFloat);
+  IOValueRef b = graph.add_input_tensor(size_small, api::kFloat);
+
+  const api::ScalarType dtype = graph.suggested_intermediate_dtype(
+      api::kFloat, graph.suggested_storage_type());
+  EXPECT_TRUE(dtype == api::kHalf);
+  ValueRef c = graph.add_tensor(size_big, dtype);
+
+  IOValueRef out = {};
+  out.value = graph.add_tensor(size_big, api::kFloat);
+
+  auto addFn = VK_GET_OP_FN("aten.add.Tensor");
+  addFn(graph, {a.value, b.value, kDummyValueRef, c});
+  addFn(graph, {c, a.value, kDummyValueRef, out.value});
+
+  out.staging = graph.set_output_tensor(out.value);
+
+  graph.prepare();
+  graph.encode_execute();
+
+  // Run graph
+
+  // Both values are exactly representable in fp16
+  float val_a = 3.0f;
+  float val_b = 1.5f;
+  float val_out = val_a + val_b + val_a;
+
+  fill_vtensor(graph, a, val_a);
+  fill_vtensor(graph, b, val_b);
+
+  graph.execute();
+
+  EXTRACT_TENSOR(out);
+
+  for (size_t i = 0; i < graph.get_tensor(out.value)->numel(); ++i) {
+    CHECK_VALUE(data_out, i, val_out);
+  }
+}
+
+TEST(VulkanComputeGraphTest, test_simple_graph_with_workgroup_autotuning) {
+  GraphConfig config;
+  config.enable_workgroup_autotuning = true;
+
+  std::vector<int64_t> size_big = {8, 64, 124};
+  std::vector<int64_t> size_small = {8, 1, 124};
+
+  api::WorkgroupSizeCache& cache =
+      api::context()->adapter_ptr()->workgroup_size_cache();
+  size_t num_entries = 0;
+
+  // The second graph should find the tuned sizes of the first in the cache
+  for (int graph_i = 0; graph_i < 2; ++graph_i) {
+    ComputeGraph graph(config);
+
+    // Build graph
+
+    IOValueRef a = graph.add_input_tensor(size_big, api::kFloat);
+    IOValueRef b = graph.add_input_tensor(size_small, api::kFloat);
+
+    IOValueRef out = {};
+
+    out.value = graph.add_tensor(size_big, api::kFloat);
+
+    auto addFn = VK_GET_OP_FN("aten.add.Tensor");
+    addFn(graph, {a.value, b.value, kDummyValueRef, out.value});
+
+    out.staging = graph.set_output_tensor(out.value);
+
+    graph.prepare();
+    graph.encode_execute();
+
+    if (graph_i == 0) {
+      num_entries = cache.size();
+    } else {
+      EXPECT_TRUE(cache.size() == num_entries);
+    }
+
+    // Run graph
+
+    float val_a = 3.0f;
+    float val_b = 1.5f;
+    float val_c = val_a + val_b;
+
+    fill_vtensor(graph, a, val_a);
+    fill_vtensor(graph, b, val_b);
+
+    graph.execute();
+
+    EXTRACT_TENSOR(out);
+
+    // Sanity check that the values are correct
+    for (size_t i = 0; i < graph.get_tensor(out.value)->numel(); ++i) {
+      CHECK_VALUE(data_out, i, val_c);
+    }
+  }
+}
+
 #define CREATE_WEIGHT_TENSOR(name, sizes, dtype, val)                   \
   std::vector<float> data_##name(api::utils::multiply_integers(sizes)); \
   std::fill(data_##name.begin(), data_##name.end(), val);               \
@@ -1066,6 +1287,52 @@ TEST(VulkanComputeGraphTest, test_simple_shared_objects_with_resize) {
   }
 }
 
+TEST(VulkanComputeGraphTest, test_resize_without_encoding_again) {
+  GraphConfig config;
+  ComputeGraph graph(config);
+
+  std::vector<int64_t> size_big = {8, 4, 4};
+
+  IOValueRef a = graph.add_input_tensor(size_big, api::kFloat);
+  IOValueRef b = graph.add_input_tensor(size_big, api::kFloat);
+
+  IOValueRef out = {};
+  out.value = graph.add_tensor(size_big, api::kFloat);
+
+  auto addFn = VK_GET_OP_FN("aten.add.Tensor");
+  addFn(graph, {a.value, b.value, kDummyValueRef, out.value});
+
+  out.staging = graph.set_output_tensor(out.value);
+
+  graph.prepare();
+  graph.encode_execute();
+
+  // Broadcasting b along the packed dim, and back, only updates the broadcast
+  // params in place, so the command buffer encoded above stays valid.
+  std::vector<std::vector<int64_t>> b_sizes_list = {
+      {8, 4, 4}, {1, 4, 4}, {8, 4, 4}, {1, 4, 4}};
+
+  for (auto& b_sizes : b_sizes_list) {
+    graph.resize_input(0, size_big);
+    graph.resize_input(1, b_sizes);
+    graph.propagate_resize();
+    EXPECT_TRUE(graph.get_tensor(out.value)->sizes() == size_big);
+
+    float val_a = b_sizes[0] + 1.0f;
+    float val_b = 2.5f;
+    fill_vtensor(graph, a, val_a);
+    fill_vtensor(graph, b, val_b);
+
+    graph.execute();
+
+    EXTRACT_TENSOR(out);
+
+    for (size_t i = 0; i < graph.get_tensor(out.value)->numel(); i++) {
+      CHECK_VALUE(data_out, i, val_a + val_b);
+    }
+  }
+}
+
 TEST(VulkanComputeGraphTest, test_large_graph) {
   auto build_start_time = std::chrono::system_clock::now();
   GraphConfig config;
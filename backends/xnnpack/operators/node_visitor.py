@@ -107,8 +107,10 @@ class NodeVisitor:
         Args:
             tensor: EdgeIR Tensor that is being checked for graph input
         """
-        return tensor.op == "placeholder" and not is_param_node(
-            self.exported_program, tensor
+        # Mutable buffers kept as delegate state are external inputs as well.
+        return tensor.op == "placeholder" and (
+            tensor in self.external_ids
+            or not is_param_node(self.exported_program, tensor)
         )
 
     def is_graph_output(self, tensor: torch.fx.Node) -> bool:
@@ -519,7 +521,10 @@ class NodeVisitor:
         """
         # The get_attr node is the input to quant_params.
         get_attr_node = tensor if quant_params is None else quant_params.q_input
-        if not is_param_node(self.exported_program, get_attr_node):
+        if (
+            not is_param_node(self.exported_program, get_attr_node)
+            or get_attr_node in self.external_ids
+        ):
             check_or_raise(
                 not swap_nc_for_depthwise_weights,
                 "Swapping N and C dimensions is only valid for constant data tensors",
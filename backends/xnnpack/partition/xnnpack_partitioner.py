@@ -537,13 +537,16 @@ class XnnpackFloatingPointPartitioner(Partitioner):
         supported_modules: List[Callable] = SUPPORTED_MODULES,
         supported_ops: Optional[List[Callable]] = SUPPORTED_OPS,
         unsupported_modules: Optional[List[Callable]] = None,
+        compile_specs: Optional[List[CompileSpec]] = None,
     ):
         super().__init__()
         self.supported_modules = set(supported_modules)
         self.unsupported_modules = unsupported_modules
         self.supported_ops = set(supported_ops or [])
 
-        self.delegation_spec = DelegationSpec(XnnpackBackend.__name__, [])
+        self.delegation_spec = DelegationSpec(
+            XnnpackBackend.__name__, compile_specs or []
+        )
 
     @staticmethod
     def check_partitions(partitions: Union[dict, list]) -> bool:
@@ -840,6 +843,7 @@ class XnnpackPartitioner(Partitioner):
         quant: Optional[bool] = None,
         _only_ops_with_dynamic_shape_support: Optional[bool] = False,
         _lower_recomposed_sdpa: Optional[bool] = True,
+        compile_specs: Optional[List[CompileSpec]] = None,
     ):
         super().__init__()
         self.supported_modules = set(supported_modules)
@@ -857,7 +861,9 @@ class XnnpackPartitioner(Partitioner):
         # TODO(T174256335) - remove this once we have a better way to handle >2d Mask
         self._lower_recomposed_sdpa: bool = _lower_recomposed_sdpa or True
 
-        self.delegation_spec = DelegationSpec(XnnpackBackend.__name__, [])
+        self.delegation_spec = DelegationSpec(
+            XnnpackBackend.__name__, compile_specs or []
+        )
         self.partition_tags: Dict[str, DelegationSpec] = {}
 
     def _update_op_lists_for_dynamic_shapes(self):
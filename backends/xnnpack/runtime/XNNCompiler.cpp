@@ -8,9 +8,12 @@
 
 #include <executorch/backends/xnnpack/runtime/XNNCompiler.h>
 #include <executorch/backends/xnnpack/runtime/XNNHeader.h>
+#include <executorch/backends/xnnpack/runtime/XNNWeightsCache.h>
 #include <executorch/backends/xnnpack/serialization/schema_generated.h>
 #include <executorch/backends/xnnpack/threadpool/threadpool.h>
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <algorithm>
+#include <cstring>
 #include <unordered_map>
 
 #pragma clang diagnostic ignored "-Wmissing-prototypes"
@@ -116,24 +119,30 @@ std::vector<T> flatbufferDimsToVector(
 Gets the constant data pointer associated with the given tensor value.
 Obtaining the constant data pointer can either be from within the flatbuffer
 payload (deprecated) or via offsets to the constant_data_ptr. If no constant
-data associated with the tensor value, then returns nullptr.
+data associated with the tensor value, then returns nullptr. The returned
+pointer is the canonical copy of the data in the shared weights cache, see
+XNNWeightsCache.
 */
 const uint8_t* getConstantDataPtr(
     const fb_xnnpack::XNNTensorValue* tensor_value,
     GraphPtr flatbuffer_graph,
-    const uint8_t* constant_data_ptr) {
+    const uint8_t* constant_data_ptr,
+    XNNWeightsCache::Session& weights_cache) {
   auto buffer_idx = tensor_value->constant_buffer_idx();
   if (buffer_idx) {
     if (!constant_data_ptr) {
       // TODO(T172265611): Remove constant_buffer in flatbuffer path after BC
       // window
       const auto& constant_buffer = *flatbuffer_graph->constant_buffer();
-      return constant_buffer[buffer_idx]->storage()->data();
+      const auto* storage = constant_buffer[buffer_idx]->storage();
+      return weights_cache.intern(storage->data(), storage->size());
     } else {
       const auto& constant_data_offsets = *flatbuffer_graph->constant_data();
       uint64_t constant_data_offset =
           constant_data_offsets[buffer_idx]->offset();
-      return constant_data_ptr + constant_data_offset;
+      return weights_cache.intern(
+          constant_data_ptr + constant_data_offset,
+          constant_data_offsets[buffer_idx]->size());
     }
   }
 
@@ -151,6 +160,7 @@ Error defineTensor(
     ValuePtr value,
     GraphPtr flatbuffer_graph,
     const uint8_t* constant_data_ptr,
+    XNNWeightsCache::Session& weights_cache,
     std::vector<uint32_t>& input_ids,
     std::vector<uint32_t>& output_ids) {
   const fb_xnnpack::XNNTensorValue* tensor_value = nullptr;
@@ -190,7 +200,8 @@ Error defineTensor(
   // Get Pointer to constant data from flatbuffer, if its non-constant
   // it is a nullptr
   const uint8_t* buffer_ptr =
-      getConstantDataPtr(tensor_value, flatbuffer_graph, constant_data_ptr);
+      getConstantDataPtr(
+          tensor_value, flatbuffer_graph, constant_data_ptr, weights_cache);
 
   xnn_status status;
   // The type we might have to convert to
@@ -1573,6 +1584,163 @@ DefineNodeFunc getDefineNodeFunc(fb_xnnpack::XNodeUnion nodeType) {
 }
 #undef _DEFINE
 
+/*
+Returns the tensor value of a serialized value, or nullptr if it is not a
+tensor.
+*/
+const fb_xnnpack::XNNTensorValue* getTensorValue(ValuePtr value) {
+  switch (value->xvalue_union_type()) {
+    case fb_xnnpack::XValueUnion::XNNTensorValue:
+      return value->xvalue_union_as_XNNTensorValue();
+    case fb_xnnpack::XValueUnion::XNNQuantizedTensorValue:
+      return value->xvalue_union_as_XNNQuantizedTensorValue()->tensor_value();
+    default:
+      return nullptr;
+  }
+}
+
+/*
+Returns the size in bytes of a tensor value that is kept as delegate state, or
+0 if its datatype cannot be.
+*/
+size_t getStateNumBytes(const fb_xnnpack::XNNTensorValue* tensor_value) {
+  size_t num_bytes = 0;
+  switch (tensor_value->datatype()) {
+    case DataType::xnn_datatype_fp32:
+    case DataType::xnn_datatype_qint32:
+      num_bytes = 4;
+      break;
+    case DataType::xnn_datatype_fp16:
+      num_bytes = 2;
+      break;
+    case DataType::xnn_datatype_qint8:
+    case DataType::xnn_datatype_quint8:
+      num_bytes = 1;
+      break;
+    default:
+      return 0;
+  }
+  for (auto dim : *tensor_value->dims()) {
+    num_bytes *= dim;
+  }
+  return num_bytes;
+}
+
+/*
+Allocates the buffers of the serialized states from the runtime allocator, and
+removes their external ids from the ids of the delegate inputs and outputs.
+*/
+Error defineStates(
+    GraphPtr flatbuffer_graph,
+    MemoryAllocator* runtime_allocator,
+    std::vector<uint32_t>& input_ids,
+    std::vector<uint32_t>& output_ids,
+    std::vector<XNNExecutor::PersistentState>& states) {
+  auto fb_states = flatbuffer_graph->state();
+  if (fb_states == nullptr || fb_states->size() == 0) {
+    return Error::Ok;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      runtime_allocator != nullptr,
+      InvalidArgument,
+      "XNNPACK delegate state requires a runtime allocator");
+
+  for (auto fb_state : *fb_states) {
+    const fb_xnnpack::XNNTensorValue* input_value = nullptr;
+    const fb_xnnpack::XNNTensorValue* output_value = nullptr;
+    for (auto value : *flatbuffer_graph->xvalues()) {
+      const fb_xnnpack::XNNTensorValue* tensor_value = getTensorValue(value);
+      if (tensor_value == nullptr) {
+        continue;
+      }
+      if (tensor_value->external_id() == fb_state->input_id()) {
+        input_value = tensor_value;
+      } else if (tensor_value->external_id() == fb_state->output_id()) {
+        output_value = tensor_value;
+      }
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        input_value != nullptr && output_value != nullptr,
+        InvalidProgram,
+        "No values with the external ids %u and %u of a delegate state",
+        fb_state->input_id(),
+        fb_state->output_id());
+
+    auto input_it =
+        std::find(input_ids.begin(), input_ids.end(), fb_state->input_id());
+    auto output_it =
+        std::find(output_ids.begin(), output_ids.end(), fb_state->output_id());
+    ET_CHECK_OR_RETURN_ERROR(
+        input_it != input_ids.end() && output_it != output_ids.end(),
+        InvalidProgram,
+        "Delegate state %u -> %u must be an external input and output",
+        fb_state->input_id(),
+        fb_state->output_id());
+    input_ids.erase(input_it);
+    output_ids.erase(output_it);
+
+    const size_t num_bytes = getStateNumBytes(input_value);
+    ET_CHECK_OR_RETURN_ERROR(
+        num_bytes != 0 && num_bytes == getStateNumBytes(output_value),
+        InvalidProgram,
+        "Delegate state %u -> %u must have the same shape and datatype",
+        fb_state->input_id(),
+        fb_state->output_id());
+
+    XNNExecutor::PersistentState state{
+        fb_state->input_id(), fb_state->output_id(), {nullptr, nullptr}};
+    for (void*& buffer : state.buffers) {
+      // XNNPACK may read up to XNN_EXTRA_BYTES past the end of its inputs.
+      buffer = runtime_allocator->allocate(num_bytes + XNN_EXTRA_BYTES);
+      ET_CHECK_OR_RETURN_ERROR(
+          buffer != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate %zu bytes of delegate state",
+          num_bytes);
+    }
+    std::memset(state.buffers[0], 0, num_bytes);
+    states.push_back(state);
+  }
+  return Error::Ok;
+}
+
+/*
+Creates a runtime from the subgraph, with the packed weights of the weights
+cache if they fit in it.
+*/
+xnn_status createRuntime(
+    xnn_subgraph_t subgraph,
+    XNNWeightsCache::Session& weights_cache,
+    xnn_workspace_t workspace,
+    uint32_t runtime_flags,
+    xnn_runtime_t* runtime_ptr) {
+  xnn_status status = xnn_create_runtime_v4(
+      subgraph,
+      weights_cache.xnn_cache(),
+      workspace,
+      torch::executorch::threadpool::get_pthreadpool(),
+      runtime_flags,
+      runtime_ptr);
+  if (status == xnn_status_success) {
+    weights_cache.on_runtime_created();
+  } else if (weights_cache.xnn_cache() != nullptr) {
+    // Once finalized, the weights cache cannot grow to fit new weights.
+    ET_LOG(
+        Info,
+        "XNN Runtime creation with the weights cache failed with code: %s, "
+        "retrying without it",
+        xnn_status_to_string(status));
+    status = xnn_create_runtime_v4(
+        subgraph,
+        /*weights_cache=*/nullptr,
+        workspace,
+        torch::executorch::threadpool::get_pthreadpool(),
+        runtime_flags,
+        runtime_ptr);
+  }
+  return status;
+}
+
 /*
 Builds the xnnpack runtime object using the buffer pointer. The buffer pointer
 must be a valid pointer to the serialized xnnpack object. It also fills the
@@ -1582,7 +1750,15 @@ __ET_NODISCARD Error XNNCompiler::compileModel(
     const void* buffer_pointer,
     size_t num_bytes,
     XNNExecutor* executor,
-    MemoryAllocator* runtime_allocator) {
+    MemoryAllocator* runtime_allocator,
+    xnn_workspace_t workspace,
+    bool fp16_inference,
+    size_t num_shape_buckets) {
+  ET_CHECK_OR_RETURN_ERROR(
+      num_shape_buckets > 0,
+      InvalidArgument,
+      "The delegate needs at least one shape bucket");
+
   Result<XNNHeader> header = XNNHeader::Parse(buffer_pointer, num_bytes);
   const uint8_t* flatbuffer_data = nullptr;
   const uint8_t* constant_data = nullptr;
@@ -1648,6 +1824,10 @@ __ET_NODISCARD Error XNNCompiler::compileModel(
   // External Ids for inputs and outputs
   std::vector<uint32_t> input_ids;
   std::vector<uint32_t> output_ids;
+  // Held until the runtime is created, so that the constants it packs are
+  // read from their canonical copies.
+  XNNWeightsCache::Session weights_cache =
+      XNNWeightsCache::get().start_session();
   Error err = Error::Ok;
   for (auto value : *flatbuffer_graph->xvalues()) {
     err = defineTensor(
@@ -1656,6 +1836,7 @@ __ET_NODISCARD Error XNNCompiler::compileModel(
         value,
         flatbuffer_graph,
         constant_data,
+        weights_cache,
         input_ids,
         output_ids);
 
@@ -1664,6 +1845,13 @@ __ET_NODISCARD Error XNNCompiler::compileModel(
     }
   }
 
+  std::vector<XNNExecutor::PersistentState> states;
+  err = defineStates(
+      flatbuffer_graph, runtime_allocator, input_ids, output_ids, states);
+  if (err != Error::Ok) {
+    return err;
+  }
+
   for (auto node : *flatbuffer_graph->xnodes()) {
     err = getDefineNodeFunc(node->xnode_union_type())(
         subgraph.get(), remapped_ids, node);
@@ -1676,23 +1864,36 @@ __ET_NODISCARD Error XNNCompiler::compileModel(
 #if defined(ENABLE_XNNPACK_PROFILING) || defined(ET_EVENT_TRACER_ENABLED)
   runtime_flags |= XNN_FLAG_BASIC_PROFILING;
 #endif
+  if (fp16_inference) {
+    // Only a hint: XNNPACK keeps fp32 if the CPU has no fp16 arithmetic.
+    runtime_flags |= XNN_FLAG_HINT_FP16_INFERENCE;
+  }
 
-  xnn_runtime_t runtime_ptr = nullptr;
-  status = xnn_create_runtime_v2(
-      subgraph.get(),
-      torch::executorch::threadpool::get_pthreadpool(),
-      runtime_flags,
-      &runtime_ptr);
-  ET_CHECK_OR_RETURN_ERROR(
-      xnn_status_success == status,
-      Internal,
-      "XNN Runtime creation failed with code: %s",
-      xnn_status_to_string(status));
-
-  err = executor->initialize( // NOLINT: runtime_ptr is non-null
-      runtime_ptr,
-      std::move(input_ids),
-      std::move(output_ids));
+  for (size_t bucket = 0; bucket < num_shape_buckets; ++bucket) {
+    xnn_runtime_t runtime_ptr = nullptr;
+    status = createRuntime(
+        subgraph.get(), weights_cache, workspace, runtime_flags, &runtime_ptr);
+    ET_CHECK_OR_RETURN_ERROR(
+        xnn_status_success == status,
+        Internal,
+        "XNN Runtime creation failed with code: %s",
+        xnn_status_to_string(status));
+
+    if (bucket == 0) {
+      err = executor->initialize( // NOLINT: runtime_ptr is non-null
+          runtime_ptr,
+          std::move(input_ids),
+          std::move(output_ids),
+          std::move(states));
+      executor->shares_workspace_ = workspace != nullptr;
+    } else {
+      // The weights are already packed, so the cache finds them.
+      err = executor->add_shape_bucket(runtime_ptr);
+    }
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
 
   return err;
 };
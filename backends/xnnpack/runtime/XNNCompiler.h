@@ -25,11 +25,22 @@ class XNNCompiler {
   // Takes Flatbuffer Serialized XNNPACK Model and rebuilds the xnn-subgraph
   // returns an executor object that holds the xnn runtime object which we
   // can then use to set inputs and run inference using the xnn graph.
+  // If workspace is not null, the runtime allocates its intermediate tensors
+  // from it, otherwise it gets a workspace of its own.
+  // If fp16_inference is true, XNNPACK runs the fp32 subgraph with fp16
+  // arithmetic on CPUs that support it, such as ARMv8.2-A with FP16, and in
+  // fp32 elsewhere.
+  // num_shape_buckets runtimes are built from the subgraph, sharing their
+  // packed weights, so that inputs of that many different shapes can each
+  // keep a runtime reshaped for them. Must be at least 1.
   __ET_NODISCARD static Error compileModel(
       const void* buffer_pointer,
       size_t num_bytes,
       XNNExecutor* executor,
-      MemoryAllocator* runtime_allocator);
+      MemoryAllocator* runtime_allocator,
+      xnn_workspace_t workspace,
+      bool fp16_inference,
+      size_t num_shape_buckets = 1);
 };
 
 } // namespace delegate
@@ -8,6 +8,8 @@
 
 #include <executorch/backends/xnnpack/runtime/XNNExecutor.h>
 
+#include <atomic>
+
 namespace torch {
 namespace executor {
 namespace xnnpack {
@@ -17,6 +19,15 @@ using Tensor = exec_aten::Tensor;
 using ScalarType = exec_aten::ScalarType;
 using SizesType = exec_aten::SizesType;
 
+namespace {
+
+constexpr size_t kInputShapeStride = XNN_MAX_TENSOR_DIMS + 1;
+
+// Number of runtime reshapes done by all executors.
+std::atomic<uint64_t> reshape_count{0};
+
+} // namespace
+
 /**
  * Initializes the XNNExecutor with the runtime and given number of
  * inputs/outputs externals_ is resized to the total number of inputs and
@@ -25,11 +36,17 @@ using SizesType = exec_aten::SizesType;
 __ET_NODISCARD Error XNNExecutor::initialize(
     xnn_runtime_t runtime,
     std::vector<uint32_t>&& input_ids,
-    std::vector<uint32_t>&& output_ids) {
-  runtime_ = std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>(
-      runtime, xnn_delete_runtime);
+    std::vector<uint32_t>&& output_ids,
+    std::vector<PersistentState>&& states) {
+  buckets_.clear();
+  current_bucket_ = 0;
+  prepare_count_ = 0;
+  Error error = add_shape_bucket(runtime);
+  if (error != Error::Ok) {
+    return error;
+  }
 
-  auto error = profiler_.initialize(runtime);
+  error = profiler_.initialize(runtime);
   if (error != Error::Ok) {
     ET_LOG(
         Error,
@@ -45,8 +62,39 @@ __ET_NODISCARD Error XNNExecutor::initialize(
   output_ids_ = std::move(output_ids);
   std::sort(output_ids_.begin(), output_ids_.end());
 
-  externals_.resize(input_ids_.size() + output_ids_.size());
+  states_ = std::move(states);
+  current_state_buffer_ = 0;
 
+  const size_t num_args = input_ids_.size() + output_ids_.size();
+  externals_.resize(num_args + 2 * states_.size());
+  for (uint32_t i = 0; i < num_args; ++i) {
+    externals_[i].id = i < input_ids_.size()
+        ? input_ids_[i]
+        : output_ids_[i - input_ids_.size()];
+    externals_[i].data = nullptr;
+  }
+  for (size_t i = 0; i < states_.size(); ++i) {
+    externals_[num_args + 2 * i].id = states_[i].input_id;
+    externals_[num_args + 2 * i + 1].id = states_[i].output_id;
+  }
+  bind_states();
+
+  input_shapes_.assign(input_ids_.size() * kInputShapeStride, 0);
+
+  return Error::Ok;
+}
+
+__ET_NODISCARD Error XNNExecutor::add_shape_bucket(xnn_runtime_t runtime) {
+  ET_CHECK_OR_RETURN_ERROR(
+      runtime != nullptr, InvalidArgument, "Shape bucket without a runtime");
+  buckets_.push_back(ShapeBucket{
+      std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>(
+          runtime, xnn_delete_runtime),
+      /*input_shapes=*/{},
+      /*needs_reshape=*/true,
+      /*needs_setup=*/true,
+      /*setup_reshape_count=*/0,
+      /*last_used=*/0});
   return Error::Ok;
 }
 
@@ -61,16 +109,19 @@ __ET_NODISCARD Error XNNExecutor::initialize(
  * Note: the external ids given to the external tensors in the XNNPACK
  * runtime correspond to their index in the list of arg passed into
  * delegate->execute()
+ *
+ * For fixed-shape models the shapes, and usually the data pointers, are the
+ * same on every call. The runtime is then only reshaped when an input shape
+ * changed, and only set up again when it was reshaped or a pointer changed.
+ * With several shape buckets, the inputs run on the bucket that was last
+ * reshaped for their shapes, if any, and otherwise reshape the least recently
+ * used bucket.
  */
 __ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
   // Create xnn_externals_value from evalue args
   xnn_status status;
-  for (uint32_t i = 0; i < externals_.size(); ++i) {
-    if (i < input_ids_.size()) {
-      externals_[i].id = input_ids_[i];
-    } else {
-      externals_[i].id = output_ids_[i - input_ids_.size()];
-    }
+  const size_t num_args = input_ids_.size() + output_ids_.size();
+  for (uint32_t i = 0; i < num_args; ++i) {
     uint32_t ext_id = externals_[i].id;
 
     ET_CHECK_OR_RETURN_ERROR(
@@ -81,38 +132,79 @@ __ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
         static_cast<uint32_t>(args[ext_id]->tag));
 
     Tensor* tensor = &args[ext_id]->toTensor();
-    externals_[i].data = tensor->mutable_data_ptr<float>();
+    void* data = tensor->mutable_data_ptr<float>();
+    if (externals_[i].data != data) {
+      externals_[i].data = data;
+      invalidate_setups();
+    }
 
-    // Reshape runtime inputs
+    // Record the shapes of the runtime inputs
     if (i < input_ids_.size()) {
       size_t num_dims = tensor->dim();
-      size_t dims[XNN_MAX_TENSOR_DIMS];
       ET_CHECK_OR_RETURN_ERROR(
           num_dims <= XNN_MAX_TENSOR_DIMS,
           InvalidArgument,
           "XNNPACK backend accepts tensors with at most %d dims, but got %zu",
           XNN_MAX_TENSOR_DIMS,
           num_dims);
-      for (int d = 0; d < num_dims; ++d) {
-        dims[d] = tensor->size(d);
+      size_t* shape = &input_shapes_[i * kInputShapeStride];
+      shape[0] = num_dims;
+      for (int d = 0; d < XNN_MAX_TENSOR_DIMS; ++d) {
+        shape[d + 1] = d < num_dims ? tensor->size(d) : 0;
       }
-      status =
-          xnn_reshape_external_value(runtime_.get(), ext_id, num_dims, dims);
+    }
+  }
+
+  const size_t selected = select_bucket();
+  ShapeBucket& bucket = buckets_[selected];
+  if (bucket.input_shapes != input_shapes_) {
+    bucket.input_shapes = input_shapes_;
+    bucket.needs_reshape = true;
+  }
+  bucket.last_used = ++prepare_count_;
+  if (selected != current_bucket_) {
+    current_bucket_ = selected;
+    auto error = profiler_.initialize(bucket.runtime.get());
+    if (error != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Failed to start profiling: %u.",
+          static_cast<unsigned int>(error));
+    }
+  }
+
+  // Stays set until the runtime was reshaped successfully.
+  const bool reshape = bucket.needs_reshape;
+  if (reshape) {
+    for (uint32_t i = 0; i < input_ids_.size(); ++i) {
+      const size_t* shape = &bucket.input_shapes[i * kInputShapeStride];
+      status = xnn_reshape_external_value(
+          bucket.runtime.get(), externals_[i].id, shape[0], shape + 1);
       ET_CHECK_OR_RETURN_ERROR(
           status == xnn_status_success,
           Internal,
           "Internal Error: Reshape Input Tensor Failed with code: %s",
           xnn_status_to_string(status));
     }
+    // Propagate Input Shape and Memory Plan for increased allocation
+    status = xnn_reshape_runtime(bucket.runtime.get());
+    reshape_count.fetch_add(1, std::memory_order_relaxed);
+
+    ET_CHECK_OR_RETURN_ERROR(
+        status == xnn_status_success,
+        Internal,
+        "Internal Error: Propagating input shapes failed with code: %s",
+        xnn_status_to_string(status));
+    bucket.needs_reshape = false;
+    bucket.needs_setup = true;
   }
-  // // Propagate Input Shape and Memory Plan for increased allocation
-  status = xnn_reshape_runtime(runtime_.get());
 
-  ET_CHECK_OR_RETURN_ERROR(
-      status == xnn_status_success,
-      Internal,
-      "Internal Error: Propagating input shapes failed with code: %s",
-      xnn_status_to_string(status));
+  if (shares_workspace_ &&
+      bucket.setup_reshape_count !=
+          reshape_count.load(std::memory_order_relaxed)) {
+    bucket.needs_setup = true;
+  }
+  profiler_.record_prepare(reshape, bucket.needs_setup);
 
   return Error::Ok;
 }
@@ -125,18 +217,24 @@ __ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
  */
 __ET_NODISCARD Error XNNExecutor::forward(BackendExecutionContext& context) {
   ET_CHECK_OR_RETURN_ERROR(
-      runtime_ != nullptr,
+      !buckets_.empty(),
       Internal,
       "XNNPACK Delegate did not compile correctly");
 
-  xnn_status status = xnn_setup_runtime_v2(
-      runtime_.get(), externals_.size(), externals_.data());
+  ShapeBucket& bucket = buckets_[current_bucket_];
+  xnn_status status;
+  if (bucket.needs_setup) {
+    status = xnn_setup_runtime_v2(
+        bucket.runtime.get(), externals_.size(), externals_.data());
 
-  ET_CHECK_OR_RETURN_ERROR(
-      status == xnn_status_success,
-      Internal,
-      "Internal Error: Setting up the runtime failed with code: %s",
-      xnn_status_to_string(status));
+    ET_CHECK_OR_RETURN_ERROR(
+        status == xnn_status_success,
+        Internal,
+        "Internal Error: Setting up the runtime failed with code: %s",
+        xnn_status_to_string(status));
+    bucket.needs_setup = false;
+    bucket.setup_reshape_count = reshape_count.load(std::memory_order_relaxed);
+  }
 
   auto error = profiler_.start(context.event_tracer());
   if (error != Error::Ok) {
@@ -146,7 +244,13 @@ __ET_NODISCARD Error XNNExecutor::forward(BackendExecutionContext& context) {
         static_cast<unsigned int>(error));
   }
 
-  status = xnn_invoke_runtime(runtime_.get());
+  status = xnn_invoke_runtime(bucket.runtime.get());
+
+  // The outputs written by this execution are the inputs of the next one.
+  if (status == xnn_status_success && !states_.empty()) {
+    current_state_buffer_ = 1 - current_state_buffer_;
+    bind_states();
+  }
 
   error = profiler_.end();
   if (error != Error::Ok) {
@@ -177,7 +281,8 @@ __ET_NODISCARD Error XNNExecutor::forward(BackendExecutionContext& context) {
  */
 __ET_NODISCARD Error XNNExecutor::resize_outputs(EValue** args) const {
   size_t output_idx_start = input_ids_.size();
-  for (size_t i = output_idx_start; i < externals_.size(); ++i) {
+  size_t output_idx_end = output_idx_start + output_ids_.size();
+  for (size_t i = output_idx_start; i < output_idx_end; ++i) {
     uint32_t ext_id = externals_[i].id;
     Tensor* out_tensor = &args[ext_id]->toTensor();
 
@@ -185,8 +290,8 @@ __ET_NODISCARD Error XNNExecutor::resize_outputs(EValue** args) const {
     size_t dims[XNN_MAX_TENSOR_DIMS];
 
     // Fetch the updated output shapes from xnnpack runtime
-    xnn_status status =
-        xnn_get_external_value_shape(runtime_.get(), ext_id, &num_dim, dims);
+    xnn_status status = xnn_get_external_value_shape(
+        buckets_[current_bucket_].runtime.get(), ext_id, &num_dim, dims);
 
     ET_CHECK_OR_RETURN_ERROR(
         status == xnn_status_success,
@@ -224,6 +329,41 @@ __ET_NODISCARD Error XNNExecutor::resize_outputs(EValue** args) const {
   return Error::Ok;
 }
 
+void XNNExecutor::bind_states() {
+  if (states_.empty()) {
+    return;
+  }
+  const size_t num_args = input_ids_.size() + output_ids_.size();
+  for (size_t i = 0; i < states_.size(); ++i) {
+    externals_[num_args + 2 * i].data =
+        states_[i].buffers[current_state_buffer_];
+    externals_[num_args + 2 * i + 1].data =
+        states_[i].buffers[1 - current_state_buffer_];
+  }
+  invalidate_setups();
+}
+
+size_t XNNExecutor::select_bucket() const {
+  size_t selected = current_bucket_;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    const ShapeBucket& bucket = buckets_[i];
+    if (!bucket.needs_reshape && bucket.input_shapes == input_shapes_) {
+      return i;
+    }
+    // Buckets that were never used have last_used 0, so they go first.
+    if (bucket.last_used < buckets_[selected].last_used) {
+      selected = i;
+    }
+  }
+  return selected;
+}
+
+void XNNExecutor::invalidate_setups() {
+  for (ShapeBucket& bucket : buckets_) {
+    bucket.needs_setup = true;
+  }
+}
+
 } // namespace delegate
 } // namespace xnnpack
 } // namespace executor
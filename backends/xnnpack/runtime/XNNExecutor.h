@@ -25,15 +25,72 @@ namespace xnnpack {
 namespace delegate {
 
 class XNNExecutor {
+ public:
+  /**
+   * A tensor that the executor keeps across executions, such as a KV cache.
+   * It is double buffered: each execution reads buffers[i] through the
+   * external value input_id and writes buffers[1 - i] through output_id, then
+   * the two swap roles for the next execution.
+   */
+  struct PersistentState {
+    uint32_t input_id;
+    uint32_t output_id;
+    void* buffers[2];
+  };
+
  private:
-  std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
-      nullptr,
-      &xnn_delete_runtime};
+  /**
+   * A runtime built from the subgraph of the delegate, and the input shapes
+   * it was last reshaped for. Inputs whose shapes alternate between a few
+   * values, e.g. variable-length sequences that cluster at a few lengths,
+   * can then each run on a runtime that is already reshaped for them.
+   */
+  struct ShapeBucket {
+    std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime;
+    // XNN_MAX_TENSOR_DIMS + 1 entries per input: the number of dims followed
+    // by the dims, padded with zeros.
+    std::vector<size_t> input_shapes;
+    bool needs_reshape;
+    bool needs_setup;
+    // Value of the global reshape count at the last setup, see
+    // shares_workspace_.
+    uint64_t setup_reshape_count;
+    // Value of prepare_count_ when the bucket was last used.
+    uint64_t last_used;
+  };
+
+  std::vector<ShapeBucket> buckets_;
+  // The bucket of the arguments prepared last.
+  size_t current_bucket_ = 0;
+  uint64_t prepare_count_ = 0;
 
   profiling::XNNProfiler profiler_;
   std::vector<uint32_t> input_ids_;
   std::vector<uint32_t> output_ids_;
+  // Externals of the inputs, then of the outputs, then of the states.
   std::vector<xnn_external_value> externals_;
+  std::vector<PersistentState> states_;
+  // Index of the buffer of each state that the next execution reads.
+  size_t current_state_buffer_ = 0;
+
+  // Whether the runtimes allocate their intermediate tensors from a workspace
+  // shared with other runtimes, whose reshapes then require setting them up
+  // again. Each bucket then gets set up again after another was reshaped.
+  bool shares_workspace_ = true;
+
+  // Shapes of the inputs of the last prepare_args(), laid out like
+  // ShapeBucket::input_shapes.
+  std::vector<size_t> input_shapes_;
+
+  // Returns the bucket already reshaped for input_shapes_, or else the least
+  // recently used one.
+  size_t select_bucket() const;
+
+  // Requires every bucket to be set up again before it runs.
+  void invalidate_setups();
+
+  // Points the state externals at the buffers of the current execution.
+  void bind_states();
 
  public:
   XNNExecutor() = default;
@@ -46,21 +103,41 @@ class XNNExecutor {
     return output_ids_.size();
   }
 
+  inline size_t getNumStates() {
+    return states_.size();
+  }
+
   /**
    * Initialize the XNNExecutor with a given runtime and input/output ids.
    * The input/output ids are expected to be sorted in order of their
-   * flatbuffer id_outs
+   * flatbuffer id_outs. The external ids of states must not be among them,
+   * and their buffers must outlive the executor.
    */
   __ET_NODISCARD Error initialize(
       xnn_runtime_t runtime,
       std::vector<uint32_t>&& input_ids,
-      std::vector<uint32_t>&& output_ids);
+      std::vector<uint32_t>&& output_ids,
+      std::vector<PersistentState>&& states = {});
+
+  /**
+   * Adds a runtime built from the same subgraph as the one passed to
+   * initialize(), so that inputs of one more shape can run without
+   * reshaping. Each runtime has its own operators and, unless the workspace
+   * is shared, its own intermediate tensors.
+   */
+  __ET_NODISCARD Error add_shape_bucket(xnn_runtime_t runtime);
+
+  inline size_t getNumShapeBuckets() {
+    return buckets_.size();
+  }
 
   /**
    * Prepares the arguments for runtime graph execution.
    * args is an array of EValues that will be passed into the runtime.
    * input shapes will be propagated through the runtime, and perform
-   * any additional memory planning as needed
+   * any additional memory planning as needed. Reshaping is skipped when a
+   * shape bucket was already reshaped for the input shapes, and setup in
+   * forward() is skipped when its data pointers are the same as well.
    */
   __ET_NODISCARD Error prepare_args(EValue** args);
 
@@ -76,6 +153,13 @@ class XNNExecutor {
    */
   __ET_NODISCARD Error resize_outputs(EValue** args) const;
 
+  /**
+   * Counts of the reshapes and setups done and skipped so far.
+   */
+  const profiling::XNNPrepareStats& prepare_stats() const {
+    return profiler_.prepare_stats();
+  }
+
   friend class XNNCompiler;
 };
 
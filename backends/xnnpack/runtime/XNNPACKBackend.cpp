@@ -7,25 +7,43 @@
  */
 
 #include <executorch/backends/xnnpack/runtime/XNNCompiler.h>
+#include <executorch/runtime/backend/delegate_profiling.h>
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/evalue.h>
 #include <executorch/runtime/platform/profiler.h>
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <mutex>
 
 #pragma clang diagnostic ignored "-Wglobal-constructors"
 
 namespace torch {
 namespace executor {
 
+namespace {
+
+// Bounds the runtimes that the "shape_buckets" compile spec can ask for.
+constexpr uint32_t kMaxShapeBuckets = 8;
+
+} // namespace
+
 class XnnpackBackend final : public PyTorchBackendInterface {
  public:
   ~XnnpackBackend() = default;
 
+  XnnpackBackend() : workspace_(nullptr, &xnn_release_workspace) {}
+
   bool is_available() const override {
     return xnn_status_success == xnn_initialize(/*allocator=*/nullptr);
   }
 
+  // Shared state, the weights cache and the workspace, is guarded by locks.
+  bool is_init_thread_safe() const override {
+    return true;
+  }
+
   Result<DelegateHandle*> init(
       BackendInitContext& context,
       FreeableBuffer* processed,
@@ -33,17 +51,50 @@ class XnnpackBackend final : public PyTorchBackendInterface {
     auto executor = ET_ALLOCATE_INSTANCE_OR_RETURN_ERROR(
         context.get_runtime_allocator(), xnnpack::delegate::XNNExecutor);
 
-    // Executor has been allocated but not constructed, ensure that runtime_ is
-    // nullptr by constructing it in place here. NOTE: Since we use placement
-    // new and since this type is not trivially destructible, we must call the
-    // destructor manually in destroy().
+    // Executor has been allocated but not constructed, ensure that it holds
+    // no runtimes by constructing it in place here. NOTE: Since we use
+    // placement new and since this type is not trivially destructible, we
+    // must call the destructor manually in destroy().
     new (executor) xnnpack::delegate::XNNExecutor;
 
-    Error err = xnnpack::delegate::XNNCompiler::compileModel(
-        processed->data(),
-        processed->size(),
-        executor,
-        context.get_runtime_allocator());
+#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+    // Creating a runtime registers it with the workspace.
+    const std::lock_guard<std::mutex> lock(workspace_mutex_);
+    xnn_workspace_t workspace = get_or_create_workspace();
+#else
+    xnn_workspace_t workspace = nullptr;
+#endif
+
+    bool fp16_inference = false;
+    uint32_t num_shape_buckets = 1;
+    for (const CompileSpec& spec : compile_specs) {
+      if (std::strcmp(spec.key, "fp16_inference") == 0) {
+        fp16_inference = true;
+      } else if (
+          std::strcmp(spec.key, "shape_buckets") == 0 &&
+          spec.value.nbytes == sizeof(uint32_t)) {
+        // A little-endian uint32.
+        const auto* value = static_cast<const uint8_t*>(spec.value.buffer);
+        num_shape_buckets = value[0] | (value[1] << 8) | (value[2] << 16) |
+            (uint32_t(value[3]) << 24);
+        num_shape_buckets =
+            std::max(1u, std::min(num_shape_buckets, kMaxShapeBuckets));
+      }
+    }
+
+    Error err;
+    {
+      DelegateProfilingScope compile_scope(
+          context.event_tracer(), DelegateProfilingEventType::kCompile);
+      err = xnnpack::delegate::XNNCompiler::compileModel(
+          processed->data(),
+          processed->size(),
+          executor,
+          context.get_runtime_allocator(),
+          workspace,
+          fp16_inference,
+          num_shape_buckets);
+    }
     // This backend does not need its processed data after compiling the model.
     processed->Free();
 
@@ -65,13 +116,28 @@ class XnnpackBackend final : public PyTorchBackendInterface {
       EValue** args) const override {
     auto executor = static_cast<xnnpack::delegate::XNNExecutor*>(handle);
 
-    // Prepare Inputs/Outputs and Propagate Input Shapes
-    Error err = executor->prepare_args(args);
+#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+    // Runtimes sharing the workspace overwrite each other's intermediate
+    // tensors, so only one of them may run at a time.
+    const std::lock_guard<std::mutex> lock(workspace_mutex_);
+#endif
+
+    Error err;
+    {
+      // Prepare Inputs/Outputs and Propagate Input Shapes
+      DelegateProfilingScope transfer_scope(
+          context.event_tracer(), DelegateProfilingEventType::kDataTransfer);
+      err = executor->prepare_args(args);
+    }
     if (err != Error::Ok) {
       return err;
     }
 
-    err = executor->forward(context);
+    {
+      DelegateProfilingScope execute_scope(
+          context.event_tracer(), DelegateProfilingEventType::kExecute);
+      err = executor->forward(context);
+    }
 
     if (err != Error::Ok) {
       return err;
@@ -86,6 +152,10 @@ class XnnpackBackend final : public PyTorchBackendInterface {
   void destroy(DelegateHandle* handle) const override {
     if (handle != nullptr) {
       auto executor = static_cast<xnnpack::delegate::XNNExecutor*>(handle);
+#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+      // Deleting a runtime unregisters it from the workspace.
+      const std::lock_guard<std::mutex> lock(workspace_mutex_);
+#endif
 #ifdef ENABLE_XNNPACK_PROFILING
       executor->print_avg_op_timings();
 #endif
@@ -94,6 +164,35 @@ class XnnpackBackend final : public PyTorchBackendInterface {
       executor->~XNNExecutor();
     }
   }
+
+ private:
+#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+  // Created on first use since XNNPACK must be initialized first. Returns
+  // nullptr if it could not be created, in which case every runtime gets a
+  // workspace of its own. workspace_mutex_ must be held.
+  xnn_workspace_t get_or_create_workspace() const {
+    if (workspace_ == nullptr) {
+      xnn_workspace_t workspace = nullptr;
+      xnn_status status = xnn_create_workspace(&workspace);
+      if (status != xnn_status_success) {
+        ET_LOG(
+            Error,
+            "Failed to create the shared XNN workspace: %s",
+            xnnpack::delegate::xnn_status_to_string(status));
+        return nullptr;
+      }
+      workspace_.reset(workspace);
+    }
+    return workspace_.get();
+  }
+#endif
+
+  // Holds the intermediate tensors of all XNNPACK runtimes. Delegates normally
+  // run one after another, so peak memory is that of the largest delegate
+  // instead of the sum over all of them.
+  mutable std::mutex workspace_mutex_;
+  mutable std::unique_ptr<xnn_workspace, decltype(&xnn_release_workspace)>
+      workspace_;
 };
 
 namespace {
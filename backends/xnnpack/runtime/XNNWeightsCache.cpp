@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/xnnpack/runtime/XNNStatus.h>
+#include <executorch/backends/xnnpack/runtime/XNNWeightsCache.h>
+#include <executorch/runtime/platform/log.h>
+
+#include <cstring>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ET_XNNPACK_RELEASE_INTERNED_CONSTANTS 1
+#endif
+
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+
+namespace torch {
+namespace executor {
+namespace xnnpack {
+namespace delegate {
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Two independent 64-bit hashes of the data, so that two different constants
+// can only share a canonical copy if both collide.
+std::array<uint64_t, 2> hash_bytes(const uint8_t* data, size_t size) {
+  uint64_t h1 = 0x9e3779b97f4a7c15ULL;
+  uint64_t h2 = 0x6a09e667f3bcc909ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    h1 = rotl(h1 ^ (word * 0x87c37b91114253d5ULL), 27) * 5 + 0x52dce729;
+    h2 = rotl(h2 ^ (word * 0x4cf5ad432745937fULL), 31) * 5 + 0x38495ab5;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, data + i, size - i);
+  h1 = fmix(h1 ^ tail ^ size);
+  h2 = fmix(h2 ^ rotl(tail, 32) ^ size);
+  return {h1, h2};
+}
+
+#ifdef ET_XNNPACK_RELEASE_INTERNED_CONSTANTS
+size_t page_size() {
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+#endif
+
+} // namespace
+
+XNNWeightsCache::Session::Session(XNNWeightsCache* owner)
+    : owner_(owner),
+      lock_(owner->mutex_),
+      use_cache_(owner->get_or_create_xnn_cache() != nullptr) {}
+
+XNNWeightsCache::Session::Session(Session&& other) noexcept
+    : owner_(other.owner_),
+      lock_(std::move(other.lock_)),
+      use_cache_(other.use_cache_) {
+  other.owner_ = nullptr;
+}
+
+XNNWeightsCache::Session::~Session() {
+  if (owner_ != nullptr) {
+    owner_->release_constants();
+  }
+}
+
+const uint8_t* XNNWeightsCache::Session::intern(
+    const uint8_t* data,
+    size_t size) {
+  if (!use_cache_ || data == nullptr || size == 0) {
+    return data;
+  }
+  const uint8_t* canonical = owner_->intern(data, size);
+  if (canonical == nullptr) {
+    ET_LOG(
+        Info,
+        "Failed to intern %zu bytes of XNNPACK constant data, building the "
+        "runtime without the weights cache",
+        size);
+    use_cache_ = false;
+    return data;
+  }
+  return canonical;
+}
+
+xnn_weights_cache_t XNNWeightsCache::Session::xnn_cache() const {
+  return use_cache_ ? owner_->xnn_cache_ : nullptr;
+}
+
+void XNNWeightsCache::Session::on_runtime_created() {
+  if (!use_cache_ || owner_->xnn_cache_finalized_) {
+    return;
+  }
+  // A soft-finalized cache still accepts new weights while it has space left,
+  // and can be read by running runtimes without locking.
+  xnn_status status = xnn_finalize_weights_cache(
+      owner_->xnn_cache_, xnn_weights_cache_finalization_kind_soft);
+  if (status != xnn_status_success) {
+    ET_LOG(
+        Error,
+        "Failed to finalize the XNNPACK weights cache: %s",
+        xnn_status_to_string(status));
+    return;
+  }
+  owner_->xnn_cache_finalized_ = true;
+}
+
+XNNWeightsCache& XNNWeightsCache::get() {
+  // Never destroyed, since runtimes may outlive static destructors.
+  static XNNWeightsCache* cache = new XNNWeightsCache();
+  return *cache;
+}
+
+XNNWeightsCache::Session XNNWeightsCache::start_session() {
+  return Session(this);
+}
+
+xnn_weights_cache_t XNNWeightsCache::get_or_create_xnn_cache() {
+  if (xnn_cache_created_) {
+    return xnn_cache_;
+  }
+  xnn_cache_created_ = true;
+  if (ET_XNNPACK_WEIGHTS_CACHE_CAPACITY == 0) {
+    return nullptr;
+  }
+  xnn_status status = xnn_create_weights_cache_with_size(
+      ET_XNNPACK_WEIGHTS_CACHE_CAPACITY, &xnn_cache_);
+  if (status != xnn_status_success) {
+    ET_LOG(
+        Error,
+        "Failed to create the XNNPACK weights cache: %s",
+        xnn_status_to_string(status));
+    xnn_cache_ = nullptr;
+  }
+  return xnn_cache_;
+}
+
+const uint8_t* XNNWeightsCache::intern(const uint8_t* data, size_t size) {
+  const Key key{size, hash_bytes(data, size)};
+  auto it = constants_.find(key);
+  if (it == constants_.end()) {
+    // XNNPACK may read up to XNN_EXTRA_BYTES past the end of its inputs.
+    size_t allocation_size = size + XNN_EXTRA_BYTES;
+#ifdef ET_XNNPACK_RELEASE_INTERNED_CONSTANTS
+    allocation_size =
+        (allocation_size + page_size() - 1) / page_size() * page_size();
+    void* allocation = mmap(
+        nullptr,
+        allocation_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (allocation == MAP_FAILED) {
+      return nullptr;
+    }
+#else
+    void* allocation = ::operator new(allocation_size, std::nothrow);
+    if (allocation == nullptr) {
+      return nullptr;
+    }
+#endif
+    it = constants_
+             .emplace(
+                 key,
+                 Constant{
+                     static_cast<uint8_t*>(allocation),
+                     allocation_size,
+                     /*resident=*/false})
+             .first;
+  }
+
+  Constant& constant = it->second;
+  if (!constant.resident) {
+    std::memcpy(constant.data, data, size);
+    constant.resident = true;
+    resident_constants_.push_back(&constant);
+  }
+  return constant.data;
+}
+
+void XNNWeightsCache::release_constants() {
+#ifdef ET_XNNPACK_RELEASE_INTERNED_CONSTANTS
+  for (Constant* constant : resident_constants_) {
+    // Only the address of the canonical copy has to outlive the session, its
+    // contents are copied in again the next time it is interned.
+#ifdef __linux__
+    madvise(constant->data, constant->allocation_size, MADV_DONTNEED);
+#else
+    madvise(constant->data, constant->allocation_size, MADV_FREE);
+#endif
+    constant->resident = false;
+  }
+#endif
+  resident_constants_.clear();
+}
+
+} // namespace delegate
+} // namespace xnnpack
+} // namespace executor
+} // namespace torch
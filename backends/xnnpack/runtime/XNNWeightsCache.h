@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <xnnpack.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Bytes of packed weights reserved for the shared XNNPACK weights cache; 0
+// disables the cache. The reservation is virtual memory that is only backed
+// as weights are packed into it.
+#ifndef ET_XNNPACK_WEIGHTS_CACHE_CAPACITY
+#define ET_XNNPACK_WEIGHTS_CACHE_CAPACITY \
+  (sizeof(void*) >= 8 ? (size_t{1} << 32) : (size_t{1} << 28))
+#endif
+
+namespace torch {
+namespace executor {
+namespace xnnpack {
+namespace delegate {
+
+/**
+ * Process-wide cache of packed XNNPACK weights. XNNCompiler passes it to every
+ * runtime it creates, so constants that several delegates share are packed
+ * and stored once. Examples are the weights of the prefill and decode methods
+ * of one model, or of several instances of one method.
+ *
+ * XNNPACK finds previously packed weights by the address of the unpacked
+ * constant data. Every delegate carries its own copy of its constants and
+ * frees that copy after init, so these addresses say nothing about identity
+ * across delegates, and may even be reused for different data. Constants are
+ * therefore interned before XNNPACK sees them: all buffers with the same size
+ * and content hash share one canonical address for the life of the process.
+ * On Linux and Apple platforms, the pages behind a canonical copy are given
+ * back once the runtime is built, and refilled the next time that constant is
+ * interned, so only the packed weights stay resident.
+ *
+ * The XNNPACK cache is soft-finalized after the first runtime using it is
+ * built, so that runtimes can execute while others are still being built.
+ * After that it cannot grow past ET_XNNPACK_WEIGHTS_CACHE_CAPACITY. A runtime
+ * whose new weights do not fit falls back to packing its own copy.
+ */
+class XNNWeightsCache {
+ public:
+  /**
+   * Exclusive access to the cache while one runtime is built. Interned
+   * constants stay readable until the session is destroyed.
+   */
+  class Session {
+   public:
+    ~Session();
+
+    Session(Session&& other) noexcept;
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+    Session& operator=(Session&&) = delete;
+
+    /**
+     * Returns the canonical copy of the `size` bytes at `data`. If the cache
+     * is disabled or the copy cannot be allocated, returns `data` itself and
+     * disables the cache for this session.
+     */
+    const uint8_t* intern(const uint8_t* data, size_t size);
+
+    /**
+     * The XNNPACK weights cache to build the runtime with, or nullptr to
+     * build it without one.
+     */
+    xnn_weights_cache_t xnn_cache() const;
+
+    /**
+     * Must be called after a runtime was successfully built with xnn_cache().
+     */
+    void on_runtime_created();
+
+   private:
+    friend class XNNWeightsCache;
+    explicit Session(XNNWeightsCache* owner);
+
+    XNNWeightsCache* owner_;
+    std::unique_lock<std::mutex> lock_;
+    bool use_cache_;
+  };
+
+  /// Returns the process-wide cache.
+  static XNNWeightsCache& get();
+
+  /// Starts building a runtime. Blocks while another session is active.
+  Session start_session();
+
+ private:
+  struct Key {
+    size_t size;
+    std::array<uint64_t, 2> hash;
+
+    bool operator==(const Key& other) const {
+      return size == other.size && hash == other.hash;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return static_cast<size_t>(key.hash[0]);
+    }
+  };
+
+  struct Constant {
+    uint8_t* data;
+    size_t allocation_size;
+    bool resident;
+  };
+
+  XNNWeightsCache() = default;
+  ~XNNWeightsCache() = delete;
+
+  // Lazily creates the XNNPACK cache. Returns nullptr if it is disabled or
+  // could not be created.
+  xnn_weights_cache_t get_or_create_xnn_cache();
+
+  // Returns nullptr if the canonical copy could not be allocated.
+  const uint8_t* intern(const uint8_t* data, size_t size);
+
+  // Gives back the pages of the constants interned by the current session.
+  void release_constants();
+
+  std::mutex mutex_;
+  xnn_weights_cache_t xnn_cache_ = nullptr;
+  bool xnn_cache_created_ = false;
+  bool xnn_cache_finalized_ = false;
+  std::unordered_map<Key, Constant, KeyHash> constants_;
+  std::vector<Constant*> resident_constants_;
+};
+
+} // namespace delegate
+} // namespace xnnpack
+} // namespace executor
+} // namespace torch
@@ -15,6 +15,7 @@
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/platform.h>
 #include <executorch/runtime/platform/types.h>
+#include <xnnpack/subgraph.h>
 
 #include <cinttypes>
 #include <cstring>
@@ -25,11 +26,143 @@
 namespace torch::executor::xnnpack::delegate::profiling {
 
 #if defined(ET_EVENT_TRACER_ENABLED) || defined(ENABLE_XNNPACK_PROFILING)
+namespace {
+
+uint64_t num_elements(const xnn_value& value) {
+  uint64_t numel = 1;
+  for (size_t d = 0; d < value.shape.num_dims; ++d) {
+    numel *= value.shape.dim[d];
+  }
+  return numel;
+}
+
+void append_shapes(
+    std::string& json,
+    const xnn_runtime& runtime,
+    const uint32_t* ids,
+    uint32_t num_ids) {
+  json += '[';
+  bool first = true;
+  for (uint32_t i = 0; i < num_ids; ++i) {
+    if (ids[i] == XNN_INVALID_VALUE_ID) {
+      continue;
+    }
+    const xnn_shape& shape = runtime.values[ids[i]].shape;
+    json += first ? "[" : ",[";
+    first = false;
+    for (size_t d = 0; d < shape.num_dims; ++d) {
+      json += (d == 0 ? "" : ",") + std::to_string(shape.dim[d]);
+    }
+    json += ']';
+  }
+  json += ']';
+}
+
+/**
+ * Estimates the FLOPs done by a node. Matrix multiplications and
+ * convolutions count a multiply and an add per MAC, data movement counts
+ * nothing and everything else one FLOP per output element.
+ */
+uint64_t estimate_flops(
+    const xnn_runtime& runtime,
+    const xnn_operator_data& opdata) {
+  if (opdata.num_outputs == 0 || opdata.outputs[0] == XNN_INVALID_VALUE_ID) {
+    return 0;
+  }
+  const xnn_value& output = runtime.values[opdata.outputs[0]];
+  const uint64_t output_numel = num_elements(output);
+  const auto input = [&](uint32_t i) -> const xnn_value* {
+    return i < opdata.num_inputs && opdata.inputs[i] != XNN_INVALID_VALUE_ID
+        ? &runtime.values[opdata.inputs[i]]
+        : nullptr;
+  };
+  switch (opdata.type) {
+    case xnn_node_type_fully_connected: {
+      const xnn_value* filter = input(1);
+      if (filter == nullptr || filter->shape.num_dims == 0) {
+        return 0;
+      }
+      const size_t k = (opdata.flags & XNN_FLAG_TRANSPOSE_WEIGHTS)
+          ? filter->shape.dim[0]
+          : filter->shape.dim[filter->shape.num_dims - 1];
+      return 2 * output_numel * k;
+    }
+    case xnn_node_type_batch_matrix_multiply: {
+      const xnn_value* a = input(0);
+      if (a == nullptr || a->shape.num_dims == 0) {
+        return 0;
+      }
+      return 2 * output_numel * a->shape.dim[a->shape.num_dims - 1];
+    }
+    case xnn_node_type_convolution_2d:
+    case xnn_node_type_depthwise_convolution_2d: {
+      // The filter holds the MACs for every output channel.
+      const xnn_value* filter = input(1);
+      const size_t num_dims = output.shape.num_dims;
+      if (filter == nullptr || num_dims == 0 ||
+          output.shape.dim[num_dims - 1] == 0) {
+        return 0;
+      }
+      return 2 * output_numel * num_elements(*filter) /
+          output.shape.dim[num_dims - 1];
+    }
+    case xnn_node_type_deconvolution_2d: {
+      // Every input element is multiplied with a filter slice.
+      const xnn_value* in = input(0);
+      const xnn_value* filter = input(1);
+      if (in == nullptr || filter == nullptr || filter->shape.num_dims == 0 ||
+          filter->shape.dim[filter->shape.num_dims - 1] == 0) {
+        return 0;
+      }
+      return 2 * num_elements(*in) * num_elements(*filter) /
+          filter->shape.dim[filter->shape.num_dims - 1];
+    }
+    case xnn_node_type_concatenate2:
+    case xnn_node_type_concatenate3:
+    case xnn_node_type_concatenate4:
+    case xnn_node_type_copy:
+    case xnn_node_type_even_split2:
+    case xnn_node_type_even_split3:
+    case xnn_node_type_static_constant_pad:
+    case xnn_node_type_static_reshape:
+    case xnn_node_type_static_slice:
+    case xnn_node_type_static_transpose:
+      return 0;
+    default:
+      return output_numel;
+  }
+}
+
+/**
+ * Bytes read and written by a node, counting every input, including its
+ * weights, and every output once.
+ */
+uint64_t estimate_bytes(
+    const xnn_runtime& runtime,
+    const xnn_operator_data& opdata) {
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < opdata.num_inputs; ++i) {
+    if (opdata.inputs[i] != XNN_INVALID_VALUE_ID) {
+      bytes += xnn_tensor_get_size(&runtime.values[opdata.inputs[i]]);
+    }
+  }
+  for (uint32_t i = 0; i < opdata.num_outputs; ++i) {
+    if (opdata.outputs[i] != XNN_INVALID_VALUE_ID) {
+      bytes += xnn_tensor_get_size(&runtime.values[opdata.outputs[i]]);
+    }
+  }
+  return bytes;
+}
+
+} // namespace
+
 XNNProfiler::XNNProfiler()
     : state_(XNNProfilerState::Uninitialized), run_count_(0) {}
 
 Error XNNProfiler::initialize(xnn_runtime_t runtime) {
   runtime_ = runtime;
+  // A different runtime of the same subgraph may have other shapes.
+  op_metadata_stale_ = true;
 
   // Fetch the runtime operator information from XNNPACK.
   ET_CHECK_OK_OR_RETURN_ERROR(get_runtime_num_operators());
@@ -73,6 +206,11 @@ Error XNNProfiler::end() {
   // Retrieve operator timing from XNNPACK.
   ET_CHECK_OK_OR_RETURN_ERROR(get_runtime_operator_timings());
 
+  if (op_metadata_stale_) {
+    update_operator_metadata();
+    op_metadata_stale_ = false;
+  }
+
   if (event_tracer_ != nullptr) {
     submit_trace();
   }
@@ -152,6 +290,38 @@ Error XNNProfiler::get_runtime_operator_timings() {
   return Error::Ok;
 }
 
+void XNNProfiler::update_operator_metadata() {
+  // Walk the operators in the same order as XNNPACK reports their timings.
+  op_metadata_.assign(op_count_, std::string());
+  size_t op_index = 0;
+  for (size_t i = 0; i < runtime_->num_ops; ++i) {
+    const xnn_operator_data& opdata = runtime_->opdata[i];
+    bool first = true;
+    for (size_t j = 0; j < XNN_MAX_OPERATOR_OBJECTS; ++j) {
+      if (opdata.operator_objects[j] == nullptr) {
+        continue;
+      }
+      if (op_index >= op_count_) {
+        return;
+      }
+      if (first) {
+        std::string& json = op_metadata_[op_index];
+        json = "{\"inputs\":";
+        append_shapes(json, *runtime_, opdata.inputs, opdata.num_inputs);
+        json += ",\"outputs\":";
+        append_shapes(json, *runtime_, opdata.outputs, opdata.num_outputs);
+        json += ",\"flops\":";
+        json += std::to_string(estimate_flops(*runtime_, opdata));
+        json += ",\"bytes\":";
+        json += std::to_string(estimate_bytes(*runtime_, opdata));
+        json += '}';
+        first = false;
+      }
+      ++op_index;
+    }
+  }
+}
+
 void XNNProfiler::log_operator_timings() {
 #ifdef ENABLE_XNNPACK_PROFILING
   // Update running average state and log average timing for each op.
@@ -173,9 +343,22 @@ void XNNProfiler::log_operator_timings() {
     total_time += avg_op_time;
 
     ET_LOG(
-        Info, ">>, %s, %" PRId64 " (%f)", op_name, op_timings_[i], avg_op_time);
+        Info,
+        ">>, %s, %" PRId64 " (%f), %s",
+        op_name,
+        op_timings_[i],
+        avg_op_time,
+        op_metadata_[i].c_str());
   }
   ET_LOG(Info, ">>, Total Time, %f", total_time);
+  ET_LOG(
+      Info,
+      ">>, Reshapes, %" PRIu64 " (%" PRIu64 " skipped), Setups, %" PRIu64
+      " (%" PRIu64 " skipped)",
+      prepare_stats_.reshapes,
+      prepare_stats_.skipped_reshapes,
+      prepare_stats_.setups,
+      prepare_stats_.skipped_setups);
 #else
   run_count_++;
 #endif
@@ -210,12 +393,16 @@ void XNNProfiler::submit_trace() {
 
     auto end_time = time + interval_ticks;
 
-    torch::executor::event_tracer_log_profiling_delegate(
+    // The metadata is serialized into ETDump as-is, without the terminator.
+    const std::string& metadata = op_metadata_[i];
+    torch::executor::log_delegate_node_event(
         event_tracer_,
         name_formatted.c_str(),
-        /*delegate_debug_id=*/static_cast<torch::executor::DebugHandle>(-1),
+        torch::executor::kDelegateNamedEventId,
         time,
-        end_time);
+        end_time,
+        metadata.empty() ? nullptr : metadata.data(),
+        metadata.size());
 
     // Assume that the next op starts immediately after the previous op.
     // This may not be strictly true, but it should be close enough.
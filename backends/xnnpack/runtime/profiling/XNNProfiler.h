@@ -8,10 +8,11 @@
 
 #pragma once
 
+#include <executorch/runtime/backend/delegate_profiling.h>
 #include <executorch/runtime/core/error.h>
-#include <executorch/runtime/core/event_tracer_hooks_delegate.h>
 
 #include <xnnpack.h>
+#include <string>
 #include <vector>
 
 namespace torch {
@@ -22,13 +23,25 @@ namespace profiling {
 
 enum class XNNProfilerState { Uninitialized, Ready, Running };
 
+/**
+ * How often XNNExecutor had to reshape and set up its runtime, and how often
+ * it could skip doing so because inputs were unchanged since the last call.
+ */
+struct XNNPrepareStats {
+  uint64_t reshapes = 0;
+  uint64_t skipped_reshapes = 0;
+  uint64_t setups = 0;
+  uint64_t skipped_setups = 0;
+};
+
 class XNNProfiler {
  public:
   XNNProfiler();
 
   /**
    * Initialize the profiler. This must be called after model is
-   * compiled and before calling begin_execution.
+   * compiled and before calling begin_execution, and again to profile
+   * another runtime.
    */
   Error initialize(xnn_runtime_t runtime);
 
@@ -45,7 +58,25 @@ class XNNProfiler {
    */
   Error end();
 
+  /**
+   * Counts one call to prepare the runtime, which reshaped and set it up only
+   * if the arguments say so.
+   */
+  void record_prepare(bool reshaped, bool setup) {
+    reshaped ? ++prepare_stats_.reshapes : ++prepare_stats_.skipped_reshapes;
+    setup ? ++prepare_stats_.setups : ++prepare_stats_.skipped_setups;
+    // Operator shapes, and so their metadata, only change on a reshape.
+    op_metadata_stale_ = op_metadata_stale_ || reshaped;
+  }
+
+  const XNNPrepareStats& prepare_stats() const {
+    return prepare_stats_;
+  }
+
  private:
+  XNNPrepareStats prepare_stats_;
+  bool op_metadata_stale_ = true;
+
 #if defined(ET_EVENT_TRACER_ENABLED) || defined(ENABLE_XNNPACK_PROFILING)
   EventTracer* event_tracer_;
   xnn_runtime_t runtime_;
@@ -54,6 +85,10 @@ class XNNProfiler {
   size_t op_count_;
   std::vector<char> op_names_;
   std::vector<uint64_t> op_timings_;
+  // Per operator JSON metadata with the shapes of its inputs and outputs and
+  // an estimate of the FLOPs it did and bytes it moved. Empty for the extra
+  // operators of nodes that XNNPACK runs as more than one operator.
+  std::vector<std::string> op_metadata_;
   uint64_t run_count_;
   et_timestamp_t start_time_;
 
@@ -68,6 +103,11 @@ class XNNProfiler {
   Error get_runtime_num_operators();
   Error get_runtime_operator_timings();
 
+  /**
+   * Rebuilds op_metadata_ from the current shapes of the runtime values.
+   */
+  void update_operator_metadata();
+
   void log_operator_timings();
 
   /**
@@ -10,7 +10,7 @@
 Please refer to executorch/backends/xnnpack/serialization/schema.fbs for the schema definitions
 """
 
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from enum import IntEnum
 from typing import List, Optional, Union
 
@@ -447,6 +447,12 @@ class ConstantDataOffset:
     size: int
 
 
+@dataclass
+class XNNState:
+    input_id: int
+    output_id: int
+
+
 @dataclass
 class XNNGraph:
     version: str
@@ -458,3 +464,5 @@ class XNNGraph:
     output_ids: List[int]
 
     constant_data: List[ConstantDataOffset]
+
+    state: List[XNNState] = field(default_factory=list)
@@ -37,6 +37,7 @@ def define_common_targets():
         ],
         preprocessor_flags = [
             # "-DENABLE_XNNPACK_PROFILING",
+            "-DENABLE_XNNPACK_SHARED_WORKSPACE",
         ],
         exported_deps = [
             "//executorch/runtime/backend:interface",
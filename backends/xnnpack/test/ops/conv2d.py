@@ -8,8 +8,12 @@ import unittest
 from typing import Optional
 
 import torch
+from executorch.backends.xnnpack.partition.xnnpack_partitioner import XnnpackPartitioner
 from executorch.backends.xnnpack.test.test_xnnpack_utils import randomize_bn
-from executorch.backends.xnnpack.test.tester import Quantize, Tester
+from executorch.backends.xnnpack.test.tester import Partition, Quantize, Tester
+from executorch.backends.xnnpack.utils.configs import (
+    get_xnnpack_fp16_inference_compile_spec,
+)
 from torch.ao.quantization.quantizer.xnnpack_quantizer import (
     get_symmetric_quantization_config,
 )
@@ -163,6 +167,24 @@ class TestConv2d(unittest.TestCase):
         for has_bias in (True, False):
             self._test(Conv2d(bias=has_bias))
 
+    def test_fp32_conv2d_fp16_inference(self) -> None:
+        m = Conv2d()
+        partitioner = XnnpackPartitioner(
+            compile_specs=[get_xnnpack_fp16_inference_compile_spec()]
+        )
+        (
+            Tester(m.eval(), m.get_inputs())
+            .export()
+            .to_edge()
+            .partition(Partition(partitioner))
+            .check_count({"torch.ops.higher_order.executorch_call_delegate": 1})
+            .to_executorch()
+            .serialize()
+            # CPUs without fp16 arithmetic run in fp32, others need the wider
+            # tolerance.
+            .run_method_and_compare_outputs(atol=1e-2, rtol=1e-2)
+        )
+
     def test_qs8_conv2d_test(self) -> None:
         for has_bias in (True, False):
             self._test(
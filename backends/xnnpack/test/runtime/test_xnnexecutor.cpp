@@ -8,9 +8,13 @@
 
 #include <executorch/backends/xnnpack/runtime/XNNExecutor.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
 #include <gtest/gtest.h>
 #include <xnnpack/subgraph.h>
 
+#include <limits>
+
+using torch::executor::BackendExecutionContext;
 using torch::executor::Error;
 using torch::executor::EValue;
 using torch::executor::testing::TensorFactory;
@@ -92,3 +96,235 @@ TEST(XNNExecutorTest, ArgumentWithTooManyDimensions) {
   // Check for invalid number of dimensions should fail without stack overflow.
   EXPECT_EQ(executor.prepare_args(args.data()), Error::InvalidArgument);
 }
+
+TEST(XNNExecutorTest, SkipsReshapeAndSetupForUnchangedInputs) {
+  XNNExecutor executor;
+  xnn_subgraph_t subgraph = nullptr;
+  xnn_runtime_t rt = nullptr;
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  ASSERT_EQ(xnn_create_subgraph(2, 0, &subgraph), xnn_status_success);
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> auto_subgraph(
+      subgraph, xnn_delete_subgraph);
+
+  std::vector<size_t> dims = {2, 2};
+  uint32_t input_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/0,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id));
+  uint32_t output_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/1,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_OUTPUT,
+          &output_id));
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_clamp(subgraph, 0.0f, 1.0f, input_id, output_id, 0));
+
+  ASSERT_EQ(xnn_create_runtime(subgraph, &rt), xnn_status_success);
+  ASSERT_EQ(executor.initialize(rt, {0}, {1}), Error::Ok);
+
+  TensorFactory<exec_aten::ScalarType::Float> tf;
+  auto input_tensor = tf.make({2, 2}, {-1.0, 0.25, 0.5, 2.0});
+  auto output_tensor = tf.zeros({2, 2});
+  EValue input_ev(input_tensor);
+  EValue output_ev(output_tensor);
+  std::array<EValue*, 2> args = {&input_ev, &output_ev};
+  BackendExecutionContext context;
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+    ASSERT_EQ(executor.forward(context), Error::Ok);
+    ASSERT_EQ(executor.resize_outputs(args.data()), Error::Ok);
+  }
+  EXPECT_TENSOR_EQ(output_tensor, tf.make({2, 2}, {0.0, 0.25, 0.5, 1.0}));
+  EXPECT_EQ(executor.prepare_stats().reshapes, 1u);
+  EXPECT_EQ(executor.prepare_stats().skipped_reshapes, 2u);
+  EXPECT_EQ(executor.prepare_stats().setups, 1u);
+  EXPECT_EQ(executor.prepare_stats().skipped_setups, 2u);
+
+  // New data pointers need a new setup but no reshape.
+  auto other_output = tf.zeros({2, 2});
+  EValue other_output_ev(other_output);
+  args[1] = &other_output_ev;
+  ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+  ASSERT_EQ(executor.forward(context), Error::Ok);
+  EXPECT_TENSOR_EQ(other_output, tf.make({2, 2}, {0.0, 0.25, 0.5, 1.0}));
+  EXPECT_EQ(executor.prepare_stats().reshapes, 1u);
+  EXPECT_EQ(executor.prepare_stats().setups, 2u);
+}
+
+TEST(XNNExecutorTest, ShapeBucketsKeepRuntimesReshaped) {
+  XNNExecutor executor;
+  xnn_subgraph_t subgraph = nullptr;
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  ASSERT_EQ(xnn_create_subgraph(2, 0, &subgraph), xnn_status_success);
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> auto_subgraph(
+      subgraph, xnn_delete_subgraph);
+
+  std::vector<size_t> dims = {2, 2};
+  uint32_t input_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/0,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id));
+  uint32_t output_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/1,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_OUTPUT,
+          &output_id));
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_clamp(subgraph, 0.0f, 1.0f, input_id, output_id, 0));
+
+  std::array<xnn_runtime_t, 2> runtimes;
+  for (xnn_runtime_t& rt : runtimes) {
+    ASSERT_EQ(xnn_create_runtime(subgraph, &rt), xnn_status_success);
+  }
+  ASSERT_EQ(executor.initialize(runtimes[0], {0}, {1}), Error::Ok);
+  ASSERT_EQ(executor.add_shape_bucket(runtimes[1]), Error::Ok);
+  EXPECT_EQ(executor.getNumShapeBuckets(), 2);
+
+  TensorFactory<exec_aten::ScalarType::Float> tf;
+  auto square = tf.make({2, 2}, {-1.0, 0.25, 0.5, 2.0});
+  auto row = tf.make({1, 4}, {2.0, 0.5, 0.25, -1.0});
+  auto output_tensor = tf.zeros({2, 2});
+  EValue square_ev(square);
+  EValue row_ev(row);
+  EValue output_ev(output_tensor);
+  std::array<EValue*, 2> args = {&square_ev, &output_ev};
+  BackendExecutionContext context;
+
+  // Each shape keeps its own runtime, so alternating them only reshapes
+  // each runtime once.
+  for (int i = 0; i < 4; ++i) {
+    args[0] = i % 2 == 0 ? &square_ev : &row_ev;
+    ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+    ASSERT_EQ(executor.forward(context), Error::Ok);
+    const float* out = output_tensor.const_data_ptr<float>();
+    if (i % 2 == 0) {
+      EXPECT_EQ(out[0], 0.0f);
+      EXPECT_EQ(out[3], 1.0f);
+    } else {
+      EXPECT_EQ(out[0], 1.0f);
+      EXPECT_EQ(out[3], 0.0f);
+    }
+  }
+  EXPECT_EQ(executor.prepare_stats().reshapes, 2u);
+  EXPECT_EQ(executor.prepare_stats().skipped_reshapes, 2u);
+
+  // A third shape reshapes the least recently used runtime.
+  auto column = tf.make({4, 1}, {0.5, 0.5, 0.5, 0.5});
+  EValue column_ev(column);
+  args[0] = &column_ev;
+  ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+  ASSERT_EQ(executor.forward(context), Error::Ok);
+  args[0] = &row_ev;
+  ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+  EXPECT_EQ(executor.prepare_stats().reshapes, 3u);
+  args[0] = &square_ev;
+  ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+  EXPECT_EQ(executor.prepare_stats().reshapes, 4u);
+}
+
+TEST(XNNExecutorTest, KeepsStateAcrossExecutions) {
+  XNNExecutor executor;
+  xnn_subgraph_t subgraph = nullptr;
+  xnn_runtime_t rt = nullptr;
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  ASSERT_EQ(xnn_create_subgraph(4, 0, &subgraph), xnn_status_success);
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> auto_subgraph(
+      subgraph, xnn_delete_subgraph);
+
+  // External ids 0 and 1 are the delegate arguments, 2 and 3 the state.
+  std::vector<size_t> dims = {2, 2};
+  std::array<uint32_t, 4> ids;
+  const std::array<uint32_t, 4> flags = {
+      XNN_VALUE_FLAG_EXTERNAL_INPUT,
+      XNN_VALUE_FLAG_EXTERNAL_OUTPUT,
+      XNN_VALUE_FLAG_EXTERNAL_INPUT,
+      XNN_VALUE_FLAG_EXTERNAL_OUTPUT};
+  for (uint32_t i = 0; i < ids.size(); ++i) {
+    ASSERT_EQ(
+        xnn_status_success,
+        xnn_define_tensor_value(
+            subgraph,
+            xnn_datatype_fp32,
+            dims.size(),
+            dims.data(),
+            nullptr,
+            /*external_id=*/i,
+            flags[i],
+            &ids[i]));
+  }
+  const float inf = std::numeric_limits<float>::infinity();
+  // output = state + input, and state = state + input.
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_add2(subgraph, -inf, inf, ids[2], ids[0], ids[1], 0));
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_add2(subgraph, -inf, inf, ids[2], ids[0], ids[3], 0));
+
+  ASSERT_EQ(xnn_create_runtime(subgraph, &rt), xnn_status_success);
+  constexpr size_t kBufferSize = 4 + XNN_EXTRA_BYTES / sizeof(float);
+  std::vector<float> state_data(2 * kBufferSize, 0.0f);
+  ASSERT_EQ(
+      executor.initialize(
+          rt,
+          {0},
+          {1},
+          {{2, 3, {state_data.data(), state_data.data() + kBufferSize}}}),
+      Error::Ok);
+  EXPECT_EQ(executor.getNumStates(), 1);
+
+  TensorFactory<exec_aten::ScalarType::Float> tf;
+  auto input_tensor = tf.make({2, 2}, {1.0, 2.0, 3.0, 4.0});
+  auto output_tensor = tf.zeros({2, 2});
+  EValue input_ev(input_tensor);
+  EValue output_ev(output_tensor);
+  std::array<EValue*, 2> args = {&input_ev, &output_ev};
+  BackendExecutionContext context;
+
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+    ASSERT_EQ(executor.forward(context), Error::Ok);
+    ASSERT_EQ(executor.resize_outputs(args.data()), Error::Ok);
+    const float n = i;
+    EXPECT_TENSOR_EQ(output_tensor, tf.make({2, 2}, {n, 2 * n, 3 * n, 4 * n}));
+  }
+  // The runtime is only reshaped once, even though it reads its state from
+  // the other buffer on every execution.
+  EXPECT_EQ(executor.prepare_stats().reshapes, 1u);
+}
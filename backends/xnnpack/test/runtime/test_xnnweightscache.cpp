@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/backends/xnnpack/runtime/XNNWeightsCache.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+using torch::executor::xnnpack::delegate::XNNWeightsCache;
+
+class XNNWeightsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+    ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  }
+};
+
+TEST_F(XNNWeightsCacheTest, EqualConstantsShareOneCopy) {
+  std::vector<uint8_t> a(4096, 1);
+  std::vector<uint8_t> b(4096, 1);
+  std::vector<uint8_t> c(4096, 2);
+
+  auto session = XNNWeightsCache::get().start_session();
+  ASSERT_NE(session.xnn_cache(), nullptr);
+  const uint8_t* interned_a = session.intern(a.data(), a.size());
+  const uint8_t* interned_b = session.intern(b.data(), b.size());
+  const uint8_t* interned_c = session.intern(c.data(), c.size());
+
+  EXPECT_NE(interned_a, a.data());
+  EXPECT_EQ(interned_a, interned_b);
+  EXPECT_NE(interned_a, interned_c);
+  EXPECT_EQ(std::memcmp(interned_a, a.data(), a.size()), 0);
+  EXPECT_EQ(std::memcmp(interned_c, c.data(), c.size()), 0);
+  // Same content but a different size is a different constant.
+  EXPECT_NE(session.intern(a.data(), a.size() - 1), interned_a);
+}
+
+TEST_F(XNNWeightsCacheTest, AddressIsStableAcrossSessions) {
+  std::vector<uint8_t> data(10000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  const uint8_t* first = nullptr;
+  {
+    auto session = XNNWeightsCache::get().start_session();
+    first = session.intern(data.data(), data.size());
+  }
+
+  // The source buffer of a later delegate lives somewhere else.
+  std::vector<uint8_t> copy(data);
+  auto session = XNNWeightsCache::get().start_session();
+  const uint8_t* second = session.intern(copy.data(), copy.size());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(std::memcmp(second, data.data(), data.size()), 0);
+}
@@ -105,33 +105,51 @@ bool populate_available_cpu_mids() {
   return true;
 }
 
-uint32_t _get_num_performant_cores() {
+bool is_non_performant_midr(uint32_t midr) {
+  switch (midr & RIVISION_MASK) {
+    case CPUINFO_ARM_MIDR_CORTEX_A520:
+    case CPUINFO_ARM_MIDR_CORTEX_A53:
+    case CPUINFO_ARM_MIDR_CORTEX_A55:
+    case CPUINFO_ARM_MIDR_CORTEX_A57:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the MIDR of every processor, or an empty vector if they could not
+// all be read.
+const std::vector<uint32_t>* get_available_cpu_midrs() {
   // @lint-ignore CLANGTIDY facebook-hte-std::once_flag
   static std::once_flag flag;
   // @lint-ignore CLANGTIDY facebook-hte-std::call_once
   std::call_once(flag, []() { populate_available_cpu_mids(); });
-  std::vector<uint32_t>* cpu_midrs = get_static_cpu_midr_vector();
+  return get_static_cpu_midr_vector();
+}
+
+uint32_t _get_num_performant_cores() {
+  const std::vector<uint32_t>* cpu_midrs = get_available_cpu_midrs();
   uint32_t num_possible_cores = cpuinfo_get_processors_count();
   if (num_possible_cores != cpu_midrs->size()) {
     ET_LOG(Info, "CPU info and manual query on # of cpus dont match.");
     return 0;
   }
   for (int32_t i = 0; i < cpu_midrs->size(); ++i) {
-    uint32_t masked_midr = (*cpu_midrs)[i] & RIVISION_MASK;
-    switch (masked_midr) {
-      case CPUINFO_ARM_MIDR_CORTEX_A520:
-      case CPUINFO_ARM_MIDR_CORTEX_A53:
-      case CPUINFO_ARM_MIDR_CORTEX_A55:
-      case CPUINFO_ARM_MIDR_CORTEX_A57:
-        num_possible_cores--;
-        break;
-      default:
-        break;
+    if (is_non_performant_midr((*cpu_midrs)[i])) {
+      num_possible_cores--;
     }
   }
   return num_possible_cores;
 }
 
+uint32_t get_processor_id(uint32_t index) {
+#if defined(__linux__)
+  return static_cast<uint32_t>(cpuinfo_get_processor(index)->linux_id);
+#else
+  return index;
+#endif
+}
+
 } // namespace
 
 uint32_t get_num_performant_cores() {
@@ -171,6 +189,44 @@ uint32_t get_num_performant_cores() {
   }
 }
 
+std::vector<uint32_t> get_performant_core_ids() {
+  ET_CHECK_MSG(cpuinfo_initialize(), "cpuinfo cannot be initialized.");
+  const uint32_t num_processors = cpuinfo_get_processors_count();
+  std::vector<uint32_t> all_ids;
+  std::vector<uint32_t> performant_ids;
+  if (cpuinfo_get_uarchs_count() > 1) {
+    for (uint32_t i = 0; i < num_processors; ++i) {
+      const struct cpuinfo_core* core = cpuinfo_get_processor(i)->core;
+      struct cpuinfo_uarch_info uarch_info = {};
+      uarch_info.uarch = core->uarch;
+#if CPUINFO_ARCH_ARM || CPUINFO_ARCH_ARM64
+      uarch_info.midr = core->midr;
+#endif
+      all_ids.push_back(get_processor_id(i));
+      if (!is_non_performant_core(&uarch_info)) {
+        performant_ids.push_back(get_processor_id(i));
+      }
+    }
+  } else {
+    // Same fallback as get_num_performant_cores(): cpuinfo may report a
+    // single uarch on big.LITTLE devices, so look at each MIDR instead.
+    const std::vector<uint32_t>* cpu_midrs = get_available_cpu_midrs();
+    for (uint32_t i = 0; i < num_processors; ++i) {
+      all_ids.push_back(get_processor_id(i));
+      if (cpu_midrs->size() == num_processors &&
+          !is_non_performant_midr((*cpu_midrs)[i])) {
+        performant_ids.push_back(get_processor_id(i));
+      }
+    }
+  }
+  ET_LOG(
+      Info,
+      "Found %zu performant cores out of %u",
+      performant_ids.size(),
+      num_processors);
+  return performant_ids.empty() ? all_ids : performant_ids;
+}
+
 } // namespace cpuinfo
 } // namespace executorch
 } // namespace torch
@@ -10,12 +10,21 @@
 
 #include <cpuinfo.h>
 
+#include <vector>
+
 namespace torch {
 namespace executorch {
 namespace cpuinfo {
 
 uint32_t get_num_performant_cores();
 
+/*
+ * Returns the logical CPU ids of the cores that are not efficiency cores, in
+ * the form expected by the pinned ThreadPool constructor. Returns all logical
+ * CPUs if the cores cannot be told apart.
+ */
+std::vector<uint32_t> get_performant_core_ids();
+
 } // namespace cpuinfo
 } // namespace executorch
 } // namespace torch
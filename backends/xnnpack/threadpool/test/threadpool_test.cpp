@@ -186,3 +186,64 @@ TEST(TestNoThreadPoolGuard, TestRunWithGuard) {
   }
   ASSERT_EQ(inner, 6);
 }
+
+TEST(TestThreadPoolGuard, OverridesGlobalThreadPool) {
+  auto global = torch::executorch::threadpool::get_threadpool();
+  torch::executorch::threadpool::ThreadPool local(2);
+  {
+    torch::executorch::threadpool::ThreadPoolGuard g1(&local);
+    ASSERT_EQ(torch::executorch::threadpool::get_threadpool(), &local);
+    {
+      // NoThreadPoolGuard still takes precedence for get_pthreadpool.
+      torch::executorch::threadpool::NoThreadPoolGuard g2;
+      ASSERT_EQ(torch::executorch::threadpool::get_pthreadpool(), nullptr);
+    }
+    ASSERT_NE(torch::executorch::threadpool::get_pthreadpool(), nullptr);
+  }
+  ASSERT_EQ(torch::executorch::threadpool::get_threadpool(), global);
+}
+
+TEST(TestPinnedThreadPool, RunsAllTasks) {
+  // CPU 0 always exists, so pinning every thread to it must succeed.
+  const std::vector<uint32_t> cpu_ids = {0, 0, 0};
+  torch::executorch::threadpool::ThreadPool pool(cpu_ids);
+  EXPECT_EQ(pool.get_thread_count(), cpu_ids.size());
+
+  std::vector<int32_t> a, b, c, c_ref;
+  generate_add_test_inputs(a, b, c_ref, c, 100);
+  pool.run([&](size_t i) { c[i] = a[i] + b[i]; }, a.size());
+  EXPECT_EQ(c, c_ref);
+
+  EXPECT_TRUE(pool._unsafe_reset_threadpool(std::vector<uint32_t>{0, 0}));
+  EXPECT_EQ(pool.get_thread_count(), 2);
+  generate_add_test_inputs(a, b, c_ref, c, 100);
+  pool.run([&](size_t i) { c[i] = a[i] + b[i]; }, a.size());
+  EXPECT_EQ(c, c_ref);
+}
+
+TEST(TestThreadPoolHotSection, RunsAllTasksWithEitherWaitPolicy) {
+  using WaitPolicy = torch::executorch::threadpool::ThreadPool::WaitPolicy;
+  torch::executorch::threadpool::ThreadPool pool(2);
+  EXPECT_EQ(pool.get_wait_policy(), WaitPolicy::kSpinThenPark);
+
+  for (WaitPolicy policy : {WaitPolicy::kSpinThenPark, WaitPolicy::kPark}) {
+    pool.set_wait_policy(policy);
+    EXPECT_EQ(pool.get_wait_policy(), policy);
+
+    std::vector<int32_t> a, b, c, c_ref;
+    generate_add_test_inputs(a, b, c_ref, c, 100);
+    pool.run([&](size_t i) { c[i] = a[i] + b[i]; }, a.size());
+    EXPECT_EQ(c, c_ref);
+    {
+      // Hot sections nest.
+      torch::executorch::threadpool::ThreadPoolHotSection outer(&pool);
+      torch::executorch::threadpool::ThreadPoolHotSection inner(&pool);
+      generate_add_test_inputs(a, b, c_ref, c, 100);
+      pool.run([&](size_t i) { c[i] = a[i] + b[i]; }, a.size());
+      EXPECT_EQ(c, c_ref);
+    }
+    generate_add_test_inputs(a, b, c_ref, c, 100);
+    pool.run([&](size_t i) { c[i] = a[i] + b[i]; }, a.size());
+    EXPECT_EQ(c, c_ref);
+  }
+}
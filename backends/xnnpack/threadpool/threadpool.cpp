@@ -14,6 +14,11 @@
 #include <cpuinfo.h>
 
 #include <atomic>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 namespace torch {
 namespace executorch {
@@ -37,6 +42,69 @@ void child_atfork() {
 ThreadPool::ThreadPool(size_t thread_count)
     : threadpool_(pthreadpool_create(thread_count), pthreadpool_destroy) {}
 
+ThreadPool::ThreadPool(const std::vector<uint32_t>& cpu_ids)
+    : threadpool_(pthreadpool_create(cpu_ids.size()), pthreadpool_destroy),
+      cpu_ids_(cpu_ids) {
+  pin_threads();
+}
+
+void ThreadPool::pin_threads() {
+  if (cpu_ids_.empty() || !threadpool_) {
+    return;
+  }
+#if defined(__linux__)
+  const size_t num_threads = pthreadpool_get_threads_count(threadpool_.get());
+  if (num_threads != cpu_ids_.size()) {
+    cpu_ids_.clear();
+    return;
+  }
+
+  // pthreadpool has no affinity API, so every thread pins itself. All tasks
+  // wait for each other before pinning, which makes each of them run on a
+  // different thread.
+  struct Context final {
+    const std::vector<uint32_t>& cpu_ids;
+    const size_t num_threads;
+    const std::thread::id caller;
+    std::atomic<size_t> started{0};
+    std::atomic<size_t> next_cpu{1};
+    std::atomic<bool> failed{false};
+  } context{cpu_ids_, num_threads, std::this_thread::get_id()};
+
+  pthreadpool_parallelize_1d(
+      threadpool_.get(),
+      [](void* const ctx, const size_t) {
+        auto& context = *reinterpret_cast<Context*>(ctx);
+        context.started.fetch_add(1);
+        while (context.started.load() < context.num_threads) {
+          std::this_thread::yield();
+        }
+        // Whichever thread calls run() later also takes part, so there is no
+        // point in pinning the thread that happens to create the pool.
+        if (std::this_thread::get_id() == context.caller) {
+          return;
+        }
+        const uint32_t cpu = context.cpu_ids[context.next_cpu.fetch_add(1)];
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+          context.failed = true;
+        }
+      },
+      &context,
+      num_threads,
+      0u);
+
+  if (context.failed) {
+    ET_LOG(Error, "Failed to pin threadpool threads to the requested CPUs");
+  }
+#else
+  ET_LOG(Info, "Threadpool pinning is not supported on this platform");
+  cpu_ids_.clear();
+#endif
+}
+
 size_t ThreadPool::get_thread_count() const {
   std::lock_guard<std::mutex> lock{mutex_};
 
@@ -53,16 +121,51 @@ bool ThreadPool::_unsafe_reset_threadpool(uint32_t new_thread_count) {
   std::lock_guard<std::mutex> lock{mutex_};
 
   threadpool_.reset(pthreadpool_create(new_thread_count));
+  cpu_ids_.clear();
+  return true;
+}
+
+bool ThreadPool::_unsafe_reset_threadpool(
+    const std::vector<uint32_t>& cpu_ids) {
+  if (cpu_ids.empty()) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+
+  threadpool_.reset(pthreadpool_create(cpu_ids.size()));
+  cpu_ids_ = cpu_ids;
+  pin_threads();
   return true;
 }
 
 void ThreadPool::run(
     const std::function<void(size_t)>& fn,
     const size_t range) {
+  struct Context final {
+    const std::function<void(size_t)>& fn;
+  } context{
+      fn,
+  };
+
+  run(
+      // Note: run() is a blocking function. The function pointer to this
+      // lambda cannot go out of scope until run() returns.
+      [](void* const context, const size_t item) {
+        reinterpret_cast<Context*>(context)->fn(item);
+      },
+      &context,
+      range);
+}
+
+void ThreadPool::run(
+    void (*fn)(void* context, size_t task_id),
+    void* context,
+    const size_t range) {
   // Run on same thread if NoThreadPoolGuard guard is enabled
   if (NoThreadPoolGuard::is_enabled()) {
     for (size_t i = 0; i < range; ++i) {
-      fn(i);
+      fn(context, i);
     }
     return;
   }
@@ -72,29 +175,45 @@ void ThreadPool::run(
   ET_CHECK_MSG(!NoThreadPoolGuard::is_enabled(), "Inside a threadpool guard!");
   ET_CHECK_MSG(threadpool_.get(), "Invalid threadpool!");
 
-  struct Context final {
-    const std::function<void(size_t)>& fn;
-  } context{
-      fn,
-  };
-
+  // Note: pthreadpool_parallelize_1d() is a blocking function, so context
+  // stays valid until all tasks have run.
   pthreadpool_parallelize_1d(
-      threadpool_.get(),
-      // Note: pthreadpool_parallelize_1d() is a blocking function.  The
-      // function pointer to this lambda passed on to
-      // pthreadpool_parallelize_1d() cannot go out of scope until
-      // pthreadpool_parallelize_1d() returns.
-      [](void* const context, const size_t item) {
-        reinterpret_cast<Context*>(context)->fn(item);
-      },
-      &context,
-      range,
-      0u);
+      threadpool_.get(), fn, context, range, get_job_flags());
+}
+
+uint32_t ThreadPool::get_job_flags() const {
+  return wait_policy_ == WaitPolicy::kPark && hot_sections_ == 0
+      ? PTHREADPOOL_FLAG_YIELD_WORKERS
+      : 0u;
+}
+
+namespace {
+// A job that does nothing, run to wake the workers up or put them to sleep.
+void noop_task(void* /*context*/, size_t /*task_id*/) {}
+} // namespace
+
+ThreadPoolHotSection::ThreadPoolHotSection(ThreadPool* threadpool)
+    : threadpool_(threadpool) {
+  ET_CHECK_MSG(threadpool_, "Invalid threadpool!");
+  threadpool_->hot_sections_.fetch_add(1);
+  threadpool_->run(noop_task, nullptr, threadpool_->get_thread_count());
+}
+
+ThreadPoolHotSection::~ThreadPoolHotSection() {
+  if (threadpool_->hot_sections_.fetch_sub(1) == 1 &&
+      threadpool_->get_wait_policy() == ThreadPool::WaitPolicy::kPark) {
+    // Let the workers, still spinning after the last job, go to sleep now
+    // rather than after the next one.
+    threadpool_->run(noop_task, nullptr, threadpool_->get_thread_count());
+  }
 }
 
 // get_threadpool is not thread safe due to leak_corrupted_threadpool
 // Make this part threadsafe: TODO(kimishpatel)
 ThreadPool* get_threadpool() {
+  if (ThreadPool* const current = ThreadPoolGuard::get_current()) {
+    return current;
+  }
   ET_CHECK_MSG(cpuinfo_initialize(), "cpuinfo initialization failed");
   int num_threads = cpuinfo_get_processors_count();
   /*
@@ -121,7 +240,10 @@ ThreadPool* get_threadpool() {
     leak_corrupted_threadpool = false;
     if (auto leaked = threadpool.release()) {
       auto t = leaked->get_thread_count();
-      threadpool = std::make_unique<ThreadPool>(t);
+      const auto& cpu_ids = leaked->get_cpu_ids();
+      threadpool = cpu_ids.empty() ? std::make_unique<ThreadPool>(t)
+                                   : std::make_unique<ThreadPool>(cpu_ids);
+      threadpool->set_wait_policy(leaked->get_wait_policy());
     }
   }
 #endif
@@ -2,12 +2,16 @@
 
 #include <pthreadpool.h>
 
+// @nolint PATTERNLINT Ok to use stdlib for this optional library
+#include <atomic>
 // @nolint PATTERNLINT Ok to use stdlib for this optional library
 #include <functional>
 // @nolint PATTERNLINT Ok to use stdlib for this optional library
 #include <memory>
 // @nolint PATTERNLINT Ok to use stdlib for this optional library
 #include <mutex>
+// @nolint PATTERNLINT Ok to use stdlib for this optional library
+#include <vector>
 
 namespace torch {
 namespace executorch {
@@ -15,7 +19,33 @@ namespace threadpool {
 
 class ThreadPool final {
  public:
+  // How the worker threads wait for the next job after finishing one.
+  enum class WaitPolicy {
+    // Spin for a while before going to sleep, so that a job submitted soon
+    // after the previous one does not wait for the workers to wake up. This
+    // is the default.
+    kSpinThenPark,
+    // Go to sleep right away, which frees the cores between jobs but adds
+    // the wake-up latency to every job. Workers still spin while a
+    // ThreadPoolHotSection is active.
+    kPark,
+  };
+
   explicit ThreadPool(size_t thread_count = 0);
+
+  /*
+   * Creates a threadpool with one thread per entry of cpu_ids, and pins each
+   * worker thread to one of those logical CPUs. The thread calling run() also
+   * does part of the work but keeps its own affinity; cpu_ids[0] is left for
+   * it. Pinning is supported on Linux and Android only, elsewhere the pool is
+   * created unpinned.
+   *
+   * Pinning a pool to the performance cores, e.g. with
+   * cpuinfo::get_performant_core_ids(), keeps a slow core from holding up
+   * every parallel region at its closing barrier.
+   */
+  explicit ThreadPool(const std::vector<uint32_t>& cpu_ids);
+
   ~ThreadPool() = default;
 
   // Make threadpool non copyable
@@ -45,6 +75,25 @@ class ThreadPool final {
    */
   bool _unsafe_reset_threadpool(uint32_t num_threads);
 
+  /*
+   * Like _unsafe_reset_threadpool(num_threads), but recreates the threadpool
+   * pinned to cpu_ids as described for the constructor taking cpu_ids.
+   */
+  bool _unsafe_reset_threadpool(const std::vector<uint32_t>& cpu_ids);
+
+  void set_wait_policy(WaitPolicy policy) {
+    wait_policy_ = policy;
+  }
+
+  WaitPolicy get_wait_policy() const {
+    return wait_policy_;
+  }
+
+  // Logical CPUs the threads are pinned to, empty if they are not pinned.
+  const std::vector<uint32_t>& get_cpu_ids() const {
+    return cpu_ids_;
+  }
+
   // Run, in parallel, function fn(task_id) over task_id in range [0, range).
   // This function is blocking.  All input is processed by the time it returns.
   // NoThreadPoolGuard (see threadpool_guard.h) can used to disable
@@ -52,8 +101,22 @@ class ThreadPool final {
   // When NoThreadPoolGuard is not used all calls to run method are serialized.
   void run(const std::function<void(size_t)>& fn, size_t range);
 
+  // Same as above, but calls fn(context, task_id) directly from the worker
+  // threads, without wrapping it in a std::function.
+  void run(
+      void (*fn)(void* context, size_t task_id),
+      void* context,
+      size_t range);
+
  private:
   friend pthreadpool_t get_pthreadpool();
+  friend class ThreadPoolHotSection;
+
+  // pthreadpool flags for the next job, as given by the wait policy.
+  uint32_t get_job_flags() const;
+
+  // Pins the worker threads to cpu_ids_, clearing cpu_ids_ if that fails.
+  void pin_threads();
 
  private:
   // This mutex is used inside get_thread_count API but it is not
@@ -64,9 +127,15 @@ class ThreadPool final {
   // TODO(kimishpatel)
   mutable std::mutex mutex_;
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_;
+  std::vector<uint32_t> cpu_ids_;
+  std::atomic<WaitPolicy> wait_policy_{WaitPolicy::kSpinThenPark};
+  // Number of active ThreadPoolHotSections.
+  std::atomic<uint32_t> hot_sections_{0};
 };
 
 // Return a singleton instance of ThreadPool for ATen/TH multithreading.
+// If a ThreadPoolGuard (see threadpool_guard.h) is active on the calling
+// thread, returns the threadpool of that guard instead.
 ThreadPool* get_threadpool();
 
 // Exposes the underlying implementation of ThreadPool.
@@ -75,6 +144,25 @@ ThreadPool* get_threadpool();
 // use cases.
 pthreadpool_t get_pthreadpool();
 
+/*
+ * Keeps the worker threads of a threadpool spinning between jobs while the
+ * guard is alive, whatever the wait policy of the pool, and wakes them up on
+ * construction so that the first job does not wait for them either. Meant to
+ * wrap latency-critical loops that issue many small jobs, like token-by-token
+ * decoding, while the pool parks its workers the rest of the time.
+ */
+class ThreadPoolHotSection final {
+ public:
+  explicit ThreadPoolHotSection(ThreadPool* threadpool = get_threadpool());
+  ~ThreadPoolHotSection();
+
+  ThreadPoolHotSection(const ThreadPoolHotSection&) = delete;
+  ThreadPoolHotSection& operator=(const ThreadPoolHotSection&) = delete;
+
+ private:
+  ThreadPool* const threadpool_;
+};
+
 } // namespace threadpool
 } // namespace executorch
 } // namespace torch
@@ -22,6 +22,16 @@ void NoThreadPoolGuard::set_enabled(bool enabled) {
   NoThreadPoolGuard_enabled = enabled;
 }
 
+thread_local ThreadPool* ThreadPoolGuard_threadpool = nullptr;
+
+ThreadPool* ThreadPoolGuard::get_current() {
+  return ThreadPoolGuard_threadpool;
+}
+
+void ThreadPoolGuard::set_current(ThreadPool* threadpool) {
+  ThreadPoolGuard_threadpool = threadpool;
+}
+
 } // namespace threadpool
 } // namespace executorch
 } // namespace torch
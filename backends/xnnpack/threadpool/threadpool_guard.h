@@ -12,6 +12,8 @@ namespace torch {
 namespace executorch {
 namespace threadpool {
 
+class ThreadPool;
+
 // A RAII, thread local (!) guard that enables or disables guard upon
 // construction, and sets it back to the original value upon destruction.
 struct NoThreadPoolGuard {
@@ -29,6 +31,29 @@ struct NoThreadPoolGuard {
   const bool prev_mode_;
 };
 
+// A RAII, thread local (!) guard that makes get_threadpool() and
+// get_pthreadpool() return the given threadpool on the calling thread, and
+// restores the previous one upon destruction. This lets, for example, each
+// Method run on its own threadpool: parallel_for() uses the threadpool active
+// at the time of the call, while XNNPACK delegates use the one active when
+// the method is loaded.
+struct ThreadPoolGuard {
+  static ThreadPool* get_current();
+
+  explicit ThreadPoolGuard(ThreadPool* threadpool)
+      : prev_threadpool_(ThreadPoolGuard::get_current()) {
+    ThreadPoolGuard::set_current(threadpool);
+  }
+  ~ThreadPoolGuard() {
+    ThreadPoolGuard::set_current(prev_threadpool_);
+  }
+
+ private:
+  static void set_current(ThreadPool* threadpool);
+
+  ThreadPool* const prev_threadpool_;
+};
+
 } // namespace threadpool
 } // namespace executorch
 } // namespace torch
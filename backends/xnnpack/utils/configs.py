@@ -11,6 +11,7 @@ from executorch.exir import CaptureConfig
 from executorch.exir.backend.canonical_partitioners.duplicate_dequant_node_pass import (
     DuplicateDequantNodePass,
 )
+from executorch.exir.backend.compile_spec_schema import CompileSpec
 from executorch.exir.pass_manager import PassType
 
 
@@ -19,6 +20,48 @@ def get_xnnpack_edge_compile_config() -> exir.EdgeCompileConfig:
     return exir.EdgeCompileConfig(_check_ir_validity=False, _skip_dim_order=True)
 
 
+def get_xnnpack_persistent_state_compile_spec() -> CompileSpec:
+    """
+    Compile spec that makes the XNNPACK delegate keep the mutable buffers of
+    the program it lowers, such as the KV caches of a transformer block, as
+    its own state across executions. The buffers are then neither copied into
+    the delegate nor back out of it on every call. They must be
+    zero-initialized.
+    """
+    return CompileSpec("persistent_state", bytes())
+
+
+def get_xnnpack_fp16_inference_compile_spec() -> CompileSpec:
+    """
+    Compile spec that lets the XNNPACK delegate run fp32 subgraphs with fp16
+    arithmetic on CPUs that support it, such as ARMv8.2-A cores with FP16. On
+    other CPUs the delegate keeps running in fp32. Pass it to the partitioner
+    through its compile_specs argument.
+
+    fp16 changes the numerics of the model, so check its accuracy on the
+    target device first, e.g. by running a bundled program with reference
+    outputs from the fp32 model through sdk_example_runner with
+    --output_verification and the tolerances the model can accept.
+    """
+    return CompileSpec("fp16_inference", bytes())
+
+
+def get_xnnpack_shape_buckets_compile_spec(num_buckets: int) -> CompileSpec:
+    """
+    Compile spec that makes the XNNPACK delegate keep up to `num_buckets`
+    runtimes of its subgraph, each reshaped for the last input shapes it ran.
+    Inputs of a dynamic-shape model that cluster at a few shapes, such as
+    sequences of a few common lengths, then skip reshaping the runtime
+    whenever a runtime already has their shapes. The runtimes share their
+    packed weights but not their operators, and unless the XNNPACK workspace
+    is shared, not their intermediate tensors. The runtime caps the count
+    at 8.
+    """
+    if num_buckets < 1:
+        raise ValueError(f"Expected at least one shape bucket, got {num_buckets}")
+    return CompileSpec("shape_buckets", num_buckets.to_bytes(4, "little"))
+
+
 def get_transform_passes(additional_passes=None) -> List[PassType]:
     additional_passes = additional_passes if additional_passes else []
     passes = additional_passes + [DuplicateDequantNodePass()]
@@ -0,0 +1,56 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import json
+
+from typing import Any, Dict, List, Optional
+
+XNNPACK_METADATA_KEYS: Dict[str, str] = {
+    "inputs": "xnnpack_input_shapes",
+    "outputs": "xnnpack_output_shapes",
+    "flops": "xnnpack_flops",
+    "bytes": "xnnpack_bytes",
+}
+
+
+def parse_xnnpack_delegate_metadata(delegate_metadatas: List[str]) -> Dict[str, Any]:
+    """
+    Delegate metadata parser for the Inspector, for the per operator events
+    logged by the XNNPACK delegate when profiling is enabled.
+
+    The delegate logs the same metadata for an operator on every run, unless
+    its shapes changed, so only the last one is used.
+    """
+    for metadata in reversed(delegate_metadatas):
+        if not metadata:
+            continue
+        try:
+            xnnpack_metadata: Dict[str, Any] = json.loads(metadata)
+        except ValueError:
+            return {}
+        return {
+            column: xnnpack_metadata[key]
+            for key, column in XNNPACK_METADATA_KEYS.items()
+            if key in xnnpack_metadata
+        }
+    return {}
+
+
+def compute_xnnpack_throughput(
+    metadata: Dict[str, Any], seconds: Optional[float]
+) -> Dict[str, float]:
+    """
+    Computes the achieved GFLOP/s and GB/s of an operator from its parsed
+    metadata and how long it ran, e.g. the average time of its Event.
+    """
+    if not seconds or seconds <= 0:
+        return {}
+    result: Dict[str, float] = {}
+    if "xnnpack_flops" in metadata:
+        result["xnnpack_gflops_per_s"] = metadata["xnnpack_flops"] / seconds / 1e9
+    if "xnnpack_bytes" in metadata:
+        result["xnnpack_gbytes_per_s"] = metadata["xnnpack_bytes"] / seconds / 1e9
+    return result
@@ -18,6 +18,7 @@ from executorch.backends.xnnpack.passes.tag_implicit_q_dq_pass import TagImplici
 from executorch.backends.xnnpack.serialization.xnnpack_graph_schema import (
     ConstantDataOffset,
     XNNGraph,
+    XNNState,
 )
 from executorch.backends.xnnpack.serialization.xnnpack_graph_serialize import (
     serialize_xnnpack_binary,
@@ -36,6 +37,7 @@ from executorch.exir.backend.backend_details import (
     PreprocessResult,
 )
 from executorch.exir.verification.verifier import EXIREdgeDialectVerifier
+from torch._export.utils import get_buffer
 from torch.export.exported_program import ExportedProgram
 
 DEFAULT_DEBUG_HANDLE = 65535
@@ -78,6 +80,53 @@ def generate_node_to_external_map(
     return node_to_external_map
 
 
+def generate_persistent_state(
+    exported_program: ExportedProgram,
+    edge_graph_module: torch.fx.GraphModule,
+    node_to_external_map: Dict[torch.fx.Node, ExternalMeta],
+) -> List[XNNState]:
+    """
+    Turns each mutable buffer of the program, such as a KV cache, into state
+    that the delegate keeps across executions, instead of a constant whose
+    update is returned for the caller to copy back.
+
+    The buffer placeholder and its updated value get external ids past those of
+    the delegate arguments. The argument slot of the updated value stays
+    reserved but is not written by the delegate. The state starts out zeroed,
+    so the buffers must be zero-initialized.
+    """
+    signature = exported_program.graph_signature
+    buffer_to_input = {
+        buffer: input_name for input_name, buffer in signature.inputs_to_buffers.items()
+    }
+    nodes = {node.name: node for node in edge_graph_module.graph.nodes}
+
+    states = []
+    next_external_id = len(node_to_external_map)
+    for output_name, buffer in signature.buffers_to_mutate.items():
+        input_node = nodes[buffer_to_input[buffer]]
+        output_node = nodes[output_name]
+        initial_value = get_buffer(exported_program, input_node)
+        if initial_value is not None and bool(initial_value.any()):
+            raise RuntimeError(
+                f"Buffer {buffer} must be zero-initialized to be kept as XNNPACK delegate state"
+            )
+
+        node_to_external_map[input_node] = ExternalMeta(
+            external_id=next_external_id,
+            io_type=XNN_VALUE_FLAG_EXTERNAL_INPUT,
+        )
+        node_to_external_map[output_node] = ExternalMeta(
+            external_id=next_external_id + 1,
+            io_type=XNN_VALUE_FLAG_EXTERNAL_OUTPUT,
+        )
+        states.append(
+            XNNState(input_id=next_external_id, output_id=next_external_id + 1)
+        )
+        next_external_id += 2
+    return states
+
+
 @final
 class XnnpackBackend(BackendDetails):
     @staticmethod
@@ -112,10 +161,13 @@ class XnnpackBackend(BackendDetails):
         )
 
         passes = []
+        persistent_state = False
         for spec in compile_specs:
             if spec.key == "dqlinear_partitioner":
                 passes.append(ConvertToLinearPass)
                 passes.append(TagImplicitQDqPass)
+            elif spec.key == "persistent_state":
+                persistent_state = True
 
         passes = passes if len(passes) > 0 else None
         # XNNPACK Delegate Specific Passes
@@ -123,19 +175,26 @@ class XnnpackBackend(BackendDetails):
         graph_module = ep.graph_module
 
         node_to_external_map = generate_node_to_external_map(ep, graph_module)
+        states = (
+            generate_persistent_state(ep, graph_module, node_to_external_map)
+            if persistent_state
+            else []
+        )
 
         # TODO retrace the graph module to lift the new params may have
         # been added to the graph in passes
 
         vals_to_ids = {}
+        # The updated value of each state keeps its argument id reserved too.
         xnnpack_graph = XNNGraph(
             version="0",
             xnodes=[],
             xvalues=[],
-            num_externs=len(node_to_external_map),
+            num_externs=len(node_to_external_map) + len(states),
             input_ids=[],
             output_ids=[],
             constant_data=[ConstantDataOffset(0, 0)],
+            state=states,
         )
 
         constant_data_bytes = bytearray()
@@ -53,6 +53,59 @@ function(gen_selected_ops)
 
 endfunction()
 
+# Generates AotMethod.h and AotMethod.cpp, which run a method of MODEL_FILE
+# without the interpreter, along with the selected_operators.yaml of its
+# operators. Use it in place of gen_selected_ops() for LIB_NAME, so that
+# generate_bindings_for_kernels() builds just the kernels the method calls. See
+# codegen/tools/gen_aot_method.py for how to use these arguments.
+#
+# Invoked as gen_aot_method( LIB_NAME lib_name MODEL_FILE model_file
+# METHOD_NAME method_name OPS_YAML custom_ops_yaml... )
+function(gen_aot_method)
+  set(arg_names LIB_NAME MODEL_FILE METHOD_NAME)
+  cmake_parse_arguments(GEN "" "${arg_names}" "OPS_YAML" ${ARGN})
+
+  message(STATUS "Generating AOT method:")
+  message(STATUS "  LIB_NAME: ${GEN_LIB_NAME}")
+  message(STATUS "  MODEL_FILE: ${GEN_MODEL_FILE}")
+  message(STATUS "  METHOD_NAME: ${GEN_METHOD_NAME}")
+  message(STATUS "  OPS_YAML: ${GEN_OPS_YAML}")
+
+  if(NOT GEN_METHOD_NAME)
+    set(GEN_METHOD_NAME forward)
+  endif()
+  set(_out_dir ${CMAKE_CURRENT_BINARY_DIR}/${GEN_LIB_NAME})
+  file(MAKE_DIRECTORY ${_out_dir})
+  file(GLOB_RECURSE _codegen_tools_srcs "${EXECUTORCH_ROOT}/codegen/tools/*.py")
+  file(GLOB_RECURSE _codegen_templates "${EXECUTORCH_ROOT}/codegen/templates/*")
+
+  set(_gen_command
+      "${PYTHON_EXECUTABLE}" -m codegen.tools.gen_aot_method
+      --model_file_path=${GEN_MODEL_FILE} --method_name=${GEN_METHOD_NAME}
+      --output_dir=${_out_dir}
+      --oplist_output_path=${_out_dir}/selected_operators.yaml
+      --source_path=${EXECUTORCH_ROOT}/codegen
+  )
+  foreach(_ops_yaml IN LISTS GEN_OPS_YAML)
+    list(APPEND _gen_command --ops_yaml_path=${_ops_yaml})
+  endforeach()
+
+  set(_gen_command_sources ${_out_dir}/AotMethod.h ${_out_dir}/AotMethod.cpp)
+  add_custom_command(
+    COMMENT "Generating AOT method ${GEN_METHOD_NAME} of ${GEN_MODEL_FILE}"
+    OUTPUT ${_gen_command_sources} ${_out_dir}/selected_operators.yaml
+    COMMAND ${_gen_command}
+    DEPENDS ${GEN_MODEL_FILE} ${GEN_OPS_YAML} ${_codegen_tools_srcs}
+            ${_codegen_templates}
+    WORKING_DIRECTORY ${EXECUTORCH_ROOT}
+  )
+  # Make generated file list available in parent scope
+  set(aot_method_sources
+      ${_gen_command_sources}
+      PARENT_SCOPE
+  )
+endfunction()
+
 # Codegen for registering kernels. Kernels are defined in functions_yaml and
 # custom_ops_yaml.
 #
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// clang-format off
+#include "${header}"
+
+#include <cstdint>
+#include <limits>
+
+#include <executorch/runtime/backend/interface.h>
+#include <executorch/runtime/core/evalue.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/assert.h>
+#include <executorch/runtime/platform/log.h>
+#include "${fn_header}" // Generated Function import headers
+// ${generated_comment}
+
+namespace ${namespace} {
+namespace {
+
+using torch::executor::Error;
+
+bool initialized = false;
+
+// Planned memory.
+${planned_buffers}
+
+// Constant tensor data.
+${constant_data}
+
+// Delegates.
+${delegates}
+
+// Values used by the instructions.
+${values}
+
+exec_aten::Tensor* const inputs[] = {${inputs}};
+exec_aten::Tensor* const outputs[] = {${outputs}};
+
+} // namespace
+
+Error init(torch::executor::MemoryAllocator* runtime_allocator) {
+  (void)runtime_allocator;
+  ET_CHECK_OR_RETURN_ERROR(!initialized, InvalidState, "Already initialized");
+${delegate_inits}
+  initialized = true;
+  return Error::Ok;
+}
+
+exec_aten::Tensor& input(size_t index) {
+  ET_CHECK_MSG(index < kNumInputs, "Input %zu out of range", index);
+  return *inputs[index];
+}
+
+exec_aten::Tensor& output(size_t index) {
+  ET_CHECK_MSG(index < kNumOutputs, "Output %zu out of range", index);
+  return *outputs[index];
+}
+
+Error execute(torch::executor::MemoryAllocator* temp_allocator) {
+  ET_CHECK_OR_RETURN_ERROR(initialized, InvalidState, "Not initialized");
+  torch::executor::KernelRuntimeContext context(nullptr, temp_allocator);
+${instructions}
+  return Error::Ok;
+}
+
+void destroy() {
+${delegate_destroys}
+  initialized = false;
+}
+
+} // namespace ${namespace}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// clang-format off
+#pragma once
+
+#include <cstddef>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/memory_allocator.h>
+
+// ${generated_comment}
+// Runs the method without an interpreter: its instructions are compiled into
+// direct calls to the kernels, with its planned memory, constants and
+// delegate data as static data.
+
+namespace ${namespace} {
+
+constexpr size_t kNumInputs = ${num_inputs};
+constexpr size_t kNumOutputs = ${num_outputs};
+
+/**
+ * Initializes the delegates of the method. Must succeed before execute() is
+ * called.
+ *
+ * @param[in] runtime_allocator Passed to the delegates, which may allocate
+ *     from it until destroy().
+ */
+__ET_NODISCARD torch::executor::Error init(
+    torch::executor::MemoryAllocator* runtime_allocator);
+
+/// The input tensor at `index`, in planned memory. Write to its data before
+/// execute().
+exec_aten::Tensor& input(size_t index);
+
+/// The output tensor at `index`, which execute() writes to.
+exec_aten::Tensor& output(size_t index);
+
+/**
+ * Executes the method once on the current inputs.
+ *
+ * @param[in] temp_allocator Passed to the kernels and delegates for scratch
+ *     memory.
+ */
+__ET_NODISCARD torch::executor::Error execute(
+    torch::executor::MemoryAllocator* temp_allocator = nullptr);
+
+/// Destroys the delegates. init() must be called again before execute().
+void destroy();
+
+} // namespace ${namespace}
@@ -0,0 +1,771 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# Generates C++ source that runs a method of a program without the
+# interpreter. Every instruction of the method's execution plan becomes a
+# direct call to the unboxed kernel declared in the Functions.h of the
+# codegen'd kernel library, or to a delegate, with the tensors' planned memory
+# offsets baked in and the constant tensors and delegate data compiled in as
+# static data. The program stays the source of truth: the C++ is regenerated
+# from it, and the kernel library is selectively built for the same
+# operators. Only fully static, straight-line methods are supported.
+
+import argparse
+import json
+import math
+import os
+import re
+import string
+import sys
+from typing import Dict, List, Optional, Sequence, Set, Tuple
+
+import yaml
+
+from executorch.exir.schema import (
+    Bool,
+    BoolList,
+    CompressionCodec,
+    DataLocation,
+    DelegateCall,
+    Double,
+    DoubleList,
+    ExecutionPlan,
+    FreeCall,
+    Int,
+    IntList,
+    KernelCall,
+    Null,
+    OptionalTensorList,
+    Program,
+    String,
+    Tensor,
+    TensorList,
+    TensorShapeDynamism,
+)
+from torchgen.model import BaseTy, BaseType, FunctionSchema, ListType, OptionalType
+
+# Matches runtime/core/portable_type/scalar_type.h.
+_SCALAR_TYPES: Dict[int, Tuple[str, int]] = {
+    0: ("Byte", 1),
+    1: ("Char", 1),
+    2: ("Short", 2),
+    3: ("Int", 4),
+    4: ("Long", 8),
+    5: ("Half", 2),
+    6: ("Float", 4),
+    7: ("Double", 8),
+    8: ("ComplexHalf", 4),
+    9: ("ComplexFloat", 8),
+    10: ("ComplexDouble", 16),
+    11: ("Bool", 1),
+    12: ("QInt8", 1),
+    13: ("QUInt8", 1),
+    14: ("QInt32", 4),
+    15: ("BFloat16", 2),
+    16: ("QUInt4x2", 1),
+    17: ("QUInt2x4", 1),
+}
+
+# Alignment of the static buffers, enough for any kernel or delegate.
+_ALIGNMENT = 16
+
+_BYTES_PER_LINE = 16
+
+
+def load_program(program_data: bytes) -> Tuple[Program, List[bytes]]:
+    """
+    Parses a serialized program, returning it along with the data of its
+    segments. Unlike deserialize_pte_binary(), the segments are kept so that
+    constant tensor data can be read from them.
+    """
+    from executorch.exir._serialize._program import (
+        _get_extended_header,
+        _json_to_program,
+        _program_flatbuffer_to_json,
+    )
+
+    program_size = len(program_data)
+    segment_base_offset = 0
+    eh = _get_extended_header(program_data)
+    if eh and eh.is_valid():
+        program_size = eh.program_size
+        segment_base_offset = eh.segment_base_offset
+    program = _json_to_program(
+        _program_flatbuffer_to_json(program_data[:program_size])
+    )
+    segment_data = program_data[segment_base_offset:] if segment_base_offset else b""
+    segments = []
+    for i, segment in enumerate(program.segments):
+        if segment.offset + segment.size > len(segment_data):
+            raise ValueError(
+                f"Segment {i} {segment} overflows data length {len(segment_data)}"
+            )
+        segments.append(segment_data[segment.offset : segment.offset + segment.size])
+    return program, segments
+
+
+def load_schemas(ops_yaml_paths: Sequence[str]) -> Dict[str, FunctionSchema]:
+    """
+    Reads the schemas of the `func` entries of functions yaml files, such as
+    native_functions.yaml or a custom_ops.yaml, keyed by qualified operator
+    name with overload, e.g. "aten::add.out".
+    """
+    schemas: Dict[str, FunctionSchema] = {}
+    for path in ops_yaml_paths:
+        with open(path, "r") as f:
+            entries = yaml.safe_load(f) or []
+        for entry in entries:
+            if not isinstance(entry, dict) or "func" not in entry:
+                continue
+            namespace, _, func = entry["func"].rpartition("::")
+            schema = FunctionSchema.parse(func)
+            schemas[f"{namespace or 'aten'}::{schema.name}"] = schema
+    return schemas
+
+
+def _find_schema(
+    name: str, overload: str, schemas: Dict[str, FunctionSchema]
+) -> FunctionSchema:
+    key = f"{name}.{overload}" if overload else name
+    if key in schemas:
+        return schemas[key]
+    # Fall back to the operators registered with torch, like gen_ops_def.py.
+    try:
+        import torch
+    except ImportError:
+        torch = None
+    if torch is not None:
+        for s in torch._C._jit_get_schemas_for_operator(name):
+            if s.overload_name == overload:
+                schema = FunctionSchema.parse(str(s).split("::", 1)[1])
+                schemas[key] = schema
+                return schema
+    raise ValueError(
+        f"No schema for operator {key}, pass the yaml that defines it with "
+        "--ops_yaml_path"
+    )
+
+
+def _identifier(name: str) -> str:
+    name = re.sub(r"\W", "_", name)
+    return f"_{name}" if name[:1].isdigit() else name
+
+
+def _byte_array(name: str, data: bytes, const: bool) -> str:
+    qualifier = "const " if const else ""
+    lines = [f"alignas({_ALIGNMENT}) {qualifier}uint8_t {name}[] = {{"]
+    for start in range(0, len(data), _BYTES_PER_LINE):
+        chunk = data[start : start + _BYTES_PER_LINE]
+        lines.append("    " + " ".join(f"0x{b:02x}," for b in chunk))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def _int_literal(value: int) -> str:
+    if value == -(2**63):
+        return "INT64_MIN"
+    return f"int64_t({value})"
+
+
+def _double_literal(value: float) -> str:
+    if math.isnan(value):
+        return "std::numeric_limits<double>::quiet_NaN()"
+    if math.isinf(value):
+        sign = "-" if value < 0 else ""
+        return f"{sign}std::numeric_limits<double>::infinity()"
+    return repr(float(value))
+
+
+def _string_literal(value: str) -> str:
+    escaped = "".join(
+        c if c.isprintable() and c not in '"\\' else f"\\{ord(c):03o}"
+        for c in value
+    )
+    return f'"{escaped}"'
+
+
+def _bool_literal(value: bool) -> str:
+    return "true" if value else "false"
+
+
+def _scalar_type(value: int) -> str:
+    if value in _SCALAR_TYPES:
+        return f"exec_aten::ScalarType::{_SCALAR_TYPES[value][0]}"
+    return f"static_cast<exec_aten::ScalarType>({value})"
+
+
+def _cpp_type(t) -> str:
+    """The type that the unboxed kernels take for a schema type."""
+    if isinstance(t, OptionalType):
+        return f"exec_aten::optional<{_cpp_type(t.elem)}>"
+    if isinstance(t, ListType):
+        return f"exec_aten::ArrayRef<{_cpp_type(t.elem)}>"
+    assert isinstance(t, BaseType), f"Unsupported type {t}"
+    types = {
+        BaseTy.Tensor: "exec_aten::Tensor",
+        BaseTy.int: "int64_t",
+        BaseTy.SymInt: "int64_t",
+        BaseTy.float: "double",
+        BaseTy.bool: "bool",
+        BaseTy.Scalar: "exec_aten::Scalar",
+        BaseTy.ScalarType: "exec_aten::ScalarType",
+        BaseTy.MemoryFormat: "exec_aten::MemoryFormat",
+        BaseTy.Layout: "exec_aten::Layout",
+        BaseTy.str: "exec_aten::string_view",
+    }
+    if t.name not in types:
+        raise ValueError(f"Arguments of type {t} are not supported")
+    return types[t.name]
+
+
+class _MethodGenerator:
+    def __init__(
+        self,
+        program: Program,
+        segments: List[bytes],
+        plan: ExecutionPlan,
+        schemas: Dict[str, FunctionSchema],
+    ) -> None:
+        self.program = program
+        self.segments = segments
+        self.plan = plan
+        self.schemas = schemas
+        # Values that need a C++ object, emitted in order of index so that
+        # lists follow the tensors they hold.
+        self.tensors: Set[int] = set()
+        self.lists: Dict[int, str] = {}
+        self.evalues: Set[int] = set()
+        # Tensors that use each constant buffer, so that its size is known.
+        self.constants: Dict[int, Tensor] = {}
+        self.delegates: Set[int] = set()
+        self.instructions: List[str] = []
+        self.delegate_args: List[str] = []
+
+    def _tensor(self, index: int) -> Tensor:
+        val = self.plan.values[index].val
+        if not isinstance(val, Tensor):
+            raise ValueError(f"Value {index} is a {type(val).__name__}, not a Tensor")
+        self.tensors.add(index)
+        return val
+
+    def _int(self, index: int) -> int:
+        val = self.plan.values[index].val
+        if not isinstance(val, Int):
+            raise ValueError(f"Value {index} is a {type(val).__name__}, not an Int")
+        return val.int_val
+
+    def _argument(self, t, index: int) -> str:  # noqa: C901
+        """The C++ expression for value `index` passed as schema type `t`."""
+        val = self.plan.values[index].val
+        if isinstance(t, OptionalType):
+            if isinstance(val, Null):
+                return "exec_aten::nullopt"
+            return f"{_cpp_type(t)}({self._argument(t.elem, index)})"
+        if isinstance(t, ListType):
+            elem = t.elem
+            if isinstance(val, IntList):
+                items = [_int_literal(self._int(i)) for i in val.items]
+            elif isinstance(val, DoubleList):
+                items = [_double_literal(v) for v in val.items]
+            elif isinstance(val, BoolList):
+                items = [_bool_literal(v) for v in val.items]
+            elif isinstance(val, TensorList):
+                items = []
+                for i in val.items:
+                    self._tensor(i)
+                    items.append(f"value_{i}")
+            elif isinstance(val, OptionalTensorList):
+                items = []
+                for i in val.items:
+                    if i < 0 or isinstance(self.plan.values[i].val, Null):
+                        items.append("exec_aten::nullopt")
+                    else:
+                        self._tensor(i)
+                        items.append(f"{_cpp_type(elem)}(value_{i})")
+            else:
+                raise ValueError(f"Value {index} is not a list of {elem}")
+            if not items:
+                return f"{_cpp_type(t)}()"
+            self.lists[index] = (
+                f"const {_cpp_type(elem)} list_{index}[] = {{{', '.join(items)}}};"
+            )
+            return f"{_cpp_type(t)}(list_{index}, {len(items)})"
+        assert isinstance(t, BaseType), f"Unsupported type {t}"
+        if t.name == BaseTy.Tensor:
+            self._tensor(index)
+            return f"value_{index}"
+        if t.name in (BaseTy.int, BaseTy.SymInt):
+            return _int_literal(self._int(index))
+        if t.name == BaseTy.float:
+            if isinstance(val, Int):
+                return _double_literal(val.int_val)
+            if isinstance(val, Double):
+                return _double_literal(val.double_val)
+        if t.name == BaseTy.bool and isinstance(val, Bool):
+            return _bool_literal(val.bool_val)
+        if t.name == BaseTy.Scalar:
+            if isinstance(val, Int):
+                return f"exec_aten::Scalar({_int_literal(val.int_val)})"
+            if isinstance(val, Double):
+                return f"exec_aten::Scalar({_double_literal(val.double_val)})"
+            if isinstance(val, Bool):
+                return f"exec_aten::Scalar({_bool_literal(val.bool_val)})"
+        if t.name == BaseTy.ScalarType:
+            return _scalar_type(self._int(index))
+        if t.name in (BaseTy.MemoryFormat, BaseTy.Layout):
+            return f"static_cast<{_cpp_type(t)}>({self._int(index)})"
+        if t.name == BaseTy.str and isinstance(val, String):
+            return f"exec_aten::string_view({_string_literal(val.string_val)})"
+        raise ValueError(
+            f"Value {index} of type {type(val).__name__} cannot be passed as {t}"
+        )
+
+    def _kernel_call(self, position: str, call: KernelCall) -> None:
+        operator = self.plan.operators[call.op_index]
+        schema = _find_schema(operator.name, operator.overload, self.schemas)
+        namespace = operator.name.split("::")[0]
+        if not schema.is_out_fn():
+            raise ValueError(
+                f"{operator.name}.{operator.overload} at instruction {position} "
+                "is not an out variant, only static kernels are supported"
+            )
+        schema_args = schema.arguments.flat_all
+        # The emitter appends the returns to the schema's arguments.
+        if len(call.args) < len(schema_args):
+            raise ValueError(
+                f"Instruction {position} has {len(call.args)} arguments, "
+                f"{schema.name} takes {len(schema_args)}"
+            )
+        args = ["context"] + [
+            self._argument(a.type, i) for a, i in zip(schema_args, call.args)
+        ]
+        name = f"{schema.name.name}_outf"
+        self.instructions.append(
+            f"  // {position}: {namespace}::{schema.name}\n"
+            f"  torch::executor::{namespace}::{name}({', '.join(args)});\n"
+            "  ET_CHECK_OK_OR_RETURN_ERROR(\n"
+            f'      context.failure_state(), "Kernel call {position} failed");'
+        )
+
+    def _delegate_call(self, position: str, call: DelegateCall) -> None:
+        n = call.delegate_index
+        self.delegates.add(n)
+        for i in call.args:
+            val = self.plan.values[i].val
+            if isinstance(val, Tensor):
+                self._tensor(i)
+            elif not isinstance(val, (Int, Double, Bool, Null)):
+                raise ValueError(
+                    f"Delegate argument {i} of type {type(val).__name__} is "
+                    "not supported"
+                )
+            self.evalues.add(i)
+        args_name = f"delegate_call_args_{len(self.delegate_args)}"
+        refs = ", ".join(f"&evalue_{i}" for i in call.args) or "nullptr"
+        self.delegate_args.append(
+            f"torch::executor::EValue* {args_name}[] = {{{refs}}};"
+        )
+        self.instructions.append(
+            f"  // {position}: {self.plan.delegates[n].id}\n"
+            "  {\n"
+            "    torch::executor::BackendExecutionContext backend_context(\n"
+            "        nullptr, temp_allocator);\n"
+            "    ET_CHECK_OK_OR_RETURN_ERROR(\n"
+            f"        delegate_backend_{n}->execute(\n"
+            f"            backend_context, delegate_handle_{n}, {args_name}),\n"
+            f'        "Delegate call {position} failed");\n'
+            "  }"
+        )
+
+    def _constant_data(self, tensor: Tensor) -> bytes:
+        nbytes = math.prod(tensor.sizes) * _SCALAR_TYPES[int(tensor.scalar_type)][1]
+        index = tensor.constant_buffer_idx
+        program = self.program
+        constant_segment = program.constant_segment
+        if not constant_segment.offsets:
+            return program.constant_buffer[index].storage[:nbytes]
+        if (
+            program.constant_segment_compression is not None
+            and program.constant_segment_compression.codec != CompressionCodec.NONE
+        ):
+            raise ValueError(
+                "Compressed constant segments are not supported, export the "
+                "program without compressing its constants"
+            )
+        segment_index = (
+            program.constant_segment_indices[index]
+            if program.constant_segment_indices
+            else constant_segment.segment_index
+        )
+        offset = constant_segment.offsets[index]
+        return self.segments[segment_index][offset : offset + nbytes]
+
+    def _delegate_data(self, n: int) -> bytes:
+        processed = self.plan.delegates[n].processed
+        if processed.location == DataLocation.INLINE:
+            return self.program.backend_delegate_data[processed.index].data
+        return self.segments[processed.index]
+
+    def _tensor_decl(self, index: int, tensor: Tensor) -> str:
+        if tensor.shape_dynamism != TensorShapeDynamism.STATIC:
+            raise ValueError(f"Tensor {index} does not have a static shape")
+        if tensor.constant_name:
+            raise ValueError(
+                f"Tensor {index} is the external constant {tensor.constant_name}, "
+                "constants must be stored in the program"
+            )
+        if tensor.constant_buffer_idx > 0:
+            self.constants[tensor.constant_buffer_idx] = tensor
+            data = f"const_cast<uint8_t*>(constant_{tensor.constant_buffer_idx})"
+        elif tensor.allocation_info is not None:
+            info = tensor.allocation_info
+            data = f"planned_buffer_{info.memory_id} + {info.memory_offset}"
+        elif math.prod(tensor.sizes) == 0:
+            # Like the empty tensors emitted for None arguments.
+            data = "nullptr"
+        else:
+            raise ValueError(f"Tensor {index} is neither constant nor memory planned")
+
+        dim = len(tensor.sizes)
+        dim_order = [int(d) for d in tensor.dim_order] or list(range(dim))
+        strides = [0] * dim
+        stride = 1
+        for d in reversed(dim_order):
+            strides[d] = stride
+            stride *= tensor.sizes[d]
+        lines = []
+        if dim > 0:
+            lines += [
+                f"exec_aten::SizesType sizes_{index}[] = "
+                f"{{{', '.join(map(str, tensor.sizes))}}};",
+                f"exec_aten::DimOrderType dim_order_{index}[] = "
+                f"{{{', '.join(map(str, dim_order))}}};",
+                f"exec_aten::StridesType strides_{index}[] = "
+                f"{{{', '.join(map(str, strides))}}};",
+            ]
+            arrays = f"sizes_{index}, {data}, dim_order_{index}, strides_{index}"
+        else:
+            arrays = f"nullptr, {data}"
+        lines += [
+            f"exec_aten::TensorImpl tensor_impl_{index}(\n"
+            f"    {_scalar_type(int(tensor.scalar_type))}, {dim}, {arrays});",
+            f"exec_aten::Tensor value_{index}(&tensor_impl_{index});",
+        ]
+        return "\n".join(lines)
+
+    def _evalue_decl(self, index: int) -> str:
+        val = self.plan.values[index].val
+        if isinstance(val, Tensor):
+            init = f"value_{index}"
+        elif isinstance(val, Int):
+            init = _int_literal(val.int_val)
+        elif isinstance(val, Double):
+            init = _double_literal(val.double_val)
+        elif isinstance(val, Bool):
+            init = _bool_literal(val.bool_val)
+        else:
+            return f"torch::executor::EValue evalue_{index};"
+        return f"torch::executor::EValue evalue_{index}({init});"
+
+    def _delegate_decls(self) -> Tuple[str, str, str]:
+        decls, inits, destroys = [], [], []
+        for n in sorted(self.delegates):
+            delegate = self.plan.delegates[n]
+            decls.append(
+                _byte_array(f"delegate_processed_{n}", self._delegate_data(n), True)
+            )
+            specs = []
+            for k, spec in enumerate(delegate.compile_specs):
+                value = "{nullptr, 0}"
+                if spec.value:
+                    spec_name = f"delegate_{n}_spec_{k}"
+                    decls.append(_byte_array(spec_name, spec.value, False))
+                    value = f"{{{spec_name}, sizeof({spec_name})}}"
+                specs.append(f"    {{{_string_literal(spec.key)}, {value}}},")
+            if specs:
+                decls.append(
+                    f"torch::executor::CompileSpec delegate_compile_specs_{n}[] = {{\n"
+                    + "\n".join(specs)
+                    + "\n};"
+                )
+                compile_specs = (
+                    "torch::executor::ArrayRef<torch::executor::CompileSpec>(\n"
+                    f"            delegate_compile_specs_{n}, {len(specs)})"
+                )
+            else:
+                compile_specs = (
+                    "torch::executor::ArrayRef<torch::executor::CompileSpec>()"
+                )
+            decls.append(
+                f"torch::executor::PyTorchBackendInterface* delegate_backend_{n} = "
+                "nullptr;\n"
+                f"torch::executor::DelegateHandle* delegate_handle_{n} = nullptr;"
+            )
+            backend_id = _string_literal(delegate.id)
+            inits.append(
+                f"  // Delegate {n}: {delegate.id}\n"
+                "  {\n"
+                f"    delegate_backend_{n} = torch::executor::get_backend_class(\n"
+                f"        {backend_id});\n"
+                "    ET_CHECK_OR_RETURN_ERROR(\n"
+                f"        delegate_backend_{n} != nullptr &&\n"
+                f"            delegate_backend_{n}->is_available(),\n"
+                "        NotFound,\n"
+                f'        "Backend %s is not available",\n'
+                f"        {backend_id});\n"
+                "    torch::executor::BackendInitContext backend_context(\n"
+                "        runtime_allocator);\n"
+                "    torch::executor::FreeableBuffer processed(\n"
+                f"        delegate_processed_{n}, sizeof(delegate_processed_{n}), "
+                "nullptr);\n"
+                f"    auto handle = delegate_backend_{n}->init(\n"
+                "        backend_context,\n"
+                "        &processed,\n"
+                f"        {compile_specs});\n"
+                "    ET_CHECK_OK_OR_RETURN_ERROR(\n"
+                f'        handle.error(), "Init of delegate {n} failed");\n'
+                f"    delegate_handle_{n} = handle.get();\n"
+                "  }"
+            )
+            destroys.append(
+                f"  if (delegate_handle_{n} != nullptr) {{\n"
+                f"    delegate_backend_{n}->destroy(delegate_handle_{n});\n"
+                f"    delegate_handle_{n} = nullptr;\n"
+                "  }"
+            )
+        return "\n\n".join(decls), "\n".join(inits), "\n".join(destroys)
+
+    def generate(self) -> Dict[str, str]:
+        plan = self.plan
+        for c, chain in enumerate(plan.chains):
+            for i, instruction in enumerate(chain.instructions):
+                position = f"{c}:{i}"
+                args = instruction.instr_args
+                if isinstance(args, KernelCall):
+                    self._kernel_call(position, args)
+                elif isinstance(args, DelegateCall):
+                    self._delegate_call(position, args)
+                elif isinstance(args, FreeCall):
+                    # Only frees dynamically allocated memory.
+                    continue
+                else:
+                    raise ValueError(
+                        f"Instruction {position} is a {type(args).__name__}, "
+                        "only straight-line methods are supported"
+                    )
+        for io in (plan.inputs, plan.outputs):
+            for i in io:
+                self._tensor(i)
+
+        # Declare the tensors first, so that constants are collected.
+        tensors = [self._tensor_decl(i, self._tensor(i)) for i in sorted(self.tensors)]
+        values = tensors + [
+            "\n".join(group)
+            for group in (
+                [self.lists[i] for i in sorted(self.lists)],
+                [self._evalue_decl(i) for i in sorted(self.evalues)],
+                self.delegate_args,
+            )
+            if group
+        ]
+
+        planned_buffers = []
+        tiers = plan.non_const_buffer_tiers
+        for memory_id, size in enumerate(plan.non_const_buffer_sizes):
+            if memory_id == 0:
+                continue
+            decl = (
+                f"alignas({_ALIGNMENT}) uint8_t planned_buffer_{memory_id}[{size}];"
+                if size > 0
+                else f"uint8_t* const planned_buffer_{memory_id} = nullptr;"
+            )
+            if tiers and tiers[memory_id]:
+                decl = f"// Planned for the {tiers[memory_id]} memory tier.\n{decl}"
+            planned_buffers.append(decl)
+
+        constant_data = [
+            _byte_array(f"constant_{i}", self._constant_data(tensor), True)
+            for i, tensor in sorted(self.constants.items())
+        ]
+        delegates, delegate_inits, delegate_destroys = self._delegate_decls()
+
+        return {
+            "num_inputs": str(len(plan.inputs)),
+            "num_outputs": str(len(plan.outputs)),
+            "planned_buffers": "\n".join(planned_buffers),
+            "constant_data": "\n\n".join(constant_data),
+            "delegates": delegates,
+            "values": "\n\n".join(values),
+            "inputs": ", ".join(f"&value_{i}" for i in plan.inputs) or "nullptr",
+            "outputs": ", ".join(f"&value_{i}" for i in plan.outputs) or "nullptr",
+            "delegate_inits": delegate_inits,
+            "instructions": "\n".join(self.instructions),
+            "delegate_destroys": delegate_destroys,
+        }
+
+
+def _find_plan(program: Program, method_name: str) -> ExecutionPlan:
+    for plan in program.execution_plan:
+        if plan.name == method_name:
+            return plan
+    raise ValueError(f"The program has no method {method_name}")
+
+
+def method_operators(program: Program, method_name: str) -> List[str]:
+    """
+    The operators that the kernel calls of a method use, e.g. "aten::add.out",
+    which the kernel library linked with the generated source must select.
+    """
+    plan = _find_plan(program, method_name)
+    operators = set()
+    for chain in plan.chains:
+        for instruction in chain.instructions:
+            if isinstance(instruction.instr_args, KernelCall):
+                operator = plan.operators[instruction.instr_args.op_index]
+                operators.add(
+                    f"{operator.name}.{operator.overload}"
+                    if operator.overload
+                    else operator.name
+                )
+    return sorted(operators)
+
+
+def gen_aot_method(
+    program: Program,
+    segments: List[bytes],
+    method_name: str,
+    schemas: Dict[str, FunctionSchema],
+    namespace: Optional[str] = None,
+    header_name: str = "AotMethod.h",
+    fn_header: str = "Functions.h",
+    source_path: Optional[str] = None,
+    generated_comment: str = "@generated by gen_aot_method.py",
+) -> Tuple[str, str]:
+    """
+    Returns the header and the source that run the method `method_name` of
+    `program`, with `segments` the data of its segments.
+    """
+    plan = _find_plan(program, method_name)
+    substitutions = _MethodGenerator(program, segments, plan, schemas).generate()
+    substitutions.update(
+        {
+            "namespace": namespace
+            or f"torch::executor::aot::{_identifier(method_name)}",
+            "header": header_name,
+            "fn_header": fn_header,
+            "generated_comment": generated_comment,
+        }
+    )
+    templates = os.path.join(
+        source_path or os.path.join(os.path.dirname(__file__), ".."), "templates"
+    )
+    outputs = []
+    for template in ("AotMethod.h", "AotMethod.cpp"):
+        with open(os.path.join(templates, template), "r") as f:
+            outputs.append(string.Template(f.read()).substitute(substitutions))
+    return outputs[0], outputs[1]
+
+
+def main(args: List[str]) -> None:
+    """
+    Generates <output_name>.h and <output_name>.cpp, which run a method of a
+    program without the interpreter. Link them against the kernel library
+    generated with the selected_operators.yaml of --oplist_output_path, whose
+    Functions.h they call into, and against the backends the program
+    delegates to.
+    """
+    parser = argparse.ArgumentParser(
+        description="Generate C++ source from a method of an executorch program"
+    )
+    parser.add_argument(
+        "--model_file_path",
+        help="Path to an executorch program",
+        required=True,
+    )
+    parser.add_argument(
+        "--method_name",
+        help="The method to generate source for",
+        default="forward",
+    )
+    parser.add_argument(
+        "--ops_yaml_path",
+        help=(
+            "A yaml with the schemas of the program's operators, like "
+            "native_functions.yaml or custom_ops.yaml. Can be repeated; "
+            "operators registered with torch are found without it"
+        ),
+        action="append",
+        default=[],
+    )
+    parser.add_argument(
+        "--output_dir",
+        help="The directory to write the header and source to",
+        required=True,
+    )
+    parser.add_argument(
+        "--output_name",
+        help="The name of the header and source, without extension",
+        default="AotMethod",
+    )
+    parser.add_argument(
+        "--namespace",
+        help="The C++ namespace of the generated functions",
+        default=None,
+    )
+    parser.add_argument(
+        "--fn_header",
+        help="The include path of the kernel library's Functions.h",
+        default="Functions.h",
+    )
+    parser.add_argument(
+        "--oplist_output_path",
+        help=(
+            "Where to write the selected_operators.yaml of the method's "
+            "operators, to selectively build the kernel library"
+        ),
+        default=None,
+    )
+    parser.add_argument(
+        "--source_path",
+        help="The directory containing the codegen templates",
+        default=None,
+    )
+    options = parser.parse_args(args)
+
+    with open(options.model_file_path, "rb") as f:
+        program, segments = load_program(f.read())
+    header, source = gen_aot_method(
+        program,
+        segments,
+        options.method_name,
+        load_schemas(options.ops_yaml_path),
+        namespace=options.namespace,
+        header_name=f"{options.output_name}.h",
+        fn_header=options.fn_header,
+        source_path=options.source_path,
+        generated_comment=(
+            "@generated by gen_aot_method.py from "
+            f"{os.path.basename(options.model_file_path)}"
+        ),
+    )
+    os.makedirs(options.output_dir, exist_ok=True)
+    for extension, content in (("h", header), ("cpp", source)):
+        path = os.path.join(options.output_dir, f"{options.output_name}.{extension}")
+        with open(path, "w") as f:
+            f.write(content)
+    if options.oplist_output_path:
+        from executorch.codegen.tools.gen_oplist import gen_oplist
+
+        gen_oplist(
+            output_path=options.oplist_output_path,
+            ops_dict=json.dumps(
+                {op: [] for op in method_operators(program, options.method_name)}
+            ),
+        )
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
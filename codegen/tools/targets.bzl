@@ -197,3 +197,41 @@ def define_common_targets(is_fbcode = False):
                 "//libfb/py:parutil",
             ],
         )
+
+        runtime.python_library(
+            name = "gen_aot_method_lib",
+            srcs = ["gen_aot_method.py"],
+            base_module = "executorch.codegen.tools",
+            visibility = [
+                "//executorch/...",
+            ],
+            external_deps = ["torchgen"],
+            deps = [
+                "fbsource//third-party/pypi/pyyaml:pyyaml",
+                ":gen_oplist_lib",
+                "//executorch/exir:schema",
+                "//executorch/exir/_serialize:lib",
+            ],
+        )
+
+        runtime.python_binary(
+            name = "gen_aot_method",
+            main_module = "executorch.codegen.tools.gen_aot_method",
+            package_style = "inplace",
+            visibility = [
+                "//executorch/...",
+                "@EXECUTORCH_CLIENTS",
+            ],
+            deps = [
+                ":gen_aot_method_lib",
+            ],
+        )
+
+        runtime.python_test(
+            name = "test_gen_aot_method",
+            srcs = ["test/test_gen_aot_method.py"],
+            base_module = "",
+            deps = [
+                ":gen_aot_method_lib",
+            ],
+        )
@@ -0,0 +1,212 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import struct
+import unittest
+from typing import List, Optional
+
+from executorch.codegen.tools.gen_aot_method import gen_aot_method
+from executorch.exir.backend.compile_spec_schema import CompileSpec
+from executorch.exir.scalar_type import ScalarType
+from executorch.exir.schema import (
+    AllocationDetails,
+    BackendDelegate,
+    BackendDelegateDataReference,
+    BackendDelegateInlineData,
+    Buffer,
+    Chain,
+    ContainerMetadata,
+    DataLocation,
+    DelegateCall,
+    EValue,
+    ExecutionPlan,
+    Instruction,
+    Int,
+    JumpFalseCall,
+    KernelCall,
+    Operator,
+    Program,
+    SubsegmentOffsets,
+    Tensor,
+    TensorShapeDynamism,
+)
+from torchgen.model import FunctionSchema
+
+ADD_OUT = (
+    "add.out(Tensor self, Tensor other, *, Scalar alpha=1, Tensor(a!) out) "
+    "-> Tensor(a!)"
+)
+
+
+def make_tensor(
+    constant_buffer_idx: int = 0,
+    offset: Optional[int] = None,
+    shape_dynamism: TensorShapeDynamism = TensorShapeDynamism.STATIC,
+) -> EValue:
+    return EValue(
+        Tensor(
+            scalar_type=ScalarType.FLOAT,
+            storage_offset=0,
+            sizes=[1, 2],
+            dim_order=[0, 1],
+            requires_grad=False,
+            layout=0,
+            constant_buffer_idx=constant_buffer_idx,
+            allocation_info=(
+                AllocationDetails(
+                    memory_id=1, memory_offset_low=offset, memory_offset_high=0
+                )
+                if offset is not None
+                else None
+            ),
+            shape_dynamism=shape_dynamism,
+        )
+    )
+
+
+def make_program(
+    instructions: List[Instruction], values: Optional[List[EValue]] = None
+) -> Program:
+    """
+    A program computing `out = (x + c) + c`, with c a constant, unless other
+    instructions are given.
+    """
+    return Program(
+        version=0,
+        execution_plan=[
+            ExecutionPlan(
+                name="forward",
+                container_meta_type=ContainerMetadata("", ""),
+                values=values
+                or [
+                    make_tensor(offset=0),
+                    make_tensor(constant_buffer_idx=1),
+                    EValue(Int(1)),
+                    make_tensor(offset=16),
+                    make_tensor(offset=32),
+                ],
+                inputs=[0],
+                outputs=[4],
+                chains=[
+                    Chain(
+                        inputs=[0],
+                        outputs=[4],
+                        instructions=instructions,
+                        stacktrace=None,
+                    )
+                ],
+                operators=[Operator(name="aten::add", overload="out")],
+                delegates=[
+                    BackendDelegate(
+                        id="StubBackend",
+                        processed=BackendDelegateDataReference(
+                            location=DataLocation.INLINE, index=0
+                        ),
+                        compile_specs=[CompileSpec("key", b"\x01")],
+                    )
+                ],
+                non_const_buffer_sizes=[0, 48],
+            )
+        ],
+        constant_buffer=[Buffer(storage=b""), Buffer(struct.pack("<2f", 1, 2))],
+        backend_delegate_data=[BackendDelegateInlineData(data=b"\xab\xcd")],
+        segments=[],
+        constant_segment=SubsegmentOffsets(segment_index=0, offsets=[]),
+    )
+
+
+KERNEL_CALLS = [
+    Instruction(KernelCall(op_index=0, args=[0, 1, 2, 3, 3])),
+    Instruction(KernelCall(op_index=0, args=[3, 1, 2, 4, 4])),
+]
+
+
+class TestGenAotMethod(unittest.TestCase):
+    def setUp(self) -> None:
+        self.schemas = {"aten::add.out": FunctionSchema.parse(ADD_OUT)}
+
+    def test_kernel_calls(self) -> None:
+        header, source = gen_aot_method(
+            make_program(KERNEL_CALLS), [], "forward", self.schemas
+        )
+        self.assertIn("namespace torch::executor::aot::forward {", header)
+        self.assertIn("constexpr size_t kNumInputs = 1;", header)
+        self.assertIn("uint8_t planned_buffer_1[48];", source)
+        self.assertIn(
+            "alignas(16) const uint8_t constant_1[] = {\n"
+            "    0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x40,\n"
+            "};",
+            source,
+        )
+        self.assertIn("planned_buffer_1 + 16, dim_order_3, strides_3);", source)
+        self.assertIn("const_cast<uint8_t*>(constant_1), dim_order_1", source)
+        self.assertIn(
+            "torch::executor::aten::add_outf(context, value_0, value_1, "
+            "exec_aten::Scalar(int64_t(1)), value_3);",
+            source,
+        )
+        self.assertIn(
+            "torch::executor::aten::add_outf(context, value_3, value_1, "
+            "exec_aten::Scalar(int64_t(1)), value_4);",
+            source,
+        )
+        self.assertIn("exec_aten::Tensor* const inputs[] = {&value_0};", source)
+        self.assertIn("exec_aten::Tensor* const outputs[] = {&value_4};", source)
+        # Only used delegates are compiled in.
+        self.assertNotIn("delegate_processed_0", source)
+
+    def test_delegate_call(self) -> None:
+        _, source = gen_aot_method(
+            make_program([Instruction(DelegateCall(delegate_index=0, args=[0, 4]))]),
+            [],
+            "forward",
+            self.schemas,
+        )
+        self.assertIn(
+            "alignas(16) const uint8_t delegate_processed_0[] = {\n"
+            "    0xab, 0xcd,\n"
+            "};",
+            source,
+        )
+        self.assertIn(
+            '{"key", {delegate_0_spec_0, sizeof(delegate_0_spec_0)}},', source
+        )
+        self.assertIn(
+            "torch::executor::EValue* delegate_call_args_0[] = "
+            "{&evalue_0, &evalue_4};",
+            source,
+        )
+        self.assertIn("delegate_backend_0->execute(", source)
+        self.assertIn("delegate_backend_0->destroy(delegate_handle_0);", source)
+
+    def test_rejects_dynamic_methods(self) -> None:
+        with self.assertRaisesRegex(ValueError, "straight-line"):
+            gen_aot_method(
+                make_program(
+                    [
+                        Instruction(
+                            JumpFalseCall(
+                                cond_value_index=2, destination_instruction=0
+                            )
+                        )
+                    ]
+                ),
+                [],
+                "forward",
+                self.schemas,
+            )
+        values = make_program(KERNEL_CALLS).execution_plan[0].values
+        values[3] = make_tensor(
+            offset=16, shape_dynamism=TensorShapeDynamism.DYNAMIC_BOUND
+        )
+        with self.assertRaisesRegex(ValueError, "static shape"):
+            gen_aot_method(
+                make_program(KERNEL_CALLS, values), [], "forward", self.schemas
+            )
+
+    def test_unknown_method(self) -> None:
+        with self.assertRaisesRegex(ValueError, "no method"):
+            gen_aot_method(make_program(KERNEL_CALLS), [], "other", self.schemas)
@@ -19,6 +19,8 @@
 
 #include <gflags/gflags.h>
 
+#include <executorch/backends/apple/mps/runtime/MPSSharedMemoryAllocator.h>
+#include <executorch/backends/apple/mps/runtime/MPSSynchronize.h>
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
@@ -99,6 +101,7 @@ DEFINE_int32(
     "Size of the debug buffer in bytes to allocate for intermediate outputs and program outputs logging.");
 
 using namespace torch::executor;
+using torch::executor::mps::delegate::MPSSharedMemoryAllocator;
 using torch::executor::util::FileDataLoader;
 
 /**
@@ -337,7 +340,10 @@ int main(int argc, char** argv) {
   // These buffers correspond to different hardware memory banks. Most mobile
   // environments will only have a single buffer. Some embedded environments may
   // have more than one for, e.g., slow/large DRAM and fast/small SRAM.
-  std::vector<std::unique_ptr<uint8_t[]>> non_const_buffers;
+  //
+  // The buffers come from MPSSharedMemoryAllocators, so that the MPS delegate
+  // can bind the inputs and outputs planned in them without copying them.
+  std::vector<std::unique_ptr<MPSSharedMemoryAllocator>> non_const_buffers;
   std::vector<MemoryAllocator> non_const_allocators;
   size_t num_non_const_buffers = 0;
   {
@@ -361,11 +367,16 @@ int main(int argc, char** argv) {
         (unsigned int)buffer_size.error());
     ET_LOG(
         Info, "Setting up non-const buffer %zu, size %lld.", id, *buffer_size);
-    non_const_buffers.push_back(std::make_unique<uint8_t[]>(*buffer_size));
+    non_const_buffers.push_back(
+        std::make_unique<MPSSharedMemoryAllocator>(*buffer_size));
+    ET_CHECK_MSG(
+        non_const_buffers.back()->base_address() != nullptr,
+        "Failed to allocate non-const buffer %zu",
+        id);
     // Since the list of allocators began empty, buffer ID N will live at index
     // N-1.
-    non_const_allocators.push_back(
-        MemoryAllocator(*buffer_size, non_const_buffers.back().get()));
+    non_const_allocators.push_back(MemoryAllocator(
+        *buffer_size, non_const_buffers.back()->base_address()));
     non_const_allocators.back().enable_profiling("non_const_allocators");
   }
 
@@ -461,6 +472,9 @@ int main(int argc, char** argv) {
         method_name,
         status);
   }
+  // Wait for the executions of pipelined programs to finish before reading
+  // their outputs.
+  ET_CHECK(torch::executor::mps::delegate::synchronize() == Error::Ok);
   if (FLAGS_profile && FLAGS_num_runs) {
     auto itr = exec_times.begin();
     if (!FLAGS_skip_warmup)
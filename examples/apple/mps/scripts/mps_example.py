@@ -67,6 +67,13 @@ def parse_args():
         help=f"Provide model name. Valid ones: {list(MODEL_NAME_TO_MODEL.keys())}",
     )
 
+    parser.add_argument(
+        "--pipelined",
+        default=False,
+        action=argparse.BooleanOptionalAction,
+        help="Whether execute() returns before the GPU finishes, to overlap executions.",
+    )
+
     parser.add_argument(
         "--use_fp16",
         default=True,
@@ -174,7 +181,10 @@ if __name__ == "__main__":
 
     edge_program_manager_copy = copy.deepcopy(edge)
 
-    compile_specs = [CompileSpec("use_fp16", bytes([args.use_fp16]))]
+    compile_specs = [
+        CompileSpec("use_fp16", bytes([args.use_fp16])),
+        CompileSpec("pipelined", bytes([args.pipelined])),
+    ]
 
     logging.info(f"Edge IR graph:\n{edge.exported_program().graph}")
     if args.use_partitioner:
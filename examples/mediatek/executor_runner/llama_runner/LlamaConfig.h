@@ -9,6 +9,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "llm_helper/include/llm_types.h"
@@ -33,6 +34,38 @@ struct LlamaModelOptions {
   LLMType cache_type        = LLMType::INT16;
   LLMType mask_type         = LLMType::INT16;
   LLMType rot_emb_type      = LLMType::INT16;
+
+  // Cache layout
+  // Ring buffer cache: the model outputs only the cache entries of the input tokens, which are
+  // written at a wrapping position instead of shifting the whole cache every step.
+  bool ring_cache = false;
+  // Ring cache only: the number of cache entries of the first tokens that are never evicted once
+  // the cache is full ("attention sinks"). The ring wraps within the remaining entries.
+  size_t cache_sink_size = 0;
+  // Ring cache only: keep generating past max_token_length, StreamingLLM style. Once the cache is
+  // full it holds the sinks and a sliding window of the latest tokens, and the rotary embeddings
+  // of the token indexes past max_token_length are computed as they are needed.
+  bool streaming = false;
+  // Allocate the caches of each chunk as slices of one buffer, so that resetting, rolling back
+  // and snapshotting the caches are bulk operations over one span.
+  bool contiguous_cache = false;
+
+  // Keep the models of all token batch sizes loaded, so that swapping between them only rebinds
+  // the model IOs instead of reloading the models.
+  bool load_all_models = false;
+  // With load_all_models, load the models on first use instead, and unload the least recently used
+  // ones once the loaded model files exceed this size in MB, split evenly between the chunks. 0
+  // loads all of them at init.
+  size_t model_memory_budget_mb = 0;
+
+  // Token embedding lookup table
+  // Table type if it differs from model_input_type, e.g. a quantized INT8/INT4 table.
+  LLMType token_embedding_type = LLMType::INVALID;
+  // Memory-map the table instead of reading it into memory.
+  bool mmap_token_embedding = false;
+  // Quantization scale of an INT16 model input, which the dequantized embeddings are
+  // requantized to.
+  float model_input_qscale = 0;
 };
 
 struct LlamaModelPaths {
@@ -40,6 +73,10 @@ struct LlamaModelPaths {
   std::string token_embedding_path;
   std::vector<std::string> prompt_model_paths;
   std::vector<std::string> gen_model_paths;
+
+  // Chunk model paths of additional prompt token batch sizes, used to digest the prompt tail
+  // with less padding. Every batch size must be smaller than prompt_token_batch_size.
+  std::unordered_map<size_t, std::vector<std::string>> extra_prompt_model_paths;
 };
 
 } // namespace torch::executor
\ No newline at end of file
@@ -11,8 +11,12 @@
 #include <unordered_map>
 #include <numeric>
 
+#include "executorch/backends/mediatek/runtime/include/NeuronBackend.h"
+#include "executorch/backends/mediatek/runtime/include/NeuronBufferAllocator.h"
+
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/evalue_util/print_evalue.h>
+#include <executorch/extension/kv_cache/kv_cache_manager.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/platform/log.h>
@@ -29,6 +33,18 @@
 
 namespace torch::executor {
 
+namespace {
+
+// Precedes the cache manager snapshot, which holds the cache state and contents.
+struct CacheSnapshotState {
+  uint64_t tokenIndex;
+};
+
+// Alignment of the caches within a cache slab.
+constexpr size_t kCacheSlabAlignment = 64;
+
+} // namespace
+
 inline std::vector<size_t> getIndexRange(const size_t startIndex, const size_t count) {
   std::vector<size_t> indexes(count);
   size_t counter = startIndex;
@@ -52,10 +68,16 @@ LlamaModelChunk::LlamaModelChunk(
       kRotEmbMasterLut(rotEmbMasterLut),
       kCacheType(modelOptions.cache_type),
       kCacheTypeSize(llm_helper::getLLMTypeSize(kCacheType)),
+      kRingCache(modelOptions.ring_cache),
+      kCacheSinkSize(modelOptions.ring_cache ? modelOptions.cache_sink_size : 0),
+      kStreaming(modelOptions.ring_cache && modelOptions.streaming),
+      kContiguousCache(modelOptions.contiguous_cache),
       kMaskInputIndex(1),
       kRotEmbInputIndexes(getIndexRange(2, numRotEmbInputs)),
       kCacheInputIndexes(getIndexRange(kRotEmbInputIndexes.back() + 1, numCache)),
-      kCacheOutputIndexes(getIndexRange(1, numCache)) {}
+      kCacheOutputIndexes(getIndexRange(1, numCache)) {
+  mAllowModelsCoexist = modelOptions.load_all_models;
+}
 
 LlamaModelChunk::~LlamaModelChunk() {}
 
@@ -71,13 +93,21 @@ size_t LlamaModelChunk::GetExpectedOutputCount() const {
 }
 
 void LlamaModelChunk::Initialize() {
-  LoadModels();
+  Preload();
   GetModelIoInfo();
   CheckIoCount();
   PrepareCacheIOs();
+  if (kContiguousCache) {
+    // Linked cache outputs then share the slices like the other cache input buffers
+    std::vector<void*> cacheBuffers;
+    mCacheSlab = AllocateCacheSlab(cacheBuffers);
+    for (size_t i = 0; i < kCacheInputIndexes.size(); i++) {
+      mInputBufferInfos[kCacheInputIndexes[i]].data = cacheBuffers[i];
+    }
+  }
   AllocateIoBuffers();
   InitMaskBuilder();
-  InitCache();
+  InitCacheManager();
 
   SetBackendInputs();
   SetBackendOutputs();
@@ -103,20 +133,54 @@ void LlamaModelChunk::CheckIoCount() {
 bool LlamaModelChunk::HotSwapModel(const size_t tokenBatchSize) {
   const auto status = ModelChunk::HotSwapModel(tokenBatchSize);
 
-  // Force rebuild mask because different batch size values will produce different mask shapes
-  mMaskBuilder->markMaskDirty();
+  if (mMaskBuilder) {
+    // Force rebuild mask because different batch size values will produce different mask shapes
+    mMaskBuilder->markMaskDirty();
 
-  // Update mask size
-  const auto newMaskSizeBytes = mInputBufferInfos[kMaskInputIndex].nbytesUsed;
-  mMaskBuilder->updateMaskSize(newMaskSizeBytes);
+    // Update mask size
+    const auto newMaskSizeBytes = mInputBufferInfos[kMaskInputIndex].nbytesUsed;
+    mMaskBuilder->updateMaskSize(newMaskSizeBytes);
+  }
 
   return status;
 }
 
+void LlamaModelChunk::Release() {
+  auto& buffer_allocator = GET_NEURON_ALLOCATOR;
+  // The buffers of the selected cache set are released along with the other model IOs
+  for (size_t i = 0; i < mCacheSets.size(); i++) {
+    if (i == mCurrentCacheSet) {
+      continue;
+    }
+    if (mCacheSets[i].slab != nullptr) {
+      buffer_allocator.RemoveBuffer(mCacheSets[i].slab);
+      continue;
+    }
+    for (auto buffer : mCacheSets[i].buffers) {
+      buffer_allocator.RemoveBuffer(buffer);
+    }
+  }
+  mCacheSets.clear();
+  mCurrentCacheSet = 0;
+  // Except for a cache slab, which is released once rather than by each of its slices
+  if (mCacheSlab != nullptr) {
+    for (size_t i = 0; i < kCacheInputIndexes.size(); i++) {
+      mInputBufferInfos[kCacheInputIndexes[i]].data = nullptr;
+      if (!kRingCache) {
+        mOutputBufferInfos[kCacheOutputIndexes[i]].data = nullptr;
+      }
+    }
+    buffer_allocator.RemoveBuffer(mCacheSlab);
+    mCacheSlab = nullptr;
+  }
+  mCacheManager.reset();
+  ModelChunk::Release();
+}
+
 void LlamaModelChunk::Reset() {
   mCurrentPadSize = 0;
   mCurrentTokenIndex = 0;
-  InitCache(); // Reset cache to zeros
+  mCacheManager->reset(); // Reset cache to zeros
 }
 
 void LlamaModelChunk::SetLeftPadding(const size_t leftPadSize) {
@@ -124,7 +188,9 @@ void LlamaModelChunk::SetLeftPadding(const size_t leftPadSize) {
   mPaddingMode = PaddingMode::LEFT;
 
   // Notify mask builder about padding
-  mMaskBuilder->notifyLeftPadding(leftPadSize);
+  if (mMaskBuilder) {
+    mMaskBuilder->notifyLeftPadding(leftPadSize);
+  }
 }
 
 void LlamaModelChunk::SetRightPadding(const size_t rightPadSize) {
@@ -132,7 +198,9 @@ void LlamaModelChunk::SetRightPadding(const size_t rightPadSize) {
   mPaddingMode = PaddingMode::RIGHT;
 
   // Notify mask builder about padding
-  mMaskBuilder->notifyRightPadding(rightPadSize);
+  if (mMaskBuilder) {
+    mMaskBuilder->notifyRightPadding(rightPadSize);
+  }
 }
 
 size_t LlamaModelChunk::GetLeftPadding() const {
@@ -143,91 +211,35 @@ size_t LlamaModelChunk::GetRightPadding() const {
   return (mPaddingMode == PaddingMode::RIGHT) ? mCurrentPadSize : 0;
 }
 
-void LlamaModelChunk::PaddingPostprocess() {
-    if (mCurrentPadSize == 0) {
-        return;
-    }
-
-    if (mPaddingMode == PaddingMode::RIGHT) {
-        RightPaddingCachePostprocess();
-    } else if (mPaddingMode == PaddingMode::LEFT) {
-        LeftPaddingCachePostprocess();
-    }
-}
-
-void LlamaModelChunk::LeftPaddingCachePostprocess() {
-    // NOTE: This part might not actually be needed
-
-    // Stride size is same across caches
-    const size_t strideSizeBytes = GetCacheStrideSize();
-    const size_t rowSize = kCacheLength * strideSizeBytes;
-
-    const size_t numRows = GetCacheNumRows();
+void LlamaModelChunk::UpdateCache() {
+  const size_t leftPadSize = GetLeftPadding();
+  const size_t rightPadSize = GetRightPadding();
+  const size_t validTokenCount = mTokenBatchSize - mCurrentPadSize;
 
-    const size_t offset = (kCacheLength - mTokenBatchSize) * strideSizeBytes;
-    const size_t zeroCount = mCurrentPadSize * strideSizeBytes;
-
-    // Fill padded sections with zeros
-    for (const auto cacheInputIdx : kCacheInputIndexes) {
-        auto cacheBuffer = reinterpret_cast<char*>(mInputBufferInfos[cacheInputIdx].data);
-        for (size_t rowIdx = 0; rowIdx < numRows; rowIdx++) {
-            auto cacheBufRow = cacheBuffer + rowIdx * rowSize; // Pointer pointing to start of row
-            std::memset(cacheBufRow + offset, 0, zeroCount);
-        }
+  if (kRingCache) {
+    // The ring cache only receives the entries of the non-padded tokens
+    std::vector<const void*> newEntries;
+    for (const auto cacheOutputIdx : kCacheOutputIndexes) {
+      newEntries.push_back(mOutputBufferInfos[cacheOutputIdx].data);
     }
-}
-
-void LlamaModelChunk::RightPaddingCachePostprocess() {
-    // NOTE: AdvanceTokenIndex() haven't been called for this inference step yet.
-    const size_t numSeenToken = mCurrentTokenIndex + mTokenBatchSize;
-    RollbackCache(mCurrentPadSize, numSeenToken);
-}
-
-void LlamaModelChunk::RollbackCache(const size_t rollbackTokCount, const size_t numSeenToken) {
-  if (rollbackTokCount == 0) {
-      return; // do nothing
-  }
-
-  const size_t numSeenTokenAlive = std::min(numSeenToken, kCacheLength);
-  const size_t firstNonEmptyIdx = kCacheLength - numSeenTokenAlive;
-  const size_t preserveTokCount = (numSeenTokenAlive > rollbackTokCount)
-                                  ? numSeenTokenAlive - rollbackTokCount : 0;
-
-  if (!preserveTokCount) {
-    // Clear cache to zeros
-    InitCache();
+    const auto status =
+        mCacheManager->write(newEntries, mTokenBatchSize, leftPadSize, validTokenCount);
+    ET_CHECK_MSG(status == Error::Ok, "Failed to write the ring cache entries");
     return;
   }
 
-  const size_t strideSizeBytes = GetCacheStrideSize();
-  const size_t rowSize = kCacheLength * strideSizeBytes;
-  const size_t numRows = GetCacheNumRows();
-
-  // Shift right and truncate rollbackTokCount, then fill left with zeros
-  for (const auto cacheInputIdx : kCacheInputIndexes) {
-    auto cacheBuffer = reinterpret_cast<char*>(mInputBufferInfos[cacheInputIdx].data);
-
-    for (size_t rowIdx = 0; rowIdx < numRows; rowIdx++) {
-      // Get the addr pointing to the start of row
-      auto cacheBufRow = cacheBuffer + rowIdx * rowSize;
-
-      // Move right for the section to be preserved
-      const size_t dstOffset = strideSizeBytes * (firstNonEmptyIdx + rollbackTokCount);
-      const size_t srcOffset = strideSizeBytes * firstNonEmptyIdx;
-      const size_t preserveSize = strideSizeBytes * preserveTokCount;
-      ET_DCHECK(dstOffset + preserveSize <= rowSize);
-      std::memmove(cacheBufRow + dstOffset, cacheBufRow + srcOffset, preserveSize);
-
-      // Then fill zeros to the section being moved out
-      const size_t offset = firstNonEmptyIdx * strideSizeBytes;
-      const size_t zeroCount = rollbackTokCount * strideSizeBytes;
-      std::memset(cacheBufRow + offset, 0, zeroCount);
-    }
+  // The model appended the cache entries of all input tokens, padding included
+  if (leftPadSize > 0) {
+    // NOTE: This part might not actually be needed
+    mCacheManager->clear(kCacheLength - mTokenBatchSize, leftPadSize);
   }
+  auto status = mCacheManager->append(mTokenBatchSize - leftPadSize);
+  ET_CHECK_MSG(status == Error::Ok, "Failed to update the cache state");
+  mCacheManager->rollback(rightPadSize);
 }
 
 void LlamaModelChunk::UpdatePosEmbAndMask(const size_t numInputToken) {
-  if (mCurrentTokenIndex + numInputToken > kMaxTokenLength) {
+  if (!kStreaming && mCurrentTokenIndex + numInputToken > kMaxTokenLength) {
     ET_LOG(
         Fatal,
         "Attempting to generate tokens exceeding the supported max token length (%zu)",
@@ -236,7 +248,14 @@ void LlamaModelChunk::UpdatePosEmbAndMask(const size_t numInputToken) {
   if (mCurrentTokenIndex > 0 && GetLeftPadding() > 0) {
     ET_LOG(Fatal, "Left-padding is only allowed in the first prompt pass.");
   }
-  mMaskBuilder->updateMask(mTokenBatchSize, mCurrentTokenIndex, numInputToken);
+  if (mMaskBuilder) {
+    if (kRingCache) {
+      const auto cacheState = mCacheManager->state();
+      mMaskBuilder->setRingCacheState(
+          mCacheManager->ring_start(), cacheState.num_valid, cacheState.num_valid_sinks);
+    }
+    mMaskBuilder->updateMask(mTokenBatchSize, mCurrentTokenIndex, numInputToken);
+  }
   SetPosEmbed(mCurrentTokenIndex);
 }
 
@@ -253,15 +272,144 @@ size_t LlamaModelChunk::GetTokenIndex() const {
   return mCurrentTokenIndex;
 }
 
+void LlamaModelChunk::Rollback(const size_t rollbackTokCount) {
+  ET_CHECK_MSG(
+      rollbackTokCount <= mCurrentTokenIndex,
+      "Rollback token count (%zu) > number of seen tokens (%zu)",
+      rollbackTokCount,
+      mCurrentTokenIndex);
+  if (rollbackTokCount == 0) {
+    return;
+  }
+  mCacheManager->rollback(rollbackTokCount);
+  mCurrentTokenIndex -= rollbackTokCount;
+
+  // The mask was built for the tokens seen before the rollback
+  if (mMaskBuilder) {
+    mMaskBuilder->markMaskDirty();
+  }
+}
+
+size_t LlamaModelChunk::GetCacheSnapshotSize() const {
+  return sizeof(CacheSnapshotState) + mCacheManager->snapshot_nbytes();
+}
+
+void LlamaModelChunk::SaveCacheSnapshot(void* dst) const {
+  const CacheSnapshotState state = {.tokenIndex = mCurrentTokenIndex};
+  auto dstPtr = reinterpret_cast<char*>(dst);
+  std::memcpy(dstPtr, &state, sizeof(state));
+  mCacheManager->save_snapshot(dstPtr + sizeof(state));
+}
+
+bool LlamaModelChunk::LoadCacheSnapshot(const void* src, const size_t size) {
+  if (size != GetCacheSnapshotSize()) {
+    ET_LOG(Error, "Cache snapshot size (%zu) != expected (%zu)", size, GetCacheSnapshotSize());
+    return false;
+  }
+  CacheSnapshotState state;
+  auto srcPtr = reinterpret_cast<const char*>(src);
+  std::memcpy(&state, srcPtr, sizeof(state));
+  if ((!kStreaming && state.tokenIndex > kMaxTokenLength)
+      || mCacheManager->load_snapshot(srcPtr + sizeof(state), size - sizeof(state))
+             != Error::Ok) {
+    ET_LOG(Error, "Invalid cache snapshot state");
+    return false;
+  }
+  mCurrentTokenIndex = state.tokenIndex;
+  mCurrentPadSize = 0;
+  if (mMaskBuilder) {
+    mMaskBuilder->markMaskDirty();
+  }
+  return true;
+}
+
+size_t LlamaModelChunk::AddCacheSet() {
+  if (mCacheSets.empty()) {
+    // Register the initial caches as cache set 0
+    mCacheSets.emplace_back();
+  }
+  CacheSet cacheSet;
+  if (kContiguousCache) {
+    cacheSet.slab = AllocateCacheSlab(cacheSet.buffers);
+    mCacheSets.push_back(std::move(cacheSet));
+    return mCacheSets.size() - 1;
+  }
+  auto& buffer_allocator = GET_NEURON_ALLOCATOR;
+  for (const auto cacheIdx : kCacheInputIndexes) {
+    const size_t cacheSizeBytes = mInputBufferInfos[cacheIdx].nbytes;
+    void* buffer = buffer_allocator.Allocate(cacheSizeBytes);
+    ET_CHECK_MSG(buffer != nullptr, "Failed to allocate cache set buffer");
+    std::memset(buffer, 0, cacheSizeBytes);
+    cacheSet.buffers.push_back(buffer);
+  }
+  mCacheSets.push_back(std::move(cacheSet));
+  return mCacheSets.size() - 1;
+}
+
+void LlamaModelChunk::SelectCacheSet(const size_t cacheSetId) {
+  if (cacheSetId == mCurrentCacheSet) {
+    return;
+  }
+  ET_CHECK_MSG(cacheSetId < mCacheSets.size(), "Invalid cache set id: %zu", cacheSetId);
+
+  // Save the state of the current cache set
+  auto& curCacheSet = mCacheSets[mCurrentCacheSet];
+  curCacheSet.buffers = GetCacheBuffers();
+  curCacheSet.tokenIndex = mCurrentTokenIndex;
+  curCacheSet.cacheState = mCacheManager->state();
+  curCacheSet.slab = mCacheSlab;
+
+  // Bind the caches of the new cache set. Linked cache outputs share the cache input buffers.
+  const auto& newCacheSet = mCacheSets[cacheSetId];
+  for (size_t i = 0; i < kCacheInputIndexes.size(); i++) {
+    mInputBufferInfos[kCacheInputIndexes[i]].data = newCacheSet.buffers[i];
+    if (!kRingCache) {
+      mOutputBufferInfos[kCacheOutputIndexes[i]].data = newCacheSet.buffers[i];
+    }
+  }
+  mCacheManager->set_buffers(newCacheSet.buffers);
+  const auto status = mCacheManager->set_state(newCacheSet.cacheState);
+  ET_CHECK_MSG(status == Error::Ok, "Invalid cache state of cache set %zu", cacheSetId);
+  mCurrentTokenIndex = newCacheSet.tokenIndex;
+  mCurrentPadSize = 0;
+  mCacheSlab = newCacheSet.slab;
+  mCurrentCacheSet = cacheSetId;
+
+  SetBackendInputs();
+  SetBackendOutputs();
+  if (mMaskBuilder) {
+    mMaskBuilder->markMaskDirty();
+  }
+}
+
 void LlamaModelChunk::Run() {
+  StartRun();
+  const auto status = neuron::WaitForAsyncExecutions();
+  ET_CHECK_MSG(status == Error::Ok, "Asynchronous execution failed with status 0x%" PRIx32, status);
+  FinishRun();
+}
+
+void LlamaModelChunk::StartRun() {
   UpdatePosEmbAndMask(mTokenBatchSize);
+  if (mCacheSets.empty()) {
+    ModelChunk::Run();
+    return;
+  }
+  // Each cache set has an execution instance of its own, which keeps its cache bindings while the
+  // other cache sets execute.
+  auto options = neuron::GetExecutionOptions();
+  options.mBindingSet = mCurrentCacheSet;
+  const neuron::ScopedExecutionOptions cacheSetBindings(options);
   ModelChunk::Run();
-  PaddingPostprocess();
+}
+
+void LlamaModelChunk::FinishRun() {
+  UpdateCache();
   AdvanceTokenIndex();
 }
 
 void LlamaModelChunk::SetPosEmbed(const size_t tokenIndex) {
-  if (tokenIndex >= kMaxTokenLength) {
+  if (!kStreaming && tokenIndex >= kMaxTokenLength) {
     ET_LOG(
         Fatal,
         "Attempting to set rotaty embedding using index exceeding the supported max token length "
@@ -269,6 +417,10 @@ void LlamaModelChunk::SetPosEmbed(const size_t tokenIndex) {
         kMaxTokenLength);
   }
 
+  if (!mIsRotEmbOwner) {
+    return; // The rotary embedding inputs are written by the owner chunk
+  }
+
   auto getRotEmbInputs = [&]() {
     std::vector<void*> rotEmbInputs;
     for (const auto inputIdx : kRotEmbInputIndexes)
@@ -285,6 +437,11 @@ void LlamaModelChunk::PrepareCacheIOs() {
   const auto firstInCacheIdx = kCacheInputIndexes.front();
   mCacheShape = method_meta.input_tensor_meta(firstInCacheIdx)->sizes();
 
+  // The ring cache outputs only hold the new entries, which are copied into the cache inputs.
+  if (kRingCache) {
+    return;
+  }
+
   // Link cache IOs
   const size_t numCaches = kCacheInputIndexes.size();
   for (size_t i = 0; i < numCaches; i++) {
@@ -306,7 +463,34 @@ size_t LlamaModelChunk::GetCacheStrideSize() const {
                      std::multiplies<>());
 }
 
+void LlamaModelChunk::ShareMaskWith(LlamaModelChunk* maskOwner) {
+  ET_CHECK_MSG(!mIsInitialized, "Mask sharing must be set up before initialization");
+  ET_CHECK_MSG(
+      maskOwner->kCacheLength == kCacheLength && maskOwner->kMaskType == kMaskType
+          && maskOwner->mTokenBatchSize == mTokenBatchSize,
+      "Chunks with different mask geometry cannot share the mask");
+  SetInputBuffer(maskOwner->GetInputBuffer(maskOwner->kMaskInputIndex), kMaskInputIndex);
+  mIsMaskOwner = false;
+}
+
+void LlamaModelChunk::ShareRotEmbWith(LlamaModelChunk* rotEmbOwner) {
+  ET_CHECK_MSG(!mIsInitialized, "Rotary embedding sharing must be set up before initialization");
+  ET_CHECK_MSG(
+      rotEmbOwner->kRotEmbMasterLut == kRotEmbMasterLut
+          && rotEmbOwner->kRotEmbInputIndexes.size() == kRotEmbInputIndexes.size()
+          && rotEmbOwner->mTokenBatchSize == mTokenBatchSize,
+      "Chunks with different rotary embedding inputs cannot share them");
+  for (size_t i = 0; i < kRotEmbInputIndexes.size(); i++) {
+    const auto ownerInputIdx = rotEmbOwner->kRotEmbInputIndexes[i];
+    SetInputBuffer(rotEmbOwner->GetInputBuffer(ownerInputIdx), kRotEmbInputIndexes[i]);
+  }
+  mIsRotEmbOwner = false;
+}
+
 void LlamaModelChunk::InitMaskBuilder() {
+  if (!mIsMaskOwner) {
+    return; // The mask is built by the owner chunk
+  }
   const auto& maskBufferInfo = mInputBufferInfos[kMaskInputIndex];
   const auto maskBuffer = maskBufferInfo.data;
   const auto maskSizeBytes = maskBufferInfo.nbytesUsed;
@@ -315,14 +499,51 @@ void LlamaModelChunk::InitMaskBuilder() {
   mMaskBuilder->buildMask(mTokenBatchSize, mCurrentTokenIndex);
 }
 
-void LlamaModelChunk::InitCache() {
-  // Zero initialization
+void LlamaModelChunk::InitCacheManager() {
+  KVCacheManager::Config config;
+  config.layout = kRingCache ? KVCacheManager::Layout::Ring : KVCacheManager::Layout::Shifted;
+  config.num_rows = GetCacheNumRows();
+  config.cache_length = kCacheLength;
+  config.entry_nbytes = GetCacheStrideSize();
+  config.num_sink_entries = kCacheSinkSize;
+  mCacheManager = std::make_unique<KVCacheManager>(config, GetCacheBuffers());
+  for (const auto cacheIdx : kCacheInputIndexes) {
+    ET_CHECK_MSG(
+        mInputBufferInfos[cacheIdx].nbytes == mCacheManager->cache_nbytes(),
+        "Cache input %zu size (%zu) does not match the cache shape (%zu)",
+        cacheIdx,
+        mInputBufferInfos[cacheIdx].nbytes,
+        mCacheManager->cache_nbytes());
+  }
+  mCacheManager->reset(); // Zero initialization
+}
+
+void* LlamaModelChunk::AllocateCacheSlab(std::vector<void*>& cacheBuffers) const {
+  std::vector<size_t> offsets;
+  size_t slabSizeBytes = 0;
+  for (const auto cacheIdx : kCacheInputIndexes) {
+    offsets.push_back(slabSizeBytes);
+    const size_t cacheSizeBytes = mInputBufferInfos[cacheIdx].nbytes;
+    slabSizeBytes += (cacheSizeBytes + kCacheSlabAlignment - 1) / kCacheSlabAlignment
+                     * kCacheSlabAlignment;
+  }
+  auto& buffer_allocator = GET_NEURON_ALLOCATOR;
+  auto slab = static_cast<uint8_t*>(buffer_allocator.Allocate(slabSizeBytes));
+  ET_CHECK_MSG(slab != nullptr, "Failed to allocate the cache slab of %zu bytes", slabSizeBytes);
+  std::memset(slab, 0, slabSizeBytes);
+  cacheBuffers.clear();
+  for (const auto offset : offsets) {
+    cacheBuffers.push_back(slab + offset);
+  }
+  return slab;
+}
+
+std::vector<void*> LlamaModelChunk::GetCacheBuffers() const {
+  std::vector<void*> cacheBuffers;
   for (const auto cacheIdx : kCacheInputIndexes) {
-    const auto& inputCacheInfo = mInputBufferInfos[cacheIdx];
-    char* cacheBuffer = reinterpret_cast<char*>(inputCacheInfo.data);
-    const size_t cacheSizeBytes = inputCacheInfo.nbytes;
-    std::memset(cacheBuffer, 0, cacheSizeBytes);
+    cacheBuffers.push_back(mInputBufferInfos[cacheIdx].data);
   }
+  return cacheBuffers;
 }
 
-} // namespace torch::executor
\ No newline at end of file
+} // namespace torch::executor
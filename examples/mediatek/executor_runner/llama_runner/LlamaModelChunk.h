@@ -14,6 +14,7 @@
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/evalue_util/print_evalue.h>
+#include <executorch/extension/kv_cache/kv_cache_manager.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/platform/log.h>
@@ -35,6 +36,7 @@ using llm_helper::MaskBuilder;
 
 using TensorShape = Span<const int32_t>;
 using ModelIndexMap = std::unordered_map<size_t, size_t>;
+using util::KVCacheManager;
 
 // Llama decoder chunk
 class LlamaModelChunk : public ModelChunk {
@@ -56,8 +58,18 @@ public:
 
   virtual void Run() override;
 
+  // Split form of Run() to pipeline the chunks. StartRun() prepares the inputs and executes the
+  // model, which returns once submitted if the model uses asynchronous Neuron execution, so the
+  // CPU can prepare the next chunk meanwhile. FinishRun() postprocesses the caches after the
+  // executions have completed, see neuron::WaitForAsyncExecutions().
+  void StartRun();
+
+  void FinishRun();
+
   virtual bool HotSwapModel(const size_t tokenBatchSize) override;
 
+  virtual void Release() override;
+
   void Reset();
 
   void SetLeftPadding(const size_t leftPadSize);
@@ -70,15 +82,48 @@ public:
 
   size_t GetTokenIndex() const;
 
+  // Discard the cache entries of the last rollbackTokCount seen tokens and rewind the token index,
+  // e.g. to drop the draft tokens rejected in speculative decoding.
+  void Rollback(const size_t rollbackTokCount);
+
+  // Cache snapshot: the token index followed by the snapshot of the cache manager.
+  // The mask is rebuilt from the restored state on the next run.
+  size_t GetCacheSnapshotSize() const;
+
+  void SaveCacheSnapshot(void* dst) const;
+
+  bool LoadCacheSnapshot(const void* src, const size_t size);
+
+  // Cache sets hold the caches, token index and cache state of independent sequences, e.g.
+  // one per session. The initial caches are cache set 0. Selecting a cache set rebinds the cache
+  // IOs of the model without copying the caches.
+  size_t AddCacheSet();
+
+  void SelectCacheSet(const size_t cacheSetId);
+
+  // Use the mask input buffer of maskOwner, which must have the same mask geometry and be
+  // initialized. Must be called before Initialize(). The mask is then only built and updated by
+  // the owner, so the owner must run before this chunk on every step.
+  void ShareMaskWith(LlamaModelChunk* maskOwner);
+
+  // Same as ShareMaskWith() but for the rotary embedding inputs, which are then only written by
+  // rotEmbOwner.
+  void ShareRotEmbWith(LlamaModelChunk* rotEmbOwner);
+
 private:
   void SetPosEmbed(const size_t tokenIndex);
 
   void InitMaskBuilder();
 
-  void InitCache();
+  void InitCacheManager();
 
   void PrepareCacheIOs();
 
+  std::vector<void*> GetCacheBuffers() const;
+
+  // Allocates the caches as aligned slices of one zeroed buffer, which is returned.
+  void* AllocateCacheSlab(std::vector<void*>& cacheBuffers) const;
+
   size_t GetCacheStrideSize() const;
 
   size_t GetCacheNumRows() const;
@@ -87,13 +132,8 @@ private:
 
   size_t GetRightPadding() const;
 
-  void PaddingPostprocess();
-
-  virtual void LeftPaddingCachePostprocess();
-
-  virtual void RightPaddingCachePostprocess();
-
-  virtual void RollbackCache(const size_t rollbackTokCount, const size_t numSeenToken);
+  // Record the cache entries of the non-padded input tokens of the last run.
+  void UpdateCache();
 
 private:
   void CheckIoCount();
@@ -116,6 +156,23 @@ private:
   const size_t kCacheLength;
   const size_t kCacheTypeSize;
 
+  // Ring buffer cache, whose first kCacheSinkSize entries are never evicted.
+  const bool kRingCache;
+  const size_t kCacheSinkSize;
+
+  // Keep generating past kMaxTokenLength, once the ring cache is full the sink entries and a
+  // sliding window of the latest entries remain.
+  const bool kStreaming;
+
+  // Slice all the caches of a cache set out of one buffer, so that the cache manager resets,
+  // saves and restores them as one span. The ring cache outputs remain separate buffers.
+  const bool kContiguousCache;
+  // The cache slab of the selected cache set, null without kContiguousCache.
+  void* mCacheSlab = nullptr;
+
+  // Tracks the valid cache entries. Created once the cache buffers are allocated.
+  std::unique_ptr<KVCacheManager> mCacheManager;
+
   // Mask
   const LLMType kMaskType;
 
@@ -126,12 +183,24 @@ private:
 
   // Lookup table for rotary embedding
   const RotaryEmbeddingMasterLut* kRotEmbMasterLut;
+  bool mIsRotEmbOwner = true;
 
-  // Mask builder
+  // Mask builder. Not created if the mask is shared from another chunk.
   std::unique_ptr<MaskBuilder> mMaskBuilder;
+  bool mIsMaskOwner = true;
 
   // Keep track of token index. Its value can also be viewed as numSeenToken.
   size_t mCurrentTokenIndex = 0;
+
+  // Cache sets. The entry of the selected cache set is only updated when switching away from it.
+  struct CacheSet {
+    std::vector<void*> buffers;
+    size_t tokenIndex = 0;
+    KVCacheManager::State cacheState;
+    void* slab = nullptr; // The buffer the caches are sliced from, if any
+  };
+  std::vector<CacheSet> mCacheSets;
+  size_t mCurrentCacheSet = 0;
 };
 
 } // namespace torch::executor
\ No newline at end of file
@@ -6,20 +6,47 @@
  * directory of this source tree for more details.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <string>
 #include <vector>
-#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <executorch/runtime/platform/log.h>
 
+#include "executorch/backends/mediatek/runtime/include/NeuronBackend.h"
+
 #include "LlamaRuntime.h"
 #include "Utils.h"
+#include "WorkerPool.h"
 
 #include "llm_helper/include/rotary_embedding.h"
 #include "llm_helper/include/token_embedding.h"
 
 namespace torch::executor {
 
+namespace {
+
+// Cache snapshot layout: the header, the tokens, then the size and snapshot of each chunk.
+constexpr char kCacheSnapshotMagic[8] = {'L', 'L', 'M', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t kCacheSnapshotVersion = 1;
+
+struct CacheSnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t numChunk;
+  uint64_t numToken;
+};
+
+} // namespace
+
 void LlamaRuntime::Initialize(const LlamaModelOptions& modelOptions, const LlamaModelPaths& modelPaths) {
   mModelOptions = modelOptions;
   const size_t numChunk = modelPaths.gen_model_paths.size();
@@ -34,12 +61,37 @@ void LlamaRuntime::Initialize(const LlamaModelOptions& modelOptions, const Llama
       rotEmbDim,
       modelOptions.rot_emb_base);
   mRotEmbMasterLut->generate();
+  if (modelOptions.streaming) {
+    ET_CHECK_MSG(modelOptions.ring_cache, "Streaming generation requires the ring cache");
+    mRotEmbMasterLut->enableExtrapolation();
+  }
 
   constexpr size_t numRotEmbInputs = 1;
   const bool usePromptModel = !modelPaths.prompt_model_paths.empty();
   const size_t initBatchSize = usePromptModel ? modelOptions.prompt_token_batch_size : 1;
   mTokenBatchSize = initBatchSize;
 
+  // Available token batch sizes for digesting the prompt, in descending order
+  mPromptBatchSizes.clear();
+  if (usePromptModel)
+    mPromptBatchSizes.push_back(modelOptions.prompt_token_batch_size);
+  for (const auto& [batchSize, extraPromptModelPaths] : modelPaths.extra_prompt_model_paths) {
+    ET_CHECK_MSG(
+        usePromptModel && batchSize > 1 && batchSize < modelOptions.prompt_token_batch_size,
+        "Extra prompt token batch size %zu must be within (1, %zu)",
+        batchSize,
+        modelOptions.prompt_token_batch_size);
+    ET_CHECK_MSG(
+        extraPromptModelPaths.size() == numChunk,
+        "Number of %zu-token prompt models (%zu) != number of chunks (%zu)",
+        batchSize,
+        extraPromptModelPaths.size(),
+        numChunk);
+    mPromptBatchSizes.push_back(batchSize);
+  }
+  mPromptBatchSizes.push_back(1);
+  std::sort(mPromptBatchSizes.begin(), mPromptBatchSizes.end(), std::greater<>());
+
   for (size_t chunkIdx = 0; chunkIdx < numChunk; chunkIdx++) {
     ModelPathMap modelPathMap;
     auto addModelPath = [&](const auto& modelPaths, const size_t batchSize) {
@@ -48,32 +100,56 @@ void LlamaRuntime::Initialize(const LlamaModelOptions& modelOptions, const Llama
       modelPathMap[batchSize] = modelPaths[chunkIdx];
     };
     addModelPath(modelPaths.prompt_model_paths, modelOptions.prompt_token_batch_size);
+    for (const auto& [batchSize, extraPromptModelPaths] : modelPaths.extra_prompt_model_paths)
+      addModelPath(extraPromptModelPaths, batchSize);
     addModelPath(modelPaths.gen_model_paths, 1);
     auto llamaChunk = new LlamaModelChunk(
         modelPathMap, modelOptions, initBatchSize, numCache, numRotEmbInputs, mRotEmbMasterLut);
+    llamaChunk->SetModelMemoryBudget((modelOptions.model_memory_budget_mb << 20) / numChunk);
     mLlamaModelChunks.push_back(llamaChunk);
   }
 
+  // Load the chunk models in parallel, then link and initialize the chunks in order.
+  mWorkerPool = std::make_unique<WorkerPool>(numChunk);
+  mWorkerPool->ParallelFor(numChunk, [&](const size_t i) { mLlamaModelChunks[i]->Preload(); });
+
   for (size_t i = 0; i < numChunk; i++) {
     auto modelChunk = mLlamaModelChunks[i];
     if (i > 0) {
       const auto prevModelChunk = mLlamaModelChunks[i - 1];
       modelChunk->SetInputBuffer(prevModelChunk->GetOutputBuffer());
+      // All chunks see the same tokens, so they share the mask and rotary embedding inputs
+      // written by the first chunk.
+      auto llamaChunk = static_cast<LlamaModelChunk*>(modelChunk);
+      auto firstLlamaChunk = static_cast<LlamaModelChunk*>(mLlamaModelChunks.front());
+      llamaChunk->ShareMaskWith(firstLlamaChunk);
+      llamaChunk->ShareRotEmbWith(firstLlamaChunk);
     }
     modelChunk->Initialize();
     // modelChunk->LogIoSummary();
   }
 
-  // NOTE: Token embedding type here is assumed to follow the model input embedding type.
+  // NOTE: Token embedding type follows the model input embedding type unless specified.
+  const auto tokenEmbType = (modelOptions.token_embedding_type != LLMType::INVALID)
+                            ? modelOptions.token_embedding_type
+                            : modelOptions.model_input_type;
   mTokenEmbLut = new llm_helper::TokenEmbeddingLut(
-      modelPaths.token_embedding_path, modelOptions.model_input_type, modelOptions.hidden_size);
+      modelPaths.token_embedding_path,
+      tokenEmbType,
+      modelOptions.hidden_size,
+      modelOptions.mmap_token_embedding);
 
   // Link first chunk emb input to token emb lut output
   const auto& tokenEmbInput = mLlamaModelChunks.front()->GetInputBuffer();
-  mTokenEmbLut->setOutput(tokenEmbInput.data, tokenEmbInput.nbytes);
+  mTokenEmbLut->setOutput(
+      tokenEmbInput.data,
+      tokenEmbInput.nbytes,
+      modelOptions.model_input_type,
+      modelOptions.model_input_qscale);
 }
 
 void LlamaRuntime::Release() {
+  WaitPreload();
   for (auto llamaChunk : mLlamaModelChunks) {
     llamaChunk->Release();
     delete llamaChunk;
@@ -81,6 +157,7 @@ void LlamaRuntime::Release() {
   mLlamaModelChunks.clear();
   delete mRotEmbMasterLut;
   delete mTokenEmbLut;
+  mWorkerPool.reset();
 }
 
 void LlamaRuntime::SwapModel(const size_t batchSize) {
@@ -90,16 +167,97 @@ void LlamaRuntime::SwapModel(const size_t batchSize) {
       ET_LOG(Error, "Hot swapping failed on chunk %zu", chunkIdx);
   };
 
-  // Use multi-threading to speedup model swapping
-  std::vector<std::thread> threads;
-  for (size_t i = 0; i < mLlamaModelChunks.size(); i++)
-    threads.emplace_back(hotSwapChunk, i);
-  for (size_t i = 0; i < mLlamaModelChunks.size(); i++)
-    threads[i].join();
+  // A preload in flight must finish before the chunks select the model.
+  WaitPreload();
+
+  if (AllModelsResident()) {
+    // Only the model IOs are rebound, which is cheaper than dispatching to the workers.
+    for (size_t i = 0; i < mLlamaModelChunks.size(); i++)
+      hotSwapChunk(i);
+    mTokenBatchSize = batchSize;
+    return;
+  }
+
+  // Use the chunk workers to speedup model swapping
+  mWorkerPool->ParallelFor(mLlamaModelChunks.size(), hotSwapChunk);
 
   mTokenBatchSize = batchSize;
 }
 
+void LlamaRuntime::PreloadModel(const size_t batchSize) {
+  if (AllModelsResident() || batchSize == mTokenBatchSize) {
+    return;
+  }
+  WaitPreload();
+  for (auto modelChunk : mLlamaModelChunks) {
+    mPreloadFutures.push_back(
+        mWorkerPool->Submit([modelChunk, batchSize] { modelChunk->PreloadModel(batchSize); }));
+  }
+}
+
+bool LlamaRuntime::AllModelsResident() const {
+  return mModelOptions.load_all_models && mModelOptions.model_memory_budget_mb == 0;
+}
+
+void LlamaRuntime::WaitPreload() {
+  for (auto& future : mPreloadFutures) {
+    future.get();
+  }
+  mPreloadFutures.clear();
+}
+
+std::vector<PromptPass> LlamaRuntime::PlanPromptPasses(const size_t numPromptToken) const {
+  // Every pass also streams all the weights, which is accounted as the compute of
+  // kPassOverheadTokens tokens. If the models of different batch sizes are not kept loaded, each
+  // swap reloads them, which dominates the cost of a few padded tokens.
+  constexpr size_t kPassOverheadTokens = 32;
+  const size_t swapCost = AllModelsResident() ? 0 : mModelOptions.prompt_token_batch_size;
+
+  // minCost[n]: the minimum cost of digesting n tokens, lastBatchSize[n]: the batch size of the
+  // pass achieving it. A pass of batch size b covers min(b, n) tokens, so padding only happens in
+  // the pass that covers the last remaining tokens. A swap is charged whenever the batch size
+  // differs from the previous pass, an upper bound since the passes are grouped by size below.
+  std::vector<size_t> minCost(numPromptToken + 1, 0);
+  std::vector<size_t> lastBatchSize(numPromptToken + 1, 0);
+  for (size_t n = 1; n <= numPromptToken; n++) {
+    minCost[n] = SIZE_MAX;
+    for (const auto batchSize : mPromptBatchSizes) {
+      const size_t remain = n > batchSize ? n - batchSize : 0;
+      const bool isNewBatchSize = (remain == 0 || lastBatchSize[remain] != batchSize);
+      const size_t cost = minCost[remain] + batchSize + kPassOverheadTokens
+                          + (isNewBatchSize ? swapCost : 0);
+      if (cost < minCost[n]) {
+        minCost[n] = cost;
+        lastBatchSize[n] = batchSize;
+      }
+    }
+  }
+
+  // The padded pass goes first so that it is left-padded on a fresh cache, then the passes in
+  // descending batch size order to swap each model at most once, ending near the gen model.
+  std::vector<PromptPass> passes;
+  size_t n = numPromptToken;
+  while (n > 0) {
+    const size_t batchSize = lastBatchSize[n];
+    const size_t numToken = std::min(batchSize, n);
+    passes.push_back({batchSize, numToken});
+    n -= numToken;
+  }
+  auto paddedFirst = [](const PromptPass& a, const PromptPass& b) {
+    const bool aPadded = a.numToken < a.batchSize;
+    const bool bPadded = b.numToken < b.batchSize;
+    if (aPadded != bPadded)
+      return aPadded;
+    return a.batchSize > b.batchSize;
+  };
+  std::sort(passes.begin(), passes.end(), paddedFirst);
+  return passes;
+}
+
+const std::vector<size_t>& LlamaRuntime::GetPromptBatchSizes() const {
+  return mPromptBatchSizes;
+}
+
 void LlamaRuntime::Reset() {
   for (auto modelChunk : mLlamaModelChunks) {
     static_cast<LlamaModelChunk*>(modelChunk)->Reset();
@@ -107,6 +265,13 @@ void LlamaRuntime::Reset() {
   mTokenIndex = 0;
 }
 
+void LlamaRuntime::Rollback(const size_t rollbackTokCount) {
+  for (auto modelChunk : mLlamaModelChunks) {
+    static_cast<LlamaModelChunk*>(modelChunk)->Rollback(rollbackTokCount);
+  }
+  mTokenIndex -= rollbackTokCount;
+}
+
 void* LlamaRuntime::Run(const std::vector<uint64_t>& inputTokens, const bool lastLogits) {
   const auto firstLlamaChunk = mLlamaModelChunks.front();
   const auto tokenIndex = static_cast<LlamaModelChunk*>(firstLlamaChunk)->GetTokenIndex();
@@ -139,22 +304,49 @@ void* LlamaRuntime::Run(const std::vector<uint64_t>& inputTokens, const bool las
   }
 
   // Begin inference flow
+  using Clock = std::chrono::steady_clock;
+  auto stageStart = Clock::now();
+  auto endStage = [&](double& stageSec) {
+    if (mIsProfiling) {
+      const auto now = Clock::now();
+      stageSec += std::chrono::duration<double>(now - stageStart).count();
+      stageStart = now;
+    }
+  };
+  mProfile.chunkSec.resize(mLlamaModelChunks.size());
+  mProfile.numRuns += mIsProfiling;
 
   // Lookup token embedding
   mTokenEmbLut->lookupEmbedding(curInputTokens);
-
-  // Decoder chunks
-  for (auto modelChunk : mLlamaModelChunks) {
-    auto llamaChunk = static_cast<LlamaModelChunk*>(modelChunk);
-
-    // Set padding if needed.
-    if (isLeftPadAllowed)
-      llamaChunk->SetLeftPadding(padSize);
-    else
-      llamaChunk->SetRightPadding(padSize);
-
-    // Run model chunk
-    llamaChunk->Run();
+  endStage(mProfile.embeddingSec);
+
+  // Decoder chunks. The Neuron executions are submitted asynchronously whatever the chunks were
+  // compiled with: they are chained on the APU, and the CPU prepares the mask and rotary embedding
+  // of each chunk while the previous one executes, then waits once per step.
+  {
+    auto options = neuron::GetExecutionOptions();
+    options.mAsync = true;
+    const neuron::ScopedExecutionOptions asyncExecutions(options);
+    for (size_t chunkIdx = 0; chunkIdx < mLlamaModelChunks.size(); chunkIdx++) {
+      auto llamaChunk = static_cast<LlamaModelChunk*>(mLlamaModelChunks[chunkIdx]);
+
+      // Set padding if needed.
+      if (isLeftPadAllowed)
+        llamaChunk->SetLeftPadding(padSize);
+      else
+        llamaChunk->SetRightPadding(padSize);
+
+      // Run model chunk
+      llamaChunk->StartRun();
+      endStage(mProfile.chunkSec[chunkIdx]);
+    }
+  }
+  const auto status = neuron::WaitForAsyncExecutions();
+  ET_CHECK_MSG(status == Error::Ok, "Asynchronous execution failed with status 0x%" PRIx32, status);
+  endStage(mProfile.waitSec);
+  for (size_t chunkIdx = 0; chunkIdx < mLlamaModelChunks.size(); chunkIdx++) {
+    static_cast<LlamaModelChunk*>(mLlamaModelChunks[chunkIdx])->FinishRun();
+    endStage(mProfile.chunkSec[chunkIdx]);
   }
 
   mTokenIndex += inputTokens.size(); // Only consider valid tokens by ignoring padding
@@ -173,6 +365,158 @@ void* LlamaRuntime::Run(const std::vector<uint64_t>& inputTokens, const bool las
   return logitsData + offset;
 }
 
+std::vector<uint8_t> LlamaRuntime::SaveCacheSnapshot(const std::vector<uint64_t>& tokens) const {
+  ET_CHECK_MSG(
+      tokens.size() == mTokenIndex,
+      "Snapshot token count (%zu) != token index (%zu)",
+      tokens.size(),
+      mTokenIndex);
+
+  size_t snapshotSize = sizeof(CacheSnapshotHeader) + tokens.size() * sizeof(uint64_t);
+  for (const auto modelChunk : mLlamaModelChunks) {
+    const auto llamaChunk = static_cast<const LlamaModelChunk*>(modelChunk);
+    snapshotSize += sizeof(uint64_t) + llamaChunk->GetCacheSnapshotSize();
+  }
+
+  std::vector<uint8_t> snapshot(snapshotSize);
+  auto dst = snapshot.data();
+  CacheSnapshotHeader header = {
+    .version = kCacheSnapshotVersion,
+    .numChunk = static_cast<uint32_t>(mLlamaModelChunks.size()),
+    .numToken = tokens.size()
+  };
+  std::memcpy(header.magic, kCacheSnapshotMagic, sizeof(header.magic));
+  std::memcpy(dst, &header, sizeof(header));
+  dst += sizeof(header);
+  std::memcpy(dst, tokens.data(), tokens.size() * sizeof(uint64_t));
+  dst += tokens.size() * sizeof(uint64_t);
+
+  for (const auto modelChunk : mLlamaModelChunks) {
+    const auto llamaChunk = static_cast<const LlamaModelChunk*>(modelChunk);
+    const uint64_t chunkSnapshotSize = llamaChunk->GetCacheSnapshotSize();
+    std::memcpy(dst, &chunkSnapshotSize, sizeof(chunkSnapshotSize));
+    dst += sizeof(chunkSnapshotSize);
+    llamaChunk->SaveCacheSnapshot(dst);
+    dst += chunkSnapshotSize;
+  }
+  return snapshot;
+}
+
+bool LlamaRuntime::SaveCacheSnapshot(
+    const std::string& path, const std::vector<uint64_t>& tokens) const {
+  const auto snapshot = SaveCacheSnapshot(tokens);
+  const auto tmpPath = path + ".tmp";
+  std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(snapshot.data()), snapshot.size());
+  file.close();
+  if (!file || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    ET_LOG(Error, "Failed to write cache snapshot: %s", path.c_str());
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  ET_LOG(Info, "Saved cache snapshot of %zu tokens: %s", tokens.size(), path.c_str());
+  return true;
+}
+
+size_t LlamaRuntime::LoadCacheSnapshot(
+    const void* data, const size_t size, const std::vector<uint64_t>& inputTokens) {
+  auto src = reinterpret_cast<const uint8_t*>(data);
+  const auto srcEnd = src + size;
+
+  CacheSnapshotHeader header;
+  if (size < sizeof(header)) {
+    return 0;
+  }
+  std::memcpy(&header, src, sizeof(header));
+  src += sizeof(header);
+  if (std::memcmp(header.magic, kCacheSnapshotMagic, sizeof(header.magic)) != 0
+      || header.version != kCacheSnapshotVersion
+      || header.numChunk != mLlamaModelChunks.size()) {
+    ET_LOG(Info, "Cache snapshot was taken from a different model, ignored.");
+    return 0;
+  }
+
+  // Only restore when the snapshot tokens are a prefix of the input tokens
+  const size_t numToken = header.numToken;
+  if (numToken == 0 || numToken > inputTokens.size()
+      || numToken * sizeof(uint64_t) > static_cast<size_t>(srcEnd - src)
+      || std::memcmp(src, inputTokens.data(), numToken * sizeof(uint64_t)) != 0) {
+    return 0;
+  }
+  src += numToken * sizeof(uint64_t);
+
+  auto loadChunk = [&](LlamaModelChunk* llamaChunk) {
+    uint64_t chunkSnapshotSize = 0;
+    if (sizeof(chunkSnapshotSize) > static_cast<size_t>(srcEnd - src)) {
+      return false;
+    }
+    std::memcpy(&chunkSnapshotSize, src, sizeof(chunkSnapshotSize));
+    src += sizeof(chunkSnapshotSize);
+    if (chunkSnapshotSize > static_cast<size_t>(srcEnd - src)
+        || !llamaChunk->LoadCacheSnapshot(src, chunkSnapshotSize)) {
+      return false;
+    }
+    src += chunkSnapshotSize;
+    return llamaChunk->GetTokenIndex() == numToken;
+  };
+  for (auto modelChunk : mLlamaModelChunks) {
+    if (!loadChunk(static_cast<LlamaModelChunk*>(modelChunk))) {
+      ET_LOG(Error, "Invalid cache snapshot, the cache is reset.");
+      Reset();
+      return 0;
+    }
+  }
+  if (src != srcEnd) {
+    ET_LOG(Error, "Invalid cache snapshot size, the cache is reset.");
+    Reset();
+    return 0;
+  }
+  mTokenIndex = numToken;
+  return numToken;
+}
+
+size_t LlamaRuntime::LoadCacheSnapshot(
+    const std::string& path, const std::vector<uint64_t>& inputTokens) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+  const size_t size = st.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    ET_LOG(Error, "Failed to map cache snapshot: %s", path.c_str());
+    return 0;
+  }
+  const auto numRestored = LoadCacheSnapshot(data, size, inputTokens);
+  munmap(data, size);
+  if (numRestored > 0) {
+    ET_LOG(Info, "Restored cache snapshot of %zu tokens: %s", numRestored, path.c_str());
+  }
+  return numRestored;
+}
+
+size_t LlamaRuntime::AddCacheSet() {
+  size_t cacheSetId = 0;
+  for (auto modelChunk : mLlamaModelChunks) {
+    cacheSetId = static_cast<LlamaModelChunk*>(modelChunk)->AddCacheSet();
+  }
+  return cacheSetId;
+}
+
+void LlamaRuntime::SelectCacheSet(const size_t cacheSetId) {
+  for (auto modelChunk : mLlamaModelChunks) {
+    static_cast<LlamaModelChunk*>(modelChunk)->SelectCacheSet(cacheSetId);
+  }
+  const auto firstLlamaChunk = static_cast<LlamaModelChunk*>(mLlamaModelChunks.front());
+  mTokenIndex = firstLlamaChunk->GetTokenIndex();
+}
+
 size_t LlamaRuntime::GetTokenBatchSize() const {
   return mTokenBatchSize;
 }
@@ -185,4 +529,18 @@ const LlamaModelOptions& LlamaRuntime::GetModelOptions() const {
   return mModelOptions;
 }
 
+void LlamaRuntime::EnableProfiling(const bool enable) {
+  mIsProfiling = enable;
+  ResetProfile();
+}
+
+void LlamaRuntime::ResetProfile() {
+  mProfile = RunProfile();
+  mProfile.chunkSec.resize(mLlamaModelChunks.size());
+}
+
+const RunProfile& LlamaRuntime::GetProfile() const {
+  return mProfile;
+}
+
 } // namespace torch::executor
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -16,12 +18,30 @@
 #include "llm_helper/include/llm_types.h"
 #include "LlamaConfig.h"
 #include "LlamaModelChunk.h"
+#include "WorkerPool.h"
 
 #include "llm_helper/include/rotary_embedding.h"
 #include "llm_helper/include/token_embedding.h"
 
 namespace torch::executor {
 
+// A prompt pass running numToken tokens on the model of the given token batch size
+struct PromptPass {
+  size_t batchSize;
+  size_t numToken;
+};
+
+// Time spent in the stages of LlamaRuntime::Run() since profiling was enabled or reset. With
+// asynchronous Neuron execution the chunks run on the APU while waiting, so the chunk times only
+// cover their CPU side (mask, rotary embedding and cache updates). Otherwise they include the
+// chunk executions.
+struct RunProfile {
+  size_t numRuns = 0;
+  double embeddingSec = 0;
+  std::vector<double> chunkSec;
+  double waitSec = 0;
+};
+
 class LlamaRuntime {
 public:
   explicit LlamaRuntime() {}
@@ -33,16 +53,61 @@ public:
 
   void SwapModel(const size_t batchSize);
 
+  // Start loading the model of the given batch size on the chunk workers while the current model
+  // keeps running. The next SwapModel() to it waits for the preload instead of loading the model.
+  void PreloadModel(const size_t batchSize);
+
+  // Decompose the prompt into passes over the available prompt batch sizes, in execution order,
+  // trading padded tokens against the number of passes and model swaps.
+  std::vector<PromptPass> PlanPromptPasses(const size_t numPromptToken) const;
+
+  const std::vector<size_t>& GetPromptBatchSizes() const;
+
   void* Run(const std::vector<uint64_t>& inputTokens, const bool lastLogits = true);
 
   void Reset();
 
+  // Discard the last rollbackTokCount tokens seen by the model.
+  void Rollback(const size_t rollbackTokCount);
+
+  // Snapshot the caches and token index of all chunks after the given tokens have been run, so
+  // that a later prompt starting with the same tokens can skip digesting them.
+  std::vector<uint8_t> SaveCacheSnapshot(const std::vector<uint64_t>& tokens) const;
+
+  bool SaveCacheSnapshot(const std::string& path, const std::vector<uint64_t>& tokens) const;
+
+  // Restore a snapshot if its tokens are a prefix of inputTokens. Returns the number of restored
+  // tokens, or 0 if the snapshot does not match or is invalid. The file version maps the snapshot
+  // instead of reading it.
+  size_t LoadCacheSnapshot(
+      const void* data, const size_t size, const std::vector<uint64_t>& inputTokens);
+
+  size_t LoadCacheSnapshot(const std::string& path, const std::vector<uint64_t>& inputTokens);
+
+  // Add a cache set to all chunks for an independent sequence, see LlamaModelChunk::AddCacheSet.
+  size_t AddCacheSet();
+
+  void SelectCacheSet(const size_t cacheSetId);
+
   size_t GetTokenBatchSize() const;
 
   size_t GetTokenIndex() const;
 
   const LlamaModelOptions& GetModelOptions() const;
 
+  // Profile the stages of Run(), e.g. for benchmarking. Disabled by default.
+  void EnableProfiling(const bool enable = true);
+
+  void ResetProfile();
+
+  const RunProfile& GetProfile() const;
+
+private:
+  void WaitPreload();
+
+  // Whether the models of all batch sizes stay loaded, so that swapping only rebinds the IOs.
+  bool AllModelsResident() const;
+
 private:
   std::vector<ModelChunk*> mLlamaModelChunks; // Assuming embedding layer is part of the chunk
   LlamaModelOptions mModelOptions;
@@ -50,6 +115,14 @@ private:
   llm_helper::RotaryEmbeddingMasterLut* mRotEmbMasterLut = nullptr;
   size_t mTokenBatchSize = 1;
   size_t mTokenIndex = 0;
+  std::vector<size_t> mPromptBatchSizes = {1};
+
+  bool mIsProfiling = false;
+  RunProfile mProfile;
+
+  // One worker per chunk for initialization, model swapping and preloading
+  std::unique_ptr<WorkerPool> mWorkerPool;
+  std::vector<std::future<void>> mPreloadFutures;
 };
 
 } // namespace torch::executor
\ No newline at end of file
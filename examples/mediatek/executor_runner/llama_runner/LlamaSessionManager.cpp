@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <executorch/runtime/platform/log.h>
+
+#include "LlamaSessionManager.h"
+#include "Utils.h"
+
+namespace torch::executor {
+
+LlamaSessionManager::LlamaSessionManager(
+    LlamaRuntime& llamaRuntime,
+    const size_t vocabSize,
+    const uint64_t eosToken,
+    const size_t decodeRoundsPerPrefill)
+    : mLlamaRuntime(llamaRuntime),
+      kVocabSize(vocabSize),
+      kEosToken(eosToken),
+      kDecodeRoundsPerPrefill(decodeRoundsPerPrefill) {}
+
+size_t LlamaSessionManager::AddSession(
+    const std::vector<uint64_t>& promptTokens, const size_t maxResponse) {
+  ET_CHECK_MSG(!promptTokens.empty(), "Session prompt is empty");
+
+  Session session;
+  session.promptTokens = promptTokens;
+  session.maxResponse = maxResponse;
+
+  // Cache set 0 is the initial caches of the runtime, the first session takes it.
+  if (mSessions.empty()) {
+    session.cacheSetId = 0;
+  } else if (!mFreeCacheSets.empty()) {
+    session.cacheSetId = mFreeCacheSets.back();
+    mFreeCacheSets.pop_back();
+  } else {
+    session.cacheSetId = mLlamaRuntime.AddCacheSet();
+  }
+  mLlamaRuntime.SelectCacheSet(session.cacheSetId);
+  mLlamaRuntime.Reset();
+
+  mSessions.push_back(std::move(session));
+  return mSessions.size() - 1;
+}
+
+bool LlamaSessionManager::Step() {
+  auto anyOf = [&](auto pred) { return std::any_of(mSessions.begin(), mSessions.end(), pred); };
+  const bool hasPrefill = anyOf([](const Session& s) { return s.IsPrefilling(); });
+  const bool hasDecode = anyOf([](const Session& s) { return s.IsDecoding(); });
+
+  if (hasPrefill && (!hasDecode || mDecodeRoundCount >= kDecodeRoundsPerPrefill)) {
+    SwapModel(mLlamaRuntime.GetModelOptions().prompt_token_batch_size);
+    for (auto& session : mSessions) {
+      if (session.IsPrefilling()) {
+        PrefillStep(session);
+      }
+    }
+    mDecodeRoundCount = 0;
+  } else if (hasDecode) {
+    SwapModel(1);
+    for (auto& session : mSessions) {
+      if (session.IsDecoding()) {
+        DecodeStep(session);
+      }
+    }
+    mDecodeRoundCount++;
+  }
+
+  return anyOf([](const Session& s) { return !s.finished; });
+}
+
+bool LlamaSessionManager::IsFinished(const size_t sessionId) const {
+  return mSessions.at(sessionId).finished;
+}
+
+const std::vector<uint64_t>& LlamaSessionManager::GetResponseTokens(const size_t sessionId) const {
+  return mSessions.at(sessionId).responseTokens;
+}
+
+void LlamaSessionManager::PrefillStep(Session& session) {
+  mLlamaRuntime.SelectCacheSet(session.cacheSetId);
+
+  // Same split as digest_prompt: the remainder goes first so that only the first pass is padded.
+  const size_t batchSize = mLlamaRuntime.GetTokenBatchSize();
+  const size_t numRemain = session.promptTokens.size() - session.numDigestedToken;
+  const size_t remainder = numRemain % batchSize;
+  const size_t numNewToken = remainder ? remainder : batchSize;
+  const auto start = session.promptTokens.begin() + session.numDigestedToken;
+  const std::vector<uint64_t> tokens(start, start + numNewToken);
+
+  void* logits = mLlamaRuntime.Run(tokens);
+  session.numDigestedToken += numNewToken;
+  if (!session.IsPrefilling()) {
+    AddResponseToken(session, logits);
+  }
+}
+
+void LlamaSessionManager::DecodeStep(Session& session) {
+  mLlamaRuntime.SelectCacheSet(session.cacheSetId);
+  void* logits = mLlamaRuntime.Run({session.responseTokens.back()});
+  AddResponseToken(session, logits);
+}
+
+void LlamaSessionManager::AddResponseToken(Session& session, const void* logits) {
+  const auto logitsType = mLlamaRuntime.GetModelOptions().model_output_type;
+  const auto token = utils::argmax(logitsType, logits, kVocabSize);
+  session.responseTokens.push_back(token);
+
+  const auto& modelOptions = mLlamaRuntime.GetModelOptions();
+  const bool isCacheFull = !modelOptions.streaming
+                           && mLlamaRuntime.GetTokenIndex() >= modelOptions.max_token_length;
+  if (token == kEosToken || session.responseTokens.size() > session.maxResponse || isCacheFull) {
+    session.finished = true;
+    mFreeCacheSets.push_back(session.cacheSetId);
+  }
+}
+
+void LlamaSessionManager::SwapModel(const size_t batchSize) {
+  if (mLlamaRuntime.GetTokenBatchSize() != batchSize) {
+    mLlamaRuntime.SwapModel(batchSize);
+  }
+}
+
+} // namespace torch::executor
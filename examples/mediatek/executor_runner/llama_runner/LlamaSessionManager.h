@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LlamaRuntime.h"
+
+namespace torch::executor {
+
+// Serves several concurrent sessions on one LlamaRuntime. Each session owns a cache set of the
+// runtime, and the scheduler interleaves the prefill passes and decode steps of the sessions.
+// Decode steps are grouped into rounds over all decoding sessions to limit the model swaps between
+// the prompt and the generative models.
+class LlamaSessionManager {
+public:
+  explicit LlamaSessionManager(
+      LlamaRuntime& llamaRuntime,
+      const size_t vocabSize,
+      const uint64_t eosToken,
+      const size_t decodeRoundsPerPrefill = 8);
+
+  // Add a session with greedy decoding. Returns the session id.
+  size_t AddSession(const std::vector<uint64_t>& promptTokens, const size_t maxResponse);
+
+  // Run one scheduling round. Returns whether any session is still active.
+  bool Step();
+
+  bool IsFinished(const size_t sessionId) const;
+
+  // Generated tokens so far, including the EOS token if generated.
+  const std::vector<uint64_t>& GetResponseTokens(const size_t sessionId) const;
+
+private:
+  struct Session {
+    std::vector<uint64_t> promptTokens;
+    std::vector<uint64_t> responseTokens;
+    size_t numDigestedToken = 0;
+    size_t maxResponse = 0;
+    size_t cacheSetId = 0;
+    bool finished = false;
+
+    bool IsPrefilling() const { return !finished && numDigestedToken < promptTokens.size(); }
+    bool IsDecoding() const { return !finished && numDigestedToken == promptTokens.size(); }
+  };
+
+  void PrefillStep(Session& session);
+
+  void DecodeStep(Session& session);
+
+  void AddResponseToken(Session& session, const void* logits);
+
+  void SwapModel(const size_t batchSize);
+
+private:
+  LlamaRuntime& mLlamaRuntime;
+  const size_t kVocabSize;
+  const uint64_t kEosToken;
+  const size_t kDecodeRoundsPerPrefill;
+
+  std::vector<Session> mSessions;
+
+  // Cache sets of finished sessions, reused by new sessions.
+  std::vector<size_t> mFreeCacheSets;
+
+  size_t mDecodeRoundCount = 0;
+};
+
+} // namespace torch::executor
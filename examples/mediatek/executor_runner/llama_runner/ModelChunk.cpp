@@ -11,6 +11,7 @@
 #include <sstream>
 
 #include "executorch/backends/mediatek/runtime/include/NeuronBufferAllocator.h"
+#include "executorch/backends/mediatek/runtime/include/NeuronMemoryAllocator.h"
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/evalue_util/print_evalue.h>
@@ -35,19 +36,27 @@ static constexpr size_t kMethodAllocatorPoolSize = 4 * 1024U * 1024U; // 4MB
 struct ModelInstance {
   std::unique_ptr<Program> program;
 
-  std::vector<std::unique_ptr<uint8_t[]>> planned_buffers;
-  std::vector<Span<uint8_t>> planned_spans;
+  // Backed by Neuron shared buffers so that the intermediate tensors between
+  // delegates are bound to the APU without copies.
+  std::unique_ptr<neuron::NeuronPlannedMemory> planned_memory;
 
   std::vector<uint8_t> method_allocator_pool;
   std::unique_ptr<MemoryAllocator> method_allocator;
-  std::unique_ptr<HierarchicalAllocator> planned_memory;
   std::unique_ptr<MemoryManager> memory_manager;
 
   std::unique_ptr<Method> method;
 };
 
-void ModelChunk::Initialize() {
+void ModelChunk::Preload() {
+  if (mIsPreloaded) {
+    return;
+  }
   LoadModels();
+  mIsPreloaded = true;
+}
+
+void ModelChunk::Initialize() {
+  Preload();
   GetModelIoInfo();
   AllocateIoBuffers();
   SetBackendInputs();
@@ -63,6 +72,7 @@ void ModelChunk::Release() {
   ENSURE_INIT
   ReleaseModels();
   ReleaseIoBuffers();
+  mIsPreloaded = false;
 }
 
 void ModelChunk::Run() {
@@ -123,6 +133,15 @@ bool ModelChunk::HotSwapModel(const size_t tokenBatchSize) {
   return true;
 }
 
+void ModelChunk::PreloadModel(const size_t tokenBatchSize) {
+  ENSURE_INIT
+  if (!HasModel(tokenBatchSize)) {
+    ET_LOG(Error, "Model preload: No model with batchSize=%zu is available", tokenBatchSize);
+    return;
+  }
+  MultiBatchSizeModelLoader::PreloadModel(tokenBatchSize);
+}
+
 void ModelChunk::SetInputBuffer(const void* data, const size_t size, const size_t index) {
   ENSURE_INIT
   auto& targetBufInfo = mInputBufferInfos[index];
@@ -491,26 +510,19 @@ void* ModelChunk::CreateModelInstance(const std::string& modelPath) {
   auto& method_allocator = modelInstance->method_allocator;
   method_allocator->enable_profiling("method allocator");
 
-  auto& planned_buffers = modelInstance->planned_buffers; // Owns the memory
-  auto& planned_spans = modelInstance->planned_spans; // Passed to the allocator
-
-  size_t num_memory_planned_buffers = method_meta->num_memory_planned_buffers();
-  for (size_t id = 0; id < num_memory_planned_buffers; ++id) {
-    // .get() will always succeed because id < num_memory_planned_buffers.
-    size_t buffer_size =
-        static_cast<size_t>(method_meta->memory_planned_buffer_size(id).get());
-    ET_LOG(Debug, "Setting up planned buffer %zu, size %zu.", id, buffer_size);
-    planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
-    planned_spans.push_back({planned_buffers.back().get(), buffer_size});
-  }
-  modelInstance->planned_memory = std::make_unique<HierarchicalAllocator>(
-      Span<Span<uint8_t>>{planned_spans.data(), planned_spans.size()});
-  auto& planned_memory = modelInstance->planned_memory;
+  auto planned_memory_result = neuron::NeuronPlannedMemory::Create(*method_meta);
+  ET_CHECK_MSG(
+      planned_memory_result.ok(),
+      "Failed to allocate planned memory for method %s: 0x%" PRIx32,
+      method_name,
+      planned_memory_result.error());
+  modelInstance->planned_memory = std::move(planned_memory_result.get());
+  auto planned_memory = modelInstance->planned_memory->get();
 
   // Assemble all of the allocators into the MemoryManager that the Executor
   // will use.
   modelInstance->memory_manager = std::make_unique<MemoryManager>(
-      method_allocator.get(), planned_memory.get());
+      method_allocator.get(), planned_memory);
   auto& memory_manager = modelInstance->memory_manager;
 
   ET_LOG(Debug, "Begin loading method %s", method_name);
@@ -37,6 +37,10 @@ public:
 
   ~ModelChunk() {}
 
+  // Load the models, the expensive part of Initialize(), so that chunks can be loaded in parallel.
+  // Initialize() then continues from the loaded models.
+  void Preload();
+
   virtual void Initialize();
 
   virtual void Release();
@@ -45,6 +49,14 @@ public:
 
   virtual bool HotSwapModel(const size_t tokenBatchSize);
 
+  // Load the model of the given batch size in the background of the current one, so that the next
+  // HotSwapModel() to it does not need to load it.
+  void PreloadModel(const size_t tokenBatchSize);
+
+  // Load the coexisting models on demand within the budget in bytes, see
+  // MultiModelLoader::SetMemoryBudget(). Must be set before Initialize().
+  void SetModelMemoryBudget(const size_t budget) { SetMemoryBudget(budget); }
+
   void SetInputBuffer(const void* data, const size_t size, const size_t index = 0);
 
   void SetInputBuffer(const BufferInfo& bufferInfo, const size_t index = 0);
@@ -92,11 +104,15 @@ private:
   void ReleaseModelInstance(void* modelInstance) override;
 
 private:
-  bool AllowModelsCoexist() const override { return false; }
+  bool AllowModelsCoexist() const override { return mAllowModelsCoexist; }
 
 protected:
   // State of initialization
   bool mIsInitialized = false;
+  bool mIsPreloaded = false;
+
+  // Keep the models of all batch sizes loaded. Must be set before Initialize().
+  bool mAllowModelsCoexist = false;
 
   // The number of input tokens the the fixed-shape model takes
   size_t mTokenBatchSize = 1;
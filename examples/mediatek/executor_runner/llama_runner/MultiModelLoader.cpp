@@ -16,6 +16,8 @@
 #include <unordered_map>
 #include <sstream>
 
+#include <sys/stat.h>
+
 namespace torch::executor {
 
 template <typename IdType>
@@ -36,6 +38,13 @@ void MultiModelLoader<IdType>::LoadModels() {
     ET_LOG(Debug, "LoadModels(): Loaded single exclusive model (Total=%zu)", numModels);
     return;
   }
+  if (LoadsOnDemand()) {
+    // Only the default model, the others are loaded when they are selected
+    mCurrentModelId = mDefaultModelId;
+    LoadOnDemand();
+    ET_LOG(Debug, "LoadModels(): Loaded the default model on demand (Total=%zu)", numModels);
+    return;
+  }
   for (const auto& [id, modelPath] : mModelPathMap) {
     SelectModel(id);
     ET_CHECK_MSG(
@@ -50,6 +59,10 @@ void MultiModelLoader<IdType>::LoadModels() {
 
 template <typename IdType>
 void MultiModelLoader<IdType>::ReleaseModels() {
+  if (mPreloadedInstance != nullptr) {
+    ReleaseModelInstance(mPreloadedInstance);
+    mPreloadedInstance = nullptr;
+  }
   if (!AllowModelsCoexist()) {
     // Select the current instance
     ReleaseModelInstance(GetModelInstance());
@@ -57,10 +70,10 @@ void MultiModelLoader<IdType>::ReleaseModels() {
     return;
   }
 
-  for (const auto& [id, _] : mModelInstanceMap) {
-    SelectModel(id);
-    ReleaseModelInstance(GetModelInstance());
-    SetModelInstance(nullptr);
+  // Not through SelectModel(), which would load the models that are loaded on demand
+  for (auto& [id, instance] : mModelInstanceMap) {
+    ReleaseModelInstance(instance);
+    instance = nullptr;
   }
 }
 
@@ -94,6 +107,9 @@ void MultiModelLoader<IdType>::SelectModel(const IdType& id) {
     return; // Do nothing
   } else if (AllowModelsCoexist()) {
     mCurrentModelId = id;
+    if (LoadsOnDemand()) {
+      LoadOnDemand();
+    }
     return;
   }
 
@@ -103,12 +119,101 @@ void MultiModelLoader<IdType>::SelectModel(const IdType& id) {
     SetModelInstance(nullptr);
   }
 
-  // Load new instance
+  // Load new instance, unless it has been preloaded
   mCurrentModelId = id;
-  void* newInstance = CreateModelInstance(mModelPathMap[id]);
+  void* newInstance = nullptr;
+  if (mPreloadedInstance != nullptr && mPreloadedModelId == id) {
+    newInstance = mPreloadedInstance;
+    mPreloadedInstance = nullptr;
+  } else {
+    newInstance = CreateModelInstance(mModelPathMap[id]);
+  }
   SetModelInstance(newInstance);
 }
 
+template <typename IdType>
+void MultiModelLoader<IdType>::PreloadModel(const IdType& id) {
+  ET_CHECK_MSG(HasModel(id), "Invalid id: %s", GetIdString(id).c_str());
+  if (id == mCurrentModelId || (AllowModelsCoexist() && !LoadsOnDemand())) {
+    return; // Already loaded
+  }
+  if (AllowModelsCoexist() && mModelInstanceMap.at(id) != nullptr) {
+    return; // Already loaded on demand
+  }
+  if (mPreloadedInstance != nullptr) {
+    if (mPreloadedModelId == id) {
+      return;
+    }
+    ReleaseModelInstance(mPreloadedInstance);
+  }
+  mPreloadedInstance = CreateModelInstance(mModelPathMap.at(id));
+  mPreloadedModelId = id;
+  ET_LOG(Debug, "Preloaded model %s", GetIdString(id).c_str());
+}
+
+template <typename IdType>
+void MultiModelLoader<IdType>::SetMemoryBudget(const size_t budget) {
+  mMemoryBudget = budget;
+}
+
+template <typename IdType>
+bool MultiModelLoader<IdType>::LoadsOnDemand() const {
+  return AllowModelsCoexist() && mMemoryBudget > 0;
+}
+
+template <typename IdType>
+void MultiModelLoader<IdType>::LoadOnDemand() {
+  const auto id = static_cast<IdType>(mCurrentModelId);
+  mLastSelected[id] = ++mNumSelections;
+  if (GetModelInstance() != nullptr) {
+    return;
+  }
+
+  // Release the least recently selected models until the new one fits. This happens before
+  // loading it so that the budget bounds the peak memory.
+  const size_t newModelSize = GetModelSize(id);
+  while (true) {
+    size_t loadedSize = 0;
+    const IdType* lruId = nullptr;
+    for (const auto& [loadedId, instance] : mModelInstanceMap) {
+      if (instance == nullptr) {
+        continue;
+      }
+      loadedSize += GetModelSize(loadedId);
+      if (lruId == nullptr || mLastSelected[loadedId] < mLastSelected[*lruId]) {
+        lruId = &loadedId;
+      }
+    }
+    if (lruId == nullptr || loadedSize + newModelSize <= mMemoryBudget) {
+      break;
+    }
+    ET_LOG(Debug, "Releasing least recently used model %s", GetIdString(*lruId).c_str());
+    ReleaseModelInstance(mModelInstanceMap[*lruId]);
+    mModelInstanceMap[*lruId] = nullptr;
+  }
+
+  void* newInstance = nullptr;
+  if (mPreloadedInstance != nullptr && mPreloadedModelId == id) {
+    newInstance = mPreloadedInstance;
+    mPreloadedInstance = nullptr;
+  } else {
+    newInstance = CreateModelInstance(mModelPathMap[id]);
+  }
+  SetModelInstance(newInstance);
+}
+
+template <typename IdType>
+size_t MultiModelLoader<IdType>::GetModelSize(const IdType& id) {
+  auto it = mModelSizes.find(id);
+  if (it == mModelSizes.end()) {
+    struct stat status;
+    const auto& modelPath = mModelPathMap.at(id);
+    const size_t size = (stat(modelPath.c_str(), &status) == 0) ? status.st_size : 0;
+    it = mModelSizes.emplace(id, size).first;
+  }
+  return it->second;
+}
+
 template <typename IdType>
 size_t MultiModelLoader<IdType>::GetNumModels() const {
   ET_CHECK_MSG(
@@ -134,9 +239,10 @@ void MultiModelLoader<IdType>::AddModel(const IdType& id, const std::string& mod
   }
   mModelPathMap[id] = modelPath;
 
-  // Create runtime immediately if can coexist
-  mModelInstanceMap[id] = AllowModelsCoexist()
-                          ? CreateModelInstance(mModelPathMap[mDefaultModelId])
+  // Create runtime immediately if can coexist, unless it is loaded on demand
+  mModelSizes.erase(id);
+  mModelInstanceMap[id] = (AllowModelsCoexist() && !LoadsOnDemand())
+                          ? CreateModelInstance(mModelPathMap[id])
                           : nullptr;
 }
 
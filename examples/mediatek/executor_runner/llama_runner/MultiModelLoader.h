@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -66,6 +67,17 @@ protected:
 
   bool HasModel(const IdType& id) const;
 
+  // Create the instance of a model ahead of SelectModel(), e.g. on another thread while the current
+  // model runs. Applies to the models that are loaded on demand, SelectModel() then takes the
+  // preloaded instance instead of loading it. Must not run concurrently with SelectModel().
+  void PreloadModel(const IdType& id);
+
+  // When models can coexist, load them on their first SelectModel() instead of in LoadModels(),
+  // and release the least recently selected ones once the loaded model files exceed the budget in
+  // bytes. The selected model is never released, and a preloaded instance may exceed the budget
+  // until it is selected. 0 to load all the models in LoadModels(). Must be set before LoadModels().
+  void SetMemoryBudget(const size_t budget);
+
   static std::string GetIdString(const IdType& id);
 
 private:
@@ -78,11 +90,30 @@ private:
   // Determine whether multiple models are allowed to be alive concurrently.
   virtual bool AllowModelsCoexist() const { return false; }
 
+  // Whether the coexisting models are loaded on demand within the memory budget.
+  bool LoadsOnDemand() const;
+
+  // Load the current model if it is not, releasing the least recently used ones to make room.
+  void LoadOnDemand();
+
+  // Size of the model file, which the memory budget accounts for.
+  size_t GetModelSize(const IdType& id);
+
 private:
   ModelPathMap mModelPathMap;
   ModelInstanceMap mModelInstanceMap;
   size_t mDefaultModelId = 0;
   size_t mCurrentModelId = 0;
+
+  // Instance created by PreloadModel() that has not been selected yet
+  void* mPreloadedInstance = nullptr;
+  IdType mPreloadedModelId = 0;
+
+  // Models loaded on demand
+  size_t mMemoryBudget = 0;
+  std::unordered_map<IdType, size_t> mModelSizes;
+  std::unordered_map<IdType, uint64_t> mLastSelected;
+  uint64_t mNumSelections = 0;
 };
 
 } // namespace torch::executor
\ No newline at end of file
@@ -16,6 +16,10 @@
 #include <regex>
 #include <chrono>
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace torch::executor {
 namespace utils {
 
@@ -62,12 +66,108 @@ static std::string read_file(const std::string& filepath) {
   return buffer.str();
 }
 
+#if defined(__aarch64__)
+namespace neon {
+
+// Largest of the first `count` logits, a multiple of 8.
+inline int16_t max(const int16_t* logits, const size_t count) {
+  int16x8_t result = vld1q_s16(logits);
+  for (size_t i = 8; i < count; i += 8) {
+    result = vmaxq_s16(result, vld1q_s16(logits + i));
+  }
+  return vmaxvq_s16(result);
+}
+
+inline __fp16 max(const __fp16* logits, const size_t count) {
+  float32x4_t result = vcvt_f32_f16(vld1_f16(logits));
+  for (size_t i = 0; i < count; i += 8) {
+    const float16x8_t values = vld1q_f16(logits + i);
+    result = vmaxq_f32(result, vcvt_f32_f16(vget_low_f16(values)));
+    result = vmaxq_f32(result, vcvt_high_f32_f16(values));
+  }
+  return static_cast<__fp16>(vmaxvq_f32(result));
+}
+
+inline float max(const float* logits, const size_t count) {
+  float32x4_t result = vld1q_f32(logits);
+  for (size_t i = 0; i < count; i += 8) {
+    result = vmaxq_f32(result, vld1q_f32(logits + i));
+    result = vmaxq_f32(result, vld1q_f32(logits + i + 4));
+  }
+  return vmaxvq_f32(result);
+}
+
+// Index of the first of the first `count` logits that equals `value`, or `count`.
+inline size_t find(const int16_t* logits, const size_t count, const int16_t value) {
+  const int16x8_t target = vdupq_n_s16(value);
+  for (size_t i = 0; i < count; i += 8) {
+    if (vmaxvq_u16(vceqq_s16(vld1q_s16(logits + i), target)) != 0) {
+      while (logits[i] != value) {
+        i++;
+      }
+      return i;
+    }
+  }
+  return count;
+}
+
+inline size_t find(const __fp16* logits, const size_t count, const __fp16 value) {
+  const float32x4_t target = vdupq_n_f32(static_cast<float>(value));
+  for (size_t i = 0; i < count; i += 8) {
+    const float16x8_t values = vld1q_f16(logits + i);
+    const uint32x4_t equal = vorrq_u32(vceqq_f32(vcvt_f32_f16(vget_low_f16(values)), target),
+                                       vceqq_f32(vcvt_high_f32_f16(values), target));
+    if (vmaxvq_u32(equal) != 0) {
+      while (logits[i] != value) {
+        i++;
+      }
+      return i;
+    }
+  }
+  return count;
+}
+
+inline size_t find(const float* logits, const size_t count, const float value) {
+  const float32x4_t target = vdupq_n_f32(value);
+  for (size_t i = 0; i < count; i += 8) {
+    const uint32x4_t equal = vorrq_u32(vceqq_f32(vld1q_f32(logits + i), target),
+                                       vceqq_f32(vld1q_f32(logits + i + 4), target));
+    if (vmaxvq_u32(equal) != 0) {
+      while (logits[i] != value) {
+        i++;
+      }
+      return i;
+    }
+  }
+  return count;
+}
+
+} // namespace neon
+#endif // defined(__aarch64__)
+
+// Index of the first largest logit, i.e. the greedy decoding of the logits. It runs on the raw
+// model output, so quantized logits need no dequantization: the scale preserves their order.
 template <typename LogitsType>
 static uint64_t argmax(const void* logits_buffer, const size_t vocab_size) {
   auto logits = reinterpret_cast<const LogitsType*>(logits_buffer);
   LogitsType max = logits[0];
   uint64_t index = 0;
-  for (size_t i = 1; i < vocab_size; i++) {
+  size_t begin = 1;
+#if defined(__aarch64__)
+  // Find the largest value 8 logits at a time, then the first logit that equals it. The scalar
+  // loop below handles the remainder, and the whole vocabulary if NaNs hide the largest value.
+  const size_t vectorized = vocab_size / 8 * 8;
+  if (vectorized > 0) {
+    const LogitsType vector_max = neon::max(logits, vectorized);
+    const size_t vector_index = neon::find(logits, vectorized, vector_max);
+    if (vector_index < vectorized) {
+      max = vector_max;
+      index = vector_index;
+      begin = vectorized;
+    }
+  }
+#endif
+  for (size_t i = begin; i < vocab_size; i++) {
     if (logits[i] > max) {
       max = logits[i];
       index = i;
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#include "WorkerPool.h"
+
+#include <executorch/runtime/platform/assert.h>
+
+namespace torch::executor {
+
+WorkerPool::WorkerPool(const size_t numWorkers) {
+  ET_CHECK_MSG(numWorkers > 0, "Worker pool requires at least one worker");
+  for (size_t i = 0; i < numWorkers; i++) {
+    mWorkers.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondVar.notify_all();
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+}
+
+std::future<void> WorkerPool::Submit(std::function<void()> task) {
+  std::packaged_task<void()> packagedTask(std::move(task));
+  auto future = packagedTask.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTasks.push(std::move(packagedTask));
+  }
+  mCondVar.notify_one();
+  return future;
+}
+
+void WorkerPool::ParallelFor(const size_t count, const std::function<void(size_t)>& task) {
+  std::vector<std::future<void>> futures;
+  futures.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    futures.push_back(Submit([&task, i] { task(i); }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+size_t WorkerPool::GetNumWorkers() const {
+  return mWorkers.size();
+}
+
+void WorkerPool::WorkerLoop() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondVar.wait(lock, [this] { return mStop || !mTasks.empty(); });
+      if (mStop && mTasks.empty()) {
+        return;
+      }
+      task = std::move(mTasks.front());
+      mTasks.pop();
+    }
+    task();
+  }
+}
+
+} // namespace torch::executor
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace torch::executor {
+
+// Fixed set of persistent worker threads running submitted tasks in FIFO order.
+class WorkerPool {
+public:
+  explicit WorkerPool(const size_t numWorkers);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Queue a task. The returned future becomes ready when the task has run.
+  std::future<void> Submit(std::function<void()> task);
+
+  // Run task(0) ... task(count - 1) on the workers and wait for all of them.
+  void ParallelFor(const size_t count, const std::function<void(size_t)>& task);
+
+  size_t GetNumWorkers() const;
+
+private:
+  void WorkerLoop();
+
+private:
+  std::vector<std::thread> mWorkers;
+  std::queue<std::packaged_task<void()>> mTasks;
+  std::mutex mMutex;
+  std::condition_variable mCondVar;
+  bool mStop = false;
+};
+
+} // namespace torch::executor
@@ -30,6 +30,11 @@ public:
     template <typename RotEmbType>
     void generate();
 
+    // Allow token indexes past the lookup table, whose rotary embeddings are then computed when
+    // they are set, e.g. to keep generating with a sliding window cache. Only the lookup table
+    // limits the positions for rotary embeddings, which encode relative positions.
+    void enableExtrapolation();
+
     virtual void setEmbed(std::vector<void*> rotEmbedBuffers, const size_t tokenIndex,
                           const size_t tokenBatchSize = 1, const size_t leftPadLength = 0,
                           const size_t rightPadLength = 0) const;
@@ -49,9 +54,19 @@ public:
     // The rotary embedding length is and determines the largest token size the model can handle
     size_t getRotEmbedLength() const;
 
+private:
+    template <typename RotEmbType>
+    void generateRow(const size_t pos, char* rowBuffer) const;
+
+    void generateRow(const size_t pos, char* rowBuffer) const;
+
+    // The lookup table row of pos, or the row generated into rowScratch past the lookup table.
+    const char* getRow(const size_t pos, std::vector<char>& rowScratch) const;
+
 private:
     char* mMasterLut; // byte flatten array
     bool mIsReady = false;
+    bool mIsExtrapolating = false;
 
     const LLMType kType;
     const size_t kTypeSize; // in bytes
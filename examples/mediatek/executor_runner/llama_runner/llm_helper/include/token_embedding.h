@@ -1,50 +1,68 @@
-/*
- * Copyright (c) 2024 MediaTek Inc.
- *
- * Licensed under the BSD License (the "License"); you may not use this file
- * except in compliance with the License. See the license file in the root
- * directory of this source tree for more details.
- */
-
-#pragma once
-
-#include "llm_types.h"
-
-#include <string>
-#include <vector>
-
-namespace torch::executor {
-namespace llm_helper {
-
-class TokenEmbeddingLut {
-public:
-    TokenEmbeddingLut(const std::string& tokenEmbLutPath, const LLMType tokenEmbLutType,
-                      const size_t hiddenSize);
-
-    ~TokenEmbeddingLut();
-
-    void setOutput(void* buffer, const size_t size);
-
-    void setOutput(void* buffer, const size_t size, const LLMType type, const float qscale = 0);
-
-    void lookupEmbedding(const std::vector<uint64_t>& tokens);
-
-private:
-    // Source lookup table
-    uint8_t* mLutBuffer = nullptr;
-    const LLMType kTokenEmbLutType;
-    const size_t kTokenEmbLutTypeSize;
-    const size_t kHiddenSize;
-    const size_t kLutRowSizeBytes;
-    size_t mVocabSize;
-
-    // Output write buffer
-    uint8_t* mOutputBuffer = nullptr;
-    size_t mOutputBufferSize = 0;
-    LLMType mTokenEmbOutputType;
-    size_t mTokenEmbOutputTypeSize;
-    float mTokenEmbQuantScale = 0;
-};
-
-} // namespace llm_helper
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#pragma once
+
+#include "llm_types.h"
+
+#include <executorch/extension/data_loader/mmap_data_loader.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torch::executor {
+namespace llm_helper {
+
+// Token embedding lookup table. INT8 and INT4 tables are quantized per row: each row is a float
+// scale followed by the hiddenSize quantized values, packed two per byte with the lower nibble
+// first for INT4. Quantized rows, and the rows of a floating point table of another type than the
+// output, are converted to the output type on lookup.
+class TokenEmbeddingLut {
+public:
+    // With useMmap, the table file is memory-mapped so that only the looked-up rows are paged in,
+    // instead of reading the whole table into memory upfront.
+    TokenEmbeddingLut(const std::string& tokenEmbLutPath, const LLMType tokenEmbLutType,
+                      const size_t hiddenSize, const bool useMmap = false);
+
+    ~TokenEmbeddingLut();
+
+    void setOutput(void* buffer, const size_t size);
+
+    void setOutput(void* buffer, const size_t size, const LLMType type, const float qscale = 0);
+
+    void lookupEmbedding(const std::vector<uint64_t>& tokens);
+
+private:
+    void loadLut(const std::string& tokenEmbLutPath);
+
+    void mmapLut(const std::string& tokenEmbLutPath);
+
+    void convertRow(const uint8_t* lutRow, uint8_t* outputRow) const;
+
+    // Source lookup table, either read into mLutBuffer or mapped by mLutLoader.
+    const uint8_t* mLutData = nullptr;
+    std::unique_ptr<uint8_t[]> mLutBuffer;
+    std::unique_ptr<util::MmapDataLoader> mLutLoader;
+    std::unique_ptr<FreeableBuffer> mLutMapping;
+    const LLMType kTokenEmbLutType;
+    const size_t kTokenEmbLutTypeSize;
+    const size_t kHiddenSize;
+    const size_t kLutRowSizeBytes;
+    size_t mVocabSize;
+
+    // Output write buffer
+    uint8_t* mOutputBuffer = nullptr;
+    size_t mOutputBufferSize = 0;
+    LLMType mTokenEmbOutputType;
+    size_t mTokenEmbOutputTypeSize;
+    float mTokenEmbQuantScale = 0;
+};
+
+} // namespace llm_helper
 } // namespace torch::executor
\ No newline at end of file
@@ -1,230 +1,271 @@
-/*
- * Copyright (c) 2024 MediaTek Inc.
- *
- * Licensed under the BSD License (the "License"); you may not use this file
- * except in compliance with the License. See the license file in the root
- * directory of this source tree for more details.
- */
-
-#include "llm_helper/include/mask_builder.h"
-
-#include <executorch/runtime/platform/log.h>
-#include <executorch/runtime/platform/assert.h>
-
-namespace torch::executor {
-namespace llm_helper {
-
-// Define mask values for different types
-template <typename T>
-struct MaskVal;
-
-#define __DECL_MASK__(TYPE, TRUE_VAL, FALSE_VAL) \
-template <>                                      \
-struct MaskVal<TYPE> {                           \
-    static constexpr TYPE kTrue = TRUE_VAL;      \
-    static constexpr TYPE kFalse = FALSE_VAL;    \
-};
-
-__DECL_MASK__(bool, true, false)
-__DECL_MASK__(int16_t, 0, -32768)
-__DECL_MASK__(__fp16,  0, -100)
-__DECL_MASK__(float,   0, -100)
-#undef __DECL_MASK__
-
-MaskBuilder::MaskBuilder(void* maskBuffer, const size_t maskSizeBytes, const LLMType maskType,
-                         const size_t cacheLength)
-    : mMaskBuffer(maskBuffer), mMaskSizeBytes(maskSizeBytes), kMaskType(maskType),
-      kMaskTypeSize(getLLMTypeSize(maskType)), kCacheLength(cacheLength) {}
-
-MaskBuilder::~MaskBuilder() {}
-
-void MaskBuilder::updateMaskSize(const size_t sizeBytes) {
-    mMaskSizeBytes = sizeBytes;
-}
-
-void MaskBuilder::markMaskDirty() {
-    mIsMaskUpdatable = false;
-}
-
-template <typename MaskType>
-void MaskBuilder::buildMask(const size_t tokenBatchSize, const size_t numSeenToken) {
-    constexpr auto maskTrue = MaskVal<MaskType>::kTrue;
-    constexpr auto maskFalse = MaskVal<MaskType>::kFalse;
-    const size_t maskLength = kCacheLength + tokenBatchSize;
-
-    // The mask is a combination (concat) of input cache mask and attention mask
-    const size_t startTrueIdx = kCacheLength - std::min(kCacheLength, numSeenToken);
-
-    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
-
-    const size_t expectedMaskSizeBytes = tokenBatchSize * maskLength * kMaskTypeSize;
-    // Use '<' instead of '!=' because mMaskSizeBytes may be padded by compiler to fit HW
-    if (mMaskSizeBytes < expectedMaskSizeBytes) {
-        ET_LOG(
-            Info,
-            "Warn: Model input mask size (%zu) < mask size to be built (%zu). "
-            "Please ensure your model options are set correctly.",
-            mMaskSizeBytes,
-            expectedMaskSizeBytes);
-    }
-
-    // There are tokenBatchSize number of rows
-    for (size_t inTokIdx = 0; inTokIdx < tokenBatchSize; inTokIdx++) {
-        const auto& rowIdx = inTokIdx; // For clarity
-        auto curMaskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer) + rowIdx * rowSize;
-        size_t i = 0; // Buffer write index
-
-        // Set the (rectangle) input cache mask
-        while (i < startTrueIdx) curMaskBuffer[i++] = maskFalse;
-        while (i < kCacheLength) curMaskBuffer[i++] = maskTrue;
-
-        // Set the (triangle) attention mask
-        const size_t attnTrueCount = inTokIdx + 1;
-        for (size_t counter = 0; counter < attnTrueCount; counter++) {
-            curMaskBuffer[i++] = maskTrue;
-        }
-        // Fill the remaining with False
-        while (i < maskLength) curMaskBuffer[i++] = maskFalse;
-    }
-
-    // Modify mask for padding if needed. Mask is not updatable if modified for padding.
-    mIsMaskUpdatable = !adjustMaskForPadding<MaskType>(tokenBatchSize);
-}
-
-template <typename MaskType>
-void MaskBuilder::updateMask(const size_t tokenBatchSize, const size_t numSeenToken,
-                             const size_t length) {
-    if (!mIsMaskUpdatable) {
-        buildMask<MaskType>(tokenBatchSize, numSeenToken);
-        return;
-    }
-
-    // Only set True for seen token
-    const size_t trueCount = std::min(length, numSeenToken);
-    if (!trueCount) {
-        // Modify mask for padding if needed. Mask is not updatable if modified for padding.
-        mIsMaskUpdatable = !adjustMaskForPadding<MaskType>(tokenBatchSize);
-        return;
-    }
-
-    // The mask is a combination (concat) of input cache mask and attention mask
-    auto maskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer);
-
-    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
-
-    // Only modify the left rectangle part
-    const size_t startTrueOffset = kCacheLength - std::min(kCacheLength, numSeenToken);
-    for (size_t inTokIdx = 0; inTokIdx < tokenBatchSize; inTokIdx++) {
-        const auto& rowIdx = inTokIdx; // For clarity
-        auto curMaskBuffer = maskBuffer + rowIdx * rowSize + startTrueOffset;
-        std::fill(curMaskBuffer, curMaskBuffer + trueCount, MaskVal<MaskType>::kTrue);
-    }
-    // Modify mask for padding if needed. Mask is not updatable if modified for padding.
-    mIsMaskUpdatable = !adjustMaskForPadding<MaskType>(tokenBatchSize);
-}
-
-void MaskBuilder::buildMask(const size_t tokenBatchSize, const size_t numSeenToken) {
-    switch (kMaskType) {
-        case LLMType::INT16:
-            buildMask<int16_t>(tokenBatchSize, numSeenToken);
-            return;
-        case LLMType::FP16:
-            buildMask<__fp16>(tokenBatchSize, numSeenToken);
-            return;
-        case LLMType::FP32:
-            buildMask<float>(tokenBatchSize, numSeenToken);
-            return;
-        default:
-            break;
-    }
-    ET_LOG(
-        Fatal,
-        "Attempting to build mask with type %s. Supported types are INT16, FP16, FP32.",
-        getLLMTypeName(kMaskType));
-}
-
-void MaskBuilder::updateMask(const size_t tokenBatchSize, const size_t numSeenToken,
-                             const size_t length) {
-    switch (kMaskType) {
-        case LLMType::INT16:
-            updateMask<int16_t>(tokenBatchSize, numSeenToken, length);
-            return;
-        case LLMType::FP16:
-            updateMask<__fp16>(tokenBatchSize, numSeenToken, length);
-            return;
-        case LLMType::FP32:
-            updateMask<float>(tokenBatchSize, numSeenToken, length);
-            return;
-        default:
-            break;
-    }
-    ET_LOG(
-        Fatal,
-        "Attempting to update with an unsupported mask type. "
-        "Supported types are INT16, FP16, FP32.");
-}
-
-void MaskBuilder::notifyLeftPadding(const size_t padLength) {
-    ET_CHECK_MSG(mRightPadLength == 0, "Attempting to set left pad after right pad has been set.");
-    if (mLeftPadLength > 0) {
-        ET_LOG(
-            Info,
-            "Warn: Calling notifyLeftPadding() multiple times before building/updating mask.");
-    }
-    mLeftPadLength = padLength;
-}
-
-void MaskBuilder::notifyRightPadding(const size_t padLength) {
-    ET_CHECK_MSG(mLeftPadLength == 0, "Attempting to set right pad after left pad has been set.");
-    if (mRightPadLength > 0) {
-        ET_LOG(
-            Info,
-            "Warn: Calling notifyLeftPadding() multiple times before building/updating mask.");
-    }
-    mRightPadLength = padLength;
-}
-
-template <typename MaskType>
-bool MaskBuilder::adjustMaskForPadding(const size_t tokenBatchSize) {
-    if (mLeftPadLength + mRightPadLength == 0) {
-        return false; // No need to modify mask since no padding
-    }
-    ET_DCHECK_MSG(
-        mLeftPadLength == 0 || mRightPadLength == 0,
-        "Only allow setting either left or right pad");
-    constexpr auto maskFalse = MaskVal<MaskType>::kFalse;
-    const size_t maskLength = kCacheLength + tokenBatchSize;
-
-    // The mask is a combination (concat) of input cache mask and attention mask
-    auto maskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer);
-
-    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
-
-    if (mLeftPadLength > 0) {
-        // Mask the padded rows
-        for (size_t inTokIdx = 0; inTokIdx < mLeftPadLength; inTokIdx++) {
-            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize;
-            std::fill(curMaskBuffer, curMaskBuffer + maskLength, maskFalse);
-        }
-        // Mask the padded attention region
-        for (size_t inTokIdx = mLeftPadLength; inTokIdx < tokenBatchSize; inTokIdx++) {
-            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize + kCacheLength;
-            // Anything from inTokIdx + 1 onwards is already False, so can skip them.
-            const size_t maskPadCount = std::min(mLeftPadLength, inTokIdx + 1);
-            std::fill(curMaskBuffer, curMaskBuffer + maskPadCount, maskFalse);
-        }
-        mLeftPadLength = 0; // Reset pad length
-    } else if (mRightPadLength > 0) {
-        // Mask the padded rows
-        const auto startIdx = tokenBatchSize - mRightPadLength;
-        for (size_t inTokIdx = startIdx; inTokIdx < tokenBatchSize; inTokIdx++) {
-            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize;
-            std::fill(curMaskBuffer, curMaskBuffer + maskLength, maskFalse);
-        }
-        mRightPadLength = 0; // Reset pad length
-    }
-    return true; // Mask is modified for padding
-}
-
-} // namespace llm_helper
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#include "llm_helper/include/mask_builder.h"
+
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/assert.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace torch::executor {
+namespace llm_helper {
+
+// Define mask values for different types
+template <typename T>
+struct MaskVal;
+
+#define __DECL_MASK__(TYPE, TRUE_VAL, FALSE_VAL) \
+template <>                                      \
+struct MaskVal<TYPE> {                           \
+    static constexpr TYPE kTrue = TRUE_VAL;      \
+    static constexpr TYPE kFalse = FALSE_VAL;    \
+};
+
+__DECL_MASK__(bool, true, false)
+__DECL_MASK__(int16_t, 0, -32768)
+__DECL_MASK__(__fp16,  0, -100)
+__DECL_MASK__(float,   0, -100)
+#undef __DECL_MASK__
+
+MaskBuilder::MaskBuilder(void* maskBuffer, const size_t maskSizeBytes, const LLMType maskType,
+                         const size_t cacheLength)
+    : mMaskBuffer(maskBuffer), mMaskSizeBytes(maskSizeBytes), kMaskType(maskType),
+      kMaskTypeSize(getLLMTypeSize(maskType)), kCacheLength(cacheLength) {}
+
+MaskBuilder::~MaskBuilder() {}
+
+void MaskBuilder::updateMaskSize(const size_t sizeBytes) {
+    mMaskSizeBytes = sizeBytes;
+}
+
+void MaskBuilder::markMaskDirty() {
+    mIsMaskUpdatable = false;
+}
+
+void MaskBuilder::setRingCacheState(const size_t startIdx, const size_t validCount,
+                                    const size_t sinkCount) {
+    mIsRingCache = true;
+    mRingSinkCount = std::min(sinkCount, kCacheLength);
+    const size_t ringLength = kCacheLength - mRingSinkCount;
+    mRingStartIdx = (ringLength > 0 && startIdx >= mRingSinkCount)
+                    ? mRingSinkCount + (startIdx - mRingSinkCount) % ringLength : mRingSinkCount;
+    mRingValidCount = std::min(validCount, ringLength);
+    mIsMaskUpdatable = false;
+}
+
+template <typename MaskType>
+void MaskBuilder::buildRow(MaskType* rowBuffer, const size_t inTokIdx, const size_t tokenBatchSize,
+                           const size_t numSeenToken) {
+    constexpr auto maskTrue = MaskVal<MaskType>::kTrue;
+    constexpr auto maskFalse = MaskVal<MaskType>::kFalse;
+    const size_t maskLength = kCacheLength + tokenBatchSize;
+
+    // Set the (rectangle) input cache mask
+    if (mIsRingCache) {
+        // The valid entries may wrap around the end of the cache, back to the end of the sinks
+        std::fill(rowBuffer, rowBuffer + kCacheLength, maskFalse);
+        std::fill(rowBuffer, rowBuffer + mRingSinkCount, maskTrue);
+        const size_t firstCount = std::min(mRingValidCount, kCacheLength - mRingStartIdx);
+        std::fill(rowBuffer + mRingStartIdx, rowBuffer + mRingStartIdx + firstCount, maskTrue);
+        const auto wrapBegin = rowBuffer + mRingSinkCount;
+        std::fill(wrapBegin, wrapBegin + mRingValidCount - firstCount, maskTrue);
+    } else {
+        const size_t startTrueIdx = kCacheLength - std::min(kCacheLength, numSeenToken);
+        std::fill(rowBuffer, rowBuffer + startTrueIdx, maskFalse);
+        std::fill(rowBuffer + startTrueIdx, rowBuffer + kCacheLength, maskTrue);
+    }
+
+    // Set the (triangle) attention mask, and fill the remaining with False
+    const size_t attnTrueCount = inTokIdx + 1;
+    std::fill(rowBuffer + kCacheLength, rowBuffer + kCacheLength + attnTrueCount, maskTrue);
+    std::fill(rowBuffer + kCacheLength + attnTrueCount, rowBuffer + maskLength, maskFalse);
+}
+
+template <typename MaskType>
+void MaskBuilder::buildMask(const size_t tokenBatchSize, const size_t numSeenToken) {
+    const size_t maskLength = kCacheLength + tokenBatchSize;
+
+    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
+
+    const size_t expectedMaskSizeBytes = tokenBatchSize * maskLength * kMaskTypeSize;
+    // Use '<' instead of '!=' because mMaskSizeBytes may be padded by compiler to fit HW
+    if (mMaskSizeBytes < expectedMaskSizeBytes) {
+        ET_LOG(
+            Info,
+            "Warn: Model input mask size (%zu) < mask size to be built (%zu). "
+            "Please ensure your model options are set correctly.",
+            mMaskSizeBytes,
+            expectedMaskSizeBytes);
+    }
+
+    // Build the first row. Every following row is the previous row with one more attention entry
+    // set to True, so copy whole rows instead of filling element by element.
+    auto maskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer);
+    buildRow(maskBuffer, 0, tokenBatchSize, numSeenToken);
+    for (size_t inTokIdx = 1; inTokIdx < tokenBatchSize; inTokIdx++) {
+        auto curMaskBuffer = maskBuffer + inTokIdx * rowSize;
+        std::memcpy(curMaskBuffer, curMaskBuffer - rowSize, maskLength * sizeof(MaskType));
+        curMaskBuffer[kCacheLength + inTokIdx] = MaskVal<MaskType>::kTrue;
+    }
+    mDirtyRowBegin = mDirtyRowEnd = 0;
+
+    // Modify mask for padding if needed. Left padding modifies the attention region of every row,
+    // so the mask is not updatable afterwards. Right padding only masks whole rows, which are
+    // rebuilt by the next update.
+    // The valid region of a ring cache moves every step, so its mask is never updatable.
+    const bool isLeftPadded = (mLeftPadLength > 0);
+    adjustMaskForPadding<MaskType>(tokenBatchSize);
+    mIsMaskUpdatable = !isLeftPadded && !mIsRingCache;
+}
+
+template <typename MaskType>
+void MaskBuilder::updateMask(const size_t tokenBatchSize, const size_t numSeenToken,
+                             const size_t length) {
+    // Left padding touches every row, so rebuild instead.
+    if (!mIsMaskUpdatable || mLeftPadLength > 0) {
+        buildMask<MaskType>(tokenBatchSize, numSeenToken);
+        return;
+    }
+
+    // The mask is a combination (concat) of input cache mask and attention mask
+    auto maskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer);
+
+    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
+
+    // Rebuild the rows masked out by the previous right padding
+    for (size_t inTokIdx = mDirtyRowBegin; inTokIdx < mDirtyRowEnd; inTokIdx++) {
+        buildRow(maskBuffer + inTokIdx * rowSize, inTokIdx, tokenBatchSize, numSeenToken);
+    }
+    mDirtyRowBegin = mDirtyRowEnd = 0;
+
+    // Only set True for the newly seen tokens, which are the columns left of the previous ones.
+    const size_t trueCount = std::min(length, numSeenToken);
+    if (trueCount > 0) {
+        // Only modify the left rectangle part
+        const size_t startTrueOffset = kCacheLength - std::min(kCacheLength, numSeenToken);
+        const size_t endTrueOffset = std::min(kCacheLength, startTrueOffset + trueCount);
+        for (size_t inTokIdx = 0; inTokIdx < tokenBatchSize; inTokIdx++) {
+            const auto& rowIdx = inTokIdx; // For clarity
+            auto curMaskBuffer = maskBuffer + rowIdx * rowSize;
+            std::fill(curMaskBuffer + startTrueOffset, curMaskBuffer + endTrueOffset,
+                      MaskVal<MaskType>::kTrue);
+        }
+    }
+    // Modify mask for padding if needed. Only right padding is possible here.
+    adjustMaskForPadding<MaskType>(tokenBatchSize);
+}
+
+void MaskBuilder::buildMask(const size_t tokenBatchSize, const size_t numSeenToken) {
+    switch (kMaskType) {
+        case LLMType::INT16:
+            buildMask<int16_t>(tokenBatchSize, numSeenToken);
+            return;
+        case LLMType::FP16:
+            buildMask<__fp16>(tokenBatchSize, numSeenToken);
+            return;
+        case LLMType::FP32:
+            buildMask<float>(tokenBatchSize, numSeenToken);
+            return;
+        default:
+            break;
+    }
+    ET_LOG(
+        Fatal,
+        "Attempting to build mask with type %s. Supported types are INT16, FP16, FP32.",
+        getLLMTypeName(kMaskType));
+}
+
+void MaskBuilder::updateMask(const size_t tokenBatchSize, const size_t numSeenToken,
+                             const size_t length) {
+    switch (kMaskType) {
+        case LLMType::INT16:
+            updateMask<int16_t>(tokenBatchSize, numSeenToken, length);
+            return;
+        case LLMType::FP16:
+            updateMask<__fp16>(tokenBatchSize, numSeenToken, length);
+            return;
+        case LLMType::FP32:
+            updateMask<float>(tokenBatchSize, numSeenToken, length);
+            return;
+        default:
+            break;
+    }
+    ET_LOG(
+        Fatal,
+        "Attempting to update with an unsupported mask type. "
+        "Supported types are INT16, FP16, FP32.");
+}
+
+void MaskBuilder::notifyLeftPadding(const size_t padLength) {
+    ET_CHECK_MSG(mRightPadLength == 0, "Attempting to set left pad after right pad has been set.");
+    if (mLeftPadLength > 0) {
+        ET_LOG(
+            Info,
+            "Warn: Calling notifyLeftPadding() multiple times before building/updating mask.");
+    }
+    mLeftPadLength = padLength;
+}
+
+void MaskBuilder::notifyRightPadding(const size_t padLength) {
+    ET_CHECK_MSG(mLeftPadLength == 0, "Attempting to set right pad after left pad has been set.");
+    if (mRightPadLength > 0) {
+        ET_LOG(
+            Info,
+            "Warn: Calling notifyLeftPadding() multiple times before building/updating mask.");
+    }
+    mRightPadLength = padLength;
+}
+
+template <typename MaskType>
+bool MaskBuilder::adjustMaskForPadding(const size_t tokenBatchSize) {
+    if (mLeftPadLength + mRightPadLength == 0) {
+        return false; // No need to modify mask since no padding
+    }
+    ET_DCHECK_MSG(
+        mLeftPadLength == 0 || mRightPadLength == 0,
+        "Only allow setting either left or right pad");
+    constexpr auto maskFalse = MaskVal<MaskType>::kFalse;
+    const size_t maskLength = kCacheLength + tokenBatchSize;
+
+    // The mask is a combination (concat) of input cache mask and attention mask
+    auto maskBuffer = reinterpret_cast<MaskType*>(mMaskBuffer);
+
+    const size_t rowSize = mMaskSizeBytes / tokenBatchSize / kMaskTypeSize;
+
+    if (mLeftPadLength > 0) {
+        // Mask the padded rows
+        for (size_t inTokIdx = 0; inTokIdx < mLeftPadLength; inTokIdx++) {
+            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize;
+            std::fill(curMaskBuffer, curMaskBuffer + maskLength, maskFalse);
+        }
+        // Mask the padded attention region
+        for (size_t inTokIdx = mLeftPadLength; inTokIdx < tokenBatchSize; inTokIdx++) {
+            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize + kCacheLength;
+            // Anything from inTokIdx + 1 onwards is already False, so can skip them.
+            const size_t maskPadCount = std::min(mLeftPadLength, inTokIdx + 1);
+            std::fill(curMaskBuffer, curMaskBuffer + maskPadCount, maskFalse);
+        }
+        mLeftPadLength = 0; // Reset pad length
+    } else if (mRightPadLength > 0) {
+        // Mask the padded rows, to be rebuilt by the next update
+        const auto startIdx = tokenBatchSize - mRightPadLength;
+        for (size_t inTokIdx = startIdx; inTokIdx < tokenBatchSize; inTokIdx++) {
+            auto curMaskBuffer = maskBuffer + inTokIdx * rowSize;
+            std::fill(curMaskBuffer, curMaskBuffer + maskLength, maskFalse);
+        }
+        mDirtyRowBegin = startIdx;
+        mDirtyRowEnd = tokenBatchSize;
+        mRightPadLength = 0; // Reset pad length
+    }
+    return true; // Mask is modified for padding
+}
+
+} // namespace llm_helper
 } // namespace torch::executor
\ No newline at end of file
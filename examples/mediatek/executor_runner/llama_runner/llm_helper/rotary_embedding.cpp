@@ -79,44 +79,13 @@ void RotaryEmbeddingMasterLut::load(const std::string& sinMasterPath,
     mIsReady = true;
 }
 
-// For float and __fp16
+// For float, __fp16 and int16
 template <typename RotEmbType>
 void RotaryEmbeddingMasterLut::generate() {
-    static_assert(std::is_same<RotEmbType, float>() || std::is_same<RotEmbType, __fp16>(),
-                  "Only int16/fp16/fp32 are supported for RotEmbType");
-    ET_LOG(Debug, "Generating floating rotary embedding lookup table");
-
-    const auto rowSize = kHeadDim * 2; // x2 for sin & cos
-    const size_t rotDim = kHeadDim;
-    const size_t rotDimHalf = rotDim / 2;
-
-    const float rotDimFp = static_cast<float>(kHeadDim);
-    const float base = (kNtkScale == 1.0f)
-                        ? kRotBase
-                        : std::powf(kRotBase * kNtkScale, rotDimFp/(rotDimFp - 2.0f));
-
-    for (int pos = 0; pos < kLength; pos++) { // row in lut
-        for (int dim = 0; dim < rotDimHalf; dim++) {
-            const float freq = float(pos) / std::powf(base, float(dim * 2) / rotDimFp);
-            const RotEmbType embCos = static_cast<RotEmbType>(std::cos(freq));
-            const RotEmbType embSin = static_cast<RotEmbType>(std::sin(freq));
-
-            const auto& row = pos;
-            const auto& col = dim; // At most kHeadDim / 2
-            auto masterLutCurPtr = reinterpret_cast<RotEmbType*>(mMasterLut) + row * rowSize + col;
-
-            // Concat Cos then Sin, and duplicate each
-            // Each row looks like this:
-            //   [<--cos--><--cos--><--sin--><--sin-->]
-            //    |        |        |        |
-            //    0    rotDimHalf   |        |
-            //                    rotDim     |
-            //                        rotDim + rotDimHalf
-            masterLutCurPtr[0                  ] = embCos;
-            masterLutCurPtr[         rotDimHalf] = embCos;
-            masterLutCurPtr[rotDim             ] = embSin;
-            masterLutCurPtr[rotDim + rotDimHalf] = embSin;
-        }
+    ET_LOG(Debug, "Generating %s rotary embedding lookup table", getLLMTypeName(kType));
+    const auto rowSizeBytes = 2 * kHeadDim * kTypeSize; // x2 for sin & cos
+    for (size_t pos = 0; pos < kLength; pos++) { // row in lut
+        generateRow<RotEmbType>(pos, mMasterLut + pos * rowSizeBytes);
     }
     mIsReady = true;
 }
@@ -124,11 +93,12 @@ void RotaryEmbeddingMasterLut::generate() {
 // NOTE: The difference between this and the Python script generated rotary embedding master lut
 // is the rounding mechanism during quantization to INT16. Python's Numpy library uses
 // round-to-even (banker's rounding) whereas the below C++ code uses round-to-nearest.
-template <>
-void RotaryEmbeddingMasterLut::generate<int16_t>() {
-    ET_LOG(Debug, "Generating int16 rotary embedding lookup table");
+template <typename RotEmbType>
+void RotaryEmbeddingMasterLut::generateRow(const size_t pos, char* rowBuffer) const {
+    static_assert(std::is_same<RotEmbType, float>() || std::is_same<RotEmbType, __fp16>()
+                      || std::is_same<RotEmbType, int16_t>(),
+                  "Only int16/fp16/fp32 are supported for RotEmbType");
 
-    const auto rowSize = kHeadDim * 2; // x2 for sin & cos
     const size_t rotDim = kHeadDim;
     const size_t rotDimHalf = rotDim / 2;
 
@@ -140,38 +110,71 @@ void RotaryEmbeddingMasterLut::generate<int16_t>() {
     // Minmax=(-1,1), so qscale = 1/32767
     const float qscale = 0.000030518509447574615;
 
-    auto quantFP32ToINT16 = [&](const float fpval) -> int16_t {
-        const int qmin = -32768; // -2^(outBitwidth-1)
-        const int qmax = +32767; // 2^(outBitwidth-1)-1
-        const int quantized = std::round(fpval / qscale);
-        const int clamped = std::max(qmin, std::min(quantized, qmax));
-        return clamped;
+    auto toRotEmbType = [&](const float fpval) -> RotEmbType {
+        if constexpr (std::is_same<RotEmbType, int16_t>()) {
+            const int qmin = -32768; // -2^(outBitwidth-1)
+            const int qmax = +32767; // 2^(outBitwidth-1)-1
+            const int quantized = std::round(fpval / qscale);
+            const int clamped = std::max(qmin, std::min(quantized, qmax));
+            return clamped;
+        } else {
+            return static_cast<RotEmbType>(fpval);
+        }
     };
 
-    for (int pos = 0; pos < kLength; pos++) { // row in lut
-        for (int dim = 0; dim < rotDimHalf; dim++) {
-            const float freq = float(pos) / std::powf(base, float(dim * 2) / rotDimFp);
-            const int16_t embCos = quantFP32ToINT16(std::cos(freq));
-            const int16_t embSin = quantFP32ToINT16(std::sin(freq));
-
-            const auto& row = pos;
-            const auto& col = dim; // At most kHeadDim / 2
-            auto masterLutCurPtr = reinterpret_cast<int16_t*>(mMasterLut) + row * rowSize + col;
-
-            // Concat Cos then Sin, and duplicate each
-            // Each row looks like this:
-            //   [<--cos--><--cos--><--sin--><--sin-->]
-            //    |        |        |        |
-            //    0    rotDimHalf   |        |
-            //                    rotDim     |
-            //                        rotDim + rotDimHalf
-            masterLutCurPtr[0                  ] = embCos;
-            masterLutCurPtr[         rotDimHalf] = embCos;
-            masterLutCurPtr[rotDim             ] = embSin;
-            masterLutCurPtr[rotDim + rotDimHalf] = embSin;
-        }
+    for (size_t dim = 0; dim < rotDimHalf; dim++) {
+        const float freq = float(pos) / std::powf(base, float(dim * 2) / rotDimFp);
+        const RotEmbType embCos = toRotEmbType(std::cos(freq));
+        const RotEmbType embSin = toRotEmbType(std::sin(freq));
+
+        const auto& col = dim; // At most kHeadDim / 2
+        auto rowCurPtr = reinterpret_cast<RotEmbType*>(rowBuffer) + col;
+
+        // Concat Cos then Sin, and duplicate each
+        // Each row looks like this:
+        //   [<--cos--><--cos--><--sin--><--sin-->]
+        //    |        |        |        |
+        //    0    rotDimHalf   |        |
+        //                    rotDim     |
+        //                        rotDim + rotDimHalf
+        rowCurPtr[0                  ] = embCos;
+        rowCurPtr[         rotDimHalf] = embCos;
+        rowCurPtr[rotDim             ] = embSin;
+        rowCurPtr[rotDim + rotDimHalf] = embSin;
     }
-    mIsReady = true;
+}
+
+void RotaryEmbeddingMasterLut::generateRow(const size_t pos, char* rowBuffer) const {
+    switch (kType) {
+        case LLMType::INT16:
+            generateRow<int16_t>(pos, rowBuffer);
+            return;
+        case LLMType::FP16:
+            generateRow<__fp16>(pos, rowBuffer);
+            return;
+        case LLMType::FP32:
+            generateRow<float>(pos, rowBuffer);
+            return;
+        default:
+            break;
+    }
+    ET_LOG(Fatal, "Rotary embedding generator not implemented for %s", getLLMTypeName(kType));
+}
+
+void RotaryEmbeddingMasterLut::enableExtrapolation() {
+    mIsExtrapolating = true;
+}
+
+const char* RotaryEmbeddingMasterLut::getRow(const size_t pos,
+                                             std::vector<char>& rowScratch) const {
+    const auto rowSizeBytes = 2 * kHeadDim * kTypeSize; // cos and sin
+    if (pos < kLength) {
+        return mMasterLut + pos * rowSizeBytes;
+    }
+    // Past the lookup table, only possible when extrapolating
+    rowScratch.resize(rowSizeBytes);
+    generateRow(pos, rowScratch.data());
+    return rowScratch.data();
 }
 
 void RotaryEmbeddingMasterLut::generate() {
@@ -230,7 +233,7 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedBuffer, const size_t token
     }
     const auto requestedMaxIndex = tokenIndex + tokenBatchSize - 1;
     const auto availableLength = getRotEmbedLength();
-    if (requestedMaxIndex >= availableLength) {
+    if (requestedMaxIndex >= availableLength && !mIsExtrapolating) {
         ET_LOG(
             Fatal,
             "Requested rotary embeddings (%zu) exceeds the max available (%zu) "
@@ -248,7 +251,7 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedBuffer, const size_t token
     const auto copySize = rowSizeBytesHalf;
 
     auto curRotEmbedBuffer = reinterpret_cast<char*>(rotEmbedBuffer);
-    const auto masterLutStart = reinterpret_cast<char*>(mMasterLut) + tokenIndex * rowSizeBytes;
+    std::vector<char> rowScratch;
 
     ET_DCHECK(tokenBatchSize >= leftPadLength + rightPadLength);
     const size_t numValidInputToken = tokenBatchSize - leftPadLength - rightPadLength;
@@ -261,7 +264,8 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedBuffer, const size_t token
 
     // cos
     for (size_t i = 0; i < numValidInputToken; i++) {
-        std::memcpy(curRotEmbedBuffer, masterLutStart + i * rowSizeBytes + cosOffset, copySize);
+        const auto row = getRow(tokenIndex + i, rowScratch);
+        std::memcpy(curRotEmbedBuffer, row + cosOffset, copySize);
         curRotEmbedBuffer += copySize;
     }
 
@@ -271,7 +275,8 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedBuffer, const size_t token
 
     // sin
     for (size_t i = 0; i < numValidInputToken; i++) {
-        std::memcpy(curRotEmbedBuffer, masterLutStart + i * rowSizeBytes + sinOffset, copySize);
+        const auto row = getRow(tokenIndex + i, rowScratch);
+        std::memcpy(curRotEmbedBuffer, row + sinOffset, copySize);
         curRotEmbedBuffer += copySize;
     }
 
@@ -292,7 +297,7 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedCosBuffer, void* rotEmbedS
     }
     const auto requestedMaxIndex = tokenIndex + tokenBatchSize - 1;
     const auto availableLength = getRotEmbedLength();
-    if (requestedMaxIndex >= availableLength) {
+    if (requestedMaxIndex >= availableLength && !mIsExtrapolating) {
         ET_LOG(
             Fatal,
             "Requested rotary embeddings (%zu) exceeds the max available (%zu) "
@@ -309,7 +314,7 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedCosBuffer, void* rotEmbedS
     const auto sinOffset = rowSizeBytesHalf;
     const auto copySize = rowSizeBytesHalf;
 
-    const auto masterLutStart = reinterpret_cast<char*>(mMasterLut) + tokenIndex * rowSizeBytes;
+    std::vector<char> rowScratch;
 
     auto curRotEmbedCosBuffer = reinterpret_cast<char*>(rotEmbedCosBuffer);
     auto curRotEmbedSinBuffer = reinterpret_cast<char*>(rotEmbedSinBuffer);
@@ -325,8 +330,9 @@ void RotaryEmbeddingMasterLut::setEmbed(void* rotEmbedCosBuffer, void* rotEmbedS
     curRotEmbedSinBuffer += leftPadSize;
 
     for (size_t i = 0; i < numValidInputToken; i++) {
-        std::memcpy(curRotEmbedCosBuffer, masterLutStart + i * rowSizeBytes + cosOffset, copySize);
-        std::memcpy(curRotEmbedSinBuffer, masterLutStart + i * rowSizeBytes + sinOffset, copySize);
+        const auto row = getRow(tokenIndex + i, rowScratch);
+        std::memcpy(curRotEmbedCosBuffer, row + cosOffset, copySize);
+        std::memcpy(curRotEmbedSinBuffer, row + sinOffset, copySize);
         curRotEmbedCosBuffer += copySize;
         curRotEmbedSinBuffer += copySize;
     }
@@ -1,107 +1,223 @@
-/*
- * Copyright (c) 2024 MediaTek Inc.
- *
- * Licensed under the BSD License (the "License"); you may not use this file
- * except in compliance with the License. See the license file in the root
- * directory of this source tree for more details.
- */
-
-#include "llm_types.h"
-#include "llm_helper/include/token_embedding.h"
-
-#include <executorch/runtime/platform/log.h>
-#include <executorch/runtime/platform/assert.h>
-
-#include <string>
-#include <fstream>
-#include <filesystem>
-
-namespace fs = std::filesystem;
-
-namespace torch::executor {
-namespace llm_helper {
-
-TokenEmbeddingLut::TokenEmbeddingLut(const std::string& tokenEmbLutPath,
-                                     const LLMType tokenEmbLutType, const size_t hiddenSize)
-    : kTokenEmbLutType(tokenEmbLutType),
-      kTokenEmbLutTypeSize(getLLMTypeSize(tokenEmbLutType)),
-      kHiddenSize(hiddenSize),
-      kLutRowSizeBytes(kHiddenSize * kTokenEmbLutTypeSize) {
-    std::ifstream file(tokenEmbLutPath, std::ios::binary);
-    if (!file) {
-        ET_LOG(Fatal, "Token embedding lookup table file not found: %s", tokenEmbLutPath.c_str());
-    }
-    ET_LOG(Debug, "Loading token embedding lookup table: %s", tokenEmbLutPath.c_str());
-
-    const size_t lutFileSize = fs::file_size(tokenEmbLutPath);
-
-    mVocabSize = lutFileSize / hiddenSize / kTokenEmbLutTypeSize;
-    ET_LOG(Debug, "TokenEmbeddingLut: Vocab size = %zu", mVocabSize);
-
-    mLutBuffer = new uint8_t [lutFileSize];
-
-    file.read(reinterpret_cast<char*>(mLutBuffer), lutFileSize);
-    ET_CHECK(file.gcount() == lutFileSize);
-}
-
-TokenEmbeddingLut::~TokenEmbeddingLut() {
-    if (mLutBuffer != nullptr) {
-        delete mLutBuffer;
-    }
-}
-
-void TokenEmbeddingLut::setOutput(void* buffer, const size_t size) {
-    setOutput(buffer, size, kTokenEmbLutType);
-}
-
-void TokenEmbeddingLut::setOutput(void* buffer, const size_t size, const LLMType type,
-                                  const float qscale) {
-    mOutputBuffer = reinterpret_cast<uint8_t*>(buffer);
-    mOutputBufferSize = size;
-    mTokenEmbOutputType = type;
-    mTokenEmbOutputTypeSize = getLLMTypeSize(type);
-    mTokenEmbQuantScale = qscale;
-}
-
-void TokenEmbeddingLut::lookupEmbedding(const std::vector<uint64_t>& tokens) {
-    const auto numTokens = tokens.size();
-    const size_t requiredOutputSize = numTokens * kHiddenSize * mTokenEmbOutputTypeSize;
-    if (mOutputBufferSize < requiredOutputSize) {
-        ET_LOG(
-            Error,
-            "Token embedding buffer size (%zu) is insufficient to hold embedding for %zu tokens "
-            "(requires %zu).",
-            mOutputBufferSize,
-            numTokens,
-            requiredOutputSize);
-        return;
-    }
-    if (mOutputBuffer == nullptr) {
-        ET_LOG(Error, "TokenEmbeddingLut: Output is not yet set for embedding lookup.");
-        return;
-    }
-
-    // Same type, so we can simply memcpy.
-    if (kTokenEmbLutType == mTokenEmbOutputType) {
-        size_t outputOffset = 0;
-        for (const auto token : tokens) {
-            // Copy one row from lookup table per token
-            ET_CHECK_MSG(token < mVocabSize, "Token id exceeds embedding lookup table range.");
-            const auto& rowIdx = token;
-            const size_t lutOffset = rowIdx * kLutRowSizeBytes;
-            std::memcpy(mOutputBuffer + outputOffset, mLutBuffer + lutOffset, kLutRowSizeBytes);
-            outputOffset += kLutRowSizeBytes;
-        }
-        return;
-    }
-
-    ET_LOG(
-        Fatal,
-        "Unimplemented: Mismatch between token embedding lookup table type (%s) "
-        "and model input embedding type (%s)",
-        getLLMTypeName(kTokenEmbLutType),
-        getLLMTypeName(mTokenEmbOutputType));
-}
-
-} // namespace llm_helper
+/*
+ * Copyright (c) 2024 MediaTek Inc.
+ *
+ * Licensed under the BSD License (the "License"); you may not use this file
+ * except in compliance with the License. See the license file in the root
+ * directory of this source tree for more details.
+ */
+
+#include "llm_types.h"
+#include "llm_helper/include/token_embedding.h"
+
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace torch::executor {
+namespace llm_helper {
+
+namespace {
+
+// Row size of the table in bytes, including the row scale of quantized tables.
+size_t getLutRowSize(const LLMType tokenEmbLutType, const size_t hiddenSize) {
+    switch (tokenEmbLutType) {
+        case LLMType::INT8:
+            return sizeof(float) + hiddenSize;
+        case LLMType::INT4:
+            return sizeof(float) + (hiddenSize + 1) / 2;
+        default:
+            return hiddenSize * getLLMTypeSize(tokenEmbLutType);
+    }
+}
+
+} // namespace
+
+TokenEmbeddingLut::TokenEmbeddingLut(const std::string& tokenEmbLutPath,
+                                     const LLMType tokenEmbLutType, const size_t hiddenSize,
+                                     const bool useMmap)
+    : kTokenEmbLutType(tokenEmbLutType),
+      kTokenEmbLutTypeSize(getLLMTypeSize(tokenEmbLutType)),
+      kHiddenSize(hiddenSize),
+      kLutRowSizeBytes(getLutRowSize(tokenEmbLutType, hiddenSize)) {
+    if (!fs::exists(tokenEmbLutPath)) {
+        ET_LOG(Fatal, "Token embedding lookup table file not found: %s", tokenEmbLutPath.c_str());
+    }
+    ET_LOG(Debug, "Loading token embedding lookup table: %s", tokenEmbLutPath.c_str());
+
+    const size_t lutFileSize = fs::file_size(tokenEmbLutPath);
+
+    mVocabSize = lutFileSize / kLutRowSizeBytes;
+    ET_LOG(Debug, "TokenEmbeddingLut: Vocab size = %zu", mVocabSize);
+
+    if (useMmap) {
+        mmapLut(tokenEmbLutPath);
+    } else {
+        loadLut(tokenEmbLutPath);
+    }
+}
+
+TokenEmbeddingLut::~TokenEmbeddingLut() {}
+
+void TokenEmbeddingLut::loadLut(const std::string& tokenEmbLutPath) {
+    std::ifstream file(tokenEmbLutPath, std::ios::binary);
+    const size_t lutFileSize = fs::file_size(tokenEmbLutPath);
+
+    mLutBuffer = std::make_unique<uint8_t[]>(lutFileSize);
+
+    file.read(reinterpret_cast<char*>(mLutBuffer.get()), lutFileSize);
+    ET_CHECK(file.gcount() == lutFileSize);
+    mLutData = mLutBuffer.get();
+}
+
+void TokenEmbeddingLut::mmapLut(const std::string& tokenEmbLutPath) {
+    // Pages are faulted in on lookup, so do not mlock the whole table.
+    auto loader = util::MmapDataLoader::from(
+        tokenEmbLutPath.c_str(), util::MmapDataLoader::MlockConfig::NoMlock);
+    ET_CHECK_MSG(loader.ok(), "Failed to open token embedding lookup table: %s",
+                 tokenEmbLutPath.c_str());
+    mLutLoader = std::make_unique<util::MmapDataLoader>(std::move(loader.get()));
+
+    const auto lutFileSize = mLutLoader->size();
+    ET_CHECK(lutFileSize.ok());
+    auto mapping = mLutLoader->Load(0, lutFileSize.get());
+    ET_CHECK_MSG(mapping.ok(), "Failed to map token embedding lookup table: %s",
+                 tokenEmbLutPath.c_str());
+    mLutMapping = std::make_unique<FreeableBuffer>(std::move(mapping.get()));
+    mLutData = reinterpret_cast<const uint8_t*>(mLutMapping->data());
+}
+
+void TokenEmbeddingLut::setOutput(void* buffer, const size_t size) {
+    setOutput(buffer, size, kTokenEmbLutType);
+}
+
+void TokenEmbeddingLut::setOutput(void* buffer, const size_t size, const LLMType type,
+                                  const float qscale) {
+    mOutputBuffer = reinterpret_cast<uint8_t*>(buffer);
+    mOutputBufferSize = size;
+    mTokenEmbOutputType = type;
+    mTokenEmbOutputTypeSize = getLLMTypeSize(type);
+    mTokenEmbQuantScale = qscale;
+}
+
+void TokenEmbeddingLut::lookupEmbedding(const std::vector<uint64_t>& tokens) {
+    const auto numTokens = tokens.size();
+    const size_t requiredOutputSize = numTokens * kHiddenSize * mTokenEmbOutputTypeSize;
+    if (mOutputBufferSize < requiredOutputSize) {
+        ET_LOG(
+            Error,
+            "Token embedding buffer size (%zu) is insufficient to hold embedding for %zu tokens "
+            "(requires %zu).",
+            mOutputBufferSize,
+            numTokens,
+            requiredOutputSize);
+        return;
+    }
+    if (mOutputBuffer == nullptr) {
+        ET_LOG(Error, "TokenEmbeddingLut: Output is not yet set for embedding lookup.");
+        return;
+    }
+
+    // Same type, so we can simply memcpy.
+    if (kTokenEmbLutType == mTokenEmbOutputType) {
+        size_t outputOffset = 0;
+        for (const auto token : tokens) {
+            // Copy one row from lookup table per token
+            ET_CHECK_MSG(token < mVocabSize, "Token id exceeds embedding lookup table range.");
+            const auto& rowIdx = token;
+            const size_t lutOffset = rowIdx * kLutRowSizeBytes;
+            std::memcpy(mOutputBuffer + outputOffset, mLutData + lutOffset, kLutRowSizeBytes);
+            outputOffset += kLutRowSizeBytes;
+        }
+        return;
+    }
+
+    // Quantized or floating point table of another type, convert the rows on the fly, e.g. the
+    // FP32 table of a model with FP16 activations.
+    const bool isConvertibleLut = (kTokenEmbLutType == LLMType::INT8
+                                   || kTokenEmbLutType == LLMType::INT4
+                                   || kTokenEmbLutType == LLMType::FP16
+                                   || kTokenEmbLutType == LLMType::FP32);
+    const bool isSupportedOutput = (mTokenEmbOutputType == LLMType::FP32
+                                    || mTokenEmbOutputType == LLMType::FP16
+                                    || (mTokenEmbOutputType == LLMType::INT16
+                                        && mTokenEmbQuantScale > 0));
+    if (isConvertibleLut && isSupportedOutput) {
+        const size_t outputRowSize = kHiddenSize * mTokenEmbOutputTypeSize;
+        size_t outputOffset = 0;
+        for (const auto token : tokens) {
+            ET_CHECK_MSG(token < mVocabSize, "Token id exceeds embedding lookup table range.");
+            convertRow(mLutData + token * kLutRowSizeBytes, mOutputBuffer + outputOffset);
+            outputOffset += outputRowSize;
+        }
+        return;
+    }
+
+    ET_LOG(
+        Fatal,
+        "Unimplemented: Mismatch between token embedding lookup table type (%s) "
+        "and model input embedding type (%s)",
+        getLLMTypeName(kTokenEmbLutType),
+        getLLMTypeName(mTokenEmbOutputType));
+}
+
+void TokenEmbeddingLut::convertRow(const uint8_t* lutRow, uint8_t* outputRow) const {
+    const bool isQuantizedLut = (kTokenEmbLutType == LLMType::INT8
+                                 || kTokenEmbLutType == LLMType::INT4);
+    float rowScale = 1;
+    if (isQuantizedLut) {
+        std::memcpy(&rowScale, lutRow, sizeof(rowScale));
+    }
+    const auto values = lutRow + (isQuantizedLut ? sizeof(rowScale) : 0);
+
+    auto getValue = [&](const size_t i) -> float {
+        if (kTokenEmbLutType == LLMType::FP32) {
+            return reinterpret_cast<const float*>(values)[i];
+        }
+        if (kTokenEmbLutType == LLMType::FP16) {
+            return reinterpret_cast<const __fp16*>(values)[i];
+        }
+        if (kTokenEmbLutType == LLMType::INT8) {
+            return static_cast<int8_t>(values[i]) * rowScale;
+        }
+        // Sign-extend the 4-bit value
+        const uint8_t nibble = (i % 2 == 0) ? (values[i / 2] & 0xF) : (values[i / 2] >> 4);
+        return static_cast<int8_t>(nibble << 4) / 16 * rowScale;
+    };
+
+    switch (mTokenEmbOutputType) {
+        case LLMType::FP32: {
+            auto output = reinterpret_cast<float*>(outputRow);
+            for (size_t i = 0; i < kHiddenSize; i++)
+                output[i] = getValue(i);
+            break;
+        }
+        case LLMType::FP16: {
+            auto output = reinterpret_cast<__fp16*>(outputRow);
+            for (size_t i = 0; i < kHiddenSize; i++)
+                output[i] = getValue(i);
+            break;
+        }
+        case LLMType::INT16: {
+            // Requantize to the model input quantization scale
+            auto output = reinterpret_cast<int16_t*>(outputRow);
+            for (size_t i = 0; i < kHiddenSize; i++) {
+                const float value = std::round(getValue(i) / mTokenEmbQuantScale);
+                output[i] = static_cast<int16_t>(std::clamp(value, -32768.0f, 32767.0f));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+} // namespace llm_helper
 } // namespace torch::executor
\ No newline at end of file
@@ -16,21 +16,38 @@
  *
  * It sets all input tensor data to ones, and assumes that the outputs are
  * all fp32 tensors.
+ *
+ * With --benchmark_output, it also writes the latency distribution of the
+ * measured iterations as JSON, along with the time the Neuron delegates spent
+ * binding the I/O and executing when event tracing is compiled in.
  */
 
+#include <chrono>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <vector>
 
 #include <gflags/gflags.h>
 
+#include <executorch/backends/mediatek/runtime/include/NeuronBackend.h>
+#include <executorch/backends/mediatek/runtime/include/NeuronMemoryAllocator.h>
+#include <executorch/examples/models/llama2/runner/benchmark_report.h>
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/evalue_util/print_evalue.h>
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
 #include <executorch/extension/runner_util/inputs.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/runtime.h>
+#ifdef ET_EVENT_TRACER_ENABLED
+#include <executorch/sdk/op_stats/op_stats.h>
+#endif
 
 static uint8_t method_allocator_pool[4 * 1024U * 1024U]; // 4 MB
 
@@ -38,11 +55,104 @@ DEFINE_string(
     model_path,
     "model.pte",
     "Model serialized in flatbuffer format.");
+DEFINE_uint64(
+    temp_allocator_size,
+    0,
+    "Initial size in bytes of the kernel scratch arena, e.g. the high-water "
+    "mark logged by an earlier run. The arena grows as needed.");
 DEFINE_int32(iteration, 1, "Iterations of inference.");
+DEFINE_int32(
+    warmup,
+    0,
+    "Iterations of inference run before the measured ones, e.g. for the "
+    "first executions to import the buffers and ramp up the clocks.");
+DEFINE_string(
+    input_memory,
+    "planned",
+    "Where the inputs live: 'planned' copies them into the memory-planned "
+    "Neuron buffers, 'neuron' binds Neuron buffers of their own, and 'malloc' "
+    "binds heap buffers, which the delegates cannot import.");
+DEFINE_bool(
+    high_addr,
+    false,
+    "Override the HighAddr compile spec of the Neuron delegates.");
+DEFINE_bool(
+    import_forever,
+    false,
+    "Override the ImportForever compile spec of the Neuron delegates.");
+DEFINE_string(
+    benchmark_output,
+    "",
+    "Path of the JSON benchmark report. Empty to only log the latencies.");
 
 using namespace torch::executor;
 using torch::executor::util::FileDataLoader;
 
+namespace {
+
+#ifdef ET_EVENT_TRACER_ENABLED
+// Room for the histograms of every instruction and delegate event.
+constexpr size_t kOpStatsTableSize = 1024;
+#endif
+
+// Neuron buffers bound to the method inputs, released when destroyed.
+class NeuronInputBuffers {
+ public:
+  NeuronInputBuffers() = default;
+  NeuronInputBuffers(const NeuronInputBuffers&) = delete;
+  NeuronInputBuffers& operator=(const NeuronInputBuffers&) = delete;
+
+  ~NeuronInputBuffers() {
+    for (void* buffer : buffers_) {
+      GET_NEURON_ALLOCATOR.RemoveBuffer(buffer);
+    }
+  }
+
+  Error bind(Method& method) {
+    MethodMeta method_meta = method.method_meta();
+    for (size_t i = 0; i < method_meta.num_inputs(); i++) {
+      auto tag = method_meta.input_tag(i);
+      if (!tag.ok() || tag.get() != Tag::Tensor) {
+        continue;
+      }
+      auto tensor_meta = method_meta.input_tensor_meta(i);
+      ET_CHECK_OK_OR_RETURN_ERROR(tensor_meta.error());
+      const size_t nbytes = tensor_meta->nbytes();
+      void* buffer = GET_NEURON_ALLOCATOR.Allocate(nbytes);
+      ET_CHECK_OR_RETURN_ERROR(
+          buffer != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate %zu bytes for input %zu",
+          nbytes,
+          i);
+      buffers_.push_back(buffer);
+      std::memset(buffer, 0, nbytes);
+      ET_CHECK_OK_OR_RETURN_ERROR(util::bind_input(method, i, buffer, nbytes));
+    }
+    return Error::Ok;
+  }
+
+ private:
+  std::vector<void*> buffers_;
+};
+
+std::string quote(const std::string& value) {
+  std::string quoted = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+bool flag_is_set(const char* name) {
+  return !gflags::GetCommandLineFlagInfoOrDie(name).is_default;
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   runtime_init();
 
@@ -56,6 +166,16 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  // Compare the delegate settings without exporting the model again.
+  neuron::DelegateSettingOverrides overrides;
+  if (flag_is_set("high_addr")) {
+    overrides.mHighAddr = FLAGS_high_addr;
+  }
+  if (flag_is_set("import_forever")) {
+    overrides.mImportForever = FLAGS_import_forever;
+  }
+  neuron::SetDelegateSettingOverrides(overrides);
+
   // Create a loader to get the data of the program file. There are other
   // DataLoaders that use mmap() or point to data that's already in memory, and
   // users can create their own DataLoaders to load from arbitrary sources.
@@ -122,23 +242,25 @@ int main(int argc, char** argv) {
   // mobile environments will only have a single buffer. Some embedded
   // environments may have more than one for, e.g., slow/large DRAM and
   // fast/small SRAM, or for memory associated with particular cores.
-  std::vector<std::unique_ptr<uint8_t[]>> planned_buffers; // Owns the memory
-  std::vector<Span<uint8_t>> planned_spans; // Passed to the allocator
-  size_t num_memory_planned_buffers = method_meta->num_memory_planned_buffers();
-  for (size_t id = 0; id < num_memory_planned_buffers; ++id) {
-    // .get() will always succeed because id < num_memory_planned_buffers.
-    size_t buffer_size =
-        static_cast<size_t>(method_meta->memory_planned_buffer_size(id).get());
-    ET_LOG(Info, "Setting up planned buffer %zu, size %zu.", id, buffer_size);
-    planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
-    planned_spans.push_back({planned_buffers.back().get(), buffer_size});
-  }
-  HierarchicalAllocator planned_memory(
-      {planned_spans.data(), planned_spans.size()});
+  //
+  // The buffers are Neuron shared buffers, so that the tensors they back are
+  // bound to the Neuron delegates without copies.
+  auto planned_memory = neuron::NeuronPlannedMemory::Create(*method_meta);
+  ET_CHECK_MSG(
+      planned_memory.ok(),
+      "Failed to allocate planned memory: 0x%" PRIx32,
+      planned_memory.error());
+
+  // The temp allocator provides scratch memory to kernels and is reset after
+  // every kernel. It grows to the largest request seen, so the high-water mark
+  // logged below can be passed back with --temp_allocator_size to skip the
+  // growth on the next run.
+  util::TempMemoryAllocator temp_allocator(FLAGS_temp_allocator_size);
 
   // Assemble all of the allocators into the MemoryManager that the Executor
   // will use.
-  MemoryManager memory_manager(&method_allocator, &planned_memory);
+  MemoryManager memory_manager(
+      &method_allocator, (*planned_memory)->get(), &temp_allocator);
 
   //
   // Load the method from the program, using the provided allocators. Running
@@ -146,7 +268,15 @@ int main(int argc, char** argv) {
   // be used by a single thread at at time, but it can be reused.
   //
 
-  Result<Method> method = program->load_method(method_name, &memory_manager);
+#ifdef ET_EVENT_TRACER_ENABLED
+  std::vector<op_stats_entry> op_stats_table(kOpStatsTableSize);
+  OpStatsTracer tracer({op_stats_table.data(), op_stats_table.size()});
+  EventTracer* event_tracer = &tracer;
+#else
+  EventTracer* event_tracer = nullptr;
+#endif
+  Result<Method> method =
+      program->load_method(method_name, &memory_manager, event_tracer);
   ET_CHECK_MSG(
       method.ok(),
       "Loading of method %s failed with status 0x%" PRIx32,
@@ -154,40 +284,141 @@ int main(int argc, char** argv) {
       (uint32_t)method.error());
   ET_LOG(Info, "Method loaded.");
 
-  // Allocate input tensors and set all of their elements to 1. The `inputs`
-  // variable owns the allocated memory and must live past the last call to
-  // `execute()`.
-  auto inputs = util::prepare_input_tensors(*method);
-  ET_CHECK_MSG(
-      inputs.ok(),
-      "Could not prepare inputs: 0x%" PRIx32,
-      (uint32_t)inputs.error());
-  ET_LOG(Info, "Inputs prepared.");
+  // Allocate input tensors and set all of their elements to 1, or bind
+  // buffers of their own to the inputs. The `inputs` variables own the
+  // allocated memory and must live past the last call to `execute()`.
+  std::optional<util::BufferCleanup> planned_inputs;
+  std::optional<util::InputBuffers> malloc_inputs;
+  NeuronInputBuffers neuron_inputs;
+  if (FLAGS_input_memory == "planned") {
+    auto inputs = util::prepare_input_tensors(*method);
+    ET_CHECK_MSG(
+        inputs.ok(),
+        "Could not prepare inputs: 0x%" PRIx32,
+        (uint32_t)inputs.error());
+    planned_inputs.emplace(std::move(inputs.get()));
+  } else if (FLAGS_input_memory == "malloc") {
+    auto inputs = util::prepare_input_buffers(*method);
+    ET_CHECK_MSG(
+        inputs.ok(),
+        "Could not prepare inputs: 0x%" PRIx32,
+        (uint32_t)inputs.error());
+    malloc_inputs.emplace(std::move(inputs.get()));
+  } else {
+    ET_CHECK_MSG(
+        FLAGS_input_memory == "neuron",
+        "Unknown input memory: %s",
+        FLAGS_input_memory.c_str());
+    const Error err = neuron_inputs.bind(*method);
+    ET_CHECK_MSG(
+        err == Error::Ok,
+        "Could not prepare inputs: 0x%" PRIx32,
+        (uint32_t)err);
+  }
+  ET_LOG(Info, "Inputs prepared in %s memory.", FLAGS_input_memory.c_str());
 
-  // Run the model.
-  auto before_exec = std::chrono::high_resolution_clock::now();
+  // Run the model. An iteration lasts until the asynchronous Neuron
+  // executions, if any, have completed.
   Error status = Error::Ok;
-  for (int i = 0; i < FLAGS_iteration; ++i) {
+  auto run_iteration = [&]() {
+    const auto before_exec = std::chrono::steady_clock::now();
     status = method->execute();
+    if (status == Error::Ok) {
+      status = neuron::WaitForAsyncExecutions();
+    }
+    const auto after_exec = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(after_exec - before_exec)
+        .count();
+  };
+  for (int i = 0; i < FLAGS_warmup && status == Error::Ok; ++i) {
+    run_iteration();
+  }
+#ifdef ET_EVENT_TRACER_ENABLED
+  // Only the measured iterations count.
+  tracer.reset();
+#endif
+  std::vector<double> latencies_ms;
+  for (int i = 0; i < FLAGS_iteration && status == Error::Ok; ++i) {
+    latencies_ms.push_back(run_iteration());
   }
-  auto after_exec = std::chrono::high_resolution_clock::now();
-  double elapsed_time =
-      std::chrono::duration_cast<std::chrono::microseconds>(
-          after_exec - before_exec).count() / 1000.0;
-
-  ET_LOG(
-      Info,
-      "%d inference took %f ms, avg %f ms",
-      FLAGS_iteration,
-      elapsed_time,
-      elapsed_time / (float)FLAGS_iteration);
   ET_CHECK_MSG(
       status == Error::Ok,
       "Execution of method %s failed with status 0x%" PRIx32,
       method_name,
       (uint32_t)status);
+
+  const auto latency = util::summarize_latencies(latencies_ms);
+  ET_LOG(
+      Info,
+      "%d inference after %d warmup: avg %f ms, p50 %f ms, p90 %f ms, "
+      "p99 %f ms, max %f ms",
+      FLAGS_iteration,
+      FLAGS_warmup,
+      latency.mean_ms,
+      latency.p50_ms,
+      latency.p90_ms,
+      latency.p99_ms,
+      latency.max_ms);
   ET_LOG(Info, "Model executed successfully.");
 
+  if (!FLAGS_benchmark_output.empty()) {
+    std::stringstream ss;
+    ss << "{\"runner\":\"mtk_executor_runner\",\"metadata\":{"
+       << "\"model_path\":" << quote(FLAGS_model_path)
+       << ",\"input_memory\":" << quote(FLAGS_input_memory)
+       << ",\"high_addr\":"
+       << quote(flag_is_set("high_addr") ? (FLAGS_high_addr ? "true" : "false")
+                                         : "compile spec")
+       << ",\"import_forever\":"
+       << quote(
+              flag_is_set("import_forever")
+                  ? (FLAGS_import_forever ? "true" : "false")
+                  : "compile spec")
+       << ",\"warmup\":" << FLAGS_warmup
+       << ",\"iterations\":" << FLAGS_iteration << "}"
+       << ",\"latency_ms\":{\"mean\":" << latency.mean_ms
+       << ",\"p50\":" << latency.p50_ms << ",\"p90\":" << latency.p90_ms
+       << ",\"p99\":" << latency.p99_ms << ",\"max\":" << latency.max_ms
+       << "},\"delegate_events_ms\":[";
+#ifdef ET_EVENT_TRACER_ENABLED
+    // DELEGATE_DATA_TRANSFER is the host binding of the I/O, and
+    // DELEGATE_EXECUTE the APU execution including the output sync, which
+    // NeuronAdapter does not time separately.
+    std::vector<op_latency_summary> summaries(kOpStatsTableSize);
+    const size_t num_summaries =
+        tracer.get_summaries({summaries.data(), summaries.size()});
+    bool first = true;
+    for (size_t i = 0; i < num_summaries; i++) {
+      const auto& summary = summaries[i];
+      if (!summary.is_delegate) {
+        continue;
+      }
+      ss << (first ? "" : ",") << "{\"name\":" << quote(summary.name)
+         << ",\"count\":" << summary.count
+         << ",\"mean\":" << summary.mean_ns / 1e6
+         << ",\"p50\":" << summary.p50_ns / 1e6
+         << ",\"p90\":" << summary.p90_ns / 1e6
+         << ",\"p99\":" << summary.p99_ns / 1e6 << "}";
+      first = false;
+    }
+#endif
+    ss << "]}";
+    std::ofstream report(FLAGS_benchmark_output);
+    report << ss.str() << std::endl;
+    ET_CHECK_MSG(
+        report.good(),
+        "Failed to write the benchmark report to %s",
+        FLAGS_benchmark_output.c_str());
+    ET_LOG(
+        Info,
+        "Benchmark report written to %s",
+        FLAGS_benchmark_output.c_str());
+  }
+  ET_LOG(
+      Info,
+      "Temp allocator high-water mark: %zu bytes.",
+      temp_allocator.high_water_mark());
+
 
   // Print the outputs.
   std::vector<EValue> outputs(method->outputs_size());
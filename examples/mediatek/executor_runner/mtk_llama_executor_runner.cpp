@@ -44,6 +44,7 @@
 
 #include "include/NeuronBufferAllocator.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <random>
@@ -64,10 +65,15 @@
 #include "llama_runner/LlamaConfig.h"
 #include "llama_runner/ModelChunk.h"
 #include "llama_runner/LlamaRuntime.h"
+#include "llama_runner/LlamaSessionManager.h"
 #include "llama_runner/Utils.h"
 
+#include <executorch/examples/models/llama2/runner/benchmark_report.h>
+#include <executorch/examples/models/llama2/runner/prompt_lookup.h>
+#include <executorch/examples/models/llama2/sampler/sampler.h>
 #include <executorch/examples/models/llama2/tokenizer/tiktoken.h>
 #include <executorch/examples/models/llama2/tokenizer/bpe_tokenizer.h>
+#include <executorch/examples/models/llama2/tokenizer/streaming_decoder.h>
 
 // Llama model options
 DEFINE_uint64(prompt_token_batch_size, 128, "Token batch size for prompt model.");
@@ -84,11 +90,68 @@ DEFINE_string(output_type, "int16", "Model output type. Default to 'int16'");
 DEFINE_string(cache_type, "int16", "Model cache type. Default to 'int16'");
 DEFINE_string(mask_type, "int16", "Model mask type. Default to 'int16'");
 DEFINE_string(rot_emb_type, "int16", "Model rotary embedding type. Default to 'int16'");
+DEFINE_string(
+    model_precision,
+    "",
+    "Weight-only quantized model precision, 'w4a16' or 'w8a16': int4/int8 weights with fp16 "
+    "activations. Sets the IO types that are not given explicitly to 'fp16'.");
+
+// Cache layout
+DEFINE_bool(
+    ring_cache,
+    false,
+    "Models output only the new cache entries, kept in a ring buffer cache.");
+DEFINE_uint64(
+    cache_sink_size,
+    0,
+    "Ring cache only: number of cache entries of the first tokens kept once the cache is full.");
+DEFINE_bool(
+    streaming,
+    false,
+    "Ring cache only: keep generating past max_token_length with a sliding window cache.");
+DEFINE_bool(
+    contiguous_cache,
+    false,
+    "Allocate the caches of each model chunk as slices of one buffer.");
+
+// Token embedding
+DEFINE_string(
+    token_embedding_type,
+    "",
+    "Token embedding lookup table type if it differs from input_type, e.g. 'int8' or 'int4' for "
+    "a table quantized per row.");
+DEFINE_bool(
+    mmap_token_embedding,
+    false,
+    "Memory-map the token embedding lookup table so that only looked-up rows are paged in.");
+DEFINE_double(
+    input_qscale,
+    0,
+    "Quantization scale of an int16 model input, required by a quantized embedding table.");
 
 // Model Paths
 DEFINE_string(token_embedding_path, "embedding.bin", "Input token embedding lookup table path.");
 DEFINE_string(prompt_model_paths, "model_128t.pte", "Comma-separated prompt model paths.");
 DEFINE_string(gen_model_paths, "model_1t.pte", "Comma-separated generative model paths.");
+DEFINE_string(
+    extra_prompt_token_batch_sizes,
+    "",
+    "Comma-separated token batch sizes of additional prompt models for the prompt tail, e.g. "
+    "'32,8'.");
+DEFINE_string(
+    extra_prompt_model_paths,
+    "",
+    "Semicolon-separated groups of comma-separated prompt model paths, one group per extra prompt "
+    "token batch size.");
+DEFINE_bool(
+    load_all_models,
+    false,
+    "Keep the models of all token batch sizes loaded to make model swapping cheap.");
+DEFINE_uint64(
+    model_memory_budget_mb,
+    0,
+    "With --load_all_models, load the models on first use and unload the least recently used ones "
+    "once the loaded model files exceed this size in MB. 0 loads all of them at init.");
 
 // Tokenizer
 DEFINE_string(tokenizer_path, "tokenizer.model", "tokenizer.model vocab path.");
@@ -100,6 +163,92 @@ DEFINE_uint64(eos_token, 128001, "EOS token id.");
 // Inference
 DEFINE_uint64(max_response, 50, "Maximum number of tokens to generate.");
 DEFINE_string(prompt_file, "", "File containing the prompt text.");
+DEFINE_string(
+    prompt_prefix_file,
+    "",
+    "File containing a prompt prefix shared across requests, e.g. a system prompt. It is "
+    "prepended to the prompt and its cache is snapshotted to prompt_cache_path.");
+DEFINE_string(
+    prompt_cache_path,
+    "",
+    "Cache snapshot file. Restored when its tokens match the start of the prompt, written after "
+    "digesting the prompt prefix otherwise.");
+DEFINE_string(
+    session_prompt_files,
+    "",
+    "Comma-separated prompt files served as concurrent sessions. Overrides prompt_file.");
+DEFINE_uint64(
+    session_decode_rounds_per_prefill,
+    8,
+    "Number of decode rounds over all sessions between two prefill passes.");
+
+// Sampling
+DEFINE_double(
+    temperature,
+    0,
+    "Sampling temperature. 0 for greedy decoding. Models with int16 logits decode greedily "
+    "unless logits_qscale is given.");
+DEFINE_double(
+    logits_qscale,
+    0,
+    "Quantization scale of int16 logits, which sampling dequantizes on the fly. 0 if unknown.");
+DEFINE_double(topp, 0.9, "Top-p (nucleus) sampling threshold. 0 or 1 to disable.");
+DEFINE_uint64(topk, 0, "Sample from the topk most likely tokens only. 0 to disable.");
+DEFINE_double(
+    repetition_penalty,
+    1.0,
+    "Penalty applied to the logits of the prompt and generated tokens. 1 to disable.");
+DEFINE_uint64(seed, 0, "Random seed for sampling. 0 to seed from the current time.");
+
+// Speculative decoding
+DEFINE_string(
+    draft_gen_model_paths,
+    "",
+    "Comma-separated generative model paths of the draft model. Empty to disable speculative "
+    "decoding.");
+DEFINE_string(draft_prompt_model_paths, "", "Comma-separated prompt model paths of the draft model.");
+DEFINE_string(draft_token_embedding_path, "", "Token embedding lookup table path of the draft model.");
+DEFINE_uint64(draft_hidden_size, 2048, "Draft model hidden size.");
+DEFINE_uint64(draft_num_head, 32, "Number of attention heads in each layer of the draft model.");
+DEFINE_uint64(draft_num_layer, 16, "Number of layers in the draft model.");
+DEFINE_uint64(
+    draft_k,
+    4,
+    "Number of tokens proposed by the draft model per step. The main model verifies them with its "
+    "prompt model, so draft_k + 1 must not exceed prompt_token_batch_size.");
+DEFINE_uint64(
+    prompt_lookup_tokens,
+    0,
+    "Number of tokens proposed per step from n-gram matches in the context when there is no draft "
+    "model (prompt lookup decoding), decoding greedily. 0 to disable. prompt_lookup_tokens + 1 must "
+    "not exceed prompt_token_batch_size.");
+DEFINE_uint64(
+    prompt_lookup_ngram,
+    3,
+    "Longest n-gram matched by prompt lookup decoding, shorter ones are tried next.");
+
+// Benchmark
+DEFINE_string(
+    benchmark_prompt_lengths,
+    "",
+    "Comma-separated prompt lengths in tokens to benchmark instead of running prompt_file. Each is "
+    "run with every benchmark_gen_lengths, and the results are written to benchmark_output.");
+DEFINE_string(
+    benchmark_gen_lengths,
+    "32,128",
+    "Comma-separated numbers of tokens to generate for each benchmarked prompt length.");
+DEFINE_uint64(benchmark_repeats, 3, "Number of measured runs of each benchmark configuration.");
+DEFINE_uint64(benchmark_warmup, 1, "Number of discarded runs before the measured ones.");
+DEFINE_string(
+    benchmark_output,
+    "mtk_llama_benchmark.json",
+    "Benchmark JSON report path. Empty to print to stdout.");
+
+// Memory
+DEFINE_uint64(
+    buffer_arena_slab_mb,
+    0,
+    "Sub-allocate model IO buffers from shared slabs of this size in MB. 0 to disable.");
 
 // Global BOS and EOS option for tokenization (encoding)
 static constexpr int8_t kAddBos = 1;
@@ -109,6 +258,21 @@ using namespace torch::executor;
 using namespace torch::executor::llm_helper;
 using torch::executor::utils::Timer;
 
+// The type of a model IO type flag. Weight-only quantized models keep their activations, and so
+// their IOs, in fp16 unless the flag is given explicitly.
+LLMType get_io_type(const char* flag_name, const std::string& flag_value) {
+  const bool weight_only = !strcasecmp(FLAGS_model_precision.c_str(), "w4a16")
+                           || !strcasecmp(FLAGS_model_precision.c_str(), "w8a16");
+  ET_CHECK_MSG(
+      weight_only || FLAGS_model_precision.empty(),
+      "Unsupported model precision: %s",
+      FLAGS_model_precision.c_str());
+  if (weight_only && gflags::GetCommandLineFlagInfoOrDie(flag_name).is_default) {
+    return LLMType::FP16;
+  }
+  return getLLMTypeFromName(flag_value.c_str());
+}
+
 LlamaModelOptions get_model_options() {
   LlamaModelOptions options = {
     // Sizes
@@ -121,11 +285,27 @@ LlamaModelOptions get_model_options() {
     .rot_emb_base             = FLAGS_rot_emb_base,
 
     // Types
-    .model_input_type  = getLLMTypeFromName(FLAGS_input_type.c_str()),
-    .model_output_type = getLLMTypeFromName(FLAGS_output_type.c_str()),
-    .cache_type        = getLLMTypeFromName(FLAGS_cache_type.c_str()),
-    .mask_type         = getLLMTypeFromName(FLAGS_mask_type.c_str()),
-    .rot_emb_type      = getLLMTypeFromName(FLAGS_rot_emb_type.c_str())
+    .model_input_type  = get_io_type("input_type", FLAGS_input_type),
+    .model_output_type = get_io_type("output_type", FLAGS_output_type),
+    .cache_type        = get_io_type("cache_type", FLAGS_cache_type),
+    .mask_type         = get_io_type("mask_type", FLAGS_mask_type),
+    .rot_emb_type      = get_io_type("rot_emb_type", FLAGS_rot_emb_type),
+
+    // Cache layout
+    .ring_cache = FLAGS_ring_cache,
+    .cache_sink_size = FLAGS_cache_sink_size,
+    .streaming = FLAGS_streaming,
+    .contiguous_cache = FLAGS_contiguous_cache,
+
+    .load_all_models = FLAGS_load_all_models,
+    .model_memory_budget_mb = FLAGS_model_memory_budget_mb,
+
+    // Token embedding
+    .token_embedding_type = FLAGS_token_embedding_type.empty()
+                            ? LLMType::INVALID
+                            : getLLMTypeFromName(FLAGS_token_embedding_type.c_str()),
+    .mmap_token_embedding = FLAGS_mmap_token_embedding,
+    .model_input_qscale   = static_cast<float>(FLAGS_input_qscale)
   };
   return options;
 }
@@ -137,21 +317,88 @@ LlamaModelPaths get_model_paths() {
     .prompt_model_paths = utils::split(FLAGS_prompt_model_paths, ','),
     .gen_model_paths = utils::split(FLAGS_gen_model_paths, ',')
   };
+  const auto extra_batch_sizes = utils::split(FLAGS_extra_prompt_token_batch_sizes, ',');
+  const auto extra_model_paths = utils::split(FLAGS_extra_prompt_model_paths, ';');
+  ET_CHECK_MSG(
+      extra_batch_sizes.size() == extra_model_paths.size(),
+      "Number of extra prompt token batch sizes (%zu) != number of extra prompt model groups (%zu)",
+      extra_batch_sizes.size(),
+      extra_model_paths.size());
+  for (size_t i = 0; i < extra_batch_sizes.size(); i++) {
+    const size_t batch_size = std::stoul(extra_batch_sizes[i]);
+    model_paths.extra_prompt_model_paths[batch_size] = utils::split(extra_model_paths[i], ',');
+  }
   return model_paths;
 }
 
+LlamaModelOptions get_draft_model_options() {
+  LlamaModelOptions options = get_model_options();
+  options.hidden_size = FLAGS_draft_hidden_size;
+  options.num_head    = FLAGS_draft_num_head;
+  options.num_layer   = FLAGS_draft_num_layer;
+  return options;
+}
+
+LlamaModelPaths get_draft_model_paths() {
+  LlamaModelPaths model_paths = {
+    .tokenizer_path = FLAGS_tokenizer_path,
+    .token_embedding_path = FLAGS_draft_token_embedding_path,
+    .prompt_model_paths = utils::split(FLAGS_draft_prompt_model_paths, ','),
+    .gen_model_paths = utils::split(FLAGS_draft_gen_model_paths, ',')
+  };
+  return model_paths;
+}
+
+std::unique_ptr<Sampler> make_sampler(const size_t vocab_size) {
+  const unsigned long long seed = FLAGS_seed ? FLAGS_seed : std::time(nullptr);
+  return std::make_unique<Sampler>(
+      vocab_size,
+      FLAGS_temperature,
+      FLAGS_topp,
+      seed,
+      FLAGS_topk,
+      FLAGS_repetition_penalty);
+}
+
+// Sample the next token from the logits of the last token. The repetition penalty applies to
+// recent_tokens. Int16 logits are decoded greedily unless their quantization scale is known.
+uint64_t sample_token(
+    Sampler& sampler,
+    const LLMType logits_type,
+    void* logits,
+    const size_t vocab_size,
+    const std::vector<uint64_t>& recent_tokens) {
+  switch (logits_type) {
+    case LLMType::FP16:
+      // __fp16 and exec_aten::Half share the IEEE half precision layout
+      return sampler.sample(reinterpret_cast<exec_aten::Half*>(logits), recent_tokens);
+    case LLMType::FP32:
+      return sampler.sample(reinterpret_cast<float*>(logits), recent_tokens);
+    case LLMType::INT16:
+      if (FLAGS_logits_qscale > 0) {
+        return sampler.sample(
+            reinterpret_cast<const int16_t*>(logits), FLAGS_logits_qscale, recent_tokens);
+      }
+      return utils::argmax(logits_type, logits, vocab_size);
+    default:
+      return utils::argmax(logits_type, logits, vocab_size);
+  }
+}
+
 Result<uint64_t> digest_prompt(
     LlamaRuntime& llama_runtime,
     const std::unique_ptr<Tokenizer>& tokenizer,
-    const std::vector<uint64_t> input_tokens) {
-  const auto input_token_count = input_tokens.size();
-  const auto prompt_token_batch_size = llama_runtime.GetTokenBatchSize();
+    const std::vector<uint64_t> input_tokens,
+    Sampler* sampler = nullptr) {
+  const auto prompt_passes = llama_runtime.PlanPromptPasses(input_tokens.size());
   size_t cur_token_index = 0;
 
-  Timer timer_digest_prompt([=](const auto elapsed_sec) {
-    // Ideal prompt size is a multiple of prompt batch size
-    const size_t ideal_prompt_size =
-        std::ceil(float(input_token_count) / prompt_token_batch_size) * prompt_token_batch_size;
+  Timer timer_digest_prompt([&](const auto elapsed_sec) {
+    // Ideal prompt size is the number of tokens processed including padding
+    size_t ideal_prompt_size = 0;
+    for (const auto& pass : prompt_passes) {
+      ideal_prompt_size += pass.batchSize;
+    }
     ET_LOG(
         Info,
         "Done analyzing prompt in %f sec (%f tok/s)",
@@ -159,23 +406,25 @@ Result<uint64_t> digest_prompt(
         (float)ideal_prompt_size / elapsed_sec);
   });
 
-  auto getNextTokens = [&]() {
-    const size_t num_tok_remain = input_token_count - cur_token_index;
-    const size_t remainder = num_tok_remain % prompt_token_batch_size;
-    const size_t num_new_tokens = remainder ? remainder : prompt_token_batch_size;
-    const auto start = cur_token_index;
-    const auto end = start + num_new_tokens;
-    return std::vector(input_tokens.begin() + start, input_tokens.begin() + end);
-  };
-
   void* logits;
   timer_digest_prompt.Start();
-  while (cur_token_index < input_token_count) {
-    const auto next_tokens = getNextTokens();
+  for (size_t i = 0; i < prompt_passes.size(); i++) {
+    const auto& pass = prompt_passes[i];
+    if (llama_runtime.GetTokenBatchSize() != pass.batchSize) {
+      llama_runtime.SwapModel(pass.batchSize);
+    }
+    // Load the model of the next pass, or the gen model after the last one, during this pass.
+    const size_t next_batch_size =
+        (i + 1 < prompt_passes.size()) ? prompt_passes[i + 1].batchSize : 1;
+    llama_runtime.PreloadModel(next_batch_size);
+
+    const auto start = input_tokens.begin() + cur_token_index;
+    const std::vector<uint64_t> next_tokens(start, start + pass.numToken);
     ET_LOG(
         Debug,
-        "Digest next tokens (size=%zu), 1st tok=%lu",
+        "Digest next tokens (size=%zu, batch=%zu), 1st tok=%lu",
         next_tokens.size(),
+        pass.batchSize,
         next_tokens[0]);
     logits = llama_runtime.Run(next_tokens);
     cur_token_index += next_tokens.size();
@@ -184,13 +433,17 @@ Result<uint64_t> digest_prompt(
 
   const auto vocab_size = tokenizer->vocab_size();
   const auto logits_type = llama_runtime.GetModelOptions().model_output_type;
-  const auto first_output_token = utils::argmax(logits_type, logits, vocab_size);
+  const auto first_output_token = sampler
+      ? sample_token(*sampler, logits_type, logits, vocab_size, input_tokens)
+      : utils::argmax(logits_type, logits, vocab_size);
   return first_output_token;
 }
 
 Error gen_response(
     LlamaRuntime& llama_runtime,
     const std::unique_ptr<Tokenizer>& tokenizer,
+    Sampler& sampler,
+    std::vector<uint64_t> recent_tokens,
     const uint64_t input_token) {
   Timer timer_model_swap(
       [](const auto elapsed_sec) { ET_LOG(Info, "Model swapped."); });
@@ -204,13 +457,13 @@ Error gen_response(
   uint64_t prev_token = input_token;
   uint64_t output_token = input_token;
 
-  auto decode_res = tokenizer->decode(prev_token, output_token);
+  // Holds back the bytes of characters split over several tokens.
+  StreamingDecoder decoder(*tokenizer);
   ET_CHECK_OR_RETURN_ERROR(
-      decode_res.ok(),
+      decoder.step(prev_token, output_token) == Error::Ok,
       InvalidState,
       "Tokenizer failed to decode first generated token: %lu",
       output_token);
-  std::string full_response = std::move(decode_res.get());
   std::vector<uint64_t> full_response_tokens = {input_token};
 
   const auto vocab_size = tokenizer->vocab_size();
@@ -221,16 +474,17 @@ Error gen_response(
 
   // Print first output token
   std::cout << "\n[Real-time Response]" << std::endl;
-  std::cout << full_response << std::flush;
+  std::cout << decoder.text() << std::flush;
 
   while (gen_tok_count++ < FLAGS_max_response
-         && llama_runtime.GetTokenIndex() < FLAGS_max_token_length) {
+         && (FLAGS_streaming || llama_runtime.GetTokenIndex() < FLAGS_max_token_length)) {
     timer_gen_token.Start();
     void* logits = llama_runtime.Run({output_token});
     timer_gen_token.End();
 
     prev_token = output_token;
-    output_token = utils::argmax(logits_type, logits, vocab_size);
+    recent_tokens.push_back(prev_token);
+    output_token = sample_token(sampler, logits_type, logits, vocab_size, recent_tokens);
     full_response_tokens.push_back(output_token);
 
     // Stop when output is EOS
@@ -238,16 +492,15 @@ Error gen_response(
       std::cout << "</eos>" << std::flush;
       break;
     }
-    auto decode_res = tokenizer->decode(prev_token, output_token);
     ET_CHECK_OR_RETURN_ERROR(
-        decode_res.ok(),
+        decoder.step(prev_token, output_token) == Error::Ok,
         InvalidState,
         "Tokenizer failed to decode generated token %lu",
         output_token);
-    const std::string tok_str = std::move(decode_res.get());
-    full_response += tok_str;
-    std::cout << tok_str << std::flush;
+    std::cout << decoder.text() << std::flush;
   }
+  decoder.flush();
+  std::cout << decoder.text() << std::flush;
 
   std::cout << "\n\n[Generated Tokens]\n" << utils::to_string(full_response_tokens) << std::endl;
 
@@ -256,30 +509,471 @@ Error gen_response(
   return Error::Ok;
 }
 
+// Speculative decoding: each step draft tokens are proposed, then the main model verifies them all
+// in a single batched pass. Draft tokens are accepted as long as they match the main model's greedy
+// prediction, and the main model's prediction at the first mismatch is appended for free. The cache
+// entries of the rejected tokens are rolled back.
+//
+// The draft tokens come from the draft model, which proposes draft_k tokens one by one, or without
+// a draft model from prompt lookup: the tokens after the latest earlier occurrence of the last
+// n-gram of the context. The prompt lookup verifies its drafts with the smallest model of the main
+// model that fits them, and decodes with the generative model when there is no match.
+Error gen_response_speculative(
+    LlamaRuntime& llama_runtime,
+    LlamaRuntime* draft_runtime,
+    const std::unique_ptr<Tokenizer>& tokenizer,
+    std::vector<uint64_t> context_tokens,
+    const uint64_t input_token) {
+  Timer timer_model_swap(
+      [](const auto elapsed_sec) { ET_LOG(Info, "Model swapped."); });
+
+  const bool use_draft_model = draft_runtime != nullptr;
+  const size_t max_draft_k = use_draft_model ? FLAGS_draft_k : FLAGS_prompt_lookup_tokens;
+  // The main model verifies the draft tokens with a prompt model, the largest when drafting with
+  // the draft model so that it never swaps.
+  const auto& batch_sizes = llama_runtime.GetPromptBatchSizes();
+  const size_t verify_batch_size = use_draft_model
+                                   ? llama_runtime.GetModelOptions().prompt_token_batch_size
+                                   : batch_sizes.front();
+  ET_CHECK_OR_RETURN_ERROR(
+      max_draft_k > 0 && max_draft_k + 1 <= verify_batch_size,
+      InvalidArgument,
+      "%s (%zu) + 1 must be within the main model token batch size (%zu)",
+      use_draft_model ? "draft_k" : "prompt_lookup_tokens",
+      max_draft_k,
+      verify_batch_size);
+  // The smallest model that fits the given number of tokens
+  auto get_batch_size = [&](const size_t num_tokens) {
+    const auto it = std::find_if(batch_sizes.rbegin(), batch_sizes.rend(), [&](const auto size) {
+      return size >= num_tokens;
+    });
+    return *it;
+  };
+  if (!use_draft_model && !llama_runtime.GetModelOptions().load_all_models) {
+    ET_LOG(
+        Info,
+        "Prompt lookup swaps between the main models when drafts are found, consider "
+        "--load_all_models to make the swaps cheap.");
+  }
+
+  timer_model_swap.Start();
+  if (llama_runtime.GetTokenBatchSize() != verify_batch_size) {
+    llama_runtime.SwapModel(verify_batch_size);
+  }
+  if (use_draft_model && draft_runtime->GetTokenBatchSize() != 1) {
+    draft_runtime->SwapModel(1);
+  }
+  timer_model_swap.End();
+
+  size_t gen_tok_count = 0;
+  size_t num_steps = 0;
+  size_t num_drafted = 0;
+  size_t num_accepted = 0;
+  uint64_t prev_token = input_token;
+  uint64_t output_token = input_token;
+  context_tokens.push_back(input_token);
+
+  // Holds back the bytes of characters split over several tokens.
+  StreamingDecoder decoder(*tokenizer);
+  ET_CHECK_OR_RETURN_ERROR(
+      decoder.step(prev_token, output_token) == Error::Ok,
+      InvalidState,
+      "Tokenizer failed to decode first generated token: %lu",
+      output_token);
+  std::vector<uint64_t> full_response_tokens = {input_token};
+
+  const auto vocab_size = tokenizer->vocab_size();
+  const auto logits_type = llama_runtime.GetModelOptions().model_output_type;
+  const size_t logits_stride = vocab_size * getLLMTypeSize(logits_type);
+
+  double gen_total_time_sec = 0;
+  Timer timer_gen_token([&](const auto elapsed_sec) { gen_total_time_sec += elapsed_sec; });
+
+  // Print first output token
+  std::cout << "\n[Real-time Response]" << std::endl;
+  std::cout << decoder.text() << std::flush;
+
+  bool is_eos = false;
+  while (!is_eos && gen_tok_count < FLAGS_max_response
+         && (FLAGS_streaming || llama_runtime.GetTokenIndex() + 1 < FLAGS_max_token_length)) {
+    // Shorten the last steps so that the verification pass stays within the max token length.
+    const size_t max_verify_tokens = FLAGS_streaming
+                                     ? max_draft_k + 1
+                                     : FLAGS_max_token_length - llama_runtime.GetTokenIndex();
+    size_t draft_k = std::min<size_t>(max_draft_k, max_verify_tokens - 1);
+
+    timer_gen_token.Start();
+
+    // Draft: propose draft_k tokens after output_token
+    std::vector<uint64_t> draft_tokens = {output_token};
+    if (use_draft_model) {
+      const auto draft_logits_type = draft_runtime->GetModelOptions().model_output_type;
+      for (size_t i = 0; i < draft_k; i++) {
+        void* draft_logits = draft_runtime->Run({draft_tokens.back()});
+        draft_tokens.push_back(utils::argmax(draft_logits_type, draft_logits, vocab_size));
+      }
+    } else {
+      const auto lookup_tokens =
+          util::prompt_lookup_draft(context_tokens, FLAGS_prompt_lookup_ngram, draft_k);
+      draft_tokens.insert(draft_tokens.end(), lookup_tokens.begin(), lookup_tokens.end());
+      draft_k = lookup_tokens.size();
+      const size_t batch_size = get_batch_size(draft_k + 1);
+      if (llama_runtime.GetTokenBatchSize() != batch_size) {
+        timer_model_swap.Start();
+        llama_runtime.SwapModel(batch_size);
+        timer_model_swap.End();
+      }
+    }
+
+    // Verify: the main model predicts the token after each of the draft_k + 1 input tokens
+    auto logits = reinterpret_cast<char*>(llama_runtime.Run(draft_tokens, /*lastLogits=*/false));
+    std::vector<uint64_t> accepted_tokens;
+    for (size_t i = 0; i <= draft_k; i++) {
+      const auto token = utils::argmax(logits_type, logits + i * logits_stride, vocab_size);
+      accepted_tokens.push_back(token);
+      if (i == draft_k || token != draft_tokens[i + 1]) {
+        break;
+      }
+    }
+    const size_t num_draft_accepted = accepted_tokens.size() - 1;
+
+    // Discard the rejected draft tokens. The main model has seen draft_k + 1 input tokens and the
+    // draft model draft_k of them, while both should keep output_token and the accepted tokens.
+    llama_runtime.Rollback(draft_k - num_draft_accepted);
+    if (!use_draft_model) {
+      // Nothing else to roll back
+    } else if (num_draft_accepted == draft_k) {
+      // The draft model has not seen its last token yet.
+      draft_runtime->Run({draft_tokens.back()});
+    } else {
+      draft_runtime->Rollback(draft_k - 1 - num_draft_accepted);
+    }
+
+    timer_gen_token.End();
+
+    num_steps++;
+    num_drafted += draft_k;
+    num_accepted += num_draft_accepted;
+
+    for (const auto token : accepted_tokens) {
+      if (gen_tok_count >= FLAGS_max_response) {
+        break;
+      }
+      gen_tok_count++;
+      prev_token = output_token;
+      output_token = token;
+      full_response_tokens.push_back(output_token);
+      context_tokens.push_back(output_token);
+
+      // Stop when output is EOS
+      if (output_token == tokenizer->eos_tok()) {
+        std::cout << "</eos>" << std::flush;
+        is_eos = true;
+        break;
+      }
+      ET_CHECK_OR_RETURN_ERROR(
+          decoder.step(prev_token, output_token) == Error::Ok,
+          InvalidState,
+          "Tokenizer failed to decode generated token %lu",
+          output_token);
+      std::cout << decoder.text() << std::flush;
+    }
+  }
+  decoder.flush();
+  std::cout << decoder.text() << std::flush;
+
+  std::cout << "\n\n[Generated Tokens]\n" << utils::to_string(full_response_tokens) << std::endl;
+
+  ET_LOG(Info, "Token generation speed: %f tok/s", gen_tok_count / gen_total_time_sec);
+  ET_LOG(
+      Info,
+      "Speculative decoding: %zu steps, %zu/%zu draft tokens accepted (%f tok/step)",
+      num_steps,
+      num_accepted,
+      num_drafted,
+      num_steps ? float(gen_tok_count) / num_steps : 0.0f);
+
+  return Error::Ok;
+}
+
 Error inference(
     LlamaRuntime& llama_runtime,
+    LlamaRuntime* draft_runtime,
     const std::unique_ptr<Tokenizer>& tokenizer,
+    const std::string& prompt_prefix,
     const std::string& prompt) {
-  // Tokenize input prompt
-  auto encode_res = tokenizer->encode(prompt, kAddBos, kAddEos);
+  // Tokenize input prompt. The prefix is tokenized separately so that its tokens are identical
+  // across prompts.
+  std::vector<uint64_t> input_tokens;
+  if (!prompt_prefix.empty()) {
+    auto encode_prefix_res = tokenizer->encode(prompt_prefix, kAddBos, 0);
+    ET_CHECK_OR_RETURN_ERROR(
+        encode_prefix_res.ok(),
+        InvalidState,
+        "Tokenizer failed to encode prompt prefix");
+    input_tokens = std::move(encode_prefix_res.get());
+  }
+  const size_t prefix_token_count = input_tokens.size();
+  auto encode_res = tokenizer->encode(prompt, prompt_prefix.empty() ? kAddBos : 0, kAddEos);
   ET_CHECK_OR_RETURN_ERROR(
       encode_res.ok(),
       InvalidState,
       "Tokenizer failed to encode prompt");
-  const auto input_tokens = std::move(encode_res.get());
+  const auto prompt_tokens = std::move(encode_res.get());
+  input_tokens.insert(input_tokens.end(), prompt_tokens.begin(), prompt_tokens.end());
 
-  std::cout << "\n[Input Prompt]\n" << prompt << std::endl;
+  std::cout << "\n[Input Prompt]\n" << prompt_prefix << prompt << std::endl;
+
+  // Skip the tokens restored from a matching cache snapshot
+  size_t cur_token_index = 0;
+  if (!FLAGS_prompt_cache_path.empty()) {
+    cur_token_index = llama_runtime.LoadCacheSnapshot(FLAGS_prompt_cache_path, input_tokens);
+  }
+  // Digest the prefix on its own so that the snapshot ends exactly after it
+  if (cur_token_index == 0 && prefix_token_count > 0) {
+    const std::vector<uint64_t> prefix_tokens(
+        input_tokens.begin(), input_tokens.begin() + prefix_token_count);
+    auto prefix_res = digest_prompt(llama_runtime, tokenizer, prefix_tokens);
+    ET_CHECK_OR_RETURN_ERROR(
+        prefix_res.ok(),
+        InvalidState,
+        "Failed to digest prompt prefix");
+    if (!FLAGS_prompt_cache_path.empty()) {
+      llama_runtime.SaveCacheSnapshot(FLAGS_prompt_cache_path, prefix_tokens);
+    }
+    cur_token_index = prefix_token_count;
+  }
+  if (cur_token_index == input_tokens.size()) {
+    // Rerun the last token to get its logits
+    llama_runtime.Rollback(1);
+    cur_token_index--;
+  }
+
+  // Speculative decoding accepts the draft tokens that match the greedy prediction, so it only
+  // supports greedy decoding.
+  const bool use_prompt_lookup = draft_runtime == nullptr && FLAGS_prompt_lookup_tokens > 0;
+  std::unique_ptr<Sampler> sampler;
+  if (draft_runtime == nullptr && !use_prompt_lookup) {
+    sampler = make_sampler(tokenizer->vocab_size());
+  }
 
   // Run prompt mode (pre-fill)
-  auto prefill_res = digest_prompt(llama_runtime, tokenizer, input_tokens);
+  const std::vector<uint64_t> remaining_tokens(
+      input_tokens.begin() + cur_token_index, input_tokens.end());
+  auto prefill_res =
+      digest_prompt(llama_runtime, tokenizer, remaining_tokens, sampler.get());
   ET_CHECK_OR_RETURN_ERROR(
       prefill_res.ok(),
       InvalidState,
       "Failed to digest prompt");
   const auto first_output_token = prefill_res.get();
 
+  if (draft_runtime != nullptr) {
+    // The draft model digests the same prompt; its predicted token is superseded by the main model.
+    auto draft_prefill_res = digest_prompt(*draft_runtime, tokenizer, input_tokens);
+    ET_CHECK_OR_RETURN_ERROR(
+        draft_prefill_res.ok(),
+        InvalidState,
+        "Draft model failed to digest prompt");
+    return gen_response_speculative(
+        llama_runtime, draft_runtime, tokenizer, input_tokens, first_output_token);
+  }
+  if (use_prompt_lookup) {
+    return gen_response_speculative(
+        llama_runtime, nullptr, tokenizer, input_tokens, first_output_token);
+  }
+
   // run generation mode (decoding)
-  return gen_response(llama_runtime, tokenizer, first_output_token);
+  return gen_response(llama_runtime, tokenizer, *sampler, input_tokens, first_output_token);
+}
+
+Error serve_sessions(
+    LlamaRuntime& llama_runtime,
+    const std::unique_ptr<Tokenizer>& tokenizer,
+    const std::vector<std::string>& prompts) {
+  LlamaSessionManager session_manager(
+      llama_runtime,
+      tokenizer->vocab_size(),
+      tokenizer->eos_tok(),
+      FLAGS_session_decode_rounds_per_prefill);
+
+  for (const auto& prompt : prompts) {
+    auto encode_res = tokenizer->encode(prompt, kAddBos, kAddEos);
+    ET_CHECK_OR_RETURN_ERROR(
+        encode_res.ok(),
+        InvalidState,
+        "Tokenizer failed to encode prompt");
+    session_manager.AddSession(encode_res.get(), FLAGS_max_response);
+  }
+
+  Timer timer_serve([&](const auto elapsed_sec) {
+    size_t total_tok_count = 0;
+    for (size_t i = 0; i < prompts.size(); i++) {
+      total_tok_count += session_manager.GetResponseTokens(i).size();
+    }
+    ET_LOG(
+        Info,
+        "Served %zu sessions in %f sec, aggregate generation speed: %f tok/s",
+        prompts.size(),
+        elapsed_sec,
+        total_tok_count / elapsed_sec);
+  });
+  timer_serve.Start();
+  while (session_manager.Step()) {
+  }
+  timer_serve.End();
+
+  // The responses are decoded one after the other, reusing the buffers.
+  StreamingDecoder decoder(*tokenizer);
+  std::string response;
+  for (size_t i = 0; i < prompts.size(); i++) {
+    const auto& response_tokens = session_manager.GetResponseTokens(i);
+    const auto eos = std::find(response_tokens.begin(), response_tokens.end(), tokenizer->eos_tok());
+    response.clear();
+    decoder.reset();
+    ET_CHECK_OR_RETURN_ERROR(
+        decoder.decode(response_tokens.data(), eos - response_tokens.begin(),
+                       response_tokens.front(), response) == Error::Ok,
+        InvalidState,
+        "Tokenizer failed to decode the response of session %zu",
+        i);
+    decoder.flush();
+    response += decoder.text();
+    std::cout << "\n[Session " << i << " Input Prompt]\n" << prompts[i] << std::endl;
+    std::cout << "\n[Session " << i << " Response]\n" << response << std::endl;
+    std::cout << "\n[Session " << i << " Generated Tokens]\n"
+              << utils::to_string(response_tokens) << std::endl;
+  }
+  return Error::Ok;
+}
+
+// Runs synthetic prompts of each benchmarked length and generates a fixed number of tokens greedily,
+// ignoring EOS, so that every run of a configuration does the same work.
+util::BenchmarkResult benchmark_run(
+    LlamaRuntime& llama_runtime,
+    const std::unique_ptr<Tokenizer>& tokenizer,
+    const std::vector<uint64_t>& prompt_tokens,
+    const size_t gen_length) {
+  util::BenchmarkResult result;
+  result.requested_prompt_tokens = result.prompt_tokens = prompt_tokens.size();
+  result.requested_generated_tokens = gen_length;
+
+  const auto vocab_size = tokenizer->vocab_size();
+  const auto logits_type = llama_runtime.GetModelOptions().model_output_type;
+  double prefill_sec = 0;
+  double swap_sec = 0;
+  std::vector<double> latencies_ms;
+  Timer timer_prefill([&](const auto elapsed_sec) { prefill_sec = elapsed_sec; });
+  Timer timer_model_swap([&](const auto elapsed_sec) { swap_sec = elapsed_sec; });
+  Timer timer_gen_token([&](const auto elapsed_sec) {
+    latencies_ms.push_back(elapsed_sec * 1000);
+  });
+
+  llama_runtime.Reset();
+  llama_runtime.ResetProfile();
+
+  timer_prefill.Start();
+  auto prefill_res = digest_prompt(llama_runtime, tokenizer, prompt_tokens);
+  timer_prefill.End();
+  ET_CHECK_MSG(prefill_res.ok(), "Failed to digest benchmark prompt");
+  uint64_t output_token = prefill_res.get();
+
+  timer_model_swap.Start();
+  llama_runtime.SwapModel(1);
+  timer_model_swap.End();
+
+  // The first token comes from the prompt pass.
+  size_t gen_tok_count = 1;
+  while (gen_tok_count < gen_length
+         && (FLAGS_streaming || llama_runtime.GetTokenIndex() < FLAGS_max_token_length)) {
+    timer_gen_token.Start();
+    void* logits = llama_runtime.Run({output_token});
+    output_token = utils::argmax(logits_type, logits, vocab_size);
+    timer_gen_token.End();
+    gen_tok_count++;
+  }
+
+  result.generated_tokens = gen_tok_count;
+  result.ttft_ms = prefill_sec * 1000;
+  result.prefill_tokens_per_second = prompt_tokens.size() / prefill_sec;
+  result.token_latency = util::summarize_latencies(latencies_ms);
+  if (!latencies_ms.empty()) {
+    result.decode_tokens_per_second = 1000 / result.token_latency.mean_ms;
+  }
+  result.peak_rss_kb = util::peak_rss_kb();
+
+  const auto& profile = llama_runtime.GetProfile();
+  result.breakdown_ms = {
+    {"prefill", prefill_sec * 1000},
+    {"model_swap", swap_sec * 1000},
+    {"decode", result.token_latency.mean_ms * latencies_ms.size()},
+    {"token_embedding", profile.embeddingSec * 1000},
+    {"neuron_wait", profile.waitSec * 1000},
+  };
+  for (size_t i = 0; i < profile.chunkSec.size(); i++) {
+    result.breakdown_ms.emplace_back("chunk_" + std::to_string(i), profile.chunkSec[i] * 1000);
+  }
+  return result;
+}
+
+Error benchmark(LlamaRuntime& llama_runtime, const std::unique_ptr<Tokenizer>& tokenizer) {
+  util::BenchmarkReport report("mtk_llama");
+  report.add_metadata("prompt_model_paths", FLAGS_prompt_model_paths);
+  report.add_metadata("gen_model_paths", FLAGS_gen_model_paths);
+  report.add_metadata("prompt_token_batch_size", std::to_string(FLAGS_prompt_token_batch_size));
+  report.add_metadata("cache_size", std::to_string(FLAGS_cache_size));
+  report.add_metadata("ring_cache", FLAGS_ring_cache ? "true" : "false");
+  if (!FLAGS_model_precision.empty()) {
+    report.add_metadata("model_precision", FLAGS_model_precision);
+  }
+
+  // Synthetic prompts repeat a common token, so that their lengths are exact.
+  auto encode_res = tokenizer->encode(" the", 0, 0);
+  ET_CHECK_OR_RETURN_ERROR(
+      encode_res.ok() && !encode_res.get().empty(),
+      InvalidState,
+      "Tokenizer failed to encode the benchmark prompt");
+  const uint64_t filler_token = encode_res.get().back();
+
+  llama_runtime.EnableProfiling();
+  for (const auto& prompt_length_str : utils::split(FLAGS_benchmark_prompt_lengths, ',')) {
+    const size_t prompt_length = std::stoul(prompt_length_str);
+    ET_CHECK_OR_RETURN_ERROR(
+        prompt_length > 0 && prompt_length < FLAGS_max_token_length,
+        InvalidArgument,
+        "Benchmark prompt length %zu must be within [1, %" PRIu64 ")",
+        prompt_length,
+        FLAGS_max_token_length);
+    std::vector<uint64_t> prompt_tokens(prompt_length, filler_token);
+    prompt_tokens.front() = tokenizer->bos_tok();
+
+    for (const auto& gen_length_str : utils::split(FLAGS_benchmark_gen_lengths, ',')) {
+      const size_t gen_length = std::stoul(gen_length_str);
+      for (size_t run = 0; run < FLAGS_benchmark_warmup + FLAGS_benchmark_repeats; run++) {
+        auto result = benchmark_run(llama_runtime, tokenizer, prompt_tokens, gen_length);
+        ET_LOG(
+            Info,
+            "Benchmark %zu+%zu tokens: TTFT %f ms, %f tok/s, p99 %f ms%s",
+            prompt_length,
+            gen_length,
+            result.ttft_ms,
+            result.decode_tokens_per_second,
+            result.token_latency.p99_ms,
+            run < FLAGS_benchmark_warmup ? " (warmup)" : "");
+        if (run >= FLAGS_benchmark_warmup) {
+          report.add_result(std::move(result));
+        }
+      }
+    }
+  }
+  llama_runtime.EnableProfiling(false);
+
+  ET_CHECK_OR_RETURN_ERROR(
+      report.write(FLAGS_benchmark_output),
+      AccessFailed,
+      "Failed to write the benchmark report to %s",
+      FLAGS_benchmark_output.c_str());
+  return Error::Ok;
 }
 
 std::unique_ptr<Tokenizer> load_tokenizer() {
@@ -326,23 +1020,58 @@ int main(int argc, char** argv) {
   Timer timer_release(
       [](const auto elapsed_sec) { ET_LOG(Info, "Model released."); });
 
+  if (FLAGS_buffer_arena_slab_mb > 0) {
+    GET_NEURON_ALLOCATOR.EnableArena(FLAGS_buffer_arena_slab_mb * 1024 * 1024);
+  }
+
   LlamaRuntime llama_runtime;
+  const bool use_draft_model = !FLAGS_draft_gen_model_paths.empty();
+  std::unique_ptr<LlamaRuntime> draft_runtime;
 
   // Initialize model
   ET_LOG(Info, "Begin model loading.");
   timer_init.Start();
   const auto tokenizer = load_tokenizer();
   llama_runtime.Initialize(model_options, model_paths);
+  if (use_draft_model) {
+    ET_CHECK_MSG(
+        !model_paths.prompt_model_paths.empty(),
+        "Speculative decoding verifies the draft tokens with the prompt model.");
+    LlamaModelOptions draft_model_options = get_draft_model_options();
+    LlamaModelPaths draft_model_paths = get_draft_model_paths();
+    if (draft_model_paths.prompt_model_paths.empty()) {
+      draft_model_options.prompt_token_batch_size = 1;
+    }
+    draft_runtime = std::make_unique<LlamaRuntime>();
+    draft_runtime->Initialize(draft_model_options, draft_model_paths);
+  }
   timer_init.End();
 
   // Run model
-  ET_CHECK_MSG(!FLAGS_prompt_file.empty(), "No prompt file provided.");
-  std::string prompt = utils::read_file(FLAGS_prompt_file);
-  inference(llama_runtime, tokenizer, prompt);
+  if (!FLAGS_benchmark_prompt_lengths.empty()) {
+    benchmark(llama_runtime, tokenizer);
+  } else if (!FLAGS_session_prompt_files.empty()) {
+    std::vector<std::string> prompts;
+    for (const auto& prompt_file : utils::split(FLAGS_session_prompt_files, ',')) {
+      prompts.push_back(utils::read_file(prompt_file));
+    }
+    serve_sessions(llama_runtime, tokenizer, prompts);
+  } else {
+    ET_CHECK_MSG(!FLAGS_prompt_file.empty(), "No prompt file provided.");
+    std::string prompt = utils::read_file(FLAGS_prompt_file);
+    std::string prompt_prefix;
+    if (!FLAGS_prompt_prefix_file.empty()) {
+      prompt_prefix = utils::read_file(FLAGS_prompt_prefix_file);
+    }
+    inference(llama_runtime, draft_runtime.get(), tokenizer, prompt_prefix, prompt);
+  }
 
   // Release model
   timer_release.Start();
   llama_runtime.Release();
+  if (draft_runtime) {
+    draft_runtime->Release();
+  }
   timer_release.End();
 
   return 0;
@@ -15,6 +15,15 @@ MODEL_NAME_TO_MODEL = {
     "emformer_transcribe": ("emformer_rnnt", "EmformerRnntTranscriberModel"),
     "emformer_predict": ("emformer_rnnt", "EmformerRnntPredictorModel"),
     "emformer_join": ("emformer_rnnt", "EmformerRnntJoinerModel"),
+    "emformer_transcribe_streaming": (
+        "emformer_rnnt",
+        "EmformerRnntStreamingTranscriberModel",
+    ),
+    "emformer_predict_streaming": (
+        "emformer_rnnt",
+        "EmformerRnntStreamingPredictorModel",
+    ),
+    "emformer_join_streaming": ("emformer_rnnt", "EmformerRnntStreamingJoinerModel"),
     "llama2": ("llama2", "Llama2Model"),
     "mobilebert": ("mobilebert", "MobileBertModelExample"),
     "mv2": ("mobilenet_v2", "MV2Model"),
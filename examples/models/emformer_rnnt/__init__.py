@@ -7,6 +7,9 @@
 from .model import (
     EmformerRnntJoinerModel,
     EmformerRnntPredictorModel,
+    EmformerRnntStreamingJoinerModel,
+    EmformerRnntStreamingPredictorModel,
+    EmformerRnntStreamingTranscriberModel,
     EmformerRnntTranscriberModel,
 )
 
@@ -14,4 +17,7 @@ __all__ = [
     EmformerRnntTranscriberModel,
     EmformerRnntPredictorModel,
     EmformerRnntJoinerModel,
+    EmformerRnntStreamingTranscriberModel,
+    EmformerRnntStreamingPredictorModel,
+    EmformerRnntStreamingJoinerModel,
 ]
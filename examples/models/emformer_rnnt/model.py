@@ -21,6 +21,9 @@ __all__ = [
     "EmformerRnntTranscriberModel",
     "EmformerRnntPredictorModel",
     "EmformerRnntJoinerModel",
+    "EmformerRnntStreamingTranscriberModel",
+    "EmformerRnntStreamingPredictorModel",
+    "EmformerRnntStreamingJoinerModel",
 ]
 
 
@@ -130,3 +133,131 @@ class EmformerRnntJoinerModel(EagerModelBase):
             torch.tensor([128]),
         )
         return (join_inputs,)
+
+
+class _StreamingState(torch.nn.Module):
+    """
+    Keeps a torchaudio state, a list of lists of tensors, in buffers. Exported
+    programs place the buffers in planned memory and update them in place, so
+    the state stays resident in the method between calls without being passed
+    in and out. The state is initially all zeros, like the states torchaudio
+    creates when given None.
+    """
+
+    def __init__(self, state) -> None:
+        super().__init__()
+        self.layout = [len(layer) for layer in state]
+        for i, layer in enumerate(state):
+            for j, tensor in enumerate(layer):
+                self.register_buffer(f"state_{i}_{j}", torch.zeros_like(tensor))
+
+    def get(self):
+        return [
+            [getattr(self, f"state_{i}_{j}") for j in range(n)]
+            for i, n in enumerate(self.layout)
+        ]
+
+    def update(self, state) -> None:
+        for i, layer in enumerate(state):
+            for j, tensor in enumerate(layer):
+                getattr(self, f"state_{i}_{j}").copy_(tensor)
+
+
+class EmformerRnntStreamingTranscriberExample(torch.nn.Module):
+    """
+    Transcribes one segment of an audio stream, with the right context frames
+    that the next segment starts with. The Emformer state stays in the model,
+    see _StreamingState.
+    """
+
+    def __init__(self) -> None:
+        super().__init__()
+        bundle = torchaudio.pipelines.EMFORMER_RNNT_BASE_LIBRISPEECH
+        self.rnnt = bundle.get_decoder().model
+        self.num_frames = bundle.segment_length + bundle.right_context_length
+        _, _, state = self.rnnt.transcribe_streaming(
+            torch.zeros(1, self.num_frames, 80), torch.tensor([self.num_frames]), None
+        )
+        self.state = _StreamingState(state)
+
+    def forward(self, sources, source_lengths):
+        output, output_lengths, state = self.rnnt.transcribe_streaming(
+            sources, source_lengths, self.state.get()
+        )
+        self.state.update(state)
+        return output, output_lengths
+
+
+class EmformerRnntStreamingTranscriberModel(EagerModelBase):
+    def __init__(self):
+        pass
+
+    def get_eager_model(self) -> torch.nn.Module:
+        logging.info("Loading emformer rnnt streaming transcriber")
+        m = EmformerRnntStreamingTranscriberExample()
+        logging.info("Loaded emformer rnnt streaming transcriber")
+        return m
+
+    def get_example_inputs(self):
+        bundle = torchaudio.pipelines.EMFORMER_RNNT_BASE_LIBRISPEECH
+        num_frames = bundle.segment_length + bundle.right_context_length
+        return (torch.randn(1, num_frames, 80), torch.tensor([num_frames]))
+
+
+class EmformerRnntStreamingPredictorExample(torch.nn.Module):
+    """
+    Predicts from the last emitted token, keeping the LSTM state in the model,
+    see _StreamingState.
+    """
+
+    def __init__(self) -> None:
+        super().__init__()
+        bundle = torchaudio.pipelines.EMFORMER_RNNT_BASE_LIBRISPEECH
+        self.rnnt = bundle.get_decoder().model
+        _, _, state = self.rnnt.predict(
+            torch.zeros([1, 1], dtype=int), torch.tensor([1], dtype=int), None
+        )
+        self.state = _StreamingState(state)
+
+    def forward(self, targets, target_lengths):
+        output, output_lengths, state = self.rnnt.predict(
+            targets, target_lengths, self.state.get()
+        )
+        self.state.update(state)
+        return output, output_lengths
+
+
+class EmformerRnntStreamingPredictorModel(EagerModelBase):
+    def __init__(self):
+        pass
+
+    def get_eager_model(self) -> torch.nn.Module:
+        logging.info("Loading emformer rnnt streaming predictor")
+        m = EmformerRnntStreamingPredictorExample()
+        logging.info("Loaded emformer rnnt streaming predictor")
+        return m
+
+    def get_example_inputs(self):
+        return (torch.zeros([1, 1], dtype=int), torch.tensor([1], dtype=int))
+
+
+class EmformerRnntStreamingJoinerModel(EagerModelBase):
+    """The joiner, for one encoder frame and one predictor output at a time."""
+
+    def __init__(self):
+        pass
+
+    def get_eager_model(self) -> torch.nn.Module:
+        logging.info("Loading emformer rnnt joiner")
+        m = EmformerRnntJoinerExample()
+        logging.info("Loaded emformer rnnt joiner")
+        return m
+
+    def get_example_inputs(self):
+        join_inputs = (
+            torch.rand([1, 1, 1024]),
+            torch.tensor([1]),
+            torch.rand([1, 1, 1024]),
+            torch.tensor([1]),
+        )
+        return (join_inputs,)
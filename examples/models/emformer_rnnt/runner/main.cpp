@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Transcribes a file of log-mel features with the streaming Emformer RNN-T
+// models, printing the token ids of each segment as it is decoded. The
+// features are raw float32 frames, e.g. the output of torchaudio's
+// EMFORMER_RNNT_BASE_LIBRISPEECH streaming feature extractor saved with
+// `features.numpy().tofile(path)`. Map the token ids to text with the
+// bundle's token processor.
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include <executorch/examples/models/emformer_rnnt/runner/streaming_asr_runner.h>
+#include <executorch/runtime/platform/log.h>
+
+DEFINE_string(
+    transcriber_path,
+    "emformer_transcribe_streaming.pte",
+    "Streaming transcriber serialized in flatbuffer format.");
+
+DEFINE_string(
+    predictor_path,
+    "emformer_predict_streaming.pte",
+    "Streaming predictor serialized in flatbuffer format.");
+
+DEFINE_string(
+    joiner_path,
+    "emformer_join_streaming.pte",
+    "Streaming joiner serialized in flatbuffer format.");
+
+DEFINE_string(features_path, "features.bin", "Raw float32 feature frames.");
+
+DEFINE_int32(
+    right_context_frames,
+    4,
+    "Lookahead frames at the end of each transcriber input.");
+
+DEFINE_int64(blank_id, 4096, "The blank token of the model.");
+
+int32_t main(int32_t argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  torch::executor::StreamingAsrRunner runner(
+      FLAGS_transcriber_path,
+      FLAGS_predictor_path,
+      FLAGS_joiner_path,
+      FLAGS_right_context_frames,
+      FLAGS_blank_id);
+  if (runner.load() != torch::executor::Error::Ok) {
+    ET_LOG(Error, "Failed to load the models");
+    return 1;
+  }
+
+  FILE* features = fopen(FLAGS_features_path.c_str(), "rb");
+  if (features == nullptr) {
+    ET_LOG(Error, "Failed to open %s", FLAGS_features_path.c_str());
+    return 1;
+  }
+  const size_t num_features = runner.num_features();
+  const auto error = runner.transcribe(
+      [&](float* frames, size_t max_frames) {
+        return fread(
+            frames, sizeof(float) * num_features, max_frames, features);
+      },
+      [](int64_t token) {
+        printf("%" PRId64 " ", token);
+        fflush(stdout);
+      },
+      [](const torch::executor::StreamingAsrRunner::Stats& stats) {
+        long max_latency_us = 0;
+        for (long latency_us : stats.segment_latencies_us) {
+          max_latency_us = std::max(max_latency_us, latency_us);
+        }
+        printf(
+            "\n%" PRId64 " tokens in %ld ms of audio, real-time factor %.3f, "
+            "max segment latency %ld us\n",
+            stats.num_tokens,
+            stats.audio_ms,
+            stats.real_time_factor(),
+            max_latency_us);
+      });
+  fclose(features);
+  return error == torch::executor::Error::Ok ? 0 : 1;
+}
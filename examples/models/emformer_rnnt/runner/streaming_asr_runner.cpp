@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/examples/models/emformer_rnnt/runner/streaming_asr_runner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+
+#include <executorch/runtime/platform/log.h>
+
+namespace torch::executor {
+namespace {
+// The number of I/O buffer sets of the transcriber.
+constexpr size_t kNumInputSets = 2;
+// Feature frames are 10 ms apart.
+constexpr long kFrameMs = 10;
+
+long time_in_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+Result<const float*> float_output(const EValue& value) {
+  ET_CHECK_OR_RETURN_ERROR(
+      value.isTensor() &&
+          value.toTensor().scalar_type() == exec_aten::ScalarType::Float,
+      InvalidProgram,
+      "Expected a float tensor output");
+  return value.toTensor().const_data_ptr<float>();
+}
+} // namespace
+
+StreamingAsrRunner::StreamingAsrRunner(
+    const std::string& transcriber_path,
+    const std::string& predictor_path,
+    const std::string& joiner_path,
+    int32_t right_context_frames,
+    int64_t blank_id,
+    int32_t max_symbols_per_frame)
+    : transcriber_path_(transcriber_path),
+      predictor_path_(predictor_path),
+      joiner_path_(joiner_path),
+      right_context_frames_(right_context_frames),
+      blank_id_(blank_id),
+      max_symbols_per_frame_(max_symbols_per_frame) {
+  ET_LOG(
+      Info,
+      "Creating streaming ASR runner: transcriber_path=%s, predictor_path=%s, joiner_path=%s",
+      transcriber_path.c_str(),
+      predictor_path.c_str(),
+      joiner_path.c_str());
+}
+
+bool StreamingAsrRunner::is_loaded() const {
+  return transcriber_method_ != nullptr && predictor_method_ != nullptr &&
+      joiner_method_ != nullptr;
+}
+
+Error StreamingAsrRunner::load() {
+  if (is_loaded()) {
+    return Error::Ok;
+  }
+  transcriber_ = std::make_unique<Module>(
+      transcriber_path_, Module::MlockConfig::UseMlockIgnoreErrors);
+  predictor_ = std::make_unique<Module>(
+      predictor_path_, Module::MlockConfig::UseMlockIgnoreErrors);
+  if (joiner_ == nullptr) {
+    joiner_ = std::make_unique<Module>(
+        joiner_path_, Module::MlockConfig::UseMlockIgnoreErrors);
+  }
+
+  // The transcriber takes [1, window_frames, num_features] features and
+  // their length.
+  const auto transcriber_meta = transcriber_->method_meta("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(transcriber_meta.error());
+  const auto features_meta = transcriber_meta->input_tensor_meta(0);
+  ET_CHECK_OK_OR_RETURN_ERROR(features_meta.error());
+  const auto sizes = features_meta->sizes();
+  ET_CHECK_OR_RETURN_ERROR(
+      sizes.size() == 3 && sizes[0] == 1 &&
+          features_meta->scalar_type() == exec_aten::ScalarType::Float,
+      InvalidProgram,
+      "Expected [1, frames, features] float features");
+  window_frames_ = sizes[1];
+  num_features_ = sizes[2];
+  ET_CHECK_OR_RETURN_ERROR(
+      window_frames_ > static_cast<size_t>(right_context_frames_),
+      InvalidArgument,
+      "%zu frames per input leave no room for %" PRId32 " context frames",
+      window_frames_,
+      right_context_frames_);
+
+  auto transcriber_method = transcriber_->bind_method("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(transcriber_method.error());
+  transcriber_method_ = transcriber_method.get();
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      transcriber_method_->experimental_allocate_io_buffer_sets(
+          kNumInputSets));
+  for (size_t set = 0; set < kNumInputSets; ++set) {
+    auto lengths = transcriber_method_->experimental_input_buffer(set, 1);
+    ET_CHECK_OK_OR_RETURN_ERROR(lengths.error());
+    ET_CHECK_OR_RETURN_ERROR(
+        lengths->size() == sizeof(int64_t),
+        InvalidProgram,
+        "Expected a single int64 length");
+    const int64_t window = window_frames_;
+    std::memcpy(lengths->data(), &window, sizeof(window));
+  }
+
+  auto predictor_method = predictor_->bind_method("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(predictor_method.error());
+  predictor_method_ = predictor_method.get();
+  auto joiner_method = joiner_->bind_method("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(joiner_method.error());
+  joiner_method_ = joiner_method.get();
+
+  // The encodings and predictor outputs are [1, 1, encoding_dim].
+  const auto joiner_meta = joiner_->method_meta("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(joiner_meta.error());
+  const auto encoding_meta = joiner_meta->input_tensor_meta(0);
+  ET_CHECK_OK_OR_RETURN_ERROR(encoding_meta.error());
+  encoding_dim_ = encoding_meta->sizes()[2];
+  encoding_.assign(encoding_dim_, 0.0f);
+  predictor_output_.assign(encoding_dim_, 0.0f);
+  const auto dim = static_cast<ManagedTensor::SizesType>(encoding_dim_);
+  encoding_tensor_ = std::make_unique<ManagedTensor>(
+      encoding_.data(),
+      encoding_dim_,
+      std::vector<ManagedTensor::SizesType>{1, 1, dim},
+      ScalarType::Float);
+  predictor_output_tensor_ = std::make_unique<ManagedTensor>(
+      predictor_output_.data(),
+      encoding_dim_,
+      std::vector<ManagedTensor::SizesType>{1, 1, dim},
+      ScalarType::Float);
+  token_tensor_ = std::make_unique<ManagedTensor>(
+      &token_,
+      1,
+      std::vector<ManagedTensor::SizesType>{1, 1},
+      ScalarType::Long);
+  length_tensor_ = std::make_unique<ManagedTensor>(
+      &one_, 1, std::vector<ManagedTensor::SizesType>{1}, ScalarType::Long);
+
+  // Decoding starts from the prediction for the blank token.
+  return predict(blank_id_);
+}
+
+Error StreamingAsrRunner::reset() {
+  transcriber_method_ = nullptr;
+  predictor_method_ = nullptr;
+  transcriber_.reset();
+  predictor_.reset();
+  return load();
+}
+
+Error StreamingAsrRunner::predict(int64_t token) {
+  token_ = token;
+  EValue inputs[] = {
+      token_tensor_->get_aliasing_tensor(),
+      length_tensor_->get_aliasing_tensor()};
+  EValue outputs[1];
+  ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+      *predictor_method_,
+      Span<const EValue>(inputs, 2),
+      Span<EValue>(outputs, 1)));
+  auto output = float_output(outputs[0]);
+  ET_CHECK_OK_OR_RETURN_ERROR(output.error());
+  std::copy(
+      output.get(), output.get() + encoding_dim_, predictor_output_.begin());
+  return Error::Ok;
+}
+
+Error StreamingAsrRunner::decode_frame(
+    const float* encoding,
+    const std::function<void(int64_t)>& token_callback) {
+  std::copy(encoding, encoding + encoding_dim_, encoding_.begin());
+  EValue inputs[] = {
+      encoding_tensor_->get_aliasing_tensor(),
+      length_tensor_->get_aliasing_tensor(),
+      predictor_output_tensor_->get_aliasing_tensor(),
+      length_tensor_->get_aliasing_tensor()};
+  for (int32_t i = 0; i < max_symbols_per_frame_; ++i) {
+    EValue outputs[1];
+    ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+        *joiner_method_,
+        Span<const EValue>(inputs, 4),
+        Span<EValue>(outputs, 1)));
+    auto logits = float_output(outputs[0]);
+    ET_CHECK_OK_OR_RETURN_ERROR(logits.error());
+    const size_t num_symbols = outputs[0].toTensor().numel();
+    const int64_t token =
+        std::max_element(logits.get(), logits.get() + num_symbols) -
+        logits.get();
+    if (token == blank_id_) {
+      break;
+    }
+    stats_.num_tokens++;
+    if (token_callback) {
+      token_callback(token);
+    }
+    ET_CHECK_OK_OR_RETURN_ERROR(predict(token));
+  }
+  return Error::Ok;
+}
+
+size_t StreamingAsrRunner::read_input(
+    FeatureSource& source,
+    size_t set,
+    size_t prev_set,
+    bool first) {
+  // Only the buffers of a set that is not executing are touched here.
+  auto* frames = reinterpret_cast<float*>(
+      transcriber_method_->experimental_input_buffer(set, 0)->data());
+  size_t offset = 0;
+  if (!first) {
+    const auto* prev = reinterpret_cast<const float*>(
+        transcriber_method_->experimental_input_buffer(prev_set, 0)->data());
+    offset = right_context_frames_;
+    std::memcpy(
+        frames,
+        prev + (window_frames_ - offset) * num_features_,
+        offset * num_features_ * sizeof(float));
+  }
+  const size_t wanted = window_frames_ - offset;
+  const size_t read =
+      std::min(source(frames + offset * num_features_, wanted), wanted);
+  std::fill(
+      frames + (offset + read) * num_features_,
+      frames + window_frames_ * num_features_,
+      0.0f);
+  return read;
+}
+
+Error StreamingAsrRunner::transcribe(
+    FeatureSource source,
+    std::function<void(int64_t)> token_callback,
+    std::function<void(const Stats&)> stats_callback) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load());
+  stats_ = {};
+
+  size_t set = 0;
+  const size_t read = read_input(source, set, set, /*first=*/true);
+  stats_.audio_ms += read * kFrameMs;
+  // An input that is not full ends the stream.
+  bool last = read < window_frames_;
+  while (read > 0) {
+    // Read the next input into the other set while this one runs.
+    std::future<size_t> next;
+    if (!last) {
+      next = std::async(std::launch::async, [this, &source, set]() {
+        return read_input(source, 1 - set, set, /*first=*/false);
+      });
+    }
+
+    const long start_us = time_in_us();
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        transcriber_method_->experimental_select_io_buffer_set(set));
+    ET_CHECK_OK_OR_RETURN_ERROR(transcriber_method_->execute());
+    auto encodings = float_output(transcriber_method_->get_output(0));
+    ET_CHECK_OK_OR_RETURN_ERROR(encodings.error());
+    const size_t num_encodings =
+        transcriber_method_->get_output(0).toTensor().numel() / encoding_dim_;
+    for (size_t i = 0; i < num_encodings; ++i) {
+      ET_CHECK_OK_OR_RETURN_ERROR(
+          decode_frame(encodings.get() + i * encoding_dim_, token_callback));
+    }
+    const long latency_us = time_in_us() - start_us;
+    stats_.segment_latencies_us.push_back(latency_us);
+    stats_.compute_ms += latency_us / 1000;
+
+    if (last) {
+      break;
+    }
+    const size_t next_read = next.get();
+    stats_.audio_ms += next_read * kFrameMs;
+    // Even an input without new frames runs, to transcribe the right context
+    // of this one.
+    last = next_read < window_frames_ - right_context_frames_;
+    set = 1 - set;
+  }
+
+  if (stats_callback) {
+    stats_callback(stats_);
+  }
+  return Error::Ok;
+}
+
+} // namespace torch::executor
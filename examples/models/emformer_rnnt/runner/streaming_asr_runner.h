@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// A streaming speech recognition runner for the Emformer RNN-T models
+// exported as emformer_transcribe_streaming, emformer_predict_streaming and
+// emformer_join_streaming. It consumes log-mel feature frames segment by
+// segment and emits the tokens of each segment as soon as it is decoded.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/runner_util/managed_tensor.h>
+
+namespace torch::executor {
+
+class StreamingAsrRunner {
+ public:
+  /**
+   * Writes up to `max_frames` feature frames, each of `num_features()`
+   * floats, to `frames` and returns the number written. Returning fewer than
+   * `max_frames` ends the stream. Called on a worker thread, one call at a
+   * time, while the previous segment is being transcribed.
+   */
+  using FeatureSource = std::function<size_t(float* frames, size_t max_frames)>;
+
+  struct Stats {
+    // Duration of the audio, at 10 ms per feature frame.
+    long audio_ms;
+    // Time spent executing the models, excluding waiting for features.
+    long compute_ms;
+    // For each segment, the time from its features being available to its
+    // last token being emitted, in microseconds. This bounds the latency of
+    // the partial results.
+    std::vector<long> segment_latencies_us;
+    // Number of emitted tokens.
+    int64_t num_tokens;
+
+    // Compute time over audio time. Below 1 keeps up with live audio.
+    double real_time_factor() const {
+      return audio_ms > 0 ? static_cast<double>(compute_ms) / audio_ms : 0.0;
+    }
+  };
+
+  /**
+   * @param[in] right_context_frames The number of frames at the end of each
+   *     transcriber input that are only lookahead, and start the next input.
+   *     4 for EMFORMER_RNNT_BASE_LIBRISPEECH.
+   * @param[in] blank_id The token that ends the symbols of a frame.
+   * @param[in] max_symbols_per_frame Bounds the tokens decoded per frame.
+   */
+  explicit StreamingAsrRunner(
+      const std::string& transcriber_path,
+      const std::string& predictor_path,
+      const std::string& joiner_path,
+      int32_t right_context_frames = 4,
+      int64_t blank_id = 4096,
+      int32_t max_symbols_per_frame = 10);
+
+  bool is_loaded() const;
+  Error load();
+
+  /**
+   * Starts a new utterance. The transcriber and predictor keep their state
+   * in planned memory between calls, so this reloads them to clear it.
+   */
+  Error reset();
+
+  /**
+   * Transcribes a stream of features, continuing the current utterance.
+   * Reading the features of a segment overlaps with transcribing the
+   * previous one.
+   *
+   * @param[in] source Provides the features.
+   * @param[in] token_callback Called with each decoded token id.
+   * @param[in] stats_callback Called with the stats of the stream.
+   */
+  Error transcribe(
+      FeatureSource source,
+      std::function<void(int64_t)> token_callback = {},
+      std::function<void(const Stats&)> stats_callback = {});
+
+  /// The number of floats per feature frame. Valid after load().
+  size_t num_features() const {
+    return num_features_;
+  }
+
+ private:
+  // Runs the predictor on `token`, updating predictor_output_.
+  Error predict(int64_t token);
+  // Decodes one encoder frame greedily, emitting its tokens.
+  Error decode_frame(
+      const float* encoding,
+      const std::function<void(int64_t)>& token_callback);
+  // Fills the transcriber input of I/O buffer set `set`, starting with the
+  // right context of `prev_set` unless it is the first input. Returns the
+  // number of new frames; the rest of the input is zeroed.
+  size_t
+  read_input(FeatureSource& source, size_t set, size_t prev_set, bool first);
+
+  const std::string transcriber_path_;
+  const std::string predictor_path_;
+  const std::string joiner_path_;
+  const int32_t right_context_frames_;
+  const int64_t blank_id_;
+  const int32_t max_symbols_per_frame_;
+
+  std::unique_ptr<Module> transcriber_;
+  std::unique_ptr<Module> predictor_;
+  std::unique_ptr<Module> joiner_;
+  // The transcriber reads its inputs from two I/O buffer sets, so that the
+  // next segment is read while the current one runs.
+  Method* transcriber_method_ = nullptr;
+  Method* predictor_method_ = nullptr;
+  Method* joiner_method_ = nullptr;
+
+  size_t num_features_ = 0;
+  size_t window_frames_ = 0;
+  size_t encoding_dim_ = 0;
+
+  // Joiner and predictor inputs.
+  std::vector<float> encoding_;
+  std::vector<float> predictor_output_;
+  int64_t token_ = 0;
+  int64_t one_ = 1;
+  std::unique_ptr<ManagedTensor> encoding_tensor_;
+  std::unique_ptr<ManagedTensor> predictor_output_tensor_;
+  std::unique_ptr<ManagedTensor> token_tensor_;
+  std::unique_ptr<ManagedTensor> length_tensor_;
+
+  Stats stats_;
+};
+
+} // namespace torch::executor
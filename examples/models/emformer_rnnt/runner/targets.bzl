@@ -0,0 +1,34 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "get_oss_build_kwargs", "runtime")
+
+def define_common_targets():
+    runtime.cxx_library(
+        name = "streaming_asr_runner",
+        srcs = [
+            "streaming_asr_runner.cpp",
+        ],
+        exported_headers = [
+            "streaming_asr_runner.h",
+        ],
+        visibility = [
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/extension/module:module",
+            "//executorch/extension/runner_util:managed_tensor",
+            "//executorch/kernels/portable:generated_lib",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "main",
+        srcs = [
+            "main.cpp",
+        ],
+        deps = [
+            ":streaming_asr_runner",
+        ],
+        external_deps = [
+            "gflags",
+        ],
+        **get_oss_build_kwargs()
+    )
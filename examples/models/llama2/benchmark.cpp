@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Benchmarks the llama runner over a sweep of prompt and generation lengths,
+// and writes the measurements as JSON.
+
+#include <gflags/gflags.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <executorch/examples/models/llama2/runner/benchmark_report.h>
+#include <executorch/examples/models/llama2/runner/runner.h>
+#include <executorch/examples/models/llama2/runner/util.h>
+
+#if defined(ET_USE_THREADPOOL)
+#include <executorch/backends/xnnpack/threadpool/cpuinfo_utils.h>
+#include <executorch/backends/xnnpack/threadpool/threadpool.h>
+#endif
+
+DEFINE_string(
+    model_path,
+    "llama2.pte",
+    "Model serialized in flatbuffer format.");
+
+DEFINE_string(tokenizer_path, "tokenizer.bin", "Tokenizer stuff.");
+
+DEFINE_string(
+    prompt_lengths,
+    "16,64,256",
+    "Comma-separated prompt lengths to benchmark, in tokens.");
+
+DEFINE_string(
+    generation_lengths,
+    "32,128",
+    "Comma-separated numbers of tokens to generate for each prompt length.");
+
+DEFINE_int32(repeats, 3, "Number of runs of each configuration.");
+
+DEFINE_int32(warmup, 1, "Number of discarded runs before the measured ones.");
+
+DEFINE_double(
+    temperature,
+    0,
+    "Temperature; Default is 0 (greedy argmax sampling), which makes runs reproducible.");
+
+DEFINE_int32(
+    cpu_threads,
+    -1,
+    "Number of CPU threads for inference. Defaults to -1, which implies we'll use a heuristic to derive the # of performant cores for a specific device.");
+
+DEFINE_string(
+    output_path,
+    "llama_benchmark.json",
+    "Where to write the JSON report. The runner prints the generated text to stdout.");
+
+namespace {
+
+using ::torch::executor::Runner;
+using ::torch::executor::util::BenchmarkReport;
+using ::torch::executor::util::BenchmarkResult;
+
+std::vector<int32_t> parse_lengths(const std::string& lengths) {
+  std::vector<int32_t> parsed;
+  std::stringstream ss(lengths);
+  std::string length;
+  while (std::getline(ss, length, ',')) {
+    if (!length.empty()) {
+      parsed.push_back(std::stoi(length));
+    }
+  }
+  return parsed;
+}
+
+// A prompt of about `num_tokens` tokens, including BOS: most tokenizers encode
+// each repeated word to a single token.
+std::string make_prompt(int32_t num_tokens) {
+  std::string prompt = "the";
+  for (int32_t i = 2; i < num_tokens; i++) {
+    prompt += " the";
+  }
+  return prompt;
+}
+
+BenchmarkResult to_result(
+    const Runner::Stats& stats,
+    int32_t prompt_length,
+    int32_t generation_length) {
+  BenchmarkResult result;
+  result.requested_prompt_tokens = prompt_length;
+  result.requested_generated_tokens = generation_length;
+  result.prompt_tokens = stats.num_prompt_tokens;
+  result.generated_tokens = stats.num_generated_tokens;
+
+  // The prompt is evaluated once the step generating the first token ran.
+  result.ttft_ms = stats.prompt_eval_end_ms - stats.inference_start_ms;
+  if (result.ttft_ms > 0) {
+    result.prefill_tokens_per_second =
+        stats.num_prompt_tokens * 1000.0 / result.ttft_ms;
+  }
+
+  std::vector<double> latencies_ms;
+  double decode_ms = 0;
+  for (const long latency_us : stats.token_latencies_us) {
+    latencies_ms.push_back(latency_us / 1000.0);
+    decode_ms += latency_us / 1000.0;
+  }
+  result.token_latency =
+      ::torch::executor::util::summarize_latencies(latencies_ms);
+  if (decode_ms > 0) {
+    result.decode_tokens_per_second = latencies_ms.size() * 1000.0 / decode_ms;
+  }
+  result.peak_rss_kb = ::torch::executor::util::peak_rss_kb();
+
+  result.breakdown_ms = {
+      {"prefill", static_cast<double>(result.ttft_ms)},
+      {"decode",
+       static_cast<double>(stats.inference_end_ms - stats.prompt_eval_end_ms)},
+      {"sampling", static_cast<double>(stats.aggregate_sampling_time_ms)},
+  };
+  return result;
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+#if defined(ET_USE_THREADPOOL)
+  uint32_t num_performant_cores = FLAGS_cpu_threads == -1
+      ? torch::executorch::cpuinfo::get_num_performant_cores()
+      : static_cast<uint32_t>(FLAGS_cpu_threads);
+  ET_LOG(
+      Info, "Resetting threadpool with num threads = %d", num_performant_cores);
+  if (num_performant_cores > 0) {
+    torch::executorch::threadpool::get_threadpool()->_unsafe_reset_threadpool(
+        num_performant_cores);
+  }
+#endif
+
+  Runner runner(FLAGS_model_path, FLAGS_tokenizer_path, FLAGS_temperature);
+  const long load_start_ms = ::torch::executor::util::time_in_ms();
+  if (runner.load() != ::torch::executor::Error::Ok) {
+    ET_LOG(Error, "Failed to load %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  const long load_ms = ::torch::executor::util::time_in_ms() - load_start_ms;
+
+  BenchmarkReport report("llama2");
+  report.add_metadata("model_path", FLAGS_model_path);
+  report.add_metadata("tokenizer_path", FLAGS_tokenizer_path);
+  report.add_metadata("model_load_ms", std::to_string(load_ms));
+  report.add_metadata("temperature", std::to_string(FLAGS_temperature));
+
+  const auto prompt_lengths = parse_lengths(FLAGS_prompt_lengths);
+  const auto generation_lengths = parse_lengths(FLAGS_generation_lengths);
+  for (const int32_t prompt_length : prompt_lengths) {
+    const std::string prompt = make_prompt(prompt_length);
+    for (const int32_t generation_length : generation_lengths) {
+      for (int32_t run = 0; run < FLAGS_warmup + FLAGS_repeats; run++) {
+        BenchmarkResult result;
+        const auto error = runner.generate(
+            prompt,
+            prompt_length + generation_length,
+            {},
+            [&](const Runner::Stats& stats) {
+              result = to_result(stats, prompt_length, generation_length);
+            });
+        if (error != ::torch::executor::Error::Ok) {
+          ET_LOG(
+              Error,
+              "Generation failed for %d prompt tokens and %d generated tokens",
+              prompt_length,
+              generation_length);
+          return 1;
+        }
+        if (run >= FLAGS_warmup) {
+          report.add_result(std::move(result));
+        }
+      }
+    }
+  }
+
+  if (!report.write(FLAGS_output_path)) {
+    ET_LOG(Error, "Failed to write %s", FLAGS_output_path.c_str());
+    return 1;
+  }
+  ET_LOG(
+      Info,
+      "Wrote %zu results to %s",
+      report.results().size(),
+      FLAGS_output_path.c_str());
+  return 0;
+}
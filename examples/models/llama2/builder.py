@@ -71,6 +71,9 @@ def load_llama_model(
     weight_type: WeightType = WeightType.LLAMA,
     verbose: bool = False,
     max_seq_len: int = 128,
+    enable_dynamic_shape: bool = False,
+    generate_full_logits: bool = True,
+    input_embeddings: bool = False,
 ) -> "LlamaEdgeManager":
     """
     A helper util that builds a Llama2 model. It returns a LlamaEdgeManager that
@@ -94,6 +97,9 @@ def load_llama_model(
         use_sdpa_with_kv_cache=use_sdpa_with_kv_cache,
         fairseq2=weight_type == WeightType.FAIRSEQ2,
         max_seq_len=max_seq_len,
+        enable_dynamic_shape=enable_dynamic_shape,
+        generate_full_logits=generate_full_logits,
+        input_embeddings=input_embeddings,
     )
     state_dict = model.state_dict()
     dtype = state_dict[next(iter(state_dict))].dtype
@@ -121,6 +127,8 @@ def load_llama_model(
         use_kv_cache=use_kv_cache,
         use_sdpa_with_kv_cache=use_sdpa_with_kv_cache,
         example_inputs=example_inputs,
+        enable_dynamic_shape=enable_dynamic_shape,
+        generate_full_logits=generate_full_logits,
         verbose=verbose,
     )
 
@@ -139,6 +147,8 @@ class LlamaEdgeManager:
         use_kv_cache,
         use_sdpa_with_kv_cache,
         example_inputs,
+        enable_dynamic_shape: bool = False,
+        generate_full_logits: bool = True,
         verbose: bool = False,
     ):
         self.model = model
@@ -150,6 +160,8 @@ class LlamaEdgeManager:
         self.example_inputs = example_inputs
         self.use_kv_cache = use_kv_cache
         self.use_sdpa_with_kv_cache = use_sdpa_with_kv_cache
+        self.enable_dynamic_shape = enable_dynamic_shape
+        self.generate_full_logits = generate_full_logits
         self.metadata = None
         self.verbose = verbose
         self.applied_source_transforms = []
@@ -213,6 +225,9 @@ class LlamaEdgeManager:
     def _get_dynamic_shape(self) -> Any:
         dim = torch.export.Dim("token_dim", max=self.model.params.max_seq_len - 1)
         if self.use_kv_cache:
+            if self.enable_dynamic_shape:
+                # tokens: [1, seq_len], input_pos: [seq_len]
+                return ({1: dim}, {0: dim})
             return None
         else:
             return ({1: dim},)
@@ -231,6 +246,7 @@ class LlamaEdgeManager:
         metadata = {
             "append_eos_to_prompt": is_fairseq2,  # For language llama, tell the runtime to always append EOS token(s) to prompt.
             "get_bos_id": 3 if is_fairseq2 else 1,
+            "get_dim": params.dim,
             "get_dtype": 5 if self.dtype == DType.fp16 else 6,
             "get_eos_id": 3 if is_fairseq2 else 2,
             "get_head_dim": params.dim // params.n_heads,
@@ -243,6 +259,8 @@ class LlamaEdgeManager:
             "get_vocab_size": params.vocab_size,
             "use_kv_cache": self.use_kv_cache,
             "use_sdpa_with_kv_cache": self.use_sdpa_with_kv_cache,
+            "enable_dynamic_shape": self.enable_dynamic_shape,
+            "use_input_embeddings": params.input_embeddings,
         }
         if self.metadata:
             try:
@@ -367,8 +385,12 @@ class LlamaEdgeManager:
                 passes=[
                     QuantFusionPass(),
                 ],
+                # Without full logits, the runner provides the buffer of the
+                # (small) logits output, so don't plan memory for it.
                 memory_planning_pass=MemoryPlanningPass(
-                    "greedy", alloc_graph_input=False
+                    "greedy",
+                    alloc_graph_input=False,
+                    alloc_graph_output=self.generate_full_logits,
                 ),
                 sym_shape_eval_pass=ConstraintBasedSymShapeEvalPass(),
             )
@@ -392,6 +414,30 @@ class LlamaEdgeManager:
         filename = save_pte_program(self.export_program, output_name, self.output_dir)
         self._saved_pte_filename = filename
 
+    def save_token_embedding_to_pte(self, output_name: str) -> str:
+        """
+        Export the token embedding table of a model exported with
+        input_embeddings to its own .pte file, which the runner uses to embed
+        the text tokens. Its tokens input has the shape of the model's.
+        Args:
+            output_name (str): The name of the .pte file.
+        """
+        assert self.model.params.input_embeddings, "The model embeds its tokens"
+        embeddings_shape = self.example_inputs[0].shape
+        example_tokens = (torch.ones(embeddings_shape[:2], dtype=torch.long),)
+        dynamic_shape = self._get_dynamic_shape()
+        with torch.no_grad():
+            edge_manager = export_to_edge(
+                self.model.tok_embeddings,
+                example_tokens,
+                dynamic_shapes=dynamic_shape[:1] if dynamic_shape else None,
+                edge_compile_config=self._get_edge_config(),
+                verbose=self.verbose,
+            )
+        return save_pte_program(
+            edge_manager.to_executorch(), output_name, self.output_dir
+        )
+
     def get_saved_pte_filename(self) -> Optional[str]:
         """
         Return the filename of the most recenet saved .pte file. Return None if the model is not saved.
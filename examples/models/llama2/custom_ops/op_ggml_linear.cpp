@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/examples/models/llama2/custom_ops/op_ggml_linear.h>
+
+#include <cstring>
+
+#include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+
+namespace torch {
+namespace executor {
+
+namespace native {
+
+namespace {
+
+// The number of weights of a GGML block.
+constexpr int64_t kBlockSize = 32;
+constexpr int64_t kQ4_0BlockBytes = 2 + kBlockSize / 2;
+constexpr int64_t kQ8_0BlockBytes = 2 + kBlockSize;
+
+float block_scale(const uint8_t* block) {
+  uint16_t bits;
+  std::memcpy(&bits, block, sizeof(bits));
+  return static_cast<float>(
+      exec_aten::Half(bits, exec_aten::Half::from_bits()));
+}
+
+// Unpacks the quants of a block into `q`.
+void unpack_q4_0(const uint8_t* block, int8_t* q) {
+  const uint8_t* quants = block + 2;
+  for (int64_t i = 0; i < kBlockSize / 2; ++i) {
+    q[i] = static_cast<int8_t>(quants[i] & 0x0F) - 8;
+    q[i + kBlockSize / 2] = static_cast<int8_t>(quants[i] >> 4) - 8;
+  }
+}
+
+void unpack_q8_0(const uint8_t* block, int8_t* q) {
+  std::memcpy(q, block + 2, kBlockSize);
+}
+
+bool check_ggml_linear_args(
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    const Tensor& out,
+    int64_t block_bytes) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      input.scalar_type() == ScalarType::Float &&
+          out.scalar_type() == ScalarType::Float,
+      "Expected float input and output");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      input.dim() >= 1 && input.size(input.dim() - 1) % kBlockSize == 0,
+      "The input features must be a multiple of %" PRId64,
+      kBlockSize);
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      weight.scalar_type() == ScalarType::Byte && weight.dim() == 2 &&
+          weight.size(1) ==
+              input.size(input.dim() - 1) / kBlockSize * block_bytes,
+      "Expected a uint8 weight of [out_features, in_features / %" PRId64
+      " * %" PRId64 "]",
+      kBlockSize,
+      block_bytes);
+  if (bias.has_value()) {
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        bias.value().scalar_type() == ScalarType::Float &&
+            bias.value().numel() == weight.size(0),
+        "Expected a float bias of out_features elements");
+  }
+  return true;
+}
+
+// Computes out = input @ weight^T + bias, reading the blocks of each weight
+// row once for all the input rows.
+template <void (*unpack)(const uint8_t*, int8_t*)>
+Tensor& ggml_linear_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    Tensor& out,
+    int64_t block_bytes) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_ggml_linear_args(input, weight, bias, out, block_bytes),
+      InvalidArgument,
+      out);
+
+  exec_aten::SizesType out_sizes[kTensorDimensionLimit];
+  for (size_t d = 0; d + 1 < input.dim(); ++d) {
+    out_sizes[d] = input.size(d);
+  }
+  out_sizes[input.dim() - 1] = weight.size(0);
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {out_sizes, static_cast<size_t>(input.dim())}) ==
+          Error::Ok,
+      InvalidArgument,
+      out);
+
+  const int64_t k = input.size(input.dim() - 1);
+  const int64_t n = weight.size(0);
+  const int64_t m = k > 0 ? input.numel() / k : 0;
+  const int64_t num_blocks = k / kBlockSize;
+  const float* input_data = input.const_data_ptr<float>();
+  const uint8_t* weight_data = weight.const_data_ptr<uint8_t>();
+  const float* bias_data =
+      bias.has_value() ? bias.value().const_data_ptr<float>() : nullptr;
+  float* out_data = out.mutable_data_ptr<float>();
+
+  // Splitting the output features keeps every thread busy when decoding a
+  // single token.
+  parallel_for_each_chunk(
+      0, n, m * k, [&](const int64_t begin, const int64_t end) {
+        int8_t q[kBlockSize];
+        for (int64_t j = begin; j < end; ++j) {
+          const float init = bias_data != nullptr ? bias_data[j] : 0.0f;
+          for (int64_t i = 0; i < m; ++i) {
+            out_data[i * n + j] = init;
+          }
+          const uint8_t* row = weight_data + j * num_blocks * block_bytes;
+          for (int64_t b = 0; b < num_blocks; ++b) {
+            const uint8_t* block = row + b * block_bytes;
+            const float scale = block_scale(block);
+            unpack(block, q);
+            for (int64_t i = 0; i < m; ++i) {
+              const float* x = input_data + i * k + b * kBlockSize;
+              float sum = 0.0f;
+              for (int64_t l = 0; l < kBlockSize; ++l) {
+                sum += x[l] * q[l];
+              }
+              out_data[i * n + j] += scale * sum;
+            }
+          }
+        }
+      });
+  return out;
+}
+
+} // namespace
+
+Tensor& linear_q4_0_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    Tensor& out) {
+  return ggml_linear_out<unpack_q4_0>(
+      ctx, input, weight, bias, out, kQ4_0BlockBytes);
+}
+
+Tensor& linear_q8_0_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    Tensor& out) {
+  return ggml_linear_out<unpack_q8_0>(
+      ctx, input, weight, bias, out, kQ8_0BlockBytes);
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
+
+namespace {
+const torch::executor::Kernel ggml_kernels[] = {
+    torch::executor::make_boxed_kernel(
+        "llama::linear_q4_0.out",
+        EXECUTORCH_FN(torch::executor::native::linear_q4_0_out)),
+    torch::executor::make_boxed_kernel(
+        "llama::linear_q8_0.out",
+        EXECUTORCH_FN(torch::executor::native::linear_q8_0_out)),
+};
+static auto res_ggml = torch::executor::register_kernels(ggml_kernels);
+} // namespace
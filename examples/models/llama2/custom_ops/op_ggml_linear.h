@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+
+namespace native {
+
+// Linear layers whose weights are in the block layouts of GGML, as stored in
+// GGUF files. A [out_features, in_features] weight is a uint8 tensor of
+// [out_features, in_features / 32 * block bytes]: each row is the blocks of
+// 32 consecutive input features, each an fp16 scale followed by the quants.
+
+// Q4_0 blocks are 18 bytes: the scale, then 16 bytes whose low nibbles are
+// the first 16 quants and high nibbles the last 16. Weights are
+// (quant - 8) * scale.
+Tensor& linear_q4_0_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    Tensor& out);
+
+// Q8_0 blocks are 34 bytes: the scale, then 32 int8 quants. Weights are
+// quant * scale.
+Tensor& linear_q8_0_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const Tensor& weight,
+    const optional<Tensor>& bias,
+    Tensor& out);
+
+} // namespace native
+} // namespace executor
+} // namespace torch
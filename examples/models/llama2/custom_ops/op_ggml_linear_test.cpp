@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <executorch/examples/models/llama2/custom_ops/op_ggml_linear.h>
+
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using exec_aten::ScalarType;
+using exec_aten::Tensor;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+constexpr uint16_t kHalfOne = 0x3C00;
+constexpr uint16_t kHalfHalf = 0x3800;
+
+// Appends a block with the given fp16 scale and quant bytes.
+void append_block(
+    std::vector<uint8_t>& blocks,
+    uint16_t scale,
+    const std::vector<uint8_t>& quants) {
+  uint8_t bytes[2];
+  std::memcpy(bytes, &scale, sizeof(scale));
+  blocks.insert(blocks.end(), bytes, bytes + 2);
+  blocks.insert(blocks.end(), quants.begin(), quants.end());
+}
+
+} // namespace
+
+class OpGgmlLinearTest : public OperatorTest {};
+
+TEST_F(OpGgmlLinearTest, Q4_0) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Byte> tf_byte;
+
+  // Row 0 is 1 for the first 16 features and 2 for the last 16. Row 1 is
+  // -0.5 for the first 16 and 0 for the last 16.
+  std::vector<uint8_t> blocks;
+  append_block(blocks, kHalfOne, std::vector<uint8_t>(16, 0x9 | (0xA << 4)));
+  append_block(blocks, kHalfHalf, std::vector<uint8_t>(16, 0x7 | (0x8 << 4)));
+  Tensor weight = tf_byte.make({2, 18}, blocks);
+
+  std::vector<float> x(64, 1.0f);
+  std::fill(x.begin() + 32, x.end(), 2.0f);
+  Tensor input = tf.make({2, 32}, x);
+  Tensor out = tf.zeros({2, 2});
+
+  torch::executor::native::linear_q4_0_out(
+      context_, input, weight, exec_aten::nullopt, out);
+  EXPECT_TENSOR_CLOSE(out, tf.make({2, 2}, {48, -8, 96, -16}));
+}
+
+TEST_F(OpGgmlLinearTest, Q8_0WithBias) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Byte> tf_byte;
+
+  // The quants are -16, ..., 15, which sum to -16.
+  std::vector<uint8_t> quants;
+  for (int i = 0; i < 32; ++i) {
+    quants.push_back(static_cast<uint8_t>(static_cast<int8_t>(i - 16)));
+  }
+  std::vector<uint8_t> blocks;
+  append_block(blocks, kHalfHalf, quants);
+  Tensor weight = tf_byte.make({1, 34}, blocks);
+
+  Tensor input = tf.ones({1, 1, 32});
+  Tensor bias = tf.make({1}, {3});
+  Tensor out = tf.zeros({1, 1, 1});
+
+  torch::executor::native::linear_q8_0_out(context_, input, weight, bias, out);
+  EXPECT_TENSOR_CLOSE(out, tf.make({1, 1, 1}, {-5}));
+}
+
+TEST_F(OpGgmlLinearTest, MismatchedWeightFails) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Byte> tf_byte;
+
+  Tensor weight = tf_byte.zeros({1, 34});
+  Tensor input = tf.ones({1, 32});
+  Tensor out = tf.zeros({1, 1});
+
+  ET_EXPECT_KERNEL_FAILURE(
+      context_,
+      torch::executor::native::linear_q4_0_out(
+          context_, input, weight, exec_aten::nullopt, out));
+}
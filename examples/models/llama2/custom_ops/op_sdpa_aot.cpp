@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/examples/models/llama2/custom_ops/op_ggml_linear.h>
 #include <executorch/examples/models/llama2/custom_ops/op_sdpa.h>
 #include <executorch/extension/aten_util/make_aten_functor_from_et_functor.h>
 #include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
@@ -82,6 +83,134 @@ at::Tensor sdpa_with_kv_cache_aten(
   return output;
 }
 
+Tensor& sdpa_with_int8_kv_cache_out_no_context(
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    Tensor& key_cache_scales,
+    Tensor& value_cache_scales,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  exec_aten::RuntimeContext context{};
+  return torch::executor::native::sdpa_with_int8_kv_cache_out(
+      context,
+      q_projected,
+      k_projected,
+      v_projected,
+      key_cache,
+      value_cache,
+      key_cache_scales,
+      value_cache_scales,
+      start_pos,
+      seq_len,
+      attn_mask,
+      dropout_p,
+      is_causal,
+      scale,
+      output);
+}
+
+at::Tensor sdpa_with_int8_kv_cache_aten(
+    const at::Tensor& q_projected,
+    const at::Tensor& k_projected,
+    const at::Tensor& v_projected,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& key_cache_scales,
+    at::Tensor& value_cache_scales,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const c10::optional<at::Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const c10::optional<double> scale) {
+  auto output = at::empty_like(q_projected);
+  WRAP_TO_ATEN(sdpa_with_int8_kv_cache_out_no_context, 13)
+  (q_projected,
+   k_projected,
+   v_projected,
+   key_cache,
+   value_cache,
+   key_cache_scales,
+   value_cache_scales,
+   start_pos,
+   seq_len,
+   attn_mask,
+   dropout_p,
+   is_causal,
+   scale,
+   output);
+  return output;
+}
+
+
+Tensor& linear_q4_0_out_no_context(
+    const Tensor& input,
+    const Tensor& weight,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<Tensor> bias,
+    Tensor& out) {
+  exec_aten::RuntimeContext context{};
+  return torch::executor::native::linear_q4_0_out(
+      context, input, weight, bias, out);
+}
+
+Tensor& linear_q8_0_out_no_context(
+    const Tensor& input,
+    const Tensor& weight,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<Tensor> bias,
+    Tensor& out) {
+  exec_aten::RuntimeContext context{};
+  return torch::executor::native::linear_q8_0_out(
+      context, input, weight, bias, out);
+}
+
+// The output of a GGML linear layer: the input with out_features features.
+at::Tensor ggml_linear_output(
+    const at::Tensor& input,
+    const at::Tensor& weight) {
+  std::vector<int64_t> sizes = input.sizes().vec();
+  sizes.back() = weight.size(0);
+  return at::empty(sizes, input.options());
+}
+
+at::Tensor linear_q4_0_aten(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const c10::optional<at::Tensor> bias) {
+  auto output = ggml_linear_output(input, weight);
+  WRAP_TO_ATEN(linear_q4_0_out_no_context, 3)(input, weight, bias, output);
+  return output;
+}
+
+at::Tensor linear_q8_0_aten(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const c10::optional<at::Tensor> bias) {
+  auto output = ggml_linear_output(input, weight);
+  WRAP_TO_ATEN(linear_q8_0_out_no_context, 3)(input, weight, bias, output);
+  return output;
+}
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -95,6 +224,26 @@ TORCH_LIBRARY(llama, m) {
       "sdpa_with_kv_cache.out(Tensor query, Tensor key, Tensor value, Tensor(a!) key_cache, "
       "Tensor(b!) value_cache, SymInt start_pos, SymInt seq_len, Tensor? attn_mask=None, "
       "float drpout_p=0.0, bool is_causal=False, float? scale=None, *, Tensor(c!) out) -> Tensor(c!)");
+  m.def(
+      "sdpa_with_int8_kv_cache(Tensor query, Tensor key, Tensor value, Tensor(a!) key_cache, "
+      "Tensor(b!) value_cache, Tensor(c!) key_cache_scales, Tensor(d!) value_cache_scales, "
+      "SymInt start_pos, SymInt seq_len, Tensor? attn_mask=None, "
+      "float drpout_p=0.0, bool is_causal=False, float? scale=None) -> Tensor");
+  m.def(
+      "sdpa_with_int8_kv_cache.out(Tensor query, Tensor key, Tensor value, Tensor(a!) key_cache, "
+      "Tensor(b!) value_cache, Tensor(c!) key_cache_scales, Tensor(d!) value_cache_scales, "
+      "SymInt start_pos, SymInt seq_len, Tensor? attn_mask=None, "
+      "float drpout_p=0.0, bool is_causal=False, float? scale=None, *, Tensor(e!) out) -> Tensor(e!)");
+  m.def(
+      "linear_q4_0(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor");
+  m.def(
+      "linear_q4_0.out(Tensor input, Tensor weight, Tensor? bias=None, *, "
+      "Tensor(a!) out) -> Tensor(a!)");
+  m.def(
+      "linear_q8_0(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor");
+  m.def(
+      "linear_q8_0.out(Tensor input, Tensor weight, Tensor? bias=None, *, "
+      "Tensor(a!) out) -> Tensor(a!)");
 }
 
 TORCH_LIBRARY_IMPL(llama, CompositeExplicitAutograd, m) {
@@ -104,4 +253,20 @@ TORCH_LIBRARY_IMPL(llama, CompositeExplicitAutograd, m) {
       "sdpa_with_kv_cache.out",
       WRAP_TO_ATEN(
           torch::executor::native::sdpa_with_kv_cache_out_no_context, 11));
+  m.impl(
+      "sdpa_with_int8_kv_cache",
+      torch::executor::native::sdpa_with_int8_kv_cache_aten);
+  m.impl(
+      "sdpa_with_int8_kv_cache.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::sdpa_with_int8_kv_cache_out_no_context,
+          13));
+  m.impl("linear_q4_0", torch::executor::native::linear_q4_0_aten);
+  m.impl(
+      "linear_q4_0.out",
+      WRAP_TO_ATEN(torch::executor::native::linear_q4_0_out_no_context, 3));
+  m.impl("linear_q8_0", torch::executor::native::linear_q8_0_aten);
+  m.impl(
+      "linear_q8_0.out",
+      WRAP_TO_ATEN(torch::executor::native::linear_q8_0_out_no_context, 3));
 }
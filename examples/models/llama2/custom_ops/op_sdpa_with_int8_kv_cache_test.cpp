@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <executorch/examples/models/llama2/custom_ops/op_sdpa.h> // Declares the operator
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using exec_aten::ScalarType;
+using exec_aten::Tensor;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+Tensor& op_sdpa_with_kv_cache(
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    bool is_causal,
+    Tensor& out) {
+  exec_aten::RuntimeContext context{};
+  return torch::executor::native::sdpa_with_kv_cache_out(
+      context,
+      query,
+      key,
+      value,
+      key_cache,
+      value_cache,
+      start_pos,
+      seq_len,
+      {},
+      0,
+      is_causal,
+      {},
+      out);
+}
+
+Tensor& op_sdpa_with_int8_kv_cache(
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    Tensor& key_cache_scales,
+    Tensor& value_cache_scales,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    bool is_causal,
+    Tensor& out) {
+  exec_aten::RuntimeContext context{};
+  return torch::executor::native::sdpa_with_int8_kv_cache_out(
+      context,
+      query,
+      key,
+      value,
+      key_cache,
+      value_cache,
+      key_cache_scales,
+      value_cache_scales,
+      start_pos,
+      seq_len,
+      {},
+      0,
+      is_causal,
+      {},
+      out);
+}
+
+// Deterministic values in [-1, 1] that differ between tensors.
+std::vector<float> make_values(size_t size, float seed) {
+  std::vector<float> values(size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = std::sin(seed + 0.37f * i);
+  }
+  return values;
+}
+
+std::vector<float> slice_positions(
+    const std::vector<float>& values,
+    int64_t begin,
+    int64_t end,
+    int64_t position_size) {
+  return std::vector<float>(
+      values.begin() + begin * position_size,
+      values.begin() + end * position_size);
+}
+
+constexpr int32_t kNumHeads = 4;
+constexpr int32_t kNumKVHeads = 2;
+constexpr int32_t kHeadDim = 8;
+constexpr int32_t kMaxSeqLen = 6;
+
+} // namespace
+
+TEST(OpSdpaWithInt8KVCacheTest, MatchesFloatCacheWithGroupedQueryHeads) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tf_int8;
+
+  Tensor key_cache = tf.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor value_cache = tf.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor key_cache_q = tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor value_cache_q = tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor key_scales = tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1});
+  Tensor value_scales = tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1});
+
+  for (int32_t pos = 0; pos < kMaxSeqLen; ++pos) {
+    Tensor query = tf.make(
+        {1, 1, kNumHeads, kHeadDim},
+        make_values(kNumHeads * kHeadDim, 1.0f + pos));
+    Tensor key = tf.make(
+        {1, 1, kNumKVHeads, kHeadDim},
+        make_values(kNumKVHeads * kHeadDim, 2.0f + pos));
+    Tensor value = tf.make(
+        {1, 1, kNumKVHeads, kHeadDim},
+        make_values(kNumKVHeads * kHeadDim, 3.0f + pos));
+
+    Tensor expected = tf.zeros({1, 1, kNumHeads, kHeadDim});
+    op_sdpa_with_kv_cache(
+        query, key, value, key_cache, value_cache, pos, 1, false, expected);
+
+    Tensor out = tf.zeros({1, 1, kNumHeads, kHeadDim});
+    op_sdpa_with_int8_kv_cache(
+        query,
+        key,
+        value,
+        key_cache_q,
+        value_cache_q,
+        key_scales,
+        value_scales,
+        pos,
+        1,
+        false,
+        out);
+    EXPECT_TENSOR_CLOSE_WITH_TOL(out, expected, 2e-2, 2e-2);
+  }
+}
+
+TEST(OpSdpaWithInt8KVCacheTest, CausalPrefillMatchesDecode) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tf_int8;
+  constexpr int32_t kPrefillLen = 4;
+  constexpr int32_t kStartPos = 1;
+
+  const std::vector<float> q_values =
+      make_values(kPrefillLen * kNumHeads * kHeadDim, 1.0f);
+  const std::vector<float> k_values =
+      make_values(kPrefillLen * kNumKVHeads * kHeadDim, 2.0f);
+  const std::vector<float> v_values =
+      make_values(kPrefillLen * kNumKVHeads * kHeadDim, 3.0f);
+  const std::vector<float> first_key =
+      make_values(kNumKVHeads * kHeadDim, 4.0f);
+  const std::vector<float> first_value =
+      make_values(kNumKVHeads * kHeadDim, 5.0f);
+
+  // Both runs first decode one token at position 0, then process the same
+  // kPrefillLen tokens either all at once or one at a time.
+  Tensor caches[2][4] = {
+      {tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim}),
+       tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim}),
+       tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1}),
+       tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1})},
+      {tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim}),
+       tf_int8.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim}),
+       tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1}),
+       tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1})}};
+  for (auto& cache : caches) {
+    Tensor out = tf.zeros({1, 1, kNumHeads, kHeadDim});
+    op_sdpa_with_int8_kv_cache(
+        tf.make({1, 1, kNumHeads, kHeadDim}, make_values(32, 6.0f)),
+        tf.make({1, 1, kNumKVHeads, kHeadDim}, first_key),
+        tf.make({1, 1, kNumKVHeads, kHeadDim}, first_value),
+        cache[0],
+        cache[1],
+        cache[2],
+        cache[3],
+        0,
+        1,
+        true,
+        out);
+  }
+
+  Tensor prefill_out = tf.zeros({1, kPrefillLen, kNumHeads, kHeadDim});
+  op_sdpa_with_int8_kv_cache(
+      tf.make({1, kPrefillLen, kNumHeads, kHeadDim}, q_values),
+      tf.make({1, kPrefillLen, kNumKVHeads, kHeadDim}, k_values),
+      tf.make({1, kPrefillLen, kNumKVHeads, kHeadDim}, v_values),
+      caches[0][0],
+      caches[0][1],
+      caches[0][2],
+      caches[0][3],
+      kStartPos,
+      kPrefillLen,
+      true,
+      prefill_out);
+
+  std::vector<float> decode_values;
+  for (int32_t i = 0; i < kPrefillLen; ++i) {
+    Tensor out = tf.zeros({1, 1, kNumHeads, kHeadDim});
+    op_sdpa_with_int8_kv_cache(
+        tf.make(
+            {1, 1, kNumHeads, kHeadDim},
+            slice_positions(q_values, i, i + 1, kNumHeads * kHeadDim)),
+        tf.make(
+            {1, 1, kNumKVHeads, kHeadDim},
+            slice_positions(k_values, i, i + 1, kNumKVHeads * kHeadDim)),
+        tf.make(
+            {1, 1, kNumKVHeads, kHeadDim},
+            slice_positions(v_values, i, i + 1, kNumKVHeads * kHeadDim)),
+        caches[1][0],
+        caches[1][1],
+        caches[1][2],
+        caches[1][3],
+        kStartPos + i,
+        1,
+        true,
+        out);
+    const float* out_data = out.const_data_ptr<float>();
+    decode_values.insert(
+        decode_values.end(), out_data, out_data + out.numel());
+  }
+
+  EXPECT_TENSOR_CLOSE(
+      prefill_out,
+      tf.make({1, kPrefillLen, kNumHeads, kHeadDim}, decode_values));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TENSOR_EQ(caches[0][i], caches[1][i]);
+  }
+}
+
+TEST(OpSdpaWithInt8KVCacheTest, RejectsFloatCache) {
+  TensorFactory<ScalarType::Float> tf;
+
+  Tensor key_cache = tf.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor value_cache = tf.zeros({1, kMaxSeqLen, kNumKVHeads, kHeadDim});
+  Tensor key_scales = tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1});
+  Tensor value_scales = tf.zeros({1, kMaxSeqLen, kNumKVHeads, 1});
+  Tensor out = tf.zeros({1, 1, kNumHeads, kHeadDim});
+  exec_aten::RuntimeContext context{};
+  torch::executor::native::sdpa_with_int8_kv_cache_out(
+      context,
+      tf.ones({1, 1, kNumHeads, kHeadDim}),
+      tf.ones({1, 1, kNumKVHeads, kHeadDim}),
+      tf.ones({1, 1, kNumKVHeads, kHeadDim}),
+      key_cache,
+      value_cache,
+      key_scales,
+      value_scales,
+      0,
+      1,
+      {},
+      0,
+      false,
+      {},
+      out);
+  EXPECT_NE(context.failure_state(), torch::executor::Error::Ok);
+}
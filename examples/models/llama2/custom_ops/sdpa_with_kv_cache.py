@@ -68,11 +68,8 @@ def _validate_params(
     ), f"Expected value_cache to be 4 dimensional but got {value_cache.dim()}"
 
     assert (
-        key_cache.dtype == torch.float32
-    ), f"Expected key_cache to be float32 but got {key_cache.dtype}"
-    assert (
-        value_cache.dtype == torch.float32
-    ), f"Expected value_cache to be float32 but got {value_cache.dtype}"
+        key_cache.dtype == value_cache.dtype
+    ), f"Key cache and value cache must have same dtype but got {key_cache.dtype} and {value_cache.dtype}"
 
     assert (
         key_cache.size() == value_cache.size()
@@ -86,8 +83,6 @@ def _validate_params(
     #     1
     # ), f"Start position  + length = {start_pos + seq_len} must be less than sequence length {key_cache.size(2)}"
 
-    assert seq_len == 1, "Only support seq_len = 1 for now."
-
     if attn_mask is not None:
         assert (
             attn_mask.dim() == 2
@@ -124,5 +119,83 @@ def sdpa_with_kv_cache_meta(
         is_causal,
         scale,
     )
+    assert key_cache.dtype in (
+        torch.float32,
+        torch.float16,
+        torch.bfloat16,
+    ), f"Expected key_cache to be float32, float16 or bfloat16 but got {key_cache.dtype}"
 
     return torch.empty_like(query)
+
+
+@impl(custom_ops_lib, "sdpa_with_int8_kv_cache", "Meta")
+def sdpa_with_int8_kv_cache_meta(
+    query,
+    key,
+    value,
+    key_cache,
+    value_cache,
+    key_cache_scales,
+    value_cache_scales,
+    start_pos,
+    seq_len,
+    attn_mask=None,
+    drpout_p=0.0,
+    is_causal=False,
+    scale=None,
+):
+    _validate_params(
+        query,
+        key,
+        value,
+        key_cache,
+        value_cache,
+        start_pos,
+        seq_len,
+        attn_mask,
+        drpout_p,
+        is_causal,
+        scale,
+    )
+    assert (
+        key_cache.dtype == torch.int8
+    ), f"Expected key_cache to be int8 but got {key_cache.dtype}"
+    for scales in (key_cache_scales, value_cache_scales):
+        assert (
+            scales.dtype == torch.float32
+        ), f"Expected kv cache scales to be float32 but got {scales.dtype}"
+        assert scales.size() == (
+            *key_cache.shape[:-1],
+            1,
+        ), f"Expected kv cache scales of size {(*key_cache.shape[:-1], 1)} but got {scales.size()}"
+
+    return torch.empty_like(query)
+
+
+def _ggml_linear_meta(input, weight, bias, block_bytes):
+    in_features = input.size(-1)
+    assert (
+        input.dtype == torch.float32
+    ), f"Expected input to be float32 but got {input.dtype}"
+    assert (
+        in_features % 32 == 0
+    ), f"Expected in_features to be a multiple of 32 but got {in_features}"
+    assert weight.dtype == torch.uint8 and weight.size() == (
+        weight.size(0),
+        in_features // 32 * block_bytes,
+    ), f"Expected a uint8 weight of [out_features, {in_features // 32 * block_bytes}] but got {weight.dtype} {weight.size()}"
+    if bias is not None:
+        assert bias.size() == (
+            weight.size(0),
+        ), f"Expected a bias of size {weight.size(0)} but got {bias.size()}"
+    return input.new_empty((*input.shape[:-1], weight.size(0)))
+
+
+@impl(custom_ops_lib, "linear_q4_0", "Meta")
+def linear_q4_0_meta(input, weight, bias=None):
+    return _ggml_linear_meta(input, weight, bias, 18)
+
+
+@impl(custom_ops_lib, "linear_q8_0", "Meta")
+def linear_q8_0_meta(input, weight, bias=None):
+    return _ggml_linear_meta(input, weight, bias, 34)
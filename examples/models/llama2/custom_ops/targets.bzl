@@ -8,16 +8,19 @@ def define_common_targets():
     """
     runtime.cxx_library(
         name = "custom_ops",
-        srcs = ["op_sdpa.cpp"],
-        exported_headers = ["op_sdpa.h"],
+        srcs = [
+            "op_ggml_linear.cpp",
+            "op_sdpa.cpp",
+        ],
+        exported_headers = [
+            "op_ggml_linear.h",
+            "op_sdpa.h",
+        ],
         exported_deps = [
             "//executorch/runtime/kernel:kernel_includes",
-            "//executorch/kernels/portable/cpu:scalar_utils",
-            "//executorch/kernels/optimized:libblas",
-            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/optimized/cpu:sdpa",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
             "//executorch/extension/kernel_util:kernel_util",
-            "//executorch/extension/parallel:thread_parallel",
-            "//executorch/backends/xnnpack/threadpool:threadpool",
         ],
         compiler_flags = ["-Wno-missing-prototypes", "-Wno-global-constructors"],
         visibility = [
@@ -86,3 +89,31 @@ def define_common_targets():
             ":custom_ops",
         ],
     )
+
+    runtime.cxx_test(
+        name = "op_sdpa_with_int8_kv_cache_test",
+        srcs = [
+            "op_sdpa_with_int8_kv_cache_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "op_ggml_linear_test",
+        srcs = [
+            "op_ggml_linear_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
@@ -36,6 +36,7 @@ from .source_transformation.quantize import (
     get_quant_embedding_transform,
     get_quant_weight_transform,
 )
+from .source_transformation.rms_norm import replace_rms_norm_with_fused_op
 from .source_transformation.rope import materialze_broadcast_of_rope_freq_cis
 from .source_transformation.sdpa import (
     replace_causal_mask,
@@ -168,12 +169,36 @@ def build_args_parser() -> argparse.ArgumentParser:
         action="store_true",
         help="Whether or not to export a model using kv cache",
     )
+    parser.add_argument(
+        "--enable_dynamic_shape",
+        default=False,
+        action="store_true",
+        help="Export a kv cache model with a dynamic seq_len dimension, so that the runner can prefill the prompt in chunks of tokens",
+    )
+    parser.add_argument(
+        "--last_logits_only",
+        default=False,
+        action="store_true",
+        help="Only return the logits of the last position, in a buffer provided by the runner instead of a memory planned one. Supported by the C++ runner only",
+    )
+    parser.add_argument(
+        "--input_embeddings",
+        default=False,
+        action="store_true",
+        help="Export a model that takes token embeddings instead of tokens, along with a <output>_tok_embeddings.pte program embedding the tokens, so that a multimodal runner can splice in the embeddings of an image encoder",
+    )
     parser.add_argument(
         "--use_sdpa_with_kv_cache",
         default=False,
         action="store_true",
         help="Whether to use sdpa_with_kv_cache update op when using kv cache",
     )
+    parser.add_argument(
+        "--use_fused_rms_norm",
+        default=False,
+        action="store_true",
+        help="Whether to run RMSNorm as the fused.rms_norm op of the optimized kernels",
+    )
     parser.add_argument(
         "-p",
         "--params",
@@ -354,6 +379,9 @@ def _prepare_for_llama_export(modelname: str, args) -> LlamaEdgeManager:
     if args.use_sdpa_with_kv_cache:
         transforms.append(replace_sdpa_with_custom_op)
 
+    if args.use_fused_rms_norm:
+        transforms.append(replace_rms_norm_with_fused_op)
+
     if args.use_kv_cache:
         if args.qnn or args.coreml or args.mps:
             # Currently qnn/coreml/mps doesn't support sdpa op, use the simpler decomposition
@@ -371,6 +399,9 @@ def _prepare_for_llama_export(modelname: str, args) -> LlamaEdgeManager:
             weight_type=weight_type,
             verbose=args.verbose,
             max_seq_len=args.max_seq_length,
+            enable_dynamic_shape=args.enable_dynamic_shape,
+            generate_full_logits=not args.last_logits_only,
+            input_embeddings=args.input_embeddings,
         )
         .set_output_dir(output_dir_path)
         .set_metadata(args.metadata)
@@ -476,4 +507,7 @@ def _export_llama(modelname, args) -> LlamaEdgeManager:  # noqa: C901
 
     builder.save_to_pte(output_file)
 
+    if args.input_embeddings:
+        builder.save_token_embedding_to_pte(f"{output_file[:-4]}_tok_embeddings.pte")
+
     return builder
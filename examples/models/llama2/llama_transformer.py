@@ -88,6 +88,12 @@ class ModelArgs:
     use_sdpa_with_kv_cache_op: bool = (
         False  # Use custom sdpa op that updates kv cache in-place
     )
+    generate_full_logits: bool = (
+        True  # Return the logits of every position, not only the last one
+    )
+    input_embeddings: bool = (
+        False  # Take token embeddings instead of tokens, e.g. to splice in image embeddings
+    )
     rope_theta: Optional[float] = (
         None  # The official name to override self.rope_freq_base.
     )
@@ -447,6 +453,8 @@ class Transformer(nn.Module):
         self.norm = RMSNorm(params.dim, eps=params.norm_eps)
         self.output = nn.Linear(params.dim, params.vocab_size, bias=False)
         self.use_kv_cache = params.use_kv_cache
+        self.generate_full_logits = params.generate_full_logits
+        self.input_embeddings = params.input_embeddings
 
         freqs_cos, freqs_sin = precompute_freqs_cis(
             params.dim // params.n_heads,
@@ -467,8 +475,14 @@ class Transformer(nn.Module):
             torch.Tensor
         ] = None,  # Scalar tensor indicating size of window of the caches
     ) -> torch.Tensor:
-        _bsz, seqlen = tokens.shape
-        h = self.tok_embeddings(tokens)
+        if self.input_embeddings:
+            # tokens holds the embeddings, [bsz, seqlen, dim], of tokens embedded
+            # by the tok_embeddings program or of other modalities.
+            _bsz, seqlen, _ = tokens.shape
+            h = tokens
+        else:
+            _bsz, seqlen = tokens.shape
+            h = self.tok_embeddings(tokens)
 
         if self.use_kv_cache:
             assert (
@@ -491,6 +505,11 @@ class Transformer(nn.Module):
                 input_pos,
             )
 
+        if not self.generate_full_logits:
+            # Only the logits of the last position are needed to sample the
+            # next token, so skip the output projection of the others.
+            h = h[:, -1, :]
+
         h = self.norm(h)
 
         logits = self.output(h)
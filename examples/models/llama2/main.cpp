@@ -34,6 +34,16 @@ DEFINE_int32(
     128,
     "Total number of tokens to generate (prompt + output). Defaults to max_seq_len. If the number of input tokens + seq_len > max_seq_len, the output will be truncated to max_seq_len tokens.");
 
+DEFINE_int32(
+    prompt_lookup_tokens,
+    0,
+    "Number of tokens to draft from n-gram matches in the context (prompt lookup decoding). Defaults to 0, which disables it.");
+
+DEFINE_int32(
+    prompt_lookup_ngram,
+    3,
+    "Longest n-gram matched by prompt lookup decoding, shorter ones are tried next.");
+
 DEFINE_int32(
     cpu_threads,
     -1,
@@ -70,9 +80,17 @@ int32_t main(int32_t argc, char** argv) {
 #endif
   // create llama runner
   ::torch::executor::Runner runner(model_path, tokenizer_path, temperature);
+  runner.set_prompt_lookup(
+      FLAGS_prompt_lookup_ngram, FLAGS_prompt_lookup_tokens);
 
-  // generate
-  runner.generate(prompt, seq_len);
+  {
+#if defined(ET_USE_THREADPOOL)
+    // Keep the threadpool workers awake between the ops of a decode step.
+    torch::executorch::threadpool::ThreadPoolHotSection hot_section;
+#endif
+    // generate
+    runner.generate(prompt, seq_len);
+  }
 
   return 0;
 }
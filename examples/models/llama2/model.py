@@ -75,6 +75,22 @@ class Llama2Model(EagerModelBase):
             else False
         )
 
+        self.enable_dynamic_shape = (
+            kwargs["enable_dynamic_shape"]
+            if "enable_dynamic_shape" in kwargs
+            else False
+        )
+
+        self.generate_full_logits = (
+            kwargs["generate_full_logits"]
+            if "generate_full_logits" in kwargs
+            else True
+        )
+
+        self.input_embeddings = (
+            kwargs["input_embeddings"] if "input_embeddings" in kwargs else False
+        )
+
         self.max_seq_len = kwargs["max_seq_len"] if "max_seq_len" in kwargs else 128
         # The example is using a dummy small model with random weights for demo purpose only.
         # Follow the instruction in https://github.com/facebookresearch/llama to download the model
@@ -157,6 +173,8 @@ the checkpoint format to avoid generating faulty models.
             max_batch_size=max_batch_size,
             use_kv_cache=self.use_kv_cache,
             use_sdpa_with_kv_cache_op=self.use_sdpa_with_kv_cache_op,
+            generate_full_logits=self.generate_full_logits,
+            input_embeddings=self.input_embeddings,
             **params,
         )
         if kwargs.get("fairseq2", False):
@@ -209,6 +227,15 @@ the checkpoint format to avoid generating faulty models.
             return self.model_.to(torch.float32)
 
     def get_example_inputs(self):
+        example_inputs = self._get_example_token_inputs()
+        if self.input_embeddings:
+            # Same shapes, with the embeddings of the tokens.
+            tokens = example_inputs[0]
+            embeddings = torch.randn(*tokens.shape, self.model_.params.dim)
+            example_inputs = (embeddings,) + example_inputs[1:]
+        return example_inputs
+
+    def _get_example_token_inputs(self):
         if self.use_kv_cache:
             return self.get_example_inputs_kvcache_sdpa()
         else:
@@ -220,6 +247,15 @@ the checkpoint format to avoid generating faulty models.
 
     # assumption is the custom op doesnt support dynamic shape right now. It might but its untested so lets first get static shape working
     def get_example_inputs_kvcache_sdpa(self):
+        if self.enable_dynamic_shape:
+            # Sizes of 0 and 1 would be specialized by export, use more tokens so
+            # that the seq_len dimension stays dynamic.
+            return (
+                torch.tensor([[2, 3, 4]], dtype=torch.long),  # tokens
+                torch.tensor(
+                    [0, 1, 2], dtype=torch.long
+                ),  # input_pos, the position of each token.
+            )
         return (
             torch.tensor(
                 [[1]], dtype=torch.long
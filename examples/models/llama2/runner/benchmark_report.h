@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Collects the results of LLM runner benchmarks and writes them as JSON.
+#pragma once
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+struct LatencySummary {
+  double mean_ms = 0;
+  double p50_ms = 0;
+  double p90_ms = 0;
+  double p99_ms = 0;
+  double max_ms = 0;
+};
+
+/// Summarizes latencies using nearest-rank percentiles.
+inline LatencySummary summarize_latencies(std::vector<double> latencies_ms) {
+  LatencySummary summary;
+  if (latencies_ms.empty()) {
+    return summary;
+  }
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  auto percentile = [&](double p) {
+    const size_t rank = static_cast<size_t>(
+        std::ceil(p / 100.0 * static_cast<double>(latencies_ms.size())));
+    return latencies_ms[std::max<size_t>(rank, 1) - 1];
+  };
+  double total_ms = 0;
+  for (const double latency_ms : latencies_ms) {
+    total_ms += latency_ms;
+  }
+  summary.mean_ms = total_ms / latencies_ms.size();
+  summary.p50_ms = percentile(50);
+  summary.p90_ms = percentile(90);
+  summary.p99_ms = percentile(99);
+  summary.max_ms = latencies_ms.back();
+  return summary;
+}
+
+/// The peak resident set size of the process so far, in kilobytes.
+inline long peak_rss_kb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+/// The measurements of one generation.
+struct BenchmarkResult {
+  // The requested prompt and generation lengths, and the actual ones, which
+  // differ when the prompt does not tokenize to the requested length or the
+  // generation stops early.
+  int64_t requested_prompt_tokens = 0;
+  int64_t requested_generated_tokens = 0;
+  int64_t prompt_tokens = 0;
+  int64_t generated_tokens = 0;
+  // Time to the first generated token, including the prompt prefill.
+  double ttft_ms = 0;
+  double prefill_tokens_per_second = 0;
+  double decode_tokens_per_second = 0;
+  LatencySummary token_latency;
+  long peak_rss_kb = 0;
+  // Where the time went, e.g. per stage or per model chunk.
+  std::vector<std::pair<std::string, double>> breakdown_ms;
+};
+
+class BenchmarkReport {
+ public:
+  explicit BenchmarkReport(std::string runner) : runner_(std::move(runner)) {}
+
+  /// Records information about the benchmark setup, e.g. the model path.
+  void add_metadata(const std::string& key, const std::string& value) {
+    metadata_.emplace_back(key, value);
+  }
+
+  void add_result(BenchmarkResult result) {
+    results_.push_back(std::move(result));
+  }
+
+  const std::vector<BenchmarkResult>& results() const {
+    return results_;
+  }
+
+  std::string to_json() const {
+    std::stringstream ss;
+    ss << "{\"runner\":" << quote(runner_) << ",\"metadata\":{";
+    for (size_t i = 0; i < metadata_.size(); i++) {
+      ss << (i > 0 ? "," : "") << quote(metadata_[i].first) << ":"
+         << quote(metadata_[i].second);
+    }
+    ss << "},\"results\":[";
+    for (size_t i = 0; i < results_.size(); i++) {
+      const BenchmarkResult& r = results_[i];
+      ss << (i > 0 ? "," : "") << "{"
+         << "\"requested_prompt_tokens\":" << r.requested_prompt_tokens
+         << ",\"requested_generated_tokens\":" << r.requested_generated_tokens
+         << ",\"prompt_tokens\":" << r.prompt_tokens
+         << ",\"generated_tokens\":" << r.generated_tokens
+         << ",\"ttft_ms\":" << r.ttft_ms
+         << ",\"prefill_tokens_per_second\":" << r.prefill_tokens_per_second
+         << ",\"decode_tokens_per_second\":" << r.decode_tokens_per_second
+         << ",\"token_latency_ms\":{"
+         << "\"mean\":" << r.token_latency.mean_ms
+         << ",\"p50\":" << r.token_latency.p50_ms
+         << ",\"p90\":" << r.token_latency.p90_ms
+         << ",\"p99\":" << r.token_latency.p99_ms
+         << ",\"max\":" << r.token_latency.max_ms << "}"
+         << ",\"peak_rss_kb\":" << r.peak_rss_kb << ",\"breakdown_ms\":{";
+      for (size_t j = 0; j < r.breakdown_ms.size(); j++) {
+        ss << (j > 0 ? "," : "") << quote(r.breakdown_ms[j].first) << ":"
+           << r.breakdown_ms[j].second;
+      }
+      ss << "}}";
+    }
+    ss << "]}";
+    return ss.str();
+  }
+
+  /// Writes the report to `path`, or to stdout if it is empty.
+  bool write(const std::string& path) const {
+    FILE* file = path.empty() ? stdout : fopen(path.c_str(), "w");
+    if (file == nullptr) {
+      return false;
+    }
+    const std::string json = to_json();
+    const bool ok = fprintf(file, "%s\n", json.c_str()) >= 0;
+    if (file != stdout) {
+      return fclose(file) == 0 && ok;
+    }
+    fflush(file);
+    return ok;
+  }
+
+ private:
+  static std::string quote(const std::string& value) {
+    std::string quoted = "\"";
+    for (const char c : value) {
+      switch (c) {
+        case '"':
+          quoted += "\\\"";
+          break;
+        case '\\':
+          quoted += "\\\\";
+          break;
+        case '\n':
+          quoted += "\\n";
+          break;
+        case '\t':
+          quoted += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+          } else {
+            quoted += c;
+          }
+      }
+    }
+    return quoted + "\"";
+  }
+
+  std::string runner_;
+  std::vector<std::pair<std::string, std::string>> metadata_;
+  std::vector<BenchmarkResult> results_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
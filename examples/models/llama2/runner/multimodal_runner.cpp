@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// A runner for llama2 models that take an image in the prompt, e.g. LLaVA: the
+// embeddings of an image encoder are spliced in between two pieces of text.
+
+#include <executorch/examples/models/llama2/runner/multimodal_runner.h>
+#include <executorch/examples/models/llama2/tokenizer/streaming_decoder.h>
+#if ET_USE_TIKTOKEN
+#include <executorch/examples/models/llama2/tokenizer/tiktoken.h>
+#else /* BPE */
+#include <executorch/examples/models/llama2/tokenizer/bpe_tokenizer.h>
+#endif /* ET_USE_TIKTOKEN*/
+#include <executorch/extension/runner_util/managed_tensor.h>
+
+#include <algorithm>
+#include <ctime>
+#include <future>
+
+#include <executorch/examples/models/llama2/runner/util.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch::executor {
+namespace {
+static constexpr auto kTopp = 0.9f;
+} // namespace
+
+MultimodalRunner::MultimodalRunner(
+    const std::string& model_path,
+    const std::string& token_embedding_path,
+    const std::string& image_encoder_path,
+    const std::string& tokenizer_path,
+    const float temperature)
+    : module_(std::make_unique<Module>(
+          model_path,
+          Module::MlockConfig::UseMlockIgnoreErrors)),
+      token_embedding_module_(std::make_unique<Module>(
+          token_embedding_path,
+          Module::MlockConfig::UseMlockIgnoreErrors)),
+      image_encoder_module_(std::make_unique<Module>(
+          image_encoder_path,
+          Module::MlockConfig::UseMlockIgnoreErrors)),
+      tokenizer_path_(tokenizer_path),
+      temperature_(temperature) {
+  ET_LOG(
+      Info,
+      "Creating multimodal LLaMa runner: model_path=%s, token_embedding_path=%s, image_encoder_path=%s, tokenizer_path=%s",
+      model_path.c_str(),
+      token_embedding_path.c_str(),
+      image_encoder_path.c_str(),
+      tokenizer_path.c_str());
+}
+
+bool MultimodalRunner::is_loaded() const {
+  return module_->is_loaded() && token_embedding_module_->is_loaded() &&
+      image_encoder_module_->is_loaded() && tokenizer_ && sampler_;
+}
+
+Error MultimodalRunner::load() {
+  if (is_loaded()) {
+    return Error::Ok;
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(token_embedding_module_->load_method("forward"));
+  ET_CHECK_OK_OR_RETURN_ERROR(image_encoder_module_->load_method("forward"));
+  auto method_res = module_->bind_method("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(method_res.error());
+  method_ = method_res.get();
+
+  ET_LOG(Info, "Reading metadata from model");
+  const auto method_names = module_->method_names();
+  ET_CHECK_OK_OR_RETURN_ERROR(method_names.error());
+  model_methods_ = method_names.get();
+  ET_CHECK_OR_RETURN_ERROR(
+      getMetadataHelper("use_input_embeddings", false) &&
+          getMetadataHelper("use_kv_cache", false) &&
+          getMetadataHelper("enable_dynamic_shape", false),
+      InvalidProgram,
+      "Expected a model exported with --input_embeddings, --use_kv_cache and --enable_dynamic_shape");
+  vocab_size_ = getMetadataHelper<int64_t>("get_vocab_size", 32000);
+  bos_id_ = getMetadataHelper<int64_t>("get_bos_id", 1);
+  eos_id_ = getMetadataHelper<int64_t>("get_eos_id", 2);
+  n_bos_ = getMetadataHelper<int64_t>("get_n_bos", 1);
+  max_seq_len_ = getMetadataHelper<int64_t>("get_max_seq_len", 128);
+  dim_ = getMetadataHelper<int64_t>("get_dim", 4096);
+
+  // See Runner::load(): the logits are memory planned unless the model was
+  // exported with --last_logits_only.
+  const auto method_meta = module_->method_meta("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(method_meta.error());
+  const auto logits_meta = method_meta->output_tensor_meta(0);
+  ET_CHECK_OK_OR_RETURN_ERROR(logits_meta.error());
+  logits_buffer_.resize(logits_meta->nbytes());
+  const auto set_output_error = method_->set_output_data_ptr(
+      logits_buffer_.data(), logits_buffer_.size(), 0);
+  if (set_output_error == Error::InvalidState) {
+    logits_buffer_.clear();
+    logits_buffer_.shrink_to_fit();
+  } else {
+    ET_CHECK_OK_OR_RETURN_ERROR(set_output_error);
+  }
+
+#if ET_USE_TIKTOKEN
+  tokenizer_ = std::make_unique<Tiktoken>(vocab_size_, bos_id_, eos_id_);
+#else
+  tokenizer_ = std::make_unique<BPETokenizer>(vocab_size_, bos_id_, eos_id_);
+#endif
+  ET_CHECK_OK_OR_RETURN_ERROR(tokenizer_->load(tokenizer_path_));
+  sampler_ = std::make_unique<Sampler>(
+      vocab_size_,
+      temperature_,
+      kTopp,
+      static_cast<unsigned long long>(std::time(nullptr)));
+
+  return Error::Ok;
+}
+
+template <typename T>
+T MultimodalRunner::getMetadataHelper(
+    const std::string& method_name,
+    T default_val) {
+  T res = default_val;
+  if (model_methods_.count(method_name)) {
+    Result<std::vector<EValue>> outputs = module_->execute(method_name);
+    if (outputs.ok() && outputs->size() > 0) {
+      res = outputs.get()[0].to<T>();
+    }
+  } else {
+    ET_LOG(
+        Info,
+        "The model does not contain %s method, using default value %lld",
+        method_name.c_str(),
+        (long long)default_val);
+  }
+  ET_LOG(Info, "%s: %lld", method_name.c_str(), (long long)res);
+  return res;
+}
+
+Error MultimodalRunner::prefill_embeddings(
+    float* embeddings,
+    int64_t num_tokens,
+    int64_t start_pos,
+    EValue& logits) {
+  ET_CHECK_OR_RETURN_ERROR(
+      num_tokens > 0 && start_pos + num_tokens <= max_seq_len_,
+      InvalidArgument,
+      "Can not prefill %" PRId64 " positions at %" PRId64 " with max seq len %d",
+      num_tokens,
+      start_pos,
+      max_seq_len_);
+  const int64_t max_chunk_size = max_seq_len_ - 1;
+  std::vector<int64_t> pos_data(std::min(num_tokens, max_chunk_size));
+
+  for (int64_t start = 0; start < num_tokens; start += max_chunk_size) {
+    const int64_t chunk_size = std::min(max_chunk_size, num_tokens - start);
+    for (int64_t i = 0; i < chunk_size; i++) {
+      pos_data[i] = start_pos + start + i;
+    }
+    ManagedTensor embeddings_managed(
+        embeddings + start * dim_,
+        128, // TODO clean up unused 128 here as ManagedTensor ignores this arg
+             // in ctor
+        {1, static_cast<exec_aten::SizesType>(chunk_size), dim_},
+        ScalarType::Float);
+    ManagedTensor input_pos_managed(
+        pos_data.data(),
+        128,
+        {static_cast<exec_aten::SizesType>(chunk_size)},
+        ScalarType::Long);
+
+    // inputs:[embeddings, input_pos]
+    EValue inputs[] = {
+        embeddings_managed.get_aliasing_tensor(),
+        input_pos_managed.get_aliasing_tensor()};
+    ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+        *method_, Span<const EValue>(inputs, 2), Span<EValue>(&logits, 1)));
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      logits.isTensor(),
+      InvalidProgram,
+      "Non Tensor Output returned from executing LLM");
+  return Error::Ok;
+}
+
+Error MultimodalRunner::prefill_tokens(
+    const std::vector<uint64_t>& tokens,
+    int64_t start_pos,
+    EValue& logits) {
+  // The token embedding program shares the dynamic seq_len dimension of the
+  // model, so the tokens are embedded in chunks of the same size.
+  const int64_t num_tokens = tokens.size();
+  const int64_t max_chunk_size = max_seq_len_ - 1;
+  std::vector<int64_t> token_data(std::min(num_tokens, max_chunk_size));
+
+  for (int64_t start = 0; start < num_tokens; start += max_chunk_size) {
+    const int64_t chunk_size = std::min(max_chunk_size, num_tokens - start);
+    std::copy(
+        tokens.begin() + start,
+        tokens.begin() + start + chunk_size,
+        token_data.begin());
+    ManagedTensor tokens_managed(
+        token_data.data(),
+        128,
+        {1, static_cast<exec_aten::SizesType>(chunk_size)},
+        ScalarType::Long);
+    auto embeddings_res = token_embedding_module_->forward(
+        {tokens_managed.get_aliasing_tensor()});
+    ET_CHECK_OK_OR_RETURN_ERROR(embeddings_res.error());
+    ET_CHECK_OR_RETURN_ERROR(
+        embeddings_res->size() == 1 && embeddings_res.get()[0].isTensor(),
+        InvalidProgram,
+        "Expected the token embedding program to return a tensor");
+    const auto embeddings = embeddings_res.get()[0].toTensor();
+    ET_CHECK_OR_RETURN_ERROR(
+        embeddings.scalar_type() == ScalarType::Float &&
+            embeddings.numel() == chunk_size * dim_,
+        InvalidProgram,
+        "Expected %" PRId64 " float token embeddings of size %d",
+        chunk_size,
+        dim_);
+
+    // The embeddings stay valid until the next execution of the program.
+    ET_CHECK_OK_OR_RETURN_ERROR(prefill_embeddings(
+        embeddings.mutable_data_ptr<float>(),
+        chunk_size,
+        start_pos + start,
+        logits));
+  }
+  return Error::Ok;
+}
+
+int32_t MultimodalRunner::sample(const exec_aten::Tensor& logits) {
+  // Logits of shape [1, seq_len, vocab_size] are for all tokens, sample from
+  // the last ones.
+  const size_t offset =
+      logits.dim() == 3 ? (logits.size(1) - 1) * logits.size(2) : 0;
+  switch (logits.scalar_type()) {
+    case ScalarType::Float:
+      return sampler_->sample(logits.mutable_data_ptr<float>() + offset);
+    case ScalarType::Half:
+      return sampler_->sample(
+          logits.mutable_data_ptr<exec_aten::Half>() + offset);
+    default:
+      ET_CHECK_MSG(
+          false,
+          "Unsupported dtype output %hhd",
+          static_cast<int8_t>(logits.scalar_type()));
+  }
+}
+
+Error MultimodalRunner::generate(
+    const std::string& prompt_prefix,
+    const exec_aten::Tensor& image,
+    const std::string& prompt_suffix,
+    int32_t seq_len,
+    std::function<void(const std::string&)> token_callback) {
+  if (!is_loaded()) {
+    ET_CHECK_OK_OR_RETURN_ERROR(load());
+  }
+  shouldStop_ = false;
+  seq_len = (seq_len > 0 && seq_len <= max_seq_len_) ? seq_len : max_seq_len_;
+  const long start_ms = util::time_in_ms();
+
+  // Nothing the text before the image depends on is computed by the encoder,
+  // so both run at once. The future joins the encoder thread on all paths.
+  std::future<Result<std::vector<EValue>>> image_future =
+      std::async(std::launch::async, [this, &image]() {
+        return image_encoder_module_->forward({image});
+      });
+
+  auto prefix_res = tokenizer_->encode(prompt_prefix, n_bos_, 0);
+  ET_CHECK_OK_OR_RETURN_ERROR(prefix_res.error());
+  const std::vector<uint64_t>& prefix_tokens = prefix_res.get();
+  ET_CHECK_OR_RETURN_ERROR(
+      !prefix_tokens.empty(), InvalidArgument, "Expected a BOS token at least");
+  EValue logits;
+  ET_CHECK_OK_OR_RETURN_ERROR(prefill_tokens(prefix_tokens, 0, logits));
+  int64_t pos = prefix_tokens.size();
+  const long prefix_end_ms = util::time_in_ms();
+
+  auto image_res = image_future.get();
+  const long image_end_ms = util::time_in_ms();
+  ET_CHECK_OK_OR_RETURN_ERROR(image_res.error());
+  ET_CHECK_OR_RETURN_ERROR(
+      image_res->size() == 1 && image_res.get()[0].isTensor(),
+      InvalidProgram,
+      "Expected the image encoder to return a tensor");
+  const auto image_embeddings = image_res.get()[0].toTensor();
+  ET_CHECK_OR_RETURN_ERROR(
+      image_embeddings.scalar_type() == ScalarType::Float &&
+          image_embeddings.dim() >= 2 &&
+          image_embeddings.size(image_embeddings.dim() - 1) == dim_,
+      InvalidProgram,
+      "Expected float image embeddings of size %d",
+      dim_);
+  const int64_t num_image_tokens = image_embeddings.numel() / dim_;
+  ET_CHECK_OK_OR_RETURN_ERROR(prefill_embeddings(
+      image_embeddings.mutable_data_ptr<float>(),
+      num_image_tokens,
+      pos,
+      logits));
+  pos += num_image_tokens;
+
+  auto suffix_res = tokenizer_->encode(prompt_suffix, 0, 0);
+  ET_CHECK_OK_OR_RETURN_ERROR(suffix_res.error());
+  const std::vector<uint64_t>& suffix_tokens = suffix_res.get();
+  if (!suffix_tokens.empty()) {
+    ET_CHECK_OK_OR_RETURN_ERROR(prefill_tokens(suffix_tokens, pos, logits));
+    pos += suffix_tokens.size();
+  }
+  const long prompt_end_ms = util::time_in_ms();
+  ET_LOG(
+      Info,
+      "Prompt of %" PRId64
+      " positions evaluated in %ld ms: text prefix %ld ms, waited %ld ms for the image encoder",
+      pos,
+      prompt_end_ms - start_ms,
+      prefix_end_ms - start_ms,
+      image_end_ms - prefix_end_ms);
+
+  // The image has no tokens to decode, so the text resumes from the last
+  // prompt token.
+  StreamingDecoder decoder(*tokenizer_);
+  int64_t prev_token =
+      suffix_tokens.empty() ? prefix_tokens.back() : suffix_tokens.back();
+  int64_t cur_token = sample(logits.toTensor());
+  const int64_t num_prompt_positions = pos;
+
+  while (true) {
+    ET_CHECK_OK_OR_RETURN_ERROR(decoder.step(prev_token, cur_token));
+    util::safe_printf(decoder.text().c_str());
+    fflush(stdout);
+    if (token_callback && !decoder.text().empty()) {
+      token_callback(decoder.text());
+    }
+    if (shouldStop_ || cur_token == eos_id_ || pos >= seq_len) {
+      break;
+    }
+
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        prefill_tokens({static_cast<uint64_t>(cur_token)}, pos, logits));
+    pos++;
+    prev_token = cur_token;
+    cur_token = sample(logits.toTensor());
+  }
+  decoder.flush();
+  util::safe_printf(decoder.text().c_str());
+  if (token_callback && !decoder.text().empty()) {
+    token_callback(decoder.text());
+  }
+  printf("\n");
+
+  const long end_ms = util::time_in_ms();
+  const int64_t num_generated_tokens = pos - num_prompt_positions + 1;
+  ET_LOG(
+      Info,
+      "Generated %" PRId64 " tokens in %ld ms",
+      num_generated_tokens,
+      end_ms - prompt_end_ms);
+  return Error::Ok;
+}
+
+void MultimodalRunner::stop() {
+  shouldStop_ = true;
+}
+
+} // namespace torch::executor
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// A runner for llama2 models that take an image in the prompt, e.g. LLaVA: the
+// embeddings of an image encoder are spliced in between two pieces of text.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <executorch/examples/models/llama2/sampler/sampler.h>
+#include <executorch/examples/models/llama2/tokenizer/tokenizer.h>
+#include <executorch/extension/module/module.h>
+
+namespace torch::executor {
+
+/**
+ * Runs three programs: an image encoder returning image embeddings of shape
+ * [1, num_image_tokens, dim], the token embedding table of the text model,
+ * and the text model exported with --input_embeddings, --use_kv_cache and
+ * --enable_dynamic_shape, which takes the embeddings of its tokens.
+ *
+ * The image encoder runs on its own thread while the text before the image is
+ * tokenized and prefilled, so that its latency is hidden behind the prefill.
+ * The two overlap best when the encoder and the text model are delegated to
+ * different backends, e.g. a GPU and the CPU; programs sharing the CPU
+ * threadpool take turns in its parallel regions.
+ */
+class MultimodalRunner {
+ public:
+  explicit MultimodalRunner(
+      const std::string& model_path,
+      const std::string& token_embedding_path,
+      const std::string& image_encoder_path,
+      const std::string& tokenizer_path,
+      const float temperature = 0.8f);
+
+  bool is_loaded() const;
+  Error load();
+
+  /**
+   * Generates up to `seq_len` positions, including the prompt, from
+   * `prompt_prefix`, the image, whose preprocessed pixels are the input of the
+   * image encoder, then `prompt_suffix`.
+   */
+  Error generate(
+      const std::string& prompt_prefix,
+      const exec_aten::Tensor& image,
+      const std::string& prompt_suffix,
+      int32_t seq_len = 768,
+      std::function<void(const std::string&)> token_callback = {});
+  void stop();
+
+ private:
+  template <typename T>
+  T getMetadataHelper(const std::string& method_name, T default_val);
+  // Feeds `num_tokens` embeddings, starting at position `start_pos`, to the
+  // text model, in chunks of up to max_seq_len - 1 positions. Sets `logits` to
+  // the logits of the last chunk, valid until the next execution.
+  Error prefill_embeddings(
+      float* embeddings,
+      int64_t num_tokens,
+      int64_t start_pos,
+      EValue& logits);
+  // Embeds the tokens and prefills them, see prefill_embeddings().
+  Error prefill_tokens(
+      const std::vector<uint64_t>& tokens,
+      int64_t start_pos,
+      EValue& logits);
+  int32_t sample(const exec_aten::Tensor& logits);
+
+  // metadata
+  int32_t vocab_size_;
+  int32_t bos_id_;
+  int32_t eos_id_;
+  int32_t n_bos_;
+  int32_t max_seq_len_;
+  int32_t dim_;
+  std::unordered_set<std::string> model_methods_;
+  std::unique_ptr<Module> module_;
+  std::unique_ptr<Module> token_embedding_module_;
+  std::unique_ptr<Module> image_encoder_module_;
+  // The bound "forward" method of the text model.
+  Method* method_ = nullptr;
+  // Holds the logits output when it is not memory planned by the model.
+  std::vector<uint8_t> logits_buffer_;
+  std::string tokenizer_path_;
+  float temperature_;
+  std::unique_ptr<Tokenizer> tokenizer_;
+  std::unique_ptr<Sampler> sampler_;
+  bool shouldStop_{false};
+};
+
+} // namespace torch::executor
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Prompt lookup decoding: draft tokens for speculative decoding are copied
+// from the context instead of being generated by a draft model. Outputs that
+// repeat spans of the prompt, e.g. summaries or code edits, accept many of
+// them.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Proposes up to `max_draft_tokens` tokens to follow `tokens`: finds the
+ * latest earlier occurrence of the n-gram that ends `tokens` and returns the
+ * tokens after it. N-grams of `max_ngram_size` tokens are tried first, down to
+ * `min_ngram_size` tokens. Returns no tokens if none of them occurs earlier.
+ */
+inline std::vector<uint64_t> prompt_lookup_draft(
+    const std::vector<uint64_t>& tokens,
+    size_t max_ngram_size,
+    size_t max_draft_tokens,
+    size_t min_ngram_size = 1) {
+  const size_t num_tokens = tokens.size();
+  if (max_draft_tokens == 0 || min_ngram_size == 0) {
+    return {};
+  }
+  for (size_t ngram_size = std::min(max_ngram_size, num_tokens - 1);
+       ngram_size >= min_ngram_size && ngram_size < num_tokens;
+       ngram_size--) {
+    const auto ngram = tokens.end() - ngram_size;
+    // The n-gram at `start` is followed by at least one token.
+    for (size_t start = num_tokens - ngram_size; start-- > 0;) {
+      if (std::equal(ngram, tokens.end(), tokens.begin() + start)) {
+        const size_t draft_start = start + ngram_size;
+        const size_t draft_end =
+            std::min(draft_start + max_draft_tokens, num_tokens);
+        return std::vector<uint64_t>(
+            tokens.begin() + draft_start, tokens.begin() + draft_end);
+      }
+    }
+  }
+  return {};
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
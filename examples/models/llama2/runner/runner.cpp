@@ -9,7 +9,9 @@
 // A simple llama2 runner that includes preprocessing and post processing logic.
 // The module takes in a string as input and emits a string as output.
 
+#include <executorch/examples/models/llama2/runner/prompt_lookup.h>
 #include <executorch/examples/models/llama2/runner/runner.h>
+#include <executorch/examples/models/llama2/tokenizer/streaming_decoder.h>
 #if ET_USE_TIKTOKEN
 #include <executorch/examples/models/llama2/tokenizer/tiktoken.h>
 #else /* BPE */
@@ -18,6 +20,7 @@
 #include <executorch/extension/evalue_util/print_evalue.h>
 #include <executorch/extension/runner_util/managed_tensor.h>
 
+#include <algorithm>
 #include <ctime>
 #include <memory>
 #include <sstream>
@@ -62,7 +65,30 @@ Error Runner::load() {
   if (is_loaded()) {
     return Error::Ok;
   }
-  ET_CHECK_OK_OR_RETURN_ERROR(module_->load_method("forward"));
+  auto method_res = module_->bind_method("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(method_res.error());
+  method_ = method_res.get();
+  ET_CHECK_OR_RETURN_ERROR(
+      method_->outputs_size() == 1,
+      InvalidProgram,
+      "Expected the model to return the logits only, got %zu outputs",
+      method_->outputs_size());
+
+  // Models exported with --last_logits_only leave the logits output to the
+  // runner. Others plan its memory, which can not be overridden.
+  const auto method_meta = module_->method_meta("forward");
+  ET_CHECK_OK_OR_RETURN_ERROR(method_meta.error());
+  const auto logits_meta = method_meta->output_tensor_meta(0);
+  ET_CHECK_OK_OR_RETURN_ERROR(logits_meta.error());
+  logits_buffer_.resize(logits_meta->nbytes());
+  const auto set_output_error = method_->set_output_data_ptr(
+      logits_buffer_.data(), logits_buffer_.size(), 0);
+  if (set_output_error == Error::InvalidState) {
+    logits_buffer_.clear();
+    logits_buffer_.shrink_to_fit();
+  } else {
+    ET_CHECK_OK_OR_RETURN_ERROR(set_output_error);
+  }
 
   // Read out metadata: vocab_size (expected by the model), BOS, EOS, n_BOS,
   // n_EOS max_seq_len from the model
@@ -78,6 +104,7 @@ Error Runner::load() {
   max_seq_len_ = getMetadataHelper<int64_t>("get_max_seq_len", 128);
   use_kv_cache_ = getMetadataHelper("use_kv_cache", true);
   use_sdpa_with_kv_cache_ = getMetadataHelper("use_sdpa_with_kv_cache", false);
+  enable_dynamic_shape_ = getMetadataHelper("enable_dynamic_shape", false);
   append_eos_ = getMetadataHelper("append_eos_to_prompt", false);
 
   // Load tokenizer
@@ -136,19 +163,41 @@ T Runner::getMetadataHelper(const std::string& method_name, T default_val) {
 }
 
 template <typename T>
-int32_t Runner::logitsToToken(
+int32_t Runner::logitsToToken(const exec_aten::Tensor& logits_tensor, T _) {
+  // Logits of shape [1, seq_len, vocab_size] are for all tokens, get the last
+  // token probabilities. Logits of shape [1, vocab_size] are already those.
+  const int64_t last =
+      logits_tensor.dim() == 3 ? logits_tensor.size(1) - 1 : 0;
+  return logitsToTokenAt(logits_tensor, last, _);
+}
+
+template <typename T>
+int32_t Runner::logitsToTokenAt(
     const exec_aten::Tensor& logits_tensor,
-    int64_t pos,
+    int64_t position,
     T _) {
   (void)_;
   T* logits = logits_tensor.mutable_data_ptr<T>();
+  if (logits_tensor.dim() == 3) {
+    logits += position * logits_tensor.size(2);
+  }
+  return sampler_->sample(logits);
+}
 
-  // Since the logits are for all tokens, get the last token probabilities
-  T* logits_last = logits;
-  if (!use_kv_cache_) {
-    logits_last += pos * tokenizer_->vocab_size();
+int32_t Runner::sample_at(
+    const exec_aten::Tensor& logits_tensor,
+    int64_t position) {
+  switch (logits_tensor.scalar_type()) {
+    case ScalarType::Float:
+      return logitsToTokenAt<float>(logits_tensor, position, 0);
+    case ScalarType::Half:
+      return logitsToTokenAt<exec_aten::Half>(logits_tensor, position, 0);
+    default:
+      ET_CHECK_MSG(
+          false,
+          "Unsupported dtype output %hhd",
+          static_cast<int8_t>(logits_tensor.scalar_type()));
   }
-  return sampler_->sample(logits_last);
 }
 
 // Given an input token. Set up the inputs for the model and execute a single
@@ -160,7 +209,6 @@ Result<torch::executor::Tensor> Runner::run_model_step(
     size_t max_seq_len) {
   // ET_LOG(Info, "Input token %" PRIu64, input_token);
   if (use_kv_cache_) {
-    std::vector<EValue> inputs;
     auto tokens = managed_tokens.get_aliasing_tensor();
     auto start_pos = managed_start_pos.get_aliasing_tensor();
 
@@ -169,25 +217,19 @@ Result<torch::executor::Tensor> Runner::run_model_step(
     tokens.mutable_data_ptr<int64_t>()[0] = input_token;
 
     // inputs:[tokens, start_pos]
-    inputs.push_back(tokens);
-    inputs.push_back(start_pos);
-
-    Result<std::vector<EValue>> outputs_res = module_->forward(inputs);
-    ET_CHECK_OK_OR_RETURN_ERROR(outputs_res.error());
+    EValue inputs[] = {tokens, start_pos};
+    EValue outputs[1];
+    ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+        *method_, Span<const EValue>(inputs, 2), Span<EValue>(outputs, 1)));
     ET_CHECK_MSG(
-        outputs_res.get().size() == 1,
-        "More then one output returned from executing LLM.");
-    ET_CHECK_MSG(
-        outputs_res.get()[0].isTensor(),
-        "Non Tensor Output returned from executing LLM");
+        outputs[0].isTensor(), "Non Tensor Output returned from executing LLM");
 
     // Bump start_pos by 1
     start_pos.mutable_data_ptr<int64_t>()[0]++;
 
     // Return the logits tensor
-    return outputs_res.get()[0].toTensor();
+    return outputs[0].toTensor();
   } else { // no kv cache
-    std::vector<EValue> inputs;
     auto tokens = managed_tokens.get_aliasing_tensor();
     (void)managed_start_pos; // unused
 
@@ -197,16 +239,12 @@ Result<torch::executor::Tensor> Runner::run_model_step(
     tokens.mutable_data_ptr<int64_t>()[tokens.size(1) - 1] = input_token;
 
     // inputs:[tokens]
-    inputs.push_back(tokens);
-
-    Result<std::vector<EValue>> outputs_res = module_->forward(inputs);
-    ET_CHECK_OK_OR_RETURN_ERROR(outputs_res.error());
+    EValue inputs[] = {tokens};
+    EValue outputs[1];
+    ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+        *method_, Span<const EValue>(inputs, 1), Span<EValue>(outputs, 1)));
     ET_CHECK_MSG(
-        outputs_res.get().size() == 1,
-        "More then one output returned from executing LLM.");
-    ET_CHECK_MSG(
-        outputs_res.get()[0].isTensor(),
-        "Non Tensor Output returned from executing LLM");
+        outputs[0].isTensor(), "Non Tensor Output returned from executing LLM");
 
     if (tokens.size(1) < max_seq_len) {
       // Resize the tokens tensor to be 1 larger for next step.
@@ -214,8 +252,90 @@ Result<torch::executor::Tensor> Runner::run_model_step(
     }
 
     // Return the logits tensor
-    return outputs_res.get()[0].toTensor();
+    return outputs[0].toTensor();
+  }
+}
+
+// Feed the first `num_tokens` prompt tokens to a kv cache model that was
+// exported with a dynamic seq_len dimension, filling its cache. The tokens are
+// processed in chunks of up to max_seq_len - 1 tokens, the upper bound of that
+// dimension, so most prompts take a single forward call.
+Error Runner::run_model_prefill(
+    const std::vector<uint64_t>& prompt_tokens,
+    int64_t num_tokens) {
+  const int64_t max_chunk_size = max_seq_len_ - 1;
+  std::vector<int64_t> token_data(std::min(num_tokens, max_chunk_size));
+  std::vector<int64_t> pos_data(token_data.size());
+
+  for (int64_t start = 0; start < num_tokens; start += max_chunk_size) {
+    const int64_t chunk_size = std::min(max_chunk_size, num_tokens - start);
+    for (int64_t i = 0; i < chunk_size; i++) {
+      token_data[i] = prompt_tokens[start + i];
+      pos_data[i] = start + i;
+    }
+
+    ManagedTensor tokens_managed(
+        token_data.data(),
+        128, // TODO clean up unused 128 here as ManagedTensor ignores this arg
+             // in ctor
+        {1, static_cast<exec_aten::SizesType>(chunk_size)},
+        ScalarType::Long);
+    ManagedTensor input_pos_managed(
+        pos_data.data(),
+        128,
+        {static_cast<exec_aten::SizesType>(chunk_size)},
+        ScalarType::Long);
+
+    // inputs:[tokens, input_pos]
+    EValue inputs[] = {
+        tokens_managed.get_aliasing_tensor(),
+        input_pos_managed.get_aliasing_tensor()};
+
+    // Only the cache update matters, the logits of the prompt are unused.
+    ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+        *method_, Span<const EValue>(inputs, 2), Span<EValue>()));
   }
+  return Error::Ok;
+}
+
+// Feed `tokens`, the current token followed by draft tokens, at the positions
+// starting at `start_pos` in a single forward call. Returns the logits of every
+// position. The cache entries of rejected draft tokens need no cleanup: the
+// positions after them are masked until they are overwritten.
+Result<torch::executor::Tensor> Runner::run_model_verify(
+    const std::vector<uint64_t>& tokens,
+    int64_t start_pos) {
+  const int64_t num_tokens = tokens.size();
+  std::vector<int64_t> token_data(tokens.begin(), tokens.end());
+  std::vector<int64_t> pos_data(num_tokens);
+  for (int64_t i = 0; i < num_tokens; i++) {
+    pos_data[i] = start_pos + i;
+  }
+  ManagedTensor tokens_managed(
+      token_data.data(),
+      128,
+      {1, static_cast<exec_aten::SizesType>(num_tokens)},
+      ScalarType::Long);
+  ManagedTensor input_pos_managed(
+      pos_data.data(),
+      128,
+      {static_cast<exec_aten::SizesType>(num_tokens)},
+      ScalarType::Long);
+
+  // inputs:[tokens, input_pos]
+  EValue inputs[] = {
+      tokens_managed.get_aliasing_tensor(),
+      input_pos_managed.get_aliasing_tensor()};
+  EValue outputs[1];
+  ET_CHECK_OK_OR_RETURN_ERROR(Module::execute(
+      *method_, Span<const EValue>(inputs, 2), Span<EValue>(outputs, 1)));
+  ET_CHECK_OR_RETURN_ERROR(
+      outputs[0].isTensor() && outputs[0].toTensor().dim() == 3 &&
+          outputs[0].toTensor().size(1) == num_tokens,
+      InvalidProgram,
+      "Expected the logits of all %" PRId64 " positions",
+      num_tokens);
+  return outputs[0].toTensor();
 }
 
 Error Runner::generate(
@@ -236,6 +356,10 @@ Error Runner::generate(
   // return a response token.
 
   stats_.inference_start_ms = util::time_in_ms();
+  stats_.aggregate_sampling_time_ms = 0;
+  stats_.token_latencies_us.clear();
+  stats_.num_draft_tokens = 0;
+  stats_.num_accepted_draft_tokens = 0;
   shouldStop_ = false;
 
   // Set the sequence length to the max seq length if not provided
@@ -298,12 +422,25 @@ Error Runner::generate(
   int64_t prev_token;
   int64_t cur_token = prompt_tokens[0];
 
-  // If we arent using the kv cache then we can batch prefill the prompt
-  if (!use_kv_cache_) {
-    tokens_managed.resize({1, num_prompt_tokens});
-    for (int i = 0; i < num_prompt_tokens - 1; i++) {
-      tokens_managed.get_aliasing_tensor().mutable_data_ptr<int64_t>()[i] =
-          prompt_tokens[i];
+  // Holds back the bytes of characters split over several tokens.
+  StreamingDecoder decoder(*tokenizer_);
+
+  // If we arent using the kv cache, or the kv cache model takes any number of
+  // tokens, then we can batch prefill the prompt
+  if (!use_kv_cache_ || enable_dynamic_shape_) {
+    if (use_kv_cache_) {
+      // Fill the cache up to the last prompt token, which the first step below
+      // feeds at its position.
+      ET_CHECK_OK_OR_RETURN_ERROR(
+          run_model_prefill(prompt_tokens, num_prompt_tokens - 1));
+      start_pos_managed.get_aliasing_tensor().mutable_data_ptr<int64_t>()[0] =
+          num_prompt_tokens - 1;
+    } else {
+      tokens_managed.resize({1, num_prompt_tokens});
+      for (int i = 0; i < num_prompt_tokens - 1; i++) {
+        tokens_managed.get_aliasing_tensor().mutable_data_ptr<int64_t>()[i] =
+            prompt_tokens[i];
+      }
     }
     // prefill tokens up to the last prompt token and then enter the loop with
     // the last promp token as the current token.
@@ -316,16 +453,115 @@ Error Runner::generate(
     uint64_t cur;
     for (int i = 1; i < num_prompt_tokens; i++) {
       cur = prompt_tokens[i];
-      auto piece_res = tokenizer_->decode(prev, cur);
-      ET_CHECK_OK_OR_RETURN_ERROR(piece_res.error());
-      util::safe_printf(piece_res.get().c_str());
+      ET_CHECK_OK_OR_RETURN_ERROR(decoder.step(prev, cur));
+      util::safe_printf(decoder.text().c_str());
       fflush(stdout);
       prev = cur;
     }
   }
 
+  stats_.token_latencies_us.reserve(seq_len - num_prompt_tokens);
+
+  // Prompt lookup decoding drafts from the prompt and the generated tokens.
+  // Verifying the drafts needs the logits of every position they are fed at.
+  const bool use_prompt_lookup = prompt_lookup_num_tokens_ > 0 &&
+      use_kv_cache_ && enable_dynamic_shape_ && logits_buffer_.empty();
+  if (prompt_lookup_num_tokens_ > 0 && !use_prompt_lookup) {
+    ET_LOG(
+        Info,
+        "Prompt lookup decoding needs a kv cache model with a dynamic seq_len and the logits of every position, generating without it");
+  }
+  std::vector<uint64_t> context_tokens;
+  if (use_prompt_lookup) {
+    context_tokens = prompt_tokens;
+  }
+
+  // Prints and reports cur_token. Returns false when the generation ends.
+  auto emit_token = [&]() {
+    // print the token as string, decode it with the Tokenizer object
+    ET_CHECK(decoder.step(prev_token, cur_token) == Error::Ok);
+    const std::string& piece = decoder.text();
+
+    // same as printf("%s", piece), but skips "unsafe" bytes
+    util::safe_printf(piece.c_str());
+    fflush(stdout);
+
+    if (token_callback && !piece.empty()) {
+      token_callback(piece);
+    }
+
+    if (shouldStop_) {
+      return false;
+    }
+
+    // data-dependent terminating condition: we have n_eos_ number of EOS
+    if (pos >= num_prompt_tokens && cur_token == eos_id_) {
+      printf("\n");
+      ET_LOG(Info, "\nReached to the end of generation");
+      return false;
+    }
+    return true;
+  };
+
   // Generate our tokens
   while (pos < seq_len - 1) {
+    const long step_start_time_us = util::time_in_us();
+
+    // Draft the tokens after cur_token, leaving room for all of them and the
+    // token sampled after the last one.
+    std::vector<uint64_t> draft_tokens;
+    if (use_prompt_lookup && pos >= num_prompt_tokens) {
+      draft_tokens = util::prompt_lookup_draft(
+          context_tokens,
+          prompt_lookup_ngram_size_,
+          std::min<int64_t>(prompt_lookup_num_tokens_, seq_len - 2 - pos));
+    }
+    if (!draft_tokens.empty()) {
+      std::vector<uint64_t> verify_tokens = {static_cast<uint64_t>(cur_token)};
+      verify_tokens.insert(
+          verify_tokens.end(), draft_tokens.begin(), draft_tokens.end());
+      Result<torch::executor::Tensor> logits_res =
+          run_model_verify(verify_tokens, pos);
+      ET_CHECK_OK_OR_RETURN_ERROR(logits_res.error());
+
+      // Accept the drafts as long as they match the tokens sampled at the
+      // positions before them, then the token sampled after the last match.
+      long sample_start_time_ms = util::time_in_ms();
+      std::vector<int64_t> accepted_tokens;
+      for (size_t i = 0; i < verify_tokens.size(); i++) {
+        accepted_tokens.push_back(sample_at(logits_res.get(), i));
+        if (i == draft_tokens.size() ||
+            static_cast<uint64_t>(accepted_tokens.back()) != draft_tokens[i]) {
+          break;
+        }
+      }
+      stats_.aggregate_sampling_time_ms +=
+          util::time_in_ms() - sample_start_time_ms;
+      stats_.num_draft_tokens += draft_tokens.size();
+      stats_.num_accepted_draft_tokens += accepted_tokens.size() - 1;
+      const long token_latency_us =
+          (util::time_in_us() - step_start_time_us) / accepted_tokens.size();
+
+      bool should_continue = true;
+      for (const int64_t token : accepted_tokens) {
+        stats_.token_latencies_us.push_back(token_latency_us);
+        prev_token = cur_token;
+        cur_token = token;
+        context_tokens.push_back(cur_token);
+        pos++;
+        should_continue = emit_token();
+        if (!should_continue) {
+          break;
+        }
+      }
+      start_pos_managed.get_aliasing_tensor().mutable_data_ptr<int64_t>()[0] =
+          pos;
+      if (!should_continue) {
+        break;
+      }
+      continue;
+    }
+
     // Run the model
     Result<torch::executor::Tensor> logits_res =
         run_model_step(cur_token, tokens_managed, start_pos_managed, seq_len);
@@ -344,11 +580,11 @@ Error Runner::generate(
     long sample_start_time_ms = util::time_in_ms();
     switch (logits_tensor.scalar_type()) {
       case ScalarType::Float: {
-        cur_token = logitsToToken<float>(logits_tensor, pos, 0);
+        cur_token = logitsToToken<float>(logits_tensor, 0);
         break;
       }
       case ScalarType::Half: {
-        cur_token = logitsToToken<exec_aten::Half>(logits_tensor, pos, 0);
+        cur_token = logitsToToken<exec_aten::Half>(logits_tensor, 0);
         break;
       }
       default:
@@ -359,38 +595,29 @@ Error Runner::generate(
     }
     stats_.aggregate_sampling_time_ms +=
         util::time_in_ms() - sample_start_time_ms;
+    if (pos >= num_prompt_tokens - 1) {
+      stats_.token_latencies_us.push_back(
+          util::time_in_us() - step_start_time_us);
+    }
 
     // advance the state machine
     if (pos < num_prompt_tokens - 1) {
       // prefill, force the next token to be the next prompt token
       cur_token = prompt_tokens[pos + 1];
+    } else if (use_prompt_lookup) {
+      context_tokens.push_back(cur_token);
     }
     pos++;
 
-    // print the token as string, decode it with the Tokenizer object
-    auto piece_res = tokenizer_->decode(prev_token, cur_token);
-    ET_CHECK(piece_res.ok());
-    const char* piece = piece_res.get().c_str();
-
-    // same as printf("%s", piece), but skips "unsafe" bytes
-    util::safe_printf(piece);
-    fflush(stdout);
-
-    if (token_callback) {
-      token_callback(piece);
-    }
-
-    if (shouldStop_) {
-      break;
-    }
-
-    // data-dependent terminating condition: we have n_eos_ number of EOS
-    if (pos >= num_prompt_tokens && cur_token == eos_id_) {
-      printf("\n");
-      ET_LOG(Info, "\nReached to the end of generation");
+    if (!emit_token()) {
       break;
     }
   }
+  decoder.flush();
+  util::safe_printf(decoder.text().c_str());
+  if (token_callback && !decoder.text().empty()) {
+    token_callback(decoder.text());
+  }
   stats_.inference_end_ms = util::time_in_ms();
   printf("\n");
 
@@ -418,6 +645,14 @@ void printReport(const Runner::Stats& stats) {
       stats.num_prompt_tokens,
       stats.num_generated_tokens);
 
+  if (stats.num_draft_tokens > 0) {
+    ET_LOG(
+        Info,
+        "\tPrompt lookup: %" PRIu64 " of %" PRIu64 " draft tokens accepted",
+        stats.num_accepted_draft_tokens,
+        stats.num_draft_tokens);
+  }
+
   ET_LOG(
       Info,
       "\tModel Load Time:\t\t%f (seconds)",
@@ -490,6 +725,13 @@ void Runner::stop() {
   shouldStop_ = true;
 }
 
+void Runner::set_prompt_lookup(
+    int32_t max_ngram_size,
+    int32_t num_draft_tokens) {
+  prompt_lookup_ngram_size_ = max_ngram_size;
+  prompt_lookup_num_tokens_ = max_ngram_size > 0 ? num_draft_tokens : 0;
+}
+
 // explicit instantiation of template methods
 template int64_t Runner::getMetadataHelper<int64_t>(
     const std::string& method_name,
@@ -16,6 +16,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <executorch/examples/models/llama2/sampler/sampler.h>
 #include <executorch/examples/models/llama2/tokenizer/tokenizer.h>
@@ -55,6 +56,12 @@ class Runner {
     int64_t num_prompt_tokens;
     // Token count from generated (total - prompt)
     int64_t num_generated_tokens;
+    // Duration of each step that generated a token, including sampling, in
+    // microseconds. Steps generating several tokens count for each of them.
+    std::vector<long> token_latencies_us;
+    // Prompt lookup decoding: draft tokens verified, and accepted.
+    int64_t num_draft_tokens;
+    int64_t num_accepted_draft_tokens;
   };
 
   bool is_loaded() const;
@@ -66,18 +73,41 @@ class Runner {
       std::function<void(const Stats&)> stats_callback = {});
   void stop();
 
+  /**
+   * Enables prompt lookup decoding: each step, up to `num_draft_tokens` tokens
+   * following the latest earlier occurrence of the last n-gram of the context,
+   * of `max_ngram_size` tokens down to 1 token, are drafted and verified in a
+   * single forward call. 0 draft tokens disables it. The sampled tokens are
+   * the same as without drafts. Requires a kv cache model exported with
+   * --enable_dynamic_shape that returns the logits of every position.
+   */
+  void set_prompt_lookup(int32_t max_ngram_size, int32_t num_draft_tokens);
+
  private:
   // metadata
   template <typename T>
   T getMetadataHelper(const std::string& method_name, T default_val);
   template <typename T>
-  int32_t
-  logitsToToken(const exec_aten::Tensor& logits_tensor, int64_t pos, T _);
+  int32_t logitsToToken(const exec_aten::Tensor& logits_tensor, T _);
+  template <typename T>
+  int32_t logitsToTokenAt(
+      const exec_aten::Tensor& logits_tensor,
+      int64_t position,
+      T _);
+  // Samples from the logits of `position` of logits of shape [1, seq_len,
+  // vocab_size].
+  int32_t sample_at(const exec_aten::Tensor& logits_tensor, int64_t position);
   Result<torch::executor::Tensor> run_model_step(
       int64_t input_token,
       ManagedTensor& tokens,
       ManagedTensor& start_pos,
       size_t max_seq_len);
+  Error run_model_prefill(
+      const std::vector<uint64_t>& prompt_tokens,
+      int64_t num_tokens);
+  Result<torch::executor::Tensor> run_model_verify(
+      const std::vector<uint64_t>& tokens,
+      int64_t start_pos);
   // metadata
   int32_t vocab_size_;
   int32_t bos_id_;
@@ -87,14 +117,22 @@ class Runner {
   int32_t max_seq_len_;
   bool use_kv_cache_;
   bool use_sdpa_with_kv_cache_;
+  bool enable_dynamic_shape_;
   bool append_eos_;
   std::unordered_set<std::string> model_methods_;
   std::unique_ptr<Module> module_;
+  // The bound "forward" method, executed without per-step allocations.
+  Method* method_ = nullptr;
+  // Holds the logits output when it is not memory planned by the model, so
+  // that the method writes them straight into memory the sampler reads.
+  std::vector<uint8_t> logits_buffer_;
   std::string tokenizer_path_;
   float temperature_;
   std::unique_ptr<Tokenizer> tokenizer_;
   std::unique_ptr<Sampler> sampler_;
   bool shouldStop_{false};
+  int32_t prompt_lookup_ngram_size_ = 0;
+  int32_t prompt_lookup_num_tokens_ = 0;
   Stats stats_;
 };
 
@@ -18,9 +18,13 @@ def define_common_targets():
         runtime.cxx_library(
             name = "runner" + aten_suffix,
             srcs = [
+                "multimodal_runner.cpp",
                 "runner.cpp",
             ],
             exported_headers = [
+                "benchmark_report.h",
+                "multimodal_runner.h",
+                "prompt_lookup.h",
                 "runner.h",
                 "util.h",
             ],
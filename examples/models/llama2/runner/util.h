@@ -44,6 +44,13 @@ long inline time_in_ms() {
   return time.tv_sec * 1000 + time.tv_nsec / 1000000;
 }
 
+long inline time_in_us() {
+  // return time in microseconds, for measuring the duration of single steps
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
 } // namespace util
 } // namespace executor
 } // namespace torch
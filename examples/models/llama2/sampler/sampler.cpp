@@ -34,170 +34,383 @@
 
 #include <executorch/examples/models/llama2/sampler/sampler.h>
 
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+
+#include <algorithm>
+
 namespace torch {
 namespace executor {
 
-// sampler stuff
+namespace {
+
+using Vec = executorch::vec::Vectorized<float>;
+
+// Number of candidates that the first round of top-p sampling sorts. The
+// nucleus of a peaked distribution usually fits, and each further round sorts
+// four times as many candidates.
+constexpr int32_t kToppInitialSortSize = 64;
+
+bool greater_prob(const ProbIndex<float>& a, const ProbIndex<float>& b) {
+  return a.prob > b.prob;
+}
+
+unsigned int random_u32(unsigned long long* state) {
+  // xorshift rng: https://en.wikipedia.org/wiki/Xorshift#xorshift.2A
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return (*state * 0x2545F4914F6CDD1Dull) >> 32;
+}
+
+float random_f32(unsigned long long* state) { // random float32 in [0,1)
+  return (random_u32(state) >> 8) / 16777216.0f;
+}
+
+// Loads `count` logits, at most Vec::size(), as float.
+inline Vec load_logits(const float* logits, int64_t count) {
+  return Vec::loadu(logits, count);
+}
+
+template <
+    typename T,
+    typename std::enable_if<
+        executorch::vec::is_reduced_floating_point<T>::value,
+        int>::type = 0>
+inline Vec load_logits(const T* logits, int64_t count) {
+  return executorch::vec::load_float(logits, count);
+}
+
+template <
+    typename T,
+    typename std::enable_if<
+        !executorch::vec::is_reduced_floating_point<T>::value,
+        int>::type = 0>
+inline Vec load_logits(const T* logits, int64_t count) {
+  __at_align__ float values[Vec::size()];
+  for (int64_t i = 0; i < count; i++) {
+    values[i] = static_cast<float>(logits[i]);
+  }
+  return Vec::loadu(values, count);
+}
+
+// Returns the largest of the `size` logits, and sets `index` to the first
+// one equal to it if `index` is not null.
 template <typename T>
-int32_t Sampler::sample_argmax(T* probabilities) {
+float max_logit(const T* logits, int32_t size, int32_t* index = nullptr) {
+  float max_value = static_cast<float>(logits[0]);
+  int32_t i = 0;
+  if (size >= Vec::size()) {
+    Vec max_vec = load_logits(logits, Vec::size());
+    for (i = Vec::size(); i + Vec::size() <= size; i += Vec::size()) {
+      max_vec = executorch::vec::maximum(
+          max_vec, load_logits(logits + i, Vec::size()));
+    }
+    max_value = executorch::vec::vec_reduce_all<float>(
+        [](Vec& x, Vec& y) { return executorch::vec::maximum(x, y); }, max_vec);
+  }
+  for (; i < size; i++) {
+    max_value = std::max(max_value, static_cast<float>(logits[i]));
+  }
+  if (index != nullptr) {
+    *index = 0;
+    for (int32_t j = 0; j < size; j++) {
+      if (static_cast<float>(logits[j]) == max_value) {
+        *index = j;
+        break;
+      }
+    }
+  }
+  return max_value;
+}
+
+} // namespace
+
+Sampler::Sampler(
+    int vocab_size,
+    float temperature,
+    float topp,
+    unsigned long long rng_seed,
+    int32_t topk,
+    float repetition_penalty)
+    : vocab_size_(vocab_size),
+      temperature_(temperature),
+      topp_(topp),
+      topk_(topk),
+      repetition_penalty_(repetition_penalty),
+      rng_state_(rng_seed),
+      weights_(std::make_unique<float[]>(vocab_size)),
+      candidates_(std::make_unique<ProbIndex<float>[]>(vocab_size)),
+      penalized_(vocab_size, false) {}
+
+// sampler stuff
+int32_t Sampler::sample_argmax() {
   // return the index that has the highest probability
-  int max_i = 0;
-  T max_p = probabilities[0];
-  for (int i = 1; i < vocab_size_; i++) {
-    if (probabilities[i] > max_p) {
+  int32_t max_i = 0;
+  float max_p = weights_[0];
+  for (int32_t i = 1; i < vocab_size_; i++) {
+    if (weights_[i] > max_p) {
       max_i = i;
-      max_p = probabilities[i];
+      max_p = weights_[i];
     }
   }
   return max_i;
 }
 
+// Sets weights_ to exp((logit - max_logit) / temperature), i.e. probabilities
+// that are not normalized, and returns their sum. Instead of normalizing them,
+// the samplers below scale the coin by the sum. The logits are dequantized by
+// `scale` on the fly, so that no float copy of them is needed.
 template <typename T>
-int32_t Sampler::sample_mult(T* probabilities, float coin) {
-  // sample index from probabilities (they must sum to 1!)
+float Sampler::prepare_weights(
+    const T* logits,
+    float scale,
+    float inv_temperature) {
+  float* const weights = weights_.get();
+  // subtracting the max value keeps exp from overflowing; the scale is
+  // positive, so the largest raw logit is the largest dequantized one
+  const float factor = scale * inv_temperature;
+  const float max_value = max_logit(logits, vocab_size_);
+
+  const Vec factor_vec(factor);
+  const Vec shift(max_value * factor);
+  Vec sum_vec(0.0f);
+  int32_t i = 0;
+  for (; i + Vec::size() <= vocab_size_; i += Vec::size()) {
+    const Vec x =
+        (load_logits(logits + i, Vec::size()) * factor_vec - shift).exp();
+    x.store(weights + i);
+    sum_vec = sum_vec + x;
+  }
+  float sum = executorch::vec::vec_reduce_all<float>(
+      [](Vec& x, Vec& y) { return x + y; }, sum_vec);
+  for (; i < vocab_size_; i++) {
+    weights[i] = std::exp((static_cast<float>(logits[i]) - max_value) * factor);
+    sum += weights[i];
+  }
+  return sum;
+}
+
+int32_t Sampler::sample_mult(float total_weight, float coin) {
+  // sample index from the weights, whose sum is total_weight
   // coin is a random number in [0, 1), usually from random_f32()
-  T cdf = 0.0;
-  for (int i = 0; i < vocab_size_; i++) {
-    cdf += probabilities[i];
-    if (coin < cdf) {
+  const float r = coin * total_weight;
+  float cdf = 0.0f;
+  for (int32_t i = 0; i < vocab_size_; i++) {
+    cdf += weights_[i];
+    if (r < cdf) {
       return i;
     }
   }
   return vocab_size_ - 1; // in case of rounding errors
 }
 
-template <typename T>
-static int32_t compare(const void* a, const void* b) {
-  ProbIndex<T>* a_ = (ProbIndex<T>*)a;
-  ProbIndex<T>* b_ = (ProbIndex<T>*)b;
-  if (a_->prob > b_->prob) {
-    return -1;
-  } else if (a_->prob < b_->prob) {
-    return 1;
+int32_t Sampler::sample_topk(int32_t k, float coin) {
+  // top-k sampling samples from the k most likely tokens. nth_element finds
+  // them in linear time, only they are then sorted.
+  ProbIndex<float>* const candidates = candidates_.get();
+  for (int32_t i = 0; i < vocab_size_; i++) {
+    candidates[i].index = i;
+    candidates[i].prob = weights_[i];
+  }
+  std::nth_element(
+      candidates, candidates + k - 1, candidates + vocab_size_, greater_prob);
+  std::sort(candidates, candidates + k, greater_prob);
+
+  int32_t last_idx = k - 1;
+  float cumulative_weight = 0.0f;
+  for (int32_t i = 0; i < k; i++) {
+    cumulative_weight += candidates[i].prob;
+  }
+  if (topp_ > 0 && topp_ < 1) {
+    // truncate the top k tokens where their cumulative probability exceeds
+    // topp
+    const float target = topp_ * cumulative_weight;
+    cumulative_weight = 0.0f;
+    for (int32_t i = 0; i < k; i++) {
+      cumulative_weight += candidates[i].prob;
+      if (cumulative_weight > target) {
+        last_idx = i;
+        break;
+      }
+    }
+  }
+
+  // sample from the truncated list
+  const float r = coin * cumulative_weight;
+  float cdf = 0.0f;
+  for (int32_t i = 0; i <= last_idx; i++) {
+    cdf += candidates[i].prob;
+    if (r < cdf) {
+      return candidates[i].index;
+    }
   }
-  return 0;
+  return candidates[last_idx].index; // in case of rounding errors
 }
 
-template <typename T>
-int32_t Sampler::sample_topp(T* probabilities, float coin) {
+int32_t Sampler::sample_topp(float total_weight, float coin) {
   // top-p sampling (or "nucleus sampling") samples from the smallest set of
   // tokens that exceed probability topp. This way we never sample tokens that
   // have very low probabilities and are less likely to go "off the rails".
   // coin is a random number in [0, 1), usually from random_f32()
-  int n = vocab_size_;
-  int n0 = 0;
-  // quicksort indices in descending order of probabilities
+  ProbIndex<float>* const candidates = candidates_.get();
+  int32_t n0 = 0;
   // values smaller than (1 - topp) / (n - 1) cannot be part of the result
   // so for efficiency we crop these out as candidates before sorting
-  std::unique_ptr<ProbIndex<T>[]> probindex =
-      std::make_unique<ProbIndex<T>[]>(vocab_size_);
-
-  const float cutoff = (1.0f - topp_) / (n - 1);
-  for (int i = 0; i < n; i++) {
-    if (probabilities[i] >= cutoff) {
-      probindex[n0].index = i;
-      probindex[n0].prob = probabilities[i];
+  const float cutoff = (1.0f - topp_) / (vocab_size_ - 1) * total_weight;
+  for (int32_t i = 0; i < vocab_size_; i++) {
+    if (weights_[i] >= cutoff) {
+      candidates[n0].index = i;
+      candidates[n0].prob = weights_[i];
       n0++;
     }
   }
-  qsort(probindex.get(), n0, sizeof(ProbIndex<T>), compare<T>);
+  if (n0 == 0) {
+    return sample_argmax(); // in case of rounding errors
+  }
 
-  // truncate the list where cumulative probability exceeds topp
-  T cumulative_prob = 0;
-  int last_idx = n0 - 1; // in case of rounding errors consider all elements
-  for (int i = 0; i < n0; i++) {
-    cumulative_prob += probindex[i].prob;
-    if (cumulative_prob > topp_) {
-      last_idx = i;
-      break; // we've exceeded topp by including last_idx
+  // Only the candidates up to the one where the cumulative probability
+  // exceeds topp need to be in order. Sort them in rounds of growing size,
+  // each round sorts the next most likely candidates out of the remaining
+  // ones, and stop once the nucleus is found.
+  const float target = topp_ * total_weight;
+  float cumulative_weight = 0.0f;
+  int32_t last_idx = n0 - 1; // in case of rounding errors consider all elements
+  int32_t num_sorted = 0;
+  int32_t round_size = kToppInitialSortSize;
+  bool found = false;
+  while (!found && num_sorted < n0) {
+    const int32_t end = std::min(n0, num_sorted + round_size);
+    std::partial_sort(
+        candidates + num_sorted,
+        candidates + end,
+        candidates + n0,
+        greater_prob);
+    for (int32_t i = num_sorted; i < end; i++) {
+      cumulative_weight += candidates[i].prob;
+      if (cumulative_weight > target) {
+        last_idx = i;
+        found = true;
+        break; // we've exceeded topp by including last_idx
+      }
     }
+    num_sorted = end;
+    round_size *= 4;
   }
 
   // sample from the truncated list
-  const T& r = coin * cumulative_prob;
-  T cdf = 0;
-  for (int i = 0; i <= last_idx; i++) {
-    cdf += probindex[i].prob;
+  const float r = coin * cumulative_weight;
+  float cdf = 0.0f;
+  for (int32_t i = 0; i <= last_idx; i++) {
+    cdf += candidates[i].prob;
     if (r < cdf) {
-      return probindex[i].index;
+      return candidates[i].index;
     }
   }
-  return probindex[last_idx].index; // in case of rounding errors
+  return candidates[last_idx].index; // in case of rounding errors
 }
 
-Sampler::Sampler(
-    int vocab_size,
-    float temperature,
-    float topp,
-    unsigned long long rng_seed)
-    : vocab_size_(vocab_size),
-      temperature_(temperature),
-      topp_(topp),
-      rng_state_(rng_seed) {}
-
 template <typename T>
-static void softmax(T* x, int size) {
-  // find max value (for numerical stability)
-  T max_val = x[0];
-  for (int i = 1; i < size; i++) {
-    if (x[i] > max_val) {
-      max_val = x[i];
-    }
-  }
-  // exp and sum
-  T sum = 0;
-  for (int i = 0; i < size; i++) {
-    x[i] = expf(x[i] - max_val);
-    sum += x[i];
-  }
-  // normalize
-  for (int i = 0; i < size; i++) {
-    x[i] /= sum;
-  }
+int32_t Sampler::sample(T* logits) {
+  return sample(logits, {});
 }
 
-static unsigned int random_u32(unsigned long long* state) {
-  // xorshift rng: https://en.wikipedia.org/wiki/Xorshift#xorshift.2A
-  *state ^= *state >> 12;
-  *state ^= *state << 25;
-  *state ^= *state >> 27;
-  return (*state * 0x2545F4914F6CDD1Dull) >> 32;
+template <typename T>
+int32_t Sampler::sample(T* logits, const std::vector<uint64_t>& recent_tokens) {
+  return sample_logits<T>(logits, 1.0f, recent_tokens);
 }
 
-static float random_f32(unsigned long long* state) { // random float32 in [0,1)
-  return (random_u32(state) >> 8) / 16777216.0f;
+int32_t Sampler::sample(
+    const int16_t* logits,
+    float scale,
+    const std::vector<uint64_t>& recent_tokens) {
+  return sample_logits(logits, scale, recent_tokens);
 }
 
 template <typename T>
-int32_t Sampler::sample(T* logits) {
+int32_t Sampler::sample_logits(
+    const T* logits,
+    float scale,
+    const std::vector<uint64_t>& recent_tokens) {
   // sample the token given the logits and some hyperparameters
-  int next;
+  const bool penalize = repetition_penalty_ != 1.0f && !recent_tokens.empty();
+  // calls fn(token) for each recent token once, even if it was seen several
+  // times
+  auto for_each_penalized_token = [&](auto&& fn) {
+    for (const uint64_t token : recent_tokens) {
+      if (token >= static_cast<uint64_t>(vocab_size_) || penalized_[token]) {
+        continue;
+      }
+      penalized_[token] = true;
+      fn(static_cast<int32_t>(token));
+    }
+    for (const uint64_t token : recent_tokens) {
+      if (token < static_cast<uint64_t>(vocab_size_)) {
+        penalized_[token] = false;
+      }
+    }
+  };
+  auto penalized_logit = [&](int32_t token) {
+    const float logit = static_cast<float>(logits[token]) * scale;
+    return logit > 0.0f ? logit / repetition_penalty_
+                        : logit * repetition_penalty_;
+  };
+
   if (temperature_ == 0.0f) {
     // greedy argmax sampling: take the token with the highest probability
-    next = sample_argmax(logits);
-  } else {
-    // apply the temperature to the logits
-    for (int q = 0; q < vocab_size_; q++) {
-      logits[q] /= temperature_;
+    if (!penalize) {
+      int32_t index = 0;
+      max_logit(logits, vocab_size_, &index);
+      return index;
     }
-    // apply softmax to the logits to get the probabilities for next token
-    softmax(logits, vocab_size_);
-    // flip a (float) coin (this is our source of entropy for sampling)
-    float coin = random_f32(&rng_state_);
-    // we sample from this distribution to get the next token
-    if (topp_ <= 0 || topp_ >= 1) {
-      // simply sample from the predicted probability distribution
-      next = sample_mult(logits, coin);
-    } else {
-      // top-p (nucleus) sampling, clamping the least likely tokens to zero
-      next = sample_topp(logits, coin);
+    float* const weights = weights_.get();
+    for (int32_t i = 0; i < vocab_size_; i++) {
+      weights[i] = static_cast<float>(logits[i]) * scale;
     }
+    for_each_penalized_token(
+        [&](int32_t token) { weights[token] = penalized_logit(token); });
+    return sample_argmax();
+  }
+
+  // dequantize, apply the temperature and softmax to the logits in a single
+  // pass
+  const float inv_temperature = 1.0f / temperature_;
+  float total_weight = prepare_weights(logits, scale, inv_temperature);
+  if (penalize) {
+    // scale the weights of the penalized tokens by
+    // exp((penalized_logit - logit) / temperature)
+    float* const weights = weights_.get();
+    for_each_penalized_token([&](int32_t token) {
+      const float logit = static_cast<float>(logits[token]) * scale;
+      const float weight = weights[token] *
+          std::exp((penalized_logit(token) - logit) * inv_temperature);
+      total_weight += weight - weights[token];
+      weights[token] = weight;
+    });
+  }
+  // flip a (float) coin (this is our source of entropy for sampling)
+  const float coin = random_f32(&rng_state_);
+  // we sample from this distribution to get the next token
+  if (topk_ > 0 && topk_ < vocab_size_) {
+    // top-k sampling, optionally followed by top-p over the k tokens
+    return sample_topk(topk_, coin);
+  } else if (topp_ <= 0 || topp_ >= 1) {
+    // simply sample from the predicted probability distribution
+    return sample_mult(total_weight, coin);
+  } else {
+    // top-p (nucleus) sampling, clamping the least likely tokens to zero
+    return sample_topp(total_weight, coin);
   }
-  return next;
 }
 
 template int32_t Sampler::sample<float>(float* logits);
 template int32_t Sampler::sample<exec_aten::Half>(exec_aten::Half* logits);
+template int32_t Sampler::sample<float>(
+    float* logits,
+    const std::vector<uint64_t>& recent_tokens);
+template int32_t Sampler::sample<exec_aten::Half>(
+    exec_aten::Half* logits,
+    const std::vector<uint64_t>& recent_tokens);
 
 } // namespace executor
 } // namespace torch
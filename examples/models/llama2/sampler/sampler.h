@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <vector>
 #ifdef USE_ATEN_LIB
 #include <torch/torch.h>
 #endif
@@ -32,28 +33,68 @@ struct ProbIndex {
 
 class Sampler {
  public:
+  /**
+   * @param[in] topk If positive, only the `topk` most likely tokens are
+   * sampled from. Combines with `topp`, which then applies to those tokens.
+   * @param[in] repetition_penalty The logits of the tokens passed to
+   * `sample` as recent tokens are divided by this value if positive and
+   * multiplied by it otherwise. 1 disables the penalty.
+   */
   Sampler(
       int32_t vocab_size,
       float temperature,
       float topp,
-      unsigned long long rng_seed);
+      unsigned long long rng_seed,
+      int32_t topk = 0,
+      float repetition_penalty = 1.0f);
 
   template <typename T>
   int32_t sample(T* logits);
 
- private:
+  /**
+   * Same as `sample(logits)`, with the repetition penalty applied to the
+   * logits of `recent_tokens`. The logits are left unchanged.
+   */
   template <typename T>
-  int32_t sample_topp(T* probabilities, float coin);
+  int32_t sample(T* logits, const std::vector<uint64_t>& recent_tokens);
+
+  /**
+   * Same as `sample(logits, recent_tokens)` for int16 quantized logits, whose
+   * value is `logits[i] * scale`. The dequantization is fused with the
+   * temperature scaling.
+   */
+  int32_t sample(
+      const int16_t* logits,
+      float scale,
+      const std::vector<uint64_t>& recent_tokens);
+
+ private:
   template <typename T>
-  int32_t sample_mult(T* probabilities, float coin);
+  int32_t sample_logits(
+      const T* logits,
+      float scale,
+      const std::vector<uint64_t>& recent_tokens);
   template <typename T>
-  int32_t sample_argmax(T* probabilities);
+  float prepare_weights(const T* logits, float scale, float inv_temperature);
+  int32_t sample_topk(int32_t k, float coin);
+  int32_t sample_topp(float total_weight, float coin);
+  int32_t sample_mult(float total_weight, float coin);
+  int32_t sample_argmax();
 
  private:
   int32_t vocab_size_;
   float temperature_;
   float topp_;
+  int32_t topk_;
+  float repetition_penalty_;
   unsigned long long rng_state_;
+  // Scratch buffers of vocab_size_ elements, reused across calls. weights_
+  // holds the unnormalized probabilities, computed from the logits in a single
+  // pass, or the logits as float when greedy decoding applies a repetition
+  // penalty.
+  std::unique_ptr<float[]> weights_;
+  std::unique_ptr<ProbIndex<float>[]> candidates_;
+  std::vector<bool> penalized_;
 };
 
 } // namespace executor
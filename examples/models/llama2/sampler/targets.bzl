@@ -21,6 +21,9 @@ def define_common_targets():
             external_deps = [
                 "libtorch",
             ] if aten else [],
+            deps = [
+                "//executorch/kernels/optimized:libvec",
+            ],
             exported_deps = [
                 "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
             ],
@@ -11,6 +11,8 @@
 #include <gtest/gtest.h>
 #include <torch/torch.h>
 
+#include <set>
+
 using namespace ::testing;
 
 namespace torch {
@@ -44,5 +46,80 @@ TEST_F(SamplerTest, TestArgMaxWithFP16) {
   EXPECT_EQ(sampler.sample(input.data_ptr<c10::Half>()), 396);
 }
 
+TEST_F(SamplerTest, TestTopK) {
+  torch::executor::Sampler sampler{
+      /*vocab_size*/ 32000,
+      /*temperature*/ 1.0f,
+      /*topp*/ 1.0f,
+      /*rng_seed*/ 0,
+      /*topk*/ 2};
+  torch::Tensor input = torch::zeros({1, 1, 32000}, at::kFloat);
+  input[0][0][7] = 2.0f;
+  input[0][0][396] = 2.0f;
+  for (int i = 0; i < 100; i++) {
+    const int32_t token = sampler.sample(input.data_ptr<float>());
+    EXPECT_TRUE(token == 7 || token == 396);
+  }
+}
+
+TEST_F(SamplerTest, TestTopPWithFlatDistribution) {
+  torch::executor::Sampler sampler{
+      /*vocab_size*/ 1000,
+      /*temperature*/ 1.0f,
+      /*topp*/ 0.1f,
+      /*rng_seed*/ 0};
+  // Every token is equally likely, so the nucleus is made of the first 101
+  // tokens of the sorted candidates. None of the others may be sampled.
+  torch::Tensor input = torch::zeros({1, 1, 1000}, at::kFloat);
+  std::set<int32_t> tokens;
+  for (int i = 0; i < 1000; i++) {
+    tokens.insert(sampler.sample(input.data_ptr<float>()));
+  }
+  EXPECT_LE(tokens.size(), 101);
+}
+
+TEST_F(SamplerTest, TestRepetitionPenalty) {
+  torch::executor::Sampler sampler{
+      /*vocab_size*/ 32000,
+      /*temperature*/ 0.0f,
+      /*topp*/ 0.9f,
+      /*rng_seed*/ 0,
+      /*topk*/ 0,
+      /*repetition_penalty*/ 2.0f};
+  torch::Tensor input = torch::zeros({1, 1, 32000}, at::kFloat);
+  input[0][0][396] = 1.0f;
+  input[0][0][7] = 0.8f;
+  EXPECT_EQ(sampler.sample(input.data_ptr<float>()), 396);
+  EXPECT_EQ(sampler.sample(input.data_ptr<float>(), {396, 396}), 7);
+  // The logits themselves are not modified.
+  EXPECT_EQ(sampler.sample(input.data_ptr<float>()), 396);
+}
+
+TEST_F(SamplerTest, TestQuantizedLogits) {
+  torch::executor::Sampler greedy{
+      /*vocab_size*/ 32000,
+      /*temperature*/ 0.0f,
+      /*topp*/ 0.9f,
+      /*rng_seed*/ 0};
+  torch::executor::Sampler sampler{
+      /*vocab_size*/ 32000,
+      /*temperature*/ 1.0f,
+      /*topp*/ 1.0f,
+      /*rng_seed*/ 42,
+      /*topk*/ 2,
+      /*repetition_penalty*/ 2.0f};
+  torch::Tensor input = torch::full({1, 1, 32000}, -1000, at::kShort);
+  input[0][0][7] = 500;
+  input[0][0][396] = 1000;
+  const int16_t* logits = input.data_ptr<int16_t>();
+  EXPECT_EQ(greedy.sample(logits, /*scale*/ 0.01f, {}), 396);
+  // Logits of 10 and 5, and 5 and 5 once 396 is penalized.
+  std::set<int32_t> tokens;
+  for (int i = 0; i < 100; i++) {
+    tokens.insert(sampler.sample(logits, /*scale*/ 0.01f, {396}));
+  }
+  EXPECT_EQ(tokens, std::set<int32_t>({7, 396}));
+}
+
 } // namespace executor
 } // namespace torch
@@ -0,0 +1,40 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import torch
+
+from executorch.examples.models.llama2.llama_transformer import RMSNorm
+
+
+class RMSNormFused(torch.nn.Module):
+    """
+    RMSNorm that runs as a single fused.rms_norm op, which the optimized
+    kernel library implements in two passes over each row.
+    """
+
+    def __init__(self, rms_norm: RMSNorm):
+        super().__init__()
+        self.eps = rms_norm.eps
+        self.weight = rms_norm.weight
+
+    def forward(self, x: torch.Tensor) -> torch.Tensor:
+        output = torch.ops.fused.rms_norm(x.float(), None, self.eps).type_as(x)
+        return output * self.weight
+
+
+def _replace_rms_norm_with_fused_op(module: torch.nn.Module):
+    for name, child in module.named_children():
+        if isinstance(child, RMSNorm):
+            setattr(module, name, RMSNormFused(child))
+        else:
+            _replace_rms_norm_with_fused_op(child)
+
+
+def replace_rms_norm_with_fused_op(module: torch.nn.Module) -> torch.nn.Module:
+    from executorch.backends.transforms import fuse_op_chains  # noqa
+
+    _replace_rms_norm_with_fused_op(module)
+    return module
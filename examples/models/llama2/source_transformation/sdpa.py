@@ -39,8 +39,11 @@ class SDPACustom(torch.nn.Module):
             v,
             self.kv_cache.k_cache,
             self.kv_cache.v_cache,
-            input_pos[-1].item(),
+            input_pos[0].item(),
             seqlen,
+            None,  # Attention mask
+            0,  # dropout probability. Ignored by the code
+            True,  # is_causal
         )
         return output.view(bsz, seqlen, self.dim)
 
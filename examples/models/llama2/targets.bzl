@@ -24,3 +24,23 @@ def define_common_targets():
                 ],
                 **get_oss_build_kwargs()
             )
+
+            runtime.cxx_binary(
+                name = "benchmark" + aten_suffix,
+                srcs = [
+                    "benchmark.cpp",
+                ],
+                preprocessor_flags = [
+                    "-DUSE_ATEN_LIB",
+                ] if aten else [],
+                deps = [
+                    "//executorch/examples/models/llama2/runner:runner" + aten_suffix,
+                    "//executorch/extension/evalue_util:print_evalue",
+                    "//executorch/backends/xnnpack/threadpool:threadpool",
+                    "//executorch/backends/xnnpack/threadpool:cpuinfo_utils",
+                ],
+                external_deps = [
+                    "gflags",
+                ],
+                **get_oss_build_kwargs()
+            )
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/examples/models/llama2/tokenizer/binary_vocab.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+
+namespace {
+
+constexpr size_t kHeaderFields = 6;
+constexpr size_t kHeaderSize = kHeaderFields * sizeof(uint32_t);
+
+uint32_t fnv1a(std::string_view piece) {
+  uint32_t hash = 2166136261u;
+  for (char c : piece) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void append_u32(std::vector<uint8_t>& out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+} // namespace
+
+constexpr char BinaryVocab::kMagic[4];
+
+bool BinaryVocab::is_binary_vocab(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  char magic[sizeof(kMagic)];
+  const bool matches = fread(magic, sizeof(magic), 1, file) == 1 &&
+      std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+  fclose(file);
+  return matches;
+}
+
+Result<BinaryVocab> BinaryVocab::from_file(const std::string& path) {
+  // Pages are faulted in on lookup, so do not mlock the whole vocabulary.
+  auto loader = util::MmapDataLoader::from(
+      path.c_str(), util::MmapDataLoader::MlockConfig::NoMlock);
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      loader.error(), "Failed to open %s", path.c_str());
+  BinaryVocab vocab;
+  vocab.loader_ =
+      std::make_unique<util::MmapDataLoader>(std::move(loader.get()));
+  const auto size = vocab.loader_->size();
+  ET_CHECK_OK_OR_RETURN_ERROR(size.error());
+  auto mapping = vocab.loader_->Load(0, size.get());
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      mapping.error(), "Failed to map %s", path.c_str());
+  vocab.mapping_ = std::make_unique<FreeableBuffer>(std::move(mapping.get()));
+  ET_CHECK_OK_OR_RETURN_ERROR(vocab.init(
+      static_cast<const uint8_t*>(vocab.mapping_->data()),
+      vocab.mapping_->size()));
+  return vocab;
+}
+
+Result<BinaryVocab> BinaryVocab::from_data(std::vector<uint8_t>&& data) {
+  BinaryVocab vocab;
+  vocab.buffer_ = std::move(data);
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      vocab.init(vocab.buffer_.data(), vocab.buffer_.size()));
+  return vocab;
+}
+
+Result<std::vector<uint8_t>> BinaryVocab::serialize(
+    const std::vector<std::string>& pieces) {
+  // Half of the slots stay empty, so that probes are short.
+  ET_CHECK_OR_RETURN_ERROR(
+      pieces.size() <= std::numeric_limits<uint32_t>::max() / 4,
+      InvalidArgument,
+      "Too many tokens: %zu",
+      pieces.size());
+  const uint32_t num_tokens = pieces.size();
+  uint32_t num_slots = 1;
+  while (num_slots < 2 * num_tokens) {
+    num_slots *= 2;
+  }
+  std::vector<uint32_t> slots(num_slots, 0);
+  uint64_t data_size = 0;
+  for (uint32_t token = 0; token < num_tokens; ++token) {
+    const std::string& piece = pieces[token];
+    uint32_t slot = fnv1a(piece) & (num_slots - 1);
+    while (slots[slot] != 0) {
+      ET_CHECK_OR_RETURN_ERROR(
+          pieces[slots[slot] - 1] != piece,
+          InvalidArgument,
+          "Tokens %" PRIu32 " and %" PRIu32 " have the same piece",
+          slots[slot] - 1,
+          token);
+      slot = (slot + 1) & (num_slots - 1);
+    }
+    slots[slot] = token + 1;
+    data_size += piece.size();
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      data_size <= std::numeric_limits<uint32_t>::max(),
+      InvalidArgument,
+      "%" PRIu64 " bytes of pieces do not fit the format",
+      data_size);
+
+  std::vector<uint8_t> out;
+  out.reserve(
+      kHeaderSize + (num_tokens + 1 + num_slots) * sizeof(uint32_t) +
+      data_size);
+  out.insert(out.end(), kMagic, kMagic + sizeof(kMagic));
+  append_u32(out, kVersion);
+  append_u32(out, num_tokens);
+  append_u32(out, num_slots);
+  append_u32(out, data_size);
+  append_u32(out, 0);
+  uint32_t offset = 0;
+  append_u32(out, offset);
+  for (const std::string& piece : pieces) {
+    offset += piece.size();
+    append_u32(out, offset);
+  }
+  for (uint32_t slot : slots) {
+    append_u32(out, slot);
+  }
+  for (const std::string& piece : pieces) {
+    out.insert(out.end(), piece.begin(), piece.end());
+  }
+  return out;
+}
+
+Error BinaryVocab::init(const uint8_t* data, size_t size) {
+  ET_CHECK_OR_RETURN_ERROR(
+      size >= kHeaderSize && std::memcmp(data, kMagic, sizeof(kMagic)) == 0,
+      InvalidArgument,
+      "Not a binary vocabulary");
+  // The sections are read in place, which needs a little-endian host and
+  // aligned fields. Mappings and vector storage are both aligned.
+  ET_CHECK_OR_RETURN_ERROR(
+      reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) == 0,
+      InvalidArgument,
+      "Binary vocabulary is not aligned");
+  const auto* header = reinterpret_cast<const uint32_t*>(data);
+  ET_CHECK_OR_RETURN_ERROR(
+      header[1] == kVersion,
+      NotSupported,
+      "Unsupported binary vocabulary version %" PRIu32,
+      header[1]);
+  const uint64_t num_tokens = header[2];
+  const uint64_t num_slots = header[3];
+  const uint64_t data_size = header[4];
+  ET_CHECK_OR_RETURN_ERROR(
+      num_slots > 0 && num_slots >= 2 * num_tokens &&
+          (num_slots & (num_slots - 1)) == 0,
+      InvalidArgument,
+      "Invalid number of hash slots %" PRIu64 " for %" PRIu64 " tokens",
+      num_slots,
+      num_tokens);
+  const uint64_t expected_size = kHeaderSize +
+      (num_tokens + 1 + num_slots) * sizeof(uint32_t) + data_size;
+  ET_CHECK_OR_RETURN_ERROR(
+      size == expected_size,
+      InvalidArgument,
+      "Binary vocabulary is %zu bytes, expected %" PRIu64,
+      size,
+      expected_size);
+
+  offsets_ = header + kHeaderFields;
+  slots_ = offsets_ + num_tokens + 1;
+  data_ = reinterpret_cast<const char*>(slots_ + num_slots);
+  ET_CHECK_OR_RETURN_ERROR(
+      offsets_[0] == 0 && offsets_[num_tokens] == data_size,
+      InvalidArgument,
+      "Invalid piece offsets");
+  num_tokens_ = num_tokens;
+  slot_mask_ = num_slots - 1;
+  return Error::Ok;
+}
+
+std::optional<uint64_t> BinaryVocab::rank(std::string_view piece) const {
+  if (num_tokens_ == 0) {
+    return std::nullopt;
+  }
+  // Like the offsets, the slots are not checked on load, so the probes are
+  // bounded even though a valid table always has an empty slot.
+  uint32_t slot = fnv1a(piece) & slot_mask_;
+  for (uint64_t probe = 0; probe <= slot_mask_ && slots_[slot] != 0;
+       ++probe, slot = (slot + 1) & slot_mask_) {
+    const uint32_t token = slots_[slot] - 1;
+    if (token < num_tokens_ && this->piece(token) == piece) {
+      return token;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> BinaryVocab::piece(uint64_t token) const {
+  if (token >= num_tokens_) {
+    return std::nullopt;
+  }
+  const uint32_t start = offsets_[token];
+  const uint32_t end = offsets_[token + 1];
+  // Offsets are not checked on load, which would touch every page.
+  if (start > end || end > offsets_[num_tokens_]) {
+    return std::nullopt;
+  }
+  return std::string_view(data_ + start, end - start);
+}
+
+} // namespace executor
+} // namespace torch
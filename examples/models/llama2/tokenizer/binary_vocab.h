@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// A vocabulary in a binary format that is used in place, so that loading a
+// mmapped file does not parse or allocate anything per token. binary_vocab.py
+// converts tiktoken vocabularies to it.
+//
+// The format is little-endian, with every field a uint32:
+//
+//   magic       "ETVB"
+//   version     kVersion
+//   num_tokens
+//   num_slots   A power of two, at least twice num_tokens.
+//   data_size
+//   reserved    0
+//   offsets     [num_tokens + 1] Token i is data[offsets[i], offsets[i + 1]).
+//   slots       [num_slots] An open addressing hash table of token ids + 1,
+//               with 0 for empty slots. A piece is looked up starting at
+//               slot fnv1a(piece) % num_slots, probing linearly.
+//   data        [data_size] bytes: the pieces of all tokens in id order.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <executorch/extension/data_loader/mmap_data_loader.h>
+#include <executorch/runtime/core/result.h>
+
+namespace torch {
+namespace executor {
+
+class BinaryVocab {
+ public:
+  static constexpr char kMagic[4] = {'E', 'T', 'V', 'B'};
+  static constexpr uint32_t kVersion = 1;
+
+  /// Whether the file at `path` starts with kMagic.
+  static bool is_binary_vocab(const std::string& path);
+
+  /**
+   * Maps the binary vocabulary at `path`. Its pages are read when tokens are
+   * looked up.
+   */
+  static Result<BinaryVocab> from_file(const std::string& path);
+
+  /// Uses the binary vocabulary in `data`, taking ownership of it.
+  static Result<BinaryVocab> from_data(std::vector<uint8_t>&& data);
+
+  /// Builds the binary form of the vocabulary where token i is `pieces[i]`.
+  static Result<std::vector<uint8_t>> serialize(
+      const std::vector<std::string>& pieces);
+
+  /// An empty vocabulary.
+  BinaryVocab() = default;
+
+  BinaryVocab(BinaryVocab&&) = default;
+  BinaryVocab& operator=(BinaryVocab&&) = default;
+
+  size_t size() const {
+    return num_tokens_;
+  }
+
+  /// The token of `piece`, if it is in the vocabulary.
+  std::optional<uint64_t> rank(std::string_view piece) const;
+
+  /// The piece of `token`, if it is in the vocabulary. Points into the
+  /// vocabulary.
+  std::optional<std::string_view> piece(uint64_t token) const;
+
+ private:
+  // Checks the header and sections of the `size` bytes at `data`, and points
+  // the views at them.
+  Error init(const uint8_t* data, size_t size);
+
+  // Only one of these owns the bytes.
+  std::unique_ptr<util::MmapDataLoader> loader_;
+  std::unique_ptr<FreeableBuffer> mapping_;
+  std::vector<uint8_t> buffer_;
+
+  uint32_t num_tokens_ = 0;
+  uint32_t slot_mask_ = 0;
+  const uint32_t* offsets_ = nullptr;
+  const uint32_t* slots_ = nullptr;
+  const char* data_ = nullptr;
+};
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,105 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+
+# Script to convert a tiktoken vocabulary into the binary format described in
+# binary_vocab.h, which the runners mmap and use without parsing it.
+
+import argparse
+import base64
+import struct
+from typing import List
+
+MAGIC = b"ETVB"
+VERSION = 1
+
+
+def fnv1a(data: bytes) -> int:
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def load_tiktoken(path: str) -> List[bytes]:
+    """
+    Loads a tiktoken vocabulary, with a base64 encoded token and its rank on
+    each line, and returns the tokens indexed by rank.
+    """
+    ranks = {}
+    with open(path, "rb") as f:
+        for line in f:
+            if not line.strip():
+                continue
+            token, rank = line.split()
+            ranks[int(rank)] = base64.b64decode(token)
+    assert sorted(ranks) == list(
+        range(len(ranks))
+    ), f"The ranks in {path} are not 0 to {len(ranks) - 1}"
+    return [ranks[i] for i in range(len(ranks))]
+
+
+def serialize(pieces: List[bytes]) -> bytes:
+    """
+    Serializes the vocabulary where token i is pieces[i]. Matches
+    BinaryVocab::serialize().
+    """
+    num_tokens = len(pieces)
+    num_slots = 1
+    while num_slots < 2 * num_tokens:
+        num_slots *= 2
+    slots = [0] * num_slots
+    for token, piece in enumerate(pieces):
+        slot = fnv1a(piece) & (num_slots - 1)
+        while slots[slot] != 0:
+            assert (
+                pieces[slots[slot] - 1] != piece
+            ), f"Tokens {slots[slot] - 1} and {token} have the same piece"
+            slot = (slot + 1) & (num_slots - 1)
+        slots[slot] = token + 1
+
+    offsets = [0]
+    for piece in pieces:
+        offsets.append(offsets[-1] + len(piece))
+    data = b"".join(pieces)
+    header = MAGIC + struct.pack(
+        "<5I", VERSION, num_tokens, num_slots, len(data), 0
+    )
+    return (
+        header
+        + struct.pack(f"<{len(offsets)}I", *offsets)
+        + struct.pack(f"<{num_slots}I", *slots)
+        + data
+    )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "-t",
+        "--tokenizer-model",
+        type=str,
+        default="tokenizer.model",
+        help="path to tokenizer model, given by tiktoken",
+    )
+    parser.add_argument(
+        "-o",
+        "--output-path",
+        type=str,
+        default=None,
+        help="output path of the binary vocabulary",
+    )
+
+    args = parser.parse_args()
+
+    output_path = (
+        args.output_path
+        if args.output_path
+        else args.tokenizer_model.replace(".model", ".vocab")
+    )
+    pieces = load_tiktoken(args.tokenizer_model)
+    with open(output_path, "wb") as f:
+        f.write(serialize(pieces))
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Turns a stream of tokens into text, one token at a time.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <executorch/examples/models/llama2/tokenizer/tokenizer.h>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Decodes the tokens of one generated sequence as they are produced.
+ *
+ * A token does not necessarily decode to whole characters: tokenizers with
+ * byte fallback split characters they have no token for into one token per
+ * UTF-8 byte. The decoder holds back the bytes of a character until the token
+ * completing it is decoded, so that the text it returns is always valid to
+ * print or to hand to a UI.
+ *
+ * The text is decoded into buffers that are reused from one token to the
+ * next. Each sequence needs its own decoder, e.g. one per session when
+ * serving several, since it keeps the incomplete bytes of its sequence.
+ */
+class StreamingDecoder {
+ public:
+  explicit StreamingDecoder(Tokenizer& tokenizer) : tokenizer_(tokenizer) {}
+
+  /**
+   * Decodes `token`, which follows `prev_token` in the sequence. On success,
+   * text() holds the characters that were completed by the token, and may be
+   * empty if the token only started a character.
+   */
+  Error step(uint64_t prev_token, uint64_t token) {
+    auto piece_res = tokenizer_.decode(prev_token, token);
+    ET_CHECK_OK_OR_RETURN_ERROR(piece_res.error());
+
+    text_.assign(pending_);
+    text_.append(piece_res.get());
+    const size_t complete = complete_prefix_size(text_);
+    pending_.assign(text_, complete, std::string::npos);
+    text_.resize(complete);
+    return Error::Ok;
+  }
+
+  /**
+   * Decodes the `num_tokens` tokens at `tokens` and appends their text to
+   * `out`, e.g. to decode a whole response at once. `prev_token` is the token
+   * before the first one.
+   */
+  Error decode(
+      const uint64_t* tokens,
+      size_t num_tokens,
+      uint64_t prev_token,
+      std::string& out) {
+    for (size_t i = 0; i < num_tokens; i++) {
+      ET_CHECK_OK_OR_RETURN_ERROR(step(prev_token, tokens[i]));
+      out.append(text_);
+      prev_token = tokens[i];
+    }
+    return Error::Ok;
+  }
+
+  /**
+   * Ends the sequence. text() holds the bytes that were held back, which no
+   * token is going to complete anymore.
+   */
+  void flush() {
+    text_.assign(pending_);
+    pending_.clear();
+  }
+
+  /// Forgets the held back bytes, to start decoding a new sequence.
+  void reset() {
+    text_.clear();
+    pending_.clear();
+  }
+
+  /// The text decoded by the last call to step() or flush().
+  const std::string& text() const {
+    return text_;
+  }
+
+ private:
+  // Returns the size of the longest prefix of `text` that does not end in the
+  // middle of a UTF-8 sequence. Bytes that can not be part of a valid sequence
+  // are not held back, since no token would complete them.
+  static size_t complete_prefix_size(const std::string& text) {
+    const size_t size = text.size();
+    // A sequence is at most 4 bytes, so only the last 3 can be incomplete.
+    for (size_t i = 1; i <= 3 && i <= size; i++) {
+      const auto byte = static_cast<unsigned char>(text[size - i]);
+      if ((byte & 0xC0) == 0x80) {
+        // A continuation byte, look for the first byte of its sequence.
+        continue;
+      }
+      size_t length = 1;
+      if ((byte & 0xE0) == 0xC0) {
+        length = 2;
+      } else if ((byte & 0xF0) == 0xE0) {
+        length = 3;
+      } else if ((byte & 0xF8) == 0xF0) {
+        length = 4;
+      }
+      return length > i ? size - i : size;
+    }
+    return size;
+  }
+
+  Tokenizer& tokenizer_;
+  // The text of the last step, and the bytes of its incomplete character.
+  std::string text_;
+  std::string pending_;
+};
+
+} // namespace executor
+} // namespace torch
@@ -9,6 +9,7 @@ def define_common_targets():
         exported_headers = [
             "tokenizer.h",
             "bpe_tokenizer.h",
+            "streaming_decoder.h",
         ],
         exported_deps = [
             "//executorch/runtime/core/exec_aten:lib",
@@ -22,14 +23,18 @@ def define_common_targets():
     runtime.cxx_library(
         name = "tiktoken",
         srcs = [
+            "binary_vocab.cpp",
             "tiktoken.cpp",
         ],
         exported_headers = [
             "tokenizer.h",
             "tiktoken.h",
+            "streaming_decoder.h",
             "base64.h",
+            "binary_vocab.h",
         ],
         exported_deps = [
+            "//executorch/extension/data_loader:mmap_data_loader",
             "//executorch/runtime/core/exec_aten:lib",
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
         ],
@@ -45,6 +50,7 @@ def define_common_targets():
         name = "tokenizer_py_lib",
         srcs = [
             "__init__.py",
+            "binary_vocab.py",
             "tokenizer.py",
         ],
         base_module = "executorch.examples.models.llama2.tokenizer",
@@ -69,3 +75,16 @@ def define_common_targets():
             ":tokenizer_py_lib",
         ],
     )
+
+    runtime.python_binary(
+        name = "binary_vocab_py",
+        main_module = "executorch.examples.models.llama2.tokenizer.binary_vocab",
+        visibility = [
+            "//executorch/examples/...",
+            "fbsource//xplat/executorch/examples/...",
+        ],
+        _is_external_target = True,
+        deps = [
+            ":tokenizer_py_lib",
+        ],
+    )
@@ -20,6 +20,16 @@ def define_common_targets():
         },
     )
 
+    runtime.cxx_test(
+        name = "test_streaming_decoder",
+        srcs = [
+            "test_streaming_decoder.cpp",
+        ],
+        deps = [
+            "//executorch/examples/models/llama2/tokenizer:bpe_tokenizer",
+        ],
+    )
+
     runtime.cxx_test(
         name = "test_tiktoken",
         srcs = [
@@ -36,6 +46,16 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "test_binary_vocab",
+        srcs = [
+            "test_binary_vocab.cpp",
+        ],
+        deps = [
+            "//executorch/examples/models/llama2/tokenizer:tiktoken",
+        ],
+    )
+
     runtime.filegroup(
         name = "resources",
         srcs = native.glob([
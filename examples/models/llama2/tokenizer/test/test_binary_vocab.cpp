@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/examples/models/llama2/tokenizer/binary_vocab.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+
+namespace torch {
+namespace executor {
+
+class BinaryVocabTest : public Test {
+ public:
+  void SetUp() override {
+    torch::executor::runtime_init();
+    pieces_ = {"a", "b", "ab", "hello", " world", std::string("\0x", 2)};
+  }
+
+  std::vector<std::string> pieces_;
+};
+
+TEST_F(BinaryVocabTest, LooksUpSerializedPieces) {
+  auto data = BinaryVocab::serialize(pieces_);
+  ASSERT_EQ(data.error(), Error::Ok);
+  auto vocab = BinaryVocab::from_data(std::move(data.get()));
+  ASSERT_EQ(vocab.error(), Error::Ok);
+
+  EXPECT_EQ(vocab->size(), pieces_.size());
+  for (size_t i = 0; i < pieces_.size(); ++i) {
+    EXPECT_EQ(vocab->rank(pieces_[i]), i);
+    EXPECT_EQ(vocab->piece(i), pieces_[i]);
+  }
+  EXPECT_EQ(vocab->rank("abc"), std::nullopt);
+  EXPECT_EQ(vocab->rank(""), std::nullopt);
+  EXPECT_EQ(vocab->piece(pieces_.size()), std::nullopt);
+}
+
+TEST_F(BinaryVocabTest, MapsFile) {
+  auto data = BinaryVocab::serialize(pieces_);
+  ASSERT_EQ(data.error(), Error::Ok);
+  const std::string path = testing::TempDir() + "binary_vocab_test.bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(fwrite(data->data(), data->size(), 1, file), 1);
+  fclose(file);
+
+  EXPECT_TRUE(BinaryVocab::is_binary_vocab(path));
+  auto vocab = BinaryVocab::from_file(path);
+  ASSERT_EQ(vocab.error(), Error::Ok);
+  EXPECT_EQ(vocab->rank("hello"), 3);
+  EXPECT_EQ(vocab->piece(4), " world");
+  std::remove(path.c_str());
+}
+
+TEST_F(BinaryVocabTest, DuplicatePiecesFail) {
+  pieces_.push_back("ab");
+  EXPECT_EQ(BinaryVocab::serialize(pieces_).error(), Error::InvalidArgument);
+}
+
+TEST_F(BinaryVocabTest, CorruptDataFails) {
+  auto data = BinaryVocab::serialize(pieces_);
+  ASSERT_EQ(data.error(), Error::Ok);
+  std::vector<uint8_t> truncated(data->begin(), data->end() - 1);
+  EXPECT_EQ(
+      BinaryVocab::from_data(std::move(truncated)).error(),
+      Error::InvalidArgument);
+
+  std::vector<uint8_t> bad_magic = data.get();
+  bad_magic[0] = 'X';
+  EXPECT_EQ(
+      BinaryVocab::from_data(std::move(bad_magic)).error(),
+      Error::InvalidArgument);
+}
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/examples/models/llama2/tokenizer/streaming_decoder.h>
+#include <executorch/examples/models/llama2/tokenizer/tokenizer.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+
+namespace torch {
+namespace executor {
+
+namespace {
+
+// Decodes each token to a fixed piece, like a vocabulary with byte fallback
+// tokens.
+class FakeTokenizer : public Tokenizer {
+ public:
+  explicit FakeTokenizer(std::vector<std::string> pieces)
+      : Tokenizer(pieces.size(), 0, 1), pieces_(std::move(pieces)) {
+    initialized_ = true;
+  }
+
+  Error load(const std::string&) override {
+    return Error::Ok;
+  }
+
+  Result<std::vector<uint64_t>>
+  encode(const std::string&, int8_t, int8_t) override {
+    return Error::NotSupported;
+  }
+
+  Result<std::string> decode(uint64_t, uint64_t token) override {
+    ET_CHECK_OK_OR_RETURN_ERROR(Tokenizer::decode_verify(token));
+    return pieces_[token];
+  }
+
+ private:
+  std::vector<std::string> pieces_;
+};
+
+} // namespace
+
+class StreamingDecoderTest : public Test {
+ public:
+  void SetUp() override {
+    torch::executor::runtime_init();
+    // "€" is 0xE2 0x82 0xAC in UTF-8, and gets a token per byte.
+    tokenizer_ = std::make_unique<FakeTokenizer>(std::vector<std::string>{
+        "<s>", "</s>", " costs", " 5", "\xE2", "\x82", "\xAC", "\xC3\xA9"});
+  }
+
+  std::unique_ptr<Tokenizer> tokenizer_;
+};
+
+TEST_F(StreamingDecoderTest, StepReturnsCompleteText) {
+  StreamingDecoder decoder(*tokenizer_);
+  EXPECT_EQ(decoder.step(0, 2), Error::Ok);
+  EXPECT_EQ(decoder.text(), " costs");
+  EXPECT_EQ(decoder.step(2, 7), Error::Ok);
+  EXPECT_EQ(decoder.text(), "\xC3\xA9");
+}
+
+TEST_F(StreamingDecoderTest, StepHoldsBackSplitCharacter) {
+  StreamingDecoder decoder(*tokenizer_);
+  EXPECT_EQ(decoder.step(0, 3), Error::Ok);
+  EXPECT_EQ(decoder.text(), " 5");
+  EXPECT_EQ(decoder.step(3, 4), Error::Ok);
+  EXPECT_EQ(decoder.text(), "");
+  EXPECT_EQ(decoder.step(4, 5), Error::Ok);
+  EXPECT_EQ(decoder.text(), "");
+  EXPECT_EQ(decoder.step(5, 6), Error::Ok);
+  EXPECT_EQ(decoder.text(), "\xE2\x82\xAC");
+}
+
+TEST_F(StreamingDecoderTest, FlushReturnsIncompleteCharacter) {
+  StreamingDecoder decoder(*tokenizer_);
+  EXPECT_EQ(decoder.step(0, 4), Error::Ok);
+  EXPECT_EQ(decoder.step(4, 5), Error::Ok);
+  EXPECT_EQ(decoder.text(), "");
+  decoder.flush();
+  EXPECT_EQ(decoder.text(), "\xE2\x82");
+
+  // Nothing is left for the next sequence.
+  EXPECT_EQ(decoder.step(0, 2), Error::Ok);
+  EXPECT_EQ(decoder.text(), " costs");
+}
+
+TEST_F(StreamingDecoderTest, StrayContinuationByteIsNotHeldBack) {
+  StreamingDecoder decoder(*tokenizer_);
+  EXPECT_EQ(decoder.step(0, 6), Error::Ok);
+  EXPECT_EQ(decoder.text(), "\xAC");
+}
+
+TEST_F(StreamingDecoderTest, DecodeAppendsWholeSequence) {
+  StreamingDecoder decoder(*tokenizer_);
+  const std::vector<uint64_t> tokens = {2, 3, 4, 5, 6};
+  std::string out = "It";
+  EXPECT_EQ(decoder.decode(tokens.data(), tokens.size(), 0, out), Error::Ok);
+  EXPECT_EQ(out, "It costs 5\xE2\x82\xAC");
+}
+
+TEST_F(StreamingDecoderTest, StepOutOfRangeFails) {
+  StreamingDecoder decoder(*tokenizer_);
+  EXPECT_EQ(decoder.step(0, 8), Error::NotSupported);
+}
+
+} // namespace executor
+} // namespace torch
@@ -63,6 +63,27 @@ TEST_F(TiktokenExtensionTest, TokenizerEncodeCorrectly) {
   EXPECT_EQ(out.get()[2], 1917);
 }
 
+TEST_F(TiktokenExtensionTest, TokenizerEncodeRepeatedTextCorrectly) {
+  Error res = tokenizer_->load(modelPath_.c_str());
+  EXPECT_EQ(res, Error::Ok);
+  // The merges of pieces that are not tokens themselves are cached, so the
+  // second occurrence of each word must be encoded like the first one.
+  const std::string text = "unbelievably unbelievably tokenization";
+  Result<std::vector<uint64_t>> out = tokenizer_->encode(text, 0, 0);
+  EXPECT_EQ(out.error(), Error::Ok);
+  Result<std::vector<uint64_t>> again = tokenizer_->encode(text, 0, 0);
+  EXPECT_EQ(again.error(), Error::Ok);
+  EXPECT_EQ(out.get(), again.get());
+
+  std::string decoded;
+  for (uint64_t token : out.get()) {
+    Result<std::string> piece = tokenizer_->decode(0, token);
+    EXPECT_EQ(piece.error(), Error::Ok);
+    decoded += piece.get();
+  }
+  EXPECT_EQ(decoded, text);
+}
+
 TEST_F(TiktokenExtensionTest, TokenizerDecodeCorrectly) {
   Error res = tokenizer_->load(modelPath_.c_str());
   EXPECT_EQ(res, Error::Ok);
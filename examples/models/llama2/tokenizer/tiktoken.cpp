@@ -84,22 +84,33 @@ static std::pair<std::string, uint64_t> _parse(const std::string& line) {
   return {std::move(token), rank};
 }
 
-static Encoder _load_encoder(const std::string& path) {
+static Result<BinaryVocab> _load_vocab(const std::string& path) {
   std::ifstream file(path);
   ET_CHECK_MSG(file, "failed to open encoder file: %s", path.c_str());
 
-  Encoder encoder;
+  std::vector<std::pair<std::string, uint64_t>> entries;
   std::string line;
   while (std::getline(file, line)) {
-    auto [token, rank] = _parse(line);
+    entries.push_back(_parse(line));
+  }
 
-    ET_CHECK_MSG(
-        encoder.emplace(std::move(token), rank).second,
-        "duplicate item: %s",
-        line.c_str());
+  // The vocabulary is indexed by rank, so the ranks must be 0 to n - 1.
+  std::vector<std::string> pieces(entries.size());
+  std::vector<bool> seen(entries.size(), false);
+  for (auto& [token, rank] : entries) {
+    ET_CHECK_OR_RETURN_ERROR(
+        rank < entries.size() && !seen[rank],
+        InvalidArgument,
+        "invalid or duplicate rank %" PRIu64 " in %zu ranks",
+        rank,
+        entries.size());
+    seen[rank] = true;
+    pieces[rank] = std::move(token);
   }
 
-  return encoder;
+  auto data = BinaryVocab::serialize(pieces);
+  ET_CHECK_OK_OR_RETURN_ERROR(data.error());
+  return BinaryVocab::from_data(std::move(data.get()));
 }
 
 static Decoder _build_decoder(const Encoder& encoder) {
@@ -113,10 +124,9 @@ static Decoder _build_decoder(const Encoder& encoder) {
   return decoder;
 }
 
-static std::vector<uint64_t> _byte_pair_merge(
-    const std::string& piece,
-    const std::unordered_map<std::string, uint64_t>& ranks,
-    std::function<uint64_t(uint64_t, uint64_t)> func) {
+template <typename F>
+static std::vector<uint64_t>
+_byte_pair_merge(std::string_view piece, const BinaryVocab& vocab, F func) {
   // This is a vector of (start, rank).
   // The rank is of the byte pair starting at position start.
   // The rank of the last item in the vector is not a valid value.
@@ -126,18 +136,14 @@ static std::vector<uint64_t> _byte_pair_merge(
     parts.emplace_back(idx, _max_size());
   }
 
-  auto get_rank = [&piece, &ranks](
+  auto get_rank = [&piece, &vocab](
                       const std::vector<std::pair<uint64_t, uint64_t>>& parts,
                       uint64_t start_idx,
                       uint64_t skip) -> std::optional<uint64_t> {
     if (start_idx + skip + 2 < parts.size()) {
       auto s = parts[start_idx].first;
       auto e = parts[start_idx + skip + 2].first;
-      auto key = piece.substr(s, e - s);
-      auto iter = ranks.find(key);
-      if (iter != ranks.end()) {
-        return iter->second;
-      }
+      return vocab.rank(piece.substr(s, e - s));
     }
     return std::nullopt;
   };
@@ -218,12 +224,12 @@ static std::vector<uint64_t> _byte_pair_merge(
 }
 
 static std::vector<uint64_t> _byte_pair_encode(
-    const std::string& piece,
-    const Encoder& encoder) {
+    std::string_view piece,
+    const BinaryVocab& vocab) {
   if (piece.size() == 1) {
-    auto iter = encoder.find(piece);
-    if (iter != encoder.end()) {
-      return std::vector<uint64_t>({iter->second});
+    auto rank = vocab.rank(piece);
+    if (rank) {
+      return std::vector<uint64_t>({*rank});
     } else {
       // TODO: is it possible?
       return {};
@@ -231,16 +237,9 @@ static std::vector<uint64_t> _byte_pair_encode(
   }
 
   return _byte_pair_merge(
-      piece, encoder, [&piece, &encoder](uint64_t start, uint64_t stop) {
-        std::string key = piece.substr(start, stop - start);
-        auto iter = encoder.find(key);
-        if (iter != encoder.end()) {
-          return iter->second;
-        } else {
-          // TODO: what if key does not exist? Should we return `unknown`?
-          // assert(false); // ??
-          return uint64_t(0);
-        }
+      piece, vocab, [&piece, &vocab](uint64_t start, uint64_t stop) {
+        // TODO: what if key does not exist? Should we return `unknown`?
+        return vocab.rank(piece.substr(start, stop - start)).value_or(0);
       });
 }
 // ------------------------------Util end------------------------------------
@@ -274,20 +273,41 @@ Tiktoken::_split_with_allowed_special_token(
   return std::make_pair(std::nullopt, input);
 }
 
+const std::vector<uint64_t>& Tiktoken::_cache_piece(
+    std::string_view piece,
+    std::vector<uint64_t>&& tokens) {
+  if (_piece_cache.size() >= _piece_cache_capacity) {
+    _piece_cache.clear();
+    _piece_cache_keys.clear();
+  }
+  const std::string& key = _piece_cache_keys.emplace_back(piece);
+  return _piece_cache.emplace(key, std::move(tokens)).first->second;
+}
+
 void Tiktoken::_encode(
     re2::StringPiece& input,
     std::vector<uint64_t>& ret,
     uint64_t& last_piece_token_len) {
-  std::string piece;
+  // Asking for the bounds of the whole match only lets RE2 find them with its
+  // DFAs, instead of running a slower engine to extract the capture group.
+  // The pieces point into the input, and are only copied when their merges
+  // get cached.
+  re2::StringPiece match;
   assert(_regex);
-  while (re2::RE2::FindAndConsume(&input, *_regex, &piece)) {
-    auto iter = _encoder.find(piece);
-    if (iter != _encoder.end()) {
+  while (_regex->Match(
+      input, 0, input.size(), re2::RE2::UNANCHORED, &match, 1)) {
+    input.remove_prefix(match.data() + match.size() - input.data());
+    const std::string_view piece(match.data(), match.size());
+    auto rank = _vocab.rank(piece);
+    if (rank) {
       last_piece_token_len = 1;
-      ret.push_back(iter->second);
+      ret.push_back(*rank);
       continue;
     }
-    auto tokens = _byte_pair_encode(piece, _encoder);
+    auto cached = _piece_cache.find(piece);
+    const std::vector<uint64_t>& tokens = cached != _piece_cache.end()
+        ? cached->second
+        : _cache_piece(piece, _byte_pair_encode(piece, _vocab));
     last_piece_token_len = tokens.size();
     ret.insert(ret.end(), tokens.begin(), tokens.end());
   }
@@ -333,11 +353,15 @@ std::pair<std::vector<uint64_t>, uint64_t> Tiktoken::_encode_with_special_token(
 // -------------------------public method start-------------------------------
 
 Error Tiktoken::load(const std::string& path) {
-  _encoder = _load_encoder(path);
-  _special_token_encoder = _get_special_tokens(_encoder.size());
+  auto vocab = BinaryVocab::is_binary_vocab(path) ? BinaryVocab::from_file(path)
+                                                  : _load_vocab(path);
+  ET_CHECK_OK_OR_RETURN_ERROR(vocab.error());
+  _vocab = std::move(vocab.get());
+  _special_token_encoder = _get_special_tokens(_vocab.size());
 
-  _decoder = _build_decoder(_encoder);
   _special_token_decoder = _build_decoder(_special_token_encoder);
+  _piece_cache.clear();
+  _piece_cache_keys.clear();
 
   _regex = _create_regex(_pattern);
 
@@ -368,11 +392,11 @@ Result<std::string> Tiktoken::decode(uint64_t prev, uint64_t cur) {
   std::string ret;
 
   std::string token_bytes;
-  auto iter = _decoder.find(cur);
-  if (iter != _decoder.end()) {
-    token_bytes = iter->second;
+  auto piece = _vocab.piece(cur);
+  if (piece) {
+    token_bytes = *piece;
   } else {
-    iter = _special_token_decoder.find(cur);
+    auto iter = _special_token_decoder.find(cur);
     if (iter != _special_token_decoder.end()) {
       token_bytes = iter->second;
     } else {
@@ -9,12 +9,15 @@
 #pragma once
 
 #include <executorch/examples/models/llama2/tokenizer/base64.h>
+#include <executorch/examples/models/llama2/tokenizer/binary_vocab.h>
 #include <executorch/examples/models/llama2/tokenizer/tokenizer.h>
 #include <re2/re2.h>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <optional>
 #include <regex>
+#include <string_view>
 #include <unordered_map>
 
 namespace torch {
@@ -30,6 +33,11 @@ class Tiktoken : public Tokenizer {
       : Tokenizer(vocab_size, bos_tok, eos_tok){};
   ~Tiktoken(){};
 
+  /**
+   * Loads a tiktoken vocabulary with base64 encoded tokens and their ranks,
+   * one per line, or a binary vocabulary converted from one by
+   * binary_vocab.py. The binary vocabulary is mmapped and used in place.
+   */
   Error load(const std::string& tokenizer_path);
 
   Result<std::vector<uint64_t>>
@@ -69,6 +77,10 @@ class Tiktoken : public Tokenizer {
       std::vector<uint64_t>& ret,
       uint64_t& last_piece_token_len);
 
+  const std::vector<uint64_t>& _cache_piece(
+      std::string_view piece,
+      std::vector<uint64_t>&& tokens);
+
   template <typename T>
   std::pair<std::vector<uint64_t>, uint64_t> _encode_with_special_token(
       const std::string& text,
@@ -77,11 +89,18 @@ class Tiktoken : public Tokenizer {
   // Removed negative lookahead \s+(?!\S) since it's not supported by RE2.
   const std::string _pattern =
       R"((?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3}| ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+)";
-  Encoder _encoder;
+  // Pieces of the input are looked up in place, without copying them into a
+  // std::string.
+  BinaryVocab _vocab;
   Encoder _special_token_encoder;
-  Decoder _decoder;
   Decoder _special_token_decoder;
 
+  // Byte pair merges of recently encoded pieces, keyed by views of the copies
+  // in _piece_cache_keys. Both are cleared when the cache is full.
+  static constexpr size_t _piece_cache_capacity = 4096;
+  std::unordered_map<std::string_view, std::vector<uint64_t>> _piece_cache;
+  std::deque<std::string> _piece_cache_keys;
+
   Re2UPtr _regex;
   Re2UPtr _special_token_regex;
 };
@@ -15,31 +15,229 @@
  *
  * It sets all input tensor data to ones, and assumes that the outputs are
  * all fp32 tensors.
+ *
+ * With --num_workers, it instead measures throughput: each worker thread loads
+ * its own Method over the shared Program, with its own planned memory, and
+ * the workers execute it back to back until --num_requests executions are
+ * done. It then reports the QPS and the latency percentiles of the
+ * executions.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <gflags/gflags.h>
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/extension/evalue_util/print_evalue.h>
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
 #include <executorch/extension/runner_util/inputs.h>
+#include <executorch/extension/runner_util/memory_usage_recorder.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/runtime.h>
 
+#ifdef ET_USE_THREADPOOL
+#include <executorch/extension/parallel/thread_parallel.h>
+#endif
+
 static uint8_t method_allocator_pool[4 * 1024U * 1024U]; // 4 MB
 
 DEFINE_string(
     model_path,
     "model.pte",
     "Model serialized in flatbuffer format.");
+DEFINE_uint64(
+    temp_allocator_size,
+    0,
+    "Initial size in bytes of the kernel scratch arena, e.g. the high-water "
+    "mark logged by an earlier run. The arena grows as needed.");
+DEFINE_string(
+    memory_usage_report,
+    "",
+    "If set, path of a JSON file to write the peak memory usage of the "
+    "planned buffers and allocators to.");
+DEFINE_uint32(
+    num_workers,
+    0,
+    "If nonzero, measure throughput with this many worker threads, each "
+    "executing its own instance of the method.");
+DEFINE_uint32(
+    num_requests,
+    100,
+    "Total number of executions across the workers in throughput mode.");
+DEFINE_uint32(
+    warmup_requests,
+    1,
+    "Untimed executions per worker before measuring throughput.");
+DEFINE_uint32(
+    intra_op_threads,
+    0,
+    "In throughput mode, the number of threadpool threads each worker splits "
+    "its kernels across. Zero means the whole threadpool. Requires kernels "
+    "built with ET_USE_THREADPOOL.");
 
 using namespace torch::executor;
 using torch::executor::util::FileDataLoader;
 
+namespace {
+
+// One worker of the throughput mode. Everything a Method mutates is owned per
+// worker, so that the workers only share the immutable Program.
+struct Worker {
+  std::unique_ptr<uint8_t[]> method_allocator_pool;
+  std::unique_ptr<MemoryAllocator> method_allocator;
+  std::vector<std::unique_ptr<uint8_t[]>> planned_buffers;
+  std::vector<Span<uint8_t>> planned_spans;
+  std::unique_ptr<HierarchicalAllocator> planned_memory;
+  std::unique_ptr<util::TempMemoryAllocator> temp_allocator;
+  std::unique_ptr<MemoryManager> memory_manager;
+  std::unique_ptr<Method> method;
+  std::unique_ptr<util::BufferCleanup> inputs;
+  std::vector<double> latencies_ms;
+};
+
+std::unique_ptr<Worker> load_worker(
+    Program& program,
+    const char* method_name,
+    const MethodMeta& method_meta) {
+  auto worker = std::make_unique<Worker>();
+  worker->method_allocator_pool =
+      std::make_unique<uint8_t[]>(sizeof(method_allocator_pool));
+  worker->method_allocator = std::make_unique<MemoryAllocator>(
+      sizeof(method_allocator_pool), worker->method_allocator_pool.get());
+  for (size_t id = 0; id < method_meta.num_memory_planned_buffers(); ++id) {
+    size_t buffer_size =
+        static_cast<size_t>(method_meta.memory_planned_buffer_size(id).get());
+    worker->planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
+    worker->planned_spans.push_back(
+        {worker->planned_buffers.back().get(), buffer_size});
+  }
+  worker->planned_memory = std::make_unique<HierarchicalAllocator>(
+      Span<Span<uint8_t>>(
+          worker->planned_spans.data(), worker->planned_spans.size()));
+  worker->temp_allocator =
+      std::make_unique<util::TempMemoryAllocator>(FLAGS_temp_allocator_size);
+  worker->memory_manager = std::make_unique<MemoryManager>(
+      worker->method_allocator.get(),
+      worker->planned_memory.get(),
+      worker->temp_allocator.get());
+
+  Result<Method> method =
+      program.load_method(method_name, worker->memory_manager.get());
+  ET_CHECK_MSG(
+      method.ok(),
+      "Loading of method %s failed with status 0x%" PRIx32,
+      method_name,
+      (uint32_t)method.error());
+  worker->method = std::make_unique<Method>(std::move(method.get()));
+  auto inputs = util::prepare_input_tensors(*worker->method);
+  ET_CHECK_MSG(
+      inputs.ok(),
+      "Could not prepare inputs: 0x%" PRIx32,
+      (uint32_t)inputs.error());
+  worker->inputs = std::make_unique<util::BufferCleanup>(std::move(*inputs));
+  return worker;
+}
+
+void run_worker(Worker& worker, std::atomic<uint32_t>& next_request) {
+#ifdef ET_USE_THREADPOOL
+  IntraOpThreadLimitGuard thread_limit(FLAGS_intra_op_threads);
+#endif
+  while (next_request.fetch_add(1) < FLAGS_num_requests) {
+    const auto start = std::chrono::steady_clock::now();
+    Error status = worker.method->execute();
+    const auto end = std::chrono::steady_clock::now();
+    ET_CHECK_MSG(
+        status == Error::Ok,
+        "Execution failed with status 0x%" PRIx32,
+        (uint32_t)status);
+    worker.latencies_ms.push_back(
+        std::chrono::duration<double, std::milli>(end - start).count());
+  }
+}
+
+// The latency that `percentile` percent of the executions stay within.
+double latency_percentile(const std::vector<double>& sorted, int percentile) {
+  const size_t index = (sorted.size() - 1) * percentile / 100;
+  return sorted[index];
+}
+
+int run_throughput(
+    Program& program,
+    const char* method_name,
+    const MethodMeta& method_meta) {
+#ifndef ET_USE_THREADPOOL
+  if (FLAGS_intra_op_threads != 0) {
+    ET_LOG(
+        Error,
+        "--intra_op_threads needs kernels built with ET_USE_THREADPOOL");
+    return 1;
+  }
+#endif
+  if (FLAGS_num_requests == 0) {
+    ET_LOG(Error, "--num_requests must be positive");
+    return 1;
+  }
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (uint32_t i = 0; i < FLAGS_num_workers; ++i) {
+    workers.push_back(load_worker(program, method_name, method_meta));
+    for (uint32_t j = 0; j < FLAGS_warmup_requests; ++j) {
+      Error status = workers.back()->method->execute();
+      ET_CHECK_MSG(
+          status == Error::Ok,
+          "Warmup execution failed with status 0x%" PRIx32,
+          (uint32_t)status);
+    }
+  }
+  ET_LOG(
+      Info,
+      "Running %" PRIu32 " requests on %" PRIu32
+      " workers, %" PRIu32 " intra-op threads each (0: all).",
+      FLAGS_num_requests,
+      FLAGS_num_workers,
+      FLAGS_intra_op_threads);
+
+  std::atomic<uint32_t> next_request{0};
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (auto& worker : workers) {
+    threads.emplace_back(
+        [&worker, &next_request]() { run_worker(*worker, next_request); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const double elapsed_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  std::vector<double> latencies_ms;
+  for (const auto& worker : workers) {
+    latencies_ms.insert(
+        latencies_ms.end(),
+        worker->latencies_ms.begin(),
+        worker->latencies_ms.end());
+  }
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  std::cout << "Requests: " << latencies_ms.size() << std::endl;
+  std::cout << "QPS: " << latencies_ms.size() / elapsed_s << std::endl;
+  std::cout << "Latency ms: p50 " << latency_percentile(latencies_ms, 50)
+            << ", p90 " << latency_percentile(latencies_ms, 90) << ", p99 "
+            << latency_percentile(latencies_ms, 99) << ", max "
+            << latencies_ms.back() << std::endl;
+  return 0;
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   runtime_init();
 
@@ -89,6 +287,10 @@ int main(int argc, char** argv) {
       method_name,
       (uint32_t)method_meta.error());
 
+  if (FLAGS_num_workers > 0) {
+    return run_throughput(program.get(), method_name, method_meta.get());
+  }
+
   //
   // The runtime does not use malloc/new; it allocates all memory using the
   // MemoryManger provided by the client. Clients are responsible for allocating
@@ -118,7 +320,9 @@ int main(int argc, char** argv) {
   // Each buffer typically corresponds to a different hardware memory bank. Most
   // mobile environments will only have a single buffer. Some embedded
   // environments may have more than one for, e.g., slow/large DRAM and
-  // fast/small SRAM, or for memory associated with particular cores.
+  // fast/small SRAM, or for memory associated with particular cores. If the
+  // program was planned for memory tiers, memory_planned_buffer_tier() names
+  // the bank each buffer belongs in; this runner uses the heap for all of them.
   std::vector<std::unique_ptr<uint8_t[]>> planned_buffers; // Owns the memory
   std::vector<Span<uint8_t>> planned_spans; // Passed to the allocator
   size_t num_memory_planned_buffers = method_meta->num_memory_planned_buffers();
@@ -126,16 +330,29 @@ int main(int argc, char** argv) {
     // .get() will always succeed because id < num_memory_planned_buffers.
     size_t buffer_size =
         static_cast<size_t>(method_meta->memory_planned_buffer_size(id).get());
-    ET_LOG(Info, "Setting up planned buffer %zu, size %zu.", id, buffer_size);
+    const char* tier = method_meta->memory_planned_buffer_tier(id).get();
+    ET_LOG(
+        Info,
+        "Setting up planned buffer %zu, size %zu, tier %s.",
+        id,
+        buffer_size,
+        tier != nullptr ? tier : "(none)");
     planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
     planned_spans.push_back({planned_buffers.back().get(), buffer_size});
   }
   HierarchicalAllocator planned_memory(
       {planned_spans.data(), planned_spans.size()});
 
+  // The temp allocator provides scratch memory to kernels and is reset after
+  // every kernel. It grows to the largest request seen, so the high-water mark
+  // logged below can be passed back with --temp_allocator_size to skip the
+  // growth on the next run.
+  util::TempMemoryAllocator temp_allocator(FLAGS_temp_allocator_size);
+
   // Assemble all of the allocators into the MemoryManager that the Executor
   // will use.
-  MemoryManager memory_manager(&method_allocator, &planned_memory);
+  MemoryManager memory_manager(
+      &method_allocator, &planned_memory, &temp_allocator);
 
   //
   // Load the method from the program, using the provided allocators. Running
@@ -169,6 +386,30 @@ int main(int argc, char** argv) {
       method_name,
       (uint32_t)status);
   ET_LOG(Info, "Model executed successfully.");
+  ET_LOG(
+      Info,
+      "Temp allocator high-water mark: %zu bytes.",
+      temp_allocator.high_water_mark());
+
+  if (!FLAGS_memory_usage_report.empty()) {
+    util::MemoryUsageRecorder recorder(
+        *method, &method_allocator, &temp_allocator);
+    status = recorder.record();
+    ET_CHECK_MSG(
+        status == Error::Ok,
+        "Recording memory usage failed with status 0x%" PRIx32,
+        (uint32_t)status);
+    std::ofstream report(FLAGS_memory_usage_report);
+    report << recorder.to_json();
+    ET_CHECK_MSG(
+        report.good(),
+        "Could not write %s",
+        FLAGS_memory_usage_report.c_str());
+    ET_LOG(
+        Info,
+        "Memory usage report written to %s.",
+        FLAGS_memory_usage_report.c_str());
+  }
 
   // Print the outputs.
   std::vector<EValue> outputs(method->outputs_size());
@@ -16,7 +16,9 @@ def define_common_targets():
             "//executorch/runtime/executor:program",
             "//executorch/extension/data_loader:file_data_loader",
             "//executorch/extension/evalue_util:print_evalue",
+            "//executorch/extension/memory_allocator:temp_memory_allocator",
             "//executorch/extension/runner_util:inputs",
+            "//executorch/extension/runner_util:memory_usage_recorder",
         ],
         external_deps = [
             "gflags",
@@ -18,7 +18,8 @@
  */
 
 #include <executorch/backends/qualcomm/runtime/QnnExecuTorch.h>
-#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/backends/qualcomm/runtime/SharedBufferAllocator.h>
+#include <executorch/extension/data_loader/mmap_data_loader.h>
 #include <executorch/extension/runner_util/inputs.h>
 #include <executorch/runtime/core/memory_allocator.h>
 #include <executorch/runtime/executor/method.h>
@@ -62,7 +63,7 @@ DEFINE_string(
     "If etdump generation is enabled an etdump will be written out to this path");
 using namespace torch::executor;
 using torch::executor::MemoryAllocator;
-using torch::executor::util::FileDataLoader;
+using torch::executor::util::MmapDataLoader;
 
 class CustomMemory {
  public:
@@ -113,13 +114,15 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  // Create a loader to get the data of the program file. There are other
-  // DataLoaders that use mmap() or point to data that's already in memory, and
-  // users can create their own DataLoaders to load from arbitrary sources.
+  // Create a loader to get the data of the program file. Mapping the file
+  // lets the QNN delegate read its context binary in place, without first
+  // copying it into a heap buffer, and unmap it once the context is created.
+  // The context binary is read once, so it is not locked in memory.
   const char* model_path = FLAGS_model_path.c_str();
-  Result<FileDataLoader> loader = FileDataLoader::from(model_path);
+  Result<MmapDataLoader> loader = MmapDataLoader::from(
+      model_path, MmapDataLoader::MlockConfig::NoMlock);
   ET_CHECK_MSG(
-      loader.ok(), "FileDataLoader::from() failed: 0x%" PRIx32, loader.error());
+      loader.ok(), "MmapDataLoader::from() failed: 0x%" PRIx32, loader.error());
 
   // Parse the program file. This is immutable, and can also be reused between
   // multiple execution invocations across multiple threads.
@@ -178,7 +181,11 @@ int main(int argc, char** argv) {
   // mobile environments will only have a single buffer. Some embedded
   // environments may have more than one for, e.g., slow/large DRAM and
   // fast/small SRAM, or for memory associated with particular cores.
+  //
+  // With shared buffers, the planned buffers are shared buffers as well, so
+  // that the tensors passed between delegates are not copied.
   std::vector<std::unique_ptr<uint8_t[]>> planned_buffers; // Owns the memory
+  qnn::SharedBufferAllocator shared_planned_buffers; // Owns the shared memory
   std::vector<Span<uint8_t>> planned_spans; // Passed to the allocator
   size_t num_memory_planned_buffers = method_meta->num_memory_planned_buffers();
   for (size_t id = 0; id < num_memory_planned_buffers; ++id) {
@@ -186,8 +193,19 @@ int main(int argc, char** argv) {
     size_t buffer_size =
         static_cast<size_t>(method_meta->memory_planned_buffer_size(id).get());
     ET_LOG(Info, "Setting up planned buffer %zu, size %zu.", id, buffer_size);
-    planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
-    planned_spans.push_back({planned_buffers.back().get(), buffer_size});
+    uint8_t* buffer = nullptr;
+    if (FLAGS_shared_buffer) {
+      buffer =
+          static_cast<uint8_t*>(shared_planned_buffers.allocate(buffer_size));
+      ET_CHECK_MSG(
+          buffer != nullptr,
+          "Failed to allocate shared planned buffer %zu",
+          id);
+    } else {
+      planned_buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
+      buffer = planned_buffers.back().get();
+    }
+    planned_spans.push_back({buffer, buffer_size});
   }
   HierarchicalAllocator planned_memory(
       {planned_spans.data(), planned_spans.size()});
@@ -96,8 +96,10 @@ if __name__ == "__main__":
         )
 
     executorch_program = delegated_program.to_executorch(
+        # The context binary goes into a page-aligned segment that the backend
+        # can read in place and release once it created the context.
         config=ExecutorchBackendConfig(
-            extract_delegate_segments=False, extract_constant_segment=False
+            extract_delegate_segments=True, extract_constant_segment=False
         )
     )
 
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * This tool benchmarks the methods of a BundledProgram with their bundled
+ * inputs, and writes the results as JSON so that on-device CI can track
+ * regressions.
+ *
+ * For each method with bundled testsets it reports:
+ * - the time to load the method, and of its first execution, both cold, i.e.
+ *   on the first load, and warm, i.e. after reloading it;
+ * - the latency distribution of the timed iterations of all its testsets,
+ *   run after the warmup iterations;
+ * - the high-water marks of its method, planned and temp memory, and the
+ *   peak resident memory of the process;
+ * - a per-op breakdown from the ETDump of extra profiled iterations, which
+ *   are not timed since tracing slows them down.
+ */
+
+#include <inttypes.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <gflags/gflags.h>
+
+#include <executorch/extension/data_loader/buffer_data_loader.h>
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/platform/clock.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/sdk/bundled_program/bundled_program.h>
+#include <executorch/sdk/etdump/etdump_flatcc.h>
+#include <executorch/sdk/etdump/etdump_schema_flatcc_reader.h>
+
+static uint8_t method_allocator_pool[4 * 1024U * 1024U]; // 4MB
+static uint8_t temp_allocator_pool[1024U * 1024U]; // 1MB
+
+DEFINE_string(
+    bundled_program_path,
+    "model_bundled.bpte",
+    "Model serialized in flatbuffer format.");
+
+DEFINE_string(
+    method_name,
+    "",
+    "Method to benchmark. If empty, all methods with bundled testsets are benchmarked.");
+
+DEFINE_int32(
+    warmup_iterations,
+    3,
+    "Untimed iterations of each testset before the timed ones.");
+
+DEFINE_int32(iterations, 20, "Timed iterations of each testset.");
+
+DEFINE_int32(
+    profile_iterations,
+    5,
+    "Iterations of each testset profiled with ETDump for the per-op breakdown. 0 to skip it.");
+
+DEFINE_string(
+    output_json_path,
+    "benchmark.json",
+    "Path to write the results to, as JSON.");
+
+DEFINE_string(
+    etdump_path_prefix,
+    "",
+    "If set, the ETDump of the profiled iterations of each method is written out to <prefix><method name>.etdp.");
+
+DEFINE_bool(
+    output_verification,
+    false,
+    "Compare the outputs of the first timed iteration of each testset to the reference outputs present in the BundledProgram.");
+
+using namespace torch::executor;
+using torch::executor::util::FileDataLoader;
+
+namespace {
+
+/**
+ * A MemoryAllocator that remembers the most memory it held, even across
+ * resets, e.g. of the temp allocator after each kernel.
+ */
+class HighWaterMarkAllocator : public MemoryAllocator {
+ public:
+  HighWaterMarkAllocator(uint32_t size, uint8_t* base_address)
+      : MemoryAllocator(size, base_address) {}
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    void* ptr = MemoryAllocator::allocate(size, alignment);
+    high_water_mark_ = std::max(high_water_mark_, used_size());
+    return ptr;
+  }
+
+  size_t high_water_mark() const {
+    return high_water_mark_;
+  }
+
+ private:
+  size_t high_water_mark_ = 0;
+};
+
+struct LatencyStats {
+  double min_us = 0;
+  double max_us = 0;
+  double mean_us = 0;
+  double stddev_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+};
+
+struct OpStats {
+  uint64_t num_calls = 0;
+  double total_us = 0;
+};
+
+struct MethodResult {
+  std::string name;
+  size_t num_testsets = 0;
+  double cold_load_us = 0;
+  double cold_first_iteration_us = 0;
+  double warm_load_us = 0;
+  double warm_first_iteration_us = 0;
+  std::vector<double> latencies_us;
+  size_t method_allocator_bytes = 0;
+  size_t planned_memory_bytes = 0;
+  size_t temp_allocator_bytes = 0;
+  int64_t peak_rss_bytes = -1;
+  size_t num_profiled_iterations = 0;
+  std::map<std::string, OpStats> ops;
+};
+
+double elapsed_us(et_timestamp_t start, et_timestamp_t end) {
+  return static_cast<double>(ticks_to_ns(end - start)) / 1000.0;
+}
+
+LatencyStats compute_stats(std::vector<double> samples) {
+  LatencyStats stats;
+  if (samples.empty()) {
+    return stats;
+  }
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double sample : samples) {
+    sum += sample;
+  }
+  stats.mean_us = sum / samples.size();
+  double sum_squares = 0;
+  for (double sample : samples) {
+    sum_squares += (sample - stats.mean_us) * (sample - stats.mean_us);
+  }
+  stats.stddev_us = std::sqrt(sum_squares / samples.size());
+  stats.min_us = samples.front();
+  stats.max_us = samples.back();
+  // Nearest-rank percentiles.
+  auto percentile = [&](double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+    return samples[std::max<size_t>(rank, 1) - 1];
+  };
+  stats.p50_us = percentile(50);
+  stats.p90_us = percentile(90);
+  stats.p99_us = percentile(99);
+  return stats;
+}
+
+// Returns the peak resident memory of the process, or -1 if unknown.
+int64_t peak_rss_bytes() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+#if defined(__APPLE__)
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return -1;
+#endif
+}
+
+// Owns the planned memory of a method, which is reused by each of its loads.
+struct PlannedMemory {
+  std::vector<std::unique_ptr<uint8_t[]>> buffers;
+  std::vector<Span<uint8_t>> spans;
+  size_t total_bytes = 0;
+
+  explicit PlannedMemory(const MethodMeta& method_meta) {
+    size_t num_buffers = method_meta.num_memory_planned_buffers();
+    for (size_t id = 0; id < num_buffers; ++id) {
+      // .get() will always succeed because id < num_buffers.
+      size_t buffer_size =
+          static_cast<size_t>(method_meta.memory_planned_buffer_size(id).get());
+      buffers.push_back(std::make_unique<uint8_t[]>(buffer_size));
+      spans.push_back({buffers.back().get(), buffer_size});
+      total_bytes += buffer_size;
+    }
+  }
+};
+
+// Everything a loaded Method uses, so that it can be reloaded from scratch.
+struct LoadedMethod {
+  HighWaterMarkAllocator method_allocator;
+  HighWaterMarkAllocator temp_allocator;
+  HierarchicalAllocator planned_memory;
+  MemoryManager memory_manager;
+  Result<Method> method;
+
+  LoadedMethod(
+      Program& program,
+      const char* method_name,
+      PlannedMemory& planned,
+      EventTracer* event_tracer)
+      : method_allocator(sizeof(method_allocator_pool), method_allocator_pool),
+        temp_allocator(sizeof(temp_allocator_pool), temp_allocator_pool),
+        planned_memory({planned.spans.data(), planned.spans.size()}),
+        memory_manager(&method_allocator, &planned_memory, &temp_allocator),
+        method(
+            program.load_method(method_name, &memory_manager, event_tracer)) {
+    ET_CHECK_MSG(
+        method.ok(),
+        "Loading of method %s failed with status 0x%" PRIx32,
+        method_name,
+        method.error());
+  }
+};
+
+void load_input(LoadedMethod& loaded, const void* bundled_program, size_t i) {
+  Error status = bundled_program::LoadBundledInput(
+      *loaded.method, bundled_program, i);
+  ET_CHECK_MSG(
+      status == Error::Ok,
+      "LoadBundledInput failed on testset %zu with status 0x%" PRIx32,
+      i,
+      status);
+}
+
+double execute(LoadedMethod& loaded) {
+  et_timestamp_t start = et_pal_current_ticks();
+  Error status = loaded.method->execute();
+  et_timestamp_t end = et_pal_current_ticks();
+  ET_CHECK_MSG(
+      status == Error::Ok,
+      "Execution failed with status 0x%" PRIx32,
+      status);
+  return elapsed_us(start, end);
+}
+
+// Adds the durations of the profiling events of an ETDump to `ops`, by the
+// name of their operator or delegate.
+void add_op_stats(
+    const etdump_result& etdump,
+    std::map<std::string, OpStats>& ops) {
+  size_t size = 0;
+  const void* buf = flatbuffers_read_size_prefix(etdump.buf, &size);
+  etdump_ETDump_table_t root =
+      etdump_ETDump_as_root_with_identifier(buf, etdump_ETDump_file_identifier);
+  ET_CHECK_MSG(root != nullptr, "Not an ETDump buffer");
+  etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(root);
+  for (size_t i = 0; i < etdump_RunData_vec_len(run_data_vec); ++i) {
+    etdump_Event_vec_t events =
+        etdump_RunData_events(etdump_RunData_vec_at(run_data_vec, i));
+    for (size_t j = 0; j < etdump_Event_vec_len(events); ++j) {
+      etdump_ProfileEvent_table_t event =
+          etdump_Event_profile_event(etdump_Event_vec_at(events, j));
+      if (event == nullptr) {
+        continue;
+      }
+      std::string name;
+      flatbuffers_string_t delegate_id_str =
+          etdump_ProfileEvent_delegate_debug_id_str(event);
+      int32_t delegate_id_int =
+          etdump_ProfileEvent_delegate_debug_id_int(event);
+      if (delegate_id_str != nullptr) {
+        name = delegate_id_str;
+      } else if (delegate_id_int != -1) {
+        name = "delegate " + std::to_string(delegate_id_int);
+      } else if (etdump_ProfileEvent_name(event) != nullptr) {
+        name = etdump_ProfileEvent_name(event);
+      } else {
+        continue;
+      }
+      uint64_t start_time = etdump_ProfileEvent_start_time(event);
+      uint64_t end_time = etdump_ProfileEvent_end_time(event);
+      OpStats& stats = ops[name];
+      stats.num_calls++;
+      stats.total_us += elapsed_us(start_time, std::max(start_time, end_time));
+    }
+  }
+}
+
+void write_json_string(FILE* out, const std::string& str) {
+  fputc('"', out);
+  for (char c : str) {
+    const unsigned char ch = static_cast<unsigned char>(c);
+    if (ch == '"' || ch == '\\') {
+      fprintf(out, "\\%c", ch);
+    } else if (ch < 0x20) {
+      fprintf(out, "\\u%04x", ch);
+    } else {
+      fputc(ch, out);
+    }
+  }
+  fputc('"', out);
+}
+
+void write_json(FILE* out, const std::vector<MethodResult>& results) {
+  fprintf(out, "{\n  \"bundled_program\": ");
+  write_json_string(out, FLAGS_bundled_program_path);
+  fprintf(
+      out,
+      ",\n  \"warmup_iterations\": %d,\n  \"iterations\": %d,\n"
+      "  \"profile_iterations\": %d,\n  \"methods\": [",
+      FLAGS_warmup_iterations,
+      FLAGS_iterations,
+      FLAGS_profile_iterations);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const MethodResult& result = results[i];
+    const LatencyStats stats = compute_stats(result.latencies_us);
+    fprintf(out, "%s\n    {\n      \"name\": ", i == 0 ? "" : ",");
+    write_json_string(out, result.name);
+    fprintf(
+        out,
+        ",\n      \"num_testsets\": %zu,\n"
+        "      \"cold_load_us\": %.3f,\n"
+        "      \"cold_first_iteration_us\": %.3f,\n"
+        "      \"warm_load_us\": %.3f,\n"
+        "      \"warm_first_iteration_us\": %.3f,\n"
+        "      \"latency_us\": {\"count\": %zu, \"min\": %.3f, \"max\": %.3f, "
+        "\"mean\": %.3f, \"stddev\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+        "\"p99\": %.3f},\n"
+        "      \"memory_bytes\": {\"method_allocator\": %zu, "
+        "\"planned\": %zu, \"temp_allocator\": %zu, \"peak_rss\": %" PRId64
+        "},\n"
+        "      \"num_profiled_iterations\": %zu,\n"
+        "      \"ops\": [",
+        result.num_testsets,
+        result.cold_load_us,
+        result.cold_first_iteration_us,
+        result.warm_load_us,
+        result.warm_first_iteration_us,
+        result.latencies_us.size(),
+        stats.min_us,
+        stats.max_us,
+        stats.mean_us,
+        stats.stddev_us,
+        stats.p50_us,
+        stats.p90_us,
+        stats.p99_us,
+        result.method_allocator_bytes,
+        result.planned_memory_bytes,
+        result.temp_allocator_bytes,
+        result.peak_rss_bytes,
+        result.num_profiled_iterations);
+
+    // The most expensive ops first.
+    std::vector<std::pair<std::string, OpStats>> ops(
+        result.ops.begin(), result.ops.end());
+    std::sort(ops.begin(), ops.end(), [](const auto& a, const auto& b) {
+      return a.second.total_us > b.second.total_us;
+    });
+    const double num_iterations =
+        std::max<double>(result.num_profiled_iterations, 1);
+    for (size_t j = 0; j < ops.size(); ++j) {
+      const OpStats& op = ops[j].second;
+      fprintf(out, "%s\n        {\"name\": ", j == 0 ? "" : ",");
+      write_json_string(out, ops[j].first);
+      fprintf(
+          out,
+          ", \"calls_per_iteration\": %.3f, \"us_per_iteration\": %.3f, "
+          "\"us_per_call\": %.3f}",
+          op.num_calls / num_iterations,
+          op.total_us / num_iterations,
+          op.total_us / op.num_calls);
+    }
+    fprintf(out, "%s]\n    }", ops.empty() ? "" : "\n      ");
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+MethodResult benchmark_method(
+    Program& program,
+    const char* method_name,
+    const void* bundled_program,
+    size_t num_testsets) {
+  MethodResult result;
+  result.name = method_name;
+  result.num_testsets = num_testsets;
+
+  Result<MethodMeta> method_meta = program.method_meta(method_name);
+  ET_CHECK_MSG(
+      method_meta.ok(),
+      "Failed to get method_meta for %s: 0x%x",
+      method_name,
+      (unsigned int)method_meta.error());
+  PlannedMemory planned(*method_meta);
+  result.planned_memory_bytes = planned.total_bytes;
+
+  // The cold load and the timed iterations.
+  {
+    et_timestamp_t start = et_pal_current_ticks();
+    LoadedMethod loaded(program, method_name, planned, nullptr);
+    result.cold_load_us = elapsed_us(start, et_pal_current_ticks());
+    for (size_t i = 0; i < num_testsets; ++i) {
+      load_input(loaded, bundled_program, i);
+      if (i == 0) {
+        result.cold_first_iteration_us = execute(loaded);
+      }
+      for (int32_t j = 0; j < FLAGS_warmup_iterations; ++j) {
+        execute(loaded);
+      }
+      for (int32_t j = 0; j < FLAGS_iterations; ++j) {
+        result.latencies_us.push_back(execute(loaded));
+        if (j == 0 && FLAGS_output_verification) {
+          Error status =
+              bundled_program::VerifyResultWithBundledExpectedOutput(
+                  *loaded.method,
+                  bundled_program,
+                  i,
+                  1e-3, // rtol
+                  1e-5 // atol
+              );
+          ET_CHECK_MSG(
+              status == Error::Ok,
+              "Bundle verification of testset %zu failed with status 0x%" PRIx32,
+              i,
+              status);
+        }
+      }
+    }
+    result.method_allocator_bytes = loaded.method_allocator.high_water_mark();
+    result.temp_allocator_bytes = loaded.temp_allocator.high_water_mark();
+  }
+
+  // The first iteration of the method once it was loaded before.
+  {
+    et_timestamp_t start = et_pal_current_ticks();
+    LoadedMethod loaded(program, method_name, planned, nullptr);
+    result.warm_load_us = elapsed_us(start, et_pal_current_ticks());
+    load_input(loaded, bundled_program, 0);
+    result.warm_first_iteration_us = execute(loaded);
+  }
+
+  if (FLAGS_profile_iterations > 0) {
+    ETDumpGen etdump_gen;
+    LoadedMethod loaded(program, method_name, planned, &etdump_gen);
+    for (size_t i = 0; i < num_testsets; ++i) {
+      load_input(loaded, bundled_program, i);
+      // Leave out the first iteration of each testset, and the events of
+      // loading the method.
+      execute(loaded);
+      etdump_gen.reset();
+      for (int32_t j = 0; j < FLAGS_profile_iterations; ++j) {
+        execute(loaded);
+      }
+      etdump_result etdump = etdump_gen.get_etdump_data();
+      if (etdump.buf != nullptr && etdump.size > 0) {
+        add_op_stats(etdump, result.ops);
+        if (!FLAGS_etdump_path_prefix.empty() && i == 0) {
+          std::string path = FLAGS_etdump_path_prefix + method_name + ".etdp";
+          FILE* f = fopen(path.c_str(), "w+");
+          fwrite((uint8_t*)etdump.buf, 1, etdump.size, f);
+          fclose(f);
+        }
+        free(etdump.buf);
+      }
+      result.num_profiled_iterations += FLAGS_profile_iterations;
+    }
+  }
+
+  result.peak_rss_bytes = peak_rss_bytes();
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  runtime_init();
+
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc != 1) {
+    std::string msg = "Extra commandline args:";
+    for (int i = 1 /* skip argv[0] (program name) */; i < argc; i++) {
+      msg += std::string(" ") + argv[i];
+    }
+    ET_LOG(Error, "%s", msg.c_str());
+    return 1;
+  }
+  ET_CHECK_MSG(
+      FLAGS_warmup_iterations >= 0 && FLAGS_iterations > 0 &&
+          FLAGS_profile_iterations >= 0,
+      "Iteration counts must not be negative, and there must be at least one timed iteration");
+
+  const char* bundled_program_path = FLAGS_bundled_program_path.c_str();
+  Result<FileDataLoader> loader = FileDataLoader::from(bundled_program_path);
+  ET_CHECK_MSG(
+      loader.ok(), "FileDataLoader::from() failed: 0x%" PRIx32, loader.error());
+
+  // Read in the entire file.
+  Result<FreeableBuffer> file_data = loader->Load(0, loader->size().get());
+  ET_CHECK_MSG(
+      file_data.ok(),
+      "Could not load contents of file '%s': 0x%x",
+      bundled_program_path,
+      (unsigned int)file_data.error());
+
+  // Find the offset to the embedded Program.
+  const void* program_data;
+  size_t program_data_len;
+  Error status = bundled_program::GetProgramData(
+      const_cast<void*>(file_data->data()),
+      file_data->size(),
+      &program_data,
+      &program_data_len);
+  ET_CHECK_MSG(
+      status == Error::Ok,
+      "GetProgramData() failed on file '%s': 0x%x",
+      bundled_program_path,
+      (unsigned int)status);
+
+  auto buffer_data_loader =
+      util::BufferDataLoader(program_data, program_data_len);
+  Result<Program> program = Program::load(&buffer_data_loader);
+  if (!program.ok()) {
+    ET_LOG(Error, "Failed to parse model file %s", bundled_program_path);
+    return 1;
+  }
+  ET_LOG(Info, "Model file %s is loaded.", bundled_program_path);
+
+  std::vector<MethodResult> results;
+  for (size_t i = 0; i < program->num_methods(); ++i) {
+    const char* method_name = program->get_method_name(i).get();
+    if (!FLAGS_method_name.empty() && FLAGS_method_name != method_name) {
+      continue;
+    }
+    Result<size_t> num_testsets =
+        bundled_program::GetNumTestSets(file_data->data(), method_name);
+    if (!num_testsets.ok() || *num_testsets == 0) {
+      ET_LOG(Info, "Skipping method %s without testsets.", method_name);
+      continue;
+    }
+    ET_LOG(
+        Info,
+        "Benchmarking method %s over %zu testsets.",
+        method_name,
+        *num_testsets);
+    results.push_back(benchmark_method(
+        *program, method_name, file_data->data(), *num_testsets));
+  }
+  ET_CHECK_MSG(!results.empty(), "No method with bundled testsets to run");
+
+  FILE* f = fopen(FLAGS_output_json_path.c_str(), "w+");
+  ET_CHECK_MSG(
+      f != nullptr, "Could not open %s", FLAGS_output_json_path.c_str());
+  write_json(f, results);
+  fclose(f);
+  ET_LOG(Info, "Results written to %s.", FLAGS_output_json_path.c_str());
+
+  return 0;
+}
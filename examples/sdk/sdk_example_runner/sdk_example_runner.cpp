@@ -28,6 +28,7 @@
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/runtime.h>
 #include <executorch/sdk/bundled_program/bundled_program.h>
+#include <executorch/sdk/etdump/chrome_trace.h>
 #include <executorch/sdk/etdump/etdump_flatcc.h>
 #include <executorch/util/util.h>
 
@@ -51,11 +52,23 @@ DEFINE_string(
     "etdump.etdp",
     "If etdump generation is enabled an etdump will be written out to this path");
 
+DEFINE_string(
+    chrome_trace_path,
+    "",
+    "If set, the profiling events are also written out to this path as a Chrome trace, which https://ui.perfetto.dev opens.");
+
 DEFINE_bool(
     output_verification,
     false,
     "Comapre the model output to the reference outputs present in the BundledProgram.");
 
+DEFINE_double(
+    rtol,
+    1e-3,
+    "Relative tolerance of the output verification. Models that run with reduced precision, such as fp16 inference, need a larger one.");
+
+DEFINE_double(atol, 1e-5, "Absolute tolerance of the output verification.");
+
 DEFINE_bool(
     print_output,
     false,
@@ -271,6 +284,15 @@ int main(int argc, char** argv) {
     FILE* f = fopen(FLAGS_etdump_path.c_str(), "w+");
     fwrite((uint8_t*)result.buf, 1, result.size, f);
     fclose(f);
+    if (!FLAGS_chrome_trace_path.empty()) {
+      f = fopen(FLAGS_chrome_trace_path.c_str(), "w+");
+      status = write_chrome_trace(result.buf, result.size, f);
+      fclose(f);
+      ET_CHECK_MSG(
+          status == Error::Ok,
+          "Writing the Chrome trace failed with status 0x%" PRIx32,
+          status);
+    }
     free(result.buf);
   }
 
@@ -281,9 +303,8 @@ int main(int argc, char** argv) {
             *method,
             file_data->data(),
             FLAGS_testset_idx,
-            1e-3, // rtol
-            1e-5 // atol
-        );
+            FLAGS_rtol,
+            FLAGS_atol);
     ET_CHECK_MSG(
         status == Error::Ok,
         "Bundle verification failed with status 0x%" PRIx32,
@@ -12,8 +12,15 @@ import logging
 
 import torch
 from executorch.backends.xnnpack.partition.xnnpack_partitioner import XnnpackPartitioner
+from executorch.backends.xnnpack.utils.configs import (
+    get_xnnpack_fp16_inference_compile_spec,
+)
 from executorch.exir import EdgeCompileConfig, ExecutorchBackendConfig
-from executorch.sdk import generate_etrecord
+from executorch.sdk import BundledProgram, generate_etrecord
+from executorch.sdk.bundled_program.config import MethodTestCase, MethodTestSuite
+from executorch.sdk.bundled_program.serialize import (
+    serialize_from_bundled_program_to_flatbuffer,
+)
 
 from ..models import MODEL_NAME_TO_MODEL
 from ..models.model_factory import EagerModelFactory
@@ -50,6 +57,15 @@ if __name__ == "__main__":
         default=True,
         help="Produce an XNNPACK delegated model",
     )
+    parser.add_argument(
+        "--fp16",
+        action="store_true",
+        required=False,
+        default=False,
+        help="Let XNNPACK run the fp32 model with fp16 arithmetic on CPUs that "
+        "support it. Also saves a bundled program with the fp32 outputs of the "
+        "eager model as reference, to check the accuracy on device.",
+    )
     parser.add_argument(
         "-r",
         "--etrecord",
@@ -78,6 +94,11 @@ if __name__ == "__main__":
     )
 
     model = model.eval()
+    if args.fp16:
+        if args.quantize:
+            raise RuntimeError("--fp16 only applies to floating-point models")
+        with torch.no_grad():
+            reference_outputs = model(*example_inputs)
     # pre-autograd export. eventually this will become torch.export
     model = torch._export.capture_pre_autograd_graph(model, example_inputs)
 
@@ -99,7 +120,8 @@ if __name__ == "__main__":
     # this is needed for the ETRecord as lowering modifies the graph in-place
     edge_copy = copy.deepcopy(edge)
 
-    edge = edge.to_backend(XnnpackPartitioner())
+    compile_specs = [get_xnnpack_fp16_inference_compile_spec()] if args.fp16 else []
+    edge = edge.to_backend(XnnpackPartitioner(compile_specs=compile_specs))
     logging.info(f"Lowered graph:\n{edge.exported_program().graph}")
 
     exec_prog = edge.to_executorch(
@@ -112,6 +134,21 @@ if __name__ == "__main__":
         generate_etrecord(args.etrecord, edge_copy, exec_prog)
         logging.info(f"Saved ETRecord to {args.etrecord}")
 
-    quant_tag = "q8" if args.quantize else "fp32"
+    quant_tag = "q8" if args.quantize else "fp16" if args.fp16 else "fp32"
     model_name = f"{args.model_name}_xnnpack_{quant_tag}"
     save_pte_program(exec_prog, model_name, args.output_dir)
+
+    if args.fp16:
+        test_suite = MethodTestSuite(
+            method_name="forward",
+            test_cases=[
+                MethodTestCase(
+                    inputs=example_inputs, expected_outputs=reference_outputs
+                )
+            ],
+        )
+        bundled_program = BundledProgram(exec_prog, [test_suite])
+        bundled_path = f"{args.output_dir}/{model_name}_bundled.bpte"
+        with open(bundled_path, "wb") as file:
+            file.write(serialize_from_bundled_program_to_flatbuffer(bundled_program))
+        logging.info(f"Saved bundled program to {bundled_path}")
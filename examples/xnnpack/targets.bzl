@@ -28,11 +28,14 @@ def define_common_targets():
         deps = [
             ":models",
             "//executorch/backends/xnnpack/partition:xnnpack_partitioner",
+            "//executorch/backends/xnnpack/utils:xnnpack_utils",
             "//executorch/examples/portable:utils",
             "//executorch/examples/xnnpack/quantization:quant_utils",
             "//executorch/exir:lib",
             "//executorch/exir/backend:backend_api",
             "//executorch/sdk:lib",
+            "//executorch/sdk/bundled_program:config",
+            "//executorch/sdk/bundled_program/serialize:lib",
         ],
     )
 
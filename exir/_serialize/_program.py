@@ -11,7 +11,7 @@ import json
 import re
 
 from dataclasses import dataclass
-from typing import ClassVar, List, Literal, Optional, Tuple
+from typing import ClassVar, Dict, List, Literal, Optional, Tuple
 
 from executorch.exir._serialize._cord import Cord
 from executorch.exir._serialize._dataclass import _DataclassEncoder, _json_to_dataclass
@@ -25,10 +25,14 @@ from executorch.exir.schema import (
     BackendDelegateDataReference,
     BackendDelegateInlineData,
     Buffer,
+    CompressionCodec,
     DataLocation,
     DataSegment,
     Program,
+    SegmentCompression,
     SubsegmentOffsets,
+    Tensor,
+    TensorShapeDynamism,
 )
 from executorch.exir.tensor import ALIGNMENT
 
@@ -338,14 +342,153 @@ def _extract_constant_segment(
     return constant_segment_data, constant_segment_offsets
 
 
+def _compress_segment(
+    data: Cord,
+    codec: CompressionCodec,
+    block_size: int,
+    alignment: int,
+) -> Tuple[Cord, SegmentCompression]:
+    """Compresses `data` as independently compressed blocks of `block_size`
+    bytes, so that the runtime can decompress them in parallel.
+
+    Args:
+        data: The segment to compress. Not modified.
+        codec: The codec to compress the blocks with. Compressing with
+            CompressionCodec.ZSTD requires the zstandard package, with
+            CompressionCodec.LZ4 the lz4 package.
+        block_size: The size in bytes of each uncompressed block. Must be
+            positive.
+        alignment: The alignment in bytes required of the decompressed data.
+
+    Returns:
+        A tuple of (compressed segment, description of the compression)
+    """
+    if block_size <= 0:
+        raise ValueError(f"Compression block size {block_size} must be positive")
+    if codec == CompressionCodec.ZSTD:
+        import zstandard
+
+        compress = zstandard.ZstdCompressor().compress
+    elif codec == CompressionCodec.LZ4:
+        import lz4.block
+
+        def compress(block: bytes) -> bytes:
+            return lz4.block.compress(block, store_size=False)
+
+    else:
+        raise ValueError(f"Unsupported compression codec {codec}")
+
+    uncompressed: bytes = bytes(data)
+    compressed: Cord = Cord()
+    block_offsets: List[int] = []
+    for start in range(0, len(uncompressed), block_size):
+        block_offsets.append(len(compressed))
+        compressed.append(compress(uncompressed[start : start + block_size]))
+    return compressed, SegmentCompression(
+        codec=codec,
+        uncompressed_size=len(uncompressed),
+        block_size=block_size,
+        block_offsets=block_offsets,
+        alignment=alignment,
+    )
+
+
+def _extract_constant_segments_by_method(
+    program: Program,
+    tensor_alignment: int,
+) -> Tuple[List[Cord], List[int], List[int]]:
+    """Like _extract_constant_segment(), but puts the constants used by each set
+    of execution plans into a segment of its own, so that loading a method only
+    loads the constants it uses. Constants shared by several methods, like the
+    weights of prefill and decode methods, are stored once.
+
+    Args:
+        program: The Program whose constant_buffer to extract. Not modified.
+        tensor_alignment: Alignment in bytes of each tensor within its segment.
+
+    Returns:
+        A tuple of (the segments, the offset of each tensor within its segment,
+        the index in the segments list of the one containing each tensor)
+    """
+    # The indices of the plans using each constant, in increasing order.
+    users: List[List[int]] = [[] for _ in program.constant_buffer]
+    for plan_index, plan in enumerate(program.execution_plan):
+        for value in plan.values:
+            val = value.val
+            if isinstance(val, Tensor) and val.constant_buffer_idx > 0:
+                constant_users = users[val.constant_buffer_idx]
+                if not constant_users or constant_users[-1] != plan_index:
+                    constant_users.append(plan_index)
+
+    # Group the constants by their users. Constants that no plan uses, like
+    # the reserved constant 0, go into the first group.
+    groups: Dict[Tuple[int, ...], int] = {}
+    for constant_users in users:
+        if constant_users:
+            groups.setdefault(tuple(constant_users), len(groups))
+    constant_groups: List[int] = [
+        groups[tuple(constant_users)] if constant_users else 0
+        for constant_users in users
+    ]
+
+    group_buffers: List[List[Buffer]] = [[] for _ in range(max(len(groups), 1))]
+    positions: List[int] = []
+    for buffer, group in zip(program.constant_buffer, constant_groups):
+        positions.append(len(group_buffers[group]))
+        group_buffers[group].append(buffer)
+
+    segments: List[Cord] = []
+    group_offsets: List[List[int]] = []
+    for buffers in group_buffers:
+        segment_data, offsets = _extract_constant_segment(buffers, tensor_alignment)
+        segments.append(segment_data)
+        group_offsets.append(offsets)
+    constant_offsets: List[int] = [
+        group_offsets[group][position]
+        for group, position in zip(constant_groups, positions)
+    ]
+    return segments, constant_offsets, constant_groups
+
+
+def _add_tensor_strides(program: Program) -> None:
+    """Sets the strides of the static-shape tensors of the program, as implied
+    by their sizes and dim orders, so that the runtime does not compute them.
+    Mirrors dim_order_to_stride() in the runtime.
+
+    Args:
+        program: The Program to update in place.
+    """
+    for plan in program.execution_plan:
+        for value in plan.values:
+            tensor = value.val
+            if (
+                not isinstance(tensor, Tensor)
+                or tensor.shape_dynamism != TensorShapeDynamism.STATIC
+            ):
+                continue
+            sizes = tensor.sizes
+            dim_order = [int(d) for d in tensor.dim_order]
+            strides = [0] * len(sizes)
+            if dim_order:
+                strides[dim_order[-1]] = 1
+            for i in range(len(dim_order) - 2, -1, -1):
+                inner = dim_order[i + 1]
+                strides[dim_order[i]] = strides[inner] * max(sizes[inner], 1)
+            tensor.strides = strides
+
+
 def serialize_pte_binary(
     program: Program,
     *,
     extract_delegate_segments: bool = False,
     extract_constant_segment: bool = False,
+    split_constant_segment: bool = False,
+    constant_segment_codec: CompressionCodec = CompressionCodec.NONE,
+    constant_segment_block_size: int = 1024 * 1024,
     segment_alignment: int = 4096,
     constant_tensor_alignment: Optional[int] = None,
     delegate_alignment: Optional[int] = None,
+    emit_tensor_strides: bool = False,
 ) -> Cord:
     """Returns the runtime binary representation of the given Program.
 
@@ -360,6 +503,18 @@ def serialize_pte_binary(
               of each segment.
         extract_constant_segment: Whether to move the constant data from the Program
             into a separate segment.
+        split_constant_segment: Whether to split the constant data into one
+            segment per set of methods that use it, which the runtime loads
+            along with those methods rather than when loading the program.
+            Only applies if extract_constant_segment is true.
+        constant_segment_codec: If not NONE, compresses the constant segment
+            with this codec, for smaller downloads. The runtime decompresses
+            it when loading the program. Only applies if
+            extract_constant_segment is true. Not supported with
+            split_constant_segment.
+        constant_segment_block_size: The size in bytes of the blocks the
+            constant segment is compressed in. Smaller blocks compress less
+            well, but the runtime can decompress more of them in parallel.
         segment_alignment: Alignment in bytes. The starting offset of each
             segment will be aligned to this value in the output data.
         constant_tensor_alignment: The minimum alignment of tensor
@@ -367,6 +522,9 @@ def serialize_pte_binary(
         delegate_alignment: If provided, the minimum alignment of delegate data
             in the program. Must be a power of 2. If not provided, uses the
             value in the schema file.
+        emit_tensor_strides: Whether to store the strides of static-shape
+            tensors, which the runtime then uses in place rather than
+            allocating and computing them when loading methods.
     Returns:
         The serialized form of the Program, ready for execution by the runtime.
     """
@@ -382,7 +540,29 @@ def serialize_pte_binary(
     # Store extracted segment data; this may be constant data or delegate data.
     segments: List[Cord] = []
 
-    if extract_constant_segment:
+    if emit_tensor_strides:
+        _add_tensor_strides(program)
+
+    if split_constant_segment and constant_segment_codec != CompressionCodec.NONE:
+        raise ValueError("Split constant segments cannot be compressed")
+    if extract_constant_segment and split_constant_segment:
+        if len(program.constant_buffer) > 0:
+            (
+                constant_segments,
+                constant_segment_offsets,
+                constant_segment_groups,
+            ) = _extract_constant_segments_by_method(
+                program, tensor_alignment=constant_tensor_alignment
+            )
+            program.constant_segment = SubsegmentOffsets(
+                segment_index=len(segments), offsets=constant_segment_offsets
+            )
+            program.constant_segment_indices = [
+                len(segments) + group for group in constant_segment_groups
+            ]
+            program.constant_buffer = []
+            segments.extend(constant_segments)
+    elif extract_constant_segment:
         constant_segment_data, constant_segment_offsets = _extract_constant_segment(
             program.constant_buffer, tensor_alignment=constant_tensor_alignment
         )
@@ -393,6 +573,16 @@ def serialize_pte_binary(
             )
             # Clear the constant buffer, as constant data will be stored in segments.
             program.constant_buffer = []
+            if constant_segment_codec != CompressionCodec.NONE:
+                (
+                    constant_segment_data,
+                    program.constant_segment_compression,
+                ) = _compress_segment(
+                    constant_segment_data,
+                    codec=constant_segment_codec,
+                    block_size=constant_segment_block_size,
+                    alignment=constant_tensor_alignment,
+                )
             # Add to the aggregate segments cord.
             segments.append(constant_segment_data)
 
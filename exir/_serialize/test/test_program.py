@@ -27,12 +27,15 @@ from executorch.exir.schema import (
     BackendDelegateDataReference,
     BackendDelegateInlineData,
     Buffer,
+    CompressionCodec,
     ContainerMetadata,
     DataLocation,
     DataSegment,
+    EValue,
     ExecutionPlan,
     Program,
     SubsegmentOffsets,
+    TensorShapeDynamism,
 )
 from executorch.exir.tests.common import get_test_program
 
@@ -640,6 +643,137 @@ class TestProgram(unittest.TestCase):
                 constant_tensor_alignment=constant_tensor_alignment,
             )
 
+    def test_split_constant_segment(self) -> None:
+        # Create a program with two methods, sharing one of three constants.
+        program = get_test_program()
+        program.execution_plan.append(copy.deepcopy(program.execution_plan[0]))
+        program.execution_plan[1].name = "decode"
+        add_constant_data(
+            program,
+            (
+                b"",  # Constant 0 is reserved for non-constant tensors.
+                self.gen_blob_data(CONSTANT_TENSOR_ALIGNMENT + 1, b"\x10\x11\x01"),
+                self.gen_blob_data(CONSTANT_TENSOR_ALIGNMENT // 2, b"\x20\x22\x02"),
+                self.gen_blob_data(CONSTANT_TENSOR_ALIGNMENT // 2, b"\x30\x33\x03"),
+            ),
+        )
+        uses = ((1, 2), (2, 3))
+        for plan, constants in zip(program.execution_plan, uses):
+            template = plan.values[4].val
+            for constant in constants:
+                tensor = copy.deepcopy(template)
+                tensor.constant_buffer_idx = constant
+                tensor.allocation_info = None
+                plan.values.append(EValue(val=tensor))
+
+        pte_data = bytes(
+            serialize_pte_binary(
+                program,
+                extract_constant_segment=True,
+                split_constant_segment=True,
+                segment_alignment=SEGMENT_ALIGNMENT,
+                constant_tensor_alignment=CONSTANT_TENSOR_ALIGNMENT,
+            )
+        )
+        self.get_and_validate_extended_header(pte_data)
+        program_with_segments = _json_to_program(_program_flatbuffer_to_json(pte_data))
+
+        # One segment for each method, and one for the shared constant.
+        segment_table: List[DataSegment] = program_with_segments.segments
+        self.assertEqual(len(segment_table), 3)
+        # The unused constant 0 goes with the first segment.
+        self.assertEqual(program_with_segments.constant_segment_indices, [0, 0, 1, 2])
+        self.assertEqual(program_with_segments.constant_segment.offsets, [0, 0, 0, 0])
+        self.assertEqual(segment_table[0].size, CONSTANT_TENSOR_ALIGNMENT + 1)
+        self.assertEqual(segment_table[1].size, CONSTANT_TENSOR_ALIGNMENT // 2)
+        self.assertEqual(segment_table[2].size, CONSTANT_TENSOR_ALIGNMENT // 2)
+        self.assertEqual(len(program_with_segments.constant_buffer), 0)
+
+    def test_compressed_constant_segment(self) -> None:
+        try:
+            import zstandard
+        except ImportError:
+            self.skipTest("zstandard is not installed")
+
+        program = get_test_program()
+        blobs = (
+            self.gen_blob_data(CONSTANT_TENSOR_ALIGNMENT * 100, b"\x10\x11\x01"),
+            self.gen_blob_data(CONSTANT_TENSOR_ALIGNMENT * 100, b"\x20\x22\x02"),
+        )
+        add_constant_data(program, blobs)
+        block_size = CONSTANT_TENSOR_ALIGNMENT * 64
+
+        pte_data = bytes(
+            serialize_pte_binary(
+                program,
+                extract_constant_segment=True,
+                constant_segment_codec=CompressionCodec.ZSTD,
+                constant_segment_block_size=block_size,
+                segment_alignment=SEGMENT_ALIGNMENT,
+                constant_tensor_alignment=CONSTANT_TENSOR_ALIGNMENT,
+            )
+        )
+        eh = self.get_and_validate_extended_header(pte_data)
+        program_with_segments = _json_to_program(_program_flatbuffer_to_json(pte_data))
+        compression = program_with_segments.constant_segment_compression
+        self.assertEqual(compression.codec, CompressionCodec.ZSTD)
+        self.assertEqual(compression.uncompressed_size, CONSTANT_TENSOR_ALIGNMENT * 200)
+        self.assertEqual(compression.block_size, block_size)
+        self.assertEqual(compression.alignment, CONSTANT_TENSOR_ALIGNMENT)
+        # The offsets are relative to the decompressed data.
+        self.assertEqual(
+            program_with_segments.constant_segment.offsets,
+            [0, CONSTANT_TENSOR_ALIGNMENT * 100],
+        )
+
+        # Each block decompresses on its own.
+        segment = program_with_segments.segments[0]
+        self.assertLess(segment.size, compression.uncompressed_size)
+        segment_data = pte_data[
+            eh.segment_base_offset
+            + segment.offset : eh.segment_base_offset
+            + segment.offset
+            + segment.size
+        ]
+        ends = compression.block_offsets[1:] + [segment.size]
+        decompressed = b"".join(
+            zstandard.ZstdDecompressor().decompress(segment_data[begin:end])
+            for begin, end in zip(compression.block_offsets, ends)
+        )
+        self.assertEqual(decompressed, b"".join(blobs))
+
+        # Split constant segments cannot be compressed.
+        with self.assertRaises(ValueError):
+            serialize_pte_binary(
+                program,
+                extract_constant_segment=True,
+                split_constant_segment=True,
+                constant_segment_codec=CompressionCodec.ZSTD,
+            )
+
+    def test_emit_tensor_strides(self) -> None:
+        program = get_test_program()
+        plan = program.execution_plan[0]
+        channels_last = copy.deepcopy(plan.values[4].val)
+        channels_last.sizes = [2, 3, 4, 5]
+        channels_last.dim_order = [0, 2, 3, 1]
+        dynamic = copy.deepcopy(plan.values[4].val)
+        dynamic.shape_dynamism = TensorShapeDynamism.DYNAMIC_BOUND
+        plan.values.extend([EValue(val=channels_last), EValue(val=dynamic)])
+
+        pte_data = bytes(serialize_pte_binary(program, emit_tensor_strides=True))
+        deserialized = deserialize_pte_binary(pte_data)
+        values = deserialized.execution_plan[0].values
+        self.assertEqual(values[4].val.strides, [2, 1])
+        self.assertEqual(values[5].val.strides, [60, 1, 15, 3])
+        # Dynamic shape tensors compute their strides at runtime.
+        self.assertIsNone(values[6].val.strides)
+
+        # Strides are not emitted by default.
+        pte_data = bytes(serialize_pte_binary(program))
+        deserialized = deserialize_pte_binary(pte_data)
+        self.assertIsNone(deserialized.execution_plan[0].values[4].val.strides)
+
     def test_constant_segment_and_delegate_segment(self) -> None:
         # Create a program with some constant tensor data and delegate data blobs.
         program = get_test_program()
@@ -0,0 +1,167 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+"""
+Placement files record which backend each node of a model should be delegated
+to, e.g. as measured on a class of devices by
+`executorch.sdk.placement_tool`. `PlacementPartitioner` restricts an existing
+partitioner to the nodes placed on its backend, so that several partitioners
+applied in sequence produce a program tailored to that class of devices.
+"""
+
+import json
+import logging
+from collections import defaultdict
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+import torch
+
+from executorch.exir.backend.canonical_partitioners.pattern_op_partitioner import (
+    generate_partitions_from_list_of_nodes,
+)
+from executorch.exir.backend.partitioner import (
+    DelegationSpec,
+    Partitioner,
+    PartitionResult,
+)
+from executorch.exir.backend.utils import tag_constant_data
+from torch.export import ExportedProgram
+from torch.fx.passes.operator_support import OperatorSupportBase
+
+PLACEMENT_FORMAT_VERSION = 1
+
+
+@dataclass
+class Placement:
+    """
+    node_to_backend: Maps the name of a node in the Edge dialect graph to the
+        id of the backend it should be delegated to. Nodes that are missing are
+        left to the partitioners.
+    latency_ms: Optional per-backend, per-node measurements backing the
+        placement, for reference only.
+    overhead_ms: Optional per-backend time spent outside of the measured
+        nodes, e.g. moving data in and out of delegates, for reference only.
+    """
+
+    node_to_backend: Dict[str, str] = field(default_factory=dict)
+    latency_ms: Dict[str, Dict[str, float]] = field(default_factory=dict)
+    overhead_ms: Dict[str, float] = field(default_factory=dict)
+
+    def save(self, path: str) -> None:
+        with open(path, "w") as f:
+            json.dump(
+                {
+                    "version": PLACEMENT_FORMAT_VERSION,
+                    "placement": self.node_to_backend,
+                    "latency_ms": self.latency_ms,
+                    "overhead_ms": self.overhead_ms,
+                },
+                f,
+                indent=2,
+                sort_keys=True,
+            )
+
+    @staticmethod
+    def load(path: str) -> "Placement":
+        with open(path, "r") as f:
+            data = json.load(f)
+        version = data.get("version")
+        if version != PLACEMENT_FORMAT_VERSION:
+            raise RuntimeError(
+                f"Unsupported placement file version {version} in {path}, "
+                f"expected {PLACEMENT_FORMAT_VERSION}"
+            )
+        return Placement(
+            node_to_backend=data.get("placement", {}),
+            latency_ms=data.get("latency_ms", {}),
+            overhead_ms=data.get("overhead_ms", {}),
+        )
+
+
+class _IsInSet(OperatorSupportBase):
+    def __init__(self, nodes: List[torch.fx.Node]) -> None:
+        super().__init__()
+        self._nodes = set(nodes)
+
+    def is_node_supported(self, submodules, node: torch.fx.Node) -> bool:
+        return node in self._nodes
+
+
+class PlacementPartitioner(Partitioner):
+    """
+    Wraps `partitioner` so that it only delegates the nodes placed on
+    `backend_id`, or not placed at all.
+
+    The nodes the wrapped partitioner tags are filtered by the placement, then
+    grouped again into partitions, so that removing a node from the middle of
+    a partition never creates a cycle.
+
+    Args:
+        partitioner: The partitioner of the backend, used as is.
+        placement: The placement to follow.
+        backend_id: The backend id used in the placement. Defaults to the
+            backend id of each DelegationSpec the partitioner returns.
+    """
+
+    def __init__(
+        self,
+        partitioner: Partitioner,
+        placement: Placement,
+        backend_id: Optional[str] = None,
+    ) -> None:
+        super().__init__(partitioner.spec)
+        self._partitioner = partitioner
+        self._placement = placement
+        self._backend_id = backend_id
+
+    def ops_to_not_decompose(self):
+        return self._partitioner.ops_to_not_decompose()
+
+    def partition(self, exported_program: ExportedProgram) -> PartitionResult:
+        result = self._partitioner(exported_program)
+        tagged_program = result.tagged_exported_program
+
+        # Group the tagged operators by DelegationSpec, dropping the ones that
+        # are placed elsewhere.
+        nodes_by_spec: Dict[int, List[torch.fx.Node]] = defaultdict(list)
+        specs: Dict[int, DelegationSpec] = {}
+        num_dropped = 0
+        for node in tagged_program.graph_module.graph.nodes:
+            tag = node.meta.pop("delegation_tag", None)
+            if tag is None or node.op != "call_function":
+                continue
+            spec = result.partition_tags[tag]
+            backend_id = self._backend_id or spec.backend_id
+            placed_on = self._placement.node_to_backend.get(node.name, backend_id)
+            if placed_on != backend_id:
+                num_dropped += 1
+                continue
+            specs[id(spec)] = spec
+            nodes_by_spec[id(spec)].append(node)
+
+        if num_dropped > 0:
+            logging.info(
+                f"Placement moved {num_dropped} nodes away from "
+                f"{type(self._partitioner).__name__}"
+            )
+
+        partition_tags: Dict[str, DelegationSpec] = {}
+        for spec_id, nodes in nodes_by_spec.items():
+            spec = specs[spec_id]
+            partitions = generate_partitions_from_list_of_nodes(
+                tagged_program.graph_module, op_support=_IsInSet(nodes)
+            )
+            for partition in partitions:
+                tag = f"{spec.backend_id}_placed_{len(partition_tags)}"
+                for node in partition.nodes:
+                    node.meta["delegation_tag"] = tag
+                partition_tags[tag] = spec
+
+        tag_constant_data(tagged_program)
+        return PartitionResult(
+            tagged_exported_program=tagged_program, partition_tags=partition_tags
+        )
@@ -11,6 +11,7 @@ from executorch.exir.dynamic_shape import DynamicMemoryPlanningMode
 from executorch.exir.pass_manager import PassType
 from executorch.exir.passes import MemoryPlanningPass, ToOutVarPass
 from executorch.exir.passes.sym_shape_eval_pass import HintBasedSymShapeEvalPass
+from executorch.exir.schema import CompressionCodec
 from executorch.exir.tracer import ExirDynamoConfig
 from torch.fx._compatibility import compatibility
 
@@ -68,6 +69,18 @@ class ExecutorchBackendConfig:
     # large constant data.
     extract_constant_segment: bool = True
 
+    # Whether to split the extracted constants into one segment per set of
+    # methods that use them, so that the runtime only loads the constants of
+    # the methods it loads, and can free them along with those methods.
+    split_constant_segment: bool = False
+
+    # If not NONE, compresses the extracted constant segment with this codec,
+    # in independently compressed blocks of constant_segment_block_size bytes
+    # that the runtime decompresses in parallel. Requires that the runtime
+    # loads the program with Program::experimental_load_with_decompressor().
+    constant_segment_codec: CompressionCodec = CompressionCodec.NONE
+    constant_segment_block_size: int = 1024 * 1024
+
     # When extracting segments, the starting offset of each segment will be
     # aligned to this value (in bytes). Must be a power of two.
     segment_alignment: int = 4096
@@ -79,8 +92,18 @@ class ExecutorchBackendConfig:
     # If provided, the minimum alignment of delegate data in the program. Must
     # be a power of 2. If not provided, uses the value in the schema file.
     delegate_alignment: Optional[int] = None
+
+    # Whether to store the strides of static-shape tensors in the program, so
+    # that the runtime uses them in place instead of allocating and computing
+    # them when loading methods.
+    emit_tensor_strides: bool = False
     sym_shape_eval_pass: PassType = HintBasedSymShapeEvalPass()
 
     # If set to true, view_copy operations will be converted to lightweight
     # view operations in the ET runtime
     remove_view_copy: bool = True
+
+    # Maps the fully qualified names of parameters and buffers to names that the
+    # runtime provides their data by when loading methods, e.g. the names of the
+    # tensors of a GGUF file. Their data is not stored in the program.
+    external_constants: Optional[Dict[str, str]] = None
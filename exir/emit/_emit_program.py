@@ -79,6 +79,7 @@ def emit_program(
     methods: Union[ExportedProgram, Dict[str, ExportedProgram]],
     emit_stacktrace: bool = False,
     prim_getters: Optional[Dict[str, Any]] = None,
+    external_constants: Optional[Dict[str, str]] = None,
 ) -> EmitterOutput:
     """
     Given a exported program, it returns the program in the format
@@ -90,6 +91,9 @@ def emit_program(
             ExportedPrograms.
         emit_stacktrace: Flag to enable emission of a stacktrace for each
            instruction for debugging purposes
+        external_constants: Maps the fully qualified names of parameters and
+           buffers to the names the runtime provides their data by when loading
+           methods. Their data is not stored in the program.
 
     Return:
         The program in a Python class which mimics the flatbuffer schema
@@ -112,7 +116,7 @@ def emit_program(
     plans = []
     debug_handle_map = {}
     method_to_delegate_debug_id_map = {}
-    program_state = _ProgramState()
+    program_state = _ProgramState(external_constants=external_constants or {})
 
     # emit each entry point in order according to name.
     for name, exported_program in sorted(methods.items()):
@@ -115,6 +115,9 @@ class _ProgramState:
     # Delegate data stored directly in the flatbuffer. Pointed to by BackendDelegateDataReference,
     # and should be copied to Program.backend_delegate_data.
     backend_delegate_data: List[BackendDelegateInlineData] = field(default_factory=list)
+    # Maps the fqns of constants whose data the runtime provides when loading
+    # methods, instead of storing it in the program, to the names it provides them by.
+    external_constants: Dict[str, str] = field(default_factory=dict)
 
 
 @dataclass
@@ -643,7 +646,7 @@ class _Emitter(torch.fx.Interpreter):
             iteration index select_copy_tensor = torch.ops.aten.select(arg0_1, 0, iteration_index)
             add_tensor = torch.ops.aten.add.Tensor(select_copy_tensor, arg1_1);  arg0_1 = arg1_1 =
             None output_of_map = torch.ops.executorch.prim.et_copy_index(output_of_map, add_tensor,
-            iteration_index) iteration_index = torch.ops.executorch.prim.add.int(iteration_index, 1,
+            iteration_index, sym_size) iteration_index = torch.ops.executorch.prim.add.int(iteration_index, 1,
             iteration_index) done_bool = torch.ops.executorch.prim.eq.int(iteration_index, sym_size,
             done_bool) # Emitter inserts a instruction here, if done_bool == False jump to
             selcect_copy op # if not continue. return add_tensor
@@ -750,11 +753,13 @@ class _Emitter(torch.fx.Interpreter):
         )
 
         # Here we call the custom op, specially added for the map operator. The output of this
-        # iteration will be appended to the accumulator tensor that we are maintaining. This
-        # accumulator tensor is the actual output of the map submodule.
+        # iteration will be written to its slice of the accumulator tensor that we are maintaining.
+        # This accumulator tensor is the actual output of the map submodule. Passing the number of
+        # iterations lets the op size the accumulator once on the first iteration, instead of
+        # resizing it on every one.
         op_index, op = self._get_operator(
             name="executorch_prim::et_copy_index",
-            overload="tensor",
+            overload="sized",
         )
         kernel = Instruction(
             KernelCall(
@@ -763,6 +768,7 @@ class _Emitter(torch.fx.Interpreter):
                     subemitter_binding_output_values[0].id,
                     map_emitter.concrete_output_ids[0].id,
                     iter_idx.id,
+                    sym_size.id,
                 ],
             )
         )
@@ -1542,6 +1548,12 @@ class _TopLevelEmitter(_Emitter):
             # User inputs and mutable buffers are not constants, other buffers or parameters are.
             spec.const = not (is_user_input or is_mutable_buffer)
 
+            if spec.const and fqn in self.program_state.external_constants:
+                # Only the name is stored; the runtime provides the data.
+                tensor = make_tensor_value(0, None, spec)
+                tensor.constant_name = self.program_state.external_constants.get(fqn)
+                return self._emit_evalue(EValue(tensor))
+
         evalue = (
             self._tensor_spec_to_evalue(spec)
             if isinstance(spec, TensorSpec)
@@ -1599,5 +1611,7 @@ class _TopLevelEmitter(_Emitter):
             non_const_buffer_sizes=typing.cast(
                 List[int], self.module.meta["non_const_buffer_sizes"]
             ),
+            # Only set when the memory_planning_pass was given memory tiers.
+            non_const_buffer_tiers=self.module.meta.get("non_const_buffer_tiers"),
             container_meta_type=self.container_meta_type,
         )
@@ -679,6 +679,12 @@ class TestEmit(unittest.TestCase):
             ].name,
             "executorch_prim::et_copy_index",
         )
+        # The number of iterations is passed so that the accumulator is sized once.
+        copy_index = (
+            program.execution_plan[0].chains[0].instructions[-5]  # pyre-ignore[16]
+        )
+        self.assertEqual(op_table[copy_index.instr_args.op_index].overload, "sized")
+        self.assertEqual(len(copy_index.instr_args.args), 4)
         self.assertEqual(
             op_table[
                 program.execution_plan[0]  # pyre-ignore[16]
@@ -1535,3 +1541,35 @@ class TestEmit(unittest.TestCase):
         executorch_module = _load_for_executorch_from_buffer(model.buffer)
         self.assertEqual(executorch_module(torch.zeros(1))[0], torch.zeros(1))
         self.assertEqual(executorch_module(torch.zeros(1))[0], torch.zeros(1) + 1)
+
+    def test_external_constants(self) -> None:
+        class Linear(nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.linear = nn.Linear(4, 2)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        program = (
+            to_edge(export(Linear(), (torch.ones(1, 4),)))
+            .to_executorch(
+                config=ExecutorchBackendConfig(
+                    external_constants={"linear.weight": "blk.0.weight"}
+                )
+            )
+            ._emitter_output.program
+        )
+        tensors = [
+            value.val
+            for value in program.execution_plan[0].values
+            if isinstance(value.val, Tensor)
+        ]
+        named = [t for t in tensors if t.constant_name is not None]
+        self.assertEqual(len(named), 1)
+        self.assertEqual(named[0].constant_name, "blk.0.weight")
+        self.assertEqual(named[0].constant_buffer_idx, 0)
+        self.assertIsNone(named[0].allocation_info)
+        # Only the bias is stored in the program.
+        self.assertEqual(len(program.constant_buffer), 2)
+        self.assertEqual(len(program.constant_buffer[1].storage), 8)
@@ -35,6 +35,39 @@ from torch.utils._pytree import tree_flatten
 
 REGISTERED_ALGOS: Dict[str, Callable[..., List[int]]] = {}
 
+# Out-variant ops whose kernels stay correct when `out` shares storage with one
+# of the listed tensor arguments of the same shape and dtype, keyed by
+# (qualified op name, overload name). The kernels read each input element
+# before writing the corresponding output element.
+INPLACE_CAPABLE_OPS: Dict[Tuple[str, str], Tuple[str, ...]] = {}
+
+
+def register_inplace_capable_op(
+    qualified_opname: str, overload: str, arg_names: Iterable[str]
+) -> None:
+    """
+    Allow the memory planner to place the output of the out variant
+    `qualified_opname.overload` in the storage of any of `arg_names` whose last
+    use is that op. Backends and custom ops can register their own kernels.
+    """
+    INPLACE_CAPABLE_OPS[(qualified_opname, overload)] = tuple(arg_names)
+
+
+for _opname in ("aten::add", "aten::sub", "aten::mul", "aten::div"):
+    register_inplace_capable_op(_opname, "out", ("self", "other"))
+    register_inplace_capable_op(_opname, "Scalar_out", ("self",))
+for _opname in (
+    "aten::abs",
+    "aten::clamp",
+    "aten::exp",
+    "aten::hardtanh",
+    "aten::neg",
+    "aten::relu",
+    "aten::sigmoid",
+    "aten::tanh",
+):
+    register_inplace_capable_op(_opname, "out", ("self",))
+
 
 class Verifier:
     """
@@ -147,6 +180,10 @@ class Verifier:
                 dedup=True,
             )
         )
+        # Outputs planned in place of an input live within that input's
+        # extended lifetime, so checking the input covers them.
+        inplace_specs = getattr(self.graph_module, "inplace_out_specs", {})
+        all_specs = [spec for spec in all_specs if spec not in inplace_specs]
 
         for lhs_spec_idx, lhs_spec in enumerate(all_specs):
             for rhs_spec in all_specs[lhs_spec_idx + 1 :]:
@@ -554,6 +591,230 @@ def get_node_tensor_specs(
         ]
 
 
+def _get_inplace_source(
+    node: torch.fx.Node,
+    out_spec: TensorSpec,
+    last_use: Dict[TensorSpec, int],
+    node_idx: int,
+    excluded: Set[TensorSpec],
+) -> Optional[TensorSpec]:
+    """
+    Return the spec of an argument of the out-var node `node` whose storage
+    `out_spec` can take over, or None if there is none.
+    """
+    target = typing.cast(torch._ops.OpOverload, node.target)
+    arg_names = INPLACE_CAPABLE_OPS.get(
+        (target._schema.name, target._schema.overload_name), ()
+    )
+    args = dict(zip((arg.name for arg in target._schema.arguments), node.args))
+    args.update(node.kwargs)
+    for arg_name in arg_names:
+        arg = args.get(arg_name)
+        # Views are planned through their base, whose shape may differ.
+        if (
+            not isinstance(arg, Node)
+            or arg.op != "call_function"
+            or arg.target == memory.view
+        ):
+            continue
+        spec = arg.meta.get("spec")
+        if (
+            isinstance(spec, TensorSpec)
+            and spec not in excluded
+            and not spec.const
+            and last_use.get(spec) == node_idx
+            and spec.shape_dynamism == TensorShapeDynamism.STATIC
+            and spec.shape == out_spec.shape
+            and spec.dtype == out_spec.dtype
+            and spec.dim_order == out_spec.dim_order
+            and spec.mem_id == out_spec.mem_id
+        ):
+            return spec
+    return None
+
+
+def plan_inplace_outputs(
+    graph_module: torch.fx.GraphModule,
+    graph_signature: Optional[ExportGraphSignature] = None,
+) -> Dict[TensorSpec, TensorSpec]:
+    r"""
+    Pair the output of each in-place capable op in INPLACE_CAPABLE_OPS with a
+    same-shaped input whose last use is that op, and extend the input's
+    lifetime over the output's. Returns a map from each paired output spec to
+    the spec whose storage it should share; chains of in-place ops all map to
+    the first tensor of the chain.
+
+    Must be called after update_all_tensors_lifetime. Graph inputs and outputs,
+    constants and dynamically shaped tensors are never paired.
+    """
+    nodes = list(graph_module.graph.nodes)
+    excluded = get_graph_input_tensors(nodes, graph_signature)
+    excluded |= get_graph_output_tensors(nodes)
+    last_use: Dict[TensorSpec, int] = {}
+    for node in nodes:
+        for spec in get_node_tensor_specs(node):
+            if spec.lifetime[1] is not None:
+                last_use[spec] = spec.lifetime[1]
+
+    shared: Dict[TensorSpec, TensorSpec] = {}
+    for node_idx, node in enumerate(nodes):
+        if not _is_out_var_node(node):
+            continue
+        out_spec = node.meta.get("spec")
+        if (
+            not isinstance(out_spec, TensorSpec)
+            or out_spec in excluded
+            or out_spec.const
+            or out_spec.shape_dynamism != TensorShapeDynamism.STATIC
+        ):
+            continue
+        source = _get_inplace_source(node, out_spec, last_use, node_idx, excluded)
+        if source is None:
+            continue
+        root = shared.get(source, source)
+        shared[out_spec] = root
+        update_tensor_lifetime(root, out_spec.lifetime[1])
+    return shared
+
+
+@dataclass
+class MemoryTier:
+    """
+    A region of target memory that memory-planned tensors can be placed in,
+    e.g. a small, fast SRAM/TCM or a large DRAM. Given a list of tiers ordered
+    fastest first, the planner gives tier i its own buffer with mem_id i + 1
+    and records the tier names in the program, so that runners can back each
+    buffer with the right region via MethodMeta::memory_planned_buffer_tier().
+    """
+
+    name: str
+    # The bytes the tier has for planned tensors, or None if unbounded.
+    capacity: Optional[int] = None
+
+
+def _count_tensor_uses(graph_module: torch.fx.GraphModule) -> Dict[TensorSpec, int]:
+    """Returns the number of nodes that read or write each tensor."""
+    uses: Dict[TensorSpec, int] = defaultdict(int)
+    for node in graph_module.graph.nodes:
+        node_specs = set()
+        args = itertools.chain([node], node.args, node.kwargs.values())
+        for arg in filter_nodes(args):
+            for spec in get_node_tensor_specs(arg):
+                if isinstance(spec, TensorSpec):
+                    node_specs.add(spec)
+        for spec in node_specs:
+            uses[spec] += 1
+    return uses
+
+
+def assign_memory_tiers(
+    graph_module: torch.fx.GraphModule,
+    memory_tiers: List[MemoryTier],
+    alignment: int,
+    graph_signature: Optional[ExportGraphSignature] = None,
+    alloc_graph_input: bool = True,
+    alloc_graph_output: bool = True,
+) -> Dict[int, List[TensorSpec]]:
+    """
+    Set the mem_id of each tensor to be planned to that of a memory tier. The
+    tensors with the most uses per byte go to the fastest tier whose capacity
+    their lifetime still fits in, and the rest to the last tier. Tensors that
+    already have a mem_id keep it.
+
+    Must be called after update_all_tensors_lifetime. Returns the tensors
+    placed in each tier but the last, keyed by mem_id and hottest first.
+    """
+    if not memory_tiers:
+        raise ExportError(
+            ExportErrorType.INVALID_INPUT_TYPE, "memory_tiers must not be empty"
+        )
+    uses = _count_tensor_uses(graph_module)
+
+    def heat(spec: TensorSpec) -> Tuple[float, int]:
+        return (-uses[spec] / max(spec.allocated_memory, 1), spec.allocated_memory)
+
+    inplace_specs = getattr(graph_module, "inplace_out_specs", {})
+    specs = [
+        spec
+        for spec in collect_specs_from_nodes(
+            graph_module.graph.nodes,
+            graph_signature,
+            do_assertion=False,
+            ignore_graph_input=not alloc_graph_input,
+            ignore_graph_output=not alloc_graph_output,
+        )
+        if spec not in inplace_specs and spec.mem_id is None
+    ]
+    for spec in specs:
+        spec.realign(alignment)
+    specs.sort(key=heat)
+
+    # Buffers of control flow submodules are appended to those of the
+    # enclosing graph, which may already fill the fast tiers.
+    is_submodule = hasattr(graph_module, "input_mem_buffer_sizes")
+    num_nodes = len(graph_module.graph.nodes)
+    tier_specs: Dict[int, List[TensorSpec]] = {}
+    live_bytes = [[0] * num_nodes for _ in memory_tiers[:-1]]
+    for spec in specs:
+        spec.mem_id = len(memory_tiers)
+        start, end = spec.lifetime
+        if is_submodule or start is None or end is None:
+            continue
+        for tier_idx, tier in enumerate(memory_tiers[:-1]):
+            live = live_bytes[tier_idx]
+            peak = max(live[start : end + 1])
+            if tier.capacity is not None and (
+                peak + spec.allocated_memory > tier.capacity
+            ):
+                continue
+            for i in range(start, end + 1):
+                live[i] += spec.allocated_memory
+            spec.mem_id = tier_idx + 1
+            tier_specs.setdefault(spec.mem_id, []).append(spec)
+            break
+    return tier_specs
+
+
+def _plan_memory_tiers(
+    run_algo: Callable[[], List[int]],
+    memory_tiers: List[MemoryTier],
+    tier_specs: Dict[int, List[TensorSpec]],
+) -> List[int]:
+    """
+    Run the planning algo until every tier fits its capacity. Storage reuse
+    by the algo can leave a tier larger than the peak of its live tensors, in
+    which case its coldest tensor moves to the next tier.
+    """
+    while True:
+        bufsizes = run_algo()
+        bufsizes = bufsizes + [0] * (len(memory_tiers) + 1 - len(bufsizes))
+        overflowing = [
+            mem_id
+            for mem_id, tier in enumerate(memory_tiers[:-1], start=1)
+            if tier.capacity is not None and bufsizes[mem_id] > tier.capacity
+        ]
+        if not overflowing:
+            break
+        mem_id = overflowing[0]
+        spec = tier_specs[mem_id].pop()
+        spec.mem_id = mem_id + 1
+        if spec.mem_id < len(memory_tiers):
+            # It was admitted to a faster tier, so it is hotter than the
+            # tensors that went to this one.
+            tier_specs.setdefault(spec.mem_id, []).insert(0, spec)
+
+    last_tier = memory_tiers[-1]
+    if last_tier.capacity is not None and (
+        bufsizes[len(memory_tiers)] > last_tier.capacity
+    ):
+        raise ExportError(
+            ExportErrorType.NOT_SUPPORTED,
+            f"Memory tier {last_tier.name} needs {bufsizes[len(memory_tiers)]} "
+            f"bytes but has {last_tier.capacity}",
+        )
+    return bufsizes
+
+
 @register_algo
 def greedy(
     graph_module: torch.fx.GraphModule,
@@ -567,6 +828,7 @@ def greedy(
     # Don't do assertion in collect_specs_from_nodes if we have already encountered
     # and ignored some to_out_variant errors.
     do_assertion = not getattr(graph_module, "encounter_to_out_var_failure", False)
+    inplace_specs = getattr(graph_module, "inplace_out_specs", {})
     # For each tensor, pick the available shared object with closest size to
     # the tensor. If there are no available shared object left, create a new
     # one.
@@ -577,6 +839,8 @@ def greedy(
         ignore_graph_input=not alloc_graph_input,
         ignore_graph_output=not alloc_graph_output,
     ):
+        if spec in inplace_specs:
+            continue
         if spec.mem_id is None:
             spec.mem_id = 1
         spec.realign(alignment)
@@ -631,12 +895,15 @@ def naive(
         bufsizes = [0, 0]
 
     bufsizes = typing.cast(List[int], bufsizes)
+    inplace_specs = getattr(graph_module, "inplace_out_specs", {})
     for spec in collect_specs_from_nodes(
         graph_module.graph.nodes,
         graph_signature,
         ignore_graph_input=not alloc_graph_input,
         ignore_graph_output=not alloc_graph_output,
     ):
+        if spec in inplace_specs:
+            continue
         # assume a single memory layer which has mem_id 1
         if spec.mem_id is None:
             spec.mem_id = 1
@@ -747,10 +1014,19 @@ def apply_algo(
     graph_signature: Optional[ExportGraphSignature] = None,
     alloc_graph_input: bool = True,
     alloc_graph_output: bool = True,
+    alloc_inplace_outputs: bool = False,
+    memory_tiers: Optional[List[MemoryTier]] = None,
 ) -> List[int]:
     """
     Recursively apply algo to graph_module and its submodules for control flow.
 
+    If alloc_inplace_outputs is True, the outputs of ops in INPLACE_CAPABLE_OPS
+    reuse the storage of an input whose last use is that op (see
+    plan_inplace_outputs) instead of being allocated by algo.
+
+    If memory_tiers is set, the tensors are spread over one buffer per tier,
+    see assign_memory_tiers. Tensors of submodules go to the last tier.
+
     Quite naively right now since it does not take the following optimizations
     into considerating:
     1. for conditional structure, true branch and false true does not overlap
@@ -760,9 +1036,39 @@ def apply_algo(
     TODO: make these optimizations once we have some baseline working.
     """
     specs = update_all_tensors_lifetime(graph_module, graph_signature)
-    bufsizes: List[int] = algo(
-        graph_module, alignment, graph_signature, alloc_graph_input, alloc_graph_output
+    inplace_specs = (
+        plan_inplace_outputs(graph_module, graph_signature)
+        if alloc_inplace_outputs
+        else {}
     )
+    # Read by the algos and the Verifier to skip the paired outputs.
+    graph_module.inplace_out_specs = inplace_specs
+
+    def run_algo() -> List[int]:
+        return algo(
+            graph_module,
+            alignment,
+            graph_signature,
+            alloc_graph_input,
+            alloc_graph_output,
+        )
+
+    if memory_tiers:
+        tier_specs = assign_memory_tiers(
+            graph_module,
+            memory_tiers,
+            alignment,
+            graph_signature,
+            alloc_graph_input,
+            alloc_graph_output,
+        )
+        bufsizes = _plan_memory_tiers(run_algo, memory_tiers, tier_specs)
+    else:
+        bufsizes = run_algo()
+    for out_spec, spec in inplace_specs.items():
+        out_spec.mem_id = spec.mem_id
+        out_spec.mem_obj_id = spec.mem_obj_id
+        out_spec.mem_offset = spec.mem_offset
     insert_calls_to_free(graph_module, specs)
 
     def handle_submodule(submodule_nd: torch.fx.Node) -> None:
@@ -779,6 +1085,8 @@ def apply_algo(
             graph_signature,
             alloc_graph_input=False,
             alloc_graph_output=True,
+            alloc_inplace_outputs=alloc_inplace_outputs,
+            memory_tiers=memory_tiers,
         )
         submodule.meta.update({"non_const_buffer_sizes": bufsizes})
 
@@ -795,5 +1103,10 @@ def apply_algo(
         handle_submodule(typing.cast(torch.fx.Node, map_node.args[0]))
 
     graph_module.meta.update({"non_const_buffer_sizes": bufsizes})
+    if memory_tiers:
+        # Entry 0 is reserved, as in non_const_buffer_sizes.
+        graph_module.meta.update(
+            {"non_const_buffer_tiers": [""] + [tier.name for tier in memory_tiers]}
+        )
 
     return bufsizes
@@ -6,11 +6,13 @@
 
 import copy
 import logging
+from typing import Optional, Tuple
 
 import torch
+from executorch.exir.dialects._ops import ops as exir_ops
 from executorch.exir.dialects.edge._ops import EdgeOpOverload
 from executorch.exir.dim_order_utils import get_dim_order
-from executorch.exir.pass_base import ExportPass, ProxyValue
+from executorch.exir.pass_base import ExportPass, PassResult, ProxyValue
 from executorch.exir.passes.dim_order_ops_registry import DimOrderOpsMap
 
 logger = logging.getLogger(__file__)
@@ -61,3 +63,56 @@ class MemoryFormatOpsPass(ExportPass):
             nkwargs,
             meta,
         )
+
+
+def _is_dim_order_copy(node: torch.fx.Node) -> bool:
+    return (
+        node.op == "call_function"
+        and node.target == exir_ops.edge.dim_order_ops._to_dim_order_copy.default
+    )
+
+
+def _layout(node: torch.fx.Node) -> Optional[Tuple[torch.dtype, Tuple[int, ...]]]:
+    val = node.meta.get("val")
+    if not isinstance(val, torch.Tensor):
+        return None
+    return val.dtype, tuple(val.dim_order())
+
+
+class RemoveRedundantDimOrderCopiesPass(ExportPass):
+    """
+    Removes the _to_dim_order_copy ops that produce a tensor with the dim order
+    and dtype of one of their inputs, e.g. the pairs converting a tensor to
+    channels last and back, which are left behind when channels-last regions of
+    a model are stitched together. Users of such a copy read the earlier tensor
+    instead, and copies that end up unused are removed.
+
+    Copies that are outputs of the graph are kept, so that the graph never
+    returns one of its inputs.
+    """
+
+    def call(self, graph_module: torch.fx.GraphModule) -> PassResult:
+        modified = False
+        for node in graph_module.graph.nodes:
+            if not _is_dim_order_copy(node) or any(
+                user.op == "output" for user in node.users
+            ):
+                continue
+            layout = _layout(node)
+            if layout is None:
+                continue
+            # Walk up the chain of copies for a tensor with the same layout.
+            source = node.args[0]
+            while isinstance(source, torch.fx.Node):
+                if _layout(source) == layout:
+                    node.replace_all_uses_with(source)
+                    modified = True
+                    break
+                if not _is_dim_order_copy(source):
+                    break
+                source = source.args[0]
+
+        if modified:
+            graph_module.graph.eliminate_dead_code()
+            graph_module.recompile()
+        return PassResult(graph_module, modified)
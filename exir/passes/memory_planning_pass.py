@@ -6,7 +6,7 @@
 
 import logging
 import warnings
-from typing import Optional
+from typing import List, Optional
 
 import torch
 from executorch.exir.error import internal_assert
@@ -16,6 +16,7 @@ from executorch.exir.memory_planning import (
     apply_algo,
     get_algo,
     get_node_tensor_specs,
+    MemoryTier,
     Verifier,
 )
 from executorch.exir.operator.convert import get_out_args_from_opoverload
@@ -32,18 +33,31 @@ class MemoryPlanningPass(PassBase):
         alloc_graph_input: bool = True,
         alloc_graph_output: bool = True,
         alignment: int = ALIGNMENT,
+        alloc_inplace_outputs: bool = False,
+        memory_tiers: Optional[List[MemoryTier]] = None,
     ) -> None:
         r"""
         alloc_graph_input/alloc_graph_output will have 4 different combinations
         to control if the memory planning algorithm need allocate memory for
         the graph input/output. The default behavior is the algorithm will allocate
         memory for both graph input and output.
+
+        alloc_inplace_outputs lets the output of an in-place capable elementwise
+        op (see INPLACE_CAPABLE_OPS) share the storage of an input that is not
+        used afterwards.
+
+        memory_tiers describes the memory regions of the target, fastest first,
+        e.g. [MemoryTier("sram", 256 * 1024), MemoryTier("dram")]. The most used
+        tensors per byte are planned into the fast tiers, as far as their
+        capacities allow, and each tier gets its own buffer.
         """
         self.memory_planning_algo = memory_planning_algo
         self.allow_lifetime_and_storage_overlap = allow_lifetime_and_storage_overlap
         self.alloc_graph_input = alloc_graph_input
         self.alloc_graph_output = alloc_graph_output
         self.alignment = alignment
+        self.alloc_inplace_outputs = alloc_inplace_outputs
+        self.memory_tiers = memory_tiers
 
     def _set_alloc_node_spec(self, graph_module: torch.fx.GraphModule) -> None:
         """
@@ -109,6 +123,8 @@ class MemoryPlanningPass(PassBase):
             graph_signature,
             self.alloc_graph_input,
             self.alloc_graph_output,
+            self.alloc_inplace_outputs,
+            self.memory_tiers,
         )
 
         # TODO: make the verifier do the work recursively to handle
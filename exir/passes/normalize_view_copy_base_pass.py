@@ -7,6 +7,7 @@
 # pyre-strict
 
 import logging
+from typing import List, Optional
 
 import torch
 
@@ -21,10 +22,55 @@ def _is_view_copy(node: torch.fx.Node) -> bool:
     )
 
 
+# Copies that only change the shape of a contiguous tensor, and are therefore
+# equivalent to a view_copy to their output shape.
+_SHAPE_ONLY_COPY_OPS = {
+    torch.ops.aten.squeeze_copy.default: torch.ops.aten.view_copy.default,
+    torch.ops.aten.squeeze_copy.dim: torch.ops.aten.view_copy.default,
+    torch.ops.aten.squeeze_copy.dims: torch.ops.aten.view_copy.default,
+    torch.ops.aten.unsqueeze_copy.default: torch.ops.aten.view_copy.default,
+    ops.edge.aten.squeeze_copy.default: ops.edge.aten.view_copy.default,
+    ops.edge.aten.squeeze_copy.dim: ops.edge.aten.view_copy.default,
+    ops.edge.aten.squeeze_copy.dims: ops.edge.aten.view_copy.default,
+    ops.edge.aten.unsqueeze_copy.default: ops.edge.aten.view_copy.default,
+}
+
+
+def _view_shape_of_shape_only_copy(node: torch.fx.Node) -> Optional[List[int]]:
+    """
+    Returns the shape a squeeze_copy or unsqueeze_copy node produces if it can
+    be replaced by a view_copy to that shape, or None.
+    """
+    if node.op != "call_function" or node.target not in _SHAPE_ONLY_COPY_OPS:
+        return None
+    # Like view_copy, keep the copy when it is an output of the graph.
+    if any(u.op == "output" for u in node.users):
+        return None
+    base = node.args[0]
+    if not isinstance(base, torch.fx.Node):
+        return None
+    val = node.meta.get("val")
+    base_val = base.meta.get("val")
+    if not isinstance(val, torch.Tensor) or not isinstance(base_val, torch.Tensor):
+        return None
+    # A view of a tensor in another dim order would reorder its elements.
+    if not base_val.is_contiguous():
+        return None
+    shape = list(val.shape)
+    # The view sizes are emitted as a constant list.
+    if not all(isinstance(s, int) for s in shape):
+        return None
+    return shape
+
+
 class NormalizeViewCopyBasePass(PassBase):
     """
     Point each view_copy to the first upstream non-view.
 
+    squeeze_copy and unsqueeze_copy nodes with a static shape and a contiguous
+    base are first rewritten as view_copy nodes, so that they become views as
+    well and do not copy their input.
+
     After this pass, the base of each view_copy is not a view_copy.
 
     When combined with dead-code elimination, this pass removes redundant
@@ -37,6 +83,13 @@ class NormalizeViewCopyBasePass(PassBase):
             if not isinstance(module, torch.fx.GraphModule):
                 continue
             for node in module.graph.nodes:
+                shape = _view_shape_of_shape_only_copy(node)
+                if shape is not None:
+                    node.target = _SHAPE_ONLY_COPY_OPS[node.target]
+                    node.args = (node.args[0], shape)
+                    node.kwargs = {}
+                    n_updated += 1
+
                 if _is_view_copy(node):
                     base, size = node.args
                     if _is_view_copy(base):
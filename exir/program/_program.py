@@ -29,6 +29,7 @@ from executorch.exir.passes import (
     EdgeToBackendOpsPass,
     MemoryFormatOpsPass,
     OpReplacePass,
+    RemoveRedundantDimOrderCopiesPass,
 )
 from executorch.exir.passes.insert_write_back_for_buffers_pass import (
     insert_write_back_for_buffers_pass,
@@ -610,6 +611,9 @@ def _to_edge(ep, config: EdgeCompileConfig) -> "ExirExportedProgram":
             new_gm_res = MemoryFormatOpsPass()(new_gm)
             assert new_gm_res is not None
             new_gm = new_gm_res.graph_module
+            new_gm_res = RemoveRedundantDimOrderCopiesPass()(new_gm)
+            assert new_gm_res is not None
+            new_gm = new_gm_res.graph_module
 
     for p in post_op_replace_passes:
         new_gm_res = p(new_gm)
@@ -657,6 +661,9 @@ def pre_memory_planning_passes(config: ExecutorchBackendConfig) -> List[PassType
 def edge_to_executorch_passes(config: ExecutorchBackendConfig) -> List[PassType]:
     passes: List[PassType] = [
         *config.passes,
+        # Backends may leave pairs of dim order conversions around the nodes
+        # they did not take.
+        RemoveRedundantDimOrderCopiesPass(),
         SpecPropPass(),
         # ExecuTorch backend ops are unable to handle unbacked symints. So after
         # this pass, passes cannot be Interpreter-based, because it will fail if
@@ -693,6 +700,7 @@ def _generate_edge_program(
         passes.append(OpReplacePass())
         if not config._skip_dim_order:
             passes.append(MemoryFormatOpsPass())
+            passes.append(RemoveRedundantDimOrderCopiesPass())
 
     gm = program.graph_module
     for p in passes:
@@ -1279,6 +1287,7 @@ class ExecutorchProgramManager:
             self._execution_programs,
             backend_config.emit_stacktrace,
             self._config_methods,
+            backend_config.external_constants,
         )
 
         # Serialize emitter output, ready to be written to a file.
@@ -1286,9 +1295,13 @@ class ExecutorchProgramManager:
             program=self._emitter_output.program,
             extract_delegate_segments=backend_config.extract_delegate_segments,
             extract_constant_segment=backend_config.extract_constant_segment,
+            split_constant_segment=backend_config.split_constant_segment,
+            constant_segment_codec=backend_config.constant_segment_codec,
+            constant_segment_block_size=backend_config.constant_segment_block_size,
             segment_alignment=backend_config.segment_alignment,
             constant_tensor_alignment=backend_config.constant_tensor_alignment,
             delegate_alignment=backend_config.delegate_alignment,
+            emit_tensor_strides=backend_config.emit_tensor_strides,
         )
         self._buffer: Optional[bytes] = None
 
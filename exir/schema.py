@@ -56,6 +56,8 @@ class Tensor:
 
     # check schema.fbs for explanations
     shape_dynamism: TensorShapeDynamism
+    strides: Optional[List[int]] = None
+    constant_name: Optional[str] = None
 
 
 @dataclass
@@ -243,6 +245,9 @@ class ExecutionPlan:
     # Runtime should use the len(constant_buffer) as the ground truch of
     # constant memory buffer size, and ignore non_const_buffer_sizes[0].
     non_const_buffer_sizes: List[int]
+    # Names of the memory tiers that the non_const_buffer_sizes entries were
+    # planned for, with an unused entry 0. None if planned without tiers.
+    non_const_buffer_tiers: Optional[List[str]] = None
 
 
 @dataclass
@@ -257,6 +262,21 @@ class SubsegmentOffsets:
     offsets: List[int]
 
 
+class CompressionCodec(IntEnum):
+    NONE = 0
+    ZSTD = 1
+    LZ4 = 2
+
+
+@dataclass
+class SegmentCompression:
+    codec: CompressionCodec
+    uncompressed_size: int
+    block_size: int
+    block_offsets: List[int]
+    alignment: int
+
+
 @dataclass
 class Program:
     version: int
@@ -265,3 +285,5 @@ class Program:
     backend_delegate_data: List[BackendDelegateInlineData]
     segments: List[DataSegment]
     constant_segment: SubsegmentOffsets
+    constant_segment_indices: Optional[List[int]] = None
+    constant_segment_compression: Optional[SegmentCompression] = None
@@ -55,6 +55,20 @@ class PropagateToCopyChannalsLastModule(torch.nn.Module):
         return t1 * t2
 
 
+class RoundTripChannelsLastModule(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+
+    def forward(self, x: torch.Tensor) -> torch.Tensor:
+        t1 = x.to(memory_format=torch.channels_last)
+        t2 = t1.to(memory_format=torch.contiguous_format)
+        t3 = t2 + 1
+        # Already channels last, and kept as it is an output.
+        return t3.to(memory_format=torch.channels_last).to(
+            memory_format=torch.channels_last
+        )
+
+
 class TestMemoryFormatOpsPass(unittest.TestCase):
     def memory_format_test_runner(self, test_set: MemoryFormatTestSet):
         aten_op_str = "torch.ops.aten._to_copy.default"
@@ -215,3 +229,20 @@ class TestMemoryFormatOpsPass(unittest.TestCase):
                 is_aten_mode=True,
             )
         )
+
+    def test_redundant_dim_order_copies_removed(self) -> None:
+        edge_op_str = "executorch_exir_dialects_edge__ops_dim_order_ops__to_dim_order_copy_default"
+        sample_input = (torch.randn([2, 3, 4, 5], dtype=torch.float32),)
+        module = RoundTripChannelsLastModule().eval()
+
+        epm = to_edge(export(module, sample_input))
+
+        # The round trip is gone. Of the last two copies, the first converts
+        # t3, and the second is kept because it is an output.
+        FileCheck().check_count(edge_op_str, 2, exactly=True).run(
+            epm.exported_program().graph_module.code
+        )
+        expected = module(*sample_input)
+        actual = epm.exported_program().module()(*sample_input)
+        self.assertTrue(torch.allclose(actual, expected))
+        self.assertTrue(is_channel_last_dim_order(actual))
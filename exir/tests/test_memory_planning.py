@@ -17,6 +17,7 @@ from executorch.exir import ExecutorchBackendConfig, to_edge
 from executorch.exir.memory_planning import (
     filter_nodes,
     get_node_tensor_specs,
+    MemoryTier,
     Verifier,
 )
 from executorch.exir.pass_base import PassResult
@@ -591,3 +592,88 @@ class TestMisc(unittest.TestCase):
             num_placeholders,
             5,
         )
+
+    def test_inplace_outputs(self) -> None:
+        class ElementwiseChain(torch.nn.Module):
+            def forward(self, x: torch.Tensor) -> torch.Tensor:
+                y = torch.sigmoid(torch.relu(torch.mm(x, x)))
+                return torch.mm(y, x)
+
+        def get_specs(
+            graph_module: GraphModule, target: torch._ops.OpOverload
+        ) -> List[Any]:  # pyre-ignore
+            return [
+                node.meta["spec"]
+                for node in graph_module.graph.nodes
+                if node.op == "call_function" and node.target == target
+            ]
+
+        for alloc_inplace_outputs in (False, True):
+            graph_module = (
+                to_edge(export(ElementwiseChain(), (torch.randn(4, 4),)))
+                .to_executorch(
+                    ExecutorchBackendConfig(
+                        memory_planning_pass=MemoryPlanningPass(
+                            "greedy", alloc_inplace_outputs=alloc_inplace_outputs
+                        )
+                    )
+                )
+                .exported_program()
+                .graph_module
+            )
+            Verifier(
+                graph_module, alloc_graph_input=True, alloc_graph_output=True
+            ).verify_storage_reuse()
+
+            mm_spec, out_spec = get_specs(graph_module, torch.ops.aten.mm.out)
+            specs = [mm_spec] + get_specs(graph_module, torch.ops.aten.relu.out)
+            specs += get_specs(graph_module, torch.ops.aten.sigmoid.out)
+            self.assertEqual(len(specs), 3)
+            # The relu and sigmoid outputs take over the storage of the first
+            # mm's output only when asked to, and that storage then stays live
+            # until the second mm.
+            offsets = {(spec.mem_obj_id, spec.mem_offset) for spec in specs}
+            self.assertEqual(len(offsets) == 1, alloc_inplace_outputs)
+            if alloc_inplace_outputs:
+                self.assertNotIn(
+                    (out_spec.mem_obj_id, out_spec.mem_offset), offsets
+                )
+
+    def test_memory_tiers(self) -> None:
+        class ElementwiseChain(torch.nn.Module):
+            def forward(self, x: torch.Tensor) -> torch.Tensor:
+                y = torch.sigmoid(torch.relu(torch.mm(x, x)))
+                return torch.mm(y, x)
+
+        # Each 4x4 float tensor takes 64 bytes, so only one fits in the SRAM at
+        # a time.
+        tiers = [MemoryTier("sram", capacity=64), MemoryTier("dram")]
+        graph_module = (
+            to_edge(export(ElementwiseChain(), (torch.randn(4, 4),)))
+            .to_executorch(
+                ExecutorchBackendConfig(
+                    memory_planning_pass=MemoryPlanningPass(
+                        "greedy", memory_tiers=tiers
+                    )
+                )
+            )
+            .exported_program()
+            .graph_module
+        )
+        Verifier(
+            graph_module, alloc_graph_input=True, alloc_graph_output=True
+        ).verify_storage_reuse()
+
+        self.assertEqual(
+            graph_module.meta["non_const_buffer_tiers"], ["", "sram", "dram"]
+        )
+        bufsizes = graph_module.meta["non_const_buffer_sizes"]
+        self.assertEqual(len(bufsizes), 3)
+        self.assertLessEqual(bufsizes[1], 64)
+        mem_ids = {
+            spec.mem_id
+            for node in graph_module.graph.nodes
+            for spec in get_node_tensor_specs(node)
+            if spec.mem_id is not None
+        }
+        self.assertEqual(mem_ids, {1, 2})
@@ -39,6 +39,18 @@ class TestModel1(nn.Module):
         return (torch.rand(5, 6),)
 
 
+class TestModel2(nn.Module):
+    def forward(self, x):
+        v1 = torch.unsqueeze(x, 0)  # removed, becomes a view of x
+        v2 = torch.mul(v1, 2.0)
+        v3 = torch.squeeze(v2, 0)  # removed, becomes a view of mul
+        v4 = torch.add(v3, 1.0)
+        return torch.squeeze(v4)  # not removed, output of the graph
+
+    def get_example_inputs(self):
+        return (torch.rand(5, 1, 6),)
+
+
 class TestRemoveViewCopy(unittest.TestCase):
     def test_disable(self) -> None:
         model = TestModel1()
@@ -225,3 +237,36 @@ class TestRemoveViewCopy(unittest.TestCase):
         self.assertEqual(
             instructions[6].instr_args.op_index, 2  # pyre-ignore
         )  # aten:view_copy @ idx11
+
+    def test_squeeze_and_unsqueeze_become_views(self) -> None:
+        model = TestModel2()
+        model.eval()
+        example_inputs = model.get_example_inputs()
+        ep = torch.export.export(model, example_inputs)
+
+        etpm = to_edge(ep).to_executorch(
+            config=ExecutorchBackendConfig(
+                remove_view_copy=True,
+                memory_planning_pass=MemoryPlanningPass(
+                    "greedy", alloc_graph_input=False
+                ),
+            ),
+        )
+
+        n_views = 0
+        n_squeeze_copies = 0
+        for node in etpm.exported_program().graph_module.graph.nodes:
+            if node.target == memory.view:
+                n_views += 1
+            elif "squeeze_copy" in str(node.target):
+                n_squeeze_copies += 1
+        self.assertEqual(n_views, 2)
+        # The squeeze feeding the output still copies.
+        self.assertEqual(n_squeeze_copies, 1)
+
+        self.assertTrue(
+            torch.allclose(
+                etpm.exported_program().module()(*example_inputs),
+                model(*example_inputs),
+            )
+        )
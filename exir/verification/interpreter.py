@@ -134,6 +134,11 @@ class Interpreter:
         self.container_metatype: exir.schema.ContainerMetadata = program.execution_plan[
             0
         ].container_meta_type
+        # Parse the input and output specs once rather than on every run.
+        # pyre-fixme[16]: Module `pytree` has no attribute `from_str`.
+        self._inp_spec = ex_pytree.from_str(self.container_metatype.encoded_inp_str)
+        # pyre-fixme[16]: Module `pytree` has no attribute `from_str`.
+        self._out_spec = ex_pytree.from_str(self.container_metatype.encoded_out_str)
 
         # create buffer in memory and get reference to it
         # pyre-ignore
@@ -368,13 +373,12 @@ class Interpreter:
         Outputs after completing all computations
         """
 
-        # pyre-fixme[16]: Module `pytree` has no attribute `tree_flatten`.
-        args, pytree = ex_pytree.tree_flatten((raw_args, {}))
-
-        if pytree.to_str() != self.container_metatype.encoded_inp_str:
+        try:
+            args = self._inp_spec.flatten_up_to((raw_args, {}))
+        except ValueError as e:
             raise TypeError(
-                f"Arguments provided do not match required type. \nRequired: {self.container_metatype.encoded_inp_str} \nProvided: {pytree.to_str()}"
-            )
+                f"Arguments provided do not match required type. \nRequired: {self.container_metatype.encoded_inp_str} \nProvided: {e}"
+            ) from e
 
         # Initialize user inputs in value list
         if len(self.execution_plan.inputs) != len(args):
@@ -419,7 +423,5 @@ class Interpreter:
             ip += 1
 
         ret = [self._value_list[i] for i in self.execution_plan.outputs]
-        # pyre-fixme[16]: Module `pytree` has no attribute `from_str`.
-        treespec = ex_pytree.from_str(self.container_metatype.encoded_out_str)
         # pyre-fixme[16]: Module `pytree` has no attribute `tree_unflatten`.
-        return ex_pytree.tree_unflatten(ret, treespec)
+        return ex_pytree.tree_unflatten(ret, self._out_spec)
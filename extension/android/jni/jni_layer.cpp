@@ -19,6 +19,7 @@
 
 #include <executorch/extension/module/module.h>
 #include <executorch/extension/runner_util/managed_tensor.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/core/portable_type/tensor_impl.h>
 #include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/platform.h>
@@ -275,6 +276,69 @@ class ExecuTorchJni : public facebook::jni::HybridClass<ExecuTorchJni> {
     return execute_method(methodName->toStdString(), jinputs);
   }
 
+  // Like execute(), but the method writes its tensor outputs straight into
+  // the direct buffers of `joutputs`, and keeps doing so on later calls. A
+  // null element leaves that output as it is.
+  facebook::jni::local_ref<facebook::jni::JArrayClass<JEValue>> execute_into(
+      facebook::jni::alias_ref<jstring> methodName,
+      facebook::jni::alias_ref<
+          facebook::jni::JArrayClass<TensorHybrid::javaobject>::javaobject>
+          joutputs,
+      facebook::jni::alias_ref<
+          facebook::jni::JArrayClass<JEValue::javaobject>::javaobject>
+          jinputs) {
+    std::string method_name = methodName->toStdString();
+    auto method = module_->bind_method(method_name);
+    if (!method.ok()) {
+      facebook::jni::throwNewJavaException(
+          "java/lang/Exception",
+          "Loading method %s failed with status 0x%" PRIx32,
+          method_name.c_str(),
+          static_cast<error_code_t>(method.error()));
+      return {};
+    }
+
+    static auto cls = TensorHybrid::javaClassStatic();
+    static const auto dtypeMethod = cls->getMethod<jint()>("dtypeJniCode");
+    static auto dataBufferMethod = cls->getMethod<
+        facebook::jni::local_ref<facebook::jni::JBuffer::javaobject>()>(
+        "getRawDataBuffer");
+    JNIEnv* jni = facebook::jni::Environment::current();
+    for (int i = 0; i < joutputs->size(); i++) {
+      auto joutput = joutputs->getElement(i);
+      if (!joutput) {
+        continue;
+      }
+      jint jdtype = dtypeMethod(joutput);
+      if (java_dtype_to_scalar_type.count(jdtype) == 0) {
+        facebook::jni::throwNewJavaException(
+            facebook::jni::gJavaLangIllegalArgumentException,
+            "Unknown Tensor jdtype %d",
+            jdtype);
+      }
+      facebook::jni::local_ref<facebook::jni::JBuffer> jbuffer =
+          dataBufferMethod(joutput);
+      // The capacity of a typed buffer is in elements.
+      const size_t nbytes = jni->GetDirectBufferCapacity(jbuffer.get()) *
+          elementSize(java_dtype_to_scalar_type.at(jdtype));
+      Error err = (*method)->set_output_data_ptr(
+          jni->GetDirectBufferAddress(jbuffer.get()), nbytes, i);
+      if (err != Error::Ok) {
+        facebook::jni::throwNewJavaException(
+            facebook::jni::gJavaLangIllegalArgumentException,
+            "Can not write output %d of method %s into the given tensor, "
+            "status 0x%" PRIx32
+            ". Outputs must not be memory planned, and the tensor must be "
+            "large enough.",
+            i,
+            method_name.c_str(),
+            static_cast<error_code_t>(err));
+      }
+    }
+
+    return execute_method(method_name, jinputs);
+  }
+
   jint load_method(facebook::jni::alias_ref<jstring> methodName) {
     return static_cast<jint>(module_->load_method(methodName->toStdString()));
   }
@@ -349,6 +413,7 @@ class ExecuTorchJni : public facebook::jni::HybridClass<ExecuTorchJni> {
         makeNativeMethod("initHybrid", ExecuTorchJni::initHybrid),
         makeNativeMethod("forward", ExecuTorchJni::forward),
         makeNativeMethod("execute", ExecuTorchJni::execute),
+        makeNativeMethod("executeInto", ExecuTorchJni::execute_into),
         makeNativeMethod("loadMethod", ExecuTorchJni::load_method),
     });
   }
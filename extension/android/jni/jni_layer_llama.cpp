@@ -6,8 +6,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -73,6 +75,16 @@ class ExecuTorchLlamaCallbackJni
     method(self(), s);
   }
 
+  void onResultBytes(
+      facebook::jni::alias_ref<facebook::jni::JByteBuffer> buffer,
+      jint length) const {
+    static auto cls = ExecuTorchLlamaCallbackJni::javaClassStatic();
+    static const auto method = cls->getMethod<void(
+        facebook::jni::alias_ref<facebook::jni::JByteBuffer>, jint)>(
+        "onResultBytes");
+    method(self(), buffer, length);
+  }
+
   void onStats(const Runner::Stats& result) const {
     static auto cls = ExecuTorchLlamaCallbackJni::javaClassStatic();
     static const auto method = cls->getMethod<void(jfloat)>("onStats");
@@ -86,6 +98,57 @@ class ExecuTorchLlamaCallbackJni
   }
 };
 
+// Collects the UTF-8 bytes of generated tokens in a direct buffer owned by
+// Java, and hands them over in one callback every `tokens_per_flush` tokens,
+// instead of creating a Java string per token.
+class TokenBatcher {
+ public:
+  TokenBatcher(
+      facebook::jni::alias_ref<facebook::jni::JByteBuffer> buffer,
+      size_t tokens_per_flush,
+      facebook::jni::alias_ref<ExecuTorchLlamaCallbackJni> callback)
+      : buffer_(buffer),
+        data_(buffer->getDirectBytes()),
+        capacity_(buffer->getDirectSize()),
+        tokens_per_flush_(tokens_per_flush),
+        callback_(callback) {}
+
+  void add(const std::string& piece) {
+    const char* bytes = piece.data();
+    size_t remaining = piece.size();
+    while (remaining > 0) {
+      if (size_ == capacity_) {
+        flush();
+      }
+      const size_t n = std::min(remaining, capacity_ - size_);
+      std::memcpy(data_ + size_, bytes, n);
+      size_ += n;
+      bytes += n;
+      remaining -= n;
+    }
+    if (++pending_tokens_ >= tokens_per_flush_) {
+      flush();
+    }
+  }
+
+  void flush() {
+    if (size_ > 0) {
+      callback_->onResultBytes(buffer_, static_cast<jint>(size_));
+    }
+    size_ = 0;
+    pending_tokens_ = 0;
+  }
+
+ private:
+  facebook::jni::alias_ref<facebook::jni::JByteBuffer> buffer_;
+  uint8_t* data_;
+  size_t capacity_;
+  size_t tokens_per_flush_;
+  facebook::jni::alias_ref<ExecuTorchLlamaCallbackJni> callback_;
+  size_t size_ = 0;
+  size_t pending_tokens_ = 0;
+};
+
 class ExecuTorchLlamaJni
     : public facebook::jni::HybridClass<ExecuTorchLlamaJni> {
  private:
@@ -136,6 +199,31 @@ class ExecuTorchLlamaJni
     return 0;
   }
 
+  jint generate_batched(
+      facebook::jni::alias_ref<jstring> prompt,
+      facebook::jni::alias_ref<facebook::jni::JByteBuffer> buffer,
+      jint tokens_per_flush,
+      facebook::jni::alias_ref<ExecuTorchLlamaCallbackJni> callback) {
+    if (!buffer->isDirect() || buffer->getDirectSize() == 0) {
+      facebook::jni::throwNewJavaException(
+          facebook::jni::gJavaLangIllegalArgumentException,
+          "The token buffer must be a non-empty direct ByteBuffer");
+    }
+    TokenBatcher batcher(
+        buffer, std::max<jint>(1, tokens_per_flush), callback);
+    Error err = runner_->generate(
+        prompt->toStdString(),
+        128,
+        [&batcher](const std::string& result) { batcher.add(result); },
+        [&batcher, callback](const Runner::Stats& result) {
+          // Deliver the last tokens before the stats.
+          batcher.flush();
+          callback->onStats(result);
+        });
+    batcher.flush();
+    return static_cast<jint>(err);
+  }
+
   void stop() {
     runner_->stop();
   }
@@ -148,6 +236,8 @@ class ExecuTorchLlamaJni
     registerHybrid({
         makeNativeMethod("initHybrid", ExecuTorchLlamaJni::initHybrid),
         makeNativeMethod("generate", ExecuTorchLlamaJni::generate),
+        makeNativeMethod(
+            "generateBatched", ExecuTorchLlamaJni::generate_batched),
         makeNativeMethod("stop", ExecuTorchLlamaJni::stop),
         makeNativeMethod("load", ExecuTorchLlamaJni::load),
     });
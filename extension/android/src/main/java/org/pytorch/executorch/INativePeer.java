@@ -19,6 +19,9 @@ interface INativePeer {
   /** Run an arbitrary method on the module */
   EValue[] execute(String methodName, EValue... inputs);
 
+  /** Run an arbitrary method on the module, writing its outputs into the given tensors */
+  EValue[] executeInto(String methodName, Tensor[] outputs, EValue... inputs);
+
   /**
    * Load a method on this module.
    *
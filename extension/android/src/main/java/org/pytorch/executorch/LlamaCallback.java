@@ -9,6 +9,7 @@
 package org.pytorch.executorch;
 
 import com.facebook.jni.annotations.DoNotStrip;
+import java.nio.ByteBuffer;
 
 public interface LlamaCallback {
   /**
@@ -20,6 +21,17 @@ public interface LlamaCallback {
   @DoNotStrip
   public void onResult(String result);
 
+  /**
+   * Called by generateBatched() with the UTF-8 bytes of the tokens generated since the last call.
+   * The bytes are only valid until this method returns, and a multi-byte character may be split
+   * across two calls, so decode them incrementally, e.g. with a CharsetDecoder.
+   *
+   * @param buffer The buffer passed to generateBatched()
+   * @param length Number of valid bytes at the start of the buffer
+   */
+  @DoNotStrip
+  public default void onResultBytes(ByteBuffer buffer, int length) {}
+
   /**
    * Called when the statistics for the generate() is available.
    *
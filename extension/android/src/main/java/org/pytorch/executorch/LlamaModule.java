@@ -12,6 +12,7 @@ import com.facebook.jni.HybridData;
 import com.facebook.jni.annotations.DoNotStrip;
 import com.facebook.soloader.nativeloader.NativeLoader;
 import com.facebook.soloader.nativeloader.SystemDelegate;
+import java.nio.ByteBuffer;
 
 public class LlamaModule {
   static {
@@ -45,6 +46,19 @@ public class LlamaModule {
   @DoNotStrip
   public native int generate(String prompt, LlamaCallback llamaCallback);
 
+  /**
+   * Like generate(), but delivers the generated text through onResultBytes() in batches of
+   * tokensPerFlush tokens, written into the given buffer, instead of one String per token.
+   *
+   * @param prompt Input prompt
+   * @param buffer Direct buffer that receives the UTF-8 bytes of the generated tokens
+   * @param tokensPerFlush Number of tokens to collect before each onResultBytes() call
+   * @param llamaCallback callback object to receive results.
+   */
+  @DoNotStrip
+  public native int generateBatched(
+      String prompt, ByteBuffer buffer, int tokensPerFlush, LlamaCallback llamaCallback);
+
   /** Stop current generate() before it finishes. */
   @DoNotStrip
   public native void stop();
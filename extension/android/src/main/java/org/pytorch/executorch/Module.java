@@ -10,6 +10,7 @@ package org.pytorch.executorch;
 
 import com.facebook.soloader.nativeloader.NativeLoader;
 import com.facebook.soloader.nativeloader.SystemDelegate;
+import java.util.HashMap;
 import java.util.Map;
 
 /** Java wrapper for ExecuTorch Module. */
@@ -18,6 +19,12 @@ public class Module {
   /** Reference to the INativePeer object of this module. */
   private INativePeer mNativePeer;
 
+  /**
+   * The output tensors given to {@link #executeInto}, per method. The native method keeps writing
+   * into their buffers, so they must not be garbage-collected.
+   */
+  private final Map<String, Tensor[]> mBoundOutputs = new HashMap<>();
+
   /**
    * Loads a serialized ExecuTorch module from the specified path on the disk.
    *
@@ -67,6 +74,50 @@ public class Module {
     return mNativePeer.execute(methodName, inputs);
   }
 
+  /**
+   * Runs the 'forward' method of this module, writing its outputs into the given tensors.
+   *
+   * @see #executeInto(String, Tensor[], EValue...)
+   */
+  public EValue[] forwardInto(Tensor[] outputs, EValue... inputs) {
+    return executeInto("forward", outputs, inputs);
+  }
+
+  /**
+   * Runs the specified method of this module, writing its tensor outputs straight into the direct
+   * buffers of {@code outputs} instead of the method's own memory, so that they stay valid after
+   * the next call and can be reused across calls without copies. Inputs created with {@code
+   * Tensor.fromBlob} on a direct buffer are never copied either.
+   *
+   * <p>The method keeps writing into these buffers on later calls, including those to {@link
+   * #execute}, until they are replaced by another call to this method. A {@code null} element
+   * leaves that output as it is. This requires a program whose outputs are not memory planned,
+   * and tensors with the dtype of the outputs and at least as many elements.
+   *
+   * @param methodName name of the ExecuTorch method to run.
+   * @param outputs tensors to write the outputs of the method into, by output index.
+   * @param inputs arguments that will be passed to ExecuTorch method.
+   * @return return value from the method, whose tensors share the buffers of {@code outputs}.
+   */
+  public EValue[] executeInto(String methodName, Tensor[] outputs, EValue... inputs) {
+    // Hold on to the tensors before the native method starts writing into them.
+    Tensor[] bound = mBoundOutputs.get(methodName);
+    if (bound == null || bound.length < outputs.length) {
+      Tensor[] grown = new Tensor[outputs.length];
+      if (bound != null) {
+        System.arraycopy(bound, 0, grown, 0, bound.length);
+      }
+      bound = grown;
+      mBoundOutputs.put(methodName, bound);
+    }
+    for (int i = 0; i < outputs.length; i++) {
+      if (outputs[i] != null) {
+        bound[i] = outputs[i];
+      }
+    }
+    return mNativePeer.executeInto(methodName, outputs, inputs);
+  }
+
   /**
    * Load a method on this module. This might help with the first time inference performance,
    * because otherwise the method is loaded lazily when it's execute. Note: this function is
@@ -88,5 +139,6 @@ public class Module {
    */
   public void destroy() {
     mNativePeer.resetNative();
+    mBoundOutputs.clear();
   }
 }
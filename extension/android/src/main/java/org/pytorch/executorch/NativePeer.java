@@ -39,6 +39,9 @@ class NativePeer implements INativePeer {
   @DoNotStrip
   public native EValue[] execute(String methodName, EValue... inputs);
 
+  @DoNotStrip
+  public native EValue[] executeInto(String methodName, Tensor[] outputs, EValue... inputs);
+
   @DoNotStrip
   public native int loadMethod(String methodName);
 }
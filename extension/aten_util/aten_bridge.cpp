@@ -9,6 +9,7 @@
 #include <executorch/extension/aten_util/aten_bridge.h>
 
 #include <executorch/runtime/platform/assert.h>
+#include <c10/util/SmallVector.h> // @manual=//caffe2/c10:c10
 #include <cstring>
 
 namespace torch {
@@ -60,6 +61,19 @@ ET_CHECK_MSG(
       torchToExecuTorchScalarType(a.options().dtype()),
       b.scalar_type());
 }
+
+template <typename T, typename U>
+bool same_values(const std::vector<T>& a, c10::ArrayRef<U> b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
 } // namespace
 
 torch::executor::ScalarType torchToExecuTorchScalarType(caffe2::TypeMeta type) {
@@ -148,9 +162,10 @@ void alias_etensor_to_attensor(
 
 at::Tensor alias_attensor_to_etensor(const torch::executor::Tensor& etensor) {
   c10::ScalarType dtype = execuTorchtoTorchScalarType(etensor.scalar_type());
-  std::vector<int64_t> at_tensor_sizes(
+  // from_blob copies these, so they only need to outlive the call.
+  c10::SmallVector<int64_t, 5> at_tensor_sizes(
       etensor.sizes().begin(), etensor.sizes().end());
-  std::vector<int64_t> at_tensor_strides(
+  c10::SmallVector<int64_t, 5> at_tensor_strides(
       etensor.strides().begin(), etensor.strides().end());
 
   at::Tensor t = at::from_blob(
@@ -162,5 +177,44 @@ at::Tensor alias_attensor_to_etensor(const torch::executor::Tensor& etensor) {
   check_tensor_meta(t, etensor);
   return t;
 }
+
+torch::executor::Tensor ETensorAliasCache::alias(
+    size_t slot,
+    at::Tensor& aten_tensor) {
+  ET_CHECK_MSG(aten_tensor.is_contiguous(), "Input tensor must be contiguous");
+  if (slot >= slots_.size()) {
+    slots_.resize(slot + 1);
+  }
+  if (slots_[slot] == nullptr) {
+    slots_[slot] = std::make_unique<Slot>();
+  }
+  Slot& s = *slots_[slot];
+  const auto dtype =
+      torchToExecuTorchScalarType(aten_tensor.options().dtype());
+  // Rebuild the metadata only when it changed. assign() keeps the capacity of
+  // the vectors, so a slot whose rank does not grow does not allocate.
+  if (!s.impl.has_value() || s.impl->scalar_type() != dtype ||
+      !same_values(s.sizes, aten_tensor.sizes()) ||
+      !same_values(s.strides, aten_tensor.strides())) {
+    const size_t dim = aten_tensor.dim();
+    s.sizes.assign(aten_tensor.sizes().begin(), aten_tensor.sizes().end());
+    s.strides.assign(
+        aten_tensor.strides().begin(), aten_tensor.strides().end());
+    // Only works for MemoryFormat::Contiguous inputs
+    s.dim_order.resize(dim);
+    for (size_t i = 0; i < dim; ++i) {
+      s.dim_order[i] = i;
+    }
+    s.impl.emplace(
+        dtype,
+        dim,
+        s.sizes.data(),
+        nullptr,
+        s.dim_order.data(),
+        s.strides.data());
+  }
+  s.impl->set_data(aten_tensor.mutable_data_ptr());
+  return torch::executor::Tensor(&*s.impl);
+}
 } // namespace util
 } // namespace torch
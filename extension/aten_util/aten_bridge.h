@@ -16,6 +16,7 @@
 #include <c10/core/ScalarTypeToTypeMeta.h> // @manual=//caffe2/c10:c10
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace torch {
@@ -45,5 +46,39 @@ void alias_etensor_to_attensor(at::Tensor& at, torch::executor::Tensor& et);
  * cloned.
  */
 at::Tensor alias_attensor_to_etensor(const torch::executor::Tensor& et);
+
+/*
+ * Aliases at::Tensors as ETensors across calls, e.g. the inputs of a method
+ * that is run repeatedly. Each slot keeps the TensorImpl and the sizes, dim
+ * order and strides it points to, and only swaps the data pointer while the
+ * tensors aliased in that slot keep their dtype, sizes and strides.
+ *
+ * Not thread safe. The ETensor of a slot is only valid until the next alias()
+ * of that slot, and as long as the aliased at::Tensor.
+ */
+class ETensorAliasCache final {
+ public:
+  /*
+   * @param[in] slot Index of the alias, e.g. the index of a method input.
+   * @param[in] aten_tensor Contiguous tensor to alias.
+   * @param[ret] ETensor aliasing the data of aten_tensor.
+   */
+  torch::executor::Tensor alias(size_t slot, at::Tensor& aten_tensor);
+
+  size_t size() const {
+    return slots_.size();
+  }
+
+ private:
+  struct Slot {
+    std::vector<torch::executor::Tensor::SizesType> sizes;
+    std::vector<torch::executor::Tensor::DimOrderType> dim_order;
+    std::vector<torch::executor::Tensor::StridesType> strides;
+    std::optional<torch::executor::TensorImpl> impl;
+  };
+
+  // Pointers so that the TensorImpls do not move when slots are added.
+  std::vector<std::unique_ptr<Slot>> slots_;
+};
 } // namespace util
 } // namespace torch
@@ -146,3 +146,42 @@ TEST(ATenBridgeTest, AliasATTensorToETensor) {
   auto aliased_at_tensor = alias_attensor_to_etensor(etensor);
   EXPECT_EQ(aliased_at_tensor.const_data_ptr(), etensor_data.data());
 }
+
+TEST(ATenBridgeTest, ETensorAliasCacheReusesMetadata) {
+  ETensorAliasCache cache;
+  auto first = generate_at_tensor();
+  Tensor etensor = cache.alias(0, first);
+  EXPECT_EQ(etensor.const_data_ptr(), first.const_data_ptr());
+  EXPECT_EQ(etensor.dim(), 3);
+  EXPECT_EQ(etensor.size(2), 6);
+  EXPECT_EQ(etensor.strides()[0], 30);
+
+  // A tensor with the same metadata reuses the TensorImpl and only swaps the
+  // data pointer.
+  auto second = generate_at_tensor();
+  Tensor reused = cache.alias(0, second);
+  EXPECT_EQ(reused.unsafeGetTensorImpl(), etensor.unsafeGetTensorImpl());
+  EXPECT_EQ(reused.const_data_ptr(), second.const_data_ptr());
+
+  // Other shapes and dtypes update the metadata.
+  auto reshaped = at::empty({2, 3}, at::kLong);
+  Tensor updated = cache.alias(0, reshaped);
+  EXPECT_EQ(updated.const_data_ptr(), reshaped.const_data_ptr());
+  EXPECT_EQ(updated.scalar_type(), ScalarType::Long);
+  EXPECT_EQ(updated.dim(), 2);
+  EXPECT_EQ(updated.size(1), 3);
+  EXPECT_EQ(updated.strides()[0], 3);
+
+  // Slots are independent.
+  auto other = at::empty({7});
+  Tensor other_etensor = cache.alias(2, other);
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(other_etensor.size(0), 7);
+  EXPECT_EQ(updated.size(1), 3);
+}
+
+TEST(ATenBridgeTest, ETensorAliasCacheNonContiguousFail) {
+  ETensorAliasCache cache;
+  auto sliced_tensor = generate_at_tensor().slice(1, 0, 2);
+  ET_EXPECT_DEATH(cache.alias(0, sliced_tensor), "");
+}
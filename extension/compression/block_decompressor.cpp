@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/compression/block_decompressor.h>
+
+#include <climits>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <executorch/backends/xnnpack/threadpool/threadpool.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+Error decompress_block(
+    __ET_UNUSED void* context,
+    Program::CompressionCodec codec,
+    const void* src,
+    size_t src_size,
+    void* dst,
+    size_t dst_size) {
+  switch (codec) {
+    case Program::CompressionCodec::Zstd: {
+      const size_t size = ZSTD_decompress(dst, dst_size, src, src_size);
+      ET_CHECK_OR_RETURN_ERROR(
+          !ZSTD_isError(size) && size == dst_size,
+          InvalidProgram,
+          "zstd block of %zu bytes decompressed to %zu of %zu bytes: %s",
+          src_size,
+          ZSTD_isError(size) ? 0 : size,
+          dst_size,
+          ZSTD_isError(size) ? ZSTD_getErrorName(size) : "wrong size");
+      return Error::Ok;
+    }
+    case Program::CompressionCodec::Lz4: {
+      ET_CHECK_OR_RETURN_ERROR(
+          src_size <= INT_MAX && dst_size <= INT_MAX,
+          NotSupported,
+          "LZ4 blocks are limited to %d bytes",
+          INT_MAX);
+      const int size = LZ4_decompress_safe(
+          static_cast<const char*>(src),
+          static_cast<char*>(dst),
+          static_cast<int>(src_size),
+          static_cast<int>(dst_size));
+      ET_CHECK_OR_RETURN_ERROR(
+          size >= 0 && static_cast<size_t>(size) == dst_size,
+          InvalidProgram,
+          "LZ4 block of %zu bytes decompressed to %d of %zu bytes",
+          src_size,
+          size,
+          dst_size);
+      return Error::Ok;
+    }
+  }
+  ET_LOG(Error, "Unknown compression codec %d", static_cast<int>(codec));
+  return Error::NotSupported;
+}
+
+void run_on_threadpool(
+    __ET_UNUSED void* runner_context,
+    size_t num_tasks,
+    void (*task)(void* task_context, size_t task_index),
+    void* task_context) {
+  torch::executorch::threadpool::get_threadpool()->run(
+      task, task_context, num_tasks);
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/program.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Decompresses a block compressed with zstd or LZ4, as a
+ * Program::ConstantDecompressor::decompress_block. Does not use `context`.
+ *
+ * @retval Error::InvalidProgram The block is corrupt or does not decompress
+ *     to exactly `dst_size` bytes.
+ * @retval Error::NotSupported Unknown codec.
+ */
+__ET_NODISCARD Error decompress_block(
+    void* context,
+    Program::CompressionCodec codec,
+    const void* src,
+    size_t src_size,
+    void* dst,
+    size_t dst_size);
+
+/**
+ * Runs the tasks across the shared threadpool, as a Method::InterOpRunner.
+ * Does not use `runner_context`.
+ */
+void run_on_threadpool(
+    void* runner_context,
+    size_t num_tasks,
+    void (*task)(void* task_context, size_t task_index),
+    void* task_context);
+
+/**
+ * Returns a decompressor for Program::experimental_load_with_decompressor()
+ * that decompresses the constant segment into memory from `allocator`,
+ * across the shared threadpool unless `parallel` is false.
+ */
+inline Program::ConstantDecompressor make_constant_decompressor(
+    MemoryAllocator* allocator,
+    bool parallel = true) {
+  return Program::ConstantDecompressor{
+      &decompress_block,
+      /*context=*/nullptr,
+      allocator,
+      parallel ? &run_on_threadpool : nullptr,
+      /*runner_context=*/nullptr};
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,32 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_library(
+        name = "block_decompressor",
+        srcs = [
+            "block_decompressor.cpp",
+        ],
+        exported_headers = [
+            "block_decompressor.h",
+        ],
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        deps = [
+            "//executorch/backends/xnnpack/threadpool:threadpool",
+        ],
+        exported_deps = [
+            "//executorch/runtime/executor:program",
+        ],
+        external_deps = [
+            "lz4",
+            "zstd",
+        ],
+    )
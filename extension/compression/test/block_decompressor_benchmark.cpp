@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Measures the size/time tradeoff of compressed constant segments: for each
+ * codec and block size, the compression ratio of synthetic quantized weights
+ * and the time to decompress them on one thread and across the threadpool,
+ * as Program::experimental_load_with_decompressor() does.
+ *
+ * Usage: block_decompressor_benchmark [segment_megabytes]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <executorch/extension/compression/block_decompressor.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace torch::executor;
+using torch::executor::util::decompress_block;
+using torch::executor::util::run_on_threadpool;
+
+namespace {
+
+struct Codec {
+  const char* name;
+  Program::CompressionCodec codec;
+  int level;
+};
+
+// Independently compressed blocks, as serialized by the exporter.
+struct CompressedSegment {
+  std::vector<uint8_t> data;
+  std::vector<size_t> block_offsets;
+  size_t block_size;
+};
+
+struct Tasks {
+  const Codec* codec;
+  const CompressedSegment* segment;
+  uint8_t* dst;
+  size_t dst_size;
+  bool failed;
+};
+
+// Int8 weights drawn from a normal distribution, like those of a quantized
+// linear layer, followed by a quarter of float scales and biases.
+std::vector<uint8_t> make_weights(size_t size) {
+  std::vector<uint8_t> data(size);
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0.0f, 20.0f);
+  const size_t num_int8 = size / 4 * 3;
+  for (size_t i = 0; i < num_int8; ++i) {
+    const float value = std::round(dist(rng));
+    data[i] = static_cast<uint8_t>(
+        static_cast<int8_t>(std::max(-128.0f, std::min(127.0f, value))));
+  }
+  for (size_t i = num_int8; i + sizeof(float) <= size; i += sizeof(float)) {
+    const float value = dist(rng) / 1000.0f;
+    std::memcpy(&data[i], &value, sizeof(value));
+  }
+  return data;
+}
+
+CompressedSegment compress(
+    const Codec& codec,
+    const std::vector<uint8_t>& data,
+    size_t block_size) {
+  CompressedSegment segment;
+  segment.block_size = block_size;
+  for (size_t start = 0; start < data.size(); start += block_size) {
+    const size_t size = std::min(block_size, data.size() - start);
+    const size_t offset = segment.data.size();
+    segment.block_offsets.push_back(offset);
+    if (codec.codec == Program::CompressionCodec::Zstd) {
+      segment.data.resize(offset + ZSTD_compressBound(size));
+      const size_t compressed_size = ZSTD_compress(
+          &segment.data[offset],
+          ZSTD_compressBound(size),
+          &data[start],
+          size,
+          codec.level);
+      segment.data.resize(offset + compressed_size);
+    } else {
+      segment.data.resize(offset + LZ4_compressBound(size));
+      const int compressed_size = LZ4_compress_default(
+          reinterpret_cast<const char*>(&data[start]),
+          reinterpret_cast<char*>(&segment.data[offset]),
+          size,
+          LZ4_compressBound(size));
+      segment.data.resize(offset + compressed_size);
+    }
+  }
+  return segment;
+}
+
+void decompress_task(void* context, size_t i) {
+  auto* tasks = static_cast<Tasks*>(context);
+  const CompressedSegment& segment = *tasks->segment;
+  const size_t begin = segment.block_offsets[i];
+  const size_t end = i + 1 < segment.block_offsets.size()
+      ? segment.block_offsets[i + 1]
+      : segment.data.size();
+  const size_t dst_offset = i * segment.block_size;
+  Error err = decompress_block(
+      nullptr,
+      tasks->codec->codec,
+      &segment.data[begin],
+      end - begin,
+      tasks->dst + dst_offset,
+      std::min(segment.block_size, tasks->dst_size - dst_offset));
+  if (err != Error::Ok) {
+    tasks->failed = true;
+  }
+}
+
+// Returns the best of a few decompressions, in milliseconds.
+double time_decompression(Tasks& tasks, bool parallel) {
+  const size_t num_blocks = tasks.segment->block_offsets.size();
+  double best_ms = INFINITY;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    if (parallel) {
+      run_on_threadpool(nullptr, num_blocks, &decompress_task, &tasks);
+    } else {
+      for (size_t i = 0; i < num_blocks; ++i) {
+        decompress_task(&tasks, i);
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    best_ms = std::min(
+        best_ms,
+        std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best_ms;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  runtime_init();
+  const size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  const std::vector<uint8_t> weights = make_weights(megabytes << 20);
+  std::vector<uint8_t> out(weights.size());
+
+  const Codec codecs[] = {
+      {"lz4", Program::CompressionCodec::Lz4, 0},
+      {"zstd-1", Program::CompressionCodec::Zstd, 1},
+      {"zstd-3", Program::CompressionCodec::Zstd, 3},
+      {"zstd-9", Program::CompressionCodec::Zstd, 9},
+  };
+  const size_t block_sizes[] = {64 << 10, 256 << 10, 1 << 20, 4 << 20};
+
+  std::printf("Decompressing %zu MiB of synthetic weights\n", megabytes);
+  std::printf(
+      "%-8s %10s %8s %12s %12s %12s\n",
+      "codec",
+      "block_kib",
+      "ratio",
+      "serial_ms",
+      "parallel_ms",
+      "parallel_gbs");
+  for (const Codec& codec : codecs) {
+    for (size_t block_size : block_sizes) {
+      const CompressedSegment segment = compress(codec, weights, block_size);
+      Tasks tasks = {&codec, &segment, out.data(), out.size(), false};
+      const double serial_ms = time_decompression(tasks, /*parallel=*/false);
+      const double parallel_ms = time_decompression(tasks, /*parallel=*/true);
+      if (tasks.failed || out != weights) {
+        std::printf("%s: decompression failed\n", codec.name);
+        return 1;
+      }
+      std::printf(
+          "%-8s %10zu %8.3f %12.2f %12.2f %12.2f\n",
+          codec.name,
+          block_size >> 10,
+          static_cast<double>(weights.size()) / segment.data.size(),
+          serial_ms,
+          parallel_ms,
+          weights.size() / (parallel_ms * 1e6));
+    }
+  }
+  return 0;
+}
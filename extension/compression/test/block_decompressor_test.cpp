@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/compression/block_decompressor.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <lz4.h>
+#include <zstd.h>
+
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using torch::executor::Error;
+using torch::executor::Program;
+using torch::executor::util::decompress_block;
+using torch::executor::util::run_on_threadpool;
+
+namespace {
+
+std::vector<uint8_t> make_data(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>((i * 7) % 13);
+  }
+  return data;
+}
+
+std::vector<uint8_t> compress(
+    Program::CompressionCodec codec,
+    const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> compressed;
+  if (codec == Program::CompressionCodec::Zstd) {
+    compressed.resize(ZSTD_compressBound(data.size()));
+    const size_t size = ZSTD_compress(
+        compressed.data(), compressed.size(), data.data(), data.size(), 3);
+    EXPECT_FALSE(ZSTD_isError(size));
+    compressed.resize(size);
+  } else {
+    compressed.resize(LZ4_compressBound(data.size()));
+    const int size = LZ4_compress_default(
+        reinterpret_cast<const char*>(data.data()),
+        reinterpret_cast<char*>(compressed.data()),
+        data.size(),
+        compressed.size());
+    EXPECT_GT(size, 0);
+    compressed.resize(size);
+  }
+  return compressed;
+}
+
+} // namespace
+
+class BlockDecompressorTest
+    : public ::testing::TestWithParam<Program::CompressionCodec> {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+};
+
+TEST_P(BlockDecompressorTest, RoundTrips) {
+  const std::vector<uint8_t> data = make_data(10000);
+  const std::vector<uint8_t> compressed = compress(GetParam(), data);
+  EXPECT_LT(compressed.size(), data.size());
+
+  std::vector<uint8_t> out(data.size());
+  ASSERT_EQ(
+      decompress_block(
+          nullptr,
+          GetParam(),
+          compressed.data(),
+          compressed.size(),
+          out.data(),
+          out.size()),
+      Error::Ok);
+  EXPECT_EQ(out, data);
+}
+
+TEST_P(BlockDecompressorTest, RejectsTheWrongSize) {
+  const std::vector<uint8_t> data = make_data(1000);
+  const std::vector<uint8_t> compressed = compress(GetParam(), data);
+
+  std::vector<uint8_t> out(data.size() + 1);
+  EXPECT_EQ(
+      decompress_block(
+          nullptr,
+          GetParam(),
+          compressed.data(),
+          compressed.size(),
+          out.data(),
+          out.size()),
+      Error::InvalidProgram);
+  EXPECT_EQ(
+      decompress_block(
+          nullptr,
+          GetParam(),
+          compressed.data(),
+          compressed.size() / 2,
+          out.data(),
+          data.size()),
+      Error::InvalidProgram);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Codecs,
+    BlockDecompressorTest,
+    Values(Program::CompressionCodec::Zstd, Program::CompressionCodec::Lz4));
+
+TEST(RunOnThreadpoolTest, RunsEveryTask) {
+  torch::executor::runtime_init();
+  std::vector<int> counts(100);
+  run_on_threadpool(
+      nullptr,
+      counts.size(),
+      [](void* context, size_t i) {
+        ++(*static_cast<std::vector<int>*>(context))[i];
+      },
+      &counts);
+  EXPECT_EQ(counts, std::vector<int>(100, 1));
+}
@@ -0,0 +1,38 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_test(
+        name = "block_decompressor_test",
+        srcs = [
+            "block_decompressor_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/compression:block_decompressor",
+            "//executorch/runtime/platform:platform",
+        ],
+        external_deps = [
+            "lz4",
+            "zstd",
+        ],
+    )
+
+    runtime.cxx_binary(
+        name = "block_decompressor_benchmark",
+        srcs = [
+            "block_decompressor_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/extension/compression:block_decompressor",
+            "//executorch/runtime/platform:platform",
+        ],
+        external_deps = [
+            "lz4",
+            "zstd",
+        ],
+    )
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/async_data_loader.h>
+
+#include <utility>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+AsyncDataLoader::~AsyncDataLoader() {
+  // Wait for the loads still in flight, since they use the wrapped loader.
+  // Unclaimed buffers are freed along with their results.
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& pending : pending_) {
+    pending.result.wait();
+  }
+}
+
+Result<FreeableBuffer> AsyncDataLoader::Load(size_t offset, size_t size) {
+  std::future<Result<FreeableBuffer>> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (it->offset == offset && it->size == size) {
+        result = std::move(it->result);
+        pending_.erase(it);
+        break;
+      }
+    }
+  }
+  if (result.valid()) {
+    return result.get();
+  }
+  return loader_->Load(offset, size);
+}
+
+Result<size_t> AsyncDataLoader::size() const {
+  return loader_->size();
+}
+
+void AsyncDataLoader::will_load(size_t offset, size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.size() >= max_pending_) {
+    return;
+  }
+  for (const auto& pending : pending_) {
+    if (pending.offset == offset && pending.size == size) {
+      return;
+    }
+  }
+  DataLoader* loader = loader_;
+  pending_.push_back(
+      {offset,
+       size,
+       std::async(std::launch::async, [loader, offset, size]() {
+         return loader->Load(offset, size);
+       })});
+}
+
+void AsyncDataLoader::prefetch(const void* data, size_t size) {
+  loader_->prefetch(data, size);
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A DataLoader that wraps another DataLoader and starts the loads announced
+ * through `will_load()` on background threads, so that they overlap with each
+ * other and with the work of the caller. `Program::load()` announces all of
+ * the program's segments, so delegate payloads are read while the constant
+ * segment is loaded and while earlier delegates are initialized.
+ *
+ * A `Load()` whose range matches an announced load waits for it and returns
+ * its buffer. Other loads are forwarded to the wrapped loader synchronously.
+ * Announced loads that are never claimed are freed when the instance is
+ * destroyed.
+ */
+class AsyncDataLoader : public DataLoader {
+ public:
+  /**
+   * Creates a new AsyncDataLoader.
+   *
+   * @param[in] loader The loader to read data from. Must be thread-safe and
+   *     must outlive this instance.
+   * @param[in] max_pending The maximum number of announced loads that may be
+   *     in flight or waiting to be claimed. Further announcements are ignored
+   *     until some of them are claimed.
+   */
+  explicit AsyncDataLoader(DataLoader* loader, size_t max_pending = 16)
+      : loader_(loader), max_pending_(max_pending) {}
+
+  ~AsyncDataLoader() override;
+
+  __ET_NODISCARD Result<FreeableBuffer> Load(size_t offset, size_t size)
+      override;
+
+  __ET_NODISCARD Result<size_t> size() const override;
+
+  void will_load(size_t offset, size_t size) override;
+
+  void prefetch(const void* data, size_t size) override;
+
+ private:
+  struct PendingLoad {
+    size_t offset;
+    size_t size;
+    std::future<Result<FreeableBuffer>> result;
+  };
+
+  // Not copyable or movable; in-flight loads point back to the wrapped loader.
+  AsyncDataLoader(const AsyncDataLoader&) = delete;
+  AsyncDataLoader& operator=(const AsyncDataLoader&) = delete;
+  AsyncDataLoader(AsyncDataLoader&&) = delete;
+  AsyncDataLoader& operator=(AsyncDataLoader&&) = delete;
+
+  DataLoader* const loader_;
+  const size_t max_pending_;
+
+  std::mutex mutex_; // Guards pending_.
+  std::vector<PendingLoad> pending_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/deduplicating_data_loader.h>
+
+#include <cstring>
+#include <utility>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+/// FNV-1a over 64-bit words, which is enough to tell segments apart; equal
+/// hashes are confirmed by comparing the contents.
+uint64_t hash_contents(const void* data, size_t size) {
+  constexpr uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kPrime;
+  }
+  return hash;
+}
+
+} // namespace
+
+SegmentCache::~SegmentCache() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!entries_.empty()) {
+    // Their buffers are still referenced, so leak them rather than free
+    // memory that is in use.
+    ET_LOG(
+        Error,
+        "SegmentCache destroyed with %zu buffers still in use",
+        entries_.size());
+  }
+}
+
+SegmentCache& SegmentCache::process_cache() {
+  // Never destroyed, so that buffers freed during static destruction do not
+  // refer to a destroyed cache.
+  static SegmentCache* cache = new SegmentCache();
+  return *cache;
+}
+
+Result<FreeableBuffer> SegmentCache::intern(FreeableBuffer&& buffer) {
+  const void* data = buffer.data();
+  size_t size = buffer.size();
+  if (data == nullptr || size == 0) {
+    return std::move(buffer);
+  }
+  uint64_t hash = hash_contents(data, size);
+
+  Entry* entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = entries_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      Entry* candidate = it->second;
+      if (candidate->buffer.size() == size &&
+          std::memcmp(candidate->buffer.data(), data, size) == 0) {
+        entry = candidate;
+        break;
+      }
+    }
+    if (entry != nullptr) {
+      entry->refs++;
+      num_bytes_deduplicated_ += size;
+    } else {
+      entry = new Entry{this, hash, 1, std::move(buffer)};
+      entries_.emplace(hash, entry);
+    }
+  }
+  // Frees the duplicate, if it was not moved into the new entry.
+  buffer.Free();
+
+  return FreeableBuffer(
+      entry->buffer.data(), entry->buffer.size(), release, entry);
+}
+
+void SegmentCache::release(
+    void* context,
+    __ET_UNUSED void* data,
+    __ET_UNUSED size_t size) {
+  Entry* entry = static_cast<Entry*>(context);
+  SegmentCache* cache = entry->cache;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex_);
+    if (--entry->refs > 0) {
+      return;
+    }
+    auto range = cache->entries_.equal_range(entry->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == entry) {
+        cache->entries_.erase(it);
+        break;
+      }
+    }
+  }
+  entry->buffer.Free();
+  delete entry;
+}
+
+size_t SegmentCache::num_entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t SegmentCache::num_bytes_deduplicated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_bytes_deduplicated_;
+}
+
+Result<FreeableBuffer> DeduplicatingDataLoader::Load(
+    size_t offset,
+    size_t size) {
+  Result<FreeableBuffer> buffer = loader_->Load(offset, size);
+  if (!buffer.ok() || size < min_size_) {
+    return buffer;
+  }
+  return cache_->intern(std::move(buffer.get()));
+}
+
+Result<size_t> DeduplicatingDataLoader::size() const {
+  return loader_->size();
+}
+
+void DeduplicatingDataLoader::will_load(size_t offset, size_t size) {
+  loader_->will_load(offset, size);
+}
+
+void DeduplicatingDataLoader::prefetch(const void* data, size_t size) {
+  loader_->prefetch(data, size);
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/freeable_buffer.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A content-addressed cache of loaded segments. Buffers with identical
+ * contents are kept once and shared, reference-counted, by everyone who
+ * interned them.
+ *
+ * NOTE: This is thread-safe. Buffers returned by `intern()` must be freed
+ * before the cache is destroyed; `process_cache()` is never destroyed.
+ */
+class SegmentCache final {
+ public:
+  SegmentCache() = default;
+  ~SegmentCache();
+
+  /**
+   * Returns the cache shared by the whole process.
+   */
+  static SegmentCache& process_cache();
+
+  /**
+   * Looks up a buffer with the same contents as `buffer`. If there is one,
+   * frees `buffer` and returns a new reference to the cached buffer.
+   * Otherwise `buffer` becomes the cached copy.
+   *
+   * @returns A buffer aliasing the cached copy, which is freed when its last
+   *     reference is.
+   */
+  __ET_NODISCARD Result<FreeableBuffer> intern(FreeableBuffer&& buffer);
+
+  /// Number of distinct buffers currently cached.
+  size_t num_entries() const;
+
+  /// Number of bytes that `intern()` did not keep because they were cached.
+  size_t num_bytes_deduplicated() const;
+
+ private:
+  struct Entry {
+    SegmentCache* cache;
+    uint64_t hash;
+    size_t refs;
+    FreeableBuffer buffer;
+  };
+
+  // Not copyable or movable; cached buffers point back to the cache.
+  SegmentCache(const SegmentCache&) = delete;
+  SegmentCache& operator=(const SegmentCache&) = delete;
+  SegmentCache(SegmentCache&&) = delete;
+  SegmentCache& operator=(SegmentCache&&) = delete;
+
+  static void release(void* context, void* data, size_t size);
+
+  mutable std::mutex mutex_; // Guards the fields below.
+  std::unordered_multimap<uint64_t, Entry*> entries_;
+  size_t num_bytes_deduplicated_ = 0;
+};
+
+/**
+ * A DataLoader that wraps another DataLoader and interns the buffers it
+ * loads in a SegmentCache. When several Programs contain the same constant
+ * segments or delegate payloads, e.g. task-specific heads on a shared
+ * encoder, those are kept in memory once across all of the Programs loaded
+ * through the same cache.
+ *
+ * Every deduplicated load is still read from the wrapped loader and hashed,
+ * so this trades load time for memory. Small loads, like the program header
+ * and most metadata, are returned as is.
+ */
+class DeduplicatingDataLoader : public DataLoader {
+ public:
+  /**
+   * Creates a new DeduplicatingDataLoader.
+   *
+   * @param[in] loader The loader to read data from. Must outlive this
+   *     instance.
+   * @param[in] cache The cache to intern buffers in. Must outlive all of the
+   *     buffers loaded through this instance.
+   * @param[in] min_size Loads smaller than this many bytes are not interned.
+   */
+  explicit DeduplicatingDataLoader(
+      DataLoader* loader,
+      SegmentCache* cache = &SegmentCache::process_cache(),
+      size_t min_size = 4096)
+      : loader_(loader), cache_(cache), min_size_(min_size) {}
+
+  __ET_NODISCARD Result<FreeableBuffer> Load(size_t offset, size_t size)
+      override;
+
+  __ET_NODISCARD Result<size_t> size() const override;
+
+  void will_load(size_t offset, size_t size) override;
+
+  void prefetch(const void* data, size_t size) override;
+
+ private:
+  DataLoader* const loader_;
+  SegmentCache* const cache_;
+  const size_t min_size_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
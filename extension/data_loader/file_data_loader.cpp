@@ -138,19 +138,6 @@ Result<FreeableBuffer> FileDataLoader::Load(size_t offset, size_t size) {
     return FreeableBuffer(nullptr, 0, /*free_fn=*/nullptr);
   }
 
-  // Seek to the right place in the file.
-  off_t seek_offset = ::lseek(fd_, offset, SEEK_SET);
-  if (seek_offset != offset) {
-    ET_LOG(
-        Error,
-        "Seeking %s to offset %zu returned %zd: %s",
-        file_name_,
-        offset,
-        (ssize_t)seek_offset,
-        strerror(errno));
-    return Error::AccessFailed;
-  }
-
   // Allocate memory for the FreeableBuffer.
   size_t alloc_size = size;
   if (alignment_ > alignof(std::max_align_t)) {
@@ -182,11 +169,13 @@ Result<FreeableBuffer> FileDataLoader::Load(size_t offset, size_t size) {
       buffer,
       alloc_size);
 
-  // Read the data into the aligned address.
+  // Read the data into the aligned address. Use pread() rather than a seek and
+  // a read so that concurrent calls don't race on the file position.
   size_t needed = size;
+  size_t read_offset = offset;
   uint8_t* buf = reinterpret_cast<uint8_t*>(aligned_buffer);
   while (needed > 0) {
-    ssize_t nread = ::read(fd_, buf, needed);
+    ssize_t nread = ::pread(fd_, buf, needed, read_offset);
     if (nread < 0 && errno == EINTR) {
       // Interrupted by a signal; zero bytes read.
       continue;
@@ -207,6 +196,7 @@ Result<FreeableBuffer> FileDataLoader::Load(size_t offset, size_t size) {
     }
     needed -= nread;
     buf += nread;
+    read_offset += nread;
   }
 
   // We can't naively free this pointer, since it may not be what malloc() gave
@@ -65,7 +65,8 @@ MmapDataLoader::~MmapDataLoader() {
 
 Result<MmapDataLoader> MmapDataLoader::from(
     const char* file_name,
-    MmapDataLoader::MlockConfig mlock_config) {
+    MmapDataLoader::MlockConfig mlock_config,
+    MmapDataLoader::HugePageConfig huge_page_config) {
   // Cache the page size.
   long page_size = sysconf(_SC_PAGESIZE);
   if (page_size < 0) {
@@ -117,7 +118,8 @@ Result<MmapDataLoader> MmapDataLoader::from(
       file_size,
       file_name_copy,
       static_cast<size_t>(page_size),
-      mlock_config);
+      mlock_config,
+      huge_page_config);
 }
 
 namespace {
@@ -144,8 +146,109 @@ void MunmapSegment(void* context, void* data, size_t size) {
         errno);
   }
 }
+
+/**
+ * Advises the kernel to back the region with transparent huge pages. This is
+ * only a hint, so failures are ignored.
+ */
+void advise_huge_pages(void* addr, size_t size) {
+#ifdef MADV_HUGEPAGE
+  if (::madvise(addr, size, MADV_HUGEPAGE) < 0) {
+    ET_LOG(
+        Debug,
+        "madvise(%p, %zu, MADV_HUGEPAGE) failed: %s (ignored)",
+        addr,
+        size,
+        ::strerror(errno));
+  }
+#else
+  (void)addr;
+  (void)size;
+#endif
+}
 } // namespace
 
+Result<void*> MmapDataLoader::copy_to_huge_pages(
+    size_t offset,
+    size_t map_size,
+    size_t read_size) const {
+  const size_t alloc_size =
+      get_overlapping_pages(0, map_size, kHugePageSize).size;
+
+  // Prefer reserved huge pages, which are always aligned to their size.
+  void* pages = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  pages = ::mmap(
+      nullptr,
+      alloc_size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+      -1,
+      0);
+#endif
+  if (pages == MAP_FAILED) {
+    // Fall back to transparent huge pages. Over-allocate by a huge page so
+    // that the region can start on a huge page boundary, then trim the rest.
+    const size_t reserve_size = alloc_size + kHugePageSize;
+    void* reserved = ::mmap(
+        nullptr,
+        reserve_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    ET_CHECK_OR_RETURN_ERROR(
+        reserved != MAP_FAILED,
+        MemoryAllocationFailed,
+        "File %s: mmap(size=%zu) for huge pages failed: %s",
+        file_name_,
+        reserve_size,
+        ::strerror(errno));
+    const uintptr_t reserved_start = reinterpret_cast<uintptr_t>(reserved);
+    const uintptr_t start =
+        (reserved_start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    const size_t head = start - reserved_start;
+    const size_t tail = reserve_size - head - alloc_size;
+    if (head > 0) {
+      ::munmap(reserved, head);
+    }
+    if (tail > 0) {
+      ::munmap(reinterpret_cast<void*>(start + alloc_size), tail);
+    }
+    pages = reinterpret_cast<void*>(start);
+    advise_huge_pages(pages, alloc_size);
+  }
+
+  size_t needed = read_size;
+  size_t read_offset = offset;
+  uint8_t* buf = static_cast<uint8_t*>(pages);
+  while (needed > 0) {
+    ssize_t nread = ::pread(fd_, buf, needed, read_offset);
+    if (nread < 0 && errno == EINTR) {
+      // Interrupted by a signal; zero bytes read.
+      continue;
+    }
+    if (nread <= 0) {
+      ET_LOG(
+          Error,
+          "Reading from %s: failed to read %zu bytes at offset %zu: %s",
+          file_name_,
+          read_size,
+          offset,
+          nread == 0 ? "EOF" : ::strerror(errno));
+      ::munmap(pages, alloc_size);
+      return Error::AccessFailed;
+    }
+    needed -= nread;
+    buf += nread;
+    read_offset += nread;
+  }
+
+  // Match the protection of the file mappings.
+  ::mprotect(pages, alloc_size, PROT_READ);
+  return pages;
+}
+
 Result<FreeableBuffer> MmapDataLoader::Load(size_t offset, size_t size) {
   ET_CHECK_OR_RETURN_ERROR(
       // Probably had its value moved to another instance.
@@ -176,24 +279,37 @@ Result<FreeableBuffer> MmapDataLoader::Load(size_t offset, size_t size) {
   Range range =
       get_overlapping_pages(static_cast<uintptr_t>(offset), size, page_size_);
 
-  // Map the pages read-only. MAP_PRIVATE vs. MAP_SHARED doesn't matter since
-  // the data is read-only, but use PRIVATE just to further avoid accidentally
-  // modifying the file.
-  void* pages = ::mmap(
-      nullptr,
-      range.size,
-      PROT_READ,
-      MAP_PRIVATE,
-      fd_,
-      static_cast<off_t>(range.start));
-  ET_CHECK_OR_RETURN_ERROR(
-      pages != MAP_FAILED,
-      AccessFailed,
-      "Failed to map %s: mmap(..., size=%zd, ..., fd=%d, offset=0x%zx)",
-      file_name_,
-      range.size,
-      fd_,
-      range.start);
+  void* pages = nullptr;
+  if (huge_page_config_ == HugePageConfig::CopyToHugePages) {
+    Result<void*> copy = copy_to_huge_pages(
+        range.start, range.size, offset + size - range.start);
+    if (!copy.ok()) {
+      return copy.error();
+    }
+    pages = copy.get();
+  } else {
+    // Map the pages read-only. MAP_PRIVATE vs. MAP_SHARED doesn't matter since
+    // the data is read-only, but use PRIVATE just to further avoid accidentally
+    // modifying the file.
+    pages = ::mmap(
+        nullptr,
+        range.size,
+        PROT_READ,
+        MAP_PRIVATE,
+        fd_,
+        static_cast<off_t>(range.start));
+    ET_CHECK_OR_RETURN_ERROR(
+        pages != MAP_FAILED,
+        AccessFailed,
+        "Failed to map %s: mmap(..., size=%zd, ..., fd=%d, offset=0x%zx)",
+        file_name_,
+        range.size,
+        fd_,
+        range.start);
+    if (huge_page_config_ == HugePageConfig::AdviseHugePages) {
+      advise_huge_pages(pages, range.size);
+    }
+  }
 
   if (mlock_config_ == MlockConfig::UseMlock ||
       mlock_config_ == MlockConfig::UseMlockIgnoreErrors) {
@@ -230,6 +346,11 @@ Result<FreeableBuffer> MmapDataLoader::Load(size_t offset, size_t size) {
   // The requested data is at an offset into the mapped pages.
   const void* data = static_cast<const uint8_t*>(pages) + offset - range.start;
 
+  // Huge page copies are unmapped in units of kHugePageSize, since they
+  // start on a huge page boundary and their size was rounded up to it.
+  const size_t unmap_page_size =
+      huge_page_config_ == HugePageConfig::CopyToHugePages ? kHugePageSize
+                                                           : page_size_;
   return FreeableBuffer(
       // The callback knows to unmap the whole pages that encompass this region.
       data,
@@ -237,9 +358,9 @@ Result<FreeableBuffer> MmapDataLoader::Load(size_t offset, size_t size) {
       MunmapSegment,
       /*free_fn_context=*/
       reinterpret_cast<void*>(
-          // Pass the cached OS page size to the callback so it doesn't need to
-          // query it again.
-          static_cast<uintptr_t>(page_size_)));
+          // Pass the page size to the callback so it doesn't need to query it
+          // again.
+          static_cast<uintptr_t>(unmap_page_size)));
 }
 
 Result<size_t> MmapDataLoader::size() const {
@@ -251,6 +372,25 @@ Result<size_t> MmapDataLoader::size() const {
   return file_size_;
 }
 
+void MmapDataLoader::prefetch(const void* data, size_t size) {
+  if (data == nullptr || size == 0 || page_size_ == 0) {
+    return;
+  }
+  Range range = get_overlapping_pages(
+      reinterpret_cast<uintptr_t>(data), size, page_size_);
+  int ret = ::madvise(
+      reinterpret_cast<void*>(range.start), range.size, MADV_WILLNEED);
+  if (ret < 0) {
+    // Only a hint; the data will still be paged in on first access.
+    ET_LOG(
+        Debug,
+        "madvise(0x%zx, %zu, MADV_WILLNEED) failed: %s (ignored)",
+        (size_t)range.start,
+        range.size,
+        ::strerror(errno));
+  }
+}
+
 } // namespace util
 } // namespace executor
 } // namespace torch
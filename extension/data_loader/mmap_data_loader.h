@@ -41,6 +41,27 @@ class MmapDataLoader : public DataLoader {
     UseMlockIgnoreErrors,
   };
 
+  /**
+   * Describes whether to back loaded segments with huge pages, which reduces
+   * TLB pressure when kernels stream through large weight buffers.
+   */
+  enum class HugePageConfig {
+    /// Map the file with the default page size.
+    NoHugePages,
+    /// Map the file and advise the kernel to use transparent huge pages for
+    /// the mapping with `madvise(MADV_HUGEPAGE)`. Only takes effect on file
+    /// systems that support huge pages for file-backed mappings.
+    AdviseHugePages,
+    /// Copy each segment into anonymous memory aligned to `kHugePageSize`,
+    /// using `MAP_HUGETLB` pages if any are reserved and transparent huge
+    /// pages otherwise. Costs a copy and the memory of the segments, but works
+    /// on any file system.
+    CopyToHugePages,
+  };
+
+  /// The huge page size assumed by `HugePageConfig::CopyToHugePages`.
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
   /**
    * Creates a new MmapDataLoader that wraps the named file. Fails if
    * the file can't be opened for reading or if its size can't be found.
@@ -50,10 +71,13 @@ class MmapDataLoader : public DataLoader {
    *     overhead of opening it again for every Load() call.
    * @param[in] mlock_config How and whether to lock loaded pages with
    *     `mlock()`.
+   * @param[in] huge_page_config Whether to back loaded segments with huge
+   *     pages.
    */
   static Result<MmapDataLoader> from(
       const char* file_name,
-      MlockConfig mlock_config = MlockConfig::UseMlock);
+      MlockConfig mlock_config = MlockConfig::UseMlock,
+      HugePageConfig huge_page_config = HugePageConfig::NoHugePages);
 
   /// DEPRECATED: Use the lowercase `from()` instead.
   __ET_DEPRECATED static Result<MmapDataLoader> From(
@@ -76,12 +100,14 @@ class MmapDataLoader : public DataLoader {
         file_size_(rhs.file_size_),
         page_size_(rhs.page_size_),
         fd_(rhs.fd_),
-        mlock_config_(rhs.mlock_config_) {
+        mlock_config_(rhs.mlock_config_),
+        huge_page_config_(rhs.huge_page_config_) {
     rhs.file_name_ = nullptr;
     rhs.file_size_ = 0;
     rhs.page_size_ = 0;
     rhs.fd_ = -1;
     rhs.mlock_config_ = MlockConfig::NoMlock;
+    rhs.huge_page_config_ = HugePageConfig::NoHugePages;
   }
 
   ~MmapDataLoader() override;
@@ -91,18 +117,36 @@ class MmapDataLoader : public DataLoader {
 
   __ET_NODISCARD Result<size_t> size() const override;
 
+  /**
+   * Asks the kernel to read the pages covering the region ahead of their first
+   * access.
+   */
+  void prefetch(const void* data, size_t size) override;
+
  private:
   MmapDataLoader(
       int fd,
       size_t file_size,
       const char* file_name,
       size_t page_size,
-      MlockConfig mlock_config)
+      MlockConfig mlock_config,
+      HugePageConfig huge_page_config)
       : file_name_(file_name),
         file_size_(file_size),
         page_size_(page_size),
         fd_(fd),
-        mlock_config_(mlock_config) {}
+        mlock_config_(mlock_config),
+        huge_page_config_(huge_page_config) {}
+
+  /**
+   * Copies `read_size` bytes of the file at the page-aligned `offset` into a
+   * new read-only region of `map_size` bytes rounded up to `kHugePageSize`,
+   * aligned to `kHugePageSize`.
+   */
+  Result<void*> copy_to_huge_pages(
+      size_t offset,
+      size_t map_size,
+      size_t read_size) const;
 
   // Not safely copyable.
   MmapDataLoader(const MmapDataLoader&) = delete;
@@ -114,6 +158,7 @@ class MmapDataLoader : public DataLoader {
   size_t page_size_;
   int fd_; // Owned by the instance.
   MlockConfig mlock_config_;
+  HugePageConfig huge_page_config_;
 };
 
 } // namespace util
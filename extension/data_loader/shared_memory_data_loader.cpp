@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/shared_memory_data_loader.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+/**
+ * Resizes the shared-memory region `fd` to the size of `file_name` and copies
+ * the file into it. Leaves no writable mapping of the region behind, so that
+ * it can be sealed.
+ */
+Error copy_file_to_region(const char* file_name, int fd) {
+  int file_fd = ::open(file_name, O_RDONLY);
+  if (file_fd < 0) {
+    ET_LOG(
+        Error,
+        "Failed to open %s: %s (%d)",
+        file_name,
+        ::strerror(errno),
+        errno);
+    return Error::AccessFailed;
+  }
+  struct stat st;
+  if (::fstat(file_fd, &st) < 0) {
+    ET_LOG(
+        Error,
+        "Could not get length of %s: %s (%d)",
+        file_name,
+        ::strerror(errno),
+        errno);
+    ::close(file_fd);
+    return Error::AccessFailed;
+  }
+  const size_t file_size = st.st_size;
+  if (::ftruncate(fd, static_cast<off_t>(file_size)) < 0) {
+    ET_LOG(
+        Error,
+        "Could not resize shared memory to %zu bytes: %s (%d)",
+        file_size,
+        ::strerror(errno),
+        errno);
+    ::close(file_fd);
+    return Error::AccessFailed;
+  }
+  if (file_size == 0) {
+    ::close(file_fd);
+    return Error::Ok;
+  }
+
+  void* region =
+      ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (region == MAP_FAILED) {
+    ET_LOG(
+        Error,
+        "Could not map %zu bytes of shared memory: %s (%d)",
+        file_size,
+        ::strerror(errno),
+        errno);
+    ::close(file_fd);
+    return Error::AccessFailed;
+  }
+  Error status = Error::Ok;
+  uint8_t* buf = static_cast<uint8_t*>(region);
+  size_t offset = 0;
+  while (offset < file_size) {
+    ssize_t nread = ::pread(file_fd, buf + offset, file_size - offset, offset);
+    if (nread < 0 && errno == EINTR) {
+      // Interrupted by a signal; zero bytes read.
+      continue;
+    }
+    if (nread <= 0) {
+      ET_LOG(
+          Error,
+          "Reading from %s: failed to read %zu bytes at offset %zu: %s",
+          file_name,
+          file_size - offset,
+          offset,
+          nread == 0 ? "EOF" : ::strerror(errno));
+      status = Error::AccessFailed;
+      break;
+    }
+    offset += nread;
+  }
+  ::munmap(region, file_size);
+  ::close(file_fd);
+  return status;
+}
+
+} // namespace
+
+Error SharedMemoryDataLoader::create_named_region(
+    const char* name,
+    const char* file_name) {
+  // Readers can only open the object read-only; this descriptor stays
+  // writable since it created the object.
+  int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IRGRP);
+  if (fd < 0) {
+    ET_LOG(
+        Error,
+        "Failed to create shared memory %s: %s (%d)",
+        name,
+        ::strerror(errno),
+        errno);
+    return Error::AccessFailed;
+  }
+  Error err = copy_file_to_region(file_name, fd);
+  ::close(fd);
+  if (err != Error::Ok) {
+    ::shm_unlink(name);
+  }
+  return err;
+}
+
+Result<int> SharedMemoryDataLoader::create_memfd_region(
+    const char* file_name) {
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+  int fd =
+      ::memfd_create("executorch_program", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    ET_LOG(Error, "memfd_create failed: %s (%d)", ::strerror(errno), errno);
+    return Error::AccessFailed;
+  }
+  Error err = copy_file_to_region(file_name, fd);
+  if (err != Error::Ok) {
+    ::close(fd);
+    return err;
+  }
+  // Keep the serving processes from modifying the shared copy.
+  if (::fcntl(
+          fd,
+          F_ADD_SEALS,
+          F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+    ET_LOG(Error, "Failed to seal memfd: %s (%d)", ::strerror(errno), errno);
+    ::close(fd);
+    return Error::AccessFailed;
+  }
+  return fd;
+#else
+  (void)file_name;
+  ET_LOG(Error, "memfd is not supported on this system");
+  return Error::NotSupported;
+#endif
+}
+
+Result<SharedMemoryDataLoader> SharedMemoryDataLoader::from_name(
+    const char* name) {
+  int fd = ::shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    ET_LOG(
+        Error,
+        "Failed to open shared memory %s: %s (%d)",
+        name,
+        ::strerror(errno),
+        errno);
+    return Error::AccessFailed;
+  }
+  return from_fd(fd);
+}
+
+Result<SharedMemoryDataLoader> SharedMemoryDataLoader::from_fd(
+    int fd,
+    size_t size) {
+  if (size == 0) {
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+      ET_LOG(
+          Error,
+          "Could not get size of fd %d: %s (%d)",
+          fd,
+          ::strerror(errno),
+          errno);
+      ::close(fd);
+      return Error::AccessFailed;
+    }
+    size = st.st_size;
+  }
+  if (size == 0) {
+    ET_LOG(Error, "Shared memory fd %d is empty", fd);
+    ::close(fd);
+    return Error::InvalidArgument;
+  }
+  // Map the whole region once; every process mapping it shares its pages.
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    ET_LOG(
+        Error,
+        "Failed to map shared memory: mmap(size=%zu, fd=%d): %s (%d)",
+        size,
+        fd,
+        ::strerror(errno),
+        errno);
+    ::close(fd);
+    return Error::AccessFailed;
+  }
+  return SharedMemoryDataLoader(data, size, fd);
+}
+
+SharedMemoryDataLoader::~SharedMemoryDataLoader() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<void*>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+Result<FreeableBuffer> SharedMemoryDataLoader::Load(
+    size_t offset,
+    size_t size) {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      data_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+  ET_CHECK_OR_RETURN_ERROR(
+      offset + size <= size_,
+      InvalidArgument,
+      "offset %zu + size %zu > size_ %zu",
+      offset,
+      size,
+      size_);
+  // The data stays mapped for the lifetime of the loader, so there is
+  // nothing to free.
+  return FreeableBuffer(
+      static_cast<const uint8_t*>(data_) + offset, size, /*free_fn=*/nullptr);
+}
+
+Result<size_t> SharedMemoryDataLoader::size() const {
+  ET_CHECK_OR_RETURN_ERROR(
+      // Probably had its value moved to another instance.
+      data_ != nullptr,
+      InvalidState,
+      "Uninitialized");
+  return size_;
+}
+
+void SharedMemoryDataLoader::prefetch(const void* data, size_t size) {
+  if (data == nullptr || size == 0) {
+    return;
+  }
+  const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(page_size - 1);
+  const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+  if (::madvise(
+          reinterpret_cast<void*>(start), end - start, MADV_WILLNEED) < 0) {
+    // Only a hint; the data will still be paged in on first access.
+    ET_LOG(
+        Debug,
+        "madvise(0x%zx, %zu, MADV_WILLNEED) failed: %s (ignored)",
+        static_cast<size_t>(start),
+        static_cast<size_t>(end - start),
+        ::strerror(errno));
+  }
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
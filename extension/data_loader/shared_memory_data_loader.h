@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A DataLoader that loads segments from a shared-memory region holding a
+ * whole program file, so that processes serving the same model share a
+ * single copy of it.
+ *
+ * A coordinator process copies the file into a region once, with
+ * create_named_region() or create_memfd_region(). Each serving process then
+ * maps the region read-only with from_name() or from_fd(). Loaded
+ * FreeableBuffers alias the mapping instead of copying from it, and freeing
+ * them does nothing, so delegate payloads share the region too unless the
+ * backend copies or repacks them.
+ *
+ * The region is mapped once for the lifetime of the loader, which must
+ * outlive the buffers it returns.
+ */
+class SharedMemoryDataLoader : public DataLoader {
+ public:
+  /**
+   * Creates the POSIX shared-memory object `name`, e.g. "/model.pte", holding
+   * the contents of `file_name`. The object is read-only for the processes
+   * opening it, and lives until shm_unlink(), or reboot.
+   *
+   * @retval Error::AccessFailed The file could not be read, or the object
+   *     could not be created, e.g. because it already exists.
+   */
+  __ET_NODISCARD static Error create_named_region(
+      const char* name,
+      const char* file_name);
+
+  /**
+   * Creates an anonymous memfd holding the contents of `file_name`, sealed
+   * against writes and resizes, for the coordinator to pass to the serving
+   * processes, e.g. by fork() or over a Unix socket.
+   *
+   * @returns The file descriptor, owned by the caller.
+   * @retval Error::NotSupported memfds are not available on this system.
+   */
+  __ET_NODISCARD static Result<int> create_memfd_region(const char* file_name);
+
+  /**
+   * Creates a new SharedMemoryDataLoader that maps the POSIX shared-memory
+   * object `name` read-only.
+   */
+  static Result<SharedMemoryDataLoader> from_name(const char* name);
+
+  /**
+   * Creates a new SharedMemoryDataLoader that maps the shared-memory region
+   * referred to by `fd`, e.g. a memfd or an ashmem region, read-only. Takes
+   * ownership of `fd`, even on failure.
+   *
+   * @param[in] fd The file descriptor of the region.
+   * @param[in] size The size of the region in bytes. If zero, uses the size
+   *     reported by fstat(), which is not available for ashmem regions.
+   */
+  static Result<SharedMemoryDataLoader> from_fd(int fd, size_t size = 0);
+
+  // Movable to be compatible with Result.
+  SharedMemoryDataLoader(SharedMemoryDataLoader&& rhs) noexcept
+      : data_(rhs.data_), size_(rhs.size_), fd_(rhs.fd_) {
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    rhs.fd_ = -1;
+  }
+
+  ~SharedMemoryDataLoader() override;
+
+  __ET_NODISCARD Result<FreeableBuffer> Load(size_t offset, size_t size)
+      override;
+
+  __ET_NODISCARD Result<size_t> size() const override;
+
+  /**
+   * Asks the kernel to bring the pages covering the region into the mapping
+   * ahead of their first access.
+   */
+  void prefetch(const void* data, size_t size) override;
+
+ private:
+  SharedMemoryDataLoader(const void* data, size_t size, int fd)
+      : data_(data), size_(size), fd_(fd) {}
+
+  // Not safely copyable.
+  SharedMemoryDataLoader(const SharedMemoryDataLoader&) = delete;
+  SharedMemoryDataLoader& operator=(const SharedMemoryDataLoader&) = delete;
+  SharedMemoryDataLoader& operator=(SharedMemoryDataLoader&&) = delete;
+
+  const void* data_; // Mapping of the whole region, owned by the instance.
+  size_t size_;
+  int fd_; // Owned by the instance.
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
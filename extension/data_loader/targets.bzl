@@ -67,3 +67,42 @@ def define_common_targets():
             "//executorch/runtime/core:core",
         ],
     )
+
+    runtime.cxx_library(
+        name = "shared_memory_data_loader",
+        srcs = ["shared_memory_data_loader.cpp"],
+        exported_headers = ["shared_memory_data_loader.h"],
+        visibility = [
+            "//executorch/extension/data_loader/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "deduplicating_data_loader",
+        srcs = ["deduplicating_data_loader.cpp"],
+        exported_headers = ["deduplicating_data_loader.h"],
+        visibility = [
+            "//executorch/extension/data_loader/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "async_data_loader",
+        srcs = ["async_data_loader.cpp"],
+        exported_headers = ["async_data_loader.h"],
+        visibility = [
+            "//executorch/extension/data_loader/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+    )
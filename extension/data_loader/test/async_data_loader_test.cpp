@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/async_data_loader.h>
+
+#include <atomic>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/data_loader/buffer_data_loader.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using torch::executor::DataLoader;
+using torch::executor::Error;
+using torch::executor::FreeableBuffer;
+using torch::executor::Result;
+using torch::executor::util::AsyncDataLoader;
+using torch::executor::util::BufferDataLoader;
+
+namespace {
+
+// Forwards to a BufferDataLoader and counts the loads.
+class CountingDataLoader : public DataLoader {
+ public:
+  CountingDataLoader(const void* data, size_t size) : loader_(data, size) {}
+
+  Result<FreeableBuffer> Load(size_t offset, size_t size) override {
+    ++num_loads;
+    return loader_.Load(offset, size);
+  }
+
+  Result<size_t> size() const override {
+    return loader_.size();
+  }
+
+  std::atomic<size_t> num_loads{0};
+
+ private:
+  BufferDataLoader loader_;
+};
+
+} // namespace
+
+class AsyncDataLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+
+    for (int i = 0; i < sizeof(data_); ++i) {
+      data_[i] = i;
+    }
+  }
+
+  uint8_t data_[256];
+};
+
+TEST_F(AsyncDataLoaderTest, AnnouncedLoadIsClaimed) {
+  CountingDataLoader base(data_, sizeof(data_));
+  AsyncDataLoader loader(&base);
+
+  loader.will_load(/*offset=*/16, /*size=*/32);
+
+  Result<FreeableBuffer> fb = loader.Load(/*offset=*/16, /*size=*/32);
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_EQ(fb->size(), 32);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_ + 16, fb->size()));
+
+  // The claimed load was the only one made.
+  EXPECT_EQ(base.num_loads, 1);
+
+  // Loading the same range again reads it again.
+  Result<FreeableBuffer> fb2 = loader.Load(/*offset=*/16, /*size=*/32);
+  ASSERT_EQ(fb2.error(), Error::Ok);
+  EXPECT_EQ(base.num_loads, 2);
+}
+
+TEST_F(AsyncDataLoaderTest, UnannouncedLoadIsForwarded) {
+  CountingDataLoader base(data_, sizeof(data_));
+  AsyncDataLoader loader(&base);
+
+  // A different range than the announced one.
+  loader.will_load(/*offset=*/0, /*size=*/8);
+  Result<FreeableBuffer> fb = loader.Load(/*offset=*/8, /*size=*/8);
+  ASSERT_EQ(fb.error(), Error::Ok);
+  EXPECT_EQ(0, std::memcmp(fb->data(), data_ + 8, fb->size()));
+
+  Result<size_t> size = loader.size();
+  ASSERT_EQ(size.error(), Error::Ok);
+  EXPECT_EQ(*size, sizeof(data_));
+}
+
+TEST_F(AsyncDataLoaderTest, AnnouncedLoadErrorIsReturned) {
+  CountingDataLoader base(data_, sizeof(data_));
+  AsyncDataLoader loader(&base);
+
+  loader.will_load(/*offset=*/sizeof(data_), /*size=*/1);
+  Result<FreeableBuffer> fb = loader.Load(/*offset=*/sizeof(data_), /*size=*/1);
+  EXPECT_NE(fb.error(), Error::Ok);
+  EXPECT_EQ(base.num_loads, 1);
+}
+
+TEST_F(AsyncDataLoaderTest, AnnouncementsBeyondLimitAreIgnored) {
+  CountingDataLoader base(data_, sizeof(data_));
+  {
+    AsyncDataLoader loader(&base, /*max_pending=*/2);
+    loader.will_load(/*offset=*/0, /*size=*/4);
+    loader.will_load(/*offset=*/4, /*size=*/4);
+    loader.will_load(/*offset=*/8, /*size=*/4);
+
+    // Unclaimed loads are waited for and freed on destruction.
+  }
+  EXPECT_EQ(base.num_loads, 2);
+}
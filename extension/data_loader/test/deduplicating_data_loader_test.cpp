@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/deduplicating_data_loader.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using torch::executor::DataLoader;
+using torch::executor::Error;
+using torch::executor::FreeableBuffer;
+using torch::executor::Result;
+using torch::executor::util::DeduplicatingDataLoader;
+using torch::executor::util::SegmentCache;
+
+namespace {
+
+// Copies the requested range of a buffer into a new allocation, like
+// FileDataLoader, and counts the allocations still alive.
+class CopyingDataLoader : public DataLoader {
+ public:
+  CopyingDataLoader(const uint8_t* data, size_t size)
+      : data_(data), size_(size) {}
+
+  Result<FreeableBuffer> Load(size_t offset, size_t size) override {
+    if (offset + size > size_) {
+      return Error::InvalidArgument;
+    }
+    void* copy = std::malloc(size);
+    std::memcpy(copy, data_ + offset, size);
+    ++num_live_buffers;
+    return FreeableBuffer(copy, size, free_copy, this);
+  }
+
+  Result<size_t> size() const override {
+    return size_;
+  }
+
+  size_t num_live_buffers = 0;
+
+ private:
+  static void free_copy(void* context, void* data, size_t /*size*/) {
+    --static_cast<CopyingDataLoader*>(context)->num_live_buffers;
+    std::free(data);
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+};
+
+} // namespace
+
+class DeduplicatingDataLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+
+    for (size_t i = 0; i < sizeof(data_); ++i) {
+      data_[i] = static_cast<uint8_t>(i % 251);
+    }
+  }
+
+  uint8_t data_[8192];
+};
+
+TEST_F(DeduplicatingDataLoaderTest, SharesIdenticalSegmentsAcrossLoaders) {
+  SegmentCache cache;
+  CopyingDataLoader first(data_, sizeof(data_));
+  CopyingDataLoader second(data_, sizeof(data_));
+  DeduplicatingDataLoader first_dedup(&first, &cache, /*min_size=*/64);
+  DeduplicatingDataLoader second_dedup(&second, &cache, /*min_size=*/64);
+
+  Result<FreeableBuffer> a = first_dedup.Load(0, 1024);
+  ASSERT_EQ(a.error(), Error::Ok);
+  Result<FreeableBuffer> b = second_dedup.Load(0, 1024);
+  ASSERT_EQ(b.error(), Error::Ok);
+
+  // The second copy was freed in favor of the first one.
+  EXPECT_EQ(a->data(), b->data());
+  EXPECT_EQ(b->size(), 1024);
+  EXPECT_EQ(0, std::memcmp(b->data(), data_, 1024));
+  EXPECT_EQ(first.num_live_buffers, 1);
+  EXPECT_EQ(second.num_live_buffers, 0);
+  EXPECT_EQ(cache.num_entries(), 1);
+  EXPECT_EQ(cache.num_bytes_deduplicated(), 1024);
+
+  // The cached copy lives until its last reference is freed.
+  a->Free();
+  EXPECT_EQ(first.num_live_buffers, 1);
+  EXPECT_EQ(0, std::memcmp(b->data(), data_, 1024));
+  b->Free();
+  EXPECT_EQ(first.num_live_buffers, 0);
+  EXPECT_EQ(cache.num_entries(), 0);
+}
+
+TEST_F(DeduplicatingDataLoaderTest, KeepsDifferentSegmentsApart) {
+  SegmentCache cache;
+  CopyingDataLoader loader(data_, sizeof(data_));
+  DeduplicatingDataLoader dedup(&loader, &cache, /*min_size=*/64);
+
+  // Same size, different contents.
+  Result<FreeableBuffer> a = dedup.Load(0, 1024);
+  ASSERT_EQ(a.error(), Error::Ok);
+  Result<FreeableBuffer> b = dedup.Load(1, 1024);
+  ASSERT_EQ(b.error(), Error::Ok);
+
+  EXPECT_NE(a->data(), b->data());
+  EXPECT_EQ(0, std::memcmp(b->data(), data_ + 1, 1024));
+  EXPECT_EQ(loader.num_live_buffers, 2);
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_EQ(cache.num_bytes_deduplicated(), 0);
+}
+
+TEST_F(DeduplicatingDataLoaderTest, DoesNotInternSmallLoads) {
+  SegmentCache cache;
+  CopyingDataLoader loader(data_, sizeof(data_));
+  DeduplicatingDataLoader dedup(&loader, &cache, /*min_size=*/64);
+
+  Result<FreeableBuffer> a = dedup.Load(0, 32);
+  ASSERT_EQ(a.error(), Error::Ok);
+  Result<FreeableBuffer> b = dedup.Load(0, 32);
+  ASSERT_EQ(b.error(), Error::Ok);
+
+  EXPECT_NE(a->data(), b->data());
+  EXPECT_EQ(cache.num_entries(), 0);
+}
+
+TEST_F(DeduplicatingDataLoaderTest, ForwardsErrorsAndSize) {
+  CopyingDataLoader loader(data_, sizeof(data_));
+  DeduplicatingDataLoader dedup(&loader);
+
+  Result<size_t> size = dedup.size();
+  ASSERT_EQ(size.error(), Error::Ok);
+  EXPECT_EQ(*size, sizeof(data_));
+
+  Result<FreeableBuffer> fb = dedup.Load(sizeof(data_), 4096);
+  EXPECT_EQ(fb.error(), Error::InvalidArgument);
+}
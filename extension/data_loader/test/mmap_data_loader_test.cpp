@@ -40,13 +40,17 @@ class MmapDataLoaderTest : public ::testing::Test {
   }
 
   // Declared as a method so it can see `page_size_`.
-  void test_in_bounds_loads_succeed(MmapDataLoader::MlockConfig mlock_config);
+  void test_in_bounds_loads_succeed(
+      MmapDataLoader::MlockConfig mlock_config,
+      MmapDataLoader::HugePageConfig huge_page_config =
+          MmapDataLoader::HugePageConfig::NoHugePages);
 
   size_t page_size_;
 };
 
 void MmapDataLoaderTest::test_in_bounds_loads_succeed(
-    MmapDataLoader::MlockConfig mlock_config) {
+    MmapDataLoader::MlockConfig mlock_config,
+    MmapDataLoader::HugePageConfig huge_page_config) {
   // Create a file containing multiple pages' worth of data, where each
   // 4-byte word has a different value.
   const size_t contents_size = 8 * page_size_;
@@ -57,8 +61,8 @@ void MmapDataLoaderTest::test_in_bounds_loads_succeed(
   TempFile tf(contents.get(), contents_size);
 
   // Wrap it in a loader.
-  Result<MmapDataLoader> mdl =
-      MmapDataLoader::from(tf.path().c_str(), mlock_config);
+  Result<MmapDataLoader> mdl = MmapDataLoader::from(
+      tf.path().c_str(), mlock_config, huge_page_config);
   ASSERT_EQ(mdl.error(), Error::Ok);
 
   // size() should succeed and reflect the total size.
@@ -210,6 +214,66 @@ TEST_F(MmapDataLoaderTest, InBoundsLoadsSucceedUseMlockIgnoreErrors) {
       MmapDataLoader::MlockConfig::UseMlockIgnoreErrors);
 }
 
+TEST_F(MmapDataLoaderTest, InBoundsLoadsSucceedAdviseHugePages) {
+  // Whether huge pages are used depends on the host, but exercise the path to
+  // make sure the code still behaves correctly.
+  test_in_bounds_loads_succeed(
+      MmapDataLoader::MlockConfig::NoMlock,
+      MmapDataLoader::HugePageConfig::AdviseHugePages);
+}
+
+TEST_F(MmapDataLoaderTest, InBoundsLoadsSucceedCopyToHugePages) {
+  test_in_bounds_loads_succeed(
+      MmapDataLoader::MlockConfig::NoMlock,
+      MmapDataLoader::HugePageConfig::CopyToHugePages);
+  test_in_bounds_loads_succeed(
+      MmapDataLoader::MlockConfig::UseMlockIgnoreErrors,
+      MmapDataLoader::HugePageConfig::CopyToHugePages);
+}
+
+TEST_F(MmapDataLoaderTest, CopyToHugePagesAlignsSegments) {
+  // Create a file with a trailing partial page, where each byte has a
+  // different value modulo 251.
+  const size_t contents_size = 5 * page_size_ + page_size_ / 2;
+  auto contents = std::make_unique<uint8_t[]>(contents_size);
+  for (size_t i = 0; i < contents_size; ++i) {
+    contents[i] = static_cast<uint8_t>(i % 251);
+  }
+  TempFile tf(contents.get(), contents_size);
+
+  Result<MmapDataLoader> mdl = MmapDataLoader::from(
+      tf.path().c_str(),
+      MmapDataLoader::MlockConfig::NoMlock,
+      MmapDataLoader::HugePageConfig::CopyToHugePages);
+  ASSERT_EQ(mdl.error(), Error::Ok);
+
+  // A page-aligned segment starts on a huge page boundary.
+  {
+    const size_t offset = 2 * page_size_;
+    const size_t size = page_size_ + 3;
+    Result<FreeableBuffer> fb = mdl->Load(offset, size);
+    ASSERT_EQ(fb.error(), Error::Ok);
+    EXPECT_EQ(fb->size(), size);
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(fb->data()) %
+            MmapDataLoader::kHugePageSize,
+        0);
+    EXPECT_EQ(0, std::memcmp(fb->data(), &contents[offset], fb->size()));
+  }
+
+  // An unaligned segment that runs to the end of the file keeps its offset
+  // within the page.
+  {
+    const size_t offset = 4 * page_size_ + 7;
+    const size_t size = contents_size - offset;
+    Result<FreeableBuffer> fb = mdl->Load(offset, size);
+    ASSERT_EQ(fb.error(), Error::Ok);
+    EXPECT_EQ(fb->size(), size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(fb->data()) % page_size_, 7);
+    EXPECT_EQ(0, std::memcmp(fb->data(), &contents[offset], fb->size()));
+  }
+}
+
 TEST_F(MmapDataLoaderTest, FinalPageOfUnevenFileSucceeds) {
   // Create a file whose length is not an even multiple of a page.
   // Each 4-byte word in the file has a different value.
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/data_loader/shared_memory_data_loader.h>
+
+#include <cstring>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/testing_util/temp_file.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using torch::executor::Error;
+using torch::executor::FreeableBuffer;
+using torch::executor::Result;
+using torch::executor::testing::TempFile;
+using torch::executor::util::SharedMemoryDataLoader;
+
+class SharedMemoryDataLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+
+  // A name unique to the test process.
+  static std::string region_name() {
+    return "/executorch_shm_test_" + std::to_string(::getpid());
+  }
+};
+
+TEST_F(SharedMemoryDataLoaderTest, NamedRegionLoadsAliasTheRegion) {
+  const std::string contents = "0123456789abcdefghij";
+  TempFile tf(contents);
+  const std::string name = region_name();
+  ASSERT_EQ(
+      SharedMemoryDataLoader::create_named_region(
+          name.c_str(), tf.path().c_str()),
+      Error::Ok);
+  // The name is taken until unlinked.
+  EXPECT_EQ(
+      SharedMemoryDataLoader::create_named_region(
+          name.c_str(), tf.path().c_str()),
+      Error::AccessFailed);
+
+  Result<SharedMemoryDataLoader> loader =
+      SharedMemoryDataLoader::from_name(name.c_str());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  // Loaders opened by name work after unlinking, like open files.
+  ASSERT_EQ(::shm_unlink(name.c_str()), 0);
+  Result<SharedMemoryDataLoader> second =
+      SharedMemoryDataLoader::from_name(name.c_str());
+  EXPECT_EQ(second.error(), Error::AccessFailed);
+
+  Result<size_t> size = loader->size();
+  ASSERT_EQ(size.error(), Error::Ok);
+  EXPECT_EQ(*size, contents.size());
+
+  Result<FreeableBuffer> first = loader->Load(/*offset=*/3, /*size=*/5);
+  ASSERT_EQ(first.error(), Error::Ok);
+  EXPECT_EQ(std::memcmp(first->data(), "34567", 5), 0);
+  Result<FreeableBuffer> again = loader->Load(/*offset=*/0, contents.size());
+  ASSERT_EQ(again.error(), Error::Ok);
+  // Both buffers point into the one mapping of the region.
+  EXPECT_EQ(static_cast<const char*>(again->data()) + 3, first->data());
+  first->Free();
+  EXPECT_EQ(std::memcmp(again->data(), contents.data(), contents.size()), 0);
+  loader->prefetch(again->data(), again->size());
+
+  EXPECT_EQ(
+      loader->Load(/*offset=*/contents.size(), /*size=*/1).error(),
+      Error::InvalidArgument);
+}
+
+TEST_F(SharedMemoryDataLoaderTest, MemfdRegion) {
+  const std::string contents = "shared program data";
+  TempFile tf(contents);
+  Result<int> fd =
+      SharedMemoryDataLoader::create_memfd_region(tf.path().c_str());
+  if (fd.error() == Error::NotSupported) {
+    GTEST_SKIP() << "memfd is not supported";
+  }
+  ASSERT_EQ(fd.error(), Error::Ok);
+  // As a serving process would, use a descriptor of its own.
+  int worker_fd = ::dup(*fd);
+  ASSERT_GE(worker_fd, 0);
+  // The region is sealed against writes.
+  EXPECT_LT(::write(*fd, "x", 1), 0);
+  ::close(*fd);
+
+  Result<SharedMemoryDataLoader> loader =
+      SharedMemoryDataLoader::from_fd(worker_fd);
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<FreeableBuffer> buffer = loader->Load(/*offset=*/7, /*size=*/7);
+  ASSERT_EQ(buffer.error(), Error::Ok);
+  EXPECT_EQ(std::memcmp(buffer->data(), "program", 7), 0);
+
+  // Moving the loader keeps the mapping alive.
+  SharedMemoryDataLoader moved(std::move(*loader));
+  EXPECT_EQ(std::memcmp(buffer->data(), "program", 7), 0);
+  EXPECT_EQ(loader->Load(0, 1).error(), Error::InvalidState);
+  EXPECT_EQ(moved.size().get(), contents.size());
+}
+
+TEST_F(SharedMemoryDataLoaderTest, FromFdFailures) {
+  EXPECT_EQ(
+      SharedMemoryDataLoader::from_fd(/*fd=*/-1).error(), Error::AccessFailed);
+  EXPECT_EQ(
+      SharedMemoryDataLoader::create_memfd_region("/no/such/file").error(),
+      Error::AccessFailed);
+}
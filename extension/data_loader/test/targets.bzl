@@ -7,6 +7,17 @@ def define_common_targets():
     TARGETS and BUCK files that call this function.
     """
 
+    runtime.cxx_test(
+        name = "async_data_loader_test",
+        srcs = [
+            "async_data_loader_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/data_loader:async_data_loader",
+            "//executorch/extension/data_loader:buffer_data_loader",
+        ],
+    )
+
     runtime.cxx_test(
         name = "buffer_data_loader_test",
         srcs = [
@@ -48,3 +59,24 @@ def define_common_targets():
             "//executorch/extension/data_loader:mmap_data_loader",
         ],
     )
+
+    runtime.cxx_test(
+        name = "shared_memory_data_loader_test",
+        srcs = [
+            "shared_memory_data_loader_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/testing_util:temp_file",
+            "//executorch/extension/data_loader:shared_memory_data_loader",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "deduplicating_data_loader_test",
+        srcs = [
+            "deduplicating_data_loader_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/data_loader:deduplicating_data_loader",
+        ],
+    )
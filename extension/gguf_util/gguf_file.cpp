@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/gguf_util/gguf_file.h>
+
+#include <cinttypes>
+#include <cstring>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+// "GGUF" in little-endian byte order.
+constexpr uint32_t kGgufMagic = 0x46554747;
+// The alignment of the tensor data when general.alignment is not set.
+constexpr uint64_t kDefaultAlignment = 32;
+// Arrays of arrays are allowed; bound the nesting of untrusted input.
+constexpr int kMaxArrayDepth = 8;
+
+// The GGUF metadata value types.
+enum ValueType : uint32_t {
+  kUint8 = 0,
+  kInt8 = 1,
+  kUint16 = 2,
+  kInt16 = 3,
+  kUint32 = 4,
+  kInt32 = 5,
+  kFloat32 = 6,
+  kBool = 7,
+  kString = 8,
+  kArray = 9,
+  kUint64 = 10,
+  kInt64 = 11,
+  kFloat64 = 12,
+};
+
+// Reads little-endian values from the file, failing instead of reading past
+// its end.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  bool read(T* value) {
+    if (size_ - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool read_string(std::string* value) {
+    uint64_t length;
+    if (!read(&length) || size_ - offset_ < length) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return true;
+  }
+
+  bool skip(uint64_t nbytes) {
+    if (size_ - offset_ < nbytes) {
+      return false;
+    }
+    offset_ += nbytes;
+    return true;
+  }
+
+  size_t offset() const {
+    return offset_;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+size_t scalar_value_size(uint32_t type) {
+  switch (type) {
+    case kUint8:
+    case kInt8:
+    case kBool:
+      return 1;
+    case kUint16:
+    case kInt16:
+      return 2;
+    case kUint32:
+    case kInt32:
+    case kFloat32:
+      return 4;
+    case kUint64:
+    case kInt64:
+    case kFloat64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+bool skip_value(Reader& reader, uint32_t type, int depth) {
+  if (type == kString) {
+    std::string value;
+    return reader.read_string(&value);
+  }
+  if (type == kArray) {
+    uint32_t item_type;
+    uint64_t count;
+    if (depth >= kMaxArrayDepth || !reader.read(&item_type) ||
+        !reader.read(&count)) {
+      return false;
+    }
+    const size_t item_size = scalar_value_size(item_type);
+    if (item_size > 0) {
+      return count <= UINT64_MAX / item_size && reader.skip(count * item_size);
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+      if (!skip_value(reader, item_type, depth + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  const size_t size = scalar_value_size(type);
+  return size > 0 && reader.skip(size);
+}
+
+// Returns the size of the data of a tensor of `numel` elements, or 0 if the
+// type is not supported.
+size_t tensor_nbytes(uint32_t type, uint64_t numel) {
+  if (numel > SIZE_MAX / 4) {
+    return 0;
+  }
+  switch (static_cast<GgufFile::TensorType>(type)) {
+    case GgufFile::TensorType::F32:
+      return numel * 4;
+    case GgufFile::TensorType::F16:
+      return numel * 2;
+    // Blocks of 32 elements with an fp16 scale.
+    case GgufFile::TensorType::Q4_0:
+      return numel % 32 == 0 ? numel / 32 * 18 : 0;
+    case GgufFile::TensorType::Q8_0:
+      return numel % 32 == 0 ? numel / 32 * 34 : 0;
+    default:
+      return 0;
+  }
+}
+
+} // namespace
+
+GgufFile::GgufFile(FreeableBuffer data, std::vector<TensorInfo> tensors)
+    : data_(std::move(data)), tensors_(std::move(tensors)) {
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    tensor_index_.emplace(tensors_[i].name, i);
+  }
+}
+
+Result<GgufFile> GgufFile::load(DataLoader* loader) {
+  Result<size_t> size = loader->size();
+  if (!size.ok()) {
+    return size.error();
+  }
+  Result<FreeableBuffer> data = loader->Load(0, size.get());
+  if (!data.ok()) {
+    return data.error();
+  }
+  const auto* bytes = static_cast<const uint8_t*>(data->data());
+  Reader reader(bytes, data->size());
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t num_tensors;
+  uint64_t num_kv;
+  ET_CHECK_OR_RETURN_ERROR(
+      reader.read(&magic) && magic == kGgufMagic,
+      InvalidArgument,
+      "Not a GGUF file");
+  ET_CHECK_OR_RETURN_ERROR(
+      reader.read(&version) && (version == 2 || version == 3),
+      NotSupported,
+      "Unsupported GGUF version %" PRIu32,
+      version);
+  ET_CHECK_OR_RETURN_ERROR(
+      reader.read(&num_tensors) && reader.read(&num_kv),
+      InvalidArgument,
+      "Truncated GGUF header");
+
+  uint64_t alignment = kDefaultAlignment;
+  for (uint64_t i = 0; i < num_kv; ++i) {
+    std::string key;
+    uint32_t type;
+    ET_CHECK_OR_RETURN_ERROR(
+        reader.read_string(&key) && reader.read(&type),
+        InvalidArgument,
+        "Truncated GGUF metadata %" PRIu64,
+        i);
+    if (key == "general.alignment" && type == kUint32) {
+      uint32_t value;
+      ET_CHECK_OR_RETURN_ERROR(
+          reader.read(&value) && value > 0 && (value & (value - 1)) == 0,
+          InvalidArgument,
+          "Invalid general.alignment");
+      alignment = value;
+      continue;
+    }
+    ET_CHECK_OR_RETURN_ERROR(
+        skip_value(reader, type, 0),
+        InvalidArgument,
+        "Invalid GGUF metadata '%s'",
+        key.c_str());
+  }
+
+  // The offsets of the tensors are relative to the data section, which
+  // follows the tensor infos.
+  std::vector<TensorInfo> tensors;
+  std::vector<uint64_t> offsets;
+  for (uint64_t i = 0; i < num_tensors; ++i) {
+    TensorInfo info;
+    uint32_t num_dims;
+    ET_CHECK_OR_RETURN_ERROR(
+        reader.read_string(&info.name) && reader.read(&num_dims) &&
+            num_dims <= 4,
+        InvalidArgument,
+        "Invalid GGUF tensor info %" PRIu64,
+        i);
+    uint64_t numel = 1;
+    for (uint32_t d = 0; d < num_dims; ++d) {
+      uint64_t dim;
+      ET_CHECK_OR_RETURN_ERROR(
+          reader.read(&dim) && (dim == 0 || numel <= UINT64_MAX / dim),
+          InvalidArgument,
+          "Invalid dims of GGUF tensor '%s'",
+          info.name.c_str());
+      info.dims.push_back(dim);
+      numel *= dim;
+    }
+    uint64_t offset;
+    ET_CHECK_OR_RETURN_ERROR(
+        reader.read(&info.type) && reader.read(&offset),
+        InvalidArgument,
+        "Truncated GGUF tensor info '%s'",
+        info.name.c_str());
+    info.nbytes = tensor_nbytes(info.type, numel);
+    info.data = nullptr;
+    tensors.push_back(std::move(info));
+    offsets.push_back(offset);
+  }
+
+  const uint64_t data_start =
+      (reader.offset() + alignment - 1) / alignment * alignment;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    TensorInfo& info = tensors[i];
+    ET_CHECK_OR_RETURN_ERROR(
+        data_start <= data->size() &&
+            offsets[i] <= data->size() - data_start &&
+            info.nbytes <= data->size() - data_start - offsets[i],
+        InvalidArgument,
+        "Data of GGUF tensor '%s' out of range",
+        info.name.c_str());
+    info.data = bytes + data_start + offsets[i];
+  }
+  return GgufFile(std::move(data.get()), std::move(tensors));
+}
+
+const GgufFile::TensorInfo* GgufFile::find_tensor(
+    const std::string& name) const {
+  auto it = tensor_index_.find(name);
+  return it != tensor_index_.end() ? &tensors_[it->second] : nullptr;
+}
+
+Method::ExternalConstantProvider GgufFile::constant_provider() const {
+  return {get_constant, const_cast<GgufFile*>(this)};
+}
+
+Result<const void*>
+GgufFile::get_constant(void* context, const char* name, size_t nbytes) {
+  const TensorInfo* info = static_cast<GgufFile*>(context)->find_tensor(name);
+  ET_CHECK_OR_RETURN_ERROR(
+      info != nullptr, NotFound, "No GGUF tensor '%s'", name);
+  ET_CHECK_OR_RETURN_ERROR(
+      info->nbytes > 0,
+      NotSupported,
+      "GGUF tensor '%s' has unsupported type %" PRIu32,
+      name,
+      info->type);
+  ET_CHECK_OR_RETURN_ERROR(
+      info->nbytes == nbytes,
+      InvalidArgument,
+      "GGUF tensor '%s' has %zu bytes, expected %zu",
+      name,
+      info->nbytes,
+      nbytes);
+  return info->data;
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <executorch/runtime/core/data_loader.h>
+#include <executorch/runtime/core/freeable_buffer.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/method.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * The tensors of a GGUF file, see
+ * https://github.com/ggerganov/ggml/blob/master/docs/gguf.md, read in place
+ * from the loaded file. With an MmapDataLoader the weights are used from the
+ * mapped pages without copies, e.g. as the external constants of a program
+ * exported with ExecutorchBackendConfig.external_constants.
+ */
+class GgufFile final {
+ public:
+  /// The GGML tensor types whose data can be provided.
+  enum class TensorType : uint32_t {
+    F32 = 0,
+    F16 = 1,
+    Q4_0 = 2,
+    Q8_0 = 8,
+  };
+
+  struct TensorInfo {
+    std::string name;
+    /// The GGML type, which may be one not listed in TensorType.
+    uint32_t type;
+    /// The dimensions, innermost first as in GGUF: a [rows, columns] matrix
+    /// is {columns, rows}.
+    std::vector<uint64_t> dims;
+    const void* data;
+    /// The size of the data, or 0 if the type is not a TensorType.
+    size_t nbytes;
+  };
+
+  /**
+   * Loads the whole file from `loader` and parses its header. Supports GGUF
+   * versions 2 and 3.
+   *
+   * @param[in] loader The source of the file. Only used during this call.
+   */
+  __ET_NODISCARD static Result<GgufFile> load(DataLoader* loader);
+
+  GgufFile(GgufFile&&) = default;
+  GgufFile& operator=(GgufFile&&) = default;
+
+  const std::vector<TensorInfo>& tensors() const {
+    return tensors_;
+  }
+
+  /// Returns the tensor named `name`, or nullptr if there is none.
+  const TensorInfo* find_tensor(const std::string& name) const;
+
+  /**
+   * Returns a provider of the data of the tensors by their GGUF name, for
+   * Program::experimental_load_method_with_external_constants(). The
+   * GgufFile must not be moved or destroyed while the provider or the
+   * methods loaded with it are in use.
+   */
+  Method::ExternalConstantProvider constant_provider() const;
+
+ private:
+  GgufFile(FreeableBuffer data, std::vector<TensorInfo> tensors);
+
+  static Result<const void*>
+  get_constant(void* context, const char* name, size_t nbytes);
+
+  FreeableBuffer data_;
+  std::vector<TensorInfo> tensors_;
+  std::unordered_map<std::string, size_t> tensor_index_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/gguf_util/gguf_file.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/data_loader/buffer_data_loader.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using torch::executor::Error;
+using torch::executor::Result;
+using torch::executor::util::BufferDataLoader;
+using torch::executor::util::GgufFile;
+
+namespace {
+
+// Builds a GGUF file in memory.
+class GgufWriter {
+ public:
+  template <typename T>
+  void write(T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void write_string(const std::string& value) {
+    write<uint64_t>(value.size());
+    data_.insert(data_.end(), value.begin(), value.end());
+  }
+
+  void pad_to(size_t alignment) {
+    data_.resize((data_.size() + alignment - 1) / alignment * alignment);
+  }
+
+  std::vector<uint8_t>& data() {
+    return data_;
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+constexpr uint32_t kStringType = 8;
+constexpr uint32_t kArrayType = 9;
+constexpr uint32_t kUint32Type = 4;
+constexpr uint32_t kQ4_KTensorType = 12;
+
+// A file with metadata, a [2, 32] Q4_0 tensor "weight" and a Q4_K tensor
+// "other", with the data aligned to 64 bytes.
+std::vector<uint8_t> make_gguf() {
+  GgufWriter writer;
+  writer.write<uint32_t>(0x46554747);
+  writer.write<uint32_t>(3);
+  writer.write<uint64_t>(2); // tensors
+  writer.write<uint64_t>(3); // metadata
+
+  writer.write_string("general.name");
+  writer.write(kStringType);
+  writer.write_string("test");
+  writer.write_string("tokenizer.ggml.tokens");
+  writer.write(kArrayType);
+  writer.write(kStringType);
+  writer.write<uint64_t>(2);
+  writer.write_string("a");
+  writer.write_string("b");
+  writer.write_string("general.alignment");
+  writer.write(kUint32Type);
+  writer.write<uint32_t>(64);
+
+  writer.write_string("weight");
+  writer.write<uint32_t>(2);
+  writer.write<uint64_t>(32);
+  writer.write<uint64_t>(2);
+  writer.write(static_cast<uint32_t>(GgufFile::TensorType::Q4_0));
+  writer.write<uint64_t>(0);
+  writer.write_string("other");
+  writer.write<uint32_t>(1);
+  writer.write<uint64_t>(256);
+  writer.write(kQ4_KTensorType);
+  writer.write<uint64_t>(64);
+
+  writer.pad_to(64);
+  for (int i = 0; i < 2 * 18; ++i) {
+    writer.write<uint8_t>(i);
+  }
+  writer.pad_to(64);
+  writer.data().resize(writer.data().size() + 144);
+  return writer.data();
+}
+
+} // namespace
+
+class GgufFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+TEST_F(GgufFileTest, ParsesTensors) {
+  std::vector<uint8_t> data = make_gguf();
+  BufferDataLoader loader(data.data(), data.size());
+  Result<GgufFile> file = GgufFile::load(&loader);
+  ASSERT_EQ(file.error(), Error::Ok);
+  ASSERT_EQ(file->tensors().size(), 2);
+
+  const GgufFile::TensorInfo* weight = file->find_tensor("weight");
+  ASSERT_NE(weight, nullptr);
+  EXPECT_EQ(weight->type, static_cast<uint32_t>(GgufFile::TensorType::Q4_0));
+  EXPECT_EQ(weight->dims, (std::vector<uint64_t>{32, 2}));
+  EXPECT_EQ(weight->nbytes, 2 * 18);
+  // The data is read in place, after the 64-byte aligned header.
+  const auto* weight_data = static_cast<const uint8_t*>(weight->data);
+  EXPECT_EQ((weight_data - data.data()) % 64, 0);
+  EXPECT_EQ(weight_data[5], 5);
+
+  const GgufFile::TensorInfo* other = file->find_tensor("other");
+  ASSERT_NE(other, nullptr);
+  EXPECT_EQ(other->nbytes, 0);
+  EXPECT_EQ(file->find_tensor("missing"), nullptr);
+}
+
+TEST_F(GgufFileTest, ProvidesConstants) {
+  std::vector<uint8_t> data = make_gguf();
+  BufferDataLoader loader(data.data(), data.size());
+  Result<GgufFile> file = GgufFile::load(&loader);
+  ASSERT_EQ(file.error(), Error::Ok);
+
+  auto provider = file->constant_provider();
+  Result<const void*> weight =
+      provider.get_constant(provider.context, "weight", 2 * 18);
+  ASSERT_EQ(weight.error(), Error::Ok);
+  EXPECT_EQ(weight.get(), file->find_tensor("weight")->data);
+
+  EXPECT_EQ(
+      provider.get_constant(provider.context, "weight", 64).error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      provider.get_constant(provider.context, "other", 144).error(),
+      Error::NotSupported);
+  EXPECT_EQ(
+      provider.get_constant(provider.context, "missing", 4).error(),
+      Error::NotFound);
+}
+
+TEST_F(GgufFileTest, RejectsInvalidFiles) {
+  std::vector<uint8_t> data = make_gguf();
+
+  // Truncated tensor data.
+  BufferDataLoader truncated(data.data(), data.size() - 200);
+  EXPECT_EQ(GgufFile::load(&truncated).error(), Error::InvalidArgument);
+
+  // Truncated header.
+  BufferDataLoader header(data.data(), 20);
+  EXPECT_EQ(GgufFile::load(&header).error(), Error::InvalidArgument);
+
+  data[0] = 'X';
+  BufferDataLoader bad_magic(data.data(), data.size());
+  EXPECT_EQ(GgufFile::load(&bad_magic).error(), Error::InvalidArgument);
+}
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/kv_cache/kv_cache_manager.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <executorch/runtime/platform/assert.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+// Precedes the cache contents in a snapshot.
+struct SnapshotHeader {
+  uint64_t cache_nbytes;
+  uint64_t num_caches;
+  uint64_t num_valid_sinks;
+  uint64_t write_index;
+  uint64_t num_valid;
+};
+
+} // namespace
+
+KVCacheManager::KVCacheManager(const Config& config, std::vector<void*> buffers)
+    : config_(config), buffers_(std::move(buffers)) {
+  ET_CHECK_MSG(
+      config_.num_rows > 0 && config_.cache_length > 0 &&
+          config_.entry_nbytes > 0,
+      "Invalid cache geometry: %zu rows of %zu entries of %zu bytes",
+      config_.num_rows,
+      config_.cache_length,
+      config_.entry_nbytes);
+  ET_CHECK_MSG(
+      config_.num_sink_entries == 0 || config_.layout == Layout::Ring,
+      "Sink entries require the ring layout");
+  ET_CHECK_MSG(
+      config_.num_sink_entries < config_.cache_length,
+      "%zu sink entries leave no room in a cache of %zu entries",
+      config_.num_sink_entries,
+      config_.cache_length);
+  update_contiguous();
+}
+
+void KVCacheManager::set_buffers(std::vector<void*> buffers) {
+  ET_CHECK_MSG(
+      buffers.size() == buffers_.size(),
+      "Expected %zu cache buffers, got %zu",
+      buffers_.size(),
+      buffers.size());
+  buffers_ = std::move(buffers);
+  update_contiguous();
+}
+
+void KVCacheManager::update_contiguous() {
+  contiguous_ = !buffers_.empty();
+  for (size_t i = 1; i < buffers_.size() && contiguous_; ++i) {
+    contiguous_ = buffers_[i] ==
+        static_cast<uint8_t*>(buffers_[0]) + i * cache_nbytes();
+  }
+}
+
+template <typename Fn>
+void KVCacheManager::for_each_row(Fn fn) {
+  const size_t row_nbytes = config_.cache_length * config_.entry_nbytes;
+  if (contiguous_) {
+    auto* row = static_cast<uint8_t*>(buffers_[0]);
+    const size_t num_rows = buffers_.size() * config_.num_rows;
+    for (size_t i = 0; i < num_rows; ++i, row += row_nbytes) {
+      fn(row);
+    }
+    return;
+  }
+  for (void* buffer : buffers_) {
+    auto* row = static_cast<uint8_t*>(buffer);
+    for (size_t i = 0; i < config_.num_rows; ++i, row += row_nbytes) {
+      fn(row);
+    }
+  }
+}
+
+Error KVCacheManager::set_state(const State& state) {
+  const bool is_ring = config_.layout == Layout::Ring;
+  ET_CHECK_OR_RETURN_ERROR(
+      state.num_valid_sinks <= config_.num_sink_entries &&
+          state.num_valid <= num_ring_entries() &&
+          (is_ring ? state.write_index < num_ring_entries()
+                   : state.write_index == 0),
+      InvalidArgument,
+      "Invalid cache state: %zu sinks, write index %zu, %zu entries",
+      state.num_valid_sinks,
+      state.write_index,
+      state.num_valid);
+  state_ = state;
+  return Error::Ok;
+}
+
+void KVCacheManager::reset() {
+  if (contiguous_) {
+    std::memset(buffers_[0], 0, buffers_.size() * cache_nbytes());
+  } else {
+    for (void* buffer : buffers_) {
+      std::memset(buffer, 0, cache_nbytes());
+    }
+  }
+  state_ = State();
+}
+
+size_t KVCacheManager::ring_start() const {
+  const size_t num_entries = num_ring_entries();
+  return config_.num_sink_entries +
+      (state_.write_index + num_entries - state_.num_valid) % num_entries;
+}
+
+Error KVCacheManager::append(size_t count) {
+  ET_CHECK_OR_RETURN_ERROR(
+      config_.layout == Layout::Shifted,
+      InvalidState,
+      "Caches of the ring layout are updated by write()");
+  state_.num_valid = std::min(state_.num_valid + count, config_.cache_length);
+  return Error::Ok;
+}
+
+Error KVCacheManager::write(
+    const std::vector<const void*>& new_entries,
+    size_t new_entries_length,
+    size_t first_entry,
+    size_t count) {
+  ET_CHECK_OR_RETURN_ERROR(
+      config_.layout == Layout::Ring,
+      InvalidState,
+      "Caches of the shifted layout are updated by the model");
+  ET_CHECK_OR_RETURN_ERROR(
+      new_entries.size() == buffers_.size() &&
+          first_entry + count <= new_entries_length,
+      InvalidArgument,
+      "Invalid new entries: %zu of %zu buffers, entries [%zu, %zu) of %zu",
+      new_entries.size(),
+      buffers_.size(),
+      first_entry,
+      first_entry + count,
+      new_entries_length);
+
+  // The entries of the first tokens fill the sinks.
+  const size_t sink_count =
+      std::min(count, config_.num_sink_entries - state_.num_valid_sinks);
+  copy_entries(
+      new_entries,
+      new_entries_length,
+      first_entry,
+      state_.num_valid_sinks,
+      sink_count);
+  state_.num_valid_sinks += sink_count;
+  first_entry += sink_count;
+  count -= sink_count;
+
+  // Only the latest entries would survive the write anyway.
+  const size_t num_entries = num_ring_entries();
+  if (count > num_entries) {
+    first_entry += count - num_entries;
+    count = num_entries;
+  }
+
+  // Entries up to the end of the cache, then the remaining ones wrap around.
+  const size_t first_count = std::min(count, num_entries - state_.write_index);
+  copy_entries(
+      new_entries,
+      new_entries_length,
+      first_entry,
+      config_.num_sink_entries + state_.write_index,
+      first_count);
+  copy_entries(
+      new_entries,
+      new_entries_length,
+      first_entry + first_count,
+      config_.num_sink_entries,
+      count - first_count);
+  state_.write_index = (state_.write_index + count) % num_entries;
+  state_.num_valid = std::min(state_.num_valid + count, num_entries);
+  return Error::Ok;
+}
+
+void KVCacheManager::rollback(size_t count) {
+  if (config_.layout == Layout::Ring) {
+    // Move the write position back, the discarded entries are overwritten
+    // later on.
+    const size_t num_entries = num_ring_entries();
+    const size_t discard_count = std::min(count, state_.num_valid);
+    state_.write_index =
+        (state_.write_index + num_entries - discard_count) % num_entries;
+    state_.num_valid -= discard_count;
+    // The sinks hold the entries of the tokens before the ring ones.
+    if (state_.num_valid == 0) {
+      state_.num_valid_sinks -=
+          std::min(count - discard_count, state_.num_valid_sinks);
+    }
+    return;
+  }
+
+  const size_t discard_count = std::min(count, state_.num_valid);
+  if (discard_count == 0) {
+    return;
+  }
+  const size_t preserve_count = state_.num_valid - discard_count;
+  const size_t first_valid = config_.cache_length - state_.num_valid;
+
+  // Shift the preserved entries right over the discarded ones, then zero the
+  // entries that were moved out.
+  for_each_row([&](uint8_t* row) {
+    std::memmove(
+        row + (first_valid + discard_count) * config_.entry_nbytes,
+        row + first_valid * config_.entry_nbytes,
+        preserve_count * config_.entry_nbytes);
+    std::memset(
+        row + first_valid * config_.entry_nbytes,
+        0,
+        discard_count * config_.entry_nbytes);
+  });
+  state_.num_valid = preserve_count;
+}
+
+void KVCacheManager::clear(size_t first_entry, size_t count) {
+  ET_CHECK_MSG(
+      first_entry + count <= config_.cache_length,
+      "Entries [%zu, %zu) are out of the cache of %zu entries",
+      first_entry,
+      first_entry + count,
+      config_.cache_length);
+  for_each_row([&](uint8_t* row) {
+    std::memset(
+        row + first_entry * config_.entry_nbytes,
+        0,
+        count * config_.entry_nbytes);
+  });
+}
+
+size_t KVCacheManager::snapshot_nbytes() const {
+  return sizeof(SnapshotHeader) + buffers_.size() * cache_nbytes();
+}
+
+void KVCacheManager::save_snapshot(void* dst) const {
+  const SnapshotHeader header = {
+      cache_nbytes(),
+      buffers_.size(),
+      state_.num_valid_sinks,
+      state_.write_index,
+      state_.num_valid};
+  auto* dst_ptr = static_cast<uint8_t*>(dst);
+  std::memcpy(dst_ptr, &header, sizeof(header));
+  dst_ptr += sizeof(header);
+  if (contiguous_) {
+    std::memcpy(dst_ptr, buffers_[0], buffers_.size() * cache_nbytes());
+    return;
+  }
+  for (const void* buffer : buffers_) {
+    std::memcpy(dst_ptr, buffer, cache_nbytes());
+    dst_ptr += cache_nbytes();
+  }
+}
+
+Error KVCacheManager::load_snapshot(const void* src, size_t size) {
+  ET_CHECK_OR_RETURN_ERROR(
+      size == snapshot_nbytes(),
+      InvalidArgument,
+      "Cache snapshot size %zu != expected %zu",
+      size,
+      snapshot_nbytes());
+  SnapshotHeader header;
+  const auto* src_ptr = static_cast<const uint8_t*>(src);
+  std::memcpy(&header, src_ptr, sizeof(header));
+  src_ptr += sizeof(header);
+  ET_CHECK_OR_RETURN_ERROR(
+      header.cache_nbytes == cache_nbytes() &&
+          header.num_caches == buffers_.size(),
+      InvalidArgument,
+      "Cache snapshot of a different geometry");
+
+  State state;
+  state.num_valid_sinks = header.num_valid_sinks;
+  state.write_index = header.write_index;
+  state.num_valid = header.num_valid;
+  ET_CHECK_OK_OR_RETURN_ERROR(set_state(state));
+
+  if (contiguous_) {
+    std::memcpy(buffers_[0], src_ptr, buffers_.size() * cache_nbytes());
+    return Error::Ok;
+  }
+  for (void* buffer : buffers_) {
+    std::memcpy(buffer, src_ptr, cache_nbytes());
+    src_ptr += cache_nbytes();
+  }
+  return Error::Ok;
+}
+
+void KVCacheManager::copy_entries(
+    const std::vector<const void*>& new_entries,
+    size_t new_entries_length,
+    size_t src_entry,
+    size_t dst_entry,
+    size_t count) {
+  if (count == 0) {
+    return;
+  }
+  const size_t dst_row_nbytes = config_.cache_length * config_.entry_nbytes;
+  const size_t src_row_nbytes = new_entries_length * config_.entry_nbytes;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    auto* dst_row = static_cast<uint8_t*>(buffers_[i]);
+    const auto* src_row = static_cast<const uint8_t*>(new_entries[i]);
+    for (size_t row = 0; row < config_.num_rows; ++row) {
+      std::memcpy(
+          dst_row + dst_entry * config_.entry_nbytes,
+          src_row + src_entry * config_.entry_nbytes,
+          count * config_.entry_nbytes);
+      dst_row += dst_row_nbytes;
+      src_row += src_row_nbytes;
+    }
+  }
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
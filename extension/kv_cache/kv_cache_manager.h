@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <executorch/runtime/core/error.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Manages the key/value caches of a transformer that takes its caches as
+ * inputs, e.g. a model delegated to an accelerator that can not update
+ * mutable buffers: which cache entries are valid, where new entries go, and
+ * rolling back, evicting, saving and restoring entries.
+ *
+ * All caches managed together share one geometry. Each cache buffer holds
+ * `num_rows` rows of `cache_length` entries of `entry_nbytes` bytes, i.e. the
+ * dimensions before the cache length dimension are flattened into rows and
+ * the ones after it into entries. The buffers are not owned by the manager.
+ *
+ * NOTE: Prototype API; subject to change.
+ */
+class KVCacheManager final {
+ public:
+  enum class Layout : uint8_t {
+    /**
+     * The model writes its updated caches in place, shifted so that the
+     * newest entries are at the end of the cache. The valid entries are the
+     * last num_valid() ones.
+     */
+    Shifted,
+    /**
+     * The model outputs the entries of its input tokens only, which write()
+     * copies at a position that wraps around the end of the cache, so that
+     * the oldest entries are evicted once the cache is full (a sliding
+     * window).
+     */
+    Ring,
+  };
+
+  struct Config {
+    Layout layout = Layout::Shifted;
+    size_t num_rows = 0;
+    size_t cache_length = 0;
+    size_t entry_nbytes = 0;
+    /**
+     * Ring layout only: the number of entries of the first tokens that are
+     * never evicted. Models attend strongly to the first tokens, so keeping
+     * them ("attention sinks") preserves the output quality once the window
+     * slides. The ring then wraps within the remaining entries.
+     */
+    size_t num_sink_entries = 0;
+  };
+
+  /// Where the valid entries are, e.g. to switch between sequences.
+  struct State {
+    size_t num_valid_sinks = 0;
+    // Ring layout: the next entry to write, relative to the first non-sink
+    // entry.
+    size_t write_index = 0;
+    // Number of valid entries, excluding sinks.
+    size_t num_valid = 0;
+  };
+
+  KVCacheManager(const Config& config, std::vector<void*> buffers);
+
+  KVCacheManager(const KVCacheManager&) = delete;
+  KVCacheManager& operator=(const KVCacheManager&) = delete;
+
+  const Config& config() const {
+    return config_;
+  }
+
+  /// The size of each cache buffer in bytes.
+  size_t cache_nbytes() const {
+    return config_.num_rows * config_.cache_length * config_.entry_nbytes;
+  }
+
+  const std::vector<void*>& buffers() const {
+    return buffers_;
+  }
+
+  /**
+   * Whether the buffers are consecutive slices of one allocation, in the
+   * order of buffers(), e.g. a per-chunk slab. The caches are then reset,
+   * snapshotted and cleared as a single span.
+   */
+  bool is_contiguous() const {
+    return contiguous_;
+  }
+
+  /**
+   * Binds other cache buffers of the same geometry, without touching their
+   * contents or the state, e.g. to switch to the caches of another sequence
+   * along with set_state().
+   */
+  void set_buffers(std::vector<void*> buffers);
+
+  State state() const {
+    return state_;
+  }
+
+  __ET_NODISCARD Error set_state(const State& state);
+
+  /// Zeroes the caches and marks all entries as invalid.
+  void reset();
+
+  /// The number of valid entries, including sinks.
+  size_t num_valid() const {
+    return state_.num_valid_sinks + state_.num_valid;
+  }
+
+  /// Ring layout: the oldest valid non-sink entry.
+  size_t ring_start() const;
+
+  /**
+   * Shifted layout: records that the model appended `count` entries, of
+   * which the last cache_length ones remain.
+   */
+  __ET_NODISCARD Error append(size_t count);
+
+  /**
+   * Ring layout: copies `count` new entries of each cache into the caches,
+   * starting at the entry `first_entry` of the `new_entries` buffers, which
+   * hold `num_rows` rows of `new_entries_length` entries. The order of the
+   * buffers matches buffers().
+   */
+  __ET_NODISCARD Error write(
+      const std::vector<const void*>& new_entries,
+      size_t new_entries_length,
+      size_t first_entry,
+      size_t count);
+
+  /**
+   * Discards the entries of the last `count` tokens, e.g. the rejected draft
+   * tokens of speculative decoding or padding. Entries that were evicted can
+   * not be restored, so at most num_valid() entries are discarded.
+   */
+  void rollback(size_t count);
+
+  /// Zeroes `count` entries starting at `first_entry`, without changing the
+  /// state.
+  void clear(size_t first_entry, size_t count);
+
+  /// The size of a snapshot of the caches and their state in bytes.
+  size_t snapshot_nbytes() const;
+
+  /// Writes a snapshot of snapshot_nbytes() bytes to `dst`.
+  void save_snapshot(void* dst) const;
+
+  /// Restores a snapshot written by save_snapshot() with the same geometry.
+  __ET_NODISCARD Error load_snapshot(const void* src, size_t size);
+
+ private:
+  size_t num_ring_entries() const {
+    return config_.cache_length - config_.num_sink_entries;
+  }
+
+  // Detects whether buffers_ are consecutive slices of one allocation.
+  void update_contiguous();
+
+  // Calls fn(row) for the rows of all the caches; the rows of contiguous
+  // buffers are walked as one sequence.
+  template <typename Fn>
+  void for_each_row(Fn fn);
+
+  // Copies the entries [src_entry, src_entry + count) of each new entry
+  // buffer to the entries starting at dst_entry.
+  void copy_entries(
+      const std::vector<const void*>& new_entries,
+      size_t new_entries_length,
+      size_t src_entry,
+      size_t dst_entry,
+      size_t count);
+
+  const Config config_;
+  std::vector<void*> buffers_;
+  bool contiguous_ = false;
+  State state_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,25 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_library(
+        name = "kv_cache_manager",
+        srcs = [
+            "kv_cache_manager.cpp",
+        ],
+        exported_headers = [
+            "kv_cache_manager.h",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+        visibility = [
+            "//executorch/extension/kv_cache/test/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+    )
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/kv_cache/kv_cache_manager.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace ::testing;
+using torch::executor::Error;
+using torch::executor::util::KVCacheManager;
+
+namespace {
+
+// Two rows of one byte entries, so that the caches read like the sequence of
+// tokens they hold.
+constexpr size_t kNumRows = 2;
+
+KVCacheManager::Config make_config(
+    KVCacheManager::Layout layout,
+    size_t cache_length,
+    size_t num_sink_entries = 0) {
+  KVCacheManager::Config config;
+  config.layout = layout;
+  config.num_rows = kNumRows;
+  config.cache_length = cache_length;
+  config.entry_nbytes = 1;
+  config.num_sink_entries = num_sink_entries;
+  return config;
+}
+
+// The entries of the tokens [first_token, first_token + count), in both rows.
+std::vector<uint8_t> make_entries(uint8_t first_token, size_t count) {
+  std::vector<uint8_t> entries;
+  for (size_t row = 0; row < kNumRows; ++row) {
+    for (size_t i = 0; i < count; ++i) {
+      entries.push_back(first_token + i);
+    }
+  }
+  return entries;
+}
+
+} // namespace
+
+class KVCacheManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+
+  // Writes the tokens [first_token, first_token + count) into a ring cache.
+  void
+  write_tokens(KVCacheManager& manager, uint8_t first_token, size_t count) {
+    const std::vector<uint8_t> entries = make_entries(first_token, count);
+    EXPECT_EQ(manager.write({entries.data()}, count, 0, count), Error::Ok);
+  }
+};
+
+TEST_F(KVCacheManagerTest, ShiftedRollbackShiftsPreservedEntries) {
+  // The model appended the tokens 1 to 4.
+  std::vector<uint8_t> cache = {0, 0, 1, 2, 3, 4, 0, 0, 1, 2, 3, 4};
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Shifted, 6), {cache.data()});
+  EXPECT_EQ(manager.append(4), Error::Ok);
+  EXPECT_EQ(manager.num_valid(), 4);
+
+  manager.rollback(2);
+  EXPECT_EQ(manager.num_valid(), 2);
+  EXPECT_EQ(cache, std::vector<uint8_t>({0, 0, 0, 0, 1, 2, 0, 0, 0, 0, 1, 2}));
+
+  // At most the valid entries are discarded.
+  manager.rollback(5);
+  EXPECT_EQ(manager.num_valid(), 0);
+  EXPECT_EQ(cache, std::vector<uint8_t>(12, 0));
+}
+
+TEST_F(KVCacheManagerTest, ShiftedAppendIsCappedAtCacheLength) {
+  std::vector<uint8_t> cache(2 * 4);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Shifted, 4), {cache.data()});
+  EXPECT_EQ(manager.append(3), Error::Ok);
+  EXPECT_EQ(manager.append(3), Error::Ok);
+  EXPECT_EQ(manager.num_valid(), 4);
+
+  const std::vector<uint8_t> entries = make_entries(1, 1);
+  EXPECT_EQ(manager.write({entries.data()}, 1, 0, 1), Error::InvalidState);
+}
+
+TEST_F(KVCacheManagerTest, RingWriteWrapsAndEvictsOldest) {
+  std::vector<uint8_t> cache(2 * 4);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 4), {cache.data()});
+  EXPECT_EQ(manager.append(1), Error::InvalidState);
+
+  write_tokens(manager, 1, 3);
+  EXPECT_EQ(manager.num_valid(), 3);
+  EXPECT_EQ(manager.ring_start(), 0);
+
+  write_tokens(manager, 4, 2);
+  EXPECT_EQ(manager.num_valid(), 4);
+  EXPECT_EQ(manager.ring_start(), 1);
+  EXPECT_EQ(cache, std::vector<uint8_t>({5, 2, 3, 4, 5, 2, 3, 4}));
+
+  // Only the last 4 of 6 tokens survive.
+  write_tokens(manager, 10, 6);
+  EXPECT_EQ(manager.ring_start(), 1);
+  EXPECT_EQ(cache, std::vector<uint8_t>({15, 12, 13, 14, 15, 12, 13, 14}));
+}
+
+TEST_F(KVCacheManagerTest, RingWriteSkipsPaddingEntries) {
+  std::vector<uint8_t> cache(2 * 4);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 4), {cache.data()});
+
+  // The first of 3 new entries is left padding.
+  const std::vector<uint8_t> entries = make_entries(0, 3);
+  EXPECT_EQ(manager.write({entries.data()}, 3, 1, 2), Error::Ok);
+  EXPECT_EQ(manager.num_valid(), 2);
+  EXPECT_EQ(cache, std::vector<uint8_t>({1, 2, 0, 0, 1, 2, 0, 0}));
+
+  EXPECT_EQ(manager.write({entries.data()}, 3, 2, 2), Error::InvalidArgument);
+}
+
+TEST_F(KVCacheManagerTest, RingKeepsSinkEntries) {
+  std::vector<uint8_t> cache(2 * 5);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 5, /*num_sink_entries=*/2),
+      {cache.data()});
+
+  write_tokens(manager, 1, 4);
+  EXPECT_EQ(manager.state().num_valid_sinks, 2);
+  EXPECT_EQ(manager.num_valid(), 4);
+
+  // The tokens 1 and 2 stay, the others slide through the remaining entries.
+  write_tokens(manager, 5, 3);
+  EXPECT_EQ(manager.num_valid(), 5);
+  EXPECT_EQ(manager.ring_start(), 4);
+  EXPECT_EQ(cache, std::vector<uint8_t>({1, 2, 6, 7, 5, 1, 2, 6, 7, 5}));
+}
+
+TEST_F(KVCacheManagerTest, RingRollbackMovesWritePositionBack) {
+  std::vector<uint8_t> cache(2 * 5);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 5, /*num_sink_entries=*/1),
+      {cache.data()});
+
+  write_tokens(manager, 1, 3);
+  manager.rollback(1);
+  EXPECT_EQ(manager.num_valid(), 2);
+
+  // The next token overwrites the discarded one.
+  write_tokens(manager, 9, 1);
+  EXPECT_EQ(cache, std::vector<uint8_t>({1, 2, 9, 0, 0, 1, 2, 9, 0, 0}));
+
+  // Rolling back past the ring entries discards sinks.
+  manager.rollback(3);
+  EXPECT_EQ(manager.num_valid(), 0);
+}
+
+TEST_F(KVCacheManagerTest, SnapshotRestoresCachesAndState) {
+  std::vector<uint8_t> cache(2 * 4);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 4), {cache.data()});
+  write_tokens(manager, 1, 5);
+
+  std::vector<uint8_t> snapshot(manager.snapshot_nbytes());
+  manager.save_snapshot(snapshot.data());
+  const std::vector<uint8_t> saved_cache = cache;
+
+  manager.reset();
+  EXPECT_EQ(manager.num_valid(), 0);
+  EXPECT_EQ(cache, std::vector<uint8_t>(8, 0));
+
+  EXPECT_EQ(
+      manager.load_snapshot(snapshot.data(), snapshot.size()), Error::Ok);
+  EXPECT_EQ(cache, saved_cache);
+  EXPECT_EQ(manager.num_valid(), 4);
+  EXPECT_EQ(manager.ring_start(), 0);
+
+  EXPECT_EQ(
+      manager.load_snapshot(snapshot.data(), snapshot.size() - 1),
+      Error::InvalidArgument);
+}
+
+TEST_F(KVCacheManagerTest, SetBuffersSwitchesSequences) {
+  std::vector<uint8_t> first(2 * 4);
+  std::vector<uint8_t> second(2 * 4);
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Ring, 4), {first.data()});
+  write_tokens(manager, 1, 2);
+  const KVCacheManager::State first_state = manager.state();
+
+  manager.set_buffers({second.data()});
+  EXPECT_EQ(manager.set_state(KVCacheManager::State()), Error::Ok);
+  write_tokens(manager, 7, 1);
+  EXPECT_EQ(second, std::vector<uint8_t>({7, 0, 0, 0, 7, 0, 0, 0}));
+
+  manager.set_buffers({first.data()});
+  EXPECT_EQ(manager.set_state(first_state), Error::Ok);
+  write_tokens(manager, 3, 1);
+  EXPECT_EQ(first, std::vector<uint8_t>({1, 2, 3, 0, 1, 2, 3, 0}));
+
+  KVCacheManager::State invalid_state;
+  invalid_state.write_index = 4;
+  EXPECT_EQ(manager.set_state(invalid_state), Error::InvalidArgument);
+}
+
+TEST_F(KVCacheManagerTest, ClearZeroesEntries) {
+  std::vector<uint8_t> cache = {1, 2, 3, 4, 1, 2, 3, 4};
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Shifted, 4), {cache.data()});
+  manager.clear(1, 2);
+  EXPECT_EQ(cache, std::vector<uint8_t>({1, 0, 0, 4, 1, 0, 0, 4}));
+}
+
+TEST_F(KVCacheManagerTest, ContiguousBuffersActAsOneSpan) {
+  // The key and value caches are consecutive slices of one slab.
+  std::vector<uint8_t> slab = {
+      0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 5, 6, 0, 0, 5, 6};
+  KVCacheManager manager(
+      make_config(KVCacheManager::Layout::Shifted, 4),
+      {slab.data(), slab.data() + 8});
+  EXPECT_TRUE(manager.is_contiguous());
+  EXPECT_EQ(manager.append(2), Error::Ok);
+
+  std::vector<uint8_t> snapshot(manager.snapshot_nbytes());
+  manager.save_snapshot(snapshot.data());
+
+  manager.rollback(1);
+  EXPECT_EQ(
+      slab,
+      std::vector<uint8_t>({0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 5, 0, 0, 0, 5}));
+
+  EXPECT_EQ(
+      manager.load_snapshot(snapshot.data(), snapshot.size()), Error::Ok);
+  EXPECT_EQ(manager.num_valid(), 2);
+  EXPECT_EQ(
+      slab,
+      std::vector<uint8_t>({0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 5, 6, 0, 0, 5, 6}));
+
+  manager.reset();
+  EXPECT_EQ(slab, std::vector<uint8_t>(16, 0));
+
+  // Separate buffers are not merged.
+  std::vector<uint8_t> other(8);
+  manager.set_buffers({slab.data(), other.data()});
+  EXPECT_FALSE(manager.is_contiguous());
+}
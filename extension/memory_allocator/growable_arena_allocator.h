@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include <executorch/runtime/core/dynamic_allocator.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A DynamicAllocator that backs the unbounded tensors of a Method with heap
+ * buffers.
+ *
+ * A tensor that outgrows its buffer gets one of at least twice the size, so
+ * that a sequence of growing resizes only reallocates a logarithmic number of
+ * times. Buffers are kept until the allocator is destroyed: since tensors
+ * keep their data and capacity across executions, a Method stops touching the
+ * heap once it has seen its largest shapes. `high_water_mark()` reports the
+ * peak footprint, e.g. to size the memory plan of a bounded version of the
+ * model.
+ *
+ * Pass an instance to the MemoryManager of the Method, and keep it alive for
+ * as long as the Method.
+ */
+class GrowableArenaAllocator : public DynamicAllocator {
+ public:
+  GrowableArenaAllocator() = default;
+
+  ~GrowableArenaAllocator() override {
+    for (const auto& block : blocks_) {
+      std::free(block.first);
+    }
+  }
+
+  GrowableArenaAllocator(const GrowableArenaAllocator&) = delete;
+  GrowableArenaAllocator& operator=(const GrowableArenaAllocator&) = delete;
+
+  void* reallocate(void* data, size_t used, size_t size, size_t* capacity)
+      override {
+    const auto it = data == nullptr ? blocks_.end() : blocks_.find(data);
+    const bool owned = it != blocks_.end();
+    const size_t old_capacity = owned ? it->second : *capacity;
+    const size_t new_capacity = std::max(size, 2 * old_capacity);
+
+    void* block = nullptr;
+    if (owned) {
+      // realloc() preserves the whole buffer; `used` never exceeds it.
+      block = std::realloc(data, new_capacity);
+    } else {
+      block = std::malloc(new_capacity);
+      if (block != nullptr && used > 0) {
+        std::memcpy(block, data, std::min(used, new_capacity));
+      }
+    }
+    if (block == nullptr) {
+      ET_LOG(Error, "Failed to allocate %zu bytes", new_capacity);
+      return nullptr;
+    }
+
+    if (owned) {
+      allocated_size_ -= it->second;
+      blocks_.erase(it);
+    }
+    blocks_[block] = new_capacity;
+    allocated_size_ += new_capacity;
+    high_water_mark_ = std::max(high_water_mark_, allocated_size_);
+    *capacity = new_capacity;
+    return block;
+  }
+
+  /**
+   * Returns the number of bytes currently allocated.
+   */
+  size_t allocated_size() const {
+    return allocated_size_;
+  }
+
+  /**
+   * Returns the largest number of bytes allocated at once so far.
+   */
+  size_t high_water_mark() const {
+    return high_water_mark_;
+  }
+
+  /**
+   * Returns the number of buffers currently allocated.
+   */
+  size_t num_blocks() const {
+    return blocks_.size();
+  }
+
+ private:
+  // Buffer -> capacity in bytes.
+  std::unordered_map<void*, size_t> blocks_;
+  size_t allocated_size_ = 0;
+  size_t high_water_mark_ = 0;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Dynamically allocates memory on huge pages using mmap() and frees all
+ * pointers at destruction time.
+ *
+ * Intended for the memory-planned arenas of large models, e.g. as the planned
+ * memory allocator of a Module, where the default page size causes heavy TLB
+ * pressure in bandwidth-bound kernels. Each allocation is rounded up to a
+ * whole number of huge pages, so this is not suited to many small allocations.
+ */
+class HugePageMemoryAllocator : public MemoryAllocator {
+ public:
+  /// The huge page size that allocations are aligned and rounded up to.
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  /**
+   * Construct a new huge page memory allocator.
+   *
+   * @param[in] numa_node The NUMA node to bind the allocated memory to, or -1
+   *     to use the default memory policy of the calling thread.
+   */
+  explicit HugePageMemoryAllocator(int numa_node = -1)
+      : MemoryAllocator(0, nullptr), numa_node_(numa_node) {}
+
+  ~HugePageMemoryAllocator() override {
+    reset();
+  }
+
+  /**
+   * Allocates 'size' bytes of memory, returning a pointer to the allocated
+   * region, or nullptr upon failure. The region starts on a huge page
+   * boundary, which satisfies any alignment up to `kHugePageSize`.
+   */
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    EXECUTORCH_TRACK_ALLOCATION(prof_id(), size);
+
+    if (!isPowerOf2(alignment) || alignment > kHugePageSize) {
+      ET_LOG(Error, "Alignment %zu is not supported", alignment);
+      return nullptr;
+    }
+    const size_t alloc_size =
+        (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (alloc_size == 0) {
+      return nullptr;
+    }
+
+    // Prefer reserved huge pages, which are always aligned to their size.
+    void* pages = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    pages = ::mmap(
+        nullptr,
+        alloc_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0);
+#endif
+    if (pages == MAP_FAILED) {
+      pages = map_transparent_huge_pages(alloc_size);
+      if (pages == nullptr) {
+        return nullptr;
+      }
+    }
+    bind_to_numa_node(pages, alloc_size);
+
+    mappings_.push_back({pages, alloc_size});
+    return pages;
+  }
+
+  // Unmap each hosted memory region.
+  void reset() override {
+    for (const auto& mapping : mappings_) {
+      ::munmap(mapping.addr, mapping.size);
+    }
+    mappings_.clear();
+  }
+
+ private:
+  struct Mapping {
+    void* addr;
+    size_t size;
+  };
+
+  /**
+   * Maps `size` bytes starting on a huge page boundary and advises the kernel
+   * to back them with transparent huge pages. Returns nullptr on failure.
+   */
+  static void* map_transparent_huge_pages(size_t size) {
+    // Over-allocate by a huge page so that the region can start on a huge page
+    // boundary, then trim the rest.
+    const size_t reserve_size = size + kHugePageSize;
+    void* reserved = ::mmap(
+        nullptr,
+        reserve_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (reserved == MAP_FAILED) {
+      ET_LOG(
+          Error,
+          "mmap(size=%zu) failed: %s",
+          reserve_size,
+          ::strerror(errno));
+      return nullptr;
+    }
+    const uintptr_t reserved_start = reinterpret_cast<uintptr_t>(reserved);
+    const uintptr_t start =
+        (reserved_start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    const size_t head = start - reserved_start;
+    const size_t tail = reserve_size - head - size;
+    if (head > 0) {
+      ::munmap(reserved, head);
+    }
+    if (tail > 0) {
+      ::munmap(reinterpret_cast<void*>(start + size), tail);
+    }
+    void* pages = reinterpret_cast<void*>(start);
+#ifdef MADV_HUGEPAGE
+    if (::madvise(pages, size, MADV_HUGEPAGE) < 0) {
+      // Only a hint; the memory is still usable with the default page size.
+      ET_LOG(
+          Debug,
+          "madvise(%p, %zu, MADV_HUGEPAGE) failed: %s (ignored)",
+          pages,
+          size,
+          ::strerror(errno));
+    }
+#endif
+    return pages;
+  }
+
+  /**
+   * Binds the pages to `numa_node_`, before they are first touched. Failure
+   * leaves the default placement, so it is not fatal.
+   */
+  void bind_to_numa_node(void* pages, size_t size) const {
+    if (numa_node_ < 0) {
+      return;
+    }
+#if defined(__linux__) && defined(SYS_mbind)
+    // Values from <linux/mempolicy.h>, to avoid depending on libnuma.
+    constexpr int kMpolBind = 2;
+    constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> node_mask(numa_node_ / kBitsPerWord + 1, 0);
+    node_mask[numa_node_ / kBitsPerWord] = 1UL << (numa_node_ % kBitsPerWord);
+    long ret = ::syscall(
+        SYS_mbind,
+        pages,
+        size,
+        kMpolBind,
+        node_mask.data(),
+        node_mask.size() * kBitsPerWord + 1,
+        0);
+    if (ret != 0) {
+      ET_LOG(
+          Info,
+          "Binding %zu bytes to NUMA node %d failed: %s (ignored)",
+          size,
+          numa_node_,
+          ::strerror(errno));
+    }
+#else
+    (void)pages;
+    (void)size;
+    ET_LOG(Info, "NUMA binding is not supported on this platform (ignored)");
+#endif
+  }
+
+  const int numa_node_;
+  std::vector<Mapping> mappings_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <executorch/runtime/core/memory_allocator.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A malloc()-backed allocator that keeps its chunks across resets.
+ *
+ * Requests are rounded up to a power-of-two size class. `reset()` returns the
+ * chunks handed out since the last one to per-class free lists instead of
+ * freeing them, and later requests of the same class reuse them. Used as a
+ * temp allocator, which the Method resets after every kernel, it stops calling
+ * malloc() once every class has seen its peak concurrent use, typically during
+ * the first execution.
+ *
+ * Allocation is thread-safe, e.g. for kernels that allocate scratch memory
+ * from a thread pool. Each thread uses one of `num_arenas` arenas chosen from
+ * its id, so that threads rarely contend for the same lock. `reset()` must not
+ * run concurrently with `allocate()`.
+ */
+class PooledMemoryAllocator : public MemoryAllocator {
+ public:
+  /// Smallest chunk size; smaller requests share this class.
+  static constexpr size_t kMinChunkSize = 64;
+
+  /// Counters covering the lifetime of the allocator.
+  struct Stats {
+    /// Number of successful allocate() calls.
+    size_t num_allocations = 0;
+    /// Number of allocate() calls that had to call malloc().
+    size_t num_mallocs = 0;
+    /// Bytes owned by the allocator, whether in use or pooled.
+    size_t pooled_bytes = 0;
+    /// Largest number of bytes in use between two resets.
+    size_t high_water_mark = 0;
+  };
+
+  /**
+   * Constructs a new pooled allocator.
+   *
+   * @param[in] num_arenas The number of independent arenas, e.g. the number of
+   *     threads that allocate concurrently. Each has its own pools, so chunks
+   *     freed by one thread's kernels are not reused by another's.
+   */
+  explicit PooledMemoryAllocator(size_t num_arenas = 1)
+      : MemoryAllocator(0, nullptr),
+        arenas_(std::max<size_t>(num_arenas, 1)) {}
+
+  ~PooledMemoryAllocator() override {
+    reset();
+    release();
+  }
+
+  PooledMemoryAllocator(const PooledMemoryAllocator&) = delete;
+  PooledMemoryAllocator& operator=(const PooledMemoryAllocator&) = delete;
+
+  /**
+   * Allocates 'size' bytes of memory, returning a pointer to the allocated
+   * region, or nullptr upon failure.
+   */
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    EXECUTORCH_TRACK_ALLOCATION(prof_id(), size);
+
+    if (!isPowerOf2(alignment)) {
+      ET_LOG(Error, "Alignment %zu is not a power of 2", alignment);
+      return nullptr;
+    }
+
+    // The minimum alignment that malloc() is guaranteed to provide.
+    static constexpr size_t kMallocAlignment = alignof(std::max_align_t);
+    if (alignment > kMallocAlignment) {
+      // Same as MallocMemoryAllocator, the chunk has room to align the
+      // returned pointer.
+      size += alignment;
+    }
+    const size_t size_class = size_class_of(size);
+    if (size_class >= kNumSizeClasses) {
+      ET_LOG(Error, "Allocation of %zu bytes is too large", size);
+      return nullptr;
+    }
+    const size_t chunk_size = kMinChunkSize << size_class;
+
+    Arena& arena = arena_for_this_thread();
+    std::lock_guard<std::mutex> guard(arena.mutex);
+    void* chunk = nullptr;
+    auto& free_list = arena.free_lists[size_class];
+    if (!free_list.empty()) {
+      chunk = free_list.back();
+      free_list.pop_back();
+    } else {
+      chunk = std::malloc(chunk_size);
+      if (chunk == nullptr) {
+        ET_LOG(Error, "Failed to allocate %zu bytes", chunk_size);
+        return nullptr;
+      }
+      arena.stats.num_mallocs++;
+      arena.stats.pooled_bytes += chunk_size;
+    }
+    arena.in_use.push_back({chunk, size_class});
+    arena.used_size += chunk_size;
+    arena.stats.num_allocations++;
+    arena.stats.high_water_mark =
+        std::max(arena.stats.high_water_mark, arena.used_size);
+    return alignPointer(chunk, alignment);
+  }
+
+  size_t used_size() const override {
+    size_t used_size = 0;
+    for (auto& arena : arenas_) {
+      std::lock_guard<std::mutex> guard(arena.mutex);
+      used_size += arena.used_size;
+    }
+    return used_size;
+  }
+
+  // Returns the chunks handed out since the last reset to the pools.
+  void reset() override {
+    for (auto& arena : arenas_) {
+      std::lock_guard<std::mutex> guard(arena.mutex);
+      for (const auto& chunk : arena.in_use) {
+        arena.free_lists[chunk.size_class].push_back(chunk.ptr);
+      }
+      arena.in_use.clear();
+      arena.used_size = 0;
+    }
+  }
+
+  /**
+   * Frees the pooled chunks that are not in use, e.g. after a Method with
+   * unusually large scratch needs has run. Keeps the statistics.
+   */
+  void release() {
+    for (auto& arena : arenas_) {
+      std::lock_guard<std::mutex> guard(arena.mutex);
+      for (size_t size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+        for (void* chunk : arena.free_lists[size_class]) {
+          std::free(chunk);
+          arena.stats.pooled_bytes -= kMinChunkSize << size_class;
+        }
+        arena.free_lists[size_class].clear();
+      }
+    }
+  }
+
+  /**
+   * Returns the statistics summed over the arenas. The high-water mark is
+   * the sum of the arenas' ones, assuming they peak at the same time.
+   */
+  Stats stats() const {
+    Stats total;
+    for (auto& arena : arenas_) {
+      std::lock_guard<std::mutex> guard(arena.mutex);
+      total.num_allocations += arena.stats.num_allocations;
+      total.num_mallocs += arena.stats.num_mallocs;
+      total.pooled_bytes += arena.stats.pooled_bytes;
+      total.high_water_mark += arena.stats.high_water_mark;
+    }
+    return total;
+  }
+
+ private:
+  // Size classes from kMinChunkSize up to 2^47 bytes.
+  static constexpr size_t kNumSizeClasses = 42;
+
+  struct Chunk {
+    void* ptr;
+    size_t size_class;
+  };
+
+  struct Arena {
+    mutable std::mutex mutex;
+    std::vector<void*> free_lists[kNumSizeClasses];
+    std::vector<Chunk> in_use;
+    size_t used_size = 0;
+    Stats stats;
+  };
+
+  static size_t size_class_of(size_t size) {
+    size_t size_class = 0;
+    size_t chunk_size = kMinChunkSize;
+    while (chunk_size < size && size_class < kNumSizeClasses) {
+      chunk_size <<= 1;
+      size_class++;
+    }
+    return size_class;
+  }
+
+  Arena& arena_for_this_thread() {
+    if (arenas_.size() == 1) {
+      return arenas_[0];
+    }
+    const size_t hash =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return arenas_[hash % arenas_.size()];
+  }
+
+  // Arenas hold a mutex, so they are neither copied nor moved after
+  // construction.
+  std::vector<Arena> arenas_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <executorch/runtime/core/memory_allocator.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * A temp allocator for kernel scratch memory that sizes itself from use.
+ *
+ * Allocations are bumped from an arena. Ones that do not fit are served with
+ * malloc() instead, and the peak usage between two resets is recorded; the
+ * next `reset()` grows the arena to that high-water mark. Since the method
+ * resets its temp allocator after every kernel, the arena converges to the
+ * largest scratch request of any kernel within the first execution, and later
+ * executions do not touch the heap.
+ *
+ * To skip the warm-up, pass a high-water mark recorded on an earlier run as
+ * the initial size.
+ */
+class TempMemoryAllocator : public MemoryAllocator {
+ public:
+  /**
+   * Alignment of the arena. The recorded usage includes the padding for
+   * alignments up to this value, so it stays valid when the arena moves.
+   */
+  static constexpr size_t kArenaAlignment = 64;
+
+  /**
+   * Construct a new temp allocator.
+   *
+   * @param[in] initial_size The initial arena size in bytes, e.g. a high-water
+   * mark recorded on an earlier run.
+   */
+  explicit TempMemoryAllocator(size_t initial_size = 0)
+      : MemoryAllocator(0, nullptr) {
+    grow(initial_size);
+  }
+
+  ~TempMemoryAllocator() override {
+    free_overflow();
+    std::free(arena_block_);
+  }
+
+  TempMemoryAllocator(const TempMemoryAllocator&) = delete;
+  TempMemoryAllocator& operator=(const TempMemoryAllocator&) = delete;
+
+  /**
+   * Allocates 'size' bytes of memory, returning a pointer to the allocated
+   * region, or nullptr upon failure.
+   */
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    EXECUTORCH_TRACK_ALLOCATION(prof_id(), size);
+
+    if (!isPowerOf2(alignment)) {
+      ET_LOG(Error, "Alignment %zu is not a power of 2", alignment);
+      return nullptr;
+    }
+
+    // Padding for alignments up to kArenaAlignment does not depend on where
+    // the arena is. Reserve the worst case padding for larger ones.
+    const size_t start = alignment <= kArenaAlignment
+        ? (used_ + alignment - 1) & ~(alignment - 1)
+        : used_ + alignment;
+    const size_t end = start + size;
+    if (end <= arena_size_) {
+      uint8_t* ptr = alignment <= kArenaAlignment
+          ? arena_ + start
+          : alignPointer(arena_ + used_, alignment);
+      used_ = end;
+      high_water_mark_ = std::max(high_water_mark_, end);
+      return ptr;
+    }
+
+    // Does not fit: use the heap for now, and count it so that the arena
+    // holds it from the next reset on.
+    overflow_size_ += size + alignment;
+    high_water_mark_ = std::max(high_water_mark_, used_ + overflow_size_);
+    void* block = std::malloc(size + alignment);
+    if (block == nullptr) {
+      return nullptr;
+    }
+    overflow_blocks_.push_back(block);
+    return alignPointer(block, alignment);
+  }
+
+  // Frees the heap allocations made since the last reset and grows the arena
+  // to the recorded high-water mark if needed.
+  void reset() override {
+    free_overflow();
+    if (high_water_mark_ > arena_size_) {
+      grow(high_water_mark_);
+    }
+    used_ = 0;
+  }
+
+  size_t used_size() const override {
+    return used_ + overflow_size_;
+  }
+
+  /**
+   * Returns the largest number of bytes in use between two resets so far.
+   */
+  size_t high_water_mark() const {
+    return high_water_mark_;
+  }
+
+  /**
+   * Returns the current arena size in bytes.
+   */
+  size_t arena_size() const {
+    return arena_size_;
+  }
+
+ private:
+  void grow(size_t size) {
+    if (size == 0) {
+      return;
+    }
+    void* block = std::malloc(size + kArenaAlignment);
+    if (block == nullptr) {
+      // Keep the smaller arena; allocations still overflow to the heap.
+      ET_LOG(Error, "Failed to grow the temp arena to %zu bytes", size);
+      return;
+    }
+    std::free(arena_block_);
+    arena_block_ = block;
+    arena_ = alignPointer(block, kArenaAlignment);
+    arena_size_ = size;
+  }
+
+  void free_overflow() {
+    for (void* block : overflow_blocks_) {
+      std::free(block);
+    }
+    overflow_blocks_.clear();
+    overflow_size_ = 0;
+  }
+
+  void* arena_block_ = nullptr; // What malloc() returned for the arena.
+  uint8_t* arena_ = nullptr; // Aligned to kArenaAlignment.
+  size_t arena_size_ = 0;
+  size_t used_ = 0;
+  size_t high_water_mark_ = 0;
+  size_t overflow_size_ = 0;
+  std::vector<void*> overflow_blocks_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/memory_allocator/growable_arena_allocator.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using torch::executor::util::GrowableArenaAllocator;
+
+class GrowableArenaAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+TEST_F(GrowableArenaAllocatorTest, AllocatesFromNull) {
+  GrowableArenaAllocator allocator;
+  size_t capacity = 0;
+  void* p = allocator.reallocate(nullptr, 0, 100, &capacity);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(capacity, 100);
+  EXPECT_EQ(allocator.allocated_size(), 100);
+  EXPECT_EQ(allocator.num_blocks(), 1);
+  std::memset(p, 0, capacity);
+}
+
+TEST_F(GrowableArenaAllocatorTest, CopiesExternalDataWithoutFreeingIt) {
+  GrowableArenaAllocator allocator;
+  uint8_t planned[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  size_t capacity = sizeof(planned);
+
+  // Only the bytes in use are preserved.
+  auto* p = static_cast<uint8_t*>(
+      allocator.reallocate(planned, /*used=*/4, /*size=*/10, &capacity));
+  ASSERT_NE(p, nullptr);
+  // At least twice the old capacity.
+  EXPECT_EQ(capacity, 16);
+  EXPECT_EQ(std::memcmp(p, planned, 4), 0);
+  EXPECT_EQ(allocator.allocated_size(), 16);
+
+  // The external buffer is still usable.
+  planned[0] = 42;
+  EXPECT_EQ(planned[0], 42);
+}
+
+TEST_F(GrowableArenaAllocatorTest, GrowsGeometrically) {
+  GrowableArenaAllocator allocator;
+  size_t capacity = 0;
+  auto* p =
+      static_cast<uint8_t*>(allocator.reallocate(nullptr, 0, 64, &capacity));
+  ASSERT_NE(p, nullptr);
+  for (size_t i = 0; i < 64; ++i) {
+    p[i] = static_cast<uint8_t>(i);
+  }
+
+  // Growing by one byte doubles the capacity and keeps the contents.
+  p = static_cast<uint8_t*>(allocator.reallocate(p, 64, 65, &capacity));
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(capacity, 128);
+  for (size_t i = 0; i < 64; ++i) {
+    EXPECT_EQ(p[i], static_cast<uint8_t>(i));
+  }
+
+  // A larger request wins over doubling.
+  p = static_cast<uint8_t*>(allocator.reallocate(p, 64, 1000, &capacity));
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(capacity, 1000);
+  EXPECT_EQ(p[63], 63);
+
+  // The old buffers were replaced rather than kept.
+  EXPECT_EQ(allocator.num_blocks(), 1);
+  EXPECT_EQ(allocator.allocated_size(), 1000);
+}
+
+TEST_F(GrowableArenaAllocatorTest, TracksHighWaterMark) {
+  GrowableArenaAllocator allocator;
+  size_t a_capacity = 0;
+  size_t b_capacity = 0;
+  void* a = allocator.reallocate(nullptr, 0, 100, &a_capacity);
+  void* b = allocator.reallocate(nullptr, 0, 200, &b_capacity);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(allocator.num_blocks(), 2);
+  EXPECT_EQ(allocator.allocated_size(), 300);
+  EXPECT_EQ(allocator.high_water_mark(), 300);
+
+  a = allocator.reallocate(a, 100, 150, &a_capacity);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(a_capacity, 200);
+  EXPECT_EQ(allocator.allocated_size(), 400);
+  EXPECT_EQ(allocator.high_water_mark(), 400);
+}
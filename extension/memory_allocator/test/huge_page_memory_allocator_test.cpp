@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/memory_allocator/huge_page_memory_allocator.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using torch::executor::util::HugePageMemoryAllocator;
+
+constexpr auto kHugePageSize = HugePageMemoryAllocator::kHugePageSize;
+
+class HugePageMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+TEST_F(HugePageMemoryAllocatorTest, AllocationsAreHugePageAligned) {
+  HugePageMemoryAllocator allocator;
+
+  for (size_t size : {size_t(1), kHugePageSize, kHugePageSize + 1}) {
+    void* p = allocator.allocate(size);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % kHugePageSize, 0);
+
+    // The whole allocation is writable.
+    std::memset(p, 0x55, size);
+    EXPECT_EQ(static_cast<uint8_t*>(p)[size - 1], 0x55);
+  }
+  allocator.reset();
+
+  // Usable again after a reset.
+  EXPECT_NE(allocator.allocate(64, /*alignment=*/64), nullptr);
+}
+
+TEST_F(HugePageMemoryAllocatorTest, BadAlignmentFails) {
+  HugePageMemoryAllocator allocator;
+
+  EXPECT_EQ(allocator.allocate(16, /*alignment=*/3), nullptr);
+  EXPECT_EQ(allocator.allocate(16, /*alignment=*/2 * kHugePageSize), nullptr);
+}
+
+TEST_F(HugePageMemoryAllocatorTest, NumaBindingFailureIsNotFatal) {
+  // Bind to a node that is unlikely to exist; the allocation still succeeds
+  // with the default placement.
+  HugePageMemoryAllocator allocator(/*numa_node=*/1023);
+
+  void* p = allocator.allocate(kHugePageSize);
+  ASSERT_NE(p, nullptr);
+  std::memset(p, 0, kHugePageSize);
+
+  // Node 0 exists on every system.
+  HugePageMemoryAllocator node0_allocator(/*numa_node=*/0);
+  void* q = node0_allocator.allocate(kHugePageSize);
+  ASSERT_NE(q, nullptr);
+  std::memset(q, 0, kHugePageSize);
+}
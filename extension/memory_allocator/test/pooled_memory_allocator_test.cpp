@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/memory_allocator/pooled_memory_allocator.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using torch::executor::util::PooledMemoryAllocator;
+
+class PooledMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+bool is_aligned(const void* ptr, size_t alignment) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  return addr % alignment == 0;
+}
+
+TEST_F(PooledMemoryAllocatorTest, ReusesChunksAfterReset) {
+  PooledMemoryAllocator allocator;
+  void* p = allocator.allocate(100);
+  void* q = allocator.allocate(1000);
+  ASSERT_NE(p, nullptr);
+  ASSERT_NE(q, nullptr);
+  std::memset(p, 0, 100);
+  std::memset(q, 0, 1000);
+  // Rounded up to the size classes.
+  EXPECT_EQ(allocator.used_size(), 128 + 1024);
+  EXPECT_EQ(allocator.stats().num_mallocs, 2);
+
+  allocator.reset();
+  EXPECT_EQ(allocator.used_size(), 0);
+
+  // The same requests are served from the pools, in any order.
+  void* q2 = allocator.allocate(1000);
+  void* p2 = allocator.allocate(120);
+  EXPECT_EQ(q2, q);
+  EXPECT_EQ(p2, p);
+
+  const auto stats = allocator.stats();
+  EXPECT_EQ(stats.num_allocations, 4);
+  EXPECT_EQ(stats.num_mallocs, 2);
+  EXPECT_EQ(stats.pooled_bytes, 128 + 1024);
+  EXPECT_EQ(stats.high_water_mark, 128 + 1024);
+}
+
+TEST_F(PooledMemoryAllocatorTest, ChunksInUseAreNotReused) {
+  PooledMemoryAllocator allocator;
+  void* p = allocator.allocate(64);
+  void* q = allocator.allocate(64);
+  EXPECT_NE(p, q);
+  EXPECT_EQ(allocator.stats().num_mallocs, 2);
+}
+
+TEST_F(PooledMemoryAllocatorTest, AlignedAllocations) {
+  PooledMemoryAllocator allocator;
+  for (size_t alignment : {1, 2, 16, 64, 256}) {
+    void* p = allocator.allocate(10, alignment);
+    ASSERT_NE(p, nullptr);
+    EXPECT_TRUE(is_aligned(p, alignment));
+  }
+  EXPECT_EQ(allocator.allocate(10, 3), nullptr);
+}
+
+TEST_F(PooledMemoryAllocatorTest, ReleaseFreesPooledChunks) {
+  PooledMemoryAllocator allocator;
+  allocator.allocate(100);
+  void* q = allocator.allocate(100);
+  ASSERT_NE(q, nullptr);
+  allocator.reset();
+
+  allocator.allocate(100);
+  allocator.release();
+  // The chunk in use is kept, the pooled one is freed.
+  EXPECT_EQ(allocator.stats().pooled_bytes, 128);
+
+  allocator.reset();
+  allocator.allocate(100);
+  EXPECT_EQ(allocator.stats().num_mallocs, 2);
+}
+
+TEST_F(PooledMemoryAllocatorTest, ConcurrentAllocations) {
+  PooledMemoryAllocator allocator(/*num_arenas=*/4);
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kNumAllocations = 100;
+  for (int round = 0; round < 2; ++round) {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&allocator]() {
+        for (size_t i = 0; i < kNumAllocations; ++i) {
+          void* p = allocator.allocate(256);
+          ASSERT_NE(p, nullptr);
+          std::memset(p, 0, 256);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(allocator.used_size(), kNumThreads * kNumAllocations * 256);
+    allocator.reset();
+  }
+  const auto stats = allocator.stats();
+  EXPECT_EQ(stats.num_allocations, 2 * kNumThreads * kNumAllocations);
+  EXPECT_LE(stats.num_mallocs, 2 * kNumThreads * kNumAllocations);
+}
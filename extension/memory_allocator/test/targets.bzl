@@ -15,3 +15,43 @@ def define_common_targets():
             "//executorch/extension/memory_allocator:malloc_memory_allocator",
         ],
     )
+
+    runtime.cxx_test(
+        name = "huge_page_memory_allocator_test",
+        srcs = [
+            "huge_page_memory_allocator_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:huge_page_memory_allocator",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "temp_memory_allocator_test",
+        srcs = [
+            "temp_memory_allocator_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:temp_memory_allocator",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "growable_arena_allocator_test",
+        srcs = [
+            "growable_arena_allocator_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:growable_arena_allocator",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "pooled_memory_allocator_test",
+        srcs = [
+            "pooled_memory_allocator_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:pooled_memory_allocator",
+        ],
+    )
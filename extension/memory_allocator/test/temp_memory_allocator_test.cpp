@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using torch::executor::util::TempMemoryAllocator;
+
+class TempMemoryAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+bool is_aligned(const void* ptr, size_t alignment) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  return addr % alignment == 0;
+}
+
+TEST_F(TempMemoryAllocatorTest, GrowsToHighWaterMark) {
+  TempMemoryAllocator allocator;
+  EXPECT_EQ(allocator.arena_size(), 0);
+
+  // Everything overflows to the heap at first.
+  void* p = allocator.allocate(100);
+  void* q = allocator.allocate(300, /*alignment=*/16);
+  ASSERT_NE(p, nullptr);
+  ASSERT_NE(q, nullptr);
+  EXPECT_TRUE(is_aligned(q, 16));
+  std::memset(p, 0, 100);
+  std::memset(q, 0, 300);
+
+  const size_t high_water_mark = allocator.high_water_mark();
+  EXPECT_GE(high_water_mark, 400);
+
+  // The reset grows the arena, and the same requests then fit in it.
+  allocator.reset();
+  EXPECT_EQ(allocator.arena_size(), high_water_mark);
+  for (int i = 0; i < 3; ++i) {
+    uint8_t* p2 = static_cast<uint8_t*>(allocator.allocate(100));
+    uint8_t* q2 =
+        static_cast<uint8_t*>(allocator.allocate(300, /*alignment=*/16));
+    ASSERT_NE(p2, nullptr);
+    ASSERT_NE(q2, nullptr);
+    EXPECT_TRUE(is_aligned(q2, 16));
+    EXPECT_GE(q2, p2 + 100);
+    allocator.reset();
+    EXPECT_EQ(allocator.arena_size(), high_water_mark);
+  }
+  EXPECT_EQ(allocator.high_water_mark(), high_water_mark);
+}
+
+TEST_F(TempMemoryAllocatorTest, InitialSizeAvoidsGrowth) {
+  TempMemoryAllocator allocator(/*initial_size=*/1024);
+  EXPECT_EQ(allocator.arena_size(), 1024);
+
+  ASSERT_NE(allocator.allocate(1000), nullptr);
+  allocator.reset();
+  EXPECT_EQ(allocator.arena_size(), 1024);
+  EXPECT_EQ(allocator.high_water_mark(), 1000);
+}
+
+TEST_F(TempMemoryAllocatorTest, LargeAlignments) {
+  TempMemoryAllocator allocator;
+
+  for (int i = 0; i < 2; ++i) {
+    void* p = allocator.allocate(8);
+    void* q = allocator.allocate(256, /*alignment=*/1024);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(q, nullptr);
+    EXPECT_TRUE(is_aligned(q, 1024));
+    allocator.reset();
+  }
+
+  EXPECT_EQ(allocator.allocate(8, /*alignment=*/3), nullptr);
+}
@@ -8,8 +8,15 @@
 
 #include <executorch/extension/module/module.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
 #include <executorch/extension/data_loader/mmap_data_loader.h>
+#include <executorch/extension/memory_allocator/growable_arena_allocator.h>
 #include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
 #include <executorch/runtime/platform/runtime.h>
 
 /**
@@ -48,15 +55,22 @@ Module::Module(
 Module::Module(
     std::unique_ptr<DataLoader> data_loader,
     std::unique_ptr<MemoryAllocator> memory_allocator,
-    std::unique_ptr<EventTracer> event_tracer)
+    std::unique_ptr<EventTracer> event_tracer,
+    std::unique_ptr<MemoryAllocator> planned_memory_allocator)
     : data_loader_(std::move(data_loader)),
       memory_allocator_(
           memory_allocator ? std::move(memory_allocator)
                            : std::make_unique<util::MallocMemoryAllocator>()),
-      event_tracer_(std::move(event_tracer)) {
+      event_tracer_(std::move(event_tracer)),
+      planned_memory_allocator_(std::move(planned_memory_allocator)) {
   runtime_init();
 }
 
+// Defined here, where MethodPool is complete.
+Module::Module(Module&&) = default;
+Module& Module::operator=(Module&&) = default;
+Module::~Module() = default;
+
 Error Module::load(const Program::Verification verification) {
   if (!is_loaded()) {
     if (!data_loader_) {
@@ -95,39 +109,238 @@ Result<std::unordered_set<std::string>> Module::method_names() {
   return result;
 }
 
+/**
+ * A fixed set of Method instances with a lock-free free list. The list is a
+ * stack of instance indices whose head carries a generation count, so that a
+ * pop racing with a pop and push of the same index can't succeed.
+ */
+class Module::MethodPool final {
+ public:
+  explicit MethodPool(std::vector<MethodHolder>&& holders)
+      : holders_(std::move(holders)), next_(holders_.size()) {
+    for (uint32_t index = 0; index < holders_.size(); ++index) {
+      release(index);
+    }
+  }
+
+  PooledMethod acquire() {
+    uint32_t index = 0;
+    while (!try_pop(&index)) {
+      std::this_thread::yield();
+    }
+    return PooledMethod(this, index, holders_[index].method.get());
+  }
+
+  void release(uint32_t index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t new_head = 0;
+    do {
+      next_[index].store(
+          static_cast<uint32_t>(head), std::memory_order_relaxed);
+      new_head = next_generation(head) | (index + 1);
+    } while (!head_.compare_exchange_weak(
+        head, new_head, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+ private:
+  static uint64_t next_generation(uint64_t head) {
+    return ((head >> 32) + 1) << 32;
+  }
+
+  bool try_pop(uint32_t* index) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    while (true) {
+      // The low half is the top index plus one, or zero if the list is empty.
+      const uint32_t top = static_cast<uint32_t>(head);
+      if (top == 0) {
+        return false;
+      }
+      const uint64_t new_head = next_generation(head) |
+          next_[top - 1].load(std::memory_order_relaxed);
+      if (head_.compare_exchange_weak(
+              head,
+              new_head,
+              std::memory_order_acquire,
+              std::memory_order_acquire)) {
+        *index = top - 1;
+        return true;
+      }
+    }
+  }
+
+  std::vector<MethodHolder> holders_;
+  std::vector<std::atomic<uint32_t>> next_;
+  std::atomic<uint64_t> head_{0};
+};
+
+Module::PooledMethod::~PooledMethod() {
+  if (pool_ != nullptr) {
+    pool_->release(index_);
+  }
+}
+
+Error Module::allocate_planned_buffer(
+    size_t buffer_size,
+    std::vector<std::vector<uint8_t>>* owned_buffers,
+    std::vector<Span<uint8_t>>* spans) {
+  uint8_t* buffer = nullptr;
+  if (planned_memory_allocator_) {
+    buffer = reinterpret_cast<uint8_t*>(
+        planned_memory_allocator_->allocate(buffer_size));
+    ET_CHECK_OR_RETURN_ERROR(
+        buffer != nullptr,
+        MemoryAllocationFailed,
+        "Failed to allocate planned buffer %zu of size %zu",
+        spans->size(),
+        buffer_size);
+  } else {
+    owned_buffers->emplace_back(buffer_size);
+    buffer = owned_buffers->back().data();
+  }
+  spans->emplace_back(buffer, buffer_size);
+  return Error::Ok;
+}
+
+Result<Module::MethodHolder> Module::load_method_holder(
+    const std::string& method_name,
+    std::unique_ptr<MemoryAllocator> method_allocator,
+    EventTracer* event_tracer,
+    SharedPlannedMemory* shared_planned_memory) {
+  // Start paging in the constants while the method is being set up. This is
+  // only a hint, so failures are left to load_method() to report.
+  (void)program_->experimental_prefetch_constants(method_name.c_str());
+
+  MethodHolder method_holder;
+  method_holder.method_allocator = std::move(method_allocator);
+  const auto method_metadata =
+      ET_UNWRAP(program_->method_meta(method_name.c_str()));
+  const auto planned_buffersCount =
+      method_metadata.num_memory_planned_buffers();
+  method_holder.planned_buffers.reserve(planned_buffersCount);
+  method_holder.planned_spans.reserve(planned_buffersCount);
+
+  if (shared_planned_memory != nullptr) {
+    auto& shared = *shared_planned_memory;
+    if (shared.spans.empty()) {
+      shared.buffers.reserve(shared.buffer_sizes.size());
+      shared.spans.reserve(shared.buffer_sizes.size());
+      for (const auto buffer_size : shared.buffer_sizes) {
+        ET_CHECK_OK_OR_RETURN_ERROR(allocate_planned_buffer(
+            buffer_size, &shared.buffers, &shared.spans));
+      }
+    }
+    // The group was sized from the plans of all its methods.
+    method_holder.planned_spans.assign(
+        shared.spans.begin(), shared.spans.begin() + planned_buffersCount);
+  } else {
+    for (auto index = 0; index < planned_buffersCount; ++index) {
+      ET_CHECK_OK_OR_RETURN_ERROR(allocate_planned_buffer(
+          method_metadata.memory_planned_buffer_size(index).get(),
+          &method_holder.planned_buffers,
+          &method_holder.planned_spans));
+    }
+  }
+  method_holder.planned_memory = std::make_unique<HierarchicalAllocator>(Span(
+      method_holder.planned_spans.data(), method_holder.planned_spans.size()));
+  method_holder.temp_allocator = std::make_unique<util::TempMemoryAllocator>();
+  method_holder.dynamic_allocator =
+      std::make_unique<util::GrowableArenaAllocator>();
+  method_holder.memory_manager = std::make_unique<MemoryManager>(
+      method_holder.method_allocator ? method_holder.method_allocator.get()
+                                     : memory_allocator_.get(),
+      method_holder.planned_memory.get(),
+      method_holder.temp_allocator.get(),
+      method_holder.dynamic_allocator.get());
+  method_holder.method = ET_UNWRAP_UNIQUE(program_->load_method(
+      method_name.c_str(), method_holder.memory_manager.get(), event_tracer));
+  return method_holder;
+}
+
 Error Module::load_method(const std::string& method_name) {
   if (!is_method_loaded(method_name)) {
     ET_CHECK_OK_OR_RETURN_ERROR(load());
+    const auto shared = shared_planned_memory_.find(method_name);
+    methods_.emplace(
+        method_name,
+        ET_UNWRAP(load_method_holder(
+            method_name,
+            /*method_allocator=*/nullptr,
+            event_tracer_.get(),
+            shared != shared_planned_memory_.end() ? shared->second.get()
+                                                   : nullptr)));
+  }
+  return Error::Ok;
+}
 
-    MethodHolder method_holder;
+Error Module::share_planned_memory(
+    const std::vector<std::string>& method_names) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load());
+  auto shared = std::make_shared<SharedPlannedMemory>();
+  for (const auto& method_name : method_names) {
+    ET_CHECK_OR_RETURN_ERROR(
+        !is_method_loaded(method_name) &&
+            shared_planned_memory_.count(method_name) == 0,
+        InvalidState,
+        "Method %s is already loaded or shares its planned memory",
+        method_name.c_str());
     const auto method_metadata =
         ET_UNWRAP(program_->method_meta(method_name.c_str()));
-    const auto planned_buffersCount =
-        method_metadata.num_memory_planned_buffers();
-    method_holder.planned_buffers.reserve(planned_buffersCount);
-    method_holder.planned_spans.reserve(planned_buffersCount);
-
-    for (auto index = 0; index < planned_buffersCount; ++index) {
-      const auto buffer_size =
-          method_metadata.memory_planned_buffer_size(index).get();
-      method_holder.planned_buffers.emplace_back(buffer_size);
-      method_holder.planned_spans.emplace_back(
-          method_holder.planned_buffers.back().data(), buffer_size);
+    const size_t num_buffers = method_metadata.num_memory_planned_buffers();
+    if (shared->buffer_sizes.size() < num_buffers) {
+      shared->buffer_sizes.resize(num_buffers, 0);
+    }
+    for (size_t index = 0; index < num_buffers; ++index) {
+      shared->buffer_sizes[index] = std::max(
+          shared->buffer_sizes[index],
+          static_cast<size_t>(
+              method_metadata.memory_planned_buffer_size(index).get()));
     }
-    method_holder.planned_memory = std::make_unique<HierarchicalAllocator>(Span(
-        method_holder.planned_spans.data(),
-        method_holder.planned_spans.size()));
-    method_holder.memory_manager = std::make_unique<MemoryManager>(
-        memory_allocator_.get(), method_holder.planned_memory.get());
-    method_holder.method = ET_UNWRAP_UNIQUE(program_->load_method(
-        method_name.c_str(),
-        method_holder.memory_manager.get(),
-        event_tracer_.get()));
-    methods_.emplace(method_name, std::move(method_holder));
   }
+  for (const auto& method_name : method_names) {
+    shared_planned_memory_.emplace(method_name, shared);
+  }
+  return Error::Ok;
+}
+
+Error Module::load_method_pool(
+    const std::string& method_name,
+    size_t pool_size) {
+  ET_CHECK_OR_RETURN_ERROR(
+      pool_size > 0 && pool_size < UINT32_MAX,
+      InvalidArgument,
+      "Invalid pool size %zu",
+      pool_size);
+  ET_CHECK_OR_RETURN_ERROR(
+      method_pools_.count(method_name) == 0,
+      InvalidState,
+      "Method %s already has a pool",
+      method_name.c_str());
+  ET_CHECK_OK_OR_RETURN_ERROR(load());
+
+  std::vector<MethodHolder> holders;
+  holders.reserve(pool_size);
+  for (size_t i = 0; i < pool_size; ++i) {
+    holders.push_back(ET_UNWRAP(load_method_holder(
+        method_name,
+        std::make_unique<util::MallocMemoryAllocator>(),
+        /*event_tracer=*/nullptr)));
+  }
+  method_pools_.emplace(
+      method_name, std::make_unique<MethodPool>(std::move(holders)));
   return Error::Ok;
 }
 
+Result<Module::PooledMethod> Module::acquire_method(
+    const std::string& method_name) {
+  const auto pool = method_pools_.find(method_name);
+  ET_CHECK_OR_RETURN_ERROR(
+      pool != method_pools_.end(),
+      InvalidArgument,
+      "Method %s has no pool",
+      method_name.c_str());
+  return pool->second->acquire();
+}
+
 bool Module::is_method_loaded(const std::string& method_name) const {
   return methods_.count(method_name);
 }
@@ -156,4 +369,185 @@ Result<std::vector<EValue>> Module::execute(
   return outputs;
 }
 
+Result<Method*> Module::bind_method(const std::string& method_name) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  return methods_.at(method_name).method.get();
+}
+
+Error Module::execute(
+    Method& method,
+    Span<const EValue> inputs,
+    Span<EValue> outputs) {
+  ET_CHECK_OR_RETURN_ERROR(
+      inputs.size() <= method.inputs_size(),
+      InvalidArgument,
+      "Got %zu inputs, method has %zu",
+      inputs.size(),
+      method.inputs_size());
+  ET_CHECK_OR_RETURN_ERROR(
+      outputs.size() <= method.outputs_size(),
+      InvalidArgument,
+      "Got room for %zu outputs, method has %zu",
+      outputs.size(),
+      method.outputs_size());
+
+  for (size_t index = 0; index < inputs.size(); ++index) {
+    ET_CHECK_OK_OR_RETURN_ERROR(method.set_input(inputs[index], index));
+  }
+  ET_CHECK_OK_OR_RETURN_ERROR(method.execute());
+  for (size_t index = 0; index < outputs.size(); ++index) {
+    outputs[index] = method.get_output(index);
+  }
+  return Error::Ok;
+}
+
+namespace {
+
+// Whether two non-tensor inputs are equal, so that requests with them can
+// share a batch.
+bool same_input(const EValue& lhs, const EValue& rhs) {
+  if (lhs.tag != rhs.tag) {
+    return false;
+  }
+  switch (lhs.tag) {
+    case Tag::None:
+      return true;
+    case Tag::Int:
+      return lhs.toInt() == rhs.toInt();
+    case Tag::Double:
+      return lhs.toDouble() == rhs.toDouble();
+    case Tag::Bool:
+      return lhs.toBool() == rhs.toBool();
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+Error Module::set_max_batch_size(
+    const std::string& method_name,
+    size_t max_batch_size) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  auto& holder = methods_.at(method_name);
+  ET_CHECK_OR_RETURN_ERROR(
+      holder.max_batch_size == 0,
+      InvalidState,
+      "The max batch size of %s is already set",
+      method_name.c_str());
+  ET_CHECK_OK_OR_RETURN_ERROR(
+      holder.method->experimental_allocate_io_buffer_sets(max_batch_size));
+  holder.max_batch_size = max_batch_size;
+  return Error::Ok;
+}
+
+Error Module::execute_batch(
+    const std::string& method_name,
+    const std::vector<std::vector<EValue>>& requests,
+    const BatchOutputCallback& on_outputs) {
+  ET_CHECK_OK_OR_RETURN_ERROR(load_method(method_name));
+  const auto& holder = methods_.at(method_name);
+  Method& method = *holder.method;
+  const MethodMeta meta = method.method_meta();
+
+  // The tensor inputs of a batched request are copied into the input buffers
+  // of a set, so they must have the planned dtypes and sizes.
+  auto batchable = [&](const std::vector<EValue>& inputs) {
+    if (holder.max_batch_size == 0 || inputs.size() != method.inputs_size()) {
+      return false;
+    }
+    for (size_t index = 0; index < inputs.size(); ++index) {
+      const auto tag = meta.input_tag(index);
+      if (!tag.ok() || *tag != Tag::Tensor) {
+        continue;
+      }
+      const auto info = meta.input_tensor_meta(index);
+      const auto buffer = method.experimental_input_buffer(0, index);
+      if (!inputs[index].isTensor() || !info.ok() || !buffer.ok() ||
+          buffer->data() == nullptr) {
+        return false;
+      }
+      const auto& tensor = inputs[index].toTensor();
+      const auto sizes = info->sizes();
+      if (tensor.scalar_type() != info->scalar_type() ||
+          tensor.nbytes() != buffer->size() ||
+          !std::equal(
+              sizes.begin(),
+              sizes.end(),
+              tensor.sizes().begin(),
+              tensor.sizes().end())) {
+        return false;
+      }
+    }
+    return true;
+  };
+  auto compatible = [](const std::vector<EValue>& lhs,
+                       const std::vector<EValue>& rhs) {
+    for (size_t index = 0; index < lhs.size(); ++index) {
+      if (!lhs[index].isTensor() && !same_input(lhs[index], rhs[index])) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<bool> done(requests.size(), false);
+  std::vector<size_t> batch;
+  std::vector<size_t> sets;
+  std::vector<EValue> outputs(method.outputs_size());
+  for (size_t first = 0; first < requests.size(); ++first) {
+    if (done[first]) {
+      continue;
+    }
+    done[first] = true;
+    if (!batchable(requests[first])) {
+      auto result = execute(method_name, requests[first]);
+      ET_CHECK_OK_OR_RETURN_ERROR(result.error());
+      on_outputs(first, result.get());
+      continue;
+    }
+
+    // Group the following pending requests that can share the batch.
+    batch.assign(1, first);
+    for (size_t next = first + 1;
+         next < requests.size() && batch.size() < holder.max_batch_size;
+         ++next) {
+      if (!done[next] && batchable(requests[next]) &&
+          compatible(requests[first], requests[next])) {
+        done[next] = true;
+        batch.push_back(next);
+      }
+    }
+
+    sets.resize(batch.size());
+    for (size_t set = 0; set < batch.size(); ++set) {
+      sets[set] = set;
+      const auto& inputs = requests[batch[set]];
+      for (size_t index = 0; index < inputs.size(); ++index) {
+        if (!inputs[index].isTensor()) {
+          // Values other than tensors are shared by the sets.
+          if (set == 0) {
+            ET_CHECK_OK_OR_RETURN_ERROR(method.set_input(inputs[index], index));
+          }
+          continue;
+        }
+        const auto& tensor = inputs[index].toTensor();
+        auto buffer = method.experimental_input_buffer(set, index);
+        ET_CHECK_OK_OR_RETURN_ERROR(buffer.error());
+        std::memcpy(buffer->data(), tensor.const_data_ptr(), tensor.nbytes());
+      }
+    }
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        method.experimental_execute_batch({sets.data(), sets.size()}));
+    for (size_t set = 0; set < batch.size(); ++set) {
+      ET_CHECK_OK_OR_RETURN_ERROR(
+          method.experimental_select_io_buffer_set(set));
+      ET_CHECK_OK_OR_RETURN_ERROR(
+          method.get_outputs(outputs.data(), outputs.size()));
+      on_outputs(batch[set], outputs);
+    }
+  }
+  return Error::Ok;
+}
+
 } // namespace torch::executor
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -53,15 +55,21 @@ class Module final {
    * @param[in] data_loader A DataLoader used for loading program data.
    * @param[in] memory_allocator A MemoryAllocator used for memory management.
    * @param[in] event_tracer A EventTracer used for tracking and logging events.
+   * @param[in] planned_memory_allocator A MemoryAllocator that backs the
+   * memory-planned buffers of the methods, e.g. with memory shared with an
+   * accelerator so that delegates can use the planned tensors without copies.
+   * The buffers are allocated on the heap if nullptr.
    */
   explicit Module(
       std::unique_ptr<DataLoader> data_loader,
       std::unique_ptr<MemoryAllocator> memory_allocator = nullptr,
-      std::unique_ptr<EventTracer> event_tracer = nullptr);
+      std::unique_ptr<EventTracer> event_tracer = nullptr,
+      std::unique_ptr<MemoryAllocator> planned_memory_allocator = nullptr);
   Module(const Module&) = delete;
   Module& operator=(const Module&) = delete;
-  Module(Module&&) = default;
-  Module& operator=(Module&&) = default;
+  Module(Module&&);
+  Module& operator=(Module&&);
+  ~Module();
 
   /**
    * Loads the program using the specified data loader and memory allocator.
@@ -153,6 +161,82 @@ class Module final {
     return execute(method_name, {});
   }
 
+  /**
+   * Loads a method if needed and returns it, for use with the
+   * allocation-free `execute()` overload that takes a Method. Resolving the
+   * method once avoids the name lookup on every call. Outputs can be written
+   * straight into caller buffers by calling `Method::set_output_data_ptr()` on
+   * the returned method once.
+   *
+   * @param[in] method_name The name of the method to bind.
+   *
+   * @returns The method, owned by the Module and valid for its lifetime, or an
+   * error if the program or method failed to load.
+   */
+  Result<Method*> bind_method(const std::string& method_name);
+
+  /**
+   * Execute a method returned by `bind_method()` without allocating: inputs
+   * are read from a span and outputs are copied into caller-provided EValues.
+   *
+   * @param[in] method The method to execute.
+   * @param[in] inputs The values to set as the first `inputs.size()` inputs.
+   * @param[out] outputs Receives the first `outputs.size()` outputs, which
+   *     are shallow copies that alias the method's memory.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  __ET_NODISCARD
+  static Error
+  execute(Method& method, Span<const EValue> inputs, Span<EValue> outputs);
+
+  /**
+   * Allocates `max_batch_size` I/O buffer sets for a method, so that
+   * `execute_batch()` can hand up to that many requests to the method at
+   * once. Loads the method if needed. Can only be called once per method.
+   *
+   * @param[in] method_name The name of the method.
+   * @param[in] max_batch_size The most requests to execute together.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  __ET_NODISCARD
+  Error set_max_batch_size(
+      const std::string& method_name,
+      size_t max_batch_size);
+
+  /**
+   * Receives the outputs of the request at `request_index`. They alias the
+   * method's memory and are only valid during the call.
+   */
+  using BatchOutputCallback = std::function<void(
+      size_t request_index,
+      const std::vector<EValue>& outputs)>;
+
+  /**
+   * Executes a method for each of a list of requests. Requests whose tensor
+   * inputs have the dtypes and sizes of the method's inputs, and whose other
+   * inputs are equal, are grouped up to the size set with
+   * `set_max_batch_size()`, and each group runs through
+   * `Method::experimental_execute_batch()`. Backends that implement
+   * `execute_batch()` then get the whole group at once. Other requests, and
+   * all of them without a max batch size, run one at a time. Loads the method
+   * if needed.
+   *
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] requests The inputs of each request.
+   * @param[in] on_outputs Called with the outputs of each request, in the
+   *     order the requests finish.
+   *
+   * @returns An Error to indicate success or failure. Stops at the first
+   * failing request.
+   */
+  __ET_NODISCARD
+  Error execute_batch(
+      const std::string& method_name,
+      const std::vector<std::vector<EValue>>& requests,
+      const BatchOutputCallback& on_outputs);
+
   /**
    * Execute the 'forward' method with the given input and retrieve output.
    * Loads the program and method before executing if needed.
@@ -179,6 +263,100 @@ class Module final {
     return forward({});
   }
 
+ private:
+  class MethodPool;
+
+ public:
+  /**
+   * Exclusive use of one Method instance of a pool loaded with
+   * `load_method_pool()`. The instance returns to the pool when this object is
+   * destroyed, so outputs read from it must not be used past that point. Must
+   * not outlive the Module.
+   */
+  class PooledMethod final {
+   public:
+    PooledMethod(PooledMethod&& rhs) noexcept
+        : pool_(rhs.pool_), index_(rhs.index_), method_(rhs.method_) {
+      rhs.pool_ = nullptr;
+      rhs.method_ = nullptr;
+    }
+    ~PooledMethod();
+
+    PooledMethod(const PooledMethod&) = delete;
+    PooledMethod& operator=(const PooledMethod&) = delete;
+    PooledMethod& operator=(PooledMethod&&) = delete;
+
+    Method& operator*() const {
+      return *method_;
+    }
+    Method* operator->() const {
+      return method_;
+    }
+
+   private:
+    friend class Module;
+    PooledMethod(MethodPool* pool, uint32_t index, Method* method)
+        : pool_(pool), index_(index), method_(method) {}
+
+    MethodPool* pool_;
+    uint32_t index_;
+    Method* method_;
+  };
+
+  /**
+   * Loads `pool_size` instances of a method that share the program, each with
+   * its own method allocator and planned memory, so that several threads can
+   * execute the method concurrently. Loads the program if needed.
+   *
+   * Pools must be loaded before the concurrent use starts, and only
+   * `acquire_method()` and the acquired methods may be used concurrently.
+   * Pooled instances do not report to the Module's EventTracer, which is not
+   * thread-safe.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] pool_size The number of instances to load.
+   *
+   * @returns An Error to indicate success or failure.
+   */
+  __ET_NODISCARD
+  Error load_method_pool(const std::string& method_name, size_t pool_size);
+
+  /**
+   * Acquires an idle instance from the pool of a method, waiting for one if
+   * all of them are in use. Thread-safe.
+   *
+   * @param[in] method_name The name of a method loaded with
+   * `load_method_pool()`.
+   *
+   * @returns The acquired method, or Error::InvalidArgument if the method has
+   * no pool.
+   */
+  __ET_NODISCARD
+  Result<PooledMethod> acquire_method(const std::string& method_name);
+
+  /**
+   * Declares that the given methods never execute at the same time, so that
+   * they can share one set of memory-planned buffers, each sized to the
+   * largest plan of the group for its index, instead of allocating a set per
+   * method. For example, the prefill and decode methods of an LLM. Must be
+   * called before any of the methods is loaded. Loads the program if needed.
+   *
+   * Planned memory holds the inputs, outputs and intermediate tensors of a
+   * method, so executing one method of the group invalidates the inputs set
+   * on and the outputs read from the others. Methods that keep state in
+   * planned memory across executions, like mutable buffers, must not share
+   * it. Pools loaded with `load_method_pool()` never use the shared buffers.
+   *
+   * @param[in] method_names The names of the methods that share planned
+   * memory.
+   *
+   * @returns An Error to indicate success or failure. Error::InvalidState if
+   * one of the methods is already loaded or shares planned memory with
+   * another group.
+   */
+  __ET_NODISCARD
+  Error share_planned_memory(const std::vector<std::string>& method_names);
+
   /**
    * Retrieves the EventTracer instance being used by the Module.
    * EventTracer is used for tracking and logging events during the execution
@@ -193,21 +371,53 @@ class Module final {
 
  private:
   struct MethodHolder {
+    // Set for pooled instances, which can't share the Module's allocator.
+    std::unique_ptr<MemoryAllocator> method_allocator;
     std::vector<std::vector<uint8_t>> planned_buffers;
     std::vector<Span<uint8_t>> planned_spans;
     std::unique_ptr<HierarchicalAllocator> planned_memory;
+    // Kernel scratch memory, sized from the usage of earlier executions.
+    std::unique_ptr<MemoryAllocator> temp_allocator;
+    // Data of the unbounded tensors, kept across executions.
+    std::unique_ptr<DynamicAllocator> dynamic_allocator;
     std::unique_ptr<MemoryManager> memory_manager;
     std::unique_ptr<Method> method;
+    // The number of I/O buffer sets, set by set_max_batch_size().
+    size_t max_batch_size = 0;
+  };
+
+  // Planned buffers shared by a group of methods, allocated when the first
+  // of them is loaded.
+  struct SharedPlannedMemory {
+    std::vector<size_t> buffer_sizes;
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<Span<uint8_t>> spans;
   };
 
+  Result<MethodHolder> load_method_holder(
+      const std::string& method_name,
+      std::unique_ptr<MemoryAllocator> method_allocator,
+      EventTracer* event_tracer,
+      SharedPlannedMemory* shared_planned_memory = nullptr);
+
+  Error allocate_planned_buffer(
+      size_t buffer_size,
+      std::vector<std::vector<uint8_t>>* owned_buffers,
+      std::vector<Span<uint8_t>>* spans);
+
  private:
   std::string file_path_;
   MlockConfig mlock_config_{MlockConfig::NoMlock};
   std::unique_ptr<DataLoader> data_loader_;
   std::unique_ptr<MemoryAllocator> memory_allocator_;
   std::unique_ptr<EventTracer> event_tracer_;
+  std::unique_ptr<MemoryAllocator> planned_memory_allocator_;
   std::unique_ptr<Program> program_;
+  // Declared before methods_ so that the methods are destroyed first.
+  std::unordered_map<std::string, std::shared_ptr<SharedPlannedMemory>>
+      shared_planned_memory_;
   std::unordered_map<std::string, MethodHolder> methods_;
+  std::unordered_map<std::string, std::unique_ptr<MethodPool>> method_pools_;
 };
 
 } // namespace torch::executor
@@ -22,7 +22,9 @@ def define_common_targets():
                 "@EXECUTORCH_CLIENTS",
             ],
             deps = [
+                "//executorch/extension/memory_allocator:growable_arena_allocator",
                 "//executorch/extension/memory_allocator:malloc_memory_allocator",
+                "//executorch/extension/memory_allocator:temp_memory_allocator",
                 "//executorch/extension/data_loader:mmap_data_loader",
             ],
             exported_deps = [
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Measures the per-call overhead of Module::forward() and of the
+ * allocation-free Module::execute() fast path, along with the number of heap
+ * allocations made per call. Intended for tiny models, where the overhead
+ * dominates the kernel time.
+ *
+ * Usage: module_benchmark <model.pte> [iterations]
+ *
+ * The model's forward method must take a single float tensor of shape [1, 2].
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <executorch/extension/module/module.h>
+
+namespace {
+
+std::atomic<size_t> num_allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+  ++num_allocations;
+  void* ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    std::abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+using namespace torch::executor;
+
+namespace {
+
+template <typename Fn>
+void run(const char* name, size_t iterations, Fn&& fn) {
+  // Warm up, which also loads the method.
+  for (size_t i = 0; i < 16; ++i) {
+    if (fn() != Error::Ok) {
+      std::printf("%s: execution failed\n", name);
+      std::exit(1);
+    }
+  }
+  const size_t allocations_before = num_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    (void)fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const size_t allocations = num_allocations - allocations_before;
+  const double ns =
+      std::chrono::duration<double, std::nano>(end - start).count();
+  std::printf(
+      "%-8s %10.1f ns/call %8.2f allocations/call\n",
+      name,
+      ns / iterations,
+      static_cast<double>(allocations) / iterations);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::printf("Usage: %s <model.pte> [iterations]\n", argv[0]);
+    return 1;
+  }
+  const size_t iterations =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+
+  Module module(argv[1]);
+
+  std::array<float, 2> input{1, 2};
+  std::array<int32_t, 2> sizes{1, 2};
+  TensorImpl tensor(
+      ScalarType::Float, sizes.size(), sizes.data(), input.data());
+
+  run("forward", iterations, [&] {
+    return module.forward({EValue(Tensor(&tensor))}).error();
+  });
+
+  Result<Method*> method = module.bind_method("forward");
+  if (!method.ok()) {
+    std::printf("Failed to load forward: 0x%x\n", (int)method.error());
+    return 1;
+  }
+  const std::array<EValue, 1> inputs{EValue(Tensor(&tensor))};
+  std::array<EValue, 1> outputs;
+  run("execute", iterations, [&] {
+    return Module::execute(
+        **method,
+        {inputs.data(), inputs.size()},
+        {outputs.data(), outputs.size()});
+  });
+  return 0;
+}
@@ -6,8 +6,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 #include <gtest/gtest.h>
 
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
 #include <executorch/extension/module/module.h>
 
 using namespace ::testing;
@@ -235,4 +241,229 @@ TEST_F(ModuleTest, TestForwardWithInvalidInputs) {
   EXPECT_FALSE(result.ok());
 }
 
+namespace {
+
+class CountingMemoryAllocator : public util::MallocMemoryAllocator {
+ public:
+  explicit CountingMemoryAllocator(size_t* allocated_bytes)
+      : allocated_bytes_(allocated_bytes) {}
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    *allocated_bytes_ += size;
+    return util::MallocMemoryAllocator::allocate(size, alignment);
+  }
+
+ private:
+  size_t* allocated_bytes_;
+};
+
+} // namespace
+
+TEST_F(ModuleTest, TestPlannedMemoryAllocator) {
+  auto loader = util::FileDataLoader::from(
+      (std::getenv("RESOURCES_PATH") + std::string("/model.pte")).c_str());
+  ASSERT_TRUE(loader.ok());
+
+  size_t planned_bytes = 0;
+  Module module(
+      std::make_unique<util::FileDataLoader>(std::move(loader.get())),
+      nullptr,
+      nullptr,
+      std::make_unique<CountingMemoryAllocator>(&planned_bytes));
+
+  const auto meta = module.method_meta("forward");
+  ASSERT_TRUE(meta.ok());
+  size_t expected_bytes = 0;
+  for (size_t i = 0; i < meta->num_memory_planned_buffers(); ++i) {
+    expected_bytes += meta->memory_planned_buffer_size(i).get();
+  }
+  EXPECT_EQ(planned_bytes, expected_bytes);
+
+  std::array<float, 2> input{1, 2};
+  std::array<int32_t, 2> sizes{1, 2};
+  TensorImpl tensor(
+      ScalarType::Float, sizes.size(), sizes.data(), input.data());
+  const auto result = module.forward({EValue(Tensor(&tensor))});
+  EXPECT_TRUE(result.ok());
+  EXPECT_NEAR(result->at(0).toTensor().const_data_ptr<float>()[0], 1.5, 1e-5);
+}
+
+TEST_F(ModuleTest, TestSharePlannedMemory) {
+  const char* path = std::getenv("ET_MODULE_MULTI_ENTRY_PATH");
+  auto loader = util::FileDataLoader::from(path);
+  ASSERT_TRUE(loader.ok());
+
+  size_t planned_bytes = 0;
+  Module module(
+      std::make_unique<util::FileDataLoader>(std::move(loader.get())),
+      nullptr,
+      nullptr,
+      std::make_unique<CountingMemoryAllocator>(&planned_bytes));
+
+  EXPECT_NE(module.share_planned_memory({"forward", "missing"}), Error::Ok);
+  ASSERT_EQ(module.share_planned_memory({"forward", "forward2"}), Error::Ok);
+  EXPECT_EQ(module.share_planned_memory({"forward2"}), Error::InvalidState);
+
+  std::array<float, 4> input{1, 1, 1, 1};
+  std::array<int32_t, 2> sizes{2, 2};
+  TensorImpl tensor(
+      ScalarType::Float, sizes.size(), sizes.data(), input.data());
+  for (int i = 0; i < 2; ++i) {
+    const auto result = module.execute("forward", {EValue(Tensor(&tensor))});
+    ASSERT_TRUE(result.ok());
+    EXPECT_NEAR(result->at(0).toTensor().const_data_ptr<float>()[0], 4, 1e-5);
+
+    const auto result2 =
+        module.execute("forward2", {EValue(Tensor(&tensor))});
+    ASSERT_TRUE(result2.ok());
+    EXPECT_NEAR(
+        result2->at(0).toTensor().const_data_ptr<float>()[0], 6, 1e-5);
+  }
+
+  // One buffer per index, sized to the larger plan, is allocated for both.
+  std::vector<size_t> expected_sizes;
+  for (const char* method_name : {"forward", "forward2"}) {
+    const auto meta = module.method_meta(method_name);
+    ASSERT_TRUE(meta.ok());
+    expected_sizes.resize(
+        std::max(expected_sizes.size(), meta->num_memory_planned_buffers()));
+    for (size_t i = 0; i < meta->num_memory_planned_buffers(); ++i) {
+      expected_sizes[i] = std::max(
+          expected_sizes[i],
+          static_cast<size_t>(meta->memory_planned_buffer_size(i).get()));
+    }
+  }
+  size_t expected_bytes = 0;
+  for (const size_t size : expected_sizes) {
+    expected_bytes += size;
+  }
+  EXPECT_EQ(planned_bytes, expected_bytes);
+}
+
+TEST_F(ModuleTest, TestSharePlannedMemoryOfLoadedMethod) {
+  Module module(std::getenv("RESOURCES_PATH") + std::string("/model.pte"));
+
+  ASSERT_EQ(module.load_method("forward"), Error::Ok);
+  EXPECT_EQ(module.share_planned_memory({"forward"}), Error::InvalidState);
+}
+
+TEST_F(ModuleTest, TestMethodPool) {
+  Module module(std::getenv("RESOURCES_PATH") + std::string("/model.pte"));
+
+  EXPECT_FALSE(module.acquire_method("forward").ok());
+  EXPECT_NE(module.load_method_pool("forward", 0), Error::Ok);
+  ASSERT_EQ(module.load_method_pool("forward", 2), Error::Ok);
+  EXPECT_NE(module.load_method_pool("forward", 2), Error::Ok);
+
+  // Each thread gets an instance of its own.
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 16;
+  std::array<int, kNumThreads> failures{};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&module, &failures, t] {
+      for (int i = 0; i < kNumIterations; ++i) {
+        std::array<float, 2> input{float(t), float(i)};
+        std::array<int32_t, 2> sizes{1, 2};
+        TensorImpl tensor(
+            ScalarType::Float, sizes.size(), sizes.data(), input.data());
+
+        auto method = module.acquire_method("forward");
+        if (!method.ok() ||
+            (*method)->set_input(EValue(Tensor(&tensor)), 0) != Error::Ok ||
+            (*method)->execute() != Error::Ok) {
+          ++failures[t];
+          continue;
+        }
+        const float output =
+            (*method)->get_output(0).toTensor().const_data_ptr<float>()[0];
+        if (std::abs(output - (t + i) / 2.0f) > 1e-5) {
+          ++failures[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kNumThreads; ++t) {
+    EXPECT_EQ(failures[t], 0);
+  }
+}
+
+TEST_F(ModuleTest, TestExecuteBoundMethod) {
+  Module module(std::getenv("RESOURCES_PATH") + std::string("/model.pte"));
+
+  const auto method = module.bind_method("forward");
+  ASSERT_TRUE(method.ok());
+  EXPECT_TRUE(module.is_method_loaded("forward"));
+
+  std::array<int32_t, 2> sizes{1, 2};
+  std::array<EValue, 1> outputs;
+  for (float offset : {0.0f, 1.0f}) {
+    std::array<float, 2> input{1 + offset, 2 + offset};
+    TensorImpl tensor(
+        ScalarType::Float, sizes.size(), sizes.data(), input.data());
+    const std::array<EValue, 1> inputs{EValue(Tensor(&tensor))};
+
+    ASSERT_EQ(
+        Module::execute(
+            **method,
+            {inputs.data(), inputs.size()},
+            {outputs.data(), outputs.size()}),
+        Error::Ok);
+    EXPECT_NEAR(
+        outputs[0].toTensor().const_data_ptr<float>()[0], 1.5 + offset, 1e-5);
+  }
+
+  // Spans longer than the method's inputs or outputs are rejected.
+  std::array<EValue, 8> too_many;
+  EXPECT_NE(
+      Module::execute(
+          **method,
+          {too_many.data(), too_many.size()},
+          {outputs.data(), outputs.size()}),
+      Error::Ok);
+  EXPECT_NE(
+      Module::execute(**method, {}, {too_many.data(), too_many.size()}),
+      Error::Ok);
+}
+
+TEST_F(ModuleTest, TestExecuteBatch) {
+  Module module(std::getenv("RESOURCES_PATH") + std::string("/model.pte"));
+  ASSERT_EQ(module.set_max_batch_size("forward", 2), Error::Ok);
+  EXPECT_EQ(module.set_max_batch_size("forward", 2), Error::InvalidState);
+
+  std::array<int32_t, 2> sizes{1, 2};
+  const std::vector<float> offsets{0.0f, 1.0f, 2.0f};
+  std::vector<std::array<float, 2>> data;
+  std::vector<TensorImpl> tensors;
+  data.reserve(offsets.size());
+  tensors.reserve(offsets.size());
+  std::vector<std::vector<EValue>> requests;
+  for (float offset : offsets) {
+    data.push_back({1 + offset, 2 + offset});
+    tensors.emplace_back(
+        ScalarType::Float, sizes.size(), sizes.data(), data.back().data());
+    requests.push_back({EValue(Tensor(&tensors.back()))});
+  }
+
+  std::vector<float> results(requests.size(), 0.0f);
+  size_t calls = 0;
+  ASSERT_EQ(
+      module.execute_batch(
+          "forward",
+          requests,
+          [&](size_t request_index, const std::vector<EValue>& outputs) {
+            ++calls;
+            results.at(request_index) =
+                outputs.at(0).toTensor().const_data_ptr<float>()[0];
+          }),
+      Error::Ok);
+  EXPECT_EQ(calls, requests.size());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    EXPECT_NEAR(results[i], 1.5 + offsets[i], 1e-5);
+  }
+}
+
 } // namespace torch::executor
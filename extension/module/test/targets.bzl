@@ -14,13 +14,29 @@ def define_common_targets():
         ],
         deps = [
             "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/memory_allocator:malloc_memory_allocator",
             "//executorch/extension/module:module",
         ],
         env = {
+            # A program with the methods "forward" (x + 3) and "forward2"
+            # (x + 5), which only builds in fbcode since it needs EXIR.
+            "ET_MODULE_MULTI_ENTRY_PATH": "$(location fbcode//executorch/test/models:exported_programs[ModuleMultipleEntry.pte])",
             "RESOURCES_PATH": "$(location :resources)/resources",
         },
     )
 
+    runtime.cxx_binary(
+        name = "module_benchmark",
+        srcs = [
+            "module_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/extension/module:module",
+        ],
+    )
+
     runtime.filegroup(
         name = "resources",
         srcs = native.glob([
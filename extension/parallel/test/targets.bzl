@@ -17,3 +17,15 @@ def define_common_targets():
             "//executorch/runtime/platform:platform",
         ],
     )
+
+    runtime.cxx_binary(
+        name = "thread_parallel_benchmark",
+        srcs = [
+            "thread_parallel_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/backends/xnnpack/threadpool:threadpool",
+            "//executorch/extension/parallel:thread_parallel",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
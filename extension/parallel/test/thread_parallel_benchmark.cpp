@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Measures the per-dispatch overhead of parallel_for and parallel_for_dynamic
+ * on loops with almost no work per item, along with the number of heap
+ * allocations made per dispatch. For comparison, also measures dispatching
+ * the same loop the way parallel_for used to: through a std::function that
+ * is copied into another std::function per call.
+ *
+ * Usage: thread_parallel_benchmark [iterations]
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include <executorch/backends/xnnpack/threadpool/threadpool.h>
+#include <executorch/extension/parallel/thread_parallel.h>
+#include <executorch/runtime/platform/runtime.h>
+
+namespace {
+
+std::atomic<size_t> num_allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+  ++num_allocations;
+  void* ptr = std::malloc(size);
+  if (ptr == nullptr) {
+    std::abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+using namespace torch::executor;
+using torch::executorch::threadpool::get_threadpool;
+
+namespace {
+
+template <typename Fn>
+void run(const char* name, size_t iterations, Fn&& fn) {
+  // Warm up, which also creates the threadpool.
+  for (size_t i = 0; i < 16; ++i) {
+    if (!fn()) {
+      std::printf("%s: dispatch failed\n", name);
+      std::exit(1);
+    }
+  }
+  const size_t allocations_before = num_allocations;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    (void)fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const size_t allocations = num_allocations - allocations_before;
+  const double ns =
+      std::chrono::duration<double, std::nano>(end - start).count();
+  std::printf(
+      "%-14s %10.1f ns/call %8.2f allocations/call\n",
+      name,
+      ns / iterations,
+      static_cast<double>(allocations) / iterations);
+}
+
+// The dispatch parallel_for used to do: the loop body is passed as a
+// std::function, which is copied into the task handed to the threadpool.
+bool legacy_parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& f) {
+  const int64_t num_threads = get_threadpool()->get_thread_count();
+  const int64_t chunk_size = std::max(
+      grain_size, (end - begin + num_threads - 1) / num_threads);
+  const int64_t num_tasks = (end - begin + chunk_size - 1) / chunk_size;
+  auto task = [f, begin, end, chunk_size](size_t task_id) {
+    int64_t local_start = begin + static_cast<int64_t>(task_id) * chunk_size;
+    if (local_start < end) {
+      f(local_start, std::min(end, local_start + chunk_size));
+    }
+  };
+  get_threadpool()->run(task, num_tasks);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  runtime_init();
+  const size_t iterations =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+  // One slot per item, so that the loop body does some real work that cannot
+  // be optimized away, and threads do not share a counter.
+  const int64_t num_items =
+      4 * static_cast<int64_t>(get_threadpool()->get_thread_count());
+  std::array<int64_t, 256> items{};
+  if (num_items > static_cast<int64_t>(items.size())) {
+    std::printf("Too many threads: %" PRId64 "\n", num_items / 4);
+    return 1;
+  }
+  // Captures more than fits in a std::function's inline buffer, like loop
+  // bodies in kernels typically do.
+  const int64_t a = 1, b = 2, c = 3;
+  auto body = [&items, &a, &b, &c](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      items[i] += a + b + c;
+    }
+  };
+
+  run("inline", iterations, [&] {
+    return parallel_for(0, num_items, num_items + 1, body);
+  });
+  run("parallel_for", iterations, [&] {
+    return parallel_for(0, num_items, 1, body);
+  });
+  run("dynamic", iterations, [&] {
+    return parallel_for_dynamic(0, num_items, 1, body);
+  });
+  run("std::function", iterations, [&] {
+    return legacy_parallel_for(0, num_items, 1, body);
+  });
+  return 0;
+}
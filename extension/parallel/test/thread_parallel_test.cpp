@@ -193,4 +193,85 @@ TEST_F(ParallelTest, TestChunkSizeTooLarge) {
   }
 }
 
+TEST_F(ParallelTest, TestIntraOpThreadLimit) {
+  EXPECT_EQ(get_intra_op_thread_limit(), 0);
+  {
+    IntraOpThreadLimitGuard guard(1);
+    EXPECT_EQ(get_intra_op_thread_limit(), 1);
+
+    // With a single thread, the whole range runs as one inline chunk.
+    int num_chunks = 0;
+    EXPECT_TRUE(
+        parallel_for(0, 10, 1, [this, &num_chunks](int64_t begin, int64_t end) {
+          ++num_chunks;
+          EXPECT_EQ(begin, 0);
+          EXPECT_EQ(end, 10);
+          this->RunTask(begin, end);
+        }));
+    EXPECT_EQ(num_chunks, 1);
+  }
+  EXPECT_EQ(get_intra_op_thread_limit(), 0);
+
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(data_[i], i);
+  }
+}
+
+TEST_F(ParallelTest, TestDynamicAllInvoked) {
+  EXPECT_TRUE(
+      parallel_for_dynamic(0, 10, 1, [this](int64_t begin, int64_t end) {
+        this->RunExclusiveTask(begin, end);
+      }));
+
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(data_[i], i);
+  }
+  EXPECT_EQ(sum_of_all_elements_, 45);
+}
+
+TEST_F(ParallelTest, TestDynamicChunksRespectGrainSize) {
+  EXPECT_TRUE(
+      parallel_for_dynamic(1, 10, 4, [this](int64_t begin, int64_t end) {
+        EXPECT_EQ((begin - 1) % 4, 0);
+        EXPECT_LE(end - begin, 4);
+        this->RunExclusiveTask(begin, end);
+      }));
+
+  EXPECT_EQ(data_[0], 0);
+  for (int64_t i = 1; i < 10; ++i) {
+    EXPECT_EQ(data_[i], i);
+  }
+}
+
+TEST_F(ParallelTest, TestDynamicInvalidRange) {
+  EXPECT_FALSE(parallel_for_dynamic(
+      10, 0, 1, [](int64_t begin, int64_t end) { (void)begin, (void)end; }));
+  EXPECT_FALSE(parallel_for_dynamic(
+      0, 10, 0, [](int64_t begin, int64_t end) { (void)begin, (void)end; }));
+}
+
+TEST_F(ParallelTest, TestNestedParallelForRunsInline) {
+  EXPECT_FALSE(in_parallel_region());
+  EXPECT_TRUE(parallel_for(0, 10, 1, [this](int64_t begin, int64_t end) {
+    EXPECT_TRUE(in_parallel_region());
+    const int64_t thread_num = get_thread_num();
+    int num_chunks = 0;
+    EXPECT_TRUE(parallel_for_dynamic(
+        begin, end, 1, [&](int64_t inner_begin, int64_t inner_end) {
+          ++num_chunks;
+          // The whole range runs on this thread as one chunk.
+          EXPECT_EQ(get_thread_num(), thread_num);
+          EXPECT_EQ(inner_begin, begin);
+          EXPECT_EQ(inner_end, end);
+          this->RunExclusiveTask(inner_begin, inner_end);
+        }));
+    EXPECT_EQ(num_chunks, 1);
+  }));
+  EXPECT_FALSE(in_parallel_region());
+
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(data_[i], i);
+  }
+}
+
 } // namespace torch::executor
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
 #include <tuple>
 
 #include <executorch/backends/xnnpack/threadpool/threadpool.h>
@@ -17,7 +18,23 @@ namespace torch::executor {
 
 namespace {
 thread_local int64_t thread_num_ = 0;
-}
+thread_local int64_t intra_op_thread_limit_ = 0;
+thread_local bool in_parallel_region_ = false;
+
+// Marks the calling thread as running a parallel_for task.
+class ParallelRegionGuard final {
+ public:
+  ParallelRegionGuard() : prev_(in_parallel_region_) {
+    in_parallel_region_ = true;
+  }
+  ~ParallelRegionGuard() {
+    in_parallel_region_ = prev_;
+  }
+
+ private:
+  const bool prev_;
+};
+} // namespace
 
 using namespace torch::executorch::threadpool;
 
@@ -33,45 +50,135 @@ void set_thread_num(int64_t thread_num) {
   thread_num_ = thread_num;
 }
 
+void set_intra_op_thread_limit(int64_t max_threads) {
+  intra_op_thread_limit_ = max_threads > 0 ? max_threads : 0;
+}
+
+int64_t get_intra_op_thread_limit() {
+  return intra_op_thread_limit_;
+}
+
+bool in_parallel_region() {
+  return in_parallel_region_;
+}
+
+// Number of threads a parallel_for from the calling thread may use.
+inline int64_t get_num_threads() {
+  int64_t num_threads = get_threadpool()->get_thread_count();
+  if (intra_op_thread_limit_ > 0) {
+    num_threads = std::min(num_threads, intra_op_thread_limit_);
+  }
+  return num_threads;
+}
+
 inline std::tuple<int64_t, int64_t>
 calc_num_tasks_and_chunk_size(int64_t begin, int64_t end, int64_t grain_size) {
   if ((end - begin) < grain_size) {
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
   // Choose number of tasks based on grain size and number of threads.
-  int64_t chunk_size =
-      divup((end - begin), get_threadpool()->get_thread_count());
+  int64_t num_threads = get_num_threads();
+  int64_t chunk_size = divup((end - begin), num_threads);
   // Make sure each task is at least grain_size size.
   chunk_size = std::max(grain_size, chunk_size);
   int64_t num_tasks = divup((end - begin), chunk_size);
   return std::make_tuple(num_tasks, chunk_size);
 }
 
-bool parallel_for(
+namespace internal {
+
+namespace {
+
+// State shared by the tasks of one parallel_for_impl call. It lives on the
+// stack of the calling thread, which waits for all tasks to finish.
+struct ParallelForContext {
+  ChunkFn fn;
+  const void* callable;
+  int64_t begin;
+  int64_t end;
+  int64_t chunk_size;
+  int64_t num_chunks;
+  std::atomic<int64_t> next_chunk;
+};
+
+void run_static_task(void* context, size_t task_id) {
+  ParallelRegionGuard guard;
+  set_thread_num(task_id);
+  const auto* ctx = static_cast<const ParallelForContext*>(context);
+  int64_t local_start =
+      ctx->begin + static_cast<int64_t>(task_id) * ctx->chunk_size;
+  if (local_start < ctx->end) {
+    int64_t local_end = std::min(ctx->end, ctx->chunk_size + local_start);
+    ctx->fn(ctx->callable, local_start, local_end);
+  }
+}
+
+// Each task keeps claiming the next unprocessed chunk until none are left,
+// so threads that draw cheap chunks go on to take more of them.
+void run_dynamic_task(void* context, size_t task_id) {
+  ParallelRegionGuard guard;
+  set_thread_num(task_id);
+  auto* ctx = static_cast<ParallelForContext*>(context);
+  for (int64_t chunk = ctx->next_chunk.fetch_add(1, std::memory_order_relaxed);
+       chunk < ctx->num_chunks;
+       chunk = ctx->next_chunk.fetch_add(1, std::memory_order_relaxed)) {
+    const int64_t local_start = ctx->begin + chunk * ctx->chunk_size;
+    ctx->fn(
+        ctx->callable,
+        local_start,
+        std::min(ctx->end, local_start + ctx->chunk_size));
+  }
+}
+
+} // namespace
+
+bool parallel_for_impl(
     const int64_t begin,
     const int64_t end,
     const int64_t grain_size,
-    const std::function<void(int64_t, int64_t)>& f) {
+    ChunkFn fn,
+    const void* callable,
+    bool dynamic) {
   ET_LOG_AND_RETURN_IF_FALSE(begin >= 0 && end >= 0);
   ET_LOG_AND_RETURN_IF_FALSE(end >= begin);
   ET_LOG_AND_RETURN_IF_FALSE(grain_size > 0);
-  int64_t num_tasks = 0, chunk_size = 0;
-  std::tie(num_tasks, chunk_size) =
-      calc_num_tasks_and_chunk_size(begin, end, grain_size);
-
-  auto task = [f, begin, end, chunk_size](size_t task_id) {
-    set_thread_num(task_id);
-    int64_t local_start = begin + static_cast<int64_t>(task_id) * chunk_size;
-    if (local_start < end) {
-      int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
-      f(local_start, local_end);
+  // Nested calls run inline: the threads are all busy with the outer loop.
+  if (in_parallel_region_) {
+    if (begin < end) {
+      fn(callable, begin, end);
     }
-  };
+    return true;
+  }
+
+  int64_t num_tasks = 0, chunk_size = 0, num_chunks = 0;
+  if (dynamic) {
+    chunk_size = grain_size;
+    num_chunks = divup(end - begin, grain_size);
+    num_tasks = begin == end ? 0 : std::min(num_chunks, get_num_threads());
+  } else {
+    std::tie(num_tasks, chunk_size) =
+        calc_num_tasks_and_chunk_size(begin, end, grain_size);
+  }
+
+  // A single task gains nothing from the threadpool; run it inline.
+  if (num_tasks <= 1) {
+    set_thread_num(0);
+    if (begin < end) {
+      fn(callable, begin, end);
+    }
+    return true;
+  }
+
+  ParallelForContext ctx{
+      fn, callable, begin, end, chunk_size, num_chunks, {0}};
 
   // Per protocol from threadpool (pthreadpool), when this returns, all tasks
   // are executed, so this is synchronous.
-  get_threadpool()->run(task, num_tasks);
+  get_threadpool()->run(
+      dynamic ? &run_dynamic_task : &run_static_task, &ctx, num_tasks);
   return true;
 }
 
+} // namespace internal
+
 } // namespace torch::executor
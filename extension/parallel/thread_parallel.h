@@ -9,11 +9,32 @@
 #pragma once
 
 #include <cstdint>
-// @nolint PATTERNLINT Ok to use stdlib for this optional library
-#include <functional>
 
 namespace torch::executor {
 
+namespace internal {
+
+// Calls the callable at `callable` on the chunk [begin, end).
+using ChunkFn = void (*)(const void* callable, int64_t begin, int64_t end);
+
+template <typename Func>
+void call_chunk_fn(const void* callable, int64_t begin, int64_t end) {
+  (*static_cast<const Func*>(callable))(begin, end);
+}
+
+// Shared implementation of parallel_for and parallel_for_dynamic. The callable
+// is passed as a pointer and a trampoline for its type, so that dispatching a
+// loop neither copies nor allocates it.
+bool parallel_for_impl(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    ChunkFn fn,
+    const void* callable,
+    bool dynamic);
+
+} // namespace internal
+
 /**
  * A helper to run function in parallel.
  *
@@ -25,18 +46,96 @@ namespace torch::executor {
  *   void f(int64_t begin, int64_t end)
  * Returns true if all work items are processed successfully, false otherwise
  *
+ * f is called by reference and is not copied, so any callable works without
+ * heap allocation, including a lambda that captures by reference. It must
+ * stay alive until parallel_for returns.
+ *
  * Warning: parallel_for does NOT copy thread local states from the current
  * thread to the worker threads. Users need to protect the access to captured
  * data if they mutate them in f.
  */
+template <typename Func>
 bool parallel_for(
     const int64_t begin,
     const int64_t end,
     const int64_t grain_size,
-    const std::function<void(int64_t, int64_t)>& f);
+    const Func& f) {
+  return internal::parallel_for_impl(
+      begin,
+      end,
+      grain_size,
+      &internal::call_chunk_fn<Func>,
+      &f,
+      /*dynamic=*/false);
+}
+
+/**
+ * Like parallel_for, but for work items whose cost varies, such as attention
+ * rows under a causal mask. Instead of giving each thread one equal share of
+ * the range up front, the range is cut into chunks of grain_size items that
+ * threads claim one at a time as they become free, so no thread idles while
+ * another works through an expensive stretch.
+ *
+ * f is called once per chunk. Within f, get_thread_num() is the same for all
+ * chunks a thread processes in this call and smaller than the number of
+ * threads used, so it can index per-thread scratch space.
+ */
+template <typename Func>
+bool parallel_for_dynamic(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const Func& f) {
+  return internal::parallel_for_impl(
+      begin,
+      end,
+      grain_size,
+      &internal::call_chunk_fn<Func>,
+      &f,
+      /*dynamic=*/true);
+}
+
+/**
+ * Returns true while the calling thread runs a task of parallel_for or
+ * parallel_for_dynamic. Parallel loops started from such a task run inline on
+ * that thread, since the other threads are busy with the outer loop.
+ */
+bool in_parallel_region();
 
 int64_t get_thread_num();
 
 void set_thread_num(int64_t thread_num);
 
+/**
+ * Caps the number of threads that parallel_for calls made from the calling
+ * thread split their work across. Zero, the default, means the whole
+ * threadpool. Set it around Method::execute() to give each method its own
+ * intra-op thread budget; a limit of one runs every loop inline.
+ */
+void set_intra_op_thread_limit(int64_t max_threads);
+
+int64_t get_intra_op_thread_limit();
+
+/**
+ * Sets the intra-op thread limit of the calling thread for the lifetime of
+ * the guard, and restores the previous limit on destruction.
+ */
+class IntraOpThreadLimitGuard final {
+ public:
+  explicit IntraOpThreadLimitGuard(int64_t max_threads)
+      : prev_max_threads_(get_intra_op_thread_limit()) {
+    set_intra_op_thread_limit(max_threads);
+  }
+
+  ~IntraOpThreadLimitGuard() {
+    set_intra_op_thread_limit(prev_max_threads_);
+  }
+
+  IntraOpThreadLimitGuard(const IntraOpThreadLimitGuard&) = delete;
+  IntraOpThreadLimitGuard& operator=(const IntraOpThreadLimitGuard&) = delete;
+
+ private:
+  const int64_t prev_max_threads_;
+};
+
 } // namespace torch::executor
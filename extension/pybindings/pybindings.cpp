@@ -10,6 +10,7 @@
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -364,6 +365,122 @@ struct PyBundledModule final {
   size_t program_len_;
 };
 
+/// Returns an at::Tensor that aliases the tensor output `v` of a method.
+at::Tensor output_to_attensor(const EValue& v) {
+#ifdef USE_ATEN_LIB
+  return v.toTensor();
+#else
+  return torch::util::alias_attensor_to_etensor(v.toTensor());
+#endif
+}
+
+/// Converts the output `v` of a method to a Python object. Tensors alias the
+/// buffers of the module unless `clone_tensor` is true.
+py::object output_to_py(const EValue& v, bool clone_tensor) {
+  if (Tag::None == v.tag) {
+    return py::none();
+  } else if (Tag::Int == v.tag) {
+    return py::cast(v.toInt());
+  } else if (Tag::Double == v.tag) {
+    return py::cast(v.toDouble());
+  } else if (Tag::Bool == v.tag) {
+    return py::cast(v.toBool());
+  } else if (Tag::String == v.tag) {
+    return py::cast(std::string(v.toString().data()));
+  } else if (Tag::Tensor == v.tag) {
+    at::Tensor output = output_to_attensor(v);
+    // Clone by default so the outputs in python do not share a lifetime with
+    // the module object.
+    return py::cast(clone_tensor ? output.clone() : output);
+  }
+  ET_ASSERT_UNREACHABLE_MSG("Invalid model output type");
+}
+
+#ifdef USE_ATEN_LIB
+// ATen mode passes the at::Tensors through, so there is nothing to cache.
+struct InputAliasCache {};
+#else
+using InputAliasCache = torch::util::ETensorAliasCache;
+#endif
+
+/// The inputs of a method converted from Python objects into EValues, along
+/// with the metadata the ETensors among them point to.
+class MethodInputs final {
+ public:
+  /// Tensor inputs are aliased through `alias_cache` if given, which must
+  /// outlive the use of evalues(). Otherwise a cache local to these inputs is
+  /// used.
+  MethodInputs(
+      const std::string& method_name,
+      const py::sequence& inputs,
+      InputAliasCache* alias_cache = nullptr)
+      : alias_cache_(
+            alias_cache != nullptr ? *alias_cache : local_alias_cache_) {
+    const auto inputs_size = py::len(inputs);
+    evalues_.reserve(inputs_size);
+
+    // Convert python objects into EValues.
+    for (size_t i = 0; i < inputs_size; ++i) {
+      py::object python_input = inputs[i];
+      std::string type_str = py::str(python_input.get_type());
+      if (type_str != "<class 'torch.Tensor'>" &&
+          py::hasattr(python_input, "__dlpack__")) {
+        // Arrays of other frameworks, e.g. numpy, are wrapped without a copy.
+        python_input =
+            py::module_::import("torch").attr("from_dlpack")(python_input);
+        type_str = py::str(python_input.get_type());
+        dlpack_inputs_.push_back(python_input);
+      }
+      if (type_str == "<class 'torch.Tensor'>") {
+        auto at_tensor = python_input.cast<at::Tensor>();
+        // alias_etensor_to_attensor will assert on this later, so to better
+        // propogate up to python we check early and throw an exception.
+        if (!at_tensor.is_contiguous()) {
+          auto error_msg = "Input " + std::to_string(i) + "for method " +
+              method_name + " is not contiguous.";
+          throw std::runtime_error(error_msg);
+        }
+
+#ifdef USE_ATEN_LIB
+        EValue evalue(at_tensor);
+#else
+        // The ETensor metadata can't alias the at::Tensor's due to int64 vs
+        // int32 typing conflict, so the cache keeps a converted copy per
+        // input and reuses it while the input shape does not change.
+        EValue evalue(alias_cache_.alias(i, at_tensor));
+#endif
+
+        evalues_.push_back(evalue);
+      } else if (py::isinstance<py::none>(python_input)) {
+        evalues_.push_back(EValue());
+      } else if (py::isinstance<py::bool_>(python_input)) {
+        evalues_.push_back(EValue(py::cast<bool>(python_input)));
+      } else if (py::isinstance<py::int_>(python_input)) {
+        evalues_.push_back(EValue(py::cast<int64_t>(python_input)));
+      } else {
+        // Unsupported pytype
+        ET_ASSERT_UNREACHABLE_MSG(type_str.c_str());
+      }
+    }
+  }
+
+  MethodInputs(const MethodInputs&) = delete;
+  MethodInputs& operator=(const MethodInputs&) = delete;
+
+  const std::vector<EValue>& evalues() const {
+    return evalues_;
+  }
+
+ private:
+  std::vector<EValue> evalues_;
+  // So the ETensors and their metadata stay in scope for
+  // Module->run_method.
+  InputAliasCache local_alias_cache_;
+  InputAliasCache& alias_cache_;
+  // The tensors wrapping the DLPack inputs.
+  std::vector<py::object> dlpack_inputs_;
+};
+
 struct PyModule final {
   explicit PyModule(const py::bytes& buffer, bool enable_etdump)
       : module_(torch::executor::load_from_buffer(
@@ -402,152 +519,116 @@ struct PyModule final {
         m.get_program_ptr(), m.get_program_len(), enable_etdump);
   }
 
+  /// Runs `method_name` on `inputs`, releasing the GIL while it executes.
+  ///
+  /// If `clone_outputs` is false, the returned tensors alias the buffers of
+  /// the module instead of being copied: they are only valid until the next
+  /// execution of any method of the module, which may overwrite them, and
+  /// must not outlive the module.
   py::list run_method(
       const std::string& method_name,
-      const py::sequence& inputs) {
-    const auto inputs_size = py::len(inputs);
-    std::vector<EValue> cpp_inputs;
-    cpp_inputs.reserve(inputs_size);
-
-#ifndef USE_ATEN_LIB // Portable mode
-    // So the ETensors and their metadata stay in scope for
-    // Module->run_method.
-    std::vector<torch::executor::TensorImpl> input_tensors;
-    std::vector<std::vector<torch::executor::Tensor::SizesType>> input_sizes;
-    std::vector<std::vector<torch::executor::Tensor::StridesType>>
-        input_strides;
-    std::vector<std::vector<torch::executor::Tensor::DimOrderType>>
-        input_dim_order;
-    // We store pointers to these vector elements so important to reserve so
-    // that we don't lose those on a vector resize. Don't need to do this for
-    // the others since they are vectors of vectors, and we don't store a
-    // pointer to the root level vector data.
-    input_tensors.reserve(inputs_size);
-#endif
-
-    // Convert python objects into EValues.
-    for (size_t i = 0; i < inputs_size; ++i) {
-      auto python_input = inputs[i];
-      const std::string& type_str = py::str(python_input.get_type());
-      if (type_str == "<class 'torch.Tensor'>") {
-        auto at_tensor = python_input.cast<at::Tensor>();
-        // alias_etensor_to_attensor will assert on this later, so to better
-        // propogate up to python we check early and throw an exception.
-        if (!at_tensor.is_contiguous()) {
-          auto error_msg = "Input " + std::to_string(i) + "for method " +
-              method_name + " is not contiguous.";
-          throw std::runtime_error(error_msg);
-        }
+      const py::sequence& inputs,
+      bool clone_outputs = true) {
+    // Held until the outputs are converted, so that another thread running a
+    // method of this module does not overwrite them first. Also guards the
+    // input alias cache of the method, which is reused across runs.
+    std::unique_lock<std::mutex> lock = lock_module();
+    MethodInputs cpp_inputs(
+        method_name, inputs, &input_alias_caches_[method_name]);
+
+    const std::vector<Span<uint8_t>>& output_storage_spans =
+        get_output_storages(method_name);
+    std::vector<EValue> outputs;
+    {
+      // The inputs are converted and the outputs are not touched until the
+      // method returns, so other Python threads can run in the meantime.
+      py::gil_scoped_release release;
+      outputs = module_->run_method(
+          method_name, cpp_inputs.evalues(), output_storage_spans);
+    }
 
-#ifdef USE_ATEN_LIB
-        EValue evalue(at_tensor);
-#else
-        // convert at::Tensor to torch::executor::Tensor
-        auto type = torch::util::torchToExecuTorchScalarType(
-            at_tensor.options().dtype());
-        size_t dim = at_tensor.dim();
-        // cant directly alias at::Tensor sizes and strides due to int64 vs
-        // int32 typing conflict
-        input_sizes.emplace_back(
-            at_tensor.sizes().begin(), at_tensor.sizes().end());
-        input_strides.emplace_back(
-            at_tensor.strides().begin(), at_tensor.strides().end());
-
-        // Only works for MemoryFormat::Contiguous inputs
-        std::vector<torch::executor::Tensor::DimOrderType> dim_order;
-        for (size_t cur_dim = 0; cur_dim < dim; cur_dim++) {
-          dim_order.push_back(cur_dim);
-        }
-        input_dim_order.push_back(std::move(dim_order));
-        input_tensors.emplace_back(
-            type,
-            dim,
-            input_sizes.back().data(),
-            nullptr,
-            input_dim_order.back().data(),
-            input_strides.back().data());
-
-        torch::executor::Tensor temp =
-            torch::executor::Tensor(&input_tensors.back());
-        torch::util::alias_etensor_to_attensor(at_tensor, temp);
-        EValue evalue(temp);
-#endif
+    // Retrieve outputs
+    const auto outputs_size = outputs.size();
+    py::list list(outputs_size);
+    for (size_t i = 0; i < outputs_size; ++i) {
+      list[i] = output_to_py(outputs[i], clone_outputs);
+    }
+    return list;
+  }
 
-        cpp_inputs.push_back(evalue);
-      } else if (py::isinstance<py::none>(python_input)) {
-        cpp_inputs.push_back(EValue());
-      } else if (py::isinstance<py::bool_>(python_input)) {
-        cpp_inputs.push_back(EValue(py::cast<bool>(python_input)));
-      } else if (py::isinstance<py::int_>(python_input)) {
-        cpp_inputs.push_back(EValue(py::cast<int64_t>(python_input)));
-      } else {
-        // Unsupported pytype
-        ET_ASSERT_UNREACHABLE_MSG(type_str.c_str());
-      }
+  /// Runs `method_name` on each of the input sets in `batch`. All of them are
+  /// converted first, then the runs happen back to back without the GIL.
+  ///
+  /// Returns one entry per output of the method: the tensors of the runs
+  /// stacked along a new first dimension, or the list of the values of the
+  /// runs for outputs that are not tensors.
+  py::list run_method_batch(
+      const std::string& method_name,
+      const py::sequence& batch) {
+    const size_t batch_size = py::len(batch);
+    if (batch_size == 0) {
+      throw std::runtime_error("run_method_batch() needs at least one input");
+    }
+    std::vector<std::unique_ptr<MethodInputs>> batch_inputs;
+    batch_inputs.reserve(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+      batch_inputs.push_back(std::make_unique<MethodInputs>(
+          method_name, batch[i].cast<py::sequence>()));
     }
 
-    const auto& method = module_->get_method(method_name);
-    const auto num_outputs = method.outputs_size();
-    // These output storages will not be used if the ExecuTorch program already
-    // pre-allocated output space. That is represented by an error from
-    // set_output_data_ptr.
-    std::vector<std::unique_ptr<uint8_t[]>> output_storages(num_outputs);
-    std::vector<Span<uint8_t>> output_storage_spans(num_outputs);
-    for (size_t i = 0; i < num_outputs; ++i) {
-      const auto& output_tensor_meta =
-          method.method_meta().output_tensor_meta(i);
-      if (!output_tensor_meta.ok()) {
-        // If the output isn't a tensor it won't have a tensor meta.
-        ET_LOG(
-            Info,
-            "Tensor meta doesn't exist for output %zu, error is 0x%" PRIx32
-            ", skipping allocating storage",
-            i,
-            static_cast<uint32_t>(output_tensor_meta.error()));
-        output_storage_spans[i] = Span<uint8_t>();
-        continue;
+    std::unique_lock<std::mutex> lock = lock_module();
+    const std::vector<Span<uint8_t>>& output_storage_spans =
+        get_output_storages(method_name);
+    std::vector<std::vector<EValue>> batch_outputs(batch_size);
+    // Undefined for the outputs that are not tensors.
+    std::vector<at::Tensor> stacked_outputs;
+    {
+      py::gil_scoped_release release;
+      for (size_t i = 0; i < batch_size; ++i) {
+        batch_outputs[i] = module_->run_method(
+            method_name, batch_inputs[i]->evalues(), output_storage_spans);
+        const auto& outputs = batch_outputs[i];
+        stacked_outputs.resize(outputs.size());
+        for (size_t j = 0; j < outputs.size(); ++j) {
+          if (!outputs[j].isTensor()) {
+            continue;
+          }
+          // Copy the output out of the module buffers, which the next run
+          // overwrites, straight into its slice of the stacked output.
+          at::Tensor output = output_to_attensor(outputs[j]);
+          if (i == 0) {
+            std::vector<int64_t> sizes{static_cast<int64_t>(batch_size)};
+            sizes.insert(
+                sizes.end(), output.sizes().begin(), output.sizes().end());
+            stacked_outputs[j] = at::empty(sizes, output.options());
+          } else if (output.sizes() != stacked_outputs[j].sizes().slice(1)) {
+            throw std::runtime_error(
+                "output " + std::to_string(j) + " of method " + method_name +
+                " changed shape within the batch and can not be stacked");
+          }
+          stacked_outputs[j].select(0, i).copy_(output);
+        }
       }
-      const size_t output_size = output_tensor_meta.get().nbytes();
-      std::unique_ptr<uint8_t[]> output(new uint8_t[output_size]);
-      output_storage_spans[i] = Span<uint8_t>(output.get(), output_size);
-      output_storages[i] = std::move(output);
     }
-    auto outputs =
-        module_->run_method(method_name, cpp_inputs, output_storage_spans);
 
-    // Retrieve outputs
-    const auto outputs_size = outputs.size();
+    const size_t outputs_size = stacked_outputs.size();
     py::list list(outputs_size);
-    for (size_t i = 0; i < outputs_size; ++i) {
-      auto& v = outputs[i];
-      if (Tag::None == v.tag) {
-        list[i] = py::none();
-      } else if (Tag::Int == v.tag) {
-        list[i] = py::cast(v.toInt());
-      } else if (Tag::Double == v.tag) {
-        list[i] = py::cast(v.toDouble());
-      } else if (Tag::Bool == v.tag) {
-        list[i] = py::cast(v.toBool());
-      } else if (Tag::String == v.tag) {
-        list[i] = py::cast(std::string(v.toString().data()));
-      } else if (Tag::Tensor == v.tag) {
-#ifdef USE_ATEN_LIB
-        // Clone so the outputs in python do not share a lifetime with the
-        // module object
-        list[i] = py::cast(v.toTensor().clone());
-#else
-        list[i] = py::cast(
-            torch::util::alias_attensor_to_etensor(v.toTensor()).clone());
-#endif
-      } else {
-        ET_ASSERT_UNREACHABLE_MSG("Invalid model output type");
+    for (size_t j = 0; j < outputs_size; ++j) {
+      if (stacked_outputs[j].defined()) {
+        list[j] = py::cast(stacked_outputs[j]);
+        continue;
       }
+      py::list values(batch_size);
+      for (size_t i = 0; i < batch_size; ++i) {
+        values[i] = output_to_py(batch_outputs[i][j], /*clone_tensor=*/true);
+      }
+      list[j] = values;
     }
     return list;
   }
 
-  py::list forward(const py::sequence& inputs) {
-    return run_method("forward", inputs);
+  py::list forward(const py::sequence& inputs, bool clone_outputs = true) {
+    return run_method("forward", inputs, clone_outputs);
   }
 
   py::list forward_single_input(const torch::Tensor& inputTensor) {
@@ -583,6 +664,7 @@ struct PyModule final {
       PyBundledModule& m,
       const string method_name,
       size_t testset_idx) {
+    std::unique_lock<std::mutex> lock = lock_module();
     const void* bundled_program_ptr = m.get_bundled_program_ptr();
     Error status = bundled_program::LoadBundledInput(
         module_->get_method(method_name), bundled_program_ptr, testset_idx);
@@ -598,6 +680,7 @@ struct PyModule final {
       size_t testset_idx,
       double rtol = 1e-5,
       double atol = 1e-8) {
+    std::unique_lock<std::mutex> lock = lock_module();
     const void* bundled_program_ptr = m.get_bundled_program_ptr();
     Error status = bundled_program::VerifyResultWithBundledExpectedOutput(
         module_->get_method(method_name),
@@ -612,7 +695,12 @@ struct PyModule final {
   }
 
   void plan_execute(const string method_name) {
-    auto status = module_->get_method(method_name).execute();
+    std::unique_lock<std::mutex> lock = lock_module();
+    Error status;
+    {
+      py::gil_scoped_release release;
+      status = module_->get_method(method_name).execute();
+    }
     THROW_IF_ERROR(
         status,
         "executing execution plan for method 'forward' failed with error: 0x%" PRIx32,
@@ -620,7 +708,66 @@ struct PyModule final {
   }
 
  private:
+  /// Locks the methods of the module, which run one at a time. Waits without
+  /// the GIL, so that a thread that holds the lock can take the GIL back.
+  std::unique_lock<std::mutex> lock_module() {
+    std::unique_lock<std::mutex> lock(*mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      py::gil_scoped_release release;
+      lock.lock();
+    }
+    return lock;
+  }
+
+  /// Returns the storage of the outputs of `method_name`, allocated on its
+  /// first run and reused by the following ones. Empty for the outputs that
+  /// are not tensors.
+  const std::vector<Span<uint8_t>>& get_output_storages(
+      const std::string& method_name) {
+    auto it = output_storages_.find(method_name);
+    if (it != output_storages_.end()) {
+      return it->second.spans;
+    }
+    const auto& method = module_->get_method(method_name);
+    const auto num_outputs = method.outputs_size();
+    // These output storages will not be used if the ExecuTorch program already
+    // pre-allocated output space. That is represented by an error from
+    // set_output_data_ptr.
+    OutputStorages storages;
+    storages.buffers.resize(num_outputs);
+    storages.spans.resize(num_outputs);
+    for (size_t i = 0; i < num_outputs; ++i) {
+      const auto& output_tensor_meta =
+          method.method_meta().output_tensor_meta(i);
+      if (!output_tensor_meta.ok()) {
+        // If the output isn't a tensor it won't have a tensor meta.
+        ET_LOG(
+            Info,
+            "Tensor meta doesn't exist for output %zu, error is 0x%" PRIx32
+            ", skipping allocating storage",
+            i,
+            static_cast<uint32_t>(output_tensor_meta.error()));
+        continue;
+      }
+      const size_t output_size = output_tensor_meta.get().nbytes();
+      storages.buffers[i].reset(new uint8_t[output_size]);
+      storages.spans[i] = Span<uint8_t>(storages.buffers[i].get(), output_size);
+    }
+    return output_storages_.emplace(method_name, std::move(storages))
+        .first->second.spans;
+  }
+
+  struct OutputStorages {
+    std::vector<std::unique_ptr<uint8_t[]>> buffers;
+    std::vector<Span<uint8_t>> spans;
+  };
+
   std::unique_ptr<Module> module_;
+  // Keyed by method name. Only accessed with mutex_ held.
+  std::unordered_map<std::string, OutputStorages> output_storages_;
+  std::unordered_map<std::string, InputAliasCache> input_alias_caches_;
+  // A unique_ptr so that PyModule stays movable.
+  std::unique_ptr<std::mutex> mutex_ = std::make_unique<std::mutex>();
 };
 
 void create_profile_block(const std::string& name) {
@@ -702,14 +849,31 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
           &PyModule::run_method,
           py::arg("method_name"),
           py::arg("inputs") = py::list(),
+          py::arg("clone_outputs") = true,
+          call_guard)
+      .def(
+          "run_method_batch",
+          &PyModule::run_method_batch,
+          py::arg("method_name"),
+          py::arg("batch"),
+          call_guard)
+      .def(
+          "forward",
+          &PyModule::forward,
+          py::arg("inputs"),
+          py::arg("clone_outputs") = true,
           call_guard)
-      .def("forward", &PyModule::forward, call_guard)
       .def("has_etdump", &PyModule::has_etdump, call_guard)
       .def(
           "write_etdump_result_to_file",
           &PyModule::write_etdump_result_to_file,
           call_guard)
-      .def("__call__", &PyModule::forward, call_guard)
+      .def(
+          "__call__",
+          &PyModule::forward,
+          py::arg("inputs"),
+          py::arg("clone_outputs") = true,
+          call_guard)
       .def("__call__", &PyModule::forward_single_input, call_guard);
 
   py::class_<PyBundledModule>(m, "BundledModule");
@@ -145,6 +145,45 @@ def make_test(  # noqa: C901
             outputs = lower_function_call()
             tester.assertTrue(torch.allclose(outputs[0], torch.ones(2, 2) * 2))
 
+        def test_output_aliasing(tester):
+            program, inputs = create_program(ModuleMulti())
+            executorch_module = load_fn(program.buffer)
+
+            cloned = executorch_module.forward(inputs)[0]
+            aliased = executorch_module.forward(inputs, clone_outputs=False)[0]
+            tester.assertTrue(torch.allclose(aliased, torch.ones(2, 2) * 2))
+
+            # The aliased output is overwritten by the next run, the cloned one
+            # is not.
+            executorch_module.forward((torch.zeros(2, 2), torch.zeros(2, 2)))
+            tester.assertTrue(torch.allclose(aliased, torch.zeros(2, 2)))
+            tester.assertTrue(torch.allclose(cloned, torch.ones(2, 2) * 2))
+
+        def test_dlpack_inputs(tester):
+            program, inputs = create_program(ModuleAdd())
+            executorch_module = load_fn(program.buffer)
+
+            # Objects implementing the DLPack protocol are accepted as tensors.
+            numpy_inputs = [x.numpy() for x in inputs]
+            output = executorch_module.forward(numpy_inputs)[0]
+            tester.assertTrue(torch.allclose(output, inputs[0] + inputs[1]))
+
+            # Repeated runs with the same shapes reuse the input metadata, and
+            # see the new data.
+            x = torch.full((2, 2), 3.0)
+            output = executorch_module.forward((x, inputs[1]))[0]
+            tester.assertTrue(torch.allclose(output, x + inputs[1]))
+
+        def test_run_method_batch(tester):
+            program, inputs = create_program(ModuleMulti())
+            executorch_module = load_fn(program.buffer)
+
+            batch = [(torch.ones(2, 2) * i, torch.ones(2, 2)) for i in range(3)]
+            stacked = executorch_module.run_method_batch("forward2", batch)[0]
+            tester.assertEqual(stacked.shape, (3, 2, 2))
+            for i, (x, y) in enumerate(batch):
+                tester.assertTrue(torch.allclose(stacked[i], x + y + 1))
+
         def test_module_callable(tester):
             # Create an ExecuTorch program from ModuleAdd.
             exported_program, inputs = create_program(ModuleAdd())
@@ -214,6 +253,9 @@ def make_test(  # noqa: C901
         test_e2e(tester)
         test_multiple_entry(tester)
         test_output_lifespan(tester)
+        test_output_aliasing(tester)
+        test_dlpack_inputs(tester)
+        test_run_method_batch(tester)
         test_module_callable(tester)
         test_module_single_input(tester)
         test_stderr_redirect(tester)
@@ -52,3 +52,13 @@ except:
     from_str = treespec_loads
     register_custom = _register_pytree_node
     TreeSpec.to_str = treespec_dumps  # pyre-ignore
+
+    if not hasattr(TreeSpec, "flatten_up_to"):
+
+        def _flatten_up_to(self, tree):
+            leaves, spec = tree_flatten(tree)
+            if spec != self:
+                raise ValueError(f"Expected a tree matching {self}, got {spec}")
+            return leaves
+
+        TreeSpec.flatten_up_to = _flatten_up_to  # pyre-ignore
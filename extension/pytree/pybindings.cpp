@@ -23,6 +23,8 @@ namespace {
 
 struct PyAux {
   py::object custom_type_context;
+  // The keys of a dict node as Python objects, built on first use.
+  mutable py::object dict_keys;
 };
 using PyTreeSpec = TreeSpec<PyAux>;
 
@@ -48,7 +50,22 @@ class PyTypeRegistry {
   }
 
   static const PyTypeReg* get_by_type(py::handle pytype) {
-    return get_by_str(py::str(pytype));
+    auto* registry = instance();
+    auto it = registry->by_type_.find(pytype.ptr());
+    if (it != registry->by_type_.end()) {
+      return it->second.second;
+    }
+    const auto* reg = get_by_str(py::str(pytype));
+    // Leaf types are remembered too, up to a bound, so that the type name is
+    // only formatted once per type. Holding the type keeps its address from
+    // being reused by another type.
+    if (registry->by_type_.size() >= kMaxCachedTypes) {
+      registry->by_type_.clear();
+    }
+    registry->by_type_.emplace(
+        pytype.ptr(),
+        std::make_pair(py::reinterpret_borrow<py::object>(pytype), reg));
+    return reg;
   }
 
   static void register_custom_type(
@@ -65,6 +82,7 @@ class PyTypeRegistry {
     if (!it.second) {
       assert(false);
     }
+    registry->by_type_.clear();
   }
 
  private:
@@ -85,18 +103,36 @@ class PyTypeRegistry {
 
     return registry_instance;
   }
+  static constexpr size_t kMaxCachedTypes = 256;
+
   std::unordered_map<std::string, std::unique_ptr<PyTypeReg>> regs_;
+  // Lookups by type object, which may map to nullptr for leaf types.
+  std::unordered_map<PyObject*, std::pair<py::object, const PyTypeReg*>>
+      by_type_;
 };
 
 class PyTree {
+  static constexpr size_t kMaxCachedSpecs = 1024;
+
   PyTreeSpec spec_;
 
   static void flatten_internal(
       py::handle x,
       std::vector<py::object>& leaves,
       PyTreeSpec& s) {
-    const auto* reg = PyTypeRegistry::get_by_type(x.get_type());
+    const PyTypeRegistry::PyTypeReg* reg = nullptr;
     const auto kind = [&reg, &x]() {
+      // The builtin containers skip the registry.
+      if (PyList_CheckExact(x.ptr())) {
+        return Kind::List;
+      }
+      if (PyTuple_CheckExact(x.ptr())) {
+        return Kind::Tuple;
+      }
+      if (PyDict_CheckExact(x.ptr())) {
+        return Kind::Dict;
+      }
+      reg = PyTypeRegistry::get_by_type(x.get_type());
       if (reg) {
         return reg->kind;
       }
@@ -179,6 +215,117 @@ class PyTree {
     }
   }
 
+  static py::object key_object(const Key& key) {
+    switch (key.kind()) {
+      case Key::Kind::Int:
+        return py::int_(key.as_int());
+      case Key::Kind::Str:
+        return py::str(key.as_str());
+      case Key::Kind::None:
+        pytree_assert(false);
+    }
+    pytree_assert(false);
+    return py::none();
+  }
+
+  static py::tuple dict_keys(const PyTreeSpec& spec) {
+    if (!spec.handle->dict_keys) {
+      const size_t size = spec.size();
+      py::tuple keys(size);
+      for (size_t i = 0; i < size; ++i) {
+        keys[i] = key_object(spec.key(i));
+      }
+      spec.handle->dict_keys = std::move(keys);
+    }
+    return py::reinterpret_borrow<py::tuple>(spec.handle->dict_keys);
+  }
+
+  // Flattens `x`, which must have the structure of `spec` down to its leaves,
+  // without building a spec for it.
+  static void flatten_up_to_internal(
+      const PyTreeSpec& spec,
+      py::handle x,
+      std::vector<py::object>& leaves) {
+    const size_t size = spec.size();
+    const auto py_size = static_cast<Py_ssize_t>(size);
+    auto check = [&](bool matches, const char* expected) {
+      if (!matches) {
+        throw py::value_error(
+            std::string("Expected ") + expected + " of " +
+            std::to_string(size) + " items, got " +
+            std::string(py::repr(x)));
+      }
+    };
+    switch (spec.kind()) {
+      case Kind::Leaf: {
+        leaves.push_back(py::reinterpret_borrow<py::object>(x));
+        return;
+      }
+      case Kind::List: {
+        check(
+            PyList_CheckExact(x.ptr()) && PyList_GET_SIZE(x.ptr()) == py_size,
+            "a list");
+        for (size_t i = 0; i < size; ++i) {
+          flatten_up_to_internal(spec[i], PyList_GET_ITEM(x.ptr(), i), leaves);
+        }
+        return;
+      }
+      case Kind::Tuple: {
+        check(
+            PyTuple_CheckExact(x.ptr()) && PyTuple_GET_SIZE(x.ptr()) == py_size,
+            "a tuple");
+        for (size_t i = 0; i < size; ++i) {
+          flatten_up_to_internal(
+              spec[i], PyTuple_GET_ITEM(x.ptr(), i), leaves);
+        }
+        return;
+      }
+      case Kind::NamedTuple: {
+        check(
+            PyTuple_Check(x.ptr()) && py::hasattr(x, "_fields") &&
+                PyTuple_GET_SIZE(x.ptr()) == py_size,
+            "a namedtuple");
+        for (size_t i = 0; i < size; ++i) {
+          flatten_up_to_internal(
+              spec[i], PyTuple_GET_ITEM(x.ptr(), i), leaves);
+        }
+        return;
+      }
+      case Kind::Dict: {
+        check(
+            PyDict_CheckExact(x.ptr()) && PyDict_Size(x.ptr()) == py_size,
+            "a dict");
+        const auto& keys = dict_keys(spec);
+        for (size_t i = 0; i < size; ++i) {
+          // Borrowed reference.
+          PyObject* child = PyDict_GetItem(x.ptr(), keys[i].ptr());
+          check(child != nullptr, "a dict with the same keys");
+          flatten_up_to_internal(spec[i], child, leaves);
+        }
+        return;
+      }
+      case Kind::Custom: {
+        const auto* reg = PyTypeRegistry::get_by_type(x.get_type());
+        check(
+            reg != nullptr && reg->kind == Kind::Custom &&
+                std::string(py::str(x.get_type())) == spec.handle->custom_type,
+            spec.handle->custom_type.c_str());
+        py::tuple out = py::cast<py::tuple>(reg->flatten(x));
+        py::list children = py::cast<py::list>(out[0]);
+        check(
+            children.size() == size &&
+                out[1].equal(spec.handle->custom_type_context),
+            spec.handle->custom_type.c_str());
+        for (size_t i = 0; i < size; ++i) {
+          flatten_up_to_internal(spec[i], children[i], leaves);
+        }
+        return;
+      }
+      case Kind::None:
+        pytree_assert(false);
+    }
+  }
+
   template <typename T>
   py::object unflatten_internal(const PyTreeSpec& spec, T&& leaves_it) const {
     switch (spec.kind()) {
@@ -212,22 +359,10 @@ class PyTree {
       }
       case Kind::Dict: {
         const size_t size = spec.size();
+        const auto& keys = dict_keys(spec);
         py::dict dict;
         for (size_t i = 0; i < size; ++i) {
-          auto& key = spec.key(i);
-          auto py_key = [&key]() -> py::handle {
-            switch (key.kind()) {
-              case Key::Kind::Int:
-                return py::cast(key.as_int()).release();
-              case Key::Kind::Str:
-                return py::cast(key.as_str()).release();
-              case Key::Kind::None:
-                pytree_assert(false);
-            }
-            pytree_assert(false);
-            return py::none();
-          }();
-          dict[py_key] = unflatten_internal(spec[i], leaves_it);
+          dict[keys[i]] = unflatten_internal(spec[i], leaves_it);
         }
         return std::move(dict);
       }
@@ -251,21 +386,47 @@ class PyTree {
     return spec_;
   }
 
-  static PyTree py_from_str(std::string spec) {
-    return PyTree(from_str<PyAux>(spec));
+  // Specs are parsed once per distinct string, since callers like the
+  // verification interpreter unflatten with the same spec on every run. The
+  // returned spec is shared and must not be mutated.
+  static std::shared_ptr<PyTree> py_from_str(const std::string& spec) {
+    // Leaked, like the type registry, so that the held Python objects are not
+    // released after the interpreter is finalized.
+    static auto* cache =
+        new std::unordered_map<StrTreeSpec, std::shared_ptr<PyTree>>();
+    auto it = cache->find(spec);
+    if (it != cache->end()) {
+      return it->second;
+    }
+    if (cache->size() >= kMaxCachedSpecs) {
+      cache->clear();
+    }
+    auto tree = std::make_shared<PyTree>(from_str<PyAux>(spec));
+    refresh_leaves_num(tree->spec_);
+    cache->emplace(spec, tree);
+    return tree;
   }
 
   StrTreeSpec py_to_str() const {
     return to_str(spec_);
   }
 
-  static std::pair<std::vector<py::object>, std::unique_ptr<PyTree>>
+  static std::pair<std::vector<py::object>, std::shared_ptr<PyTree>>
   tree_flatten(py::handle x) {
     std::vector<py::object> leaves{};
     PyTreeSpec spec{};
     flatten_internal(x, leaves, spec);
     refresh_leaves_num(spec);
-    return {std::move(leaves), std::make_unique<PyTree>(std::move(spec))};
+    return {std::move(leaves), std::make_shared<PyTree>(std::move(spec))};
+  }
+
+  // Flattens `x` against this spec. Raises ValueError if the structure of
+  // `x` does not match.
+  std::vector<py::object> flatten_up_to(py::handle x) const {
+    std::vector<py::object> leaves;
+    leaves.reserve(leaves_num());
+    flatten_up_to_internal(spec_, x, leaves);
+    return leaves;
   }
 
   static py::object tree_unflatten(py::iterable leaves, py::object o) {
@@ -286,7 +447,7 @@ class PyTree {
   }
 };
 
-inline std::pair<std::vector<py::object>, std::unique_ptr<PyTree>> tree_flatten(
+inline std::pair<std::vector<py::object>, std::shared_ptr<PyTree>> tree_flatten(
     py::handle x) {
   return PyTree::tree_flatten(x);
 }
@@ -306,8 +467,8 @@ static py::object tree_map(py::function& fn, py::handle x) {
   return pytree->tree_unflatten(vec);
 }
 
-static std::unique_ptr<PyTree> py_from_str(std::string spec) {
-  return std::make_unique<PyTree>(from_str<PyAux>(spec));
+static std::shared_ptr<PyTree> py_from_str(const std::string& spec) {
+  return PyTree::py_from_str(spec);
 }
 
 static py::object broadcast_to_and_flatten(
@@ -382,12 +543,13 @@ PYBIND11_MODULE(pybindings, m) {
   m.def("broadcast_to_and_flatten", &broadcast_to_and_flatten);
   m.def("register_custom", &PyTypeRegistry::register_custom_type);
 
-  py::class_<PyTree>(m, "TreeSpec")
+  py::class_<PyTree, std::shared_ptr<PyTree>>(m, "TreeSpec")
       .def("from_str", &PyTree::py_from_str)
       .def(
           "tree_unflatten",
           static_cast<py::object (PyTree::*)(py::iterable leaves) const>(
               &PyTree::tree_unflatten))
+      .def("flatten_up_to", &PyTree::flatten_up_to, py::arg("tree"))
       .def("__repr__", &PyTree::py_to_str)
       .def("__eq__", &PyTree::operator==)
       .def("to_str", &PyTree::py_to_str)
@@ -15,6 +15,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 // NB: This is a local, pytree FunctionRef and not from the ExecuTorch runtime.
 #include <executorch/extension/pytree/function_ref.h>
@@ -671,6 +672,43 @@ ContainerHandle<T, Aux> unflatten(const StrTreeSpec& spec, T* leaves) {
   return unflatten(from_str<Aux>(spec), leaves);
 }
 
+// Parses each distinct StrTreeSpec once. Callers that unflatten with the same
+// spec on every call, like the inputs and outputs of a method, keep one cache
+// so that only the leaves are rebuilt per call.
+template <typename Aux = Empty>
+class TreeSpecCache final {
+ public:
+  // The returned spec stays valid until clear() or the cache is destroyed.
+  const TreeSpec<Aux>& get(const StrTreeSpec& spec) {
+    auto it = specs_.find(spec);
+    if (it == specs_.end()) {
+      auto parsed = std::make_unique<TreeSpec<Aux>>(from_str<Aux>(spec));
+      refresh_leaves_num(*parsed);
+      it = specs_.emplace(spec, std::move(parsed)).first;
+    }
+    return *it->second;
+  }
+
+  size_t size() const {
+    return specs_.size();
+  }
+
+  void clear() {
+    specs_.clear();
+  }
+
+ private:
+  std::unordered_map<StrTreeSpec, std::unique_ptr<TreeSpec<Aux>>> specs_;
+};
+
+template <typename T, typename Aux>
+ContainerHandle<T, Aux> unflatten(
+    TreeSpecCache<Aux>& cache,
+    const StrTreeSpec& spec,
+    T* leaves) {
+  return clone(cache.get(spec), leaves);
+}
+
 template <typename T, typename Aux>
 void flatten_internal(const ContainerHandle<T, Aux>& tree, const T** leaves) {
   using tree_t = decltype(tree);
@@ -13,6 +13,7 @@ import torch
 # @manual=//executorch/extension/pytree:pybindings
 from executorch.extension.pytree import (
     broadcast_to_and_flatten,
+    from_str,
     register_custom,
     tree_flatten,
     tree_map,
@@ -292,6 +293,28 @@ class TestPytree(unittest.TestCase):
         point2 = tree_unflatten(children, spec)
         self.assertEqual(str(point), str(point2))
 
+    def test_flatten_up_to(self):
+        pytree = (1, [2, 3], {"a": 4, 5: (6,)})
+        leaves, spec = tree_flatten(pytree)
+        self.assertEqual(spec.flatten_up_to(pytree), leaves)
+        # Leaves of the spec match whole subtrees.
+        self.assertEqual(_spec((0, 0)).flatten_up_to((1, [2, 3])), [1, [2, 3]])
+        for mismatched in [
+            (1, (2, 3), {"a": 4, 5: (6,)}),
+            (1, [2, 3, 4], {"a": 4, 5: (6,)}),
+            (1, [2, 3], {"b": 4, 5: (6,)}),
+            [1, [2, 3], {"a": 4, 5: (6,)}],
+        ]:
+            with self.assertRaises(ValueError):
+                spec.flatten_up_to(mismatched)
+
+    def test_from_str_is_cached(self):
+        spec_str = "T2#1#2($,L2#1#1($,$))"
+        spec = from_str(spec_str)
+        self.assertIs(from_str(spec_str), spec)
+        self.assertEqual(tree_unflatten([1, 2, 3], spec), (1, [2, 3]))
+        self.assertEqual(tree_unflatten([4, 5, 6], spec), (4, [5, 6]))
+
     def test_broadcast_to_and_flatten(self):
         cases = [
             (1, (), []),
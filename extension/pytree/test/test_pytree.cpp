@@ -188,6 +188,29 @@ TEST(pytree, FlattenNestedDict) {
   }
 }
 
+TEST(pytree, TreeSpecCache) {
+  TreeSpecCache<> cache;
+  const std::string spec = "T2#1#2($,L2#1#1($,$))";
+  const auto& parsed = cache.get(spec);
+  ASSERT_EQ(parsed.leaves_num(), 3);
+  // The same spec is parsed only once.
+  ASSERT_EQ(&cache.get(spec), &parsed);
+  ASSERT_EQ(cache.size(), 1);
+
+  Leaf items[3] = {11, 12, 13};
+  for (size_t i = 0; i < 2; ++i) {
+    auto c = unflatten(cache, spec, items);
+    ASSERT_TRUE(c.isTuple());
+    ASSERT_EQ(c[0], 11);
+    ASSERT_TRUE(c[1].isList());
+    ASSERT_EQ(c[1][1], 13);
+  }
+  ASSERT_EQ(cache.size(), 1);
+
+  cache.clear();
+  ASSERT_EQ(cache.size(), 0);
+}
+
 } // namespace pytree
 } // namespace executor
 } // namespace torch
@@ -8,6 +8,8 @@
 
 #include <executorch/extension/runner_util/inputs.h>
 
+#include <cstdint>
+
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/method_meta.h>
 #include <executorch/runtime/platform/log.h>
@@ -53,6 +55,62 @@ Result<BufferCleanup> prepare_input_tensors(Method& method) {
   return BufferCleanup({inputs, num_allocated});
 }
 
+Result<InputBuffers> prepare_input_buffers(Method& method, size_t alignment) {
+  ET_CHECK_OR_RETURN_ERROR(
+      alignment > 0 && (alignment & (alignment - 1)) == 0,
+      InvalidArgument,
+      "Alignment %zu is not a power of 2",
+      alignment);
+
+  MethodMeta method_meta = method.method_meta();
+  size_t num_inputs = method_meta.num_inputs();
+  auto* buffers = static_cast<InputBuffers::Buffer*>(
+      calloc(num_inputs, sizeof(InputBuffers::Buffer)));
+  ET_CHECK_OR_RETURN_ERROR(
+      buffers != nullptr || num_inputs == 0,
+      MemoryAllocationFailed,
+      "Failed to allocate %zu input buffers",
+      num_inputs);
+  // Frees the buffers allocated so far on failure.
+  InputBuffers input_buffers(buffers, num_inputs);
+
+  for (size_t i = 0; i < num_inputs; i++) {
+    auto tag = method_meta.input_tag(i);
+    if (!tag.ok()) {
+      return tag.error();
+    }
+    if (tag.get() != Tag::Tensor) {
+      ET_LOG(Debug, "Skipping non-tensor input %zu", i);
+      continue;
+    }
+    Result<TensorInfo> tensor_meta = method_meta.input_tensor_meta(i);
+    if (!tensor_meta.ok()) {
+      return tensor_meta.error();
+    }
+    // Round the size up so that the last vector load stays in the buffer, and
+    // leave room to align the start.
+    size_t nbytes = tensor_meta->nbytes();
+    size_t padded_nbytes = (nbytes + alignment - 1) & ~(alignment - 1);
+    void* allocation = malloc(padded_nbytes + alignment - 1);
+    ET_CHECK_OR_RETURN_ERROR(
+        allocation != nullptr,
+        MemoryAllocationFailed,
+        "Failed to allocate %zu bytes for input %zu",
+        padded_nbytes,
+        i);
+    uintptr_t address = reinterpret_cast<uintptr_t>(allocation);
+    address = (address + alignment - 1) & ~(alignment - 1);
+    buffers[i] = {allocation, reinterpret_cast<void*>(address), padded_nbytes};
+
+    Error err = bind_input(method, i, buffers[i].data, padded_nbytes);
+    if (err != Error::Ok) {
+      ET_LOG(Error, "Failed to bind input %zu: 0x%" PRIx32, i, (uint32_t)err);
+      return err;
+    }
+  }
+  return input_buffers;
+}
+
 } // namespace util
 } // namespace executor
 } // namespace torch
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <cstdlib>
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/method_meta.h>
@@ -63,6 +66,121 @@ class BufferCleanup final {
  */
 Result<BufferCleanup> prepare_input_tensors(Method& method);
 
+/**
+ * Points the tensor input `input_index` of `method` at `data`, without copying
+ * it or allocating memory. The Method keeps its own input tensor and only
+ * updates its shape and data pointer, so calling this before every execution
+ * is cheap.
+ *
+ * @param[in] method The Method that owns the input to bind.
+ * @param[in] input_index Zero-based index of the input. Must be a tensor.
+ * @param[in] data The data of the input, in the dim order of the input. Must
+ *     outlive the executions that use it, and is written to by kernels that
+ *     modify the input.
+ * @param[in] nbytes The size of `data` in bytes, which must be large enough
+ *     for `sizes`.
+ * @param[in] sizes The shape of the input, which must be valid for the Method,
+ *     e.g. within the upper bounds of a dynamically shaped input. Defaults to
+ *     the shape in the Method's metadata.
+ *
+ * @returns Error::Ok on success, non-Ok on failure.
+ */
+__ET_NODISCARD Error bind_input(
+    Method& method,
+    size_t input_index,
+    void* data,
+    size_t nbytes,
+    exec_aten::ArrayRef<exec_aten::SizesType> sizes = {});
+
+/**
+ * Buffers allocated for the tensor inputs of a Method by
+ * prepare_input_buffers(), which frees them when destroyed. Movable.
+ */
+class InputBuffers final {
+ public:
+  /**
+   * Move ctor. Takes ownership of the buffers previously owned by `rhs`,
+   * leaving `rhs` empty.
+   */
+  InputBuffers(InputBuffers&& rhs) noexcept
+      : buffers_(rhs.buffers_), num_inputs_(rhs.num_inputs_) {
+    rhs.buffers_ = nullptr;
+    rhs.num_inputs_ = 0;
+  }
+
+  ~InputBuffers() {
+    for (size_t i = 0; i < num_inputs_; i++) {
+      free(buffers_[i].allocation);
+    }
+    free(buffers_);
+  }
+
+  /// Returns the number of inputs of the Method, tensors or not.
+  size_t size() const {
+    return num_inputs_;
+  }
+
+  /**
+   * Returns the buffer bound to input `input_index`, or nullptr if the input
+   * is not a tensor.
+   */
+  void* data(size_t input_index) const {
+    return input_index < num_inputs_ ? buffers_[input_index].data : nullptr;
+  }
+
+  /// Returns the size in bytes of the buffer bound to input `input_index`.
+  size_t nbytes(size_t input_index) const {
+    return input_index < num_inputs_ ? buffers_[input_index].nbytes : 0;
+  }
+
+ private:
+  struct Buffer {
+    // The pointer to free().
+    void* allocation;
+    // The aligned start of the buffer.
+    void* data;
+    size_t nbytes;
+  };
+
+  InputBuffers(Buffer* buffers, size_t num_inputs)
+      : buffers_(buffers), num_inputs_(num_inputs) {}
+
+  // Delete other rule-of-five methods.
+  InputBuffers(const InputBuffers&) = delete;
+  InputBuffers& operator=(const InputBuffers&) = delete;
+  InputBuffers& operator=(InputBuffers&&) noexcept = delete;
+
+  friend Result<InputBuffers> prepare_input_buffers(Method&, size_t);
+
+  // One entry per input; non-tensor inputs have a null buffer.
+  Buffer* buffers_;
+  size_t num_inputs_;
+};
+
+/// The default alignment of the buffers allocated by prepare_input_buffers().
+constexpr size_t kDefaultInputBufferAlignment = 64;
+
+/**
+ * Allocates a buffer for each tensor input of the provided Method and binds it
+ * to the input with bind_input(). Unlike prepare_input_tensors(), the contents
+ * of the buffers are left uninitialized: fill them through
+ * `InputBuffers::data()` before each execution, without calling set_input().
+ *
+ * The buffers are sized for the shape in the Method's metadata, which is the
+ * upper bound of dynamically shaped inputs, and rounded up to a multiple of
+ * `alignment`, so that delegates can use aligned and full vector loads.
+ *
+ * @param[in] method The Method that owns the inputs to prepare.
+ * @param[in] alignment The alignment of each buffer, a power of two.
+ *
+ * @returns On success, an object that owns the buffers. It must remain alive
+ *     when calling `method->execute()`.
+ * @returns An error on failure.
+ */
+Result<InputBuffers> prepare_input_buffers(
+    Method& method,
+    size_t alignment = kDefaultInputBufferAlignment);
+
 namespace internal {
 /**
  * INTERNAL-ONLY: Creates a Tensor using the provided shape and buffer,
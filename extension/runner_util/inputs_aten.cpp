@@ -18,6 +18,36 @@ namespace torch {
 namespace executor {
 namespace util {
 
+Error bind_input(
+    Method& method,
+    size_t input_index,
+    void* data,
+    size_t nbytes,
+    exec_aten::ArrayRef<exec_aten::SizesType> sizes) {
+  Result<TensorInfo> tensor_meta =
+      method.method_meta().input_tensor_meta(input_index);
+  if (!tensor_meta.ok()) {
+    return tensor_meta.error();
+  }
+  // Convert the default sizes array from int32_t to int64_t.
+  std::vector<int64_t> sizes64(sizes.begin(), sizes.end());
+  if (sizes.empty()) {
+    for (auto s : tensor_meta->sizes()) {
+      sizes64.push_back(s);
+    }
+  }
+  at::Tensor t = at::from_blob(
+      data, sizes64, at::TensorOptions(tensor_meta->scalar_type()));
+  ET_CHECK_OR_RETURN_ERROR(
+      t.nbytes() <= nbytes,
+      InvalidArgument,
+      "Input %zu needs %zu bytes, but the buffer has %zu",
+      input_index,
+      t.nbytes(),
+      nbytes);
+  return method.experimental_share_input(t, input_index);
+}
+
 namespace internal {
 
 Error fill_and_set_input(
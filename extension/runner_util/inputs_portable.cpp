@@ -19,6 +19,47 @@
 namespace torch {
 namespace executor {
 namespace util {
+
+Error bind_input(
+    Method& method,
+    size_t input_index,
+    void* data,
+    size_t nbytes,
+    exec_aten::ArrayRef<exec_aten::SizesType> sizes) {
+  Result<TensorInfo> tensor_meta =
+      method.method_meta().input_tensor_meta(input_index);
+  if (!tensor_meta.ok()) {
+    return tensor_meta.error();
+  }
+  if (sizes.empty()) {
+    sizes = {tensor_meta->sizes().data(), tensor_meta->sizes().size()};
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      sizes.size() == tensor_meta->sizes().size(),
+      InvalidArgument,
+      "Input %zu has %zu dims, but got %zu sizes",
+      input_index,
+      tensor_meta->sizes().size(),
+      sizes.size());
+
+  // Only carries the shape and data to experimental_share_input(), which
+  // updates the Method's own input tensor in place.
+  TensorImpl impl = TensorImpl(
+      tensor_meta->scalar_type(),
+      /*dim=*/sizes.size(),
+      const_cast<TensorImpl::SizesType*>(sizes.data()),
+      data,
+      const_cast<TensorImpl::DimOrderType*>(tensor_meta->dim_order().data()));
+  ET_CHECK_OR_RETURN_ERROR(
+      impl.nbytes() <= nbytes,
+      InvalidArgument,
+      "Input %zu needs %zu bytes, but the buffer has %zu",
+      input_index,
+      impl.nbytes(),
+      nbytes);
+  return method.experimental_share_input(EValue(Tensor(&impl)), input_index);
+}
+
 namespace internal {
 
 namespace {
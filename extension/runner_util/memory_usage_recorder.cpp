@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/runner_util/memory_usage_recorder.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+void append_format(std::string& out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void append_format(std::string& out, const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  const int len = std::vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (len > 0) {
+    out.append(buffer, std::min<size_t>(len, sizeof(buffer) - 1));
+  }
+}
+
+} // namespace
+
+MemoryUsageRecorder::MemoryUsageRecorder(
+    const Method& method,
+    const MemoryAllocator* method_allocator,
+    const TempMemoryAllocator* temp_allocator)
+    : method_(method),
+      method_allocator_(method_allocator),
+      temp_allocator_(temp_allocator),
+      planned_buffer_peak_bytes_(
+          method.method_meta().num_memory_planned_buffers(),
+          0) {}
+
+Error MemoryUsageRecorder::record() {
+  ET_CHECK_OK_OR_RETURN_ERROR(method_.experimental_record_planned_memory_usage(
+      {planned_buffer_peak_bytes_.data(), planned_buffer_peak_bytes_.size()}));
+  if (method_allocator_ != nullptr) {
+    method_allocator_bytes_ =
+        std::max(method_allocator_bytes_, method_allocator_->used_size());
+  }
+  ++num_runs_;
+  return Error::Ok;
+}
+
+std::string MemoryUsageRecorder::to_json() const {
+  const MethodMeta meta = method_.method_meta();
+  std::string out;
+  append_format(out, "{\n  \"method\": \"%s\",\n", meta.name());
+  append_format(out, "  \"num_runs\": %zu,\n", num_runs_);
+  out += "  \"planned_buffers\": [";
+  for (size_t i = 0; i < planned_buffer_peak_bytes_.size(); ++i) {
+    const int64_t planned_bytes = meta.memory_planned_buffer_size(i).get();
+    append_format(
+        out,
+        "%s\n    {\"index\": %zu, \"planned_bytes\": %" PRId64
+        ", \"peak_bytes\": %zu}",
+        i == 0 ? "" : ",",
+        i,
+        planned_bytes,
+        planned_buffer_peak_bytes_[i]);
+  }
+  out += planned_buffer_peak_bytes_.empty() ? "]" : "\n  ]";
+  if (method_allocator_ != nullptr) {
+    append_format(
+        out, ",\n  \"method_allocator_bytes\": %zu", method_allocator_bytes_);
+  }
+  if (temp_allocator_ != nullptr) {
+    append_format(
+        out,
+        ",\n  \"temp_allocator_peak_bytes\": %zu",
+        temp_allocator_->high_water_mark());
+  }
+  out += "\n}\n";
+  return out;
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
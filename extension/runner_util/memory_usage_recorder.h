@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/method.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Records the peak memory usage of a method across executions: how much of
+ * each memory-planned buffer its tensors actually cover, how much the method
+ * allocator holds, and the largest scratch usage of a kernel.
+ *
+ * Running the method over representative inputs and writing `to_json()`
+ * gives a report that the ahead-of-time memory planner can use to bound the
+ * planned buffer sizes of models with dynamic shapes, rather than planning
+ * for the upper bound of every shape.
+ */
+class MemoryUsageRecorder final {
+ public:
+  /**
+   * @param[in] method The method to record. Must outlive the recorder.
+   * @param[in] method_allocator The method allocator of `method`, or nullptr.
+   * @param[in] temp_allocator The temp allocator of `method`, or nullptr.
+   */
+  MemoryUsageRecorder(
+      const Method& method,
+      const MemoryAllocator* method_allocator = nullptr,
+      const TempMemoryAllocator* temp_allocator = nullptr);
+
+  /**
+   * Folds the usage of the latest execution into the peaks. Call after each
+   * `Method::execute()`.
+   *
+   * @returns Error::Ok on success, non-Ok on failure.
+   */
+  __ET_NODISCARD Error record();
+
+  /// Returns the number of executions recorded.
+  size_t num_runs() const {
+    return num_runs_;
+  }
+
+  /// Returns the peak bytes used of each memory-planned buffer.
+  const std::vector<size_t>& planned_buffer_peak_bytes() const {
+    return planned_buffer_peak_bytes_;
+  }
+
+  /**
+   * Returns the report as JSON, in the form:
+   *
+   * @code
+   * {
+   *   "method": "forward",
+   *   "num_runs": 8,
+   *   "planned_buffers": [
+   *     {"index": 0, "planned_bytes": 4096, "peak_bytes": 1024}
+   *   ],
+   *   "method_allocator_bytes": 2048,
+   *   "temp_allocator_peak_bytes": 512
+   * }
+   * @endcode
+   *
+   * The allocator fields are omitted when the allocators were not provided.
+   */
+  std::string to_json() const;
+
+ private:
+  const Method& method_;
+  const MemoryAllocator* method_allocator_;
+  const TempMemoryAllocator* temp_allocator_;
+  std::vector<size_t> planned_buffer_peak_bytes_;
+  size_t method_allocator_bytes_ = 0;
+  size_t num_runs_ = 0;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
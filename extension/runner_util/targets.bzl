@@ -41,3 +41,18 @@ def define_common_targets():
                 "//executorch/runtime/core/exec_aten/util:tensor_util" + aten_suffix,
             ],
         )
+
+        runtime.cxx_library(
+            name = "memory_usage_recorder" + aten_suffix,
+            srcs = ["memory_usage_recorder.cpp"],
+            exported_headers = ["memory_usage_recorder.h"],
+            visibility = [
+                "//executorch/...",
+                "@EXECUTORCH_CLIENTS",
+            ],
+            exported_deps = [
+                "//executorch/extension/memory_allocator:temp_memory_allocator",
+                "//executorch/runtime/core:memory_allocator",
+                "//executorch/runtime/executor:program" + aten_suffix,
+            ],
+        )
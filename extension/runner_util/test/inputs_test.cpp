@@ -17,6 +17,10 @@
 #include <executorch/runtime/platform/runtime.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 using namespace ::testing;
 using exec_aten::ScalarType;
 using exec_aten::Tensor;
@@ -31,8 +35,11 @@ using torch::executor::Span;
 using torch::executor::Tag;
 using torch::executor::Tensor;
 using torch::executor::testing::ManagedMemoryManager;
+using torch::executor::util::bind_input;
 using torch::executor::util::BufferCleanup;
 using torch::executor::util::FileDataLoader;
+using torch::executor::util::InputBuffers;
+using torch::executor::util::prepare_input_buffers;
 using torch::executor::util::prepare_input_tensors;
 
 class InputsTest : public ::testing::Test {
@@ -101,6 +108,51 @@ TEST_F(InputsTest, Smoke) {
   // the pointers.
 }
 
+TEST_F(InputsTest, PrepareInputBuffersAndBind) {
+  Result<InputBuffers> input_buffers =
+      prepare_input_buffers(*method_, /*alignment=*/128);
+  ASSERT_EQ(input_buffers.error(), Error::Ok);
+  ASSERT_EQ(input_buffers->size(), method_->inputs_size());
+
+  // ModuleAdd has two tensor inputs followed by a scalar.
+  for (size_t i = 0; i < 2; i++) {
+    ASSERT_NE(input_buffers->data(i), nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(input_buffers->data(i)) % 128, 0);
+    EXPECT_EQ(input_buffers->nbytes(i) % 128, 0);
+  }
+  EXPECT_EQ(input_buffers->data(2), nullptr);
+
+  // Writing to the buffers sets the inputs, without calling set_input().
+  auto fill = [](void* data, size_t numel, float value) {
+    std::fill(
+        static_cast<float*>(data), static_cast<float*>(data) + numel, value);
+  };
+  const size_t numel =
+      method_->method_meta().input_tensor_meta(0)->nbytes() / sizeof(float);
+  fill(input_buffers->data(0), numel, 1.5);
+  fill(input_buffers->data(1), numel, 2.0);
+  ASSERT_EQ(method_->execute(), Error::Ok);
+  Tensor output = method_->get_output(0).toTensor();
+  for (float e : Span<float>(output.mutable_data_ptr<float>(), numel)) {
+    EXPECT_EQ(e, 3.5);
+  }
+
+  // Bind caller memory to the first input.
+  std::vector<float> data(numel, 4.0);
+  ASSERT_EQ(
+      bind_input(*method_, 0, data.data(), data.size() * sizeof(float)),
+      Error::Ok);
+  ASSERT_EQ(method_->execute(), Error::Ok);
+  output = method_->get_output(0).toTensor();
+  for (float e : Span<float>(output.mutable_data_ptr<float>(), numel)) {
+    EXPECT_EQ(e, 6.0);
+  }
+
+  // Too small a buffer or a non-tensor input is rejected.
+  EXPECT_NE(bind_input(*method_, 0, data.data(), sizeof(float)), Error::Ok);
+  EXPECT_NE(bind_input(*method_, 2, data.data(), sizeof(float)), Error::Ok);
+}
+
 TEST(BufferCleanupTest, Smoke) {
   // Returns the size of the buffer at index `i`.
   auto test_buffer_size = [](size_t i) {
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/scheduler/method_scheduler.h>
+
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/clock.h>
+#include <executorch/runtime/platform/platform.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+namespace {
+
+uint64_t pal_now_ns() {
+  return ticks_to_ns(et_pal_current_ticks());
+}
+
+} // namespace
+
+MethodScheduler::MethodScheduler(uint64_t time_slice_ns, Clock clock)
+    : time_slice_ns_(time_slice_ns),
+      clock_(clock != nullptr ? clock : pal_now_ns) {}
+
+Result<size_t> MethodScheduler::submit(
+    Method& method,
+    int32_t priority,
+    uint64_t deadline_ns) {
+  for (const Task& task : tasks_) {
+    ET_CHECK_OR_RETURN_ERROR(
+        task.method != &method,
+        InvalidState,
+        "Method is already in pending task %zu",
+        task.id);
+  }
+  const size_t id = next_task_id_++;
+  tasks_.push_back(Task{id, &method, priority, deadline_ns, false});
+  return id;
+}
+
+Error MethodScheduler::cancel(size_t task_id) {
+  for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+    if (it->id == task_id) {
+      ET_CHECK_OR_RETURN_ERROR(
+          !it->started,
+          InvalidState,
+          "Cannot cancel task %zu after it has started",
+          task_id);
+      tasks_.erase(it);
+      return Error::Ok;
+    }
+  }
+  return Error::NotFound;
+}
+
+size_t MethodScheduler::pick_next() const {
+  size_t best = 0;
+  for (size_t i = 1; i < tasks_.size(); ++i) {
+    const Task& a = tasks_[i];
+    const Task& b = tasks_[best];
+    // Tasks are kept in submission order, so strict comparisons keep the
+    // earliest of otherwise equal tasks.
+    if (a.priority > b.priority ||
+        (a.priority == b.priority && a.deadline_ns < b.deadline_ns)) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+Result<MethodScheduler::SliceResult> MethodScheduler::run_slice() {
+  if (tasks_.empty()) {
+    return Error::NotFound;
+  }
+  const size_t index = pick_next();
+  Task& task = tasks_[index];
+  task.started = true;
+
+  SliceResult result{task.id, 0, false, Error::Ok, false};
+  const uint64_t start_ns = clock_();
+  while (true) {
+    // Yield before a delegate call unless it would start the slice, so a
+    // more urgent task submitted in the meantime runs first.
+    if (result.steps > 0 &&
+        task.method->experimental_next_step_is_delegate_call()) {
+      break;
+    }
+    Error err = task.method->experimental_step();
+    if (err == Error::EndOfMethod) {
+      err = task.method->experimental_reset_execution();
+      result.finished = true;
+      result.error = err;
+      break;
+    }
+    if (err != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Task %zu failed at step %zu: 0x%" PRIx32,
+          task.id,
+          result.steps,
+          static_cast<uint32_t>(err));
+      result.finished = true;
+      result.error = err;
+      break;
+    }
+    result.steps++;
+    if (clock_() - start_ns >= time_slice_ns_) {
+      break;
+    }
+  }
+
+  if (result.finished) {
+    result.missed_deadline = clock_() > task.deadline_ns;
+    tasks_.erase(tasks_.begin() + index);
+  }
+  return result;
+}
+
+} // namespace util
+} // namespace executor
+} // namespace torch
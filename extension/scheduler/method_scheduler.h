@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/method.h>
+
+namespace torch {
+namespace executor {
+namespace util {
+
+/**
+ * Cooperatively interleaves the execution of several loaded Methods on a
+ * single thread, using `Method::experimental_step()`.
+ *
+ * Each call to `run_slice()` picks the pending task with the highest
+ * priority, breaking ties by the earliest deadline and then by submission
+ * order, and steps its Method until the time slice elapses or the next
+ * instruction is a delegate call. A task submitted between slices is
+ * therefore picked up within one slice, so a high-priority interactive model
+ * can preempt a long-running background model without OS threads.
+ *
+ * Inputs must be set on a Method before it is submitted, and its outputs are
+ * valid once `run_slice()` reports the task as finished without error. A
+ * Method may only be in one pending task at a time. The scheduler is not
+ * thread-safe; on an MCU, submit from the main loop rather than from an
+ * interrupt handler.
+ *
+ * NOTE: Prototype API; subject to change.
+ */
+class MethodScheduler final {
+ public:
+  /// Returns a monotonically non-decreasing time in nanoseconds.
+  using Clock = uint64_t (*)();
+
+  /// The deadline of a task that has none.
+  static constexpr uint64_t kNoDeadline = UINT64_MAX;
+
+  /// What happened during a call to `run_slice()`.
+  struct SliceResult {
+    /// The id returned by `submit()` of the task that ran.
+    size_t task_id;
+    /// The number of steps executed.
+    size_t steps;
+    /// Whether the task is done, either successfully or with an error, and
+    /// has been removed from the scheduler.
+    bool finished;
+    /// Error::Ok, or the error of the step that failed the task.
+    Error error;
+    /// Whether the task finished after its deadline.
+    bool missed_deadline;
+  };
+
+  /**
+   * @param[in] time_slice_ns The time a task may run before yielding. A
+   *     slice always executes at least one step, so 0 executes exactly one.
+   * @param[in] clock The time source for slices and deadlines. Defaults to
+   *     the PAL, via `et_pal_current_ticks()`.
+   */
+  explicit MethodScheduler(uint64_t time_slice_ns, Clock clock = nullptr);
+
+  /**
+   * Adds a task that executes `method` from its start.
+   *
+   * @param[in] method The Method to execute. Must outlive the task.
+   * @param[in] priority Larger values run first.
+   * @param[in] deadline_ns The time, on the scheduler's clock, by which the
+   *     task should finish.
+   *
+   * @returns The id of the task, or Error::InvalidState if `method` is
+   *     already in a pending task.
+   */
+  __ET_NODISCARD Result<size_t> submit(
+      Method& method,
+      int32_t priority,
+      uint64_t deadline_ns = kNoDeadline);
+
+  /**
+   * Removes a task that has not started executing.
+   *
+   * @retval Error::Ok on success.
+   * @retval Error::NotFound if there is no pending task with that id.
+   * @retval Error::InvalidState if the task has started, since a Method can
+   *     not be reset mid-execution.
+   */
+  __ET_NODISCARD Error cancel(size_t task_id);
+
+  /// Returns the number of tasks that have not finished.
+  size_t num_pending() const {
+    return tasks_.size();
+  }
+
+  /**
+   * Runs one time slice of the most urgent pending task. A task that reaches
+   * the end of its Method is reset so that the Method can be submitted
+   * again.
+   *
+   * @returns What ran, or Error::NotFound if no task is pending.
+   */
+  __ET_NODISCARD Result<SliceResult> run_slice();
+
+ private:
+  struct Task {
+    size_t id;
+    Method* method;
+    int32_t priority;
+    uint64_t deadline_ns;
+    bool started;
+  };
+
+  /// Returns the index in tasks_ of the task to run next.
+  size_t pick_next() const;
+
+  const uint64_t time_slice_ns_;
+  const Clock clock_;
+  size_t next_task_id_ = 0;
+  std::vector<Task> tasks_;
+};
+
+} // namespace util
+} // namespace executor
+} // namespace torch
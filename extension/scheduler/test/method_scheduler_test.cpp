@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/scheduler/method_scheduler.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/executor/test/managed_memory_manager.h>
+#include <executorch/runtime/platform/assert.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/util/util.h>
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using torch::executor::Error;
+using torch::executor::Method;
+using torch::executor::Program;
+using torch::executor::Result;
+using torch::executor::testing::ManagedMemoryManager;
+using torch::executor::util::FileDataLoader;
+using torch::executor::util::MethodScheduler;
+
+constexpr size_t kDefaultNonConstMemBytes = 32 * 1024U;
+constexpr size_t kDefaultRuntimeMemBytes = 32 * 1024U;
+
+namespace {
+
+// A clock that only moves when the test says so.
+uint64_t fake_now_ns = 0;
+
+uint64_t fake_clock() {
+  return fake_now_ns;
+}
+
+// Runs slices until `task_id` finishes, and returns its last slice.
+MethodScheduler::SliceResult run_until_finished(
+    MethodScheduler& scheduler,
+    size_t task_id) {
+  while (true) {
+    Result<MethodScheduler::SliceResult> result = scheduler.run_slice();
+    ET_CHECK(result.ok());
+    if (result->task_id == task_id && result->finished) {
+      return result.get();
+    }
+  }
+}
+
+} // namespace
+
+class MethodSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+    fake_now_ns = 0;
+
+    add_ = load_method(std::getenv("ET_MODULE_ADD_PATH"), &add_mmm_);
+    linear_ = load_method(
+        std::getenv("ET_MODULE_LINEAR_CONSTANT_SEGMENT_PATH"), &linear_mmm_);
+  }
+
+  void TearDown() override {
+    for (auto& inputs : inputs_) {
+      torch::executor::util::FreeInputs(inputs);
+    }
+  }
+
+  std::unique_ptr<Method> load_method(
+      const char* path,
+      std::unique_ptr<ManagedMemoryManager>* mmm) {
+    Result<FileDataLoader> loader = FileDataLoader::from(path);
+    EXPECT_EQ(loader.error(), Error::Ok);
+    loaders_.push_back(
+        std::make_unique<FileDataLoader>(std::move(loader.get())));
+
+    Result<Program> program = Program::load(loaders_.back().get());
+    EXPECT_EQ(program.error(), Error::Ok);
+    programs_.push_back(std::make_unique<Program>(std::move(program.get())));
+
+    *mmm = std::make_unique<ManagedMemoryManager>(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method =
+        programs_.back()->load_method("forward", &(*mmm)->get());
+    EXPECT_EQ(method.error(), Error::Ok);
+    auto result = std::make_unique<Method>(std::move(method.get()));
+    inputs_.push_back(torch::executor::util::PrepareInputTensors(*result));
+    return result;
+  }
+
+  std::unique_ptr<Method> add_;
+  std::unique_ptr<Method> linear_;
+
+ private:
+  // Must outlive the methods.
+  std::vector<std::unique_ptr<FileDataLoader>> loaders_;
+  std::vector<std::unique_ptr<Program>> programs_;
+  std::unique_ptr<ManagedMemoryManager> add_mmm_;
+  std::unique_ptr<ManagedMemoryManager> linear_mmm_;
+  std::vector<exec_aten::ArrayRef<void*>> inputs_;
+};
+
+TEST_F(MethodSchedulerTest, RunSliceWithoutTasksFails) {
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  EXPECT_EQ(scheduler.run_slice().error(), Error::NotFound);
+}
+
+TEST_F(MethodSchedulerTest, MatchesExecute) {
+  ASSERT_EQ(add_->execute(), Error::Ok);
+  const auto& executed = add_->get_output(0).toTensor();
+  const auto* executed_data =
+      static_cast<const uint8_t*>(executed.const_data_ptr());
+  std::vector<uint8_t> expected(
+      executed_data, executed_data + executed.nbytes());
+  std::memset(executed.mutable_data_ptr(), 0, executed.nbytes());
+
+  // With a zero time slice, every slice executes a single step.
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  Result<size_t> task = scheduler.submit(*add_, /*priority=*/0);
+  ASSERT_EQ(task.error(), Error::Ok);
+  Result<MethodScheduler::SliceResult> first = scheduler.run_slice();
+  ASSERT_EQ(first.error(), Error::Ok);
+  EXPECT_EQ(first->task_id, task.get());
+  EXPECT_EQ(first->steps, 1);
+
+  MethodScheduler::SliceResult last = run_until_finished(scheduler, *task);
+  EXPECT_EQ(last.error, Error::Ok);
+  EXPECT_FALSE(last.missed_deadline);
+  EXPECT_EQ(scheduler.num_pending(), 0);
+
+  const auto& stepped = add_->get_output(0).toTensor();
+  ASSERT_EQ(stepped.nbytes(), expected.size());
+  EXPECT_EQ(
+      std::memcmp(stepped.const_data_ptr(), expected.data(), expected.size()),
+      0);
+
+  // The method was reset and can run again.
+  ASSERT_EQ(scheduler.submit(*add_, /*priority=*/0).error(), Error::Ok);
+  EXPECT_EQ(run_until_finished(scheduler, *task + 1).error, Error::Ok);
+}
+
+TEST_F(MethodSchedulerTest, HigherPriorityPreempts) {
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  Result<size_t> background = scheduler.submit(*linear_, /*priority=*/0);
+  ASSERT_EQ(background.error(), Error::Ok);
+  Result<MethodScheduler::SliceResult> slice = scheduler.run_slice();
+  ASSERT_EQ(slice.error(), Error::Ok);
+  EXPECT_EQ(slice->task_id, background.get());
+
+  // The urgent task runs to completion before the background one resumes.
+  Result<size_t> urgent = scheduler.submit(*add_, /*priority=*/1);
+  ASSERT_EQ(urgent.error(), Error::Ok);
+  bool finished = false;
+  while (!finished) {
+    Result<MethodScheduler::SliceResult> urgent_slice = scheduler.run_slice();
+    ASSERT_EQ(urgent_slice.error(), Error::Ok);
+    ASSERT_EQ(urgent_slice->task_id, urgent.get());
+    EXPECT_EQ(urgent_slice->error, Error::Ok);
+    finished = urgent_slice->finished;
+  }
+  EXPECT_EQ(run_until_finished(scheduler, *background).error, Error::Ok);
+}
+
+TEST_F(MethodSchedulerTest, EarlierDeadlineRunsFirst) {
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  Result<size_t> late = scheduler.submit(*linear_, 0, /*deadline_ns=*/200);
+  Result<size_t> early = scheduler.submit(*add_, 0, /*deadline_ns=*/100);
+  ASSERT_EQ(late.error(), Error::Ok);
+  ASSERT_EQ(early.error(), Error::Ok);
+
+  Result<MethodScheduler::SliceResult> slice = scheduler.run_slice();
+  ASSERT_EQ(slice.error(), Error::Ok);
+  EXPECT_EQ(slice->task_id, early.get());
+
+  // Finishing after the deadline is reported.
+  fake_now_ns = 150;
+  EXPECT_TRUE(run_until_finished(scheduler, *early).missed_deadline);
+  EXPECT_FALSE(run_until_finished(scheduler, *late).missed_deadline);
+}
+
+TEST_F(MethodSchedulerTest, TimeSliceBoundsSteps) {
+  // The clock never moves, so a nonzero slice runs the whole method.
+  MethodScheduler scheduler(/*time_slice_ns=*/1, fake_clock);
+  Result<size_t> task = scheduler.submit(*add_, /*priority=*/0);
+  ASSERT_EQ(task.error(), Error::Ok);
+  Result<MethodScheduler::SliceResult> slice = scheduler.run_slice();
+  ASSERT_EQ(slice.error(), Error::Ok);
+  EXPECT_TRUE(slice->finished);
+  EXPECT_EQ(slice->error, Error::Ok);
+}
+
+TEST_F(MethodSchedulerTest, SubmitPendingMethodFails) {
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  ASSERT_EQ(scheduler.submit(*add_, 0).error(), Error::Ok);
+  EXPECT_EQ(scheduler.submit(*add_, 1).error(), Error::InvalidState);
+  EXPECT_EQ(scheduler.num_pending(), 1);
+}
+
+TEST_F(MethodSchedulerTest, CancelOnlyBeforeStarting) {
+  MethodScheduler scheduler(/*time_slice_ns=*/0, fake_clock);
+  Result<size_t> first = scheduler.submit(*add_, /*priority=*/1);
+  Result<size_t> second = scheduler.submit(*linear_, /*priority=*/0);
+  ASSERT_EQ(first.error(), Error::Ok);
+  ASSERT_EQ(second.error(), Error::Ok);
+
+  ASSERT_EQ(scheduler.run_slice().error(), Error::Ok);
+  EXPECT_EQ(scheduler.cancel(*first), Error::InvalidState);
+  EXPECT_EQ(scheduler.cancel(*second), Error::Ok);
+  EXPECT_EQ(scheduler.cancel(*second), Error::NotFound);
+  EXPECT_EQ(scheduler.num_pending(), 1);
+}
@@ -1,15 +1,14 @@
-/*
- * Copyright (c) Meta Platforms, Inc. and affiliates.
- * All rights reserved.
- *
- * This source code is licensed under the BSD-style license found in the
- * LICENSE file in the root directory of this source tree.
- */
-
 #include <executorch/extension/training/optimizer/sgd.h>
 #include <executorch/kernels/test/FunctionHeaderWrapper.h> // Declares the operator
 
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
 #include <executorch/runtime/kernel/kernel_runtime_context.h>
 
 namespace torch {
@@ -17,6 +16,170 @@ namespace executor {
 namespace training {
 namespace optimizer {
 
+namespace {
+
+/**
+ * Allocates an uninitialized tensor with the shape and dtype of `like`, to
+ * hold its momentum. Freed by ~SGD().
+ */
+Tensor alloc_momentum_buffer(const Tensor& like) {
+  void* buf_ptr = malloc(like.nbytes());
+#ifdef USE_ATEN_LIB
+  std::vector<int64_t> sizes(like.sizes().begin(), like.sizes().end());
+  return torch::from_blob(buf_ptr, sizes, like.scalar_type());
+#else
+  TensorImpl* buf_impl = new TensorImpl(
+      like.scalar_type(),
+      like.sizes().size(),
+      const_cast<TensorImpl::SizesType*>(like.sizes().data()),
+      buf_ptr,
+      const_cast<TensorImpl::DimOrderType*>(like.dim_order().data()));
+  return Tensor(buf_impl);
+#endif
+}
+
+bool is_contiguous(const Tensor& t) {
+#ifdef USE_ATEN_LIB
+  return t.is_contiguous();
+#else
+  return is_contiguous_dim_order(t.dim_order().data(), t.dim());
+#endif
+}
+
+/// The hyperparameters of an update, converted to the dtype of the param.
+template <typename T>
+struct UpdateParams {
+  T lr;
+  T momentum;
+  T one_minus_dampening;
+  T weight_decay;
+  bool nesterov;
+  bool has_momentum;
+};
+
+/**
+ * Computes the SGD update of one element, or one vector of elements when V is
+ * a Vectorized<T>, and returns the new param value.
+ */
+template <typename T, typename V>
+inline V sgd_update_one(
+    const UpdateParams<T>& u,
+    const V& p,
+    V g,
+    V* buf,
+    bool init_buf) {
+  if (u.weight_decay != 0) {
+    g = g + V(u.weight_decay) * p;
+  }
+  if (u.has_momentum) {
+    *buf = init_buf ? g : V(u.momentum) * *buf + V(u.one_minus_dampening) * g;
+    g = u.nesterov ? g + V(u.momentum) * *buf : *buf;
+  }
+  return p - V(u.lr) * g;
+}
+
+/**
+ * Updates the `n` contiguous elements of a param in a single pass. `buf` is
+ * the momentum buffer, or nullptr without momentum; `init_buf` is true on
+ * the first step, when it has no momentum yet.
+ */
+template <typename T>
+void sgd_update(
+    const UpdateParams<T>& u,
+    T* p,
+    const T* g,
+    T* buf,
+    bool init_buf,
+    int64_t n) {
+  using Vec = executorch::vec::Vectorized<T>;
+  int64_t i = 0;
+  for (; i + Vec::size() <= n; i += Vec::size()) {
+    Vec v_buf = u.has_momentum && !init_buf ? Vec::loadu(buf + i) : Vec(0);
+    Vec v_p = sgd_update_one<T, Vec>(
+        u, Vec::loadu(p + i), Vec::loadu(g + i), &v_buf, init_buf);
+    v_p.store(p + i);
+    if (u.has_momentum) {
+      v_buf.store(buf + i);
+    }
+  }
+  for (; i < n; ++i) {
+    T s_buf = u.has_momentum && !init_buf ? buf[i] : T(0);
+    p[i] = sgd_update_one<T, T>(u, p[i], g[i], &s_buf, init_buf);
+    if (u.has_momentum) {
+      buf[i] = s_buf;
+    }
+  }
+}
+
+/// A param update of the fused path, gathered before running them.
+struct PendingUpdate {
+  Tensor param;
+  Tensor grad;
+  Tensor momentum_buffer;
+  bool init_buf;
+  const SGDOptions* options;
+};
+
+template <typename T>
+UpdateParams<T> make_update_params(const SGDOptions& options) {
+  return UpdateParams<T>{
+      static_cast<T>(options.lr()),
+      static_cast<T>(options.momentum()),
+      static_cast<T>(1 - options.dampening()),
+      static_cast<T>(options.weight_decay()),
+      options.nesterov(),
+      options.momentum() != 0};
+}
+
+void run_update(const PendingUpdate& update) {
+  const SGDOptions& options = *update.options;
+  const bool has_momentum = options.momentum() != 0;
+  if (update.param.scalar_type() == ScalarType::Float) {
+    sgd_update<float>(
+        make_update_params<float>(options),
+        update.param.mutable_data_ptr<float>(),
+        update.grad.const_data_ptr<float>(),
+        has_momentum ? update.momentum_buffer.mutable_data_ptr<float>()
+                     : nullptr,
+        update.init_buf,
+        update.param.numel());
+  } else {
+    sgd_update<double>(
+        make_update_params<double>(options),
+        update.param.mutable_data_ptr<double>(),
+        update.grad.const_data_ptr<double>(),
+        has_momentum ? update.momentum_buffer.mutable_data_ptr<double>()
+                     : nullptr,
+        update.init_buf,
+        update.param.numel());
+  }
+}
+
+template <typename T>
+void sgd_update_rows(
+    T lr,
+    T* p,
+    const int64_t* indices,
+    const T* values,
+    int64_t num_indices,
+    int64_t row_size) {
+  using Vec = executorch::vec::Vectorized<T>;
+  const Vec v_lr(lr);
+  for (int64_t k = 0; k < num_indices; ++k) {
+    T* row = p + indices[k] * row_size;
+    const T* g = values + k * row_size;
+    int64_t i = 0;
+    for (; i + Vec::size() <= row_size; i += Vec::size()) {
+      (Vec::loadu(row + i) - v_lr * Vec::loadu(g + i)).store(row + i);
+    }
+    for (; i < row_size; ++i) {
+      row[i] -= lr * g[i];
+    }
+  }
+}
+
+} // namespace
+
 bool SGDParamGroup::has_options() const {
   return options_ != nullptr;
 }
@@ -57,9 +220,20 @@ void SGD::add_param_group(const SGDParamGroup& param_group) {
   } else {
     param_group_.set_options(param_group.options().clone());
   }
+  const size_t group_index = param_groups_.size();
+  for (size_t i = 0; i < param_group_.param_names().size(); ++i) {
+    // If a name appears in multiple groups, the first one gets the updates.
+    param_index_.emplace(
+        param_group_.param_names()[i], std::make_pair(group_index, i));
+  }
   param_groups_.emplace_back(std::move(param_group_));
 }
 
+const std::pair<size_t, size_t>* SGD::find_param(const char* name) const {
+  auto it = param_index_.find(name);
+  return it == param_index_.end() ? nullptr : &it->second;
+}
+
 Error SGD::step(Span<const char*> gradient_names, Span<Tensor> gradient_data) {
   // check that the number of gradient names matches the number of gradients
   ET_CHECK_OR_RETURN_ERROR(
@@ -68,95 +242,198 @@ Error SGD::step(Span<const char*> gradient_names, Span<Tensor> gradient_data) {
       "Gradient names and gradients must have the same length.");
 
   RuntimeContext context;
-  for (auto& group : param_groups_) {
+  std::vector<PendingUpdate> fused_updates;
+  int64_t fused_numel = 0;
+  for (size_t j = 0; j < gradient_names.size(); j++) {
+    const std::pair<size_t, size_t>* index = find_param(gradient_names[j]);
+    if (index == nullptr) {
+      continue;
+    }
+    auto& group = param_groups_[index->first];
     auto& options = static_cast<SGDOptions&>(group.options());
     auto weight_decay = options.weight_decay();
     auto momentum = options.momentum();
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
 
-    for (int i = 0; i < group.param_names().size(); i++) {
-      for (int j = 0; j < gradient_names.size(); j++) {
-        // if param name and gradient name match, run the optimizer step
-        if (strcmp(group.param_names()[i], gradient_names[j]) == 0) {
-          auto d_p = gradient_data[j];
-          auto p = group.param_data()[i];
-          if (weight_decay != 0) {
-            // uses weight_decay specified and adds it to the gradient
-            torch::executor::aten::add_outf(context, d_p, p, weight_decay, d_p);
-            if (context.failure_state() != Error::Ok) {
-              return context.failure_state();
-            }
-          }
-          if (momentum != 0) {
-            Tensor buf(nullptr);
-            auto param_state = state_.find(p.unsafeGetTensorImpl());
-            // look for the momentum buffer for the given parameter. this is the
-            // momentum as of the previous epoch
-            if (param_state == state_.end()) {
-              // create a new momentum buffer if it doesn't exist. this memory
-              // needs to be freed when the optimizer is destroyed
-              void* buf_ptr = malloc(d_p.nbytes());
+    auto d_p = gradient_data[j];
+    auto p = group.param_data()[index->second];
 
-#ifdef USE_ATEN_LIB
-              std::vector<int64_t> sizes(
-                  d_p.sizes().begin(), d_p.sizes().end());
-              buf = torch::from_blob(buf_ptr, sizes, d_p.scalar_type());
-#else
-              TensorImpl* buf_impl = new TensorImpl(
-                  d_p.scalar_type(),
-                  d_p.sizes().size(),
-                  const_cast<TensorImpl::SizesType*>(d_p.sizes().data()),
-                  buf_ptr,
-                  const_cast<TensorImpl::DimOrderType*>(
-                      d_p.dim_order().data()));
-              buf = Tensor(buf_impl);
-#endif
-              torch::executor::aten::clone_outf(
-                  context, d_p, exec_aten::MemoryFormat::Contiguous, buf);
-              if (context.failure_state() != Error::Ok) {
-                return context.failure_state();
-              }
-
-              // save the state of the momentum buffer to be reused in later
-              // epochs
-              auto state = std::make_unique<SGDParamState>(buf);
-              state_[p.unsafeGetTensorImpl()] = std::move(state);
-            } else {
-              buf = static_cast<SGDParamState&>(*param_state->second)
-                        .momentum_buffer();
-
-              // update the momentum buffer and apply dampening
-              torch::executor::aten::mul_outf(context, buf, momentum, buf);
-              if (context.failure_state() != Error::Ok) {
-                return context.failure_state();
-              }
-              torch::executor::aten::add_outf(
-                  context, buf, d_p, 1 - dampening, buf);
-              if (context.failure_state() != Error::Ok) {
-                return context.failure_state();
-              }
-            }
-            if (nesterov) {
-              // apply nesterov momentum
-              torch::executor::aten::add_outf(context, d_p, buf, momentum, d_p);
-              if (context.failure_state() != Error::Ok) {
-                return context.failure_state();
-              }
-            } else {
-              d_p = buf;
-            }
-          }
-          // update the parameter using the gradient and learning rate
-          torch::executor::aten::add_outf(
-              context, p, d_p, -1 * options.lr(), p);
-          if (context.failure_state() != Error::Ok) {
-            return context.failure_state();
-          }
-          break;
+    const ScalarType dtype = p.scalar_type();
+    if ((dtype == ScalarType::Float || dtype == ScalarType::Double) &&
+        d_p.scalar_type() == dtype && d_p.numel() == p.numel() &&
+        is_contiguous(p) && is_contiguous(d_p)) {
+      PendingUpdate update{p, d_p, Tensor(nullptr), false, &options};
+      if (momentum != 0) {
+        auto param_state = state_.find(p.unsafeGetTensorImpl());
+        if (param_state == state_.end()) {
+          // The first step initializes the momentum buffer.
+          update.momentum_buffer = alloc_momentum_buffer(d_p);
+          update.init_buf = true;
+          state_[p.unsafeGetTensorImpl()] =
+              std::make_unique<SGDParamState>(update.momentum_buffer);
+        } else {
+          update.momentum_buffer = param_state->second->momentum_buffer();
+        }
+      }
+      fused_numel += p.numel();
+      fused_updates.push_back(update);
+      continue;
+    }
+
+    if (weight_decay != 0) {
+      // uses weight_decay specified and adds it to the gradient
+      torch::executor::aten::add_outf(context, d_p, p, weight_decay, d_p);
+      if (context.failure_state() != Error::Ok) {
+        return context.failure_state();
+      }
+    }
+    if (momentum != 0) {
+      Tensor buf(nullptr);
+      auto param_state = state_.find(p.unsafeGetTensorImpl());
+      // look for the momentum buffer for the given parameter. this is the
+      // momentum as of the previous epoch
+      if (param_state == state_.end()) {
+        // create a new momentum buffer if it doesn't exist. this memory
+        // needs to be freed when the optimizer is destroyed
+        buf = alloc_momentum_buffer(d_p);
+        torch::executor::aten::clone_outf(
+            context, d_p, exec_aten::MemoryFormat::Contiguous, buf);
+        if (context.failure_state() != Error::Ok) {
+          return context.failure_state();
+        }
+
+        // save the state of the momentum buffer to be reused in later
+        // epochs
+        auto state = std::make_unique<SGDParamState>(buf);
+        state_[p.unsafeGetTensorImpl()] = std::move(state);
+      } else {
+        buf = static_cast<SGDParamState&>(*param_state->second)
+                  .momentum_buffer();
+
+        // update the momentum buffer and apply dampening
+        torch::executor::aten::mul_outf(context, buf, momentum, buf);
+        if (context.failure_state() != Error::Ok) {
+          return context.failure_state();
         }
+        torch::executor::aten::add_outf(context, buf, d_p, 1 - dampening, buf);
+        if (context.failure_state() != Error::Ok) {
+          return context.failure_state();
+        }
+      }
+      if (nesterov) {
+        // apply nesterov momentum
+        torch::executor::aten::add_outf(context, d_p, buf, momentum, d_p);
+        if (context.failure_state() != Error::Ok) {
+          return context.failure_state();
+        }
+      } else {
+        d_p = buf;
       }
     }
+    // update the parameter using the gradient and learning rate
+    torch::executor::aten::add_outf(context, p, d_p, -1 * options.lr(), p);
+    if (context.failure_state() != Error::Ok) {
+      return context.failure_state();
+    }
+  }
+
+  if (!fused_updates.empty()) {
+    // Each update reads and writes only its own param and momentum buffer.
+    // The params differ in size, so threads claim them as they become free.
+    const int64_t num_updates = fused_updates.size();
+    parallel_for_each_chunk_dynamic(
+        0,
+        num_updates,
+        /*work_per_item=*/fused_numel / num_updates,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            run_update(fused_updates[i]);
+          }
+        });
+  }
+  return Error::Ok;
+}
+
+Error SGD::step_sparse(
+    Span<const char*> gradient_names,
+    Span<Tensor> gradient_indices,
+    Span<Tensor> gradient_values) {
+  ET_CHECK_OR_RETURN_ERROR(
+      gradient_names.size() == gradient_indices.size() &&
+          gradient_names.size() == gradient_values.size(),
+      InvalidState,
+      "Gradient names, indices and values must have the same length.");
+
+  for (size_t j = 0; j < gradient_names.size(); j++) {
+    const std::pair<size_t, size_t>* index = find_param(gradient_names[j]);
+    if (index == nullptr) {
+      continue;
+    }
+    auto& group = param_groups_[index->first];
+    const SGDOptions& options = group.options();
+    ET_CHECK_OR_RETURN_ERROR(
+        options.momentum() == 0 && options.weight_decay() == 0,
+        NotSupported,
+        "Sparse updates of %s do not support momentum or weight decay",
+        gradient_names[j]);
+
+    Tensor p = group.param_data()[index->second];
+    const Tensor& indices = gradient_indices[j];
+    const Tensor& values = gradient_values[j];
+    const ScalarType dtype = p.scalar_type();
+    ET_CHECK_OR_RETURN_ERROR(
+        dtype == ScalarType::Float || dtype == ScalarType::Double,
+        NotSupported,
+        "Sparse updates of %s require a Float or Double param",
+        gradient_names[j]);
+    ET_CHECK_OR_RETURN_ERROR(
+        p.dim() >= 1 && is_contiguous(p) && is_contiguous(values) &&
+            values.scalar_type() == dtype &&
+            indices.scalar_type() == ScalarType::Long && indices.dim() == 1,
+        InvalidArgument,
+        "Invalid sparse gradient for %s",
+        gradient_names[j]);
+
+    const int64_t num_rows = p.size(0);
+    const int64_t row_size = num_rows == 0 ? 0 : p.numel() / num_rows;
+    const int64_t num_indices = indices.numel();
+    ET_CHECK_OR_RETURN_ERROR(
+        values.numel() == num_indices * row_size,
+        InvalidArgument,
+        "Sparse gradient of %s has %" PRId64 " values, expected %" PRId64,
+        gradient_names[j],
+        static_cast<int64_t>(values.numel()),
+        num_indices * row_size);
+    const int64_t* index_data = indices.const_data_ptr<int64_t>();
+    for (int64_t k = 0; k < num_indices; ++k) {
+      ET_CHECK_OR_RETURN_ERROR(
+          index_data[k] >= 0 && index_data[k] < num_rows,
+          InvalidArgument,
+          "Sparse gradient index %" PRId64 " of %s is out of range [0, %" PRId64
+          ")",
+          index_data[k],
+          gradient_names[j],
+          num_rows);
+    }
+
+    if (dtype == ScalarType::Float) {
+      sgd_update_rows<float>(
+          static_cast<float>(options.lr()),
+          p.mutable_data_ptr<float>(),
+          index_data,
+          values.const_data_ptr<float>(),
+          num_indices,
+          row_size);
+    } else {
+      sgd_update_rows<double>(
+          options.lr(),
+          p.mutable_data_ptr<double>(),
+          index_data,
+          values.const_data_ptr<double>(),
+          num_indices,
+          row_size);
+    }
   }
   return Error::Ok;
 }
@@ -20,7 +20,9 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/span.h>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace torch {
@@ -219,6 +221,13 @@ class SGD {
    * The two spans must be of the same size. It is expected that the gradient in
    * 'gradient_data' at index 'i' represents the gradient calculated in the loss
    * function for the parameter with the name in 'gradient_names' at index 'i'.
+   * Gradients whose name matches no parameter are ignored.
+   *
+   * Float and Double parameters are updated in a single pass that applies the
+   * weight decay, momentum and learning rate together, without modifying the
+   * gradients, and different parameters are updated in parallel when built
+   * with a threadpool. Other dtypes are updated with the portable kernels,
+   * which write the intermediate results to the gradients.
    *
    * @param[in] gradient_names The names of the params that matches the gradient
    *   in 'gradient_data' at the same index.
@@ -227,10 +236,39 @@ class SGD {
    */
   Error step(Span<const char*> gradient_names, Span<Tensor> gradient_data);
 
+  /**
+   * Performs the optimization step for row-sparse gradients, e.g. those of an
+   * embedding table, updating only the rows of the parameters that have a
+   * gradient.
+   *
+   * For the param with the name in 'gradient_names' at index 'i', row
+   * 'gradient_indices[i][k]' of the param, i.e. its sub-tensor at that index of
+   * dimension 0, gets the gradient 'gradient_values[i][k]'. Repeated indices
+   * accumulate. Only Float and Double params in groups without momentum or
+   * weight decay are supported, since both would also have to update the rows
+   * without a gradient.
+   *
+   * @param[in] gradient_names The names of the params to update.
+   * @param[in] gradient_indices Long tensors of shape [n] with the rows of
+   *   each param that have a gradient.
+   * @param[in] gradient_values Tensors of shape [n, *row_shape] with the
+   *   gradients of those rows, with the dtype of the param.
+   */
+  Error step_sparse(
+      Span<const char*> gradient_names,
+      Span<Tensor> gradient_indices,
+      Span<Tensor> gradient_values);
+
  private:
+  /// Returns the (group, param) index of the named param, or nullptr.
+  const std::pair<size_t, size_t>* find_param(const char* name) const;
+
   std::vector<SGDParamGroup> param_groups_;
   std::unordered_map<void*, std::unique_ptr<SGDParamState>> state_;
   std::unique_ptr<SGDOptions> defaults_;
+  // Maps each param name to its (group, param) index, so that step() does
+  // not compare every gradient name against every param name.
+  std::unordered_map<std::string, std::pair<size_t, size_t>> param_index_;
 };
 
 } // namespace optimizer
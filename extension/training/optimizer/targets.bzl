@@ -33,6 +33,11 @@ def define_common_targets():
             exported_headers = [
                 "sgd.h",
             ],
+            deps = [
+                "//executorch/kernels/optimized:libvec",
+                "//executorch/kernels/portable/cpu/util:parallel_util",
+                "//executorch/runtime/core/exec_aten/util:dim_order_util" + aten_suffix,
+            ],
             exported_deps = [
                 "//executorch/runtime/kernel:kernel_runtime_context" + aten_suffix,
                 "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
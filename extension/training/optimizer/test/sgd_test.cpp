@@ -9,11 +9,14 @@
 #include <executorch/extension/training/optimizer/sgd.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/platform/runtime.h>
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 // @lint-ignore-every CLANGTIDY facebook-hte-CArray
 
 using namespace ::testing;
@@ -134,3 +137,118 @@ TEST_F(SGDOptimizerTest, SGDOptimizerComplex) {
   EXPECT_NEAR(p1[0], 0.540303, 0.1);
   EXPECT_NEAR(p2[0], 0.620909, 0.1);
 }
+
+TEST_F(SGDOptimizerTest, SGDOptimizerMomentumMatchesReference) {
+  TensorFactory<ScalarType::Float> tf;
+
+  // Long enough to cover both the vectorized loop and its tail.
+  constexpr int kNumel = 37;
+  std::vector<float> init(kNumel);
+  std::vector<float> grad(kNumel);
+  for (int i = 0; i < kNumel; ++i) {
+    init[i] = 0.1f * i - 1.0f;
+    grad[i] = 0.05f * (i % 7) - 0.2f;
+  }
+
+  const char* param_name[1] = {"param1"};
+  Span<const char*> param_names(param_name, 1);
+  Tensor param_data[1] = {tf.make({kNumel}, init)};
+  Span<Tensor> param_data_span(param_data, 1);
+
+  const double lr = 0.1, momentum = 0.9, dampening = 0.1, weight_decay = 0.01;
+  SGD optimizer(
+      param_names,
+      param_data_span,
+      SGDOptions{lr, momentum, dampening, weight_decay, true});
+
+  std::vector<float> ref_p = init;
+  std::vector<float> ref_buf(kNumel);
+  for (int step = 0; step < 5; ++step) {
+    Tensor grad_data[1] = {tf.make({kNumel}, grad)};
+    Span<Tensor> grad_data_span(grad_data, 1);
+    ASSERT_EQ(optimizer.step(param_names, grad_data_span), Error::Ok);
+
+    // The gradients are left untouched.
+    EXPECT_TENSOR_EQ(grad_data[0], tf.make({kNumel}, grad));
+
+    for (int i = 0; i < kNumel; ++i) {
+      float g = grad[i] + weight_decay * ref_p[i];
+      ref_buf[i] =
+          step == 0 ? g : momentum * ref_buf[i] + (1 - dampening) * g;
+      g = g + momentum * ref_buf[i];
+      ref_p[i] -= lr * g;
+    }
+  }
+  EXPECT_TENSOR_CLOSE(param_data_span[0], tf.make({kNumel}, ref_p));
+}
+
+TEST_F(SGDOptimizerTest, SGDOptimizerIgnoresUnknownGradients) {
+  TensorFactory<ScalarType::Float> tf;
+
+  const char* param_name[1] = {"param1"};
+  Span<const char*> param_names(param_name, 1);
+  Tensor param_data[1] = {tf.make({1, 1}, {1})};
+  Span<Tensor> param_data_span(param_data, 1);
+
+  SGD optimizer(param_names, param_data_span, SGDOptions{0.1});
+
+  const char* grad_name[2] = {"other", "param1"};
+  Span<const char*> grad_names(grad_name, 2);
+  Tensor grad_data[2] = {tf.make({1, 1}, {5}), tf.make({1, 1}, {-1})};
+  Span<Tensor> grad_data_span(grad_data, 2);
+
+  ASSERT_EQ(optimizer.step(grad_names, grad_data_span), Error::Ok);
+  EXPECT_TENSOR_CLOSE(param_data_span[0], tf.make({1, 1}, {1.1}));
+}
+
+TEST_F(SGDOptimizerTest, SGDOptimizerSparseUpdatesOnlyGivenRows) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  const char* param_name[1] = {"embedding"};
+  Span<const char*> param_names(param_name, 1);
+  Tensor param_data[1] = {tf.make({3, 2}, {1, 1, 2, 2, 3, 3})};
+  Span<Tensor> param_data_span(param_data, 1);
+
+  SGD optimizer(param_names, param_data_span, SGDOptions{0.5});
+
+  // Row 2 appears twice, so its gradients accumulate.
+  Tensor indices[1] = {tf_long.make({3}, {2, 0, 2})};
+  Tensor values[1] = {tf.make({3, 2}, {1, 2, 2, 2, 1, 0})};
+  ASSERT_EQ(
+      optimizer.step_sparse(
+          param_names, Span<Tensor>(indices, 1), Span<Tensor>(values, 1)),
+      Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      param_data_span[0], tf.make({3, 2}, {0, 0, 2, 2, 2, 2}));
+}
+
+TEST_F(SGDOptimizerTest, SGDOptimizerSparseRejectsInvalidGradients) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  const char* param_name[1] = {"embedding"};
+  Span<const char*> param_names(param_name, 1);
+  Tensor param_data[1] = {tf.make({2, 2}, {1, 1, 2, 2})};
+  Span<Tensor> param_data_span(param_data, 1);
+
+  SGD optimizer(param_names, param_data_span, SGDOptions{0.5});
+  SGD momentum_optimizer(
+      param_names, param_data_span, SGDOptions{0.5, /*momentum=*/0.9});
+
+  Tensor out_of_range[1] = {tf_long.make({1}, {2})};
+  Tensor in_range[1] = {tf_long.make({1}, {1})};
+  Tensor values[1] = {tf.make({1, 2}, {1, 1})};
+  EXPECT_EQ(
+      optimizer.step_sparse(
+          param_names, Span<Tensor>(out_of_range, 1), Span<Tensor>(values, 1)),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      momentum_optimizer.step_sparse(
+          param_names, Span<Tensor>(in_range, 1), Span<Tensor>(values, 1)),
+      Error::NotSupported);
+
+  // Nothing was updated.
+  EXPECT_TENSOR_EQ(param_data_span[0], tf.make({2, 2}, {1, 1, 2, 2}));
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+/**
+ * @file
+ *
+ * Helpers for the Helium (M-profile Vector Extension) paths of the Cortex-M
+ * kernels. ET_CORTEX_M_USE_MVE_FLOAT is defined when compiling for a core with
+ * floating-point Helium, e.g. Cortex-M55 or Cortex-M85; otherwise the kernels
+ * fall back to scalar code, so that they also build and run on the host.
+ */
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 2)
+#include <arm_mve.h>
+#define ET_CORTEX_M_USE_MVE_FLOAT 1
+#endif
+
+namespace torch {
+namespace executor {
+namespace native {
+namespace cortex_m {
+
+#ifdef ET_CORTEX_M_USE_MVE_FLOAT
+
+/**
+ * Returns e^x for each lane, to within a few ulp of std::exp() over the range
+ * where the result is a normal float; inputs beyond it are clamped.
+ */
+inline float32x4_t vexpq_f32(float32x4_t x) {
+  x = vminnmq_f32(x, vdupq_n_f32(88.0f));
+  x = vmaxnmq_f32(x, vdupq_n_f32(-87.3365447504019f));
+
+  // e^x = 2^n * e^r, with n = round(x / ln(2)) and |r| <= ln(2) / 2. ln(2) is
+  // split in a high and a low part to compute r accurately.
+  const float32x4_t n = vrndnq_f32(vmulq_n_f32(x, 1.44269504088896341f));
+  float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(0.693359375f));
+  r = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+
+  // Degree 6 polynomial for e^r.
+  float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+  p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(1.0f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(1.0f), p, r);
+
+  // 2^n, built from its exponent bits.
+  const int32x4_t exponent =
+      vshlq_n_s32(vaddq_n_s32(vcvtq_s32_f32(n), 127), 23);
+  return vmulq_f32(p, vreinterpretq_f32_s32(exponent));
+}
+
+#endif // ET_CORTEX_M_USE_MVE_FLOAT
+
+} // namespace cortex_m
+} // namespace native
+} // namespace executor
+} // namespace torch
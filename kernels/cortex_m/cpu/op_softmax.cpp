@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include <executorch/kernels/cortex_m/cpu/helium_utils.h>
+#include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+/**
+ * Softmax over `dim_size` elements `stride` apart, in float.
+ */
+template <typename CTYPE>
+void softmax_strided(
+    const CTYPE* in,
+    CTYPE* out,
+    int64_t dim_size,
+    int64_t stride) {
+  float max_in = in[0];
+  for (int64_t d = 1; d < dim_size; ++d) {
+    max_in = std::max(max_in, float(in[d * stride]));
+  }
+  float sum = 0;
+  for (int64_t d = 0; d < dim_size; ++d) {
+    sum += std::exp(float(in[d * stride]) - max_in);
+  }
+  for (int64_t d = 0; d < dim_size; ++d) {
+    out[d * stride] = std::exp(float(in[d * stride]) - max_in) / sum;
+  }
+}
+
+/**
+ * Softmax over `dim_size` contiguous floats, which is what softmax over the
+ * last dimension computes, e.g. in attention and classifier heads.
+ */
+void softmax_contiguous(const float* in, float* out, int64_t dim_size) {
+#ifdef ET_CORTEX_M_USE_MVE_FLOAT
+  const int32_t n = static_cast<int32_t>(dim_size);
+  float max_in = in[0];
+  for (int32_t i = 0; i < n; i += 4) {
+    const mve_pred16_t p = vctp32q(n - i);
+    max_in = vmaxnmvq_p_f32(max_in, vldrwq_z_f32(in + i, p), p);
+  }
+  // Store the exponentials in the output, then scale them.
+  float32x4_t v_sum = vdupq_n_f32(0);
+  for (int32_t i = 0; i < n; i += 4) {
+    const mve_pred16_t p = vctp32q(n - i);
+    const float32x4_t v = cortex_m::vexpq_f32(
+        vsubq_n_f32(vldrwq_z_f32(in + i, p), max_in));
+    vstrwq_p_f32(out + i, v, p);
+    v_sum = vaddq_m_f32(v_sum, v_sum, v, p);
+  }
+  const float sum = vgetq_lane_f32(v_sum, 0) + vgetq_lane_f32(v_sum, 1) +
+      vgetq_lane_f32(v_sum, 2) + vgetq_lane_f32(v_sum, 3);
+  const float inv_sum = 1.0f / sum;
+  for (int32_t i = 0; i < n; i += 4) {
+    const mve_pred16_t p = vctp32q(n - i);
+    vstrwq_p_f32(out + i, vmulq_n_f32(vldrwq_z_f32(out + i, p), inv_sum), p);
+  }
+#else
+  softmax_strided<float>(in, out, dim_size, /*stride=*/1);
+#endif
+}
+
+} // namespace
+
+// _softmax.out(Tensor self, int dim, bool half_to_float, *, Tensor(a!) out)
+// -> Tensor(a!)
+Tensor& cortex_m_softmax_out(
+    RuntimeContext& ctx,
+    const Tensor& self,
+    int64_t dim,
+    bool half_to_float,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_softmax_args(self, dim, half_to_float, out),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, resize_tensor(out, self.sizes()) == Error::Ok, InvalidArgument, out);
+
+  if (self.numel() == 0) {
+    return out;
+  }
+
+  // Adjust for negative dim
+  dim = dim < 0 ? dim + nonzero_dim(self) : dim;
+
+  // A 0-dim tensor is treated as a single softmax over one element.
+  const int64_t dim_size = self.dim() == 0 ? 1 : self.size(dim);
+  int64_t outer_size = 1;
+  int64_t inner_size = 1;
+  for (int64_t i = 0; i < dim; ++i) {
+    outer_size *= self.size(i);
+  }
+  for (int64_t i = dim + 1; i < self.dim(); ++i) {
+    inner_size *= self.size(i);
+  }
+
+  ET_SWITCH_FLOATH_TYPES(self.scalar_type(), ctx, "_softmax.out", CTYPE, [&]() {
+    const CTYPE* in_data = self.const_data_ptr<CTYPE>();
+    CTYPE* out_data = out.mutable_data_ptr<CTYPE>();
+    for (int64_t o = 0; o < outer_size; ++o) {
+      for (int64_t i = 0; i < inner_size; ++i) {
+        const int64_t base = o * dim_size * inner_size + i;
+        if (std::is_same<CTYPE, float>::value && inner_size == 1) {
+          softmax_contiguous(
+              reinterpret_cast<const float*>(in_data + base),
+              reinterpret_cast<float*>(out_data + base),
+              dim_size);
+        } else {
+          softmax_strided<CTYPE>(
+              in_data + base, out_data + base, dim_size, inner_size);
+        }
+      }
+    }
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
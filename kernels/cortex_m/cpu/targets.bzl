@@ -0,0 +1,58 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.cxx_library(
+        name = "helium_utils",
+        srcs = [],
+        exported_headers = ["helium_utils.h"],
+        visibility = ["//executorch/kernels/cortex_m/..."],
+    )
+
+    runtime.cxx_library(
+        name = "op_add",
+        srcs = ["op_add.cpp"],
+        visibility = ["//executorch/kernels/cortex_m/..."],
+        deps = [
+            ":helium_utils",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        # kernels often have helpers with no prototypes just disabling the warning here as the headers
+        # are codegend and linked in later
+        compiler_flags = ["-Wno-missing-prototypes"],
+        # link_whole is necessary because the operators register themselves
+        # via static initializers that run at program startup.
+        # @lint-ignore BUCKLINT link_whole
+        link_whole = True,
+    )
+
+    runtime.cxx_library(
+        name = "op_softmax",
+        srcs = ["op_softmax.cpp"],
+        visibility = ["//executorch/kernels/cortex_m/..."],
+        deps = [
+            ":helium_utils",
+            "//executorch/kernels/portable/cpu/util:activation_ops_util",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        compiler_flags = ["-Wno-missing-prototypes"],
+        # @lint-ignore BUCKLINT link_whole
+        link_whole = True,
+    )
+
+    runtime.cxx_library(
+        name = "cpu_cortex_m",
+        srcs = [],
+        visibility = ["//executorch/kernels/..."],
+        exported_deps = [
+            ":op_add",
+            ":op_softmax",
+        ],
+    )
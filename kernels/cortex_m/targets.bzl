@@ -0,0 +1,54 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+load("@fbsource//xplat/executorch/codegen:codegen.bzl", "et_operator_library", "executorch_generated_lib")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    runtime.export_file(
+        name = "cortex_m.yaml",
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "cortex_m_operators",
+        srcs = [],
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        exported_deps = [
+            "//executorch/kernels/cortex_m/cpu:cpu_cortex_m",
+        ],
+    )
+
+    et_operator_library(
+        name = "cortex_m_oplist",
+        ops_schema_yaml_target = ":cortex_m.yaml",
+        visibility = [
+            "@EXECUTORCH_CLIENTS",
+        ],
+    )
+
+    # Used mainly for operator testing. In practice, a generated lib specific
+    # to a project should be created that contains only the required operators
+    # for a particular model.
+    executorch_generated_lib(
+        name = "generated_lib",
+        deps = [
+            ":cortex_m_oplist",
+            ":cortex_m_operators",
+        ],
+        functions_yaml_target = ":cortex_m.yaml",
+        define_static_targets = True,
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+    )
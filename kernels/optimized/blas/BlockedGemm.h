@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/kernels/optimized/utils/math_utils.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+namespace executorch {
+namespace cpublas {
+
+// Register tile of the micro kernel: kGemmMr rows by kGemmNr columns of C.
+// The rows are contiguous in column-major C, so the kGemmMr accumulators of
+// a column map onto vector registers.
+constexpr int64_t kGemmMr = 8;
+constexpr int64_t kGemmNr = 4;
+
+// Cache blocking. A task packs a kGemmMc x kGemmKc block of A (sized for L2)
+// and a kGemmKc x kGemmNc block of B, and keeps a kGemmMc x kGemmNc block of
+// C in the accumulation type until the whole depth has been reduced.
+constexpr int64_t kGemmMc = 64;
+constexpr int64_t kGemmKc = 128;
+constexpr int64_t kGemmNc = 64;
+
+static_assert(kGemmMc % kGemmMr == 0, "kGemmMc must be a multiple of kGemmMr");
+static_assert(kGemmNc % kGemmNr == 0, "kGemmNc must be a multiple of kGemmNr");
+
+// Products smaller than this many multiply-adds are left to the simple
+// kernels, whose lack of packing wins on tiny matrices.
+constexpr int64_t kBlockedGemmMinWork = 32 * 32 * 32;
+
+// The type the blocked kernel accumulates in: float for float and the
+// reduced precision types, double for double.
+template <typename scalar_t>
+using blocked_gemm_opmath_t = typename std::conditional<
+    std::is_same<scalar_t, double>::value,
+    double,
+    float>::type;
+
+inline bool use_blocked_gemm(int64_t m, int64_t n, int64_t k) {
+  return m * n * k >= kBlockedGemmMinWork;
+}
+
+namespace internal {
+
+// Packs rows [0, mc) and depths [0, kc) of op(A) into panels of kGemmMr rows,
+// each stored depth-major, zero-padding the last panel.
+template <typename scalar_t, typename opmath_t>
+inline void pack_gemm_a(
+    bool transa,
+    int64_t mc,
+    int64_t kc,
+    const scalar_t* a,
+    int64_t lda,
+    opmath_t* packed) {
+  for (int64_t i0 = 0; i0 < mc; i0 += kGemmMr) {
+    const int64_t mr = std::min(kGemmMr, mc - i0);
+    for (int64_t l = 0; l < kc; ++l) {
+      for (int64_t i = 0; i < kGemmMr; ++i) {
+        const scalar_t* src = transa ? a + (i0 + i) * lda + l
+                                     : a + l * lda + (i0 + i);
+        *packed++ = i < mr ? static_cast<opmath_t>(*src) : opmath_t(0);
+      }
+    }
+  }
+}
+
+// Packs depths [0, kc) and columns [0, nc) of op(B) into panels of kGemmNr
+// columns, each stored depth-major, zero-padding the last panel.
+template <typename scalar_t, typename opmath_t>
+inline void pack_gemm_b(
+    bool transb,
+    int64_t kc,
+    int64_t nc,
+    const scalar_t* b,
+    int64_t ldb,
+    opmath_t* packed) {
+  for (int64_t j0 = 0; j0 < nc; j0 += kGemmNr) {
+    const int64_t nr = std::min(kGemmNr, nc - j0);
+    for (int64_t l = 0; l < kc; ++l) {
+      for (int64_t j = 0; j < kGemmNr; ++j) {
+        const scalar_t* src = transb ? b + l * ldb + (j0 + j)
+                                     : b + (j0 + j) * ldb + l;
+        *packed++ = j < nr ? static_cast<opmath_t>(*src) : opmath_t(0);
+      }
+    }
+  }
+}
+
+// Adds the product of one packed A panel and one packed B panel to the
+// kGemmMr x kGemmNr tile of the column-major accumulator `c`.
+template <typename opmath_t>
+inline void gemm_micro_kernel(
+    int64_t kc,
+    const opmath_t* a_panel,
+    const opmath_t* b_panel,
+    opmath_t* c,
+    int64_t ldc) {
+  opmath_t acc[kGemmNr][kGemmMr] = {};
+  for (int64_t l = 0; l < kc; ++l) {
+    const opmath_t* a_l = a_panel + l * kGemmMr;
+    const opmath_t* b_l = b_panel + l * kGemmNr;
+    for (int64_t j = 0; j < kGemmNr; ++j) {
+      const opmath_t b_lj = b_l[j];
+      for (int64_t i = 0; i < kGemmMr; ++i) {
+        acc[j][i] += a_l[i] * b_lj;
+      }
+    }
+  }
+  for (int64_t j = 0; j < kGemmNr; ++j) {
+    for (int64_t i = 0; i < kGemmMr; ++i) {
+      c[j * ldc + i] += acc[j][i];
+    }
+  }
+}
+
+// Computes the mc x nc block of C at (i0, j0) over the full depth.
+template <typename scalar_t, typename opmath_t>
+inline void gemm_blocked_tile(
+    bool transa,
+    bool transb,
+    int64_t i0,
+    int64_t j0,
+    int64_t mc,
+    int64_t nc,
+    int64_t k,
+    opmath_t alpha,
+    const scalar_t* a,
+    int64_t lda,
+    const scalar_t* b,
+    int64_t ldb,
+    opmath_t beta,
+    scalar_t* c,
+    int64_t ldc) {
+  opmath_t packed_a[kGemmMc * kGemmKc];
+  opmath_t packed_b[kGemmKc * kGemmNc];
+  opmath_t acc[kGemmMc * kGemmNc] = {};
+
+  for (int64_t l0 = 0; l0 < k; l0 += kGemmKc) {
+    const int64_t kc = std::min(kGemmKc, k - l0);
+    const scalar_t* a_block = transa ? a + i0 * lda + l0 : a + l0 * lda + i0;
+    const scalar_t* b_block = transb ? b + l0 * ldb + j0 : b + j0 * ldb + l0;
+    pack_gemm_a(transa, mc, kc, a_block, lda, packed_a);
+    pack_gemm_b(transb, kc, nc, b_block, ldb, packed_b);
+
+    for (int64_t jr = 0; jr < nc; jr += kGemmNr) {
+      const opmath_t* b_panel = packed_b + (jr / kGemmNr) * kc * kGemmNr;
+      for (int64_t ir = 0; ir < mc; ir += kGemmMr) {
+        const opmath_t* a_panel = packed_a + (ir / kGemmMr) * kc * kGemmMr;
+        gemm_micro_kernel(
+            kc, a_panel, b_panel, acc + jr * kGemmMc + ir, kGemmMc);
+      }
+    }
+  }
+
+  for (int64_t j = 0; j < nc; ++j) {
+    scalar_t* c_j = c + (j0 + j) * ldc + i0;
+    const opmath_t* acc_j = acc + j * kGemmMc;
+    for (int64_t i = 0; i < mc; ++i) {
+      // Like BLAS, beta == 0 overwrites C without reading it, so that NaNs
+      // in uninitialized outputs do not propagate.
+      const opmath_t prev =
+          beta == opmath_t(0) ? opmath_t(0) : beta * opmath_t(c_j[i]);
+      c_j[i] = static_cast<scalar_t>(prev + alpha * acc_j[i]);
+    }
+  }
+}
+
+} // namespace internal
+
+/**
+ * Cache-blocked, register-tiled GEMM over column-major matrices:
+ * c = alpha * op(a) @ op(b) + beta * c, where op(a) is m x k and op(b) is
+ * k x n. Operands are packed into the accumulation type, so reduced
+ * precision inputs accumulate in float. The blocks of C are split across the
+ * threadpool when the kernels are built with ET_USE_THREADPOOL.
+ */
+template <typename scalar_t>
+void gemm_blocked(
+    bool transa,
+    bool transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    blocked_gemm_opmath_t<scalar_t> alpha,
+    const scalar_t* a,
+    int64_t lda,
+    const scalar_t* b,
+    int64_t ldb,
+    blocked_gemm_opmath_t<scalar_t> beta,
+    scalar_t* c,
+    int64_t ldc) {
+  if (m <= 0 || n <= 0) {
+    return;
+  }
+  const int64_t num_m_blocks = utils::divup(m, kGemmMc);
+  const int64_t num_n_blocks = utils::divup(n, kGemmNc);
+  torch::executor::parallel_for_each_chunk(
+      0,
+      num_m_blocks * num_n_blocks,
+      kGemmMc * kGemmNc * std::max<int64_t>(k, 1),
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          const int64_t i0 = (block % num_m_blocks) * kGemmMc;
+          const int64_t j0 = (block / num_m_blocks) * kGemmNc;
+          internal::gemm_blocked_tile(
+              transa,
+              transb,
+              i0,
+              j0,
+              std::min(kGemmMc, m - i0),
+              std::min(kGemmNc, n - j0),
+              k,
+              alpha,
+              a,
+              lda,
+              b,
+              ldb,
+              beta,
+              c,
+              ldc);
+        }
+      });
+}
+
+} // namespace cpublas
+} // namespace executorch
@@ -97,7 +97,18 @@ void gemm(
       c, &ldc_);
 #endif // ET_BUILD_FOR_APPLE
 #else
-  using acc_type = utils::compute_dtype<float>;
+  if (use_blocked_gemm(m, n, k)) {
+    gemm_blocked(
+        is_transposed(transa), is_transposed(transb),
+        m, n, k,
+        alpha,
+        a, lda,
+        b, ldb,
+        beta,
+        c, ldc);
+    return;
+  }
+  using acc_type = utils::compute_dtype<double>;
   gemm_impl(
       transa, transb,
       m, n, k,
@@ -138,6 +149,17 @@ void gemm(
 #endif // ET_BUILD_FOR_APPLE
 
 #else
+  if (use_blocked_gemm(m, n, k)) {
+    gemm_blocked(
+        is_transposed(transa), is_transposed(transb),
+        m, n, k,
+        alpha,
+        a, lda,
+        b, ldb,
+        beta,
+        c, ldc);
+    return;
+  }
   using acc_type = utils::compute_dtype<float>;
   gemm_impl(
       transa, transb,
@@ -161,6 +183,19 @@ void gemm(
     Half *c, int64_t ldc) {
   normalize_last_dims(transa, transb, m, n, k, &lda, &ldb, &ldc);
 
+  if (use_blocked_gemm(m, n, k)) {
+    // Accumulates in float rather than Half.
+    gemm_blocked(
+        is_transposed(transa), is_transposed(transb),
+        m, n, k,
+        static_cast<float>(alpha),
+        a, lda,
+        b, ldb,
+        static_cast<float>(beta),
+        c, ldc);
+    return;
+  }
+
   using acc_type = utils::compute_dtype<Half>;
   gemm_impl(
       transa, transb,
@@ -12,6 +12,7 @@
 #include <type_traits>
 
 #include <executorch/kernels/optimized/blas/BlasKernel.h>
+#include <executorch/kernels/optimized/blas/BlockedGemm.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 
 namespace executorch {
@@ -25,6 +26,10 @@ enum class TransposeType {
   ConjTranspose,
 };
 
+inline bool is_transposed(TransposeType trans) {
+  return trans != TransposeType::NoTranspose;
+}
+
 // clang-format off
 void normalize_last_dims(
     TransposeType transa, TransposeType transb,
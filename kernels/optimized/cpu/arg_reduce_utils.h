@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace internal {
+
+// Rows at least this long are split into blocks that threads reduce
+// separately before their results are combined.
+constexpr int64_t kArgReduceBlockSize = 16384;
+constexpr int64_t kArgReduceMaxBlocks = 64;
+
+// Columns reduced together when the reduced dim is not the innermost one.
+constexpr int64_t kArgReduceColumnBlock = 256;
+
+/**
+ * Whether `v` replaces the current extremum `acc`, as in the portable
+ * kernels: the first NaN wins, otherwise the first largest (or smallest)
+ * value.
+ */
+template <bool kIsMax, typename CTYPE>
+inline bool arg_reduce_replaces(const CTYPE v, const CTYPE acc) {
+  return !std::isnan(acc) && (std::isnan(v) || (kIsMax ? v > acc : v < acc));
+}
+
+/**
+ * Returns the position of the extremum of the `n` contiguous elements at
+ * `data`. The extremum is found with vector comparisons, NaNs included, and
+ * then a second pass looks for its first occurrence.
+ */
+template <bool kIsMax, typename CTYPE>
+int64_t arg_reduce_contiguous(const CTYPE* const data, const int64_t n) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  const CTYPE extremum = kIsMax
+      ? executorch::vec::reduce_all<CTYPE>(
+            [](const Vec& a, const Vec& b) {
+              return executorch::vec::maximum(a, b);
+            },
+            data,
+            n)
+      : executorch::vec::reduce_all<CTYPE>(
+            [](const Vec& a, const Vec& b) {
+              return executorch::vec::minimum(a, b);
+            },
+            data,
+            n);
+  if (std::isnan(extremum)) {
+    for (int64_t i = 0; i < n; ++i) {
+      if (std::isnan(data[i])) {
+        return i;
+      }
+    }
+  } else {
+    for (int64_t i = 0; i < n; ++i) {
+      if (data[i] == extremum) {
+        return i;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Like arg_reduce_contiguous(), but splits long rows into blocks that are
+ * reduced in parallel. The block results are combined in order, so ties
+ * still go to the first occurrence.
+ */
+template <bool kIsMax, typename CTYPE>
+int64_t arg_reduce_long_row(const CTYPE* const data, const int64_t n) {
+  const int64_t num_blocks = std::min(
+      kArgReduceMaxBlocks,
+      (n + kArgReduceBlockSize - 1) / kArgReduceBlockSize);
+  const int64_t block_size = (n + num_blocks - 1) / num_blocks;
+  int64_t block_index[kArgReduceMaxBlocks];
+  parallel_for_each_chunk(
+      0, num_blocks, block_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t b = begin; b < end; ++b) {
+          const int64_t start = b * block_size;
+          const int64_t size = std::min(block_size, n - start);
+          block_index[b] = start +
+              (size > 0 ? arg_reduce_contiguous<kIsMax>(data + start, size)
+                        : 0);
+        }
+      });
+  int64_t best = block_index[0];
+  for (int64_t b = 1; b < num_blocks; ++b) {
+    if (b * block_size < n &&
+        arg_reduce_replaces<kIsMax>(data[block_index[b]], data[best])) {
+      best = block_index[b];
+    }
+  }
+  return best;
+}
+
+/**
+ * Writes to `out` the positions of the extrema of `in` along `dim`, or over
+ * all of its elements if `dim` is not set, with the semantics of the
+ * portable argmax and argmin kernels.
+ *
+ * Rows along an innermost dim are reduced with vector comparisons, one row
+ * per thread or, for few long rows, blocks of a row per thread. Otherwise
+ * the rows of a block of columns are reduced together, in parallel over the
+ * blocks.
+ */
+template <bool kIsMax, typename CTYPE>
+void arg_reduce(
+    const Tensor& in,
+    const exec_aten::optional<int64_t>& dim,
+    Tensor& out) {
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  long* const out_data = out.mutable_data_ptr<long>();
+
+  int64_t outer = 1;
+  int64_t dim_size = in.numel();
+  int64_t inner = 1;
+  if (dim.has_value() && in.dim() > 0) {
+    const int64_t d = dim.value() < 0 ? dim.value() + in.dim() : dim.value();
+    outer = getLeadingDims(in, d);
+    dim_size = in.size(d);
+    inner = getTrailingDims(in, d);
+  }
+
+  if (inner == 1) {
+    if (outer < kArgReduceMaxBlocks && dim_size >= 2 * kArgReduceBlockSize) {
+      for (int64_t i = 0; i < outer; ++i) {
+        out_data[i] =
+            arg_reduce_long_row<kIsMax>(in_data + i * dim_size, dim_size);
+      }
+      return;
+    }
+    parallel_for_each_chunk(
+        0, outer, dim_size, [&](const int64_t begin, const int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            out_data[i] =
+                arg_reduce_contiguous<kIsMax>(in_data + i * dim_size, dim_size);
+          }
+        });
+    return;
+  }
+
+  const int64_t num_column_blocks =
+      (inner + kArgReduceColumnBlock - 1) / kArgReduceColumnBlock;
+  parallel_for_each_chunk(
+      0,
+      outer * num_column_blocks,
+      dim_size * std::min(inner, kArgReduceColumnBlock),
+      [&](const int64_t begin, const int64_t end) {
+        CTYPE acc[kArgReduceColumnBlock];
+        for (int64_t task = begin; task < end; ++task) {
+          const int64_t i = task / num_column_blocks;
+          const int64_t c0 = (task % num_column_blocks) * kArgReduceColumnBlock;
+          const int64_t columns = std::min(kArgReduceColumnBlock, inner - c0);
+          const CTYPE* const slice = in_data + i * dim_size * inner + c0;
+          long* const out_row = out_data + i * inner + c0;
+          std::copy(slice, slice + columns, acc);
+          std::fill(out_row, out_row + columns, 0);
+          for (int64_t j = 1; j < dim_size; ++j) {
+            const CTYPE* const row = slice + j * inner;
+            for (int64_t c = 0; c < columns; ++c) {
+              if (arg_reduce_replaces<kIsMax>(row[c], acc[c])) {
+                acc[c] = row[c];
+                out_row[c] = j;
+              }
+            }
+          }
+        }
+      });
+}
+
+} // namespace internal
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/distance_util.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace internal {
+
+// The bytes of the second operand's rows a tile of pairwise_distances()
+// keeps in cache while it is compared against every row of the first.
+constexpr int64_t kDistanceTileBytes = 32 * 1024;
+
+/**
+ * The p-norm distances with vectorized kernels. Each one computes
+ * `compute(a, b, m, p)`, the distance between the `m` contiguous elements at
+ * `a` and at `b`, with `m` > 0.
+ */
+template <typename CTYPE>
+struct L1Distance {
+  static CTYPE compute(const CTYPE* a, const CTYPE* b, int64_t m, CTYPE) {
+    using Vec = executorch::vec::Vectorized<CTYPE>;
+    return executorch::vec::map2_reduce_all<CTYPE>(
+        [](const Vec& x, const Vec& y) { return (x - y).abs(); },
+        [](const Vec& x, const Vec& y) { return x + y; },
+        a,
+        b,
+        m);
+  }
+};
+
+template <typename CTYPE>
+struct L2Distance {
+  static CTYPE compute(const CTYPE* a, const CTYPE* b, int64_t m, CTYPE) {
+    using Vec = executorch::vec::Vectorized<CTYPE>;
+    return std::sqrt(executorch::vec::map2_reduce_all<CTYPE>(
+        [](const Vec& x, const Vec& y) { return (x - y) * (x - y); },
+        [](const Vec& x, const Vec& y) { return x + y; },
+        a,
+        b,
+        m));
+  }
+};
+
+// NaNs propagate, as in ATen.
+template <typename CTYPE>
+struct LinfDistance {
+  static CTYPE compute(const CTYPE* a, const CTYPE* b, int64_t m, CTYPE) {
+    using Vec = executorch::vec::Vectorized<CTYPE>;
+    return executorch::vec::map2_reduce_all<CTYPE>(
+        [](const Vec& x, const Vec& y) { return (x - y).abs(); },
+        [](const Vec& x, const Vec& y) {
+          return executorch::vec::maximum(x, y);
+        },
+        a,
+        b,
+        m);
+  }
+};
+
+/// Any other p, with the scalar Norm of the portable kernels.
+template <typename CTYPE, typename Norm>
+struct NormDistance {
+  static CTYPE compute(const CTYPE* a, const CTYPE* b, int64_t m, CTYPE p) {
+    CTYPE agg = 0;
+    for (int64_t k = 0; k < m; ++k) {
+      agg = Norm::reduce(agg, Norm::map(std::abs(a[k] - b[k]), p));
+    }
+    return Norm::finish(agg, p);
+  }
+};
+
+/**
+ * Calls `fn` with the distance functor for the p-norm `p`.
+ */
+template <typename CTYPE, typename Fn>
+void dispatch_distance(const double p, const Fn& fn) {
+  if (p == 0.0) {
+    fn(NormDistance<CTYPE, L0<CTYPE>>());
+  } else if (p == 1.0) {
+    fn(L1Distance<CTYPE>());
+  } else if (p == 2.0) {
+    fn(L2Distance<CTYPE>());
+  } else if (p == INFINITY) {
+    fn(LinfDistance<CTYPE>());
+  } else {
+    fn(NormDistance<CTYPE, Lp<CTYPE>>());
+  }
+}
+
+/**
+ * Returns how many rows of `m` elements make up a tile of the second
+ * operand.
+ */
+template <typename CTYPE>
+int64_t distance_tile_rows(const int64_t m) {
+  return std::max<int64_t>(
+      1, kDistanceTileBytes / (std::max<int64_t>(1, m) * sizeof(CTYPE)));
+}
+
+/**
+ * Writes to row i of `out` (of stride `ld_out`) the distances between row i
+ * of the `n1` rows at `x1` and each of the `n2` rows at `x2`, all rows
+ * holding `m` > 0 contiguous elements. The rows of `x2` are visited a tile
+ * at a time, so that each tile is read from cache for every row of `x1`.
+ */
+template <typename CTYPE, typename Dist>
+void pairwise_distances(
+    const CTYPE* const x1,
+    const int64_t n1,
+    const CTYPE* const x2,
+    const int64_t n2,
+    const int64_t m,
+    const CTYPE p,
+    CTYPE* const out,
+    const int64_t ld_out) {
+  const int64_t tile = distance_tile_rows<CTYPE>(m);
+  for (int64_t j0 = 0; j0 < n2; j0 += tile) {
+    const int64_t j1 = std::min(n2, j0 + tile);
+    for (int64_t i = 0; i < n1; ++i) {
+      const CTYPE* const row_i = x1 + i * m;
+      CTYPE* const out_row = out + i * ld_out;
+      for (int64_t j = j0; j < j1; ++j) {
+        out_row[j] = Dist::compute(row_i, x2 + j * m, m, p);
+      }
+    }
+  }
+}
+
+} // namespace internal
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <type_traits>
+
+#include <executorch/kernels/optimized/cpu/moments_utils.h>
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace internal {
+
+/// The activation applied to the output of a normalization, if any.
+enum class NormActivation {
+  kNone,
+  kRelu,
+  kSilu,
+};
+
+/**
+ * Parses the `activation` argument of the fused normalization operators.
+ * Returns false if it names no supported activation.
+ */
+inline bool parse_norm_activation(
+    const exec_aten::string_view name,
+    NormActivation* const activation) {
+  if (name == "none") {
+    *activation = NormActivation::kNone;
+  } else if (name == "relu") {
+    *activation = NormActivation::kRelu;
+  } else if (name == "silu") {
+    *activation = NormActivation::kSilu;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Calls `fn` with a std::integral_constant holding `activation`, so that the
+ * normalization loops are instantiated once per activation instead of
+ * branching per element.
+ */
+template <typename Fn>
+void dispatch_norm_activation(const NormActivation activation, const Fn& fn) {
+  switch (activation) {
+    case NormActivation::kNone:
+      fn(std::integral_constant<NormActivation, NormActivation::kNone>());
+      return;
+    case NormActivation::kRelu:
+      fn(std::integral_constant<NormActivation, NormActivation::kRelu>());
+      return;
+    case NormActivation::kSilu:
+      fn(std::integral_constant<NormActivation, NormActivation::kSilu>());
+      return;
+  }
+}
+
+template <NormActivation kActivation>
+struct ApplyNormActivation;
+
+template <>
+struct ApplyNormActivation<NormActivation::kNone> {
+  template <typename Vec>
+  static Vec apply(const Vec& x) {
+    return x;
+  }
+};
+
+template <>
+struct ApplyNormActivation<NormActivation::kRelu> {
+  // NaNs propagate, as in relu.out.
+  template <typename Vec>
+  static Vec apply(const Vec& x) {
+    return executorch::vec::maximum(x, Vec(0));
+  }
+};
+
+template <>
+struct ApplyNormActivation<NormActivation::kSilu> {
+  // x * sigmoid(x)
+  template <typename Vec>
+  static Vec apply(const Vec& x) {
+    return x / (Vec(1) + x.neg().exp());
+  }
+};
+
+/**
+ * Writes activation(x * scale + shift) for the `n` elements at `x` to `y`.
+ */
+template <NormActivation kActivation, typename CTYPE>
+void scale_shift_activation(
+    const CTYPE* const x,
+    CTYPE* const y,
+    const int64_t n,
+    const CTYPE scale,
+    const CTYPE shift) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  executorch::vec::map<CTYPE>(
+      [scale, shift](const Vec& v) {
+        return ApplyNormActivation<kActivation>::apply(
+            v * Vec(scale) + Vec(shift));
+      },
+      y,
+      x,
+      n);
+}
+
+/**
+ * Group normalization of a contiguous N x C x HxW input, followed by
+ * `kActivation`. The moments of every group come from the Welford
+ * RowwiseMoments(); the groups are split across threads. `mean_data` and
+ * `rstd_data` receive the N x group statistics unless null.
+ */
+template <typename CTYPE, NormActivation kActivation>
+void group_norm(
+    const Tensor& input,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    const int64_t N,
+    const int64_t C,
+    const int64_t HxW,
+    const int64_t group,
+    const CTYPE eps,
+    Tensor& out,
+    CTYPE* const mean_data,
+    CTYPE* const rstd_data) {
+  const int64_t leading = N * group;
+  const int64_t D = C / group;
+  const int64_t inner_size = D * HxW;
+
+  if (leading == 0) {
+    return;
+  }
+
+  if (inner_size == 0) {
+    for (int64_t i = 0; i < leading; ++i) {
+      if (mean_data != nullptr) {
+        mean_data[i] = static_cast<CTYPE>(0);
+      }
+      if (rstd_data != nullptr) {
+        rstd_data[i] = static_cast<CTYPE>(NAN);
+      }
+    }
+    return;
+  }
+
+  const CTYPE* const input_data = input.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+  const CTYPE* const weight_data =
+      weight.has_value() ? weight.value().const_data_ptr<CTYPE>() : nullptr;
+  const CTYPE* const bias_data =
+      bias.has_value() ? bias.value().const_data_ptr<CTYPE>() : nullptr;
+
+  parallel_for_each_chunk(
+      0, leading, 2 * inner_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const CTYPE* const x = input_data + i * inner_size;
+          CTYPE* const y = out_data + i * inner_size;
+
+          CTYPE mean_value;
+          CTYPE rstd_value;
+          std::tie(mean_value, rstd_value) = RowwiseMoments(x, inner_size);
+          rstd_value = CTYPE(1) / std::sqrt(rstd_value + eps);
+
+          const int64_t g = i % group;
+          for (int64_t j = 0; j < D; ++j) {
+            const int64_t ch = g * D + j;
+            const CTYPE scale = rstd_value *
+                (weight_data == nullptr ? CTYPE(1) : weight_data[ch]);
+            const CTYPE shift = -scale * mean_value +
+                (bias_data == nullptr ? CTYPE(0) : bias_data[ch]);
+            scale_shift_activation<kActivation>(
+                x + j * HxW, y + j * HxW, HxW, scale, shift);
+          }
+
+          if (mean_data != nullptr) {
+            mean_data[i] = mean_value;
+          }
+          if (rstd_data != nullptr) {
+            rstd_data[i] = rstd_value;
+          }
+        }
+      });
+}
+
+/**
+ * Checks that `in` and `out` are both contiguous or both channels last, the
+ * layouts batch_norm() supports, and sets `channels_last` accordingly.
+ */
+inline bool check_batch_norm_layout(
+    const Tensor& in,
+    const Tensor& out,
+    bool* const channels_last) {
+  *channels_last =
+      is_channels_last_dim_order(in.dim_order().data(), in.dim_order().size());
+  ET_LOG_AND_RETURN_IF_FALSE(
+      *channels_last ||
+      is_contiguous_dim_order(in.dim_order().data(), in.dim_order().size()));
+  ET_LOG_AND_RETURN_IF_FALSE(
+      *channels_last ==
+      is_channels_last_dim_order(
+          out.dim_order().data(), out.dim_order().size()));
+  return true;
+}
+
+/**
+ * Inference batch normalization with the running statistics, followed by
+ * `kActivation`. Contiguous inputs are split across threads by channel
+ * plane; channels-last inputs by pixel, a vector of channels at a time.
+ */
+template <typename CTYPE, NormActivation kActivation>
+void batch_norm(
+    const Tensor& in,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    const Tensor& running_mean,
+    const Tensor& running_var,
+    const double eps,
+    const bool channels_last,
+    Tensor& out) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  const size_t C_dim = in.dim() >= 1 ? 1 : 0;
+  const int64_t C = in.size(C_dim);
+  const int64_t outer = getLeadingDims(in, C_dim);
+  const int64_t inner = getTrailingDims(in, C_dim);
+
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+  const CTYPE* const mean_data = running_mean.const_data_ptr<CTYPE>();
+  const CTYPE* const var_data = running_var.const_data_ptr<CTYPE>();
+  const CTYPE* const weight_data =
+      weight.has_value() ? weight.value().const_data_ptr<CTYPE>() : nullptr;
+  const CTYPE* const bias_data =
+      bias.has_value() ? bias.value().const_data_ptr<CTYPE>() : nullptr;
+
+  // out = in * scale + shift, folding the statistics and affine parameters
+  // of channel c.
+  const auto scale_and_shift = [&](int64_t c, CTYPE& scale, CTYPE& shift) {
+    CTYPE invstd = 1.0 / std::sqrt(var_data[c] + eps);
+    scale = invstd * (weight_data != nullptr ? weight_data[c] : CTYPE(1));
+    shift =
+        (bias_data != nullptr ? bias_data[c] : CTYPE(0)) - mean_data[c] * scale;
+  };
+
+  if (channels_last) {
+    // Every pixel holds the C channels contiguously. Each chunk of pixels
+    // folds the parameters of a block of channels once, then applies them to
+    // all of its pixels.
+    constexpr int64_t kBlock = 64;
+    const int64_t num_pixels = outer * inner;
+    parallel_for_each_chunk(
+        0, num_pixels, C, [&](const int64_t begin, const int64_t end) {
+          CTYPE scale[kBlock];
+          CTYPE shift[kBlock];
+          for (int64_t c0 = 0; c0 < C; c0 += kBlock) {
+            const int64_t block = std::min(kBlock, C - c0);
+            for (int64_t c = 0; c < block; ++c) {
+              scale_and_shift(c0 + c, scale[c], shift[c]);
+            }
+            for (int64_t i = begin; i < end; ++i) {
+              executorch::vec::map3<CTYPE>(
+                  [](const Vec& x, const Vec& s, const Vec& b) {
+                    return ApplyNormActivation<kActivation>::apply(x * s + b);
+                  },
+                  out_data + i * C + c0,
+                  in_data + i * C + c0,
+                  scale,
+                  shift,
+                  block);
+            }
+          }
+        });
+    return;
+  }
+
+  parallel_for_each_chunk(
+      0, outer * C, inner, [&](const int64_t begin, const int64_t end) {
+        for (int64_t plane = begin; plane < end; ++plane) {
+          CTYPE scale, shift;
+          scale_and_shift(plane % C, scale, shift);
+          scale_shift_activation<kActivation>(
+              in_data + plane * inner,
+              out_data + plane * inner,
+              inner,
+              scale,
+              shift);
+        }
+      });
+}
+
+} // namespace internal
+
+} // namespace native
+} // namespace executor
+} // namespace torch
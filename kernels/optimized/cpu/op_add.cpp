@@ -81,8 +81,7 @@ Tensor& opt_add_out(
   ScalarType b_type = b.scalar_type();
   ScalarType out_type = out.scalar_type();
 
-  if (a_type == b_type && a_type == out_type && a.sizes().equals(b.sizes()) &&
-      a_type != ScalarType::Half) {
+  if (a_type == b_type && a_type == out_type && a.sizes().equals(b.sizes())) {
     // Resize for dynamic shape
     auto error = resize_tensor(out, a.sizes());
     ET_KERNEL_CHECK_MSG(
@@ -92,6 +91,22 @@ Tensor& opt_add_out(
         out,
         "Failed to resize output tensor.");
 
+    if (a_type == ScalarType::Half) {
+      // Computed in float, like the broadcasting path below.
+      float alpha_val;
+      ET_KERNEL_CHECK(
+          ctx, utils::extract_scalar(alpha, &alpha_val), InvalidArgument, out);
+
+      using fVec = executorch::vec::Vectorized<float>;
+      executorch::vec::map2<exec_aten::Half>(
+          [alpha_val](fVec x, fVec y) { return x + fVec(alpha_val) * y; },
+          out.mutable_data_ptr<exec_aten::Half>(),
+          a.const_data_ptr<exec_aten::Half>(),
+          b.const_data_ptr<exec_aten::Half>(),
+          out.numel());
+      return out;
+    }
+
     ET_SWITCH_REALB_TYPES(a_type, ctx, "add.out", CTYPE, [&]() {
       CTYPE alpha_val;
       ET_KERNEL_CHECK(
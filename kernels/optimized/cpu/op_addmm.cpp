@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/portable/cpu/scalar_utils.h>
+#include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+#include <cstring>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using Scalar = exec_aten::Scalar;
+
+// addmm.out(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1,
+// Scalar alpha=1, Tensor(a!) out) -> Tensor(a!)
+Tensor& opt_addmm_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_addmm_args(in, mat1, mat2, beta, alpha, out),
+      InvalidArgument,
+      out);
+
+  size_t output_ndim = 0;
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  get_mm_out_target_size(mat1, mat2, output_sizes, &output_ndim);
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {output_sizes, output_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, tensor_is_broadcastable_to(in, out), InvalidArgument, out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  ScalarType alpha_dtype = utils::get_scalar_dtype(alpha);
+  ScalarType beta_dtype = utils::get_scalar_dtype(beta);
+  ET_SWITCH_REAL_TYPES_AND(
+      Half, in.scalar_type(), ctx, "addmm.out", CTYPE, [&]() {
+        ET_SWITCH_SCALAR_OBJ_TYPES(
+            alpha_dtype, ctx, "addmm.out", ALPHA_T, [&]() {
+              ET_SWITCH_SCALAR_OBJ_TYPES(
+                  beta_dtype, ctx, "addmm.out", BETA_T, [&]() {
+                    using executorch::cpublas::TransposeType;
+                    const int64_t m = mat1.size(0);
+                    const int64_t k = mat1.size(1);
+                    const int64_t n = mat2.size(1);
+                    const CTYPE alpha_val =
+                        convert<CTYPE>(alpha.to<ALPHA_T>());
+                    const CTYPE beta_val = convert<CTYPE>(beta.to<BETA_T>());
+                    CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+                    // Without broadcasting, gemm adds beta * in itself once
+                    // in has been copied into out.
+                    const bool in_matches_out = out.sizes() == in.sizes();
+                    if (in_matches_out) {
+                      std::memcpy(
+                          out_data, in.const_data_ptr<CTYPE>(), out.nbytes());
+                    }
+
+                    // See op_mm.cpp for the row-major to column-major swap.
+                    // clang-format off
+                    executorch::cpublas::gemm(
+                        TransposeType::NoTranspose, TransposeType::NoTranspose,
+                        n, m, k,
+                        alpha_val,
+                        mat2.const_data_ptr<CTYPE>(), n,
+                        mat1.const_data_ptr<CTYPE>(), k,
+                        in_matches_out ? beta_val : static_cast<CTYPE>(0),
+                        out_data, n);
+                    // clang-format on
+
+                    if (!in_matches_out) {
+                      apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+                          [beta_val](const CTYPE val_out, const CTYPE val_in) {
+                            return val_out + val_in * beta_val;
+                          },
+                          out,
+                          in,
+                          out);
+                    }
+                  });
+            });
+      });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
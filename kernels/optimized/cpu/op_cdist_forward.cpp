@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/cpu/distance_utils.h>
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/distance_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using exec_aten::optional;
+using exec_aten::Tensor;
+
+namespace {
+
+inline ArrayRef<Tensor::SizesType> get_batch_sizes(const Tensor& tensor) {
+  return {tensor.sizes().data(), tensor.sizes().size() - 2};
+}
+
+/**
+ * Whether the p = 2 distances are computed from the matrix product, following
+ * ATen: compute_mode 1 always uses it, 2 never does, and the default (unset
+ * or 0) uses it once either operand has more than 25 rows.
+ */
+bool use_mm_for_euclid_dist(
+    const double p,
+    const optional<int64_t>& compute_mode,
+    const int64_t P,
+    const int64_t R) {
+  if (p != 2.0) {
+    return false;
+  }
+  const int64_t mode = compute_mode.has_value() ? compute_mode.value() : 0;
+  return mode == 1 || (mode == 0 && (P > 25 || R > 25));
+}
+
+/**
+ * Locates the matrices of x1 and x2 that batch `b` of `out` is computed
+ * from, broadcasting the batch dims.
+ */
+class CdistBatches {
+ public:
+  CdistBatches(const Tensor& x1, const Tensor& x2, const Tensor& out)
+      : x1_(x1),
+        x2_(x2),
+        out_(out),
+        x1_is_broadcasted_(!get_batch_sizes(out).equals(get_batch_sizes(x1))),
+        x2_is_broadcasted_(!get_batch_sizes(out).equals(get_batch_sizes(x2))),
+        x1_inner_size_(x1.size(x1.dim() - 2) * x1.size(x1.dim() - 1)),
+        x2_inner_size_(x2.size(x2.dim() - 2) * x2.size(x2.dim() - 1)),
+        out_inner_size_(out.size(out.dim() - 2) * out.size(out.dim() - 1)) {}
+
+  size_t numel() const {
+    return out_.numel() / out_inner_size_;
+  }
+
+  void get_bases(const size_t b, size_t* x1_base, size_t* x2_base) const {
+    *x1_base = b * x1_inner_size_;
+    *x2_base = b * x2_inner_size_;
+    if (x1_is_broadcasted_ || x2_is_broadcasted_) {
+      size_t out_base_coord[kTensorDimensionLimit];
+      delinearize_index(
+          b * out_inner_size_, out_, out_base_coord, kTensorDimensionLimit);
+      if (x1_is_broadcasted_) {
+        *x1_base = linearize_access_indexes(out_base_coord, out_.dim(), x1_);
+      }
+      if (x2_is_broadcasted_) {
+        *x2_base = linearize_access_indexes(out_base_coord, out_.dim(), x2_);
+      }
+    }
+  }
+
+ private:
+  const Tensor& x1_;
+  const Tensor& x2_;
+  const Tensor& out_;
+  const bool x1_is_broadcasted_;
+  const bool x2_is_broadcasted_;
+  const size_t x1_inner_size_;
+  const size_t x2_inner_size_;
+  const size_t out_inner_size_;
+};
+
+/**
+ * Computes every distance directly. The rows of all batches are split
+ * across threads.
+ */
+template <typename CTYPE, typename Dist>
+void cdist_direct(
+    const Tensor& x1,
+    const Tensor& x2,
+    Tensor& out,
+    const double p) {
+  const CdistBatches batches(x1, x2, out);
+  const CTYPE* const x1_data = x1.const_data_ptr<CTYPE>();
+  const CTYPE* const x2_data = x2.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+  const int64_t P = x1.size(x1.dim() - 2);
+  const int64_t R = x2.size(x2.dim() - 2);
+  const int64_t M = x1.size(x1.dim() - 1);
+
+  parallel_for_each_chunk(
+      0,
+      batches.numel() * P,
+      R * M,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t row = begin; row < end;) {
+          const int64_t b = row / P;
+          const int64_t i = row % P;
+          const int64_t rows = std::min(end - row, P - i);
+          size_t x1_base, x2_base;
+          batches.get_bases(b, &x1_base, &x2_base);
+          internal::pairwise_distances<CTYPE, Dist>(
+              x1_data + x1_base + i * M,
+              rows,
+              x2_data + x2_base,
+              R,
+              M,
+              static_cast<CTYPE>(p),
+              out_data + (b * P + i) * R,
+              R);
+          row += rows;
+        }
+      });
+}
+
+/**
+ * Computes the p = 2 distances as sqrt(|a|^2 + |b|^2 - 2 a.b), with the dot
+ * products of each batch from a single GEMM. This is much faster for many
+ * rows but loses precision for nearby points, hence compute_mode. Returns
+ * false if the row norms could not be allocated.
+ */
+template <typename CTYPE>
+bool cdist_euclidean_mm(
+    RuntimeContext& ctx,
+    const Tensor& x1,
+    const Tensor& x2,
+    Tensor& out) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  using executorch::cpublas::TransposeType;
+
+  const int64_t P = x1.size(x1.dim() - 2);
+  const int64_t R = x2.size(x2.dim() - 2);
+  const int64_t M = x1.size(x1.dim() - 1);
+
+  Result<void*> norms_mem = ctx.allocate_temp((P + R) * sizeof(CTYPE));
+  if (!norms_mem.ok()) {
+    return false;
+  }
+  CTYPE* const x1_norms = static_cast<CTYPE*>(norms_mem.get());
+  CTYPE* const x2_norms = x1_norms + P;
+
+  const CdistBatches batches(x1, x2, out);
+  const CTYPE* const x1_data = x1.const_data_ptr<CTYPE>();
+  const CTYPE* const x2_data = x2.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+  const auto squared_norms =
+      [M](const CTYPE* const x, const int64_t n, CTYPE* const norms) {
+        parallel_for_each_chunk(
+            0, n, M, [&](const int64_t begin, const int64_t end) {
+              for (int64_t i = begin; i < end; ++i) {
+                norms[i] = executorch::vec::map_reduce_all<CTYPE>(
+                    [](const Vec& v) { return v * v; },
+                    [](const Vec& a, const Vec& b) { return a + b; },
+                    x + i * M,
+                    M);
+              }
+            });
+      };
+
+  for (size_t b = 0; b < batches.numel(); ++b) {
+    size_t x1_base, x2_base;
+    batches.get_bases(b, &x1_base, &x2_base);
+    const CTYPE* const a = x1_data + x1_base;
+    const CTYPE* const c = x2_data + x2_base;
+    CTYPE* const out_b = out_data + b * P * R;
+
+    squared_norms(a, P, x1_norms);
+    squared_norms(c, R, x2_norms);
+
+    // out = -2 x1 @ x2^T, i.e. in column-major terms out^T = -2 x2 @ x1^T
+    // with x2 stored transposed. The GEMM splits its own work across
+    // threads.
+    // clang-format off
+    executorch::cpublas::gemm(
+        TransposeType::Transpose, TransposeType::NoTranspose,
+        R, P, M,
+        static_cast<CTYPE>(-2),
+        c, M,
+        a, M,
+        static_cast<CTYPE>(0),
+        out_b, R);
+    // clang-format on
+
+    parallel_for_each_chunk(
+        0, P, R, [&](const int64_t begin, const int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const Vec x1_norm(x1_norms[i]);
+            CTYPE* const out_row = out_b + i * R;
+            executorch::vec::map2<CTYPE>(
+                [x1_norm](const Vec& dot, const Vec& x2_norm) {
+                  return executorch::vec::maximum(
+                             dot + x1_norm + x2_norm, Vec(0))
+                      .sqrt();
+                },
+                out_row,
+                out_row,
+                x2_norms,
+                R);
+          }
+        });
+  }
+  return true;
+}
+
+} // namespace
+
+Tensor& opt_cdist_forward_out(
+    RuntimeContext& ctx,
+    const Tensor& x1,
+    const Tensor& x2,
+    double p,
+    optional<int64_t> compute_mode,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_cdist_args(x1, x2, p, compute_mode, out),
+      InvalidArgument,
+      out);
+
+  Tensor::SizesType target_sizes[kTensorDimensionLimit];
+  size_t target_ndim = 0;
+
+  ET_KERNEL_CHECK(
+      ctx,
+      get_broadcast_target_size(
+          {x1.sizes().data(), x1.sizes().size() - 2},
+          {x2.sizes().data(), x2.sizes().size() - 2},
+          target_sizes,
+          kTensorDimensionLimit,
+          &target_ndim) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  target_ndim += 2;
+  target_sizes[target_ndim - 2] = x1.size(x1.dim() - 2);
+  target_sizes[target_ndim - 1] = x2.size(x2.dim() - 2);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  ScalarType out_type = out.scalar_type();
+  constexpr auto name = "_cdist_forward.out";
+
+  ET_SWITCH_FLOAT_TYPES(out_type, ctx, name, CTYPE, [&] {
+    // If the last dimension of x1 (which is equal to the last dimension of
+    // x2) has size 0, then the output is filled with 0s.
+    if (x1.numel() == 0) {
+      CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+      std::fill(out_data, out_data + out.numel(), static_cast<CTYPE>(0));
+      return;
+    }
+    if (use_mm_for_euclid_dist(
+            p, compute_mode, x1.size(x1.dim() - 2), x2.size(x2.dim() - 2)) &&
+        cdist_euclidean_mm<CTYPE>(ctx, x1, x2, out)) {
+      return;
+    }
+    internal::dispatch_distance<CTYPE>(p, [&](auto dist) {
+      cdist_direct<CTYPE, decltype(dist)>(x1, x2, out, p);
+    });
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
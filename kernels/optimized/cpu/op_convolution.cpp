@@ -0,0 +1,1030 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/operator_registry.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using ScalarType = exec_aten::ScalarType;
+using IntArrayRef = exec_aten::ArrayRef<int64_t>;
+
+namespace {
+
+using executorch::cpublas::TransposeType;
+
+// Winograd only pays for its transforms when both channel counts are large
+// enough for the batched products to dominate.
+constexpr int64_t kWinogradMinChannels = 8;
+
+/**
+ * A 2D convolution problem. 1D convolutions are described with a height of
+ * one. Strides are in elements and come from the dim order of each tensor,
+ * so contiguous and channels-last tensors are both described exactly.
+ */
+struct Conv2dParams {
+  int64_t N;
+  int64_t in_C;
+  int64_t in_H;
+  int64_t in_W;
+  int64_t out_C;
+  int64_t out_H;
+  int64_t out_W;
+  int64_t w_H;
+  int64_t w_W;
+  int64_t groups;
+  int64_t in_C_per_group;
+  int64_t out_C_per_group;
+
+  int64_t stride_y;
+  int64_t stride_x;
+  int64_t padding_y;
+  int64_t padding_x;
+  int64_t dilation_y;
+  int64_t dilation_x;
+
+  exec_aten::StridesType in_strides[4];
+  exec_aten::StridesType w_strides[4];
+  exec_aten::StridesType out_strides[4];
+
+  // True if the channel is the fastest moving dim (NHWC).
+  bool in_channels_last;
+  bool w_channels_last;
+  bool out_channels_last;
+
+  int64_t out_size() const {
+    return out_H * out_W;
+  }
+
+  // Depth of the im2col product: the receptive field of one output.
+  int64_t patch_size() const {
+    return in_C_per_group * w_H * w_W;
+  }
+};
+
+void get_strides_4d(
+    const Tensor& t,
+    exec_aten::SizesType* sizes,
+    exec_aten::StridesType* strides) {
+  exec_aten::DimOrderType dim_order[kTensorDimensionLimit];
+  if (t.dim() == 3) {
+    size_t ndim = 0;
+    get_unsqueezed_sizes(t, 2, sizes, ndim);
+    get_unsqueezed_dim_order(t, 2, dim_order);
+  } else {
+    for (size_t d = 0; d < 4; ++d) {
+      sizes[d] = t.size(d);
+      dim_order[d] = t.dim_order()[d];
+    }
+  }
+  dim_order_to_stride_nocheck(sizes, dim_order, 4, strides);
+}
+
+Conv2dParams make_conv2d_params(
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& out,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    int64_t groups) {
+  Conv2dParams p;
+  exec_aten::SizesType in_sizes[kTensorDimensionLimit];
+  exec_aten::SizesType w_sizes[kTensorDimensionLimit];
+  exec_aten::SizesType out_sizes[kTensorDimensionLimit];
+  get_strides_4d(in, in_sizes, p.in_strides);
+  get_strides_4d(weight, w_sizes, p.w_strides);
+  get_strides_4d(out, out_sizes, p.out_strides);
+
+  p.N = in_sizes[0];
+  p.in_C = in_sizes[1];
+  p.in_H = in_sizes[2];
+  p.in_W = in_sizes[3];
+  p.out_C = w_sizes[0];
+  p.w_H = w_sizes[2];
+  p.w_W = w_sizes[3];
+  p.out_H = out_sizes[2];
+  p.out_W = out_sizes[3];
+  p.groups = groups;
+  p.in_C_per_group = p.in_C / groups;
+  p.out_C_per_group = p.out_C / groups;
+
+  // Same adjustment as the portable kernel: a 1D convolution is a 2D
+  // convolution with a unit height, stride 1, padding 0 and dilation 1.
+  if (in.dim() == 3) {
+    p.stride_y = 1;
+    p.padding_y = 0;
+    p.dilation_y = 1;
+    p.stride_x = stride[0];
+    p.padding_x = padding[0];
+    p.dilation_x = dilation.size() > 0 ? dilation[0] : 1;
+  } else {
+    p.stride_y = val_at(stride, 0);
+    p.padding_y = val_at(padding, 0, /*default_value=*/0);
+    p.dilation_y = val_at(dilation, 0);
+    p.stride_x = val_at(stride, 1);
+    p.padding_x = val_at(padding, 1, /*default_value=*/0);
+    p.dilation_x = val_at(dilation, 1);
+  }
+
+  p.in_channels_last = in.dim() == 4 &&
+      is_channels_last_dim_order(in.dim_order().data(), in.dim());
+  p.w_channels_last = weight.dim() == 4 &&
+      is_channels_last_dim_order(weight.dim_order().data(), weight.dim());
+  p.out_channels_last = out.dim() == 4 &&
+      is_channels_last_dim_order(out.dim_order().data(), out.dim());
+  return p;
+}
+
+/**
+ * Allocates scratch memory for the im2col and Winograd paths. Without a temp
+ * allocator the kernel falls back to the direct convolution, which is a
+ * supported configuration, so this fails without logging an error.
+ */
+Result<void*> allocate_scratch(RuntimeContext& ctx, size_t nbytes) {
+  if (!ctx.has_temp_allocator()) {
+    ET_LOG(Debug, "No temp allocator, convolution takes the direct path");
+    return Error::NotFound;
+  }
+  return ctx.allocate_temp(nbytes);
+}
+
+//
+// Direct and depthwise convolution
+//
+
+/**
+ * Computes out[batch, out_c, out_y, out_x] by walking its receptive field.
+ * Used when no scratch memory is available for the GEMM based paths.
+ */
+template <typename CTYPE>
+inline CTYPE conv2d_direct_point(
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    const CTYPE* w_ptr,
+    int64_t batch,
+    int64_t out_c,
+    int64_t out_y,
+    int64_t out_x) {
+  const int64_t in_c_start = (out_c / p.out_C_per_group) * p.in_C_per_group;
+  const CTYPE* in_n = in_ptr + batch * p.in_strides[0];
+  const CTYPE* w_oc = w_ptr + out_c * p.w_strides[0];
+
+  CTYPE accum = 0;
+  for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+    const int64_t in_y = p.stride_y * out_y + p.dilation_y * w_y - p.padding_y;
+    if (in_y < 0 || in_y >= p.in_H) {
+      continue;
+    }
+    for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+      const int64_t in_x =
+          p.stride_x * out_x + p.dilation_x * w_x - p.padding_x;
+      if (in_x < 0 || in_x >= p.in_W) {
+        continue;
+      }
+      const CTYPE* in_yx =
+          in_n + in_y * p.in_strides[2] + in_x * p.in_strides[3];
+      const CTYPE* w_yx = w_oc + w_y * p.w_strides[2] + w_x * p.w_strides[3];
+      for (int64_t c = 0; c < p.in_C_per_group; ++c) {
+        accum += in_yx[(in_c_start + c) * p.in_strides[1]] *
+            w_yx[c * p.w_strides[1]];
+      }
+    }
+  }
+  return accum;
+}
+
+template <typename CTYPE>
+void conv2d_direct(
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    const CTYPE* w_ptr,
+    CTYPE* out_ptr) {
+  const int64_t work_per_row = p.out_W * p.out_C * p.patch_size();
+  parallel_for_each_chunk(
+      0, p.N * p.out_H, work_per_row, [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const int64_t batch = row / p.out_H;
+          const int64_t out_y = row % p.out_H;
+          CTYPE* out_row =
+              out_ptr + batch * p.out_strides[0] + out_y * p.out_strides[2];
+          for (int64_t out_x = 0; out_x < p.out_W; ++out_x) {
+            for (int64_t out_c = 0; out_c < p.out_C; ++out_c) {
+              out_row[out_x * p.out_strides[3] + out_c * p.out_strides[1]] =
+                  conv2d_direct_point(
+                      p, in_ptr, w_ptr, batch, out_c, out_y, out_x);
+            }
+          }
+        }
+      });
+}
+
+/**
+ * Returns the range [begin, end) of outputs along one spatial dim whose
+ * input coordinate out * stride + offset falls inside [0, in_size).
+ */
+inline void valid_output_range(
+    int64_t offset,
+    int64_t stride,
+    int64_t in_size,
+    int64_t out_size,
+    int64_t& begin,
+    int64_t& end) {
+  begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  end = in_size - offset <= 0 ? 0 : (in_size - offset + stride - 1) / stride;
+  begin = std::min(begin, out_size);
+  end = std::max(std::min(end, out_size), begin);
+}
+
+/**
+ * Depthwise convolution: every group has a single input channel. Each
+ * output plane accumulates one weight tap at a time over the range of
+ * outputs that tap can reach, so the inner loop has no bounds checks. For
+ * channels-last outputs the channel is innermost instead, which keeps both
+ * the input and the output accesses contiguous.
+ */
+template <typename CTYPE>
+void conv2d_depthwise(
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    const CTYPE* w_ptr,
+    CTYPE* out_ptr) {
+  const int64_t taps = p.w_H * p.w_W;
+
+  if (p.out_channels_last) {
+    parallel_for_each_chunk(
+        0,
+        p.N * p.out_H,
+        p.out_W * p.out_C * taps,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t row = begin; row < end; ++row) {
+            const int64_t batch = row / p.out_H;
+            const int64_t out_y = row % p.out_H;
+            CTYPE* out_row =
+                out_ptr + batch * p.out_strides[0] + out_y * p.out_strides[2];
+            for (int64_t out_x = 0; out_x < p.out_W; ++out_x) {
+              CTYPE* out_pixel = out_row + out_x * p.out_strides[3];
+              for (int64_t out_c = 0; out_c < p.out_C; ++out_c) {
+                out_pixel[out_c] = 0;
+              }
+            }
+            for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+              const int64_t in_y =
+                  p.stride_y * out_y + p.dilation_y * w_y - p.padding_y;
+              if (in_y < 0 || in_y >= p.in_H) {
+                continue;
+              }
+              for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+                int64_t x_begin = 0;
+                int64_t x_end = 0;
+                valid_output_range(
+                    p.dilation_x * w_x - p.padding_x,
+                    p.stride_x,
+                    p.in_W,
+                    p.out_W,
+                    x_begin,
+                    x_end);
+                const CTYPE* w_tap =
+                    w_ptr + w_y * p.w_strides[2] + w_x * p.w_strides[3];
+                for (int64_t out_x = x_begin; out_x < x_end; ++out_x) {
+                  const int64_t in_x =
+                      p.stride_x * out_x + p.dilation_x * w_x - p.padding_x;
+                  const CTYPE* in_pixel = in_ptr + batch * p.in_strides[0] +
+                      in_y * p.in_strides[2] + in_x * p.in_strides[3];
+                  CTYPE* out_pixel = out_row + out_x * p.out_strides[3];
+                  for (int64_t out_c = 0; out_c < p.out_C; ++out_c) {
+                    const int64_t in_c = out_c / p.out_C_per_group;
+                    out_pixel[out_c] += in_pixel[in_c * p.in_strides[1]] *
+                        w_tap[out_c * p.w_strides[0]];
+                  }
+                }
+              }
+            }
+          }
+        });
+    return;
+  }
+
+  parallel_for_each_chunk(
+      0,
+      p.N * p.out_C,
+      p.out_size() * taps,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t plane = begin; plane < end; ++plane) {
+          const int64_t batch = plane / p.out_C;
+          const int64_t out_c = plane % p.out_C;
+          const int64_t in_c = out_c / p.out_C_per_group;
+          const CTYPE* in_plane =
+              in_ptr + batch * p.in_strides[0] + in_c * p.in_strides[1];
+          const CTYPE* w_oc = w_ptr + out_c * p.w_strides[0];
+          CTYPE* out_plane =
+              out_ptr + batch * p.out_strides[0] + out_c * p.out_strides[1];
+
+          for (int64_t out_y = 0; out_y < p.out_H; ++out_y) {
+            CTYPE* out_row = out_plane + out_y * p.out_strides[2];
+            for (int64_t out_x = 0; out_x < p.out_W; ++out_x) {
+              out_row[out_x * p.out_strides[3]] = 0;
+            }
+          }
+          for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+            int64_t y_begin = 0;
+            int64_t y_end = 0;
+            valid_output_range(
+                p.dilation_y * w_y - p.padding_y,
+                p.stride_y,
+                p.in_H,
+                p.out_H,
+                y_begin,
+                y_end);
+            for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+              int64_t x_begin = 0;
+              int64_t x_end = 0;
+              valid_output_range(
+                  p.dilation_x * w_x - p.padding_x,
+                  p.stride_x,
+                  p.in_W,
+                  p.out_W,
+                  x_begin,
+                  x_end);
+              const CTYPE w_val =
+                  w_oc[w_y * p.w_strides[2] + w_x * p.w_strides[3]];
+              for (int64_t out_y = y_begin; out_y < y_end; ++out_y) {
+                const int64_t in_y =
+                    p.stride_y * out_y + p.dilation_y * w_y - p.padding_y;
+                const CTYPE* in_row = in_plane + in_y * p.in_strides[2] +
+                    (p.dilation_x * w_x - p.padding_x) * p.in_strides[3];
+                CTYPE* out_row = out_plane + out_y * p.out_strides[2];
+                const int64_t in_step = p.stride_x * p.in_strides[3];
+                const int64_t out_step = p.out_strides[3];
+                for (int64_t out_x = x_begin; out_x < x_end; ++out_x) {
+                  out_row[out_x * out_step] += w_val * in_row[out_x * in_step];
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+//
+// im2col + GEMM
+//
+
+// Offset of tap (c, w_y, w_x) within a patch. Patches follow the channel
+// placement of the input so that channels-last inputs copy contiguous runs.
+inline int64_t patch_index(
+    const Conv2dParams& p,
+    int64_t c,
+    int64_t w_y,
+    int64_t w_x) {
+  return p.in_channels_last ? (w_y * p.w_W + w_x) * p.in_C_per_group + c
+                            : (c * p.w_H + w_y) * p.w_W + w_x;
+}
+
+/**
+ * Unfolds the receptive fields of one (batch, group) into `col`. For
+ * contiguous outputs `col` is patch_size() x out_size() row-major (one row
+ * per tap), otherwise it is out_size() x patch_size() (one row per output
+ * pixel), matching the layout the GEMM writes.
+ */
+template <typename CTYPE>
+void im2col(
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    int64_t batch,
+    int64_t group,
+    CTYPE* col) {
+  const CTYPE* in_g = in_ptr + batch * p.in_strides[0] +
+      group * p.in_C_per_group * p.in_strides[1];
+  const int64_t K = p.patch_size();
+  const int64_t P = p.out_size();
+
+  if (!p.out_channels_last) {
+    for (int64_t c = 0; c < p.in_C_per_group; ++c) {
+      for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+        for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+          CTYPE* col_row = col + patch_index(p, c, w_y, w_x) * P;
+          const int64_t x_offset = p.dilation_x * w_x - p.padding_x;
+          int64_t x_begin = 0;
+          int64_t x_end = 0;
+          valid_output_range(
+              x_offset, p.stride_x, p.in_W, p.out_W, x_begin, x_end);
+          for (int64_t out_y = 0; out_y < p.out_H; ++out_y) {
+            CTYPE* dst = col_row + out_y * p.out_W;
+            const int64_t in_y =
+                p.stride_y * out_y + p.dilation_y * w_y - p.padding_y;
+            if (in_y < 0 || in_y >= p.in_H) {
+              std::fill(dst, dst + p.out_W, CTYPE(0));
+              continue;
+            }
+            const CTYPE* src = in_g + c * p.in_strides[1] +
+                in_y * p.in_strides[2] + x_offset * p.in_strides[3];
+            const int64_t in_step = p.stride_x * p.in_strides[3];
+            std::fill(dst, dst + x_begin, CTYPE(0));
+            for (int64_t out_x = x_begin; out_x < x_end; ++out_x) {
+              dst[out_x] = src[out_x * in_step];
+            }
+            std::fill(dst + x_end, dst + p.out_W, CTYPE(0));
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  for (int64_t out_y = 0; out_y < p.out_H; ++out_y) {
+    for (int64_t out_x = 0; out_x < p.out_W; ++out_x) {
+      CTYPE* dst = col + (out_y * p.out_W + out_x) * K;
+      for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+        const int64_t in_y =
+            p.stride_y * out_y + p.dilation_y * w_y - p.padding_y;
+        for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+          const int64_t in_x =
+              p.stride_x * out_x + p.dilation_x * w_x - p.padding_x;
+          const bool in_bounds =
+              in_y >= 0 && in_y < p.in_H && in_x >= 0 && in_x < p.in_W;
+          const CTYPE* src =
+              in_g + in_y * p.in_strides[2] + in_x * p.in_strides[3];
+          for (int64_t c = 0; c < p.in_C_per_group; ++c) {
+            dst[patch_index(p, c, w_y, w_x)] =
+                in_bounds ? src[c * p.in_strides[1]] : CTYPE(0);
+          }
+        }
+      }
+    }
+  }
+}
+
+// True if the weight rows are already laid out as patches.
+inline bool weight_matches_patch_layout(const Conv2dParams& p) {
+  return p.w_channels_last == p.in_channels_last;
+}
+
+// Copies the weight into out_C rows of patch_size() taps each.
+template <typename CTYPE>
+void pack_conv_weight(const Conv2dParams& p, const CTYPE* w_ptr, CTYPE* dst) {
+  const int64_t K = p.patch_size();
+  for (int64_t out_c = 0; out_c < p.out_C; ++out_c) {
+    for (int64_t c = 0; c < p.in_C_per_group; ++c) {
+      for (int64_t w_y = 0; w_y < p.w_H; ++w_y) {
+        for (int64_t w_x = 0; w_x < p.w_W; ++w_x) {
+          dst[out_c * K + patch_index(p, c, w_y, w_x)] =
+              w_ptr[out_c * p.w_strides[0] + c * p.w_strides[1] +
+                    w_y * p.w_strides[2] + w_x * p.w_strides[3]];
+        }
+      }
+    }
+  }
+}
+
+// True if the input of each (batch, group) already is its own im2col
+// matrix: a pointwise convolution with matching input and output layouts.
+inline bool is_pointwise(const Conv2dParams& p) {
+  return p.w_H == 1 && p.w_W == 1 && p.stride_y == 1 && p.stride_x == 1 &&
+      p.padding_y == 0 && p.padding_x == 0 &&
+      p.in_channels_last == p.out_channels_last;
+}
+
+/**
+ * Lowers the convolution to one GEMM per (batch, group) over the unfolded
+ * input. `prepacked_w`, if not null, is the weight already laid out by
+ * pack_conv_weight(). Returns false, without writing out, if the scratch
+ * memory for the unfolded input or the packed weight could not be allocated.
+ */
+template <typename CTYPE>
+bool conv2d_im2col_gemm(
+    RuntimeContext& ctx,
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    const CTYPE* w_ptr,
+    const CTYPE* prepacked_w,
+    CTYPE* out_ptr) {
+  const int64_t K = p.patch_size();
+  const int64_t P = p.out_size();
+  const bool pointwise = is_pointwise(p);
+
+  CTYPE* col = nullptr;
+  if (!pointwise) {
+    Result<void*> col_mem = allocate_scratch(ctx, K * P * sizeof(CTYPE));
+    if (!col_mem.ok()) {
+      return false;
+    }
+    col = static_cast<CTYPE*>(col_mem.get());
+  }
+
+  const CTYPE* packed_w = prepacked_w != nullptr ? prepacked_w : w_ptr;
+  if (prepacked_w == nullptr && !weight_matches_patch_layout(p)) {
+    Result<void*> w_mem = allocate_scratch(ctx, p.out_C * K * sizeof(CTYPE));
+    if (!w_mem.ok()) {
+      return false;
+    }
+    pack_conv_weight(p, w_ptr, static_cast<CTYPE*>(w_mem.get()));
+    packed_w = static_cast<const CTYPE*>(w_mem.get());
+  }
+
+  for (int64_t batch = 0; batch < p.N; ++batch) {
+    for (int64_t group = 0; group < p.groups; ++group) {
+      const CTYPE* lhs = col;
+      int64_t ld_lhs = p.out_channels_last ? K : P;
+      if (pointwise) {
+        lhs = in_ptr + batch * p.in_strides[0] +
+            group * p.in_C_per_group * p.in_strides[1];
+        ld_lhs = p.out_channels_last ? p.in_strides[3] : p.in_strides[1];
+      } else {
+        im2col(p, in_ptr, batch, group, col);
+      }
+      const CTYPE* w_g = packed_w + group * p.out_C_per_group * K;
+      CTYPE* out_g = out_ptr + batch * p.out_strides[0] +
+          group * p.out_C_per_group * p.out_strides[1];
+
+      if (p.out_channels_last) {
+        // Column-major out_g is out_C_per_group x P with a pixel stride of
+        // out_C: out_g = w_g @ col.
+        // clang-format off
+        executorch::cpublas::gemm(
+            TransposeType::Transpose, TransposeType::NoTranspose,
+            p.out_C_per_group, P, K,
+            static_cast<CTYPE>(1),
+            w_g, K,
+            lhs, ld_lhs,
+            static_cast<CTYPE>(0),
+            out_g, p.out_strides[3]);
+        // clang-format on
+      } else {
+        // Column-major out_g is P x out_C_per_group: out_g = col^T @ w_g^T.
+        // clang-format off
+        executorch::cpublas::gemm(
+            TransposeType::NoTranspose, TransposeType::NoTranspose,
+            P, p.out_C_per_group, K,
+            static_cast<CTYPE>(1),
+            lhs, ld_lhs,
+            w_g, K,
+            static_cast<CTYPE>(0),
+            out_g, p.out_strides[1]);
+        // clang-format on
+      }
+    }
+  }
+  return true;
+}
+
+//
+// Winograd F(2x2, 3x3)
+//
+
+// A 4x4 input tile produces a 2x2 output tile.
+constexpr int64_t kWinogradTile = 4;
+constexpr int64_t kWinogradOutTile = 2;
+constexpr int64_t kWinogradPoints = kWinogradTile * kWinogradTile;
+
+inline bool can_use_winograd(const Conv2dParams& p) {
+  return p.groups == 1 && p.w_H == 3 && p.w_W == 3 && p.stride_y == 1 &&
+      p.stride_x == 1 && p.dilation_y == 1 && p.dilation_x == 1 &&
+      p.in_C >= kWinogradMinChannels && p.out_C >= kWinogradMinChannels;
+}
+
+// U = G g G^T for one 3x3 filter g.
+inline void winograd_transform_weight(const float g[3][3], float u[4][4]) {
+  float tmp[4][3];
+  for (int j = 0; j < 3; ++j) {
+    tmp[0][j] = g[0][j];
+    tmp[1][j] = 0.5f * (g[0][j] + g[1][j] + g[2][j]);
+    tmp[2][j] = 0.5f * (g[0][j] - g[1][j] + g[2][j]);
+    tmp[3][j] = g[2][j];
+  }
+  for (int i = 0; i < 4; ++i) {
+    u[i][0] = tmp[i][0];
+    u[i][1] = 0.5f * (tmp[i][0] + tmp[i][1] + tmp[i][2]);
+    u[i][2] = 0.5f * (tmp[i][0] - tmp[i][1] + tmp[i][2]);
+    u[i][3] = tmp[i][2];
+  }
+}
+
+// V = B^T d B for one 4x4 input tile d.
+inline void winograd_transform_input(const float d[4][4], float v[4][4]) {
+  float tmp[4][4];
+  for (int j = 0; j < 4; ++j) {
+    tmp[0][j] = d[0][j] - d[2][j];
+    tmp[1][j] = d[1][j] + d[2][j];
+    tmp[2][j] = d[2][j] - d[1][j];
+    tmp[3][j] = d[1][j] - d[3][j];
+  }
+  for (int i = 0; i < 4; ++i) {
+    v[i][0] = tmp[i][0] - tmp[i][2];
+    v[i][1] = tmp[i][1] + tmp[i][2];
+    v[i][2] = tmp[i][2] - tmp[i][1];
+    v[i][3] = tmp[i][1] - tmp[i][3];
+  }
+}
+
+// Y = A^T m A for one 4x4 tile of products m.
+inline void winograd_transform_output(const float m[4][4], float y[2][2]) {
+  float tmp[2][4];
+  for (int j = 0; j < 4; ++j) {
+    tmp[0][j] = m[0][j] + m[1][j] + m[2][j];
+    tmp[1][j] = m[1][j] - m[2][j] - m[3][j];
+  }
+  for (int i = 0; i < 2; ++i) {
+    y[i][0] = tmp[i][0] + tmp[i][1] + tmp[i][2];
+    y[i][1] = tmp[i][1] - tmp[i][2] - tmp[i][3];
+  }
+}
+
+// Fills U (16 x out_C x in_C) with the transformed 3x3 filters.
+void winograd_transform_weights(
+    const Conv2dParams& p,
+    const float* w_ptr,
+    float* U) {
+  const int64_t C = p.in_C;
+  const int64_t OC = p.out_C;
+  parallel_for_each_chunk(0, OC, C * 64, [&](int64_t begin, int64_t end) {
+    for (int64_t oc = begin; oc < end; ++oc) {
+      for (int64_t c = 0; c < C; ++c) {
+        float g[3][3];
+        for (int64_t i = 0; i < 3; ++i) {
+          for (int64_t j = 0; j < 3; ++j) {
+            g[i][j] = w_ptr
+                [oc * p.w_strides[0] + c * p.w_strides[1] +
+                 i * p.w_strides[2] + j * p.w_strides[3]];
+          }
+        }
+        float u[4][4];
+        winograd_transform_weight(g, u);
+        for (int64_t xi = 0; xi < kWinogradPoints; ++xi) {
+          U[(xi * OC + oc) * C + c] = u[xi / 4][xi % 4];
+        }
+      }
+    }
+  });
+}
+
+/**
+ * 3x3 stride 1 convolution with the Winograd F(2x2, 3x3) algorithm, which
+ * needs 16 multiplies per 2x2 output tile instead of 36. The transformed
+ * weights U (16 x out_C x in_C), inputs V (16 x in_C x tiles) and products
+ * M (16 x out_C x tiles) live in scratch memory, unless U was prepacked,
+ * and the products are 16 independent GEMMs. Returns false, without writing
+ * out, if the scratch memory could not be allocated.
+ */
+bool conv2d_winograd_3x3(
+    RuntimeContext& ctx,
+    const Conv2dParams& p,
+    const float* in_ptr,
+    const float* w_ptr,
+    const float* prepacked_u,
+    float* out_ptr) {
+  const int64_t tiles_h = (p.out_H + kWinogradOutTile - 1) / kWinogradOutTile;
+  const int64_t tiles_w = (p.out_W + kWinogradOutTile - 1) / kWinogradOutTile;
+  const int64_t T = tiles_h * tiles_w;
+  const int64_t C = p.in_C;
+  const int64_t OC = p.out_C;
+
+  const float* U = prepacked_u;
+  if (U == nullptr) {
+    Result<void*> u_mem =
+        allocate_scratch(ctx, kWinogradPoints * OC * C * sizeof(float));
+    if (!u_mem.ok()) {
+      return false;
+    }
+    winograd_transform_weights(p, w_ptr, static_cast<float*>(u_mem.get()));
+    U = static_cast<const float*>(u_mem.get());
+  }
+  Result<void*> v_mem =
+      allocate_scratch(ctx, kWinogradPoints * C * T * sizeof(float));
+  if (!v_mem.ok()) {
+    return false;
+  }
+  Result<void*> m_mem =
+      allocate_scratch(ctx, kWinogradPoints * OC * T * sizeof(float));
+  if (!m_mem.ok()) {
+    return false;
+  }
+  float* V = static_cast<float*>(v_mem.get());
+  float* M = static_cast<float*>(m_mem.get());
+
+  for (int64_t batch = 0; batch < p.N; ++batch) {
+    const float* in_n = in_ptr + batch * p.in_strides[0];
+    parallel_for_each_chunk(0, C, T * 64, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        const float* in_c = in_n + c * p.in_strides[1];
+        for (int64_t t = 0; t < T; ++t) {
+          const int64_t y0 = (t / tiles_w) * kWinogradOutTile - p.padding_y;
+          const int64_t x0 = (t % tiles_w) * kWinogradOutTile - p.padding_x;
+          float d[4][4];
+          for (int64_t i = 0; i < kWinogradTile; ++i) {
+            const int64_t y = y0 + i;
+            for (int64_t j = 0; j < kWinogradTile; ++j) {
+              const int64_t x = x0 + j;
+              d[i][j] = y >= 0 && y < p.in_H && x >= 0 && x < p.in_W
+                  ? in_c[y * p.in_strides[2] + x * p.in_strides[3]]
+                  : 0.0f;
+            }
+          }
+          float v[4][4];
+          winograd_transform_input(d, v);
+          for (int64_t xi = 0; xi < kWinogradPoints; ++xi) {
+            V[(xi * C + c) * T + t] = v[xi / 4][xi % 4];
+          }
+        }
+      }
+    });
+
+    // M[xi] (OC x T) = U[xi] (OC x C) @ V[xi] (C x T), computed as the
+    // column-major product M[xi]^T = V[xi]^T @ U[xi]^T.
+    for (int64_t xi = 0; xi < kWinogradPoints; ++xi) {
+      // clang-format off
+      executorch::cpublas::gemm(
+          TransposeType::NoTranspose, TransposeType::NoTranspose,
+          T, OC, C,
+          1.0f,
+          V + xi * C * T, T,
+          U + xi * OC * C, C,
+          0.0f,
+          M + xi * OC * T, T);
+      // clang-format on
+    }
+
+    float* out_n = out_ptr + batch * p.out_strides[0];
+    parallel_for_each_chunk(0, OC, T * 64, [&](int64_t begin, int64_t end) {
+      for (int64_t oc = begin; oc < end; ++oc) {
+        float* out_c = out_n + oc * p.out_strides[1];
+        for (int64_t t = 0; t < T; ++t) {
+          float m[4][4];
+          for (int64_t xi = 0; xi < kWinogradPoints; ++xi) {
+            m[xi / 4][xi % 4] = M[(xi * OC + oc) * T + t];
+          }
+          float y[2][2];
+          winograd_transform_output(m, y);
+          const int64_t y0 = (t / tiles_w) * kWinogradOutTile;
+          const int64_t x0 = (t % tiles_w) * kWinogradOutTile;
+          for (int64_t i = 0; i < kWinogradOutTile && y0 + i < p.out_H; ++i) {
+            for (int64_t j = 0; j < kWinogradOutTile && x0 + j < p.out_W;
+                 ++j) {
+              out_c[(y0 + i) * p.out_strides[2] + (x0 + j) * p.out_strides[3]] =
+                  y[i][j];
+            }
+          }
+        }
+      }
+    });
+  }
+  return true;
+}
+
+/**
+ * Weight layouts computed once by prepack_convolution() when the weight is a
+ * constant. Either may be null if the corresponding path does not apply.
+ */
+struct PrepackedConvWeight {
+  // Winograd transformed filters, see winograd_transform_weights().
+  const float* winograd_weight;
+  // Weight rows laid out as im2col patches, see pack_conv_weight().
+  const float* patch_weight;
+};
+
+template <typename CTYPE>
+void conv2d(
+    RuntimeContext& ctx,
+    const Conv2dParams& p,
+    const CTYPE* in_ptr,
+    const CTYPE* w_ptr,
+    CTYPE* out_ptr) {
+  if (p.in_C_per_group == 1) {
+    conv2d_depthwise(p, in_ptr, w_ptr, out_ptr);
+    return;
+  }
+  if (conv2d_im2col_gemm<CTYPE>(
+          ctx, p, in_ptr, w_ptr, /*prepacked_w=*/nullptr, out_ptr)) {
+    return;
+  }
+  conv2d_direct(p, in_ptr, w_ptr, out_ptr);
+}
+
+template <>
+void conv2d<float>(
+    RuntimeContext& ctx,
+    const Conv2dParams& p,
+    const float* in_ptr,
+    const float* w_ptr,
+    float* out_ptr) {
+  if (p.in_C_per_group == 1) {
+    conv2d_depthwise(p, in_ptr, w_ptr, out_ptr);
+    return;
+  }
+  const auto* prepacked =
+      static_cast<const PrepackedConvWeight*>(ctx.prepacked_data());
+  if (can_use_winograd(p) &&
+      conv2d_winograd_3x3(
+          ctx,
+          p,
+          in_ptr,
+          w_ptr,
+          prepacked != nullptr ? prepacked->winograd_weight : nullptr,
+          out_ptr)) {
+    return;
+  }
+  if (conv2d_im2col_gemm(
+          ctx,
+          p,
+          in_ptr,
+          w_ptr,
+          prepacked != nullptr ? prepacked->patch_weight : nullptr,
+          out_ptr)) {
+    return;
+  }
+  conv2d_direct(p, in_ptr, w_ptr, out_ptr);
+}
+
+/**
+ * Prepack function for convolution.out: transforms a constant float weight
+ * into the layouts the Winograd and im2col paths would otherwise compute on
+ * every call. The layouts only depend on the weight, the channel counts and
+ * the dim orders, which do not change between executions.
+ */
+const void* prepack_convolution(KernelPrepackContext& ctx, EValue** stack) {
+  // convolution.out(input, weight, bias, stride, padding, dilation,
+  //                 transposed, output_padding, groups, *, out)
+  if (!ctx.is_constant(1)) {
+    return nullptr;
+  }
+  const Tensor& in = stack[0]->toTensor();
+  const Tensor& weight = stack[1]->toTensor();
+  const exec_aten::optional<Tensor> bias = stack[2]->toOptional<Tensor>();
+  const IntArrayRef stride = stack[3]->toIntList();
+  const IntArrayRef padding = stack[4]->toIntList();
+  const IntArrayRef dilation = stack[5]->toIntList();
+  const bool transposed = stack[6]->toBool();
+  const IntArrayRef output_padding = stack[7]->toIntList();
+  const int64_t groups = stack[8]->toInt();
+  Tensor& out = stack[9]->toTensor();
+
+  if (in.scalar_type() != ScalarType::Float ||
+      !check_convolution_args(
+          in,
+          weight,
+          bias,
+          stride,
+          padding,
+          dilation,
+          transposed,
+          output_padding,
+          groups,
+          out)) {
+    // The kernel reports invalid arguments when it runs.
+    return nullptr;
+  }
+  const Conv2dParams p =
+      make_conv2d_params(in, weight, out, stride, padding, dilation, groups);
+  if (p.in_C_per_group == 1) {
+    // The depthwise kernel reads the weight directly.
+    return nullptr;
+  }
+
+  Result<void*> mem = ctx.allocate(sizeof(PrepackedConvWeight));
+  if (!mem.ok()) {
+    return nullptr;
+  }
+  auto* prepacked = static_cast<PrepackedConvWeight*>(mem.get());
+  prepacked->winograd_weight = nullptr;
+  prepacked->patch_weight = nullptr;
+
+  const float* w_ptr = weight.const_data_ptr<float>();
+  if (can_use_winograd(p)) {
+    Result<void*> u_mem =
+        ctx.allocate(kWinogradPoints * p.out_C * p.in_C * sizeof(float));
+    if (u_mem.ok()) {
+      winograd_transform_weights(p, w_ptr, static_cast<float*>(u_mem.get()));
+      prepacked->winograd_weight = static_cast<const float*>(u_mem.get());
+    }
+  }
+  if (!weight_matches_patch_layout(p)) {
+    Result<void*> w_mem =
+        ctx.allocate(p.out_C * p.patch_size() * sizeof(float));
+    if (w_mem.ok()) {
+      pack_conv_weight(p, w_ptr, static_cast<float*>(w_mem.get()));
+      prepacked->patch_weight = static_cast<const float*>(w_mem.get());
+    }
+  }
+  return prepacked;
+}
+
+static auto prepack_registered =
+    register_prepack_functions({KernelPrepack(
+        "aten::convolution.out", prepack_convolution)});
+
+template <typename CTYPE, typename CTYPE_BIAS>
+void add_bias(const Conv2dParams& p, const CTYPE_BIAS* bias, CTYPE* out_ptr) {
+  for (int64_t batch = 0; batch < p.N; ++batch) {
+    for (int64_t out_y = 0; out_y < p.out_H; ++out_y) {
+      for (int64_t out_x = 0; out_x < p.out_W; ++out_x) {
+        CTYPE* out_pixel = out_ptr + batch * p.out_strides[0] +
+            out_y * p.out_strides[2] + out_x * p.out_strides[3];
+        for (int64_t out_c = 0; out_c < p.out_C; ++out_c) {
+          out_pixel[out_c * p.out_strides[1]] +=
+              convert<CTYPE, CTYPE_BIAS>(bias[out_c]);
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+Tensor& opt_convolution_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& weight,
+    const exec_aten::optional<Tensor>& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    bool transposed,
+    IntArrayRef output_padding,
+    int64_t groups,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_convolution_args(
+          in,
+          weight,
+          bias,
+          stride,
+          padding,
+          dilation,
+          transposed,
+          output_padding,
+          groups,
+          out),
+      InvalidArgument,
+      out);
+
+  size_t output_ndim = 0;
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  get_convolution_out_target_size(
+      in, weight, stride, padding, dilation, output_sizes, &output_ndim);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      output_size_is_valid({output_sizes, output_ndim}, in.dim() - 2),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {output_sizes, output_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  const Conv2dParams params =
+      make_conv2d_params(in, weight, out, stride, padding, dilation, groups);
+
+  ScalarType in_type = in.scalar_type();
+  ET_SWITCH_REAL_TYPES(in_type, ctx, "convolution.out", CTYPE, [&]() {
+    CTYPE* const out_ptr = out.mutable_data_ptr<CTYPE>();
+    conv2d<CTYPE>(
+        ctx,
+        params,
+        in.const_data_ptr<CTYPE>(),
+        weight.const_data_ptr<CTYPE>(),
+        out_ptr);
+
+    if (bias.has_value()) {
+      ET_SWITCH_REAL_TYPES_AND(
+          Bool,
+          bias.value().scalar_type(),
+          ctx,
+          "convolution.out",
+          CTYPE_BIAS,
+          [&]() {
+            add_bias<CTYPE, CTYPE_BIAS>(
+                params, bias.value().const_data_ptr<CTYPE_BIAS>(), out_ptr);
+          });
+    }
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using ScalarType = exec_aten::ScalarType;
+
+namespace {
+
+// Slices at least twice this long are scanned in blocks, in parallel, when
+// there are too few slices to keep the threads busy.
+constexpr int64_t kScanBlockSize = 16384;
+constexpr int64_t kScanMaxBlocks = 64;
+
+// Columns scanned together when the scanned dim is not the innermost one.
+constexpr int64_t kScanColumnBlock = 1024;
+
+// Scans the n > 0 contiguous elements at `in`, adding `offset` to all of them
+// unless `first` is set.
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void scan_contiguous(
+    const CTYPE_IN* const in,
+    CTYPE_OUT* const out,
+    const int64_t n,
+    const bool first,
+    const CTYPE_OUT offset) {
+  CTYPE_OUT acc = static_cast<CTYPE_OUT>(in[0]);
+  if (!first) {
+    acc = acc + offset;
+  }
+  out[0] = acc;
+  for (int64_t i = 1; i < n; ++i) {
+    acc = static_cast<CTYPE_OUT>(in[i]) + acc;
+    out[i] = acc;
+  }
+}
+
+/**
+ * Scans a long contiguous slice in two passes over blocks: the first sums
+ * every block but the last, the second scans every block starting from the
+ * sum of the blocks before it. Both passes split the blocks across threads.
+ * The first block is summed exactly as a sequential scan would.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void blocked_scan_contiguous(
+    const CTYPE_IN* const in,
+    CTYPE_OUT* const out,
+    const int64_t n) {
+  const int64_t num_blocks =
+      std::min(kScanMaxBlocks, (n + kScanBlockSize - 1) / kScanBlockSize);
+  const int64_t block_size = (n + num_blocks - 1) / num_blocks;
+  const auto block_extent = [&](const int64_t b, int64_t& size) {
+    const int64_t start = std::min(b * block_size, n);
+    size = std::min(block_size, n - start);
+    return start;
+  };
+
+  CTYPE_OUT sums[kScanMaxBlocks];
+  parallel_for_each_chunk(
+      0,
+      num_blocks - 1,
+      block_size,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t b = begin; b < end; ++b) {
+          int64_t size = 0;
+          const int64_t start = block_extent(b, size);
+          CTYPE_OUT sum = size > 0 ? static_cast<CTYPE_OUT>(in[start]) : 0;
+          for (int64_t i = start + 1; i < start + size; ++i) {
+            sum = static_cast<CTYPE_OUT>(in[i]) + sum;
+          }
+          sums[b] = sum;
+        }
+      });
+
+  CTYPE_OUT offsets[kScanMaxBlocks];
+  offsets[0] = 0;
+  for (int64_t b = 1; b < num_blocks; ++b) {
+    offsets[b] = b == 1 ? sums[0] : sums[b - 1] + offsets[b - 1];
+  }
+
+  parallel_for_each_chunk(
+      0, num_blocks, block_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t b = begin; b < end; ++b) {
+          int64_t size = 0;
+          const int64_t start = block_extent(b, size);
+          if (size > 0) {
+            scan_contiguous(in + start, out + start, size, b == 0, offsets[b]);
+          }
+        }
+      });
+}
+
+/**
+ * Returns the cumulative sum of elements of input in the dimension dim, with
+ * the same additions, in the same order, as the portable kernel, except for
+ * long slices scanned in blocks.
+ *
+ * Slices along an innermost dim are scanned one per thread, or in blocks
+ * for few long slices when the kernels are threaded. Otherwise every row
+ * adds the output row before it, a vector at a time, in parallel over
+ * blocks of columns.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void cumsum_tensors(const Tensor& self, int64_t dim, Tensor& out) {
+  if (self.numel() == 0) {
+    return;
+  }
+
+  const CTYPE_IN* const in_data = self.const_data_ptr<CTYPE_IN>();
+  CTYPE_OUT* const out_data = out.mutable_data_ptr<CTYPE_OUT>();
+
+  if (self.dim() == 0) {
+    out_data[0] = static_cast<CTYPE_OUT>(in_data[0]);
+    return;
+  }
+
+  const int64_t dim_size = self.size(dim);
+  const int64_t outer = getLeadingDims(self, dim);
+  const int64_t inner = getTrailingDims(self, dim);
+
+  if (inner == 1) {
+    if (kParallelForEachChunkIsThreaded && outer < kScanMaxBlocks &&
+        dim_size >= 2 * kScanBlockSize) {
+      for (int64_t i = 0; i < outer; ++i) {
+        blocked_scan_contiguous(
+            in_data + i * dim_size, out_data + i * dim_size, dim_size);
+      }
+      return;
+    }
+    parallel_for_each_chunk(
+        0, outer, dim_size, [&](const int64_t begin, const int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            scan_contiguous(
+                in_data + i * dim_size,
+                out_data + i * dim_size,
+                dim_size,
+                /*first=*/true,
+                CTYPE_OUT(0));
+          }
+        });
+    return;
+  }
+
+  using Vec = executorch::vec::Vectorized<CTYPE_OUT>;
+  constexpr bool kVectorized = std::is_same<CTYPE_IN, CTYPE_OUT>::value &&
+      std::is_floating_point<CTYPE_OUT>::value;
+  const int64_t num_column_blocks =
+      (inner + kScanColumnBlock - 1) / kScanColumnBlock;
+  parallel_for_each_chunk(
+      0,
+      outer * num_column_blocks,
+      dim_size * std::min(inner, kScanColumnBlock),
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t task = begin; task < end; ++task) {
+          const int64_t i = task / num_column_blocks;
+          const int64_t c0 = (task % num_column_blocks) * kScanColumnBlock;
+          const int64_t columns = std::min(kScanColumnBlock, inner - c0);
+          const CTYPE_IN* const in_slice = in_data + i * dim_size * inner + c0;
+          CTYPE_OUT* const out_slice = out_data + i * dim_size * inner + c0;
+          for (int64_t c = 0; c < columns; ++c) {
+            out_slice[c] = static_cast<CTYPE_OUT>(in_slice[c]);
+          }
+          for (int64_t j = 1; j < dim_size; ++j) {
+            const CTYPE_IN* const in_row = in_slice + j * inner;
+            CTYPE_OUT* const out_row = out_slice + j * inner;
+            const CTYPE_OUT* const prev_row = out_row - inner;
+            if (kVectorized) {
+              executorch::vec::map2<CTYPE_OUT>(
+                  [](const Vec& x, const Vec& y) { return x + y; },
+                  out_row,
+                  reinterpret_cast<const CTYPE_OUT*>(in_row),
+                  prev_row,
+                  columns);
+            } else {
+              for (int64_t c = 0; c < columns; ++c) {
+                out_row[c] = static_cast<CTYPE_OUT>(in_row[c]) + prev_row[c];
+              }
+            }
+          }
+        }
+      });
+}
+
+} // namespace
+
+/**
+ * Returns the cumulative sum of elements of input in the dimension dim.
+ * If dtype is specified, the input tensor is casted to dtype before the
+ * operation is performed. This is useful for preventing data type overflows.
+ */
+Tensor& opt_cumsum_out(
+    RuntimeContext& ctx,
+    const Tensor& self,
+    int64_t dim,
+    optional<ScalarType> enforced_dtype,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_cumsum_args(self, dim, enforced_dtype, out),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, resize_tensor(out, self.sizes()) == Error::Ok, InvalidArgument, out);
+
+  dim = (self.dim() == 0) ? 0 : dim < 0 ? dim + self.dim() : dim;
+
+  ET_SWITCH_REAL_TYPES_AND(
+      Bool, self.scalar_type(), ctx, "cumsum.out", CTYPE_SELF, [&] {
+        ET_SWITCH_REAL_TYPES_AND(
+            Bool, out.scalar_type(), ctx, "cumsum.out", CTYPE_OUT, [&] {
+              cumsum_tensors<CTYPE_SELF, CTYPE_OUT>(self, dim, out);
+            });
+      });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -10,6 +10,7 @@
 
 #include <executorch/kernels/optimized/vec/functional.h>
 #include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -27,8 +28,7 @@ template <
     typename CTYPE_OUT,
     typename std::enable_if<
         std::is_same<CTYPE_IN, CTYPE_OUT>::value &&
-            !std::is_same<CTYPE_IN, torch::executor::Half>::value &&
-            !std::is_same<CTYPE_OUT, torch::executor::Half>::value,
+            !executorch::vec::is_reduced_floating_point<CTYPE_IN>::value,
         int>::type = 0>
 void exp_data(
     const CTYPE_IN* in_data,
@@ -40,16 +40,32 @@ void exp_data(
 }
 
 /**
- * Slow path of natural exponential function.
+ * Fast path for Half, which is computed in float by the vector intrinsics.
  */
 template <
     typename CTYPE_IN,
     typename CTYPE_OUT,
     typename std::enable_if<
-        !std::is_same<CTYPE_IN, CTYPE_OUT>::value ||
-            std::is_same<CTYPE_IN, torch::executor::Half>::value ||
-            std::is_same<CTYPE_OUT, torch::executor::Half>::value,
+        std::is_same<CTYPE_IN, CTYPE_OUT>::value &&
+            executorch::vec::is_reduced_floating_point<CTYPE_IN>::value,
         int>::type = 0>
+void exp_data(
+    const CTYPE_IN* in_data,
+    const size_t numel,
+    CTYPE_OUT* out_data) {
+  using fVec = executorch::vec::Vectorized<float>;
+  executorch::vec::map<CTYPE_IN>(
+      [](fVec x) { return x.exp(); }, out_data, in_data, numel);
+}
+
+/**
+ * Slow path of natural exponential function.
+ */
+template <
+    typename CTYPE_IN,
+    typename CTYPE_OUT,
+    typename std::enable_if<!std::is_same<CTYPE_IN, CTYPE_OUT>::value, int>::
+        type = 0>
 void exp_data(
     const CTYPE_IN* in_data,
     const size_t numel,
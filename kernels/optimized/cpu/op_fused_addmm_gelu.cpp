@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/portable/cpu/scalar_utils.h>
+#include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using Scalar = exec_aten::Scalar;
+using string_view = exec_aten::string_view;
+
+namespace {
+
+// Rows of the output produced per GEMM call. Bias and gelu are applied to a
+// block while it is still in cache, instead of in separate passes over the
+// whole output. Every call repacks mat2, so a block keeps at least enough
+// rows to amortize that.
+constexpr size_t kOutputBlockBytes = 256 * 1024;
+constexpr int64_t kMinRowsPerBlock = 64;
+
+template <typename CTYPE>
+inline CTYPE gelu_value(const CTYPE x, const bool use_tanh) {
+  if (use_tanh) {
+    // 0.5 * x * (1 + Tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))
+    const CTYPE kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
+    const CTYPE kKappa = 0.044715;
+    const CTYPE inner = kBeta * (x + kKappa * x * x * x);
+    return CTYPE(0.5) * x * (CTYPE(1) + std::tanh(inner));
+  }
+  return CTYPE(0.5) * x * (CTYPE(1) + std::erf(x * M_SQRT1_2));
+}
+
+} // namespace
+
+/**
+ * Computes gelu(beta * self + alpha * (mat1 @ mat2)), the fusion of an
+ * addmm.out feeding a gelu.out, as emitted by the FuseOpChainsPass export
+ * pass. The output is produced a block of rows at a time so that the bias
+ * and the activation are applied while the GEMM result is still in cache.
+ *
+ * fused::addmm_gelu.out(Tensor self, Tensor mat1, Tensor mat2, *,
+ *     Scalar beta=1, Scalar alpha=1, str approximate="none",
+ *     Tensor(a!) out) -> Tensor(a!)
+ */
+Tensor& opt_fused_addmm_gelu_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    string_view approximate,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_addmm_args(in, mat1, mat2, beta, alpha, out),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      approximate == "tanh" || approximate == "none",
+      InvalidArgument,
+      out,
+      "Invalid approximation format: %.*s for gelu",
+      static_cast<int>(approximate.length()),
+      approximate.data());
+
+  size_t output_ndim = 0;
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  get_mm_out_target_size(mat1, mat2, output_sizes, &output_ndim);
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {output_sizes, output_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, tensor_is_broadcastable_to(in, out), InvalidArgument, out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  const bool use_tanh = approximate == "tanh";
+  ScalarType alpha_dtype = utils::get_scalar_dtype(alpha);
+  ScalarType beta_dtype = utils::get_scalar_dtype(beta);
+  constexpr auto name = "fused::addmm_gelu.out";
+  ET_SWITCH_FLOAT_TYPES(in.scalar_type(), ctx, name, CTYPE, [&]() {
+    ET_SWITCH_SCALAR_OBJ_TYPES(
+        alpha_dtype, ctx, name, ALPHA_T, [&]() {
+          ET_SWITCH_SCALAR_OBJ_TYPES(
+              beta_dtype, ctx, name, BETA_T, [&]() {
+                using executorch::cpublas::TransposeType;
+                const int64_t m = mat1.size(0);
+                const int64_t k = mat1.size(1);
+                const int64_t n = mat2.size(1);
+                const CTYPE alpha_val = convert<CTYPE>(alpha.to<ALPHA_T>());
+                const CTYPE beta_val = convert<CTYPE>(beta.to<BETA_T>());
+                const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+                const CTYPE* const mat1_data = mat1.const_data_ptr<CTYPE>();
+                const CTYPE* const mat2_data = mat2.const_data_ptr<CTYPE>();
+                CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+                // A full-size bias is folded into the GEMM through beta, and
+                // a bias row is added per output row. Any other broadcast
+                // falls back to a separate bias pass before the activation.
+                const bool in_matches_out = out.sizes() == in.sizes();
+                const bool in_is_row = in.numel() == n &&
+                    (in.dim() == 1 || (in.dim() == 2 && in.size(0) == 1));
+                const bool fuse_bias = in_matches_out || in_is_row;
+
+                const int64_t row_bytes = sizeof(CTYPE) * n;
+                const int64_t rows_per_block = std::max<int64_t>(
+                    kMinRowsPerBlock, kOutputBlockBytes / row_bytes);
+
+                for (int64_t row0 = 0; row0 < m; row0 += rows_per_block) {
+                  const int64_t rows = std::min(rows_per_block, m - row0);
+                  CTYPE* const out_block = out_data + row0 * n;
+                  if (in_matches_out) {
+                    std::memcpy(
+                        out_block,
+                        in_data + row0 * n,
+                        rows * n * sizeof(CTYPE));
+                  }
+
+                  // See op_mm.cpp for the row-major to column-major swap.
+                  // clang-format off
+                  executorch::cpublas::gemm(
+                      TransposeType::NoTranspose, TransposeType::NoTranspose,
+                      n, rows, k,
+                      alpha_val,
+                      mat2_data, n,
+                      mat1_data + row0 * k, k,
+                      in_matches_out ? beta_val : static_cast<CTYPE>(0),
+                      out_block, n);
+                  // clang-format on
+
+                  if (!fuse_bias) {
+                    continue;
+                  }
+                  for (int64_t i = 0; i < rows; ++i) {
+                    CTYPE* const out_row = out_block + i * n;
+                    for (int64_t j = 0; j < n; ++j) {
+                      CTYPE val = out_row[j];
+                      if (in_is_row && !in_matches_out) {
+                        val += beta_val * in_data[j];
+                      }
+                      out_row[j] = gelu_value(val, use_tanh);
+                    }
+                  }
+                }
+
+                if (!fuse_bias) {
+                  apply_binary_elementwise_fn<CTYPE, CTYPE, CTYPE>(
+                      [beta_val, use_tanh](
+                          const CTYPE val_out, const CTYPE val_in) {
+                        return gelu_value(
+                            val_out + val_in * beta_val, use_tanh);
+                      },
+                      out,
+                      in,
+                      out);
+                }
+              });
+        });
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
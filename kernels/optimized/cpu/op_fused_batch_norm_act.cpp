@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/cpu/normalization_utils.h>
+#include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using string_view = exec_aten::string_view;
+
+/**
+ * Computes activation(_native_batch_norm_legit_no_training(input, ...)[0]),
+ * the fusion of an inference batch norm feeding a relu or a silu, as emitted
+ * by the FuseOpChainsPass export pass. The activation is applied while
+ * normalizing, instead of in another pass over the output.
+ *
+ * fused::batch_norm_act.out(Tensor input, Tensor? weight, Tensor? bias,
+ *     Tensor running_mean, Tensor running_var, float eps, str activation, *,
+ *     Tensor(a!) out) -> Tensor(a!)
+ */
+Tensor& opt_fused_batch_norm_act_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    const Tensor& running_mean,
+    const Tensor& running_var,
+    double eps,
+    string_view activation,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, in.sizes()) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  // There are no statistics outputs; out stands in for them, since the
+  // checks only compare their dtype with the input's.
+  ET_KERNEL_CHECK(
+      ctx,
+      check_batch_norm_args(
+          in,
+          weight,
+          bias,
+          running_mean,
+          running_var,
+          /*momentum=*/0,
+          eps,
+          out,
+          out,
+          out),
+      InvalidArgument,
+      out);
+
+  bool channels_last = false;
+  ET_KERNEL_CHECK(
+      ctx,
+      internal::check_batch_norm_layout(in, out, &channels_last),
+      InvalidArgument,
+      out);
+
+  internal::NormActivation act;
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      internal::parse_norm_activation(activation, &act),
+      InvalidArgument,
+      out,
+      "Unsupported activation: %.*s",
+      static_cast<int>(activation.size()),
+      activation.data());
+
+  ET_SWITCH_FLOAT_TYPES(
+      in.scalar_type(), ctx, "fused::batch_norm_act.out", CTYPE, [&]() {
+        internal::dispatch_norm_activation(act, [&](auto kActivation) {
+          internal::batch_norm<CTYPE, decltype(kActivation)::value>(
+              in,
+              weight,
+              bias,
+              running_mean,
+              running_var,
+              eps,
+              channels_last,
+              out);
+        });
+      });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/cpu/normalization_utils.h>
+#include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+using string_view = exec_aten::string_view;
+
+/**
+ * Computes activation(native_group_norm(input, ...)[0]), the fusion of a
+ * native_group_norm.out whose statistics are unused feeding a relu or a
+ * silu, as emitted by the FuseOpChainsPass export pass. The activation is
+ * applied while normalizing, instead of in another pass over the output.
+ *
+ * fused::group_norm_act.out(Tensor input, Tensor? weight, Tensor? bias,
+ *     int N, int C, int HxW, int group, float eps, str activation, *,
+ *     Tensor(a!) out) -> Tensor(a!)
+ */
+Tensor& opt_fused_group_norm_act_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps,
+    string_view activation,
+    Tensor& out) {
+  // There are no statistics outputs; out stands in for them, since the
+  // checks only compare their dtype with the input's.
+  ET_KERNEL_CHECK(
+      ctx,
+      check_group_norm_args(
+          input, weight, bias, N, C, HxW, group, out, out, out),
+      InvalidArgument,
+      out);
+
+  internal::NormActivation act;
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      internal::parse_norm_activation(activation, &act),
+      InvalidArgument,
+      out,
+      "Unsupported activation: %.*s",
+      static_cast<int>(activation.size()),
+      activation.data());
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, input.sizes()) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  ET_SWITCH_FLOAT_TYPES(
+      input.scalar_type(), ctx, "fused::group_norm_act.out", CTYPE, [&]() {
+        internal::dispatch_norm_activation(act, [&](auto kActivation) {
+          internal::group_norm<CTYPE, decltype(kActivation)::value>(
+              input,
+              weight,
+              bias,
+              N,
+              C,
+              HxW,
+              group,
+              eps,
+              out,
+              /*mean_data=*/nullptr,
+              /*rstd_data=*/nullptr);
+        });
+      });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+// True if `t` holds one value per element of the innermost dimension of
+// `out`, which is how per-channel scales and shifts broadcast over
+// channels-last activations.
+bool is_row_broadcast(const Tensor& t, const Tensor& out) {
+  return out.dim() > 0 && t.dim() == 1 &&
+      t.size(0) == out.size(out.dim() - 1);
+}
+
+} // namespace
+
+/**
+ * Computes self * scale + shift in a single pass over memory, broadcasting
+ * scale and shift against self. This is the fusion of a mul.Tensor feeding
+ * an add.Tensor, as emitted by the FuseOpChainsPass export pass.
+ *
+ * All tensors must share a dtype.
+ *
+ * fused::mul_add.out(Tensor self, Tensor scale, Tensor shift, *,
+ *     Tensor(a!) out) -> Tensor(a!)
+ */
+Tensor& opt_fused_mul_add_out(
+    RuntimeContext& ctx,
+    const Tensor& self,
+    const Tensor& scale,
+    const Tensor& shift,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      tensors_have_same_dtype(self, scale, shift) &&
+          tensors_have_same_dtype(self, out),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_to_broadcast_target_size(self, scale, shift, out) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  const bool self_matches_out = self.sizes().equals(out.sizes());
+  const bool scale_matches_out = scale.sizes().equals(out.sizes());
+  const bool shift_matches_out = shift.sizes().equals(out.sizes());
+
+  constexpr auto name = "fused::mul_add.out";
+  ET_SWITCH_REAL_TYPES(out.scalar_type(), ctx, name, CTYPE, [&]() {
+    using Vec = executorch::vec::Vectorized<CTYPE>;
+    const auto fn = [](Vec x, Vec s, Vec b) {
+      return executorch::vec::fmadd(x, s, b);
+    };
+    const CTYPE* const self_data = self.const_data_ptr<CTYPE>();
+    const CTYPE* const scale_data = scale.const_data_ptr<CTYPE>();
+    const CTYPE* const shift_data = shift.const_data_ptr<CTYPE>();
+    CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+    if (self_matches_out && scale_matches_out && shift_matches_out) {
+      executorch::vec::map3<CTYPE>(
+          fn, out_data, self_data, scale_data, shift_data, out.numel());
+    } else if (
+        self_matches_out &&
+        (scale_matches_out || is_row_broadcast(scale, out)) &&
+        (shift_matches_out || is_row_broadcast(shift, out))) {
+      // Per-channel affine on the innermost dimension: walk self a row at a
+      // time and reuse the broadcast rows of scale and shift.
+      const int64_t row_size = out.size(out.dim() - 1);
+      const int64_t num_rows = out.numel() / row_size;
+      for (int64_t row = 0; row < num_rows; ++row) {
+        const int64_t offset = row * row_size;
+        executorch::vec::map3<CTYPE>(
+            fn,
+            out_data + offset,
+            self_data + offset,
+            scale_matches_out ? scale_data + offset : scale_data,
+            shift_matches_out ? shift_data + offset : shift_data,
+            row_size);
+      }
+    } else {
+      apply_ternary_elementwise_fn<CTYPE, CTYPE, CTYPE, CTYPE>(
+          [](const CTYPE val_self,
+             const CTYPE val_scale,
+             const CTYPE val_shift) {
+            return val_self * val_scale + val_shift;
+          },
+          self,
+          scale,
+          shift,
+          out);
+    }
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+bool check_rms_norm_args(
+    const Tensor& input,
+    const exec_aten::optional<Tensor>& weight,
+    const Tensor& out) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      input.dim() >= 1, "Expected input to have at least one dimension.");
+  ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_dtype(input, out));
+  ET_LOG_AND_RETURN_IF_FALSE(tensor_is_contiguous(input));
+  if (weight.has_value()) {
+    const Tensor& w = weight.value();
+    ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_dtype(input, w));
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        w.dim() == 1 && w.size(0) == input.size(input.dim() - 1),
+        "Expected weight to be 1-D with the size of the last input dimension.");
+  }
+  return true;
+}
+
+template <typename CTYPE>
+void rms_norm(
+    const CTYPE* in_data,
+    const CTYPE* weight_data,
+    const double eps,
+    const int64_t num_rows,
+    const int64_t row_size,
+    CTYPE* out_data) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  parallel_for_each_chunk(
+      0, num_rows, 3 * row_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const CTYPE* const in_row = in_data + i * row_size;
+          CTYPE* const out_row = out_data + i * row_size;
+          const CTYPE sum_sq = executorch::vec::map_reduce_all<CTYPE>(
+              [](Vec x) { return x * x; },
+              [](Vec x, Vec y) { return x + y; },
+              in_row,
+              row_size);
+          const CTYPE rstd =
+              CTYPE(1) / std::sqrt(sum_sq / row_size + static_cast<CTYPE>(eps));
+          const Vec rstd_vec(rstd);
+          if (weight_data == nullptr) {
+            executorch::vec::map<CTYPE>(
+                [rstd_vec](Vec x) { return x * rstd_vec; },
+                out_row,
+                in_row,
+                row_size);
+          } else {
+            executorch::vec::map2<CTYPE>(
+                [rstd_vec](Vec x, Vec w) { return x * rstd_vec * w; },
+                out_row,
+                in_row,
+                weight_data,
+                row_size);
+          }
+        }
+      });
+}
+
+} // namespace
+
+/**
+ * Normalizes each row of the last dimension of `input` by its root mean
+ * square, then scales it by `weight` when one is given:
+ *
+ *   out = input * rsqrt(mean(input^2, dim=-1) + eps) * weight
+ *
+ * The sum of squares, the normalization and the scale are done in two passes
+ * over each row instead of the five ops the Python RMSNorm decomposes into.
+ *
+ * fused::rms_norm.out(Tensor input, Tensor? weight, float eps, *,
+ *     Tensor(a!) out) -> Tensor(a!)
+ */
+Tensor& opt_fused_rms_norm_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const exec_aten::optional<Tensor>& weight,
+    double eps,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx, check_rms_norm_args(input, weight, out), InvalidArgument, out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, input.sizes()) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (input.numel() == 0) {
+    return out;
+  }
+
+  const int64_t row_size = input.size(input.dim() - 1);
+  const int64_t num_rows = input.numel() / row_size;
+
+  constexpr auto name = "fused::rms_norm.out";
+  ET_SWITCH_FLOAT_TYPES(input.scalar_type(), ctx, name, CTYPE, [&]() {
+    rms_norm<CTYPE>(
+        input.const_data_ptr<CTYPE>(),
+        weight.has_value() ? weight.value().const_data_ptr<CTYPE>() : nullptr,
+        eps,
+        num_rows,
+        row_size,
+        out.mutable_data_ptr<CTYPE>());
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
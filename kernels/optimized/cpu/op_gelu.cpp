@@ -6,13 +6,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#ifdef __aarch64__
-#include <arm_neon.h>
-#include <sleef.h>
-#endif
-
 #include <cmath>
 
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <executorch/runtime/platform/assert.h>
 
@@ -34,7 +31,7 @@ namespace {
  *
  * Assumes that the tensors are contiguous, are the same shape, and have the
  * same dtype. CTYPE should be the C type (like `float` or `double`) that
- * matches the dtype of the tensors.
+ * matches the dtype of the tensors. Half is computed in float.
  */
 template <typename CTYPE>
 void gelu(
@@ -42,52 +39,39 @@ void gelu(
     const Tensor& input,
     string_view approximate,
     Tensor& output) {
+  using COMPUTE_CTYPE = typename std::conditional<
+      executorch::vec::is_reduced_floating_point<CTYPE>::value,
+      float,
+      CTYPE>::type;
+  using Vec = executorch::vec::Vectorized<COMPUTE_CTYPE>;
   const CTYPE* in_data = input.const_data_ptr<CTYPE>();
   CTYPE* out_data = output.mutable_data_ptr<CTYPE>();
   size_t lim = input.numel();
 
-  // TODO: Add fast path for tanh using sleef's tanh
+  const Vec half(COMPUTE_CTYPE(0.5));
+  const Vec one(COMPUTE_CTYPE(1));
   if (approximate == "tanh") {
     // 0.5 * x * (1 + Tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))
-    for (size_t i = 0; i < lim; ++i) {
-      const CTYPE x = in_data[i];
-      const CTYPE kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
-      const CTYPE kKappa = 0.044715;
-      auto x_cube = x * x * x;
-      auto inner = kBeta * (x + kKappa * x_cube);
-      out_data[i] = CTYPE(0.5) * x * (CTYPE(1) + std::tanh(inner));
-    }
+    const Vec kBeta(COMPUTE_CTYPE(M_SQRT2 * M_2_SQRTPI * 0.5));
+    const Vec kKappa(COMPUTE_CTYPE(0.044715));
+    executorch::vec::map<CTYPE>(
+        [&](Vec x) {
+          const Vec inner =
+              kBeta * executorch::vec::fmadd(kKappa * x, x * x, x);
+          return half * x * (one + inner.tanh());
+        },
+        out_data,
+        in_data,
+        lim);
   } else if (approximate == "none") { // dont appx
     // GELU(x) = x * Φ(x) where Φ(x) is the is the Cumulative Distribution
     // Function for Gaussian Distribution.
-
-#ifndef __aarch64__
-    for (size_t i = 0; i < lim; ++i) {
-      const CTYPE x = in_data[i];
-      out_data[i] = CTYPE(0.5) * x * (CTYPE(1) + std::erf(x * M_SQRT1_2));
-    }
-#else
-    size_t i = 0;
-    if (std::is_same<CTYPE, float>::value) {
-      for (; i + 4 < lim; i += 4) {
-        const float32x4_t in =
-            vld1q_f32(static_cast<const float*>(&in_data[i]));
-        const float32x4_t m_sqrt1_2x4 = {
-            M_SQRT1_2, M_SQRT1_2, M_SQRT1_2, M_SQRT1_2};
-        const float32x4_t ones = vmovq_n_f32(1.0);
-        const float32x4_t halves = vmovq_n_f32(0.5);
-        float32x4_t out = Sleef_erff4_u10(vmulq_f32(in, m_sqrt1_2x4));
-        vst1q_f32(
-            static_cast<float*>(&out_data[i]),
-            vmulq_f32(vmulq_f32(vaddq_f32(out, ones), in), halves));
-      }
-    }
-    for (; i < lim; ++i) {
-      const CTYPE x = in_data[i];
-      out_data[i] = CTYPE(0.5) * x * (CTYPE(1) + std::erf(x * M_SQRT1_2));
-    }
-#endif // __aarch64__
-
+    const Vec kAlpha(COMPUTE_CTYPE(M_SQRT1_2));
+    executorch::vec::map<CTYPE>(
+        [&](Vec x) { return half * x * (one + (x * kAlpha).erf()); },
+        out_data,
+        in_data,
+        lim);
   } else {
     ET_KERNEL_CHECK_MSG(
         context,
@@ -130,6 +114,7 @@ Tensor& opt_gelu_out(
   switch (input.scalar_type()) {
     // TODO support Double as well
     GELU(float, Float)
+    GELU(exec_aten::Half, Half)
     default:
       ET_KERNEL_CHECK_MSG(
           context,
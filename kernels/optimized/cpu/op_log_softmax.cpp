@@ -6,14 +6,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#ifdef __aarch64__
-#include <arm_neon.h>
-#include <sleef.h>
-#endif
-
 #include <cmath>
 #include <type_traits>
 
+#include <executorch/kernels/optimized/cpu/softmax_utils.h>
 #include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -30,6 +26,9 @@ namespace {
 
 template <typename IN_T, typename OUT_T>
 void log_softmax_kernel(const Tensor& input, int64_t dim, Tensor& out) {
+  static_assert(
+      std::is_same<IN_T, OUT_T>::value,
+      "log_softmax is only vectorized without a dtype conversion");
   const IN_T* __restrict__ input_data_base = input.const_data_ptr<IN_T>();
   OUT_T* __restrict__ output_data_base = out.mutable_data_ptr<OUT_T>();
 
@@ -37,6 +36,9 @@ void log_softmax_kernel(const Tensor& input, int64_t dim, Tensor& out) {
     output_data_base[0] = 0;
     return;
   }
+  if (input.numel() == 0) {
+    return;
+  }
 
   int64_t dim_size = input.size(dim);
 
@@ -49,56 +51,8 @@ void log_softmax_kernel(const Tensor& input, int64_t dim, Tensor& out) {
     inner_size *= input.size(i);
   }
 
-  int64_t dim_stride = inner_size;
-  int64_t outer_stride = dim_size * dim_stride;
-
-  for (size_t outer_idx = 0; outer_idx < outer_size; ++outer_idx) {
-    for (size_t inner_idx = 0; inner_idx < inner_size; ++inner_idx) {
-      const IN_T* input_data =
-          input_data_base + outer_idx * outer_stride + inner_idx;
-      OUT_T* output_data =
-          output_data_base + outer_idx * outer_stride + inner_idx;
-
-      // calculate max in softmax dim
-      IN_T max_input = input_data[0];
-      for (auto d = 0; d < dim_size; ++d) {
-        max_input = std::max(max_input, input_data[d * dim_stride]);
-      }
-      // calculate sum and exponential in softmax dim
-      OUT_T temp_sum = 0;
-#ifndef __aarch64__
-      for (auto d = 0; d < dim_size; ++d) {
-        output_data[d * dim_stride] =
-            std::exp(input_data[d * dim_stride] - max_input);
-        temp_sum += output_data[d * dim_stride];
-      }
-#else
-      auto d = 0;
-      for (; d + 4 < dim_size; d += 4) {
-        auto index = d * dim_stride;
-        float32x4_t in =
-            vld1q_f32(static_cast<const float*>(&input_data[index]));
-        float32x4_t out_ =
-            Sleef_expf4_u10(vsubq_f32(in, vmovq_n_f32(max_input)));
-        vst1q_f32(static_cast<float*>(&output_data[index]), out_);
-        temp_sum += vaddvq_f32(out_);
-      }
-
-      for (; d < dim_size; ++d) {
-        output_data[d * dim_stride] =
-            std::exp(input_data[d * dim_stride] - max_input);
-        temp_sum += output_data[d * dim_stride];
-      }
-#endif // __aarch64__
-
-      temp_sum = std::log(temp_sum);
-
-      for (auto dd = 0; dd < dim_size; ++dd) {
-        output_data[dd * dim_stride] =
-            input_data[dd * dim_stride] - max_input - temp_sum;
-      }
-    }
-  }
+  vec_softmax</*kLogSoftmax=*/true>(
+      input_data_base, output_data_base, outer_size, dim_size, inner_size);
 }
 
 // OUT_T is the corresponding C++ type for out.scalar_type(). Only takes float
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/matmul_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+// mm.out(Tensor self, Tensor mat2, *, Tensor(a!) out) -> Tensor(a!)
+Tensor& opt_mm_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& mat2,
+    Tensor& out) {
+  ET_KERNEL_CHECK(ctx, check_mm_args(in, mat2, out), InvalidArgument, out);
+
+  size_t output_ndim = 0;
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  get_mm_out_target_size(in, mat2, output_sizes, &output_ndim);
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {output_sizes, output_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  ET_SWITCH_REAL_TYPES_AND(Half, in.scalar_type(), ctx, "mm.out", CTYPE, [&]() {
+    using executorch::cpublas::TransposeType;
+    const int64_t m = in.size(0);
+    const int64_t k = in.size(1);
+    const int64_t n = mat2.size(1);
+
+    // The row-major product out = in @ mat2 is the column-major product
+    // out^T = mat2^T @ in^T, which needs no transposes.
+    // clang-format off
+    executorch::cpublas::gemm(
+        TransposeType::NoTranspose, TransposeType::NoTranspose,
+        n, m, k,
+        static_cast<CTYPE>(1),
+        mat2.const_data_ptr<CTYPE>(), n,
+        in.const_data_ptr<CTYPE>(), k,
+        static_cast<CTYPE>(0),
+        out.mutable_data_ptr<CTYPE>(), n);
+    // clang-format on
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -34,8 +34,6 @@ bool can_use_optimized_path(
   bool can_use_optimized_path = true;
   can_use_optimized_path =
       can_use_optimized_path && ((a_type == b_type) && (a_type == out_type));
-  can_use_optimized_path = can_use_optimized_path &&
-      (a_type != ScalarType::Half && b_type != ScalarType::Half);
   can_use_optimized_path = can_use_optimized_path &&
       (a.sizes().equals(b.sizes()) ||
        (a.numel() == b.numel() && a.numel() == out.numel()));
@@ -108,6 +106,18 @@ Tensor& opt_mul_out(
         out,
         "Failed to resize output tensor.");
 
+    if (out_type == ScalarType::Half) {
+      // Computed in float, like the broadcasting path below.
+      using fVec = executorch::vec::Vectorized<float>;
+      executorch::vec::map2<exec_aten::Half>(
+          [](fVec x, fVec y) { return x * y; },
+          out.mutable_data_ptr<exec_aten::Half>(),
+          a.const_data_ptr<exec_aten::Half>(),
+          b.const_data_ptr<exec_aten::Half>(),
+          out.numel());
+      return out;
+    }
+
     ET_SWITCH_REALB_TYPES(out_type, ctx, "mul.out", CTYPE, [&]() {
       using Vec = executorch::vec::Vectorized<CTYPE>;
       executorch::vec::map2<CTYPE>(
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <tuple>
+
+#include <executorch/kernels/optimized/cpu/normalization_utils.h>
+#include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+std::tuple<Tensor&, Tensor&, Tensor&>
+opt_native_batch_norm_legit_no_training_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    const Tensor& running_mean,
+    const Tensor& running_var,
+    double momentum,
+    double eps,
+    Tensor& out,
+    Tensor& mean_out,
+    Tensor& invstd_out) {
+  std::tuple<Tensor&, Tensor&, Tensor&> ret_val(out, mean_out, invstd_out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, in.sizes()) == Error::Ok,
+      InvalidArgument,
+      ret_val);
+
+  ET_KERNEL_CHECK(
+      ctx, resize_tensor(mean_out, {0}) == Error::Ok, InvalidArgument, ret_val);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(invstd_out, {0}) == Error::Ok,
+      InvalidArgument,
+      ret_val);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      check_batch_norm_args(
+          in,
+          weight,
+          bias,
+          running_mean,
+          running_var,
+          momentum,
+          eps,
+          out,
+          mean_out,
+          invstd_out),
+      InvalidArgument,
+      ret_val);
+
+  bool channels_last = false;
+  ET_KERNEL_CHECK(
+      ctx,
+      internal::check_batch_norm_layout(in, out, &channels_last),
+      InvalidArgument,
+      ret_val);
+
+  constexpr auto name = "_native_batch_norm_legit_no_training.out";
+
+  ET_SWITCH_FLOAT_TYPES(in.scalar_type(), ctx, name, CTYPE, [&] {
+    internal::batch_norm<CTYPE, internal::NormActivation::kNone>(
+        in, weight, bias, running_mean, running_var, eps, channels_last, out);
+  });
+
+  return ret_val;
+}
+
+std::tuple<Tensor&, Tensor&, Tensor&> opt_native_batch_norm_legit_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    Tensor& running_mean,
+    Tensor& running_var,
+    bool training,
+    double momentum,
+    double eps,
+    Tensor& out,
+    Tensor& mean_out,
+    Tensor& invstd_out) {
+  std::tuple<Tensor&, Tensor&, Tensor&> ret_val(out, mean_out, invstd_out);
+
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      training == false,
+      InvalidArgument,
+      ret_val,
+      "Optimized kernels only support inference mode!");
+
+  return opt_native_batch_norm_legit_no_training_out(
+      ctx,
+      in,
+      weight,
+      bias,
+      running_mean,
+      running_var,
+      momentum,
+      eps,
+      out,
+      mean_out,
+      invstd_out);
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
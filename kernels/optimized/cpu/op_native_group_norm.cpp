@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <tuple>
+
+#include <executorch/kernels/optimized/cpu/normalization_utils.h>
+#include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+std::tuple<Tensor&, Tensor&, Tensor&> opt_native_group_norm_out(
+    RuntimeContext& ctx,
+    const Tensor& input,
+    const exec_aten::optional<Tensor>& weight,
+    const exec_aten::optional<Tensor>& bias,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps,
+    Tensor& out,
+    Tensor& mean_out,
+    Tensor& rstd_out) {
+  std::tuple<Tensor&, Tensor&, Tensor&> ret_val(out, mean_out, rstd_out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      check_group_norm_args(
+          input, weight, bias, N, C, HxW, group, out, mean_out, rstd_out),
+      InvalidArgument,
+      ret_val);
+
+  Tensor::SizesType mean_rstd_sizes[kTensorDimensionLimit];
+  mean_rstd_sizes[0] = N;
+  mean_rstd_sizes[1] = group;
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, input.sizes()) == Error::Ok,
+      InvalidArgument,
+      ret_val);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(mean_out, {mean_rstd_sizes, 2}) == Error::Ok,
+      InvalidArgument,
+      ret_val);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(rstd_out, {mean_rstd_sizes, 2}) == Error::Ok,
+      InvalidArgument,
+      ret_val);
+
+  ET_SWITCH_FLOAT_TYPES(
+      input.scalar_type(), ctx, "native_group_norm.out", CTYPE, [&]() {
+        internal::group_norm<CTYPE, internal::NormActivation::kNone>(
+            input,
+            weight,
+            bias,
+            N,
+            C,
+            HxW,
+            group,
+            eps,
+            out,
+            mean_out.mutable_data_ptr<CTYPE>(),
+            rstd_out.mutable_data_ptr<CTYPE>());
+      });
+
+  return ret_val;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <cmath>
 #include <tuple>
@@ -14,6 +15,7 @@
 #include <executorch/kernels/optimized/vec/functional.h>
 #include <executorch/kernels/optimized/vec/vec.h>
 #include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 
 namespace torch {
 namespace executor {
@@ -74,39 +76,42 @@ void layer_norm(
   const bool gamma_null = gamma_data == nullptr;
   const bool beta_null = beta_data == nullptr;
 
-  for (size_t i = 0; i < M; ++i) {
-    const CTYPE* src_ptr = input_data + i * N;
-    CTYPE* dst_ptr = out_data + i * N;
-
-    CTYPE mean_val;
-    CTYPE rstd_val;
-    std::tie(mean_val, rstd_val) = RowwiseMoments(src_ptr, N);
-    rstd_val = CTYPE(1) / std::sqrt(rstd_val + eps);
-
-    const CTYPE scale = rstd_val;
-    const CTYPE offset = -rstd_val * mean_val;
-
-    if (gamma_null || beta_null) {
-      for (size_t j = 0; j < N; ++j) {
-        const CTYPE gamma_v = gamma_null ? CTYPE(1) : gamma_data[j];
-        const CTYPE beta_v = beta_null ? CTYPE(0) : beta_data[j];
-        dst_ptr[j] = (src_ptr[j] * scale + offset) * gamma_v + beta_v;
-      }
-    } else {
-      executorch::vec::map3<CTYPE>(
-          [scale, offset](Vec x, Vec gamma, Vec beta) {
-            return (x * Vec(scale) + Vec(offset)) * gamma + beta;
-          },
-          dst_ptr,
-          src_ptr,
-          gamma_data,
-          beta_data,
-          N);
-    }
-
-    mean_data[i] = mean_val;
-    rstd_data[i] = rstd_val;
-  }
+  parallel_for_each_chunk(
+      0, M, 2 * N, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const CTYPE* src_ptr = input_data + i * N;
+          CTYPE* dst_ptr = out_data + i * N;
+
+          CTYPE mean_val;
+          CTYPE rstd_val;
+          std::tie(mean_val, rstd_val) = RowwiseMoments(src_ptr, N);
+          rstd_val = CTYPE(1) / std::sqrt(rstd_val + eps);
+
+          const CTYPE scale = rstd_val;
+          const CTYPE offset = -rstd_val * mean_val;
+
+          if (gamma_null || beta_null) {
+            for (size_t j = 0; j < N; ++j) {
+              const CTYPE gamma_v = gamma_null ? CTYPE(1) : gamma_data[j];
+              const CTYPE beta_v = beta_null ? CTYPE(0) : beta_data[j];
+              dst_ptr[j] = (src_ptr[j] * scale + offset) * gamma_v + beta_v;
+            }
+          } else {
+            executorch::vec::map3<CTYPE>(
+                [scale, offset](Vec x, Vec gamma, Vec beta) {
+                  return (x * Vec(scale) + Vec(offset)) * gamma + beta;
+                },
+                dst_ptr,
+                src_ptr,
+                gamma_data,
+                beta_data,
+                N);
+          }
+
+          mean_data[i] = mean_val;
+          rstd_data[i] = rstd_val;
+        }
+      });
 }
 
 } // namespace
@@ -8,6 +8,7 @@
 
 #include <executorch/kernels/optimized/vec/functional.h>
 #include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
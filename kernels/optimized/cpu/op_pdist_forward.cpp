@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/cpu/distance_utils.h>
+#include <executorch/kernels/portable/cpu/util/distance_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+/**
+ * Writes the distance between every pair of rows i < j of `in`, in
+ * row-major order of the pairs. Row i has n - i - 1 pairs, so the rows are
+ * claimed dynamically by the threads; within a chunk of rows the later rows
+ * are visited a tile at a time, as in pairwise_distances().
+ */
+template <typename CTYPE, typename Dist>
+void pdist_rows(const Tensor& in, Tensor& out, const double p) {
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+
+  const int64_t n = in.size(0);
+  const int64_t m = in.size(1);
+  const int64_t tile = internal::distance_tile_rows<CTYPE>(m);
+
+  parallel_for_each_chunk_dynamic(
+      0, n, n * m / 2, [&](const int64_t begin, const int64_t end) {
+        for (int64_t j0 = begin + 1; j0 < n; j0 += tile) {
+          const int64_t j1 = std::min(n, j0 + tile);
+          for (int64_t i = begin; i < end && i < j1 - 1; ++i) {
+            const CTYPE* const row_i = in_data + i * m;
+            // The pairs of row i follow the n - k - 1 pairs of each earlier
+            // row k; pair (i, j) is the (j - i - 1)-th of them.
+            const int64_t out_offset = i * n - i * (i + 1) / 2 - i - 1;
+            for (int64_t j = std::max(j0, i + 1); j < j1; ++j) {
+              out_data[out_offset + j] = Dist::compute(
+                  row_i, in_data + j * m, m, static_cast<CTYPE>(p));
+            }
+          }
+        }
+      });
+}
+
+} // namespace
+
+Tensor& opt_pdist_forward_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    double p,
+    Tensor& out) {
+  ET_KERNEL_CHECK(ctx, check_pdist_args(in, p, out), InvalidArgument, out);
+
+  Tensor::SizesType target_sizes[kTensorDimensionLimit];
+  size_t target_ndim = 0;
+  get_pdist_out_target_size(in, target_sizes, &target_ndim);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(out, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  ScalarType in_type = in.scalar_type();
+  constexpr auto name = "_pdist_forward.out";
+
+  ET_SWITCH_FLOAT_TYPES(in_type, ctx, name, CTYPE, [&] {
+    if (in.size(1) == 0) {
+      CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+      std::fill(out_data, out_data + out.numel(), static_cast<CTYPE>(0));
+      return;
+    }
+    internal::dispatch_distance<CTYPE>(p, [&](auto dist) {
+      pdist_rows<CTYPE, decltype(dist)>(in, out, p);
+    });
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,1073 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/optimized/cpu/op_sdpa.h>
+
+#include <executorch/kernels/optimized/blas/CPUBlas.h>
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+namespace vec = ::executorch::vec;
+using Vec = vec::Vectorized<float>;
+using executorch::cpublas::TransposeType;
+
+// Largest magnitude of a symmetrically quantized int8 cache entry.
+constexpr float kQuantizedCacheMax = 127.0f;
+
+template <typename T>
+inline T data_index_init(T offset) {
+  return offset;
+}
+
+template <typename T, typename... Args>
+inline T data_index_init(T offset, T& x, const T& X, Args&&... args) {
+  offset = data_index_init(offset, std::forward<Args>(args)...);
+  x = offset % X;
+  return offset / X;
+}
+
+inline bool data_index_step() {
+  return true;
+}
+
+template <typename T, typename... Args>
+inline bool data_index_step(T& x, const T& X, Args&&... args) {
+  if (data_index_step(std::forward<Args>(args)...)) {
+    x = ((x + 1) == X) ? 0 : (x + 1);
+    return x == 0;
+  }
+  return false;
+}
+
+// 1) out = exp(a - val)
+// 2) val = sum(out)
+inline void _exp_reduce_sum_fusion_kernel(
+    float* a,
+    const int& size,
+    float* out,
+    float& val) {
+  auto vec_size = Vec::size();
+  auto vec_max = Vec(val);
+  float tmp_sum = 0;
+  auto vec_tmp_sum = Vec(tmp_sum);
+  for (int i = 0; i < vec_size * (size / vec_size); i += vec_size) {
+    auto tmp0 = Vec::loadu(a + i);
+    auto tmp1 = tmp0 - vec_max;
+    auto tmp2 = tmp1.exp();
+    vec_tmp_sum += tmp2;
+    tmp2.store(out + i);
+  }
+  tmp_sum = vec::vec_reduce_all<float>(
+      [](Vec& x, Vec& y) { return x + y; }, vec_tmp_sum);
+  for (int i = vec_size * (size / vec_size); i < size; i++) {
+    auto tmp0 = a[i];
+    auto tmp1 = tmp0 - val;
+    auto tmp2 = std::exp(tmp1);
+    tmp_sum += tmp2;
+    out[i] = tmp2;
+  }
+  val = tmp_sum;
+}
+
+// 1) out = a * scale
+// 2) max = max(out)
+inline void _mul_reduce_max_fusion_kernel(
+    const float* a,
+    const float& scale,
+    const int& size,
+    float* out,
+    float& max) {
+  auto vec_size = Vec::size();
+  auto vec_scale = Vec(scale);
+  float tmp_max = -std::numeric_limits<float>::infinity();
+  auto vec_tmp_max = Vec(tmp_max);
+  for (int i = 0; i < vec_size * (size / vec_size); i += vec_size) {
+    auto tmp0 = Vec::loadu(a + i);
+    auto tmp1 = tmp0 * vec_scale;
+    vec_tmp_max = vec::maximum(vec_tmp_max, tmp1);
+    tmp1.store(out + i);
+  }
+  for (int i = vec_size * (size / vec_size); i < size; i++) {
+    auto tmp0 = a[i];
+    auto tmp1 = tmp0 * scale;
+    tmp_max = std::max(tmp_max, tmp1);
+    out[i] = tmp1;
+  }
+  max = std::max(
+      tmp_max,
+      vec::vec_reduce_all<float>(
+          [](Vec& x, Vec& y) { return vec::maximum(x, y); }, vec_tmp_max));
+}
+
+inline void fill_stub(float* data, float val, int64_t size) {
+  Vec data_vec = Vec(val);
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    data_vec.store(data + d);
+  }
+  for (; d < size; d++) {
+    data[d] = val;
+  }
+}
+
+/**
+ * Where the [head dim] rows of an attention operand live: row (b, h, n)
+ * starts at element b * stride_b + h * stride_h + n * stride_n. Covers both
+ * the [batch, heads, seq, dim] layout of plain attention and the
+ * [batch, seq, heads, dim] layout of the kv caches.
+ */
+struct RowLayout {
+  int64_t stride_b;
+  int64_t stride_h;
+  int64_t stride_n;
+
+  int64_t offset(int64_t b, int64_t h, int64_t n) const {
+    return b * stride_b + h * stride_h + n * stride_n;
+  }
+};
+
+RowLayout get_row_layout(const Tensor& t, bool seq_dim_first) {
+  const auto strides = t.strides();
+  if (seq_dim_first) {
+    return {strides[0], strides[2], strides[1]};
+  }
+  return {strides[0], strides[1], strides[2]};
+}
+
+/**
+ * A key or value operand of the attention. Float operands are read in
+ * place; Half and BFloat16 operands are converted, and Char operands are
+ * dequantized with one scale per row, into float scratch a block of rows at
+ * a time.
+ */
+struct KVOperand {
+  const void* data;
+  ScalarType dtype;
+  RowLayout layout;
+  const float* scales;
+  RowLayout scale_layout;
+};
+
+KVOperand make_kv_operand(const Tensor& t, bool seq_dim_first) {
+  return {
+      t.const_data_ptr(),
+      t.scalar_type(),
+      get_row_layout(t, seq_dim_first),
+      nullptr,
+      {0, 0, 0}};
+}
+
+KVOperand make_quantized_kv_operand(const Tensor& t, const Tensor& scales) {
+  return {
+      t.const_data_ptr(),
+      t.scalar_type(),
+      get_row_layout(t, /*seq_dim_first=*/true),
+      scales.const_data_ptr<float>(),
+      get_row_layout(scales, /*seq_dim_first=*/true)};
+}
+
+inline float to_float(const exec_aten::Half value) {
+  return static_cast<float>(value);
+}
+
+// BFloat16 is plain storage here, so convert through its bit pattern: the
+// upper half of a float.
+inline float to_float(const exec_aten::BFloat16 value) {
+  const uint32_t bits = static_cast<uint32_t>(value.x) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+inline void from_float(const float value, exec_aten::Half* dst) {
+  *dst = exec_aten::Half(value);
+}
+
+// Rounds to nearest even, and keeps NaNs quiet.
+inline void from_float(const float value, exec_aten::BFloat16* dst) {
+  if (std::isnan(value)) {
+    dst->x = 0x7fc0;
+    return;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits += 0x7fff + ((bits >> 16) & 1);
+  dst->x = static_cast<uint16_t>(bits >> 16);
+}
+
+template <typename CTYPE>
+void convert_rows(
+    const CTYPE* src,
+    int64_t src_stride,
+    int64_t rows,
+    int64_t head_size,
+    float* dst) {
+  for (int64_t row = 0; row < rows; ++row) {
+    const CTYPE* src_row = src + row * src_stride;
+    float* dst_row = dst + row * head_size;
+    for (int64_t d = 0; d < head_size; ++d) {
+      dst_row[d] = to_float(src_row[d]);
+    }
+  }
+}
+
+void dequantize_rows(
+    const int8_t* src,
+    int64_t src_stride,
+    const float* scales,
+    int64_t scale_stride,
+    int64_t rows,
+    int64_t head_size,
+    float* dst) {
+  for (int64_t row = 0; row < rows; ++row) {
+    const int8_t* src_row = src + row * src_stride;
+    const float row_scale = scales[row * scale_stride];
+    float* dst_row = dst + row * head_size;
+    for (int64_t d = 0; d < head_size; ++d) {
+      dst_row[d] = static_cast<float>(src_row[d]) * row_scale;
+    }
+  }
+}
+
+/**
+ * Returns rows [n, n + rows) of head h of batch b of `operand` as float, and
+ * sets `ld` to the distance between consecutive rows. Float operands are
+ * returned in place; anything else is written to `scratch`, which must hold
+ * rows * head_size floats.
+ */
+const float* load_kv_rows(
+    const KVOperand& operand,
+    int64_t b,
+    int64_t h,
+    int64_t n,
+    int64_t rows,
+    int64_t head_size,
+    float* scratch,
+    int64_t& ld) {
+  const int64_t offset = operand.layout.offset(b, h, n);
+  const int64_t stride = operand.layout.stride_n;
+  ld = head_size;
+  switch (operand.dtype) {
+    case ScalarType::Half:
+      convert_rows(
+          static_cast<const exec_aten::Half*>(operand.data) + offset,
+          stride,
+          rows,
+          head_size,
+          scratch);
+      return scratch;
+    case ScalarType::BFloat16:
+      convert_rows(
+          static_cast<const exec_aten::BFloat16*>(operand.data) + offset,
+          stride,
+          rows,
+          head_size,
+          scratch);
+      return scratch;
+    case ScalarType::Char:
+      dequantize_rows(
+          static_cast<const int8_t*>(operand.data) + offset,
+          stride,
+          operand.scales + operand.scale_layout.offset(b, h, n),
+          operand.scale_layout.stride_n,
+          rows,
+          head_size,
+          scratch);
+      return scratch;
+    default:
+      ld = stride;
+      return static_cast<const float*>(operand.data) + offset;
+  }
+}
+
+struct AttentionShape {
+  int64_t batch_size;
+  int64_t num_heads;
+  int64_t num_kv_heads;
+  int64_t q_size;
+  int64_t kv_size;
+  int64_t head_size;
+};
+
+/**
+ * Tiled attention with an online softmax. Work is split over
+ * (batch, kv head, query block), and each work item computes every query
+ * head that shares its kv head, so a block of keys and values is loaded (and
+ * converted, if needed) once per group of query heads instead of once per
+ * query head.
+ *
+ * With is_causal set, query row i may attend keys [0, causal_offset + i].
+ */
+template <int64_t q_split_size, int64_t kv_split_size>
+void cpu_flash_attention(
+    const float* q_data,
+    const RowLayout& q_layout,
+    const KVOperand& key,
+    const KVOperand& value,
+    float* out_data,
+    const RowLayout& out_layout,
+    const AttentionShape& shape,
+    const float* mask_data,
+    int64_t mask_stride_m,
+    bool is_causal,
+    int64_t causal_offset,
+    float scaling_factor) {
+  const int64_t batchSize = shape.batch_size;
+  const int64_t num_heads_kv = shape.num_kv_heads;
+  const int64_t qSize = shape.q_size;
+  const int64_t kvSize = shape.kv_size;
+  const int64_t headSize = shape.head_size;
+  const int64_t num_reps = shape.num_heads / num_heads_kv;
+
+  const int64_t qSplitSize = q_split_size > qSize ? qSize : q_split_size;
+  const int64_t kvSplitSize = kv_split_size > kvSize ? kvSize : kv_split_size;
+  const int64_t qSlice = (qSize - 1) / qSplitSize + 1;
+  const bool kv_needs_conversion =
+      key.dtype != ScalarType::Float || value.dtype != ScalarType::Float;
+
+  auto compute_chunk = [&](int64_t begin, int64_t end) {
+    // Scratch for this chunk: scores of one query block against one kv
+    // block, the running max, sum and output of every query head in the
+    // group, and the converted kv block.
+    std::vector<float> qk_vec(qSplitSize * kvSplitSize);
+    std::vector<float> qk_max_vec(num_reps * qSplitSize);
+    std::vector<float> qk_sum_vec(num_reps * qSplitSize);
+    std::vector<float> dst_vec(num_reps * qSplitSize * headSize);
+    std::vector<float> kv_scratch_vec(
+        kv_needs_conversion ? 2 * kvSplitSize * headSize : 0);
+    float* qk_data = qk_vec.data();
+    float* k_scratch = kv_needs_conversion ? kv_scratch_vec.data() : nullptr;
+    float* v_scratch =
+        kv_needs_conversion ? k_scratch + kvSplitSize * headSize : nullptr;
+
+    int64_t i = 0, j_kv = 0, k = 0;
+    data_index_init(begin, i, batchSize, j_kv, num_heads_kv, k, qSlice);
+    for (int64_t z = begin; z < end; z++) {
+      const int64_t m = k * qSplitSize;
+      const int64_t qBlockSize = std::min(qSplitSize, qSize - m);
+      fill_stub(
+          qk_max_vec.data(),
+          -std::numeric_limits<float>::infinity(),
+          num_reps * qSplitSize);
+      fill_stub(qk_sum_vec.data(), 0.0f, num_reps * qSplitSize);
+      const int64_t num_keys = is_causal
+          ? std::min(causal_offset + m + qBlockSize, kvSize)
+          : kvSize;
+      for (int64_t n = 0; n < num_keys; n += kvSplitSize) {
+        const int64_t kvBlockSize = std::min(kvSplitSize, num_keys - n);
+        int64_t ldk = 0, ldv = 0;
+        const float* k_block = load_kv_rows(
+            key, i, j_kv, n, kvBlockSize, headSize, k_scratch, ldk);
+        const float* v_block = load_kv_rows(
+            value, i, j_kv, n, kvBlockSize, headSize, v_scratch, ldv);
+        // Only blocks that reach past the first row's last visible key need
+        // the causal mask.
+        const bool apply_causal_mask =
+            is_causal && n + kvBlockSize > causal_offset + m + 1;
+
+        for (int64_t rep = 0; rep < num_reps; ++rep) {
+          const int64_t j = j_kv * num_reps + rep;
+          float* qk_max_data = qk_max_vec.data() + rep * qSplitSize;
+          float* qk_sum_data = qk_sum_vec.data() + rep * qSplitSize;
+          float* dst_data = dst_vec.data() + rep * qSplitSize * headSize;
+
+          // Calculate q @ k.T
+          ::executorch::cpublas::gemm(
+              TransposeType::Transpose,
+              TransposeType::NoTranspose,
+              kvBlockSize,
+              qBlockSize,
+              headSize,
+              1.0f,
+              k_block,
+              ldk,
+              q_data + q_layout.offset(i, j, m),
+              q_layout.stride_n,
+              0.0f,
+              qk_data,
+              kvBlockSize);
+          // Apply causal mask, fill unused with -inf
+          if (apply_causal_mask) {
+            for (int64_t row = 0; row < qBlockSize; ++row) {
+              const int64_t first_masked =
+                  std::max<int64_t>(causal_offset + m + row - n + 1, 0);
+              if (first_masked < kvBlockSize) {
+                fill_stub(
+                    qk_data + row * kvBlockSize + first_masked,
+                    -std::numeric_limits<float>::infinity(),
+                    kvBlockSize - first_masked);
+              }
+            }
+          }
+          // qk <- qk * scaling + attn_mask
+          if (mask_data != nullptr) {
+            for (int64_t row = 0; row < qBlockSize; ++row) {
+              vec::map2<float>(
+                  [scaling_factor](Vec x, Vec y) {
+                    return x * Vec(scaling_factor) + y;
+                  },
+                  qk_data + row * kvBlockSize,
+                  qk_data + row * kvBlockSize,
+                  mask_data + (m + row) * mask_stride_m + n,
+                  kvBlockSize);
+            }
+          }
+          // Update coefficients with Softmax
+          float tmp_max = 0, tmp_sum = 0, exp_tmp = 0;
+          for (int64_t row = 0; row < qBlockSize; ++row) {
+            if (mask_data != nullptr) {
+              // max per row
+              tmp_max = vec::reduce_all<float>(
+                  [](Vec& x, Vec& y) { return vec::maximum(x, y); },
+                  qk_data + row * kvBlockSize,
+                  kvBlockSize);
+            } else {
+              // apply scaling factor and max per row in fusion
+              _mul_reduce_max_fusion_kernel(
+                  qk_data + row * kvBlockSize,
+                  scaling_factor,
+                  kvBlockSize,
+                  qk_data + row * kvBlockSize,
+                  tmp_max);
+            }
+            tmp_max = qk_max_data[row] > tmp_max ? qk_max_data[row] : tmp_max;
+            // qk <- exp(qk - max) and sum per row
+            tmp_sum = tmp_max;
+            _exp_reduce_sum_fusion_kernel(
+                qk_data + row * kvBlockSize,
+                kvBlockSize,
+                qk_data + row * kvBlockSize,
+                tmp_sum);
+            // exp_tmp <- exp(max[row] - max)
+            exp_tmp = std::exp(qk_max_data[row] - tmp_max);
+            // sum[row] <- sum + exp_tmp * sum[row]
+            qk_sum_data[row] = tmp_sum + exp_tmp * qk_sum_data[row];
+            // max[row] <- max
+            qk_max_data[row] = tmp_max;
+            // dst <- dst * exp_tmp
+            if (n > 0) {
+              vec::map<float>(
+                  [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
+                  dst_data + row * headSize,
+                  dst_data + row * headSize,
+                  headSize);
+            }
+          }
+          // Calculate Softmax(q @ k.T) @ v
+          ::executorch::cpublas::gemm(
+              TransposeType::NoTranspose,
+              TransposeType::NoTranspose,
+              headSize,
+              qBlockSize,
+              kvBlockSize,
+              1.0f,
+              v_block,
+              ldv,
+              qk_data,
+              kvBlockSize,
+              n == 0 ? 0.0f : 1.0f,
+              dst_data,
+              headSize);
+        }
+      }
+      // dst <- dst / sum[row]
+      // reorder MHA output with strides
+      for (int64_t rep = 0; rep < num_reps; ++rep) {
+        const int64_t j = j_kv * num_reps + rep;
+        const float* qk_sum_data = qk_sum_vec.data() + rep * qSplitSize;
+        const float* dst_data = dst_vec.data() + rep * qSplitSize * headSize;
+        for (int64_t row = 0; row < qBlockSize; ++row) {
+          const float sum_reciprocal = 1 / qk_sum_data[row];
+          vec::map<float>(
+              [sum_reciprocal](Vec x) { return x * Vec(sum_reciprocal); },
+              out_data + out_layout.offset(i, j, m + row),
+              dst_data + row * headSize,
+              headSize);
+        }
+      }
+      // Move to the next query block
+      data_index_step(i, batchSize, j_kv, num_heads_kv, k, qSlice);
+    }
+  };
+
+  const int64_t work_per_item = num_reps * qSplitSize * kvSize * headSize;
+  if (is_causal) {
+    // Under a causal mask, later query blocks attend to more keys, so the
+    // blocks are handed out dynamically instead of in equal shares.
+    parallel_for_each_chunk_dynamic(
+        0, batchSize * num_heads_kv * qSlice, work_per_item / 2, compute_chunk);
+  } else {
+    parallel_for_each_chunk(
+        0, batchSize * num_heads_kv * qSlice, work_per_item, compute_chunk);
+  }
+}
+
+void run_flash_attention(
+    const float* q_data,
+    const RowLayout& q_layout,
+    const KVOperand& key,
+    const KVOperand& value,
+    float* out_data,
+    const RowLayout& out_layout,
+    const AttentionShape& shape,
+    const optional<Tensor>& attn_mask,
+    bool is_causal,
+    int64_t causal_offset,
+    float scaling_factor) {
+  const bool has_attn_mask = attn_mask.has_value() && attn_mask.value().numel();
+  const float* mask_data =
+      has_attn_mask ? attn_mask.value().const_data_ptr<float>() : nullptr;
+  const int64_t mask_stride_m =
+      has_attn_mask ? attn_mask.value().strides()[0] : 0;
+
+  // TODO we need to re-evaluate this for ARM CPUs
+  // And there can be many so instead of templatizing
+  // we might consider another appraoch
+  if (shape.q_size >= 768) {
+    cpu_flash_attention<256, 512>(
+        q_data,
+        q_layout,
+        key,
+        value,
+        out_data,
+        out_layout,
+        shape,
+        mask_data,
+        mask_stride_m,
+        is_causal,
+        causal_offset,
+        scaling_factor);
+  } else if (shape.q_size >= 192) {
+    cpu_flash_attention<64, 512>(
+        q_data,
+        q_layout,
+        key,
+        value,
+        out_data,
+        out_layout,
+        shape,
+        mask_data,
+        mask_stride_m,
+        is_causal,
+        causal_offset,
+        scaling_factor);
+  } else {
+    cpu_flash_attention<32, 512>(
+        q_data,
+        q_layout,
+        key,
+        value,
+        out_data,
+        out_layout,
+        shape,
+        mask_data,
+        mask_stride_m,
+        is_causal,
+        causal_offset,
+        scaling_factor);
+  }
+}
+
+float calculate_scale(int64_t head_size, const optional<double>& scale) {
+  return static_cast<float>(
+      scale.has_value() ? scale.value() : 1.0 / std::sqrt(head_size));
+}
+
+bool validate_attn_mask(
+    const optional<Tensor>& attn_mask,
+    int64_t q_size,
+    int64_t kv_size) {
+  if (!attn_mask.has_value() || attn_mask.value().numel() == 0) {
+    return true;
+  }
+  const Tensor& mask = attn_mask.value();
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      mask.dim() == 2, "Attention mask must be a 2D tensor");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      mask.scalar_type() == ScalarType::Float,
+      "Attention mask must be Float type");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      mask.size(0) == q_size && mask.size(1) == kv_size,
+      "Attention mask must have shape [%" PRId64 ", %" PRId64
+      "], got [%zd, %zd]",
+      q_size,
+      kv_size,
+      mask.size(0),
+      mask.size(1));
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(mask.dim_order().data(), mask.dim()),
+      "Attention mask must be in contiguous dim order");
+  return true;
+}
+
+bool validate_num_heads(int64_t num_heads, int64_t num_kv_heads) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      num_kv_heads > 0 && num_heads % num_kv_heads == 0,
+      "Number of query heads (%" PRId64
+      ") must be a multiple of the number of kv heads (%" PRId64 ")",
+      num_heads,
+      num_kv_heads);
+  return true;
+}
+
+bool validate_flash_attention_args(
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    const optional<Tensor>& attn_mask) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(query.dim() == 4, "query must be a 4D tensor");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(key.dim() == 4, "key must be a 4D tensor");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(value.dim() == 4, "value must be a 4D tensor");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      (query.size(3) == value.size(3)) && (key.size(3) == value.size(3)),
+      "scaled_dot_product_attention_flash_attention: Q/K/V should have the same head size");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      key.size(0) == query.size(0) && value.size(0) == query.size(0) &&
+          key.size(1) == value.size(1) && key.size(2) == value.size(2),
+      "Key and value must have matching batch, head and sequence sizes");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      (query.scalar_type() == ScalarType::Float), "Query must be Float type");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      (query.scalar_type() == key.scalar_type()) &&
+          (query.scalar_type() == value.scalar_type()),
+      "Key and Value must have the same data type as Query");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(query.dim_order().data(), query.dim()),
+      "query must be in contiguous dim order");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(key.dim_order().data(), key.dim()),
+      "key must be in contiguous dim order");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(value.dim_order().data(), value.dim()),
+      "value must be in contiguous dim order");
+
+  return validate_num_heads(query.size(1), key.size(1)) &&
+      validate_attn_mask(attn_mask, query.size(2), key.size(2));
+}
+
+bool validate_cache_params(
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    int64_t start_pos,
+    int64_t seq_length) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      k_cache.dim() == 4, "kcache must be a 4D tensor");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      v_cache.dim() == 4, "v_cache must be a 4D tensor");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      k_cache.sizes() == v_cache.sizes(),
+      "key cache and value cache must have the same size");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      k_cache.scalar_type() == v_cache.scalar_type(),
+      "key cache and value cache must have the same dtype");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      start_pos >= 0 && seq_length > 0,
+      "start_pos must be non-negative and seq_length must be positive");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      (start_pos + seq_length) <= k_cache.size(1),
+      "start_post + seq_length must be less than max seq length supported by key cache."
+      "start pos: %" PRId64 ", seq_length: %" PRId64
+      "."
+      "key cache size: %zd",
+      start_pos,
+      seq_length,
+      k_cache.size(1));
+
+  // Make sure they are in contiguous dim order
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(k_cache.dim_order().data(), k_cache.dim()),
+      "key cache must be in contiguous dim order");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(v_cache.dim_order().data(), v_cache.dim()),
+      "value cache must be in contiguous dim order");
+
+  return true;
+}
+
+bool validate_projected_args(
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    const Tensor& key_cache,
+    int64_t seq_len) {
+  for (const Tensor* t : {&q_projected, &k_projected, &v_projected}) {
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        t->dim() == 4, "q, k and v must be 4D tensors");
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        t->scalar_type() == ScalarType::Float,
+        "q, k and v must be Float type");
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        t->size(0) == key_cache.size(0) && t->size(1) == seq_len &&
+            t->size(3) == key_cache.size(3),
+        "q, k and v must have shape [batch, seq_len, heads, head dim] "
+        "matching the cache");
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        is_contiguous_dim_order(t->dim_order().data(), t->dim()),
+        "q, k and v must be in contiguous dim order");
+  }
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      k_projected.size(2) == key_cache.size(2) &&
+          v_projected.size(2) == key_cache.size(2),
+      "k and v must have as many heads as the cache");
+  return validate_num_heads(q_projected.size(2), key_cache.size(2));
+}
+
+template <typename CTYPE>
+void convert_into_cache(const float* src, CTYPE* dst, int64_t numel) {
+  for (int64_t i = 0; i < numel; ++i) {
+    from_float(src[i], dst + i);
+  }
+}
+
+// Writes the [batch, seq_len, heads, head dim] rows of `projected` into
+// `cache` at start_pos, converting them to the dtype of the cache.
+void update_cache(const Tensor& projected, Tensor& cache, int64_t start_pos) {
+  const int64_t rows_numel =
+      projected.size(1) * projected.size(2) * projected.size(3);
+  const float* src_data = projected.const_data_ptr<float>();
+  const int64_t batch_stride = cache.strides()[0];
+  const int64_t pos_offset = start_pos * cache.strides()[1];
+  for (int64_t b = 0; b < projected.size(0); ++b) {
+    const float* src = src_data + b * rows_numel;
+    const int64_t dst_offset = b * batch_stride + pos_offset;
+    switch (cache.scalar_type()) {
+      case ScalarType::Half:
+        convert_into_cache(
+            src,
+            cache.mutable_data_ptr<exec_aten::Half>() + dst_offset,
+            rows_numel);
+        break;
+      case ScalarType::BFloat16:
+        convert_into_cache(
+            src,
+            cache.mutable_data_ptr<exec_aten::BFloat16>() + dst_offset,
+            rows_numel);
+        break;
+      default:
+        std::memcpy(
+            cache.mutable_data_ptr<float>() + dst_offset,
+            src,
+            rows_numel * sizeof(float));
+        break;
+    }
+  }
+}
+
+// Quantizes each [head dim] row of `projected` symmetrically to int8 and
+// writes it into `cache` at start_pos, with its scale in `scales`.
+void update_quantized_cache(
+    const Tensor& projected,
+    Tensor& cache,
+    Tensor& scales,
+    int64_t start_pos) {
+  const int64_t seq_len = projected.size(1);
+  const int64_t num_heads = projected.size(2);
+  const int64_t head_size = projected.size(3);
+  const float* src_data = projected.const_data_ptr<float>();
+  int8_t* cache_data = cache.mutable_data_ptr<int8_t>();
+  float* scales_data = scales.mutable_data_ptr<float>();
+  const RowLayout cache_layout = get_row_layout(cache, true);
+  const RowLayout scale_layout = get_row_layout(scales, true);
+  for (int64_t b = 0; b < projected.size(0); ++b) {
+    for (int64_t s = 0; s < seq_len; ++s) {
+      for (int64_t h = 0; h < num_heads; ++h) {
+        const float* src =
+            src_data + ((b * seq_len + s) * num_heads + h) * head_size;
+        int8_t* dst = cache_data + cache_layout.offset(b, h, start_pos + s);
+        float abs_max = 0;
+        for (int64_t d = 0; d < head_size; ++d) {
+          abs_max = std::max(abs_max, std::abs(src[d]));
+        }
+        const float inv_scale =
+            abs_max == 0 ? 0.0f : kQuantizedCacheMax / abs_max;
+        for (int64_t d = 0; d < head_size; ++d) {
+          const float q = std::nearbyint(src[d] * inv_scale);
+          dst[d] = static_cast<int8_t>(
+              std::min(std::max(q, -kQuantizedCacheMax), kQuantizedCacheMax));
+        }
+        scales_data[scale_layout.offset(b, h, start_pos + s)] =
+            abs_max / kQuantizedCacheMax;
+      }
+    }
+  }
+}
+
+bool validate_cache_scales(const Tensor& cache, const Tensor& scales) {
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      scales.scalar_type() == ScalarType::Float,
+      "kv cache scales must be Float type");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      scales.dim() == 4 && scales.size(0) == cache.size(0) &&
+          scales.size(1) == cache.size(1) && scales.size(2) == cache.size(2) &&
+          scales.size(3) == 1,
+      "kv cache scales must have shape [batch, max seq len, kv heads, 1]");
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      is_contiguous_dim_order(scales.dim_order().data(), scales.dim()),
+      "kv cache scales must be in contiguous dim order");
+  return true;
+}
+
+// Attends q_projected over the first start_pos + seq_len positions of the
+// key and value operands, which have already been updated.
+void run_sdpa_with_kv_cache(
+    const Tensor& q_projected,
+    const KVOperand& key,
+    const KVOperand& value,
+    const Tensor& key_cache,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    const optional<Tensor>& attn_mask,
+    const bool is_causal,
+    const optional<double>& scale,
+    Tensor& output) {
+  const AttentionShape shape{
+      q_projected.size(0),
+      q_projected.size(2),
+      key_cache.size(2),
+      seq_len,
+      start_pos + seq_len,
+      q_projected.size(3)};
+  run_flash_attention(
+      q_projected.const_data_ptr<float>(),
+      get_row_layout(q_projected, /*seq_dim_first=*/true),
+      key,
+      value,
+      output.mutable_data_ptr<float>(),
+      get_row_layout(output, /*seq_dim_first=*/true),
+      shape,
+      attn_mask,
+      is_causal,
+      /*causal_offset=*/start_pos,
+      calculate_scale(shape.head_size, scale));
+}
+
+} // namespace
+
+Tensor& opt_flash_attention_out(
+    RuntimeContext& ctx,
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  (void)dropout_p;
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_flash_attention_args(query, key, value, attn_mask),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(output, query.sizes()) == Error::Ok,
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx, output.scalar_type() == ScalarType::Float, InvalidArgument, output);
+
+  if (output.numel() == 0 || key.size(2) == 0) {
+    return output;
+  }
+
+  const AttentionShape shape{
+      query.size(0),
+      query.size(1),
+      key.size(1),
+      query.size(2),
+      key.size(2),
+      query.size(3)};
+  run_flash_attention(
+      query.const_data_ptr<float>(),
+      get_row_layout(query, /*seq_dim_first=*/false),
+      make_kv_operand(key, /*seq_dim_first=*/false),
+      make_kv_operand(value, /*seq_dim_first=*/false),
+      output.mutable_data_ptr<float>(),
+      get_row_layout(output, /*seq_dim_first=*/false),
+      shape,
+      attn_mask,
+      is_causal,
+      /*causal_offset=*/0,
+      calculate_scale(shape.head_size, scale));
+  return output;
+}
+
+Tensor& opt_sdpa_with_kv_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  (void)dropout_p;
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_cache_params(key_cache, value_cache, start_pos, seq_len),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      key_cache.scalar_type() == ScalarType::Float ||
+          key_cache.scalar_type() == ScalarType::Half ||
+          key_cache.scalar_type() == ScalarType::BFloat16,
+      InvalidArgument,
+      output,
+      "kv cache must be Float, Half or BFloat16 type");
+
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_projected_args(
+          q_projected, k_projected, v_projected, key_cache, seq_len) &&
+          validate_attn_mask(attn_mask, seq_len, start_pos + seq_len),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(output, q_projected.sizes()) == Error::Ok,
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx, output.scalar_type() == ScalarType::Float, InvalidArgument, output);
+
+  update_cache(k_projected, key_cache, start_pos);
+  update_cache(v_projected, value_cache, start_pos);
+
+  run_sdpa_with_kv_cache(
+      q_projected,
+      make_kv_operand(key_cache, /*seq_dim_first=*/true),
+      make_kv_operand(value_cache, /*seq_dim_first=*/true),
+      key_cache,
+      start_pos,
+      seq_len,
+      attn_mask,
+      is_causal,
+      scale,
+      output);
+  return output;
+}
+
+Tensor& opt_sdpa_with_quantized_kv_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    Tensor& key_cache_scales,
+    Tensor& value_cache_scales,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  (void)dropout_p;
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_cache_params(key_cache, value_cache, start_pos, seq_len),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      key_cache.scalar_type() == ScalarType::Char,
+      InvalidArgument,
+      output,
+      "quantized kv cache must be Char type");
+
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_cache_scales(key_cache, key_cache_scales) &&
+          validate_cache_scales(value_cache, value_cache_scales),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_projected_args(
+          q_projected, k_projected, v_projected, key_cache, seq_len) &&
+          validate_attn_mask(attn_mask, seq_len, start_pos + seq_len),
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(output, q_projected.sizes()) == Error::Ok,
+      InvalidArgument,
+      output);
+
+  ET_KERNEL_CHECK(
+      ctx, output.scalar_type() == ScalarType::Float, InvalidArgument, output);
+
+  update_quantized_cache(k_projected, key_cache, key_cache_scales, start_pos);
+  update_quantized_cache(
+      v_projected, value_cache, value_cache_scales, start_pos);
+
+  run_sdpa_with_kv_cache(
+      q_projected,
+      make_quantized_kv_operand(key_cache, key_cache_scales),
+      make_quantized_kv_operand(value_cache, value_cache_scales),
+      key_cache,
+      start_pos,
+      seq_len,
+      attn_mask,
+      is_causal,
+      scale,
+      output);
+  return output;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+/**
+ * Flash-attention style scaled dot product attention over
+ * [batch, num heads, seq len, head dim] query, key and value tensors.
+ *
+ * The query is tiled into blocks, and each block makes a single pass over the
+ * keys and values with an online softmax, so the full attention matrix is
+ * never materialized. Grouped-query attention is supported: key and value may
+ * have fewer heads than query, as long as they divide the number of query
+ * heads, and the kv heads are shared without being repeated in memory.
+ */
+Tensor& opt_flash_attention_out(
+    RuntimeContext& ctx,
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+/**
+ * Writes k_projected and v_projected into key_cache and value_cache at
+ * [start_pos, start_pos + seq_len), then attends q_projected over positions
+ * [0, start_pos + seq_len) of the caches.
+ *
+ * q_projected, k_projected and v_projected are Float tensors of shape
+ * [batch, seq_len, num heads, head dim]. The caches have shape
+ * [batch, max seq len, num kv heads, head dim] and may be Float, Half or
+ * BFloat16. Reduced-precision caches are converted to float one block of
+ * positions at a time, and all accumulation is done in float.
+ *
+ * When is_causal is set, query position i attends cache positions
+ * [0, start_pos + i], which makes chunked prefill and decode agree.
+ */
+Tensor& opt_sdpa_with_kv_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+/**
+ * Same as opt_sdpa_with_kv_cache_out, but with Char (int8) caches that hold a
+ * quarter of the bytes of a Float cache.
+ *
+ * Each [head dim] vector of the caches is quantized symmetrically with its
+ * own scale: key_cache_scales and value_cache_scales are Float tensors of
+ * shape [batch, max seq len, num kv heads, 1], written together with the
+ * caches. Blocks of the caches are dequantized into float scratch right
+ * before they are used.
+ */
+Tensor& opt_sdpa_with_quantized_kv_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q_projected,
+    const Tensor& k_projected,
+    const Tensor& v_projected,
+    Tensor& key_cache,
+    Tensor& value_cache,
+    Tensor& key_cache_scales,
+    Tensor& value_cache_scales,
+    const int64_t start_pos,
+    const int64_t seq_len,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+} // namespace native
+} // namespace executor
+} // namespace torch
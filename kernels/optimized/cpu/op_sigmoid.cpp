@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace {
+
+/**
+ * Fast path of sigmoid. When no casting is required, CPU vector intrinsics
+ * can be used.
+ */
+template <
+    typename CTYPE_IN,
+    typename CTYPE_OUT,
+    typename std::enable_if<
+        std::is_same<CTYPE_IN, CTYPE_OUT>::value &&
+            std::is_floating_point<CTYPE_IN>::value,
+        int>::type = 0>
+void sigmoid_data(
+    const CTYPE_IN* in_data,
+    const size_t numel,
+    CTYPE_OUT* out_data) {
+  using Vec = executorch::vec::Vectorized<CTYPE_IN>;
+  executorch::vec::map<CTYPE_IN>(
+      [](Vec x) {
+        const Vec one(CTYPE_IN(1));
+        return one / (one + x.neg().exp());
+      },
+      out_data,
+      in_data,
+      numel);
+}
+
+/**
+ * Slow path of sigmoid.
+ */
+template <
+    typename CTYPE_IN,
+    typename CTYPE_OUT,
+    typename std::enable_if<
+        !std::is_same<CTYPE_IN, CTYPE_OUT>::value ||
+            !std::is_floating_point<CTYPE_IN>::value,
+        int>::type = 0>
+void sigmoid_data(
+    const CTYPE_IN* in_data,
+    const size_t numel,
+    CTYPE_OUT* out_data) {
+  for (size_t i = 0; i < numel; i++) {
+    // perform math in double to preserve precision
+    const double xi = static_cast<double>(in_data[i]);
+    out_data[i] = static_cast<CTYPE_OUT>(1.0 / (1.0 + std::exp(-xi)));
+  }
+}
+
+} // namespace
+
+Tensor& opt_sigmoid_out(RuntimeContext& ctx, const Tensor& in, Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx, in.scalar_type() != ScalarType::Bool, InvalidArgument, out);
+  ET_KERNEL_CHECK(ctx, tensor_is_floating_type(out), InvalidArgument, out);
+
+  // Resize for dynamic shape
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      resize_tensor(out, in.sizes()) == Error::Ok,
+      InvalidArgument,
+      out,
+      "Failed to resize output tensor.");
+
+  ET_SWITCH_REALHB_TYPES(in.scalar_type(), ctx, "sigmoid.out", CTYPE_IN, [&] {
+    ET_SWITCH_FLOATH_TYPES(
+        out.scalar_type(), ctx, "sigmoid.out", CTYPE_OUT, [&] {
+          sigmoid_data<CTYPE_IN, CTYPE_OUT>(
+              in.const_data_ptr<CTYPE_IN>(),
+              in.numel(),
+              out.mutable_data_ptr<CTYPE_OUT>());
+        });
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
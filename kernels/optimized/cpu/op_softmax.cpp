@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include <executorch/kernels/optimized/cpu/softmax_utils.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+/**
+ * Fast path for dtypes that Vectorized supports.
+ */
+template <
+    typename CTYPE,
+    typename std::enable_if<
+        !std::is_same<CTYPE, torch::executor::Half>::value,
+        int>::type = 0>
+void softmax_data(
+    const CTYPE* in_data,
+    CTYPE* out_data,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t inner_size) {
+  vec_softmax</*kLogSoftmax=*/false>(
+      in_data, out_data, outer_size, dim_size, inner_size);
+}
+
+/**
+ * Slow path for Half, which is computed in float one element at a time.
+ */
+template <
+    typename CTYPE,
+    typename std::enable_if<
+        std::is_same<CTYPE, torch::executor::Half>::value,
+        int>::type = 0>
+void softmax_data(
+    const CTYPE* in_data,
+    CTYPE* out_data,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t inner_size) {
+  for (int64_t i = 0; i < outer_size * inner_size; ++i) {
+    const int64_t base =
+        (i / inner_size) * dim_size * inner_size + i % inner_size;
+    float max_in = in_data[base];
+    for (int64_t d = 1; d < dim_size; ++d) {
+      max_in = std::max(max_in, float(in_data[base + d * inner_size]));
+    }
+    float sum = 0;
+    for (int64_t d = 0; d < dim_size; ++d) {
+      sum += std::exp(float(in_data[base + d * inner_size]) - max_in);
+    }
+    for (int64_t d = 0; d < dim_size; ++d) {
+      out_data[base + d * inner_size] =
+          std::exp(float(in_data[base + d * inner_size]) - max_in) / sum;
+    }
+  }
+}
+
+} // namespace
+
+// _softmax.out(Tensor self, int dim, bool half_to_float, *, Tensor(a!) out)
+// -> Tensor(a!)
+Tensor& opt_softmax_out(
+    RuntimeContext& ctx,
+    const Tensor& self,
+    int64_t dim,
+    bool half_to_float,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      check_softmax_args(self, dim, half_to_float, out),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, resize_tensor(out, self.sizes()) == Error::Ok, InvalidArgument, out);
+
+  if (self.numel() == 0) {
+    return out;
+  }
+
+  // Adjust for negative dim
+  dim = dim < 0 ? dim + nonzero_dim(self) : dim;
+
+  // A 0-dim tensor is treated as a single softmax over one element.
+  const int64_t dim_size = self.dim() == 0 ? 1 : self.size(dim);
+  int64_t outer_size = 1;
+  int64_t inner_size = 1;
+  for (int64_t i = 0; i < dim; ++i) {
+    outer_size *= self.size(i);
+  }
+  for (int64_t i = dim + 1; i < self.dim(); ++i) {
+    inner_size *= self.size(i);
+  }
+
+  ET_SWITCH_FLOATH_TYPES(self.scalar_type(), ctx, "_softmax.out", CTYPE, [&]() {
+    softmax_data<CTYPE>(
+        self.const_data_ptr<CTYPE>(),
+        out.mutable_data_ptr<CTYPE>(),
+        outer_size,
+        dim_size,
+        inner_size);
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
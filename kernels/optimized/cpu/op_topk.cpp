@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <tuple>
+
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/kernels/portable/cpu/util/topk_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+// Largest k for which contiguous rows are scanned with vector comparisons.
+constexpr int64_t kTopKVectorizedMaxK = 8;
+
+/**
+ * Whether any lane of `v` would be kept by a full selector whose worst kept
+ * value is `worst`. Later elements lose ties, so only values that rank
+ * strictly before `worst` count.
+ */
+template <bool kLargest, typename CTYPE>
+inline bool topk_has_candidate(
+    const executorch::vec::Vectorized<CTYPE>& v,
+    const CTYPE worst) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  constexpr int kAllLanes = (1 << Vec::size()) - 1;
+  if (std::isnan(worst)) {
+    // Nothing ranks before a NaN for largest, while every other value does
+    // for smallest.
+    return !kLargest && (v == v).zero_mask() != kAllLanes;
+  }
+  // NaN lanes compare false, which makes them candidates only for largest.
+  return kLargest ? (v <= Vec(worst)).zero_mask() != 0
+                  : (v < Vec(worst)).zero_mask() != kAllLanes;
+}
+
+/**
+ * Selects the top k of the contiguous row of `n` elements at `in`. Once k
+ * elements are kept, a whole vector of elements is skipped with one
+ * comparison against the worst kept value, which is the common case for
+ * small k.
+ */
+template <bool kLargest, typename CTYPE>
+void topk_row_vectorized(
+    const CTYPE* const in,
+    const int64_t n,
+    const int64_t k,
+    CTYPE* const values,
+    long* const indices) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+  internal::TopKSelector<kLargest, CTYPE> selector(values, indices, k, 1);
+  int64_t i = 0;
+  for (; i < k; ++i) {
+    selector.push(in[i], i);
+  }
+  for (; i + Vec::size() <= n; i += Vec::size()) {
+    if (!topk_has_candidate<kLargest>(Vec::loadu(in + i), selector.worst())) {
+      continue;
+    }
+    for (int64_t j = i; j < i + Vec::size(); ++j) {
+      selector.push(in[j], j);
+    }
+  }
+  for (; i < n; ++i) {
+    selector.push(in[i], i);
+  }
+  selector.finish();
+}
+
+/**
+ * Selects the top k of every contiguous row of `in`, splitting the rows
+ * across threads.
+ */
+template <bool kLargest, typename CTYPE>
+void topk_rows_vectorized(
+    const Tensor& in,
+    const int64_t k,
+    Tensor& values,
+    Tensor& indices) {
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const values_data = values.mutable_data_ptr<CTYPE>();
+  long* const indices_data = indices.mutable_data_ptr<long>();
+
+  const int64_t dim_size = in.dim() == 0 ? 1 : in.size(in.dim() - 1);
+  const int64_t outer = in.numel() / dim_size;
+
+  parallel_for_each_chunk(
+      0, outer, dim_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          topk_row_vectorized<kLargest>(
+              in_data + i * dim_size,
+              dim_size,
+              k,
+              values_data + i * k,
+              indices_data + i * k);
+        }
+      });
+}
+
+/**
+ * Selects the top k of every slice of `in` along `dim` with the portable
+ * heap selection, splitting the slices across threads.
+ */
+template <bool kLargest, typename CTYPE>
+void topk(
+    const Tensor& in,
+    const int64_t k,
+    const int64_t dim,
+    Tensor& values,
+    Tensor& indices) {
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const values_data = values.mutable_data_ptr<CTYPE>();
+  long* const indices_data = indices.mutable_data_ptr<long>();
+
+  const int64_t outer = in.dim() == 0 ? 1 : getLeadingDims(in, dim);
+  const int64_t dim_size = in.dim() == 0 ? 1 : in.size(dim);
+  const int64_t inner = in.dim() == 0 ? 1 : getTrailingDims(in, dim);
+
+  parallel_for_each_chunk(
+      0, outer * inner, dim_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t slice = begin; slice < end; ++slice) {
+          const int64_t i = slice / inner;
+          const int64_t j = slice % inner;
+          internal::topk_slice<kLargest>(
+              in_data + i * dim_size * inner + j,
+              dim_size,
+              inner,
+              k,
+              values_data + i * k * inner + j,
+              indices_data + i * k * inner + j,
+              inner);
+        }
+      });
+}
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> opt_topk_values(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    bool largest,
+    bool sorted,
+    Tensor& values,
+    Tensor& indices) {
+  // The outputs are always sorted, which sorted = false allows.
+  (void)sorted;
+  std::tuple<Tensor&, Tensor&> out(values, indices);
+
+  ET_KERNEL_CHECK(
+      ctx, check_topk_args(in, k, dim, values, indices), InvalidArgument, out);
+
+  Tensor::SizesType target_sizes[kTensorDimensionLimit];
+  size_t target_ndim = 0;
+  get_topk_out_target_size(in, k, dim, target_sizes, &target_ndim);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(values, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(indices, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (values.numel() == 0) {
+    return out;
+  }
+
+  dim = dim < 0 ? dim + in.dim() : dim;
+  const ScalarType in_type = in.scalar_type();
+
+  if ((in.dim() == 0 || dim == in.dim() - 1) && k <= kTopKVectorizedMaxK &&
+      (in_type == ScalarType::Float || in_type == ScalarType::Double)) {
+    ET_SWITCH_FLOAT_TYPES(in_type, ctx, "topk.values", CTYPE, [&]() {
+      if (largest) {
+        topk_rows_vectorized</*kLargest=*/true, CTYPE>(in, k, values, indices);
+      } else {
+        topk_rows_vectorized</*kLargest=*/false, CTYPE>(
+            in, k, values, indices);
+      }
+    });
+    return out;
+  }
+
+  ET_SWITCH_REAL_TYPES(in_type, ctx, "topk.values", CTYPE, [&]() {
+    if (largest) {
+      topk</*kLargest=*/true, CTYPE>(in, k, dim, values, indices);
+    } else {
+      topk</*kLargest=*/false, CTYPE>(in, k, dim, values, indices);
+    }
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace internal {
+
+/**
+ * A 2D pooling problem over N * C planes. 3D inputs are described with a batch
+ * of one. The input and output share their layout, either contiguous (NCHW)
+ * or channels last (NHWC).
+ */
+struct Pool2dParams {
+  int64_t N;
+  int64_t C;
+  int64_t in_H;
+  int64_t in_W;
+  int64_t out_H;
+  int64_t out_W;
+  int64_t k_H;
+  int64_t k_W;
+  int64_t s_H;
+  int64_t s_W;
+  int64_t p_H;
+  int64_t p_W;
+  int64_t d_H;
+  int64_t d_W;
+  bool channels_last;
+
+  // The window of output (oy, ox) covers the whole input, which means every
+  // output reduces a whole plane.
+  bool is_global() const {
+    return out_H == 1 && out_W == 1 && k_H == in_H && k_W == in_W &&
+        p_H == 0 && p_W == 0;
+  }
+};
+
+/**
+ * Describes the pooling of `in` into `out`. Returns false if they do not share
+ * their layout, which the callers leave to the generic kernel_ops_util loop.
+ */
+inline bool get_pool2d_params(
+    const Tensor& in,
+    const Tensor& out,
+    const IntArrayRef kernel_size,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation,
+    Pool2dParams* params) {
+  const bool channels_last =
+      is_channels_last_dim_order(in.dim_order().data(), in.dim());
+  if (channels_last !=
+      is_channels_last_dim_order(out.dim_order().data(), out.dim())) {
+    return false;
+  }
+  const size_t dim = in.dim();
+  params->N = dim == 4 ? in.size(0) : 1;
+  params->C = in.size(dim - 3);
+  params->in_H = in.size(dim - 2);
+  params->in_W = in.size(dim - 1);
+  params->out_H = out.size(dim - 2);
+  params->out_W = out.size(dim - 1);
+  params->k_H = val_at(kernel_size, 0);
+  params->k_W = val_at(kernel_size, 1);
+  params->s_H = val_at(stride, 0, /*default_value=*/params->k_H);
+  params->s_W = val_at(stride, 1, /*default_value=*/params->k_W);
+  params->p_H = val_at(padding, 0, /*default_value=*/0);
+  params->p_W = val_at(padding, 1, /*default_value=*/0);
+  params->d_H = val_at(dilation, 0, /*default_value=*/1);
+  params->d_W = val_at(dilation, 1, /*default_value=*/1);
+  params->channels_last = channels_last;
+  return true;
+}
+
+/**
+ * The extent of a window along one axis, as kernel_reduction_then_map_2d()
+ * computes it: [begin, end) is the part of the undilated window within the
+ * input, and `size` the part within the padded input.
+ */
+struct PoolExtent {
+  int64_t begin;
+  int64_t end;
+  int64_t size;
+};
+
+inline PoolExtent
+pool_extent(int64_t out, int64_t k, int64_t s, int64_t p, int64_t in_size) {
+  int64_t begin = out * s - p;
+  int64_t end = std::min(begin + k, in_size + p);
+  const int64_t size = end - begin;
+  begin = std::max<int64_t>(begin, 0);
+  end = std::min(end, in_size);
+  return {begin, end, size};
+}
+
+/**
+ * Max pooling: keeps the first of the largest values and its position, the
+ * same way the portable kernel does.
+ */
+template <typename CTYPE>
+struct MaxPooler {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  void update(CTYPE v, int64_t tap, CTYPE& acc, int64_t& acc_tap) const {
+    if (v > acc) {
+      acc = v;
+      acc_tap = tap;
+    }
+  }
+
+  void update(const Vec& v, const Vec& tap, Vec& acc, Vec& acc_tap) const {
+    const Vec greater = v > acc;
+    acc = Vec::blendv(acc, v, greater);
+    acc_tap = Vec::blendv(acc_tap, tap, greater);
+  }
+
+  CTYPE finish(CTYPE acc, int64_t count) const {
+    (void)count;
+    return acc;
+  }
+
+  Vec finish(const Vec& acc, int64_t count) const {
+    (void)count;
+    return acc;
+  }
+};
+
+/**
+ * Average pooling: sums the values in window order and divides the sum by
+ * the window size, or by `divisor` if non-zero.
+ */
+template <typename CTYPE>
+struct AvgPooler {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  bool include_pad;
+  int64_t divisor;
+
+  void update(CTYPE v, int64_t tap, CTYPE& acc, int64_t& acc_tap) const {
+    (void)tap;
+    (void)acc_tap;
+    acc += v;
+  }
+
+  void update(const Vec& v, const Vec& tap, Vec& acc, Vec& acc_tap) const {
+    (void)tap;
+    (void)acc_tap;
+    acc = acc + v;
+  }
+
+  CTYPE finish(CTYPE acc, int64_t count) const {
+    return acc / static_cast<CTYPE>(divisor != 0 ? divisor : count);
+  }
+
+  Vec finish(const Vec& acc, int64_t count) const {
+    return acc / Vec(static_cast<CTYPE>(divisor != 0 ? divisor : count));
+  }
+};
+
+template <typename Pooler>
+int64_t pool_count(
+    const Pooler& pooler,
+    const PoolExtent& y,
+    const PoolExtent& x) {
+  return pooler.include_pad ? y.size * x.size
+                            : (y.end - y.begin) * (x.end - x.begin);
+}
+
+template <typename CTYPE>
+int64_t pool_count(
+    const MaxPooler<CTYPE>& pooler,
+    const PoolExtent& y,
+    const PoolExtent& x) {
+  (void)pooler;
+  (void)y;
+  (void)x;
+  return 1;
+}
+
+/**
+ * Pools output (oy, ox) of one plane element by element. Input elements are
+ * `elem_stride` apart within the plane, e.g. C in NHWC. Windows outside of
+ * the input leave the output untouched, as in the portable kernel.
+ */
+template <typename CTYPE, typename Pooler>
+void pool_one(
+    const Pool2dParams& p,
+    const Pooler& pooler,
+    const CTYPE* const plane,
+    const int64_t elem_stride,
+    const int64_t oy,
+    const int64_t ox,
+    CTYPE* const out,
+    int64_t* const index) {
+  const PoolExtent y = pool_extent(oy, p.k_H, p.s_H, p.p_H, p.in_H);
+  const PoolExtent x = pool_extent(ox, p.k_W, p.s_W, p.p_W, p.in_W);
+  if (y.begin >= y.end || x.begin >= x.end) {
+    return;
+  }
+  bool initialized = false;
+  CTYPE acc = 0;
+  int64_t acc_index = 0;
+  for (int64_t ky = 0; ky < p.k_H; ++ky) {
+    const int64_t iy = oy * p.s_H - p.p_H + ky * p.d_H;
+    if (iy < 0 || iy >= p.in_H) {
+      continue;
+    }
+    for (int64_t kx = 0; kx < p.k_W; ++kx) {
+      const int64_t ix = ox * p.s_W - p.p_W + kx * p.d_W;
+      if (ix < 0 || ix >= p.in_W) {
+        continue;
+      }
+      const int64_t in_index = iy * p.in_W + ix;
+      const CTYPE v = plane[in_index * elem_stride];
+      if (!initialized) {
+        acc = v;
+        acc_index = in_index;
+        initialized = true;
+      } else {
+        pooler.update(v, in_index, acc, acc_index);
+      }
+    }
+  }
+  *out = pooler.finish(acc, pool_count(pooler, y, x));
+  if (index != nullptr) {
+    *index = acc_index;
+  }
+}
+
+/**
+ * Converts the taps, numbered ky * k_W + kx, that won in `n` lanes into
+ * input positions within the plane.
+ */
+template <typename CTYPE>
+void taps_to_indices(
+    const Pool2dParams& p,
+    const executorch::vec::Vectorized<CTYPE>& taps,
+    const int64_t n,
+    const int64_t oy,
+    const int64_t ox,
+    const int64_t ox_step,
+    int64_t* const index,
+    const int64_t index_step) {
+  CTYPE lanes[executorch::vec::Vectorized<CTYPE>::size()];
+  taps.store(lanes, n);
+  for (int64_t i = 0; i < n; ++i) {
+    const int64_t tap = static_cast<int64_t>(lanes[i]);
+    const int64_t iy = oy * p.s_H - p.p_H + (tap / p.k_W) * p.d_H;
+    const int64_t ix =
+        (ox + i * ox_step) * p.s_W - p.p_W + (tap % p.k_W) * p.d_W;
+    index[i * index_step] = iy * p.in_W + ix;
+  }
+}
+
+/**
+ * Pools output row `oy` of an NCHW plane. With a unit horizontal stride, the
+ * outputs whose windows lie horizontally within the input are computed a
+ * vector of outputs at a time, with the same taps in the same order as
+ * pool_one().
+ */
+template <typename CTYPE, typename Pooler>
+void pool_row_nchw(
+    const Pool2dParams& p,
+    const Pooler& pooler,
+    const CTYPE* const plane,
+    const int64_t oy,
+    CTYPE* const out_row,
+    int64_t* const index_row) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  constexpr int64_t kLanes = Vec::size();
+  const PoolExtent y = pool_extent(oy, p.k_H, p.s_H, p.p_H, p.in_H);
+  if (y.begin >= y.end) {
+    return;
+  }
+
+  bool any_row = false;
+  for (int64_t ky = 0; ky < p.k_H; ++ky) {
+    const int64_t iy = oy * p.s_H - p.p_H + ky * p.d_H;
+    any_row = any_row || (iy >= 0 && iy < p.in_H);
+  }
+
+  // [x_begin, x_end) are the outputs all of whose horizontal taps are inside
+  // the input.
+  int64_t x_begin = p.out_W;
+  int64_t x_end = p.out_W;
+  if (std::is_floating_point<CTYPE>::value && p.s_W == 1 && any_row) {
+    x_begin = std::min(p.p_W, p.out_W);
+    x_end = std::max(
+        x_begin,
+        std::min<int64_t>(p.out_W, p.in_W + p.p_W - (p.k_W - 1) * p.d_W));
+  }
+
+  for (int64_t ox = 0; ox < x_begin; ++ox) {
+    pool_one(
+        p,
+        pooler,
+        plane,
+        1,
+        oy,
+        ox,
+        out_row + ox,
+        index_row ? index_row + ox : nullptr);
+  }
+
+  if (x_begin < x_end) {
+    const int64_t count = pool_count(
+        pooler, y, pool_extent(x_begin, p.k_W, p.s_W, p.p_W, p.in_W));
+    for (int64_t ox = x_begin; ox < x_end; ox += kLanes) {
+      const int64_t n = std::min(kLanes, x_end - ox);
+      bool initialized = false;
+      Vec acc;
+      Vec acc_tap;
+      for (int64_t ky = 0; ky < p.k_H; ++ky) {
+        const int64_t iy = oy * p.s_H - p.p_H + ky * p.d_H;
+        if (iy < 0 || iy >= p.in_H) {
+          continue;
+        }
+        const CTYPE* const in_row = plane + iy * p.in_W + ox - p.p_W;
+        for (int64_t kx = 0; kx < p.k_W; ++kx) {
+          const Vec v = Vec::loadu(in_row + kx * p.d_W, n);
+          const Vec tap(static_cast<CTYPE>(ky * p.k_W + kx));
+          if (!initialized) {
+            acc = v;
+            acc_tap = tap;
+            initialized = true;
+          } else {
+            pooler.update(v, tap, acc, acc_tap);
+          }
+        }
+      }
+      pooler.finish(acc, count).store(out_row + ox, n);
+      if (index_row != nullptr) {
+        taps_to_indices(p, acc_tap, n, oy, ox, 1, index_row + ox, 1);
+      }
+    }
+  }
+
+  for (int64_t ox = x_end; ox < p.out_W; ++ox) {
+    pool_one(
+        p,
+        pooler,
+        plane,
+        1,
+        oy,
+        ox,
+        out_row + ox,
+        index_row ? index_row + ox : nullptr);
+  }
+}
+
+/**
+ * Pools output pixel (oy, ox) of an NHWC sample, a vector of channels at a
+ * time. Every channel sees the same taps, in the same order as pool_one().
+ */
+template <typename CTYPE, typename Pooler>
+void pool_pixel_nhwc(
+    const Pool2dParams& p,
+    const Pooler& pooler,
+    const CTYPE* const sample,
+    const int64_t oy,
+    const int64_t ox,
+    CTYPE* const out_pixel,
+    int64_t* const index_pixel) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  constexpr int64_t kLanes = Vec::size();
+  const PoolExtent y = pool_extent(oy, p.k_H, p.s_H, p.p_H, p.in_H);
+  const PoolExtent x = pool_extent(ox, p.k_W, p.s_W, p.p_W, p.in_W);
+  if (y.begin >= y.end || x.begin >= x.end) {
+    return;
+  }
+
+  // Windows whose dilated taps all fall into the padding produce zeros.
+  bool any_tap = false;
+  for (int64_t ky = 0; ky < p.k_H && !any_tap; ++ky) {
+    const int64_t iy = oy * p.s_H - p.p_H + ky * p.d_H;
+    for (int64_t kx = 0; kx < p.k_W && !any_tap; ++kx) {
+      const int64_t ix = ox * p.s_W - p.p_W + kx * p.d_W;
+      any_tap = iy >= 0 && iy < p.in_H && ix >= 0 && ix < p.in_W;
+    }
+  }
+  if (!std::is_floating_point<CTYPE>::value || !any_tap) {
+    for (int64_t c = 0; c < p.C; ++c) {
+      pool_one(
+          p,
+          pooler,
+          sample + c,
+          p.C,
+          oy,
+          ox,
+          out_pixel + c,
+          index_pixel ? index_pixel + c : nullptr);
+    }
+    return;
+  }
+
+  const int64_t count = pool_count(pooler, y, x);
+  for (int64_t c = 0; c < p.C; c += kLanes) {
+    const int64_t n = std::min(kLanes, p.C - c);
+    bool initialized = false;
+    Vec acc;
+    Vec acc_tap;
+    for (int64_t ky = 0; ky < p.k_H; ++ky) {
+      const int64_t iy = oy * p.s_H - p.p_H + ky * p.d_H;
+      if (iy < 0 || iy >= p.in_H) {
+        continue;
+      }
+      for (int64_t kx = 0; kx < p.k_W; ++kx) {
+        const int64_t ix = ox * p.s_W - p.p_W + kx * p.d_W;
+        if (ix < 0 || ix >= p.in_W) {
+          continue;
+        }
+        const Vec v = Vec::loadu(sample + (iy * p.in_W + ix) * p.C + c, n);
+        const Vec tap(static_cast<CTYPE>(ky * p.k_W + kx));
+        if (!initialized) {
+          acc = v;
+          acc_tap = tap;
+          initialized = true;
+        } else {
+          pooler.update(v, tap, acc, acc_tap);
+        }
+      }
+    }
+    pooler.finish(acc, count).store(out_pixel + c, n);
+    if (index_pixel != nullptr) {
+      taps_to_indices(p, acc_tap, n, oy, ox, 0, index_pixel + c, 1);
+    }
+  }
+}
+
+/**
+ * Pools every output of `in` into `out`, and the positions of the pooled
+ * values into `indices` if non-null. NCHW inputs are split across threads by
+ * plane and NHWC inputs by output row.
+ */
+template <typename CTYPE, typename Pooler>
+void pool2d(
+    const Pool2dParams& p,
+    const Pooler& pooler,
+    const CTYPE* const in,
+    CTYPE* const out,
+    int64_t* const indices) {
+  const int64_t in_plane = p.in_H * p.in_W;
+  const int64_t out_plane = p.out_H * p.out_W;
+  const int64_t work_per_output = p.k_H * p.k_W;
+  if (!p.channels_last) {
+    parallel_for_each_chunk(
+        0,
+        p.N * p.C,
+        out_plane * work_per_output,
+        [&](const int64_t begin, const int64_t end) {
+          for (int64_t plane = begin; plane < end; ++plane) {
+            for (int64_t oy = 0; oy < p.out_H; ++oy) {
+              const int64_t out_offset = plane * out_plane + oy * p.out_W;
+              pool_row_nchw(
+                  p,
+                  pooler,
+                  in + plane * in_plane,
+                  oy,
+                  out + out_offset,
+                  indices ? indices + out_offset : nullptr);
+            }
+          }
+        });
+    return;
+  }
+  parallel_for_each_chunk(
+      0,
+      p.N * p.out_H,
+      p.out_W * p.C * work_per_output,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const int64_t n = row / p.out_H;
+          const int64_t oy = row % p.out_H;
+          for (int64_t ox = 0; ox < p.out_W; ++ox) {
+            const int64_t out_offset = (row * p.out_W + ox) * p.C;
+            pool_pixel_nhwc(
+                p,
+                pooler,
+                in + n * in_plane * p.C,
+                oy,
+                ox,
+                out + out_offset,
+                indices ? indices + out_offset : nullptr);
+          }
+        }
+      });
+}
+
+/**
+ * Global average pooling, where every output averages a whole plane.
+ * Contiguous planes are summed with vector partial sums; NHWC samples add
+ * whole pixels, so each channel still sums in window order.
+ */
+template <typename CTYPE>
+void global_avg_pool2d(
+    const Pool2dParams& p,
+    const AvgPooler<CTYPE>& pooler,
+    const CTYPE* const in,
+    CTYPE* const out) {
+  using Vec = executorch::vec::Vectorized<CTYPE>;
+
+  const int64_t plane_size = p.in_H * p.in_W;
+  if (!p.channels_last) {
+    parallel_for_each_chunk(
+        0,
+        p.N * p.C,
+        plane_size,
+        [&](const int64_t begin, const int64_t end) {
+          for (int64_t plane = begin; plane < end; ++plane) {
+            const CTYPE* const data = in + plane * plane_size;
+            CTYPE sum = 0;
+            if (std::is_floating_point<CTYPE>::value) {
+              sum = executorch::vec::reduce_all<CTYPE>(
+                  [](const Vec& a, const Vec& b) { return a + b; },
+                  data,
+                  plane_size);
+            } else {
+              for (int64_t i = 0; i < plane_size; ++i) {
+                sum += data[i];
+              }
+            }
+            out[plane] = pooler.finish(sum, plane_size);
+          }
+        });
+    return;
+  }
+  parallel_for_each_chunk(
+      0, p.N, plane_size * p.C, [&](const int64_t begin, const int64_t end) {
+        for (int64_t n = begin; n < end; ++n) {
+          const CTYPE* const sample = in + n * plane_size * p.C;
+          CTYPE* const sums = out + n * p.C;
+          std::copy(sample, sample + p.C, sums);
+          for (int64_t i = 1; i < plane_size; ++i) {
+            executorch::vec::map2<CTYPE>(
+                [](const Vec& a, const Vec& b) { return a + b; },
+                sums,
+                sums,
+                sample + i * p.C,
+                p.C);
+          }
+          for (int64_t c = 0; c < p.C; ++c) {
+            sums[c] = pooler.finish(sums[c], plane_size);
+          }
+        }
+      });
+}
+
+} // namespace internal
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/kernels/optimized/vec/functional.h>
+#include <executorch/kernels/optimized/vec/vec.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+namespace internal {
+
+template <typename scalar_t>
+inline executorch::vec::Vectorized<scalar_t>
+load_lanes(const scalar_t* data, int64_t count) {
+  using Vec = executorch::vec::Vectorized<scalar_t>;
+  return count == Vec::size() ? Vec::loadu(data) : Vec::loadu(data, count);
+}
+
+template <typename scalar_t>
+inline void store_lanes(
+    const executorch::vec::Vectorized<scalar_t>& v,
+    scalar_t* data,
+    int64_t count) {
+  if (count == executorch::vec::Vectorized<scalar_t>::size()) {
+    v.store(data);
+  } else {
+    v.store(data, count);
+  }
+}
+
+// Softmax of contiguous rows of dim_size elements.
+template <bool kLogSoftmax, typename scalar_t>
+void vec_softmax_lastdim(
+    const scalar_t* in,
+    scalar_t* out,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using Vec = executorch::vec::Vectorized<scalar_t>;
+  parallel_for_each_chunk(
+      0, outer_size, 3 * dim_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const scalar_t* const in_row = in + i * dim_size;
+          scalar_t* const out_row = out + i * dim_size;
+          // Subtracting the maximum keeps exp from overflowing.
+          const scalar_t max_in = executorch::vec::reduce_all<scalar_t>(
+              [](Vec& x, Vec& y) { return executorch::vec::maximum(x, y); },
+              in_row,
+              dim_size);
+          const Vec max_vec(max_in);
+          if (kLogSoftmax) {
+            const scalar_t sum = executorch::vec::map_reduce_all<scalar_t>(
+                [max_vec](Vec x) { return (x - max_vec).exp(); },
+                [](Vec x, Vec y) { return x + y; },
+                in_row,
+                dim_size);
+            const Vec shift(max_in + std::log(sum));
+            executorch::vec::map<scalar_t>(
+                [shift](Vec x) { return x - shift; },
+                out_row,
+                in_row,
+                dim_size);
+          } else {
+            executorch::vec::map<scalar_t>(
+                [max_vec](Vec x) { return (x - max_vec).exp(); },
+                out_row,
+                in_row,
+                dim_size);
+            const scalar_t sum = executorch::vec::reduce_all<scalar_t>(
+                [](Vec& x, Vec& y) { return x + y; }, out_row, dim_size);
+            const Vec scale(scalar_t(1) / sum);
+            executorch::vec::map<scalar_t>(
+                [scale](Vec x) { return x * scale; },
+                out_row,
+                out_row,
+                dim_size);
+          }
+        }
+      });
+}
+
+// Softmax over a dimension whose elements are inner_size apart. Each vector
+// lane follows a different inner position, so loads stay contiguous.
+template <bool kLogSoftmax, typename scalar_t>
+void vec_softmax_strided(
+    const scalar_t* in,
+    scalar_t* out,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t inner_size) {
+  using Vec = executorch::vec::Vectorized<scalar_t>;
+  const int64_t num_blocks = (inner_size + Vec::size() - 1) / Vec::size();
+  parallel_for_each_chunk(
+      0,
+      outer_size * num_blocks,
+      3 * dim_size * Vec::size(),
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t ix = begin; ix < end; ++ix) {
+          const int64_t outer_idx = ix / num_blocks;
+          const int64_t inner_idx = (ix % num_blocks) * Vec::size();
+          const int64_t count =
+              std::min<int64_t>(Vec::size(), inner_size - inner_idx);
+          const int64_t offset = outer_idx * dim_size * inner_size + inner_idx;
+          const scalar_t* const in_data = in + offset;
+          scalar_t* const out_data = out + offset;
+
+          Vec max_vec = load_lanes(in_data, count);
+          for (int64_t d = 1; d < dim_size; ++d) {
+            max_vec = executorch::vec::maximum(
+                max_vec, load_lanes(in_data + d * inner_size, count));
+          }
+          Vec sum(scalar_t(0));
+          for (int64_t d = 0; d < dim_size; ++d) {
+            const Vec e =
+                (load_lanes(in_data + d * inner_size, count) - max_vec).exp();
+            if (!kLogSoftmax) {
+              store_lanes(e, out_data + d * inner_size, count);
+            }
+            sum = sum + e;
+          }
+          if (kLogSoftmax) {
+            const Vec shift = max_vec + sum.log();
+            for (int64_t d = 0; d < dim_size; ++d) {
+              store_lanes(
+                  load_lanes(in_data + d * inner_size, count) - shift,
+                  out_data + d * inner_size,
+                  count);
+            }
+          } else {
+            const Vec scale = Vec(scalar_t(1)) / sum;
+            for (int64_t d = 0; d < dim_size; ++d) {
+              store_lanes(
+                  load_lanes(out_data + d * inner_size, count) * scale,
+                  out_data + d * inner_size,
+                  count);
+            }
+          }
+        }
+      });
+}
+
+} // namespace internal
+
+/**
+ * Computes softmax, or log_softmax when kLogSoftmax is set, of `in` along the
+ * middle dimension of a contiguous [outer_size, dim_size, inner_size] array,
+ * writing the result to `out`.
+ *
+ * exp and log are evaluated with Vectorized, which uses Sleef or the NEON
+ * polynomials where available instead of one libm call per element.
+ */
+template <bool kLogSoftmax, typename scalar_t>
+void vec_softmax(
+    const scalar_t* in,
+    scalar_t* out,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t inner_size) {
+  if (inner_size == 1) {
+    internal::vec_softmax_lastdim<kLogSoftmax>(in, out, outer_size, dim_size);
+  } else {
+    internal::vec_softmax_strided<kLogSoftmax>(
+        in, out, outer_size, dim_size, inner_size);
+  }
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
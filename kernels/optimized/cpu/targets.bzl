@@ -9,12 +9,67 @@ _OPTIMIZED_ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:broadcast_util",
         ],
     ),
+    op_target(
+        name = "op_addmm",
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:matmul_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_argmax",
+        deps = [
+            ":arg_reduce_utils",
+            "//executorch/kernels/portable/cpu/util:reduce_util",
+        ],
+    ),
+    op_target(
+        name = "op_argmin",
+        deps = [
+            ":arg_reduce_utils",
+            "//executorch/kernels/portable/cpu/util:reduce_util",
+        ],
+    ),
+    op_target(
+        name = "op_avg_pool2d",
+        deps = [
+            ":pooling_utils",
+            "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+        ],
+    ),
     op_target(
         name = "op_bmm",
         deps = [
             "//executorch/kernels/optimized:libblas",
         ],
     ),
+    op_target(
+        name = "op_cdist_forward",
+        deps = [
+            ":distance_utils",
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+        ],
+    ),
+    op_target(
+        name = "op_convolution",
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/runtime/kernel:operator_registry",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_cumsum",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+        ],
+    ),
     op_target(
         name = "op_div",
         deps = [
@@ -22,16 +77,50 @@ _OPTIMIZED_ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:broadcast_util",
         ],
     ),
-    op_target(name = "op_exp"),
     op_target(
-        name = "op_gelu",
-        deps = select({
-            "DEFAULT": [],
-            "ovr_config//cpu:arm64": [
-                "fbsource//third-party/sleef:sleef_arm",
-            ],
-        }),
+        name = "op_exp",
+        deps = [
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_fused_addmm_gelu",
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:matmul_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_fused_batch_norm_act",
+        deps = [
+            ":normalization_utils",
+            "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+        ],
     ),
+    op_target(
+        name = "op_fused_group_norm_act",
+        deps = [
+            ":normalization_utils",
+            "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_fused_mul_add",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_fused_rms_norm",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(name = "op_gelu"),
     op_target(
         name = "op_le",
         deps = [
@@ -40,15 +129,25 @@ _OPTIMIZED_ATEN_OPS = (
     ),
     op_target(
         name = "op_log_softmax",
-        deps = select({
-            "DEFAULT": [
-                "//executorch/kernels/portable/cpu/util:activation_ops_util",
-            ],
-            "ovr_config//cpu:arm64": [
-                "//executorch/kernels/portable/cpu/util:activation_ops_util",
-                "fbsource//third-party/sleef:sleef_arm",
-            ],
-        }),
+        deps = [
+            ":softmax_utils",
+            "//executorch/kernels/portable/cpu/util:activation_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_max_pool2d_with_indices",
+        deps = [
+            ":pooling_utils",
+            "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_mm",
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/portable/cpu/util:matmul_ops_util",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
     ),
     op_target(
         name = "op_mul",
@@ -57,14 +156,55 @@ _OPTIMIZED_ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:broadcast_util",
         ],
     ),
+    op_target(
+        name = "op_native_batch_norm",
+        deps = [
+            ":normalization_utils",
+            "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+        ],
+    ),
+    op_target(
+        name = "op_native_group_norm",
+        deps = [
+            ":normalization_utils",
+            "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+        ],
+    ),
     op_target(
         name = "op_native_layer_norm",
         deps = [
             ":moments_utils",
             "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_neg",
+        deps = [
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_pdist_forward",
+        deps = [
+            ":distance_utils",
+        ],
+    ),
+    op_target(
+        name = "op_sigmoid",
+        deps = [
+            "//executorch/kernels/portable/cpu:scalar_utils",
+        ],
+    ),
+    op_target(
+        name = "op_softmax",
+        deps = [
+            ":softmax_utils",
+            "//executorch/kernels/portable/cpu/util:activation_ops_util",
+            "//executorch/kernels/portable/cpu:scalar_utils",
         ],
     ),
-    op_target(name = "op_neg"),
     op_target(
         name = "op_sub",
         deps = [
@@ -72,6 +212,13 @@ _OPTIMIZED_ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:broadcast_util",
         ],
     ),
+    op_target(
+        name = "op_topk",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/kernels/portable/cpu/util:topk_util",
+        ],
+    ),
 )
 
 def define_common_targets():
@@ -97,6 +244,30 @@ def define_common_targets():
         exported_deps = all_op_targets,
     )
 
+    runtime.cxx_library(
+        name = "arg_reduce_utils",
+        srcs = [],
+        exported_headers = ["arg_reduce_utils.h"],
+        visibility = ["//executorch/kernels/optimized/..."],
+        exported_deps = [
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "distance_utils",
+        srcs = [],
+        exported_headers = ["distance_utils.h"],
+        visibility = ["//executorch/kernels/optimized/..."],
+        exported_deps = [
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:distance_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+        ],
+    )
+
     runtime.cxx_library(
         name = "moments_utils",
         srcs = [],
@@ -107,3 +278,62 @@ def define_common_targets():
             "//executorch/kernels/optimized:libutils",
         ],
     )
+
+    runtime.cxx_library(
+        name = "normalization_utils",
+        srcs = [],
+        exported_headers = ["normalization_utils.h"],
+        visibility = ["//executorch/kernels/optimized/..."],
+        exported_deps = [
+            ":moments_utils",
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "pooling_utils",
+        srcs = [],
+        exported_headers = ["pooling_utils.h"],
+        visibility = ["//executorch/kernels/optimized/..."],
+        exported_deps = [
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "softmax_utils",
+        srcs = [],
+        exported_headers = ["softmax_utils.h"],
+        visibility = ["//executorch/kernels/optimized/..."],
+        exported_deps = [
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+        ],
+    )
+
+    # Scaled dot product attention over Float, Half, BFloat16 and int8 kv
+    # caches. Not part of cpu_optimized since it implements no ATen operator;
+    # libraries that register it as a custom op depend on it directly.
+    runtime.cxx_library(
+        name = "sdpa",
+        srcs = ["op_sdpa.cpp"],
+        exported_headers = ["op_sdpa.h"],
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        deps = [
+            "//executorch/kernels/optimized:libblas",
+            "//executorch/kernels/optimized:libvec",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/extension/parallel:thread_parallel",
+            "//executorch/backends/xnnpack/threadpool:threadpool",
+        ],
+        exported_deps = [
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+    )
@@ -54,6 +54,10 @@ def define_libs():
             "//executorch/...",
             "@EXECUTORCH_CLIENTS",
         ],
+        exported_deps = [
+            # Needed for the Half and BFloat16 conversions
+            "//executorch/runtime/core/portable_type:scalar_type",
+        ],
         cxx_platform_deps = select({
             "DEFAULT": [
                 (
@@ -137,6 +141,7 @@ def define_libs():
         ],
         exported_deps = [
             "//executorch/kernels/optimized:libutils",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
             "//executorch/runtime/core/exec_aten:lib",
         ],
     )
@@ -10,6 +10,7 @@
 
 #include <executorch/kernels/optimized/blas/CPUBlas.h>
 
+#include <limits>
 #include <vector>
 
 #define TEST_FORALL_SUPPORTED_CTYPES(_, N) \
@@ -74,3 +75,109 @@ void test_matmul_ones() {
 TEST(BlasTest, MatmulOnes) {
   TEST_FORALL_SUPPORTED_CTYPES(test_matmul_ones, 25);
 }
+
+namespace {
+
+// Reference column-major c = alpha * op(a) @ op(b) + beta * c in double.
+template <typename T>
+std::vector<double> reference_gemm(
+    bool transa,
+    bool transb,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    double alpha,
+    const std::vector<T>& a,
+    int64_t lda,
+    const std::vector<T>& b,
+    int64_t ldb,
+    double beta,
+    const std::vector<T>& c,
+    int64_t ldc) {
+  std::vector<double> out(c.size());
+  for (int64_t j = 0; j < n; ++j) {
+    for (int64_t i = 0; i < m; ++i) {
+      double dot = 0;
+      for (int64_t l = 0; l < k; ++l) {
+        const double a_il = transa ? a[i * lda + l] : a[l * lda + i];
+        const double b_lj = transb ? b[l * ldb + j] : b[j * ldb + l];
+        dot += a_il * b_lj;
+      }
+      const double c_ij = static_cast<double>(c[j * ldc + i]);
+      out[j * ldc + i] = alpha * dot + beta * c_ij;
+    }
+  }
+  return out;
+}
+
+template <typename T>
+void test_blocked_gemm(bool transa, bool transb, double tolerance) {
+  // Sizes that are not multiples of the blocking, with a depth spanning
+  // several depth blocks.
+  const int64_t m = 75;
+  const int64_t n = 70;
+  const int64_t k = 300;
+  const int64_t lda = transa ? k : m;
+  const int64_t ldb = transb ? n : k;
+  const int64_t ldc = m;
+
+  std::vector<T> a(m * k);
+  std::vector<T> b(k * n);
+  std::vector<T> c(m * n);
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<T>(static_cast<float>((i * 7) % 11) / 11.0f - 0.5f);
+  }
+  for (size_t i = 0; i < b.size(); ++i) {
+    b[i] = static_cast<T>(static_cast<float>((i * 5) % 13) / 13.0f - 0.5f);
+  }
+  for (size_t i = 0; i < c.size(); ++i) {
+    c[i] = static_cast<T>(static_cast<float>(i % 3));
+  }
+
+  const std::vector<double> expected = reference_gemm(
+      transa, transb, m, n, k, 0.5, a, lda, b, ldb, 2.0, c, ldc);
+
+  executorch::cpublas::gemm_blocked<T>(
+      transa,
+      transb,
+      m,
+      n,
+      k,
+      0.5,
+      a.data(),
+      lda,
+      b.data(),
+      ldb,
+      2.0,
+      c.data(),
+      ldc);
+
+  for (size_t i = 0; i < c.size(); ++i) {
+    EXPECT_NEAR(static_cast<double>(c[i]), expected[i], tolerance) << i;
+  }
+}
+
+} // namespace
+
+TEST(BlasTest, BlockedGemmMatchesReference) {
+  for (const bool transa : {false, true}) {
+    for (const bool transb : {false, true}) {
+      test_blocked_gemm<float>(transa, transb, 1e-3);
+      test_blocked_gemm<double>(transa, transb, 1e-9);
+      // Half inputs, accumulated in float; only the final store rounds.
+      test_blocked_gemm<executorch::cpublas::Half>(transa, transb, 5e-2);
+    }
+  }
+}
+
+TEST(BlasTest, BlockedGemmZeroBetaIgnoresOutput) {
+  const int64_t n = 40;
+  std::vector<float> a(n * n, 1.0f);
+  std::vector<float> b(n * n, 1.0f);
+  std::vector<float> c(n * n, std::numeric_limits<float>::quiet_NaN());
+
+  executorch::cpublas::gemm_blocked<float>(
+      false, false, n, n, n, 1.0f, a.data(), n, b.data(), n, 0.0f, c.data(), n);
+
+  EXPECT_TRUE(check_all_equal_to(c, static_cast<float>(n)));
+}
@@ -11,6 +11,7 @@
 #include <executorch/kernels/optimized/vec/functional.h>
 #include <executorch/kernels/optimized/vec/vec.h>
 
+#include <cmath>
 #include <vector>
 
 #define TEST_FORALL_SUPPORTED_CTYPES(_) \
@@ -44,6 +45,30 @@ bool check_all_equal_to(std::vector<T>& arr, const float value) {
   return true;
 }
 
+// Checks that `vec_fn` applied to evenly spaced inputs in [lo, hi] matches
+// `ref_fn` to within `atol + rtol * |ref|`.
+template <typename VecFn, typename RefFn>
+void check_float_op_accuracy(
+    const VecFn& vec_fn,
+    const RefFn& ref_fn,
+    const float lo,
+    const float hi,
+    const float rtol,
+    const float atol) {
+  constexpr size_t kNumInputs = 4099;
+  std::vector<float> in(kNumInputs);
+  for (size_t i = 0; i < kNumInputs; ++i) {
+    in[i] = lo + (hi - lo) * i / (kNumInputs - 1);
+  }
+  std::vector<float> out(kNumInputs);
+  executorch::vec::map<float>(vec_fn, out.data(), in.data(), kNumInputs);
+  for (size_t i = 0; i < kNumInputs; ++i) {
+    const float expected = ref_fn(in[i]);
+    EXPECT_NEAR(out[i], expected, atol + rtol * std::abs(expected))
+        << "input " << in[i];
+  }
+}
+
 } // namespace
 
 template <typename T>
@@ -72,3 +97,143 @@ void test_load_and_add() {
 TEST(VecFloatTest, LoadAndAdd) {
   TEST_FORALL_SUPPORTED_CTYPES(test_load_and_add);
 }
+
+using VecF = executorch::vec::Vectorized<float>;
+
+TEST(VecFloatTest, ExpMatchesStd) {
+  check_float_op_accuracy(
+      [](VecF x) { return x.exp(); },
+      [](float x) { return std::exp(x); },
+      -87.0f,
+      88.0f,
+      1e-6f,
+      0.0f);
+}
+
+TEST(VecFloatTest, ExpSaturates) {
+  const float in[] = {-1000.0f, -200.0f, 100.0f, 1000.0f, 0.0f, 1.0f, -1.0f};
+  constexpr size_t kNumInputs = sizeof(in) / sizeof(in[0]);
+  float out[kNumInputs];
+  executorch::vec::map<float>(
+      [](VecF x) { return x.exp(); }, out, in, kNumInputs);
+  EXPECT_EQ(out[0], 0.0f);
+  EXPECT_EQ(out[1], 0.0f);
+  EXPECT_TRUE(std::isinf(out[2]));
+  EXPECT_TRUE(std::isinf(out[3]));
+  EXPECT_EQ(out[4], 1.0f);
+  EXPECT_FLOAT_EQ(out[5], std::exp(1.0f));
+  EXPECT_FLOAT_EQ(out[6], std::exp(-1.0f));
+}
+
+TEST(VecFloatTest, LogMatchesStd) {
+  check_float_op_accuracy(
+      [](VecF x) { return x.log(); },
+      [](float x) { return std::log(x); },
+      1e-3f,
+      1e3f,
+      1e-6f,
+      1e-7f);
+  check_float_op_accuracy(
+      [](VecF x) { return x.log(); },
+      [](float x) { return std::log(x); },
+      0.5f,
+      2.0f,
+      1e-6f,
+      1e-7f);
+}
+
+TEST(VecFloatTest, LogSpecialValues) {
+  const float in[] = {0.0f, -1.0f, INFINITY, 1.0f};
+  constexpr size_t kNumInputs = sizeof(in) / sizeof(in[0]);
+  float out[kNumInputs];
+  executorch::vec::map<float>(
+      [](VecF x) { return x.log(); }, out, in, kNumInputs);
+  EXPECT_TRUE(std::isinf(out[0]) && out[0] < 0);
+  EXPECT_TRUE(std::isnan(out[1]));
+  EXPECT_TRUE(std::isinf(out[2]) && out[2] > 0);
+  EXPECT_EQ(out[3], 0.0f);
+}
+
+TEST(VecFloatTest, TanhMatchesStd) {
+  check_float_op_accuracy(
+      [](VecF x) { return x.tanh(); },
+      [](float x) { return std::tanh(x); },
+      -12.0f,
+      12.0f,
+      1e-6f,
+      1e-7f);
+}
+
+TEST(VecFloatTest, ErfMatchesStd) {
+  check_float_op_accuracy(
+      [](VecF x) { return x.erf(); },
+      [](float x) { return std::erf(x); },
+      -6.0f,
+      6.0f,
+      0.0f,
+      1e-6f);
+}
+
+TEST(VecHalfTest, Map2MatchesScalar) {
+  using torch::executor::Half;
+  // Cover the full vectors as well as the partial tail.
+  constexpr int64_t kNumInputs = 2 * VecF::size() + 3;
+  std::vector<Half> a(kNumInputs);
+  std::vector<Half> b(kNumInputs);
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    a[i] = Half(0.37f * i - 3.1f);
+    b[i] = Half(1.5f - 0.11f * i);
+  }
+  std::vector<Half> out(kNumInputs);
+  executorch::vec::map2<Half>(
+      [](VecF x, VecF y) { return x * y + x; },
+      out.data(),
+      a.data(),
+      b.data(),
+      kNumInputs);
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    const Half expected = Half(
+        static_cast<float>(a[i]) * static_cast<float>(b[i]) +
+        static_cast<float>(a[i]));
+    EXPECT_EQ(out[i].x, expected.x) << "index " << i;
+  }
+}
+
+TEST(VecBFloat16Test, StoreRoundsToNearestEven) {
+  using torch::executor::BFloat16;
+  const float in[] = {
+      1.0f,
+      // Halfway between 1 and the next BFloat16, rounds down to even.
+      1.00390625f,
+      // Halfway between two BFloat16, rounds up to even.
+      1.01171875f,
+      -2.71828f,
+      3.4e38f,
+      INFINITY,
+      -INFINITY,
+      NAN,
+      0.0f};
+  constexpr int64_t kNumInputs = sizeof(in) / sizeof(in[0]);
+  const uint16_t expected[] = {
+      0x3f80, 0x3f80, 0x3f82, 0xc02e, 0x7f80, 0x7f80, 0xff80, 0x7fc0, 0x0000};
+  BFloat16 out[kNumInputs];
+  for (int64_t d = 0; d < kNumInputs; d += VecF::size()) {
+    const int64_t count = std::min<int64_t>(VecF::size(), kNumInputs - d);
+    executorch::vec::store_float(VecF::loadu(in + d, count), out + d, count);
+  }
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    EXPECT_EQ(out[i].x, expected[i]) << "index " << i;
+  }
+
+  // Loading gives back the rounded values.
+  float back[kNumInputs];
+  for (int64_t d = 0; d < kNumInputs; d += VecF::size()) {
+    const int64_t count = std::min<int64_t>(VecF::size(), kNumInputs - d);
+    executorch::vec::load_float(out + d, count).store(back + d, count);
+  }
+  EXPECT_EQ(back[0], 1.0f);
+  EXPECT_EQ(back[1], 1.0f);
+  EXPECT_EQ(back[2], 1.015625f);
+  EXPECT_TRUE(std::isinf(back[5]) && back[5] > 0);
+  EXPECT_TRUE(std::isnan(back[7]));
+}
@@ -229,7 +229,11 @@ inline scalar_t map3_reduce_all(
   return vec_reduce_all(red_fun, acc_vec);
 }
 
-template <typename scalar_t, typename Op>
+template <
+    typename scalar_t,
+    typename Op,
+    typename std::enable_if<!is_reduced_floating_point<scalar_t>::value, int>::
+        type = 0>
 inline void map(
     const Op& vec_fun,
     scalar_t* output_data,
@@ -247,7 +251,11 @@ inline void map(
   }
 }
 
-template <typename scalar_t, typename Op>
+template <
+    typename scalar_t,
+    typename Op,
+    typename std::enable_if<!is_reduced_floating_point<scalar_t>::value, int>::
+        type = 0>
 inline void map2(
     const Op& vec_fun,
     scalar_t* output_data,
@@ -270,6 +278,57 @@ inline void map2(
   }
 }
 
+// See Note [Reduced precision floating point]. `vec_fun` takes and returns
+// Vectorized<float>.
+template <
+    typename scalar_t,
+    typename Op,
+    typename std::enable_if<is_reduced_floating_point<scalar_t>::value, int>::
+        type = 0>
+inline void map(
+    const Op& vec_fun,
+    scalar_t* output_data,
+    const scalar_t* input_data,
+    int64_t size) {
+  using fVec = vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % fVec::size()); d += fVec::size()) {
+    fVec output_vec = vec_fun(load_float(input_data + d));
+    store_float(output_vec, output_data + d);
+  }
+  if (size - d > 0) {
+    fVec output_vec = vec_fun(load_float(input_data + d, size - d));
+    store_float(output_vec, output_data + d, size - d);
+  }
+}
+
+template <
+    typename scalar_t,
+    typename Op,
+    typename std::enable_if<is_reduced_floating_point<scalar_t>::value, int>::
+        type = 0>
+inline void map2(
+    const Op& vec_fun,
+    scalar_t* output_data,
+    const scalar_t* input_data,
+    const scalar_t* input_data2,
+    int64_t size) {
+  using fVec = vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % fVec::size()); d += fVec::size()) {
+    fVec data_vec = load_float(input_data + d);
+    fVec data_vec2 = load_float(input_data2 + d);
+    fVec output_vec = vec_fun(data_vec, data_vec2);
+    store_float(output_vec, output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_vec = load_float(input_data + d, size - d);
+    fVec data_vec2 = load_float(input_data2 + d, size - d);
+    fVec output_vec = vec_fun(data_vec, data_vec2);
+    store_float(output_vec, output_data + d, size - d);
+  }
+}
+
 template <typename scalar_t, typename Op>
 inline void map3(
     const Op& vec_fun,
@@ -19,6 +19,7 @@
 #include <executorch/kernels/optimized/vec/vec256/vec256_float_neon.h>
 #include <executorch/kernels/optimized/vec/vec256/vec256_double.h>
 #include <executorch/kernels/optimized/vec/vec256/vec256_int.h>
+#include <executorch/kernels/optimized/vec/vec256/vec256_half.h>
 #endif
 
 #include <algorithm>
@@ -14,6 +14,8 @@
 #include <executorch/kernels/optimized/vec/intrinsics.h>
 #include <executorch/kernels/optimized/vec/vec_base.h>
 
+#include <cfloat>
+#include <cmath>
 
 #if defined(__aarch64__) && defined(ET_BUILD_ARM_VEC256_WITH_SLEEF)
 #include <sleef.h>
@@ -22,7 +24,8 @@
 // Sleef offers vectorized versions of some transcedentals
 // such as sin, cos, tan etc..
 // However for now opting for STL, since we are not building
-// with Sleef for mobile yet.
+// with Sleef for mobile yet. exp, log, tanh and erf, which the kernels use the
+// most, fall back to the NEON polynomials below instead.
 
 namespace executorch {
 namespace vec {
@@ -72,6 +75,128 @@ struct BlendRegs<index, false>{
   }
 };
 
+// Polynomial approximations of the transcendentals that kernels use the most.
+// They are used when Sleef is not available, so that these functions stay
+// vectorized instead of calling into libm one lane at a time.
+
+// exp(x) with a few ulp of error. Inputs are reduced to r = x - n * ln(2),
+// |r| <= ln(2) / 2, and exp(r) is evaluated with the Cephes expf polynomial.
+// Results that would be subnormal are flushed to zero.
+inline float32x4_t exp_f32x4(float32x4_t x) {
+  const float32x4_t max_input = vdupq_n_f32(88.72283935546875f);
+  const float32x4_t min_input = vdupq_n_f32(-87.33654022216797f);
+  const float32x4_t xc = vminq_f32(vmaxq_f32(x, min_input), max_input);
+  // Keep 2^n a normal float; the polynomial is still accurate for the
+  // slightly larger |r| this leaves near the top of the range.
+  const float32x4_t n = vminq_f32(
+      vrndnq_f32(vmulq_f32(xc, vdupq_n_f32(1.44269504088896341f))),
+      vdupq_n_f32(127.0f));
+  // ln(2) is split in two so that r is computed without cancellation.
+  float32x4_t r = vfmsq_f32(xc, n, vdupq_n_f32(0.693359375f));
+  r = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+
+  float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+  p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+  p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+  p = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), p, vmulq_f32(r, r));
+
+  const int32x4_t pow2n = vshlq_n_s32(
+      vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+  float32x4_t result = vmulq_f32(p, vreinterpretq_f32_s32(pow2n));
+  result = vbslq_f32(vcltq_f32(x, min_input), vdupq_n_f32(0.0f), result);
+  result = vbslq_f32(vcgtq_f32(x, max_input), vdupq_n_f32(INFINITY), result);
+  // NaN compares unequal to itself, and is passed through.
+  return vbslq_f32(vceqq_f32(x, x), result, x);
+}
+
+// log(x) with a few ulp of error. x is split into m * 2^e with m in
+// [sqrt(0.5), sqrt(2)), and log(m) is evaluated with the Cephes logf
+// polynomial.
+inline float32x4_t log_f32x4(float32x4_t x) {
+  // Scale subnormals up so that their exponent can be read from the bits.
+  const uint32x4_t subnormal = vcltq_f32(x, vdupq_n_f32(FLT_MIN));
+  const float32x4_t xn =
+      vbslq_f32(subnormal, vmulq_f32(x, vdupq_n_f32(8388608.0f)), x);
+  const int32x4_t bits = vreinterpretq_s32_f32(xn);
+  int32x4_t e = vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127));
+  e = vbslq_s32(subnormal, vsubq_s32(e, vdupq_n_s32(23)), e);
+  // m in [1, 2), then moved into [sqrt(0.5), sqrt(2)).
+  float32x4_t m = vreinterpretq_f32_s32(vorrq_s32(
+      vandq_s32(bits, vdupq_n_s32(0x007fffff)), vdupq_n_s32(0x3f800000)));
+  const uint32x4_t large = vcgtq_f32(m, vdupq_n_f32(1.41421356237f));
+  m = vbslq_f32(large, vmulq_f32(m, vdupq_n_f32(0.5f)), m);
+  // The mask is all ones, i.e. -1, where m was halved.
+  e = vsubq_s32(e, vreinterpretq_s32_u32(large));
+  const float32x4_t ef = vcvtq_f32_s32(e);
+
+  const float32x4_t f = vsubq_f32(m, vdupq_n_f32(1.0f));
+  const float32x4_t f2 = vmulq_f32(f, f);
+  float32x4_t p = vdupq_n_f32(7.0376836292e-2f);
+  p = vfmaq_f32(vdupq_n_f32(-1.1514610310e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(1.1676998740e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(-1.2420140846e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(1.4249322787e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(-1.6668057665e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(2.0000714765e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(-2.4999993993e-1f), p, f);
+  p = vfmaq_f32(vdupq_n_f32(3.3333331174e-1f), p, f);
+  // log(x) = e * ln(2) + f - f^2 / 2 + f^3 * p, with ln(2) split in two.
+  float32x4_t y = vmulq_f32(vmulq_f32(f, f2), p);
+  y = vfmaq_f32(y, ef, vdupq_n_f32(-2.12194440e-4f));
+  y = vfmsq_f32(y, f2, vdupq_n_f32(0.5f));
+  float32x4_t result = vaddq_f32(f, y);
+  result = vfmaq_f32(result, ef, vdupq_n_f32(0.693359375f));
+
+  result = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(NAN), result);
+  result = vbslq_f32(
+      vceqq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-INFINITY), result);
+  result = vbslq_f32(vceqq_f32(x, vdupq_n_f32(INFINITY)), x, result);
+  return vbslq_f32(vceqq_f32(x, x), result, x);
+}
+
+// tanh(x). Small inputs use the Cephes tanhf polynomial, and larger ones
+// 1 - 2 / (exp(2|x|) + 1) with the sign of x.
+inline float32x4_t tanh_f32x4(float32x4_t x) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t ax = vabsq_f32(x);
+  const float32x4_t e = exp_f32x4(vaddq_f32(ax, ax));
+  float32x4_t large =
+      vsubq_f32(one, vdivq_f32(vdupq_n_f32(2.0f), vaddq_f32(e, one)));
+  large = vbslq_f32(vdupq_n_u32(0x80000000), x, large);
+
+  const float32x4_t x2 = vmulq_f32(x, x);
+  float32x4_t p = vdupq_n_f32(-5.70498872745e-3f);
+  p = vfmaq_f32(vdupq_n_f32(2.06390887954e-2f), p, x2);
+  p = vfmaq_f32(vdupq_n_f32(-5.37397155531e-2f), p, x2);
+  p = vfmaq_f32(vdupq_n_f32(1.33314422036e-1f), p, x2);
+  p = vfmaq_f32(vdupq_n_f32(-3.33332819422e-1f), p, x2);
+  const float32x4_t small = vfmaq_f32(x, vmulq_f32(x, x2), p);
+
+  // NaN fails the comparison and takes the exp path, which keeps it.
+  return vbslq_f32(vcltq_f32(ax, vdupq_n_f32(0.625f)), small, large);
+}
+
+// erf(x) with the Abramowitz and Stegun 7.1.26 approximation also used by
+// the AVX2 implementation. The absolute error is below 1e-6 in float.
+inline float32x4_t erf_f32x4(float32x4_t x) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t ax = vabsq_f32(x);
+  const float32x4_t t = vdivq_f32(
+      one, vfmaq_f32(one, vdupq_n_f32(0.3275911f), ax));
+  float32x4_t r = vdupq_n_f32(1.061405429f);
+  r = vfmaq_f32(vdupq_n_f32(-1.453152027f), r, t);
+  r = vfmaq_f32(vdupq_n_f32(1.421413741f), r, t);
+  r = vfmaq_f32(vdupq_n_f32(-0.284496736f), r, t);
+  r = vfmaq_f32(vdupq_n_f32(0.254829592f), r, t);
+  r = vmulq_f32(r, t);
+  const float32x4_t e = exp_f32x4(vnegq_f32(vmulq_f32(x, x)));
+  const float32x4_t result = vfmsq_f32(one, r, e);
+  return vbslq_f32(vdupq_n_u32(0x80000000), x, result);
+}
+
 template <> class Vectorized<float> {
 private:
   float32x4x2_t values;
@@ -384,7 +509,7 @@ public:
   Vectorized<float> erf() const {
     return USE_SLEEF(
       Vectorized<float>(Sleef_erff4_u10(values.val[0]), Sleef_erff4_u10(values.val[1])),
-      map(std::erf);
+      Vectorized<float>(erf_f32x4(values.val[0]), erf_f32x4(values.val[1]))
     );
   }
   Vectorized<float> erfc() const {
@@ -396,7 +521,7 @@ public:
   Vectorized<float> exp() const {
     return USE_SLEEF(
       Vectorized<float>(Sleef_expf4_u10(values.val[0]), Sleef_expf4_u10(values.val[1])),
-      map(std::exp)
+      Vectorized<float>(exp_f32x4(values.val[0]), exp_f32x4(values.val[1]))
     );
   }
   Vectorized<float> exp2() const {
@@ -450,7 +575,7 @@ public:
   Vectorized<float> log() const {
     return USE_SLEEF(
       Vectorized<float>(Sleef_logf4_u10(values.val[0]), Sleef_logf4_u10(values.val[1])),
-      map(std::log)
+      Vectorized<float>(log_f32x4(values.val[0]), log_f32x4(values.val[1]))
     );
   }
   Vectorized<float> log10() const {
@@ -537,7 +662,7 @@ public:
   Vectorized<float> tanh() const {
     return USE_SLEEF(
       Vectorized<float>(Sleef_tanhf4_u10(values.val[0]), Sleef_tanhf4_u10(values.val[1])),
-      map(std::tanh)
+      Vectorized<float>(tanh_f32x4(values.val[0]), tanh_f32x4(values.val[1]))
     );
   }
   Vectorized<float> trunc() const {
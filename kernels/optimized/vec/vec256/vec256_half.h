@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <executorch/kernels/optimized/vec/intrinsics.h>
+#include <executorch/kernels/optimized/vec/vec_base.h>
+#include <executorch/kernels/optimized/vec/vec256/vec256_float.h>
+#include <executorch/kernels/optimized/vec/vec256/vec256_float_neon.h>
+#include <executorch/runtime/core/portable_type/bfloat16.h>
+#include <executorch/runtime/core/portable_type/half.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace executorch {
+namespace vec {
+// See Note [CPU_CAPABILITY namespace]
+inline namespace CPU_CAPABILITY {
+
+// Note [Reduced precision floating point]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Half and BFloat16 have no Vectorized of their own. Kernels load them into a
+// Vectorized<float>, compute in float, and round the result back when
+// storing, which is what the scalar kernels do one element at a time: the
+// results are the same, only the conversions are vectorized. The conversions
+// use F16C on AVX2 and the fcvt instructions on aarch64.
+
+template <typename T>
+struct is_reduced_floating_point
+    : std::integral_constant<
+          bool,
+          std::is_same<T, torch::executor::Half>::value ||
+              std::is_same<T, torch::executor::BFloat16>::value> {};
+
+namespace detail {
+
+inline float bf16_to_float(uint16_t bits) {
+  const uint32_t value = static_cast<uint32_t>(bits) << 16;
+  float result;
+  std::memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+// Rounds to nearest even, and keeps NaNs quiet.
+inline uint16_t float_to_bf16(float value) {
+  if (std::isnan(value)) {
+    return 0x7fc0;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+#if defined(CPU_CAPABILITY_AVX2) && !defined(_MSC_VER)
+
+#if defined(__F16C__)
+inline Vectorized<float> load_float_full(const torch::executor::Half* ptr) {
+  return _mm256_cvtph_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::Half* ptr) {
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(ptr),
+      _mm256_cvtps_ph(static_cast<__m256>(v), _MM_FROUND_TO_NEAREST_INT));
+}
+#define ET_VEC_HAS_HALF_CONVERSIONS
+#endif // defined(__F16C__)
+
+inline Vectorized<float> load_float_full(
+    const torch::executor::BFloat16* ptr) {
+  const __m256i bits = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::BFloat16* ptr) {
+  const __m256 values = v;
+  const __m256i bits = _mm256_castps_si256(values);
+  const __m256i lsb =
+      _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+  __m256i rounded = _mm256_srli_epi32(
+      _mm256_add_epi32(
+          bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff))),
+      16);
+  const __m256 is_nan = _mm256_cmp_ps(values, values, _CMP_UNORD_Q);
+  rounded = _mm256_blendv_epi8(
+      rounded, _mm256_set1_epi32(0x7fc0), _mm256_castps_si256(is_nan));
+  // packus works within 128-bit lanes; gather the two halves afterwards.
+  const __m256i packed = _mm256_permute4x64_epi64(
+      _mm256_packus_epi32(rounded, rounded), 0xd8);
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(ptr), _mm256_castsi256_si128(packed));
+}
+#define ET_VEC_HAS_BFLOAT16_CONVERSIONS
+
+#elif defined(__aarch64__)
+
+inline Vectorized<float> load_float_full(const torch::executor::Half* ptr) {
+  const float16x8_t values =
+      vreinterpretq_f16_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(ptr)));
+  return Vectorized<float>(
+      vcvt_f32_f16(vget_low_f16(values)), vcvt_high_f32_f16(values));
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::Half* ptr) {
+  const float16x8_t values =
+      vcvt_high_f16_f32(vcvt_f16_f32(v.get_low()), v.get_high());
+  vst1q_u16(reinterpret_cast<uint16_t*>(ptr), vreinterpretq_u16_f16(values));
+}
+#define ET_VEC_HAS_HALF_CONVERSIONS
+
+inline Vectorized<float> load_float_full(
+    const torch::executor::BFloat16* ptr) {
+  const uint16x8_t bits = vld1q_u16(reinterpret_cast<const uint16_t*>(ptr));
+  return Vectorized<float>(
+      vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(bits), 16)),
+      vreinterpretq_f32_u32(vshll_high_n_u16(bits, 16)));
+}
+
+inline uint16x4_t float_to_bf16(float32x4_t v) {
+  const uint32x4_t bits = vreinterpretq_u32_f32(v);
+  const uint32x4_t lsb = vandq_u32(vshrq_n_u32(bits, 16), vdupq_n_u32(1));
+  uint32x4_t rounded =
+      vaddq_u32(bits, vaddq_u32(lsb, vdupq_n_u32(0x7fff)));
+  const uint32x4_t is_nan = vmvnq_u32(vceqq_f32(v, v));
+  rounded = vbslq_u32(is_nan, vdupq_n_u32(0x7fc00000), rounded);
+  return vshrn_n_u32(rounded, 16);
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::BFloat16* ptr) {
+  vst1q_u16(
+      reinterpret_cast<uint16_t*>(ptr),
+      vcombine_u16(float_to_bf16(v.get_low()), float_to_bf16(v.get_high())));
+}
+#define ET_VEC_HAS_BFLOAT16_CONVERSIONS
+
+#endif
+
+#ifndef ET_VEC_HAS_HALF_CONVERSIONS
+inline Vectorized<float> load_float_full(const torch::executor::Half* ptr) {
+  __at_align__ float values[Vectorized<float>::size()];
+  for (int64_t i = 0; i < Vectorized<float>::size(); ++i) {
+    values[i] = static_cast<float>(ptr[i]);
+  }
+  return Vectorized<float>::loadu(values);
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::Half* ptr) {
+  __at_align__ float values[Vectorized<float>::size()];
+  v.store(values);
+  for (int64_t i = 0; i < Vectorized<float>::size(); ++i) {
+    ptr[i] = torch::executor::Half(values[i]);
+  }
+}
+#endif // ET_VEC_HAS_HALF_CONVERSIONS
+
+#ifndef ET_VEC_HAS_BFLOAT16_CONVERSIONS
+inline Vectorized<float> load_float_full(
+    const torch::executor::BFloat16* ptr) {
+  __at_align__ float values[Vectorized<float>::size()];
+  for (int64_t i = 0; i < Vectorized<float>::size(); ++i) {
+    values[i] = bf16_to_float(ptr[i].x);
+  }
+  return Vectorized<float>::loadu(values);
+}
+
+inline void store_float_full(
+    const Vectorized<float>& v,
+    torch::executor::BFloat16* ptr) {
+  __at_align__ float values[Vectorized<float>::size()];
+  v.store(values);
+  for (int64_t i = 0; i < Vectorized<float>::size(); ++i) {
+    ptr[i].x = float_to_bf16(values[i]);
+  }
+}
+#endif // ET_VEC_HAS_BFLOAT16_CONVERSIONS
+
+#undef ET_VEC_HAS_HALF_CONVERSIONS
+#undef ET_VEC_HAS_BFLOAT16_CONVERSIONS
+
+} // namespace detail
+
+/**
+ * Loads `count` Half or BFloat16 values, converting them to float. The lanes
+ * past `count` are zero.
+ */
+template <
+    typename T,
+    typename std::enable_if<is_reduced_floating_point<T>::value, int>::type =
+        0>
+inline Vectorized<float> load_float(
+    const T* ptr,
+    int64_t count = Vectorized<float>::size()) {
+  if (count == Vectorized<float>::size()) {
+    return detail::load_float_full(ptr);
+  }
+  T values[Vectorized<float>::size()] = {};
+  std::memcpy(values, ptr, count * sizeof(T));
+  return detail::load_float_full(values);
+}
+
+/**
+ * Rounds the first `count` lanes of `v` to Half or BFloat16 and stores them.
+ */
+template <
+    typename T,
+    typename std::enable_if<is_reduced_floating_point<T>::value, int>::type =
+        0>
+inline void store_float(
+    const Vectorized<float>& v,
+    T* ptr,
+    int64_t count = Vectorized<float>::size()) {
+  if (count == Vectorized<float>::size()) {
+    detail::store_float_full(v, ptr);
+    return;
+  }
+  T values[Vectorized<float>::size()];
+  detail::store_float_full(v, values);
+  std::memcpy(ptr, values, count * sizeof(T));
+}
+
+} // namespace CPU_CAPABILITY
+} // namespace vec
+} // namespace executorch
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -95,13 +96,13 @@ Tensor& _to_dim_order_copy_out(
       InvalidArgument,
       out);
 
-  ET_SWITCH_REALHB_TYPES(
-      self.scalar_type(), ctx, "_to_dim_order_copy_out", CTYPE_IN, [&] {
-        ET_SWITCH_REALHB_TYPES(
-            out.scalar_type(), ctx, "_to_dim_order_copy_out", CTYPE_OUT, [&] {
-              _to_dim_order_copy_impl<CTYPE_IN, CTYPE_OUT>(self, out);
-            });
-      });
+  constexpr auto name = "dim_order_ops::_to_dim_order_copy.out";
+
+  ET_SWITCH_REALHB_TYPES(self.scalar_type(), ctx, name, CTYPE_IN, [&] {
+    ET_SWITCH_REALHB_TYPES(out.scalar_type(), ctx, name, CTYPE_OUT, [&] {
+      _to_dim_order_copy_impl<CTYPE_IN, CTYPE_OUT>(self, out);
+    });
+  });
 
   return out;
 }
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -43,7 +44,9 @@ Tensor& as_strided_copy_out(
 
   size_t offset = storage_offset.has_value() ? storage_offset.value() : 0;
 
-  ET_SWITCH_ALL_TYPES(in.scalar_type(), ctx, __func__, CTYPE, [&] {
+  constexpr auto name = "as_strided_copy.out";
+
+  ET_SWITCH_ALL_TYPES(in.scalar_type(), ctx, name, CTYPE, [&] {
     as_strided_copy<CTYPE>(in, size, stride, offset, out);
   });
 
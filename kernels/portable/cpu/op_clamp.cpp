@@ -53,7 +53,7 @@ __ET_NODISCARD bool check_bounds(
         }
       });
     } else if (isFloatingType(out_type)) {
-      ET_SWITCH_FLOATH_TYPES(out_type, ctx, "clamp", CTYPE_OUT, [&]() {
+      ET_SWITCH_FLOATH_TYPES(out_type, ctx, "clamp.out", CTYPE_OUT, [&]() {
         if (std::isfinite(val) &&
             is_out_of_bounds<CTYPE_VAL, CTYPE_OUT, double>(val)) {
           ET_LOG(Error, "%s value out of bounds", val_name);
@@ -119,11 +119,11 @@ Tensor& clamp_out(
 
   ET_KERNEL_CHECK(ctx, common_type == out_type, InvalidArgument, out);
 
-  ET_SWITCH_REALH_TYPES(out_type, ctx, "clamp", CTYPE_OUT, [&]() {
+  ET_SWITCH_REALH_TYPES(out_type, ctx, "clamp.out", CTYPE_OUT, [&]() {
     // Extract optional min value
     CTYPE_OUT min = 0;
     if (has_min) {
-      ET_SWITCH_SCALAR_OBJ_TYPES(min_type, ctx, "clamp", CTYPE_MIN, [&]() {
+      ET_SWITCH_SCALAR_OBJ_TYPES(min_type, ctx, "clamp.out", CTYPE_MIN, [&]() {
         CTYPE_MIN min_val = 0;
         utils::extract_scalar(min_opt.value(), &min_val);
         min = static_cast<CTYPE_OUT>(min_val);
@@ -133,14 +133,14 @@ Tensor& clamp_out(
     // Extract optional max value
     CTYPE_OUT max = 0;
     if (has_max) {
-      ET_SWITCH_SCALAR_OBJ_TYPES(max_type, ctx, "clamp", CTYPE_MAX, [&]() {
+      ET_SWITCH_SCALAR_OBJ_TYPES(max_type, ctx, "clamp.out", CTYPE_MAX, [&]() {
         CTYPE_MAX max_val = 0;
         utils::extract_scalar(max_opt.value(), &max_val);
         max = static_cast<CTYPE_OUT>(max_val);
       });
     }
 
-    ET_SWITCH_REALHB_TYPES(in_type, ctx, "clamp", CTYPE_IN, [&]() {
+    ET_SWITCH_REALHB_TYPES(in_type, ctx, "clamp.out", CTYPE_IN, [&]() {
       apply_unary_map_fn(
           [has_min, min, has_max, max](const CTYPE_IN val_in) {
             CTYPE_OUT val_out = static_cast<CTYPE_OUT>(val_in);
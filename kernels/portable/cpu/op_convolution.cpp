@@ -8,6 +8,7 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
 #include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -130,6 +131,84 @@ void conv2d_impl(
   }
 }
 
+/**
+ * Computes the 2D convolution of channels-last tensors, whose weight is also
+ * channels last. Each output pixel is computed at once: for each out channel,
+ * the products run over the in channels of a pixel and of a weight tap, which
+ * are contiguous in both tensors.
+ */
+template <typename CTYPE, typename CTYPE_BIAS>
+void conv2d_nhwc_impl(
+    const CTYPE* const in_ptr,
+    SizesArrayRef in_sizes,
+    const CTYPE* const w_ptr,
+    SizesArrayRef w_sizes,
+    const CTYPE_BIAS* const bias_ptr,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    const int64_t groups,
+    CTYPE* const out_ptr,
+    SizesArrayRef out_sizes) {
+  const int64_t out_N = out_sizes[0];
+  const int64_t out_C = out_sizes[1];
+  const int64_t out_H = out_sizes[2];
+  const int64_t out_W = out_sizes[3];
+  const int64_t in_C = in_sizes[1];
+  const int64_t in_H = in_sizes[2];
+  const int64_t in_W = in_sizes[3];
+  const int64_t w_H = w_sizes[2];
+  const int64_t w_W = w_sizes[3];
+
+  const int64_t in_C_per_group = in_C / groups;
+  const int64_t out_C_per_group = out_C / groups;
+
+  const int64_t stride_y = val_at(stride, 0);
+  const int64_t padding_y = val_at(padding, 0, /*default_value=*/0);
+  const int64_t dilation_y = val_at(dilation, 0);
+  const int64_t stride_x = val_at(stride, 1);
+  const int64_t padding_x = val_at(padding, 1, /*default_value=*/0);
+  const int64_t dilation_x = val_at(dilation, 1);
+
+  for (int64_t n = 0; n < out_N; ++n) {
+    for (int64_t out_y = 0; out_y < out_H; ++out_y) {
+      for (int64_t out_x = 0; out_x < out_W; ++out_x) {
+        CTYPE* const out_pixel =
+            out_ptr + ((n * out_H + out_y) * out_W + out_x) * out_C;
+        for (int64_t out_c = 0; out_c < out_C; ++out_c) {
+          const int64_t in_c_start = (out_c / out_C_per_group) * in_C_per_group;
+          CTYPE accum = 0.0f;
+          for (int64_t w_y = 0; w_y < w_H; ++w_y) {
+            const int64_t in_y =
+                stride_y * out_y + dilation_y * w_y - padding_y;
+            if (in_y < 0 || in_y >= in_H) {
+              continue;
+            }
+            for (int64_t w_x = 0; w_x < w_W; ++w_x) {
+              const int64_t in_x =
+                  stride_x * out_x + dilation_x * w_x - padding_x;
+              if (in_x < 0 || in_x >= in_W) {
+                continue;
+              }
+              const CTYPE* const in_pixel = in_ptr +
+                  ((n * in_H + in_y) * in_W + in_x) * in_C + in_c_start;
+              const CTYPE* const w_tap =
+                  w_ptr + ((out_c * w_H + w_y) * w_W + w_x) * in_C_per_group;
+              for (int64_t c = 0; c < in_C_per_group; ++c) {
+                accum += in_pixel[c] * w_tap[c];
+              }
+            }
+          }
+          if (bias_ptr != nullptr) {
+            accum += convert<CTYPE, CTYPE_BIAS>(bias_ptr[out_c]);
+          }
+          out_pixel[out_c] = accum;
+        }
+      }
+    }
+  }
+}
+
 template <typename CTYPE, typename CTYPE_BIAS>
 void convolution_wrapper(
     const Tensor& in,
@@ -212,6 +291,31 @@ void convolution_wrapper(
     dilation_ = {dilation_arr, 2};
   }
 
+  CTYPE* const out_ptr = out.mutable_data_ptr<CTYPE>();
+  const CTYPE* const in_ptr = in.const_data_ptr<CTYPE>();
+  const CTYPE* const w_ptr = weight.const_data_ptr<CTYPE>();
+  const CTYPE_BIAS* const bias_ptr =
+      bias.has_value() ? bias.value().const_data_ptr<CTYPE_BIAS>() : nullptr;
+
+  if (is_channels_last_dim_order(in_dim_order.data(), in_dim_order.size()) &&
+      is_channels_last_dim_order(
+          weight_dim_order.data(), weight_dim_order.size()) &&
+      is_channels_last_dim_order(out_dim_order.data(), out_dim_order.size())) {
+    conv2d_nhwc_impl(
+        in_ptr,
+        in_sizes,
+        w_ptr,
+        weight_sizes,
+        bias_ptr,
+        stride_,
+        padding_,
+        dilation_,
+        groups,
+        out_ptr,
+        out_sizes);
+    return;
+  }
+
   exec_aten::StridesType in_strides[kTensorDimensionLimit];
   dim_order_to_stride_nocheck(
       in_sizes.data(), in_dim_order.data(), in_sizes.size(), in_strides);
@@ -227,12 +331,6 @@ void convolution_wrapper(
   dim_order_to_stride_nocheck(
       out_sizes.data(), out_dim_order.data(), out_sizes.size(), out_strides);
 
-  CTYPE* const out_ptr = out.mutable_data_ptr<CTYPE>();
-  const CTYPE* const in_ptr = in.const_data_ptr<CTYPE>();
-  const CTYPE* const w_ptr = weight.const_data_ptr<CTYPE>();
-  const CTYPE_BIAS* const bias_ptr =
-      bias.has_value() ? bias.value().const_data_ptr<CTYPE_BIAS>() : nullptr;
-
   for (size_t batch = 0; batch < out_N; ++batch) {
     for (size_t group = 0; group < groups; ++group) {
       // Align channel offset based on the group
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <executorch/runtime/platform/assert.h>
@@ -99,9 +100,9 @@ Tensor& cumsum_out(
   dim = (self.dim() == 0) ? 0 : dim < 0 ? dim + self.dim() : dim;
 
   ET_SWITCH_REAL_TYPES_AND(
-      Bool, self.scalar_type(), ctx, "cumsum", CTYPE_SELF, [&] {
+      Bool, self.scalar_type(), ctx, "cumsum.out", CTYPE_SELF, [&] {
         ET_SWITCH_REAL_TYPES_AND(
-            Bool, out.scalar_type(), ctx, "cumsum", CTYPE_OUT, [&] {
+            Bool, out.scalar_type(), ctx, "cumsum.out", CTYPE_OUT, [&] {
               cumsum_tensors<CTYPE_SELF, CTYPE_OUT>(self, dim, out);
             });
       });
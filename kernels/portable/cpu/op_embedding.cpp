@@ -8,6 +8,8 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/kernel_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -56,13 +58,16 @@ void embedding_kernel(
         "indices_ptr[%d] %ld < 0",
         i,
         static_cast<long>(indices_ptr[i]));
-    if (w_data != nullptr) {
-      memcpy(
-          out_data,
-          w_data + nbytes_per_entry * indices_ptr[i],
-          nbytes_per_entry);
-    }
-    out_data += nbytes_per_entry;
+  }
+  if (w_data != nullptr) {
+    gather_rows(
+        w_data,
+        out_data,
+        indices_ptr,
+        indices.numel(),
+        /*num_outer=*/1,
+        weight_height,
+        nbytes_per_entry);
   }
 }
 } // namespace
@@ -107,7 +112,7 @@ Tensor& embedding_out(
       "Expected indices tensor to have Long or Int scalar types");
 
   ET_SWITCH_TWO_TYPES(
-      Long, Int, ix_type, ctx, "op_embedding.out", CTYPE, [&]() {
+      Long, Int, ix_type, ctx, "embedding.out", CTYPE, [&]() {
         embedding_kernel<CTYPE>(ctx, weight, indices, out);
       });
 
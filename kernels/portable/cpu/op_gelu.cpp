@@ -9,6 +9,7 @@
 #include <cmath>
 
 #include <executorch/kernels/portable/cpu/math_constants.h>
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/activation_ops_util.h>
 #include <executorch/kernels/portable/cpu/util/functional_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -11,8 +11,10 @@
 #include <cstring>
 #include <tuple>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/advanced_index_util.h>
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -72,6 +74,38 @@ Tensor& index_Tensor_out(
     return out;
   }
 
+  // A single integral index selects whole rows along its dimension, laid out
+  // in out as index_select would.
+  const int64_t gather_dim = get_single_integral_index_dim(indices);
+  if (gather_dim >= 0) {
+    const Tensor& index = indices[gather_dim].value();
+    ET_KERNEL_CHECK(
+        ctx,
+        check_integral_index_bounds(in, gather_dim, index),
+        InvalidArgument,
+        out);
+    ET_SWITCH_REALHB_TYPES(in_type, ctx, "index.Tensor_out", CTYPE, [&]() {
+      ET_SWITCH_TWO_TYPES(
+          Long,
+          Int,
+          index.scalar_type(),
+          ctx,
+          "index.Tensor_out",
+          CTYPE_IX,
+          [&]() {
+            gather_rows(
+                in.const_data_ptr<char>(),
+                out.mutable_data_ptr<char>(),
+                index.const_data_ptr<CTYPE_IX>(),
+                index.numel(),
+                getLeadingDims(in, gather_dim),
+                in.size(gather_dim),
+                getTrailingDims(in, gather_dim) * sizeof(CTYPE));
+          });
+    });
+    return out;
+  }
+
   int32_t dim_map[kTensorDimensionLimit];
   int32_t ix_map[kTensorDimensionLimit];
   size_t start = 0;
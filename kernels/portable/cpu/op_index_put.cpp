@@ -8,8 +8,10 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/advanced_index_util.h>
 #include <executorch/kernels/portable/cpu/util/broadcast_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -91,6 +93,66 @@ Tensor& index_put_out(
   // To start, copy the input data into the out tensor
   memcpy(out.mutable_data_ptr<char>(), in.const_data_ptr<char>(), in.nbytes());
 
+  // A single integral index selects whole rows along its dimension. When the
+  // values need no broadcasting, write them row by row. Slices along the
+  // leading dims are disjoint, but an index may repeat within one, so the
+  // rows of a slice are written in order.
+  bool values_match_x = values.dim() == x_dim;
+  for (size_t i = 0; values_match_x && i < x_dim; i++) {
+    values_match_x = values.size(i) == x_sizes[i];
+  }
+  const int64_t scatter_dim = get_single_integral_index_dim(indices);
+  if (scatter_dim >= 0 && values_match_x) {
+    const Tensor& index = indices[scatter_dim].value();
+    ET_KERNEL_CHECK(
+        ctx,
+        check_integral_index_bounds(in, scatter_dim, index),
+        InvalidArgument,
+        out);
+    const size_t outer = getLeadingDims(in, scatter_dim);
+    const size_t inner = getTrailingDims(in, scatter_dim);
+    const size_t rows = in.size(scatter_dim);
+    const size_t num_indices = index.numel();
+    ET_SWITCH_REALHB_TYPES(in_type, ctx, "index_put.out", CTYPE, [&]() {
+      ET_SWITCH_TWO_TYPES(
+          Long,
+          Int,
+          index.scalar_type(),
+          ctx,
+          "index_put.out",
+          CTYPE_IX,
+          [&]() {
+            const CTYPE_IX* const index_data = index.const_data_ptr<CTYPE_IX>();
+            const CTYPE* const values_data = values.const_data_ptr<CTYPE>();
+            CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
+            parallel_for_each_chunk(
+                0,
+                outer,
+                num_indices * inner,
+                [&](const int64_t begin, const int64_t end) {
+                  for (int64_t i = begin; i < end; ++i) {
+                    for (size_t j = 0; j < num_indices; ++j) {
+                      const int64_t index_val = index_data[j];
+                      const size_t row =
+                          index_val < 0 ? index_val + rows : index_val;
+                      CTYPE* const dst = out_data + (i * rows + row) * inner;
+                      const CTYPE* const src =
+                          values_data + (i * num_indices + j) * inner;
+                      if (accumulate) {
+                        for (size_t k = 0; k < inner; ++k) {
+                          dst[k] += src[k];
+                        }
+                      } else {
+                        memcpy(dst, src, inner * sizeof(CTYPE));
+                      }
+                    }
+                  }
+                });
+          });
+    });
+    return out;
+  }
+
   // In what follows, `x = in[indices]`. This tensor is implicit, and it would
   // be much easier to be able to allocate memory, and then call index.Tensor
   // to compute `x`. But since we can't do that, we have to keep track of its
@@ -10,6 +10,8 @@
 #include <cstdint>
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
+#include <executorch/kernels/portable/cpu/util/gather_util.h>
 #include <executorch/kernels/portable/cpu/util/index_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -67,16 +69,15 @@ Tensor& index_select_out(
 
   ET_SWITCH_TWO_TYPES(
       Long, Int, ix_type, ctx, "index_select.out", CTYPE, [&]() {
-        const CTYPE* const index_arr = index.mutable_data_ptr<CTYPE>();
-        for (int i = 0; i < leading_dims; i++) {
-          const char* src = input_data + i * in_dim_length * length_per_step;
-          char* dest = out_data + i * out_dim_length * length_per_step;
-          for (auto j = 0; j < out_dim_length; j++) {
-            const char* copy_src = src + index_arr[j] * length_per_step;
-            memcpy(dest, copy_src, length_per_step);
-            dest += length_per_step;
-          }
-        }
+        // The indices were validated by check_index_select_args().
+        gather_rows(
+            input_data,
+            out_data,
+            index.const_data_ptr<CTYPE>(),
+            out_dim_length,
+            leading_dims,
+            in_dim_length,
+            length_per_step);
       });
 
   return out;
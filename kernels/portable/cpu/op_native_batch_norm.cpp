@@ -6,9 +6,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <tuple>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <executorch/runtime/platform/assert.h>
@@ -66,10 +68,21 @@ std::tuple<Tensor&, Tensor&, Tensor&> _native_batch_norm_legit_no_training_out(
       InvalidArgument,
       ret_val);
 
-  // For now, only support the contiguous dim order
+  // Support the contiguous dim order, and channels last when the output has it
+  // too, in which case the channels are the innermost dimension.
+  const bool channels_last =
+      is_channels_last_dim_order(in.dim_order().data(), in.dim_order().size());
   ET_KERNEL_CHECK(
       ctx,
-      is_contiguous_dim_order(in.dim_order().data(), in.dim_order().size()),
+      is_contiguous_dim_order(in.dim_order().data(), in.dim_order().size()) ||
+          channels_last,
+      InvalidArgument,
+      ret_val);
+  ET_KERNEL_CHECK(
+      ctx,
+      channels_last ==
+          is_channels_last_dim_order(
+              out.dim_order().data(), out.dim_order().size()),
       InvalidArgument,
       ret_val);
 
@@ -78,7 +91,7 @@ std::tuple<Tensor&, Tensor&, Tensor&> _native_batch_norm_legit_no_training_out(
   size_t outer = getLeadingDims(in, C_dim);
   size_t inner = getTrailingDims(in, C_dim);
 
-  constexpr auto name = "native_batch_norm_legit_no_training.out";
+  constexpr auto name = "_native_batch_norm_legit_no_training.out";
 
   ET_SWITCH_FLOAT_TYPES(in.scalar_type(), ctx, name, CTYPE, [&] {
     const CTYPE* in_data = in.const_data_ptr<CTYPE>();
@@ -86,22 +99,49 @@ std::tuple<Tensor&, Tensor&, Tensor&> _native_batch_norm_legit_no_training_out(
 
     const CTYPE* const mean_data = running_mean.const_data_ptr<CTYPE>();
     const CTYPE* const var_data = running_var.const_data_ptr<CTYPE>();
+    const CTYPE* const weight_data =
+        weight.has_value() ? weight.value().const_data_ptr<CTYPE>() : nullptr;
+    const CTYPE* const bias_data =
+        bias.has_value() ? bias.value().const_data_ptr<CTYPE>() : nullptr;
+
+    // out = in * scale + shift, folding the statistics and affine parameters
+    // of channel c.
+    auto scale_and_shift = [&](size_t c, CTYPE& scale, CTYPE& shift) {
+      CTYPE invstd = 1.0 / std::sqrt(var_data[c] + eps);
+      scale = invstd * (weight_data != nullptr ? weight_data[c] : CTYPE(1));
+      shift = (bias_data != nullptr ? bias_data[c] : CTYPE(0)) -
+          mean_data[c] * scale;
+    };
+
+    if (channels_last) {
+      // Every pixel holds the C channels contiguously. Fold the parameters of
+      // a block of channels once, then apply them to all the pixels.
+      constexpr size_t kBlock = 64;
+      CTYPE scale[kBlock];
+      CTYPE shift[kBlock];
+      const size_t num_pixels = outer * inner;
+      for (size_t c0 = 0; c0 < C; c0 += kBlock) {
+        const size_t block = std::min(kBlock, C - c0);
+        for (size_t c = 0; c < block; ++c) {
+          scale_and_shift(c0 + c, scale[c], shift[c]);
+        }
+        for (size_t i = 0; i < num_pixels; ++i) {
+          const CTYPE* const in_pixel = in_data + i * C + c0;
+          CTYPE* const out_pixel = out_data + i * C + c0;
+          for (size_t c = 0; c < block; ++c) {
+            out_pixel[c] = in_pixel[c] * scale[c] + shift[c];
+          }
+        }
+      }
+      return;
+    }
 
     for (size_t i = 0; i < outer; ++i) {
       for (size_t c = 0; c < C; ++c) {
-        CTYPE mean = mean_data[c];
-        CTYPE var = var_data[c];
-        CTYPE invstd = 1.0 / std::sqrt(var + eps);
-        CTYPE weight_val = 1;
-        if (weight.has_value()) {
-          weight_val = weight.value().const_data_ptr<CTYPE>()[c];
-        }
-        CTYPE bias_val = 0;
-        if (bias.has_value()) {
-          bias_val = bias.value().const_data_ptr<CTYPE>()[c];
-        }
+        CTYPE scale, shift;
+        scale_and_shift(c, scale, shift);
         for (size_t j = 0; j < inner; ++j) {
-          *out_data = (*in_data - mean) * invstd * weight_val + bias_val;
+          *out_data = *in_data * scale + shift;
           out_data++;
           in_data++;
         }
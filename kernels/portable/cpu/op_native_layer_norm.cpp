@@ -6,7 +6,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/normalization_ops_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/kernels/portable/cpu/vec_ops.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <cmath>
@@ -66,27 +68,31 @@ void layer_norm(
     bias_data = nullptr;
   }
 
-  for (int i = 0; i < leading; ++i) {
-    const CTYPE* x = input_data + i * normalized;
-    CTYPE* y = out_data + i * normalized;
-
-    // compute E[X] and Var[x] = E[x^2] - E[x]^2
-    CTYPE sum = reduce_add(x, normalized);
-    CTYPE sq_sum = vec_powerf(x, normalized);
-    CTYPE mean_value = sum / normalized;
-    CTYPE variance = sq_sum / normalized - mean_value * mean_value;
-    CTYPE std = std::sqrt(variance + eps);
-
-    // Calculate the elements of output
-    for (int j = 0; j < normalized; ++j) {
-      CTYPE w = weight_data ? weight_data[j] : static_cast<CTYPE>(1);
-      CTYPE b = bias_data ? bias_data[j] : static_cast<CTYPE>(0);
-      y[j] = (x[j] - mean_value) / std * w + b;
-    }
-
-    mean_data[i] = mean_value;
-    rstd_data[i] = 1.0 / std;
-  }
+  // Rows are normalized independently; each one reads its input three times.
+  parallel_for_each_chunk(
+      0, leading, 3 * normalized, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const CTYPE* x = input_data + i * normalized;
+          CTYPE* y = out_data + i * normalized;
+
+          // compute E[X] and Var[x] = E[x^2] - E[x]^2
+          CTYPE sum = reduce_add(x, normalized);
+          CTYPE sq_sum = vec_powerf(x, normalized);
+          CTYPE mean_value = sum / normalized;
+          CTYPE variance = sq_sum / normalized - mean_value * mean_value;
+          CTYPE std = std::sqrt(variance + eps);
+
+          // Calculate the elements of output
+          for (int j = 0; j < normalized; ++j) {
+            CTYPE w = weight_data ? weight_data[j] : static_cast<CTYPE>(1);
+            CTYPE b = bias_data ? bias_data[j] : static_cast<CTYPE>(0);
+            y[j] = (x[j] - mean_value) / std * w + b;
+          }
+
+          mean_data[i] = mean_value;
+          rstd_data[i] = 1.0 / std;
+        }
+      });
 }
 
 } // namespace
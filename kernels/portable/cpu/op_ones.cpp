@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -20,7 +21,9 @@ Tensor& ones_out(RuntimeContext& ctx, IntArrayRef size, Tensor& out) {
       ctx, resize_tensor(out, size) == Error::Ok, InvalidArgument, out);
 
   ScalarType out_type = out.scalar_type();
-  ET_SWITCH_REAL_TYPES_AND(Bool, out_type, ctx, __func__, CTYPE, [&] {
+  constexpr auto name = "ones.out";
+
+  ET_SWITCH_REAL_TYPES_AND(Bool, out_type, ctx, name, CTYPE, [&] {
     auto out_data = out.mutable_data_ptr<CTYPE>();
     for (size_t i = 0; i < out.numel(); i++) {
       out_data[i] = static_cast<CTYPE>(1);
@@ -6,6 +6,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <cstring>
+
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -19,21 +23,153 @@ using IntArrayRef = exec_aten::ArrayRef<int64_t>;
 
 namespace {
 
-void increment_coordinate_permuted(
-    const Tensor& tensor,
-    size_t* const coordinate,
-    IntArrayRef dims) {
-  for (int i = dims.size() - 1; i >= 0; i--) {
-    size_t d = dims[i] >= 0 ? dims[i] : dims[i] + tensor.dim();
-    coordinate[d]++;
-    if (coordinate[d] == tensor.size(d)) {
-      coordinate[d] = 0;
+// Side of the square tiles in which transposes are copied, so that both the
+// reads and the writes of a tile stay within a few cache lines per row.
+constexpr size_t kTransposeTile = 16;
+
+// The permutation as a copy from the strided input to the contiguous output:
+// the dims of out with their sizes and input strides in elements, dropping
+// the dims of size one and merging the ones that are adjacent in both.
+struct PermutedLayout {
+  size_t ndim = 0;
+  size_t sizes[kTensorDimensionLimit];
+  size_t in_strides[kTensorDimensionLimit];
+  size_t out_strides[kTensorDimensionLimit];
+};
+
+PermutedLayout coalesce_permuted_dims(const Tensor& in, IntArrayRef dims) {
+  PermutedLayout layout;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    const size_t d = dims[i] >= 0 ? dims[i] : dims[i] + in.dim();
+    const size_t size = in.size(d);
+    const size_t stride = in.strides()[d];
+    if (size == 1) {
+      continue;
+    }
+    if (layout.ndim > 0 &&
+        layout.in_strides[layout.ndim - 1] == stride * size) {
+      layout.sizes[layout.ndim - 1] *= size;
+      layout.in_strides[layout.ndim - 1] = stride;
     } else {
+      layout.sizes[layout.ndim] = size;
+      layout.in_strides[layout.ndim] = stride;
+      layout.ndim++;
+    }
+  }
+  size_t out_stride = 1;
+  for (size_t i = layout.ndim; i-- > 0;) {
+    layout.out_strides[i] = out_stride;
+    out_stride *= layout.sizes[i];
+  }
+  return layout;
+}
+
+// Calls fn(in_offset, out_offset) for every index of the dims of the layout
+// listed in `loop_dims`, the last one varying fastest.
+template <typename Fn>
+void for_each_index(
+    const PermutedLayout& layout,
+    const size_t* loop_dims,
+    size_t num_loop_dims,
+    const Fn& fn) {
+  size_t index[kTensorDimensionLimit] = {0};
+  size_t in_offset = 0;
+  size_t out_offset = 0;
+  while (true) {
+    fn(in_offset, out_offset);
+    size_t i = num_loop_dims;
+    for (; i > 0; --i) {
+      const size_t d = loop_dims[i - 1];
+      in_offset += layout.in_strides[d];
+      out_offset += layout.out_strides[d];
+      if (++index[i - 1] < layout.sizes[d]) {
+        break;
+      }
+      in_offset -= layout.in_strides[d] * layout.sizes[d];
+      out_offset -= layout.out_strides[d] * layout.sizes[d];
+      index[i - 1] = 0;
+    }
+    if (i == 0) {
       return;
     }
   }
 }
 
+template <typename CTYPE>
+void permute_copy(
+    const PermutedLayout& layout,
+    const CTYPE* const in_data,
+    CTYPE* const out_data) {
+  if (layout.ndim == 0) {
+    out_data[0] = in_data[0];
+    return;
+  }
+  const size_t last = layout.ndim - 1;
+  size_t loop_dims[kTensorDimensionLimit];
+
+  // The innermost dim is contiguous in both: copy whole rows.
+  if (layout.in_strides[last] == 1) {
+    for (size_t i = 0; i < last; ++i) {
+      loop_dims[i] = i;
+    }
+    const size_t nbytes = layout.sizes[last] * sizeof(CTYPE);
+    for_each_index(layout, loop_dims, last, [&](size_t in, size_t out) {
+      std::memcpy(out_data + out, in_data + in, nbytes);
+    });
+    return;
+  }
+
+  // The dim that is contiguous in the input is another one of out: transpose
+  // it with the innermost one, tile by tile.
+  size_t transposed = last;
+  for (size_t i = 0; i < last; ++i) {
+    if (layout.in_strides[i] == 1) {
+      transposed = i;
+    }
+  }
+  if (transposed != last) {
+    size_t num_loop_dims = 0;
+    for (size_t i = 0; i < last; ++i) {
+      if (i != transposed) {
+        loop_dims[num_loop_dims++] = i;
+      }
+    }
+    const size_t rows = layout.sizes[transposed];
+    const size_t cols = layout.sizes[last];
+    const size_t out_row_stride = layout.out_strides[transposed];
+    const size_t in_col_stride = layout.in_strides[last];
+    for_each_index(
+        layout, loop_dims, num_loop_dims, [&](size_t in, size_t out) {
+          for (size_t r0 = 0; r0 < rows; r0 += kTransposeTile) {
+            const size_t r1 = std::min(rows, r0 + kTransposeTile);
+            for (size_t c0 = 0; c0 < cols; c0 += kTransposeTile) {
+              const size_t c1 = std::min(cols, c0 + kTransposeTile);
+              for (size_t r = r0; r < r1; ++r) {
+                CTYPE* const dst = out_data + out + r * out_row_stride;
+                const CTYPE* const src = in_data + in + r;
+                for (size_t c = c0; c < c1; ++c) {
+                  dst[c] = src[c * in_col_stride];
+                }
+              }
+            }
+          }
+        });
+    return;
+  }
+
+  // Otherwise gather the innermost dim element by element.
+  for (size_t i = 0; i < last; ++i) {
+    loop_dims[i] = i;
+  }
+  const size_t cols = layout.sizes[last];
+  const size_t in_col_stride = layout.in_strides[last];
+  for_each_index(layout, loop_dims, last, [&](size_t in, size_t out) {
+    for (size_t c = 0; c < cols; ++c) {
+      out_data[out + c] = in_data[in + c * in_col_stride];
+    }
+  });
+}
+
 } // namespace
 
 Tensor& permute_copy_out(
@@ -56,18 +192,16 @@ Tensor& permute_copy_out(
       InvalidArgument,
       out);
 
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  const PermutedLayout layout = coalesce_permuted_dims(in, dims);
   const auto in_type = out.scalar_type();
   // in and out must be the same dtype
   ET_SWITCH_ALL_TYPES(in_type, ctx, "permute_copy.out", CTYPE, [&] {
-    const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
-    CTYPE* const out_data = out.mutable_data_ptr<CTYPE>();
-
-    size_t in_coord[kTensorDimensionLimit] = {0};
-
-    for (size_t i = 0; i < out.numel(); ++i) {
-      out_data[i] = in_data[coordinateToIndex(in, in_coord)];
-      increment_coordinate_permuted(in, in_coord, dims);
-    }
+    permute_copy(
+        layout, in.const_data_ptr<CTYPE>(), out.mutable_data_ptr<CTYPE>());
   });
 
   return out;
@@ -69,6 +69,12 @@ Tensor& slice_copy_Tensor_out(
 
   for (int i = 0; i < leading_dims; i++) {
     const char* src = input_data + (i * dim_length + start) * length_per_step;
+    if (step == 1) {
+      // The selected rows are adjacent.
+      memcpy(dest, src, num_values * length_per_step);
+      dest += num_values * length_per_step;
+      continue;
+    }
     for (int j = 0; j < num_values; j++) {
       memcpy(dest, src, length_per_step);
       src += step * length_per_step;
@@ -8,6 +8,7 @@
 
 #include <cstring>
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -45,7 +46,29 @@ Tensor& stack_out(
   const size_t ninputs = tensors.size();
 
   const auto out_type = out.scalar_type();
+  bool same_type = true;
+  for (size_t j = 0; j < ninputs; ++j) {
+    if (tensors[j].scalar_type() != out_type) {
+      same_type = false;
+      break;
+    }
+  }
+
   ET_SWITCH_REAL_TYPES_AND(Bool, out_type, ctx, "stack.out", CTYPE_OUT, [&] {
+    if (same_type) {
+      // Every input contributes one contiguous block per outer index.
+      const size_t nbytes = inner * sizeof(CTYPE_OUT);
+      char* out_bytes = out.mutable_data_ptr<char>();
+      for (size_t i = 0; i < outer; ++i) {
+        for (size_t j = 0; j < ninputs; ++j) {
+          const char* const in_bytes = tensors[j].const_data_ptr<char>();
+          std::memcpy(out_bytes, in_bytes + i * nbytes, nbytes);
+          out_bytes += nbytes;
+        }
+      }
+      return;
+    }
+
     CTYPE_OUT* out_ptr = out.mutable_data_ptr<CTYPE_OUT>();
     for (size_t i = 0; i < outer; ++i) {
       for (size_t j = 0; j < ninputs; ++j) {
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/transpose_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <cstring>
@@ -30,6 +31,7 @@ Tensor& t_copy_out(RuntimeContext& ctx, const Tensor& in, Tensor& out) {
   ET_KERNEL_CHECK(ctx, check_t_copy_args(in, out), InvalidArgument, out);
 
   ScalarType in_type = in.scalar_type();
+  constexpr auto name = "t_copy.out";
 
   if (in.dim() < 2) {
     // Resize for dynamic shape
@@ -37,7 +39,7 @@ Tensor& t_copy_out(RuntimeContext& ctx, const Tensor& in, Tensor& out) {
         ctx, resize_tensor(out, in.sizes()) == Error::Ok, InvalidArgument, out);
 
     if (in.numel() > 0) {
-      ET_SWITCH_ALL_TYPES(in_type, ctx, __func__, CTYPE, [&]() {
+      ET_SWITCH_ALL_TYPES(in_type, ctx, name, CTYPE, [&]() {
         const CTYPE* in_data = in.const_data_ptr<CTYPE>();
         CTYPE* out_data = out.mutable_data_ptr<CTYPE>();
         memcpy(out_data, in_data, in.nbytes());
@@ -58,7 +60,7 @@ Tensor& t_copy_out(RuntimeContext& ctx, const Tensor& in, Tensor& out) {
       InvalidArgument,
       out);
 
-  ET_SWITCH_ALL_TYPES(in_type, ctx, __func__, CTYPE, [&] {
+  ET_SWITCH_ALL_TYPES(in_type, ctx, name, CTYPE, [&] {
     transpose_tensors<CTYPE>(in, 1, 0, out);
   });
 
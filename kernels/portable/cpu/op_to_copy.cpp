@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/copy_ops_util.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -46,8 +47,10 @@ Tensor& to_copy_out(
       InvalidArgument,
       out);
 
-  ET_SWITCH_REALHB_TYPES(self.scalar_type(), ctx, "to_copy", CTYPE_IN, [&] {
-    ET_SWITCH_REALHB_TYPES(out.scalar_type(), ctx, "to_copy", CTYPE_OUT, [&] {
+  constexpr auto name = "_to_copy.out";
+
+  ET_SWITCH_REALHB_TYPES(self.scalar_type(), ctx, name, CTYPE_IN, [&] {
+    ET_SWITCH_REALHB_TYPES(out.scalar_type(), ctx, name, CTYPE_OUT, [&] {
       _to_impl<CTYPE_IN, CTYPE_OUT>(self, out);
     });
   });
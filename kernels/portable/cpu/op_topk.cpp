@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <tuple>
+
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+#include <executorch/kernels/portable/cpu/util/topk_util.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+/**
+ * Selects the top k of every slice of `in` along `dim` with a heap of k
+ * elements, in O(n log k) per slice, splitting the slices across threads.
+ */
+template <bool kLargest, typename CTYPE>
+void topk(
+    const Tensor& in,
+    const int64_t k,
+    const int64_t dim,
+    Tensor& values,
+    Tensor& indices) {
+  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
+  CTYPE* const values_data = values.mutable_data_ptr<CTYPE>();
+  long* const indices_data = indices.mutable_data_ptr<long>();
+
+  const int64_t outer = in.dim() == 0 ? 1 : getLeadingDims(in, dim);
+  const int64_t dim_size = in.dim() == 0 ? 1 : in.size(dim);
+  const int64_t inner = in.dim() == 0 ? 1 : getTrailingDims(in, dim);
+
+  parallel_for_each_chunk(
+      0, outer * inner, dim_size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t slice = begin; slice < end; ++slice) {
+          const int64_t i = slice / inner;
+          const int64_t j = slice % inner;
+          internal::topk_slice<kLargest>(
+              in_data + i * dim_size * inner + j,
+              dim_size,
+              inner,
+              k,
+              values_data + i * k * inner + j,
+              indices_data + i * k * inner + j,
+              inner);
+        }
+      });
+}
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> topk_values(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    bool largest,
+    bool sorted,
+    Tensor& values,
+    Tensor& indices) {
+  // The outputs are always sorted, which sorted = false allows.
+  (void)sorted;
+  std::tuple<Tensor&, Tensor&> out(values, indices);
+
+  ET_KERNEL_CHECK(
+      ctx, check_topk_args(in, k, dim, values, indices), InvalidArgument, out);
+
+  Tensor::SizesType target_sizes[kTensorDimensionLimit];
+  size_t target_ndim = 0;
+  get_topk_out_target_size(in, k, dim, target_sizes, &target_ndim);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(values, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx,
+      resize_tensor(indices, {target_sizes, target_ndim}) == Error::Ok,
+      InvalidArgument,
+      out);
+
+  if (values.numel() == 0) {
+    return out;
+  }
+
+  dim = dim < 0 ? dim + in.dim() : dim;
+
+  ET_SWITCH_REAL_TYPES(in.scalar_type(), ctx, "topk.values", CTYPE, [&]() {
+    if (largest) {
+      topk</*kLargest=*/true, CTYPE>(in, k, dim, values, indices);
+    } else {
+      topk</*kLargest=*/false, CTYPE>(in, k, dim, values, indices);
+    }
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
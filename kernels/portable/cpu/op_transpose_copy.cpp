@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <executorch/kernels/portable/cpu/selective_build.h>
 #include <executorch/kernels/portable/cpu/util/transpose_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
@@ -57,7 +58,9 @@ Tensor& transpose_copy_int_out(
       InvalidArgument,
       out);
 
-  ET_SWITCH_ALL_TYPES(in.scalar_type(), ctx, __func__, CTYPE, [&] {
+  constexpr auto name = "transpose_copy.int_out";
+
+  ET_SWITCH_ALL_TYPES(in.scalar_type(), ctx, name, CTYPE, [&] {
     transpose_tensors<CTYPE>(in, dim0, dim1, out);
   });
 
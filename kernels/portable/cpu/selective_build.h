@@ -14,6 +14,12 @@
 // include header generated by
 // executorch/codegen/tools/gen_selected_op_variants.py
 #include <executorch/kernels/portable/cpu/selected_op_variants.h>
+
+// Only compile in the switch cases of the dtypes selected for the operator
+// named by the switch, see ET_INTERNAL_SWITCH_CASE.
+#undef ET_INTERNAL_SELECTED_DTYPE
+#define ET_INTERNAL_SELECTED_DTYPE(enum_type) \
+  ::should_include_kernel_dtype(et_switch_name, enum_type)
 #else
 // dummy implementation
 inline constexpr bool should_include_kernel_dtype(
@@ -24,21 +30,4 @@ inline constexpr bool should_include_kernel_dtype(
 }
 #endif
 
-namespace torch {
-namespace executor {
-#define ET_INTERNAL_CHECK_SELECTIVE_BUILD(enum_type)               \
-  do {                                                             \
-    if (!should_include_kernel_dtype(et_switch_name, enum_type)) { \
-      ET_LOG(                                                      \
-          Error,                                                   \
-          "dtype '%" PRId8 "' not selected for operator %s",       \
-          static_cast<int8_t>(enum_type),                          \
-          et_switch_name);                                         \
-      torch::executor::runtime_abort();                            \
-    }                                                              \
-  } while (0)
-
-} // namespace executor
-} // namespace torch
-
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
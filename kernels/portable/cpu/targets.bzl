@@ -14,6 +14,7 @@ _ATEN_OPS = (
         name = "op_abs",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -55,6 +56,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -64,6 +66,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -71,6 +74,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -86,18 +90,21 @@ _ATEN_OPS = (
         name = "op_argmax",
         deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_argmin",
         deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_as_strided_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -123,6 +130,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -135,6 +143,7 @@ _ATEN_OPS = (
         name = "op_avg_pool2d",
         deps = [
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -154,6 +163,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -183,12 +193,14 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:matmul_ops_util",
             ":vec_ops",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_cat",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -196,6 +208,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:distance_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -228,6 +241,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
             ":vec_ops",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -257,6 +271,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -269,6 +284,7 @@ _ATEN_OPS = (
         name = "op_diagonal_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -283,7 +299,9 @@ _ATEN_OPS = (
     op_target(
         name = "op_embedding",
         deps = [
+            "//executorch/kernels/portable/cpu/util:gather_util",
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -338,6 +356,7 @@ _ATEN_OPS = (
         name = "op_flip",
         deps = [
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -351,6 +370,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:math_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -391,6 +411,7 @@ _ATEN_OPS = (
             ":math_constants",
             "//executorch/kernels/portable/cpu/util:activation_ops_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -399,6 +420,7 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:activation_ops_util",
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -422,6 +444,8 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:advanced_index_util",
             "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:gather_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -429,12 +453,16 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:advanced_index_util",
             "//executorch/kernels/portable/cpu/util:broadcast_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_index_select",
         deps = [
+            "//executorch/kernels/portable/cpu/util:gather_util",
             "//executorch/kernels/portable/cpu/util:index_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -501,6 +529,7 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:activation_ops_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -514,6 +543,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -532,6 +562,7 @@ _ATEN_OPS = (
         name = "op_logit",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -557,6 +588,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -571,6 +603,7 @@ _ATEN_OPS = (
         name = "op_max_pool2d_with_indices",
         deps = [
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -580,6 +613,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -589,6 +623,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -604,6 +639,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:matmul_ops_util",
             ":vec_ops",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -618,6 +654,7 @@ _ATEN_OPS = (
         name = "op_native_batch_norm",
         deps = [
             "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -625,6 +662,8 @@ _ATEN_OPS = (
         deps = [
             ":vec_ops",
             "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -632,6 +671,7 @@ _ATEN_OPS = (
         deps = [
             ":vec_ops",
             "//executorch/kernels/portable/cpu/util:normalization_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -646,6 +686,7 @@ _ATEN_OPS = (
         name = "op_neg",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -660,24 +701,28 @@ _ATEN_OPS = (
         name = "op_ones",
         deps = [
             "//executorch/runtime/core/exec_aten/util:tensor_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_pdist_forward",
         deps = [
             "//executorch/kernels/portable/cpu/util:distance_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_permute_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_pixel_shuffle",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -694,6 +739,7 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -706,24 +752,28 @@ _ATEN_OPS = (
         name = "op_reflection_pad1d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_reflection_pad2d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_reflection_pad3d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_relu",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -745,18 +795,21 @@ _ATEN_OPS = (
         name = "op_replication_pad1d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_replication_pad2d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_replication_pad3d",
         deps = [
             "//executorch/kernels/portable/cpu/util:padding_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -766,6 +819,7 @@ _ATEN_OPS = (
         name = "op_round",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -793,6 +847,7 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -809,18 +864,21 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:index_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_sigmoid",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_sign",
         deps = [
             "//executorch/kernels/portable/cpu/util:functional_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -847,6 +905,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:index_util",
             "//executorch/kernels/portable/cpu/util:kernel_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -856,12 +915,14 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:activation_ops_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_split_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -869,6 +930,7 @@ _ATEN_OPS = (
         deps = [
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -887,6 +949,7 @@ _ATEN_OPS = (
         name = "op_stack",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -904,11 +967,15 @@ _ATEN_OPS = (
             "//executorch/runtime/core/exec_aten/util:scalar_type_util",
             "//executorch/runtime/core/exec_aten/util:tensor_util",
             "//executorch/kernels/portable/cpu/util:reduce_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_t_copy",
-        deps = ["//executorch/kernels/portable/cpu/util:transpose_util"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:transpose_util",
+            ":scalar_utils",
+        ],
     ),
     op_target(
         name = "op_tan",
@@ -922,20 +989,32 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/pattern:pattern",
         ],
     ),
+    op_target(
+        name = "op_topk",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:parallel_util",
+            "//executorch/kernels/portable/cpu/util:topk_util",
+        ],
+    ),
     op_target(
         name = "op_to_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
         name = "op_transpose_copy",
-        deps = ["//executorch/kernels/portable/cpu/util:transpose_util"],
+        deps = [
+            "//executorch/kernels/portable/cpu/util:transpose_util",
+            ":scalar_utils",
+        ],
     ),
     op_target(
         name = "op_tril",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -948,6 +1027,7 @@ _ATEN_OPS = (
         name = "op_unbind_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -977,6 +1057,7 @@ _ATEN_OPS = (
             "//executorch/kernels/portable/cpu/util:broadcast_util",
             "//executorch/kernels/portable/cpu/util:functional_util",
             "//executorch/runtime/core/exec_aten:lib",
+            ":scalar_utils",
         ],
     ),
     op_target(
@@ -986,6 +1067,7 @@ _ATEN_OPS = (
         name = "op__to_dim_order_copy",
         deps = [
             "//executorch/kernels/portable/cpu/util:copy_ops_util",
+            ":scalar_utils",
         ],
     ),
 )
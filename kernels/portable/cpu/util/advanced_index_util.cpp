@@ -260,6 +260,40 @@ size_t get_num_leading_null_indices(TensorOptList indices) {
   return start;
 }
 
+int64_t get_single_integral_index_dim(TensorOptList indices) {
+  int64_t dim = -1;
+  for (size_t i = 0; i < indices.size(); i++) {
+    if (!indices[i].has_value()) {
+      continue;
+    }
+    if (dim >= 0 || is_mask_index(indices[i].value())) {
+      return -1;
+    }
+    dim = i;
+  }
+  return dim;
+}
+
+bool check_integral_index_bounds(
+    const Tensor& in,
+    size_t dim,
+    const Tensor& index) {
+  const int64_t size = in.size(dim);
+  for (size_t i = 0; i < index.numel(); i++) {
+    const int64_t index_val = index.scalar_type() == ScalarType::Int
+        ? static_cast<int64_t>(index.const_data_ptr<int32_t>()[i])
+        : index.const_data_ptr<int64_t>()[i];
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        index_val >= -size && index_val < size,
+        "Index %" PRId64
+        " is out of bounds for input dimension %zu with size %" PRId64 ".",
+        index_val,
+        dim,
+        size);
+  }
+  return true;
+}
+
 bool get_index_out_target_size(
     const Tensor& in,
     TensorOptList indices,
@@ -72,6 +72,23 @@ size_t get_num_null_indices(TensorOptList indices);
  */
 size_t get_num_leading_null_indices(TensorOptList indices);
 
+/**
+ * Returns the position of the only non-null index if the list holds a single
+ * non-null index and it is a Long or Int index, i.e. the indexing is
+ * `in[:, ..., :, index]` and gathers whole rows along that dimension.
+ * Returns -1 otherwise.
+ */
+int64_t get_single_integral_index_dim(TensorOptList indices);
+
+/**
+ * Checks that the values of the Long or Int `index` into dimension `dim` of
+ * `in` are within [-in.size(dim), in.size(dim)).
+ */
+bool check_integral_index_bounds(
+    const Tensor& in,
+    size_t dim,
+    const Tensor& index);
+
 /**
  * Compute the expected size for the out tensor
  */
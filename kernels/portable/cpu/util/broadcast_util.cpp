@@ -318,5 +318,35 @@ size_t linearize_access_indexes(
       broadcast_from.strides());
 }
 
+void get_broadcast_strides(
+    const Tensor& broadcast_from,
+    const Tensor& broadcast_to,
+    size_t* out_strides,
+    const size_t out_strides_len) {
+  const ssize_t to_ndim = broadcast_to.dim();
+  const ssize_t num_skip_dims = to_ndim - broadcast_from.dim();
+  ET_CHECK(to_ndim <= out_strides_len);
+  ET_CHECK(num_skip_dims >= 0);
+
+  for (ssize_t i = 0; i < to_ndim; ++i) {
+    // Leading dimensions that broadcast_from lacks are broadcasted.
+    if (i < num_skip_dims) {
+      out_strides[i] = 0;
+      continue;
+    }
+    const ssize_t from_dim = i - num_skip_dims;
+    const auto from_size = broadcast_from.size(from_dim);
+    if (from_size == 1) {
+      out_strides[i] = 0;
+      continue;
+    }
+    ET_CHECK_MSG(
+        from_size == broadcast_to.size(i),
+        "Expected dim size == 1 if broadcasted, but actual dim size is %zu",
+        static_cast<size_t>(from_size));
+    out_strides[i] = broadcast_from.strides()[from_dim];
+  }
+}
+
 } // namespace executor
 } // namespace torch
@@ -266,6 +266,111 @@ size_t linearize_access_indexes(
     ssize_t broadcast_to_ndim,
     const Tensor& broadcast_from);
 
+/**
+ * Compute the strides, in elements, to step broadcast_from along each
+ * dimension of broadcast_to. The stride is zero along dimensions that
+ * broadcast_from is broadcasted over, including the leading dimensions it
+ * lacks, so that walking broadcast_to with these strides visits the matching
+ * element of broadcast_from without per-element index math.
+ *
+ * @param[in] broadcast_from The tensor to be broadcasted.
+ * @param[in] broadcast_to The tensor to which broadcast_from is broadcasted.
+ * @param[out] out_strides One stride per dimension of broadcast_to.
+ * @param[in] out_strides_len The capacity of out_strides.
+ */
+void get_broadcast_strides(
+    const Tensor& broadcast_from,
+    const Tensor& broadcast_to,
+    size_t* out_strides,
+    const size_t out_strides_len);
+
+namespace internal {
+
+/**
+ * Walks the contiguous `out` tensor row by row, calling
+ * `row_fn(out_index, row_size, in_offsets, in_strides)` for each row, where
+ * `in_offsets[k]` is the offset of the first element of the row in
+ * `inputs[k]`, and `in_strides[k]` is the step between its elements within
+ * the row. Dimensions that every input walks contiguously are merged, so the
+ * rows are as long as the broadcasting allows.
+ */
+template <size_t kNumInputs, typename RowFn>
+inline void apply_broadcast_rows(
+    const Tensor& out,
+    const Tensor* const (&inputs)[kNumInputs],
+    const RowFn& row_fn) {
+  const size_t numel = out.numel();
+  if (numel == 0) {
+    return;
+  }
+
+  size_t strides[kNumInputs][kTensorDimensionLimit];
+  for (size_t k = 0; k < kNumInputs; ++k) {
+    get_broadcast_strides(*inputs[k], out, strides[k], kTensorDimensionLimit);
+  }
+
+  // Merge dimensions from the innermost outward. Index 0 of the merged
+  // arrays is the innermost dimension.
+  size_t merged_sizes[kTensorDimensionLimit];
+  size_t merged_strides[kNumInputs][kTensorDimensionLimit];
+  size_t merged_ndim = 0;
+  for (ssize_t d = out.dim() - 1; d >= 0; --d) {
+    const size_t size = out.size(d);
+    if (size == 1) {
+      continue;
+    }
+    bool can_merge = merged_ndim > 0;
+    for (size_t k = 0; can_merge && k < kNumInputs; ++k) {
+      const size_t last = merged_ndim - 1;
+      can_merge =
+          strides[k][d] == merged_strides[k][last] * merged_sizes[last];
+    }
+    if (can_merge) {
+      merged_sizes[merged_ndim - 1] *= size;
+    } else {
+      merged_sizes[merged_ndim] = size;
+      for (size_t k = 0; k < kNumInputs; ++k) {
+        merged_strides[k][merged_ndim] = strides[k][d];
+      }
+      ++merged_ndim;
+    }
+  }
+  if (merged_ndim == 0) {
+    // All dimensions have size one.
+    merged_sizes[0] = 1;
+    for (size_t k = 0; k < kNumInputs; ++k) {
+      merged_strides[k][0] = 0;
+    }
+    merged_ndim = 1;
+  }
+
+  const size_t row_size = merged_sizes[0];
+  size_t row_strides[kNumInputs];
+  size_t offsets[kNumInputs] = {};
+  for (size_t k = 0; k < kNumInputs; ++k) {
+    row_strides[k] = merged_strides[k][0];
+  }
+  size_t counter[kTensorDimensionLimit] = {};
+  for (size_t out_index = 0; out_index < numel; out_index += row_size) {
+    row_fn(out_index, row_size, offsets, row_strides);
+    // Advance the outer dimensions like an odometer.
+    for (size_t d = 1; d < merged_ndim; ++d) {
+      for (size_t k = 0; k < kNumInputs; ++k) {
+        offsets[k] += merged_strides[k][d];
+      }
+      if (++counter[d] < merged_sizes[d]) {
+        break;
+      }
+      for (size_t k = 0; k < kNumInputs; ++k) {
+        offsets[k] -= merged_strides[k][d] * merged_sizes[d];
+      }
+      counter[d] = 0;
+    }
+  }
+}
+
+} // namespace internal
+
 //
 // Mapping with broadcasting
 //
@@ -273,7 +378,9 @@ size_t linearize_access_indexes(
 /**
  * Useful for binary elementwise operators. For each element of the inputs,
  * perform a computation and write to the corresponding element of the output.
- * Tensor broadcasting is applied wherever it is required.
+ * Tensor broadcasting is applied wherever it is required. `out` may share
+ * storage with an input of the same sizes and dtype, which the memory planner
+ * uses to run elementwise ops in place.
  */
 template <typename CTYPE_A, typename CTYPE_B, typename CTYPE_OUT, typename Op>
 inline void apply_binary_elementwise_fn(
@@ -289,24 +396,31 @@ inline void apply_binary_elementwise_fn(
   const CTYPE_B* const data_b = b.const_data_ptr<CTYPE_B>();
   CTYPE_OUT* const data_out = out.mutable_data_ptr<CTYPE_OUT>();
 
-  for (size_t i = 0; i < out.numel(); ++i) {
-    size_t a_linear_index = i;
-    size_t b_linear_index = i;
-
-    if (any_is_broadcasted) {
-      size_t out_indexes[kTensorDimensionLimit];
-      delinearize_index(i, out, out_indexes, kTensorDimensionLimit);
-
-      if (a_is_broadcasted) {
-        a_linear_index = linearize_access_indexes(out_indexes, out.dim(), a);
-      }
-      if (b_is_broadcasted) {
-        b_linear_index = linearize_access_indexes(out_indexes, out.dim(), b);
-      }
+  if (!any_is_broadcasted) {
+    // Keep the common case a plain loop that the compiler can vectorize.
+    const size_t numel = out.numel();
+    for (size_t i = 0; i < numel; ++i) {
+      data_out[i] = compute_fun(data_a[i], data_b[i]);
     }
-
-    data_out[i] = compute_fun(data_a[a_linear_index], data_b[b_linear_index]);
+    return;
   }
+
+  const Tensor* const inputs[] = {&a, &b};
+  internal::apply_broadcast_rows(
+      out,
+      inputs,
+      [&](size_t out_index,
+          size_t row_size,
+          const size_t* offsets,
+          const size_t* strides) {
+        const CTYPE_A* const row_a = data_a + offsets[0];
+        const CTYPE_B* const row_b = data_b + offsets[1];
+        CTYPE_OUT* const row_out = data_out + out_index;
+        for (size_t i = 0; i < row_size; ++i) {
+          row_out[i] =
+              compute_fun(row_a[i * strides[0]], row_b[i * strides[1]]);
+        }
+      });
 }
 
 /**
@@ -337,29 +451,33 @@ inline void apply_ternary_elementwise_fn(
   const CTYPE_C* const data_c = c.const_data_ptr<CTYPE_C>();
   CTYPE_OUT* const data_out = out.mutable_data_ptr<CTYPE_OUT>();
 
-  for (size_t i = 0; i < out.numel(); ++i) {
-    size_t a_linear_index = i;
-    size_t b_linear_index = i;
-    size_t c_linear_index = i;
-
-    if (any_is_broadcasted) {
-      size_t out_indexes[kTensorDimensionLimit];
-      delinearize_index(i, out, out_indexes, kTensorDimensionLimit);
-
-      if (a_is_broadcasted) {
-        a_linear_index = linearize_access_indexes(out_indexes, out.dim(), a);
-      }
-      if (b_is_broadcasted) {
-        b_linear_index = linearize_access_indexes(out_indexes, out.dim(), b);
-      }
-      if (c_is_broadcasted) {
-        c_linear_index = linearize_access_indexes(out_indexes, out.dim(), c);
-      }
+  if (!any_is_broadcasted) {
+    const size_t numel = out.numel();
+    for (size_t i = 0; i < numel; ++i) {
+      data_out[i] = compute_fun(data_a[i], data_b[i], data_c[i]);
     }
-
-    data_out[i] = compute_fun(
-        data_a[a_linear_index], data_b[b_linear_index], data_c[c_linear_index]);
+    return;
   }
+
+  const Tensor* const inputs[] = {&a, &b, &c};
+  internal::apply_broadcast_rows(
+      out,
+      inputs,
+      [&](size_t out_index,
+          size_t row_size,
+          const size_t* offsets,
+          const size_t* strides) {
+        const CTYPE_A* const row_a = data_a + offsets[0];
+        const CTYPE_B* const row_b = data_b + offsets[1];
+        const CTYPE_C* const row_c = data_c + offsets[2];
+        CTYPE_OUT* const row_out = data_out + out_index;
+        for (size_t i = 0; i < row_size; ++i) {
+          row_out[i] = compute_fun(
+              row_a[i * strides[0]],
+              row_b[i * strides[1]],
+              row_c[i * strides[2]]);
+        }
+      });
 }
 
 } // namespace executor
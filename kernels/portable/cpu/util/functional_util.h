@@ -43,6 +43,8 @@ inline CTYPE apply_unary_reduce_fn(
 /**
  * Applies `map_fun` to `size` elements of `data_in`, writing results to
  * `data_out`. The `stride` can also be defined; by default it is set to 1.
+ * `data_out` may be `data_in`, since every element is read before its result
+ * is written.
  */
 template <typename CTYPE_IN, typename CTYPE_OUT, typename MapOp>
 inline void apply_unary_map_fn(
@@ -51,6 +53,13 @@ inline void apply_unary_map_fn(
     CTYPE_OUT* const data_out,
     const int64_t size,
     const int64_t stride = 1) {
+  if (stride == 1) {
+    // Keep the contiguous case a plain loop that the compiler can vectorize.
+    for (size_t i = 0; i < size; i++) {
+      data_out[i] = map_fun(data_in[i]);
+    }
+    return;
+  }
   for (size_t i = 0; i < size; i++) {
     data_out[i * stride] = map_fun(data_in[i * stride]);
   }
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
+
+namespace torch {
+namespace executor {
+
+/**
+ * How many rows ahead gather_rows() prefetches. Lookups into large tables
+ * rarely hit neighbouring rows, so the hardware prefetcher cannot anticipate
+ * them; a few rows of lead hide most of the latency of the next miss.
+ */
+constexpr size_t kGatherPrefetchDistance = 4;
+
+/**
+ * Copies the rows of `src` selected by `indices` to `dst`.
+ *
+ * `src` holds `num_outer` slices of `src_rows` rows of `row_bytes` bytes, and
+ * `dst` receives `num_outer` slices of `num_indices` rows: row j of slice i of
+ * `dst` is row `indices[j]` of slice i of `src`. Negative indices count from
+ * the end of the slice. The indices must have been validated to lie within
+ * [-src_rows, src_rows), since this may run on several threads and cannot
+ * report errors.
+ *
+ * Each row is a single memcpy, the rows a few indices ahead are prefetched,
+ * and the rows are split across the threadpool when there are enough bytes to
+ * copy.
+ */
+template <typename INDEX_T>
+void gather_rows(
+    const char* const src,
+    char* const dst,
+    const INDEX_T* const indices,
+    const size_t num_indices,
+    const size_t num_outer,
+    const size_t src_rows,
+    const size_t row_bytes) {
+  if (num_indices == 0 || num_outer == 0 || row_bytes == 0) {
+    return;
+  }
+  const auto row_of = [&](const size_t outer, const size_t j) {
+    const int64_t index = static_cast<int64_t>(indices[j]);
+    const size_t row = index < 0 ? index + src_rows : index;
+    return src + (outer * src_rows + row) * row_bytes;
+  };
+  parallel_for_each_chunk(
+      0,
+      num_outer * num_indices,
+      row_bytes,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t k = begin; k < end; ++k) {
+          const size_t outer = k / num_indices;
+          const size_t j = k % num_indices;
+#if defined(__GNUC__) || defined(__clang__)
+          if (j + kGatherPrefetchDistance < num_indices) {
+            __builtin_prefetch(row_of(outer, j + kGatherPrefetchDistance));
+          }
+#endif
+          std::memcpy(dst + k * row_bytes, row_of(outer, j), row_bytes);
+        }
+      });
+}
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <executorch/runtime/platform/assert.h>
+
+#ifdef ET_USE_THREADPOOL
+#include <executorch/extension/parallel/thread_parallel.h>
+#endif
+
+namespace torch {
+namespace executor {
+
+/**
+ * The number of elementary operations a task should perform to amortize the
+ * cost of handing it to another thread.
+ */
+constexpr int64_t kParallelMinWorkPerTask = 32768;
+
+/**
+ * Whether parallel_for_each_chunk can split work across threads. Algorithms
+ * that do extra work to expose parallelism, e.g. a two-pass scan, only pay
+ * for it when this is true.
+ */
+#ifdef ET_USE_THREADPOOL
+constexpr bool kParallelForEachChunkIsThreaded = true;
+#else
+constexpr bool kParallelForEachChunkIsThreaded = false;
+#endif
+
+/**
+ * Returns the smallest number of work items, each costing about
+ * `work_per_item` elementary operations, that are worth a task of their own.
+ */
+inline int64_t parallel_grain_size(const int64_t work_per_item) {
+  return std::max<int64_t>(
+      1, kParallelMinWorkPerTask / std::max<int64_t>(1, work_per_item));
+}
+
+/**
+ * Calls `fn(begin, end)` on disjoint chunks that together cover the work
+ * items [begin, end), splitting the range across the threadpool when the
+ * kernels are built with ET_USE_THREADPOOL and the work is large enough to
+ * benefit. Otherwise calls `fn(begin, end)` once on the calling thread.
+ *
+ * `fn` may run concurrently on several threads, so it must only write to
+ * state that belongs to its own chunk, and must not report kernel failures
+ * through the RuntimeContext.
+ *
+ * @param[in] work_per_item The approximate number of elementary operations
+ *     each work item performs, used to pick the grain size.
+ */
+template <typename Fn>
+inline void parallel_for_each_chunk(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t work_per_item,
+    const Fn& fn) {
+  if (begin >= end) {
+    return;
+  }
+#ifdef ET_USE_THREADPOOL
+  const int64_t grain_size = parallel_grain_size(work_per_item);
+  if (end - begin > grain_size) {
+    ET_CHECK(parallel_for(begin, end, grain_size, fn));
+    return;
+  }
+#else
+  (void)work_per_item;
+#endif
+  fn(begin, end);
+}
+
+/**
+ * Like parallel_for_each_chunk, but for work items whose cost varies. The
+ * range is cut into many small chunks that threads claim as they become free,
+ * instead of one equal share per thread, so that a stretch of expensive items
+ * does not leave the other threads idle.
+ *
+ * @param[in] work_per_item The average number of elementary operations per
+ *     work item, used to pick the chunk size.
+ */
+template <typename Fn>
+inline void parallel_for_each_chunk_dynamic(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t work_per_item,
+    const Fn& fn) {
+  if (begin >= end) {
+    return;
+  }
+#ifdef ET_USE_THREADPOOL
+  const int64_t grain_size = parallel_grain_size(work_per_item);
+  if (end - begin > grain_size) {
+    ET_CHECK(parallel_for_dynamic(begin, end, grain_size, fn));
+    return;
+  }
+#else
+  (void)work_per_item;
+#endif
+  fn(begin, end);
+}
+
+} // namespace executor
+} // namespace torch
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #include <cstring>
@@ -344,6 +345,89 @@ void apply_over_dim_list(
       fn, in, is_in_dim_list, base, ustart, uend);
 }
 
+/**
+ * Like the three-argument `apply_over_dim()`, but splits the reductions
+ * across the threadpool when the kernels are built with ET_USE_THREADPOOL.
+ * Each reduction must only write to the output elements of its own slice.
+ */
+template <typename Fn>
+void parallel_apply_over_dim(
+    const Fn& fn,
+    const exec_aten::Tensor& in,
+    const exec_aten::optional<int64_t>& dim) {
+  if (!dim.has_value() || in.dim() == 0 || in.numel() == 0) {
+    apply_over_dim(fn, in, dim);
+    return;
+  }
+  ET_CHECK_VALID_DIM(dim.value(), in.dim());
+
+  const size_t d = ET_NORMALIZE_IX(dim.value(), in.dim());
+  const size_t size = in.size(d);
+  const size_t stride = in.strides()[d];
+  const size_t outer_stride = size * stride;
+  const int64_t num_reductions = getLeadingDims(in, d) * stride;
+  // Split over the flattened outer and inner indexes, so that reducing the
+  // innermost dimension of a tall tensor still gets one reduction per row.
+  parallel_for_each_chunk(
+      0, num_reductions, size, [&](const int64_t begin, const int64_t end) {
+        for (int64_t ix = begin; ix < end; ++ix) {
+          const size_t outer_idx = ix / stride;
+          const size_t inner_idx = ix % stride;
+          fn(size, stride, outer_idx * outer_stride + inner_idx);
+        }
+      });
+}
+
+/**
+ * Calls `fn(out_ix)` for every element `out_ix` of the output of reducing
+ * `in` over `dim`, splitting the output elements across the threadpool when
+ * the kernels are built with ET_USE_THREADPOOL. `fn` must only write to the
+ * output element `out_ix`.
+ */
+template <typename Fn>
+void parallel_for_each_reduce_over_dim_output_index(
+    const exec_aten::Tensor& in,
+    const exec_aten::optional<int64_t>& dim,
+    const exec_aten::Tensor& out,
+    const Fn& fn) {
+  const int64_t reduction_size =
+      in.numel() == 0 ? 1 : get_reduced_dim_product(in, dim);
+  parallel_for_each_chunk(
+      0,
+      out.numel(),
+      reduction_size,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t out_ix = begin; out_ix < end; ++out_ix) {
+          fn(out_ix);
+        }
+      });
+}
+
+/**
+ * Calls `fn(out_ix)` for every element `out_ix` of the output of reducing
+ * `in` over `dim_list`, splitting the output elements across the threadpool
+ * when the kernels are built with ET_USE_THREADPOOL. `fn` must only write to
+ * the output element `out_ix`.
+ */
+template <typename Fn>
+void parallel_for_each_reduce_over_dim_list_output_index(
+    const exec_aten::Tensor& in,
+    const exec_aten::optional<exec_aten::ArrayRef<int64_t>>& dim_list,
+    const exec_aten::Tensor& out,
+    const Fn& fn) {
+  const int64_t reduction_size =
+      in.numel() == 0 ? 1 : get_reduced_dim_product(in, dim_list);
+  parallel_for_each_chunk(
+      0,
+      out.numel(),
+      reduction_size,
+      [&](const int64_t begin, const int64_t end) {
+        for (int64_t out_ix = begin; out_ix < end; ++out_ix) {
+          fn(out_ix);
+        }
+      });
+}
+
 //
 // Reduce Functions
 //
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <cstring>
 
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
@@ -77,87 +78,50 @@ bool check_repeat_args(
   return true;
 }
 
-// Given the indices to a point in an n-D tensor, and the stride (in bytes)
-// along each dimension, return the offset from origin to that point.
-size_t compute_access_offset(
-    const size_t* indices,
-    const size_t* strides,
-    size_t num_entries) {
-  size_t offset = 0;
-  for (int i = num_entries - 1; i >= 0; --i) {
-    // @lint-ignore CLANGTIDY indices and strides share same length.
-    offset += indices[i] * strides[i];
-  }
-  return offset;
-}
-
-// Copy an self array to multiple coordinates of the out tensor.
-//'in_offset' identifies the offset to the source data in self tensor.
-//'out_offset' identifies the offset in out tensor where the source data
-// should be copied.
-//'strides' indicates the stride along each dimension of the out tensor.
-void repeat_internal(
-    const Tensor& self,
-    Tensor& out,
-    size_t in_offset,
-    size_t out_offset,
-    const size_t* strides) {
-  const char* src = self.const_data_ptr<char>() + in_offset;
-  char* dest = out.mutable_data_ptr<char>() + out_offset;
-
-  // Treats zero-dim self as one-dim tensor with size {1}.
-  ssize_t self_dim = self.dim() ? self.dim() : 1;
-  int32_t one = 1;
-  exec_aten::ArrayRef<int32_t> self_size =
-      self.dim() ? self.sizes() : exec_aten::ArrayRef<int32_t>(&one, 1);
-
-  // Get the size of the array in bytes.
-  size_t num_bytes = self_size[self_dim - 1] * out.element_size();
-  if (num_bytes == 0) {
+// Copies the self block at dimension `dim` into the out block at the same
+// dimension, replicating it along `dim` and every dimension after it. The
+// sizes and strides are padded to the rank of out; strides are in bytes.
+void repeat_block(
+    const char* src,
+    char* dest,
+    size_t dim,
+    size_t ndim,
+    const size_t* self_sizes,
+    const size_t* self_strides,
+    const size_t* out_strides,
+    const int64_t* repeats,
+    size_t contiguous_dim) {
+  // From `contiguous_dim` on, nothing is repeated: the self block is laid out
+  // in out exactly as in self.
+  if (dim == contiguous_dim) {
+    memcpy(dest, src, self_sizes[dim] * self_strides[dim]);
     return;
   }
-
-  // Visualize the out tensor as a set of 1D arrays. Given an n-dimensional
-  // out X[d0, d1, ..., d{N-2}, d{N-1}], we can view the out as a tensor
-  // X'[d0, d1, ..., d{N-2}, 1], where each point is a array of length
-  // size(d{N-1}). Below is the strategy to iterate over the relevant points in
-  // X'. We create an n-D slot array, where each index corresponds to a
-  // dimension of X'. A valid value of slot array is one which corresponds to
-  // a data point in X'.
-  size_t slots[kTensorDimensionLimit];
-  memset(slots, 0, self_dim * sizeof(slots[0]));
-
-  // The increment along index of slot array to reach the next possible valid
-  // value.
-  int64_t incr[kTensorDimensionLimit];
-  for (size_t i = 0; i < self_dim; i++) {
-    incr[i] = self_size[i];
-  }
-
-  // And now copy the self data to possibly multiple points in the out
-  // tensor. Note that if the self is n-dimensional tensor, we limit copying
-  // to only n dimensions in out tensor (out can be higher-dimensional
-  // than self).
-  size_t index = self_dim - 1;
-  size_t start = out.dim() - self_dim;
-  while (slots[0] != out.size(start)) {
-    // Compute the offset (from origin) in the out tensor where this self
-    // data will be copied to.
-    size_t offset = compute_access_offset(slots, strides, self_dim);
-    memcpy(dest + offset, src, num_bytes);
-
-    // Find the next valid value of slot array.
-    slots[index] += incr[index];
-    // If we have reached the limit in the innermost dimension, successively
-    // increment the slot index of outer dimensions.
-    while (slots[index] == out.size(start + index)) {
-      if (index == 0) {
-        break;
-      }
-      slots[index--] = 0;
-      slots[index] += incr[index];
+  if (dim + 1 < ndim) {
+    for (size_t i = 0; i < self_sizes[dim]; ++i) {
+      repeat_block(
+          src + i * self_strides[dim],
+          dest + i * out_strides[dim],
+          dim + 1,
+          ndim,
+          self_sizes,
+          self_strides,
+          out_strides,
+          repeats,
+          contiguous_dim);
     }
-    index = self_dim - 1;
+  } else {
+    memcpy(dest, src, self_sizes[dim] * self_strides[dim]);
+  }
+  // The first copy along `dim` is now complete and contiguous; replicate it
+  // as a whole, doubling the copied range each time.
+  const size_t block = self_sizes[dim] * out_strides[dim];
+  const size_t total = block * repeats[dim];
+  size_t copied = block;
+  while (copied < total) {
+    const size_t n = std::min(copied, total - copied);
+    memcpy(dest + copied, dest, n);
+    copied += n;
   }
 }
 
@@ -180,7 +144,7 @@ Error repeat_tensor(
     return Error::Ok;
   }
 
-  ssize_t element_size = out.element_size();
+  const size_t element_size = out.element_size();
 
   // The underlying data of tensor out shall equal tensor self.
   // Treats it specially to circumvent zero-dim tensor issue.
@@ -191,93 +155,40 @@ Error repeat_tensor(
     return Error::Ok;
   }
 
-  // Treats zero-dim self as one-dim tensor with size {1}.
-  ssize_t self_dim = self.dim() ? self.dim() : 1;
-  int32_t one = 1;
-  exec_aten::ArrayRef<int32_t> self_size = self.sizes().empty()
-      ? exec_aten::ArrayRef<int32_t>(&one, 1)
-      : self.sizes();
-
-  // Compute the stride (in bytes) along each out tensor dimension.
-  size_t strides[kTensorDimensionLimit];
-  memset(strides, 0, sizeof(strides[0]) * self_dim);
-  size_t start = out.dim() - self_dim;
-  size_t accum_offset = element_size;
-
-  for (ssize_t i = self_dim - 1; i >= 0; i--) {
-    strides[i] = accum_offset;
-    accum_offset *= out.size(start + i);
+  // Pad the sizes of self with leading ones to the rank of out, and compute
+  // the byte strides of both.
+  const size_t ndim = out.dim();
+  const size_t start = ndim - self.dim();
+  size_t self_sizes[kTensorDimensionLimit];
+  size_t self_strides[kTensorDimensionLimit];
+  size_t out_strides[kTensorDimensionLimit];
+  size_t self_stride = element_size;
+  size_t out_stride = element_size;
+  for (size_t i = ndim; i-- > 0;) {
+    self_sizes[i] = i >= start ? self.size(i - start) : 1;
+    self_strides[i] = self_stride;
+    out_strides[i] = out_stride;
+    self_stride *= self_sizes[i];
+    out_stride *= out.size(i);
   }
 
-  // Given an n-dimensional self X[d0, d1, ..., d{N-2}, d{N-1}], we can view
-  // the self as a tensor X'[d0, d1, ..., d{N-2}, 1], where each point is a
-  // 1D array of length size(d{N-1}). Now we need a strategy to iterate over
-  // all the points in X'. We do not want to use getLeadingDims(), as we want
-  // to know the indices explicitly so that we can compute the appropriate
-  // offset for both self and out tensor at that index. To achieve this,
-  // we create an n-D slot array, where each index corresponds to a dimension
-  // of X'. A valid value of slot array is the one that corresponds to a
-  // valid index in X'.
-  size_t slots[kTensorDimensionLimit];
-  memset(slots, 0, self_dim * sizeof(slots[0]));
-
-  // 'limits' indicates the upper bound on each index in slot. Note that we
-  // copy the entire array along the innermost dimension as a direct memcpy,
-  // so we reset the upper bound of innermost dim to 1. 'in_incr' indicates
-  // the size (in bytes) of the self data.
-  int64_t limits[kTensorDimensionLimit];
-  for (size_t i = 0; i < self_dim; i++) {
-    limits[i] = self_size[i];
+  // The largest trailing block that is not repeated is copied with a single
+  // memcpy.
+  size_t contiguous_dim = ndim;
+  while (contiguous_dim > 0 && repeats[contiguous_dim - 1] == 1) {
+    --contiguous_dim;
   }
 
-  // @lint-ignore CLANGTIDY Here limits is guaranteend a non-empty array.
-  size_t in_incr = limits[self_dim - 1] * element_size;
-  limits[self_dim - 1] = 1;
-  // 'in_offset' indicates the offset (in bytes) from the origin to an self
-  // data.
-  size_t in_offset = 0;
-  size_t index = self_dim - 1;
-
-  // Below, we copy the entire self tensor into the out tensor (at origin),
-  // one array a time. To do so, we iterate over all the valid values of slots
-  // array. The repeat_internal() takes care of replicating the array along the
-  // coordinates specified by repeats array.
-  while (slots[0] != limits[0]) {
-    // Compute the offset (from origin) in the out tensor where the self
-    // array (with indices in self tensor indicated by slots) will be copied.
-    size_t out_offset = compute_access_offset(slots, strides, self_dim);
-    // Now repeatedly copy the array to multiple coordinates in the out
-    // tensor. Curtail the copy along as many dimensions as the self tensor.
-    // The copy along remaining higher dimensions can be done via trivial
-    // memcpy.
-    repeat_internal(self, out, in_offset, out_offset, strides);
-
-    // Find the next valid value of slot array
-    slots[index]++;
-    // If we have reached the limit in the innermost dimension, successively
-    // increment the slot index of outer dimensions.
-    while (slots[index] == limits[index]) {
-      if (index == 0) {
-        break;
-      }
-      slots[index--] = 0;
-      slots[index]++;
-    }
-    index = self_dim - 1;
-    in_offset += in_incr;
-  }
-
-  // And now if an n-D self was meant to be replicated to m dimensions where
-  // m>n, we can just do simple memcpy for (m-n) dimensions.
-  const char* src = out.const_data_ptr<char>();
-  char* dest = out.mutable_data_ptr<char>() + accum_offset;
-  for (int i = start - 1; i >= 0; --i) {
-    for (int j = 0; j < repeats[i] - 1; ++j) {
-      memcpy(dest, src, accum_offset);
-      dest += accum_offset;
-    }
-    accum_offset *= out.size(i);
-  }
+  repeat_block(
+      self.const_data_ptr<char>(),
+      out.mutable_data_ptr<char>(),
+      0,
+      ndim,
+      self_sizes,
+      self_strides,
+      out_strides,
+      repeats.data(),
+      contiguous_dim);
 
   return Error::Ok;
 }
@@ -91,6 +91,19 @@ def define_common_targets():
         visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/..."],
     )
 
+    runtime.cxx_library(
+        name = "topk_util",
+        srcs = ["topk_util.cpp"],
+        exported_headers = [
+            "topk_util.h",
+        ],
+        compiler_flags = ["-Wno-missing-prototypes"],
+        deps = [
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/..."],
+    )
+
     runtime.cxx_library(
         name = "kernel_ops_util",
         srcs = ["kernel_ops_util.cpp"],
@@ -159,6 +172,16 @@ def define_common_targets():
     )
 
     # Utility functions that can be used by operators that perform indexing
+    runtime.cxx_library(
+        name = "gather_util",
+        srcs = [],
+        exported_headers = ["gather_util.h"],
+        exported_deps = [
+            ":parallel_util",
+        ],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/cpu/..."],
+    )
+
     runtime.cxx_library(
         name = "index_util",
         srcs = ["index_util.cpp"],
@@ -191,6 +214,20 @@ def define_common_targets():
         visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/quantized/..."],
     )
 
+    # Splits loops across the threadpool when the kernels are built with
+    # -DET_USE_THREADPOOL, which also requires linking
+    # //executorch/extension/parallel:thread_parallel. Serial otherwise, so that
+    # the portable kernels keep no dependencies outside of the runtime.
+    runtime.cxx_library(
+        name = "parallel_util",
+        srcs = [],
+        exported_headers = ["parallel_util.h"],
+        exported_deps = [
+            "//executorch/runtime/platform:platform",
+        ],
+        visibility = ["//executorch/kernels/portable/cpu/...", "//executorch/kernels/optimized/...", "//executorch/kernels/quantized/...", "//executorch/extension/training/...", "//executorch/examples/models/llama2/custom_ops/..."],
+    )
+
     runtime.cxx_library(
         name = "select_copy_util",
         srcs = ["select_copy_util.cpp"],
@@ -210,6 +247,9 @@ def define_common_targets():
             name = "reduce_util{}".format(suffix),
             srcs = ["reduce_util.cpp"],
             exported_headers = ["reduce_util.h"],
+            exported_deps = [
+                ":parallel_util",
+            ],
             deps = [
                 "//executorch/runtime/kernel:kernel_includes{}".format(suffix),
                 "//executorch/runtime/core/exec_aten/util:tensor_util{}".format(suffix),
@@ -20,7 +20,10 @@
 using namespace ::testing;
 using exec_aten::ScalarType;
 using exec_aten::Tensor;
+using torch::executor::apply_binary_elementwise_fn;
+using torch::executor::apply_ternary_elementwise_fn;
 using torch::executor::ArrayRef;
+using torch::executor::kTensorDimensionLimit;
 using torch::executor::testing::TensorFactory;
 
 TEST(BroadcastUtilTest, BroadcastTensor) {
@@ -183,3 +186,69 @@ TEST(BroadcastUtilTest, LinearizeIndex) {
     EXPECT_EQ(linear_index, 2);
   }
 }
+
+TEST(BroadcastUtilTest, GetBroadcastStrides) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor broadcast_from = tf.zeros({2, 1, 4});
+  Tensor broadcast_to = tf.zeros({3, 2, 5, 4});
+
+  size_t strides[4];
+  get_broadcast_strides(broadcast_from, broadcast_to, strides, 4);
+  EXPECT_EQ(strides[0], 0);
+  EXPECT_EQ(strides[1], 4);
+  EXPECT_EQ(strides[2], 0);
+  EXPECT_EQ(strides[3], 1);
+}
+
+TEST(BroadcastUtilTest, ApplyBinaryElementwiseFnMatchesLinearize) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.make({2, 1, 3}, {1, 2, 3, 4, 5, 6});
+  Tensor b = tf.make({4, 1}, {10, 20, 30, 40});
+  Tensor out = tf.zeros({2, 4, 3});
+
+  apply_binary_elementwise_fn<int32_t, int32_t, int32_t>(
+      [](int32_t x, int32_t y) { return x * 100 + y; }, a, b, out);
+
+  const int32_t* const data_a = a.const_data_ptr<int32_t>();
+  const int32_t* const data_b = b.const_data_ptr<int32_t>();
+  const int32_t* const data_out = out.const_data_ptr<int32_t>();
+  for (size_t i = 0; i < out.numel(); ++i) {
+    size_t indexes[kTensorDimensionLimit];
+    delinearize_index(i, out, indexes, kTensorDimensionLimit);
+    ArrayRef<size_t> out_indexes(indexes, out.dim());
+    const size_t a_index = linearize_access_indexes(out_indexes, out.dim(), a);
+    const size_t b_index = linearize_access_indexes(out_indexes, out.dim(), b);
+    EXPECT_EQ(data_out[i], data_a[a_index] * 100 + data_b[b_index]);
+  }
+}
+
+TEST(BroadcastUtilTest, ApplyTernaryElementwiseFnBroadcastsRows) {
+  TensorFactory<ScalarType::Int> tf;
+
+  // The trailing dimensions of `a` and `out` merge into one row per channel.
+  Tensor a = tf.make({2, 2, 2}, {1, 2, 3, 4, 5, 6, 7, 8});
+  Tensor b = tf.make({2, 1, 1}, {10, 20});
+  Tensor c = tf.make({1}, {100});
+  Tensor out = tf.zeros({2, 2, 2});
+
+  apply_ternary_elementwise_fn<int32_t, int32_t, int32_t, int32_t>(
+      [](int32_t x, int32_t y, int32_t z) { return x + y + z; }, a, b, c, out);
+
+  EXPECT_TENSOR_EQ(
+      out, tf.make({2, 2, 2}, {111, 112, 113, 114, 125, 126, 127, 128}));
+}
+
+TEST(BroadcastUtilTest, ApplyBinaryElementwiseFnScalarOutput) {
+  TensorFactory<ScalarType::Int> tf;
+
+  Tensor a = tf.make({}, {3});
+  Tensor b = tf.make({1}, {4});
+  Tensor out = tf.zeros({1});
+
+  apply_binary_elementwise_fn<int32_t, int32_t, int32_t>(
+      [](int32_t x, int32_t y) { return x * y; }, a, b, out);
+
+  EXPECT_TENSOR_EQ(out, tf.make({1}, {12}));
+}
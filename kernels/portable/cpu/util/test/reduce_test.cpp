@@ -578,3 +578,51 @@ TEST(ReduceUtilTest, ApplyOverDimListInvalid) {
   ET_EXPECT_DEATH(
       apply_over_dim_list([](size_t in_ix) { return; }, in, dim_list, 0), "");
 }
+
+TEST(ReduceUtilTest, ParallelApplyOverDimMatchesApplyOverDim) {
+  TensorFactory<ScalarType::Long> tf;
+
+  Tensor in = tf.zeros({2, 4, 5, 3});
+  for (int64_t dim = -4; dim < 4; ++dim) {
+    std::vector<size_t> expected;
+    apply_over_dim(
+        [&expected](size_t size, size_t stride, size_t base) {
+          expected.push_back(base);
+          expected.push_back(size);
+          expected.push_back(stride);
+        },
+        in,
+        dim);
+
+    std::vector<size_t> actual;
+    parallel_apply_over_dim(
+        [&actual](size_t size, size_t stride, size_t base) {
+          actual.push_back(base);
+          actual.push_back(size);
+          actual.push_back(stride);
+        },
+        in,
+        dim);
+
+    EXPECT_EQ(actual, expected);
+  }
+}
+
+TEST(ReduceUtilTest, ParallelForEachReduceOverDimListOutputIndex) {
+  TensorFactory<ScalarType::Long> tf;
+
+  Tensor in = tf.zeros({2, 4, 5, 3});
+  Tensor out = tf.zeros({2, 1, 1, 3});
+  int64_t dim_array[2] = {1, 2};
+  optional<ArrayRef<int64_t>> dim_list =
+      optional<ArrayRef<int64_t>>(ArrayRef<int64_t>{dim_array, 2});
+
+  int64_t* const out_data = out.mutable_data_ptr<int64_t>();
+  parallel_for_each_reduce_over_dim_list_output_index(
+      in, dim_list, out, [&](const size_t out_ix) {
+        out_data[out_ix] += out_ix + 1;
+      });
+
+  // Every output index is visited exactly once.
+  EXPECT_TENSOR_EQ(out, tf.make({2, 1, 1, 3}, {1, 2, 3, 4, 5, 6}));
+}
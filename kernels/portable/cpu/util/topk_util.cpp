@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/cpu/util/topk_util.h>
+
+namespace torch {
+namespace executor {
+
+bool check_topk_args(
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    const Tensor& values,
+    const Tensor& indices) {
+  ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_dtype(in, values));
+  ET_LOG_AND_RETURN_IF_FALSE(indices.scalar_type() == ScalarType::Long);
+  for (const Tensor* t : {&in, &values, &indices}) {
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        is_contiguous_dim_order(t->dim_order().data(), t->dim_order().size()),
+        "topk only supports the default dim order");
+  }
+  ET_LOG_AND_RETURN_IF_FALSE(tensor_has_dim(in, dim));
+  const int64_t dim_size =
+      in.dim() == 0 ? 1 : in.size(dim < 0 ? dim + in.dim() : dim);
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      k >= 0 && k <= dim_size,
+      "selected index k = %" PRId64 " out of range for dim of size %" PRId64,
+      k,
+      dim_size);
+  return true;
+}
+
+void get_topk_out_target_size(
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    Tensor::SizesType* out_sizes,
+    size_t* out_ndim) {
+  *out_ndim = in.dim();
+  for (size_t i = 0; i < in.dim(); ++i) {
+    out_sizes[i] = in.size(i);
+  }
+  if (in.dim() > 0) {
+    out_sizes[dim < 0 ? dim + in.dim() : dim] = k;
+  }
+}
+
+} // namespace executor
+} // namespace torch
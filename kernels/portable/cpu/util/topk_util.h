@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cmath>
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+
+bool check_topk_args(
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    const Tensor& values,
+    const Tensor& indices);
+
+void get_topk_out_target_size(
+    const Tensor& in,
+    int64_t k,
+    int64_t dim,
+    Tensor::SizesType* out_sizes,
+    size_t* out_ndim);
+
+namespace internal {
+
+/**
+ * Whether element `a` at position `a_ix` comes before element `b` at position
+ * `b_ix` in the output of topk. NaN counts as larger than any other value, as
+ * in ATen, and ties go to the earlier position.
+ */
+template <bool kLargest, typename CTYPE>
+inline bool topk_ranks_before(
+    const CTYPE a,
+    const long a_ix,
+    const CTYPE b,
+    const long b_ix) {
+  const bool a_is_nan = std::isnan(a);
+  const bool b_is_nan = std::isnan(b);
+  if (a_is_nan != b_is_nan) {
+    return kLargest ? a_is_nan : b_is_nan;
+  }
+  if (!a_is_nan && a != b) {
+    return kLargest ? a > b : a < b;
+  }
+  return a_ix < b_ix;
+}
+
+/**
+ * Keeps the k best elements offered so far in a heap stored directly in the
+ * output slices `values` and `indices`, whose consecutive elements are
+ * `stride` apart. The root holds the worst kept element, so each offered
+ * element costs one comparison when it is not kept and O(log k) otherwise.
+ */
+template <bool kLargest, typename CTYPE>
+class TopKSelector {
+ public:
+  TopKSelector(
+      CTYPE* const values,
+      long* const indices,
+      const int64_t k,
+      const int64_t stride)
+      : values_(values), indices_(indices), k_(k), stride_(stride) {}
+
+  bool full() const {
+    return size_ == k_;
+  }
+
+  /// The worst kept element. Only valid once full().
+  CTYPE worst() const {
+    return values_[0];
+  }
+
+  /**
+   * Offers element `v` at position `ix`. Positions must be offered in
+   * increasing order.
+   */
+  void push(const CTYPE v, const long ix) {
+    if (size_ < k_) {
+      int64_t pos = size_++;
+      while (pos > 0) {
+        const int64_t parent = (pos - 1) / 2;
+        if (!ranks_before(parent, v, ix)) {
+          break;
+        }
+        move(parent, pos);
+        pos = parent;
+      }
+      set(pos, v, ix);
+    } else if (
+        k_ > 0 &&
+        topk_ranks_before<kLargest>(v, ix, values_[0], indices_[0])) {
+      sift_down(0, v, ix, size_);
+    }
+  }
+
+  /// Sorts the kept elements best first.
+  void finish() {
+    for (int64_t n = size_ - 1; n > 0; --n) {
+      const CTYPE v = values_[n * stride_];
+      const long ix = indices_[n * stride_];
+      move(0, n);
+      sift_down(0, v, ix, n);
+    }
+  }
+
+ private:
+  /// Whether the kept element at heap position `pos` ranks before (v, ix).
+  bool ranks_before(const int64_t pos, const CTYPE v, const long ix) const {
+    return topk_ranks_before<kLargest>(
+        values_[pos * stride_], indices_[pos * stride_], v, ix);
+  }
+
+  void set(const int64_t pos, const CTYPE v, const long ix) {
+    values_[pos * stride_] = v;
+    indices_[pos * stride_] = ix;
+  }
+
+  void move(const int64_t from, const int64_t to) {
+    set(to, values_[from * stride_], indices_[from * stride_]);
+  }
+
+  /// Places (v, ix) at `pos` of the heap of the first `n` positions.
+  void sift_down(int64_t pos, const CTYPE v, const long ix, const int64_t n) {
+    while (true) {
+      int64_t child = 2 * pos + 1;
+      if (child >= n) {
+        break;
+      }
+      // Follow the worse child, which must not rank before its parent.
+      const int64_t sibling = child + 1;
+      if (sibling < n &&
+          ranks_before(
+              child, values_[sibling * stride_], indices_[sibling * stride_])) {
+        child = sibling;
+      }
+      if (ranks_before(child, v, ix)) {
+        break;
+      }
+      move(child, pos);
+      pos = child;
+    }
+    set(pos, v, ix);
+  }
+
+  CTYPE* const values_;
+  long* const indices_;
+  const int64_t k_;
+  const int64_t stride_;
+  int64_t size_ = 0;
+};
+
+/**
+ * Writes the k best of the `n` elements at `in`, `in_stride` apart, sorted
+ * best first to `values` and their positions to `indices`, whose elements
+ * are `out_stride` apart.
+ */
+template <bool kLargest, typename CTYPE>
+void topk_slice(
+    const CTYPE* const in,
+    const int64_t n,
+    const int64_t in_stride,
+    const int64_t k,
+    CTYPE* const values,
+    long* const indices,
+    const int64_t out_stride) {
+  TopKSelector<kLargest, CTYPE> selector(values, indices, k, out_stride);
+  for (int64_t i = 0; i < n; ++i) {
+    selector.push(in[i * in_stride], i);
+  }
+  selector.finish();
+}
+
+} // namespace internal
+
+} // namespace executor
+} // namespace torch
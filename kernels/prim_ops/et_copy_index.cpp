@@ -8,6 +8,7 @@
 
 #include <executorch/kernels/prim_ops/et_copy_index.h>
 
+#include <cinttypes>
 #include <cstring>
 
 #include <executorch/runtime/kernel/kernel_includes.h>
@@ -116,6 +117,56 @@ void et_copy_index(RuntimeContext& context, EValue** stack) {
       size_copy_from);
 }
 
+// Same as et_copy_index, with the number of iterations of the map as a fourth
+// argument: the emitter passes the sym_size that bounds the loop. copy_to is
+// resized to its final shape on the first iteration, after which every
+// iteration only writes its slice in place, without checking shapes or
+// resizing again.
+void et_copy_index_sized(RuntimeContext& context, EValue** stack) {
+  (void)context;
+  auto copy_to = (*stack[0]).toTensor();
+  const auto& copy_from = (*stack[1]).toTensor();
+  const auto index = (*stack[2]).toInt();
+  const auto num_iterations = (*stack[3]).toInt();
+
+  ET_CHECK_MSG(
+      index >= 0 && index < num_iterations,
+      "Index %" PRId64 " out of range for %" PRId64 " iterations",
+      index,
+      num_iterations);
+
+  if (index == 0) {
+    ET_CHECK_MSG(
+        copy_to.sizes().size() == copy_from.sizes().size() + 1,
+        "Ranks of copy_to  and copy_from tensor should only differ by 1.");
+    ET_CHECK_MSG(
+        copy_to.sizes().size() <= kTensorDimensionLimit,
+        "copy_to has too many dimensions");
+    SizesType expected_output_size[kTensorDimensionLimit];
+    expected_output_size[0] = num_iterations;
+    for (size_t i = 0; i < copy_from.sizes().size(); i++) {
+      expected_output_size[i + 1] = copy_from.sizes()[i];
+    }
+    // Nothing has been written yet, so an unbounded copy_to may move.
+    Error err =
+        resize_tensor(copy_to, {expected_output_size, copy_to.sizes().size()});
+    ET_CHECK_MSG(err == Error::Ok, "Failed to resize copy_to");
+  } else {
+    // The loop body produces the same shape on every iteration, so comparing
+    // the number of elements is enough.
+    ET_CHECK_MSG(
+        copy_to.size(0) == num_iterations &&
+            copy_from.numel() * num_iterations == copy_to.numel(),
+        "Mismatch in shape between copy_to and copy_from tensors");
+  }
+
+  const size_t size_copy_from = copy_from.nbytes();
+  memcpy(
+      copy_to.mutable_data_ptr<uint8_t>() + index * size_copy_from,
+      copy_from.const_data_ptr(),
+      size_copy_from);
+}
+
 } // namespace function
 } // namespace executor
 } // namespace torch
@@ -17,6 +17,8 @@ namespace function {
 
 void et_copy_index(RuntimeContext& context, EValue** stack);
 
+void et_copy_index_sized(RuntimeContext& context, EValue** stack);
+
 } // namespace function
 } // namespace executor
 } // namespace torch
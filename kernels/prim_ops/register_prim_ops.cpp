@@ -14,6 +14,7 @@
 
 using KernelArrayRef = ::torch::executor::ArrayRef<::torch::executor::Kernel>;
 using torch::executor::function::et_copy_index;
+using torch::executor::function::et_copy_index_sized;
 
 namespace torch {
 namespace executor {
@@ -241,6 +242,8 @@ static Kernel prim_ops[] = {
 
     // executorch_prim::et_copy_index.tensor(tensor, tensor) -> tensor
     Kernel("executorch_prim::et_copy_index.tensor", &et_copy_index),
+    // executorch_prim::et_copy_index.sized(tensor, tensor, int, int) -> tensor
+    Kernel("executorch_prim::et_copy_index.sized", &et_copy_index_sized),
     // executorch_prim::et_view.default(Tensor, int[]) -> Tensor
     Kernel("executorch_prim::et_view.default", &et_view),
 
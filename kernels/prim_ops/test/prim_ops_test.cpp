@@ -223,6 +223,68 @@ TEST_F(RegisterPrimOpsTest, TestETCopyIndexStaticShape) {
 #endif
 }
 
+TEST_F(RegisterPrimOpsTest, TestETCopyIndexSized) {
+  EXPECT_TRUE(hasOpsFn("executorch_prim::et_copy_index.sized"));
+
+  testing::TensorFactory<ScalarType::Int> tf;
+
+#ifdef USE_ATEN_LIB
+  Tensor copy_to = tf.make({3, 2}, {0, 0, 0, 0, 0, 0});
+#else
+  Tensor copy_to = tf.make(
+      {3, 2}, {0, 0, 0, 0, 0, 0}, {}, TensorShapeDynamism::DYNAMIC_BOUND);
+  SizesType empty_size[2] = {0, 0};
+  Error err = resize_tensor(copy_to, {empty_size, 2});
+  EXPECT_EQ(err, Error::Ok);
+#endif
+
+  EValue values[4];
+  EValue* stack[4];
+  values[0] = EValue(copy_to);
+  values[1] = EValue(tf.make({2}, {1, 2}));
+  values[2] = EValue((int64_t)0);
+  values[3] = EValue((int64_t)2);
+  for (size_t i = 0; i < 4; i++) {
+    stack[i] = &values[i];
+  }
+
+  // The first iteration resizes copy_to to its final shape.
+  getOpsFn("executorch_prim::et_copy_index.sized")(context, stack);
+  EXPECT_EQ(copy_to.sizes()[0], 2);
+  EXPECT_EQ(copy_to.sizes()[1], 2);
+  const void* data_ptr = copy_to.const_data_ptr();
+
+  // The next ones write their slice in place.
+  values[1] = EValue(tf.make({2}, {3, 4}));
+  values[2] = EValue((int64_t)1);
+  getOpsFn("executorch_prim::et_copy_index.sized")(context, stack);
+  EXPECT_EQ(copy_to.const_data_ptr(), data_ptr);
+  EXPECT_TENSOR_EQ(copy_to, tf.make({2, 2}, {1, 2, 3, 4}));
+
+  // Indices past the number of iterations are rejected.
+  values[2] = EValue((int64_t)2);
+  ET_EXPECT_DEATH(
+      getOpsFn("executorch_prim::et_copy_index.sized")(context, stack), "");
+}
+
+TEST_F(RegisterPrimOpsTest, TestETCopyIndexSizedMismatchShape) {
+  testing::TensorFactory<ScalarType::Int> tf;
+
+  EValue values[4];
+  EValue* stack[4];
+  values[0] = EValue(tf.make({2, 3}, {1, 2, 3, 4, 5, 6}));
+  values[1] = EValue(tf.make({2}, {1, 2}));
+  values[2] = EValue((int64_t)1);
+  values[3] = EValue((int64_t)2);
+  for (size_t i = 0; i < 4; i++) {
+    stack[i] = &values[i];
+  }
+
+  // copy_to was not sized for slices of copy_from's shape.
+  ET_EXPECT_DEATH(
+      getOpsFn("executorch_prim::et_copy_index.sized")(context, stack), "");
+}
+
 TEST_F(RegisterPrimOpsTest, TestBooleanOps) {
   EValue values[3];
   double a = 3;
@@ -6,12 +6,20 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/vec_ops.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <limits>
 #include <tuple>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
  */
@@ -66,17 +74,58 @@ void check_quantize_per_tensor_args(
       ssize_t(zero_point_out.numel()));
 }
 
-void choose_qparams(
-    const Tensor& input,
+/**
+ * Computes the minimum and maximum of the `n` floats at `x` in a single pass.
+ */
+void find_min_max(const float* x, int64_t n, float& min_out, float& max_out) {
+  float min = std::numeric_limits<float>::infinity();
+  float max = -std::numeric_limits<float>::infinity();
+  int64_t i = 0;
+#if defined(__aarch64__)
+  float32x4_t v_min = vdupq_n_f32(min);
+  float32x4_t v_max = vdupq_n_f32(max);
+  for (; i + 4 <= n; i += 4) {
+    const float32x4_t v = vld1q_f32(x + i);
+    v_min = vminq_f32(v_min, v);
+    v_max = vmaxq_f32(v_max, v);
+  }
+  min = vminvq_f32(v_min);
+  max = vmaxvq_f32(v_max);
+#elif defined(__AVX2__)
+  __m256 v_min = _mm256_set1_ps(min);
+  __m256 v_max = _mm256_set1_ps(max);
+  for (; i + 8 <= n; i += 8) {
+    const __m256 v = _mm256_loadu_ps(x + i);
+    v_min = _mm256_min_ps(v_min, v);
+    v_max = _mm256_max_ps(v_max, v);
+  }
+  float mins[8];
+  float maxs[8];
+  _mm256_storeu_ps(mins, v_min);
+  _mm256_storeu_ps(maxs, v_max);
+  for (int j = 0; j < 8; ++j) {
+    min = std::min(min, mins[j]);
+    max = std::max(max, maxs[j]);
+  }
+#endif
+  for (; i < n; ++i) {
+    min = std::min(min, x[i]);
+    max = std::max(max, x[i]);
+  }
+  min_out = min;
+  max_out = max;
+}
+
+/**
+ * Computes the scale and zero point that map [min, max] onto [qmin, qmax].
+ */
+void calculate_scale_and_zero_point(
+    float min,
+    float max,
     int32_t qmin,
     int32_t qmax,
-    Tensor& scale_out,
-    Tensor& zero_point_out) {
-  const float* x_fp32 = input.const_data_ptr<float>();
-  // Compute x_min, x_max and q_params (scale, zero_point)
-  float min = torch::executor::vec_minf(x_fp32, input.numel());
-  float max = torch::executor::vec_maxf(x_fp32, input.numel());
-
+    double& scale_out,
+    int32_t& zero_point_out) {
   // We extend the [min, max] interval to ensure that it contains 0.
   // Otherwise, we would not meet the requirement that 0 be an exactly
   // representable value.
@@ -144,8 +193,59 @@ void choose_qparams(
     nudged_zero_point = nearbyint(static_cast<float>(initial_zero_point));
   }
 
+  scale_out = scale;
+  zero_point_out = nudged_zero_point;
+}
+
+void choose_qparams(
+    const Tensor& input,
+    int32_t qmin,
+    int32_t qmax,
+    Tensor& scale_out,
+    Tensor& zero_point_out) {
+  float min = 0;
+  float max = 0;
+  find_min_max(input.const_data_ptr<float>(), input.numel(), min, max);
+
+  double scale = 0;
+  int32_t zero_point = 0;
+  calculate_scale_and_zero_point(min, max, qmin, qmax, scale, zero_point);
   scale_out.mutable_data_ptr<double>()[0] = scale;
-  zero_point_out.mutable_data_ptr<int64_t>()[0] = nudged_zero_point;
+  zero_point_out.mutable_data_ptr<int64_t>()[0] = zero_point;
+}
+
+/**
+ * Computes a scale and zero point for each token, i.e. each slice of the
+ * input along its last dimension. Each token is read once, and tokens are
+ * split across threads.
+ */
+void choose_qparams_per_token(
+    const Tensor& input,
+    int32_t qmin,
+    int32_t qmax,
+    Tensor& scale_out,
+    Tensor& zero_point_out) {
+  const float* x_fp32 = input.const_data_ptr<float>();
+  const int64_t token_size = input.dim() > 0 ? input.size(input.dim() - 1) : 1;
+  const int64_t num_tokens = token_size > 0 ? input.numel() / token_size : 0;
+  double* scale_data = scale_out.mutable_data_ptr<double>();
+  int64_t* zero_point_data = zero_point_out.mutable_data_ptr<int64_t>();
+
+  parallel_for_each_chunk(
+      0, num_tokens, token_size, [&](int64_t begin, int64_t end) {
+        for (int64_t token = begin; token < end; ++token) {
+          float min = 0;
+          float max = 0;
+          find_min_max(x_fp32 + token * token_size, token_size, min, max);
+
+          double scale = 0;
+          int32_t zero_point = 0;
+          calculate_scale_and_zero_point(
+              min, max, qmin, qmax, scale, zero_point);
+          scale_data[token] = scale;
+          zero_point_data[token] = zero_point;
+        }
+      });
 }
 } // namespace
 
@@ -180,6 +280,66 @@ std::tuple<Tensor, Tensor> choose_qparams_tensor_out(
       input, quant_min, quant_max, eps, dtype, scale_out, zero_point_out);
 }
 
+/**
+ * Computes an asymmetric int8 scale and zero point for each token of the
+ * input, i.e. each slice along its last dimension. scale_out and
+ * zero_point_out are resized to the input's shape with a last dimension of
+ * size 1.
+ */
+std::tuple<Tensor&, Tensor&> choose_qparams_per_token_asymmetric_out(
+    const Tensor& input,
+    ScalarType dtype,
+    Tensor& scale_out,
+    Tensor& zero_point_out) {
+  (void)dtype;
+  const int32_t quant_min = -128;
+  const int32_t quant_max = 127;
+
+  ET_CHECK_MSG(
+      input.dim() > 0, "Expected input to have at least one dimension");
+  ET_CHECK_MSG(
+      input.scalar_type() == ScalarType::Float,
+      "Expected input to be Float tensor received: %" PRId8,
+      static_cast<int8_t>(input.scalar_type()));
+  ET_CHECK_MSG(
+      scale_out.scalar_type() == ScalarType::Double,
+      "Expected scale to be Double tensor received: %" PRId8,
+      static_cast<int8_t>(scale_out.scalar_type()));
+  ET_CHECK_MSG(
+      zero_point_out.scalar_type() == ScalarType::Long,
+      "Expected zero_point to be Long tensor received: %" PRId8,
+      static_cast<int8_t>(zero_point_out.scalar_type()));
+
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  for (ssize_t i = 0; i < input.dim() - 1; i++) {
+    output_sizes[i] = input.size(i);
+  }
+  output_sizes[input.dim() - 1] = 1;
+  const exec_aten::ArrayRef<exec_aten::SizesType> output_shape(
+      output_sizes, input.dim());
+  ET_CHECK_MSG(
+      resize_tensor(scale_out, output_shape) == Error::Ok,
+      "Failed to resize scale_out Tensor in choose_qparams_per_token");
+  ET_CHECK_MSG(
+      resize_tensor(zero_point_out, output_shape) == Error::Ok,
+      "Failed to resize zero_point_out Tensor in choose_qparams_per_token");
+
+  choose_qparams_per_token(
+      input, quant_min, quant_max, scale_out, zero_point_out);
+  return {scale_out, zero_point_out};
+}
+
+std::tuple<Tensor&, Tensor&> choose_qparams_per_token_asymmetric_out(
+    RuntimeContext& context,
+    const Tensor& input,
+    ScalarType dtype,
+    Tensor& scale_out,
+    Tensor& zero_point_out) {
+  (void)context;
+  return choose_qparams_per_token_asymmetric_out(
+      input, dtype, scale_out, zero_point_out);
+}
+
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -6,11 +6,22 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/util/reduce_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <type_traits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 2)
+// Helium with floating point, e.g. Cortex-M55 and Cortex-M85.
+#include <arm_mve.h>
+#define ET_QUANTIZED_USE_MVE 1
+#endif
 
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
@@ -61,6 +72,190 @@ void check_dequantize_per_tensor_args(
       quant_max);
 }
 
+/**
+ * Dequantizes `n` contiguous values that share a scale and zero point, with
+ * the same float arithmetic as fbgemm.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void dequantize_block(
+    const CTYPE_IN* in,
+    CTYPE_OUT* out,
+    int64_t n,
+    float scale,
+    int32_t zero_point) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = static_cast<CTYPE_OUT>((in[i] - zero_point) * scale);
+  }
+}
+
+#if defined(__aarch64__) || defined(__AVX2__) || defined(ET_QUANTIZED_USE_MVE)
+/**
+ * Vectorized dequantize_block() for 8-bit inputs and float outputs. The
+ * values are widened to 32-bit integers before subtracting the zero point,
+ * so the result matches the scalar loop exactly.
+ */
+template <typename CTYPE_IN>
+void dequantize_8bit_block_float(
+    const CTYPE_IN* in,
+    float* out,
+    int64_t n,
+    float scale,
+    int32_t zero_point) {
+  constexpr bool kIsSigned = std::is_signed<CTYPE_IN>::value;
+  int64_t i = 0;
+#if defined(__aarch64__)
+  const int32x4_t v_zero_point = vdupq_n_s32(zero_point);
+  const float32x4_t v_scale = vdupq_n_f32(scale);
+  for (; i + 16 <= n; i += 16) {
+    int16x8_t wide[2];
+    if (kIsSigned) {
+      const int8x16_t v = vld1q_s8(reinterpret_cast<const int8_t*>(in + i));
+      wide[0] = vmovl_s8(vget_low_s8(v));
+      wide[1] = vmovl_s8(vget_high_s8(v));
+    } else {
+      const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i));
+      wide[0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v)));
+      wide[1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v)));
+    }
+    for (int j = 0; j < 2; ++j) {
+      const int32x4_t lo =
+          vsubq_s32(vmovl_s16(vget_low_s16(wide[j])), v_zero_point);
+      const int32x4_t hi =
+          vsubq_s32(vmovl_s16(vget_high_s16(wide[j])), v_zero_point);
+      vst1q_f32(out + i + 8 * j, vmulq_f32(vcvtq_f32_s32(lo), v_scale));
+      vst1q_f32(out + i + 8 * j + 4, vmulq_f32(vcvtq_f32_s32(hi), v_scale));
+    }
+  }
+#elif defined(ET_QUANTIZED_USE_MVE)
+  const int32x4_t v_zero_point = vdupq_n_s32(zero_point);
+  for (; i + 4 <= n; i += 4) {
+    // Widening byte loads.
+    const int32x4_t wide = kIsSigned
+        ? vldrbq_s32(reinterpret_cast<const int8_t*>(in + i))
+        : vreinterpretq_s32_u32(
+              vldrbq_u32(reinterpret_cast<const uint8_t*>(in + i)));
+    const float32x4_t shifted =
+        vcvtq_f32_s32(vsubq_s32(wide, v_zero_point));
+    vst1q_f32(out + i, vmulq_n_f32(shifted, scale));
+  }
+#else
+  const __m256i v_zero_point = _mm256_set1_epi32(zero_point);
+  const __m256 v_scale = _mm256_set1_ps(scale);
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+    const __m256i wide =
+        kIsSigned ? _mm256_cvtepi8_epi32(v) : _mm256_cvtepu8_epi32(v);
+    const __m256 shifted =
+        _mm256_cvtepi32_ps(_mm256_sub_epi32(wide, v_zero_point));
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(shifted, v_scale));
+  }
+#endif
+  dequantize_block<CTYPE_IN, float>(
+      in + i, out + i, n - i, scale, zero_point);
+}
+
+void dequantize_block(
+    const uint8_t* in,
+    float* out,
+    int64_t n,
+    float scale,
+    int32_t zero_point) {
+  dequantize_8bit_block_float(in, out, n, scale, zero_point);
+}
+
+void dequantize_block(
+    const int8_t* in,
+    float* out,
+    int64_t n,
+    float scale,
+    int32_t zero_point) {
+  dequantize_8bit_block_float(in, out, n, scale, zero_point);
+}
+#endif
+
+/**
+ * Dequantizes blocks of `inner` contiguous elements, where block `b` belongs
+ * to channel `b % channels`, splitting the blocks across threads. Unlike the
+ * per-tensor variant, the arithmetic is done in double. The inputs are at
+ * most 32-bit, so converting them and the zero point to double before the
+ * subtraction is exact, and lets the compiler vectorize the loop.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void dequantize_per_channel_blocks(
+    const CTYPE_IN* in,
+    CTYPE_OUT* out,
+    int64_t outer,
+    int64_t channels,
+    int64_t inner,
+    const double* scale_data,
+    const int64_t* zero_point_data) {
+  parallel_for_each_chunk(
+      0, outer * channels, inner, [&](int64_t begin, int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          const int64_t channel = block % channels;
+          const double scale = scale_data[channel];
+          const double zero_point = zero_point_data != nullptr
+              ? static_cast<double>(zero_point_data[channel])
+              : 0.0;
+          const CTYPE_IN* in_block = in + block * inner;
+          CTYPE_OUT* out_block = out + block * inner;
+          for (int64_t i = 0; i < inner; ++i) {
+            out_block[i] = static_cast<CTYPE_OUT>(
+                (static_cast<double>(in_block[i]) - zero_point) * scale);
+          }
+        }
+      });
+}
+
+/**
+ * Dequantizes `input`, viewed as [outer, channels, inner], with one scale and
+ * zero point per channel. `zero_point_data` may be null for symmetric
+ * quantization.
+ */
+void dequantize_per_channel_impl(
+    const Tensor& input,
+    const double* scale_data,
+    const int64_t* zero_point_data,
+    int64_t outer,
+    int64_t channels,
+    int64_t inner,
+    Tensor& out) {
+#define DEQUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype) \
+  case ScalarType::out_dtype:                           \
+    dequantize_per_channel_blocks(                      \
+        input.const_data_ptr<CTYPE_IN>(),               \
+        out.mutable_data_ptr<CTYPE_OUT>(),              \
+        outer,                                          \
+        channels,                                       \
+        inner,                                          \
+        scale_data,                                     \
+        zero_point_data);                               \
+    break;
+#define CALCULATE_INT_TYPE(CTYPE_IN, in_dtype)               \
+  case ScalarType::in_dtype:                                 \
+    switch (out.scalar_type()) {                             \
+      ET_FORALL_FLOAT_TYPES_WITH(CTYPE_IN, DEQUANTIZE_IMPL); \
+      default:                                               \
+        ET_CHECK_MSG(                                        \
+            false,                                           \
+            "Unhandled output dtype %" PRId8,                \
+            static_cast<int8_t>(out.scalar_type()));         \
+    }                                                        \
+    break;
+
+  switch (input.scalar_type()) {
+    ET_FORALL_INT_TYPES(CALCULATE_INT_TYPE);
+    default:
+      ET_CHECK_MSG(
+          false,
+          "Unhandled input dtype %" PRId8,
+          static_cast<int8_t>(input.scalar_type()));
+  }
+#undef CALCULATE_INT_TYPE
+#undef DEQUANTIZE_IMPL
+}
+
 } // namespace
 
 /**
@@ -91,15 +286,20 @@ Tensor& dequantize_per_tensor_out(
 
   // calculate the dequantized output, cast scale to float to match fbgemm
   // behavior
-#define DEQUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)              \
-  case ScalarType::out_dtype:                                        \
-    for (size_t i = 0; i < input.numel(); i++) {                     \
-      out.mutable_data_ptr<OUT_CTYPE>()[i] = static_cast<OUT_CTYPE>( \
-          (input.const_data_ptr<IN_CTYPE>()[i] -                     \
-           static_cast<int32_t>(zero_point)) *                       \
-          static_cast<float>(scale));                                \
-    }                                                                \
-    break;
+#define DEQUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)            \
+  case ScalarType::out_dtype: {                                    \
+    const IN_CTYPE* in_data = input.const_data_ptr<IN_CTYPE>();    \
+    OUT_CTYPE* out_data = out.mutable_data_ptr<OUT_CTYPE>();       \
+    parallel_for_each_chunk(                                       \
+        0, input.numel(), 1, [&](int64_t begin, int64_t end) {     \
+          dequantize_block(                                        \
+              in_data + begin,                                     \
+              out_data + begin,                                    \
+              end - begin,                                         \
+              static_cast<float>(scale),                           \
+              static_cast<int32_t>(zero_point));                   \
+        });                                                        \
+  } break;
 #define CALCULATE_INT_TYPE(IN_CTYPE, in_dtype)               \
   case ScalarType::in_dtype:                                 \
     switch (out.scalar_type()) {                             \
@@ -121,7 +321,7 @@ Tensor& dequantize_per_tensor_out(
           static_cast<int8_t>(input.scalar_type()));
   }
 
-#undef CALCULATE_FLOAT_TYPE
+#undef CALCULATE_INT_TYPE
 #undef DEQUANTIZE_IMPL
   return out;
 }
@@ -219,75 +419,27 @@ Tensor& dequantize_per_channel_out(
   check_dequantize_per_tensor_args(
       input, quant_min, quant_max, dtype, out_dtype, out);
 
-  // a list contains all dimensions except axis
-  int64_t dims[input.dim() - 1];
-  for (int64_t i = 0; i < input.dim() - 1; i++) {
-    if (i < axis) {
-      dims[i] = i;
-    } else {
-      dims[i] = i - 1;
-    }
+  // View the input as [outer, channels, inner] around the axis, so that each
+  // channel is dequantized in contiguous blocks of `inner` elements.
+  const int64_t channels = input.size(axis);
+  int64_t outer = 1;
+  for (int64_t i = 0; i < axis; i++) {
+    outer *= input.size(i);
   }
-  const double* scale_data = scale.const_data_ptr<double>();
-  const int64_t* zero_point_data;
-  if (opt_zero_points.has_value()) {
-    zero_point_data = opt_zero_points.value().const_data_ptr<int64_t>();
-  } else {
-    zero_point_data = nullptr;
+  int64_t inner = 1;
+  for (int64_t i = axis + 1; i < input.dim(); i++) {
+    inner *= input.size(i);
   }
-
-  exec_aten::optional<exec_aten::ArrayRef<int64_t>> optional_dim_list{
-      exec_aten::ArrayRef<int64_t>{dims, size_t(input.dim() - 1)}};
-
-  // Actual dequantization logic
-  // input, out are the input and output tensors
-  // channel_ix is the index along the axis dimension. 0 <= channel_ix <
-  // input.size(axis).
-  //   i.e. if the tensor has shape (N,C,H,W), axis being 1, then channel_ix
-  //   will be 0, 1, 2, ... C-1
-  // in_ix is the flat index of the element you are dequantizing.
-  //   in other words you are dequantizing in_data[in_ix]
-#define DEQUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype)                        \
-  case ScalarType::out_dtype:                                                  \
-    for (size_t channel_ix = 0; channel_ix < input.size(axis); ++channel_ix) { \
-      double _scale = scale_data[channel_ix];                                  \
-      int64_t _zero_point = 0;                                                 \
-      if (zero_point_data != nullptr) {                                        \
-        _zero_point = zero_point_data[channel_ix];                             \
-      }                                                                        \
-      apply_over_dim_list(                                                     \
-          [input, out, _scale, _zero_point](size_t in_ix) {                    \
-            out.mutable_data_ptr<CTYPE_OUT>()[in_ix] = static_cast<CTYPE_OUT>( \
-                (input.const_data_ptr<CTYPE_IN>()[in_ix] - _zero_point) *      \
-                _scale);                                                       \
-          },                                                                   \
-          input,                                                               \
-          optional_dim_list,                                                   \
-          channel_ix);                                                         \
-    }                                                                          \
-    break;
-#define CALCULATE_FLOAT_TYPE(CTYPE_IN, in_dtype)             \
-  case ScalarType::in_dtype:                                 \
-    switch (out.scalar_type()) {                             \
-      ET_FORALL_FLOAT_TYPES_WITH(CTYPE_IN, DEQUANTIZE_IMPL); \
-      default:                                               \
-        ET_CHECK_MSG(                                        \
-            false,                                           \
-            "Unhandled output dtype %" PRId8,                \
-            static_cast<int8_t>(out.scalar_type()));         \
-    }                                                        \
-    break;
-
-  switch (input.scalar_type()) {
-    ET_FORALL_INT_TYPES(CALCULATE_FLOAT_TYPE);
-    default:
-      ET_CHECK_MSG(
-          false,
-          "Unhandled input dtype %" PRId8,
-          static_cast<int8_t>(input.scalar_type()));
-  }
-#undef CALCULATE_FLOAT_TYPE
-#undef QUANTIZE_IMPL
+  dequantize_per_channel_impl(
+      input,
+      scale.const_data_ptr<double>(),
+      opt_zero_points.has_value()
+          ? opt_zero_points.value().const_data_ptr<int64_t>()
+          : nullptr,
+      outer,
+      channels,
+      inner,
+      out);
 
   return out;
 }
@@ -316,6 +468,81 @@ Tensor& dequantize_per_channel_out(
       out);
 }
 
+/**
+ * Dequantizes each token of the input, i.e. each slice along its last
+ * dimension, with its own scale and zero point, as computed by
+ * choose_qparams_per_token_asymmetric. `scale` and `zero_point` hold one
+ * value per token.
+ */
+Tensor& dequantize_per_token_out(
+    const Tensor& input,
+    const Tensor& scale,
+    const Tensor& zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    ScalarType dtype,
+    ScalarType out_dtype,
+    Tensor& out) {
+  torch::executor::Error err = resize_tensor(out, input.sizes());
+  ET_CHECK_MSG(
+      err == torch::executor::Error::Ok,
+      "Failed to resize out Tensor in dequantize_per_token_out");
+
+  const int64_t token_size = input.dim() > 0 ? input.size(input.dim() - 1) : 1;
+  const int64_t num_tokens = token_size > 0 ? input.numel() / token_size : 0;
+
+  ET_CHECK_MSG(
+      scale.scalar_type() == ScalarType::Double,
+      "scale.scalar_type() %" PRId8 " is not double type",
+      static_cast<int8_t>(scale.scalar_type()));
+
+  ET_CHECK_MSG(
+      scale.numel() == num_tokens,
+      "scale.numel() %zd != number of tokens %zd",
+      ssize_t(scale.numel()),
+      ssize_t(num_tokens));
+
+  ET_CHECK_MSG(
+      zero_point.scalar_type() == ScalarType::Long,
+      "zero_point.scalar_type() %" PRId8 " is not integer type",
+      static_cast<int8_t>(zero_point.scalar_type()));
+
+  ET_CHECK_MSG(
+      zero_point.numel() == num_tokens,
+      "zero_point.numel() %zd != number of tokens %zd",
+      ssize_t(zero_point.numel()),
+      ssize_t(num_tokens));
+
+  exec_aten::optional<ScalarType> opt_out_dtype = out_dtype;
+  check_dequantize_per_tensor_args(
+      input, quant_min, quant_max, dtype, opt_out_dtype, out);
+
+  dequantize_per_channel_impl(
+      input,
+      scale.const_data_ptr<double>(),
+      zero_point.const_data_ptr<int64_t>(),
+      /*outer=*/1,
+      /*channels=*/num_tokens,
+      /*inner=*/token_size,
+      out);
+  return out;
+}
+
+Tensor& dequantize_per_token_out(
+    RuntimeContext& context,
+    const Tensor& input,
+    const Tensor& scale,
+    const Tensor& zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    ScalarType dtype,
+    ScalarType out_dtype,
+    Tensor& out) {
+  (void)context;
+  return dequantize_per_token_out(
+      input, scale, zero_point, quant_min, quant_max, dtype, out_dtype, out);
+}
+
 Tensor& dequantize_per_tensor_out(
     RuntimeContext& context,
     const Tensor& input,
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = exec_aten::Tensor;
+
+namespace {
+
+// Activations are quantized kChunkSize elements at a time into a stack
+// buffer, for up to kRowTile rows at once. Each weight row is then read once
+// per tile of activation rows instead of once per row.
+constexpr int64_t kChunkSize = 1024;
+constexpr int64_t kRowTile = 4;
+
+/// Returns sum(a[i] * b[i]) for i in [0, len).
+inline int32_t dot_int8(const int8_t* a, const int8_t* b, int64_t len) {
+  int64_t i = 0;
+  int32_t sum = 0;
+#if defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= len; i += 16) {
+    acc = vdotq_s32(acc, vld1q_s8(a + i), vld1q_s8(b + i));
+  }
+  sum = vaddvq_s32(acc);
+#elif defined(__aarch64__)
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= len; i += 16) {
+    const int8x16_t va = vld1q_s8(a + i);
+    const int8x16_t vb = vld1q_s8(b + i);
+    // |a| <= 127, so the sum of two products fits in int16.
+    int16x8_t prod = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+    prod = vmlal_high_s8(prod, va, vb);
+    acc = vpadalq_s16(acc, prod);
+  }
+  sum = vaddvq_s32(acc);
+#elif defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 16 <= len; i += 16) {
+    const __m256i va = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+#if defined(__AVXVNNI__)
+    acc = _mm256_dpwssd_avx_epi32(acc, va, vb);
+#else
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+#endif
+  }
+  __m128i s = _mm_add_epi32(
+      _mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  s = _mm_hadd_epi32(s, s);
+  s = _mm_hadd_epi32(s, s);
+  sum = _mm_cvtsi128_si32(s);
+#endif
+  for (; i < len; ++i) {
+    sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+  }
+  return sum;
+}
+
+/// Returns the value of element `index` of a packed int4 row: two elements
+/// per byte, the even one in the high nibble, both stored with an offset of 8.
+/// This is the layout used by quantized_decomposed::embedding_4bit.
+inline int32_t int4_value(const uint8_t* w, int64_t index) {
+  const uint8_t byte = w[index >> 1];
+  return static_cast<int32_t>((index & 1) ? (byte & 0x0F) : (byte >> 4)) - 8;
+}
+
+/// Returns sum(a[i] * w[i]) for i in [0, len), where w is a packed int4 row
+/// starting at an even element. `a` is indexed in elements.
+inline int32_t dot_int8_int4(const int8_t* a, const uint8_t* w, int64_t len) {
+  int64_t i = 0;
+  int32_t sum = 0;
+#if defined(__aarch64__)
+  const uint8x16_t mask = vdupq_n_u8(0x0F);
+  const int8x16_t offset = vdupq_n_s8(8);
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 32 <= len; i += 32) {
+    const uint8x16_t packed = vld1q_u8(w + i / 2);
+    const int8x16_t hi =
+        vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(packed, 4)), offset);
+    const int8x16_t lo =
+        vsubq_s8(vreinterpretq_s8_u8(vandq_u8(packed, mask)), offset);
+    // Interleave back into element order: hi0 lo0 hi1 lo1 ...
+    const int8x16x2_t vw = vzipq_s8(hi, lo);
+#if defined(__ARM_FEATURE_DOTPROD)
+    acc = vdotq_s32(acc, vld1q_s8(a + i), vw.val[0]);
+    acc = vdotq_s32(acc, vld1q_s8(a + i + 16), vw.val[1]);
+#else
+    for (int half = 0; half < 2; ++half) {
+      const int8x16_t va = vld1q_s8(a + i + 16 * half);
+      int16x8_t prod = vmull_s8(vget_low_s8(va), vget_low_s8(vw.val[half]));
+      prod = vmlal_high_s8(prod, va, vw.val[half]);
+      acc = vpadalq_s16(acc, prod);
+    }
+#endif
+  }
+  sum = vaddvq_s32(acc);
+#elif defined(__AVX2__)
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m128i offset = _mm_set1_epi8(8);
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 32 <= len; i += 32) {
+    const __m128i packed =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i / 2));
+    const __m128i hi =
+        _mm_sub_epi8(_mm_and_si128(_mm_srli_epi16(packed, 4), mask), offset);
+    const __m128i lo = _mm_sub_epi8(_mm_and_si128(packed, mask), offset);
+    // Interleave back into element order: hi0 lo0 hi1 lo1 ...
+    const __m128i vw[2] = {
+        _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo)};
+    for (int half = 0; half < 2; ++half) {
+      const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(a + i + 16 * half)));
+      const __m256i vb = _mm256_cvtepi8_epi16(vw[half]);
+#if defined(__AVXVNNI__)
+      acc = _mm256_dpwssd_avx_epi32(acc, va, vb);
+#else
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+#endif
+    }
+  }
+  __m128i s = _mm_add_epi32(
+      _mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  s = _mm_hadd_epi32(s, s);
+  s = _mm_hadd_epi32(s, s);
+  sum = _mm_cvtsi128_si32(s);
+#endif
+  for (; i < len; ++i) {
+    sum += static_cast<int32_t>(a[i]) * int4_value(w, i);
+  }
+  return sum;
+}
+
+/**
+ * Quantizes `len` activations to int8 with the symmetric per-token scale
+ * 1 / `inv_scale`, rounding like quantize_per_tensor.
+ */
+inline void quantize_activations(
+    const float* x,
+    int64_t len,
+    float inv_scale,
+    int8_t* q) {
+  for (int64_t i = 0; i < len; ++i) {
+    const float v = std::nearbyint(x[i] * inv_scale);
+    q[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, v)));
+  }
+}
+
+/// Per-token symmetric scale: the row's absolute maximum maps to 127.
+inline float activation_scale(const float* x, int64_t len) {
+  float absmax = 0;
+  for (int64_t i = 0; i < len; ++i) {
+    absmax = std::max(absmax, std::abs(x[i]));
+  }
+  return absmax == 0 ? 1.0f : absmax / 127.0f;
+}
+
+bool check_linear_dynamic_args(
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    ScalarType weight_dtype,
+    int64_t in_features,
+    Tensor& out) {
+  ET_LOG_AND_RETURN_IF_FALSE(in.dim() >= 1);
+  ET_LOG_AND_RETURN_IF_FALSE(tensor_is_rank(weight, 2));
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      weight_scales.dim() == 1 || weight_scales.dim() == 2,
+      "weight_scales must be 1D or 2D but got %zd dims",
+      ssize_t(weight_scales.dim()));
+  ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_rank(in, out));
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      in.scalar_type() == ScalarType::Float, "input dtype must be Float");
+  ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_dtype(in, weight_scales, out));
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      weight.scalar_type() == weight_dtype, "unexpected weight dtype");
+
+  ET_LOG_MSG_AND_RETURN_IF_FALSE(
+      in.size(in.dim() - 1) == in_features,
+      "input features %zd do not match weight features %" PRId64,
+      ssize_t(in.size(in.dim() - 1)),
+      in_features);
+  ET_LOG_AND_RETURN_IF_FALSE(
+      tensors_have_same_size_at_dims(weight_scales, 0, weight, 0));
+  if (weight_scales.dim() == 2) {
+    ET_LOG_MSG_AND_RETURN_IF_FALSE(
+        in_features % weight_scales.size(1) == 0,
+        "number of groups must divide the input features");
+  }
+
+  if (opt_bias.has_value()) {
+    const Tensor& bias = opt_bias.value();
+    ET_LOG_AND_RETURN_IF_FALSE(tensor_is_rank(bias, 1));
+    ET_LOG_AND_RETURN_IF_FALSE(tensors_have_same_dtype(bias, in));
+    ET_LOG_AND_RETURN_IF_FALSE(
+        tensors_have_same_size_at_dims(bias, 0, weight, 0));
+  }
+  return true;
+}
+
+void resize_linear_dynamic_out(
+    const Tensor& in,
+    const Tensor& weight,
+    Tensor& out) {
+  const size_t dim = static_cast<size_t>(in.dim());
+  exec_aten::SizesType output_sizes[kTensorDimensionLimit];
+  for (size_t i = 0; i < dim; ++i) {
+    output_sizes[i] = in.size(i);
+  }
+  output_sizes[dim - 1] = weight.size(0);
+  ET_CHECK(resize_tensor(out, {output_sizes, dim}) == Error::Ok);
+}
+
+/**
+ * Shared driver for the int8 and int4 weight kernels. `dot(q, j, k0, len)`
+ * returns the int32 dot product of `len` quantized activations with weight
+ * row j starting at input feature k0.
+ */
+template <typename DotFn>
+void linear_dynamic(
+    const Tensor& in,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    const DotFn& dot,
+    Tensor& out) {
+  const int64_t k = in.size(in.dim() - 1);
+  const int64_t m = k == 0 ? 0 : in.numel() / k;
+  const int64_t n = out.size(out.dim() - 1);
+  const int64_t num_groups =
+      weight_scales.dim() == 2 ? weight_scales.size(1) : 1;
+  const int64_t group_size = k / num_groups;
+
+  const float* const in_data = in.const_data_ptr<float>();
+  const float* const scales = weight_scales.const_data_ptr<float>();
+  const float* const bias =
+      opt_bias.has_value() ? opt_bias.value().const_data_ptr<float>() : nullptr;
+  float* const out_data = out.mutable_data_ptr<float>();
+
+  int8_t q[kRowTile][kChunkSize];
+  float act_scales[kRowTile];
+
+  for (int64_t row0 = 0; row0 < m; row0 += kRowTile) {
+    const int64_t rows = std::min(kRowTile, m - row0);
+    for (int64_t r = 0; r < rows; ++r) {
+      act_scales[r] = activation_scale(in_data + (row0 + r) * k, k);
+      std::fill(out_data + (row0 + r) * n, out_data + (row0 + r + 1) * n, 0.f);
+    }
+
+    for (int64_t k0 = 0; k0 < k; k0 += kChunkSize) {
+      const int64_t chunk = std::min(kChunkSize, k - k0);
+      for (int64_t r = 0; r < rows; ++r) {
+        quantize_activations(
+            in_data + (row0 + r) * k + k0, chunk, 1.0f / act_scales[r], q[r]);
+      }
+
+      for (int64_t j = 0; j < n; ++j) {
+        const float* const row_scales = scales + j * num_groups;
+        // Walk the groups overlapping this chunk. A group split across
+        // chunks is scaled once per piece.
+        for (int64_t g0 = k0; g0 < k0 + chunk;) {
+          const int64_t group = g0 / group_size;
+          const int64_t g1 = std::min((group + 1) * group_size, k0 + chunk);
+          const float w_scale = row_scales[group];
+          for (int64_t r = 0; r < rows; ++r) {
+            const int32_t acc = dot(q[r] + (g0 - k0), j, g0, g1 - g0);
+            out_data[(row0 + r) * n + j] += static_cast<float>(acc) * w_scale;
+          }
+          g0 = g1;
+        }
+      }
+    }
+
+    for (int64_t r = 0; r < rows; ++r) {
+      float* const out_row = out_data + (row0 + r) * n;
+      for (int64_t j = 0; j < n; ++j) {
+        out_row[j] = out_row[j] * act_scales[r] + (bias ? bias[j] : 0.f);
+      }
+    }
+  }
+}
+
+} // namespace
+
+/**
+ * Linear layer with int8 weights and dynamically quantized activations.
+ * Each row of `in` (one token) is quantized to int8 with a symmetric scale
+ * computed from its absolute maximum, multiplied with the int8 weights in
+ * int32, and rescaled by the activation and weight scales. `weight_scales`
+ * holds one scale per output channel, or one per output channel and group of
+ * input features. Zero points are not supported: the weights are symmetric.
+ *
+ * in: [..., k] float, weight: [n, k] int8, weight_scales: [n] or [n, groups],
+ * bias: optional [n], out: [..., n] float.
+ */
+Tensor& quantized_linear_dynamic_int8_out(
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    Tensor& out) {
+  ET_CHECK(check_linear_dynamic_args(
+      in,
+      weight,
+      weight_scales,
+      opt_bias,
+      ScalarType::Char,
+      weight.size(1),
+      out));
+  resize_linear_dynamic_out(in, weight, out);
+
+  const int8_t* const w_data = weight.const_data_ptr<int8_t>();
+  const int64_t k = weight.size(1);
+  linear_dynamic(
+      in,
+      weight_scales,
+      opt_bias,
+      [w_data, k](const int8_t* q, int64_t j, int64_t k0, int64_t len) {
+        return dot_int8(q, w_data + j * k + k0, len);
+      },
+      out);
+  return out;
+}
+
+Tensor& quantized_linear_dynamic_int8_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    Tensor& out) {
+  (void)ctx;
+  return quantized_linear_dynamic_int8_out(
+      in, weight, weight_scales, opt_bias, out);
+}
+
+/**
+ * Same as linear_dynamic_int8, with int4 weights packed two per byte in the
+ * embedding_4bit layout: weight is [n, k / 2] uint8, the element at an even
+ * index in the high nibble, and every value stored as int4 + 8. Groups must
+ * hold an even number of input features.
+ */
+Tensor& quantized_linear_dynamic_int4_out(
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    Tensor& out) {
+  const int64_t k = 2 * weight.size(1);
+  ET_CHECK(check_linear_dynamic_args(
+      in, weight, weight_scales, opt_bias, ScalarType::Byte, k, out));
+  ET_CHECK_MSG(
+      weight_scales.dim() == 1 || (k / weight_scales.size(1)) % 2 == 0,
+      "int4 weight groups must hold an even number of elements");
+  resize_linear_dynamic_out(in, weight, out);
+
+  const uint8_t* const w_data = weight.const_data_ptr<uint8_t>();
+  linear_dynamic(
+      in,
+      weight_scales,
+      opt_bias,
+      [w_data, k](const int8_t* q, int64_t j, int64_t k0, int64_t len) {
+        // Chunks and groups start at even features, so k0 is byte aligned.
+        return dot_int8_int4(q, w_data + (j * k + k0) / 2, len);
+      },
+      out);
+  return out;
+}
+
+Tensor& quantized_linear_dynamic_int4_out(
+    RuntimeContext& ctx,
+    const Tensor& in,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const optional<Tensor>& opt_bias,
+    Tensor& out) {
+  (void)ctx;
+  return quantized_linear_dynamic_int4_out(
+      in, weight, weight_scales, opt_bias, out);
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
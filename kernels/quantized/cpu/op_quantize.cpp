@@ -6,11 +6,22 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/util/reduce_util.h>
+#include <executorch/kernels/portable/cpu/util/parallel_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <type_traits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 2)
+// Helium with floating point, e.g. Cortex-M55 and Cortex-M85.
+#include <arm_mve.h>
+#define ET_QUANTIZED_USE_MVE 1
+#endif
 
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
@@ -102,6 +113,225 @@ T quantize_val(
   return static_cast<T>(qvalue);
 }
 
+namespace {
+
+/**
+ * Quantizes `n` contiguous values that share a scale and zero point.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void quantize_block(
+    const CTYPE_IN* in,
+    CTYPE_OUT* out,
+    int64_t n,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = quantize_val<CTYPE_OUT, CTYPE_IN>(
+        scale, zero_point, in[i], quant_min, quant_max);
+  }
+}
+
+#if defined(__aarch64__) || defined(__AVX2__) || defined(ET_QUANTIZED_USE_MVE)
+/**
+ * Vectorized quantize_block() for float inputs and 8-bit outputs, which is
+ * what runs at delegate boundaries. Every step matches quantize_val(): the
+ * multiply by the float reciprocal of the scale, round half to even, the
+ * float add of the zero point, and the clamp, which is exact in float for
+ * 8-bit bounds.
+ */
+template <typename CTYPE_OUT>
+void quantize_float_block_8bit(
+    const float* in,
+    CTYPE_OUT* out,
+    int64_t n,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max) {
+  constexpr bool kIsSigned = std::is_signed<CTYPE_OUT>::value;
+  const float inv_scale = 1.0f / static_cast<float>(scale);
+  const float zero_point_f =
+      static_cast<float>(static_cast<int32_t>(zero_point));
+  int64_t i = 0;
+#if defined(__aarch64__)
+  const float32x4_t v_inv_scale = vdupq_n_f32(inv_scale);
+  const float32x4_t v_zero_point = vdupq_n_f32(zero_point_f);
+  const float32x4_t v_min = vdupq_n_f32(static_cast<float>(quant_min));
+  const float32x4_t v_max = vdupq_n_f32(static_cast<float>(quant_max));
+  for (; i + 16 <= n; i += 16) {
+    int32x4_t q[4];
+    for (int j = 0; j < 4; ++j) {
+      float32x4_t v = vmulq_f32(vld1q_f32(in + i + 4 * j), v_inv_scale);
+      v = vaddq_f32(vrndnq_f32(v), v_zero_point);
+      q[j] = vcvtq_s32_f32(vminq_f32(vmaxq_f32(v, v_min), v_max));
+    }
+    const int16x8_t lo = vcombine_s16(vqmovn_s32(q[0]), vqmovn_s32(q[1]));
+    const int16x8_t hi = vcombine_s16(vqmovn_s32(q[2]), vqmovn_s32(q[3]));
+    if (kIsSigned) {
+      vst1q_s8(
+          reinterpret_cast<int8_t*>(out + i),
+          vcombine_s8(vqmovn_s16(lo), vqmovn_s16(hi)));
+    } else {
+      vst1q_u8(
+          reinterpret_cast<uint8_t*>(out + i),
+          vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+    }
+  }
+#elif defined(ET_QUANTIZED_USE_MVE)
+  const float32x4_t v_min = vdupq_n_f32(static_cast<float>(quant_min));
+  const float32x4_t v_max = vdupq_n_f32(static_cast<float>(quant_max));
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t v = vmulq_n_f32(vld1q_f32(in + i), inv_scale);
+    v = vaddq_n_f32(vrndnq_f32(v), zero_point_f);
+    const int32x4_t q =
+        vcvtq_s32_f32(vminnmq_f32(vmaxnmq_f32(v, v_min), v_max));
+    // The values are within the 8-bit bounds, so the truncating byte stores
+    // are exact.
+    if (kIsSigned) {
+      vstrbq_s32(reinterpret_cast<int8_t*>(out + i), q);
+    } else {
+      vstrbq_u32(reinterpret_cast<uint8_t*>(out + i), vreinterpretq_u32_s32(q));
+    }
+  }
+#else
+  const __m256 v_inv_scale = _mm256_set1_ps(inv_scale);
+  const __m256 v_zero_point = _mm256_set1_ps(zero_point_f);
+  const __m256 v_min = _mm256_set1_ps(static_cast<float>(quant_min));
+  const __m256 v_max = _mm256_set1_ps(static_cast<float>(quant_max));
+  // The 32-bit to 8-bit packs interleave the 128-bit lanes.
+  const __m256i v_unshuffle = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  for (; i + 32 <= n; i += 32) {
+    __m256i q[4];
+    for (int j = 0; j < 4; ++j) {
+      __m256 v = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8 * j), v_inv_scale);
+      v = _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      v = _mm256_add_ps(v, v_zero_point);
+      q[j] = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(v, v_min), v_max));
+    }
+    const __m256i lo = _mm256_packs_epi32(q[0], q[1]);
+    const __m256i hi = _mm256_packs_epi32(q[2], q[3]);
+    const __m256i packed =
+        kIsSigned ? _mm256_packs_epi16(lo, hi) : _mm256_packus_epi16(lo, hi);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(out + i),
+        _mm256_permutevar8x32_epi32(packed, v_unshuffle));
+  }
+#endif
+  quantize_block<float, CTYPE_OUT>(
+      in + i, out + i, n - i, scale, zero_point, quant_min, quant_max);
+}
+
+void quantize_block(
+    const float* in,
+    uint8_t* out,
+    int64_t n,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max) {
+  quantize_float_block_8bit(
+      in, out, n, scale, zero_point, quant_min, quant_max);
+}
+
+void quantize_block(
+    const float* in,
+    int8_t* out,
+    int64_t n,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max) {
+  quantize_float_block_8bit(
+      in, out, n, scale, zero_point, quant_min, quant_max);
+}
+#endif
+
+/**
+ * Quantizes blocks of `inner` contiguous elements, where block `b` belongs to
+ * channel `b % channels`. The blocks are split across threads.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void quantize_per_channel_blocks(
+    const CTYPE_IN* in,
+    CTYPE_OUT* out,
+    int64_t outer,
+    int64_t channels,
+    int64_t inner,
+    const double* scale_data,
+    const int64_t* zero_point_data,
+    int64_t quant_min,
+    int64_t quant_max) {
+  parallel_for_each_chunk(
+      0, outer * channels, inner, [&](int64_t begin, int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          const int64_t channel = block % channels;
+          quantize_block(
+              in + block * inner,
+              out + block * inner,
+              inner,
+              scale_data[channel],
+              zero_point_data[channel],
+              quant_min,
+              quant_max);
+        }
+      });
+}
+
+/**
+ * Quantizes `input`, viewed as [outer, channels, inner], with one scale and
+ * zero point per channel.
+ */
+void quantize_per_channel_impl(
+    const Tensor& input,
+    const double* scale_data,
+    const int64_t* zero_point_data,
+    int64_t outer,
+    int64_t channels,
+    int64_t inner,
+    int64_t quant_min,
+    int64_t quant_max,
+    Tensor& out) {
+#define QUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype) \
+  case ScalarType::out_dtype:                         \
+    quantize_per_channel_blocks(                      \
+        input.const_data_ptr<CTYPE_IN>(),             \
+        out.mutable_data_ptr<CTYPE_OUT>(),            \
+        outer,                                        \
+        channels,                                     \
+        inner,                                        \
+        scale_data,                                   \
+        zero_point_data,                              \
+        quant_min,                                    \
+        quant_max);                                   \
+    break;
+#define CALCULATE_FLOAT_TYPE(CTYPE_IN, in_dtype)         \
+  case ScalarType::in_dtype:                             \
+    switch (out.scalar_type()) {                         \
+      ET_FORALL_INT_TYPES_WITH(CTYPE_IN, QUANTIZE_IMPL); \
+      default:                                           \
+        ET_CHECK_MSG(                                    \
+            false,                                       \
+            "Unhandled output dtype %" PRId8,            \
+            static_cast<int8_t>(out.scalar_type()));     \
+    }                                                    \
+    break;
+
+  switch (input.scalar_type()) {
+    ET_FORALL_FLOAT_TYPES(CALCULATE_FLOAT_TYPE);
+    default:
+      ET_CHECK_MSG(
+          false,
+          "Unhandled input dtype %" PRId8,
+          static_cast<int8_t>(input.scalar_type()));
+  }
+#undef CALCULATE_FLOAT_TYPE
+#undef QUANTIZE_IMPL
+}
+
+} // namespace
+
 Tensor& quantize_per_tensor_out(
     const Tensor& input,
     double scale,
@@ -118,15 +348,22 @@ Tensor& quantize_per_tensor_out(
   check_quantize_per_tensor_args(input, quant_min, quant_max, dtype, out);
 
   // calculate the quantized input
-#define QUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)          \
-  case ScalarType::out_dtype:                                  \
-    for (size_t i = 0; i < input.numel(); i++) {               \
-      IN_CTYPE value = input.const_data_ptr<IN_CTYPE>()[i];    \
-      out.mutable_data_ptr<OUT_CTYPE>()[i] =                   \
-          quantize_val<OUT_CTYPE, IN_CTYPE>(                   \
-              scale, zero_point, value, quant_min, quant_max); \
-    }                                                          \
-    break;
+#define QUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)                  \
+  case ScalarType::out_dtype: {                                        \
+    const IN_CTYPE* in_data = input.const_data_ptr<IN_CTYPE>();        \
+    OUT_CTYPE* out_data = out.mutable_data_ptr<OUT_CTYPE>();           \
+    parallel_for_each_chunk(                                           \
+        0, input.numel(), 1, [&](int64_t begin, int64_t end) {         \
+          quantize_block(                                              \
+              in_data + begin,                                         \
+              out_data + begin,                                        \
+              end - begin,                                             \
+              scale,                                                   \
+              zero_point,                                              \
+              quant_min,                                               \
+              quant_max);                                              \
+        });                                                            \
+  } break;
 #define CALCULATE_FLOAT_TYPE(IN_CTYPE, in_dtype)         \
   case ScalarType::in_dtype:                             \
     switch (out.scalar_type()) {                         \
@@ -278,72 +515,27 @@ Tensor& quantize_per_channel_out(
 
   check_quantize_per_tensor_args(input, quant_min, quant_max, dtype, out);
 
-  // a list contains all dimensions except axis
-  int64_t dims[input.dim() - 1];
-  for (int64_t i = 0; i < input.dim() - 1; i++) {
-    if (i < axis) {
-      dims[i] = i;
-    } else {
-      dims[i] = i - 1;
-    }
+  // View the input as [outer, channels, inner] around the axis, so that each
+  // channel is quantized in contiguous blocks of `inner` elements.
+  const int64_t channels = input.size(axis);
+  int64_t outer = 1;
+  for (int64_t i = 0; i < axis; i++) {
+    outer *= input.size(i);
   }
-  const double* scale_data = scale.const_data_ptr<double>();
-  const int64_t* zero_point_data = zero_point.const_data_ptr<int64_t>();
-
-  exec_aten::optional<exec_aten::ArrayRef<int64_t>> optional_dim_list{
-      exec_aten::ArrayRef<int64_t>{dims, size_t(input.dim() - 1)}};
-
-  // Actual quantization logic
-  // input, out are the input and output tensors
-  // channel_ix is the index along the axis dimension. 0 <= channel_ix <
-  // input.size(axis).
-  //   i.e. if the tensor has shape (N,C,H,W), axis being 1, then channel_ix
-  //   will be 0, 1, 2, ... C-1
-  // in_ix is the flat index of the element you are quantizing.
-  //   in other words you are quantizing in_data[in_ix]
-#define QUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype)                          \
-  case ScalarType::out_dtype:                                                  \
-    for (size_t channel_ix = 0; channel_ix < input.size(axis); ++channel_ix) { \
-      double _scale = scale_data[channel_ix];                                  \
-      int64_t _zero_point = zero_point_data[channel_ix];                       \
-      apply_over_dim_list(                                                     \
-          [input, out, _scale, _zero_point, quant_min, quant_max](             \
-              size_t in_ix) {                                                  \
-            out.mutable_data_ptr<CTYPE_OUT>()[in_ix] =                         \
-                quantize_val<CTYPE_OUT, CTYPE_IN>(                             \
-                    _scale,                                                    \
-                    _zero_point,                                               \
-                    input.const_data_ptr<CTYPE_IN>()[in_ix],                   \
-                    quant_min,                                                 \
-                    quant_max);                                                \
-          },                                                                   \
-          input,                                                               \
-          optional_dim_list,                                                   \
-          channel_ix);                                                         \
-    }                                                                          \
-    break;
-#define CALCULATE_FLOAT_TYPE(CTYPE_IN, in_dtype)         \
-  case ScalarType::in_dtype:                             \
-    switch (out.scalar_type()) {                         \
-      ET_FORALL_INT_TYPES_WITH(CTYPE_IN, QUANTIZE_IMPL); \
-      default:                                           \
-        ET_CHECK_MSG(                                    \
-            false,                                       \
-            "Unhandled output dtype %" PRId8,            \
-            static_cast<int8_t>(out.scalar_type()));     \
-    }                                                    \
-    break;
-
-  switch (input.scalar_type()) {
-    ET_FORALL_FLOAT_TYPES(CALCULATE_FLOAT_TYPE);
-    default:
-      ET_CHECK_MSG(
-          false,
-          "Unhandled input dtype %" PRId8,
-          static_cast<int8_t>(input.scalar_type()));
+  int64_t inner = 1;
+  for (int64_t i = axis + 1; i < input.dim(); i++) {
+    inner *= input.size(i);
   }
-#undef CALCULATE_FLOAT_TYPE
-#undef QUANTIZE_IMPL
+  quantize_per_channel_impl(
+      input,
+      scale.const_data_ptr<double>(),
+      zero_point.const_data_ptr<int64_t>(),
+      outer,
+      channels,
+      inner,
+      quant_min,
+      quant_max,
+      out);
 
   return out;
 }
@@ -362,6 +554,80 @@ Tensor& quantize_per_channel_out(
   return quantize_per_channel_out(
       input, scale, zero_point, axis, quant_min, quant_max, dtype, out);
 }
+
+/**
+ * Quantizes each token of the input, i.e. each slice along its last
+ * dimension, with its own scale and zero point, as computed by
+ * choose_qparams_per_token_asymmetric. `scale` and `zero_point` hold one
+ * value per token, typically with the input's shape and a last dimension of
+ * size 1.
+ */
+Tensor& quantize_per_token_out(
+    const Tensor& input,
+    const Tensor& scale,
+    const Tensor& zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    ScalarType dtype,
+    Tensor& out) {
+  torch::executor::Error err = resize_tensor(out, input.sizes());
+  ET_CHECK_MSG(
+      err == torch::executor::Error::Ok,
+      "Failed to resize out Tensor in quantize_per_token_out");
+
+  const int64_t token_size = input.dim() > 0 ? input.size(input.dim() - 1) : 1;
+  const int64_t num_tokens = token_size > 0 ? input.numel() / token_size : 0;
+
+  ET_CHECK_MSG(
+      scale.scalar_type() == ScalarType::Double,
+      "scale.scalar_type() %" PRId8 " is not double type",
+      static_cast<int8_t>(scale.scalar_type()));
+
+  ET_CHECK_MSG(
+      scale.numel() == num_tokens,
+      "scale.numel() %zd != number of tokens %zd",
+      ssize_t(scale.numel()),
+      ssize_t(num_tokens));
+
+  ET_CHECK_MSG(
+      zero_point.scalar_type() == ScalarType::Long,
+      "zero_point.scalar_type() %" PRId8 " is not integer type",
+      static_cast<int8_t>(zero_point.scalar_type()));
+
+  ET_CHECK_MSG(
+      zero_point.numel() == num_tokens,
+      "zero_point.numel() %zd != number of tokens %zd",
+      ssize_t(zero_point.numel()),
+      ssize_t(num_tokens));
+
+  check_quantize_per_tensor_args(input, quant_min, quant_max, dtype, out);
+
+  quantize_per_channel_impl(
+      input,
+      scale.const_data_ptr<double>(),
+      zero_point.const_data_ptr<int64_t>(),
+      /*outer=*/1,
+      /*channels=*/num_tokens,
+      /*inner=*/token_size,
+      quant_min,
+      quant_max,
+      out);
+  return out;
+}
+
+Tensor& quantize_per_token_out(
+    RuntimeContext& context,
+    const Tensor& input,
+    const Tensor& scale,
+    const Tensor& zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    ScalarType dtype,
+    Tensor& out) {
+  (void)context;
+  return quantize_per_token_out(
+      input, scale, zero_point, quant_min, quant_max, dtype, out);
+}
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -8,16 +8,13 @@ _QUANT_OPS = (
     op_target(
         name = "op_choose_qparams",
         deps = [
-            "//executorch/kernels/portable/cpu:vec_ops",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
         ],
     ),
     op_target(
         name = "op_dequantize",
         deps = [
-            "//executorch/kernels/portable/cpu/util:reduce_util",
-        ],
-        _aten_mode_deps = [
-            "//executorch/kernels/portable/cpu/util:reduce_util_aten",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
         ],
     ),
     op_target(
@@ -26,6 +23,9 @@ _QUANT_OPS = (
     op_target(
         name = "op_embedding4b",
     ),
+    op_target(
+        name = "op_linear_dynamic",
+    ),
     op_target(
         name = "op_mixed_mm",
         deps = [
@@ -41,10 +41,7 @@ _QUANT_OPS = (
     op_target(
         name = "op_quantize",
         deps = [
-            "//executorch/kernels/portable/cpu/util:reduce_util",
-        ],
-        _aten_mode_deps = [
-            "//executorch/kernels/portable/cpu/util:reduce_util_aten",
+            "//executorch/kernels/portable/cpu/util:parallel_util",
         ],
     ),
 )
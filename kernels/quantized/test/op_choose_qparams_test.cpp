@@ -21,6 +21,7 @@ using exec_aten::ArrayRef;
 using exec_aten::Scalar;
 using exec_aten::ScalarType;
 using exec_aten::Tensor;
+using torch::executor::native::choose_qparams_per_token_asymmetric_out;
 using torch::executor::native::choose_qparams_tensor_out;
 using torch::executor::testing::TensorFactory;
 
@@ -51,3 +52,22 @@ void test_dtype() {
 TEST(OpQuantizeOutTest, AllDtypesSupported) {
   test_dtype<ScalarType::Byte>();
 }
+
+TEST(OpChooseQparamsPerTokenAsymmetricOutTest, Float) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Double> tf_double;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  Tensor input = tf_float.make({2, 3}, {1.0, 2.0, 3.0, -2.0, 0.0, 6.0});
+  Tensor scale_out = tf_double.zeros({2, 1});
+  Tensor zero_point_out = tf_long.zeros({2, 1});
+  // [0, 3] and [-2, 6] mapped onto [-128, 127].
+  Tensor expected_scale = tf_double.make({2, 1}, {3.0 / 255, 8.0 / 255});
+  Tensor expected_zero_point = tf_long.make({2, 1}, {-128, -64});
+
+  choose_qparams_per_token_asymmetric_out(
+      input, ScalarType::Float, scale_out, zero_point_out);
+
+  EXPECT_TENSOR_CLOSE(scale_out, expected_scale);
+  EXPECT_TENSOR_EQ(zero_point_out, expected_zero_point);
+}
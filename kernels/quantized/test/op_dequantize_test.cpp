@@ -25,6 +25,7 @@ using exec_aten::Tensor;
 using torch::executor::native::dequantize_per_channel_out;
 using torch::executor::native::dequantize_per_tensor_out;
 using torch::executor::native::dequantize_per_tensor_tensor_args_out;
+using torch::executor::native::dequantize_per_token_out;
 using torch::executor::testing::TensorFactory;
 
 /// A generic smoke test that works for any dtype that supports ones() and
@@ -164,3 +165,89 @@ TEST(OpDequantizeOutTest, DequantizePerChannel) {
 
   EXPECT_TENSOR_EQ(out, expected);
 }
+
+TEST(OpDequantizeOutTest, DequantizePerTensorMatchesScalar) {
+  TensorFactory<ScalarType::Char> tf_char;
+  TensorFactory<ScalarType::Float> tfo;
+
+  // Long enough to cover the vectorized loop and a scalar tail.
+  std::vector<int8_t> input_data(100);
+  std::vector<float> expected_data(input_data.size());
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<int8_t>(i * 5 - 128);
+    expected_data[i] = (input_data[i] - 3) * 0.1f;
+  }
+  Tensor input = tf_char.make({100}, input_data);
+  Tensor expected = tfo.make({100}, expected_data);
+
+  Tensor out = tfo.zeros({100});
+  dequantize_per_tensor_out(
+      input,
+      /*scale=*/0.1,
+      /*zero_point=*/3,
+      /*quant_min=*/-128,
+      /*quant_max=*/127,
+      ScalarType::Char,
+      optional<ScalarType>(),
+      out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
+
+TEST(OpDequantizeOutTest, DequantizePerChannelInnerAxis) {
+  TensorFactory<ScalarType::Byte> tf_byte;
+  TensorFactory<ScalarType::Double> tf_double;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  Tensor input = tf_byte.full({2, 3, 2}, 100);
+  Tensor scale = tf_double.make({3}, {0.5, 0.75, 1});
+  Tensor zero_point = tf_long.make({3}, {30, 50, 60});
+
+  TensorFactory<ScalarType::Float> tfo;
+  Tensor out = tfo.zeros({2, 3, 2});
+  // (100 - 30) * 0.5
+  // (100 - 50) * 0.75
+  // (100 - 60) * 1
+  Tensor expected = tfo.make(
+      {2, 3, 2}, {35, 35, 37.5, 37.5, 40, 40, 35, 35, 37.5, 37.5, 40, 40});
+  dequantize_per_channel_out(
+      input,
+      scale,
+      zero_point,
+      /*axis=*/1,
+      /*quant_min=*/0,
+      /*quant_max=*/255,
+      ScalarType::Byte,
+      optional<ScalarType>(),
+      out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
+
+TEST(OpDequantizeOutTest, DequantizePerToken) {
+  TensorFactory<ScalarType::Char> tf_char;
+  TensorFactory<ScalarType::Double> tf_double;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  Tensor input = tf_char.full({3, 2}, 20);
+  Tensor scale = tf_double.make({3, 1}, {0.5, 0.75, 1});
+  Tensor zero_point = tf_long.make({3, 1}, {-10, 4, 20});
+
+  TensorFactory<ScalarType::Float> tfo;
+  Tensor out = tfo.zeros({3, 2});
+  // (20 + 10) * 0.5
+  // (20 - 4) * 0.75
+  // (20 - 20) * 1
+  Tensor expected = tfo.make({3, 2}, {15, 15, 12, 12, 0, 0});
+  dequantize_per_token_out(
+      input,
+      scale,
+      zero_point,
+      /*quant_min=*/-128,
+      /*quant_max=*/127,
+      ScalarType::Char,
+      ScalarType::Float,
+      out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/quantized/NativeFunctions.h> // Declares the quantized operator
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/test/utils/DeathTest.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace ::testing;
+using exec_aten::optional;
+using exec_aten::RuntimeContext;
+using exec_aten::ScalarType;
+using exec_aten::Tensor;
+using torch::executor::native::quantized_linear_dynamic_int4_out;
+using torch::executor::native::quantized_linear_dynamic_int8_out;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+// Packs int4 values two per byte, the even element in the high nibble.
+std::vector<uint8_t> pack_int4(const std::vector<int>& values) {
+  std::vector<uint8_t> packed(values.size() / 2);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    packed[i] = ((values[2 * i] + 8) << 4) | (values[2 * i + 1] + 8);
+  }
+  return packed;
+}
+
+} // namespace
+
+class OpQuantizedLinearDynamicTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    torch::executor::runtime_init();
+  }
+};
+
+// Every row's absolute maximum is 127 times a power of two, so the
+// activations quantize exactly and the result matches a float linear.
+TEST_F(OpQuantizedLinearDynamicTest, Int8PerChannelWithBias) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tf_char;
+
+  Tensor input = tf.make({2, 4}, {127, -64, 32, 1, -254, 126, 0, 2});
+  Tensor weight =
+      tf_char.make({3, 4}, {1, 2, 3, 4, -1, 0, 1, 0, 5, -5, 2, -2});
+  Tensor weight_scales = tf.make({3}, {0.5, 1, 0.25});
+  optional<Tensor> bias = tf.make({3}, {1, 2, 3});
+  Tensor out = tf.zeros({2, 3});
+
+  RuntimeContext ctx{};
+  quantized_linear_dynamic_int8_out(
+      ctx, input, weight, weight_scales, bias, out);
+
+  Tensor expected =
+      tf.make({2, 3}, {50.5, -93, 257.25, 4, 256, -473});
+  EXPECT_TENSOR_CLOSE(out, expected);
+}
+
+TEST_F(OpQuantizedLinearDynamicTest, Int4PerGroup) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Byte> tf_byte;
+
+  Tensor input = tf.make({1, 4}, {127, -64, 32, 1});
+  Tensor weight =
+      tf_byte.make({2, 2}, pack_int4({1, -2, 3, -8, 7, 0, -1, 2}));
+  Tensor weight_scales = tf.make({2, 2}, {0.5, 0.25, 1, 2});
+  Tensor out = tf.zeros({1, 2});
+
+  RuntimeContext ctx{};
+  quantized_linear_dynamic_int4_out(
+      ctx, input, weight, weight_scales, optional<Tensor>(), out);
+
+  Tensor expected = tf.make({1, 2}, {149.5, 829});
+  EXPECT_TENSOR_CLOSE(out, expected);
+}
+
+// Long enough rows to take the vectorized dot products, with groups that
+// are not a multiple of the vector width.
+TEST_F(OpQuantizedLinearDynamicTest, LongRowsMatchReference) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tf_char;
+  TensorFactory<ScalarType::Byte> tf_byte;
+
+  constexpr int m = 3;
+  constexpr int k = 120;
+  constexpr int n = 5;
+  constexpr int groups = 4;
+
+  std::vector<float> in_data(m * k);
+  for (int i = 0; i < m * k; ++i) {
+    in_data[i] = (i * 53) % 255 - 127;
+  }
+  // The largest magnitude of every row is 127.
+  for (int i = 0; i < m; ++i) {
+    in_data[i * k] = 127;
+  }
+  std::vector<int8_t> w8(n * k);
+  std::vector<int> w4(n * k);
+  for (int i = 0; i < n * k; ++i) {
+    w8[i] = (i * 29) % 255 - 127;
+    w4[i] = (i * 7) % 16 - 8;
+  }
+  std::vector<float> scales(n * groups);
+  for (int i = 0; i < n * groups; ++i) {
+    scales[i] = 0.125 * (1 + i % 3);
+  }
+
+  std::vector<float> expected8(m * n, 0);
+  std::vector<float> expected4(m * n, 0);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int l = 0; l < k; ++l) {
+        const float s = scales[j * groups + l / (k / groups)];
+        expected8[i * n + j] += in_data[i * k + l] * w8[j * k + l] * s;
+        expected4[i * n + j] += in_data[i * k + l] * w4[j * k + l] * s;
+      }
+    }
+  }
+
+  Tensor input = tf.make({m, k}, in_data);
+  Tensor weight_scales = tf.make({n, groups}, scales);
+  RuntimeContext ctx{};
+
+  Tensor out8 = tf.zeros({m, n});
+  quantized_linear_dynamic_int8_out(
+      ctx,
+      input,
+      tf_char.make({n, k}, w8),
+      weight_scales,
+      optional<Tensor>(),
+      out8);
+  EXPECT_TENSOR_CLOSE(out8, tf.make({m, n}, expected8));
+
+  Tensor out4 = tf.zeros({m, n});
+  quantized_linear_dynamic_int4_out(
+      ctx,
+      input,
+      tf_byte.make({n, k / 2}, pack_int4(w4)),
+      weight_scales,
+      optional<Tensor>(),
+      out4);
+  EXPECT_TENSOR_CLOSE(out4, tf.make({m, n}, expected4));
+}
+
+TEST_F(OpQuantizedLinearDynamicTest, MismatchedFeaturesDies) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tf_char;
+
+  Tensor input = tf.ones({1, 4});
+  Tensor weight = tf_char.ones({2, 3});
+  Tensor weight_scales = tf.ones({2});
+  Tensor out = tf.zeros({1, 2});
+
+  RuntimeContext ctx{};
+  ET_EXPECT_DEATH(
+      quantized_linear_dynamic_int8_out(
+          ctx, input, weight, weight_scales, optional<Tensor>(), out),
+      "");
+}
@@ -14,6 +14,7 @@
 #include <executorch/test/utils/DeathTest.h>
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <limits>
 
 using namespace ::testing;
@@ -24,6 +25,7 @@ using exec_aten::Tensor;
 using torch::executor::native::quantize_per_channel_out;
 using torch::executor::native::quantize_per_tensor_out;
 using torch::executor::native::quantize_per_tensor_tensor_args_out;
+using torch::executor::native::quantize_per_token_out;
 using torch::executor::testing::TensorFactory;
 
 /// A generic smoke test that works for any dtype that supports ones() and
@@ -136,3 +138,81 @@ TEST(OpQuantizeOutTest, QuantizePerChannel) {
 
   EXPECT_TENSOR_EQ(out, expected);
 }
+
+TEST(OpQuantizeOutTest, QuantizePerTensorMatchesScalar) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Char> tfo;
+
+  // Long enough to cover the vectorized loop and a scalar tail, including
+  // values exactly halfway between two integers and values that clamp.
+  std::vector<float> input_data(131);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = (static_cast<float>(i) - 65.0f) * 0.625f;
+  }
+  Tensor input = tf_float.make({131}, input_data);
+  double scale = 0.25;
+  int64_t zero_point = 3;
+  int64_t quant_min = -128;
+  int64_t quant_max = 127;
+
+  std::vector<int8_t> expected_data(input_data.size());
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    float q = std::nearbyint(input_data[i] / 0.25f) + zero_point;
+    expected_data[i] = static_cast<int8_t>(
+        std::min<float>(std::max<float>(q, quant_min), quant_max));
+  }
+  Tensor expected = tfo.make({131}, expected_data);
+
+  Tensor out = tfo.zeros({131});
+  quantize_per_tensor_out(
+      input, scale, zero_point, quant_min, quant_max, ScalarType::Char, out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
+
+TEST(OpQuantizeOutTest, QuantizePerChannelInnerAxis) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Double> tf_double;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  Tensor input = tf_float.full({2, 3, 2}, 4);
+  Tensor scale = tf_double.make({3}, {0.5, 1, 2});
+  Tensor zero_point = tf_long.make({3}, {127, 63, 10});
+  int64_t quant_min = 0;
+  int64_t quant_max = 255;
+
+  TensorFactory<ScalarType::Byte> tfo;
+  Tensor out = tfo.zeros({2, 3, 2});
+  // 4 / 0.5 + 127
+  // 4 / 1 + 63
+  // 4 / 2 + 10
+  Tensor expected = tfo.make(
+      {2, 3, 2}, {135, 135, 67, 67, 12, 12, 135, 135, 67, 67, 12, 12});
+  quantize_per_channel_out(
+      input, scale, zero_point, 1, quant_min, quant_max, ScalarType::Byte, out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
+
+TEST(OpQuantizeOutTest, QuantizePerToken) {
+  TensorFactory<ScalarType::Float> tf_float;
+  TensorFactory<ScalarType::Double> tf_double;
+  TensorFactory<ScalarType::Long> tf_long;
+
+  Tensor input = tf_float.full({3, 2}, 4);
+  Tensor scale = tf_double.make({3, 1}, {0.5, 1, 2});
+  Tensor zero_point = tf_long.make({3, 1}, {7, -3, 0});
+  int64_t quant_min = -128;
+  int64_t quant_max = 127;
+
+  TensorFactory<ScalarType::Char> tfo;
+  Tensor out = tfo.zeros({3, 2});
+  // 4 / 0.5 + 7
+  // 4 / 1 - 3
+  // 4 / 2 + 0
+  Tensor expected = tfo.make({3, 2}, {15, 15, 1, 1, 2, 2});
+  quantize_per_token_out(
+      input, scale, zero_point, quant_min, quant_max, ScalarType::Char, out);
+
+  EXPECT_TENSOR_EQ(out, expected);
+}
@@ -26,6 +26,11 @@ def define_common_targets():
         "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
     ])
     op_test("op_embedding4b_test", kernel_name = "quantized")
+    op_test("op_linear_dynamic_test", kernel_name = "quantized", deps = [
+        "//executorch/kernels/quantized/cpu:op_linear_dynamic",
+        "//executorch/kernels/quantized:generated_lib_headers",
+        "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+    ])
     op_test("op_mixed_mm_test", kernel_name = "quantized", deps = [
         "//executorch/kernels/quantized/cpu:op_mixed_mm",
         "//executorch/kernels/quantized:generated_lib_headers",
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Times every kernel library's implementation of a set of operators, on
+ * shapes taken from the models in examples/models, and reports the time per
+ * call along with the effective memory bandwidth and arithmetic throughput.
+ * Each case runs the portable kernel, the optimized kernel and, where there
+ * is one, the quantized kernel computing the same layer, so that kernel work
+ * can be measured and regressions caught per operator.
+ *
+ * Usage: kernel_benchmark [filter] [min_seconds]
+ *
+ * Only the cases whose name contains `filter` run, and each variant repeats
+ * for at least `min_seconds` (0.2 by default).
+ */
+
+#include <executorch/extension/memory_allocator/temp_memory_allocator.h>
+#include <executorch/kernels/optimized/NativeFunctions.h> // Declares the optimized operators
+#include <executorch/kernels/portable/NativeFunctions.h> // Declares the portable operators
+#include <executorch/kernels/quantized/NativeFunctions.h> // Declares the quantized operators
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using exec_aten::ArrayRef;
+using exec_aten::optional;
+using exec_aten::RuntimeContext;
+using exec_aten::ScalarType;
+using exec_aten::Tensor;
+using torch::executor::Error;
+using torch::executor::runtime_init;
+using torch::executor::testing::TensorFactory;
+
+namespace native = torch::executor::native;
+
+namespace {
+
+/// One kernel library's implementation of a case.
+struct Variant {
+  const char* library;
+  std::function<void(RuntimeContext&)> run;
+};
+
+/**
+ * An operator call on fixed inputs. `bytes` and `flops` are the essential
+ * memory traffic and arithmetic of the call, which every variant is measured
+ * against.
+ */
+struct Case {
+  std::string name;
+  double bytes;
+  double flops;
+  std::vector<Variant> variants;
+};
+
+std::mt19937 rng(0);
+
+template <ScalarType DTYPE>
+Tensor random_tensor(
+    TensorFactory<DTYPE>& tf,
+    const std::vector<int32_t>& sizes,
+    double lo = -1,
+    double hi = 1) {
+  using CTYPE = typename TensorFactory<DTYPE>::ctype;
+  size_t numel = 1;
+  for (const int32_t size : sizes) {
+    numel *= size;
+  }
+  std::uniform_real_distribution<double> dist(lo, hi);
+  std::vector<CTYPE> data(numel);
+  for (CTYPE& value : data) {
+    value = static_cast<CTYPE>(dist(rng));
+  }
+  return tf.make(sizes, data);
+}
+
+double seconds_since(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * Runs `variant` until at least `min_seconds` have passed and returns the
+ * mean seconds per call, or a negative value if the kernel failed.
+ */
+double time_variant(const Variant& variant, const double min_seconds) {
+  // Scratch memory is reset after every call, as the method does, so after
+  // the warm-up the kernels are not timed allocating it.
+  torch::executor::util::TempMemoryAllocator temp_allocator;
+  RuntimeContext ctx(nullptr, &temp_allocator);
+  // Warm up the caches and the threadpool, and check that the kernel
+  // accepts the inputs.
+  variant.run(ctx);
+  temp_allocator.reset();
+  if (ctx.failure_state() != Error::Ok) {
+    return -1;
+  }
+  size_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  do {
+    variant.run(ctx);
+    temp_allocator.reset();
+    ++iterations;
+    elapsed = seconds_since(start);
+  } while (elapsed < min_seconds || iterations < 3);
+  return elapsed / iterations;
+}
+
+// Tensor factories own the memory of the tensors they make, so they live as
+// long as the cases.
+TensorFactory<ScalarType::Float> tf_float;
+TensorFactory<ScalarType::Char> tf_char;
+TensorFactory<ScalarType::Long> tf_long;
+
+void add_elementwise_cases(std::vector<Case>& cases) {
+  // MobileNetV2 residual connection.
+  {
+    const std::vector<int32_t> sizes = {1, 24, 56, 56};
+    const Tensor a = random_tensor(tf_float, sizes);
+    const Tensor b = random_tensor(tf_float, sizes);
+    Tensor out = tf_float.zeros(sizes);
+    const double n = a.numel();
+    cases.push_back(
+        {"add.out/mobilenet_v2_residual",
+         3 * n * sizeof(float),
+         n,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::add_out(ctx, a, b, 1, out);
+           }},
+          {"optimized", [=](RuntimeContext& ctx) mutable {
+             native::opt_add_out(ctx, a, b, 1, out);
+           }}}});
+  }
+  // Llama feed-forward gate, w1(x) * w3(x), for a 128 token prompt of
+  // stories110M.
+  {
+    const std::vector<int32_t> sizes = {128, 2048};
+    const Tensor a = random_tensor(tf_float, sizes);
+    const Tensor b = random_tensor(tf_float, sizes);
+    Tensor out = tf_float.zeros(sizes);
+    const double n = a.numel();
+    cases.push_back(
+        {"mul.out/llama_ffn_gate",
+         3 * n * sizeof(float),
+         n,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::mul_out(ctx, a, b, out);
+           }},
+          {"optimized", [=](RuntimeContext& ctx) mutable {
+             native::opt_mul_out(ctx, a, b, out);
+           }}}});
+  }
+  // ViT-B/16 MLP activation.
+  {
+    const std::vector<int32_t> sizes = {197, 3072};
+    const Tensor in = random_tensor(tf_float, sizes, -3, 3);
+    Tensor out = tf_float.zeros(sizes);
+    const double n = in.numel();
+    cases.push_back(
+        {"gelu.out/vit_mlp",
+         2 * n * sizeof(float),
+         // One tanh or erf per element, counted as a single operation.
+         n,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::gelu_out(ctx, in, "none", out);
+           }},
+          {"optimized", [=](RuntimeContext& ctx) mutable {
+             native::opt_gelu_out(ctx, in, "none", out);
+           }}}});
+  }
+}
+
+void add_matmul_cases(std::vector<Case>& cases) {
+  // A stories110M attention projection over a 32 token prompt. The
+  // quantized variant is the same layer with int8 weights.
+  {
+    const int32_t M = 32, K = 768, N = 768;
+    const Tensor in = random_tensor(tf_float, {M, K});
+    const Tensor weight_t = random_tensor(tf_float, {K, N});
+    const Tensor q_weight = random_tensor(tf_char, {N, K}, -127, 127);
+    const Tensor q_scales = random_tensor(tf_float, {N}, 0.001, 0.01);
+    Tensor out = tf_float.zeros({M, N});
+    cases.push_back(
+        {"mm.out/llama_attention_proj",
+         (M * K + K * N + M * N) * sizeof(float),
+         2.0 * M * K * N,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::mm_out(ctx, in, weight_t, out);
+           }},
+          {"optimized",
+           [=](RuntimeContext& ctx) mutable {
+             native::opt_mm_out(ctx, in, weight_t, out);
+           }},
+          {"quantized", [=](RuntimeContext& ctx) mutable {
+             native::quantized_linear_dynamic_int8_out(
+                 ctx, in, q_weight, q_scales, optional<Tensor>(), out);
+           }}}});
+  }
+  // stories110M attention scores, q @ k^T over 12 heads and 128 positions.
+  {
+    const int32_t B = 12, M = 128, K = 64, N = 128;
+    const Tensor q = random_tensor(tf_float, {B, M, K});
+    const Tensor k_t = random_tensor(tf_float, {B, K, N});
+    Tensor out = tf_float.zeros({B, M, N});
+    cases.push_back(
+        {"bmm.out/llama_attention_scores",
+         B * (M * K + K * N + M * N) * sizeof(float),
+         2.0 * B * M * K * N,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::bmm_out(ctx, q, k_t, out);
+           }},
+          {"optimized", [=](RuntimeContext& ctx) mutable {
+             native::opt_bmm_out(ctx, q, k_t, out);
+           }}}});
+  }
+}
+
+void add_conv_cases(std::vector<Case>& cases) {
+  struct ConvShape {
+    const char* name;
+    int32_t C, H, W, OC, kernel, stride, padding, groups;
+  };
+  const ConvShape shapes[] = {
+      // The expansion of a MobileNetV2 inverted residual block.
+      {"mobilenet_v2_pointwise", 24, 56, 56, 144, 1, 1, 0, 1},
+      // Its depthwise convolution.
+      {"mobilenet_v2_depthwise", 144, 56, 56, 144, 3, 1, 1, 144},
+      // A 3x3 convolution of the second ResNet-50 stage.
+      {"resnet_3x3", 128, 28, 28, 128, 3, 1, 1, 1},
+  };
+  for (const ConvShape& s : shapes) {
+    const int32_t out_H = (s.H + 2 * s.padding - s.kernel) / s.stride + 1;
+    const int32_t out_W = (s.W + 2 * s.padding - s.kernel) / s.stride + 1;
+    const Tensor in = random_tensor(tf_float, {1, s.C, s.H, s.W});
+    const Tensor weight = random_tensor(
+        tf_float, {s.OC, s.C / s.groups, s.kernel, s.kernel});
+    const optional<Tensor> bias(random_tensor(tf_float, {s.OC}));
+    Tensor out = tf_float.zeros({1, s.OC, out_H, out_W});
+    const std::vector<int64_t> stride = {s.stride, s.stride};
+    const std::vector<int64_t> padding = {s.padding, s.padding};
+    const std::vector<int64_t> dilation = {1, 1};
+    const std::vector<int64_t> output_padding = {0, 0};
+    const int64_t groups = s.groups;
+    const auto run = [=](auto kernel) {
+      return [=](RuntimeContext& ctx) mutable {
+        kernel(
+            ctx,
+            in,
+            weight,
+            bias,
+            ArrayRef<int64_t>(stride.data(), stride.size()),
+            ArrayRef<int64_t>(padding.data(), padding.size()),
+            ArrayRef<int64_t>(dilation.data(), dilation.size()),
+            false,
+            ArrayRef<int64_t>(output_padding.data(), output_padding.size()),
+            groups,
+            out);
+      };
+    };
+    const double macs = static_cast<double>(out.numel()) *
+        (s.C / s.groups) * s.kernel * s.kernel;
+    cases.push_back(
+        {std::string("convolution.out/") + s.name,
+         (in.numel() + weight.numel() + out.numel()) * sizeof(float),
+         2 * macs,
+         {{"portable", run(native::convolution_out)},
+          {"optimized", run(native::opt_convolution_out)}}});
+  }
+}
+
+void add_normalization_cases(std::vector<Case>& cases) {
+  // ViT-B/16 attention probabilities over 12 heads of 197 tokens.
+  {
+    const std::vector<int32_t> sizes = {12, 197, 197};
+    const Tensor in = random_tensor(tf_float, sizes, -4, 4);
+    Tensor out = tf_float.zeros(sizes);
+    const double n = in.numel();
+    cases.push_back(
+        {"_softmax.out/vit_attention",
+         2 * n * sizeof(float),
+         // max, exp, sum and scale per element.
+         4 * n,
+         {{"portable",
+           [=](RuntimeContext& ctx) mutable {
+             native::softmax_out(ctx, in, -1, false, out);
+           }},
+          {"optimized", [=](RuntimeContext& ctx) mutable {
+             native::opt_softmax_out(ctx, in, -1, false, out);
+           }}}});
+  }
+  // ViT-B/16 pre-attention layer norm.
+  {
+    const int32_t T = 197, D = 768;
+    const Tensor in = random_tensor(tf_float, {T, D});
+    const optional<Tensor> weight(random_tensor(tf_float, {D}));
+    const optional<Tensor> bias(random_tensor(tf_float, {D}));
+    Tensor out = tf_float.zeros({T, D});
+    Tensor mean = tf_float.zeros({T, 1});
+    Tensor rstd = tf_float.zeros({T, 1});
+    const std::vector<int64_t> normalized_shape = {D};
+    const auto run = [=](auto kernel) {
+      return [=](RuntimeContext& ctx) mutable {
+        kernel(
+            ctx,
+            in,
+            ArrayRef<int64_t>(normalized_shape.data(), normalized_shape.size()),
+            weight,
+            bias,
+            1e-6,
+            out,
+            mean,
+            rstd);
+      };
+    };
+    const double n = in.numel();
+    cases.push_back(
+        {"native_layer_norm.out/vit",
+         2 * n * sizeof(float),
+         // Moments, then scale and shift.
+         5 * n,
+         {{"portable", run(native::native_layer_norm_out)},
+          {"optimized", run(native::opt_native_layer_norm_out)}}});
+  }
+}
+
+void add_pooling_cases(std::vector<Case>& cases) {
+  // The max pooling of the ResNet stem.
+  const Tensor in = random_tensor(tf_float, {1, 64, 112, 112});
+  Tensor out = tf_float.zeros({1, 64, 56, 56});
+  Tensor indices = tf_long.zeros({1, 64, 56, 56});
+  const std::vector<int64_t> kernel_size = {3, 3};
+  const std::vector<int64_t> stride = {2, 2};
+  const std::vector<int64_t> padding = {1, 1};
+  const std::vector<int64_t> dilation = {1, 1};
+  const auto run = [=](auto kernel) {
+    return [=](RuntimeContext& ctx) mutable {
+      kernel(
+          ctx,
+          in,
+          ArrayRef<int64_t>(kernel_size.data(), kernel_size.size()),
+          ArrayRef<int64_t>(stride.data(), stride.size()),
+          ArrayRef<int64_t>(padding.data(), padding.size()),
+          ArrayRef<int64_t>(dilation.data(), dilation.size()),
+          false,
+          out,
+          indices);
+    };
+  };
+  cases.push_back(
+      {"max_pool2d_with_indices.out/resnet_stem",
+       in.numel() * sizeof(float) +
+           out.numel() * (sizeof(float) + sizeof(int64_t)),
+       out.numel() * 9.0,
+       {{"portable", run(native::max_pool2d_with_indices_out)},
+        {"optimized", run(native::opt_max_pool2d_with_indices_out)}}});
+}
+
+void add_embedding_cases(std::vector<Case>& cases) {
+  // The token embedding of a 128 token stories110M prompt. The quantized
+  // variant looks the rows up in an int8 table with a scale per row.
+  const int32_t V = 32000, D = 768, T = 128;
+  const Tensor weight = random_tensor(tf_float, {V, D});
+  const Tensor q_weight = random_tensor(tf_char, {V, D}, -127, 127);
+  const Tensor q_scales = random_tensor(tf_float, {V}, 0.001, 0.01);
+  const Tensor tokens = random_tensor(tf_long, {1, T}, 0, V - 1);
+  Tensor out = tf_float.zeros({1, T, D});
+  cases.push_back(
+      {"embedding.out/llama_tokens",
+       2.0 * T * D * sizeof(float),
+       0,
+       {{"portable",
+         [=](RuntimeContext& ctx) mutable {
+           native::embedding_out(ctx, weight, tokens, -1, false, false, out);
+         }},
+        {"quantized", [=](RuntimeContext& ctx) mutable {
+           native::quantized_embedding_byte_out(
+               ctx, q_weight, q_scales, optional<Tensor>(), -128, 127, tokens,
+               out);
+         }}}});
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  runtime_init();
+  const char* const filter = argc > 1 ? argv[1] : "";
+  const double min_seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 0.2;
+
+  std::vector<Case> cases;
+  add_elementwise_cases(cases);
+  add_matmul_cases(cases);
+  add_conv_cases(cases);
+  add_normalization_cases(cases);
+  add_pooling_cases(cases);
+  add_embedding_cases(cases);
+
+  std::printf(
+      "%-42s %-10s %12s %10s %10s %9s\n",
+      "case",
+      "library",
+      "us/call",
+      "GB/s",
+      "GFLOP/s",
+      "speedup");
+  for (const Case& c : cases) {
+    if (c.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    double portable_seconds = 0;
+    for (const Variant& variant : c.variants) {
+      const double seconds = time_variant(variant, min_seconds);
+      if (seconds < 0) {
+        std::printf("%-42s %-10s failed\n", c.name.c_str(), variant.library);
+        continue;
+      }
+      if (std::strcmp(variant.library, "portable") == 0) {
+        portable_seconds = seconds;
+      }
+      std::printf(
+          "%-42s %-10s %12.2f %10.2f %10.2f",
+          c.name.c_str(),
+          variant.library,
+          seconds * 1e6,
+          c.bytes / seconds * 1e-9,
+          c.flops / seconds * 1e-9);
+      if (portable_seconds > 0) {
+        std::printf(" %8.2fx", portable_seconds / seconds);
+      }
+      std::printf("\n");
+    }
+  }
+  return 0;
+}
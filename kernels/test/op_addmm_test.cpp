@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 #include <limits>
+#include <vector>
 
 using namespace ::testing;
 using exec_aten::ArrayRef;
@@ -66,6 +67,73 @@ class OpAddmmOutTest : public OperatorTest {
 
     EXPECT_TENSOR_EQ(out, expected);
   }
+
+  // Computes beta * self + alpha * (mat1 @ mat2) for an m x k mat1, a k x n
+  // mat2 and a self of the given sizes, broadcast to m x n. The entries are
+  // multiples of 0.5 in [-1, 1], so that the result is exact even in Half.
+  template <exec_aten::ScalarType DTYPE>
+  void test_large_addmm(
+      int32_t m,
+      int32_t k,
+      int32_t n,
+      const std::vector<int32_t>& self_sizes) {
+    using CTYPE = typename TensorFactory<DTYPE>::ctype;
+    TensorFactory<DTYPE> tf;
+    const float alpha = 2.0f;
+    const float beta = -1.5f;
+
+    const int32_t self_rows = self_sizes.size() == 2 ? self_sizes[0] : 1;
+    const int32_t self_cols = self_sizes.back();
+    std::vector<float> self_data(self_rows * self_cols);
+    std::vector<float> x_data(m * k);
+    std::vector<float> y_data(k * n);
+    for (int32_t i = 0; i < self_rows * self_cols; ++i) {
+      self_data[i] = ((i * 3) % 5 - 2) * 0.5f;
+    }
+    for (int32_t i = 0; i < m * k; ++i) {
+      x_data[i] = ((i * 7) % 5 - 2) * 0.5f;
+    }
+    for (int32_t i = 0; i < k * n; ++i) {
+      y_data[i] = ((i * 3) % 5 - 2) * 0.5f;
+    }
+    std::vector<CTYPE> expected_data(m * n);
+    for (int32_t i = 0; i < m; ++i) {
+      for (int32_t j = 0; j < n; ++j) {
+        float sum = 0;
+        for (int32_t l = 0; l < k; ++l) {
+          sum += x_data[i * k + l] * y_data[l * n + j];
+        }
+        const int32_t self_idx = (self_rows == 1 ? 0 : i) * self_cols +
+            (self_cols == 1 ? 0 : j);
+        expected_data[i * n + j] =
+            static_cast<CTYPE>(beta * self_data[self_idx] + alpha * sum);
+      }
+    }
+
+    Tensor self = tf.make(
+        self_sizes, std::vector<CTYPE>(self_data.begin(), self_data.end()));
+    Tensor x =
+        tf.make({m, k}, std::vector<CTYPE>(x_data.begin(), x_data.end()));
+    Tensor y =
+        tf.make({k, n}, std::vector<CTYPE>(y_data.begin(), y_data.end()));
+    Tensor out = tf.zeros({m, n});
+
+    op_addmm_out(self, x, y, Scalar(beta), Scalar(alpha), out);
+
+    EXPECT_TENSOR_EQ(out, tf.make({m, n}, expected_data));
+  }
+
+  // Runs test_large_addmm() with sizes above the size at which optimized
+  // kernels block the product for the caches, which are not multiples of
+  // the blocks or tiles, and with self broadcast in every way.
+  template <exec_aten::ScalarType DTYPE>
+  void test_large_addmm_broadcasts() {
+    test_large_addmm<DTYPE>(70, 133, 67, {70, 67});
+    test_large_addmm<DTYPE>(70, 133, 67, {67});
+    test_large_addmm<DTYPE>(70, 133, 67, {1, 67});
+    test_large_addmm<DTYPE>(70, 133, 67, {70, 1});
+    test_large_addmm<DTYPE>(33, 35, 129, {1});
+  }
 };
 
 TEST_F(OpAddmmOutTest, OutputDim) {
@@ -104,6 +172,18 @@ TEST_F(OpAddmmOutTest, AllDtypesSupported) {
   // for those types.
 }
 
+TEST_F(OpAddmmOutTest, LargeMatricesFloat) {
+  test_large_addmm_broadcasts<ScalarType::Float>();
+}
+
+TEST_F(OpAddmmOutTest, LargeMatricesHalf) {
+  if (torch::executor::testing::SupportedFeatures::get()->is_aten) {
+    GTEST_SKIP() << "skip Half because torch::executor::aten::mm_out does not "
+                    "support Half";
+  }
+  test_large_addmm_broadcasts<ScalarType::Half>();
+}
+
 TEST_F(OpAddmmOutTest, EmptyInputWithEmptyOutTensorPasses) {
   TensorFactory<ScalarType::Float> tf;
 
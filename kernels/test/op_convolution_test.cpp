@@ -12,8 +12,10 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/core/memory_allocator.h>
 
 #include <gtest/gtest.h>
+#include <vector>
 
 using namespace ::testing;
 using exec_aten::ArrayRef;
@@ -137,6 +139,177 @@ class OpConvOutTest : public OperatorTest {
         out);
     EXPECT_TENSOR_CLOSE(out, expected);
   }
+
+  // Makes an N x C x H x W tensor, contiguous or channels last, whose
+  // element at (n, c, h, w) is fn(n, c, h, w).
+  template <typename Fn>
+  Tensor make_4d(
+      TensorFactory<ScalarType::Float>& tf,
+      const std::vector<int32_t>& sizes,
+      bool channels_last,
+      Fn fn) {
+    const int32_t N = sizes[0], C = sizes[1], H = sizes[2], W = sizes[3];
+    std::vector<float> data(N * C * H * W);
+    for (int32_t n = 0; n < N; ++n) {
+      for (int32_t c = 0; c < C; ++c) {
+        for (int32_t h = 0; h < H; ++h) {
+          for (int32_t w = 0; w < W; ++w) {
+            const int32_t index = channels_last
+                ? ((n * H + h) * W + w) * C + c
+                : ((n * C + c) * H + h) * W + w;
+            data[index] = fn(n, c, h, w);
+          }
+        }
+      }
+    }
+    return channels_last ? tf.make_channels_last(sizes, data)
+                         : tf.make(sizes, data);
+  }
+
+  /**
+   * Runs a square 2D convolution of a 2 x in_c x 7 x 9 input against a
+   * reference computed here, both with a temp allocator in the context and
+   * without one. The optimized kernel needs the temp allocator for its
+   * im2col and Winograd paths, and falls back to a direct convolution
+   * otherwise. The entries are multiples of 0.5 in [-1, 1], so that every
+   * path computes the reference exactly up to rounding.
+   */
+  void test_conv2d(
+      int32_t in_c,
+      int32_t out_c,
+      int32_t kernel,
+      int64_t stride,
+      int64_t padding,
+      int64_t dilation,
+      int64_t groups,
+      bool channels_last,
+      bool with_bias) {
+    TensorFactory<ScalarType::Float> tf;
+    const int32_t N = 2, H = 7, W = 9;
+    const int32_t in_c_per_group = in_c / groups;
+    const int32_t out_c_per_group = out_c / groups;
+    const int32_t extent = dilation * (kernel - 1) + 1;
+    const int32_t out_h = (H + 2 * padding - extent) / stride + 1;
+    const int32_t out_w = (W + 2 * padding - extent) / stride + 1;
+
+    const auto in_value = [](int32_t n, int32_t c, int32_t h, int32_t w) {
+      return ((n * 5 + c * 3 + h * 7 + w * 11) % 5 - 2) * 0.5f;
+    };
+    const auto weight_value = [](int32_t o, int32_t i, int32_t y, int32_t x) {
+      return ((o * 3 + i * 5 + y * 2 + x * 7) % 5 - 2) * 0.5f;
+    };
+    const auto bias_value = [](int32_t o) { return (o % 3 - 1) * 0.5f; };
+
+    Tensor input = make_4d(tf, {N, in_c, H, W}, channels_last, in_value);
+    Tensor weight = make_4d(
+        tf,
+        {out_c, in_c_per_group, kernel, kernel},
+        channels_last,
+        weight_value);
+    optional<Tensor> bias;
+    if (with_bias) {
+      std::vector<float> bias_data(out_c);
+      for (int32_t o = 0; o < out_c; ++o) {
+        bias_data[o] = bias_value(o);
+      }
+      bias = tf.make({out_c}, bias_data);
+    }
+    Tensor expected = make_4d(
+        tf,
+        {N, out_c, out_h, out_w},
+        channels_last,
+        [&](int32_t n, int32_t o, int32_t y, int32_t x) {
+          const int32_t group = o / out_c_per_group;
+          float sum = with_bias ? bias_value(o) : 0.0f;
+          for (int32_t i = 0; i < in_c_per_group; ++i) {
+            for (int32_t ky = 0; ky < kernel; ++ky) {
+              for (int32_t kx = 0; kx < kernel; ++kx) {
+                const int32_t h = y * stride - padding + ky * dilation;
+                const int32_t w = x * stride - padding + kx * dilation;
+                if (h >= 0 && h < H && w >= 0 && w < W) {
+                  sum += in_value(n, group * in_c_per_group + i, h, w) *
+                      weight_value(o, i, ky, kx);
+                }
+              }
+            }
+          }
+          return sum;
+        });
+
+    int64_t strides[] = {stride, stride};
+    int64_t paddings[] = {padding, padding};
+    int64_t dilations[] = {dilation, dilation};
+    int64_t output_padding[] = {0};
+
+    // Scratch memory for the optimized paths.
+    std::vector<uint8_t> temp_memory(256 * 1024);
+    torch::executor::MemoryAllocator temp_allocator(
+        temp_memory.size(), temp_memory.data());
+    exec_aten::RuntimeContext context_with_temp(nullptr, &temp_allocator);
+    Tensor out = channels_last
+        ? tf.full_channels_last({N, out_c, out_h, out_w}, 0)
+        : tf.zeros({N, out_c, out_h, out_w});
+    torch::executor::aten::convolution_outf(
+        context_with_temp,
+        input,
+        weight,
+        bias,
+        strides,
+        paddings,
+        dilations,
+        false,
+        output_padding,
+        groups,
+        out);
+    EXPECT_EQ(context_with_temp.failure_state(), torch::executor::Error::Ok);
+    EXPECT_TENSOR_CLOSE(out, expected);
+
+    // Without a temp allocator.
+    Tensor fallback_out = channels_last
+        ? tf.full_channels_last({N, out_c, out_h, out_w}, 0)
+        : tf.zeros({N, out_c, out_h, out_w});
+    op_convolution_out(
+        input,
+        weight,
+        bias,
+        strides,
+        paddings,
+        dilations,
+        false,
+        output_padding,
+        groups,
+        fallback_out);
+    EXPECT_TENSOR_CLOSE(fallback_out, expected);
+  }
+
+  // Runs test_conv2d() on contiguous and channels-last tensors, with and
+  // without a bias.
+  void test_conv2d_layouts(
+      int32_t in_c,
+      int32_t out_c,
+      int32_t kernel,
+      int64_t stride,
+      int64_t padding,
+      int64_t dilation,
+      int64_t groups) {
+    for (const bool channels_last : {false, true}) {
+      for (const bool with_bias : {false, true}) {
+        SCOPED_TRACE(
+            ::testing::Message() << "channels_last=" << channels_last
+                                 << " with_bias=" << with_bias);
+        test_conv2d(
+            in_c,
+            out_c,
+            kernel,
+            stride,
+            padding,
+            dilation,
+            groups,
+            channels_last,
+            with_bias);
+      }
+    }
+  }
 };
 
 class OpConvCorrectnessTest : public OpConvOutTest {};
@@ -455,6 +628,91 @@ TEST_F(OpConvCorrectnessTest, 2DSanityCheckChannelsLast) {
   EXPECT_TENSOR_CLOSE(out, expected);
 }
 
+// The optimized kernel lowers these to im2col and a GEMM, with fewer than
+// 8 channels or a stride or dilation that rules out Winograd.
+TEST_F(OpConvCorrectnessTest, 2DIm2col) {
+  test_conv2d_layouts(
+      /*in_c=*/3,
+      /*out_c=*/5,
+      /*kernel=*/3,
+      /*stride=*/2,
+      /*padding=*/1,
+      /*dilation=*/1,
+      /*groups=*/1);
+  test_conv2d_layouts(
+      /*in_c=*/8,
+      /*out_c=*/8,
+      /*kernel=*/3,
+      /*stride=*/1,
+      /*padding=*/2,
+      /*dilation=*/2,
+      /*groups=*/1);
+}
+
+// A 1x1 convolution, which the optimized kernel multiplies without im2col.
+TEST_F(OpConvCorrectnessTest, 2DPointwise) {
+  test_conv2d_layouts(
+      /*in_c=*/8,
+      /*out_c=*/6,
+      /*kernel=*/1,
+      /*stride=*/1,
+      /*padding=*/0,
+      /*dilation=*/1,
+      /*groups=*/1);
+}
+
+// 3x3 with stride 1 and at least 8 channels, which the optimized kernel
+// computes with Winograd F(2x2, 3x3). The odd output sizes leave partial
+// tiles.
+TEST_F(OpConvCorrectnessTest, 2DWinograd) {
+  test_conv2d_layouts(
+      /*in_c=*/8,
+      /*out_c=*/9,
+      /*kernel=*/3,
+      /*stride=*/1,
+      /*padding=*/1,
+      /*dilation=*/1,
+      /*groups=*/1);
+  test_conv2d_layouts(
+      /*in_c=*/16,
+      /*out_c=*/8,
+      /*kernel=*/3,
+      /*stride=*/1,
+      /*padding=*/0,
+      /*dilation=*/1,
+      /*groups=*/1);
+}
+
+TEST_F(OpConvCorrectnessTest, 2DDepthwise) {
+  test_conv2d_layouts(
+      /*in_c=*/6,
+      /*out_c=*/12,
+      /*kernel=*/3,
+      /*stride=*/1,
+      /*padding=*/1,
+      /*dilation=*/1,
+      /*groups=*/6);
+  test_conv2d_layouts(
+      /*in_c=*/4,
+      /*out_c=*/4,
+      /*kernel=*/3,
+      /*stride=*/2,
+      /*padding=*/1,
+      /*dilation=*/1,
+      /*groups=*/4);
+}
+
+TEST_F(OpConvCorrectnessTest, 2DGrouped) {
+  test_conv2d_layouts(
+      /*in_c=*/8,
+      /*out_c=*/6,
+      /*kernel=*/3,
+      /*stride=*/1,
+      /*padding=*/1,
+      /*dilation=*/1,
+      /*groups=*/2);
+}
+
 TEST_F(OpConvOutTest, DynamicShapeUpperBoundSameAsExpected) {
   test_dynamic_shape(
       {1, 4, 2}, torch::executor::TensorShapeDynamism::DYNAMIC_BOUND);
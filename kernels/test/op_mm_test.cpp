@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include <limits>
+#include <vector>
 
 using namespace ::testing;
 using exec_aten::ArrayRef;
@@ -56,6 +57,44 @@ class OpMmOutTest : public OperatorTest {
 
     EXPECT_TENSOR_EQ(out, expected);
   }
+
+  // Multiplies an m x k matrix by a k x n one, whose entries are multiples
+  // of 0.5 in [-1, 1], so that every partial sum is exact even in Half and
+  // the result does not depend on the order of the accumulation.
+  template <exec_aten::ScalarType DTYPE>
+  void test_large_mm(int32_t m, int32_t k, int32_t n) {
+    using CTYPE = typename TensorFactory<DTYPE>::ctype;
+    TensorFactory<DTYPE> tf;
+
+    std::vector<float> x_data(m * k);
+    std::vector<float> y_data(k * n);
+    for (int32_t i = 0; i < m * k; ++i) {
+      x_data[i] = ((i * 7) % 5 - 2) * 0.5f;
+    }
+    for (int32_t i = 0; i < k * n; ++i) {
+      y_data[i] = ((i * 3) % 5 - 2) * 0.5f;
+    }
+    std::vector<CTYPE> expected_data(m * n);
+    for (int32_t i = 0; i < m; ++i) {
+      for (int32_t j = 0; j < n; ++j) {
+        float sum = 0;
+        for (int32_t l = 0; l < k; ++l) {
+          sum += x_data[i * k + l] * y_data[l * n + j];
+        }
+        expected_data[i * n + j] = static_cast<CTYPE>(sum);
+      }
+    }
+
+    Tensor x =
+        tf.make({m, k}, std::vector<CTYPE>(x_data.begin(), x_data.end()));
+    Tensor y =
+        tf.make({k, n}, std::vector<CTYPE>(y_data.begin(), y_data.end()));
+    Tensor out = tf.zeros({m, n});
+
+    op_mm_out(x, y, out);
+
+    EXPECT_TENSOR_EQ(out, tf.make({m, n}, expected_data));
+  }
 };
 
 TEST_F(OpMmOutTest, OutputDim) {
@@ -88,6 +127,22 @@ TEST_F(OpMmOutTest, AllDtypesSupported) {
   // for those types.
 }
 
+TEST_F(OpMmOutTest, LargeMatricesFloat) {
+  // Above the size at which optimized kernels block the product for the
+  // caches, with sizes that are not multiples of the blocks or tiles.
+  test_large_mm<ScalarType::Float>(70, 133, 67);
+  test_large_mm<ScalarType::Float>(33, 35, 129);
+}
+
+TEST_F(OpMmOutTest, LargeMatricesHalf) {
+  if (torch::executor::testing::SupportedFeatures::get()->is_aten) {
+    GTEST_SKIP() << "skip Half because torch::executor::aten::mm_out does not "
+                    "support Half";
+  }
+  test_large_mm<ScalarType::Half>(70, 133, 67);
+  test_large_mm<ScalarType::Half>(33, 35, 129);
+}
+
 TEST_F(OpMmOutTest, EmptyInputWithEmptyOutTensorPasses) {
   TensorFactory<ScalarType::Float> tf;
 
@@ -862,6 +862,38 @@ TEST_F(
   EXPECT_TENSOR_CLOSE(out2, out2_expected);
 }
 
+TEST_F(OpNativeBatchNormLegitNoTrainingOutTest, SampleAtomicTestChannelsLast) {
+  torch::executor::testing::TensorFactory<exec_aten::ScalarType::Float> tfFloat;
+
+  exec_aten::Tensor input = tfFloat.make_channels_last(
+      {1, 2, 2, 2}, {3.0, 4.0, 5.0, 1.0, -1.0, 2.0, 1.0, 0.0});
+  exec_aten::optional<exec_aten::Tensor> weight =
+      exec_aten::optional<exec_aten::Tensor>(tfFloat.make({2}, {2.0, 3.0}));
+  exec_aten::optional<exec_aten::Tensor> bias =
+      exec_aten::optional<exec_aten::Tensor>(tfFloat.make({2}, {0.5, -1.0}));
+  exec_aten::Tensor running_mean = tfFloat.make({2}, {1.0, 2.0});
+  exec_aten::Tensor running_var = tfFloat.make({2}, {4.0, 1.0});
+  double momentum = 0.1;
+  double eps = 0;
+  exec_aten::Tensor out0 = tfFloat.full_channels_last({1, 2, 2, 2}, 0.0);
+  exec_aten::Tensor out1 = tfFloat.zeros({0});
+  exec_aten::Tensor out2 = tfFloat.zeros({0});
+  exec_aten::Tensor out0_expected = tfFloat.make_channels_last(
+      {1, 2, 2, 2}, {2.5, 5.0, 4.5, -4.0, -1.5, -1.0, 0.5, -7.0});
+  op_native_batch_norm_legit_no_training_out(
+      input,
+      weight,
+      bias,
+      running_mean,
+      running_var,
+      momentum,
+      eps,
+      out0,
+      out1,
+      out2);
+  EXPECT_TENSOR_CLOSE(out0, out0_expected);
+}
+
 TEST_F(OpNativeBatchNormLegitOutTest, SampleAtomicTest2D) {
   torch::executor::testing::TensorFactory<exec_aten::ScalarType::Float> tfFloat;
 
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/test/FunctionHeaderWrapper.h> // Declares the operator
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/kernels/test/supported_features.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace ::testing;
+using exec_aten::ScalarType;
+using exec_aten::Tensor;
+using torch::executor::testing::TensorFactory;
+
+class OpTopkValuesTest : public OperatorTest {
+ protected:
+  std::tuple<Tensor&, Tensor&> op_topk_values(
+      const Tensor& in,
+      int64_t k,
+      int64_t dim,
+      bool largest,
+      bool sorted,
+      Tensor& values,
+      Tensor& indices) {
+    return torch::executor::aten::topk_outf(
+        context_, in, k, dim, largest, sorted, values, indices);
+  }
+
+  template <ScalarType DTYPE>
+  void test_dtype() {
+    TensorFactory<DTYPE> tf;
+    TensorFactory<ScalarType::Long> tfl;
+
+    // clang-format off
+    Tensor in = tf.make(
+        {2, 5},
+        {3, 9, 1, 7, 5,
+         6, 2, 8, 4, 0});
+    // clang-format on
+    Tensor values = tf.zeros({2, 2});
+    Tensor indices = tfl.zeros({2, 2});
+
+    op_topk_values(
+        in, 2, 1, /*largest=*/true, /*sorted=*/true, values, indices);
+    EXPECT_TENSOR_EQ(values, tf.make({2, 2}, {9, 7, 8, 6}));
+    EXPECT_TENSOR_EQ(indices, tfl.make({2, 2}, {1, 3, 2, 0}));
+
+    op_topk_values(
+        in, 2, -1, /*largest=*/false, /*sorted=*/true, values, indices);
+    EXPECT_TENSOR_EQ(values, tf.make({2, 2}, {1, 3, 0, 2}));
+    EXPECT_TENSOR_EQ(indices, tfl.make({2, 2}, {2, 0, 4, 1}));
+  }
+};
+
+TEST_F(OpTopkValuesTest, AllRealDtypesSupported) {
+#define TEST_ENTRY(ctype, dtype) test_dtype<ScalarType::dtype>();
+  ET_FORALL_REAL_TYPES(TEST_ENTRY);
+#undef TEST_ENTRY
+}
+
+TEST_F(OpTopkValuesTest, OuterDim) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tfl;
+
+  // clang-format off
+  Tensor in = tf.make(
+      {3, 2},
+      {0.5, 4.0,
+       2.5, 1.0,
+       1.5, 3.0});
+  // clang-format on
+  Tensor values = tf.zeros({2, 2});
+  Tensor indices = tfl.zeros({2, 2});
+
+  op_topk_values(in, 2, 0, /*largest=*/true, /*sorted=*/true, values, indices);
+  EXPECT_TENSOR_EQ(values, tf.make({2, 2}, {2.5, 4.0, 1.5, 3.0}));
+  EXPECT_TENSOR_EQ(indices, tfl.make({2, 2}, {1, 0, 2, 2}));
+}
+
+TEST_F(OpTopkValuesTest, LongRows) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tfl;
+
+  // Distinct values in a scrambled order, long enough for the vectorized
+  // optimized path, with a NaN that counts as the largest value.
+  constexpr int kRows = 2;
+  constexpr int kCols = 100;
+  std::vector<float> data(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) {
+    data[i] = static_cast<float>((i * 37) % (kRows * kCols));
+  }
+  data[kCols + 60] = NAN;
+  Tensor in = tf.make({kRows, kCols}, data);
+
+  for (const int64_t k : {3, 20}) {
+    const int32_t k32 = static_cast<int32_t>(k);
+    Tensor values = tf.zeros({kRows, k32});
+    Tensor indices = tfl.zeros({kRows, k32});
+    for (const bool largest : {true, false}) {
+      op_topk_values(in, k, 1, largest, /*sorted=*/true, values, indices);
+      for (int r = 0; r < kRows; ++r) {
+        // Reference: repeatedly pick the best remaining element.
+        std::vector<bool> taken(kCols, false);
+        for (int j = 0; j < k; ++j) {
+          int best = -1;
+          for (int c = 0; c < kCols; ++c) {
+            if (taken[c]) {
+              continue;
+            }
+            const float v = data[r * kCols + c];
+            if (best < 0) {
+              best = c;
+              continue;
+            }
+            const float b = data[r * kCols + best];
+            const bool better = std::isnan(v) != std::isnan(b)
+                ? std::isnan(v) == largest
+                : (largest ? v > b : v < b);
+            if (better) {
+              best = c;
+            }
+          }
+          taken[best] = true;
+          const float expected = data[r * kCols + best];
+          const float actual = values.const_data_ptr<float>()[r * k + j];
+          if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(actual));
+          } else {
+            EXPECT_EQ(actual, expected);
+          }
+          EXPECT_EQ(indices.const_data_ptr<int64_t>()[r * k + j], best);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(OpTopkValuesTest, EmptySelection) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tfl;
+
+  Tensor in = tf.ones({2, 3});
+  Tensor values = tf.zeros({2, 0});
+  Tensor indices = tfl.zeros({2, 0});
+
+  op_topk_values(in, 0, 1, /*largest=*/true, /*sorted=*/true, values, indices);
+  EXPECT_TENSOR_EQ(values, tf.zeros({2, 0}));
+  EXPECT_TENSOR_EQ(indices, tfl.zeros({2, 0}));
+}
+
+TEST_F(OpTopkValuesTest, KTooLargeDies) {
+  if (torch::executor::testing::SupportedFeatures::get()->is_aten) {
+    GTEST_SKIP() << "ATen kernel throws on an out of range k";
+  }
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Long> tfl;
+
+  Tensor in = tf.ones({2, 3});
+  Tensor values = tf.zeros({2, 4});
+  Tensor indices = tfl.zeros({2, 4});
+
+  ET_EXPECT_KERNEL_FAILURE(
+      context_,
+      op_topk_values(
+          in, 4, 1, /*largest=*/true, /*sorted=*/true, values, indices));
+}
+
+TEST_F(OpTopkValuesTest, WrongIndicesDtypeDies) {
+  if (torch::executor::testing::SupportedFeatures::get()->is_aten) {
+    GTEST_SKIP() << "ATen kernel throws on non-Long indices";
+  }
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Int> tfi;
+
+  Tensor in = tf.ones({2, 3});
+  Tensor values = tf.zeros({2, 2});
+  Tensor indices = tfi.zeros({2, 2});
+
+  ET_EXPECT_KERNEL_FAILURE(
+      context_,
+      op_topk_values(
+          in, 2, 1, /*largest=*/true, /*sorted=*/true, values, indices));
+}
@@ -152,6 +152,24 @@ def define_common_targets(is_fbcode = False):
         ],
     )
 
+    runtime.cxx_binary(
+        name = "kernel_benchmark",
+        srcs = [
+            "kernel_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/extension/memory_allocator:temp_memory_allocator",
+            "//executorch/kernels/optimized:generated_lib_headers",
+            "//executorch/kernels/optimized/cpu:cpu_optimized",
+            "//executorch/kernels/portable:generated_lib_headers",
+            "//executorch/kernels/portable/cpu:cpu",
+            "//executorch/kernels/quantized:generated_lib_headers",
+            "//executorch/kernels/quantized/cpu:quantized_cpu",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     codegen_function_header_wrapper("executorch/kernels/aten", "aten")
     codegen_function_header_wrapper("executorch/kernels/portable", "portable")
     codegen_function_header_wrapper("executorch/kernels/optimized", "optimized")
@@ -163,37 +181,37 @@ def define_common_targets(is_fbcode = False):
     _common_op_test("op_acos_test", ["aten", "portable"])
     _common_op_test("op_acosh_test", ["aten", "portable"])
     _common_op_test("op_add_test", ["aten", "portable", "optimized"])
-    _common_op_test("op_addmm_test", ["aten", "portable"])
+    _common_op_test("op_addmm_test", ["aten", "portable", "optimized"])
     _common_op_test("op_alias_copy_test", ["aten", "portable"])
     _common_op_test("op_amax_test", ["aten", "portable"])
     _common_op_test("op_amin_test", ["aten", "portable"])
     _common_op_test("op_any_test", ["aten", "portable"])
     _common_op_test("op_arange_test", ["aten", "portable"])
-    _common_op_test("op_argmax_test", ["aten", "portable"])
-    _common_op_test("op_argmin_test", ["aten", "portable"])
+    _common_op_test("op_argmax_test", ["aten", "portable", "optimized"])
+    _common_op_test("op_argmin_test", ["aten", "portable", "optimized"])
     _common_op_test("op_as_strided_copy_test", ["aten", "portable"])
     _common_op_test("op_asin_test", ["aten", "portable"])
     _common_op_test("op_asinh_test", ["aten", "portable"])
     _common_op_test("op_atan_test", ["aten", "portable"])
     _common_op_test("op_atan2_test", ["aten", "portable"])
     _common_op_test("op_atanh_test", ["aten", "portable"])
-    _common_op_test("op_avg_pool2d_test", ["aten", "portable"])
+    _common_op_test("op_avg_pool2d_test", ["aten", "portable", "optimized"])
     _common_op_test("op_bitwise_and_test", ["aten", "portable"])
     _common_op_test("op_bitwise_not_test", ["aten", "portable"])
     _common_op_test("op_bitwise_or_test", ["aten", "portable"])
     _common_op_test("op_bitwise_xor_test", ["aten", "portable"])
     _common_op_test("op_bmm_test", ["aten", "portable", "optimized"])
     _common_op_test("op_cat_test", ["aten", "portable"])
-    _common_op_test("op_cdist_forward_test", ["aten", "portable"])
+    _common_op_test("op_cdist_forward_test", ["aten", "portable", "optimized"])
     _common_op_test("op_ceil_test", ["aten", "portable"])
     _common_op_test("op_clamp_test", ["aten", "portable"])
     _common_op_test("op_clone_test", ["aten", "portable"])
     _common_op_test("op_constant_pad_nd_test", ["aten", "portable"])
-    _common_op_test("op_convolution_test", ["aten", "portable"])
+    _common_op_test("op_convolution_test", ["aten", "portable", "optimized"])
     _common_op_test("op_copy_test", ["aten", "portable"])
     _common_op_test("op_cos_test", ["aten", "portable"])
     _common_op_test("op_cosh_test", ["aten", "portable"])
-    _common_op_test("op_cumsum_test", ["aten", "portable"])
+    _common_op_test("op_cumsum_test", ["aten", "portable", "optimized"])
     _common_op_test("op_detach_copy_test", ["aten", "portable"])
     _common_op_test("op_diagonal_copy_test", ["aten", "portable"])
     _common_op_test("op_div_test", ["aten", "portable", "optimized"])
@@ -237,22 +255,22 @@ def define_common_targets(is_fbcode = False):
     _common_op_test("op_lt_test", ["aten", "portable"])
     _common_op_test("op_masked_fill_test", ["aten", "portable"])
     _common_op_test("op_max_test", ["aten", "portable"])
-    _common_op_test("op_max_pool2d_with_indices_test", ["aten", "portable"])
+    _common_op_test("op_max_pool2d_with_indices_test", ["aten", "portable", "optimized"])
     _common_op_test("op_maximum_test", ["aten", "portable"])
     _common_op_test("op_mean_test", ["aten", "portable"])
     _common_op_test("op_min_test", ["aten", "portable"])
     _common_op_test("op_minimum_test", ["aten", "portable"])
-    _common_op_test("op_mm_test", ["aten", "portable"])
+    _common_op_test("op_mm_test", ["aten", "portable", "optimized"])
     _common_op_test("op_mul_test", ["aten", "portable", "optimized"])
     _common_op_test("op_pow_test", ["aten", "portable"])
-    _common_op_test("op_native_batch_norm_test", ["aten", "portable"])
-    _common_op_test("op_native_group_norm_test", ["aten", "portable"])
+    _common_op_test("op_native_batch_norm_test", ["aten", "portable", "optimized"])
+    _common_op_test("op_native_group_norm_test", ["aten", "portable", "optimized"])
     _common_op_test("op_native_layer_norm_test", ["aten", "portable", "optimized"])
     _common_op_test("op_ne_test", ["aten", "portable"])
     _common_op_test("op_neg_test", ["aten", "portable", "optimized"])
     _common_op_test("op_nonzero_test", ["aten", "portable"])
     _common_op_test("op_ones_test", ["aten", "portable"])
-    _common_op_test("op_pdist_forward_test", ["aten", "portable"])
+    _common_op_test("op_pdist_forward_test", ["aten", "portable", "optimized"])
     _common_op_test("op_permute_copy_test", ["aten", "portable"])
     _common_op_test("op_pixel_shuffle_test", ["aten", "portable"])
     _common_op_test("op_prod_test", ["aten", "portable"])
@@ -274,13 +292,13 @@ def define_common_targets(is_fbcode = False):
     _common_op_test("op_scatter_add_test", ["aten", "portable"])
     _common_op_test("op_select_scatter_test", ["aten", "portable"])
     _common_op_test("op_select_copy_test", ["aten", "portable"])
-    _common_op_test("op_sigmoid_test", ["aten", "portable"])
+    _common_op_test("op_sigmoid_test", ["aten", "portable", "optimized"])
     _common_op_test("op_sign_test", ["aten", "portable"])
     _common_op_test("op_sin_test", ["aten", "portable"])
     _common_op_test("op_sinh_test", ["aten", "portable"])
     _common_op_test("op_slice_scatter_test", ["aten", "portable"])
     _common_op_test("op_slice_copy_test", ["aten", "portable"])
-    _common_op_test("op_softmax_test", ["aten", "portable"])
+    _common_op_test("op_softmax_test", ["aten", "portable", "optimized"])
     _common_op_test("op_split_copy_test", ["aten", "portable"])
     _common_op_test("op_split_with_sizes_copy_test", ["aten", "portable"])
     _common_op_test("op_sqrt_test", ["aten", "portable"])
@@ -291,6 +309,7 @@ def define_common_targets(is_fbcode = False):
     _common_op_test("op_t_copy_test", ["aten", "portable"])
     _common_op_test("op_tan_test", ["aten", "portable"])
     _common_op_test("op_tanh_test", ["aten", "portable"])
+    _common_op_test("op_topk_test", ["aten", "portable", "optimized"])
     _common_op_test("op_to_copy_test", ["aten", "portable"])
     _common_op_test("op_transpose_copy_test", ["aten", "portable"])
     _common_op_test("op_tril_test", ["aten", "portable"])
@@ -9,11 +9,38 @@
 #pragma once
 
 #include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/core/span.h>
 
 namespace torch {
 namespace executor {
 
+/**
+ * The data of a tensor held in memory owned by a backend, e.g. on a GPU,
+ * instead of the host memory of the tensor.
+ */
+struct DeviceBuffer {
+  /// Opaque to the runtime, and interpreted by the backend that left the data
+  /// there. Null if the data is in host memory.
+  void* handle = nullptr;
+  /// The device that holds the data.
+  exec_aten::Device device = exec_aten::Device(exec_aten::DeviceType::CPU);
+};
+
+/**
+ * Where the data of an argument of a delegate call is. Set up by the runtime,
+ * see BackendExecutionContext::get_device_buffer().
+ */
+struct DelegateArgPlacement {
+  /// The device buffer holding the data, or an empty buffer if the data is in
+  /// host memory.
+  DeviceBuffer buffer;
+  /// Whether the runtime lets the backend leave the argument in device
+  /// memory.
+  bool may_stay_on_device = false;
+};
+
 /**
  * BackendExecutionContext will be used to inject run time context.
  */
@@ -21,8 +48,11 @@ class BackendExecutionContext final {
  public:
   BackendExecutionContext(
       EventTracer* event_tracer = nullptr,
-      MemoryAllocator* temp_allocator = nullptr)
-      : event_tracer_(event_tracer), temp_allocator_(temp_allocator) {}
+      MemoryAllocator* temp_allocator = nullptr,
+      Span<DelegateArgPlacement> arg_placements = {})
+      : event_tracer_(event_tracer),
+        temp_allocator_(temp_allocator),
+        arg_placements_(arg_placements) {}
 
   /**
    * Returns a pointer to an instance of EventTracer to do profiling/debugging
@@ -45,9 +75,51 @@ class BackendExecutionContext final {
     return temp_allocator_->allocate(size, alignment);
   }
 
+  /**
+   * Returns the buffer that holds argument `arg_index` of the call, if an
+   * earlier call to this backend left it in device memory. The host memory of
+   * the tensor is then stale. Returns nullptr if the data is in host memory.
+   *
+   * When the backend writes an argument that has a device buffer, it must
+   * report the new placement with set_device_buffer(), passing an empty
+   * DeviceBuffer if it wrote host memory.
+   */
+  const DeviceBuffer* get_device_buffer(size_t arg_index) const {
+    if (arg_index >= arg_placements_.size() ||
+        arg_placements_[arg_index].buffer.handle == nullptr) {
+      return nullptr;
+    }
+    return &arg_placements_[arg_index].buffer;
+  }
+
+  /**
+   * Leaves output argument `arg_index` in `buffer` instead of host memory.
+   * Only backends whose supports_device_buffers() is true may do this, and
+   * should call it before writing host memory. The runtime copies the data
+   * to host memory with PyTorchBackendInterface::copy_to_host() before
+   * anything other than a delegate call of this backend reads it, and passes
+   * `buffer` to such delegate calls.
+   *
+   * The buffer must stay valid until the backend reports another placement
+   * for the tensor, or until the delegate that set it is destroyed.
+   *
+   * @returns true on success, or false if the runtime needs the data in host
+   *     memory, e.g. because the tensor is an output of the method. The
+   *     backend must then write host memory as usual.
+   */
+  bool set_device_buffer(size_t arg_index, const DeviceBuffer& buffer) {
+    if (arg_index >= arg_placements_.size() ||
+        !arg_placements_[arg_index].may_stay_on_device) {
+      return buffer.handle == nullptr;
+    }
+    arg_placements_[arg_index].buffer = buffer;
+    return true;
+  }
+
  private:
   EventTracer* event_tracer_ = nullptr;
   MemoryAllocator* temp_allocator_ = nullptr;
+  Span<DelegateArgPlacement> arg_placements_;
 };
 
 } // namespace executor
@@ -7,6 +7,7 @@
  */
 
 #pragma once
+#include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/memory_allocator.h>
 
 namespace torch {
@@ -18,8 +19,10 @@ namespace executor {
  */
 class BackendInitContext final {
  public:
-  explicit BackendInitContext(MemoryAllocator* runtime_allocator)
-      : runtime_allocator_(runtime_allocator) {}
+  explicit BackendInitContext(
+      MemoryAllocator* runtime_allocator,
+      EventTracer* event_tracer = nullptr)
+      : runtime_allocator_(runtime_allocator), event_tracer_(event_tracer) {}
 
   /** Get the runtime allocator passed from Method. It's the same runtime
    * executor used by the standard executor runtime and the life span is the
@@ -29,8 +32,19 @@ class BackendInitContext final {
     return runtime_allocator_;
   }
 
+  /**
+   * Returns a pointer to the event tracer of the Method being loaded, to
+   * profile the compilation and initialization of the delegate, or nullptr
+   * if there is none. It is null when delegates are initialized in parallel,
+   * as an EventTracer is only used from one thread at a time.
+   */
+  EventTracer* event_tracer() {
+    return event_tracer_;
+  }
+
  private:
   MemoryAllocator* runtime_allocator_ = nullptr;
+  EventTracer* event_tracer_ = nullptr;
 };
 
 } // namespace executor
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+
+#include <executorch/runtime/core/event_tracer_hooks_delegate.h>
+#include <executorch/runtime/platform/platform.h>
+
+/**
+ * @file
+ *
+ * The profiling contract shared by delegate backends, so that the Inspector
+ * can compare the time a model spends in each phase of different backends.
+ *
+ * Besides the events of the nodes they execute, which keep the names or
+ * delegate debug identifiers generated ahead of time, backends log the phases
+ * below as delegate events with reserved names:
+ *
+ * - DELEGATE_COMPILE: building the executable graph from the processed blob,
+ *   e.g. compiling a QNN graph or an XNNPACK runtime, in init().
+ * - DELEGATE_INIT: the rest of init(), e.g. creating a device context or
+ *   allocating tensors.
+ * - DELEGATE_EXECUTE: running the graph on the backend in execute().
+ * - DELEGATE_DATA_TRANSFER: copying or binding inputs and outputs between the
+ *   runtime and the backend.
+ * - DELEGATE_MEMORY_USAGE: a point event, whose metadata is the number of
+ *   bytes the backend allocated, in decimal.
+ *
+ * Init events are only recorded when Method is given an EventTracer at load
+ * time, see BackendInitContext::event_tracer().
+ */
+
+namespace torch {
+namespace executor {
+
+/// The phases of a delegate reported through EventTracer.
+enum class DelegateProfilingEventType : uint8_t {
+  kCompile,
+  kInit,
+  kExecute,
+  kDataTransfer,
+  kMemoryUsage,
+};
+
+constexpr const char* kDelegateCompileEventName = "DELEGATE_COMPILE";
+constexpr const char* kDelegateInitEventName = "DELEGATE_INIT";
+constexpr const char* kDelegateExecuteEventName = "DELEGATE_EXECUTE";
+constexpr const char* kDelegateDataTransferEventName =
+    "DELEGATE_DATA_TRANSFER";
+constexpr const char* kDelegateMemoryUsageEventName = "DELEGATE_MEMORY_USAGE";
+
+/// The delegate debug identifier of events identified by their name.
+constexpr DebugHandle kDelegateNamedEventId = static_cast<DebugHandle>(-1);
+
+/// Returns the reserved name of the events of `type`.
+inline const char* delegate_profiling_event_name(
+    DelegateProfilingEventType type) {
+  switch (type) {
+    case DelegateProfilingEventType::kCompile:
+      return kDelegateCompileEventName;
+    case DelegateProfilingEventType::kInit:
+      return kDelegateInitEventName;
+    case DelegateProfilingEventType::kExecute:
+      return kDelegateExecuteEventName;
+    case DelegateProfilingEventType::kDataTransfer:
+      return kDelegateDataTransferEventName;
+    case DelegateProfilingEventType::kMemoryUsage:
+      return kDelegateMemoryUsageEventName;
+  }
+  return kDelegateExecuteEventName;
+}
+
+/**
+ * Profiles the lifetime of the scope as a delegate event of the given phase.
+ * Does nothing when `event_tracer` is null or EventTracer support is not
+ * compiled in.
+ */
+class DelegateProfilingScope final {
+ public:
+  DelegateProfilingScope(
+      EventTracer* event_tracer,
+      DelegateProfilingEventType type)
+      : event_tracer_(event_tracer),
+        entry_(event_tracer_start_profiling_delegate(
+            event_tracer,
+            delegate_profiling_event_name(type),
+            kDelegateNamedEventId)) {}
+
+  DelegateProfilingScope(const DelegateProfilingScope&) = delete;
+  DelegateProfilingScope& operator=(const DelegateProfilingScope&) = delete;
+
+  ~DelegateProfilingScope() {
+    event_tracer_end_profiling_delegate(event_tracer_, entry_);
+  }
+
+ private:
+  EventTracer* event_tracer_;
+  EventTracerEntry entry_;
+};
+
+/**
+ * Logs the execution of a node by the backend, after the fact, e.g. from the
+ * results of a native profiler. `name` or `delegate_debug_id` identify the
+ * node as in the delegate debug identifier mapping generated ahead of time;
+ * pass nullptr or kDelegateNamedEventId for the one that is not used.
+ */
+inline void log_delegate_node_event(
+    EventTracer* event_tracer,
+    const char* name,
+    DebugHandle delegate_debug_id,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time,
+    const void* metadata = nullptr,
+    size_t metadata_len = 0) {
+  event_tracer_log_profiling_delegate(
+      event_tracer,
+      name,
+      delegate_debug_id,
+      start_time,
+      end_time,
+      metadata,
+      metadata_len);
+}
+
+/**
+ * Logs that the backend currently holds `num_bytes` of memory, e.g. its
+ * workspace or the weights it packed, as a DELEGATE_MEMORY_USAGE event.
+ */
+inline void log_delegate_memory_usage(
+    EventTracer* event_tracer,
+    uint64_t num_bytes) {
+#ifdef ET_EVENT_TRACER_ENABLED
+  if (event_tracer) {
+    char metadata[24];
+    int len = snprintf(metadata, sizeof(metadata), "%" PRIu64, num_bytes);
+    et_timestamp_t now = et_pal_current_ticks();
+    event_tracer->log_profiling_delegate(
+        kDelegateMemoryUsageEventName,
+        kDelegateNamedEventId,
+        now,
+        now,
+        metadata,
+        static_cast<size_t>(len));
+  }
+#else //! ET_EVENT_TRACER_ENABLED
+  (void)event_tracer;
+  (void)num_bytes;
+#endif
+}
+
+} // namespace executor
+} // namespace torch
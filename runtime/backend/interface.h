@@ -48,6 +48,17 @@ class PyTorchBackendInterface {
    */
   __ET_NODISCARD virtual bool is_available() const = 0;
 
+  /**
+   * Returns true if init() may be called for several delegates of this
+   * backend at the same time, from different threads. Only then does
+   * Program::experimental_load_method_with_parallel_init() initialize the
+   * delegates of this backend concurrently. Allocations from the runtime
+   * allocator of the context are serialized by the runtime.
+   */
+  __ET_NODISCARD virtual bool is_init_thread_safe() const {
+    return false;
+  }
+
   /**
    * Responsible to further process (compile/transform/optimize) the compiled
    * unit that was produced, ahead-of-time, as well as perform any backend
@@ -94,6 +105,54 @@ class PyTorchBackendInterface {
       DelegateHandle* handle,
       EValue** args) const = 0;
 
+  /**
+   * Executes the method's handle once for each argument list in `batch`.
+   * Every list has the layout of the `args` of execute(), but holds the
+   * inputs and outputs of a different request, so that backends that can
+   * submit several requests to their device at once amortize the dispatch
+   * overhead. The default implementation calls execute() on each list in
+   * order.
+   *
+   * @param[in] handle An opaque handle returned by `init()`.
+   * @param[in] batch The argument lists of the requests.
+   * @retval Error::Ok if all requests succeeded.
+   */
+  __ET_NODISCARD virtual Error execute_batch(
+      BackendExecutionContext& context,
+      DelegateHandle* handle,
+      ArrayRef<EValue**> batch) const {
+    for (EValue** args : batch) {
+      Error err = execute(context, handle, args);
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+    return Error::Ok;
+  }
+
+  /**
+   * Returns true if execute() may leave outputs in device memory owned by the
+   * backend, with BackendExecutionContext::set_device_buffer(), so that
+   * consecutive delegate calls on the same device do not round-trip their
+   * tensors through host memory. Such backends must implement
+   * copy_to_host().
+   */
+  __ET_NODISCARD virtual bool supports_device_buffers() const {
+    return false;
+  }
+
+  /**
+   * Copies the data that execute() left in `buffer` to the host memory of
+   * `tensor`, whose sizes and dtype are those of the data.
+   *
+   * @retval Error::Ok if successful.
+   */
+  __ET_NODISCARD virtual Error copy_to_host(
+      __ET_UNUSED const DeviceBuffer& buffer,
+      __ET_UNUSED exec_aten::Tensor& tensor) const {
+    return Error::NotSupported;
+  }
+
   /**
    * Responsible for destroying a handle, if it's required for some backend.
    * It may be needed for some backends. For example, resources associated with
@@ -41,6 +41,31 @@ class DataLoader {
    * Returns the length of the underlying data source, typically the file size.
    */
   __ET_NODISCARD virtual Result<size_t> size() const = 0;
+
+  /**
+   * Hints that `Load(offset, size)` will be called soon, so that the
+   * implementation can start the read ahead of time, e.g. concurrently with
+   * other work of the caller. The default implementation does nothing.
+   *
+   * NOTE: This must be thread-safe, like `Load()`.
+   */
+  virtual void will_load(size_t offset, size_t size) {
+    (void)offset;
+    (void)size;
+  }
+
+  /**
+   * Hints that the `size` bytes at `data`, which must lie inside a buffer
+   * returned by `Load()`, will be read soon. Implementations that load lazily
+   * can use this to start bringing the data into memory ahead of the first
+   * access. The default implementation does nothing.
+   *
+   * NOTE: This must be thread-safe, like `Load()`.
+   */
+  virtual void prefetch(const void* data, size_t size) {
+    (void)data;
+    (void)size;
+  }
 };
 
 } // namespace executor
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Interface for the allocators that back tensors with DYNAMIC_UNBOUND shape
+ * dynamism. Unlike MemoryAllocator, it hands out buffers that can be
+ * reallocated when a resize needs more memory than the tensor's capacity.
+ *
+ * An allocator typically serves all the unbounded tensors of one Method, and
+ * must outlive it.
+ */
+class DynamicAllocator {
+ public:
+  virtual ~DynamicAllocator() = default;
+
+  /**
+   * Returns a buffer of at least `size` bytes whose first `used` bytes are a
+   * copy of those of `data`.
+   *
+   * @param[in] data The current buffer of the tensor. May be nullptr, or a
+   *     buffer this allocator did not return, e.g. memory-planned data; such
+   *     buffers are copied from but never freed.
+   * @param[in] used The number of bytes of `data` to preserve.
+   * @param[in] size The minimum size of the new buffer in bytes.
+   * @param[in,out] capacity The capacity of `data` in bytes on input, and that
+   *     of the returned buffer on success.
+   *
+   * @returns The new buffer, or nullptr on failure, in which case `data` and
+   *     `capacity` are left untouched. On success, `data` must no longer be
+   *     used.
+   */
+  virtual void*
+  reallocate(void* data, size_t used, size_t size, size_t* capacity) = 0;
+};
+
+} // namespace executor
+} // namespace torch
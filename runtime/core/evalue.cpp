@@ -13,6 +13,10 @@ namespace executor {
 template <>
 exec_aten::ArrayRef<exec_aten::optional<exec_aten::Tensor>>
 BoxedEvalueList<exec_aten::optional<exec_aten::Tensor>>::get() const {
+  if (frozen_) {
+    return exec_aten::ArrayRef<exec_aten::optional<exec_aten::Tensor>>{
+        unwrapped_vals_, wrapped_vals_.size()};
+  }
   for (typename exec_aten::ArrayRef<
            exec_aten::optional<exec_aten::Tensor>>::size_type i = 0;
        i < wrapped_vals_.size();
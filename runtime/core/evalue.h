@@ -65,11 +65,30 @@ class BoxedEvalueList {
    */
   exec_aten::ArrayRef<T> get() const;
 
+  /*
+   * Unwraps the list one last time: get() then returns that result without
+   * reading the EValues again. Only valid if none of the EValues the list
+   * points to is assigned to afterwards, e.g. because they are constants of
+   * the program. Changes to a Tensor's data or shape are fine, since the
+   * unwrapped Tensor refers to the same TensorImpl.
+   */
+  void freeze() {
+    frozen_ = false;
+    get();
+    frozen_ = true;
+  }
+
+  bool frozen() const {
+    return frozen_;
+  }
+
  private:
   // Source of truth for the list
   exec_aten::ArrayRef<EValue*> wrapped_vals_;
   // Same size as wrapped_vals
   mutable T* unwrapped_vals_;
+  // Whether unwrapped_vals_ is up to date for good, see freeze().
+  bool frozen_ = false;
 };
 
 template <>
@@ -498,6 +517,9 @@ EVALUE_DEFINE_TO(
 
 template <typename T>
 exec_aten::ArrayRef<T> BoxedEvalueList<T>::get() const {
+  if (frozen_) {
+    return exec_aten::ArrayRef<T>{unwrapped_vals_, wrapped_vals_.size()};
+  }
   for (typename exec_aten::ArrayRef<T>::size_type i = 0;
        i < wrapped_vals_.size();
        i++) {
@@ -7,6 +7,7 @@
  */
 
 #include <executorch/runtime/core/evalue.h>
+#include <executorch/runtime/platform/compiler.h>
 #include <executorch/runtime/platform/platform.h>
 #include <stdlib.h>
 #include <cstdint>
@@ -30,6 +31,8 @@ constexpr ChainID kUnsetChainId = -1;
 constexpr DebugHandle kUnsetDebugHandle = 0;
 // Default bundled input index to indicate that it hasn't been set yet.
 constexpr int kUnsetBundledInputIndex = -1;
+/// Memory id of the tensors that are not memory planned, e.g. constants.
+constexpr int32_t kUnplannedMemoryId = -1;
 
 /// Different types of delegate debug identifiers that are supported currently.
 enum class DelegateDebugIdType {
@@ -66,6 +69,35 @@ enum class EventTracerDebugLogLevel {
   kIntermediateOutputs,
 };
 
+/**
+ * Hardware performance counter values, e.g. read with perf_event_open(2) on
+ * Linux. Counters that are not available on the target read as zero.
+ */
+struct EventTracerPerfCounters {
+  /// CPU cycles.
+  uint64_t cycles;
+  /// Retired instructions.
+  uint64_t instructions;
+  /// Level 1 data cache read misses.
+  uint64_t l1d_cache_misses;
+  /// Last level cache misses, i.e. the L2 cache on most mobile CPUs.
+  uint64_t ll_cache_misses;
+  /// Cycles stalled in the backend of the pipeline, mostly waiting for memory.
+  uint64_t stalled_cycles;
+};
+
+/**
+ * The bytes an instruction read from and wrote to one memory buffer, summed
+ * over the tensors of its arguments.
+ */
+struct EventTracerMemoryTraffic {
+  /// Index of the memory-planned buffer, as in
+  /// MethodMeta::memory_planned_buffer_size(), or kUnplannedMemoryId.
+  int32_t mem_id;
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+};
+
 /**
  * This is the struct which should be returned when a profiling event is
  * started. This is used to uniquely identify that profiling event and will be
@@ -91,6 +123,9 @@ struct EventTracerEntry {
   /// refer to the DelegateMappingBuilder library present in
   /// executorch/exir/backend/utils.py.
   DelegateDebugIdType delegate_event_id_type;
+  /// The hardware performance counters when this event was started, only set
+  /// by event tracers that capture them.
+  EventTracerPerfCounters start_counters;
 };
 /**
  * EventTracer is a class that users can inherit and implement to
@@ -256,6 +291,21 @@ class EventTracer {
       const EValue& evalue,
       LoggedEValueType evalue_type) = 0;
 
+  /**
+   * Log the bytes that the current instruction, as set by
+   * set_chain_debug_handle(), read from and wrote to each buffer, derived
+   * from the sizes of the tensors of its arguments. This is only called when
+   * memory traffic tracing was enabled before the method was loaded, see
+   * set_memory_traffic_tracing(). Event tracers that do not need it can
+   * ignore it.
+   *
+   * @param[in] traffic One entry per buffer that the instruction touched.
+   * @param[in] num_buffers Number of entries in traffic.
+   */
+  virtual void log_memory_traffic(
+      __ET_UNUSED const EventTracerMemoryTraffic* traffic,
+      __ET_UNUSED size_t num_buffers) {}
+
   /**
    * Helper function to set the chain id ands debug handle. Users have two
    * options, the first is that they can directly pass in the chain id and debug
@@ -322,6 +372,23 @@ class EventTracer {
     return event_tracer_debug_level_;
   }
 
+  /**
+   * Enable or disable memory traffic tracing, in which the Method reports the
+   * bytes each instruction moves through log_memory_traffic(). Methods only
+   * trace it if it was enabled when they were loaded, as they then allocate
+   * the bookkeeping it needs.
+   */
+  void set_memory_traffic_tracing(bool enabled) {
+    trace_memory_traffic_ = enabled;
+  }
+
+  /**
+   * Return whether memory traffic tracing is enabled.
+   */
+  bool memory_traffic_tracing_enabled() {
+    return trace_memory_traffic_;
+  }
+
   /**
    * Return the current status of intermediate outputs logging mode.
    */
@@ -355,6 +422,7 @@ class EventTracer {
   bool event_tracer_enable_debugging_ = false;
   bool log_intermediate_tensors_ = false;
   int bundled_input_index_ = kUnsetBundledInputIndex;
+  bool trace_memory_traffic_ = false;
   EventTracerDebugLogLevel event_tracer_debug_level_ =
       EventTracerDebugLogLevel::kNoLogging;
 };
@@ -69,7 +69,7 @@ void resize_tensor_to_assert_dynamic_unbound(Tensor&& t) {
 #ifdef USE_ATEN_LIB
   EXPECT_EQ(resize_tensor(t, ArrayRef<SizesType>({100, 100})), Error::Ok);
 #else
-  // TODO(T175194371): For now, we can't resize past the original capacity.
+  // Without a DynamicAllocator, we can't resize past the original capacity.
   EXPECT_NE(resize_tensor(t, ArrayRef<SizesType>({100, 100})), Error::Ok);
 #endif
 }
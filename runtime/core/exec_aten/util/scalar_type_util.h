@@ -865,20 +865,54 @@ inline exec_aten::ScalarType promoteTypes(
 // by ExecuTorch.
 //
 
-#ifdef ET_INTERNAL_CHECK_SELECTIVE_BUILD
-#define ET_INTERNAL_SWITCH_CASE(enum_type, CTYPE_ALIAS, ...)  \
-  case enum_type: {                                           \
-    ET_INTERNAL_CHECK_SELECTIVE_BUILD(enum_type);             \
-    using CTYPE_ALIAS = ScalarTypeToCppType<enum_type>::type; \
-    return __VA_ARGS__();                                     \
+// Whether the switch cases of `enum_type` are compiled in. Dtype-selective
+// builds redefine it in kernels/portable/cpu/selective_build.h. It is expanded
+// with the switch, so that the two headers may be included in any order.
+#ifndef ET_INTERNAL_SELECTED_DTYPE
+#define ET_INTERNAL_SELECTED_DTYPE(enum_type) true
+#endif
+
+namespace internal {
+
+/// Aborts on a dtype left out of a dtype-selective build. Kept out of line so
+/// that each unselected switch case only costs a call.
+__ET_NORETURN __ET_NOINLINE inline void dtype_not_selected(
+    const char* name,
+    exec_aten::ScalarType dtype) {
+  ET_LOG(
+      Error,
+      "dtype '%" PRId8 "' not selected for operator %s",
+      static_cast<int8_t>(dtype),
+      name);
+  torch::executor::runtime_abort();
+}
+
+/**
+ * Returns `fn()` if `kSelected`. Otherwise aborts, without instantiating the
+ * body of `fn`, so that the code of unselected dtypes is left out of the
+ * binary.
+ */
+template <bool kSelected, typename Fn>
+inline auto call_if_dtype_selected(
+    const Fn& fn,
+    __ET_UNUSED const char* name,
+    __ET_UNUSED exec_aten::ScalarType dtype) -> decltype(fn()) {
+  if constexpr (kSelected) {
+    return fn();
+  } else {
+    dtype_not_selected(name, dtype);
   }
-#else
-#define ET_INTERNAL_SWITCH_CASE(enum_type, CTYPE_ALIAS, ...)  \
-  case enum_type: {                                           \
-    using CTYPE_ALIAS = ScalarTypeToCppType<enum_type>::type; \
-    return __VA_ARGS__();                                     \
+}
+
+} // namespace internal
+
+#define ET_INTERNAL_SWITCH_CASE(enum_type, CTYPE_ALIAS, ...)       \
+  case enum_type: {                                                \
+    using CTYPE_ALIAS = ScalarTypeToCppType<enum_type>::type;      \
+    return ::torch::executor::internal::call_if_dtype_selected<    \
+        ET_INTERNAL_SELECTED_DTYPE(enum_type)>(                    \
+        __VA_ARGS__, et_switch_name, enum_type);                   \
   }
-#endif
 
 #define ET_INTERNAL_SWITCH(TYPE, CONTEXT, NAME, ...) \
   [&] {                                              \
@@ -149,6 +149,12 @@ class MemoryAllocator {
     return size_;
   }
 
+  // Returns the number of bytes allocated since the last reset, including
+  // alignment padding.
+  virtual size_t used_size() const {
+    return static_cast<size_t>(cur_ - begin_);
+  }
+
   // Resets the current pointer to the base address. It does nothing to
   // the contents.
   virtual void reset() {
@@ -15,8 +15,15 @@ namespace executor {
 
 /// Denotes the specific genre of compute device.
 /// Subset of https://github.com/pytorch/pytorch/blob/main/c10/core/Device.h
+/// The values match c10::DeviceType.
 enum class DeviceType : int8_t {
   CPU = 0,
+  CUDA = 1,
+  Vulkan = 10,
+  Metal = 11,
+  MPS = 13,
+  /// Any other accelerator, e.g. an NPU.
+  PrivateUse1 = 20,
 };
 
 /// An index representing a specific device; For cpu it should always be -1 or 0
@@ -28,7 +35,8 @@ using DeviceIndex = int8_t;
  * just a skeleton to allow certain kernels that expect device as an
  * argument to still be run.
  *
- * In ExecuTorch this is always expected to be CPU.
+ * Tensors are always expected to be on CPU. The other device types describe
+ * the memory that backends may leave delegate outputs in, see DeviceBuffer.
  */
 struct Device final {
   using Type = DeviceType;
@@ -38,7 +46,7 @@ struct Device final {
   /* implicit */ Device(DeviceType type, DeviceIndex index = -1)
       : type_(type), index_(index) {}
 
-  /// Returns the type of device this is. Only CPU is supported.
+  /// Returns the type of device this is.
   DeviceType type() const noexcept {
     return type_;
   }
@@ -48,9 +56,10 @@ struct Device final {
     return type_ == DeviceType::CPU;
   }
 
-  /// Returns the device index. Always 0 if specified or -1 if not provided.
+  /// Returns the device index, or -1 if not provided. For CPU, always 0 if
+  /// specified.
   DeviceIndex index() const noexcept {
-    ET_CHECK(index_ == 0 || index_ == -1);
+    ET_CHECK(!is_cpu() || index_ == 0 || index_ == -1);
     return index_;
   }
 
@@ -98,12 +98,31 @@ Error TensorImpl::internal_resize_contiguous(ArrayRef<SizesType> new_sizes) {
 
   auto new_numel = compute_numel(new_sizes.data(), dim_);
 
-  // Upper bounded tensors can be reshaped but not beyond upper bound
+  auto new_nbytes = new_numel * elementSize(type_);
+
+  // Unbounded tensors grow their data through their allocator, if they have
+  // one. Tensors without data, e.g. ones that were not memory-planned, get it
+  // on their first resize.
+  if (shape_dynamism_ == TensorShapeDynamism::DYNAMIC_UNBOUND &&
+      dynamic_allocator_ != nullptr &&
+      (new_nbytes > capacity_ || (data_ == nullptr && new_nbytes > 0))) {
+    size_t capacity = data_ == nullptr ? 0 : capacity_;
+    void* new_data = dynamic_allocator_->reallocate(
+        data_, data_ == nullptr ? 0 : nbytes(), new_nbytes, &capacity);
+    ET_CHECK_OR_RETURN_ERROR(
+        new_data != nullptr,
+        MemoryAllocationFailed,
+        "Failed to grow an unbounded tensor from %zu to %zu bytes",
+        capacity_,
+        new_nbytes);
+    data_ = new_data;
+    capacity_ = capacity;
+  }
+
+  // Upper bounded tensors can be reshaped but not beyond upper bound, nor can
+  // unbounded tensors without an allocator.
   if (shape_dynamism_ == TensorShapeDynamism::DYNAMIC_BOUND ||
-      // TODO(T175194371): Unbounded tensor resizing is not yet supported: treat
-      // them as upper-bounded.
       shape_dynamism_ == TensorShapeDynamism::DYNAMIC_UNBOUND) {
-    auto new_nbytes = new_numel * elementSize(type_);
     ET_CHECK_OR_RETURN_ERROR(
         new_nbytes <= capacity_,
         NotSupported,
@@ -11,6 +11,7 @@
 #include <sys/types.h> // TODO(T126923429): Include size_t, ssize_t
 
 #include <executorch/runtime/core/array_ref.h>
+#include <executorch/runtime/core/dynamic_allocator.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/portable_type/scalar_type.h>
 #include <executorch/runtime/core/tensor_shape_dynamism.h>
@@ -191,6 +192,16 @@ class TensorImpl {
     data_ = ptr;
   }
 
+  /**
+   * Sets the allocator that a DYNAMIC_UNBOUND tensor uses to grow its data
+   * when resized beyond its capacity. Without one, unbounded tensors cannot
+   * grow past the size they were created with. Has no effect on tensors with
+   * other shape dynamisms.
+   */
+  void set_dynamic_allocator(DynamicAllocator* allocator) {
+    dynamic_allocator_ = allocator;
+  }
+
   /*
    * DEPRECATED: Use torch::executor::resize_tensor() or
    * torch::executor::resize_tensor_impl().
@@ -235,6 +246,9 @@ class TensorImpl {
   /// Pointer to underlying data blob. NOTE: Can be null.
   void* data_;
 
+  /// Grows data_ of DYNAMIC_UNBOUND tensors. NOTE: Can be null.
+  DynamicAllocator* dynamic_allocator_ = nullptr;
+
   /// Tensor's number of dimensions.
   const ssize_t dim_;
 
@@ -12,6 +12,8 @@
 #include <executorch/runtime/platform/runtime.h>
 
 #include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
 #include <random>
 
 using namespace ::testing;
@@ -258,13 +260,137 @@ TEST_F(TensorImplTest, TestSetSizesContigUnbounded) {
   err = resize_tensor_impl(&t, {new_sizes_4, 1});
   EXPECT_NE(err, Error::Ok);
 
-  // TODO(T175194371): For now, we can't resize past the original capacity.
-  // Once we can, this test should check for that ability.
-
   SizesType new_sizes_3[2] = {4, 2};
-  // Can't execeed original capacity.
+  // Can't execeed original capacity without a dynamic allocator.
+  err = resize_tensor_impl(&t, {new_sizes_3, 2});
+  EXPECT_NE(err, Error::Ok);
+}
+
+namespace {
+// Hands out heap buffers and counts the calls.
+class CountingDynamicAllocator : public DynamicAllocator {
+ public:
+  ~CountingDynamicAllocator() override {
+    std::free(block_);
+  }
+
+  void* reallocate(void* data, size_t used, size_t size, size_t* capacity)
+      override {
+    ++num_calls;
+    if (fail) {
+      return nullptr;
+    }
+    void* block = std::malloc(size);
+    if (used > 0) {
+      std::memcpy(block, data, used);
+    }
+    std::free(block_);
+    block_ = block;
+    *capacity = size;
+    return block;
+  }
+
+  int num_calls = 0;
+  bool fail = false;
+
+ private:
+  void* block_ = nullptr;
+};
+} // namespace
+
+TEST_F(TensorImplTest, TestSetSizesContigUnboundedGrows) {
+  SizesType sizes[2] = {3, 2};
+  DimOrderType dim_order[2] = {0, 1};
+  StridesType strides[2] = {2, 1};
+  float data[6] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  TensorImpl t(
+      ScalarType::Float,
+      2,
+      sizes,
+      data,
+      dim_order,
+      strides,
+      TensorShapeDynamism::DYNAMIC_UNBOUND);
+  CountingDynamicAllocator allocator;
+  t.set_dynamic_allocator(&allocator);
+
+  // Resizing within capacity keeps the data where it is.
+  SizesType new_sizes_1[2] = {1, 2};
+  Error err = resize_tensor_impl(&t, {new_sizes_1, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(t.data(), data);
+  EXPECT_EQ(allocator.num_calls, 0);
+
+  // Resizing beyond it moves the data in use to a larger buffer.
+  SizesType new_sizes_2[2] = {4, 3};
+  err = resize_tensor_impl(&t, {new_sizes_2, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(allocator.num_calls, 1);
+  EXPECT_NE(t.data(), data);
+  EXPECT_EQ(t.numel(), 12);
+  EXPECT_EQ(t.strides()[0], 3);
+  EXPECT_EQ(t.mutable_data<float>()[0], 1.0);
+  EXPECT_EQ(t.mutable_data<float>()[1], 2.0);
+
+  // The new capacity sticks.
+  SizesType new_sizes_3[2] = {2, 6};
   err = resize_tensor_impl(&t, {new_sizes_3, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(allocator.num_calls, 1);
+
+  // Failures leave the tensor unchanged.
+  allocator.fail = true;
+  void* old_data = t.mutable_data();
+  SizesType new_sizes_4[2] = {8, 8};
+  err = resize_tensor_impl(&t, {new_sizes_4, 2});
+  EXPECT_NE(err, Error::Ok);
+  EXPECT_EQ(t.mutable_data(), old_data);
+  EXPECT_EQ(t.numel(), 12);
+}
+
+TEST_F(TensorImplTest, TestSetSizesContigUnboundedAllocatesMissingData) {
+  SizesType sizes[1] = {4};
+  DimOrderType dim_order[1] = {0};
+  StridesType strides[1] = {1};
+  TensorImpl t(
+      ScalarType::Float,
+      1,
+      sizes,
+      /*data=*/nullptr,
+      dim_order,
+      strides,
+      TensorShapeDynamism::DYNAMIC_UNBOUND);
+  CountingDynamicAllocator allocator;
+  t.set_dynamic_allocator(&allocator);
+
+  // Even a resize to the same size allocates the data.
+  SizesType new_sizes[1] = {4};
+  Error err = resize_tensor_impl(&t, {new_sizes, 1});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_NE(t.data(), nullptr);
+  EXPECT_EQ(allocator.num_calls, 1);
+}
+
+TEST_F(TensorImplTest, TestSetSizesContigBoundedIgnoresDynamicAllocator) {
+  SizesType sizes[1] = {4};
+  DimOrderType dim_order[1] = {0};
+  StridesType strides[1] = {1};
+  float data[4] = {};
+  TensorImpl t(
+      ScalarType::Float,
+      1,
+      sizes,
+      data,
+      dim_order,
+      strides,
+      TensorShapeDynamism::DYNAMIC_BOUND);
+  CountingDynamicAllocator allocator;
+  t.set_dynamic_allocator(&allocator);
+
+  SizesType new_sizes[1] = {5};
+  Error err = resize_tensor_impl(&t, {new_sizes, 1});
   EXPECT_NE(err, Error::Ok);
+  EXPECT_EQ(allocator.num_calls, 0);
 }
 
 TEST_F(TensorImplTest, TestWriteRead) {
@@ -30,6 +30,7 @@ def define_common_targets():
         exported_headers = [
             "array_ref.h",  # TODO(T157717874): Migrate all users to span and then move this to portable_type
             "data_loader.h",
+            "dynamic_allocator.h",
             "error.h",
             "freeable_buffer.h",
             "result.h",
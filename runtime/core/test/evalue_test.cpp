@@ -164,6 +164,32 @@ TEST(TestEValue, BoxedEvalueList) {
   EXPECT_EQ(unwrapped[2], 3);
 }
 
+TEST(TestEValue, FrozenBoxedEvalueList) {
+  EValue values[2] = {EValue((int64_t)1), EValue((int64_t)2)};
+  EValue* values_p[2] = {&values[0], &values[1]};
+  int64_t storage[2] = {0, 0};
+  BoxedEvalueList<int64_t> x{values_p, storage, 2};
+  EXPECT_FALSE(x.frozen());
+
+  // Unfrozen lists see updates to the values.
+  values[0] = EValue((int64_t)3);
+  EXPECT_EQ(x.get()[0], 3);
+
+  // Frozen lists are unwrapped once, and keep returning the same result.
+  x.freeze();
+  EXPECT_TRUE(x.frozen());
+  EXPECT_EQ(storage[0], 3);
+  EXPECT_EQ(storage[1], 2);
+  values[1] = EValue((int64_t)4);
+  auto unwrapped = x.get();
+  EXPECT_EQ(unwrapped.data(), storage);
+  EXPECT_EQ(unwrapped[1], 2);
+
+  // Copies share the frozen state.
+  EValue e(x);
+  EXPECT_EQ(e.toIntList()[1], 2);
+}
+
 TEST(TestEValue, toOptionalTensorList) {
   // create list, empty evalue ctor gets tag::None
   EValue values[2] = {EValue(), EValue()};
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <executorch/runtime/core/dynamic_allocator.h>
 #include <executorch/runtime/core/hierarchical_allocator.h>
 #include <executorch/runtime/core/memory_allocator.h>
 
@@ -48,14 +49,20 @@ class MemoryManager final {
    *     uses it. May be `nullptr` if the Method does not use kernels or
    *     delegates that allocate temporary data. This allocator will be reset
    *     after every kernel or delegate call during execution.
+   * @param[in] dynamic_allocator The allocator that tensors with
+   *     DYNAMIC_UNBOUND shape dynamism use to grow their data. Must outlive
+   *     the Method that uses it. May be `nullptr`, in which case Methods with
+   *     unbounded tensors fail to load.
    */
   explicit MemoryManager(
       MemoryAllocator* method_allocator,
       HierarchicalAllocator* planned_memory = nullptr,
-      MemoryAllocator* temp_allocator = nullptr)
+      MemoryAllocator* temp_allocator = nullptr,
+      DynamicAllocator* dynamic_allocator = nullptr)
       : method_allocator_(method_allocator),
         planned_memory_(planned_memory),
-        temp_allocator_(temp_allocator) {
+        temp_allocator_(temp_allocator),
+        dynamic_allocator_(dynamic_allocator) {
     ET_CHECK_MSG(
         method_allocator != temp_allocator,
         "method allocator cannot be the same as temp allocator");
@@ -107,10 +114,19 @@ class MemoryManager final {
     return temp_allocator_;
   }
 
+  /**
+   * Returns the allocator that tensors with DYNAMIC_UNBOUND shape dynamism use
+   * to grow their data, or nullptr if unbounded tensors are not supported.
+   */
+  DynamicAllocator* dynamic_allocator() const {
+    return dynamic_allocator_;
+  }
+
  private:
   MemoryAllocator* method_allocator_;
   HierarchicalAllocator* planned_memory_;
   MemoryAllocator* temp_allocator_;
+  DynamicAllocator* dynamic_allocator_;
 };
 
 } // namespace executor
@@ -8,9 +8,12 @@
 
 #include <executorch/runtime/executor/method.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes> // @donotremove
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/event_tracer_hooks.h>
@@ -38,18 +41,14 @@ namespace executor {
 class BackendDelegate final {
  public:
   /**
-   * Initializes an already-allocated BackendDelegate from its serialized
-   * representation.
+   * Prepares an already-allocated BackendDelegate from its serialized
+   * representation, up to calling the backend's init(): looks up the backend,
+   * loads the delegate data and parses the compile specs.
    *
-   * @param[in] delegate The serialized backend delegate to load.
-   * @param[in] program The serialized program to load from.
-   * @param[in] backend_init_context The context pointer to pass to the
-   *     backend's init() method.
-   * @param[out] out The BackendDelegate to initialize.
-   *
-   * @returns Error::Ok if the initialization succeeded, or an error otherwise.
+   * On success, InitBackend() must be called on `out` before it is used or
+   * destroyed.
    */
-  static Error Init(
+  static Error Prepare(
       const executorch_flatbuffer::BackendDelegate& delegate,
       const Program* program,
       BackendInitContext& backend_init_context,
@@ -85,32 +84,61 @@ class BackendDelegate final {
       ET_LOG(Error, "Failed to get compile specs for backend %s", backend_id);
       return err;
     }
-    size_t num_compile_specs = delegate.compile_specs()->size();
 
     out->backend_ = backend;
+    out->backend_id_ = backend_id;
     out->handle_ = nullptr;
+    out->compile_specs_ = compile_specs;
+    out->num_compile_specs_ = delegate.compile_specs()->size();
     // Pass a pointer to this buffer to the backend. It's safe for the backend
     // to point its handle to this object, since it will outlive the backend.
     new (&out->segment_) FreeableBuffer(std::move(processed_data.get()));
+    return Error::Ok;
+  }
 
-    // Initialize the delegate.
-    Result<DelegateHandle*> handle = backend->init(
+  /**
+   * Calls the init() of the backend found by Prepare(). On failure, the
+   * delegate is left in a state that is safe to destroy.
+   */
+  Error InitBackend(BackendInitContext& backend_init_context) {
+    Result<DelegateHandle*> handle = backend_->init(
         backend_init_context,
-        &out->segment_,
-        ArrayRef<CompileSpec>(compile_specs, num_compile_specs));
+        &segment_,
+        ArrayRef<CompileSpec>(compile_specs_, num_compile_specs_));
     if (!handle.ok()) {
       ET_LOG(
           Error,
           "Init failed for backend %s: 0x%" PRIx32,
-          backend_id,
+          backend_id_,
           static_cast<uint32_t>(handle.error()));
-      out->segment_.Free();
+      segment_.Free();
+      // There is no handle to destroy.
+      backend_ = nullptr;
       return handle.error();
     }
-    out->handle_ = handle.get();
+    handle_ = handle.get();
     return Error::Ok;
   }
 
+  /// Returns true if the backend found by Prepare() has a thread-safe init().
+  bool has_thread_safe_init() const {
+    return backend_->is_init_thread_safe();
+  }
+
+  /// Returns the backend that runs the delegate.
+  const PyTorchBackendInterface* backend() const {
+    return backend_;
+  }
+
+  /**
+   * Releases a delegate that was prepared, but whose backend init() was never
+   * called, so that it is safe to destroy.
+   */
+  void CancelInit() {
+    segment_.Free();
+    backend_ = nullptr;
+  }
+
   ~BackendDelegate() {
     if (backend_ != nullptr) {
       backend_->destroy(handle_);
@@ -124,6 +152,13 @@ class BackendDelegate final {
     return backend_->execute(backend_execution_context, handle_, args);
   }
 
+  Error ExecuteBatch(
+      BackendExecutionContext& backend_execution_context,
+      ArrayRef<EValue**> batch) const {
+    EXECUTORCH_SCOPE_PROF("delegate_execute_batch");
+    return backend_->execute_batch(backend_execution_context, handle_, batch);
+  }
+
  private:
   // Not constructible.
   BackendDelegate() = delete;
@@ -196,6 +231,57 @@ class BackendDelegate final {
   FreeableBuffer segment_;
   const PyTorchBackendInterface* backend_;
   DelegateHandle* handle_;
+  // Only used between Prepare() and InitBackend().
+  const char* backend_id_;
+  CompileSpec* compile_specs_;
+  size_t num_compile_specs_;
+};
+
+/**
+ * Pre-decoded form of an instruction, so that the fast dispatch loop of
+ * Method::execute() does not need to read the flatbuffer.
+ */
+struct DecodedInstruction {
+  enum class Kind : uint8_t {
+    KernelCall,
+    JumpFalseCall,
+    /// Any other instruction, run through Method::execute_instruction().
+    Other,
+    /// A KernelCall run once by Method::init(), skipped by execution. See
+    /// Method::fold_constant_instructions().
+    Folded,
+  };
+
+  Kind kind;
+  /// JumpFalseCall: the instruction to jump to if the condition is false.
+  uint32_t jump_target;
+  /// KernelCall: the kernel to call.
+  OpFunction kernel;
+  /// KernelCall: the argument list of the kernel.
+  EValue** args;
+  /// KernelCall: the data returned by the kernel's prepack function, if any.
+  const void* prepacked_data;
+  /// JumpFalseCall: the condition value.
+  EValue* cond_value;
+  /// The values that a delegate call may have left in device memory, copied
+  /// to host memory before the instruction runs. See
+  /// Method::init_device_placement().
+  const uint32_t* device_syncs;
+  uint32_t n_device_syncs;
+};
+
+/**
+ * Where the data of a value is, if a backend may leave delegate outputs in
+ * device memory.
+ */
+struct DevicePlacement {
+  /// The backend whose device holds the data, or null if it is in host
+  /// memory.
+  const PyTorchBackendInterface* backend;
+  /// The device buffer holding the data, if `backend` is non-null.
+  DeviceBuffer buffer;
+  /// Whether delegate calls may leave the value in device memory.
+  bool may_stay_on_device;
 };
 
 /**
@@ -209,10 +295,74 @@ struct Chain {
   Span<InstructionArgs> argument_lists_;
   /// Each instruction will have one kernel (not for delegate).
   OpFunction* kernels_;
+  /// The instructions of the chain, decoded at init time.
+  DecodedInstruction* decoded_instructions_;
+
+  /// Inter-op schedule, set by experimental_enable_inter_op_parallelism()
+  /// only if the chain can run in parallel. Wave `w` holds the independent
+  /// instructions wave_instructions_[wave_offsets_[w]:wave_offsets_[w + 1]].
+  const uint32_t* wave_instructions_;
+  const uint32_t* wave_offsets_;
+  size_t n_waves_;
+};
+
+/**
+ * Bookkeeping of memory traffic tracing, see
+ * EventTracer::set_memory_traffic_tracing().
+ */
+struct MemoryTrafficState {
+  /// For each value, the planned buffer of its tensor, or kUnplannedMemoryId.
+  int32_t* value_mem_ids;
+  /// For each value, the key of the instruction that writes its tensor, see
+  /// memory_traffic_key(), or kTrafficNotWritten.
+  uint64_t* value_writers;
+  /// One entry per planned buffer, then one for the unplanned tensors.
+  EventTracerMemoryTraffic* traffic;
+  size_t num_buffers;
 };
 
 namespace {
 
+/// The value is only read by the instructions.
+constexpr uint64_t kTrafficNotWritten = UINT64_MAX;
+/// The value is written by the first instruction that touches it.
+constexpr uint64_t kTrafficUnseen = UINT64_MAX - 1;
+
+uint64_t memory_traffic_key(size_t chain_idx, size_t instr_idx) {
+  return (static_cast<uint64_t>(chain_idx) << 32) | instr_idx;
+}
+
+// Calls fn once for the index of each value in `args`, and for the items of
+// its tensor list arguments.
+template <typename Fn>
+void for_each_arg_value(
+    InstructionArgs args,
+    const EValue* values,
+    const flatbuffers::Vector<
+        flatbuffers::Offset<executorch_flatbuffer::EValue>>* s_values,
+    size_t num_values,
+    Fn&& fn) {
+  for (size_t i = 0; i < args.size(); i++) {
+    // The out argument of a kernel is also passed as its return value.
+    if (std::find(args.begin(), args.begin() + i, args[i]) !=
+        args.begin() + i) {
+      continue;
+    }
+    const size_t value_idx = args[i] - values;
+    fn(value_idx);
+    const auto s_value = s_values->Get(value_idx);
+    if (s_value->val_type() == executorch_flatbuffer::KernelTypes::TensorList) {
+      const auto items = s_value->val_as_TensorList()->items();
+      for (size_t j = 0; j < items->size(); j++) {
+        if (items->Get(j) >= 0 &&
+            static_cast<size_t>(items->Get(j)) < num_values) {
+          fn(static_cast<size_t>(items->Get(j)));
+        }
+      }
+    }
+  }
+}
+
 Result<InstructionArgs> gen_instruction_arguments(
     MemoryAllocator* method_allocator,
     size_t num_values,
@@ -234,6 +384,78 @@ Result<InstructionArgs> gen_instruction_arguments(
   return InstructionArgs(arg_list, num_args);
 }
 
+/**
+ * Layout of the kernel cache written by
+ * Method::experimental_export_kernel_cache(), in host byte order. The header
+ * is followed by one uint32_t per kernel call of the method, in chain and
+ * instruction order: the index of its kernel in get_kernels().
+ */
+struct KernelCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t kernels_fingerprint;
+  uint32_t num_kernel_calls;
+  uint32_t reserved;
+};
+
+constexpr uint32_t kKernelCacheMagic = 0x434B5445; // "ETKC"
+constexpr uint32_t kKernelCacheVersion = 1;
+
+size_t count_kernel_calls(const executorch_flatbuffer::ExecutionPlan* plan) {
+  size_t count = 0;
+  const auto chains = plan->chains();
+  for (size_t i = 0; chains != nullptr && i < chains->size(); ++i) {
+    const auto instructions = chains->Get(i)->instructions();
+    for (size_t j = 0; instructions != nullptr && j < instructions->size();
+         ++j) {
+      if (instructions->Get(j) != nullptr &&
+          instructions->Get(j)->instr_args_type() ==
+              executorch_flatbuffer::InstructionArguments::KernelCall) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+/**
+ * Returns the kernel indices of `cache` if it was exported for `plan` by a
+ * process with the same registered kernels, or an empty span so that the
+ * kernels are resolved by name.
+ */
+Span<const uint32_t> parse_kernel_cache(
+    Span<const uint8_t> cache,
+    const executorch_flatbuffer::ExecutionPlan* plan) {
+  if (cache.empty()) {
+    return {};
+  }
+  KernelCacheHeader header;
+  if (cache.size() < sizeof(header) ||
+      reinterpret_cast<uintptr_t>(cache.data()) % alignof(uint32_t) != 0) {
+    ET_LOG(Info, "Ignoring kernel cache: too short or misaligned");
+    return {};
+  }
+  memcpy(&header, cache.data(), sizeof(header));
+  if (header.magic != kKernelCacheMagic ||
+      header.version != kKernelCacheVersion) {
+    ET_LOG(Info, "Ignoring kernel cache: unknown format");
+    return {};
+  }
+  if (header.kernels_fingerprint != get_kernels_fingerprint()) {
+    ET_LOG(Info, "Ignoring kernel cache: the registered kernels changed");
+    return {};
+  }
+  const size_t num_kernel_calls = count_kernel_calls(plan);
+  if (header.num_kernel_calls != num_kernel_calls ||
+      cache.size() < sizeof(header) + num_kernel_calls * sizeof(uint32_t)) {
+    ET_LOG(Info, "Ignoring kernel cache: exported for another method");
+    return {};
+  }
+  return {
+      reinterpret_cast<const uint32_t*>(cache.data() + sizeof(header)),
+      num_kernel_calls};
+}
+
 Result<bool> parse_cond_value(const EValue& cond_value) {
   // The cond value attached to the JF instruction at the beginning of an
   // if/else branch is a Tensor which we parse and decide whether to continue
@@ -273,15 +495,130 @@ Result<bool> parse_cond_value(const EValue& cond_value) {
   return true;
 }
 
+/**
+ * Returns the indices of the items of a serialized list, or nullptr if the
+ * value is not a list of EValues.
+ */
+const flatbuffers::Vector<int32_t>* get_list_items(
+    const executorch_flatbuffer::EValue* serialization_value) {
+  if (serialization_value == nullptr || serialization_value->val() == nullptr) {
+    return nullptr;
+  }
+  switch (serialization_value->val_type()) {
+    case executorch_flatbuffer::KernelTypes::IntList:
+      return serialization_value->val_as_IntList()->items();
+    case executorch_flatbuffer::KernelTypes::TensorList:
+      return serialization_value->val_as_TensorList()->items();
+    case executorch_flatbuffer::KernelTypes::OptionalTensorList:
+      return serialization_value->val_as_OptionalTensorList()->items();
+    default:
+      return nullptr;
+  }
+}
+
+// Whether the tensor is backed by constant data, from the program or from the
+// ExternalConstantProvider, instead of a memory-planned allocation.
+bool is_constant_tensor(const executorch_flatbuffer::Tensor* s_tensor) {
+  return (s_tensor->constant_buffer_idx() > 0 ||
+          s_tensor->constant_name() != nullptr) &&
+      s_tensor->allocation_info() == nullptr;
+}
+
 } // namespace
 
-Error Method::parse_values() {
+Error Method::load_constant_segments() {
+  if (!program_->has_method_constant_segments()) {
+    return Error::Ok;
+  }
+  const auto* internal_program = program_->get_internal_program();
+  const auto* segment_indices = internal_program->constant_segment_indices();
+  const size_t n_segment = internal_program->segments()->size();
+  auto method_allocator = memory_manager_->method_allocator();
+
+  // Find the segments holding the constant tensors of the plan.
+  bool* used =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, bool, n_segment);
+  std::fill(used, used + n_segment, false);
+  const auto* values = serialization_plan_->values();
+  ET_CHECK_OR_RETURN_ERROR(values != nullptr, InvalidProgram, "Missing values");
+  for (const auto* value : *values) {
+    if (value->val_type() != executorch_flatbuffer::KernelTypes::Tensor) {
+      continue;
+    }
+    const uint32_t buffer_idx = value->val_as_Tensor()->constant_buffer_idx();
+    if (buffer_idx > 0) {
+      ET_CHECK_OR_RETURN_ERROR(
+          buffer_idx < segment_indices->size(),
+          InvalidProgram,
+          "Constant buffer index %" PRIu32 " out of range %" PRIu32,
+          buffer_idx,
+          segment_indices->size());
+      used[segment_indices->Get(buffer_idx)] = true;
+    }
+  }
+
+  constant_segments_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      method_allocator, FreeableBuffer, n_segment);
+  for (size_t i = 0; i < n_segment; ++i) {
+    if (!used[i]) {
+      new (&constant_segments_[i]) FreeableBuffer();
+      continue;
+    }
+    Result<FreeableBuffer> segment = program_->LoadSegment(i);
+    if (!segment.ok()) {
+      ET_LOG(
+          Error,
+          "Failed to load constant segment %zu: 0x%" PRIx32,
+          i,
+          static_cast<uint32_t>(segment.error()));
+      n_constant_segment_ = i;
+      return segment.error();
+    }
+    new (&constant_segments_[i]) FreeableBuffer(std::move(segment.get()));
+  }
+  n_constant_segment_ = n_segment;
+  return Error::Ok;
+}
+
+Error Method::parse_values(bool lazy) {
   auto flatbuffer_values = serialization_plan_->values();
   ET_CHECK_OR_RETURN_ERROR(
       flatbuffer_values != nullptr, InvalidProgram, "Missing values");
   size_t n_value = flatbuffer_values->size();
   values_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
       memory_manager_->method_allocator(), EValue, n_value);
+  {
+    Error err = find_written_values();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
+  if (lazy) {
+    value_parsed_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+        memory_manager_->method_allocator(), bool, n_value);
+    // Start from None values, the deferred ones stay so until parsed. None
+    // holds nothing to destroy, so parse_value() can overwrite it.
+    for (size_t i = 0; i < n_value; ++i) {
+      new (&values_[i]) EValue();
+      value_parsed_[i] = false;
+    }
+    n_value_ = n_value;
+    // Inputs and outputs are set and read before any instruction runs.
+    for (size_t i = 0; i < inputs_size(); ++i) {
+      Error err = ensure_value_parsed(get_input_index(i));
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+    for (size_t i = 0; i < outputs_size(); ++i) {
+      Error err = ensure_value_parsed(get_output_index(i));
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+    return Error::Ok;
+  }
 
   // n_value_ counts the number of successfully-initialized values for ~Method()
   // to clean up, and is incremented at the bottom of the loop. This makes it
@@ -289,151 +626,356 @@ Error Method::parse_values() {
   n_value_ = 0;
 
   for (size_t i = 0; i < n_value; ++i) {
-    auto serialization_value = flatbuffer_values->Get(i);
-    // Ensure that the `val_as_X()` calls will return non-null pointers.
-    ET_CHECK_OR_RETURN_ERROR(
-        serialization_value != nullptr &&
-            (serialization_value->val_type() ==
-                 executorch_flatbuffer::KernelTypes::Null ||
-             serialization_value->val() != nullptr),
-        InvalidProgram,
-        "Null value at index %zu",
-        i);
-
-    switch (serialization_value->val_type()) {
-      case executorch_flatbuffer::KernelTypes::Null: {
-        // Placement new as the list elements are not initialized, so calling
-        // copy assignment is not defined if its non trivial (Imagine the
-        // garbage in values_[i] thinks its an at::Tensor).
-        new (&values_[i]) EValue();
-      } break;
-      case executorch_flatbuffer::KernelTypes::Int: {
-        new (&values_[i]) EValue(serialization_value->val_as_Int()->int_val());
-      } break;
-      case executorch_flatbuffer::KernelTypes::Double: {
-        new (&values_[i])
-            EValue(serialization_value->val_as_Double()->double_val());
-      } break;
-      case executorch_flatbuffer::KernelTypes::Bool: {
-        new (&values_[i])
-            EValue(serialization_value->val_as_Bool()->bool_val());
-      } break;
-      case executorch_flatbuffer::KernelTypes::IntList: {
-        const auto items = serialization_value->val_as_IntList()->items();
-        ET_CHECK_OR_RETURN_ERROR(
-            items != nullptr, InvalidProgram, "Missing list at index %zu", i);
-        // Allocate space for boxed and unboxed list representations using
-        // values_ as source of truth
-        auto* evalp_list =
-            memory_manager_->method_allocator()->allocateList<EValue*>(
-                items->size());
-        auto* int_list =
-            memory_manager_->method_allocator()->allocateList<int64_t>(
-                items->size());
-
-        // initialize boxed list
-        for (size_t j = 0; j < items->size(); j++) {
-          evalp_list[j] = &values_[static_cast<size_t>(items->Get(j))];
-        }
-        new (&values_[i]) EValue(
-            BoxedEvalueList<int64_t>(evalp_list, int_list, items->size()));
-      } break;
-      case executorch_flatbuffer::KernelTypes::BoolList: {
-        const auto items = serialization_value->val_as_BoolList()->items();
-        ET_CHECK_OR_RETURN_ERROR(
-            items != nullptr, InvalidProgram, "Missing list at index %zu", i);
-        // NOTE: This is technically not portable. A platform could technically
-        // define boolean as something longer than a byte. This would be an
-        // exceptionally rare case, and this type is currently unused in any
-        // operators in ATen that we would need to support. To be properly
-        // portable here we need to allocate a new array of bool and copy cast
-        // the flatbuffer data into it, but because of how exceptionally rare
-        // this case is its low prio TODO: jakeszwe
-        new (&values_[i]) EValue(exec_aten::ArrayRef<bool>(
-            (const bool*)items->data(), items->size()));
-      } break;
-      case executorch_flatbuffer::KernelTypes::DoubleList: {
-        const auto items = serialization_value->val_as_DoubleList()->items();
-        ET_CHECK_OR_RETURN_ERROR(
-            items != nullptr, InvalidProgram, "Missing list at index %zu", i);
-        new (&values_[i])
-            EValue(exec_aten::ArrayRef<double>(items->data(), items->size()));
-      } break;
-      case executorch_flatbuffer::KernelTypes::String: {
-        const auto fb_str = serialization_value->val_as_String()->string_val();
-        ET_CHECK_OR_RETURN_ERROR(
-            fb_str != nullptr,
-            InvalidProgram,
-            "Missing string at index %zu",
-            i);
-        new (&values_[i]) EValue(fb_str->c_str(), fb_str->size());
-      } break;
-      case executorch_flatbuffer::KernelTypes::Tensor: {
-        auto t = deserialization::parseTensor(
-            program_, memory_manager_, serialization_value->val_as_Tensor());
-        if (!t.ok()) {
-          ET_LOG(
-              Error,
-              "Failed parsing tensor at index %zu: 0x%" PRIx32,
-              i,
-              static_cast<uint32_t>(t.error()));
-          return t.error();
-        }
-        new (&values_[i]) EValue(t.get());
-      } break;
-      case executorch_flatbuffer::KernelTypes::TensorList: {
-        // get list of serialization tensors and allocate storage for executor
-        // tensors
-        auto tensors = deserialization::parseTensorList(
-            serialization_value->val_as_TensorList()->items(),
-            values_,
-            memory_manager_);
-        if (!tensors.ok()) {
-          ET_LOG(
-              Error,
-              "Failed parsing tensor list at index %zu: 0x%" PRIx32,
-              i,
-              static_cast<uint32_t>(tensors.error()));
-          return tensors.error();
+    Error err = parse_value(i);
+    if (err != Error::Ok) {
+      return err;
+    }
+
+    // ~Method() will try to clean up n_value_ entries in the values_ array.
+    // Only increment this once we know the entry is valid, so that we don't try
+    // to clean up an uninitialized entry.
+    n_value_ = i + 1;
+  }
+  // Lists may point to values after them, so wait for all of them.
+  for (size_t i = 0; i < n_value; ++i) {
+    freeze_list_if_constant(i);
+  }
+  return Error::Ok;
+}
+
+Error Method::find_written_values() {
+  const auto* s_values = serialization_plan_->values();
+  const size_t n_value = s_values->size();
+  if (n_value == 0) {
+    return Error::Ok;
+  }
+  const size_t n_byte = (n_value + 7) / 8;
+  value_written_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      memory_manager_->method_allocator(), uint8_t, n_byte);
+  std::memset(value_written_, 0, n_byte);
+
+  // Kernels and backends update the Tensors they write in place, but may
+  // assign other values, e.g. the ints that sym_size returns.
+  const auto mark = [&](int32_t index, bool including_tensors) {
+    // Invalid indices are reported when parsing the instructions.
+    if (index < 0 || static_cast<size_t>(index) >= n_value) {
+      return;
+    }
+    const auto* s_value = s_values->Get(index);
+    if (!including_tensors && s_value != nullptr &&
+        s_value->val_type() == executorch_flatbuffer::KernelTypes::Tensor) {
+      return;
+    }
+    value_written_[index / 8] |= 1 << (index % 8);
+  };
+
+  // Callers can assign to inputs and outputs with mutable_input() and
+  // mutable_output().
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    mark(serialization_plan_->inputs()->Get(i), /*including_tensors=*/true);
+  }
+  for (size_t i = 0; i < outputs_size(); ++i) {
+    mark(serialization_plan_->outputs()->Get(i), /*including_tensors=*/true);
+  }
+
+  const auto* chains = serialization_plan_->chains();
+  if (chains == nullptr) {
+    return Error::Ok;
+  }
+  for (const auto* s_chain : *chains) {
+    if (s_chain == nullptr || s_chain->instructions() == nullptr) {
+      continue;
+    }
+    for (const auto* instruction : *s_chain->instructions()) {
+      if (instruction == nullptr || instruction->instr_args() == nullptr) {
+        continue;
+      }
+      const flatbuffers::Vector<int32_t>* args = nullptr;
+      switch (instruction->instr_args_type()) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+          args = instruction->instr_args_as_KernelCall()->args();
+          break;
+        case executorch_flatbuffer::InstructionArguments::DelegateCall:
+          args = instruction->instr_args_as_DelegateCall()->args();
+          break;
+        case executorch_flatbuffer::InstructionArguments::MoveCall:
+          mark(
+              instruction->instr_args_as_MoveCall()->move_to(),
+              /*including_tensors=*/true);
+          break;
+        default:
+          break;
+      }
+      if (args != nullptr) {
+        for (size_t j = 0; j < args->size(); ++j) {
+          mark(args->Get(j), /*including_tensors=*/false);
         }
-        new (&values_[i]) EValue(tensors.get());
-      } break;
-      case executorch_flatbuffer::KernelTypes::OptionalTensorList: {
-        // Same as TensorList but optional<Tensor> instead of Tensor
-        auto tensors =
-            deserialization::parseListOptionalType<exec_aten::Tensor>(
-                serialization_value->val_as_OptionalTensorList()->items(),
-                values_,
-                memory_manager_);
-        if (!tensors.ok()) {
+      }
+    }
+  }
+  return Error::Ok;
+}
+
+void Method::freeze_list_if_constant(size_t i) {
+  if (value_written_ == nullptr) {
+    return;
+  }
+  const auto* s_values = serialization_plan_->values();
+  const auto* items = get_list_items(s_values->Get(i));
+  if (items == nullptr) {
+    return;
+  }
+  const bool optional_items = s_values->Get(i)->val_type() ==
+      executorch_flatbuffer::KernelTypes::OptionalTensorList;
+  for (size_t j = 0; j < items->size(); ++j) {
+    const int32_t index = items->Get(j);
+    if (index < 0 && optional_items) {
+      continue;
+    }
+    // Leave malformed lists to fail when a kernel reads them, as before.
+    if (index < 0 || static_cast<size_t>(index) >= n_value_) {
+      return;
+    }
+    if (value_written_[index / 8] & (1 << (index % 8))) {
+      return;
+    }
+    const EValue& item = values_[index];
+    const bool valid_item = s_values->Get(i)->val_type() ==
+            executorch_flatbuffer::KernelTypes::IntList
+        ? item.isInt()
+        : item.isTensor() || (optional_items && item.isNone());
+    if (!valid_item) {
+      return;
+    }
+  }
+
+  auto& payload = values_[i].payload.copyable_union;
+  switch (values_[i].tag) {
+    case Tag::ListInt:
+      payload.as_int_list.freeze();
+      break;
+    case Tag::ListTensor:
+      payload.as_tensor_list.freeze();
+      break;
+    case Tag::ListOptionalTensor:
+      payload.as_list_optional_tensor.freeze();
+      break;
+    default:
+      break;
+  }
+}
+
+Error Method::set_external_constant_data(
+    const executorch_flatbuffer::Tensor* s_tensor,
+    const exec_aten::Tensor& tensor) {
+  const char* name = s_tensor->constant_name()->c_str();
+  ET_CHECK_OR_RETURN_ERROR(
+      s_tensor->constant_buffer_idx() == 0 &&
+          s_tensor->allocation_info() == nullptr,
+      InvalidProgram,
+      "External constant '%s' also has program data",
+      name);
+  ET_CHECK_OR_RETURN_ERROR(
+      external_constants_.get_constant != nullptr,
+      NotFound,
+      "Constant '%s' is external, but no ExternalConstantProvider was given",
+      name);
+  Result<const void*> data = external_constants_.get_constant(
+      external_constants_.context, name, tensor.nbytes());
+  if (!data.ok()) {
+    return data.error();
+  }
+  // The const_cast is 'ok' here because the provider guarantees that this
+  // data is never modified, like that of the program's constants.
+  return internal::set_tensor_data(
+      tensor, const_cast<void*>(data.get()), tensor.nbytes());
+}
+
+Error Method::parse_value(size_t i) {
+  auto serialization_value = serialization_plan_->values()->Get(i);
+  // Ensure that the `val_as_X()` calls will return non-null pointers.
+  ET_CHECK_OR_RETURN_ERROR(
+      serialization_value != nullptr &&
+          (serialization_value->val_type() ==
+               executorch_flatbuffer::KernelTypes::Null ||
+           serialization_value->val() != nullptr),
+      InvalidProgram,
+      "Null value at index %zu",
+      i);
+
+  switch (serialization_value->val_type()) {
+    case executorch_flatbuffer::KernelTypes::Null: {
+      // Placement new as the list elements are not initialized, so calling
+      // copy assignment is not defined if its non trivial (Imagine the
+      // garbage in values_[i] thinks its an at::Tensor).
+      new (&values_[i]) EValue();
+    } break;
+    case executorch_flatbuffer::KernelTypes::Int: {
+      new (&values_[i]) EValue(serialization_value->val_as_Int()->int_val());
+    } break;
+    case executorch_flatbuffer::KernelTypes::Double: {
+      new (&values_[i])
+          EValue(serialization_value->val_as_Double()->double_val());
+    } break;
+    case executorch_flatbuffer::KernelTypes::Bool: {
+      new (&values_[i]) EValue(serialization_value->val_as_Bool()->bool_val());
+    } break;
+    case executorch_flatbuffer::KernelTypes::IntList: {
+      const auto items = serialization_value->val_as_IntList()->items();
+      ET_CHECK_OR_RETURN_ERROR(
+          items != nullptr, InvalidProgram, "Missing list at index %zu", i);
+      // Allocate space for boxed and unboxed list representations using
+      // values_ as source of truth
+      auto* evalp_list =
+          memory_manager_->method_allocator()->allocateList<EValue*>(
+              items->size());
+      auto* int_list =
+          memory_manager_->method_allocator()->allocateList<int64_t>(
+              items->size());
+
+      // initialize boxed list
+      for (size_t j = 0; j < items->size(); j++) {
+        evalp_list[j] = &values_[static_cast<size_t>(items->Get(j))];
+      }
+      new (&values_[i]) EValue(
+          BoxedEvalueList<int64_t>(evalp_list, int_list, items->size()));
+    } break;
+    case executorch_flatbuffer::KernelTypes::BoolList: {
+      const auto items = serialization_value->val_as_BoolList()->items();
+      ET_CHECK_OR_RETURN_ERROR(
+          items != nullptr, InvalidProgram, "Missing list at index %zu", i);
+      // NOTE: This is technically not portable. A platform could technically
+      // define boolean as something longer than a byte. This would be an
+      // exceptionally rare case, and this type is currently unused in any
+      // operators in ATen that we would need to support. To be properly
+      // portable here we need to allocate a new array of bool and copy cast
+      // the flatbuffer data into it, but because of how exceptionally rare
+      // this case is its low prio TODO: jakeszwe
+      new (&values_[i]) EValue(exec_aten::ArrayRef<bool>(
+          (const bool*)items->data(), items->size()));
+    } break;
+    case executorch_flatbuffer::KernelTypes::DoubleList: {
+      const auto items = serialization_value->val_as_DoubleList()->items();
+      ET_CHECK_OR_RETURN_ERROR(
+          items != nullptr, InvalidProgram, "Missing list at index %zu", i);
+      new (&values_[i])
+          EValue(exec_aten::ArrayRef<double>(items->data(), items->size()));
+    } break;
+    case executorch_flatbuffer::KernelTypes::String: {
+      const auto fb_str = serialization_value->val_as_String()->string_val();
+      ET_CHECK_OR_RETURN_ERROR(
+          fb_str != nullptr, InvalidProgram, "Missing string at index %zu", i);
+      new (&values_[i]) EValue(fb_str->c_str(), fb_str->size());
+    } break;
+    case executorch_flatbuffer::KernelTypes::Tensor: {
+      const auto* s_tensor = serialization_value->val_as_Tensor();
+      auto t = deserialization::parseTensor(
+          program_,
+          memory_manager_,
+          s_tensor,
+          {constant_segments_, n_constant_segment_});
+      if (!t.ok()) {
+        ET_LOG(
+            Error,
+            "Failed parsing tensor at index %zu: 0x%" PRIx32,
+            i,
+            static_cast<uint32_t>(t.error()));
+        return t.error();
+      }
+      if (s_tensor->constant_name() != nullptr) {
+        Error err = set_external_constant_data(s_tensor, t.get());
+        if (err != Error::Ok) {
           ET_LOG(
               Error,
-              "Failed parsing optional tensor list at index %zu: 0x%" PRIx32,
+              "Failed getting constant '%s' at index %zu: 0x%" PRIx32,
+              s_tensor->constant_name()->c_str(),
               i,
-              static_cast<uint32_t>(tensors.error()));
-          return tensors.error();
+              static_cast<uint32_t>(err));
+          return err;
         }
-        new (&values_[i]) EValue(tensors.get());
-      } break;
-      default:
-        // flatbuffer enums start at 0, but they generate a hidden NONE enum
-        // and give it that value. schema.fbs doesnt show this type, so I
-        // subtract one to keep the output in 0 based indexing for a
-        // disgruntled debugger seeing this error message and checking
-        // schema.fbs
+      }
+      new (&values_[i]) EValue(t.get());
+    } break;
+    case executorch_flatbuffer::KernelTypes::TensorList: {
+      // get list of serialization tensors and allocate storage for executor
+      // tensors
+      auto tensors = deserialization::parseTensorList(
+          serialization_value->val_as_TensorList()->items(),
+          values_,
+          memory_manager_);
+      if (!tensors.ok()) {
         ET_LOG(
             Error,
-            "Unknown KernelTypes value %" PRIu32 " at index %zu",
-            static_cast<uint32_t>(serialization_value->val_type()) - 1,
-            i);
-        return Error::InvalidProgram;
-    }
+            "Failed parsing tensor list at index %zu: 0x%" PRIx32,
+            i,
+            static_cast<uint32_t>(tensors.error()));
+        return tensors.error();
+      }
+      new (&values_[i]) EValue(tensors.get());
+    } break;
+    case executorch_flatbuffer::KernelTypes::OptionalTensorList: {
+      // Same as TensorList but optional<Tensor> instead of Tensor
+      auto tensors = deserialization::parseListOptionalType<exec_aten::Tensor>(
+          serialization_value->val_as_OptionalTensorList()->items(),
+          values_,
+          memory_manager_);
+      if (!tensors.ok()) {
+        ET_LOG(
+            Error,
+            "Failed parsing optional tensor list at index %zu: 0x%" PRIx32,
+            i,
+            static_cast<uint32_t>(tensors.error()));
+        return tensors.error();
+      }
+      new (&values_[i]) EValue(tensors.get());
+    } break;
+    default:
+      // flatbuffer enums start at 0, but they generate a hidden NONE enum
+      // and give it that value. schema.fbs doesnt show this type, so I
+      // subtract one to keep the output in 0 based indexing for a
+      // disgruntled debugger seeing this error message and checking
+      // schema.fbs
+      ET_LOG(
+          Error,
+          "Unknown KernelTypes value %" PRIu32 " at index %zu",
+          static_cast<uint32_t>(serialization_value->val_type()) - 1,
+          i);
+      return Error::InvalidProgram;
+  }
+  return Error::Ok;
+}
 
-    // ~Method() will try to clean up n_value_ entries in the values_ array.
-    // Only increment this once we know the entry is valid, so that we don't try
-    // to clean up an uninitialized entry.
-    n_value_ = i + 1;
+Error Method::ensure_value_parsed(size_t i) {
+  if (value_parsed_ == nullptr) {
+    return Error::Ok;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      i < n_value_, InvalidProgram, "Value index %zu >= %zu", i, n_value_);
+  if (value_parsed_[i]) {
+    return Error::Ok;
+  }
+  // Set first so that a list containing itself does not recurse forever.
+  value_parsed_[i] = true;
+
+  // Lists point to their items, which must be parsed first.
+  const auto* items = get_list_items(serialization_plan_->values()->Get(i));
+  Error err = Error::Ok;
+  if (items != nullptr) {
+    for (size_t j = 0; j < items->size() && err == Error::Ok; ++j) {
+      // Optional lists use -1 for None items.
+      if (items->Get(j) >= 0) {
+        err = ensure_value_parsed(static_cast<size_t>(items->Get(j)));
+      }
+    }
+  }
+  if (err == Error::Ok) {
+    err = parse_value(i);
   }
+  if (err != Error::Ok) {
+    value_parsed_[i] = false;
+    return err;
+  }
+  freeze_list_if_constant(i);
   return Error::Ok;
 }
 
@@ -481,7 +1023,8 @@ Error Method::resolve_operator(
     OpFunction* kernels,
     size_t kernel_index,
     InstructionArgs args,
-    size_t n_args) {
+    size_t n_args,
+    PrepackFunction* prepack) {
   // TODO(T153505381, T153506819) Investigate optimizing this function for both
   // space and time.
 
@@ -495,14 +1038,45 @@ Error Method::resolve_operator(
       "Op index %" PRIu32 " out of range",
       op_index);
   const auto& op = ops->Get(op_index);
+  auto method_allocator = memory_manager_->method_allocator();
+
+  // Without kernel keys, the arguments do not take part in the lookup, so all
+  // the call sites of an operator share its kernel.
+  const bool memoize = !has_specialized_kernels();
+  if (memoize) {
+    if (resolved_operators_ == nullptr) {
+      resolved_operators_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+          method_allocator, ResolvedOperator, ops->size());
+      std::memset(
+          resolved_operators_, 0, ops->size() * sizeof(ResolvedOperator));
+    }
+    const ResolvedOperator& resolved = resolved_operators_[op_index];
+    if (resolved.kernel != nullptr) {
+      kernels[kernel_index] = resolved.kernel;
+      *prepack = resolved.prepack;
+      return Error::Ok;
+    }
+  }
 
   Error err = populate_operator_name(op, kTempBufferSizeForName, operator_name);
   if (err != Error::Ok) {
     return err;
   }
 
+  if (memoize) {
+    if (!hasOpsFn(operator_name)) {
+      ET_LOG(Error, "Missing operator: [%d] %s", op_index, operator_name);
+      return Error::OperatorMissing;
+    }
+    ResolvedOperator& resolved = resolved_operators_[op_index];
+    resolved.kernel = getOpsFn(operator_name);
+    resolved.prepack = getPrepackFn(operator_name);
+    kernels[kernel_index] = resolved.kernel;
+    *prepack = resolved.prepack;
+    return Error::Ok;
+  }
+
   // resolve tensor meta
-  auto method_allocator = memory_manager_->method_allocator();
   TensorMeta* meta =
       ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, TensorMeta, n_args);
   size_t count = 0;
@@ -531,6 +1105,7 @@ Error Method::resolve_operator(
   if (hasOpsFn(operator_name, ArrayRef<TensorMeta>(meta, count))) {
     kernels[kernel_index] =
         getOpsFn(operator_name, ArrayRef<TensorMeta>(meta, count));
+    *prepack = getPrepackFn(operator_name);
     return Error::Ok;
   } else {
     ET_LOG(Error, "Missing operator: [%d] %s", op_index, operator_name);
@@ -538,22 +1113,549 @@ Error Method::resolve_operator(
   }
 }
 
-Result<Method> Method::load(
-    executorch_flatbuffer::ExecutionPlan* s_plan,
-    const Program* program,
-    MemoryManager* memory_manager,
-    EventTracer* event_tracer) {
-  Method method(program, memory_manager, event_tracer);
-  Error err = method.init(s_plan);
-  if (err != Error::Ok) {
-    return err;
+Error Method::resolve_operator_from_cache(
+    int32_t op_index,
+    uint32_t cached_kernel,
+    OpFunction* kernels,
+    size_t kernel_index,
+    PrepackFunction* prepack) {
+  constexpr size_t kTempBufferSizeForName = 100;
+  char operator_name[kTempBufferSizeForName];
+  const auto ops = serialization_plan_->operators();
+  ET_CHECK_OR_RETURN_ERROR(
+      ops != nullptr && op_index < ops->size(),
+      InvalidProgram,
+      "Op index %" PRIu32 " out of range",
+      op_index);
+  Error err = populate_operator_name(
+      ops->Get(op_index), kTempBufferSizeForName, operator_name);
+  if (err != Error::Ok) {
+    return err;
+  }
+
+  // The fingerprint of the cache guarantees that the index refers to the
+  // same kernel as when it was exported; the name catches caches exported for
+  // another program.
+  ArrayRef<Kernel> registered = get_kernels();
+  if (cached_kernel >= registered.size() ||
+      strcmp(registered[cached_kernel].name_, operator_name) != 0) {
+    return Error::NotFound;
+  }
+  kernels[kernel_index] = registered[cached_kernel].op_;
+  *prepack = getPrepackFn(operator_name);
+  return Error::Ok;
+}
+
+Result<const void*> Method::prepack_kernel_call(
+    PrepackFunction prepack,
+    InstructionArgs args,
+    const int32_t* arg_idxs) {
+  auto method_allocator = memory_manager_->method_allocator();
+  const auto values = serialization_plan_->values();
+  bool* arg_is_constant =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, bool, args.size());
+  for (size_t i = 0; i < args.size(); ++i) {
+    // Constant tensors are backed by the program's constant buffer instead of
+    // a memory-planned allocation, so their data never changes.
+    const auto s_value = values->Get(arg_idxs[i]);
+    const auto s_tensor =
+        s_value->val_type() == executorch_flatbuffer::KernelTypes::Tensor
+        ? s_value->val_as_Tensor()
+        : nullptr;
+    arg_is_constant[i] = s_tensor != nullptr && is_constant_tensor(s_tensor);
+  }
+  KernelPrepackContext context(method_allocator, arg_is_constant, args.size());
+  return prepack(context, args.data());
+}
+
+namespace {
+
+/**
+ * Forwards allocations to another allocator one at a time, so that backends
+ * initializing delegates concurrently can share the method allocator.
+ */
+class SerializedAllocator final : public MemoryAllocator {
+ public:
+  explicit SerializedAllocator(MemoryAllocator* allocator)
+      : MemoryAllocator(0, nullptr), allocator_(allocator) {}
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    while (lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    void* ptr = allocator_->allocate(size, alignment);
+    lock_.clear(std::memory_order_release);
+    return ptr;
+  }
+
+  uint8_t* base_address() const override {
+    return allocator_->base_address();
+  }
+
+  uint32_t size() const override {
+    return allocator_->size();
+  }
+
+ private:
+  MemoryAllocator* allocator_;
+  std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
+struct DelegateInitTasks {
+  BackendDelegate* delegates;
+  const uint32_t* delegate_indices;
+  Error* errors;
+  BackendInitContext* backend_init_context;
+};
+
+void run_delegate_init_task(void* context, size_t task_index) {
+  auto* tasks = static_cast<DelegateInitTasks*>(context);
+  tasks->errors[task_index] =
+      tasks->delegates[tasks->delegate_indices[task_index]].InitBackend(
+          *tasks->backend_init_context);
+}
+
+/**
+ * Finds the first instruction that calls the delegate at `delegate_index`, so
+ * that the events of its init() are attributed to that instruction, which
+ * identifies the delegate and its backend. Returns false if there is none.
+ */
+bool find_delegate_call(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    size_t delegate_index,
+    ChainID* chain_id,
+    DebugHandle* instruction_id) {
+  const auto chains = plan->chains();
+  if (chains == nullptr) {
+    return false;
+  }
+  for (size_t i = 0; i < chains->size(); ++i) {
+    const auto instructions = chains->Get(i)->instructions();
+    if (instructions == nullptr) {
+      continue;
+    }
+    for (size_t j = 0; j < instructions->size(); ++j) {
+      const auto instruction = instructions->Get(j);
+      if (instruction != nullptr && instruction->instr_args() != nullptr &&
+          instruction->instr_args_type() ==
+              executorch_flatbuffer::InstructionArguments::DelegateCall &&
+          instruction->instr_args_as_DelegateCall()->delegate_index() ==
+              delegate_index) {
+        *chain_id = static_cast<ChainID>(i);
+        *instruction_id = static_cast<DebugHandle>(j);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+Error Method::resolve_kernel_call(Chain& chain, size_t instr_idx) {
+  // We know that instr_args_as_KernelCall is non-null because it was checked
+  // at init time.
+  auto instruction = chain.s_chain_->instructions()->Get(instr_idx);
+  auto kernel_call = instruction->instr_args_as_KernelCall();
+  const auto arg_idxs = kernel_call->args();
+  for (size_t i = 0; i < arg_idxs->size(); ++i) {
+    Error err = ensure_value_parsed(arg_idxs->Get(i));
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
+  InstructionArgs args = chain.argument_lists_[instr_idx];
+  PrepackFunction prepack = nullptr;
+  Error err = resolve_operator(
+      kernel_call->op_index(),
+      chain.kernels_,
+      instr_idx,
+      args,
+      args.size(),
+      &prepack);
+  if (err != Error::Ok) {
+    return err;
+  }
+  const void* prepacked_data = nullptr;
+  if (prepack != nullptr) {
+    auto prepacked = prepack_kernel_call(prepack, args, arg_idxs->data());
+    if (!prepacked.ok()) {
+      return prepacked.error();
+    }
+    prepacked_data = prepacked.get();
+  }
+  auto& decoded = chain.decoded_instructions_[instr_idx];
+  decoded.kernel = chain.kernels_[instr_idx];
+  decoded.prepacked_data = prepacked_data;
+  return Error::Ok;
+}
+
+Error Method::resolve_deferred_kernel_calls() {
+  if (value_parsed_ == nullptr) {
+    return Error::Ok;
+  }
+  for (size_t i = 0; i < n_chains_; ++i) {
+    auto& chain = chains_[i];
+    const size_t num_instructions = chain.s_chain_->instructions()->size();
+    for (size_t instr_idx = 0; instr_idx < num_instructions; ++instr_idx) {
+      if (chain.decoded_instructions_[instr_idx].kind ==
+              DecodedInstruction::Kind::KernelCall &&
+          chain.kernels_[instr_idx] == nullptr) {
+        Error err = resolve_kernel_call(chain, instr_idx);
+        if (err != Error::Ok) {
+          return err;
+        }
+      }
+    }
+  }
+  return Error::Ok;
+}
+
+Error Method::fold_constant_instructions() {
+  if (n_value_ == 0) {
+    return Error::Ok;
+  }
+  MemoryAllocator* method_allocator = memory_manager_->method_allocator();
+  MemoryAllocator* temp_allocator = memory_manager_->temp_allocator();
+  const auto s_values = serialization_plan_->values();
+
+  // How the instructions and callers use each value.
+  enum : uint8_t {
+    // Returned by a kernel call, which writes it.
+    kReturned = 1 << 0,
+    // Written other than by the one kernel call returning it.
+    kAssigned = 1 << 1,
+    // A constant tensor of the program, or an output of a folded call.
+    kConstant = 1 << 2,
+    // Touched by an instruction visited so far.
+    kSeen = 1 << 3,
+  };
+  uint8_t* flags =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, uint8_t, n_value_);
+  std::memset(flags, 0, n_value_);
+
+  // Calls fn for the index of a value and, if it is a list, of its items.
+  const auto for_each_item = [&](size_t value_idx, auto&& fn) {
+    fn(value_idx);
+    const auto items = get_list_items(s_values->Get(value_idx));
+    if (items == nullptr) {
+      return;
+    }
+    for (size_t j = 0; j < items->size(); ++j) {
+      if (items->Get(j) >= 0 && static_cast<size_t>(items->Get(j)) < n_value_) {
+        fn(static_cast<size_t>(items->Get(j)));
+      }
+    }
+  };
+  const auto assign = [&](size_t value_idx) {
+    if (value_idx < n_value_) {
+      flags[value_idx] |= kAssigned;
+    }
+  };
+  const auto see = [&](size_t value_idx) { flags[value_idx] |= kSeen; };
+
+  // Callers can assign to inputs and outputs.
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    assign(get_input_index(i));
+  }
+  for (size_t i = 0; i < outputs_size(); ++i) {
+    assign(get_output_index(i));
+  }
+  // The program does not tell the outputs of a kernel call from its inputs,
+  // but the last argument of a kernel call is its return value: its out
+  // tensor, the list of its out tensors, or the value of a symbolic op.
+  // Kernels update their out tensors in place, so these are the values they
+  // write. Backends may write any argument of their delegates.
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    const Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); ++instr_idx) {
+      const auto instruction = instructions->Get(instr_idx);
+      const InstructionArgs args = chain.argument_lists_[instr_idx];
+      switch (instruction->instr_args_type()) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+          if (args.size() > 0) {
+            for_each_item(args[args.size() - 1] - values_, [&](size_t i) {
+              flags[i] |= (flags[i] & kReturned) ? kAssigned : kReturned;
+            });
+          }
+          break;
+        case executorch_flatbuffer::InstructionArguments::DelegateCall:
+          for (EValue* arg : args) {
+            for_each_item(arg - values_, assign);
+          }
+          break;
+        case executorch_flatbuffer::InstructionArguments::MoveCall:
+          assign(instruction->instr_args_as_MoveCall()->move_to());
+          break;
+        case executorch_flatbuffer::InstructionArguments::FreeCall:
+          assign(instruction->instr_args_as_FreeCall()->value_index());
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  // Constant tensors are backed by the program's constant buffer instead of
+  // a memory-planned allocation.
+  for (size_t i = 0; i < n_value_; ++i) {
+    const auto s_value = s_values->Get(i);
+    if (s_value->val_type() == executorch_flatbuffer::KernelTypes::Tensor &&
+        is_constant_tensor(s_value->val_as_Tensor()) &&
+        (flags[i] & (kReturned | kAssigned)) == 0) {
+      flags[i] |= kConstant;
+    }
+  }
+
+  size_t num_folded = 0;
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); ++instr_idx) {
+      DecodedInstruction& decoded = chain.decoded_instructions_[instr_idx];
+      const InstructionArgs args = chain.argument_lists_[instr_idx];
+      if (decoded.kind != DecodedInstruction::Kind::KernelCall ||
+          args.size() == 0) {
+        for (EValue* arg : args) {
+          for_each_item(arg - values_, see);
+        }
+        continue;
+      }
+
+      const size_t ret_idx = args[args.size() - 1] - values_;
+      const auto ret_type = s_values->Get(ret_idx)->val_type();
+      bool foldable = ret_type == executorch_flatbuffer::KernelTypes::Tensor ||
+          ret_type == executorch_flatbuffer::KernelTypes::TensorList;
+      // Calls fn for the index of each output tensor.
+      const auto for_each_output = [&](auto&& fn) {
+        if (ret_type == executorch_flatbuffer::KernelTypes::Tensor) {
+          fn(ret_idx);
+          return;
+        }
+        const auto items = get_list_items(s_values->Get(ret_idx));
+        if (items == nullptr) {
+          return;
+        }
+        for (size_t j = 0; j < items->size(); ++j) {
+          if (items->Get(j) >= 0 &&
+              static_cast<size_t>(items->Get(j)) < n_value_) {
+            fn(static_cast<size_t>(items->Get(j)));
+          }
+        }
+      };
+      const auto is_output = [&](size_t value_idx) {
+        bool found = false;
+        for_each_output([&](size_t i) { found |= i == value_idx; });
+        return found;
+      };
+
+      // The outputs must be planned tensors that only this call writes and
+      // that no earlier instruction touched, and every other value it reads
+      // must be the same on each execution.
+      if (foldable) {
+        size_t num_outputs = 0;
+        for_each_output([&](size_t i) {
+          num_outputs++;
+          foldable &= values_[i].isTensor() &&
+              s_values->Get(i)->val_as_Tensor()->allocation_info() !=
+                  nullptr &&
+              (flags[i] & (kAssigned | kConstant | kSeen)) == 0;
+        });
+        foldable &= num_outputs > 0;
+      }
+      for (size_t j = 0; foldable && j + 1 < args.size(); ++j) {
+        for_each_item(args[j] - values_, [&](size_t i) {
+          if (values_[i].isTensor()) {
+            foldable &= (flags[i] & kConstant) != 0 || is_output(i);
+          } else {
+            foldable &= (flags[i] & (kReturned | kAssigned)) == 0;
+          }
+        });
+      }
+
+      for (EValue* arg : args) {
+        for_each_item(arg - values_, see);
+      }
+      if (!foldable) {
+        continue;
+      }
+
+      // The planned memory of the outputs is reused by other tensors during
+      // execution, so give them their own. This is harmless if the call ends
+      // up not being folded.
+      bool allocated = true;
+      for_each_output([&](size_t i) {
+        const auto& tensor = values_[i].toTensor();
+        if (!allocated || tensor.nbytes() == 0) {
+          return;
+        }
+        void* data = method_allocator->allocate(tensor.nbytes());
+        allocated = data != nullptr &&
+            internal::set_tensor_data(tensor, data, tensor.nbytes()) ==
+                Error::Ok;
+      });
+      if (!allocated) {
+        ET_LOG(
+            Info,
+            "Out of memory for the outputs of instruction %zu:%zu, stopped "
+            "folding constants",
+            chain_idx,
+            instr_idx);
+        return Error::Ok;
+      }
+
+      KernelRuntimeContext context(
+          /*event_tracer=*/nullptr, temp_allocator, decoded.prepacked_data);
+      decoded.kernel(context, decoded.args);
+      if (temp_allocator != nullptr) {
+        temp_allocator->reset();
+      }
+      Error err = context.failure_state();
+      if (err != Error::Ok) {
+        step_state_ = StepState{chain_idx, instr_idx};
+        log_kernel_call_failure(err);
+        return err;
+      }
+      for_each_output([&](size_t i) { flags[i] |= kConstant; });
+      decoded.kind = DecodedInstruction::Kind::Folded;
+      num_folded++;
+    }
+  }
+  ET_LOG(Debug, "Folded %zu constant kernel calls", num_folded);
+  return Error::Ok;
+}
+
+Error Method::init_delegate(
+    size_t delegate_index,
+    BackendInitContext& context) {
+  ChainID chain_id = kUnsetChainId;
+  DebugHandle instruction_id = kUnsetDebugHandle;
+  if (event_tracer_ != nullptr) {
+    find_delegate_call(
+        serialization_plan_, delegate_index, &chain_id, &instruction_id);
+  }
+  internal::EventTracerProfileInstructionScope event_tracer_instr_scope =
+      internal::EventTracerProfileInstructionScope(
+          event_tracer_, chain_id, instruction_id);
+  internal::EventTracerProfileScope event_tracer_profile_scope =
+      internal::EventTracerProfileScope(event_tracer_, "Method::init_delegate");
+  return delegates_[delegate_index].InitBackend(context);
+}
+
+Error Method::init_delegates_parallel(
+    InterOpRunner runner,
+    void* runner_context) {
+  const auto delegates = serialization_plan_->delegates();
+  const size_t n_delegate = delegates->size();
+  auto method_allocator = memory_manager_->method_allocator();
+  // Backends initialized on this thread may profile their init() with the
+  // event tracer, which the parallel ones must not touch.
+  BackendInitContext backend_init_context(method_allocator, event_tracer_);
+
+  uint32_t* parallel_indices = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      method_allocator, uint32_t, n_delegate);
+  Error* errors =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, Error, n_delegate);
+  // Backends may keep using the allocator of the context after init(), so it
+  // must live as long as the method.
+  auto* serialized_allocator = ET_ALLOCATE_INSTANCE_OR_RETURN_ERROR(
+      method_allocator, SerializedAllocator);
+  new (serialized_allocator) SerializedAllocator(method_allocator);
+
+  // Data loaders and the method allocator are not thread safe, so everything
+  // up to the backend init() calls is done on this thread. If anything fails,
+  // delegates whose init() did not run are released before returning, and
+  // all entries are cleaned up by ~Method().
+  for (size_t i = 0; i < n_delegate; ++i) {
+    Error err = BackendDelegate::Prepare(
+        *delegates->Get(i), program_, backend_init_context, &delegates_[i]);
+    if (err != Error::Ok) {
+      for (size_t j = 0; j < i; ++j) {
+        delegates_[j].CancelInit();
+      }
+      n_delegate_ = i;
+      return err;
+    }
+  }
+  n_delegate_ = n_delegate;
+
+  // Backends that do not declare a thread-safe init() are initialized one
+  // after the other, before any of the others.
+  size_t n_parallel = 0;
+  for (size_t i = 0; i < n_delegate; ++i) {
+    if (delegates_[i].has_thread_safe_init()) {
+      parallel_indices[n_parallel++] = static_cast<uint32_t>(i);
+      continue;
+    }
+    Error err = init_delegate(i, backend_init_context);
+    if (err != Error::Ok) {
+      for (size_t j = i + 1; j < n_delegate; ++j) {
+        delegates_[j].CancelInit();
+      }
+      for (size_t j = 0; j < n_parallel; ++j) {
+        delegates_[parallel_indices[j]].CancelInit();
+      }
+      return err;
+    }
+  }
+  if (n_parallel == 0) {
+    return Error::Ok;
+  }
+
+  BackendInitContext parallel_init_context(serialized_allocator);
+  DelegateInitTasks tasks{
+      delegates_, parallel_indices, errors, &parallel_init_context};
+  if (n_parallel == 1) {
+    run_delegate_init_task(&tasks, 0);
+  } else {
+    runner(runner_context, n_parallel, &run_delegate_init_task, &tasks);
+  }
+  // Report the failure of the earliest delegate, as the sequential
+  // initialization would. Failed delegates are already safe to destroy.
+  for (size_t i = 0; i < n_parallel; ++i) {
+    if (errors[i] != Error::Ok) {
+      return errors[i];
+    }
+  }
+  return Error::Ok;
+}
+
+Result<Method> Method::load(
+    executorch_flatbuffer::ExecutionPlan* s_plan,
+    const Program* program,
+    MemoryManager* memory_manager,
+    EventTracer* event_tracer,
+    InterOpRunner delegate_init_runner,
+    void* delegate_init_runner_context,
+    bool lazy_values,
+    Span<const uint8_t> kernel_cache,
+    bool fold_constants,
+    const ExternalConstantProvider* external_constants) {
+  Method method(program, memory_manager, event_tracer);
+  Error err = method.init(
+      s_plan,
+      delegate_init_runner,
+      delegate_init_runner_context,
+      lazy_values,
+      kernel_cache,
+      fold_constants,
+      external_constants);
+  if (err != Error::Ok) {
+    return err;
   } else {
     ET_CHECK(method.initialized());
     return method;
   }
 }
 
-Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
+Error Method::init(
+    executorch_flatbuffer::ExecutionPlan* s_plan,
+    InterOpRunner delegate_init_runner,
+    void* delegate_init_runner_context,
+    bool lazy_values,
+    Span<const uint8_t> kernel_cache,
+    bool fold_constants,
+    const ExternalConstantProvider* external_constants) {
   EXECUTORCH_SCOPE_PROF("Method::init");
   internal::EventTracerProfileScope event_tracer_profile_scope =
       internal::EventTracerProfileScope(event_tracer_, "Method::init");
@@ -566,11 +1668,28 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
   init_state_ =
       InitializationState::InitializationFailed; // Until proven otherwise
   serialization_plan_ = s_plan;
+  if (external_constants != nullptr) {
+    // Kept for the values that are parsed lazily.
+    external_constants_ = *external_constants;
+  }
   auto method_allocator = memory_manager_->method_allocator();
 
+  {
+    internal::EventTracerProfileScope event_tracer_profile_scope =
+        internal::EventTracerProfileScope(
+            event_tracer_, "Method::load_constant_segments");
+    Error err = load_constant_segments();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
   {
     // Parse the elements of the values_ array.
-    Error err = parse_values();
+    internal::EventTracerProfileScope event_tracer_profile_scope =
+        internal::EventTracerProfileScope(
+            event_tracer_, "Method::parse_values");
+    Error err = parse_values(lazy_values);
     if (err != Error::Ok) {
       return err;
     }
@@ -578,6 +1697,9 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
 
   {
     // Resolve delegates
+    internal::EventTracerProfileScope event_tracer_profile_scope =
+        internal::EventTracerProfileScope(
+            event_tracer_, "Method::init_delegates");
     const auto delegates = serialization_plan_->delegates();
     ET_CHECK_OR_RETURN_ERROR(
         delegates != nullptr, InvalidProgram, "Missing delegates field");
@@ -590,23 +1712,39 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
     // makes it safe for errors to return without updating any state.
     n_delegate_ = 0;
 
-    for (size_t i = 0; i < n_delegate; ++i) {
-      const auto& delegate = *delegates->Get(i);
-      BackendInitContext backend_init_context(method_allocator);
-      Error err = BackendDelegate::Init(
-          delegate, program_, backend_init_context, &delegates_[i]);
+    if (delegate_init_runner != nullptr) {
+      Error err = init_delegates_parallel(
+          delegate_init_runner, delegate_init_runner_context);
       if (err != Error::Ok) {
         return err;
       }
-      // ~Method() will try to clean up n_delegate_ entries in the delegates_
-      // array. Only increment this once we know the entry is valid, so that
-      // we don't try to clean up an uninitialized entry.
-      n_delegate_ = i + 1;
+    } else {
+      for (size_t i = 0; i < n_delegate; ++i) {
+        const auto& delegate = *delegates->Get(i);
+        BackendInitContext backend_init_context(
+            method_allocator, event_tracer_);
+        Error err = BackendDelegate::Prepare(
+            delegate, program_, backend_init_context, &delegates_[i]);
+        if (err != Error::Ok) {
+          return err;
+        }
+        err = init_delegate(i, backend_init_context);
+        if (err != Error::Ok) {
+          return err;
+        }
+        // ~Method() will try to clean up n_delegate_ entries in the
+        // delegates_ array. Only increment this once we know the entry is
+        // valid, so that we don't try to clean up an uninitialized entry.
+        n_delegate_ = i + 1;
+      }
     }
   }
 
   {
-    // Load chains
+    // Load chains, resolving the operator of each kernel call.
+    internal::EventTracerProfileScope event_tracer_profile_scope =
+        internal::EventTracerProfileScope(
+            event_tracer_, "Method::resolve_operators");
     const auto chains = serialization_plan_->chains();
     ET_CHECK_OR_RETURN_ERROR(
         chains != nullptr && chains->size() > 0, InvalidProgram, "No chains");
@@ -614,6 +1752,12 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
     chains_ =
         ET_ALLOCATE_LIST_OR_RETURN_ERROR(method_allocator, Chain, n_chains_);
 
+    // Kernels exported by a previous run, indexed by the position of the
+    // kernel call in the method. Empty if there are none, or they are stale.
+    const Span<const uint32_t> cached_kernels =
+        parse_kernel_cache(kernel_cache, serialization_plan_);
+    size_t kernel_call_idx = 0;
+
     // Try resolving all operators before failing, to make it easier to debug
     // multiple problems at once.
     Error delayed_error = Error::Ok;
@@ -631,6 +1775,11 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
           method_allocator, OpFunction, num_instructions);
       auto chain_instruction_arg_lists = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
           method_allocator, InstructionArgs, num_instructions);
+      auto chain_decoded_instructions = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+          method_allocator, DecodedInstruction, num_instructions);
+      // Only read for kernel calls, which always set their entry.
+      const void** chain_prepacked_data = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+          method_allocator, const void*, num_instructions);
 
       // Set up the argument lists ahead of time and store pointers to them to
       // use when the instructions are called
@@ -660,12 +1809,35 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
               return res.error();
             }
             chain_instruction_arg_lists[instr_idx] = res.get();
-            auto err = resolve_operator(
-                instruction->instr_args_as_KernelCall()->op_index(),
-                chain_instruction_kernels,
-                instr_idx,
-                res.get(),
-                arg_idxs->size());
+            chain_instruction_kernels[instr_idx] = nullptr;
+            chain_prepacked_data[instr_idx] = nullptr;
+            if (value_parsed_ != nullptr) {
+              // Parsed and resolved by the first execution, see
+              // resolve_kernel_call().
+              break;
+            }
+            PrepackFunction prepack = nullptr;
+            const auto op_index =
+                instruction->instr_args_as_KernelCall()->op_index();
+            Error err = Error::NotFound;
+            if (!cached_kernels.empty()) {
+              err = resolve_operator_from_cache(
+                  op_index,
+                  cached_kernels[kernel_call_idx],
+                  chain_instruction_kernels,
+                  instr_idx,
+                  &prepack);
+            }
+            kernel_call_idx++;
+            if (err == Error::NotFound) {
+              err = resolve_operator(
+                  op_index,
+                  chain_instruction_kernels,
+                  instr_idx,
+                  res.get(),
+                  arg_idxs->size(),
+                  &prepack);
+            }
             if (err == Error::OperatorMissing) {
               num_instructions_missing_op++;
             } else if (err == Error::MemoryAllocationFailed) {
@@ -673,6 +1845,14 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
             } else {
               delayed_error = err;
             }
+            if (err == Error::Ok && prepack != nullptr) {
+              auto prepacked =
+                  prepack_kernel_call(prepack, res.get(), arg_idxs->data());
+              if (!prepacked.ok()) {
+                return prepacked.error();
+              }
+              chain_prepacked_data[instr_idx] = prepacked.get();
+            }
           } break;
           case executorch_flatbuffer::InstructionArguments::DelegateCall: {
             const auto arg_idxs =
@@ -691,6 +1871,14 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
               return res.error();
             }
             chain_instruction_arg_lists[instr_idx] = res.get();
+            // Backends may read their arguments, and the tensors among them,
+            // before the first execution.
+            for (size_t j = 0; j < arg_idxs->size(); ++j) {
+              Error err = ensure_value_parsed(arg_idxs->Get(j));
+              if (err != Error::Ok) {
+                return err;
+              }
+            }
           } break;
           case executorch_flatbuffer::InstructionArguments::JumpFalseCall: {
             // Validate the index at load time so we can trust it during
@@ -703,17 +1891,74 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
                 "Index %d negative or >= %zu",
                 index,
                 n_value_);
+            Error err = ensure_value_parsed(index);
+            if (err != Error::Ok) {
+              return err;
+            }
+            chain_instruction_arg_lists[instr_idx] = InstructionArgs();
+          } break;
+          case executorch_flatbuffer::InstructionArguments::MoveCall: {
+            auto move_call = instruction->instr_args_as_MoveCall();
+            Error err = ensure_value_parsed(move_call->move_from());
+            if (err == Error::Ok) {
+              err = ensure_value_parsed(move_call->move_to());
+            }
+            if (err != Error::Ok) {
+              return err;
+            }
+            chain_instruction_arg_lists[instr_idx] = InstructionArgs();
+          } break;
+          case executorch_flatbuffer::InstructionArguments::FreeCall: {
+            Error err = ensure_value_parsed(
+                instruction->instr_args_as_FreeCall()->value_index());
+            if (err != Error::Ok) {
+              return err;
+            }
             chain_instruction_arg_lists[instr_idx] = InstructionArgs();
           } break;
           default: {
             chain_instruction_arg_lists[instr_idx] = InstructionArgs();
           } break;
         }
+
+        // Decode the instruction for the fast dispatch loop. The kernel has
+        // been resolved above, or init fails later.
+        auto& decoded = chain_decoded_instructions[instr_idx];
+        decoded = DecodedInstruction{
+            DecodedInstruction::Kind::Other,
+            0,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            0};
+        switch (instruction->instr_args_type()) {
+          case executorch_flatbuffer::InstructionArguments::KernelCall: {
+            decoded.kind = DecodedInstruction::Kind::KernelCall;
+            decoded.kernel = chain_instruction_kernels[instr_idx];
+            decoded.args = chain_instruction_arg_lists[instr_idx].data();
+            decoded.prepacked_data = chain_prepacked_data[instr_idx];
+          } break;
+          case executorch_flatbuffer::InstructionArguments::JumpFalseCall: {
+            auto jf_call = instruction->instr_args_as_JumpFalseCall();
+            decoded.kind = DecodedInstruction::Kind::JumpFalseCall;
+            decoded.jump_target =
+                static_cast<uint32_t>(jf_call->destination_instruction());
+            decoded.cond_value = &values_[jf_call->cond_value_index()];
+          } break;
+          default:
+            break;
+        }
       }
       chains_[i] = Chain{
           s_chain,
           Span<InstructionArgs>(chain_instruction_arg_lists, num_instructions),
           chain_instruction_kernels,
+          chain_decoded_instructions,
+          /*wave_instructions_=*/nullptr,
+          /*wave_offsets_=*/nullptr,
+          /*n_waves_=*/0,
       };
     }
     ET_CHECK_OR_RETURN_ERROR(
@@ -761,6 +2006,38 @@ Error Method::init(executorch_flatbuffer::ExecutionPlan* s_plan) {
     }
   }
 
+  if (fold_constants && value_parsed_ == nullptr) {
+    internal::EventTracerProfileScope event_tracer_profile_scope =
+        internal::EventTracerProfileScope(
+            event_tracer_, "Method::fold_constants");
+    Error err = fold_constant_instructions();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
+  {
+    Error err = init_device_placement();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
+#ifdef ET_EVENT_TRACER_ENABLED
+  if (event_tracer_ != nullptr &&
+      event_tracer_->memory_traffic_tracing_enabled()) {
+    // Tracing needs the tensors of every instruction.
+    Error err = resolve_deferred_kernel_calls();
+    if (err != Error::Ok) {
+      return err;
+    }
+    err = init_memory_traffic_tracing();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+#endif
+
   step_state_ = StepState{0, 0};
 
   init_state_ = InitializationState::Initialized;
@@ -976,36 +2253,410 @@ Method::set_output_data_ptr(void* buffer, size_t size, size_t output_idx) {
 }
 
 __ET_NODISCARD Error
-Method::get_outputs(EValue* output_evalues, size_t length) {
+Method::experimental_share_input(const EValue& input_evalue, size_t input_idx) {
   ET_CHECK_OR_RETURN_ERROR(
       initialized(),
       InvalidState,
-      "Outputs can not be retrieved until method has been initialized.");
+      "Input can not be set until method has been initialized.");
 
   ET_CHECK_OR_RETURN_ERROR(
-      length >= outputs_size(),
-      InvalidArgument,
-      "The given array is not large enough to hold all outputs.");
-
-  for (size_t i = 0; i < outputs_size(); i++) {
-    output_evalues[i] = values_[get_output_index(i)];
-  }
-
-  for (size_t i = outputs_size(); i < length; i++) {
-    output_evalues[i] = EValue();
-  }
-
-  return Error::Ok;
-}
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "Inputs can not be set mid execution.");
 
-Error Method::execute_instruction() {
-  auto& chain = chains_[step_state_.chain_idx];
-  auto instructions = chain.s_chain_->instructions();
+  ET_CHECK_OR_RETURN_ERROR(
+      input_idx < inputs_size(),
+      InvalidArgument,
+      "Given input index must be less than the number of inputs in method, but got %zu and %zu",
+      input_idx,
+      inputs_size());
 
+  const auto& e = get_value(get_input_index(input_idx));
   ET_CHECK_OR_RETURN_ERROR(
-      step_state_.instr_idx < instructions->size(),
-      Internal,
-      "Instr index %zu >= chain[%zu] instr count %zu",
+      e.isTensor() && input_evalue.isTensor(),
+      InvalidArgument,
+      "Only tensor inputs can be shared, but the %zu-th input has tag %" PRIu32
+      " and the input_evalue tag %" PRIu32,
+      input_idx,
+      static_cast<uint32_t>(e.tag),
+      static_cast<uint32_t>(input_evalue.tag));
+
+  const auto& t_dst = e.toTensor();
+  const auto& t_src = input_evalue.toTensor();
+  ET_CHECK_OR_RETURN_ERROR(
+      t_dst.scalar_type() == t_src.scalar_type(),
+      InvalidArgument,
+      "The %zu-th input tensor's scalartype does not meet requirement: found %" PRId8
+      " but expected %" PRId8,
+      input_idx,
+      static_cast<int8_t>(t_src.scalar_type()),
+      static_cast<int8_t>(t_dst.scalar_type()));
+  Error err = resize_tensor(t_dst, t_src.sizes());
+  ET_CHECK_OR_RETURN_ERROR(
+      err == Error::Ok,
+      InvalidArgument,
+      "Error setting input %zu: 0x%" PRIx32,
+      input_idx,
+      static_cast<uint32_t>(err));
+  err = internal::share_tensor_data(t_dst, t_src);
+  ET_CHECK_OR_RETURN_ERROR(
+      err == Error::Ok,
+      InvalidArgument,
+      "Error setting data_ptr %zu: 0x%" PRIx32,
+      input_idx,
+      static_cast<uint32_t>(err));
+  return Error::Ok;
+}
+
+__ET_NODISCARD Error Method::experimental_allocate_io_buffer_sets(
+    size_t num_sets) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "I/O buffers can not be allocated until method has been initialized.");
+  ET_CHECK_OR_RETURN_ERROR(
+      n_io_buffer_sets_ == 0,
+      InvalidState,
+      "I/O buffer sets were already allocated.");
+  ET_CHECK_OR_RETURN_ERROR(
+      num_sets > 0, InvalidArgument, "num_sets must be greater than zero.");
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "I/O buffer sets can not be allocated mid execution.");
+
+  const size_t n_io = inputs_size() + outputs_size();
+  if (n_io == 0) {
+    n_io_buffer_sets_ = num_sets;
+    return Error::Ok;
+  }
+  MemoryAllocator* method_allocator = memory_manager_->method_allocator();
+  Span<uint8_t>* buffers = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      method_allocator, Span<uint8_t>, num_sets * n_io);
+  const auto* s_values = serialization_plan_->values();
+  for (size_t io = 0; io < n_io; ++io) {
+    const size_t value_idx = get_io_index(io);
+    size_t alias = io;
+    for (size_t prev = 0; prev < io; ++prev) {
+      if (get_io_index(prev) == value_idx) {
+        alias = prev;
+        break;
+      }
+    }
+    const EValue& value = get_value(value_idx);
+    const auto* s_value = s_values->Get(value_idx);
+    // Constant tensors are backed by the program's constant buffer.
+    const bool is_constant =
+        value.isTensor() && is_constant_tensor(s_value->val_as_Tensor());
+    for (size_t set = 0; set < num_sets; ++set) {
+      Span<uint8_t>& buffer = buffers[set * n_io + io];
+      buffer = {};
+      if (alias != io) {
+        buffer = buffers[set * n_io + alias];
+        continue;
+      }
+      if (!value.isTensor() || is_constant || value.toTensor().nbytes() == 0) {
+        continue;
+      }
+      const size_t nbytes = value.toTensor().nbytes();
+      // Use the default alignment of the memory planner.
+      void* data = method_allocator->allocate(nbytes, /*alignment=*/16);
+      ET_CHECK_OR_RETURN_ERROR(
+          data != nullptr,
+          MemoryAllocationFailed,
+          "Failed to allocate %zu bytes for I/O %zu of set %zu",
+          nbytes,
+          io,
+          set);
+      buffer = {static_cast<uint8_t*>(data), nbytes};
+    }
+  }
+  io_buffers_ = buffers;
+  n_io_buffer_sets_ = num_sets;
+  init_batch_args(num_sets);
+  return experimental_select_io_buffer_set(0);
+}
+
+void Method::init_batch_args(size_t num_sets) {
+#ifndef USE_ATEN_LIB
+  if (n_chains_ != 1 || chains_[0].s_chain_->instructions()->size() != 1) {
+    return;
+  }
+  const auto* instruction = chains_[0].s_chain_->instructions()->Get(0);
+  if (instruction->instr_args_type() !=
+          executorch_flatbuffer::InstructionArguments::DelegateCall ||
+      instruction->instr_args_as_DelegateCall()->delegate_index() >=
+          n_delegate_) {
+    return;
+  }
+
+  // The sets may run concurrently on the device, so every tensor that is
+  // written must have a buffer in each set. Each set gets its own copy of
+  // these tensors, which share the sizes of the originals and so must not
+  // be resized.
+  const InstructionArgs args = chains_[0].argument_lists_[0];
+  const size_t n_io = inputs_size() + outputs_size();
+  const auto* s_values = serialization_plan_->values();
+  size_t n_copied = 0;
+  for (EValue* arg : args) {
+    if (!arg->isTensor()) {
+      continue;
+    }
+    const size_t value_idx = arg - values_;
+    const auto* s_tensor = s_values->Get(value_idx)->val_as_Tensor();
+    if (is_constant_tensor(s_tensor)) {
+      continue;
+    }
+    size_t io = 0;
+    while (io < n_io && get_io_index(io) != value_idx) {
+      ++io;
+    }
+    if (io == n_io || io_buffers_[io].data() == nullptr ||
+        s_tensor->shape_dynamism() !=
+            executorch_flatbuffer::TensorShapeDynamism::STATIC) {
+      return;
+    }
+    ++n_copied;
+  }
+  if (n_copied == 0) {
+    return;
+  }
+
+  MemoryAllocator* method_allocator = memory_manager_->method_allocator();
+  auto* batch_args =
+      method_allocator->allocateList<EValue*>(num_sets * args.size());
+  auto* batch_lists = method_allocator->allocateList<EValue**>(num_sets);
+  auto* values = method_allocator->allocateList<EValue>(num_sets * n_copied);
+  auto* impls =
+      method_allocator->allocateList<TensorImpl>(num_sets * n_copied);
+  if (batch_args == nullptr || batch_lists == nullptr || values == nullptr ||
+      impls == nullptr) {
+    ET_LOG(Info, "No memory to batch delegate calls; sets run one by one");
+    return;
+  }
+  size_t copy = 0;
+  for (size_t set = 0; set < num_sets; ++set) {
+    for (size_t i = 0; i < args.size(); ++i) {
+      EValue* arg = args[i];
+      batch_args[set * args.size() + i] = arg;
+      const size_t value_idx = arg - values_;
+      if (!arg->isTensor() ||
+          is_constant_tensor(s_values->Get(value_idx)->val_as_Tensor())) {
+        continue;
+      }
+      size_t io = 0;
+      while (get_io_index(io) != value_idx) {
+        ++io;
+      }
+      TensorImpl* impl = new (&impls[copy])
+          TensorImpl(*arg->toTensor().unsafeGetTensorImpl());
+      impl->set_data(io_buffers_[set * n_io + io].data());
+      new (&values[copy]) EValue(exec_aten::Tensor(impl));
+      batch_args[set * args.size() + i] = &values[copy];
+      ++copy;
+    }
+  }
+  batch_args_ = batch_args;
+  batch_lists_ = batch_lists;
+#else
+  (void)num_sets;
+#endif
+}
+
+__ET_NODISCARD Error Method::experimental_select_io_buffer_set(
+    size_t set_idx) {
+  ET_CHECK_OR_RETURN_ERROR(
+      n_io_buffer_sets_ > 0,
+      InvalidState,
+      "I/O buffer sets have not been allocated.");
+  ET_CHECK_OR_RETURN_ERROR(
+      set_idx < n_io_buffer_sets_,
+      InvalidArgument,
+      "set_idx %zu >= num_sets %zu",
+      set_idx,
+      n_io_buffer_sets_);
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "I/O buffer sets can not be selected mid execution.");
+
+  const size_t n_io = inputs_size() + outputs_size();
+  for (size_t io = 0; io < n_io; ++io) {
+    const Span<uint8_t>& buffer = io_buffers_[set_idx * n_io + io];
+    if (buffer.data() == nullptr) {
+      continue;
+    }
+    Error err = internal::set_tensor_data(
+        mutable_value(get_io_index(io)).toTensor(),
+        buffer.data(),
+        buffer.size());
+    ET_CHECK_OR_RETURN_ERROR(
+        err == Error::Ok,
+        InvalidArgument,
+        "Error setting data_ptr of I/O %zu: 0x%" PRIx32,
+        io,
+        static_cast<uint32_t>(err));
+  }
+  return Error::Ok;
+}
+
+Result<Span<uint8_t>> Method::get_io_buffer(size_t set_idx, size_t io) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      n_io_buffer_sets_ > 0,
+      InvalidState,
+      "I/O buffer sets have not been allocated.");
+  ET_CHECK_OR_RETURN_ERROR(
+      set_idx < n_io_buffer_sets_,
+      InvalidArgument,
+      "set_idx %zu >= num_sets %zu",
+      set_idx,
+      n_io_buffer_sets_);
+  const size_t n_io = inputs_size() + outputs_size();
+  return io_buffers_[set_idx * n_io + io];
+}
+
+Result<Span<uint8_t>> Method::experimental_input_buffer(
+    size_t set_idx,
+    size_t input_idx) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      input_idx < inputs_size(),
+      InvalidArgument,
+      "input_idx %zu >= num_inputs %zu",
+      input_idx,
+      inputs_size());
+  return get_io_buffer(set_idx, input_idx);
+}
+
+Result<Span<uint8_t>> Method::experimental_output_buffer(
+    size_t set_idx,
+    size_t output_idx) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      output_idx < outputs_size(),
+      InvalidArgument,
+      "output_idx %zu >= num_outputs %zu",
+      output_idx,
+      outputs_size());
+  return get_io_buffer(set_idx, inputs_size() + output_idx);
+}
+
+__ET_NODISCARD Error
+Method::experimental_execute_batch(Span<const size_t> set_indices) {
+  ET_CHECK_OR_RETURN_ERROR(
+      n_io_buffer_sets_ > 0,
+      InvalidState,
+      "I/O buffer sets have not been allocated.");
+  ET_CHECK_OR_RETURN_ERROR(
+      set_indices.size() <= n_io_buffer_sets_,
+      InvalidArgument,
+      "Batch of %zu sets > num_sets %zu",
+      set_indices.size(),
+      n_io_buffer_sets_);
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "A batch can not be executed mid execution.");
+  for (size_t set_idx : set_indices) {
+    ET_CHECK_OR_RETURN_ERROR(
+        set_idx < n_io_buffer_sets_,
+        InvalidArgument,
+        "set_idx %zu >= num_sets %zu",
+        set_idx,
+        n_io_buffer_sets_);
+  }
+  // The sets of a batch may run concurrently, so they must not share their
+  // buffers. The batch is no larger than num_sets.
+  for (size_t i = 1; i < set_indices.size(); ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      ET_CHECK_OR_RETURN_ERROR(
+          set_indices[i] != set_indices[j],
+          InvalidArgument,
+          "Set %zu appears more than once in the batch",
+          set_indices[i]);
+    }
+  }
+  if (set_indices.empty()) {
+    return Error::Ok;
+  }
+
+  // Device placements and events are tracked per execute().
+  if (batch_args_ == nullptr || value_placements_ != nullptr ||
+      event_tracer_ != nullptr) {
+    for (size_t set_idx : set_indices) {
+      Error err = experimental_select_io_buffer_set(set_idx);
+      if (err == Error::Ok) {
+        err = execute();
+      }
+      if (err != Error::Ok) {
+        ET_LOG(
+            Error,
+            "Executing set %zu of the batch failed: 0x%" PRIx32,
+            set_idx,
+            static_cast<uint32_t>(err));
+        return err;
+      }
+    }
+    return Error::Ok;
+  }
+
+  EXECUTORCH_SCOPE_PROF("Method::execute_batch");
+  const size_t n_args = chains_[0].argument_lists_[0].size();
+  for (size_t i = 0; i < set_indices.size(); ++i) {
+    batch_lists_[i] = batch_args_ + set_indices[i] * n_args;
+  }
+  const auto delegate_idx = chains_[0]
+                                .s_chain_->instructions()
+                                ->Get(0)
+                                ->instr_args_as_DelegateCall()
+                                ->delegate_index();
+  BackendExecutionContext backend_execution_context(
+      /*event_tracer*/ nullptr,
+      /*temp_allocator*/ memory_manager_->temp_allocator());
+  Error err = delegates_[delegate_idx].ExecuteBatch(
+      backend_execution_context,
+      ArrayRef<EValue**>(batch_lists_, set_indices.size()));
+  if (err != Error::Ok) {
+    ET_LOG(
+        Error,
+        "Batched CALL_DELEGATE execute of %zu sets failed: 0x%" PRIx32,
+        set_indices.size(),
+        static_cast<uint32_t>(err));
+    return err;
+  }
+  return experimental_select_io_buffer_set(
+      set_indices[set_indices.size() - 1]);
+}
+
+__ET_NODISCARD Error
+Method::get_outputs(EValue* output_evalues, size_t length) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Outputs can not be retrieved until method has been initialized.");
+
+  ET_CHECK_OR_RETURN_ERROR(
+      length >= outputs_size(),
+      InvalidArgument,
+      "The given array is not large enough to hold all outputs.");
+
+  for (size_t i = 0; i < outputs_size(); i++) {
+    output_evalues[i] = values_[get_output_index(i)];
+  }
+
+  for (size_t i = outputs_size(); i < length; i++) {
+    output_evalues[i] = EValue();
+  }
+
+  return Error::Ok;
+}
+
+Error Method::execute_instruction() {
+  auto& chain = chains_[step_state_.chain_idx];
+  auto instructions = chain.s_chain_->instructions();
+
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx < instructions->size(),
+      Internal,
+      "Instr index %zu >= chain[%zu] instr count %zu",
       step_state_.instr_idx,
       step_state_.chain_idx,
       (size_t)instructions->size());
@@ -1013,44 +2664,55 @@ Error Method::execute_instruction() {
   auto instruction = instructions->Get(step_state_.instr_idx);
   size_t next_instr_idx = step_state_.instr_idx + 1;
   Error err = Error::Ok;
+  const DecodedInstruction& decoded =
+      chain.decoded_instructions_[step_state_.instr_idx];
+  if (decoded.n_device_syncs > 0) {
+    err = copy_device_values_to_host(decoded);
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
   switch (instruction->instr_args_type()) {
     case executorch_flatbuffer::InstructionArguments::KernelCall: {
+      if (chain.decoded_instructions_[step_state_.instr_idx].kind ==
+          DecodedInstruction::Kind::Folded) {
+        // Already run by init().
+        break;
+      }
       EXECUTORCH_SCOPE_PROF("OPERATOR_CALL");
       internal::EventTracerProfileScope event_tracer_scope =
           internal::EventTracerProfileScope(event_tracer_, "OPERATOR_CALL");
       // TODO(T147221312): Also expose tensor resizer via the context.
       // The temp_allocator passed can be null, but calling allocate_temp will
       // fail
+      if (chain.kernels_[step_state_.instr_idx] == nullptr) {
+        err = resolve_kernel_call(chain, step_state_.instr_idx);
+        if (err != Error::Ok) {
+          ET_LOG(
+              Error,
+              "Failed to resolve KernelCall at instruction %zu:%zu: 0x%" PRIx32,
+              step_state_.chain_idx,
+              step_state_.instr_idx,
+              static_cast<uint32_t>(err));
+          break;
+        }
+      }
       KernelRuntimeContext context(
-          event_tracer_, memory_manager_->temp_allocator());
+          event_tracer_,
+          memory_manager_->temp_allocator(),
+          chain.decoded_instructions_[step_state_.instr_idx].prepacked_data);
       auto args = chain.argument_lists_[step_state_.instr_idx];
       chain.kernels_[step_state_.instr_idx](context, args.data());
       // We reset the temp_allocator after the switch statement
       err = context.failure_state();
       if (err != Error::Ok) {
-        // We know that instr_args_as_KernelCall is non-null because it was
-        // checked at init time.
-        auto op_index = instruction->instr_args_as_KernelCall()->op_index();
-        auto op = serialization_plan_->operators()->Get(op_index);
-        ET_LOG(
-            Error,
-            "KernelCall failed at instruction %zu:%zu in operator %s.%s: 0x%x",
-            step_state_.chain_idx,
-            step_state_.instr_idx,
-            op->name()->c_str(),
-            op->overload()->c_str(),
-            (unsigned int)err);
-        for (size_t i = 0; i < args.size(); ++i) {
-          ET_LOG(
-              Error,
-              "arg %u with type id %u",
-              (unsigned int)i,
-              (unsigned int)args[i]->tag);
-        }
-        // TODO(T153804650): Consider logging the EValues to help with
-        // debugging. This is a failure path, and it doesn't matter if it's a
-        // little slow. Do the same for DelegateCall errors.
+        log_kernel_call_failure(err);
       }
+#ifdef ET_EVENT_TRACER_ENABLED
+      if (memory_traffic_ != nullptr && err == Error::Ok) {
+        log_memory_traffic(chain);
+      }
+#endif
     } break;
     case executorch_flatbuffer::InstructionArguments::DelegateCall: {
       EXECUTORCH_SCOPE_PROF("DELEGATE_CALL");
@@ -1068,12 +2730,8 @@ Error Method::execute_instruction() {
           delegate_idx,
           n_delegate_,
           step_state_.instr_idx);
-      BackendExecutionContext backend_execution_context(
-          /*event_tracer*/ event_tracer_,
-          /*temp_allocator*/ memory_manager_->temp_allocator());
-      err = delegates_[delegate_idx].Execute(
-          backend_execution_context,
-          chain.argument_lists_[step_state_.instr_idx].data());
+      err = execute_delegate(
+          delegate_idx, chain.argument_lists_[step_state_.instr_idx]);
       if (err != Error::Ok) {
         ET_LOG(
             Error,
@@ -1081,6 +2739,11 @@ Error Method::execute_instruction() {
             step_state_.instr_idx,
             static_cast<uint32_t>(err));
       }
+#ifdef ET_EVENT_TRACER_ENABLED
+      if (memory_traffic_ != nullptr && err == Error::Ok) {
+        log_memory_traffic(chain);
+      }
+#endif
 
       // Log all the arguments of the delegate call. Ideally we'd only like to
       // log the outputs of the delegate, but currently we cannot know from the
@@ -1151,6 +2814,867 @@ Error Method::execute_instruction() {
   return err;
 }
 
+void Method::log_kernel_call_failure(Error err) const {
+  const auto& chain = chains_[step_state_.chain_idx];
+  auto instruction =
+      chain.s_chain_->instructions()->Get(step_state_.instr_idx);
+  auto args = chain.argument_lists_[step_state_.instr_idx];
+  // We know that instr_args_as_KernelCall is non-null because it was checked
+  // at init time.
+  auto op_index = instruction->instr_args_as_KernelCall()->op_index();
+  auto op = serialization_plan_->operators()->Get(op_index);
+  ET_LOG(
+      Error,
+      "KernelCall failed at instruction %zu:%zu in operator %s.%s: 0x%x",
+      step_state_.chain_idx,
+      step_state_.instr_idx,
+      op->name()->c_str(),
+      op->overload()->c_str(),
+      (unsigned int)err);
+  for (size_t i = 0; i < args.size(); ++i) {
+    ET_LOG(
+        Error,
+        "arg %u with type id %u",
+        (unsigned int)i,
+        (unsigned int)args[i]->tag);
+  }
+  // TODO(T153804650): Consider logging the EValues to help with
+  // debugging. This is a failure path, and it doesn't matter if it's a
+  // little slow. Do the same for DelegateCall errors.
+}
+
+Error Method::execute_chain_fast(Chain& chain) {
+  const size_t num_instructions = chain.s_chain_->instructions()->size();
+  MemoryAllocator* temp_allocator = memory_manager_->temp_allocator();
+
+  size_t instr_idx = 0;
+  while (instr_idx < num_instructions) {
+    const DecodedInstruction& instr = chain.decoded_instructions_[instr_idx];
+    switch (instr.kind) {
+      case DecodedInstruction::Kind::KernelCall: {
+        if (instr.kernel == nullptr) {
+          // Deferred by lazy value parsing; the regular path resolves it.
+          step_state_.instr_idx = instr_idx;
+          Error err = execute_instruction();
+          if (err != Error::Ok) {
+            return err;
+          }
+          instr_idx = step_state_.instr_idx;
+          break;
+        }
+        if (instr.n_device_syncs > 0) {
+          Error sync_err = copy_device_values_to_host(instr);
+          if (sync_err != Error::Ok) {
+            step_state_.instr_idx = instr_idx;
+            return sync_err;
+          }
+        }
+        KernelRuntimeContext context(
+            /*event_tracer=*/nullptr, temp_allocator, instr.prepacked_data);
+        instr.kernel(context, instr.args);
+        if (temp_allocator != nullptr) {
+          temp_allocator->reset();
+        }
+        Error err = context.failure_state();
+        if (err != Error::Ok) {
+          step_state_.instr_idx = instr_idx;
+          log_kernel_call_failure(err);
+          return err;
+        }
+        instr_idx++;
+      } break;
+      case DecodedInstruction::Kind::Folded:
+        instr_idx++;
+        break;
+      case DecodedInstruction::Kind::JumpFalseCall: {
+        Result<bool> jf_result = parse_cond_value(*instr.cond_value);
+        if (temp_allocator != nullptr) {
+          temp_allocator->reset();
+        }
+        if (!jf_result.ok()) {
+          step_state_.instr_idx = instr_idx;
+          return jf_result.error();
+        }
+        instr_idx = jf_result.get() ? instr_idx + 1 : instr.jump_target;
+      } break;
+      default: {
+        // Delegate, move and free calls are not dispatch bound.
+        step_state_.instr_idx = instr_idx;
+        Error err = execute_instruction();
+        if (err != Error::Ok) {
+          return err;
+        }
+        instr_idx = step_state_.instr_idx;
+      } break;
+    }
+  }
+  step_state_.instr_idx = instr_idx;
+  return Error::Ok;
+}
+
+Error Method::run_scheduled_instruction(
+    const Chain& chain,
+    size_t instr_idx,
+    MemoryAllocator* temp_allocator) {
+  const DecodedInstruction& instr = chain.decoded_instructions_[instr_idx];
+  if (instr.kind == DecodedInstruction::Kind::KernelCall) {
+    KernelRuntimeContext context(
+        /*event_tracer=*/nullptr, temp_allocator, instr.prepacked_data);
+    instr.kernel(context, instr.args);
+    return context.failure_state();
+  }
+  // Only kernel and delegate calls are scheduled.
+  auto delegate_idx = chain.s_chain_->instructions()
+                          ->Get(instr_idx)
+                          ->instr_args_as_DelegateCall()
+                          ->delegate_index();
+  ET_CHECK_OR_RETURN_ERROR(
+      delegate_idx < n_delegate_,
+      Internal,
+      "DELEGATE_CALL index %" PRIu32 " >= num delegates %zu at instruction %zu",
+      delegate_idx,
+      n_delegate_,
+      instr_idx);
+  BackendExecutionContext backend_execution_context(
+      /*event_tracer*/ nullptr,
+      /*temp_allocator*/ temp_allocator);
+  return delegates_[delegate_idx].Execute(
+      backend_execution_context, chain.argument_lists_[instr_idx].data());
+}
+
+namespace {
+
+struct InterOpWave {
+  Method* method;
+  const Chain* chain;
+  const uint32_t* instructions;
+};
+
+} // namespace
+
+void Method::run_inter_op_task(void* context, size_t task_index) {
+  auto* wave = static_cast<InterOpWave*>(context);
+  Method* method = wave->method;
+  // The temp allocator is not thread safe, so concurrent instructions do not
+  // get one.
+  method->inter_op_errors_[task_index] = method->run_scheduled_instruction(
+      *wave->chain, wave->instructions[task_index], /*temp_allocator=*/nullptr);
+}
+
+Error Method::execute_chain_parallel(Chain& chain) {
+  MemoryAllocator* temp_allocator = memory_manager_->temp_allocator();
+
+  for (size_t wave_idx = 0; wave_idx < chain.n_waves_; wave_idx++) {
+    const uint32_t* wave_instructions =
+        chain.wave_instructions_ + chain.wave_offsets_[wave_idx];
+    const size_t wave_size =
+        chain.wave_offsets_[wave_idx + 1] - chain.wave_offsets_[wave_idx];
+
+    Error err = Error::Ok;
+    size_t failed_task = 0;
+    if (wave_size == 1) {
+      err = run_scheduled_instruction(
+          chain, wave_instructions[0], temp_allocator);
+      if (temp_allocator != nullptr) {
+        temp_allocator->reset();
+      }
+    } else {
+      InterOpWave wave{this, &chain, wave_instructions};
+      inter_op_runner_(
+          inter_op_runner_context_, wave_size, &run_inter_op_task, &wave);
+      // Report the failure of the earliest instruction, as the sequential
+      // execution would. A wave keeps the program order.
+      for (size_t i = 0; i < wave_size; i++) {
+        if (inter_op_errors_[i] != Error::Ok) {
+          err = inter_op_errors_[i];
+          failed_task = i;
+          break;
+        }
+      }
+    }
+
+    if (err != Error::Ok) {
+      step_state_.instr_idx = wave_instructions[failed_task];
+      if (chain.decoded_instructions_[step_state_.instr_idx].kind ==
+          DecodedInstruction::Kind::KernelCall) {
+        log_kernel_call_failure(err);
+      } else {
+        ET_LOG(
+            Error,
+            "CALL_DELEGATE execute failed at instruction %zu: 0x%" PRIx32,
+            step_state_.instr_idx,
+            static_cast<uint32_t>(err));
+      }
+      return err;
+    }
+  }
+  step_state_.instr_idx = chain.s_chain_->instructions()->size();
+  return Error::Ok;
+}
+
+Error Method::init_device_placement() {
+  bool has_device_backend = false;
+  for (size_t i = 0; i < n_delegate_; i++) {
+    has_device_backend |= delegates_[i].backend()->supports_device_buffers();
+  }
+  if (!has_device_backend) {
+    return Error::Ok;
+  }
+
+  MemoryAllocator* allocator = memory_manager_->method_allocator();
+  auto* placements =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, DevicePlacement, n_value_);
+  for (size_t i = 0; i < n_value_; i++) {
+    placements[i] = DevicePlacement{nullptr, DeviceBuffer(), false};
+  }
+
+  // The tensors touched by delegate calls of such backends may stay in
+  // device memory, unless the caller reads or writes them.
+  size_t max_delegate_args = 1;
+  for (size_t chain_idx = 0; chain_idx < n_chains_; chain_idx++) {
+    const Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); instr_idx++) {
+      const auto instruction = instructions->Get(instr_idx);
+      if (instruction->instr_args_type() !=
+          executorch_flatbuffer::InstructionArguments::DelegateCall) {
+        continue;
+      }
+      const InstructionArgs args = chain.argument_lists_[instr_idx];
+      max_delegate_args = std::max(max_delegate_args, args.size());
+      const auto delegate_idx =
+          instruction->instr_args_as_DelegateCall()->delegate_index();
+      if (delegate_idx >= n_delegate_ ||
+          !delegates_[delegate_idx].backend()->supports_device_buffers()) {
+        continue;
+      }
+      for (size_t i = 0; i < args.size(); i++) {
+        if (args[i]->isTensor()) {
+          placements[args[i] - values_].may_stay_on_device = true;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < inputs_size(); i++) {
+    placements[get_input_index(i)].may_stay_on_device = false;
+  }
+  for (size_t i = 0; i < outputs_size(); i++) {
+    placements[get_output_index(i)].may_stay_on_device = false;
+  }
+
+  // Every other instruction that touches one of them copies it to host
+  // memory first, if it is on a device at that point.
+  const auto s_values = serialization_plan_->values();
+  for (size_t chain_idx = 0; chain_idx < n_chains_; chain_idx++) {
+    Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); instr_idx++) {
+      const auto instruction = instructions->Get(instr_idx);
+      DecodedInstruction& decoded = chain.decoded_instructions_[instr_idx];
+      if (decoded.kind == DecodedInstruction::Kind::Folded) {
+        continue;
+      }
+      const auto for_each_value = [&](auto&& fn) {
+        const auto visit = [&](size_t value_idx) {
+          if (value_idx < n_value_ &&
+              placements[value_idx].may_stay_on_device) {
+            fn(value_idx);
+          }
+        };
+        switch (instruction->instr_args_type()) {
+          case executorch_flatbuffer::InstructionArguments::KernelCall:
+            for_each_arg_value(
+                chain.argument_lists_[instr_idx],
+                values_,
+                s_values,
+                n_value_,
+                visit);
+            break;
+          case executorch_flatbuffer::InstructionArguments::MoveCall:
+            visit(instruction->instr_args_as_MoveCall()->move_from());
+            visit(instruction->instr_args_as_MoveCall()->move_to());
+            break;
+          case executorch_flatbuffer::InstructionArguments::FreeCall:
+            visit(instruction->instr_args_as_FreeCall()->value_index());
+            break;
+          default:
+            // Delegate calls copy the values of other backends themselves,
+            // see execute_delegate().
+            break;
+        }
+      };
+      uint32_t n_syncs = 0;
+      for_each_value([&](size_t) { n_syncs++; });
+      if (n_syncs == 0) {
+        continue;
+      }
+      auto* syncs =
+          ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint32_t, n_syncs);
+      n_syncs = 0;
+      for_each_value([&](size_t value_idx) {
+        syncs[n_syncs++] = static_cast<uint32_t>(value_idx);
+      });
+      decoded.device_syncs = syncs;
+      decoded.n_device_syncs = n_syncs;
+    }
+  }
+
+  delegate_arg_placements_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      allocator, DelegateArgPlacement, max_delegate_args);
+  value_placements_ = placements;
+  return Error::Ok;
+}
+
+Error Method::copy_value_to_host(size_t value_idx) {
+  DevicePlacement& placement = value_placements_[value_idx];
+  if (placement.backend == nullptr) {
+    return Error::Ok;
+  }
+  exec_aten::Tensor tensor = values_[value_idx].toTensor();
+  Error err = placement.backend->copy_to_host(placement.buffer, tensor);
+  if (err != Error::Ok) {
+    ET_LOG(
+        Error,
+        "Copying value %zu to host memory failed: 0x%" PRIx32,
+        value_idx,
+        static_cast<uint32_t>(err));
+    return err;
+  }
+  placement.backend = nullptr;
+  placement.buffer = DeviceBuffer();
+  return Error::Ok;
+}
+
+Error Method::copy_device_values_to_host(const DecodedInstruction& instr) {
+  for (uint32_t i = 0; i < instr.n_device_syncs; i++) {
+    Error err = copy_value_to_host(instr.device_syncs[i]);
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+  return Error::Ok;
+}
+
+Error Method::execute_delegate(size_t delegate_idx, InstructionArgs args) {
+  const BackendDelegate& delegate = delegates_[delegate_idx];
+  if (value_placements_ == nullptr) {
+    BackendExecutionContext backend_execution_context(
+        /*event_tracer*/ event_tracer_,
+        /*temp_allocator*/ memory_manager_->temp_allocator());
+    return delegate.Execute(backend_execution_context, args.data());
+  }
+
+  // Hand the tensors this backend left on its device back to it, and bring
+  // those of other backends to host memory.
+  const PyTorchBackendInterface* backend = delegate.backend();
+  const bool device_backend = backend->supports_device_buffers();
+  for (size_t i = 0; i < args.size(); i++) {
+    const size_t value_idx = args[i] - values_;
+    const DevicePlacement& placement = value_placements_[value_idx];
+    if (placement.backend != nullptr && placement.backend != backend) {
+      Error err = copy_value_to_host(value_idx);
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+    delegate_arg_placements_[i] = DelegateArgPlacement{
+        placement.buffer, device_backend && placement.may_stay_on_device};
+  }
+  BackendExecutionContext backend_execution_context(
+      /*event_tracer*/ event_tracer_,
+      /*temp_allocator*/ memory_manager_->temp_allocator(),
+      Span<DelegateArgPlacement>(delegate_arg_placements_, args.size()));
+  Error err = delegate.Execute(backend_execution_context, args.data());
+  if (err != Error::Ok || !device_backend) {
+    return err;
+  }
+  for (size_t i = 0; i < args.size(); i++) {
+    const DelegateArgPlacement& arg_placement = delegate_arg_placements_[i];
+    if (!arg_placement.may_stay_on_device) {
+      continue;
+    }
+    DevicePlacement& placement = value_placements_[args[i] - values_];
+    placement.buffer = arg_placement.buffer;
+    placement.backend =
+        arg_placement.buffer.handle != nullptr ? backend : nullptr;
+  }
+  return Error::Ok;
+}
+
+Error Method::init_memory_traffic_tracing() {
+  MemoryAllocator* allocator = memory_manager_->method_allocator();
+  auto* state =
+      ET_ALLOCATE_INSTANCE_OR_RETURN_ERROR(allocator, MemoryTrafficState);
+  const auto s_values = serialization_plan_->values();
+  const auto buffer_sizes = serialization_plan_->non_const_buffer_sizes();
+  // Index zero of the buffer sizes is reserved, as in MethodMeta.
+  state->num_buffers = buffer_sizes != nullptr && buffer_sizes->size() > 0
+      ? buffer_sizes->size() - 1
+      : 0;
+  state->value_mem_ids =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, int32_t, n_value_);
+  state->value_writers =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint64_t, n_value_);
+  state->traffic = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      allocator, EventTracerMemoryTraffic, state->num_buffers + 1);
+
+  for (size_t i = 0; i < n_value_; i++) {
+    state->value_mem_ids[i] = kUnplannedMemoryId;
+    const auto s_value = s_values->Get(i);
+    if (s_value->val_type() == executorch_flatbuffer::KernelTypes::Tensor) {
+      const auto allocation_info = s_value->val_as_Tensor()->allocation_info();
+      if (allocation_info != nullptr && allocation_info->memory_id() > 0 &&
+          allocation_info->memory_id() <= state->num_buffers) {
+        state->value_mem_ids[i] = allocation_info->memory_id() - 1;
+      }
+    }
+    state->value_writers[i] = state->value_mem_ids[i] != kUnplannedMemoryId
+        ? kTrafficUnseen
+        : kTrafficNotWritten;
+  }
+  // Outputs may be unplanned, with data set by set_output_data_ptr(), while
+  // inputs are only read, even if they are planned.
+  for (size_t i = 0; i < outputs_size(); i++) {
+    state->value_writers[get_output_index(i)] = kTrafficUnseen;
+  }
+  for (size_t i = 0; i < inputs_size(); i++) {
+    state->value_writers[get_input_index(i)] = kTrafficNotWritten;
+  }
+
+  // The program does not tell the outputs of an instruction from its inputs,
+  // but the memory plan only gives a tensor storage from the first
+  // instruction that touches it, which writes it as the out argument of a
+  // kernel or delegate. Every other instruction reads it.
+  for (size_t chain_idx = 0; chain_idx < n_chains_; chain_idx++) {
+    const Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); instr_idx++) {
+      const auto type = instructions->Get(instr_idx)->instr_args_type();
+      if (type != executorch_flatbuffer::InstructionArguments::KernelCall &&
+          type != executorch_flatbuffer::InstructionArguments::DelegateCall) {
+        continue;
+      }
+      if (chain.decoded_instructions_[instr_idx].kind ==
+          DecodedInstruction::Kind::Folded) {
+        // init() gave the outputs of folded calls memory of their own, and
+        // the other tensors they touch are constant.
+        for_each_arg_value(
+            chain.argument_lists_[instr_idx],
+            values_,
+            s_values,
+            n_value_,
+            [&](size_t value_idx) {
+              state->value_mem_ids[value_idx] = kUnplannedMemoryId;
+            });
+      }
+      const uint64_t key = memory_traffic_key(chain_idx, instr_idx);
+      for_each_arg_value(
+          chain.argument_lists_[instr_idx],
+          values_,
+          s_values,
+          n_value_,
+          [&](size_t value_idx) {
+            if (state->value_writers[value_idx] == kTrafficUnseen) {
+              state->value_writers[value_idx] = key;
+            }
+          });
+    }
+  }
+
+  memory_traffic_ = state;
+  return Error::Ok;
+}
+
+void Method::log_memory_traffic(const Chain& chain) {
+  MemoryTrafficState* state = memory_traffic_;
+  if (!event_tracer_->memory_traffic_tracing_enabled()) {
+    return;
+  }
+  const size_t num_entries = state->num_buffers + 1;
+  for (size_t i = 0; i < num_entries; i++) {
+    state->traffic[i].mem_id = i < state->num_buffers
+        ? static_cast<int32_t>(i)
+        : kUnplannedMemoryId;
+    state->traffic[i].bytes_read = 0;
+    state->traffic[i].bytes_written = 0;
+  }
+
+  const uint64_t key =
+      memory_traffic_key(step_state_.chain_idx, step_state_.instr_idx);
+  for_each_arg_value(
+      chain.argument_lists_[step_state_.instr_idx],
+      values_,
+      serialization_plan_->values(),
+      n_value_,
+      [&](size_t value_idx) {
+        const EValue& value = values_[value_idx];
+        if (!value.isTensor()) {
+          return;
+        }
+        const int32_t mem_id = state->value_mem_ids[value_idx];
+        const size_t entry =
+            mem_id != kUnplannedMemoryId ? mem_id : state->num_buffers;
+        EventTracerMemoryTraffic& traffic = state->traffic[entry];
+        // Sizes are read after the call, so they include the resizing of
+        // the outputs of dynamic shapes.
+        const size_t nbytes = value.toTensor().nbytes();
+        if (state->value_writers[value_idx] == key) {
+          traffic.bytes_written += nbytes;
+        } else {
+          traffic.bytes_read += nbytes;
+        }
+      });
+
+  size_t num_touched = 0;
+  for (size_t i = 0; i < num_entries; i++) {
+    if (state->traffic[i].bytes_read > 0 ||
+        state->traffic[i].bytes_written > 0) {
+      state->traffic[num_touched++] = state->traffic[i];
+    }
+  }
+  if (num_touched > 0) {
+    event_tracer_->log_memory_traffic(state->traffic, num_touched);
+  }
+}
+
+Error Method::build_inter_op_schedule(Chain& chain, size_t* max_wave_size) {
+  *max_wave_size = 0;
+  const auto instructions = chain.s_chain_->instructions();
+  const size_t num_instructions = instructions->size();
+  for (size_t instr_idx = 0; instr_idx < num_instructions; instr_idx++) {
+    const auto type = instructions->Get(instr_idx)->instr_args_type();
+    if (type != executorch_flatbuffer::InstructionArguments::KernelCall &&
+        type != executorch_flatbuffer::InstructionArguments::DelegateCall) {
+      // Control flow, moves and frees keep the chain sequential.
+      return Error::Ok;
+    }
+  }
+  if (num_instructions < 2) {
+    return Error::Ok;
+  }
+
+  MemoryAllocator* allocator = memory_manager_->method_allocator();
+  const auto s_values = serialization_plan_->values();
+
+  // Calls fn for every value an instruction touches: its arguments and the
+  // items of its list arguments.
+  auto for_each_value = [&](size_t instr_idx, auto&& fn) {
+    for (EValue* arg : chain.argument_lists_[instr_idx]) {
+      const size_t value_idx = arg - values_;
+      fn(value_idx);
+      const auto s_value = s_values->Get(value_idx);
+      const flatbuffers::Vector<int32_t>* items = nullptr;
+      switch (s_value->val_type()) {
+        case executorch_flatbuffer::KernelTypes::TensorList:
+          items = s_value->val_as_TensorList()->items();
+          break;
+        case executorch_flatbuffer::KernelTypes::OptionalTensorList:
+          items = s_value->val_as_OptionalTensorList()->items();
+          break;
+        default:
+          break;
+      }
+      if (items != nullptr) {
+        for (size_t i = 0; i < items->size(); i++) {
+          if (items->Get(i) >= 0 &&
+              static_cast<size_t>(items->Get(i)) < n_value_) {
+            fn(static_cast<size_t>(items->Get(i)));
+          }
+        }
+      }
+      if (s_value->val_type() == executorch_flatbuffer::KernelTypes::IntList) {
+        const auto int_items = s_value->val_as_IntList()->items();
+        for (size_t i = 0; i < int_items->size(); i++) {
+          if (int_items->Get(i) >= 0 &&
+              static_cast<size_t>(int_items->Get(i)) < n_value_) {
+            fn(static_cast<size_t>(int_items->Get(i)));
+          }
+        }
+      }
+    }
+  };
+
+  // Mark the method inputs and outputs, which may alias each other through
+  // set_input() and set_output_data_ptr().
+  bool* is_io = ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, bool, n_value_);
+  for (size_t i = 0; i < n_value_; i++) {
+    is_io[i] = false;
+  }
+  for (size_t i = 0; i < inputs_size(); i++) {
+    is_io[get_input_index(i)] = true;
+  }
+  for (size_t i = 0; i < outputs_size(); i++) {
+    is_io[get_output_index(i)] = true;
+  }
+
+  // Level of the last instruction touching each resource: the values, then
+  // one entry per delegate, then one shared by all tensors without known
+  // memory. An instruction runs one level after everything it conflicts with.
+  const size_t num_resources = n_value_ + n_delegate_ + 1;
+  const size_t unknown_memory_resource = n_value_ + n_delegate_;
+  uint32_t* resource_levels =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint32_t, num_resources);
+  for (size_t i = 0; i < num_resources; i++) {
+    resource_levels[i] = 0;
+  }
+
+  // Memory ranges touched by the instructions so far, with their levels.
+  struct MemoryRange {
+    uintptr_t begin;
+    uintptr_t end;
+    uint32_t level;
+  };
+  size_t max_ranges = 0;
+  for (size_t instr_idx = 0; instr_idx < num_instructions; instr_idx++) {
+    for_each_value(instr_idx, [&](size_t) { max_ranges++; });
+  }
+  MemoryRange* ranges =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, MemoryRange, max_ranges);
+  size_t num_ranges = 0;
+
+  uint32_t* levels =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint32_t, num_instructions);
+  uint32_t num_waves = 0;
+  size_t num_scheduled = 0;
+  for (size_t instr_idx = 0; instr_idx < num_instructions; instr_idx++) {
+    if (chain.decoded_instructions_[instr_idx].kind ==
+        DecodedInstruction::Kind::Folded) {
+      // Already run by init(), it joins no wave.
+      levels[instr_idx] = 0;
+      continue;
+    }
+    num_scheduled++;
+    const auto instruction = instructions->Get(instr_idx);
+    size_t delegate_resource = num_resources;
+    if (instruction->instr_args_type() ==
+        executorch_flatbuffer::InstructionArguments::DelegateCall) {
+      const auto delegate_idx =
+          instruction->instr_args_as_DelegateCall()->delegate_index();
+      ET_CHECK_OR_RETURN_ERROR(
+          delegate_idx < n_delegate_,
+          InvalidProgram,
+          "DELEGATE_CALL index %" PRIu32 " >= num delegates %zu",
+          delegate_idx,
+          n_delegate_);
+      delegate_resource = n_value_ + delegate_idx;
+    }
+
+    // Find the level of the last conflicting instruction.
+    const size_t first_range = num_ranges;
+    bool touches_unknown_memory = false;
+    uint32_t level = 0;
+    if (delegate_resource < num_resources) {
+      level = resource_levels[delegate_resource];
+    }
+    for_each_value(instr_idx, [&](size_t value_idx) {
+      level = std::max(level, resource_levels[value_idx]);
+      const EValue& value = values_[value_idx];
+      if (!value.isTensor()) {
+        return;
+      }
+      const auto& tensor = value.toTensor();
+      const auto begin = reinterpret_cast<uintptr_t>(tensor.const_data_ptr());
+      // Resizing changes the size of dynamic tensors, and may move their
+      // data, after the schedule is built. Their range is not known here.
+      const auto s_tensor = s_values->Get(value_idx)->val_as_Tensor();
+      const bool is_dynamic = s_tensor == nullptr ||
+          s_tensor->shape_dynamism() !=
+              executorch_flatbuffer::TensorShapeDynamism::STATIC;
+      if (begin == 0 || is_io[value_idx] || is_dynamic) {
+        touches_unknown_memory = true;
+        return;
+      }
+      ranges[num_ranges++] =
+          MemoryRange{begin, begin + tensor.nbytes(), /*level=*/0};
+    });
+    if (touches_unknown_memory) {
+      level = std::max(level, resource_levels[unknown_memory_resource]);
+    }
+    for (size_t i = first_range; i < num_ranges; i++) {
+      for (size_t j = 0; j < first_range; j++) {
+        if (ranges[i].begin < ranges[j].end &&
+            ranges[j].begin < ranges[i].end) {
+          level = std::max(level, ranges[j].level);
+        }
+      }
+    }
+    level += 1;
+
+    // Record the level for the resources of this instruction.
+    levels[instr_idx] = level;
+    num_waves = std::max(num_waves, level);
+    if (delegate_resource < num_resources) {
+      resource_levels[delegate_resource] = level;
+    }
+    if (touches_unknown_memory) {
+      resource_levels[unknown_memory_resource] = level;
+    }
+    for_each_value(instr_idx, [&](size_t value_idx) {
+      resource_levels[value_idx] = level;
+    });
+    for (size_t i = first_range; i < num_ranges; i++) {
+      ranges[i].level = level;
+    }
+  }
+
+  if (num_waves == num_scheduled) {
+    // Every instruction depends on the previous one, nothing to parallelize.
+    return Error::Ok;
+  }
+
+  // Group the instructions by level, keeping the program order in a wave.
+  uint32_t* wave_offsets =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint32_t, num_waves + 1);
+  for (size_t i = 0; i <= num_waves; i++) {
+    wave_offsets[i] = 0;
+  }
+  for (size_t instr_idx = 0; instr_idx < num_instructions; instr_idx++) {
+    if (levels[instr_idx] > 0) {
+      wave_offsets[levels[instr_idx]]++; // Levels start at 1
+    }
+  }
+  for (size_t i = 1; i <= num_waves; i++) {
+    *max_wave_size = std::max<size_t>(*max_wave_size, wave_offsets[i]);
+    wave_offsets[i] += wave_offsets[i - 1];
+  }
+  uint32_t* wave_instructions =
+      ET_ALLOCATE_LIST_OR_RETURN_ERROR(allocator, uint32_t, num_instructions);
+  for (size_t instr_idx = 0; instr_idx < num_instructions; instr_idx++) {
+    if (levels[instr_idx] == 0) {
+      continue;
+    }
+    // Use the start offset of each wave as its insertion cursor. Afterwards
+    // each entry holds the end of its wave, so shift them back below.
+    wave_instructions[wave_offsets[levels[instr_idx] - 1]++] = instr_idx;
+  }
+  for (size_t i = num_waves; i > 0; i--) {
+    wave_offsets[i] = wave_offsets[i - 1];
+  }
+  wave_offsets[0] = 0;
+
+  chain.wave_instructions_ = wave_instructions;
+  chain.wave_offsets_ = wave_offsets;
+  chain.n_waves_ = num_waves;
+  return Error::Ok;
+}
+
+Error Method::experimental_enable_inter_op_parallelism(
+    InterOpRunner runner,
+    void* runner_context) {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Inter-op parallelism can not be enabled until method has been "
+      "initialized.");
+  ET_CHECK_OR_RETURN_ERROR(
+      runner != nullptr, InvalidArgument, "Inter-op runner is null");
+  ET_CHECK_OR_RETURN_ERROR(
+      step_state_.instr_idx == 0 && step_state_.chain_idx == 0,
+      InvalidState,
+      "Inter-op parallelism can not be enabled mid execution.");
+  ET_CHECK_OR_RETURN_ERROR(
+      value_placements_ == nullptr,
+      NotSupported,
+      "Inter-op parallelism is not supported with backends that leave "
+      "delegate outputs in device memory.");
+
+  if (inter_op_errors_ == nullptr) {
+    // Scheduling needs the tensors of every instruction.
+    Error err = resolve_deferred_kernel_calls();
+    if (err != Error::Ok) {
+      return err;
+    }
+    size_t max_wave_size = 1;
+    for (size_t i = 0; i < n_chains_; i++) {
+      size_t chain_max_wave_size = 0;
+      err = build_inter_op_schedule(chains_[i], &chain_max_wave_size);
+      if (err != Error::Ok) {
+        return err;
+      }
+      max_wave_size = std::max(max_wave_size, chain_max_wave_size);
+    }
+    inter_op_errors_ = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+        memory_manager_->method_allocator(), Error, max_wave_size);
+  }
+  inter_op_runner_ = runner;
+  inter_op_runner_context_ = runner_context;
+  return Error::Ok;
+}
+
+Result<size_t> Method::experimental_export_kernel_cache(
+    Span<uint8_t> out) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Kernel cache can not be exported until method has been initialized.");
+  const size_t num_kernel_calls = count_kernel_calls(serialization_plan_);
+  const size_t size =
+      sizeof(KernelCacheHeader) + num_kernel_calls * sizeof(uint32_t);
+  if (out.empty()) {
+    return size;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      out.size() >= size,
+      InvalidArgument,
+      "Kernel cache needs %zu bytes, got %zu",
+      size,
+      out.size());
+
+  ArrayRef<Kernel> registered = get_kernels();
+  uint8_t* entry = out.data() + sizeof(KernelCacheHeader);
+  for (size_t i = 0; i < n_chains_; ++i) {
+    const Chain& chain = chains_[i];
+    const auto instructions = chain.s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); ++instr_idx) {
+      if (chain.decoded_instructions_[instr_idx].kind !=
+          DecodedInstruction::Kind::KernelCall) {
+        continue;
+      }
+      const OpFunction kernel = chain.kernels_[instr_idx];
+      ET_CHECK_OR_RETURN_ERROR(
+          kernel != nullptr,
+          InvalidState,
+          "Kernel call %zu:%zu not resolved yet",
+          i,
+          instr_idx);
+      const auto op_index =
+          instructions->Get(instr_idx)->instr_args_as_KernelCall()->op_index();
+      constexpr size_t kTempBufferSizeForName = 100;
+      char operator_name[kTempBufferSizeForName];
+      Error err = populate_operator_name(
+          serialization_plan_->operators()->Get(op_index),
+          kTempBufferSizeForName,
+          operator_name);
+      if (err != Error::Ok) {
+        return err;
+      }
+      // Several names may share a kernel function, the name disambiguates.
+      uint32_t index = 0;
+      while (index < registered.size() &&
+             (registered[index].op_ != kernel ||
+              strcmp(registered[index].name_, operator_name) != 0)) {
+        index++;
+      }
+      ET_CHECK_OR_RETURN_ERROR(
+          index < registered.size(),
+          Internal,
+          "Kernel of %s not found in the registry",
+          operator_name);
+      memcpy(entry, &index, sizeof(index));
+      entry += sizeof(index);
+    }
+  }
+
+  KernelCacheHeader header{
+      kKernelCacheMagic,
+      kKernelCacheVersion,
+      get_kernels_fingerprint(),
+      static_cast<uint32_t>(num_kernel_calls),
+      /*reserved=*/0};
+  memcpy(out.data(), &header, sizeof(header));
+  return size;
+}
+
 Error Method::experimental_reset_execution() {
   ET_CHECK_OR_RETURN_ERROR(
       step_state_.chain_idx == n_chains_,
@@ -1160,6 +3684,16 @@ Error Method::experimental_reset_execution() {
   return Error::Ok;
 }
 
+bool Method::experimental_next_step_is_delegate_call() const {
+  if (!initialized() || step_state_.chain_idx == n_chains_) {
+    return false;
+  }
+  auto instructions = chains_[step_state_.chain_idx].s_chain_->instructions();
+  return step_state_.instr_idx < instructions->size() &&
+      instructions->Get(step_state_.instr_idx)->instr_args_type() ==
+      executorch_flatbuffer::InstructionArguments::DelegateCall;
+}
+
 // Log all the outputs of this method to the event tracer.
 void Method::log_outputs() {
 #ifdef ET_EVENT_TRACER_ENABLED
@@ -1230,6 +3764,14 @@ Error Method::execute() {
       NotSupported,
       "Cannot execute until method has been initialized.");
 
+  // Without an event tracer or the profiler there is nothing to record per
+  // instruction, so run the pre-decoded instructions in a tight loop.
+#ifdef PROFILING_ENABLED
+  const bool fast_dispatch = false;
+#else
+  const bool fast_dispatch = (event_tracer_ == nullptr);
+#endif
+
   // Chains are executed sequentially today, but future async designs may
   // branch and run many in parallel or out of order.
   for (step_state_.chain_idx = 0; step_state_.chain_idx < n_chains_;
@@ -1244,6 +3786,21 @@ Error Method::execute() {
 
     // Loop over instructions
     step_state_.instr_idx = 0;
+    if (fast_dispatch && inter_op_runner_ != nullptr &&
+        chain.wave_instructions_ != nullptr) {
+      auto status = execute_chain_parallel(chain);
+      if (status != Error::Ok) {
+        return status;
+      }
+      continue;
+    }
+    if (fast_dispatch) {
+      auto status = execute_chain_fast(chain);
+      if (status != Error::Ok) {
+        return status;
+      }
+      continue;
+    }
     while (step_state_.instr_idx < chain.s_chain_->instructions()->size()) {
       EXECUTORCH_PROFILE_INSTRUCTION_SCOPE(
           static_cast<int32_t>(step_state_.chain_idx),
@@ -1316,6 +3873,11 @@ size_t Method::get_output_index(size_t i) const {
   return static_cast<size_t>(serialization_plan_->outputs()->Get(i));
 }
 
+size_t Method::get_io_index(size_t io) const {
+  return io < inputs_size() ? get_input_index(io)
+                            : get_output_index(io - inputs_size());
+}
+
 const EValue& Method::get_output(size_t i) const {
   return get_value(get_output_index(i));
 }
@@ -1328,6 +3890,50 @@ EventTracer* Method::get_event_tracer() {
   return event_tracer_;
 }
 
+Error Method::experimental_record_planned_memory_usage(
+    Span<size_t> peak_bytes) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Cannot record memory usage until method has been initialized.");
+  const size_t num_buffers = method_meta().num_memory_planned_buffers();
+  ET_CHECK_OR_RETURN_ERROR(
+      peak_bytes.size() >= num_buffers,
+      InvalidArgument,
+      "peak_bytes has %zu entries, method has %zu planned buffers",
+      peak_bytes.size(),
+      num_buffers);
+
+  const auto* s_values = serialization_plan_->values();
+  for (size_t i = 0; i < n_value_; ++i) {
+    if (!values_[i].isTensor()) {
+      continue;
+    }
+    const auto* s_value = s_values->Get(i);
+    if (s_value->val_type() != executorch_flatbuffer::KernelTypes::Tensor) {
+      continue;
+    }
+    // Only tensors placed by the memory plan count; constants and unplanned
+    // inputs and outputs have no allocation info.
+    const auto* allocation_info = s_value->val_as_Tensor()->allocation_info();
+    if (allocation_info == nullptr) {
+      continue;
+    }
+    // Memory ID 0 is reserved, like in the tensor parser.
+    const size_t buffer_index = allocation_info->memory_id() - 1;
+    if (buffer_index >= num_buffers) {
+      continue;
+    }
+    const size_t offset = allocation_info->memory_offset_low() |
+        (static_cast<size_t>(allocation_info->memory_offset_high()) << 32);
+    const size_t end = offset + values_[i].toTensor().nbytes();
+    if (end > peak_bytes[buffer_index]) {
+      peak_bytes[buffer_index] = end;
+    }
+  }
+  return Error::Ok;
+}
+
 Method::~Method() {
   // Destroy the values. It's necessary in ATen mode, where the refcount of
   // Tensors needs to be decremented properly.
@@ -1342,6 +3948,12 @@ Method::~Method() {
       delegates_[i].~BackendDelegate();
     }
   }
+  // Free the constant segments, if the DataLoader allows it.
+  if (constant_segments_ != nullptr) {
+    for (size_t i = 0; i < n_constant_segment_; i++) {
+      constant_segments_[i].~FreeableBuffer();
+    }
+  }
   // All other fields are trivially destructible.
 }
 } // namespace executor
@@ -11,6 +11,7 @@
 #include <executorch/runtime/core/evalue.h>
 #include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/freeable_buffer.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/method_meta.h>
 #include <executorch/runtime/platform/compiler.h>
@@ -21,6 +22,7 @@ namespace executorch_flatbuffer {
 struct Chain;
 struct ExecutionPlan;
 struct EValue;
+struct Tensor;
 } // namespace executorch_flatbuffer
 
 namespace torch {
@@ -31,11 +33,18 @@ class Program;
 
 // Forward declare internal types.
 class BackendDelegate;
+class BackendInitContext;
 struct Chain;
+struct DecodedInstruction;
+struct DelegateArgPlacement;
+struct DevicePlacement;
+struct MemoryTrafficState;
 template <typename T>
 class Span;
 class KernelRuntimeContext;
+class KernelPrepackContext;
 using OpFunction = void (*)(KernelRuntimeContext&, EValue**);
+using PrepackFunction = const void* (*)(KernelPrepackContext&, EValue**);
 /// A list of pointers into the master values table that together compose the
 /// argument list for a single instruction
 using InstructionArgs = Span<EValue*>;
@@ -64,13 +73,31 @@ class Method final {
         chains_(rhs.chains_),
         init_state_(rhs.init_state_),
         pre_allocated_input_(rhs.pre_allocated_input_),
-        pre_allocated_output_(rhs.pre_allocated_output_) {
+        pre_allocated_output_(rhs.pre_allocated_output_),
+        inter_op_runner_(rhs.inter_op_runner_),
+        inter_op_runner_context_(rhs.inter_op_runner_context_),
+        inter_op_errors_(rhs.inter_op_errors_),
+        memory_traffic_(rhs.memory_traffic_),
+        value_placements_(rhs.value_placements_),
+        delegate_arg_placements_(rhs.delegate_arg_placements_),
+        n_io_buffer_sets_(rhs.n_io_buffer_sets_),
+        io_buffers_(rhs.io_buffers_),
+        batch_args_(rhs.batch_args_),
+        batch_lists_(rhs.batch_lists_),
+        value_parsed_(rhs.value_parsed_),
+        value_written_(rhs.value_written_),
+        resolved_operators_(rhs.resolved_operators_),
+        n_constant_segment_(rhs.n_constant_segment_),
+        constant_segments_(rhs.constant_segments_),
+        external_constants_(rhs.external_constants_) {
     // Required: clear out fields that the dtor looks at, so that we don't free
     // anything twice.
     rhs.n_value_ = 0;
     rhs.values_ = nullptr;
     rhs.n_delegate_ = 0;
     rhs.delegates_ = nullptr;
+    rhs.n_constant_segment_ = 0;
+    rhs.constant_segments_ = nullptr;
 
     // Helpful: Try to ensure that any other interactions with the old object
     // result in failures.
@@ -84,8 +111,49 @@ class Method final {
     rhs.chains_ = nullptr;
     rhs.pre_allocated_input_ = false;
     rhs.pre_allocated_output_ = false;
+    rhs.inter_op_runner_ = nullptr;
+    rhs.inter_op_runner_context_ = nullptr;
+    rhs.inter_op_errors_ = nullptr;
+    rhs.memory_traffic_ = nullptr;
+    rhs.value_placements_ = nullptr;
+    rhs.delegate_arg_placements_ = nullptr;
+    rhs.n_io_buffer_sets_ = 0;
+    rhs.io_buffers_ = nullptr;
+    rhs.batch_args_ = nullptr;
+    rhs.batch_lists_ = nullptr;
+    rhs.value_parsed_ = nullptr;
+    rhs.value_written_ = nullptr;
+    rhs.resolved_operators_ = nullptr;
   }
 
+  /**
+   * Runs `task(task_context, i)` for every `i` in `[0, num_tasks)`, possibly
+   * concurrently, and returns once all of them have completed.
+   */
+  using InterOpRunner = void (*)(
+      void* runner_context,
+      size_t num_tasks,
+      void (*task)(void* task_context, size_t task_index),
+      void* task_context);
+
+  /**
+   * Provides the data of the constant tensors that a program only names, see
+   * Program::experimental_load_method_with_external_constants().
+   */
+  struct ExternalConstantProvider {
+    /**
+     * Returns the data of the constant named `name`, which must be `nbytes`
+     * long, must not be modified and must outlive the Method; or an error if
+     * there is no such constant.
+     */
+    Result<const void*> (*get_constant)(
+        void* context,
+        const char* name,
+        size_t nbytes);
+    /// Passed to get_constant.
+    void* context;
+  };
+
   /**
    * Sets the internal input value to be equivalent to the to the provided
    * value.
@@ -143,6 +211,133 @@ class Method final {
   __ET_NODISCARD Error
   set_output_data_ptr(void* buffer, size_t size, size_t output_idx);
 
+  /**
+   * Points the specified tensor input at the data of `input_evalue` instead of
+   * copying it, even if the memory plan allocated a buffer for the input.
+   * Otherwise behaves like set_input().
+   *
+   * NOTE: The data must outlive the executions that use it, and kernels that
+   * write to the input write to it. Later calls to set_input() copy into the
+   * shared data rather than the planned buffer, so use this API for all the
+   * values of an input once it is used.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] input_evalue The tensor to share with the method input. Its
+   *     dtype must match the input's and its shape must be valid for it.
+   * @param[in] input_idx Zero-based index of the input to set. Must be less
+   *     than the value returned by inputs_size().
+   *
+   * @returns Error::Ok on success, non-Ok on failure.
+   */
+  __ET_NODISCARD Error
+  experimental_share_input(const EValue& input_evalue, size_t input_idx);
+
+  /**
+   * Allocates `num_sets` sets of buffers for the tensor inputs and outputs of
+   * the method from the method allocator, and selects set 0. While the method
+   * executes with one set selected, a producer may fill the inputs of another
+   * set and a consumer may read the outputs of a third, so that a streaming
+   * pipeline does not have to wait for execute() before writing the next
+   * frame.
+   *
+   * Each buffer holds the current nbytes() of its tensor, which for tensors
+   * with dynamic shapes is their upper bound at load time. Constant outputs
+   * and non-tensor values are not double buffered; their buffers are empty.
+   * An output that is also an input, or an earlier output, shares its
+   * buffers.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] num_sets The number of buffer sets, typically 2. Must be > 0.
+   *
+   * @retval Error::Ok on success.
+   * @retval Error::InvalidState if the sets were already allocated, or
+   *     execution is in progress.
+   * @retval Error::MemoryAllocationFailed if the method allocator is too
+   *     small.
+   */
+  __ET_NODISCARD Error experimental_allocate_io_buffer_sets(size_t num_sets);
+
+  /**
+   * Points the tensor inputs and outputs of the method at the buffers of the
+   * given set, so that the next execution reads and writes them. Inputs set
+   * with set_input() are copied into the selected set if the memory plan
+   * allocated them; set_input() on other inputs and set_output_data_ptr()
+   * repoint single tensors until the next call.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] set_idx The set to select. Must be less than the `num_sets`
+   *     passed to experimental_allocate_io_buffer_sets().
+   *
+   * @returns Error::Ok on success, non-Ok on failure.
+   */
+  __ET_NODISCARD Error experimental_select_io_buffer_set(size_t set_idx);
+
+  /**
+   * Returns the buffer of an input in a set allocated by
+   * experimental_allocate_io_buffer_sets(). Safe to call, and to write to the
+   * buffer, while a different set executes.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] set_idx The set of the buffer.
+   * @param[in] input_idx Zero-based index of the input. Must be less than the
+   *     value returned by inputs_size().
+   *
+   * @returns The buffer, which is empty for inputs that are not tensors.
+   */
+  __ET_NODISCARD Result<Span<uint8_t>> experimental_input_buffer(
+      size_t set_idx,
+      size_t input_idx) const;
+
+  /**
+   * Returns the buffer of an output in a set allocated by
+   * experimental_allocate_io_buffer_sets(). Safe to call, and to read from
+   * the buffer, while a different set executes.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] set_idx The set of the buffer.
+   * @param[in] output_idx Zero-based index of the output. Must be less than
+   *     the value returned by outputs_size().
+   *
+   * @returns The buffer, which is empty for outputs that are not double
+   *     buffered.
+   */
+  __ET_NODISCARD Result<Span<uint8_t>> experimental_output_buffer(
+      size_t set_idx,
+      size_t output_idx) const;
+
+  /**
+   * Executes the method once for each of the given I/O buffer sets, whose
+   * inputs were written through experimental_input_buffer(). The outputs of
+   * a set are read through experimental_output_buffer(), or by selecting the
+   * set. Leaves the last set of the batch selected.
+   *
+   * If the method is a single delegate call whose tensor arguments are all
+   * constants, or inputs and outputs with static shapes and buffers in the
+   * sets, its backend receives all sets in one execute_batch() call, so that
+   * an accelerator can submit them together. Without an event tracer or
+   * device buffers, that is; otherwise, and for other methods, the sets are
+   * selected and executed one after another.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] set_indices The sets to execute, each at most once. Must not
+   *     be more than the `num_sets` passed to
+   *     experimental_allocate_io_buffer_sets().
+   *
+   * @retval Error::Ok if all sets executed successfully.
+   * @retval Error::InvalidState if the sets have not been allocated, or
+   *     execution is in progress.
+   * @retval Error::InvalidArgument if a set index is out of range or
+   *     repeated.
+   */
+  __ET_NODISCARD Error
+  experimental_execute_batch(Span<const size_t> set_indices);
+
   /**
    * Copies the method's outputs into the provided array.
    *
@@ -172,6 +367,72 @@ class Method final {
    */
   __ET_NODISCARD Error execute();
 
+  /**
+   * Enables inter-op parallel execution. On first use, each chain is split
+   * into waves of instructions that share no values and no tensor memory, and
+   * execute() runs the instructions of each wave through `runner`. The waves
+   * themselves still run in order.
+   *
+   * Only chains made of kernel and delegate calls are parallelized; chains
+   * with control flow, moves or frees keep running sequentially. Execution
+   * with an event tracer is always sequential. Instructions that run
+   * concurrently get no temp allocator. Method inputs and outputs are assumed
+   * to possibly alias each other, so they may be set before or after this
+   * call. So are tensors with dynamic shapes, whose size and data can change
+   * when they are resized.
+   *
+   * The schedule is allocated from the method allocator.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] runner The function running the tasks of a wave. It must not
+   *     run the tasks on the threads of a pool that the kernels themselves
+   *     block on.
+   * @param[in] runner_context Passed to every `runner` call.
+   *
+   * @returns Error::Ok on success, non-Ok on failure.
+   */
+  __ET_NODISCARD Error experimental_enable_inter_op_parallelism(
+      InterOpRunner runner,
+      void* runner_context);
+
+  /**
+   * Raises each entry of `peak_bytes` to the number of bytes of the
+   * corresponding memory-planned buffer that the method's tensors cover with
+   * their current sizes. Called after each execution with the same array, this
+   * records how much of each planned buffer real inputs need, which can be
+   * less than the planned size when tensors have dynamic shapes.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in,out] peak_bytes One entry per memory-planned buffer, indexed
+   *     like `MethodMeta::memory_planned_buffer_size()`. Must have at least
+   *     `num_memory_planned_buffers()` entries; initialize to zero.
+   *
+   * @returns Error::Ok on success, non-Ok on failure.
+   */
+  __ET_NODISCARD Error
+  experimental_record_planned_memory_usage(Span<size_t> peak_bytes) const;
+
+  /**
+   * Writes the kernel resolved for each kernel call of the method to `out`,
+   * as indices into the operator registry. Passing the result to
+   * `Program::experimental_load_method_with_kernel_cache()` in a later run of
+   * the same binary skips resolving the kernels by name. Save it e.g. in a
+   * file next to the program.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[out] out Receives the cache. If empty, nothing is written.
+   *
+   * @returns The size of the cache in bytes.
+   * @retval Error::InvalidArgument `out` is not empty but too small.
+   * @retval Error::InvalidState Some kernel calls of a method loaded with
+   *     lazy values have not run yet.
+   */
+  __ET_NODISCARD Result<size_t> experimental_export_kernel_cache(
+      Span<uint8_t> out) const;
+
   /**
    * Advances/executes a single instruction in the method.
    *
@@ -196,6 +457,15 @@ class Method final {
    */
   __ET_NODISCARD Error experimental_reset_execution();
 
+  /**
+   * Returns true if the next `experimental_step()` will execute a delegate
+   * call. Lets a scheduler yield before handing the CPU to a backend, whose
+   * calls are typically much longer than a single kernel.
+   *
+   * NOTE: Prototype API; subject to change.
+   */
+  bool experimental_next_step_is_delegate_call() const;
+
   /**
    * Returns the MethodMeta that corresponds to the calling Method.
    */
@@ -270,21 +540,80 @@ class Method final {
         chains_(nullptr),
         init_state_(InitializationState::Uninitialized),
         pre_allocated_input_(false),
-        pre_allocated_output_(false) {}
+        pre_allocated_output_(false),
+        inter_op_runner_(nullptr),
+        inter_op_runner_context_(nullptr),
+        inter_op_errors_(nullptr),
+        memory_traffic_(nullptr),
+        value_placements_(nullptr),
+        delegate_arg_placements_(nullptr),
+        n_io_buffer_sets_(0),
+        io_buffers_(nullptr),
+        batch_args_(nullptr),
+        batch_lists_(nullptr),
+        value_parsed_(nullptr),
+        value_written_(nullptr),
+        resolved_operators_(nullptr),
+        n_constant_segment_(0),
+        constant_segments_(nullptr),
+        external_constants_{nullptr, nullptr} {}
 
   /// Static factory used by Program.
   __ET_NODISCARD static Result<Method> load(
       executorch_flatbuffer::ExecutionPlan* s_plan,
       const Program* program,
       MemoryManager* memory_manager,
-      EventTracer* event_tracer);
+      EventTracer* event_tracer,
+      InterOpRunner delegate_init_runner = nullptr,
+      void* delegate_init_runner_context = nullptr,
+      bool lazy_values = false,
+      Span<const uint8_t> kernel_cache = {},
+      bool fold_constants = false,
+      const ExternalConstantProvider* external_constants = nullptr);
 
   /**
    * Initialize the method from its serialized representation.
    *
+   * @param[in] delegate_init_runner If non-null, runs the init() calls of
+   *     backends with a thread-safe init() concurrently.
+   * @param[in] delegate_init_runner_context Passed to `delegate_init_runner`.
+   * @param[in] lazy_values If true, only parses the inputs, outputs and the
+   *     arguments of instructions other than kernel calls. Each kernel call
+   *     parses its arguments and resolves its operator when it first runs.
+   * @param[in] kernel_cache The output of experimental_export_kernel_cache(),
+   *     or empty. Ignored if stale.
+   * @param[in] fold_constants If true, runs the kernel calls whose arguments
+   *     are all constant once, and removes them from execution. Ignored if
+   *     `lazy_values` is true.
+   * @param[in] external_constants If not null, provides the data of the
+   *     constant tensors that have a constant_name. Copied.
+   *
    * @returns Error::Ok on success, non-Ok on failure.
    */
-  __ET_NODISCARD Error init(executorch_flatbuffer::ExecutionPlan* s_plan);
+  __ET_NODISCARD Error init(
+      executorch_flatbuffer::ExecutionPlan* s_plan,
+      InterOpRunner delegate_init_runner = nullptr,
+      void* delegate_init_runner_context = nullptr,
+      bool lazy_values = false,
+      Span<const uint8_t> kernel_cache = {},
+      bool fold_constants = false,
+      const ExternalConstantProvider* external_constants = nullptr);
+
+  // Points `tensor`, parsed from `s_tensor`, at the data of its named constant
+  // from external_constants_.
+  __ET_NODISCARD Error set_external_constant_data(
+      const executorch_flatbuffer::Tensor* s_tensor,
+      const exec_aten::Tensor& tensor);
+
+  // Initializes all delegates, running the init() calls of backends that
+  // declare a thread-safe init() through `runner`.
+  __ET_NODISCARD Error
+  init_delegates_parallel(InterOpRunner runner, void* runner_context);
+
+  // Calls the init() of the prepared delegate at `delegate_index`, profiled as
+  // the instruction that calls the delegate.
+  __ET_NODISCARD Error
+  init_delegate(size_t delegate_index, BackendInitContext& context);
 
   /// Returns true if the Method was successfully initialized.
   inline bool initialized() const {
@@ -296,9 +625,72 @@ class Method final {
   size_t get_input_index(size_t i) const;
   size_t get_output_index(size_t i) const;
 
+  // Returns the value index of input `io`, or of output `io - inputs_size()`.
+  size_t get_io_index(size_t io) const;
+
+  // Returns the buffer of input or output `io` in an I/O buffer set.
+  __ET_NODISCARD Result<Span<uint8_t>> get_io_buffer(size_t set_idx, size_t io)
+      const;
+
+  // Sets batch_args_ and batch_lists_ if the method is a single delegate call
+  // that can run the `num_sets` I/O buffer sets in one execute_batch().
+  void init_batch_args(size_t num_sets);
+
   // Executes a single instruction using the state in step_state_
   __ET_NODISCARD Error execute_instruction();
 
+  // Executes all instructions of a chain from their decoded form, without
+  // tracing or profiling. Other than KernelCall and JumpFalseCall, the
+  // instructions are delegated to execute_instruction().
+  __ET_NODISCARD Error execute_chain_fast(Chain& chain);
+
+  // Logs the failure of the KernelCall instruction at step_state_.
+  void log_kernel_call_failure(Error err) const;
+
+  // Executes the waves of a chain scheduled by
+  // experimental_enable_inter_op_parallelism().
+  __ET_NODISCARD Error execute_chain_parallel(Chain& chain);
+
+  // Runs a KernelCall or DelegateCall instruction of a scheduled chain, with
+  // the given temp allocator, which may be null.
+  __ET_NODISCARD Error run_scheduled_instruction(
+      const Chain& chain,
+      size_t instr_idx,
+      MemoryAllocator* temp_allocator);
+
+  // Task function passed to inter_op_runner_.
+  static void run_inter_op_task(void* context, size_t task_index);
+
+  // Splits a chain into waves of independent instructions. Returns the width
+  // of the widest wave through max_wave_size.
+  __ET_NODISCARD Error
+  build_inter_op_schedule(Chain& chain, size_t* max_wave_size);
+
+  // Finds the buffer of each tensor and the instruction that writes it, for
+  // log_memory_traffic().
+  __ET_NODISCARD Error init_memory_traffic_tracing();
+
+  // If a backend supports device buffers, finds the tensors that may stay in
+  // device memory between its delegate calls, and the other instructions
+  // that need those tensors in host memory.
+  __ET_NODISCARD Error init_device_placement();
+
+  // Copies a value that a backend left in device memory to host memory.
+  __ET_NODISCARD Error copy_value_to_host(size_t value_idx);
+
+  // Copies the device_syncs of an instruction to host memory.
+  __ET_NODISCARD Error
+  copy_device_values_to_host(const DecodedInstruction& instr);
+
+  // Runs a delegate, tracking the placement of its arguments if a backend
+  // supports device buffers.
+  __ET_NODISCARD Error
+  execute_delegate(size_t delegate_idx, InstructionArgs args);
+
+  // Reports the bytes moved by the KernelCall or DelegateCall instruction at
+  // step_state_ to the event tracer.
+  void log_memory_traffic(const Chain& chain);
+
   StepState step_state_;
   const Program* program_;
   MemoryManager* memory_manager_;
@@ -318,19 +710,127 @@ class Method final {
   bool pre_allocated_input_;
   bool pre_allocated_output_;
 
+  InterOpRunner inter_op_runner_;
+  void* inter_op_runner_context_;
+  // Status of each task of the wave being run by inter_op_runner_.
+  Error* inter_op_errors_;
+
+  // Set by init() if the event tracer traces memory traffic.
+  MemoryTrafficState* memory_traffic_;
+
+  // Set by init() if a backend may leave delegate outputs in device memory:
+  // the placement of each value, and room for those of the arguments of a
+  // delegate call.
+  DevicePlacement* value_placements_;
+  DelegateArgPlacement* delegate_arg_placements_;
+
+  // Set by experimental_allocate_io_buffer_sets(): for each set, the buffers
+  // of the inputs followed by those of the outputs.
+  size_t n_io_buffer_sets_;
+  Span<uint8_t>* io_buffers_;
+
+  // Set by experimental_allocate_io_buffer_sets() if the sets of a batch can
+  // be handed to the backend at once: for each set, the arguments of the
+  // delegate call with the tensors of the set, and room for the argument
+  // lists of a batch.
+  EValue** batch_args_;
+  EValue*** batch_lists_;
+
+  // Whether each value has been parsed, if values are parsed lazily. Null if
+  // all of them were parsed by init().
+  bool* value_parsed_;
+
+  // Bit set of the values that instructions or callers may assign to, see
+  // find_written_values().
+  uint8_t* value_written_;
+
+  // The kernel of each operator, indexed by op index, if no registered kernel
+  // has a kernel key. Entries are filled by the first call site of their
+  // operator, see resolve_operator().
+  struct ResolvedOperator {
+    OpFunction kernel;
+    PrepackFunction prepack;
+  };
+  ResolvedOperator* resolved_operators_;
+
+  // The constant segments used by the method, indexed by segment index, if
+  // the program splits its constants over segments. Empty entries are
+  // segments the method does not use.
+  size_t n_constant_segment_;
+  FreeableBuffer* constant_segments_;
+
+  // Provides the data of the constant tensors that have a constant_name.
+  ExternalConstantProvider external_constants_;
+
+  /**
+   * Loads the constant segments used by the method into constant_segments_,
+   * if the program splits its constants over segments. On error,
+   * n_constant_segment_ will be set to the number of initialized entries.
+   */
+  __ET_NODISCARD Error load_constant_segments();
+
   /**
    * Parses the elements of the values_ array. On error, n_value_ will be set to
    * the number of successfully-initialized entries so that ~Method doesn't try
    * to clean up uninitialized entries.
+   *
+   * If `lazy` is true, sets all values to None and only parses the inputs and
+   * outputs; the other values are parsed by ensure_value_parsed().
    */
-  __ET_NODISCARD Error parse_values();
+  __ET_NODISCARD Error parse_values(bool lazy);
+
+  /// Parses the serialized value at index `i` into values_[i], which must be
+  /// uninitialized or None.
+  __ET_NODISCARD Error parse_value(size_t i);
+
+  /// Parses values_[i], and the items it points to if it is a list, unless
+  /// they were already parsed.
+  __ET_NODISCARD Error ensure_value_parsed(size_t i);
+
+  /// Fills value_written_ from the serialized plan.
+  __ET_NODISCARD Error find_written_values();
+
+  /// Freezes values_[i] if it is a list whose items are never assigned to,
+  /// so that kernels do not unwrap it again on every call. Its items must be
+  /// parsed.
+  void freeze_list_if_constant(size_t i);
+
+  /// Parses the arguments of the KernelCall instruction at `instr_idx` of
+  /// `chain`, whose parsing was deferred, and resolves its operator.
+  __ET_NODISCARD Error resolve_kernel_call(Chain& chain, size_t instr_idx);
+
+  /// Resolves all the kernel calls deferred by lazy value parsing.
+  __ET_NODISCARD Error resolve_deferred_kernel_calls();
+
+  /// Runs the kernel calls whose arguments are all constant, storing their
+  /// outputs in memory from the method allocator, and marks them folded so
+  /// that execution skips them.
+  __ET_NODISCARD Error fold_constant_instructions();
 
   __ET_NODISCARD Error resolve_operator(
       int32_t op_index,
       OpFunction* kernels,
       size_t kernel_index,
       InstructionArgs args,
-      size_t n_args);
+      size_t n_args,
+      PrepackFunction* prepack);
+
+  /// Resolves the operator at `op_index` to the registered kernel at index
+  /// `cached_kernel`, without matching the kernel keys. Returns
+  /// Error::NotFound if that kernel is not one of the operator.
+  __ET_NODISCARD Error resolve_operator_from_cache(
+      int32_t op_index,
+      uint32_t cached_kernel,
+      OpFunction* kernels,
+      size_t kernel_index,
+      PrepackFunction* prepack);
+
+  /// Runs `prepack` over the arguments of a kernel call and returns the
+  /// prepacked data for the call.
+  Result<const void*> prepack_kernel_call(
+      PrepackFunction prepack,
+      InstructionArgs args,
+      const int32_t* arg_idxs);
 
   void log_outputs();
 };
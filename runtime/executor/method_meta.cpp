@@ -196,5 +196,28 @@ Result<int64_t> MethodMeta::memory_planned_buffer_size(size_t index) const {
   return s_plan_->non_const_buffer_sizes()->Get(index + 1);
 }
 
+Result<const char*> MethodMeta::memory_planned_buffer_tier(
+    size_t index) const {
+  auto num_buffers = this->num_memory_planned_buffers();
+  ET_CHECK_OR_RETURN_ERROR(
+      index < num_buffers,
+      InvalidArgument,
+      "index %zu out of range. num_buffers: %zu",
+      index,
+      num_buffers);
+  const auto* tiers = s_plan_->non_const_buffer_tiers();
+  if (tiers == nullptr || tiers->size() == 0) {
+    return nullptr;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      tiers->size() == num_buffers + 1,
+      InvalidProgram,
+      "%zu memory tiers for %zu buffers",
+      static_cast<size_t>(tiers->size()),
+      num_buffers);
+  // Entry zero is reserved, as in non_const_buffer_sizes.
+  return tiers->Get(index + 1)->c_str();
+}
+
 } // namespace executor
 } // namespace torch
@@ -176,6 +176,17 @@ class MethodMeta final {
    */
   Result<int64_t> memory_planned_buffer_size(size_t index) const;
 
+  /**
+   * Get the name of the memory tier (e.g. "sram" or "dram") that the
+   * specified memory-planned buffer was planned for. Runners can use it to
+   * back each buffer with the matching memory region.
+   *
+   * @param[in] index The index of the buffer to look up.
+   * @returns The tier name on success, nullptr if the program was planned
+   *     without memory tiers, or an error on failure.
+   */
+  Result<const char*> memory_planned_buffer_tier(size_t index) const;
+
   /**
    * DEPRECATED: Use num_memory_planned_buffers() instead.
    */
@@ -8,10 +8,12 @@
 
 #include <executorch/runtime/executor/program.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
 #include <executorch/runtime/core/event_tracer_hooks.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/platform/profiler.h>
@@ -46,6 +48,122 @@ bool IsAligned(const void* data) {
   return addr % kMinimumAlignment == 0;
 }
 
+// The blocks of a compressed segment, decompressed by one task each.
+struct DecompressionTasks {
+  const Program::ConstantDecompressor* decompressor;
+  Program::CompressionCodec codec;
+  const uint8_t* src;
+  size_t src_size;
+  const flatbuffers::Vector<uint64_t>* block_offsets;
+  uint8_t* dst;
+  size_t dst_size;
+  size_t block_size;
+  Error* errors;
+};
+
+void run_decompression_task(void* task_context, size_t task_index) {
+  auto* tasks = static_cast<DecompressionTasks*>(task_context);
+  const uint64_t begin = tasks->block_offsets->Get(task_index);
+  const uint64_t end = task_index + 1 < tasks->block_offsets->size()
+      ? tasks->block_offsets->Get(task_index + 1)
+      : tasks->src_size;
+  const size_t dst_offset = task_index * tasks->block_size;
+  tasks->errors[task_index] = tasks->decompressor->decompress_block(
+      tasks->decompressor->context,
+      tasks->codec,
+      tasks->src + begin,
+      end - begin,
+      tasks->dst + dst_offset,
+      std::min(tasks->block_size, tasks->dst_size - dst_offset));
+}
+
+/**
+ * Decompresses the blocks of `compressed`, described by `compression`, into a
+ * buffer allocated from the decompressor's allocator, and frees `compressed`.
+ */
+Result<FreeableBuffer> decompress_segment(
+    FreeableBuffer&& compressed,
+    const executorch_flatbuffer::SegmentCompression* compression,
+    const Program::ConstantDecompressor& decompressor) {
+  const auto codec = compression->codec();
+  ET_CHECK_OR_RETURN_ERROR(
+      codec == executorch_flatbuffer::CompressionCodec::ZSTD ||
+          codec == executorch_flatbuffer::CompressionCodec::LZ4,
+      NotSupported,
+      "Unknown compression codec %d",
+      static_cast<int>(codec));
+  const auto* block_offsets = compression->block_offsets();
+  const size_t uncompressed_size = compression->uncompressed_size();
+  const size_t block_size = compression->block_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      block_offsets != nullptr && block_size > 0 &&
+          block_offsets->size() ==
+              (uncompressed_size + block_size - 1) / block_size,
+      InvalidProgram,
+      "Inconsistent compressed segment: %zu bytes in blocks of %zu",
+      uncompressed_size,
+      block_size);
+  const size_t num_blocks = block_offsets->size();
+  uint64_t prev_offset = 0;
+  for (uint64_t offset : *block_offsets) {
+    ET_CHECK_OR_RETURN_ERROR(
+        offset >= prev_offset && offset <= compressed.size(),
+        InvalidProgram,
+        "Compressed block offset %" PRIu64 " out of order or range %zu",
+        offset,
+        compressed.size());
+    prev_offset = offset;
+  }
+
+  const size_t alignment =
+      std::max<size_t>(compression->alignment(), kMinimumAlignment);
+  auto* dst = static_cast<uint8_t*>(
+      decompressor.allocator->allocate(uncompressed_size, alignment));
+  ET_CHECK_OR_RETURN_ERROR(
+      dst != nullptr || uncompressed_size == 0,
+      MemoryAllocationFailed,
+      "Failed to allocate %zu bytes for the constant segment",
+      uncompressed_size);
+  Error* errors = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+      decompressor.allocator, Error, num_blocks);
+
+  DecompressionTasks tasks = {
+      &decompressor,
+      static_cast<Program::CompressionCodec>(codec),
+      static_cast<const uint8_t*>(compressed.data()),
+      compressed.size(),
+      block_offsets,
+      dst,
+      uncompressed_size,
+      block_size,
+      errors};
+  if (decompressor.runner != nullptr && num_blocks > 1) {
+    decompressor.runner(
+        decompressor.runner_context,
+        num_blocks,
+        &run_decompression_task,
+        &tasks);
+  } else {
+    for (size_t i = 0; i < num_blocks; ++i) {
+      run_decompression_task(&tasks, i);
+    }
+  }
+  // Only the decompressed data is needed from now on.
+  compressed.Free();
+  for (size_t i = 0; i < num_blocks; ++i) {
+    if (errors[i] != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Failed to decompress block %zu of the constant segment: 0x%" PRIx32,
+          i,
+          static_cast<uint32_t>(errors[i]));
+      return errors[i];
+    }
+  }
+  // The allocator owns the data.
+  return FreeableBuffer(dst, uncompressed_size, /*free_fn=*/nullptr);
+}
+
 Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
     const executorch_flatbuffer::Program* program,
     const char* method_name) {
@@ -60,18 +178,143 @@ Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
   return Error::InvalidArgument;
 }
 
+/**
+ * Constants separated by at most this many bytes of padding are prefetched
+ * with a single hint.
+ */
+constexpr size_t kPrefetchCoalesceGapBytes = 4096;
+
+/**
+ * Returns the serialized tensor at `value_index` if it is a constant tensor,
+ * or nullptr otherwise.
+ */
+const executorch_flatbuffer::Tensor* get_constant_tensor(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    int64_t value_index) {
+  const auto* values = plan->values();
+  if (values == nullptr || value_index < 0 ||
+      static_cast<size_t>(value_index) >= values->size()) {
+    return nullptr;
+  }
+  const auto* value = values->Get(value_index);
+  if (value->val_type() != executorch_flatbuffer::KernelTypes::Tensor) {
+    return nullptr;
+  }
+  const auto* s_tensor = value->val_as_Tensor();
+  if (s_tensor == nullptr || s_tensor->constant_buffer_idx() == 0) {
+    return nullptr;
+  }
+  return s_tensor;
+}
+
+size_t get_tensor_nbytes(const executorch_flatbuffer::Tensor* s_tensor) {
+  size_t numel = 1;
+  if (s_tensor->sizes() != nullptr) {
+    for (int32_t size : *s_tensor->sizes()) {
+      numel *= size;
+    }
+  }
+  return numel *
+      elementSize(static_cast<exec_aten::ScalarType>(s_tensor->scalar_type()));
+}
+
+/**
+ * Appends `value_index` to the first `*count` entries of `out` if it refers to
+ * a constant tensor that is not already listed.
+ */
+void record_constant_use(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    int32_t value_index,
+    Span<uint32_t> out,
+    size_t* count) {
+  if (*count >= out.size() ||
+      get_constant_tensor(plan, value_index) == nullptr) {
+    return;
+  }
+  const uint32_t index = static_cast<uint32_t>(value_index);
+  if (std::find(out.begin(), out.begin() + *count, index) ==
+      out.begin() + *count) {
+    out[(*count)++] = index;
+  }
+}
+
+/**
+ * Records the constant tensors used by an instruction argument, looking
+ * through tensor lists.
+ */
+void record_arg_constant_uses(
+    const executorch_flatbuffer::ExecutionPlan* plan,
+    int32_t arg_index,
+    Span<uint32_t> out,
+    size_t* count) {
+  const auto* values = plan->values();
+  if (values == nullptr || arg_index < 0 ||
+      static_cast<size_t>(arg_index) >= values->size()) {
+    return;
+  }
+  const auto* value = values->Get(arg_index);
+  const flatbuffers::Vector<int32_t>* items = nullptr;
+  switch (value->val_type()) {
+    case executorch_flatbuffer::KernelTypes::Tensor:
+      record_constant_use(plan, arg_index, out, count);
+      return;
+    case executorch_flatbuffer::KernelTypes::TensorList:
+      items = value->val_as_TensorList()->items();
+      break;
+    case executorch_flatbuffer::KernelTypes::OptionalTensorList:
+      items = value->val_as_OptionalTensorList()->items();
+      break;
+    default:
+      return;
+  }
+  if (items != nullptr) {
+    for (int32_t item : *items) {
+      record_constant_use(plan, item, out, count);
+    }
+  }
+}
+
 } // namespace
 
 /* static */ Result<Program> Program::load(
     DataLoader* loader,
-    Program::Verification verification) {
+    Program::Verification verification,
+    EventTracer* event_tracer) {
+  return load_internal(
+      loader, verification, event_tracer, /*decompressor=*/nullptr);
+}
+
+/* static */ Result<Program> Program::experimental_load_with_decompressor(
+    DataLoader* loader,
+    const ConstantDecompressor& decompressor,
+    Program::Verification verification,
+    EventTracer* event_tracer) {
+  ET_CHECK_OR_RETURN_ERROR(
+      decompressor.decompress_block != nullptr &&
+          decompressor.allocator != nullptr,
+      InvalidArgument,
+      "Decompressor needs a decompress_block function and an allocator");
+  return load_internal(loader, verification, event_tracer, &decompressor);
+}
+
+/* static */ Result<Program> Program::load_internal(
+    DataLoader* loader,
+    Program::Verification verification,
+    EventTracer* event_tracer,
+    const ConstantDecompressor* decompressor) {
   EXECUTORCH_SCOPE_PROF("Program::load");
+  internal::event_tracer_create_event_block(event_tracer, "load");
+  internal::EventTracerProfileScope event_tracer_scope =
+      internal::EventTracerProfileScope(event_tracer, "Program::load");
 
   // See if the program size is in the header.
   size_t program_size = 0;
   size_t segment_base_offset = 0;
   {
     EXECUTORCH_SCOPE_PROF("Program::check_header");
+    internal::EventTracerProfileScope check_header_scope =
+        internal::EventTracerProfileScope(
+            event_tracer, "Program::check_header");
     Result<FreeableBuffer> header =
         loader->Load(/*offset=*/0, ExtendedHeader::kNumHeadBytes);
     if (!header.ok()) {
@@ -95,11 +338,15 @@ Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
 
   // Load the flatbuffer data as a segment.
   uint32_t prof_tok = EXECUTORCH_BEGIN_PROF("Program::load_data");
+  EventTracerEntry load_data_entry =
+      internal::event_tracer_begin_profiling_event(
+          event_tracer, "Program::load_data");
   Result<FreeableBuffer> program_data =
       loader->Load(/*offset=*/0, program_size);
   if (!program_data.ok()) {
     return program_data.error();
   }
+  internal::event_tracer_end_profiling_event(event_tracer, load_data_entry);
   EXECUTORCH_END_PROF(prof_tok);
 
   // Make sure the magic header matches the expected version.
@@ -117,6 +364,9 @@ Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
   if (verification == Verification::InternalConsistency) {
 #if ET_ENABLE_PROGRAM_VERIFICATION
     EXECUTORCH_SCOPE_PROF("Program::verify_internal_consistency");
+    internal::EventTracerProfileScope verify_scope =
+        internal::EventTracerProfileScope(
+            event_tracer, "Program::verify_internal_consistency");
     flatbuffers::Verifier verifier(
         reinterpret_cast<const uint8_t*>(program_data->data()),
         program_data->size());
@@ -144,6 +394,16 @@ Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
   const executorch_flatbuffer::Program* flatbuffer_program =
       executorch_flatbuffer::GetProgram(program_data->data());
 
+  // Announce the segment loads up front, so that loaders that read
+  // asynchronously can fetch delegate payloads while the constant segment is
+  // loaded and the methods are initialized.
+  if (segment_base_offset > 0 && flatbuffer_program->segments() != nullptr) {
+    for (const auto* segment : *flatbuffer_program->segments()) {
+      loader->will_load(
+          segment_base_offset + segment->offset(), segment->size());
+    }
+  }
+
   // Constant data may live inside the flatbuffer data (constant_buffer) or in a
   // separate segment (constant_segment). It should not be in both.
   const auto* constant_segment = flatbuffer_program->constant_segment();
@@ -171,13 +431,75 @@ Result<executorch_flatbuffer::ExecutionPlan*> get_execution_plan(
         constant_segment->segment_index(),
         segments->size());
 
+    const auto* constant_segment_indices =
+        flatbuffer_program->constant_segment_indices();
+    const auto* compression =
+        flatbuffer_program->constant_segment_compression();
+    if (constant_segment_indices != nullptr &&
+        constant_segment_indices->size() > 0) {
+      ET_CHECK_OR_RETURN_ERROR(
+          compression == nullptr,
+          InvalidProgram,
+          "Split constant segments cannot be compressed");
+      // The constants are split over segments that Method loads along with
+      // the methods that use them.
+      ET_CHECK_OR_RETURN_ERROR(
+          constant_segment_indices->size() ==
+              constant_segment->offsets()->size(),
+          InvalidProgram,
+          "constant_segment_indices contains %u items, "
+          "constant_segment.offsets contains %u items",
+          constant_segment_indices->size(),
+          constant_segment->offsets()->size());
+      for (uint32_t segment_index : *constant_segment_indices) {
+        ET_CHECK_OR_RETURN_ERROR(
+            segment_index < segments->size(),
+            InvalidProgram,
+            "Constant segment index %u invalid for program segments range %u",
+            segment_index,
+            segments->size());
+      }
+      return Program(
+          loader,
+          segment_base_offset,
+          std::move(program_data.get()),
+          flatbuffer_program,
+          /*constant_segment_data=*/FreeableBuffer{});
+    }
+
     const executorch_flatbuffer::DataSegment* data_segment =
         segments->Get(constant_segment->segment_index());
+    EXECUTORCH_SCOPE_PROF("Program::load_constant_segment");
+    internal::EventTracerProfileScope constant_segment_scope =
+        internal::EventTracerProfileScope(
+            event_tracer, "Program::load_constant_segment");
     Result<FreeableBuffer> constant_segment_data = loader->Load(
         segment_base_offset + data_segment->offset(), data_segment->size());
     if (!constant_segment_data.ok()) {
       return constant_segment_data.error();
     }
+    if (compression != nullptr) {
+      ET_CHECK_OR_RETURN_ERROR(
+          decompressor != nullptr,
+          NotSupported,
+          "The constant segment is compressed: load the program with "
+          "experimental_load_with_decompressor()");
+      EXECUTORCH_SCOPE_PROF("Program::decompress_constant_segment");
+      internal::EventTracerProfileScope decompress_scope =
+          internal::EventTracerProfileScope(
+              event_tracer, "Program::decompress_constant_segment");
+      Result<FreeableBuffer> decompressed = decompress_segment(
+          std::move(constant_segment_data.get()), compression, *decompressor);
+      if (!decompressed.ok()) {
+        return decompressed.error();
+      }
+      return Program(
+          loader,
+          segment_base_offset,
+          std::move(program_data.get()),
+          flatbuffer_program,
+          std::move(decompressed.get()));
+    }
     // The FreeableBuffer owns the data that flatbuffer_program points into.
     // Also keep a pointer to the loader so it can load more segments when
     // necessary.
@@ -228,8 +550,114 @@ Result<Method> Program::load_method(
     const char* method_name,
     MemoryManager* memory_manager,
     EventTracer* event_tracer) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      /*delegate_init_runner=*/nullptr,
+      /*delegate_init_runner_context=*/nullptr,
+      /*lazy_values=*/false,
+      /*kernel_cache=*/{},
+      /*fold_constants=*/false,
+      /*external_constants=*/nullptr);
+}
+
+Result<Method> Program::experimental_load_method_with_parallel_init(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    EventTracer* event_tracer,
+    Method::InterOpRunner delegate_init_runner,
+    void* delegate_init_runner_context) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      delegate_init_runner,
+      delegate_init_runner_context,
+      /*lazy_values=*/false,
+      /*kernel_cache=*/{},
+      /*fold_constants=*/false,
+      /*external_constants=*/nullptr);
+}
+
+Result<Method> Program::experimental_load_method_with_lazy_values(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    EventTracer* event_tracer) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      /*delegate_init_runner=*/nullptr,
+      /*delegate_init_runner_context=*/nullptr,
+      /*lazy_values=*/true,
+      /*kernel_cache=*/{},
+      /*fold_constants=*/false,
+      /*external_constants=*/nullptr);
+}
+
+Result<Method> Program::experimental_load_method_with_kernel_cache(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    Span<const uint8_t> kernel_cache,
+    EventTracer* event_tracer) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      /*delegate_init_runner=*/nullptr,
+      /*delegate_init_runner_context=*/nullptr,
+      /*lazy_values=*/false,
+      kernel_cache,
+      /*fold_constants=*/false,
+      /*external_constants=*/nullptr);
+}
+
+Result<Method> Program::experimental_load_method_with_constant_folding(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    EventTracer* event_tracer) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      /*delegate_init_runner=*/nullptr,
+      /*delegate_init_runner_context=*/nullptr,
+      /*lazy_values=*/false,
+      /*kernel_cache=*/{},
+      /*fold_constants=*/true,
+      /*external_constants=*/nullptr);
+}
+
+Result<Method> Program::experimental_load_method_with_external_constants(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    const Method::ExternalConstantProvider& provider,
+    EventTracer* event_tracer) const {
+  return load_method_internal(
+      method_name,
+      memory_manager,
+      event_tracer,
+      /*delegate_init_runner=*/nullptr,
+      /*delegate_init_runner_context=*/nullptr,
+      /*lazy_values=*/false,
+      /*kernel_cache=*/{},
+      /*fold_constants=*/false,
+      &provider);
+}
+
+Result<Method> Program::load_method_internal(
+    const char* method_name,
+    MemoryManager* memory_manager,
+    EventTracer* event_tracer,
+    Method::InterOpRunner delegate_init_runner,
+    void* delegate_init_runner_context,
+    bool lazy_values,
+    Span<const uint8_t> kernel_cache,
+    bool fold_constants,
+    const Method::ExternalConstantProvider* external_constants) const {
   EXECUTORCH_SCOPE_PROF("Program::load_method");
-  internal::event_tracer_create_event_block(event_tracer, "Default");
+  internal::event_tracer_create_event_block(event_tracer, "load");
   internal::EventTracerProfileScope event_tracer_scope =
       internal::EventTracerProfileScope(event_tracer, "Program::load_method");
   // If we can't create a MethodMeta for the Method, the Method is corrupt;
@@ -243,7 +671,17 @@ Result<Method> Program::load_method(
   if (!plan.ok()) {
     return plan.error();
   }
-  return Method::load(plan.get(), this, memory_manager, event_tracer);
+  return Method::load(
+      plan.get(),
+      this,
+      memory_manager,
+      event_tracer,
+      delegate_init_runner,
+      delegate_init_runner_context,
+      lazy_values,
+      kernel_cache,
+      fold_constants,
+      external_constants);
 }
 
 Result<MethodMeta> Program::method_meta(const char* method_name) const {
@@ -268,16 +706,156 @@ Result<MethodMeta> Program::method_meta(const char* method_name) const {
   return MethodMeta(plan.get());
 }
 
+Result<size_t> Program::experimental_constant_use_order(
+    const char* method_name,
+    Span<uint32_t> out) const {
+  auto plan = get_execution_plan(internal_program_, method_name);
+  if (!plan.ok()) {
+    return plan.error();
+  }
+  size_t count = 0;
+  const auto* chains = plan.get()->chains();
+  if (chains == nullptr) {
+    return count;
+  }
+  for (const auto* chain : *chains) {
+    const auto* instructions = chain->instructions();
+    if (instructions == nullptr) {
+      continue;
+    }
+    for (const auto* instruction : *instructions) {
+      const flatbuffers::Vector<int32_t>* args = nullptr;
+      switch (instruction->instr_args_type()) {
+        case executorch_flatbuffer::InstructionArguments::KernelCall:
+          args = instruction->instr_args_as_KernelCall()->args();
+          break;
+        case executorch_flatbuffer::InstructionArguments::DelegateCall:
+          args = instruction->instr_args_as_DelegateCall()->args();
+          break;
+        default:
+          break;
+      }
+      if (args == nullptr) {
+        continue;
+      }
+      for (int32_t arg : *args) {
+        record_arg_constant_uses(plan.get(), arg, out, &count);
+      }
+    }
+  }
+  return count;
+}
+
+Error Program::experimental_prefetch_constants(
+    const char* method_name,
+    Span<const uint32_t> use_order) const {
+  EXECUTORCH_SCOPE_PROF("Program::experimental_prefetch_constants");
+  auto plan = get_execution_plan(internal_program_, method_name);
+  if (!plan.ok()) {
+    return plan.error();
+  }
+  // Constants inside the flatbuffer were read along with the program data.
+  if (loader_ == nullptr || constant_segment_data_.data() == nullptr) {
+    return Error::Ok;
+  }
+
+  const auto* values = plan.get()->values();
+  size_t num_constants = use_order.size();
+  if (use_order.empty() && values != nullptr) {
+    num_constants = values->size();
+  }
+  const uint8_t* range_start = nullptr;
+  size_t range_size = 0;
+  for (size_t i = 0; i < num_constants; ++i) {
+    const int64_t value_index = use_order.empty() ? i : use_order[i];
+    const auto* s_tensor = get_constant_tensor(plan.get(), value_index);
+    if (s_tensor == nullptr) {
+      ET_CHECK_OR_RETURN_ERROR(
+          use_order.empty(),
+          InvalidArgument,
+          "Value %" PRId64 " is not a constant tensor",
+          value_index);
+      continue;
+    }
+    const size_t nbytes = get_tensor_nbytes(s_tensor);
+    Result<const void*> data =
+        get_constant_buffer_data(s_tensor->constant_buffer_idx(), nbytes);
+    if (!data.ok()) {
+      return data.error();
+    }
+    const uint8_t* start = static_cast<const uint8_t*>(data.get());
+    // Extend the pending range when this constant follows it closely.
+    if (range_start != nullptr && start >= range_start &&
+        start <= range_start + range_size + kPrefetchCoalesceGapBytes) {
+      range_size = std::max<size_t>(range_size, start + nbytes - range_start);
+      continue;
+    }
+    if (range_size > 0) {
+      loader_->prefetch(range_start, range_size);
+    }
+    range_start = start;
+    range_size = nbytes;
+  }
+  if (range_size > 0) {
+    loader_->prefetch(range_start, range_size);
+  }
+  return Error::Ok;
+}
+
 Result<const void*> Program::get_constant_buffer_data(
     size_t buffer_index,
     size_t nbytes) const {
+  return get_constant_buffer_data(buffer_index, nbytes, {});
+}
+
+bool Program::has_method_constant_segments() const {
+  const auto* constant_segment_indices =
+      internal_program_->constant_segment_indices();
+  return constant_segment_indices != nullptr &&
+      constant_segment_indices->size() > 0;
+}
+
+Result<const void*> Program::get_constant_buffer_data(
+    size_t buffer_index,
+    size_t nbytes,
+    Span<const FreeableBuffer> constant_segments) const {
   auto internal_program =
       static_cast<const executorch_flatbuffer::Program*>(internal_program_);
 
-  // Constant data is either in a separate segment (constant_segment_data) and
-  // loaded during Program::load, or stored inside the flatbuffer data
-  // (constant_buffer).
-  if (constant_segment_data_.data() != nullptr) {
+  // Constant data is either in segments loaded by Method::init, in a separate
+  // segment (constant_segment_data) loaded during Program::load, or stored
+  // inside the flatbuffer data (constant_buffer).
+  if (has_method_constant_segments()) {
+    const auto* offsets = internal_program->constant_segment()->offsets();
+    ET_CHECK_OR_RETURN_ERROR(
+        buffer_index < offsets->size(),
+        InvalidArgument,
+        "Constant segment buffer index %zu invalid for program constant segment range %zu",
+        buffer_index,
+        static_cast<size_t>(offsets->size()));
+    const uint32_t segment_index =
+        internal_program->constant_segment_indices()->Get(buffer_index);
+    ET_CHECK_OR_RETURN_ERROR(
+        segment_index < constant_segments.size() &&
+            constant_segments[segment_index].data() != nullptr,
+        InvalidState,
+        "Constant segment %" PRIu32 " of buffer %zu not loaded",
+        segment_index,
+        buffer_index);
+    const FreeableBuffer& segment = constant_segments[segment_index];
+    uint64_t offset = static_cast<uint64_t>((*offsets)[buffer_index]);
+    ET_CHECK_OR_RETURN_ERROR(
+        offset + nbytes <= segment.size(),
+        InvalidArgument,
+        "Constant segment offset %" PRIu64
+        " + size_bytes %zu invalid for constant segment %" PRIu32 " size %zu",
+        offset,
+        nbytes,
+        segment_index,
+        segment.size());
+    return static_cast<const void*>(
+        static_cast<const unsigned char*>(segment.data()) + offset);
+  } else if (constant_segment_data_.data() != nullptr) {
     size_t num_elems = internal_program->constant_segment()->offsets()->size();
     ET_CHECK_OR_RETURN_ERROR(
         buffer_index < num_elems,
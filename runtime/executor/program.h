@@ -16,6 +16,7 @@
 #include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/freeable_buffer.h>
 #include <executorch/runtime/core/result.h>
+#include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/method_meta.h>
@@ -72,10 +73,73 @@ class Program final {
    *     instance.
    * @param[in] verification The type of verification to do before returning
    *     success.
+   * @param[in] event_tracer If not null, profiles the steps of the load, e.g.
+   *     the verification and the load of the constant segment, in a new event
+   *     block named "load". It is not used after this call.
    */
   __ET_NODISCARD static Result<Program> load(
       DataLoader* loader,
-      Verification verification = Verification::Minimal);
+      Verification verification = Verification::Minimal,
+      EventTracer* event_tracer = nullptr);
+
+  /**
+   * The codecs of compressed constant segments. The values match those of
+   * the program schema.
+   */
+  enum class CompressionCodec : uint8_t {
+    Zstd = 1,
+    Lz4 = 2,
+  };
+
+  /**
+   * Decompresses the constant segment of programs exported with a
+   * constant_segment_codec, see experimental_load_with_decompressor().
+   */
+  struct ConstantDecompressor {
+    /**
+     * Decompresses one independently compressed block: the `src_size` bytes
+     * at `src`, into exactly `dst_size` bytes at `dst`. Called concurrently
+     * for different blocks when `runner` is set.
+     */
+    Error (*decompress_block)(
+        void* context,
+        CompressionCodec codec,
+        const void* src,
+        size_t src_size,
+        void* dst,
+        size_t dst_size);
+    /// Passed to decompress_block.
+    void* context;
+    /// Allocates the decompressed segment, which must outlive the Program.
+    MemoryAllocator* allocator;
+    /// If not null, runs the decompression of the blocks, e.g. across a
+    /// threadpool. Otherwise they are decompressed on the calling thread.
+    Method::InterOpRunner runner;
+    void* runner_context;
+  };
+
+  /**
+   * Loads a Program like load(), decompressing its constant segment if it is
+   * compressed. The compressed data is freed once decompressed, so only the
+   * decompressed segment, allocated from `decompressor.allocator`, stays in
+   * memory. Programs that load() loads are loaded the same way.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] loader The source to load program data from, which must
+   *     outlive the returned Program instance.
+   * @param[in] decompressor How to decompress the constant segment. Only used
+   *     during this call, but its allocator must outlive the Program.
+   * @param[in] verification The type of verification to do before returning
+   *     success.
+   * @param[in] event_tracer If not null, profiles the steps of the load, as
+   *     load() does.
+   */
+  __ET_NODISCARD static Result<Program> experimental_load_with_decompressor(
+      DataLoader* loader,
+      const ConstantDecompressor& decompressor,
+      Verification verification = Verification::Minimal,
+      EventTracer* event_tracer = nullptr);
 
   /// DEPRECATED: Use the lowercase `load()` instead.
   __ET_DEPRECATED __ET_NODISCARD static Result<Program> Load(
@@ -97,6 +161,18 @@ class Program final {
   Result<const void*> get_constant_buffer_data(size_t buffer_idx, size_t nbytes)
       const;
 
+  /**
+   * Like get_constant_buffer_data(buffer_idx, nbytes), but also finds the
+   * constants of programs that split them over segments loaded with the
+   * methods that use them.
+   * @param[in] constant_segments The segments loaded by the method, indexed
+   *     by segment index. Entries for segments it does not use are empty.
+   */
+  Result<const void*> get_constant_buffer_data(
+      size_t buffer_idx,
+      size_t nbytes,
+      Span<const FreeableBuffer> constant_segments) const;
+
   /**
    * Returns the number of methods in the program.
    */
@@ -128,6 +204,138 @@ class Program final {
       MemoryManager* memory_manager,
       EventTracer* event_tracer = nullptr) const;
 
+  /**
+   * Loads the named method like load_method(), but calls the init() of the
+   * delegates of backends that declare a thread-safe init(), see
+   * PyTorchBackendInterface::is_init_thread_safe(), concurrently. Their
+   * allocations from the method allocator are serialized. Delegates of other
+   * backends are initialized one after the other, before them.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] memory_manager The allocators to use during initialization and
+   *     execution of the loaded method.
+   * @param[in] event_tracer The event tracer to use for this method run.
+   * @param[in] delegate_init_runner Runs the delegate init() tasks, possibly
+   *     concurrently. It must not run the tasks on the threads of a pool that
+   *     the backends themselves block on during init().
+   * @param[in] delegate_init_runner_context Passed to every
+   *     `delegate_init_runner` call.
+   *
+   * @returns The loaded method on success, or an error on failure.
+   */
+  Result<Method> experimental_load_method_with_parallel_init(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      EventTracer* event_tracer,
+      Method::InterOpRunner delegate_init_runner,
+      void* delegate_init_runner_context) const;
+
+  /**
+   * Loads the named method like load_method(), but only parses the values the
+   * runtime and the delegates need before execution: the method inputs and
+   * outputs and the arguments of delegate and control flow instructions. Each
+   * kernel call parses its arguments and resolves its operator the first time
+   * it runs, so the first execution is slower and operators missing from the
+   * registry are reported then rather than by this call.
+   *
+   * Speeds up loading methods with many values, e.g. the tensors of large
+   * graphs that are not delegated.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] memory_manager The allocators to use during initialization and
+   *     execution of the loaded method.
+   * @param[in] event_tracer The event tracer to use for this method run.
+   *
+   * @returns The loaded method on success, or an error on failure.
+   */
+  Result<Method> experimental_load_method_with_lazy_values(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      EventTracer* event_tracer = nullptr) const;
+
+  /**
+   * Loads the named method like load_method(), but takes the kernel of each
+   * kernel call from `kernel_cache`, as exported by
+   * `Method::experimental_export_kernel_cache()`, instead of looking it up by
+   * name and tensor dtypes. The cache is ignored, and the kernels looked up
+   * as usual, if the registered kernels differ from those of the process that
+   * exported it or if it was exported for another method.
+   *
+   * The cache is only read during this call. It must be aligned to 4 bytes,
+   * as are mmap()ed files.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] memory_manager The allocators to use during initialization and
+   *     execution of the loaded method.
+   * @param[in] kernel_cache The exported kernel cache of the method.
+   * @param[in] event_tracer The event tracer to use for this method run.
+   *
+   * @returns The loaded method on success, or an error on failure.
+   */
+  Result<Method> experimental_load_method_with_kernel_cache(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      Span<const uint8_t> kernel_cache,
+      EventTracer* event_tracer = nullptr) const;
+
+  /**
+   * Loads the named method like load_method(), but runs the kernel calls
+   * whose arguments are all constant, e.g. the dequantization or permutation
+   * of weights, once while loading. Their outputs are kept in memory from the
+   * method allocator and execution skips them.
+   *
+   * A kernel call is folded if the tensors it reads are constant tensors of
+   * the program, or outputs of folded kernel calls, and the other values it
+   * reads are not assigned by any instruction or caller. Its outputs must be
+   * memory-planned tensors that no other instruction writes and that are not
+   * method inputs or outputs. Folding stops if the method allocator runs
+   * out of memory, and loading fails if a folded kernel call fails.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] memory_manager The allocators to use during initialization and
+   *     execution of the loaded method.
+   * @param[in] event_tracer The event tracer to use for this method run.
+   *
+   * @returns The loaded method on success, or an error on failure.
+   */
+  Result<Method> experimental_load_method_with_constant_folding(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      EventTracer* event_tracer = nullptr) const;
+
+  /**
+   * Loads the named method like load_method(), but takes the data of the
+   * constant tensors that the program names instead of storing, as exported
+   * with ExecutorchBackendConfig.external_constants, from `provider`. This
+   * lets weights stay in a file of another format, e.g. mmap()ed GGUF
+   * tensors, without being copied into the program. Loading fails if a named
+   * constant is missing or has another size.
+   *
+   * NOTE: Prototype API; subject to change.
+   *
+   * @param[in] method_name The name of the method to load.
+   * @param[in] memory_manager The allocators to use during initialization and
+   *     execution of the loaded method.
+   * @param[in] provider Provides the named constants. Copied; its context and
+   *     the data it returns must outlive the Method.
+   * @param[in] event_tracer The event tracer to use for this method run.
+   *
+   * @returns The loaded method on success, or an error on failure.
+   */
+  Result<Method> experimental_load_method_with_external_constants(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      const Method::ExternalConstantProvider& provider,
+      EventTracer* event_tracer = nullptr) const;
+
   /**
    * Gathers metadata for the named method.
    *
@@ -135,6 +343,41 @@ class Program final {
    */
   Result<MethodMeta> method_meta(const char* method_name) const;
 
+  /**
+   * EXPERIMENTAL: Computes the order in which the instructions of the named
+   * method first reference its constant tensors. The result can be saved and
+   * passed to `experimental_prefetch_constants()` on later runs.
+   *
+   * @param[in] method_name The name of the method to inspect.
+   * @param[out] out Receives the indices into the method's values table of
+   *     the constant tensors, in first-use order. Constants beyond
+   *     `out.size()` are dropped.
+   *
+   * @returns The number of entries written to `out`.
+   */
+  Result<size_t> experimental_constant_use_order(
+      const char* method_name,
+      Span<uint32_t> out) const;
+
+  /**
+   * EXPERIMENTAL: Hints the DataLoader to start bringing the constant data of
+   * the named method into memory, so that the first execution does not stall
+   * on page faults. Intended to be called just before `load_method()`.
+   * Adjacent constants are coalesced into a single hint.
+   *
+   * Does nothing if the constants are stored in the program flatbuffer, which
+   * is read in full by `load()`.
+   *
+   * @param[in] method_name The name of the method whose constants to prefetch.
+   * @param[in] use_order Values table indices of the constants to prefetch, in
+   *     the order to prefetch them, as returned by
+   *     `experimental_constant_use_order()`. If empty, all constants of the
+   *     method are prefetched in values table order.
+   */
+  __ET_NODISCARD Error experimental_prefetch_constants(
+      const char* method_name,
+      Span<const uint32_t> use_order = {}) const;
+
   /**
    * DEPRECATED: Use MethodMeta instead.
    *
@@ -230,6 +473,29 @@ class Program final {
     return internal_program_;
   }
 
+  // Implements load() and experimental_load_with_decompressor().
+  __ET_NODISCARD static Result<Program> load_internal(
+      DataLoader* loader,
+      Verification verification,
+      EventTracer* event_tracer,
+      const ConstantDecompressor* decompressor);
+
+  // Implements the load_method() variants.
+  Result<Method> load_method_internal(
+      const char* method_name,
+      MemoryManager* memory_manager,
+      EventTracer* event_tracer,
+      Method::InterOpRunner delegate_init_runner,
+      void* delegate_init_runner_context,
+      bool lazy_values,
+      Span<const uint8_t> kernel_cache,
+      bool fold_constants,
+      const Method::ExternalConstantProvider* external_constants) const;
+
+  // Whether the constants are split over segments that Method loads, rather
+  // than in constant_segment_data_ or the flatbuffer.
+  bool has_method_constant_segments() const;
+
   // Used by Method to look up entries in the delegate data table.
   Error get_backend_delegate_data(
       size_t index,
@@ -284,7 +550,8 @@ class Program final {
   /// be present in internal_program_.
   size_t segment_base_offset_;
 
-  /// Constant segment data.
+  /// Constant segment data. Empty if the constants are in the flatbuffer, or
+  /// split over segments loaded by Method.
   FreeableBuffer constant_segment_data_;
 };
 
@@ -18,10 +18,15 @@ namespace torch {
 namespace executor {
 namespace deserialization {
 
+/**
+ * Parses `s_tensor`. `constant_segments` are the constant segments loaded by
+ * the method, as passed to Program::get_constant_buffer_data().
+ */
 __ET_NODISCARD Result<exec_aten::Tensor> parseTensor(
     const Program* program,
     MemoryManager* memory_manager,
-    const executorch_flatbuffer::Tensor* s_tensor);
+    const executorch_flatbuffer::Tensor* s_tensor,
+    Span<const FreeableBuffer> constant_segments = {});
 
 __ET_NODISCARD Result<BoxedEvalueList<exec_aten::Tensor>> parseTensorList(
     const flatbuffers::Vector<int32_t>* tensor_indices,
@@ -88,6 +93,8 @@ parseListOptionalType(
  * @param[in] program The Program to use for constant buffer data.
  * @param[in] nbytes The amount of memory to get from the allocator.
  * @param[in] allocator The source of memory for non-constant tensors.
+ * @param[in] constant_segments The constant segments loaded by the method, if
+ *     the program splits its constants over segments.
  *
  * @returns On success, the data pointer to use for the tensor. On failure, a
  *     non-Ok Error.
@@ -96,7 +103,8 @@ __ET_NODISCARD Result<void*> getTensorDataPtr(
     const executorch_flatbuffer::Tensor* s_tensor,
     const Program* program,
     size_t nbytes,
-    HierarchicalAllocator* allocator);
+    HierarchicalAllocator* allocator,
+    Span<const FreeableBuffer> constant_segments = {});
 
 } // namespace deserialization
 } // namespace executor
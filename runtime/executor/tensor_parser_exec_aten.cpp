@@ -52,10 +52,11 @@ __ET_NODISCARD Result<void*> getTensorDataPtr(
     const executorch_flatbuffer::Tensor* s_tensor,
     const Program* program,
     size_t nbytes,
-    HierarchicalAllocator* allocator) {
+    HierarchicalAllocator* allocator,
+    Span<const FreeableBuffer> constant_segments) {
   if (s_tensor->constant_buffer_idx() > 0) {
     auto data = program->get_constant_buffer_data(
-        s_tensor->constant_buffer_idx(), nbytes);
+        s_tensor->constant_buffer_idx(), nbytes, constant_segments);
     if (!data.ok()) {
       return data.error();
     }
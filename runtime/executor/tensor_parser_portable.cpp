@@ -23,7 +23,8 @@ namespace deserialization {
 Result<torch::executor::Tensor> parseTensor(
     const Program* program,
     MemoryManager* memory_manager,
-    const executorch_flatbuffer::Tensor* s_tensor) {
+    const executorch_flatbuffer::Tensor* s_tensor,
+    Span<const FreeableBuffer> constant_segments) {
   EXECUTORCH_SCOPE_PROF("TensorParser::parseTensor");
   auto method_allocator = memory_manager->method_allocator();
 
@@ -46,12 +47,12 @@ Result<torch::executor::Tensor> parseTensor(
 
   TensorShapeDynamism dynamism =
       static_cast<TensorShapeDynamism>(s_tensor->shape_dynamism());
-  // TODO(T175194371): Remove this check once fully dynamic shapes are
-  // supported.
   ET_CHECK_OR_RETURN_ERROR(
-      dynamism != TensorShapeDynamism::DYNAMIC_UNBOUND,
+      dynamism != TensorShapeDynamism::DYNAMIC_UNBOUND ||
+          memory_manager->dynamic_allocator() != nullptr,
       NotSupported,
-      "Fully dynamic tensor shapes not yet supported: T175194371");
+      "Fully dynamic tensor shapes require a MemoryManager with a "
+      "dynamic_allocator");
 
   ET_CHECK_OR_RETURN_ERROR(
       s_tensor->sizes() != nullptr, InvalidProgram, "Missing sizes field");
@@ -97,18 +98,25 @@ Result<torch::executor::Tensor> parseTensor(
     sizes = const_cast<exec_aten::SizesType*>(serialized_sizes);
     dim_order = const_cast<exec_aten::DimOrderType*>(serialized_dim_order);
   }
-  // We will remove strides from schema.
-  // Allocating strides buffer here and populating it.
-  // In subsequent diffs we can remove strides accessor, however this
-  // will introduce incompatible APIs between ATen Tensor and ETensor.
-  exec_aten::StridesType* strides = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
-      method_allocator, exec_aten::StridesType, dim);
-  auto status =
-      torch::executor::dim_order_to_stride(sizes, dim_order, dim, strides);
-  ET_CHECK_OR_RETURN_ERROR(
-      status == Error::Ok,
-      Internal,
-      "dim_order_to_stride returned invalid status");
+  exec_aten::StridesType* strides = nullptr;
+  const auto serialized_strides = s_tensor->strides();
+  if (dynamism == TensorShapeDynamism::STATIC &&
+      serialized_strides != nullptr && serialized_strides->size() == dim) {
+    // Precomputed by the serializer. Const cast safe for the same reason as
+    // sizes above.
+    strides = const_cast<exec_aten::StridesType*>(serialized_strides->data());
+  } else {
+    // Allocating strides buffer here and populating it, as dynamic shape
+    // tensors need mutable strides and older programs don't serialize them.
+    strides = ET_ALLOCATE_LIST_OR_RETURN_ERROR(
+        method_allocator, exec_aten::StridesType, dim);
+    auto status =
+        torch::executor::dim_order_to_stride(sizes, dim_order, dim, strides);
+    ET_CHECK_OR_RETURN_ERROR(
+        status == Error::Ok,
+        Internal,
+        "dim_order_to_stride returned invalid status");
+  }
 
   auto* tensor_impl = ET_ALLOCATE_INSTANCE_OR_RETURN_ERROR(
       method_allocator, torch::executor::TensorImpl);
@@ -128,7 +136,8 @@ Result<torch::executor::Tensor> parseTensor(
       s_tensor,
       program,
       tensor_impl->nbytes(),
-      memory_manager->planned_memory());
+      memory_manager->planned_memory(),
+      constant_segments);
   if (!data_ptr.ok()) {
     ET_LOG(
         Error,
@@ -137,6 +146,9 @@ Result<torch::executor::Tensor> parseTensor(
     return data_ptr.error();
   }
   tensor_impl->set_data(data_ptr.get());
+  if (dynamism == TensorShapeDynamism::DYNAMIC_UNBOUND) {
+    tensor_impl->set_dynamic_allocator(memory_manager->dynamic_allocator());
+  }
 
   return torch::executor::Tensor(tensor_impl);
 }
@@ -34,6 +34,7 @@ using torch::executor::BackendInitContext;
 using torch::executor::CompileSpec;
 using torch::executor::DataLoader;
 using torch::executor::DelegateHandle;
+using torch::executor::DeviceBuffer;
 using torch::executor::Error;
 using torch::executor::EValue;
 using torch::executor::FreeableBuffer;
@@ -57,6 +58,7 @@ class StubBackend final : public PyTorchBackendInterface {
       ArrayRef<CompileSpec>,
       MemoryAllocator*)>;
   using ExecuteFn = std::function<Error(DelegateHandle*, EValue**)>;
+  using InspectContextFn = std::function<void(BackendExecutionContext&)>;
   using DestroyFn = std::function<void(DelegateHandle*)>;
 
   // Default name that this backend is registered as.
@@ -74,6 +76,14 @@ class StubBackend final : public PyTorchBackendInterface {
     return true;
   }
 
+  void set_init_thread_safe(bool init_thread_safe) {
+    init_thread_safe_ = init_thread_safe;
+  }
+
+  bool is_init_thread_safe() const override {
+    return init_thread_safe_;
+  }
+
   void install_init(InitFn fn) {
     init_fn_ = fn;
   }
@@ -94,10 +104,18 @@ class StubBackend final : public PyTorchBackendInterface {
     execute_fn_ = fn;
   }
 
+  /// Installs a function that execute() passes its context to first.
+  void install_inspect_context(InspectContextFn fn) {
+    inspect_context_fn_ = fn;
+  }
+
   Error execute(
-      __ET_UNUSED BackendExecutionContext& context,
+      BackendExecutionContext& context,
       DelegateHandle* handle,
       EValue** args) const override {
+    if (inspect_context_fn_) {
+      inspect_context_fn_.value()(context);
+    }
     if (execute_fn_) {
       return execute_fn_.value()(handle, args);
     }
@@ -105,6 +123,26 @@ class StubBackend final : public PyTorchBackendInterface {
     return Error::Ok;
   }
 
+  void set_supports_device_buffers(bool supports_device_buffers) {
+    supports_device_buffers_ = supports_device_buffers;
+  }
+
+  bool supports_device_buffers() const override {
+    return supports_device_buffers_;
+  }
+
+  Error copy_to_host(
+      __ET_UNUSED const DeviceBuffer& buffer,
+      __ET_UNUSED exec_aten::Tensor& tensor) const override {
+    ++copy_to_host_calls_;
+    return Error::Ok;
+  }
+
+  /// Returns the number of copy_to_host() calls since the last reset().
+  size_t copy_to_host_calls() const {
+    return copy_to_host_calls_;
+  }
+
   void install_destroy(DestroyFn fn) {
     destroy_fn_ = fn;
   }
@@ -120,8 +158,12 @@ class StubBackend final : public PyTorchBackendInterface {
    */
   void reset() {
     is_available_fn_.reset();
+    init_thread_safe_ = false;
     init_fn_.reset();
     execute_fn_.reset();
+    inspect_context_fn_.reset();
+    supports_device_buffers_ = false;
+    copy_to_host_calls_ = 0;
     destroy_fn_.reset();
   }
 
@@ -152,8 +194,12 @@ class StubBackend final : public PyTorchBackendInterface {
   static StubBackend singleton_;
 
   std::optional<IsAvailableFn> is_available_fn_;
+  bool init_thread_safe_ = false;
   std::optional<InitFn> init_fn_;
   std::optional<ExecuteFn> execute_fn_;
+  std::optional<InspectContextFn> inspect_context_fn_;
+  bool supports_device_buffers_ = false;
+  mutable size_t copy_to_host_calls_ = 0;
   std::optional<DestroyFn> destroy_fn_;
 };
 
@@ -444,6 +490,134 @@ TEST_P(BackendIntegrationTest, EndToEndTestWithProcessedAsHandle) {
   EXPECT_EQ(execute_handle, destroy_handle);
 }
 
+namespace {
+
+// Runs the tasks sequentially, like a threadpool with a single thread would.
+void run_tasks_inline(
+    void* runner_context,
+    size_t num_tasks,
+    void (*task)(void* task_context, size_t task_index),
+    void* task_context) {
+  *static_cast<size_t*>(runner_context) += num_tasks;
+  for (size_t i = 0; i < num_tasks; ++i) {
+    task(task_context, i);
+  }
+}
+
+} // namespace
+
+TEST_P(BackendIntegrationTest, DeviceBuffersDoNotHoldMethodOutputs) {
+  StubBackend::singleton().set_supports_device_buffers(true);
+  // The whole model is delegated, so every argument of the delegate call is
+  // an input or output of the method and must be in host memory.
+  size_t execute_calls = 0;
+  DeviceBuffer device_buffer;
+  device_buffer.handle = &execute_calls;
+  StubBackend::singleton().install_inspect_context(
+      [&](BackendExecutionContext& context) {
+        ++execute_calls;
+        for (size_t i = 0; i < 8; ++i) {
+          EXPECT_EQ(context.get_device_buffer(i), nullptr);
+          EXPECT_FALSE(context.set_device_buffer(i, device_buffer));
+          // Reporting host memory is always fine.
+          EXPECT_TRUE(context.set_device_buffer(i, DeviceBuffer()));
+        }
+      });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = program->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+  EXPECT_EQ(method->execute(), Error::Ok);
+  // Stepping goes through the same placement tracking.
+  Error err = Error::Ok;
+  while ((err = method->experimental_step()) == Error::Ok) {
+  }
+  EXPECT_EQ(err, Error::EndOfMethod);
+  torch::executor::util::FreeInputs(inputs);
+
+  EXPECT_EQ(execute_calls, 2);
+  EXPECT_EQ(StubBackend::singleton().copy_to_host_calls(), 0);
+
+  // The runtime tracks placements per value, which parallel waves do not.
+  size_t runner_tasks = 0;
+  ASSERT_EQ(method->experimental_reset_execution(), Error::Ok);
+  EXPECT_EQ(
+      method->experimental_enable_inter_op_parallelism(
+          run_tasks_inline, &runner_tasks),
+      Error::NotSupported);
+}
+
+TEST_P(BackendIntegrationTest, ParallelInitSucceeds) {
+  for (bool init_thread_safe : {false, true}) {
+    StubBackend::singleton().set_init_thread_safe(init_thread_safe);
+    size_t init_calls = 0;
+    StubBackend::singleton().install_init(
+        [&](FreeableBuffer* processed,
+            __ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+            MemoryAllocator* runtime_allocator) -> Result<DelegateHandle*> {
+          ++init_calls;
+          // Allocations go through to the method allocator.
+          EXPECT_NE(runtime_allocator->allocate(16), nullptr);
+          return processed;
+        });
+    DelegateHandle* destroy_handle = nullptr;
+    StubBackend::singleton().install_destroy(
+        [&](DelegateHandle* handle) { destroy_handle = handle; });
+
+    Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+    ASSERT_EQ(loader.error(), Error::Ok);
+    Result<Program> program = Program::load(&loader.get());
+    ASSERT_EQ(program.error(), Error::Ok);
+
+    size_t runner_tasks = 0;
+    {
+      ManagedMemoryManager mmm(
+          kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+      Result<Method> method_res =
+          program->experimental_load_method_with_parallel_init(
+              "forward", &mmm.get(), nullptr, run_tasks_inline, &runner_tasks);
+      ASSERT_EQ(method_res.error(), Error::Ok);
+      EXPECT_EQ(init_calls, 1);
+    }
+    // The runner is only used for more than one thread-safe delegate.
+    EXPECT_EQ(runner_tasks, 0);
+    EXPECT_NE(destroy_handle, nullptr);
+  }
+}
+
+TEST_P(BackendIntegrationTest, ParallelInitFailureIsReported) {
+  StubBackend::singleton().set_init_thread_safe(true);
+  StubBackend::singleton().install_init(
+      [&](__ET_UNUSED FreeableBuffer* processed,
+          __ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          __ET_UNUSED MemoryAllocator* runtime_allocator)
+          -> Result<DelegateHandle*> { return Error::DelegateInvalidHandle; });
+  bool destroy_called = false;
+  StubBackend::singleton().install_destroy(
+      [&](__ET_UNUSED DelegateHandle* handle) { destroy_called = true; });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  size_t runner_tasks = 0;
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method_res =
+      program->experimental_load_method_with_parallel_init(
+          "forward", &mmm.get(), nullptr, run_tasks_inline, &runner_tasks);
+  EXPECT_EQ(method_res.error(), Error::DelegateInvalidHandle);
+  // A delegate that failed to initialize is not destroyed.
+  EXPECT_FALSE(destroy_called);
+}
+
 // TODO: Add more tests for the runtime-to-backend interface. E.g.:
 // - Errors during init() or execute() result in runtime init/execution failures
 // - Correct values are passed to init()/execute()
@@ -90,6 +90,12 @@ TEST_F(MethodMetaTest, MethodMetaApi) {
       method_meta->non_const_buffer_size(1).error(),
       Error::InvalidArgument); // Deprecated API
 
+  // The program was planned without memory tiers
+  EXPECT_EQ(method_meta->memory_planned_buffer_tier(0).get(), nullptr);
+  EXPECT_EQ(
+      method_meta->memory_planned_buffer_tier(1).error(),
+      Error::InvalidArgument);
+
   // Missing method fails
   EXPECT_EQ(
       program_->method_meta("not_a_method").error(), Error::InvalidArgument);
@@ -6,14 +6,19 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <vector>
 
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/executor/method.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/executor/test/managed_memory_manager.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/kernel/operator_registry.h>
 #include <executorch/runtime/platform/runtime.h>
 #include <executorch/test/utils/DeathTest.h>
 #include <executorch/util/util.h>
@@ -21,11 +26,19 @@
 
 using namespace ::testing;
 using exec_aten::ArrayRef;
+using torch::executor::AllocatorID;
+using torch::executor::ChainID;
+using torch::executor::DebugHandle;
 using torch::executor::Error;
 using torch::executor::EValue;
+using torch::executor::EventTracer;
+using torch::executor::EventTracerEntry;
+using torch::executor::EventTracerMemoryTraffic;
+using torch::executor::LoggedEValueType;
 using torch::executor::Method;
 using torch::executor::Program;
 using torch::executor::Result;
+using torch::executor::Span;
 using torch::executor::testing::ManagedMemoryManager;
 using torch::executor::util::FileDataLoader;
 
@@ -64,6 +77,8 @@ class MethodTest : public ::testing::Test {
     load_program(
         std::getenv("ET_MODULE_LINEAR_CONSTANT_BUFFER_PATH"),
         "linear_constant_buffer");
+    load_program(
+        std::getenv("ET_MODULE_TRANSPOSED_WEIGHT_PATH"), "transposed_weight");
   }
 
  private:
@@ -99,6 +114,253 @@ TEST_F(MethodTest, MoveTest) {
   torch::executor::util::FreeInputs(inputs);
 }
 
+TEST_F(MethodTest, ExecuteMatchesStepping) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+
+  // Without an event tracer, execute() runs the pre-decoded instructions.
+  Error err = method->execute();
+  ASSERT_EQ(err, Error::Ok);
+  const auto& executed = method->get_output(0).toTensor();
+  const auto* executed_data =
+      static_cast<const uint8_t*>(executed.const_data_ptr());
+  std::vector<uint8_t> expected(
+      executed_data, executed_data + executed.nbytes());
+
+  // Stepping goes through the regular instruction path.
+  std::fill(
+      static_cast<uint8_t*>(executed.mutable_data_ptr()),
+      static_cast<uint8_t*>(executed.mutable_data_ptr()) + executed.nbytes(),
+      0);
+  while ((err = method->experimental_step()) == Error::Ok) {
+  }
+  ASSERT_EQ(err, Error::EndOfMethod);
+  ASSERT_EQ(method->experimental_reset_execution(), Error::Ok);
+
+  const auto& stepped = method->get_output(0).toTensor();
+  ASSERT_EQ(stepped.nbytes(), expected.size());
+  EXPECT_EQ(
+      std::memcmp(stepped.const_data_ptr(), expected.data(), expected.size()),
+      0);
+
+  torch::executor::util::FreeInputs(inputs);
+}
+
+TEST_F(MethodTest, IOBufferSetsAlternate) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  ASSERT_EQ(
+      method->experimental_select_io_buffer_set(0), Error::InvalidState);
+  ASSERT_EQ(method->experimental_allocate_io_buffer_sets(2), Error::Ok);
+  EXPECT_EQ(
+      method->experimental_allocate_io_buffer_sets(2), Error::InvalidState);
+  EXPECT_EQ(
+      method->experimental_select_io_buffer_set(2), Error::InvalidArgument);
+  EXPECT_EQ(
+      method->experimental_input_buffer(0, method->inputs_size()).error(),
+      Error::InvalidArgument);
+
+  // The tensor inputs of ModuleAdd are float tensors. Fill each set with its
+  // own value before running any of them.
+  const float fill[2] = {1.0f, 2.0f};
+  for (size_t set = 0; set < 2; ++set) {
+    for (size_t i = 0; i < method->inputs_size(); ++i) {
+      Result<Span<uint8_t>> buffer =
+          method->experimental_input_buffer(set, i);
+      ASSERT_EQ(buffer.error(), Error::Ok);
+      auto* data = reinterpret_cast<float*>(buffer->data());
+      std::fill(data, data + buffer->size() / sizeof(float), fill[set]);
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> outputs;
+  for (size_t set = 0; set < 2; ++set) {
+    ASSERT_EQ(method->experimental_select_io_buffer_set(set), Error::Ok);
+    ASSERT_EQ(method->execute(), Error::Ok);
+    Result<Span<uint8_t>> out =
+        method->experimental_output_buffer(set, 0);
+    ASSERT_EQ(out.error(), Error::Ok);
+    EXPECT_EQ(method->get_output(0).toTensor().const_data_ptr(), out->data());
+    outputs.emplace_back(out->data(), out->data() + out->size());
+  }
+
+  // The output of set 0 survives the execution of set 1.
+  Result<Span<uint8_t>> out0 =
+      method->experimental_output_buffer(0, 0);
+  ASSERT_EQ(out0.error(), Error::Ok);
+  EXPECT_EQ(std::memcmp(out0->data(), outputs[0].data(), out0->size()), 0);
+  EXPECT_NE(outputs[0], outputs[1]);
+}
+
+TEST_F(MethodTest, ExecuteBatchRejectsRepeatedSets) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  ASSERT_EQ(method->experimental_allocate_io_buffer_sets(3), Error::Ok);
+
+  // A repeated set would run twice on the same buffers.
+  const size_t repeated[] = {0, 1, 0};
+  EXPECT_EQ(
+      method->experimental_execute_batch(Span<const size_t>(repeated)),
+      Error::InvalidArgument);
+  const size_t out_of_range[] = {3};
+  EXPECT_EQ(
+      method->experimental_execute_batch(Span<const size_t>(out_of_range)),
+      Error::InvalidArgument);
+
+  const size_t distinct[] = {2, 0};
+  EXPECT_EQ(
+      method->experimental_execute_batch(Span<const size_t>(distinct)),
+      Error::Ok);
+}
+
+TEST_F(MethodTest, LazyValuesMatchEager) {
+  ManagedMemoryManager eager_mmm(
+      kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> eager = programs_["linear_constant_buffer"]->load_method(
+      "forward", &eager_mmm.get());
+  ASSERT_EQ(eager.error(), Error::Ok);
+  exec_aten::ArrayRef<void*> eager_inputs =
+      torch::executor::util::PrepareInputTensors(*eager);
+  ASSERT_EQ(eager->execute(), Error::Ok);
+  const auto& expected = eager->get_output(0).toTensor();
+
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method =
+      programs_["linear_constant_buffer"]
+          ->experimental_load_method_with_lazy_values("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+
+  // The first execution resolves the kernel calls, the second reuses them.
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_EQ(method->execute(), Error::Ok);
+    const auto& output = method->get_output(0).toTensor();
+    ASSERT_EQ(output.nbytes(), expected.nbytes());
+    EXPECT_EQ(
+        std::memcmp(
+            output.const_data_ptr(),
+            expected.const_data_ptr(),
+            output.nbytes()),
+        0);
+  }
+
+  torch::executor::util::FreeInputs(inputs);
+  torch::executor::util::FreeInputs(eager_inputs);
+}
+
+TEST_F(MethodTest, KernelCacheResolvesKernels) {
+  ManagedMemoryManager eager_mmm(
+      kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> eager =
+      programs_["add"]->load_method("forward", &eager_mmm.get());
+  ASSERT_EQ(eager.error(), Error::Ok);
+
+  Result<size_t> size = eager->experimental_export_kernel_cache({});
+  ASSERT_EQ(size.error(), Error::Ok);
+  ASSERT_GT(*size, 0);
+  // Back the cache with 8-byte words to keep it aligned.
+  std::vector<uint64_t> storage((*size + 7) / 8);
+  Span<uint8_t> cache(reinterpret_cast<uint8_t*>(storage.data()), *size);
+  EXPECT_EQ(
+      eager->experimental_export_kernel_cache({cache.data(), 1}).error(),
+      Error::InvalidArgument);
+  Result<size_t> written = eager->experimental_export_kernel_cache(cache);
+  ASSERT_EQ(written.error(), Error::Ok);
+  EXPECT_EQ(*written, *size);
+
+  exec_aten::ArrayRef<void*> eager_inputs =
+      torch::executor::util::PrepareInputTensors(*eager);
+  ASSERT_EQ(eager->execute(), Error::Ok);
+  const auto& expected = eager->get_output(0).toTensor();
+
+  // Load with the cache, then with a cache whose registry fingerprint no
+  // longer matches, which falls back to resolving the kernels by name.
+  for (int stale = 0; stale < 2; ++stale) {
+    if (stale) {
+      // The fingerprint follows the 4-byte magic and version.
+      cache[8] ^= 0xff;
+    }
+    ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method =
+        programs_["add"]->experimental_load_method_with_kernel_cache(
+            "forward", &mmm.get(), {cache.data(), cache.size()});
+    ASSERT_EQ(method.error(), Error::Ok);
+    exec_aten::ArrayRef<void*> inputs =
+        torch::executor::util::PrepareInputTensors(*method);
+    ASSERT_EQ(method->execute(), Error::Ok);
+    const auto& output = method->get_output(0).toTensor();
+    ASSERT_EQ(output.nbytes(), expected.nbytes());
+    EXPECT_EQ(
+        std::memcmp(
+            output.const_data_ptr(),
+            expected.const_data_ptr(),
+            output.nbytes()),
+        0);
+    torch::executor::util::FreeInputs(inputs);
+  }
+
+  torch::executor::util::FreeInputs(eager_inputs);
+}
+
+namespace {
+// Inter-op runner that runs the tasks of a wave in reverse order on the
+// calling thread, so that results depending on the order within a wave show.
+void run_tasks_in_reverse(
+    void* runner_context,
+    size_t num_tasks,
+    void (*task)(void* task_context, size_t task_index),
+    void* task_context) {
+  (void)runner_context;
+  for (size_t i = num_tasks; i > 0; i--) {
+    task(task_context, i - 1);
+  }
+}
+} // namespace
+
+TEST_F(MethodTest, InterOpParallelismMatchesSequential) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+
+  Error err = method->execute();
+  ASSERT_EQ(err, Error::Ok);
+  const auto& output = method->get_output(0).toTensor();
+  const auto* output_data =
+      static_cast<const uint8_t*>(output.const_data_ptr());
+  std::vector<uint8_t> expected(output_data, output_data + output.nbytes());
+
+  err = method->experimental_enable_inter_op_parallelism(
+      run_tasks_in_reverse, nullptr);
+  ASSERT_EQ(err, Error::Ok);
+  // Enabling again only replaces the runner.
+  err = method->experimental_enable_inter_op_parallelism(
+      run_tasks_in_reverse, nullptr);
+  ASSERT_EQ(err, Error::Ok);
+
+  err = method->execute();
+  ASSERT_EQ(err, Error::Ok);
+  ASSERT_EQ(output.nbytes(), expected.size());
+  EXPECT_EQ(
+      std::memcmp(output.const_data_ptr(), expected.data(), expected.size()),
+      0);
+
+  // A null runner is rejected.
+  err = method->experimental_enable_inter_op_parallelism(nullptr, nullptr);
+  EXPECT_EQ(err, Error::InvalidArgument);
+
+  torch::executor::util::FreeInputs(inputs);
+}
+
 TEST_F(MethodTest, GetInputTests) {
   ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
   Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
@@ -204,6 +466,182 @@ TEST_F(MethodTest, MethodMetaTest) {
   EXPECT_EQ(method_meta.num_outputs(), method->outputs_size());
 }
 
+TEST_F(MethodTest, RecordPlannedMemoryUsageTest) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = programs_["add"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+  ASSERT_EQ(method->execute(), Error::Ok);
+
+  auto method_meta = method->method_meta();
+  const size_t num_buffers = method_meta.num_memory_planned_buffers();
+  std::vector<size_t> peak_bytes(num_buffers, 0);
+  Error err = method->experimental_record_planned_memory_usage(
+      {peak_bytes.data(), peak_bytes.size()});
+  ASSERT_EQ(err, Error::Ok);
+
+  // The recorded usage never exceeds the planned size of a buffer.
+  for (size_t i = 0; i < num_buffers; ++i) {
+    Result<int64_t> planned_size = method_meta.memory_planned_buffer_size(i);
+    ASSERT_EQ(planned_size.error(), Error::Ok);
+    EXPECT_LE(peak_bytes[i], static_cast<size_t>(planned_size.get()));
+  }
+
+  // Too few entries is an error.
+  if (num_buffers > 0) {
+    err = method->experimental_record_planned_memory_usage(
+        {peak_bytes.data(), num_buffers - 1});
+    EXPECT_EQ(err, Error::InvalidArgument);
+  }
+
+  torch::executor::util::FreeInputs(inputs);
+}
+
+namespace {
+
+// Records the memory traffic of each instruction.
+class MemoryTrafficTracer : public EventTracer {
+ public:
+  struct Record {
+    ChainID chain_id;
+    DebugHandle debug_handle;
+    std::vector<EventTracerMemoryTraffic> traffic;
+  };
+
+  void create_event_block(const char*) override {}
+  EventTracerEntry start_profiling(const char*, ChainID, DebugHandle)
+      override {
+    return EventTracerEntry();
+  }
+  void end_profiling(EventTracerEntry) override {}
+  EventTracerEntry start_profiling_delegate(const char*, DebugHandle)
+      override {
+    return EventTracerEntry();
+  }
+  void end_profiling_delegate(EventTracerEntry, const void*, size_t)
+      override {}
+  void log_profiling_delegate(
+      const char*,
+      DebugHandle,
+      et_timestamp_t,
+      et_timestamp_t,
+      const void*,
+      size_t) override {}
+  void track_allocation(AllocatorID, size_t) override {}
+  AllocatorID track_allocator(const char*) override {
+    return 0;
+  }
+  void log_evalue(const EValue&, LoggedEValueType) override {}
+
+  void log_memory_traffic(
+      const EventTracerMemoryTraffic* traffic,
+      size_t num_buffers) override {
+    records.push_back(
+        {current_chain_id(),
+         current_debug_handle(),
+         std::vector<EventTracerMemoryTraffic>(
+             traffic, traffic + num_buffers)});
+  }
+
+  std::vector<Record> records;
+};
+
+} // namespace
+
+TEST_F(MethodTest, MemoryTrafficTracingTest) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  MemoryTrafficTracer tracer;
+  tracer.set_memory_traffic_tracing(true);
+  Result<Method> method =
+      programs_["add"]->load_method("forward", &mmm.get(), &tracer);
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  exec_aten::ArrayRef<void*> inputs =
+      torch::executor::util::PrepareInputTensors(*method);
+  ASSERT_EQ(method->execute(), Error::Ok);
+
+#ifdef ET_EVENT_TRACER_ENABLED
+  // The add of two 2x2 float tensors reads them and writes the sum.
+  ASSERT_EQ(tracer.records.size(), 1);
+  EXPECT_EQ(tracer.records[0].chain_id, 0);
+  uint64_t bytes_read = 0;
+  uint64_t bytes_written = 0;
+  for (const EventTracerMemoryTraffic& traffic : tracer.records[0].traffic) {
+    bytes_read += traffic.bytes_read;
+    bytes_written += traffic.bytes_written;
+  }
+  EXPECT_EQ(bytes_read, 2 * 4 * sizeof(float));
+  EXPECT_EQ(bytes_written, 4 * sizeof(float));
+
+  // Turning it off after loading stops the tracing.
+  tracer.set_memory_traffic_tracing(false);
+  ASSERT_EQ(method->execute(), Error::Ok);
+  EXPECT_EQ(tracer.records.size(), 1);
+#else
+  EXPECT_TRUE(tracer.records.empty());
+#endif
+
+  torch::executor::util::FreeInputs(inputs);
+}
+
+TEST_F(MethodTest, ConstantFoldingMatchesRegularLoad) {
+  ManagedMemoryManager regular_mmm(
+      kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  MemoryTrafficTracer regular_tracer;
+  regular_tracer.set_memory_traffic_tracing(true);
+  Result<Method> regular = programs_["transposed_weight"]->load_method(
+      "forward", &regular_mmm.get(), &regular_tracer);
+  ASSERT_EQ(regular.error(), Error::Ok);
+  exec_aten::ArrayRef<void*> regular_inputs =
+      torch::executor::util::PrepareInputTensors(*regular);
+  ASSERT_EQ(regular->execute(), Error::Ok);
+  const auto& expected = regular->get_output(0).toTensor();
+#ifdef ET_EVENT_TRACER_ENABLED
+  // The transpose and the mm.
+  EXPECT_EQ(regular_tracer.records.size(), 2);
+#endif
+
+  // ModuleTransposedWeight computes mm(x, w.t()), the transpose of the
+  // constant w is folded away.
+  for (bool traced : {false, true}) {
+    ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    MemoryTrafficTracer tracer;
+    tracer.set_memory_traffic_tracing(true);
+    Result<Method> method =
+        programs_["transposed_weight"]
+            ->experimental_load_method_with_constant_folding(
+                "forward", &mmm.get(), traced ? &tracer : nullptr);
+    ASSERT_EQ(method.error(), Error::Ok);
+    exec_aten::ArrayRef<void*> inputs =
+        torch::executor::util::PrepareInputTensors(*method);
+
+    // Executions after the first still read the folded weight.
+    for (int run = 0; run < 2; ++run) {
+      ASSERT_EQ(method->execute(), Error::Ok);
+      const auto& output = method->get_output(0).toTensor();
+      ASSERT_EQ(output.nbytes(), expected.nbytes());
+      EXPECT_EQ(
+          std::memcmp(
+              output.const_data_ptr(),
+              expected.const_data_ptr(),
+              output.nbytes()),
+          0);
+#ifdef ET_EVENT_TRACER_ENABLED
+      if (traced) {
+        // Only the mm runs.
+        EXPECT_EQ(tracer.records.size(), run + 1);
+      }
+#endif
+    }
+
+    torch::executor::util::FreeInputs(inputs);
+  }
+
+  torch::executor::util::FreeInputs(regular_inputs);
+}
+
 TEST_F(MethodTest, AliasedIOTest) {
   // TODO(T163238401)
   ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
@@ -297,6 +735,43 @@ TEST_F(MethodTest, ConstantBufferTest) {
   ASSERT_EQ(err, Error::Ok);
 }
 
+namespace {
+int mul_prepack_calls = 0;
+bool mul_prepack_saw_constant_self = false;
+bool mul_prepack_saw_constant_other = false;
+} // namespace
+
+TEST_F(MethodTest, PrepackRunsAtLoadTest) {
+  // ModuleLinear computes mul(self.a, x) + self.b, so the first argument of
+  // its mul is a constant and the second is the method input.
+  static auto registered = torch::executor::register_prepack_functions(
+      {torch::executor::KernelPrepack(
+          "aten::mul.out",
+          [](torch::executor::KernelPrepackContext& context,
+             EValue** stack) -> const void* {
+            (void)stack;
+            mul_prepack_calls++;
+            mul_prepack_saw_constant_self = context.is_constant(0);
+            mul_prepack_saw_constant_other = context.is_constant(1);
+            return nullptr;
+          })});
+  ASSERT_EQ(registered, Error::Ok);
+
+  mul_prepack_calls = 0;
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method =
+      programs_["linear_constant_buffer"]->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+  EXPECT_EQ(mul_prepack_calls, 1);
+  EXPECT_TRUE(mul_prepack_saw_constant_self);
+  EXPECT_FALSE(mul_prepack_saw_constant_other);
+
+  // Executing does not prepack again.
+  Error err = method->execute();
+  ASSERT_EQ(err, Error::Ok);
+  EXPECT_EQ(mul_prepack_calls, 1);
+}
+
 // TODO(T161163608): Test is disabled due to a resize bug in tensor_index_out of
 // the portable op lib
 
@@ -11,10 +11,13 @@
 
 #include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <executorch/extension/data_loader/buffer_data_loader.h>
 #include <executorch/extension/data_loader/file_data_loader.h>
 #include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/result.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/platform/runtime.h>
@@ -24,8 +27,15 @@
 #include <gtest/gtest.h>
 
 using namespace ::testing;
+using torch::executor::AllocatorID;
+using torch::executor::ChainID;
+using torch::executor::DebugHandle;
 using torch::executor::Error;
+using torch::executor::EValue;
+using torch::executor::EventTracer;
+using torch::executor::EventTracerEntry;
 using torch::executor::FreeableBuffer;
+using torch::executor::LoggedEValueType;
 using torch::executor::Program;
 using torch::executor::Result;
 using torch::executor::util::BufferDataLoader;
@@ -369,6 +379,48 @@ TEST_F(ProgramTest, LoadConstantSegment) {
   EXPECT_GE(flatbuffer_program->constant_segment()->offsets()->size(), 1);
 }
 
+TEST_F(ProgramTest, PrefetchConstantsInUseOrder) {
+  const char* linear_path =
+      std::getenv("ET_MODULE_LINEAR_CONSTANT_SEGMENT_PATH");
+  Result<FileDataLoader> linear_loader = FileDataLoader::from(linear_path);
+  ASSERT_EQ(linear_loader.error(), Error::Ok);
+
+  Result<Program> program = Program::load(&linear_loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  // The linear layer uses its weight and bias constants.
+  uint32_t order[16];
+  Result<size_t> num_constants =
+      program->experimental_constant_use_order("forward", order);
+  ASSERT_EQ(num_constants.error(), Error::Ok);
+  EXPECT_GE(num_constants.get(), 1);
+
+  // A truncated order keeps its prefix.
+  uint32_t first[1];
+  Result<size_t> num_first =
+      program->experimental_constant_use_order("forward", first);
+  ASSERT_EQ(num_first.error(), Error::Ok);
+  EXPECT_EQ(num_first.get(), 1);
+  EXPECT_EQ(first[0], order[0]);
+
+  // Prefetching in either the recorded or the default order succeeds.
+  EXPECT_EQ(
+      program->experimental_prefetch_constants(
+          "forward",
+          torch::executor::Span<const uint32_t>(order, num_constants.get())),
+      Error::Ok);
+  EXPECT_EQ(program->experimental_prefetch_constants("forward"), Error::Ok);
+
+  // Indices that do not name constants are rejected.
+  const uint32_t bad_order[] = {0xffffffff};
+  EXPECT_EQ(
+      program->experimental_prefetch_constants("forward", bad_order),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      program->experimental_prefetch_constants("missing"),
+      Error::InvalidArgument);
+}
+
 TEST_F(ProgramTest, LoadConstantSegmentWithNoConstantSegment) {
   // Load the serialized ModuleLinear data, with constants in the flatbuffer and
   // no constants in the segment.
@@ -397,3 +449,77 @@ TEST_F(ProgramTest, LoadConstantSegmentWithNoConstantSegment) {
   // The constant buffer should exist.
   EXPECT_GE(flatbuffer_program->constant_buffer()->size(), 1);
 }
+
+namespace {
+
+// Records the names of the event blocks and of the profiling events.
+class EventNameTracer : public EventTracer {
+ public:
+  void create_event_block(const char* name) override {
+    blocks.emplace_back(name);
+  }
+  EventTracerEntry start_profiling(const char* name, ChainID, DebugHandle)
+      override {
+    events.emplace_back(name);
+    return EventTracerEntry();
+  }
+  void end_profiling(EventTracerEntry) override {}
+  EventTracerEntry start_profiling_delegate(const char*, DebugHandle)
+      override {
+    return EventTracerEntry();
+  }
+  void end_profiling_delegate(EventTracerEntry, const void*, size_t)
+      override {}
+  void log_profiling_delegate(
+      const char*,
+      DebugHandle,
+      torch::executor::et_timestamp_t,
+      torch::executor::et_timestamp_t,
+      const void*,
+      size_t) override {}
+  void track_allocation(AllocatorID, size_t) override {}
+  AllocatorID track_allocator(const char*) override {
+    return 0;
+  }
+  void log_evalue(const EValue&, LoggedEValueType) override {}
+
+  bool has_event(const char* name) const {
+    for (const auto& event : events) {
+      if (event == name) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<std::string> blocks;
+  std::vector<std::string> events;
+};
+
+} // namespace
+
+TEST_F(ProgramTest, LoadProfilesItsSteps) {
+  const char* linear_path =
+      std::getenv("ET_MODULE_LINEAR_CONSTANT_SEGMENT_PATH");
+  Result<FileDataLoader> linear_loader = FileDataLoader::from(linear_path);
+  ASSERT_EQ(linear_loader.error(), Error::Ok);
+
+  EventNameTracer tracer;
+  Result<Program> program = Program::load(
+      &linear_loader.get(),
+      Program::Verification::InternalConsistency,
+      &tracer);
+  ASSERT_EQ(program.error(), Error::Ok);
+
+#ifdef ET_EVENT_TRACER_ENABLED
+  ASSERT_EQ(tracer.blocks.size(), 1);
+  EXPECT_EQ(tracer.blocks[0], "load");
+  EXPECT_TRUE(tracer.has_event("Program::load"));
+  EXPECT_TRUE(tracer.has_event("Program::check_header"));
+  EXPECT_TRUE(tracer.has_event("Program::load_data"));
+  EXPECT_TRUE(tracer.has_event("Program::load_constant_segment"));
+#else
+  EXPECT_TRUE(tracer.blocks.empty());
+  EXPECT_TRUE(tracer.events.empty());
+#endif
+}
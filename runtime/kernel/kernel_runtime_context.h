@@ -36,11 +36,16 @@ class KernelRuntimeContext {
    * @param[in] temp_allocator The optional MemoryAllocator used to allocate
    *     temporary memory for the kernel. If not provided, an error will be
    *     returned when calling allocate_temp.
+   * @param[in] prepacked_data The optional data returned by the kernel's
+   *     prepack function when the method was loaded.
    */
   KernelRuntimeContext(
       EventTracer* event_tracer = nullptr,
-      MemoryAllocator* temp_allocator = nullptr)
-      : event_tracer_(event_tracer), temp_allocator_(temp_allocator) {}
+      MemoryAllocator* temp_allocator = nullptr,
+      const void* prepacked_data = nullptr)
+      : event_tracer_(event_tracer),
+        temp_allocator_(temp_allocator),
+        prepacked_data_(prepacked_data) {}
   /**
    * Tells the runtime that the kernel call has failed. Prefer this over
    * ET_CHECK_*(), which fatally panics the process/system.
@@ -99,14 +104,89 @@ class KernelRuntimeContext {
     return temp_memory;
   }
 
+  /**
+   * Returns true if a temp allocator was provided, so that kernels with a
+   * path that needs no temporary memory can take it without calling
+   * allocate_temp(), which logs an error when there is none.
+   */
+  bool has_temp_allocator() const {
+    return temp_allocator_ != nullptr;
+  }
+
+  /**
+   * Returns the data that the prepack function registered for this kernel's
+   * operator returned when the method was loaded, or nullptr if there is no
+   * prepack function or it declined to pack this call. See
+   * register_prepack_functions().
+   */
+  const void* prepacked_data() const {
+    return prepacked_data_;
+  }
+
   // TODO(T147221312): Add a way to resize a tensor.
 
  private:
   EventTracer* event_tracer_ = nullptr;
   MemoryAllocator* temp_allocator_ = nullptr;
+  const void* prepacked_data_ = nullptr;
   Error failure_state_ = Error::Ok;
 };
 
+/**
+ * State passed to a kernel's prepack function, which runs once per kernel
+ * call instruction when a method is loaded. The prepack function can
+ * transform constant arguments, such as weights, into a layout its kernel
+ * prefers, and the kernel receives the result through
+ * KernelRuntimeContext::prepacked_data() on every call.
+ */
+class KernelPrepackContext final {
+ public:
+  /**
+   * @param[in] method_allocator The allocator that owns the prepacked data.
+   *     It lives as long as the method.
+   * @param[in] arg_is_constant For each argument of the call, whether it is a
+   *     constant tensor whose data is the same for every execution.
+   * @param[in] num_args The number of entries in arg_is_constant.
+   */
+  KernelPrepackContext(
+      MemoryAllocator* method_allocator,
+      const bool* arg_is_constant,
+      size_t num_args)
+      : method_allocator_(method_allocator),
+        arg_is_constant_(arg_is_constant),
+        num_args_(num_args) {}
+
+  /// Returns true if argument `arg_index` is a constant tensor.
+  bool is_constant(size_t arg_index) const {
+    return arg_index < num_args_ && arg_is_constant_[arg_index];
+  }
+
+  /**
+   * Allocates memory for prepacked data. The memory lives as long as the
+   * method and is never freed individually.
+   */
+  Result<void*> allocate(
+      size_t size,
+      size_t alignment = MemoryAllocator::kDefaultAlignment) {
+    ET_CHECK_OR_RETURN_ERROR(
+        method_allocator_ != nullptr,
+        NotFound,
+        "No method allocator provided");
+    void* memory = method_allocator_->allocate(size, alignment);
+    ET_CHECK_OR_RETURN_ERROR(
+        memory != nullptr,
+        MemoryAllocationFailed,
+        "Failed to allocate prepack memory. Bytes requested: %zu",
+        size);
+    return memory;
+  }
+
+ private:
+  MemoryAllocator* method_allocator_ = nullptr;
+  const bool* arg_is_constant_ = nullptr;
+  size_t num_args_ = 0;
+};
+
 } // namespace executor
 } // namespace torch
 
@@ -23,6 +23,56 @@ OperatorRegistry& getOperatorRegistry() {
   return operator_registry;
 }
 
+namespace {
+
+// 32-bit FNV-1a over the op name and, unless it is a fallback, the kernel key
+// data. A fallback kernel and a specialized kernel of the same op hash
+// differently, so each lookup is a single probe sequence.
+uint32_t hash_kernel(const char* name, const KernelKey& kernel_key) {
+  constexpr uint32_t kFnvPrime = 16777619u;
+  uint32_t hash = 2166136261u;
+  for (const char* c = name; *c != '\0'; c++) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * kFnvPrime;
+  }
+  hash = (hash ^ (kernel_key.is_fallback() ? 0u : 1u)) * kFnvPrime;
+  if (!kernel_key.is_fallback()) {
+    const char* data = kernel_key.data();
+    for (size_t i = 0; i < KernelKey::MAX_SIZE && data[i] != '\0'; i++) {
+      hash = (hash ^ static_cast<uint8_t>(data[i])) * kFnvPrime;
+    }
+  }
+  return hash;
+}
+
+} // namespace
+
+int32_t OperatorRegistry::find_kernel(
+    const char* name,
+    const KernelKey& kernel_key) const {
+  constexpr uint32_t kMask = kKernelIndexSize - 1;
+  for (uint32_t slot = hash_kernel(name, kernel_key) & kMask;;
+       slot = (slot + 1) & kMask) {
+    const uint32_t entry = kernel_index_[slot];
+    if (entry == 0) {
+      return -1;
+    }
+    const Kernel& k = kernels_[entry - 1];
+    if (k.kernel_key_ == kernel_key && strcmp(k.name_, name) == 0) {
+      return static_cast<int32_t>(entry - 1);
+    }
+  }
+}
+
+void OperatorRegistry::index_kernel(uint32_t idx) {
+  constexpr uint32_t kMask = kKernelIndexSize - 1;
+  const Kernel& kernel = kernels_[idx];
+  uint32_t slot = hash_kernel(kernel.name_, kernel.kernel_key_) & kMask;
+  while (kernel_index_[slot] != 0) {
+    slot = (slot + 1) & kMask;
+  }
+  kernel_index_[slot] = idx + 1;
+}
+
 Error register_kernels(const ArrayRef<Kernel>& kernels) {
   Error success = getOperatorRegistry().register_kernels(kernels);
   if (success == Error::InvalidArgument || success == Error::Internal) {
@@ -67,17 +117,19 @@ Error OperatorRegistry::register_kernels(const ArrayRef<Kernel>& kernels) {
   const char* lib_name = et_pal_get_shared_library_name(kernels.data());
 
   for (const auto& kernel : kernels) {
-    // linear search. This is fine if the number of kernels are small.
-    for (int32_t i = 0; i < this->num_kernels_; i++) {
-      Kernel k = this->kernels_[i];
-      if (strcmp(kernel.name_, k.name_) == 0 &&
-          kernel.kernel_key_ == k.kernel_key_) {
-        ET_LOG(Error, "Re-registering %s, from %s", k.name_, lib_name);
-        ET_LOG_KERNEL_KEY(k.kernel_key_);
-        return Error::InvalidArgument;
-      }
+    const int32_t existing_idx = find_kernel(kernel.name_, kernel.kernel_key_);
+    if (existing_idx != -1) {
+      const Kernel& k = this->kernels_[existing_idx];
+      ET_LOG(Error, "Re-registering %s, from %s", k.name_, lib_name);
+      ET_LOG_KERNEL_KEY(k.kernel_key_);
+      return Error::InvalidArgument;
+    }
+    this->kernels_[this->num_kernels_] = kernel;
+    index_kernel(this->num_kernels_);
+    this->num_kernels_++;
+    if (!kernel.kernel_key_.is_fallback()) {
+      this->num_specialized_kernels_++;
     }
-    this->kernels_[this->num_kernels_++] = kernel;
   }
   ET_LOG(
       Debug,
@@ -138,16 +190,8 @@ bool OperatorRegistry::hasOpsFn(
   make_kernel_key_string(meta_list, buf);
   KernelKey kernel_key = KernelKey(buf);
 
-  for (size_t idx = 0; idx < this->num_kernels_; idx++) {
-    if (strcmp(this->kernels_[idx].name_, name) == 0) {
-      if (this->kernels_[idx].kernel_key_.is_fallback() ||
-          this->kernels_[idx].kernel_key_ == kernel_key) {
-        return true;
-      }
-    }
-  }
-
-  return false;
+  return find_kernel(name, kernel_key) != -1 ||
+      find_kernel(name, KernelKey()) != -1;
 }
 
 const OpFunction& getOpsFn(const char* name, ArrayRef<TensorMeta> kernel_key) {
@@ -161,17 +205,11 @@ const OpFunction& OperatorRegistry::getOpsFn(
   make_kernel_key_string(meta_list, buf);
   KernelKey kernel_key = KernelKey(buf);
 
-  int32_t fallback_idx = -1;
-  for (size_t idx = 0; idx < this->num_kernels_; idx++) {
-    if (strcmp(this->kernels_[idx].name_, name) == 0) {
-      if (this->kernels_[idx].kernel_key_ == kernel_key) {
-        return this->kernels_[idx].op_;
-      }
-      if (this->kernels_[idx].kernel_key_.is_fallback()) {
-        fallback_idx = idx;
-      }
-    }
+  const int32_t idx = find_kernel(name, kernel_key);
+  if (idx != -1) {
+    return this->kernels_[idx].op_;
   }
+  const int32_t fallback_idx = find_kernel(name, KernelKey());
   if (fallback_idx != -1) {
     return this->kernels_[fallback_idx].op_;
   }
@@ -179,6 +217,90 @@ const OpFunction& OperatorRegistry::getOpsFn(
   ET_LOG_TENSOR_META(meta_list);
 }
 
+Error register_prepack_functions(const ArrayRef<KernelPrepack>& prepacks) {
+  Error success = getOperatorRegistry().register_prepack_functions(prepacks);
+  if (success == Error::InvalidArgument || success == Error::Internal) {
+    ET_CHECK_MSG(
+        false,
+        "Prepack registration failed with error %" PRIu32
+        ", see error log for details.",
+        static_cast<uint32_t>(success));
+  }
+  return success;
+}
+
+Error OperatorRegistry::register_prepack_functions(
+    const ArrayRef<KernelPrepack>& prepacks) {
+  // Like kernels, prepack functions are registered during static
+  // initialization, possibly before PAL init.
+  ::et_pal_init();
+
+  if (prepacks.size() + this->num_prepacks_ > kMaxNumOfPrepacks) {
+    ET_LOG(
+        Error,
+        "The total number of prepack functions to be registered is larger "
+        "than the limit %" PRIu32 ". %" PRIu32 " are already registered.",
+        kMaxNumOfPrepacks,
+        (uint32_t)this->num_prepacks_);
+    return Error::Internal;
+  }
+  for (const auto& prepack : prepacks) {
+    if (getPrepackFn(prepack.name_) != nullptr) {
+      ET_LOG(Error, "Re-registering prepack function for %s", prepack.name_);
+      return Error::InvalidArgument;
+    }
+    this->prepacks_[this->num_prepacks_++] = prepack;
+  }
+  return Error::Ok;
+}
+
+PrepackFunction getPrepackFn(const char* name) {
+  return getOperatorRegistry().getPrepackFn(name);
+}
+
+PrepackFunction OperatorRegistry::getPrepackFn(const char* name) const {
+  // Few operators have prepack functions and they are only looked up when a
+  // method is loaded, so a linear scan is enough.
+  for (size_t i = 0; i < this->num_prepacks_; i++) {
+    if (strcmp(this->prepacks_[i].name_, name) == 0) {
+      return this->prepacks_[i].prepack_;
+    }
+  }
+  return nullptr;
+}
+
+uint64_t get_kernels_fingerprint() {
+  return getOperatorRegistry().get_kernels_fingerprint();
+}
+
+uint64_t OperatorRegistry::get_kernels_fingerprint() const {
+  // 64-bit FNV-1a, with a null byte closing each string so that moving a
+  // character from a name to its key changes the hash.
+  constexpr uint64_t kFnvPrime = 1099511628211ull;
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](const char* str, size_t max_len) {
+    for (size_t i = 0; i < max_len && str[i] != '\0'; i++) {
+      hash = (hash ^ static_cast<uint8_t>(str[i])) * kFnvPrime;
+    }
+    hash *= kFnvPrime;
+  };
+  for (size_t i = 0; i < this->num_kernels_; i++) {
+    const Kernel& kernel = this->kernels_[i];
+    mix(kernel.name_, SIZE_MAX);
+    mix(kernel.kernel_key_.is_fallback() ? "" : kernel.kernel_key_.data(),
+        KernelKey::MAX_SIZE);
+  }
+  return hash;
+}
+
+bool has_specialized_kernels() {
+  return getOperatorRegistry().has_specialized_kernels();
+}
+
+bool OperatorRegistry::has_specialized_kernels() const {
+  return this->num_specialized_kernels_ > 0;
+}
+
 ArrayRef<Kernel> get_kernels() {
   return getOperatorRegistry().get_kernels();
 }
@@ -40,8 +40,16 @@ namespace torch {
 namespace executor {
 
 class KernelRuntimeContext; // Forward declaration
+class KernelPrepackContext; // Forward declaration
 using RuntimeContext = KernelRuntimeContext; // TODO(T147221312): Remove
 using OpFunction = void (*)(KernelRuntimeContext&, EValue**);
+/**
+ * Runs once per kernel call instruction when a method is loaded, with the
+ * same arguments the kernel will receive. Returns data for the kernel to read
+ * through KernelRuntimeContext::prepacked_data(), or nullptr to leave the
+ * call unpacked.
+ */
+using PrepackFunction = const void* (*)(KernelPrepackContext&, EValue**);
 
 /**
  * Dtype and dim order metadata for a Tensor argument to an operator.
@@ -189,6 +197,21 @@ struct Kernel {
   Kernel() {}
 };
 
+/**
+ * Associates a prepack function with an operator name. Kernel libraries
+ * register these next to their kernels, so the prepacked layout is only
+ * produced for, and read by, kernels that understand it.
+ */
+struct KernelPrepack {
+  const char* name_;
+  PrepackFunction prepack_;
+
+  explicit KernelPrepack(const char* name, PrepackFunction prepack)
+      : name_(name), prepack_(prepack) {}
+
+  KernelPrepack() : name_(nullptr), prepack_(nullptr) {}
+};
+
 // Maximum number of operators and their associated kernels that can be
 // registered.
 constexpr uint32_t kOperatorTableMaxSize = 250;
@@ -199,6 +222,25 @@ constexpr uint32_t kMaxNumOfKernels = MAX_KERNEL_NUM;
 constexpr uint32_t kMaxNumOfKernels =
     kOperatorTableMaxSize * kMaxNumOfKernelPerOp;
 #endif
+
+namespace internal {
+// Smallest power of two that is >= n.
+constexpr uint32_t next_power_of_two(uint32_t n) {
+  uint32_t size = 1;
+  while (size < n) {
+    size <<= 1;
+  }
+  return size;
+}
+} // namespace internal
+
+// Number of slots in the kernel hash index. Keeping the load factor at or
+// below 50% bounds the probe sequences of the open addressing.
+constexpr uint32_t kKernelIndexSize =
+    internal::next_power_of_two(2 * kMaxNumOfKernels);
+
+// Maximum number of operators that can have a prepack function.
+constexpr uint32_t kMaxNumOfPrepacks = 64;
 /**
  * See OperatorRegistry::hasOpsFn()
  */
@@ -216,6 +258,16 @@ const OpFunction& getOpsFn(
  */
 ArrayRef<Kernel> get_kernels();
 
+/**
+ * See OperatorRegistry::get_kernels_fingerprint()
+ */
+uint64_t get_kernels_fingerprint();
+
+/**
+ * See OperatorRegistry::has_specialized_kernels()
+ */
+bool has_specialized_kernels();
+
 /**
  * See OperatorRegistry::register_kernels(). Notice that the returned Error
  * object should be handled internally and the reason for keep returning is to
@@ -223,9 +275,23 @@ ArrayRef<Kernel> get_kernels();
  */
 __ET_NODISCARD Error register_kernels(const ArrayRef<Kernel>&);
 
+/**
+ * See OperatorRegistry::register_prepack_functions().
+ */
+__ET_NODISCARD Error register_prepack_functions(const ArrayRef<KernelPrepack>&);
+
+/**
+ * See OperatorRegistry::getPrepackFn()
+ */
+PrepackFunction getPrepackFn(const char* name);
+
 struct OperatorRegistry {
  public:
-  OperatorRegistry() : num_kernels_(0) {}
+  OperatorRegistry()
+      : num_kernels_(0),
+        num_specialized_kernels_(0),
+        kernel_index_(),
+        num_prepacks_(0) {}
 
   /**
    * Registers the Kernels object (i.e. string name and function reference
@@ -253,9 +319,61 @@ struct OperatorRegistry {
    */
   ArrayRef<Kernel> get_kernels();
 
+  /**
+   * Returns a hash of the names and kernel keys of the registered kernels, in
+   * registration order. Indices into get_kernels() saved by a process are
+   * valid in another one if both have the same fingerprint.
+   */
+  uint64_t get_kernels_fingerprint() const;
+
+  /**
+   * Returns whether any registered kernel has a kernel key, i.e. whether the
+   * kernel of an operator may depend on the dtypes and dim orders of its
+   * arguments. When none has, an operator resolves to the same kernel for
+   * every call site, so callers may resolve each operator name once.
+   */
+  bool has_specialized_kernels() const;
+
+  /**
+   * Registers prepack functions by operator name. An operator can have at
+   * most one prepack function, independent of its kernel keys. Unlike
+   * kernels, prepack functions may be registered before their operators.
+   *
+   * @param[in] prepacks The operator name and prepack function pairs.
+   * @retval Error code representing whether registration was successful.
+   */
+  __ET_NODISCARD Error
+  register_prepack_functions(const ArrayRef<KernelPrepack>& prepacks);
+
+  /**
+   * Returns the prepack function registered for the operator, or nullptr if
+   * there is none.
+   */
+  PrepackFunction getPrepackFn(const char* name) const;
+
  private:
+  /**
+   * Returns the index into kernels_ of the kernel registered with exactly
+   * this name and kernel key, or -1 if there is none.
+   */
+  int32_t find_kernel(const char* name, const KernelKey& kernel_key) const;
+
+  /**
+   * Adds kernels_[idx] to the hash index. The kernel must not be indexed yet.
+   */
+  void index_kernel(uint32_t idx);
+
   Kernel kernels_[kMaxNumOfKernels];
   uint32_t num_kernels_;
+  // Number of kernels in kernels_ that are not fallback kernels.
+  uint32_t num_specialized_kernels_;
+
+  // Open addressing hash index over kernels_, keyed by (name, kernel key).
+  // Each slot holds the kernel index + 1, and 0 marks an empty slot.
+  uint32_t kernel_index_[kKernelIndexSize];
+
+  KernelPrepack prepacks_[kMaxNumOfPrepacks];
+  uint32_t num_prepacks_;
 };
 
 } // namespace executor
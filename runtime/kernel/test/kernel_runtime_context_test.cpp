@@ -14,6 +14,7 @@
 
 using namespace ::testing;
 using torch::executor::Error;
+using torch::executor::KernelPrepackContext;
 using torch::executor::KernelRuntimeContext;
 using torch::executor::MemoryAllocator;
 using torch::executor::Result;
@@ -63,6 +64,7 @@ TEST_F(KernelRuntimeContextTest, FailureStateReflectsFailure) {
 
 TEST_F(KernelRuntimeContextTest, FailureNoMemoryAllocatorProvided) {
   KernelRuntimeContext context;
+  EXPECT_FALSE(context.has_temp_allocator());
   Result<void*> allocated_memory = context.allocate_temp(4);
   EXPECT_EQ(allocated_memory.error(), Error::NotFound);
 }
@@ -74,6 +76,7 @@ TEST_F(KernelRuntimeContextTest, SuccessfulMemoryAllocation) {
   MemoryAllocator temp_allocator(
       temp_memory_allocator_pool_size, temp_memory_allocator_pool.get());
   KernelRuntimeContext context(nullptr, &temp_allocator);
+  EXPECT_TRUE(context.has_temp_allocator());
   Result<void*> allocated_memory = context.allocate_temp(4);
   EXPECT_EQ(allocated_memory.ok(), true);
 }
@@ -100,3 +103,35 @@ TEST_F(KernelRuntimeContextTest, MemoryAllocatorAlignmentPassed) {
   EXPECT_EQ(allocated_memory.ok(), true);
   EXPECT_EQ(temp_allocator.last_seen_alignment, 2);
 }
+
+TEST_F(KernelRuntimeContextTest, PrepackedDataDefaultsToNull) {
+  KernelRuntimeContext context;
+  EXPECT_EQ(context.prepacked_data(), nullptr);
+
+  int packed = 0;
+  KernelRuntimeContext prepacked_context(nullptr, nullptr, &packed);
+  EXPECT_EQ(prepacked_context.prepacked_data(), &packed);
+}
+
+TEST_F(KernelRuntimeContextTest, PrepackContextReportsConstantArgs) {
+  bool arg_is_constant[] = {false, true};
+  KernelPrepackContext context(nullptr, arg_is_constant, 2);
+  EXPECT_FALSE(context.is_constant(0));
+  EXPECT_TRUE(context.is_constant(1));
+  // Out of range arguments are never constant.
+  EXPECT_FALSE(context.is_constant(2));
+  EXPECT_EQ(context.allocate(4).error(), Error::NotFound);
+}
+
+TEST_F(KernelRuntimeContextTest, PrepackContextAllocates) {
+  constexpr size_t method_allocator_pool_size = 4;
+  auto method_allocator_pool =
+      std::make_unique<uint8_t[]>(method_allocator_pool_size);
+  TestMemoryAllocator method_allocator(
+      method_allocator_pool_size, method_allocator_pool.get());
+  KernelPrepackContext context(&method_allocator, nullptr, 0);
+  Result<void*> allocated_memory = context.allocate(4, 2);
+  EXPECT_EQ(allocated_memory.ok(), true);
+  EXPECT_EQ(method_allocator.last_seen_alignment, 2);
+  EXPECT_EQ(context.allocate(8).error(), Error::MemoryAllocationFailed);
+}
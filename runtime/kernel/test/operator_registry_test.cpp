@@ -271,5 +271,117 @@ TEST_F(OperatorRegistryTest, ExecutorUsesFallbackKernel) {
   ASSERT_EQ(val, 100);
 }
 
+TEST_F(OperatorRegistryTest, LookUpAmongManyKernels) {
+  constexpr int kNumOps = 64;
+  // The registry keeps the name pointers, so they must outlive the test.
+  static char names[kNumOps][32];
+
+  char buf_long_contiguous[BUF_SIZE];
+  make_kernel_key({{ScalarType::Long, {0, 1, 2, 3}}}, buf_long_contiguous);
+  KernelKey key = KernelKey(buf_long_contiguous);
+
+  // Every op has a specialized kernel returning 2 * i, and the even ops also
+  // have a fallback kernel returning 2 * i + 1.
+  std::vector<Kernel> kernels;
+  for (int i = 0; i < kNumOps; i++) {
+    snprintf(names[i], sizeof(names[i]), "test::many_%d", i);
+    kernels.emplace_back(names[i], key, [](RuntimeContext&, EValue** stack) {
+      *(stack[0]) = Scalar(stack[0]->toScalar().to<int64_t>() * 2);
+    });
+    if (i % 2 == 0) {
+      kernels.emplace_back(
+          names[i], KernelKey{}, [](RuntimeContext&, EValue** stack) {
+            *(stack[0]) = Scalar(stack[0]->toScalar().to<int64_t>() * 2 + 1);
+          });
+    }
+  }
+  auto s1 = register_kernels(ArrayRef<Kernel>(kernels.data(), kernels.size()));
+  EXPECT_EQ(s1, torch::executor::Error::Ok);
+
+  Tensor::DimOrderType dims[] = {0, 1, 2, 3};
+  auto dim_order_type = ArrayRef<Tensor::DimOrderType>(dims, 4);
+  TensorMeta meta_long[] = {TensorMeta(ScalarType::Long, dim_order_type)};
+  TensorMeta meta_float[] = {TensorMeta(ScalarType::Float, dim_order_type)};
+
+  EValue values[1];
+  EValue* stack[1] = {&values[0]};
+  RuntimeContext context{};
+  for (int i = 0; i < kNumOps; i++) {
+    EXPECT_TRUE(hasOpsFn(names[i], ArrayRef<TensorMeta>(meta_long)));
+    values[0] = Scalar(i);
+    getOpsFn(names[i], ArrayRef<TensorMeta>(meta_long))(context, stack);
+    EXPECT_EQ(values[0].toScalar().to<int64_t>(), 2 * i);
+
+    // Only the even ops can fall back for a dtype without a specialized kernel
+    const bool has_fallback = (i % 2 == 0);
+    EXPECT_EQ(
+        hasOpsFn(names[i], ArrayRef<TensorMeta>(meta_float)), has_fallback);
+    EXPECT_EQ(hasOpsFn(names[i]), has_fallback);
+    if (has_fallback) {
+      values[0] = Scalar(i);
+      getOpsFn(names[i], ArrayRef<TensorMeta>(meta_float))(context, stack);
+      EXPECT_EQ(values[0].toScalar().to<int64_t>(), 2 * i + 1);
+    }
+  }
+  EXPECT_FALSE(hasOpsFn("test::many_", ArrayRef<TensorMeta>(meta_long)));
+}
+
+TEST_F(OperatorRegistryTest, FingerprintChangesWithKernels) {
+  const uint64_t before = get_kernels_fingerprint();
+  EXPECT_EQ(get_kernels_fingerprint(), before);
+
+  Kernel kernels[] = {
+      Kernel("test::fingerprinted", [](RuntimeContext&, EValue**) {})};
+  auto s1 = register_kernels(kernels);
+  EXPECT_EQ(s1, torch::executor::Error::Ok);
+  EXPECT_NE(get_kernels_fingerprint(), before);
+}
+
+TEST_F(OperatorRegistryTest, HasSpecializedKernelsWithKernelKey) {
+  char buf[BUF_SIZE];
+  make_kernel_key({{ScalarType::Float, {0, 1, 2, 3}}}, buf);
+  Kernel kernels[] = {Kernel(
+      "test::specialized", KernelKey(buf), [](RuntimeContext&, EValue**) {})};
+  auto s1 = register_kernels(kernels);
+  EXPECT_EQ(s1, torch::executor::Error::Ok);
+  EXPECT_TRUE(has_specialized_kernels());
+}
+
+TEST_F(OperatorRegistryTest, RegisterPrepackFunctions) {
+  static int prepack_value = 7;
+  KernelPrepack prepacks[] = {KernelPrepack(
+      "test::prepacked", [](KernelPrepackContext& context, EValue** stack) {
+        (void)stack;
+        return context.is_constant(0)
+            ? static_cast<const void*>(&prepack_value)
+            : nullptr;
+      })};
+  auto s1 = register_prepack_functions(prepacks);
+  EXPECT_EQ(s1, torch::executor::Error::Ok);
+
+  EXPECT_EQ(getPrepackFn("test::not_prepacked"), nullptr);
+  PrepackFunction prepack = getPrepackFn("test::prepacked");
+  ASSERT_NE(prepack, nullptr);
+
+  EValue values[1];
+  EValue* stack[1] = {&values[0]};
+  bool constant[] = {true};
+  KernelPrepackContext constant_context(nullptr, constant, 1);
+  EXPECT_EQ(prepack(constant_context, stack), &prepack_value);
+
+  bool not_constant[] = {false};
+  KernelPrepackContext not_constant_context(nullptr, not_constant, 1);
+  EXPECT_EQ(prepack(not_constant_context, stack), nullptr);
+}
+
+TEST_F(OperatorRegistryTest, DoubleRegisterPrepackFunctionsDies) {
+  KernelPrepack prepacks[] = {KernelPrepack(
+      "test::double_prepacked",
+      [](KernelPrepackContext&, EValue**) -> const void* { return nullptr; })};
+  auto s1 = register_prepack_functions(prepacks);
+  EXPECT_EQ(s1, torch::executor::Error::Ok);
+  ET_EXPECT_DEATH({ auto res = register_prepack_functions(prepacks); }, "");
+}
+
 } // namespace executor
 } // namespace torch
@@ -7,9 +7,12 @@
  */
 
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 
 #include <executorch/runtime/platform/assert.h>
 #include <executorch/runtime/platform/hooks.h>
+#include <executorch/runtime/platform/log.h>
 #include <executorch/runtime/platform/platform.h>
 #include <executorch/runtime/platform/profiler.h>
 #include <inttypes.h>
@@ -18,23 +21,142 @@ namespace torch {
 namespace executor {
 
 namespace {
-static uint8_t prof_buf[prof_buf_size * MAX_PROFILE_BLOCKS];
-// Base pointer for header
-static prof_header_t* prof_header =
-    (prof_header_t*)((uintptr_t)prof_buf + prof_header_offset);
-// Base pointer for profiling entries
-static prof_event_t* prof_arr =
-    (prof_event_t*)((uintptr_t)prof_buf + prof_events_offset);
-// Base pointer for memory allocator info array
-static prof_allocator_t* mem_allocator_arr =
-    (prof_allocator_t*)((uintptr_t)prof_buf + prof_mem_alloc_info_offset);
-// Base pointer for memory profiling entries
-static mem_prof_event_t* mem_prof_arr =
-    (mem_prof_event_t*)((uintptr_t)prof_buf + prof_mem_alloc_events_offset);
-
-static uint32_t num_blocks = 0;
-static bool prof_stats_dumped = false;
-prof_state_t profile_state_tls{-1, 0u};
+
+// A perf event as it is recorded. The name is only copied into the
+// prof_event_t of the dump.
+struct alignas(8) prof_record_t {
+  const char* name;
+  uint32_t block_id;
+  int32_t chain_idx;
+  uint32_t instruction_idx;
+  uint64_t start_time;
+  uint64_t end_time;
+};
+
+// The ring of perf events of a thread. Only written by the thread that
+// claimed it, so recording needs no atomics.
+struct prof_ring_t {
+  prof_record_t* records;
+  // A power of two.
+  uint32_t capacity;
+  // Number of events begun since the last reset, the last `capacity` of which
+  // are in `records`.
+  uint64_t num_begun;
+};
+
+struct prof_block_t {
+  char name[PROF_NAME_MAX_LEN];
+};
+
+struct alignas(8) mem_prof_record_t {
+  uint32_t block_id;
+  mem_prof_event_t event;
+};
+
+#ifdef PROFILING_ENABLED
+constexpr size_t kStaticRecords = MAX_PROFILE_EVENTS * MAX_PROFILE_THREADS;
+// As much as the blocks of the previous fixed size profiler took.
+constexpr size_t kStaticDumpSize = prof_buf_size * 2;
+#else
+// Builds without profiling can still pass buffers to profiler_set_buffers().
+constexpr size_t kStaticRecords = 1;
+constexpr size_t kStaticDumpSize = 8;
+#endif
+// Maximum number of threads that can profile, whatever the buffers.
+constexpr uint32_t kMaxProfileRings = 64;
+constexpr uint32_t kNoBlock = UINT32_MAX;
+
+static prof_record_t static_records[kStaticRecords];
+alignas(8) static uint8_t static_dump_buf[kStaticDumpSize];
+
+static prof_ring_t rings[kMaxProfileRings];
+static uint32_t max_rings = 0;
+static std::atomic<uint32_t> num_rings{0};
+// Bumped by profiler_set_buffers() to make the threads claim new rings. 0
+// until the profiler is first configured.
+static std::atomic<uint32_t> ring_generation{0};
+static uint8_t* dump_buf = nullptr;
+static size_t dump_buf_size = 0;
+
+static prof_block_t blocks[MAX_PROFILE_BLOCKS];
+static std::atomic<uint32_t> num_blocks_created{0};
+
+static prof_allocator_t mem_allocator_arr[MEM_PROFILE_MAX_ALLOCATORS];
+static std::atomic<uint32_t> num_allocators{0};
+static mem_prof_record_t mem_prof_arr[MAX_MEM_PROFILE_EVENTS];
+static std::atomic<uint32_t> num_mem_prof_entries{0};
+
+// Events dropped other than by overwriting the rings.
+static std::atomic<uint64_t> num_dropped{0};
+
+struct tls_ring_t {
+  uint32_t generation;
+  prof_ring_t* ring;
+};
+thread_local tls_ring_t tls_ring{0, nullptr};
+thread_local uint32_t tls_block_id = kNoBlock;
+thread_local prof_state_t profile_state_tls{-1, 0u};
+
+void copy_name(char* dst, const char* src) {
+  size_t str_len = strlen(src);
+  memset(dst, 0, PROF_NAME_MAX_LEN);
+  memcpy(dst, src, str_len > PROF_NAME_MAX_LEN ? PROF_NAME_MAX_LEN : str_len);
+}
+
+void ensure_configured() {
+  static const bool configured = [] {
+    if (ring_generation.load() == 0) {
+      profiler_set_buffers(
+          static_records,
+          sizeof(static_records),
+          MAX_PROFILE_EVENTS,
+          static_dump_buf,
+          sizeof(static_dump_buf));
+    }
+    return true;
+  }();
+  (void)configured;
+}
+
+prof_ring_t* ring_for_thread() {
+  uint32_t generation = ring_generation.load(std::memory_order_acquire);
+  if (generation != 0 && tls_ring.generation == generation) {
+    return tls_ring.ring;
+  }
+  ensure_configured();
+  generation = ring_generation.load(std::memory_order_acquire);
+  tls_ring.generation = generation;
+  tls_ring.ring = nullptr;
+  uint32_t index = num_rings.fetch_add(1, std::memory_order_relaxed);
+  if (index < max_rings) {
+    tls_ring.ring = &rings[index];
+  }
+  return tls_ring.ring;
+}
+
+uint32_t current_block_id() {
+  if (tls_block_id != kNoBlock) {
+    return tls_block_id;
+  }
+  uint32_t num_created = num_blocks_created.load(std::memory_order_acquire);
+  if (num_created == 0) {
+    profiling_create_block("default");
+    return tls_block_id;
+  }
+  return num_created - 1;
+}
+
+uint64_t num_overwritten_events() {
+  uint64_t num_overwritten = 0;
+  uint32_t num_claimed = num_rings.load();
+  for (uint32_t i = 0; i < num_claimed && i < max_rings; i++) {
+    if (rings[i].num_begun > rings[i].capacity) {
+      num_overwritten += rings[i].num_begun - rings[i].capacity;
+    }
+  }
+  return num_overwritten;
+}
+
 } // namespace
 
 const prof_state_t& get_profile_tls_state() {
@@ -55,129 +177,265 @@ ExecutorchProfilerInstructionScope::~ExecutorchProfilerInstructionScope() {
   set_profile_tls_state(old_state_);
 }
 
+void profiler_set_buffers(
+    void* event_buffer,
+    size_t event_buffer_size,
+    uint32_t max_events_per_thread,
+    void* dump_buffer,
+    size_t dump_buffer_size) {
+  // The largest power of two that fits, so that tokens index rings with a
+  // mask even after they wrap around.
+  uint32_t capacity = 0;
+  if (max_events_per_thread > 0) {
+    capacity = 1u << (31 - __builtin_clz(max_events_per_thread));
+  }
+
+  // Align the buffers for prof_record_t and prof_header_t.
+  uintptr_t event_begin = ((uintptr_t)event_buffer + 7) & ~(uintptr_t)7;
+  uintptr_t event_end = (uintptr_t)event_buffer + event_buffer_size;
+  size_t num_records = event_buffer != nullptr && event_end > event_begin
+      ? (event_end - event_begin) / sizeof(prof_record_t)
+      : 0;
+  max_rings = capacity > 0 ? num_records / capacity : 0;
+  if (max_rings > kMaxProfileRings) {
+    max_rings = kMaxProfileRings;
+  }
+  for (uint32_t i = 0; i < max_rings; i++) {
+    rings[i].records = (prof_record_t*)event_begin + i * capacity;
+    rings[i].capacity = capacity;
+    rings[i].num_begun = 0;
+  }
+
+  uintptr_t dump_begin = ((uintptr_t)dump_buffer + 7) & ~(uintptr_t)7;
+  uintptr_t dump_end = (uintptr_t)dump_buffer + dump_buffer_size;
+  dump_buf = (uint8_t*)dump_begin;
+  dump_buf_size = dump_buffer != nullptr && dump_end > dump_begin
+      ? dump_end - dump_begin
+      : 0;
+
+  num_rings.store(0);
+  uint32_t generation = ring_generation.load() + 1;
+  ring_generation.store(generation == 0 ? 1 : generation);
+  reset_profile_stats();
+}
+
 uint32_t begin_profiling(const char* name) {
-  ET_CHECK_MSG(
-      prof_header->prof_entries < MAX_PROFILE_EVENTS,
-      "Out of profiling buffer space. Increase MAX_PROFILE_EVENTS and re-compile.");
-  uint32_t curr_counter = prof_header->prof_entries;
-  prof_header->prof_entries++;
-  prof_arr[curr_counter].end_time = 0;
-  prof_arr[curr_counter].name_str = name;
+  prof_ring_t* ring = ring_for_thread();
+  if (ring == nullptr) {
+    num_dropped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+  uint32_t token = static_cast<uint32_t>(ring->num_begun);
+  prof_record_t& record = ring->records[token & (ring->capacity - 1)];
+  record.end_time = 0;
+  record.name = name;
+  record.block_id = current_block_id();
   prof_state_t state = get_profile_tls_state();
-  prof_arr[curr_counter].chain_idx = state.chain_idx;
-  prof_arr[curr_counter].instruction_idx = state.instruction_idx;
+  record.chain_idx = state.chain_idx;
+  record.instruction_idx = state.instruction_idx;
+  ring->num_begun++;
   // Set start time at the last to ensure that we're not capturing
   // any of the overhead in this function.
-  prof_arr[curr_counter].start_time = et_pal_current_ticks();
-  return curr_counter;
+  record.start_time = et_pal_current_ticks();
+  return token;
 }
 
 void end_profiling(uint32_t token_id) {
-  ET_CHECK_MSG(token_id < MAX_PROFILE_EVENTS, "Invalid token id.");
-  prof_arr[token_id].end_time = et_pal_current_ticks();
+  et_timestamp_t end_time = et_pal_current_ticks();
+  prof_ring_t* ring = tls_ring.ring;
+  if (ring == nullptr ||
+      tls_ring.generation != ring_generation.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // The event is gone if the ring was reset or wrapped around since it began.
+  uint32_t age = static_cast<uint32_t>(ring->num_begun) - token_id;
+  if (age == 0 || age > ring->capacity) {
+    return;
+  }
+  ring->records[token_id & (ring->capacity - 1)].end_time = end_time;
 }
 
 void dump_profile_stats(prof_result_t* prof_result) {
-  prof_result->prof_data = (uint8_t*)prof_buf;
-  prof_result->num_bytes = num_blocks * prof_buf_size;
-  prof_result->num_blocks = num_blocks;
-
-  if (!prof_stats_dumped) {
-    for (size_t i = 0; i < num_blocks; i++) {
-      prof_header_t* prof_header_local =
-          (prof_header_t*)(prof_buf + prof_buf_size * i);
-      prof_event_t* prof_event_local =
-          (prof_event_t*)(prof_buf + prof_buf_size * i + prof_events_offset);
-      // Copy over the string names into the space allocated in prof_event_t. We
-      // avoided doing this earlier to keep the overhead in begin_profiling and
-      // end_profiling as low as possible.
-      for (size_t j = 0; j < prof_header_local->prof_entries; j++) {
-        size_t str_len = strlen(prof_event_local[j].name_str);
-        const char* str_ptr = prof_event_local[j].name_str;
-        memset(prof_event_local[j].name, 0, PROF_NAME_MAX_LEN);
-        if (str_len > PROF_NAME_MAX_LEN) {
-          memcpy(prof_event_local[j].name, str_ptr, PROF_NAME_MAX_LEN);
-        } else {
-          memcpy(prof_event_local[j].name, str_ptr, str_len);
+  ensure_configured();
+  prof_result->prof_data = dump_buf;
+  prof_result->num_bytes = 0;
+  prof_result->num_blocks = 0;
+
+  // The events left in each ring, which are in the order they began, and so
+  // in the order of their blocks.
+  uint32_t num_claimed = num_rings.load();
+  if (num_claimed > max_rings) {
+    num_claimed = max_rings;
+  }
+  uint64_t cursors[kMaxProfileRings];
+  for (uint32_t i = 0; i < num_claimed; i++) {
+    const prof_ring_t& ring = rings[i];
+    cursors[i] =
+        ring.num_begun > ring.capacity ? ring.num_begun - ring.capacity : 0;
+  }
+  auto head = [&](uint32_t i) -> const prof_record_t* {
+    const prof_ring_t& ring = rings[i];
+    return cursors[i] < ring.num_begun
+        ? &ring.records[cursors[i] & (ring.capacity - 1)]
+        : nullptr;
+  };
+
+  const uint32_t num_created = num_blocks_created.load();
+  const uint32_t first_block =
+      num_created > MAX_PROFILE_BLOCKS ? num_created - MAX_PROFILE_BLOCKS : 0;
+  const uint32_t num_alloc = std::min<uint32_t>(
+      num_allocators.load(), MEM_PROFILE_MAX_ALLOCATORS);
+  const uint32_t num_mem = std::min<uint32_t>(
+      num_mem_prof_entries.load(), MAX_MEM_PROFILE_EVENTS);
+  uint64_t num_not_dumped = 0;
+  size_t offset = 0;
+
+  for (uint32_t block_id = first_block; block_id < num_created; block_id++) {
+    // Events of blocks that were overwritten in the block table.
+    for (uint32_t i = 0; i < num_claimed; i++) {
+      const prof_record_t* r = head(i);
+      while (r != nullptr && r->block_id < block_id) {
+        num_not_dumped++;
+        cursors[i]++;
+        r = head(i);
+      }
+    }
+
+    size_t header_offset = offset;
+    offset += sizeof(prof_header_t);
+    uint32_t num_events = 0;
+    // Merge the events of this block from all the rings by start time.
+    while (true) {
+      int32_t next = -1;
+      for (uint32_t i = 0; i < num_claimed; i++) {
+        const prof_record_t* r = head(i);
+        if (r != nullptr && r->block_id == block_id &&
+            (next < 0 || r->start_time < head(next)->start_time)) {
+          next = i;
         }
       }
+      if (next < 0) {
+        break;
+      }
+      const prof_record_t* r = head(next);
+      cursors[next]++;
+      if (offset + sizeof(prof_event_t) > dump_buf_size) {
+        num_not_dumped++;
+        continue;
+      }
+      prof_event_t* event = (prof_event_t*)(dump_buf + offset);
+      copy_name(event->name, r->name);
+      event->chain_idx = r->chain_idx;
+      event->instruction_idx = r->instruction_idx;
+      event->start_time = r->start_time;
+      event->end_time = r->end_time;
+      offset += sizeof(prof_event_t);
+      num_events++;
+    }
+
+    uint32_t num_block_mem = 0;
+    for (uint32_t i = 0; i < num_mem; i++) {
+      num_block_mem += mem_prof_arr[i].block_id == block_id ? 1 : 0;
+    }
+    size_t tail_size = sizeof(prof_allocator_t) * num_alloc +
+        sizeof(mem_prof_event_t) * num_block_mem;
+    if ((num_events == 0 && num_block_mem == 0) ||
+        offset + tail_size > dump_buf_size) {
+      // Skip empty blocks, like an unused "default" block, and blocks that do
+      // not fit.
+      num_not_dumped += num_events + num_block_mem;
+      offset = header_offset;
+      continue;
+    }
+
+    memcpy(
+        dump_buf + offset,
+        mem_allocator_arr,
+        sizeof(prof_allocator_t) * num_alloc);
+    offset += sizeof(prof_allocator_t) * num_alloc;
+    for (uint32_t i = 0; i < num_mem; i++) {
+      if (mem_prof_arr[i].block_id == block_id) {
+        memcpy(
+            dump_buf + offset,
+            &mem_prof_arr[i].event,
+            sizeof(mem_prof_event_t));
+        offset += sizeof(mem_prof_event_t);
+      }
     }
+
+    prof_header_t* header = (prof_header_t*)(dump_buf + header_offset);
+    memcpy(
+        header->name,
+        blocks[block_id % MAX_PROFILE_BLOCKS].name,
+        PROF_NAME_MAX_LEN);
+    header->prof_ver = ET_PROF_VER;
+    header->max_prof_entries = num_events;
+    header->prof_entries = num_events;
+    header->max_allocator_entries = num_alloc;
+    header->allocator_entries = num_alloc;
+    header->max_mem_prof_entries = num_block_mem;
+    header->mem_prof_entries = num_block_mem;
+    prof_result->num_blocks++;
   }
+  prof_result->num_bytes = offset;
 
-  prof_stats_dumped = true;
+  // Events of blocks older than the block table or newer than any block.
+  for (uint32_t i = 0; i < num_claimed; i++) {
+    num_not_dumped += rings[i].num_begun - cursors[i];
+  }
+  uint64_t num_lost = profiler_num_dropped_events() + num_not_dumped;
+  if (num_lost > 0) {
+    ET_LOG(
+        Error,
+        "%" PRIu64
+        " profiling events were dropped. Increase MAX_PROFILE_EVENTS, MAX_PROFILE_BLOCKS or the buffers passed to profiler_set_buffers().",
+        num_lost);
+  }
 }
 
 void reset_profile_stats() {
-  prof_stats_dumped = false;
-  prof_header->prof_entries = 0;
-  prof_header->allocator_entries = 0;
-  prof_header->mem_prof_entries = 0;
+  for (uint32_t i = 0; i < max_rings; i++) {
+    rings[i].num_begun = 0;
+  }
+  num_mem_prof_entries.store(0);
+  num_dropped.store(0);
+}
+
+uint64_t profiler_num_dropped_events() {
+  return num_dropped.load() + num_overwritten_events();
 }
 
 void track_allocation(int32_t id, uint32_t size) {
   if (id == -1)
     return;
-  ET_CHECK_MSG(
-      prof_header->mem_prof_entries < MAX_MEM_PROFILE_EVENTS,
-      "Out of memory profiling buffer space. Increase MAX_MEM_PROFILE_EVENTS\
-       to %" PRIu32 " and re-compile.",
-      prof_header->mem_prof_entries);
-  mem_prof_arr[prof_header->mem_prof_entries].allocator_id = id;
-  mem_prof_arr[prof_header->mem_prof_entries].allocation_size = size;
-  prof_header->mem_prof_entries++;
+  uint32_t index = num_mem_prof_entries.fetch_add(1, std::memory_order_relaxed);
+  if (index >= MAX_MEM_PROFILE_EVENTS) {
+    num_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  mem_prof_arr[index].block_id = current_block_id();
+  mem_prof_arr[index].event.allocator_id = id;
+  mem_prof_arr[index].event.allocation_size = size;
 }
 
 uint32_t track_allocator(const char* name) {
-  ET_CHECK_MSG(
-      prof_header->allocator_entries < MEM_PROFILE_MAX_ALLOCATORS,
-      "Out of allocator tracking space, %d is needed. Increase MEM_PROFILE_MAX_ALLOCATORS and re-compile",
-      prof_header->allocator_entries);
-  size_t str_len = strlen(name);
-  size_t num_allocators = prof_header->allocator_entries;
-  memset(mem_allocator_arr[num_allocators].name, 0, PROF_NAME_MAX_LEN);
-  if (str_len > PROF_NAME_MAX_LEN) {
-    memcpy(mem_allocator_arr[num_allocators].name, name, PROF_NAME_MAX_LEN);
-  } else {
-    memcpy(mem_allocator_arr[num_allocators].name, name, str_len);
-  }
-  mem_allocator_arr[num_allocators].allocator_id = num_allocators;
-  return prof_header->allocator_entries++;
+  uint32_t index = num_allocators.fetch_add(1, std::memory_order_relaxed);
+  if (index >= MEM_PROFILE_MAX_ALLOCATORS) {
+    ET_LOG(
+        Error,
+        "Out of allocator tracking space. Increase MEM_PROFILE_MAX_ALLOCATORS and re-compile");
+    return static_cast<uint32_t>(-1);
+  }
+  copy_name(mem_allocator_arr[index].name, name);
+  mem_allocator_arr[index].allocator_id = index;
+  return index;
 }
 
 void profiling_create_block(const char* name) {
-  // If the current profiling block is not used then continue to use this, if
-  // not move onto the next block.
-  if (prof_header->prof_entries != 0 || prof_header->mem_prof_entries != 0 ||
-      prof_header->allocator_entries != 0 || num_blocks == 0) {
-    num_blocks += 1;
-    ET_CHECK_MSG(
-        num_blocks <= MAX_PROFILE_BLOCKS,
-        "Only %d blocks are supported and they've all been used up but %d is used. Increment MAX_PROFILE_BLOCKS and re-run",
-        MAX_PROFILE_BLOCKS,
-        num_blocks);
-  }
-
+  uint32_t block_id = num_blocks_created.fetch_add(1);
   // Copy over the name of this profiling block.
-  size_t str_len =
-      strlen(name) >= PROF_NAME_MAX_LEN ? PROF_NAME_MAX_LEN : strlen(name);
-  uintptr_t base = (uintptr_t)prof_buf + (num_blocks - 1) * prof_buf_size;
-  prof_header = (prof_header_t*)(base + prof_header_offset);
-  memset(prof_header->name, 0, PROF_NAME_MAX_LEN);
-  memcpy(prof_header->name, name, str_len);
-
-  // Set profiler version for compatiblity checks in the post-processing
-  // tool.
-  prof_header->prof_ver = ET_PROF_VER;
-  // Set the maximum number of entries that this block can support.
-  prof_header->max_prof_entries = MAX_PROFILE_EVENTS;
-  prof_header->max_allocator_entries = MEM_PROFILE_MAX_ALLOCATORS;
-  prof_header->max_mem_prof_entries = MAX_MEM_PROFILE_EVENTS;
-  reset_profile_stats();
-
-  // Set the base addresses for the various profiling entries arrays.
-  prof_arr = (prof_event_t*)(base + prof_events_offset);
-  mem_allocator_arr = (prof_allocator_t*)(base + prof_mem_alloc_info_offset);
-  mem_prof_arr = (mem_prof_event_t*)(base + prof_mem_alloc_events_offset);
+  copy_name(blocks[block_id % MAX_PROFILE_BLOCKS].name, name);
+  tls_block_id = block_id;
 }
 
 void profiler_init(void) {
@@ -19,12 +19,18 @@ namespace executor {
 // tool
 #define ET_PROF_VER 0x00000001
 
-// By default we support profiling upto 1024 perf events. Build
-// targets can override this to increase the profiling buffer size
-// during compilation.
+// By default the profiler keeps the last 1024 perf events of each thread.
+// Build targets can override this to increase the size of the static
+// profiling buffers during compilation, or pass larger buffers to
+// profiler_set_buffers() at runtime.
 #ifndef MAX_PROFILE_EVENTS
 #define MAX_PROFILE_EVENTS 1024
 #endif
+// By default the static profiling buffers hold the perf events of up to 2
+// threads. The events of further threads are dropped.
+#ifndef MAX_PROFILE_THREADS
+#define MAX_PROFILE_THREADS 2
+#endif
 // By default we support profiling upto 1024 memory allocation events.
 // Build targets can choose to override this, which will consequently have
 // the effect of increasing/decreasing the profiling buffer size.
@@ -38,12 +44,12 @@ namespace executor {
 #ifndef MEM_PROFILE_MAX_ALLOCATORS
 #define MEM_PROFILE_MAX_ALLOCATORS 32
 #endif
-// By default we support only one profiling block. If users want to profile
-// something that will be iterated on multiple times then they will have to
-// increment this to support their use case. In post-processing the stats for
-// all these iterations will be consolidated.
+// By default the profiler keeps the last 16 profiling blocks, e.g. one per
+// iteration of something that is profiled multiple times. The perf events of
+// older blocks are dropped. In post-processing the stats for all these
+// iterations will be consolidated.
 #ifndef MAX_PROFILE_BLOCKS
-#define MAX_PROFILE_BLOCKS 2
+#define MAX_PROFILE_BLOCKS 16
 #endif
 
 #define PROF_NAME_MAX_LEN 32
@@ -89,7 +95,9 @@ typedef struct alignas(8) {
 } prof_header_t;
 
 /*
-This is what the layout of the profiling buffer looks like.
+This is what the layout of each block of the profiling results returned by
+dump_profile_stats() looks like. The max_*_entries of the header are the
+number of entries present in this block.
 ---------------------------------------
 | Profiling header                    |
 ---------------------------------------
@@ -101,8 +109,9 @@ This is what the layout of the profiling buffer looks like.
 ---------------------------------------
 */
 
-// offsets of the various sections in the profiling buffer
-// Total size required for profiling buffer
+// offsets of the various sections in a block with the maximum number of
+// entries
+// Total size required for such a block
 constexpr uint32_t prof_buf_size = sizeof(prof_header_t) +
     sizeof(prof_event_t) * MAX_PROFILE_EVENTS +
     sizeof(mem_prof_event_t) * MAX_MEM_PROFILE_EVENTS +
@@ -119,23 +128,47 @@ constexpr size_t prof_mem_alloc_events_offset = prof_mem_alloc_info_offset +
 // statically allocated buffer declared in the profiler module.
 void profiler_init(void);
 
+// Makes the profiler record perf events into `event_buffer`, in a ring of up
+// to `max_events_per_thread` events for each thread that profiles, rounded
+// down to a power of two, and dump them into `dump_buffer`. Discards the
+// events recorded so far. Must not be called while other threads profile.
+void profiler_set_buffers(
+    void* event_buffer,
+    size_t event_buffer_size,
+    uint32_t max_events_per_thread,
+    void* dump_buffer,
+    size_t dump_buffer_size);
+
 // This starts the profiling of this event and returns a token
-// by which this event can be referred to in the future.
+// by which this event can be referred to in the future. `name` is not
+// copied until dump_profile_stats(), so it must outlive the next dump, as
+// string literals do. Recording takes no lock: each thread records into a
+// ring of its own, which overwrites its oldest events when it is full.
 uint32_t begin_profiling(const char* name);
 
-// End profiling event represented by token_id
+// End profiling event represented by token_id, on the thread that began it.
 void end_profiling(uint32_t token_id);
 
 // Dump profiler results, return pointer to prof event array and number of
-// events in it.
+// events in it. The events of all threads are merged in the order they
+// started, block by block. The results stay valid until the next call to
+// dump_profile_stats() or profiler_set_buffers(). Must not be called while
+// other threads profile.
 void dump_profile_stats(prof_result_t* prof_result);
 
+// Discards the perf and memory allocation events recorded so far.
 void reset_profile_stats();
 
+// Number of perf and memory allocation events dropped because the rings,
+// blocks or dump buffer were full, since the last reset.
+uint64_t profiler_num_dropped_events();
+
 void track_allocation(int32_t id, uint32_t size);
 
 uint32_t track_allocator(const char* name);
 
+// Starts a new profiling block, of the calling thread. Threads that never
+// created a block record into the last block created by any thread.
 void profiling_create_block(const char* name);
 
 // This class enables scope based profiling where needed. Profiling
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <executorch/runtime/platform/profiler.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using namespace torch::executor;
+
+namespace {
+
+constexpr uint32_t kEventsPerThread = 8;
+
+struct DumpBlock {
+  const prof_header_t* header;
+  const prof_event_t* events;
+  const prof_allocator_t* allocators;
+  const mem_prof_event_t* mem_events;
+};
+
+// Walks the blocks of a dump like profiler/parse_profiler_results.py.
+std::vector<DumpBlock> parse_dump(const prof_result_t& result) {
+  std::vector<DumpBlock> blocks;
+  const uint8_t* data = result.prof_data;
+  for (uint32_t i = 0; i < result.num_blocks; i++) {
+    DumpBlock block;
+    block.header = (const prof_header_t*)data;
+    data += sizeof(prof_header_t);
+    block.events = (const prof_event_t*)data;
+    data += sizeof(prof_event_t) * block.header->max_prof_entries;
+    block.allocators = (const prof_allocator_t*)data;
+    data += sizeof(prof_allocator_t) * block.header->max_allocator_entries;
+    block.mem_events = (const mem_prof_event_t*)data;
+    data += sizeof(mem_prof_event_t) * block.header->max_mem_prof_entries;
+    blocks.push_back(block);
+  }
+  EXPECT_EQ(data - result.prof_data, result.num_bytes);
+  return blocks;
+}
+
+std::string event_name(const prof_event_t& event) {
+  return std::string(event.name, strnlen(event.name, PROF_NAME_MAX_LEN));
+}
+
+class ProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    runtime_init();
+    profiler_set_buffers(
+        event_buf_,
+        sizeof(event_buf_),
+        kEventsPerThread,
+        dump_buf_,
+        sizeof(dump_buf_));
+  }
+
+  alignas(8) uint8_t event_buf_[4096];
+  alignas(8) uint8_t dump_buf_[8192];
+};
+
+} // namespace
+
+TEST_F(ProfilerTest, RecordsEventsOfABlock) {
+  profiling_create_block("run");
+  uint32_t outer = begin_profiling("outer");
+  uint32_t inner = begin_profiling("inner");
+  end_profiling(inner);
+  end_profiling(outer);
+
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 1);
+  EXPECT_STREQ(blocks[0].header->name, "run");
+  EXPECT_EQ(blocks[0].header->prof_ver, ET_PROF_VER);
+  ASSERT_EQ(blocks[0].header->prof_entries, 2);
+  EXPECT_EQ(event_name(blocks[0].events[0]), "outer");
+  EXPECT_EQ(event_name(blocks[0].events[1]), "inner");
+  for (int i = 0; i < 2; i++) {
+    EXPECT_LE(blocks[0].events[i].start_time, blocks[0].events[i].end_time);
+  }
+  EXPECT_EQ(profiler_num_dropped_events(), 0);
+}
+
+TEST_F(ProfilerTest, RingKeepsTheLatestEvents) {
+  profiling_create_block("run");
+  const char* names[] = {"e0", "e1", "e2", "e3", "e4", "e5", "e6", "e7",
+                         "e8", "e9", "e10", "e11"};
+  for (const char* name : names) {
+    end_profiling(begin_profiling(name));
+  }
+  uint32_t stale = begin_profiling("stale");
+  for (uint32_t i = 0; i < kEventsPerThread; i++) {
+    end_profiling(begin_profiling("new"));
+  }
+  // The event was overwritten, so ending it must not touch the ring.
+  end_profiling(stale);
+
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 1);
+  ASSERT_EQ(blocks[0].header->prof_entries, kEventsPerThread);
+  for (uint32_t i = 0; i < kEventsPerThread; i++) {
+    EXPECT_EQ(event_name(blocks[0].events[i]), "new");
+    EXPECT_NE(blocks[0].events[i].end_time, 0);
+  }
+  EXPECT_EQ(profiler_num_dropped_events(), 13);
+
+  reset_profile_stats();
+  EXPECT_EQ(profiler_num_dropped_events(), 0);
+  dump_profile_stats(&result);
+  EXPECT_EQ(result.num_blocks, 0);
+}
+
+TEST_F(ProfilerTest, KeepsMoreThanTwoBlocks) {
+  const char* block_names[] = {"block0", "block1", "block2", "block3"};
+  for (const char* name : block_names) {
+    profiling_create_block(name);
+    end_profiling(begin_profiling(name));
+  }
+
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 4);
+  for (size_t i = 0; i < blocks.size(); i++) {
+    EXPECT_STREQ(blocks[i].header->name, block_names[i]);
+    ASSERT_EQ(blocks[i].header->prof_entries, 1);
+    EXPECT_EQ(event_name(blocks[i].events[0]), block_names[i]);
+  }
+}
+
+TEST_F(ProfilerTest, TracksAllocationsPerBlock) {
+  uint32_t allocator = track_allocator("planned");
+  profiling_create_block("first");
+  track_allocation(allocator, 16);
+  profiling_create_block("second");
+  track_allocation(allocator, 32);
+  track_allocation(allocator, 64);
+
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 2);
+  ASSERT_GE(blocks[0].header->allocator_entries, 1);
+  ASSERT_EQ(blocks[0].header->mem_prof_entries, 1);
+  EXPECT_EQ(blocks[0].mem_events[0].allocation_size, 16);
+  ASSERT_EQ(blocks[1].header->mem_prof_entries, 2);
+  EXPECT_EQ(blocks[1].mem_events[0].allocation_size, 32);
+  EXPECT_EQ(blocks[1].mem_events[1].allocation_size, 64);
+  EXPECT_EQ(blocks[1].mem_events[1].allocator_id, allocator);
+}
+
+TEST_F(ProfilerTest, MergesThreadsByStartTime) {
+  profiling_create_block("run");
+  uint32_t token = begin_profiling("main");
+  std::thread worker([] {
+    // Follows the block created by the main thread.
+    for (int i = 0; i < 3; i++) {
+      end_profiling(begin_profiling("worker"));
+    }
+  });
+  worker.join();
+  end_profiling(token);
+
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 1);
+  ASSERT_EQ(blocks[0].header->prof_entries, 4);
+  EXPECT_EQ(event_name(blocks[0].events[0]), "main");
+  for (int i = 1; i < 4; i++) {
+    EXPECT_EQ(event_name(blocks[0].events[i]), "worker");
+    EXPECT_LE(
+        blocks[0].events[i - 1].start_time, blocks[0].events[i].start_time);
+  }
+}
+
+TEST_F(ProfilerTest, DropsEventsOfThreadsWithoutARing) {
+  // Room for a single ring.
+  profiler_set_buffers(
+      event_buf_, 64 * kEventsPerThread, kEventsPerThread, dump_buf_, 4096);
+  profiling_create_block("run");
+  end_profiling(begin_profiling("main"));
+  std::thread worker([] { end_profiling(begin_profiling("worker")); });
+  worker.join();
+
+  EXPECT_EQ(profiler_num_dropped_events(), 1);
+  prof_result_t result;
+  dump_profile_stats(&result);
+  std::vector<DumpBlock> blocks = parse_dump(result);
+  ASSERT_EQ(blocks.size(), 1);
+  ASSERT_EQ(blocks[0].header->prof_entries, 1);
+  EXPECT_EQ(event_name(blocks[0].events[0]), "main");
+}
@@ -65,6 +65,16 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "profiler_test",
+        srcs = [
+            "profiler_test.cpp",
+        ],
+        deps = [
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
     runtime.cxx_test(
         name = "logging_test",
         srcs = [
@@ -8,9 +8,11 @@
 
 #include <executorch/sdk/bundled_program/bundled_program.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 
 #ifdef USE_ATEN_LIB
 #include <ATen/ATen.h>
@@ -78,6 +80,10 @@ TensorImpl impl_like(bundled_program_flatbuffer::Tensor* bundled_tensor) {
  *
  * T must be a floating point type. Non-floating point data should be compared
  * directly.
+ *
+ * Elements are compared without branches, a block at a time, so that the
+ * compiler can vectorize the comparison; mismatches are only checked for at
+ * the end of each block.
  */
 template <
     typename T,
@@ -88,27 +94,27 @@ bool data_is_close(
     size_t numel,
     double rtol,
     double atol) {
-  for (size_t i = 0; i < numel; i++) {
-    const auto ai = a[i];
-    const auto bi = b[i];
-
-    if (std::isnan(ai) && std::isnan(bi)) {
+  constexpr size_t kBlockSize = 256;
+  const T t_rtol = static_cast<T>(rtol);
+  const T t_atol = static_cast<T>(atol);
+  const T max_error = std::numeric_limits<T>::max();
+  for (size_t start = 0; start < numel; start += kBlockSize) {
+    const size_t end = std::min(numel, start + kBlockSize);
+    bool close = true;
+    for (size_t i = start; i < end; i++) {
+      const T ai = a[i];
+      const T bi = b[i];
+      const T actual_error = std::abs(ai - bi);
+      const T allowed_error = t_atol + std::abs(t_rtol * bi);
       // NaN == NaN
-    } else if (
-        !std::isfinite(ai) && !std::isfinite(bi) && ((ai > 0) == (bi > 0))) {
-      // -Inf == -Inf
-      // +Inf == +Inf
-    } else if (rtol == 0 && atol == 0) {
-      // Exact comparison; avoid unnecessary math.
-      if (ai != bi) {
-        return false;
-      }
-    } else {
-      auto allowed_error = atol + std::abs(rtol * bi);
-      auto actual_error = std::abs(ai - bi);
-      if (!std::isfinite(actual_error) || actual_error > allowed_error) {
-        return false;
-      }
+      const bool both_nan = (ai != ai) & (bi != bi);
+      // Also covers -Inf == -Inf and +Inf == +Inf, and exact comparison when
+      // rtol and atol are 0. An infinite or NaN error is never allowed.
+      close &= (ai == bi) | both_nan |
+          ((actual_error <= allowed_error) & (actual_error <= max_error));
+    }
+    if (!close) {
+      return false;
     }
   }
   return true;
@@ -189,8 +195,7 @@ bool tensors_are_close(
 Result<bundled_program_flatbuffer::BundledMethodTestSuite*>
 get_method_test_suite(
     const bundled_program_flatbuffer::BundledProgram* bundled_program,
-    Method& method) {
-  const char* method_name = method.method_meta().name();
+    const char* method_name) {
   auto method_test_suites = bundled_program->method_test_suites();
   for (size_t i = 0; i < method_test_suites->size(); i++) {
     auto m_test = method_test_suites->GetMutableObject(i);
@@ -204,11 +209,34 @@ get_method_test_suite(
 
 } // namespace
 
-// Load testset_idx-th bundled data into the Method
-__ET_NODISCARD Error LoadBundledInput(
+__ET_NODISCARD Result<size_t> GetNumTestSets(
+    serialized_bundled_program* bundled_program_ptr,
+    const char* method_name) {
+  ET_CHECK_OR_RETURN_ERROR(
+      bundled_program_flatbuffer::BundledProgramBufferHasIdentifier(
+          bundled_program_ptr),
+      NotSupported,
+      "The input buffer should be a bundled program.");
+
+  auto method_test = get_method_test_suite(
+      bundled_program_flatbuffer::GetBundledProgram(bundled_program_ptr),
+      method_name);
+
+  if (!method_test.ok()) {
+    return method_test.error();
+  }
+  return static_cast<size_t>(method_test.get()->test_cases()->size());
+}
+
+namespace {
+
+// Load testset_idx-th bundled data into the Method, sharing the data of tensor
+// inputs with the Method rather than copying it if share_tensors is true.
+__ET_NODISCARD Error load_bundled_input(
     Method& method,
     serialized_bundled_program* bundled_program_ptr,
-    size_t testset_idx) {
+    size_t testset_idx,
+    bool share_tensors) {
   ET_CHECK_OR_RETURN_ERROR(
       bundled_program_flatbuffer::BundledProgramBufferHasIdentifier(
           bundled_program_ptr),
@@ -217,12 +245,18 @@ __ET_NODISCARD Error LoadBundledInput(
 
   auto method_test = get_method_test_suite(
       bundled_program_flatbuffer::GetBundledProgram(bundled_program_ptr),
-      method);
+      method.method_meta().name());
 
   if (!method_test.ok()) {
     return method_test.error();
   }
 
+  ET_CHECK_OR_RETURN_ERROR(
+      testset_idx < method_test.get()->test_cases()->size(),
+      InvalidArgument,
+      "Testset %zu out of range, the Method has %zu",
+      testset_idx,
+      static_cast<size_t>(method_test.get()->test_cases()->size()));
   auto bundled_inputs =
       method_test.get()->test_cases()->Get(testset_idx)->inputs();
 
@@ -244,6 +278,8 @@ __ET_NODISCARD Error LoadBundledInput(
 
 #ifdef USE_ATEN_LIB
         Tensor t = tensor_like(bundled_input_tensor);
+        // t owns a copy of the bundled data, so it can't be shared.
+        share_tensors = false;
 #else // !USE_ATEN_LIB
         TensorImpl impl = impl_like(bundled_input_tensor);
         Tensor t = Tensor(&impl);
@@ -255,8 +291,13 @@ __ET_NODISCARD Error LoadBundledInput(
         // not the pointer of impl, Tensor t or even the Evalue e_input. So
         // their lifetime will not impact the safety. Also there's a specific
         // memory space with enough lifetime holding the underlying data blob,
-        // so the lifetime of the data blob is not an issue.
-        status = method.set_input(e_input, input_idx);
+        // so the lifetime of the data blob is not an issue. The same holds
+        // when the Method shares the data blob.
+        if (share_tensors && t.nbytes() > 0) {
+          status = method.experimental_share_input(e_input, input_idx);
+        } else {
+          status = method.set_input(e_input, input_idx);
+        }
         break;
       }
       case bundled_program_flatbuffer::ValueUnion::Int: {
@@ -300,6 +341,24 @@ __ET_NODISCARD Error LoadBundledInput(
   return Error::Ok;
 }
 
+} // namespace
+
+__ET_NODISCARD Error LoadBundledInput(
+    Method& method,
+    serialized_bundled_program* bundled_program_ptr,
+    size_t testset_idx) {
+  return load_bundled_input(
+      method, bundled_program_ptr, testset_idx, /*share_tensors=*/false);
+}
+
+__ET_NODISCARD Error LoadBundledInputZeroCopy(
+    Method& method,
+    serialized_bundled_program* bundled_program_ptr,
+    size_t testset_idx) {
+  return load_bundled_input(
+      method, bundled_program_ptr, testset_idx, /*share_tensors=*/true);
+}
+
 __ET_NODISCARD Error VerifyResultWithBundledExpectedOutput(
     Method& method,
     serialized_bundled_program* bundled_program_ptr,
@@ -314,12 +373,18 @@ __ET_NODISCARD Error VerifyResultWithBundledExpectedOutput(
 
   auto method_test = get_method_test_suite(
       bundled_program_flatbuffer::GetBundledProgram(bundled_program_ptr),
-      method);
+      method.method_meta().name());
 
   if (!method_test.ok()) {
     return method_test.error();
   }
 
+  ET_CHECK_OR_RETURN_ERROR(
+      testset_idx < method_test.get()->test_cases()->size(),
+      InvalidArgument,
+      "Testset %zu out of range, the Method has %zu",
+      testset_idx,
+      static_cast<size_t>(method_test.get()->test_cases()->size()));
   auto bundled_expected_outputs =
       method_test.get()->test_cases()->Get(testset_idx)->expected_outputs();
 
@@ -361,6 +426,36 @@ __ET_NODISCARD Error VerifyResultWithBundledExpectedOutput(
   return Error::Ok;
 }
 
+__ET_NODISCARD Result<size_t> VerifyAllBundledTestSets(
+    Method& method,
+    serialized_bundled_program* bundled_program_ptr,
+    bool share_inputs,
+    double rtol,
+    double atol) {
+  Result<size_t> num_testsets =
+      GetNumTestSets(bundled_program_ptr, method.method_meta().name());
+  if (!num_testsets.ok()) {
+    return num_testsets.error();
+  }
+
+  size_t num_mismatched = 0;
+  for (size_t testset_idx = 0; testset_idx < num_testsets.get();
+       testset_idx++) {
+    ET_CHECK_OK_OR_RETURN_ERROR(load_bundled_input(
+        method, bundled_program_ptr, testset_idx, share_inputs));
+    ET_CHECK_OK_OR_RETURN_ERROR(
+        method.execute(), "Execution of testset %zu failed", testset_idx);
+    Error status = VerifyResultWithBundledExpectedOutput(
+        method, bundled_program_ptr, testset_idx, rtol, atol);
+    if (status == Error::NotFound) {
+      num_mismatched++;
+    } else if (status != Error::Ok) {
+      return status;
+    }
+  }
+  return num_mismatched;
+}
+
 __ET_NODISCARD Error GetProgramData(
     void* file_data,
     size_t file_data_len,
@@ -20,6 +20,21 @@ namespace bundled_program {
  */
 using serialized_bundled_program = const void;
 
+/**
+ * Gets the number of bundled testsets of a Method, without loading it.
+ *
+ * @param[in] bundled_program_ptr The bundled program contains the testsets.
+ * @param[in] method_name The name of the Method whose testsets are counted.
+ *
+ * @returns The number of testsets, which bounds the testset_idx of
+ * LoadBundledInput() and VerifyResultWithBundledExpectedOutput(), or
+ * Error::InvalidArgument if the bundled program has no testsets for the
+ * Method.
+ */
+__ET_NODISCARD Result<size_t> GetNumTestSets(
+    serialized_bundled_program* bundled_program_ptr,
+    const char* method_name);
+
 /**
  * Load testset_idx-th bundled input of method_idx-th Method test in
  * bundled_program_ptr to given Method.
@@ -36,6 +51,31 @@ __ET_NODISCARD Error LoadBundledInput(
     serialized_bundled_program* bundled_program_ptr,
     size_t testset_idx);
 
+/**
+ * Like LoadBundledInput(), but points the Method's tensor inputs at the
+ * bundled data instead of copying it into them, see
+ * Method::experimental_share_input(). Saves a copy per input when running many
+ * testsets.
+ *
+ * NOTE: Kernels that write to their inputs write to the bundled program, and
+ * later calls to LoadBundledInput() copy into the bundled data, so use this
+ * function for all the testsets run on a Method once it is used.
+ *
+ * NOTE: Prototype API; subject to change.
+ *
+ * @param[in] method The Method to verify.
+ * @param[in] bundled_program_ptr The bundled program contains expected output.
+ *     It must outlive the executions of the Method that use its inputs.
+ * @param[in] testset_idx  The index of input needs to be set into given Method.
+ *
+ * @returns Return Error::Ok if load successfully, or the error happens during
+ * execution.
+ */
+__ET_NODISCARD Error LoadBundledInputZeroCopy(
+    Method& method,
+    serialized_bundled_program* bundled_program_ptr,
+    size_t testset_idx);
+
 /**
  * Compare the Method's output with testset_idx-th bundled expected
  * output in method_idx-th Method test.
@@ -56,6 +96,27 @@ __ET_NODISCARD Error VerifyResultWithBundledExpectedOutput(
     double rtol = 1e-5,
     double atol = 1e-8);
 
+/**
+ * Runs all of the bundled testsets of the Method, i.e. loads the inputs of
+ * each, executes the Method and compares its outputs with the expected ones.
+ *
+ * @param[in] method The Method to verify.
+ * @param[in] bundled_program_ptr The bundled program contains the testsets.
+ * @param[in] share_inputs Whether to load the inputs with
+ *     LoadBundledInputZeroCopy() rather than LoadBundledInput().
+ * @param[in] rtol Relative tolerance used for data comparsion.
+ * @param[in] atol Absolute tolerance used for data comparsion.
+ *
+ * @returns The number of testsets whose outputs mismatched the expected ones,
+ * or the error that happened while loading or executing a testset.
+ */
+__ET_NODISCARD Result<size_t> VerifyAllBundledTestSets(
+    Method& method,
+    serialized_bundled_program* bundled_program_ptr,
+    bool share_inputs = false,
+    double rtol = 1e-5,
+    double atol = 1e-8);
+
 /**
  * Finds the serialized ExecuTorch program data in the provided bundled program
  * file data.
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/sdk/etdump/chrome_trace.h>
+
+#include <inttypes.h>
+#include <cstdarg>
+#include <algorithm>
+
+#include <executorch/runtime/platform/clock.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/sdk/etdump/etdump_schema_flatcc_reader.h>
+
+namespace torch {
+namespace executor {
+
+namespace {
+
+// Process ids of the lanes of CPU threads and of delegate events that were
+// not timed on a thread.
+constexpr int kThreadsPid = 0;
+constexpr int kDelegatesPid = 1;
+
+class TraceWriter {
+ public:
+  explicit TraceWriter(FILE* out) : out_(out) {}
+
+  bool ok() const {
+    return ok_;
+  }
+
+  __ET_PRINTFLIKE(2, 3) void print(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (vfprintf(out_, format, args) < 0) {
+      ok_ = false;
+    }
+    va_end(args);
+  }
+
+  // Starts a new element of the traceEvents array.
+  void begin_event() {
+    print(first_event_ ? "\n" : ",\n");
+    first_event_ = false;
+  }
+
+  // Writes `str` as a JSON string.
+  void string(const char* str) {
+    if (fputc('"', out_) == EOF) {
+      ok_ = false;
+    }
+    for (const char* c = str; *c != '\0'; ++c) {
+      const unsigned char ch = static_cast<unsigned char>(*c);
+      if (ch == '"' || ch == '\\') {
+        print("\\%c", ch);
+      } else if (ch < 0x20) {
+        print("\\u%04x", ch);
+      } else if (fputc(ch, out_) == EOF) {
+        ok_ = false;
+      }
+    }
+    if (fputc('"', out_) == EOF) {
+      ok_ = false;
+    }
+  }
+
+  void metadata(const char* type, int pid, uint64_t tid, const char* name) {
+    begin_event();
+    print(
+        "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%" PRIu64
+        ",\"args\":{\"name\":",
+        type,
+        pid,
+        tid);
+    string(name);
+    print("}}");
+  }
+
+ private:
+  FILE* out_;
+  bool ok_ = true;
+  bool first_event_ = true;
+};
+
+// Chrome traces are in microseconds.
+double ticks_to_us(uint64_t ticks) {
+  return static_cast<double>(ticks_to_ns(ticks)) / 1000.0;
+}
+
+const char* string_or(flatbuffers_string_t str, const char* fallback) {
+  return str != nullptr ? str : fallback;
+}
+
+void write_profile_event(
+    TraceWriter& writer,
+    etdump_ProfileEvent_table_t event,
+    const char* block_name) {
+  const uint64_t thread_id = etdump_ProfileEvent_thread_id(event);
+  flatbuffers_string_t delegate_id_str =
+      etdump_ProfileEvent_delegate_debug_id_str(event);
+  const int32_t delegate_id_int =
+      etdump_ProfileEvent_delegate_debug_id_int(event);
+  const bool is_delegate = delegate_id_str != nullptr || delegate_id_int != -1;
+
+  writer.begin_event();
+  writer.print("{\"name\":");
+  if (delegate_id_str != nullptr) {
+    writer.string(delegate_id_str);
+  } else if (delegate_id_int != -1) {
+    writer.print("\"delegate %" PRId32 "\"", delegate_id_int);
+  } else {
+    writer.string(string_or(etdump_ProfileEvent_name(event), "unnamed"));
+  }
+  const uint64_t start_time = etdump_ProfileEvent_start_time(event);
+  const uint64_t end_time =
+      std::max(etdump_ProfileEvent_end_time(event), start_time);
+  writer.print(
+      ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%" PRIu64
+      ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"block\":",
+      is_delegate ? "delegate" : "operator",
+      thread_id != 0 ? kThreadsPid : kDelegatesPid,
+      thread_id,
+      ticks_to_us(start_time),
+      ticks_to_us(end_time) - ticks_to_us(start_time));
+  writer.string(block_name);
+  writer.print(
+      ",\"instruction_id\":%" PRId32 ",\"chain_index\":%" PRId32,
+      etdump_ProfileEvent_instruction_id(event),
+      etdump_ProfileEvent_chain_index(event));
+  etdump_PerfCounters_struct_t counters =
+      etdump_ProfileEvent_perf_counters(event);
+  if (counters != nullptr) {
+    writer.print(
+        ",\"cycles\":%" PRIu64 ",\"instructions\":%" PRIu64
+        ",\"l1d_cache_misses\":%" PRIu64 ",\"ll_cache_misses\":%" PRIu64
+        ",\"stalled_cycles\":%" PRIu64,
+        etdump_PerfCounters_cycles(counters),
+        etdump_PerfCounters_instructions(counters),
+        etdump_PerfCounters_l1d_cache_misses(counters),
+        etdump_PerfCounters_ll_cache_misses(counters),
+        etdump_PerfCounters_stalled_cycles(counters));
+  }
+  writer.print("}}");
+}
+
+} // namespace
+
+Error write_chrome_trace(
+    const void* etdump_data,
+    size_t etdump_size,
+    FILE* out) {
+  ET_CHECK_OR_RETURN_ERROR(out != nullptr, InvalidArgument, "No output file");
+  ET_CHECK_OR_RETURN_ERROR(
+      etdump_data != nullptr && etdump_size > sizeof(flatbuffers_uoffset_t),
+      InvalidArgument,
+      "Empty ETDump");
+  size_t size = 0;
+  const void* buf =
+      flatbuffers_read_size_prefix(const_cast<void*>(etdump_data), &size);
+  ET_CHECK_OR_RETURN_ERROR(
+      size <= etdump_size - sizeof(flatbuffers_uoffset_t),
+      InvalidArgument,
+      "ETDump of %zu bytes is truncated to %zu bytes",
+      size,
+      etdump_size);
+  etdump_ETDump_table_t etdump =
+      etdump_ETDump_as_root_with_identifier(buf, etdump_ETDump_file_identifier);
+  ET_CHECK_OR_RETURN_ERROR(
+      etdump != nullptr, InvalidArgument, "Not an ETDump buffer");
+
+  TraceWriter writer(out);
+  writer.print("{\"traceEvents\":[");
+  writer.metadata("process_name", kThreadsPid, 0, "ExecuTorch");
+  writer.metadata("process_name", kDelegatesPid, 0, "Delegates");
+  writer.metadata("thread_name", kDelegatesPid, 0, "Device timestamps");
+
+  etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(etdump);
+  const size_t num_blocks = etdump_RunData_vec_len(run_data_vec);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    etdump_RunData_table_t run_data = etdump_RunData_vec_at(run_data_vec, i);
+    const char* block_name = string_or(etdump_RunData_name(run_data), "");
+    etdump_Event_vec_t events = etdump_RunData_events(run_data);
+    const size_t num_events = etdump_Event_vec_len(events);
+
+    // The block spans the events of the first thread that ran one, which is
+    // the thread that executed the method.
+    uint64_t block_thread_id = 0;
+    uint64_t block_start = UINT64_MAX;
+    uint64_t block_end = 0;
+    for (size_t j = 0; j < num_events; ++j) {
+      etdump_ProfileEvent_table_t event =
+          etdump_Event_profile_event(etdump_Event_vec_at(events, j));
+      if (event == nullptr) {
+        continue;
+      }
+      write_profile_event(writer, event, block_name);
+      const uint64_t thread_id = etdump_ProfileEvent_thread_id(event);
+      if (thread_id == 0) {
+        continue;
+      }
+      if (block_thread_id == 0) {
+        block_thread_id = thread_id;
+      }
+      if (thread_id == block_thread_id) {
+        block_start =
+            std::min(block_start, etdump_ProfileEvent_start_time(event));
+        block_end = std::max(block_end, etdump_ProfileEvent_end_time(event));
+      }
+    }
+    if (block_thread_id != 0 && block_start <= block_end) {
+      writer.begin_event();
+      writer.print("{\"name\":");
+      writer.string(block_name);
+      writer.print(
+          ",\"cat\":\"block\",\"ph\":\"X\",\"pid\":%d,\"tid\":%" PRIu64
+          ",\"ts\":%.3f,\"dur\":%.3f}",
+          kThreadsPid,
+          block_thread_id,
+          ticks_to_us(block_start),
+          ticks_to_us(block_end) - ticks_to_us(block_start));
+    }
+  }
+  writer.print("\n],\"displayTimeUnit\":\"ns\"}\n");
+
+  ET_CHECK_OR_RETURN_ERROR(
+      writer.ok(), AccessFailed, "Failed to write the Chrome trace");
+  return Error::Ok;
+}
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <cstddef>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Writes the profiling events of an ETDump, as returned by
+ * ETDumpGen::get_etdump_data(), to `out` as Chrome trace event JSON, which
+ * chrome://tracing and https://ui.perfetto.dev open. This lets a device write
+ * a trace without the Python Inspector.
+ *
+ * Each thread that ran events gets a lane, where the events of delegates
+ * nest under the operator calls that ran them, and each event block spans
+ * its events. Delegate events logged without a thread, e.g. with the
+ * timestamps of an accelerator, go to a lane of their own. Timestamps are
+ * converted with the tick rate of this platform, so the trace must be written
+ * on the device that profiled the events.
+ *
+ * @returns Error::InvalidArgument if `etdump_data` is not an ETDump, or
+ * Error::AccessFailed if writing to `out` fails.
+ */
+__ET_NODISCARD Error
+write_chrome_trace(const void* etdump_data, size_t etdump_size, FILE* out);
+
+} // namespace executor
+} // namespace torch
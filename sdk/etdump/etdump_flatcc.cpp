@@ -12,6 +12,13 @@
 #include <flatcc/flatcc_types.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
 #include "executorch/runtime/core/exec_aten/exec_aten.h"
 #include "executorch/runtime/core/exec_aten/util/scalar_type_util.h"
 #include "executorch/runtime/platform/assert.h"
@@ -52,7 +59,10 @@ executorch_flatbuffer_ScalarType_enum_t get_flatbuffer_scalar_type(
 etdump_Tensor_ref_t add_tensor_entry(
     flatcc_builder_t* builder,
     const exec_aten::Tensor& tensor,
-    long offset) {
+    long offset,
+    etdump_TensorCompression_enum_t compression =
+        etdump_TensorCompression_None,
+    const uint64_t* checksum = nullptr) {
   etdump_Tensor_start(builder);
 
   etdump_Tensor_scalar_type_add(
@@ -72,10 +82,101 @@ etdump_Tensor_ref_t add_tensor_entry(
   }
   etdump_Tensor_strides_end(builder);
   etdump_Tensor_offset_add(builder, offset);
+  if (compression != etdump_TensorCompression_None) {
+    etdump_Tensor_compression_add(builder, compression);
+  }
+  if (checksum != nullptr) {
+    etdump_Tensor_checksum_add(builder, *checksum);
+  }
 
   return etdump_Tensor_end(builder);
 }
 
+// FNV-1a over the 8-byte little-endian words of the data, the last one padded
+// with zeros, starting from the size, with a xorshift to mix the high bits
+// into the low ones. Mirrored by tensor_checksum() of
+// sdk/inspector/_inspector_utils.py.
+uint64_t tensor_checksum(const void* data, size_t nbytes) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = 0xcbf29ce484222325 ^ static_cast<uint64_t>(nbytes);
+  for (size_t i = 0; i < nbytes; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, std::min(sizeof(uint64_t), nbytes - i));
+    hash = (hash ^ word) * kPrime;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
+
+// Zero runs shorter than this are kept as literals, since a record costs
+// 8 bytes.
+constexpr size_t kMinZeroRun = 16;
+
+// Encodes `data` for ETDumpTensorMode::kCompress, as records of the number of
+// zero bytes and the number of literal bytes that follow, as uint32_t, then
+// the literal bytes. Returns the size of the encoding, or 0 if it does not fit
+// in `capacity`.
+size_t zero_run_length_encode(
+    const uint8_t* data,
+    size_t size,
+    uint8_t* out,
+    size_t capacity) {
+  size_t in = 0;
+  size_t out_size = 0;
+  while (in < size) {
+    size_t zeros_end = in;
+    while (zeros_end < size && data[zeros_end] == 0 &&
+           zeros_end - in < UINT32_MAX) {
+      zeros_end++;
+    }
+    // The literals end before the next long enough run of zeros.
+    size_t literals_end = zeros_end;
+    size_t num_trailing_zeros = 0;
+    while (literals_end < size && num_trailing_zeros < kMinZeroRun &&
+           literals_end - zeros_end < UINT32_MAX) {
+      num_trailing_zeros = data[literals_end] == 0 ? num_trailing_zeros + 1 : 0;
+      literals_end++;
+    }
+    if (num_trailing_zeros == kMinZeroRun) {
+      literals_end -= num_trailing_zeros;
+    }
+    const size_t num_literals = literals_end - zeros_end;
+    const uint32_t record[2] = {
+        static_cast<uint32_t>(zeros_end - in),
+        static_cast<uint32_t>(num_literals)};
+    if (out_size + sizeof(record) + num_literals > capacity) {
+      return 0;
+    }
+    memcpy(out + out_size, record, sizeof(record));
+    memcpy(out + out_size + sizeof(record), data + zeros_end, num_literals);
+    out_size += sizeof(record) + num_literals;
+    in = literals_end;
+  }
+  return out_size;
+}
+
+// The event id of the events that the sampling mode skips.
+constexpr int64_t kUnsampledEventId = INT64_MIN;
+
+// Id of the calling thread, the same as the OS tools use where available.
+// Platforms without threads, e.g. microcontrollers, run everything on thread 1.
+uint64_t current_thread_id() {
+#if defined(__linux__)
+  static thread_local uint64_t thread_id = 0;
+  if (thread_id == 0) {
+    thread_id = static_cast<uint64_t>(syscall(SYS_gettid));
+  }
+  return thread_id;
+#elif defined(__APPLE__)
+  uint64_t thread_id = 0;
+  pthread_threadid_np(nullptr, &thread_id);
+  return thread_id;
+#else
+  return 1;
+#endif
+}
+
 static uint8_t* alignPointer(void* ptr, size_t alignment) {
   intptr_t addr = reinterpret_cast<intptr_t>(ptr);
   if ((addr & (alignment - 1)) == 0) {
@@ -125,6 +226,7 @@ ETDumpGen::~ETDumpGen() {
 void ETDumpGen::reset() {
   etdump_gen_state = ETDumpGen_Init;
   num_blocks = 0;
+  num_pending_traffic = 0;
   flatcc_builder_reset(builder);
   flatbuffers_buffer_start(builder, etdump_ETDump_file_identifier);
   etdump_ETDump_start_as_root_with_size(builder);
@@ -134,6 +236,21 @@ void ETDumpGen::reset() {
 }
 
 void ETDumpGen::create_event_block(const char* name) {
+  if (is_sampling()) {
+    is_block_sampled =
+        num_seen_blocks++ % sampling_config.block_period == 0;
+    sampled_block_name = name;
+    return;
+  }
+  if (is_streaming()) {
+    if (num_blocks >= stream_blocks_per_flush) {
+      // All the blocks are complete, so the write needs no new block.
+      (void)write_stream();
+    }
+    if (name != current_block_name) {
+      strncpy(current_block_name, name, sizeof(current_block_name) - 1);
+    }
+  }
   if (etdump_gen_state == ETDumpGen_Adding_Events) {
     etdump_RunData_events_end(builder);
   } else if (etdump_gen_state == ETDumpGen_Done) {
@@ -187,8 +304,17 @@ EventTracerEntry ETDumpGen::start_profiling(
     ChainID chain_id,
     DebugHandle debug_handle) {
   EventTracerEntry prof_entry;
-  prof_entry.event_id = name != nullptr ? create_string_entry(name) : -1;
   prof_entry.delegate_event_id_type = DelegateDebugIdType::kNone;
+  if (is_sampling()) {
+    if (!should_sample_event()) {
+      prof_entry.event_id = kUnsampledEventId;
+      return prof_entry;
+    }
+    prof_entry.event_id =
+        name != nullptr ? reinterpret_cast<intptr_t>(name) : -1;
+  } else {
+    prof_entry.event_id = name != nullptr ? create_string_entry(name) : -1;
+  }
 
   if (chain_id == -1) {
     prof_entry.chain_id = chain_id_;
@@ -197,6 +323,11 @@ EventTracerEntry ETDumpGen::start_profiling(
     prof_entry.chain_id = chain_id;
     prof_entry.debug_handle = debug_handle;
   }
+  // The counters are read before the start time and after the end time, so
+  // that reading them does not add to the duration of the event.
+  if (perf_counters.is_open()) {
+    perf_counters.read(prof_entry.start_counters);
+  }
   prof_entry.start_time = et_pal_current_ticks();
   return prof_entry;
 }
@@ -209,16 +340,29 @@ EventTracerEntry ETDumpGen::start_profiling_delegate(
   ET_CHECK_MSG(
       (name == nullptr) ^ (delegate_debug_index == -1),
       "Only name or delegate_debug_index can be valid. Check DelegateMappingBuilder documentation for more details.");
-  check_ready_to_add_events();
   EventTracerEntry prof_entry;
   DelegateDebugIdType delegate_event_id_type =
       name == nullptr ? DelegateDebugIdType::kInt : DelegateDebugIdType::kStr;
   prof_entry.delegate_event_id_type = delegate_event_id_type;
   prof_entry.chain_id = chain_id_;
   prof_entry.debug_handle = debug_handle_;
-  prof_entry.event_id = delegate_debug_index == static_cast<unsigned int>(-1)
-      ? create_string_entry(name)
-      : delegate_debug_index;
+  if (is_sampling()) {
+    if (!should_sample_event()) {
+      prof_entry.event_id = kUnsampledEventId;
+      return prof_entry;
+    }
+    prof_entry.event_id = delegate_debug_index == static_cast<unsigned int>(-1)
+        ? reinterpret_cast<intptr_t>(name)
+        : delegate_debug_index;
+  } else {
+    check_ready_to_add_events();
+    prof_entry.event_id = delegate_debug_index == static_cast<unsigned int>(-1)
+        ? create_string_entry(name)
+        : delegate_debug_index;
+  }
+  if (perf_counters.is_open()) {
+    perf_counters.read(prof_entry.start_counters);
+  }
   prof_entry.start_time = et_pal_current_ticks();
   return prof_entry;
 }
@@ -227,13 +371,22 @@ void ETDumpGen::end_profiling_delegate(
     EventTracerEntry event_tracer_entry,
     const void* metadata,
     size_t metadata_len) {
+  if (is_sampling()) {
+    if (event_tracer_entry.event_id != kUnsampledEventId) {
+      record_sampled_event(
+          event_tracer_entry, et_pal_current_ticks(), current_thread_id());
+    }
+    return;
+  }
   et_timestamp_t end_time = et_pal_current_ticks();
   check_ready_to_add_events();
 
   // Start building the ProfileEvent entry.
   etdump_ProfileEvent_start(builder);
+  add_perf_counters(event_tracer_entry);
   etdump_ProfileEvent_start_time_add(builder, event_tracer_entry.start_time);
   etdump_ProfileEvent_end_time_add(builder, end_time);
+  etdump_ProfileEvent_thread_id_add(builder, current_thread_id());
   etdump_ProfileEvent_chain_index_add(builder, chain_id_);
   etdump_ProfileEvent_instruction_id_add(builder, debug_handle_);
   // Delegate debug identifier can either be of a string type or an integer
@@ -266,6 +419,21 @@ void ETDumpGen::log_profiling_delegate(
   ET_CHECK_MSG(
       (name == nullptr) ^ (delegate_debug_index == -1),
       "Only name or delegate_debug_index can be valid. Check DelegateMappingBuilder documentation for more details.");
+  if (is_sampling()) {
+    if (should_sample_event()) {
+      EventTracerEntry entry;
+      entry.event_id = name != nullptr ? reinterpret_cast<intptr_t>(name)
+                                       : delegate_debug_index;
+      entry.chain_id = chain_id_;
+      entry.debug_handle = debug_handle_;
+      entry.start_time = start_time;
+      entry.delegate_event_id_type = name != nullptr
+          ? DelegateDebugIdType::kStr
+          : DelegateDebugIdType::kInt;
+      record_sampled_event(entry, end_time, /*thread_id=*/0);
+    }
+    return;
+  }
   check_ready_to_add_events();
   int64_t string_id = name != nullptr ? create_string_entry(name) : -1;
   etdump_ProfileEvent_start(builder);
@@ -289,6 +457,13 @@ void ETDumpGen::log_profiling_delegate(
 }
 
 void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
+  if (is_sampling()) {
+    if (prof_entry.event_id != kUnsampledEventId) {
+      record_sampled_event(
+          prof_entry, et_pal_current_ticks(), current_thread_id());
+    }
+    return;
+  }
   et_timestamp_t end_time = et_pal_current_ticks();
   ET_CHECK_MSG(
       prof_entry.delegate_event_id_type == DelegateDebugIdType::kNone,
@@ -296,8 +471,11 @@ void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
   check_ready_to_add_events();
 
   etdump_ProfileEvent_start(builder);
+  add_perf_counters(prof_entry);
+  add_memory_traffic(prof_entry);
   etdump_ProfileEvent_start_time_add(builder, prof_entry.start_time);
   etdump_ProfileEvent_end_time_add(builder, end_time);
+  etdump_ProfileEvent_thread_id_add(builder, current_thread_id());
   etdump_ProfileEvent_chain_index_add(builder, prof_entry.chain_id);
   etdump_ProfileEvent_instruction_id_add(builder, prof_entry.debug_handle);
   if (prof_entry.event_id != -1) {
@@ -310,6 +488,9 @@ void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
 }
 
 AllocatorID ETDumpGen::track_allocator(const char* name) {
+  if (is_sampling()) {
+    return 0;
+  }
   ET_CHECK_MSG(
       (etdump_gen_state == ETDumpGen_Block_Created ||
        etdump_gen_state == ETDumpGen_Adding_Allocators),
@@ -326,6 +507,9 @@ AllocatorID ETDumpGen::track_allocator(const char* name) {
 void ETDumpGen::track_allocation(
     AllocatorID allocator_id,
     size_t allocation_size) {
+  if (is_sampling()) {
+    return;
+  }
   check_ready_to_add_events();
 
   etdump_RunData_events_push_start(builder);
@@ -334,6 +518,17 @@ void ETDumpGen::track_allocation(
 }
 
 etdump_result ETDumpGen::get_etdump_data() {
+  if (is_sampling()) {
+    return get_sampled_etdump_data();
+  }
+  if (is_streaming()) {
+    (void)write_stream();
+    return {nullptr, 0};
+  }
+  return finish_etdump();
+}
+
+etdump_result ETDumpGen::finish_etdump() {
   etdump_result result;
   if (etdump_gen_state == ETDumpGen_Adding_Events) {
     etdump_RunData_events_end(builder);
@@ -381,13 +576,108 @@ size_t ETDumpGen::copy_tensor_to_debug_buffer(exec_aten::Tensor tensor) {
   return (size_t)(offset_ptr - debug_buffer.data());
 }
 
+size_t ETDumpGen::compress_tensor_to_debug_buffer(
+    exec_aten::Tensor tensor,
+    bool* compressed) {
+  *compressed = false;
+  if (tensor.nbytes() == 0) {
+    return static_cast<size_t>(-1);
+  }
+  uint8_t* offset_ptr =
+      alignPointer(debug_buffer.data() + debug_buffer_offset, 64);
+  const size_t offset = offset_ptr - debug_buffer.data();
+  // Only worth it if smaller than the data.
+  const size_t capacity = offset < debug_buffer.size()
+      ? std::min(debug_buffer.size() - offset, tensor.nbytes() - 1)
+      : 0;
+  const size_t size = zero_run_length_encode(
+      static_cast<const uint8_t*>(tensor.const_data_ptr()),
+      tensor.nbytes(),
+      offset_ptr,
+      capacity);
+  if (size == 0) {
+    return copy_tensor_to_debug_buffer(tensor);
+  }
+  debug_buffer_offset = offset + size;
+  *compressed = true;
+  return offset;
+}
+
+void ETDumpGen::set_debug_filter(etdump_debug_filter filter) {
+  debug_filter = filter;
+}
+
+void ETDumpGen::set_tensor_mode(ETDumpTensorMode mode) {
+  tensor_mode = mode;
+}
+
+bool ETDumpGen::should_log_evalue(
+    const EValue& evalue,
+    LoggedEValueType evalue_type) {
+  if (evalue_type == LoggedEValueType::kProgramOutput &&
+      debug_filter.always_log_outputs) {
+    return true;
+  }
+  if (debug_handle_ < debug_filter.min_debug_handle ||
+      debug_handle_ > debug_filter.max_debug_handle) {
+    return false;
+  }
+  if (evalue.isTensor() || evalue.isTensorList()) {
+    size_t nbytes = 0;
+    if (evalue.isTensor()) {
+      nbytes = evalue.toTensor().nbytes();
+    } else {
+      for (const exec_aten::Tensor& tensor : evalue.toTensorList()) {
+        nbytes += tensor.nbytes();
+      }
+    }
+    if (nbytes < debug_filter.min_tensor_nbytes ||
+        nbytes > debug_filter.max_tensor_nbytes) {
+      return false;
+    }
+  }
+  return debug_filter.predicate == nullptr ||
+      debug_filter.predicate(
+          debug_filter.predicate_context, debug_handle_, evalue);
+}
+
 void ETDumpGen::log_evalue(const EValue& evalue, LoggedEValueType evalue_type) {
-  if (debug_buffer.empty()) {
+  if ((debug_buffer.empty() && tensor_mode != ETDumpTensorMode::kChecksum) ||
+      is_sampling()) {
+    return;
+  }
+  if (!should_log_evalue(evalue, evalue_type)) {
     return;
   }
 
   check_ready_to_add_events();
 
+  // Logs the data of a tensor as the tensor mode asks.
+  auto add_logged_tensor = [this](const exec_aten::Tensor& tensor) {
+    switch (tensor_mode) {
+      case ETDumpTensorMode::kChecksum: {
+        const uint64_t checksum =
+            tensor_checksum(tensor.const_data_ptr(), tensor.nbytes());
+        return add_tensor_entry(
+            builder, tensor, -1, etdump_TensorCompression_None, &checksum);
+      }
+      case ETDumpTensorMode::kCompress: {
+        bool compressed = false;
+        long offset = compress_tensor_to_debug_buffer(tensor, &compressed);
+        return add_tensor_entry(
+            builder,
+            tensor,
+            offset,
+            compressed ? etdump_TensorCompression_ZeroRunLength
+                       : etdump_TensorCompression_None);
+      }
+      case ETDumpTensorMode::kCopy:
+      default:
+        return add_tensor_entry(
+            builder, tensor, copy_tensor_to_debug_buffer(tensor));
+    }
+  };
+
   etdump_DebugEvent_start(builder);
 
   etdump_DebugEvent_chain_index_add(builder, chain_id_);
@@ -396,9 +686,7 @@ void ETDumpGen::log_evalue(const EValue& evalue, LoggedEValueType evalue_type) {
   switch (evalue.tag) {
     case Tag::Tensor: {
       exec_aten::Tensor tensor = evalue.toTensor();
-      long offset = copy_tensor_to_debug_buffer(tensor);
-      etdump_Tensor_ref_t tensor_ref =
-          add_tensor_entry(builder, tensor, offset);
+      etdump_Tensor_ref_t tensor_ref = add_logged_tensor(tensor);
 
       etdump_Value_start(builder);
       etdump_Value_val_add(builder, etdump_ValueType_Tensor);
@@ -417,9 +705,7 @@ void ETDumpGen::log_evalue(const EValue& evalue, LoggedEValueType evalue_type) {
       exec_aten::ArrayRef<exec_aten::Tensor> tensors = evalue.toTensorList();
       etdump_Tensor_vec_start(builder);
       for (size_t i = 0; i < tensors.size(); ++i) {
-        long offset = copy_tensor_to_debug_buffer(tensors[i]);
-        etdump_Tensor_vec_push(
-            builder, add_tensor_entry(builder, tensors[i], offset));
+        etdump_Tensor_vec_push(builder, add_logged_tensor(tensors[i]));
       }
       etdump_Tensor_vec_ref_t tensor_vec_ref = etdump_Tensor_vec_end(builder);
       etdump_TensorList_ref_t tensor_list_ref =
@@ -501,5 +787,293 @@ bool ETDumpGen::is_static_etdump() {
   return alloc.data != nullptr;
 }
 
+void ETDumpGen::enable_sampling(
+    Span<etdump_sampled_event> ring,
+    etdump_sampling_config config) {
+  ET_CHECK_MSG(!ring.empty(), "The sampling ring must not be empty.");
+  reset();
+  sample_ring = ring;
+  sample_ring_next = 0;
+  sample_ring_size = 0;
+  num_dropped_events = 0;
+  sampling_config = config;
+  sampling_config.block_period = std::max<size_t>(config.block_period, 1);
+  sampling_config.event_period = std::max<size_t>(config.event_period, 1);
+  num_seen_blocks = 0;
+  is_block_sampled = false;
+  sampled_block_name = nullptr;
+  // xorshift needs a non-zero state.
+  sampling_rng_state = config.seed != 0 ? config.seed : 0x9e3779b97f4a7c15;
+}
+
+void ETDumpGen::disable_sampling() {
+  sample_ring = {};
+  sample_ring_size = 0;
+  is_block_sampled = false;
+  reset();
+}
+
+bool ETDumpGen::is_sampling() {
+  return !sample_ring.empty();
+}
+
+size_t ETDumpGen::get_num_dropped_events() {
+  return num_dropped_events;
+}
+
+bool etdump_file_stream_writer(void* context, const void* data, size_t size) {
+  FILE* file = static_cast<FILE*>(context);
+  return fwrite(data, 1, size, file) == size && fflush(file) == 0;
+}
+
+void ETDumpGen::enable_streaming(
+    etdump_stream_writer writer,
+    void* writer_context,
+    size_t blocks_per_flush) {
+  ET_CHECK_MSG(writer != nullptr, "The stream needs a writer.");
+  reset();
+  stream_writer = writer;
+  stream_writer_context = writer_context;
+  stream_blocks_per_flush = std::max<size_t>(blocks_per_flush, 1);
+  num_streamed_blocks = 0;
+  current_block_name[0] = '\0';
+  stream_front_cursor = alloc.front_cursor;
+  stream_front_left = alloc.front_left;
+}
+
+void ETDumpGen::disable_streaming() {
+  stream_writer = nullptr;
+  stream_writer_context = nullptr;
+  reset();
+}
+
+bool ETDumpGen::is_streaming() {
+  return stream_writer != nullptr;
+}
+
+Error ETDumpGen::flush_stream() {
+  ET_CHECK_OR_RETURN_ERROR(
+      is_streaming(), InvalidState, "ETDumpGen is not streaming.");
+  const bool in_block = etdump_gen_state != ETDumpGen_Init &&
+      etdump_gen_state != ETDumpGen_Done && num_blocks > 0;
+  Error err = write_stream();
+  if (in_block) {
+    // Later events of the current block go to a block of the same name.
+    create_event_block(current_block_name);
+  }
+  return err;
+}
+
+size_t ETDumpGen::get_num_streamed_blocks() {
+  return num_streamed_blocks;
+}
+
+Error ETDumpGen::write_stream() {
+  const size_t blocks = num_blocks;
+  etdump_result result = finish_etdump();
+  if (result.buf != nullptr && is_static_etdump()) {
+    // Only the bytes emitted since the last write, without the rest of the
+    // build buffer.
+    result.size = stream_front_left - alloc.front_left;
+  }
+  Error err = Error::Ok;
+  if (result.buf != nullptr) {
+    if (stream_writer(stream_writer_context, result.buf, result.size)) {
+      num_streamed_blocks += blocks;
+    } else {
+      ET_LOG(Error, "Failed to write %zu ETDump blocks to the stream", blocks);
+      err = Error::AccessFailed;
+    }
+    if (!is_static_etdump()) {
+      flatcc_builder_aligned_free(result.buf);
+    }
+  }
+  if (is_static_etdump()) {
+    alloc.front_cursor = stream_front_cursor;
+    alloc.front_left = stream_front_left;
+  }
+  reset();
+  return err;
+}
+
+Error ETDumpGen::enable_perf_counters() {
+  return perf_counters.open();
+}
+
+void ETDumpGen::disable_perf_counters() {
+  perf_counters.close();
+}
+
+bool ETDumpGen::is_capturing_perf_counters() {
+  return perf_counters.is_open();
+}
+
+// Adds the counter deltas since `entry` started to the ProfileEvent being
+// built. Must be called right after etdump_ProfileEvent_start().
+void ETDumpGen::add_perf_counters(const EventTracerEntry& entry) {
+  if (!perf_counters.is_open()) {
+    return;
+  }
+  EventTracerPerfCounters end_counters;
+  perf_counters.read(end_counters);
+  const EventTracerPerfCounters& start_counters = entry.start_counters;
+  etdump_ProfileEvent_perf_counters_create(
+      builder,
+      end_counters.cycles - start_counters.cycles,
+      end_counters.instructions - start_counters.instructions,
+      end_counters.l1d_cache_misses - start_counters.l1d_cache_misses,
+      end_counters.ll_cache_misses - start_counters.ll_cache_misses,
+      end_counters.stalled_cycles - start_counters.stalled_cycles);
+}
+
+void ETDumpGen::log_memory_traffic(
+    const EventTracerMemoryTraffic* traffic,
+    size_t num_buffers) {
+  if (is_sampling()) {
+    return;
+  }
+  if (num_buffers > kETDumpMaxMemoryTrafficBuffers) {
+    ET_LOG(
+        Info,
+        "Recording the traffic of %zu of %zu buffers",
+        kETDumpMaxMemoryTrafficBuffers,
+        num_buffers);
+    num_buffers = kETDumpMaxMemoryTrafficBuffers;
+  }
+  memcpy(pending_traffic, traffic, num_buffers * sizeof(*traffic));
+  num_pending_traffic = num_buffers;
+  pending_traffic_chain_id = chain_id_;
+  pending_traffic_debug_handle = debug_handle_;
+}
+
+// Adds the traffic logged for the instruction of `entry` to the ProfileEvent
+// being built.
+void ETDumpGen::add_memory_traffic(const EventTracerEntry& entry) {
+  if (num_pending_traffic == 0 ||
+      entry.chain_id != pending_traffic_chain_id ||
+      entry.debug_handle != pending_traffic_debug_handle) {
+    return;
+  }
+  etdump_ProfileEvent_memory_traffic_start(builder);
+  for (size_t i = 0; i < num_pending_traffic; i++) {
+    etdump_ProfileEvent_memory_traffic_push_create(
+        builder,
+        pending_traffic[i].mem_id,
+        pending_traffic[i].bytes_read,
+        pending_traffic[i].bytes_written);
+  }
+  etdump_ProfileEvent_memory_traffic_end(builder);
+  num_pending_traffic = 0;
+}
+
+bool ETDumpGen::should_sample_event() {
+  if (!is_block_sampled) {
+    return false;
+  }
+  if (sampling_config.event_period == 1) {
+    return true;
+  }
+  sampling_rng_state ^= sampling_rng_state << 13;
+  sampling_rng_state ^= sampling_rng_state >> 7;
+  sampling_rng_state ^= sampling_rng_state << 17;
+  return sampling_rng_state % sampling_config.event_period == 0;
+}
+
+void ETDumpGen::record_sampled_event(
+    const EventTracerEntry& entry,
+    et_timestamp_t end_time,
+    uint64_t thread_id) {
+  etdump_sampled_event& event = sample_ring[sample_ring_next];
+  event.start_time = entry.start_time;
+  event.end_time = end_time;
+  event.event_id = entry.event_id;
+  event.block_name = sampled_block_name;
+  event.block_index = static_cast<uint32_t>(num_seen_blocks - 1);
+  event.chain_id = entry.chain_id;
+  event.debug_handle = entry.debug_handle;
+  event.delegate_event_id_type = entry.delegate_event_id_type;
+  event.thread_id = thread_id;
+
+  if (++sample_ring_next == sample_ring.size()) {
+    sample_ring_next = 0;
+  }
+  if (sample_ring_size < sample_ring.size()) {
+    sample_ring_size++;
+  } else {
+    num_dropped_events++;
+  }
+}
+
+// Serializes the sampled events, oldest first, into a RunData per block.
+etdump_result ETDumpGen::get_sampled_etdump_data() {
+  reset();
+  const size_t ring_size = sample_ring.size();
+  const size_t first = (sample_ring_next + ring_size - sample_ring_size) %
+      ring_size;
+  uint32_t block_index = 0;
+  for (size_t i = 0; i < sample_ring_size; ++i) {
+    const etdump_sampled_event& event = sample_ring[(first + i) % ring_size];
+    if (num_blocks == 0 || event.block_index != block_index) {
+      if (num_blocks > 0) {
+        etdump_RunData_events_end(builder);
+        etdump_ETDump_run_data_push_end(builder);
+        etdump_ETDump_run_data_push_start(builder);
+      }
+      ++num_blocks;
+      block_index = event.block_index;
+      const char* block_name =
+          event.block_name != nullptr ? event.block_name : "";
+      etdump_RunData_name_create_strn(builder, block_name, strlen(block_name));
+      etdump_RunData_events_start(builder);
+    }
+
+    // Names are pointers to the event name strings.
+    int64_t name_ref = 0;
+    if (event.delegate_event_id_type != DelegateDebugIdType::kInt &&
+        event.event_id != -1) {
+      name_ref = create_string_entry(
+          reinterpret_cast<const char*>(static_cast<intptr_t>(event.event_id)));
+    }
+    etdump_ProfileEvent_start(builder);
+    etdump_ProfileEvent_start_time_add(builder, event.start_time);
+    etdump_ProfileEvent_end_time_add(builder, event.end_time);
+    etdump_ProfileEvent_chain_index_add(builder, event.chain_id);
+    etdump_ProfileEvent_instruction_id_add(builder, event.debug_handle);
+    if (event.thread_id != 0) {
+      etdump_ProfileEvent_thread_id_add(builder, event.thread_id);
+    }
+    if (event.delegate_event_id_type == DelegateDebugIdType::kInt) {
+      etdump_ProfileEvent_delegate_debug_id_int_add(builder, event.event_id);
+    } else if (event.delegate_event_id_type == DelegateDebugIdType::kStr) {
+      etdump_ProfileEvent_delegate_debug_id_str_add(builder, name_ref);
+    } else if (name_ref != 0) {
+      etdump_ProfileEvent_name_add(builder, name_ref);
+    }
+    etdump_ProfileEvent_ref_t id = etdump_ProfileEvent_end(builder);
+    etdump_RunData_events_push_start(builder);
+    etdump_Event_profile_event_add(builder, id);
+    etdump_RunData_events_push_end(builder);
+  }
+  sample_ring_size = 0;
+
+  etdump_result result = {nullptr, 0};
+  if (num_blocks == 0) {
+    return result;
+  }
+  etdump_RunData_events_end(builder);
+  etdump_ETDump_run_data_push_end(builder);
+  etdump_ETDump_run_data_end(builder);
+  etdump_ETDump_ref_t root = etdump_ETDump_end(builder);
+  flatbuffers_buffer_end(builder, root);
+  if (alloc.data) {
+    result.buf = alloc.front_cursor;
+    result.size = alloc.out_size - alloc.front_left;
+  } else {
+    result.buf = flatcc_builder_finalize_aligned_buffer(builder, &result.size);
+  }
+  etdump_gen_state = ETDumpGen_Done;
+  return result;
+}
+
 } // namespace executor
 } // namespace torch
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include "executorch/runtime/core/event_tracer.h"
 #include "executorch/runtime/platform/platform.h"
+#include "executorch/sdk/etdump/perf_counters.h"
 
 #define ETDUMP_VERSION 0
 
@@ -33,6 +34,10 @@ struct etdump_result {
   size_t size;
 };
 
+// Maximum number of buffers whose traffic ETDumpGen records per instruction,
+// more than the memory plans of most models have.
+constexpr size_t kETDumpMaxMemoryTrafficBuffers = 8;
+
 struct etdump_static_allocator {
   etdump_static_allocator() {}
 
@@ -65,6 +70,89 @@ struct etdump_static_allocator {
   size_t front_left{0};
 };
 
+/**
+ * A profiling event recorded by ETDumpGen in sampling mode. Compact and
+ * trivially copyable, so that recording it costs a few stores.
+ */
+struct etdump_sampled_event {
+  et_timestamp_t start_time;
+  et_timestamp_t end_time;
+  // As in EventTracerEntry, except that names are pointers to the name
+  // strings, which are not copied.
+  int64_t event_id;
+  // Name of the event block, i.e. execution, the event belongs to.
+  const char* block_name;
+  uint32_t block_index;
+  ChainID chain_id;
+  DebugHandle debug_handle;
+  DelegateDebugIdType delegate_event_id_type;
+  // 0 for events logged by delegates, as in ProfileEvent.
+  uint64_t thread_id;
+};
+
+struct etdump_sampling_config {
+  // Profile one in this many event blocks, i.e. executions.
+  size_t block_period{1};
+  // Profile each event of a profiled block with a probability of one in this
+  // many.
+  size_t event_period{1};
+  // Seed of the random choice of events.
+  uint64_t seed{0};
+};
+
+/**
+ * How ETDumpGen logs the data of the tensors of log_evalue().
+ */
+enum class ETDumpTensorMode {
+  // Copies the data into the debug buffer.
+  kCopy,
+  // Copies the data into the debug buffer with the runs of zero bytes
+  // squeezed out, which shrinks e.g. activations after a ReLU. Data that
+  // would not shrink is copied as is.
+  kCompress,
+  // Records a checksum of the data in the Tensor entry only, which needs no
+  // debug buffer. Enough to find where two runs diverge.
+  kChecksum,
+};
+
+/**
+ * Receives the ETDumps serialized by ETDumpGen in streaming mode, see
+ * ETDumpGen::enable_streaming(). `data` is only valid during the call. Returns
+ * false if the data could not be written.
+ */
+using etdump_stream_writer =
+    bool (*)(void* context, const void* data, size_t size);
+
+/**
+ * An etdump_stream_writer that appends to the FILE* in `context`, e.g. one
+ * returned by fopen() or, for a file descriptor, fdopen().
+ */
+bool etdump_file_stream_writer(void* context, const void* data, size_t size);
+
+using etdump_debug_predicate =
+    bool (*)(void* context, DebugHandle debug_handle, const EValue& evalue);
+
+/**
+ * Which of the values of log_evalue() ETDumpGen logs. A value is logged if it
+ * passes all the checks.
+ */
+struct etdump_debug_filter {
+  // The debug handle, i.e. instruction id, of the value must be in
+  // [min_debug_handle, max_debug_handle].
+  DebugHandle min_debug_handle{0};
+  DebugHandle max_debug_handle{UINT32_MAX};
+  // The size of a tensor, or the total size of a tensor list, must be in
+  // [min_tensor_nbytes, max_tensor_nbytes]. Does not apply to scalars.
+  size_t min_tensor_nbytes{0};
+  size_t max_tensor_nbytes{SIZE_MAX};
+  // If set, must return true for the value, e.g. for the debug handles of
+  // the ops of interest, which an ETRecord maps to op names.
+  etdump_debug_predicate predicate{nullptr};
+  void* predicate_context{nullptr};
+  // Program outputs are logged without checks.
+  bool always_log_outputs{true};
+};
+
 class ETDumpGen : public EventTracer {
  public:
   ETDumpGen(Span<uint8_t> buffer = {nullptr, (size_t)0});
@@ -97,24 +185,155 @@ class ETDumpGen : public EventTracer {
       const EValue& evalue,
       LoggedEValueType evalue_type =
           LoggedEValueType::kIntermediateOutput) override;
+  /**
+   * Records the traffic in the ProfileEvent of the operator or delegate call
+   * it belongs to, when that call ends. Enable it with
+   * set_memory_traffic_tracing() before loading the method. Not recorded in
+   * sampling mode.
+   */
+  virtual void log_memory_traffic(
+      const EventTracerMemoryTraffic* traffic,
+      size_t num_buffers) override;
   void set_debug_buffer(Span<uint8_t> buffer);
+  /**
+   * Only logs the values of log_evalue() that pass `filter`, so that long runs
+   * can log the values of interest only.
+   */
+  void set_debug_filter(etdump_debug_filter filter);
+  /**
+   * Sets how the data of tensors are logged, ETDumpTensorMode::kCopy by
+   * default. ETDumpTensorMode::kChecksum logs tensors even without a debug
+   * buffer.
+   */
+  void set_tensor_mode(ETDumpTensorMode mode);
   etdump_result get_etdump_data();
   size_t get_num_blocks();
   bool is_static_etdump();
   void reset();
 
+  /**
+   * Switches to the sampling mode, cheap enough to leave on in production:
+   * profiling events of a subset of the blocks and events are recorded into
+   * `ring`, overwriting the oldest ones when it is full, and serialized by
+   * get_etdump_data() only, which then empties the ring. Events recorded so
+   * far are discarded.
+   *
+   * The names of events and blocks are not copied, so they must outlive the
+   * next get_etdump_data(), as the string literals of the runtime do. Delegate
+   * metadata, allocations and debug events are not recorded.
+   */
+  void enable_sampling(
+      Span<etdump_sampled_event> ring,
+      etdump_sampling_config config = {});
+  void disable_sampling();
+  bool is_sampling();
+  // Number of sampled events overwritten before they were serialized.
+  size_t get_num_dropped_events();
+
+  /**
+   * Switches to the streaming mode, for profiling sessions too long to keep
+   * in memory: once `blocks_per_flush` event blocks are complete, they are
+   * serialized into an ETDump of their own, passed to `writer` and dropped,
+   * which bounds the memory of the builder. The stream is the concatenation
+   * of these size-prefixed ETDumps, which
+   * deserialize_from_etdump_flatcc_stream() merges. get_etdump_data() flushes
+   * the blocks that remain and returns no data. Events recorded so far are
+   * discarded.
+   *
+   * Not used in sampling mode. The debug buffer is not streamed, so the
+   * values of log_evalue() still have to fit in it.
+   */
+  void enable_streaming(
+      etdump_stream_writer writer,
+      void* writer_context,
+      size_t blocks_per_flush = 1);
+  void disable_streaming();
+  bool is_streaming();
+  /**
+   * Writes the blocks recorded since the last flush, including the current
+   * one, to the stream. Events of the current block that are recorded after
+   * this go to a new block of the same name.
+   *
+   * @returns Error::InvalidState if not streaming, Error::AccessFailed if the
+   *     writer failed, in which case the blocks are dropped.
+   */
+  __ET_NODISCARD Error flush_stream();
+  // Number of blocks written to the stream so far.
+  size_t get_num_streamed_blocks();
+
+  /**
+   * Captures the hardware performance counters of EventTracerPerfCounters,
+   * e.g. cycles and cache misses, over each profiling event that has a start
+   * and an end, and records their deltas in its ProfileEvent. See
+   * PerfCounterGroup for what they count. Not captured in sampling mode.
+   *
+   * @returns Error::NotSupported if no counter is available.
+   */
+  __ET_NODISCARD Error enable_perf_counters();
+  void disable_perf_counters();
+  bool is_capturing_perf_counters();
+
  private:
   struct flatcc_builder* builder;
   size_t num_blocks = 0;
   Span<uint8_t> debug_buffer;
   size_t debug_buffer_offset = 0;
+  etdump_debug_filter debug_filter;
+  ETDumpTensorMode tensor_mode = ETDumpTensorMode::kCopy;
   int bundled_input_index = -1;
   ETDumpGen_State etdump_gen_state = ETDumpGen_Init;
   struct etdump_static_allocator alloc;
 
+  Span<etdump_sampled_event> sample_ring;
+  size_t sample_ring_next = 0;
+  size_t sample_ring_size = 0;
+  size_t num_dropped_events = 0;
+  etdump_sampling_config sampling_config;
+  size_t num_seen_blocks = 0;
+  bool is_block_sampled = false;
+  const char* sampled_block_name = nullptr;
+  uint64_t sampling_rng_state = 0;
+
+  etdump_stream_writer stream_writer = nullptr;
+  void* stream_writer_context = nullptr;
+  size_t stream_blocks_per_flush = 1;
+  size_t num_streamed_blocks = 0;
+  // Name of the current block, possibly truncated, to continue it after a
+  // flush.
+  char current_block_name[64] = {};
+  // Emitter state of the static allocator when streaming started, restored
+  // after every flush since the builder does not reset it.
+  uint8_t* stream_front_cursor = nullptr;
+  size_t stream_front_left = 0;
+
+  PerfCounterGroup perf_counters;
+
+  // Traffic logged for the instruction of pending_traffic_chain_id and
+  // pending_traffic_debug_handle, until its profiling event ends.
+  EventTracerMemoryTraffic pending_traffic[kETDumpMaxMemoryTrafficBuffers];
+  size_t num_pending_traffic = 0;
+  ChainID pending_traffic_chain_id = kUnsetChainId;
+  DebugHandle pending_traffic_debug_handle = kUnsetDebugHandle;
+
   void check_ready_to_add_events();
   int64_t create_string_entry(const char* name);
   size_t copy_tensor_to_debug_buffer(exec_aten::Tensor tensor);
+  size_t compress_tensor_to_debug_buffer(
+      exec_aten::Tensor tensor,
+      bool* compressed);
+  bool should_log_evalue(const EValue& evalue, LoggedEValueType evalue_type);
+  bool should_sample_event();
+  void record_sampled_event(
+      const EventTracerEntry& entry,
+      et_timestamp_t end_time,
+      uint64_t thread_id);
+  etdump_result get_sampled_etdump_data();
+  // Ends the ETDump being built and returns it.
+  etdump_result finish_etdump();
+  // Writes the ETDump being built to the stream and resets the builder.
+  Error write_stream();
+  void add_perf_counters(const EventTracerEntry& entry);
+  void add_memory_traffic(const EventTracerEntry& entry);
 };
 
 } // namespace executor
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/sdk/etdump/perf_counters.h>
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <executorch/runtime/platform/log.h>
+
+namespace torch {
+namespace executor {
+
+namespace {
+
+#if defined(__linux__)
+uint64_t* counter_field(EventTracerPerfCounters& counters, int index) {
+  uint64_t* fields[PerfCounterGroup::kNumCounters] = {
+      &counters.cycles,
+      &counters.instructions,
+      &counters.l1d_cache_misses,
+      &counters.ll_cache_misses,
+      &counters.stalled_cycles,
+  };
+  return fields[index];
+}
+
+struct CounterConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+// In the order of the fields of EventTracerPerfCounters.
+constexpr CounterConfig kCounterConfigs[PerfCounterGroup::kNumCounters] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+};
+
+int perf_event_open(perf_event_attr* attr, int group_fd) {
+  // Counts the calling thread on any CPU.
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0));
+}
+#endif
+
+} // namespace
+
+PerfCounterGroup::~PerfCounterGroup() {
+  close();
+}
+
+Error PerfCounterGroup::open() {
+#if defined(__linux__)
+  if (is_open()) {
+    return Error::Ok;
+  }
+  for (int i = 0; i < kNumCounters; ++i) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = kCounterConfigs[i].type;
+    attr.config = kCounterConfigs[i].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // The whole group is enabled at once below.
+    attr.disabled = leader_fd_ < 0 ? 1 : 0;
+    int fd = perf_event_open(&attr, leader_fd_);
+    if (fd < 0) {
+      continue;
+    }
+    if (leader_fd_ < 0) {
+      leader_fd_ = fd;
+    }
+    fds_[i] = fd;
+    slots_[i] = num_open_++;
+  }
+  if (!is_open()) {
+    ET_LOG(Error, "Failed to open any hardware performance counter");
+    return Error::NotSupported;
+  }
+  ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return Error::Ok;
+#else
+  ET_LOG(Error, "Hardware performance counters are not supported");
+  return Error::NotSupported;
+#endif
+}
+
+void PerfCounterGroup::close() {
+#if defined(__linux__)
+  if (is_open()) {
+    ioctl(leader_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+  // Members of the group are closed before its leader.
+  for (int i = kNumCounters - 1; i >= 0; --i) {
+    if (fds_[i] >= 0) {
+      ::close(fds_[i]);
+    }
+  }
+#endif
+  leader_fd_ = -1;
+  num_open_ = 0;
+  for (int i = 0; i < kNumCounters; ++i) {
+    fds_[i] = -1;
+    slots_[i] = -1;
+  }
+}
+
+void PerfCounterGroup::read(EventTracerPerfCounters& counters) const {
+  memset(&counters, 0, sizeof(counters));
+#if defined(__linux__)
+  if (!is_open()) {
+    return;
+  }
+  // With PERF_FORMAT_GROUP: the number of counters, then their values in the
+  // order they were added to the group.
+  uint64_t values[1 + kNumCounters];
+  const ssize_t size = ::read(leader_fd_, values, sizeof(values));
+  if (size < static_cast<ssize_t>(sizeof(uint64_t) * (1 + num_open_))) {
+    return;
+  }
+  for (int i = 0; i < kNumCounters; ++i) {
+    if (slots_[i] >= 0) {
+      *counter_field(counters, i) = values[1 + slots_[i]];
+    }
+  }
+#endif
+}
+
+} // namespace executor
+} // namespace torch
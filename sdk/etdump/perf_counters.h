@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+
+/**
+ * Reads the hardware performance counters of EventTracerPerfCounters, with a
+ * group of perf_event_open(2) counters on Linux and Android, so that a read
+ * is a single system call.
+ *
+ * The counters only count user space instructions of the thread that called
+ * open(); work that operators hand off to a threadpool is not counted.
+ */
+class PerfCounterGroup {
+ public:
+  PerfCounterGroup() = default;
+  ~PerfCounterGroup();
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+  /**
+   * Opens and starts the counters. Counters that the CPU or the kernel does
+   * not support are left out and read as zero.
+   *
+   * @returns Error::NotSupported when perf events are not available, e.g. on
+   * other platforms or when /proc/sys/kernel/perf_event_paranoid forbids them.
+   */
+  __ET_NODISCARD Error open();
+
+  /// Stops and closes the counters.
+  void close();
+
+  bool is_open() const {
+    return leader_fd_ >= 0;
+  }
+
+  /// Reads the current values of the counters, zeros if they are not open.
+  void read(EventTracerPerfCounters& counters) const;
+
+  /// Number of counters in EventTracerPerfCounters.
+  static constexpr int kNumCounters = 5;
+
+ private:
+  int leader_fd_ = -1;
+  int fds_[kNumCounters] = {-1, -1, -1, -1, -1};
+  // Index of each counter in the values read from the group, -1 if it could
+  // not be opened.
+  int slots_[kNumCounters] = {-1, -1, -1, -1, -1};
+  int num_open_ = 0;
+};
+
+} // namespace executor
+} // namespace torch
@@ -18,12 +18,19 @@ from typing import List, Optional
 from executorch.exir.scalar_type import ScalarType
 
 
+class TensorCompression(Enum):
+    NONE = "None"
+    ZERO_RUN_LENGTH = "ZeroRunLength"
+
+
 @dataclass
 class Tensor:
     scalar_type: ScalarType
     sizes: List[int]
     strides: List[int]
     offset: Optional[int]
+    compression: Optional[str] = None  # Member of TensorCompression
+    checksum: Optional[int] = None
 
 
 @dataclass
@@ -106,6 +113,22 @@ class PROFILE_EVENT_ENUM(Enum):
     LOAD_MODEL = "Program::load_method"
 
 
+@dataclass
+class PerfCounters:
+    cycles: int
+    instructions: int
+    l1d_cache_misses: int
+    ll_cache_misses: int
+    stalled_cycles: int
+
+
+@dataclass
+class MemoryTraffic:
+    mem_id: int
+    bytes_read: int
+    bytes_written: int
+
+
 @dataclass
 class ProfileEvent:
     name: Optional[str]
@@ -116,6 +139,9 @@ class ProfileEvent:
     delegate_debug_metadata: Optional[bytes]
     start_time: int
     end_time: int
+    perf_counters: Optional[PerfCounters] = None
+    thread_id: Optional[int] = None
+    memory_traffic: Optional[List[MemoryTraffic]] = None
 
 
 @dataclass
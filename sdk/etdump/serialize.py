@@ -9,6 +9,7 @@
 import json
 import os
 import tempfile
+from typing import Optional
 
 import pkg_resources
 
@@ -108,3 +109,38 @@ def deserialize_from_etdump_flatcc(
     return _deserialize_from_json_to_etdump_flatcc(
         _convert_from_flatcc(data, size_prefixed)
     )
+
+
+def deserialize_from_etdump_flatcc_stream(data: bytes) -> ETDumpFlatCC:
+    """
+    Given the stream written by an ETDumpGen in streaming mode, i.e. a
+    concatenation of size-prefixed etdump binary blobs, this function will
+    deserialize each of them and return a single ETDump python object with
+    the run data of all of them, in stream order. A single etdump binary blob
+    is a stream of one.
+    Args:
+        data: Serialized etdump stream.
+    Returns:
+        Deserialized ETDump python object.
+    """
+    run_data = []
+    version: Optional[int] = None
+    offset = 0
+    while offset + 4 <= len(data):
+        size = int.from_bytes(data[offset : offset + 4], "little")
+        if size == 0:
+            # Padding between blobs.
+            offset += 4
+            continue
+        end = offset + 4 + size
+        if end > len(data):
+            raise ValueError(
+                f"Truncated etdump stream: blob at offset {offset} needs "
+                f"{size} bytes, {len(data) - offset - 4} remain"
+            )
+        etdump = deserialize_from_etdump_flatcc(data[offset:end])
+        version = etdump.version if version is None else version
+        run_data.extend(etdump.run_data)
+        offset = end
+    return ETDumpFlatCC(version=version or 0, run_data=run_data)
+
@@ -94,10 +94,14 @@ def define_common_targets():
             srcs = [
                 "etdump_flatcc.cpp",
                 "emitter.cpp",
+                "perf_counters.cpp",
+                "chrome_trace.cpp",
             ],
             exported_headers = [
                 "etdump_flatcc.h",
                 "emitter.h",
+                "perf_counters.h",
+                "chrome_trace.h",
             ],
             deps = [
                 "//executorch/runtime/platform:platform",
@@ -12,6 +12,7 @@
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/platform/runtime.h>
+#include <executorch/sdk/etdump/chrome_trace.h>
 #include <executorch/sdk/etdump/etdump_flatcc.h>
 #include <executorch/sdk/etdump/etdump_schema_flatcc_builder.h>
 #include <executorch/sdk/etdump/etdump_schema_flatcc_reader.h>
@@ -19,6 +20,8 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace torch {
 namespace executor {
@@ -275,6 +278,113 @@ TEST_F(ProfilerETDumpTest, VerifyLogging) {
   }
 }
 
+TEST_F(ProfilerETDumpTest, FilteredDebugEvents) {
+  testing::TensorFactory<ScalarType::Float> tf;
+  EValue small(tf.ones({2}));
+  EValue large(tf.ones({64}));
+
+  for (size_t i = 0; i < 2; i++) {
+    etdump_gen[i]->create_event_block("test_block");
+    void* ptr = malloc(2048);
+    etdump_gen[i]->set_debug_buffer(Span<uint8_t>((uint8_t*)ptr, 2048));
+
+    etdump_debug_filter filter;
+    filter.min_debug_handle = 2;
+    filter.max_debug_handle = 3;
+    filter.max_tensor_nbytes = 64;
+    etdump_gen[i]->set_debug_filter(filter);
+
+    // Out of the range of debug handles.
+    etdump_gen[i]->set_chain_debug_handle(0, 1);
+    etdump_gen[i]->log_evalue(small);
+    etdump_gen[i]->set_chain_debug_handle(0, 2);
+    etdump_gen[i]->log_evalue(small);
+    // Too large.
+    etdump_gen[i]->log_evalue(large);
+    // Program outputs are always logged.
+    etdump_gen[i]->log_evalue(large, LoggedEValueType::kProgramOutput);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    etdump_Event_vec_t events = etdump_RunData_events(
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0));
+    ASSERT_EQ(etdump_Event_vec_len(events), 2);
+    etdump_DebugEvent_table_t debug_event =
+        etdump_Event_debug_event(etdump_Event_vec_at(events, 0));
+    ASSERT_EQ(etdump_DebugEvent_instruction_id(debug_event), 2);
+
+    free(ptr);
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+}
+
+TEST_F(ProfilerETDumpTest, CompressedAndChecksummedTensors) {
+  testing::TensorFactory<ScalarType::Float> tf;
+  EValue zeros(tf.zeros({64}));
+  EValue ones(tf.ones({64}));
+
+  for (size_t i = 0; i < 2; i++) {
+    etdump_gen[i]->create_event_block("test_block");
+    void* ptr = malloc(2048);
+    etdump_gen[i]->set_debug_buffer(Span<uint8_t>((uint8_t*)ptr, 2048));
+
+    etdump_gen[i]->set_tensor_mode(ETDumpTensorMode::kCompress);
+    etdump_gen[i]->log_evalue(zeros);
+    // Not smaller when compressed, so copied as is.
+    etdump_gen[i]->log_evalue(ones);
+    etdump_gen[i]->set_tensor_mode(ETDumpTensorMode::kChecksum);
+    etdump_gen[i]->log_evalue(ones);
+    etdump_gen[i]->log_evalue(zeros);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    etdump_Event_vec_t events = etdump_RunData_events(
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0));
+    ASSERT_EQ(etdump_Event_vec_len(events), 4);
+    etdump_Tensor_table_t tensors[4];
+    for (size_t j = 0; j < 4; j++) {
+      tensors[j] = etdump_Value_tensor(etdump_DebugEvent_debug_entry(
+          etdump_Event_debug_event(etdump_Event_vec_at(events, j))));
+    }
+
+    // 256 zero bytes, then no literals.
+    ASSERT_EQ(
+        etdump_Tensor_compression(tensors[0]),
+        etdump_TensorCompression_ZeroRunLength);
+    uint32_t record[2];
+    memcpy(record, (uint8_t*)ptr + etdump_Tensor_offset(tensors[0]), 8);
+    EXPECT_EQ(record[0], 256);
+    EXPECT_EQ(record[1], 0);
+
+    ASSERT_EQ(
+        etdump_Tensor_compression(tensors[1]), etdump_TensorCompression_None);
+    float one;
+    memcpy(&one, (uint8_t*)ptr + etdump_Tensor_offset(tensors[1]), 4);
+    EXPECT_EQ(one, 1.0f);
+
+    EXPECT_EQ(etdump_Tensor_offset(tensors[2]), -1);
+    EXPECT_EQ(etdump_Tensor_offset(tensors[3]), -1);
+    EXPECT_NE(etdump_Tensor_checksum(tensors[2]), 0);
+    EXPECT_NE(
+        etdump_Tensor_checksum(tensors[2]), etdump_Tensor_checksum(tensors[3]));
+
+    free(ptr);
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+}
+
 TEST_F(ProfilerETDumpTest, MultipleBlocksWithEvents) {
   for (size_t i = 0; i < 2; i++) {
     etdump_gen[i]->create_event_block("test_block");
@@ -571,5 +681,340 @@ TEST_F(ProfilerETDumpTest, WriteAfterGetETDumpData) {
   }
 }
 
+TEST_F(ProfilerETDumpTest, SampledProfileEvents) {
+  etdump_sampled_event ring[8];
+  for (size_t i = 0; i < 2; i++) {
+    etdump_gen[i]->enable_sampling({ring, 8});
+    ASSERT_TRUE(etdump_gen[i]->is_sampling());
+
+    etdump_gen[i]->create_event_block("test_block");
+    EventTracerEntry entry = etdump_gen[i]->start_profiling("test_event", 0, 1);
+    etdump_gen[i]->end_profiling(entry);
+    etdump_gen[i]->log_profiling_delegate(nullptr, 276, 1, 2, nullptr, 0);
+    // Allocations are not recorded in sampling mode.
+    etdump_gen[i]->track_allocation(
+        etdump_gen[i]->track_allocator("test_allocator"), 64);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+    ASSERT_TRUE(result.size != 0);
+
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    ASSERT_NE(etdump, nullptr);
+
+    etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(etdump);
+    ASSERT_EQ(etdump_RunData_vec_len(run_data_vec), 1);
+    EXPECT_EQ(etdump_gen[i]->get_num_blocks(), 1);
+    etdump_RunData_table_t run_data = etdump_RunData_vec_at(run_data_vec, 0);
+    EXPECT_EQ(
+        std::string(
+            etdump_RunData_name(run_data),
+            strlen(etdump_RunData_name(run_data))),
+        "test_block");
+
+    etdump_Event_vec_t event_vec = etdump_RunData_events(run_data);
+    ASSERT_EQ(etdump_Event_vec_len(event_vec), 2);
+
+    etdump_ProfileEvent_table_t event_0 =
+        etdump_Event_profile_event(etdump_Event_vec_at(event_vec, 0));
+    flatbuffers_string_t event_0_name = etdump_ProfileEvent_name(event_0);
+    EXPECT_EQ(std::string(event_0_name, strlen(event_0_name)), "test_event");
+    EXPECT_EQ(etdump_ProfileEvent_instruction_id(event_0), 1);
+
+    etdump_ProfileEvent_table_t event_1 =
+        etdump_Event_profile_event(etdump_Event_vec_at(event_vec, 1));
+    EXPECT_EQ(etdump_ProfileEvent_delegate_debug_id_int(event_1), 276);
+    EXPECT_EQ(etdump_ProfileEvent_start_time(event_1), 1);
+    EXPECT_EQ(etdump_ProfileEvent_end_time(event_1), 2);
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+
+    // The ring is emptied by get_etdump_data().
+    result = etdump_gen[i]->get_etdump_data();
+    EXPECT_EQ(result.buf, nullptr);
+    EXPECT_EQ(result.size, 0);
+
+    etdump_gen[i]->disable_sampling();
+    EXPECT_FALSE(etdump_gen[i]->is_sampling());
+  }
+}
+
+TEST_F(ProfilerETDumpTest, SampledBlocks) {
+  etdump_sampled_event ring[8];
+  for (size_t i = 0; i < 2; i++) {
+    etdump_sampling_config config;
+    config.block_period = 2;
+    etdump_gen[i]->enable_sampling({ring, 8}, config);
+
+    const char* block_names[] = {"block_0", "block_1", "block_2", "block_3"};
+    for (const char* block_name : block_names) {
+      etdump_gen[i]->create_event_block(block_name);
+      EventTracerEntry entry =
+          etdump_gen[i]->start_profiling("test_event", 0, 1);
+      etdump_gen[i]->end_profiling(entry);
+    }
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    ASSERT_NE(etdump, nullptr);
+
+    // Only blocks 0 and 2 are profiled.
+    etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(etdump);
+    ASSERT_EQ(etdump_RunData_vec_len(run_data_vec), 2);
+    etdump_RunData_table_t run_data = etdump_RunData_vec_at(run_data_vec, 1);
+    EXPECT_EQ(
+        std::string(
+            etdump_RunData_name(run_data),
+            strlen(etdump_RunData_name(run_data))),
+        "block_2");
+    EXPECT_EQ(etdump_Event_vec_len(etdump_RunData_events(run_data)), 1);
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+    etdump_gen[i]->disable_sampling();
+  }
+}
+
+TEST_F(ProfilerETDumpTest, SampledEventsOverwriteOldest) {
+  etdump_sampled_event ring[2];
+  for (size_t i = 0; i < 2; i++) {
+    etdump_gen[i]->enable_sampling({ring, 2});
+
+    etdump_gen[i]->create_event_block("test_block");
+    const char* event_names[] = {"event_0", "event_1", "event_2"};
+    for (const char* event_name : event_names) {
+      EventTracerEntry entry = etdump_gen[i]->start_profiling(event_name, 0, 1);
+      etdump_gen[i]->end_profiling(entry);
+    }
+    EXPECT_EQ(etdump_gen[i]->get_num_dropped_events(), 1);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    ASSERT_NE(etdump, nullptr);
+
+    etdump_RunData_table_t run_data =
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0);
+    etdump_Event_vec_t event_vec = etdump_RunData_events(run_data);
+    ASSERT_EQ(etdump_Event_vec_len(event_vec), 2);
+    flatbuffers_string_t event_name = etdump_ProfileEvent_name(
+        etdump_Event_profile_event(etdump_Event_vec_at(event_vec, 0)));
+    EXPECT_EQ(std::string(event_name, strlen(event_name)), "event_1");
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+    etdump_gen[i]->disable_sampling();
+  }
+}
+
+namespace {
+
+// Keeps a copy of each buffer written to the stream.
+bool collect_stream(void* context, const void* data, size_t size) {
+  auto* buffers = static_cast<std::vector<std::vector<uint8_t>>*>(context);
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  buffers->emplace_back(bytes, bytes + size);
+  return true;
+}
+
+bool fail_stream(void* context, const void* data, size_t size) {
+  (void)context;
+  (void)data;
+  (void)size;
+  return false;
+}
+
+etdump_RunData_vec_t streamed_run_data(const std::vector<uint8_t>& buffer) {
+  size_t size = 0;
+  void* buf = flatbuffers_read_size_prefix(
+      const_cast<uint8_t*>(buffer.data()), &size);
+  etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+      buf, etdump_ETDump_file_identifier);
+  return etdump != nullptr ? etdump_ETDump_run_data(etdump) : nullptr;
+}
+
+std::string block_name(etdump_RunData_vec_t run_data_vec, size_t i) {
+  etdump_RunData_table_t run_data = etdump_RunData_vec_at(run_data_vec, i);
+  return std::string(
+      etdump_RunData_name(run_data), strlen(etdump_RunData_name(run_data)));
+}
+
+} // namespace
+
+TEST_F(ProfilerETDumpTest, StreamedBlocks) {
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<std::vector<uint8_t>> buffers;
+    etdump_gen[i]->enable_streaming(
+        collect_stream, &buffers, /*blocks_per_flush=*/2);
+    ASSERT_TRUE(etdump_gen[i]->is_streaming());
+
+    const char* block_names[] = {"block_0", "block_1", "block_2", "block_3"};
+    for (const char* name : block_names) {
+      etdump_gen[i]->create_event_block(name);
+      EventTracerEntry entry =
+          etdump_gen[i]->start_profiling("test_event", 0, 1);
+      etdump_gen[i]->end_profiling(entry);
+    }
+    // Blocks 0 and 1 were written when block 2 started.
+    ASSERT_EQ(buffers.size(), 1);
+    EXPECT_EQ(etdump_gen[i]->get_num_streamed_blocks(), 2);
+    EXPECT_EQ(etdump_gen[i]->get_num_blocks(), 2);
+
+    // The rest are written by get_etdump_data().
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    EXPECT_EQ(result.buf, nullptr);
+    EXPECT_EQ(result.size, 0);
+    ASSERT_EQ(buffers.size(), 2);
+    EXPECT_EQ(etdump_gen[i]->get_num_streamed_blocks(), 4);
+
+    for (size_t b = 0; b < buffers.size(); ++b) {
+      etdump_RunData_vec_t run_data_vec = streamed_run_data(buffers[b]);
+      ASSERT_NE(run_data_vec, nullptr);
+      ASSERT_EQ(etdump_RunData_vec_len(run_data_vec), 2);
+      EXPECT_EQ(block_name(run_data_vec, 0), block_names[2 * b]);
+      EXPECT_EQ(block_name(run_data_vec, 1), block_names[2 * b + 1]);
+      EXPECT_EQ(
+          etdump_Event_vec_len(etdump_RunData_events(
+              etdump_RunData_vec_at(run_data_vec, 1))),
+          1);
+    }
+
+    etdump_gen[i]->disable_streaming();
+    EXPECT_FALSE(etdump_gen[i]->is_streaming());
+    EXPECT_EQ(etdump_gen[i]->flush_stream(), Error::InvalidState);
+  }
+}
+
+TEST_F(ProfilerETDumpTest, FlushStreamContinuesBlock) {
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<std::vector<uint8_t>> buffers;
+    etdump_gen[i]->enable_streaming(collect_stream, &buffers);
+
+    etdump_gen[i]->create_event_block("long_block");
+    EventTracerEntry entry = etdump_gen[i]->start_profiling("event_0", 0, 1);
+    etdump_gen[i]->end_profiling(entry);
+    ASSERT_EQ(etdump_gen[i]->flush_stream(), Error::Ok);
+    ASSERT_EQ(buffers.size(), 1);
+
+    // Events after the flush go to a new block of the same name.
+    entry = etdump_gen[i]->start_profiling("event_1", 0, 2);
+    etdump_gen[i]->end_profiling(entry);
+    (void)etdump_gen[i]->get_etdump_data();
+    ASSERT_EQ(buffers.size(), 2);
+
+    etdump_RunData_vec_t run_data_vec = streamed_run_data(buffers[1]);
+    ASSERT_NE(run_data_vec, nullptr);
+    ASSERT_EQ(etdump_RunData_vec_len(run_data_vec), 1);
+    EXPECT_EQ(block_name(run_data_vec, 0), "long_block");
+    etdump_Event_vec_t event_vec =
+        etdump_RunData_events(etdump_RunData_vec_at(run_data_vec, 0));
+    ASSERT_EQ(etdump_Event_vec_len(event_vec), 1);
+    flatbuffers_string_t event_name = etdump_ProfileEvent_name(
+        etdump_Event_profile_event(etdump_Event_vec_at(event_vec, 0)));
+    EXPECT_EQ(std::string(event_name, strlen(event_name)), "event_1");
+
+    // A failed write drops the blocks.
+    etdump_gen[i]->enable_streaming(fail_stream, nullptr);
+    etdump_gen[i]->create_event_block("dropped_block");
+    EXPECT_EQ(etdump_gen[i]->flush_stream(), Error::AccessFailed);
+    EXPECT_EQ(etdump_gen[i]->get_num_streamed_blocks(), 0);
+    etdump_gen[i]->disable_streaming();
+  }
+}
+
+TEST_F(ProfilerETDumpTest, PerfCounters) {
+  for (size_t i = 0; i < 2; i++) {
+    // The counters are not available on every machine, e.g. in containers.
+    const bool capturing = etdump_gen[i]->enable_perf_counters() == Error::Ok;
+    EXPECT_EQ(etdump_gen[i]->is_capturing_perf_counters(), capturing);
+
+    etdump_gen[i]->create_event_block("test_block");
+    EventTracerEntry entry = etdump_gen[i]->start_profiling("test_event", 0, 1);
+    etdump_gen[i]->end_profiling(entry);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+
+    size_t size = 0;
+    void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+    etdump_ETDump_table_t etdump = etdump_ETDump_as_root_with_identifier(
+        buf, etdump_ETDump_file_identifier);
+    ASSERT_NE(etdump, nullptr);
+
+    etdump_RunData_table_t run_data =
+        etdump_RunData_vec_at(etdump_ETDump_run_data(etdump), 0);
+    etdump_ProfileEvent_table_t profile_event = etdump_Event_profile_event(
+        etdump_Event_vec_at(etdump_RunData_events(run_data), 0));
+    etdump_PerfCounters_struct_t perf_counters =
+        etdump_ProfileEvent_perf_counters(profile_event);
+    if (capturing) {
+      ASSERT_NE(perf_counters, nullptr);
+    } else {
+      EXPECT_EQ(perf_counters, nullptr);
+    }
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+    etdump_gen[i]->disable_perf_counters();
+    EXPECT_FALSE(etdump_gen[i]->is_capturing_perf_counters());
+  }
+}
+
+TEST_F(ProfilerETDumpTest, ChromeTrace) {
+  for (size_t i = 0; i < 2; i++) {
+    etdump_gen[i]->create_event_block("test_block");
+    EventTracerEntry entry = etdump_gen[i]->start_profiling("test_event", 0, 1);
+    EventTracerEntry delegate_entry = etdump_gen[i]->start_profiling_delegate(
+        "test_delegate\"op", static_cast<torch::executor::DebugHandle>(-1));
+    etdump_gen[i]->end_profiling_delegate(delegate_entry, nullptr, 0);
+    etdump_gen[i]->end_profiling(entry);
+    etdump_gen[i]->log_profiling_delegate(nullptr, 276, 1, 2, nullptr, 0);
+
+    etdump_result result = etdump_gen[i]->get_etdump_data();
+    ASSERT_TRUE(result.buf != nullptr);
+
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    ASSERT_EQ(write_chrome_trace(result.buf, result.size, f), Error::Ok);
+    std::string trace(ftell(f), '\0');
+    rewind(f);
+    ASSERT_EQ(fread(&trace[0], 1, trace.size(), f), trace.size());
+    fclose(f);
+
+    EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"test_event\""), std::string::npos);
+    EXPECT_NE(
+        trace.find("\"name\":\"test_delegate\\\"op\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"delegate 276\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"test_block\""), std::string::npos);
+
+    if (!etdump_gen[i]->is_static_etdump()) {
+      free(result.buf);
+    }
+  }
+
+  uint8_t not_etdump[16] = {};
+  EXPECT_EQ(
+      write_chrome_trace(not_etdump, sizeof(not_etdump), stdout),
+      Error::InvalidArgument);
+}
+
 } // namespace executor
 } // namespace torch
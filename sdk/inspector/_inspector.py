@@ -37,6 +37,8 @@ from executorch.sdk.etdump.schema_flatcc import DebugEvent, ETDumpFlatCC, Profil
 from executorch.sdk.etrecord import ETRecord, parse_etrecord
 from executorch.sdk.inspector._inspector_utils import (
     create_debug_handle_to_op_node_mapping,
+    DELEGATE_NODE_EXECUTE_EVENT_TYPE,
+    DELEGATE_PROFILING_EVENT_TYPES,
     EDGE_DIALECT_GRAPH_KEY,
     EXCLUDED_COLUMNS_WHEN_PRINTING,
     EXCLUDED_EVENTS_WHEN_PRINTING,
@@ -292,6 +294,8 @@ class Event:
             Available as Event.raw_delegate_debug_metadatas
 
         debug_data: A list containing intermediate data collected.
+        perf_counters: A dictionary mapping the name of each hardware performance counter captured by the runtime, e.g. cycles, to its values over the event (available attributes as in perf_data).
+        memory_traffic: A dictionary mapping the id of each memory-planned buffer (-1 for tensors that are not memory planned) to the average bytes the event read from and wrote to it, if the runtime traced memory traffic.
 
         _instruction_id: Instruction Identifier for Symbolication
         _delegate_metadata_parser: Optional Parser for _delegate_debug_metadatas
@@ -309,6 +313,10 @@ class Event:
     _delegate_debug_metadatas: List[str] = dataclasses.field(default_factory=list)
 
     debug_data: ProgramOutput = dataclasses.field(default_factory=list)
+    perf_counters: Dict[str, PerfData] = dataclasses.field(default_factory=dict)
+    memory_traffic: Dict[int, Tuple[float, float]] = dataclasses.field(
+        default_factory=dict
+    )
     _instruction_id: Optional[int] = None
 
     _delegate_metadata_parser: Optional[Callable[[List[str]], Dict[str, Any]]] = None
@@ -333,6 +341,35 @@ class Event:
         """
         return self._delegate_debug_metadatas
 
+    @property
+    def delegate_event_type(self) -> Optional[str]:
+        """
+        Returns the phase of the delegate profiled by a delegated event, one of
+        the values of DELEGATE_PROFILING_EVENT_TYPES for the events with the
+        reserved names, or "node_execute" for the execution of a node. None if
+        the event is not delegated.
+        """
+        if not self.is_delegated_op:
+            return None
+        return DELEGATE_PROFILING_EVENT_TYPES.get(
+            str(self.delegate_debug_identifier), DELEGATE_NODE_EXECUTE_EVENT_TYPE
+        )
+
+    @property
+    def delegate_memory_usage_bytes(self) -> Optional[int]:
+        """
+        Returns the largest number of bytes reported by a DELEGATE_MEMORY_USAGE
+        event, None for other events.
+        """
+        if self.delegate_event_type != "memory_usage":
+            return None
+        values = [
+            int(metadata)
+            for metadata in self._delegate_debug_metadatas
+            if metadata.isdigit()
+        ]
+        return max(values) if values else None
+
     def to_dataframe(self, _units="") -> pd.DataFrame:
         """
         Convert the Event into a pandas DataFrame
@@ -449,6 +486,8 @@ class Event:
             is_delegated_op
             perf_data
             delegate_debug_metadatas
+            perf_counters
+            memory_traffic
         """
 
         # Fill out fields from profile event signature
@@ -476,6 +515,8 @@ class Event:
         # Fill out fields from profile event
         data = []
         delegate_debug_metadatas = []
+        perf_counters: Dict[str, List[float]] = {}
+        memory_traffic: Dict[int, List[Tuple[int, int]]] = {}
         for event in events:
             if (profile_events := event.profile_events) is not None:
                 if len(profile_events) != 1:
@@ -517,10 +558,29 @@ class Event:
                     if profile_event.delegate_debug_metadata
                     else ""
                 )
+                if (counters := profile_event.perf_counters) is not None:
+                    for counter in dataclasses.fields(counters):
+                        perf_counters.setdefault(counter.name, []).append(
+                            float(getattr(counters, counter.name))
+                        )
+                for traffic in profile_event.memory_traffic or []:
+                    memory_traffic.setdefault(traffic.mem_id, []).append(
+                        (traffic.bytes_read, traffic.bytes_written)
+                    )
 
         # Update fields
         if len(data) > 0:
             ret_event.perf_data = PerfData(data)
+        ret_event.perf_counters = {
+            name: PerfData(values) for name, values in perf_counters.items()
+        }
+        ret_event.memory_traffic = {
+            mem_id: (
+                float(np.mean([read for read, _ in values])),
+                float(np.mean([written for _, written in values])),
+            )
+            for mem_id, values in memory_traffic.items()
+        }
         if any(delegate_debug_metadatas):
             ret_event._delegate_debug_metadatas = delegate_debug_metadatas
 
@@ -614,7 +674,11 @@ class EventBlock:
     reference_output: Optional[ProgramOutput] = None
 
     def to_dataframe(
-        self, include_units: bool = False, include_delegate_debug_data: bool = False
+        self,
+        include_units: bool = False,
+        include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
+        include_memory_traffic: bool = False,
     ) -> pd.DataFrame:
         """
         Converts the EventBlock into a DataFrame with each row being an event instance
@@ -625,6 +689,13 @@ class EventBlock:
         Args:
             include_units: Whether headers should include units (default false)
             include_delegate_debug_data: Whether to show the delegate debug data
+            include_perf_counters: Whether to show the average hardware performance
+                counters of each event, and its instructions per cycle (ipc). Memory
+                bound events have a low ipc and a high share of stalled cycles.
+            include_memory_traffic: Whether to show the average bytes each event read
+                and wrote, its achieved bandwidth in GB/s and, along with the
+                performance counters, its instructions per byte, as an estimate of
+                its arithmetic intensity.
 
         Returns:
             A pandas DataFrame containing the data of each Event instance in this EventBlock.
@@ -663,6 +734,54 @@ class EventBlock:
             if any(not data.empty for data in delegate_data):
                 df = pd.concat([df, pd.DataFrame(delegate_data)], axis=1)
 
+        # Add hardware performance counter columns
+        if include_perf_counters:
+            counter_data = []
+            for event in self.events:
+                counters = {
+                    "avg_" + name: data.avg
+                    for name, data in event.perf_counters.items()
+                }
+                cycles = counters.get("avg_cycles")
+                instructions = counters.get("avg_instructions")
+                if cycles and instructions is not None:
+                    counters["ipc"] = instructions / cycles
+                counter_data.append(pd.Series(counters, dtype=float))
+
+            if any(not data.empty for data in counter_data):
+                df = pd.concat([df, pd.DataFrame(counter_data)], axis=1)
+
+        # Add memory traffic columns
+        if include_memory_traffic:
+            traffic_data = []
+            for event in self.events:
+                traffic = {}
+                if event.memory_traffic:
+                    bytes_read = sum(r for r, _ in event.memory_traffic.values())
+                    bytes_written = sum(w for _, w in event.memory_traffic.values())
+                    bytes_moved = bytes_read + bytes_written
+                    traffic["avg_bytes_read"] = bytes_read
+                    traffic["avg_bytes_written"] = bytes_written
+                    if (
+                        event.perf_data is not None
+                        and event.perf_data.avg > 0
+                        and self.target_time_scale != TimeScale.CYCLES
+                    ):
+                        seconds = (
+                            event.perf_data.avg
+                            / TIME_SCALE_DICT[self.target_time_scale]
+                        )
+                        traffic["bandwidth_gbps"] = bytes_moved / seconds / 1e9
+                    instructions = event.perf_counters.get("instructions")
+                    if instructions is not None and bytes_moved > 0:
+                        traffic["instructions_per_byte"] = (
+                            instructions.avg / bytes_moved
+                        )
+                traffic_data.append(pd.Series(traffic, dtype=float))
+
+            if any(not data.empty for data in traffic_data):
+                df = pd.concat([df, pd.DataFrame(traffic_data)], axis=1)
+
         return df
 
     @staticmethod
@@ -845,9 +964,10 @@ class EventBlock:
             if (delegate_debug_id := event.delegate_debug_identifier) is None:
                 event.debug_handles = handle_map[instruction_id]
 
-                # DELEGATE_CALL is a special non-delegated event and benefits from having the name populated
+                # DELEGATE_CALL and the init of the delegate it calls are special
+                # non-delegated events and benefit from having the name populated
                 if (
-                    event.name == "DELEGATE_CALL"
+                    event.name in ("DELEGATE_CALL", "Method::init_delegate")
                     and delegate_map is not None
                     and (delegate_metadata := delegate_map.get(instruction_id))
                     is not None
@@ -869,6 +989,11 @@ class EventBlock:
 
             # For delegated events, handles are found via delegateMetadata
             event.delegate_backend_name = delegate_metadata.get("name", "")
+
+            # The phases of the delegate do not correspond to nodes
+            if event.delegate_event_type != DELEGATE_NODE_EXECUTE_EVENT_TYPE:
+                continue
+
             delegate_metadata_delegate_map = delegate_metadata.get("delegate_map", {})
 
             # delegate_debug_id can be either int based or string based, therefore we need to check both
@@ -1040,11 +1165,15 @@ class Inspector:
         self,
         include_units: bool = True,
         include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
+        include_memory_traffic: bool = False,
     ) -> pd.DataFrame:
         """
         Args:
             include_units: Whether headers should include units (default true)
             include_delegate_debug_data: Whether to include delegate debug metadata (default false)
+            include_perf_counters: Whether to include hardware performance counters (default false)
+            include_memory_traffic: Whether to include the bytes moved by each event (default false)
 
         Returns:
             Returns a pandas DataFrame of the Events in each EventBlock in the inspector, with each row representing an Event.
@@ -1054,6 +1183,8 @@ class Inspector:
             event_block.to_dataframe(
                 include_units=include_units,
                 include_delegate_debug_data=include_delegate_debug_data,
+                include_perf_counters=include_perf_counters,
+                include_memory_traffic=include_memory_traffic,
             )
             for event_block in self.event_blocks
         ]
@@ -1064,6 +1195,8 @@ class Inspector:
         file: IO[str] = sys.stdout,
         include_units: bool = True,
         include_delegate_debug_data: bool = False,
+        include_perf_counters: bool = False,
+        include_memory_traffic: bool = False,
     ) -> None:
         """
         Displays the underlying EventBlocks in a structured tabular format, with each row representing an Event.
@@ -1073,11 +1206,18 @@ class Inspector:
                 Not used if this is in an IPython environment such as a Jupyter notebook.
             include_units: Whether headers should include units (default true)
             include_delegate_debug_data: Whether to include delegate debug metadata (default false)
+            include_perf_counters: Whether to include hardware performance counters (default false)
+            include_memory_traffic: Whether to include the bytes moved by each event (default false)
 
         Returns:
             None
         """
-        combined_df = self.to_dataframe(include_units, include_delegate_debug_data)
+        combined_df = self.to_dataframe(
+            include_units,
+            include_delegate_debug_data,
+            include_perf_counters,
+            include_memory_traffic,
+        )
 
         # Filter out some columns and rows for better readability when printing
         filtered_column_df = combined_df.drop(columns=EXCLUDED_COLUMNS_WHEN_PRINTING)
@@ -1107,6 +1247,54 @@ class Inspector:
                 file=file,
             )
 
+    def delegate_profiling_summary(self, include_units: bool = True) -> pd.DataFrame:
+        """
+        Summarizes the time spent in each phase of each delegate backend, so
+        that backends can be compared: compile and init during the load of the
+        method, data transfer and execute, as well as the execution of the
+        nodes and the memory usage they reported. The backend names come from
+        ETRecord, so they are None without one. The phases of init() are only
+        profiled for delegates that are not initialized in parallel.
+
+        Args:
+            include_units: Whether headers should include units (default true)
+
+        Returns:
+            A pandas DataFrame with a row per event block, backend and phase,
+            holding the number of events, the sum of their average times and,
+            for memory usage, the largest number of bytes reported.
+        """
+        rows = []
+        for block in self.event_blocks:
+            units = (
+                " (" + block.target_time_scale.value + ")" if include_units else ""
+            )
+            summary: Dict[Tuple[Optional[str], str], Dict[str, Any]] = OrderedDict()
+            for event in block.events:
+                if (event_type := event.delegate_event_type) is None:
+                    continue
+                row = summary.setdefault(
+                    (event.delegate_backend_name, event_type),
+                    {"num_events": 0, "avg": 0.0, "memory_bytes": None},
+                )
+                row["num_events"] += 1
+                if event.perf_data is not None:
+                    row["avg"] += event.perf_data.avg
+                if (num_bytes := event.delegate_memory_usage_bytes) is not None:
+                    row["memory_bytes"] = max(row["memory_bytes"] or 0, num_bytes)
+            for (backend_name, event_type), row in summary.items():
+                rows.append(
+                    {
+                        "event_block_name": block.name,
+                        "delegate_backend_name": backend_name,
+                        "event_type": event_type,
+                        "num_events": row["num_events"],
+                        "avg" + units: row["avg"],
+                        "memory_bytes": row["memory_bytes"],
+                    }
+                )
+        return pd.DataFrame(rows)
+
     # TODO: write unit test
     def find_total_for_module(self, module_name: str) -> float:
         """
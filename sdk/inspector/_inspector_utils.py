@@ -21,6 +21,7 @@ from executorch.sdk.etdump.schema_flatcc import (
     ProfileEvent,
     ScalarType,
     Tensor,
+    TensorCompression,
     Value,
     ValueType,
 )
@@ -35,6 +36,15 @@ RESERVED_FRAMEWORK_EVENT_NAMES = [
     "Method::init",
     "Program::load_method",
     "Method::execute",
+    # Steps of the load, in the "load" event block
+    "Program::load",
+    "Program::check_header",
+    "Program::load_data",
+    "Program::verify_internal_consistency",
+    "Program::load_constant_segment",
+    "Method::parse_values",
+    "Method::init_delegates",
+    "Method::resolve_operators",
 ]
 EXCLUDED_COLUMNS_WHEN_PRINTING = [
     "raw",
@@ -45,6 +55,18 @@ EXCLUDED_COLUMNS_WHEN_PRINTING = [
 ]
 EXCLUDED_EVENTS_WHEN_PRINTING = {"OPERATOR_CALL"}
 
+# Delegate events with the names reserved by runtime/backend/delegate_profiling.h,
+# mapped to the phase of the delegate they profile. The other delegate events
+# profile the execution of a node.
+DELEGATE_PROFILING_EVENT_TYPES = {
+    "DELEGATE_COMPILE": "compile",
+    "DELEGATE_INIT": "init",
+    "DELEGATE_EXECUTE": "execute",
+    "DELEGATE_DATA_TRANSFER": "data_transfer",
+    "DELEGATE_MEMORY_USAGE": "memory_usage",
+}
+DELEGATE_NODE_EXECUTE_EVENT_TYPE = "node_execute"
+
 
 class TimeScale(Enum):
     NS = "ns"
@@ -70,6 +92,40 @@ InferenceOutput: TypeAlias = Union[
 ProgramOutput: TypeAlias = List[InferenceOutput]
 
 
+def tensor_checksum(data: bytes) -> int:
+    """
+    Returns the checksum that ETDumpGen logs for a tensor with these bytes in
+    the checksum tensor mode: FNV-1a over the 8-byte little-endian words of the
+    data, the last one padded with zeros, starting from the size, with a
+    xorshift after each word.
+    """
+    mask = (1 << 64) - 1
+    checksum = 0xCBF29CE484222325 ^ len(data)
+    for i in range(0, len(data), 8):
+        word = int.from_bytes(data[i : i + 8], "little")
+        checksum = ((checksum ^ word) * 0x100000001B3) & mask
+        checksum ^= checksum >> 32
+    return checksum
+
+
+def _decode_zero_run_length(buffer: bytes, offset: int, size: int) -> bytes:
+    """
+    Decodes `size` bytes of tensor data stored with the ZeroRunLength
+    compression at `offset` of the debug buffer.
+    """
+    data = bytearray()
+    while len(data) < size:
+        num_zeros = int.from_bytes(buffer[offset : offset + 4], "little")
+        num_literals = int.from_bytes(buffer[offset + 4 : offset + 8], "little")
+        offset += 8
+        data += bytes(num_zeros)
+        data += buffer[offset : offset + num_literals]
+        offset += num_literals
+        if num_zeros == 0 and num_literals == 0:
+            raise ValueError("Corrupted ZeroRunLength tensor data")
+    return bytes(data[:size])
+
+
 # Given a ETDump Tensor object and offset, extract into a torch.Tensor
 def _parse_tensor_value(
     tensor: Optional[Tensor], output_buffer: Optional[bytes]
@@ -113,10 +169,18 @@ def _parse_tensor_value(
     if tensor.offset is None:
         raise ValueError("Tensor offset cannot be None")
 
-    return torch.frombuffer(
-        output_buffer[tensor.offset : tensor.offset + tensor_bytes_size],
-        dtype=torch_dtype,
-    ).view(tensor.sizes)
+    if tensor.checksum is not None and tensor.offset < 0:
+        # Only a checksum of the data was logged.
+        return torch.zeros(tensor.sizes, dtype=torch_dtype)
+
+    if tensor.compression == TensorCompression.ZERO_RUN_LENGTH.value:
+        data = _decode_zero_run_length(
+            output_buffer, tensor.offset, tensor_bytes_size
+        )
+    else:
+        data = output_buffer[tensor.offset : tensor.offset + tensor_bytes_size]
+
+    return torch.frombuffer(data, dtype=torch_dtype).view(tensor.sizes)
 
 
 def inflate_runtime_output(
@@ -17,7 +17,11 @@ from unittest.mock import patch
 from executorch.exir import ExportedProgram
 from executorch.sdk import generate_etrecord, parse_etrecord
 from executorch.sdk.debug_format.et_schema import OperatorNode
-from executorch.sdk.etdump.schema_flatcc import ProfileEvent
+from executorch.sdk.etdump.schema_flatcc import (
+    MemoryTraffic,
+    PerfCounters,
+    ProfileEvent,
+)
 from executorch.sdk.etrecord.tests.etrecord_test import TestETRecord
 
 from executorch.sdk.inspector import _inspector, Event, EventBlock, Inspector, PerfData
@@ -26,6 +30,7 @@ from executorch.sdk.inspector._inspector import (
     InstructionEventSignature,
     ProfileEventSignature,
 )
+from executorch.sdk.inspector._inspector_utils import TimeScale
 
 
 OP_TYPE = "aten::add"
@@ -232,6 +237,156 @@ class TestInspector(unittest.TestCase):
         # Value of the perf data after scaling is done. 200/10 - 100/10.
         self.assertEqual(event.perf_data.raw[0], 10)
 
+    def test_populate_perf_counters(self):
+        event = Event(name="")
+        event_signature = ProfileEventSignature(name="test_event", instruction_id=0)
+        instruction_events = [
+            InstructionEvent(
+                signature=InstructionEventSignature(0, 0),
+                profile_events=[
+                    ProfileEvent(
+                        name="test_event",
+                        chain_index=0,
+                        instruction_id=0,
+                        delegate_debug_id_int=None,
+                        delegate_debug_id_str=None,
+                        start_time=100,
+                        end_time=200,
+                        delegate_debug_metadata=None,
+                        perf_counters=PerfCounters(
+                            cycles=1000 * run,
+                            instructions=500 * run,
+                            l1d_cache_misses=10,
+                            ll_cache_misses=2,
+                            stalled_cycles=400,
+                        ),
+                    )
+                ],
+            )
+            for run in (1, 3)
+        ]
+        Event._populate_profiling_related_fields(
+            event, event_signature, instruction_events, 1
+        )
+        self.assertEqual(event.perf_counters["cycles"].raw, [1000, 3000])
+        self.assertEqual(event.perf_counters["instructions"].avg, 1000)
+
+        df = EventBlock(name=EVENT_BLOCK_NAME, events=[event]).to_dataframe(
+            include_perf_counters=True
+        )
+        self.assertEqual(df["avg_cycles"].values[0], 2000)
+        self.assertEqual(df["ipc"].values[0], 0.5)
+
+    def test_populate_memory_traffic(self):
+        event = Event(name="")
+        event_signature = ProfileEventSignature(name="test_event", instruction_id=0)
+        instruction_events = [
+            InstructionEvent(
+                signature=InstructionEventSignature(0, 0),
+                profile_events=[
+                    ProfileEvent(
+                        name="test_event",
+                        chain_index=0,
+                        instruction_id=0,
+                        delegate_debug_id_int=None,
+                        delegate_debug_id_str=None,
+                        start_time=0,
+                        end_time=1000,
+                        delegate_debug_metadata=None,
+                        perf_counters=PerfCounters(
+                            cycles=2000,
+                            instructions=1200,
+                            l1d_cache_misses=0,
+                            ll_cache_misses=0,
+                            stalled_cycles=0,
+                        ),
+                        memory_traffic=[
+                            MemoryTraffic(
+                                mem_id=0, bytes_read=1000 * run, bytes_written=500
+                            ),
+                            MemoryTraffic(
+                                mem_id=-1, bytes_read=500, bytes_written=0
+                            ),
+                        ],
+                    )
+                ],
+            )
+            for run in (1, 3)
+        ]
+        Event._populate_profiling_related_fields(
+            event, event_signature, instruction_events, 1
+        )
+        self.assertEqual(event.memory_traffic, {0: (2000, 500), -1: (500, 0)})
+
+        # The event took 1000 ns, as the target time scale is the source one.
+        df = EventBlock(
+            name=EVENT_BLOCK_NAME,
+            events=[event],
+            source_time_scale=TimeScale.NS,
+            target_time_scale=TimeScale.NS,
+        ).to_dataframe(include_memory_traffic=True)
+        self.assertEqual(df["avg_bytes_read"].values[0], 2500)
+        self.assertEqual(df["avg_bytes_written"].values[0], 500)
+        self.assertAlmostEqual(df["bandwidth_gbps"].values[0], 3.0)
+        self.assertAlmostEqual(df["instructions_per_byte"].values[0], 0.4)
+
+    def test_inspector_delegate_profiling_summary(self):
+        def delegate_event(name, backend, avg, metadata=None):
+            return Event(
+                name=name,
+                perf_data=PerfData([avg]),
+                delegate_debug_identifier=name,
+                is_delegated_op=True,
+                delegate_backend_name=backend,
+                _delegate_debug_metadatas=metadata or [],
+            )
+
+        with patch.object(
+            _inspector, "parse_etrecord", return_value=None
+        ), patch.object(
+            _inspector, "gen_etdump_object", return_value=None
+        ), patch.object(
+            EventBlock, "_gen_from_etdump"
+        ), patch.object(
+            _inspector, "gen_graphs_from_etrecord"
+        ):
+            inspector_instance = Inspector(
+                etdump_path=ETDUMP_PATH,
+                etrecord=ETRECORD_PATH,
+            )
+
+            events = [
+                Event(name="DELEGATE_CALL", perf_data=PerfData([10.0])),
+                delegate_event("DELEGATE_DATA_TRANSFER", "XnnpackBackend", 1.0),
+                delegate_event("DELEGATE_EXECUTE", "XnnpackBackend", 6.0),
+                delegate_event("conv #1", "XnnpackBackend", 2.0),
+                delegate_event("linear #1", "XnnpackBackend", 3.0),
+                delegate_event("DELEGATE_EXECUTE", "VulkanBackend", 4.0),
+                delegate_event("DELEGATE_MEMORY_USAGE", "VulkanBackend", 0.0, ["4096"]),
+            ]
+            self.assertIsNone(events[0].delegate_event_type)
+            self.assertEqual(events[1].delegate_event_type, "data_transfer")
+            self.assertEqual(events[3].delegate_event_type, "node_execute")
+            self.assertEqual(events[6].delegate_memory_usage_bytes, 4096)
+            inspector_instance.event_blocks = [
+                EventBlock(name=EVENT_BLOCK_NAME, events=events)
+            ]
+
+            df = inspector_instance.delegate_profiling_summary()
+            self.assertEqual(
+                list(zip(df["delegate_backend_name"], df["event_type"])),
+                [
+                    ("XnnpackBackend", "data_transfer"),
+                    ("XnnpackBackend", "execute"),
+                    ("XnnpackBackend", "node_execute"),
+                    ("VulkanBackend", "execute"),
+                    ("VulkanBackend", "memory_usage"),
+                ],
+            )
+            self.assertEqual(list(df["num_events"]), [1, 1, 2, 1, 1])
+            self.assertEqual(list(df["avg (ms)"]), [1.0, 6.0, 5.0, 4.0, 0.0])
+            self.assertEqual(df["memory_bytes"].values[4], 4096)
+
     def test_inspector_get_exported_program(self):
         # Create a context manager to patch functions called by Inspector.__init__
         with patch.object(
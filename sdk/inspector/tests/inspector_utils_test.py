@@ -8,6 +8,8 @@ import tempfile
 import unittest
 from typing import Dict, Tuple
 
+import torch
+
 from executorch.sdk import generate_etrecord, parse_etrecord
 
 from executorch.sdk.debug_format.base_schema import (
@@ -25,6 +27,8 @@ from executorch.sdk.inspector._inspector_utils import (
     EDGE_DIALECT_GRAPH_KEY,
     find_populated_event,
     gen_graphs_from_etrecord,
+    inflate_runtime_output,
+    tensor_checksum,
 )
 
 
@@ -126,6 +130,42 @@ class TestInspectorUtils(unittest.TestCase):
         )
         self.assertEqual(find_populated_event(event), profile_event)
 
+    def test_inflate_compressed_tensor(self):
+        data = torch.tensor([0.0] * 8 + [1.0, 2.0] + [0.0] * 6)
+        # 32 zero bytes, then 8 literal bytes and 24 zero bytes.
+        buffer = (
+            (32).to_bytes(4, "little")
+            + (8).to_bytes(4, "little")
+            + data[8:10].numpy().tobytes()
+            + (24).to_bytes(4, "little")
+            + (0).to_bytes(4, "little")
+        )
+        value = flatcc.Value(
+            val=flatcc.ValueType.TENSOR.value,
+            tensor=flatcc.Tensor(
+                scalar_type=flatcc.ScalarType.FLOAT,
+                sizes=[16],
+                strides=[1],
+                offset=0,
+                compression=flatcc.TensorCompression.ZERO_RUN_LENGTH.value,
+            ),
+            tensor_list=None,
+            int_value=None,
+            float_value=None,
+            double_value=None,
+            bool_value=None,
+            output=None,
+        )
+        self.assertTrue(torch.equal(inflate_runtime_output(value, buffer), data))
+
+    def test_tensor_checksum(self):
+        data = torch.ones(3).numpy().tobytes()
+        # As computed by ETDumpGen.
+        self.assertEqual(tensor_checksum(data), 0x6581166EB45CD8DD)
+        self.assertNotEqual(tensor_checksum(data), tensor_checksum(bytes(12)))
+        # Padding the last word with zeros keeps the size in the checksum.
+        self.assertNotEqual(tensor_checksum(bytes(4)), tensor_checksum(bytes(8)))
+
 
 def gen_mock_operator_graph_with_expected_map() -> (
     Tuple[OperatorGraph, Dict[int, OperatorNode]]
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/sdk/op_stats/op_stats.h>
+
+#include <inttypes.h>
+#include <string.h>
+#include <algorithm>
+
+#include <executorch/runtime/platform/assert.h>
+
+namespace torch {
+namespace executor {
+
+namespace {
+
+uint64_t hash_key(bool is_delegate, ChainID chain_id, DebugHandle handle) {
+  uint64_t key =
+      (static_cast<uint64_t>(static_cast<uint32_t>(chain_id)) << 32) | handle;
+  key ^= is_delegate ? 0x9e3779b97f4a7c15 : 0;
+  // The finalizer of splitmix64.
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111eb;
+  key ^= key >> 31;
+  return key;
+}
+
+// Single writer, so no read-modify-write is needed.
+void store_relaxed(std::atomic<uint64_t>& value, uint64_t new_value) {
+  value.store(new_value, std::memory_order_relaxed);
+}
+
+uint64_t load_relaxed(const std::atomic<uint64_t>& value) {
+  return value.load(std::memory_order_relaxed);
+}
+
+size_t bucket_of(uint64_t ns) {
+  if (ns < 2) {
+    return 0;
+  }
+  const size_t log2 = 63 - __builtin_clzll(ns);
+  return std::min(log2, kOpStatsNumBuckets - 1);
+}
+
+// Interpolates the latency at quantile `q` linearly in its bucket.
+double quantile(
+    const uint64_t* buckets,
+    uint64_t count,
+    double q,
+    uint64_t min_ns,
+    uint64_t max_ns) {
+  const double rank = q * count;
+  uint64_t num_below = 0;
+  for (size_t i = 0; i < kOpStatsNumBuckets; ++i) {
+    if (buckets[i] > 0 && num_below + buckets[i] >= rank) {
+      const double low = i == 0 ? 0.0 : static_cast<double>(1ull << i);
+      const double high = i == kOpStatsNumBuckets - 1
+          ? std::max(low, static_cast<double>(max_ns))
+          : static_cast<double>(1ull << (i + 1));
+      const double value =
+          low + (high - low) * (rank - num_below) / buckets[i];
+      return std::min(
+          std::max(value, static_cast<double>(min_ns)),
+          static_cast<double>(max_ns));
+    }
+    num_below += buckets[i];
+  }
+  return static_cast<double>(max_ns);
+}
+
+void summarize(const op_stats_entry& entry, op_latency_summary& summary) {
+  memcpy(summary.name, entry.name, kOpStatsMaxNameLen);
+  summary.is_delegate = entry.is_delegate;
+  summary.chain_id = entry.chain_id;
+  summary.debug_handle = entry.debug_handle;
+  // A consistent count for the quantiles, even if the entry is being
+  // updated.
+  uint64_t buckets[kOpStatsNumBuckets];
+  uint64_t count = 0;
+  for (size_t i = 0; i < kOpStatsNumBuckets; ++i) {
+    buckets[i] = load_relaxed(entry.buckets[i]);
+    count += buckets[i];
+  }
+  summary.count = count;
+  summary.total_ns = load_relaxed(entry.sum_ns);
+  summary.min_ns = count > 0 ? load_relaxed(entry.min_ns) : 0;
+  summary.max_ns = load_relaxed(entry.max_ns);
+  summary.mean_ns =
+      count > 0 ? static_cast<double>(summary.total_ns) / count : 0.0;
+  summary.p50_ns =
+      quantile(buckets, count, 0.50, summary.min_ns, summary.max_ns);
+  summary.p90_ns =
+      quantile(buckets, count, 0.90, summary.min_ns, summary.max_ns);
+  summary.p99_ns =
+      quantile(buckets, count, 0.99, summary.min_ns, summary.max_ns);
+}
+
+double ns_to_us(double ns) {
+  return ns / 1000.0;
+}
+
+} // namespace
+
+OpStatsTracer::OpStatsTracer(Span<op_stats_entry> table)
+    : table_(table), tick_ratio_(et_pal_ticks_to_ns_multiplier()) {
+  ET_CHECK_MSG(!table.empty(), "The op stats table must not be empty.");
+}
+
+void OpStatsTracer::create_event_block(__ET_UNUSED const char* name) {
+  num_blocks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+op_stats_entry* OpStatsTracer::find_entry(
+    const char* name,
+    bool is_delegate,
+    ChainID chain_id,
+    DebugHandle debug_handle) {
+  if (name == nullptr) {
+    name = "";
+  }
+  const size_t size = table_.size();
+  const size_t start = hash_key(is_delegate, chain_id, debug_handle) % size;
+  for (size_t i = 0; i < size; ++i) {
+    op_stats_entry& entry = table_[(start + i) % size];
+    if (!entry.used.load(std::memory_order_acquire)) {
+      entry.is_delegate = is_delegate;
+      entry.chain_id = chain_id;
+      entry.debug_handle = debug_handle;
+      strncpy(entry.name, name, kOpStatsMaxNameLen - 1);
+      entry.name[kOpStatsMaxNameLen - 1] = '\0';
+      entry.used.store(true, std::memory_order_release);
+      return &entry;
+    }
+    if (entry.is_delegate == is_delegate && entry.chain_id == chain_id &&
+        entry.debug_handle == debug_handle &&
+        strncmp(entry.name, name, kOpStatsMaxNameLen - 1) == 0) {
+      return &entry;
+    }
+  }
+  num_dropped_events_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void OpStatsTracer::record(
+    op_stats_entry* entry,
+    et_timestamp_t start,
+    et_timestamp_t end) {
+  const uint64_t ns = end > start
+      ? (end - start) * tick_ratio_.numerator / tick_ratio_.denominator
+      : 0;
+  std::atomic<uint64_t>& bucket = entry->buckets[bucket_of(ns)];
+  store_relaxed(bucket, load_relaxed(bucket) + 1);
+  store_relaxed(entry->count, load_relaxed(entry->count) + 1);
+  store_relaxed(entry->sum_ns, load_relaxed(entry->sum_ns) + ns);
+  if (ns < load_relaxed(entry->min_ns)) {
+    store_relaxed(entry->min_ns, ns);
+  }
+  if (ns > load_relaxed(entry->max_ns)) {
+    store_relaxed(entry->max_ns, ns);
+  }
+}
+
+EventTracerEntry OpStatsTracer::start_profiling(
+    const char* name,
+    ChainID chain_id,
+    DebugHandle debug_handle) {
+  EventTracerEntry prof_entry;
+  prof_entry.delegate_event_id_type = DelegateDebugIdType::kNone;
+  if (chain_id == -1) {
+    prof_entry.chain_id = chain_id_;
+    prof_entry.debug_handle = debug_handle_;
+  } else {
+    prof_entry.chain_id = chain_id;
+    prof_entry.debug_handle = debug_handle;
+  }
+  op_stats_entry* entry = find_entry(
+      name,
+      /*is_delegate=*/false,
+      prof_entry.chain_id,
+      prof_entry.debug_handle);
+  prof_entry.event_id = entry != nullptr ? entry - table_.data() : -1;
+  prof_entry.start_time = et_pal_current_ticks();
+  return prof_entry;
+}
+
+void OpStatsTracer::end_profiling(EventTracerEntry prof_entry) {
+  const et_timestamp_t end_time = et_pal_current_ticks();
+  if (prof_entry.event_id >= 0) {
+    record(&table_[prof_entry.event_id], prof_entry.start_time, end_time);
+  }
+}
+
+EventTracerEntry OpStatsTracer::start_profiling_delegate(
+    const char* name,
+    DebugHandle delegate_debug_index) {
+  EventTracerEntry prof_entry;
+  prof_entry.delegate_event_id_type =
+      name != nullptr ? DelegateDebugIdType::kStr : DelegateDebugIdType::kInt;
+  prof_entry.chain_id = chain_id_;
+  prof_entry.debug_handle = delegate_debug_index;
+  op_stats_entry* entry = find_entry(
+      name, /*is_delegate=*/true, chain_id_, delegate_debug_index);
+  prof_entry.event_id = entry != nullptr ? entry - table_.data() : -1;
+  prof_entry.start_time = et_pal_current_ticks();
+  return prof_entry;
+}
+
+void OpStatsTracer::end_profiling_delegate(
+    EventTracerEntry prof_entry,
+    __ET_UNUSED const void* metadata,
+    __ET_UNUSED size_t metadata_len) {
+  end_profiling(prof_entry);
+}
+
+void OpStatsTracer::log_profiling_delegate(
+    const char* name,
+    DebugHandle delegate_debug_index,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time,
+    __ET_UNUSED const void* metadata,
+    __ET_UNUSED size_t metadata_len) {
+  op_stats_entry* entry = find_entry(
+      name, /*is_delegate=*/true, chain_id_, delegate_debug_index);
+  if (entry != nullptr) {
+    record(entry, start_time, end_time);
+  }
+}
+
+void OpStatsTracer::track_allocation(
+    __ET_UNUSED AllocatorID id,
+    __ET_UNUSED size_t size) {}
+
+AllocatorID OpStatsTracer::track_allocator(__ET_UNUSED const char* name) {
+  return 0;
+}
+
+void OpStatsTracer::log_evalue(
+    __ET_UNUSED const EValue& evalue,
+    __ET_UNUSED LoggedEValueType evalue_type) {}
+
+size_t OpStatsTracer::get_summaries(Span<op_latency_summary> out) const {
+  if (out.empty()) {
+    return 0;
+  }
+  auto more_total = [](const op_latency_summary& a,
+                       const op_latency_summary& b) {
+    return a.total_ns > b.total_ns;
+  };
+  // Keeps the events that took the most time when `out` is too small for all
+  // of them.
+  size_t num_summaries = 0;
+  for (const op_stats_entry& entry : table_) {
+    if (!entry.used.load(std::memory_order_acquire)) {
+      continue;
+    }
+    op_latency_summary summary;
+    summarize(entry, summary);
+    if (num_summaries < out.size()) {
+      out[num_summaries++] = summary;
+      continue;
+    }
+    op_latency_summary* least =
+        std::max_element(out.begin(), out.end(), more_total);
+    if (more_total(summary, *least)) {
+      *least = summary;
+    }
+  }
+  std::sort(out.begin(), out.begin() + num_summaries, more_total);
+  return num_summaries;
+}
+
+size_t OpStatsTracer::get_num_blocks() const {
+  return num_blocks_.load(std::memory_order_relaxed);
+}
+
+size_t OpStatsTracer::get_num_dropped_events() const {
+  return num_dropped_events_.load(std::memory_order_relaxed);
+}
+
+void OpStatsTracer::reset() {
+  for (op_stats_entry& entry : table_) {
+    entry.used.store(false, std::memory_order_relaxed);
+    store_relaxed(entry.count, 0);
+    store_relaxed(entry.sum_ns, 0);
+    store_relaxed(entry.min_ns, UINT64_MAX);
+    store_relaxed(entry.max_ns, 0);
+    for (std::atomic<uint64_t>& bucket : entry.buckets) {
+      store_relaxed(bucket, 0);
+    }
+  }
+  num_blocks_.store(0);
+  num_dropped_events_.store(0);
+}
+
+Error write_op_stats_table(
+    const op_latency_summary* summaries,
+    size_t num_summaries,
+    FILE* out) {
+  ET_CHECK_OR_RETURN_ERROR(out != nullptr, InvalidArgument, "No output file");
+  bool ok = fprintf(
+                out,
+                "%-31s %8s %10s %10s %12s %10s %10s %10s %10s %10s %10s\n",
+                "name",
+                "chain",
+                "handle",
+                "count",
+                "total_us",
+                "min_us",
+                "mean_us",
+                "p50_us",
+                "p90_us",
+                "p99_us",
+                "max_us") >= 0;
+  for (size_t i = 0; i < num_summaries; ++i) {
+    const op_latency_summary& s = summaries[i];
+    char chain[16];
+    if (s.is_delegate) {
+      snprintf(chain, sizeof(chain), "delegate");
+    } else {
+      snprintf(chain, sizeof(chain), "%" PRId32, s.chain_id);
+    }
+    ok = ok &&
+        fprintf(out,
+                "%-31s %8s %10" PRIu32 " %10" PRIu64
+                " %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                s.name[0] != '\0' ? s.name : "-",
+                chain,
+                s.debug_handle,
+                s.count,
+                ns_to_us(s.total_ns),
+                ns_to_us(s.min_ns),
+                ns_to_us(s.mean_ns),
+                ns_to_us(s.p50_ns),
+                ns_to_us(s.p90_ns),
+                ns_to_us(s.p99_ns),
+                ns_to_us(s.max_ns)) >= 0;
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      ok, AccessFailed, "Failed to write the op stats table");
+  return Error::Ok;
+}
+
+} // namespace executor
+} // namespace torch
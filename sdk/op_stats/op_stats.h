@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <atomic>
+#include <cstdint>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/platform/compiler.h>
+#include <executorch/runtime/platform/platform.h>
+
+namespace torch {
+namespace executor {
+
+// Bucket i of the latency histograms counts latencies in [2^i, 2^(i+1)) ns,
+// except that bucket 0 counts those under 2 ns and the last one those from
+// 2^39 ns, about 9 minutes.
+constexpr size_t kOpStatsNumBuckets = 40;
+constexpr size_t kOpStatsMaxNameLen = 32;
+
+/**
+ * The latency histogram of an event, i.e. of an instruction of a chain, of a
+ * delegate event or of the execution of a method. Only OpStatsTracer writes
+ * its fields.
+ */
+struct op_stats_entry {
+  // Set once the key below is written.
+  std::atomic<bool> used{false};
+  bool is_delegate{false};
+  ChainID chain_id{0};
+  DebugHandle debug_handle{0};
+  // Truncated to kOpStatsMaxNameLen - 1 characters.
+  char name[kOpStatsMaxNameLen]{};
+
+  // Written by the recording thread only, so they are loaded and stored
+  // rather than atomically updated.
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum_ns{0};
+  std::atomic<uint64_t> min_ns{UINT64_MAX};
+  std::atomic<uint64_t> max_ns{0};
+  std::atomic<uint64_t> buckets[kOpStatsNumBuckets]{};
+};
+
+/**
+ * The latency statistics of an event, returned by
+ * OpStatsTracer::get_summaries().
+ */
+struct op_latency_summary {
+  char name[kOpStatsMaxNameLen];
+  bool is_delegate;
+  ChainID chain_id;
+  DebugHandle debug_handle;
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+  double mean_ns;
+  // Estimated from the histogram, within [min_ns, max_ns].
+  double p50_ns;
+  double p90_ns;
+  double p99_ns;
+};
+
+/**
+ * An EventTracer that aggregates the latency of each profiling event into a
+ * fixed-bucket histogram in place, instead of recording the events, so that
+ * a serving process can export per-op metrics without shipping traces.
+ *
+ * Events are keyed by their chain, debug handle, i.e. instruction, and name,
+ * so each instruction of a method gets a histogram, as does each delegate
+ * event. Debug events and allocations are ignored.
+ *
+ * The tracer does not allocate memory: the histograms live in the table it
+ * is constructed with. Events that do not find room in it are counted by
+ * get_num_dropped_events(). One thread records events at a time, as a Method
+ * runs on one thread, while any thread may call get_summaries().
+ */
+class OpStatsTracer : public EventTracer {
+ public:
+  explicit OpStatsTracer(Span<op_stats_entry> table);
+
+  void create_event_block(const char* name) override;
+  EventTracerEntry start_profiling(
+      const char* name,
+      ChainID chain_id = kUnsetChainId,
+      DebugHandle debug_handle = kUnsetDebugHandle) override;
+  void end_profiling(EventTracerEntry prof_entry) override;
+  EventTracerEntry start_profiling_delegate(
+      const char* name,
+      DebugHandle delegate_debug_index) override;
+  void end_profiling_delegate(
+      EventTracerEntry prof_entry,
+      const void* metadata,
+      size_t metadata_len) override;
+  void log_profiling_delegate(
+      const char* name,
+      DebugHandle delegate_debug_index,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time,
+      const void* metadata,
+      size_t metadata_len) override;
+  void track_allocation(AllocatorID id, size_t size) override;
+  AllocatorID track_allocator(const char* name) override;
+  void log_evalue(const EValue& evalue, LoggedEValueType evalue_type)
+      override;
+
+  /**
+   * Fills `out` with the statistics of the events, the ones that took the
+   * most time in total first.
+   *
+   * @returns The number of summaries written, at most out.size().
+   */
+  size_t get_summaries(Span<op_latency_summary> out) const;
+
+  // Number of event blocks, i.e. method executions, seen.
+  size_t get_num_blocks() const;
+  // Number of events not recorded because the table was full.
+  size_t get_num_dropped_events() const;
+  // Clears the table. Must not be called while events are recorded.
+  void reset();
+
+ private:
+  Span<op_stats_entry> table_;
+  et_tick_ratio_t tick_ratio_;
+  std::atomic<size_t> num_blocks_{0};
+  std::atomic<size_t> num_dropped_events_{0};
+
+  op_stats_entry* find_entry(
+      const char* name,
+      bool is_delegate,
+      ChainID chain_id,
+      DebugHandle debug_handle);
+  void record(op_stats_entry* entry, et_timestamp_t start, et_timestamp_t end);
+};
+
+/**
+ * Writes `summaries`, as returned by OpStatsTracer::get_summaries(), to `out`
+ * as a text table in microseconds.
+ *
+ * @returns Error::AccessFailed if writing to `out` fails.
+ */
+__ET_NODISCARD Error write_op_stats_table(
+    const op_latency_summary* summaries,
+    size_t num_summaries,
+    FILE* out);
+
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/sdk/op_stats/op_stats.h>
+
+using namespace torch::executor;
+
+class OpStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+
+  // Logs a delegate event of `ns` nanoseconds, as ticks are nanoseconds on
+  // the host.
+  static void log_event(
+      OpStatsTracer& tracer,
+      const char* name,
+      DebugHandle index,
+      et_timestamp_t ns) {
+    tracer.log_profiling_delegate(name, index, 1000, 1000 + ns, nullptr, 0);
+  }
+
+  op_stats_entry table_[16];
+};
+
+TEST_F(OpStatsTest, AggregatesInstructionLatency) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 16));
+  for (int run = 0; run < 3; ++run) {
+    tracer.create_event_block("Execute");
+    EventTracerEntry method = tracer.start_profiling("Method::execute");
+    for (DebugHandle instruction = 0; instruction < 2; ++instruction) {
+      tracer.set_chain_debug_handle(0, instruction);
+      tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+      tracer.set_chain_debug_handle(kUnsetChainId, kUnsetDebugHandle);
+    }
+    tracer.end_profiling(method);
+  }
+
+  op_latency_summary summaries[8];
+  size_t num_summaries = tracer.get_summaries({summaries, 8});
+  ASSERT_EQ(num_summaries, 3);
+  EXPECT_EQ(tracer.get_num_blocks(), 3);
+  EXPECT_EQ(tracer.get_num_dropped_events(), 0);
+  // The method execution encloses the operators, so it took the most time.
+  EXPECT_STREQ(summaries[0].name, "Method::execute");
+  EXPECT_EQ(summaries[0].chain_id, kUnsetChainId);
+  for (size_t i = 0; i < num_summaries; ++i) {
+    EXPECT_EQ(summaries[i].count, 3);
+    EXPECT_FALSE(summaries[i].is_delegate);
+    EXPECT_LE(summaries[i].min_ns, summaries[i].max_ns);
+    EXPECT_LE(summaries[i].min_ns, summaries[i].p50_ns);
+    EXPECT_LE(summaries[i].p99_ns, summaries[i].max_ns);
+  }
+  for (size_t i = 1; i < num_summaries; ++i) {
+    EXPECT_STREQ(summaries[i].name, "OPERATOR_CALL");
+    EXPECT_EQ(summaries[i].chain_id, 0);
+  }
+  EXPECT_NE(summaries[1].debug_handle, summaries[2].debug_handle);
+}
+
+TEST_F(OpStatsTest, EstimatesPercentilesFromTheHistogram) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 16));
+  for (int i = 0; i < 90; ++i) {
+    log_event(tracer, "conv", 1, 1000);
+  }
+  for (int i = 0; i < 10; ++i) {
+    log_event(tracer, "conv", 1, 100000);
+  }
+
+  op_latency_summary summary;
+  ASSERT_EQ(tracer.get_summaries({&summary, 1}), 1);
+  EXPECT_STREQ(summary.name, "conv");
+  EXPECT_TRUE(summary.is_delegate);
+  EXPECT_EQ(summary.debug_handle, 1);
+  EXPECT_EQ(summary.count, 100);
+  EXPECT_EQ(summary.total_ns, 90 * 1000 + 10 * 100000);
+  EXPECT_EQ(summary.min_ns, 1000);
+  EXPECT_EQ(summary.max_ns, 100000);
+  EXPECT_DOUBLE_EQ(summary.mean_ns, 10900.0);
+  // Within the bucket of 1000 ns, [512, 1024), clamped to the minimum.
+  EXPECT_GE(summary.p50_ns, 1000.0);
+  EXPECT_LT(summary.p50_ns, 1024.0);
+  EXPECT_LE(summary.p90_ns, 1024.0);
+  // Within the bucket of 100000 ns, clamped to the maximum.
+  EXPECT_GE(summary.p99_ns, 65536.0);
+  EXPECT_LE(summary.p99_ns, 100000.0);
+}
+
+TEST_F(OpStatsTest, KeyDelegateEventsByName) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 16));
+  log_event(tracer, "matmul", 3, 10);
+  log_event(tracer, "softmax", 3, 20);
+  log_event(tracer, "matmul", 3, 10);
+  log_event(tracer, nullptr, 3, 30);
+
+  op_latency_summary summaries[8];
+  ASSERT_EQ(tracer.get_summaries({summaries, 8}), 3);
+  EXPECT_STREQ(summaries[0].name, "");
+  EXPECT_EQ(summaries[0].count, 1);
+  EXPECT_STREQ(summaries[1].name, "matmul");
+  EXPECT_EQ(summaries[1].count, 2);
+  EXPECT_STREQ(summaries[2].name, "softmax");
+  EXPECT_EQ(summaries[2].count, 1);
+}
+
+TEST_F(OpStatsTest, ReturnsTheEventsThatTookTheMostTime) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 16));
+  log_event(tracer, "b", 1, 200);
+  log_event(tracer, "d", 2, 400);
+  log_event(tracer, "a", 3, 100);
+  log_event(tracer, "c", 4, 300);
+
+  op_latency_summary summaries[2];
+  ASSERT_EQ(tracer.get_summaries({summaries, 2}), 2);
+  EXPECT_STREQ(summaries[0].name, "d");
+  EXPECT_STREQ(summaries[1].name, "c");
+}
+
+TEST_F(OpStatsTest, DropsEventsWhenTheTableIsFull) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 2));
+  log_event(tracer, "a", 1, 10);
+  log_event(tracer, "b", 2, 10);
+  log_event(tracer, "c", 3, 10);
+  tracer.set_chain_debug_handle(0, 4);
+  // Ending a dropped event must not touch the table.
+  tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+  tracer.set_chain_debug_handle(kUnsetChainId, kUnsetDebugHandle);
+  log_event(tracer, "a", 1, 10);
+
+  EXPECT_EQ(tracer.get_num_dropped_events(), 2);
+  op_latency_summary summaries[4];
+  ASSERT_EQ(tracer.get_summaries({summaries, 4}), 2);
+  EXPECT_STREQ(summaries[0].name, "a");
+  EXPECT_EQ(summaries[0].count, 2);
+  EXPECT_EQ(summaries[1].count, 1);
+
+  tracer.reset();
+  EXPECT_EQ(tracer.get_num_dropped_events(), 0);
+  EXPECT_EQ(tracer.get_summaries({summaries, 4}), 0);
+  log_event(tracer, "c", 3, 10);
+  EXPECT_EQ(tracer.get_summaries({summaries, 4}), 1);
+  EXPECT_STREQ(summaries[0].name, "c");
+  EXPECT_EQ(summaries[0].min_ns, 10);
+}
+
+TEST_F(OpStatsTest, WritesATable) {
+  OpStatsTracer tracer(Span<op_stats_entry>(table_, 16));
+  log_event(tracer, "linear", 7, 2500);
+  op_latency_summary summary;
+  ASSERT_EQ(tracer.get_summaries({&summary, 1}), 1);
+
+  FILE* file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(write_op_stats_table(&summary, 1, file), Error::Ok);
+  rewind(file);
+  char line[256];
+  ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+  EXPECT_NE(strstr(line, "p99_us"), nullptr);
+  ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+  std::string row(line);
+  EXPECT_EQ(row.rfind("linear", 0), 0);
+  EXPECT_NE(row.find("delegate"), std::string::npos);
+  EXPECT_NE(row.find("2.500"), std::string::npos);
+  fclose(file);
+
+  EXPECT_EQ(write_op_stats_table(&summary, 1, nullptr), Error::InvalidArgument);
+}
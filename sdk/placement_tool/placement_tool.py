@@ -0,0 +1,169 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+"""
+Picks a backend for each node of a model from on-device measurements.
+
+Lower the same model once per candidate backend, generating an ETRecord for
+each, and run each resulting .pte on the target device with ETDump enabled
+(e.g. with sdk_example_runner or bundled_benchmark_runner). This tool reads
+the ETRecord/ETDump pairs, attributes the measured latency to the nodes of the
+Edge dialect graph, and writes a placement file that
+`executorch.exir.backend.placement.PlacementPartitioner` consumes to lower the
+model for that class of devices. Name the candidates after the backend ids
+their partitioners use:
+
+    python -m executorch.sdk.placement_tool.placement_tool \
+        --candidate XnnpackBackend:xnnpack.etrecord:xnnpack.etdump \
+        --candidate VulkanBackend:vulkan.etrecord:vulkan.etdump \
+        --output_path placement.json
+"""
+
+import argparse
+import logging
+from typing import Dict, Iterable, Optional, Tuple
+
+from executorch.exir.backend.placement import Placement
+from executorch.sdk.inspector import Event, Inspector
+
+
+def collect_node_latencies(events: Iterable[Event]) -> Dict[str, float]:
+    """
+    Returns the average latency of each node of the Edge dialect graph over
+    the given events. An event that covers several nodes, e.g. a delegate
+    call, is split evenly between them; a node covered by several events keeps
+    the share of the most specific one, so that a delegate call does not count
+    twice with the events its backend logged inside it.
+    """
+    # node name -> (number of nodes of the event, latency share)
+    shares: Dict[str, Tuple[int, float]] = {}
+    for event in events:
+        if event.perf_data is None or len(event.stack_traces) == 0:
+            continue
+        nodes = list(event.stack_traces.keys())
+        share = event.perf_data.avg / len(nodes)
+        for node in nodes:
+            previous = shares.get(node)
+            if previous is None or len(nodes) < previous[0]:
+                shares[node] = (len(nodes), share)
+            elif len(nodes) == previous[0]:
+                # The node runs several times, e.g. in a loop.
+                shares[node] = (len(nodes), previous[1] + share)
+    return {node: share for node, (_, share) in shares.items()}
+
+
+def overhead_ms(events: Iterable[Event], node_latencies: Dict[str, float]) -> float:
+    """
+    Returns the time Method::execute spent outside of the measured nodes, e.g.
+    moving data in and out of delegates, given the output of
+    collect_node_latencies() for the same events.
+    """
+    execute_ms = sum(
+        event.perf_data.avg
+        for event in events
+        if event.name == "Method::execute" and event.perf_data is not None
+    )
+    return max(0.0, execute_ms - sum(node_latencies.values()))
+
+
+def compute_placement(
+    latencies_by_backend: Dict[str, Dict[str, float]],
+    default_backend: str,
+    min_gain_ms: float = 0.0,
+) -> Dict[str, str]:
+    """
+    Places each node on the backend where it ran fastest. A node only leaves
+    `default_backend` if the gain exceeds `min_gain_ms`, which accounts for the
+    cost of moving data between backends.
+    """
+    nodes = set()
+    for latencies in latencies_by_backend.values():
+        nodes.update(latencies.keys())
+
+    default_latencies = latencies_by_backend.get(default_backend, {})
+    placement: Dict[str, str] = {}
+    for node in sorted(nodes):
+        best_backend: Optional[str] = None
+        best_latency = float("inf")
+        for backend, latencies in sorted(latencies_by_backend.items()):
+            latency = latencies.get(node)
+            if latency is not None and latency < best_latency:
+                best_backend, best_latency = backend, latency
+        if best_backend is None:
+            continue
+        default_latency = default_latencies.get(node)
+        if (
+            default_latency is not None
+            and default_latency - best_latency <= min_gain_ms
+        ):
+            best_backend = default_backend
+        placement[node] = best_backend
+    return placement
+
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument(
+        "--candidate",
+        action="append",
+        required=True,
+        help="A backend name, ETRecord path and ETDump path, separated by colons. "
+        "The first candidate is the default placement.",
+    )
+
+    parser.add_argument(
+        "--min_gain_ms",
+        type=float,
+        default=0.0,
+        help="The latency gain required to move a node off the default backend",
+    )
+
+    parser.add_argument(
+        "--output_path",
+        default="placement.json",
+        help="The output path for the placement file",
+    )
+
+    args = parser.parse_args()
+    return args
+
+
+def main():
+    args = parse_args()
+
+    latencies_by_backend: Dict[str, Dict[str, float]] = {}
+    overhead_by_backend: Dict[str, float] = {}
+    for candidate in args.candidate:
+        backend, etrecord_path, etdump_path = candidate.split(":")
+        inspector = Inspector(etdump_path=etdump_path, etrecord=etrecord_path)
+        events = [
+            event
+            for event_block in inspector.event_blocks
+            for event in event_block.events
+        ]
+        latencies = collect_node_latencies(events)
+        latencies_by_backend[backend] = latencies
+        overhead_by_backend[backend] = overhead_ms(events, latencies)
+        logging.info(
+            f"{backend}: {sum(latencies.values()):.3f} ms over "
+            f"{len(latencies)} nodes, {overhead_by_backend[backend]:.3f} ms "
+            "outside of them"
+        )
+
+    default_backend = args.candidate[0].split(":")[0]
+    placement = Placement(
+        node_to_backend=compute_placement(
+            latencies_by_backend, default_backend, args.min_gain_ms
+        ),
+        latency_ms=latencies_by_backend,
+        overhead_ms=overhead_by_backend,
+    )
+    placement.save(args.output_path)
+
+
+if __name__ == "__main__":
+    main()
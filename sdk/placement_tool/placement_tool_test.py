@@ -0,0 +1,77 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import os
+import tempfile
+import unittest
+from typing import List, Optional
+
+from executorch.exir.backend.placement import Placement
+from executorch.sdk.inspector import Event, PerfData
+from executorch.sdk.placement_tool.placement_tool import (
+    collect_node_latencies,
+    compute_placement,
+    overhead_ms,
+)
+
+
+def _event(
+    name: str, nodes: List[str], latency_ms: float, delegated: Optional[bool] = None
+) -> Event:
+    return Event(
+        name=name,
+        perf_data=PerfData([latency_ms]),
+        stack_traces={node: "" for node in nodes},
+        is_delegated_op=delegated,
+    )
+
+
+class TestPlacementTool(unittest.TestCase):
+    def test_collect_prefers_the_most_specific_event(self) -> None:
+        events = [
+            # The delegate call covers both nodes...
+            _event("DELEGATE_CALL", ["conv", "relu"], 10.0),
+            # ...and its backend logged one of them on its own.
+            _event("conv", ["conv"], 6.0, delegated=True),
+            Event(name="Method::execute", perf_data=PerfData([12.0])),
+        ]
+        latencies = collect_node_latencies(events)
+        self.assertEqual(latencies, {"conv": 6.0, "relu": 5.0})
+        self.assertEqual(overhead_ms(events, latencies), 1.0)
+
+    def test_collect_accumulates_repeated_nodes(self) -> None:
+        events = [_event("add", ["add"], 1.0), _event("add", ["add"], 2.0)]
+        self.assertEqual(collect_node_latencies(events), {"add": 3.0})
+
+    def test_compute_placement(self) -> None:
+        latencies_by_backend = {
+            "XnnpackBackend": {"conv": 4.0, "softmax": 1.0, "linear": 2.0},
+            "VulkanBackend": {"conv": 1.0, "softmax": 0.9, "gelu": 0.5},
+        }
+        self.assertEqual(
+            compute_placement(
+                latencies_by_backend, "XnnpackBackend", min_gain_ms=0.5
+            ),
+            {
+                "conv": "VulkanBackend",
+                # The gain is below min_gain_ms.
+                "softmax": "XnnpackBackend",
+                "linear": "XnnpackBackend",
+                # Only measured on one backend.
+                "gelu": "VulkanBackend",
+            },
+        )
+
+    def test_placement_round_trip(self) -> None:
+        placement = Placement(
+            node_to_backend={"conv": "VulkanBackend"},
+            latency_ms={"VulkanBackend": {"conv": 1.0}},
+            overhead_ms={"VulkanBackend": 0.25},
+        )
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            path = os.path.join(tmp_dir, "placement.json")
+            placement.save(path)
+            self.assertEqual(Placement.load(path), placement)
@@ -143,6 +143,19 @@ class ModuleLinear(torch.nn.Module):
         return (torch.ones(2, 2, dtype=torch.float),)
 
 
+class ModuleTransposedWeight(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.w = torch.arange(4, dtype=torch.float).reshape(2, 2)
+
+    def forward(self, x: torch.Tensor):
+        # The transpose only reads a constant.
+        return torch.mm(x, self.w.t())
+
+    def get_random_inputs(self):
+        return (torch.ones(2, 2, dtype=torch.float),)
+
+
 class ModuleMultipleEntry(torch.nn.Module):
     def __init__(self):
         super().__init__()